@@ -0,0 +1,97 @@
+/*
+ * 文件: buffer_access_strategy.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 缓冲区访问策略，大表顺序扫描时使用一个私有的小环形frame集合，
+ *       避免一次全表扫描把整个缓冲池的热点页面都挤出去
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "common/config.h"
+
+namespace SimpleRDBMS {
+
+class BufferPoolManager;
+
+/**
+ * BufferAccessStrategy - 批量读取（BULK READ）访问策略
+ *
+ * 设计思路（参考PostgreSQL的BAS_BULKREAD）：
+ * - 扫描器持有一个环，环里记录自己之前读入页面所用的frame
+ * - 缓存未命中时，优先复用环中下一个槽位的frame，而不是从全局替换器里
+ *   挑victim，这样扫描最多只占用环大小那么多的frame
+ * - 如果环里的frame已经被别人pin住或者换成了别的页面，就退回到普通的
+ *   替换流程，并把新frame记进环里
+ * - 扫描刚开始时不启用环（activation_pages），小表扫描仍然会完整缓存，
+ *   只有读入页面数超过阈值后才开始循环复用
+ *
+ * 缓存命中走正常路径，不会改变环的状态。
+ * 策略对象只应被一个扫描使用，环按缓冲池分片分开存放，受分片锁保护。
+ */
+class BufferAccessStrategy {
+   public:
+    /** 默认环大小：32个页面（4KB页面下为128KB） */
+    static constexpr size_t DEFAULT_RING_SIZE = 32;
+
+    /**
+     * 构造函数
+     * @param num_shards 缓冲池分片数量，必须和使用它的缓冲池一致
+     * @param ring_size 环的总大小（页面数），平均分到每个分片，每个分片至少1个
+     * @param activation_pages 读入多少个页面之后才开始复用环
+     */
+    BufferAccessStrategy(size_t num_shards, size_t ring_size,
+                         size_t activation_pages)
+        : rings_(num_shards == 0 ? 1 : num_shards),
+          cursors_(rings_.size(), 0),
+          per_shard_ring_size_(ring_size / rings_.size() == 0
+                                   ? 1
+                                   : ring_size / rings_.size()),
+          activation_pages_(activation_pages) {}
+
+    /** 获取策略读入过的页面数量（缓存未命中的次数） */
+    size_t GetPagesRead() const { return pages_read_.load(); }
+
+    /** 获取通过复用环中frame完成的读取次数 */
+    size_t GetRingReuses() const { return ring_reuses_.load(); }
+
+   private:
+    friend class BufferPoolManager;
+
+    /** 环中的一个槽位，记录frame以及环放进去的页面 */
+    struct RingSlot {
+        size_t frame_id;
+        page_id_t page_id;
+    };
+
+    /** 每个分片一个环 */
+    std::vector<std::vector<RingSlot>> rings_;
+
+    /** 每个环下一个要复用的槽位 */
+    std::vector<size_t> cursors_;
+
+    /** 每个分片的环大小 */
+    size_t per_shard_ring_size_;
+
+    /** 启用环之前允许正常读入的页面数 */
+    size_t activation_pages_;
+
+    /** 统计：读入的页面数，不同分片可能并发更新 */
+    std::atomic<size_t> pages_read_{0};
+
+    /** 统计：复用环中frame的次数 */
+    std::atomic<size_t> ring_reuses_{0};
+
+    /**
+     * 只读映射方式下已经madvise过的页面范围[begin, end)，
+     * 扫描线程和预读线程可能同时更新，竞争的结果只是多一次madvise
+     */
+    std::atomic<page_id_t> advised_begin_{INVALID_PAGE_ID};
+    std::atomic<page_id_t> advised_end_{INVALID_PAGE_ID};
+};
+
+}  // namespace SimpleRDBMS
@@ -8,11 +8,22 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <new>
 
+#include "buffer/lru_replacer.h"
 #include "common/debug.h"
 #include "common/exception.h"
+#include "common/numa.h"
+#include "recovery/log_manager.h"
 #include "stat/stat.h"
+#include "stat/trace.h"
 
 namespace SimpleRDBMS {
 
@@ -24,52 +35,334 @@ namespace SimpleRDBMS {
  * @param replacer 页面替换器（智能指针，通常是LRU）
  *
  * 实现思路：
- * 1. 先分配固定大小的页面数组作为缓冲池
- * 2. 初始化所有frame都是空闲状态，加入free_list
- * 3. page_table_用来维护page_id到frame_id的映射关系
+ * 1. 先分配一块arena作为缓冲池
+ * 2. 只创建一个分片，直接使用调用者传入的替换器
+ * 3. 初始化所有frame都是空闲状态，加入free_list
  */
 BufferPoolManager::BufferPoolManager(size_t pool_size,
                                      std::unique_ptr<DiskManager> disk_manager,
                                      std::unique_ptr<Replacer> replacer)
-    : pool_size_(pool_size),
-      disk_manager_(std::move(disk_manager)),
-      replacer_(std::move(replacer)) {
+    : pool_size_(pool_size), disk_manager_(std::move(disk_manager)) {
     LOG_INFO("Creating BufferPoolManager with pool_size=" << pool_size);
 
-    LOG_DEBUG("About to allocate buffer pool array...");
+    InitShards(1, nullptr);
+
+    // 单分片模式下直接使用调用者传入的替换器
+    if (replacer) {
+        shards_[0]->replacer = std::move(replacer);
+        shards_[0]->replacer->SetCapacity(shards_[0]->frames.size());
+    }
+}
+
+/**
+ * 构造函数 - 初始化分片模式的缓冲池管理器
+ *
+ * @param pool_size 缓冲池总大小（页面数量）
+ * @param num_shards 分片数量
+ * @param disk_manager 磁盘管理器（智能指针）
+ * @param replacer_factory 替换器工厂，为空时使用LRUReplacer
+ *
+ * 实现思路：
+ * 1. 每个分片用工厂创建自己的替换器
+ * 2. 分配一整块arena，frame轮流分给各个分片
+ */
+BufferPoolManager::BufferPoolManager(size_t pool_size, size_t num_shards,
+                                     std::unique_ptr<DiskManager> disk_manager,
+                                     ReplacerFactory replacer_factory)
+    : pool_size_(pool_size), disk_manager_(std::move(disk_manager)) {
+    LOG_INFO("Creating BufferPoolManager with pool_size="
+             << pool_size << ", num_shards=" << num_shards);
+    InitShards(num_shards, replacer_factory);
+}
+
+/**
+ * 析构函数 - 清理资源并确保所有脏页都写回磁盘
+ */
+BufferPoolManager::~BufferPoolManager() {
+    LOG_INFO("Destroying BufferPoolManager");
+
+    StopWarmup();
+    StopWarmupDump();
+    StopBackgroundWriter();
+
+    // 把所有脏页都写回磁盘，确保数据不丢失
+    FlushAllPages();
+
+    // 先析构分片（替换器等），再释放所有arena的内存
+    shards_.clear();
+    for (auto& arena : arenas_) {
+        FreeArena(arena);
+    }
+    arenas_.clear();
+}
+
+/**
+ * 初始化分片
+ *
+ * 实现思路：
+ * 1. 分片数量限制在[1, pool_size]，避免出现没有frame的空分片
+ * 2. 为每个分片创建空的结构和替换器
+ * 3. 分配第一块arena，再把其中的frame平均分给各个分片
+ */
+void BufferPoolManager::InitShards(size_t num_shards,
+                                   const ReplacerFactory& replacer_factory) {
+    size_t pool_size = pool_size_.load();
+    if (num_shards == 0) {
+        num_shards = 1;
+    }
+    if (pool_size > 0 && num_shards > pool_size) {
+        LOG_WARN("num_shards " << num_shards << " exceeds pool_size "
+                               << pool_size << ", clamping");
+        num_shards = pool_size;
+    }
+
+    // 每个分片初始大约分到的frame数量，用于创建替换器
+    size_t frames_per_shard = (pool_size + num_shards - 1) / num_shards;
+    for (size_t i = 0; i < num_shards; i++) {
+        auto shard = std::make_unique<BufferPoolShard>();
+        if (replacer_factory) {
+            shard->replacer = replacer_factory(frames_per_shard);
+        }
+        if (!shard->replacer) {
+            shard->replacer = std::make_unique<LRUReplacer>(frames_per_shard);
+        }
+        shards_.push_back(std::move(shard));
+    }
+
+    LOG_DEBUG("About to allocate buffer pool arena...");
     try {
-        // 分配缓冲池数组 - 这是整个系统的内存缓存区域
-        pages_ = new Page[pool_size_];
-        LOG_DEBUG("Buffer pool array allocated successfully");
+        // 分配缓冲池arena - 这是整个系统的内存缓存区域
+        arenas_.push_back(AllocateArena(pool_size));
+        LOG_DEBUG("Buffer pool arena allocated successfully");
     } catch (const std::exception& e) {
         LOG_ERROR("Failed to allocate buffer pool: " << e.what());
         throw;
     }
+    DistributeArena(0);
+
+    LOG_DEBUG("Buffer pool initialized with " << shards_.size()
+                                              << " shard(s), " << pool_size
+                                              << " frames total");
+}
+
+/**
+ * 分配一块新的arena
+ *
+ * 实现思路：
+ * 1. 总字节数向上取整到2MB，并按2MB对齐分配，方便内核使用透明大页
+ * 2. 用madvise(MADV_HUGEPAGE)提示内核，不支持的系统上忽略即可
+ * 3. 多路机器上让这块内存在各个NUMA节点之间交错分配：页面按page_id
+ *    散到各个分片，任何节点的线程都会访问，默认的first-touch会让
+ *    初始化线程所在的节点承担全部访问
+ * 4. 逐个placement new构造Page对象
+ */
+BufferPoolManager::FrameArena BufferPoolManager::AllocateArena(size_t count) {
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
 
-    LOG_DEBUG("Initializing free list...");
-    // 把所有frame都标记为空闲，刚开始所有frame都可以用
-    for (size_t i = 0; i < pool_size_; i++) {
-        free_list_.push_back(i);
-        if (i % 10 == 0) {  // 每10个输出一次进度，避免日志太多
-            LOG_TRACE("Initialized frame " << i << "/" << pool_size_);
+    FrameArena arena;
+    arena.count = count;
+    if (count == 0) {
+        return arena;
+    }
+
+    size_t bytes = count * sizeof(Page);
+    arena.bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    if (posix_memalign(&arena.memory, HUGE_PAGE_SIZE, arena.bytes) != 0) {
+        throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    if (madvise(arena.memory, arena.bytes, MADV_HUGEPAGE) != 0) {
+        LOG_DEBUG("madvise(MADV_HUGEPAGE) not supported, using normal pages");
+    }
+#endif
+    NumaTopology::Get().InterleaveMemory(arena.memory, arena.bytes);
+
+    arena.pages = static_cast<Page*>(arena.memory);
+    for (size_t i = 0; i < count; i++) {
+        new (&arena.pages[i]) Page();
+    }
+    return arena;
+}
+
+/**
+ * 释放arena - 先析构页面对象，再归还内存
+ */
+void BufferPoolManager::FreeArena(FrameArena& arena) {
+    if (arena.memory == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < arena.count; i++) {
+        arena.pages[i].~Page();
+    }
+    std::free(arena.memory);
+    arena.memory = nullptr;
+    arena.pages = nullptr;
+    arena.count = 0;
+    arena.live_frames = 0;
+}
+
+/**
+ * 把arena中的frame平均分给各个分片
+ *
+ * 第i个frame分给第i % num_shards个分片，优先复用分片里缩容留下的空槽位，
+ * 这样frame_id不会无限增长
+ */
+void BufferPoolManager::DistributeArena(size_t arena_index) {
+    FrameArena& arena = arenas_[arena_index];
+    for (size_t i = 0; i < arena.count; i++) {
+        BufferPoolShard& shard = *shards_[i % shards_.size()];
+        std::unique_lock<std::mutex> lock(shard.latch);
+
+        Page* page = &arena.pages[i];
+        size_t frame_id;
+        if (!shard.retired_slots.empty()) {
+            frame_id = shard.retired_slots.back();
+            shard.retired_slots.pop_back();
+            shard.frames[frame_id] = page;
+        } else {
+            frame_id = shard.frames.size();
+            shard.frames.push_back(page);
+        }
+
+        shard.free_list.push_back(frame_id);
+        shard.pool_size++;
+        shard.replacer->SetCapacity(shard.frames.size());
+        arena.live_frames++;
+    }
+}
+
+/**
+ * 在线调整缓冲池大小
+ *
+ * 实现思路：
+ * 1. 扩容：分配一块大小为差值的新arena，分给各个分片
+ * 2. 缩容：按各个分片当前大小平均分摊需要回收的frame数量，
+ *    一个分片回收不够时由后面的分片补上
+ * 3. 最后释放所有frame都已经回收的arena
+ */
+bool BufferPoolManager::Resize(size_t new_pool_size) {
+    std::lock_guard<std::mutex> resize_lock(resize_latch_);
+
+    if (new_pool_size == 0) {
+        LOG_ERROR("Resize: buffer pool size must be positive");
+        return false;
+    }
+
+    size_t old_pool_size = pool_size_.load();
+    if (new_pool_size == old_pool_size) {
+        return true;
+    }
+
+    if (new_pool_size > old_pool_size) {
+        size_t delta = new_pool_size - old_pool_size;
+        try {
+            arenas_.push_back(AllocateArena(delta));
+        } catch (const std::exception& e) {
+            LOG_ERROR("Resize: failed to allocate " << delta
+                                                    << " frames: " << e.what());
+            return false;
         }
+        DistributeArena(arenas_.size() - 1);
+        pool_size_ = new_pool_size;
+        LOG_INFO("Buffer pool grown from " << old_pool_size << " to "
+                                           << new_pool_size << " frames");
+        return true;
     }
-    LOG_DEBUG("Free list initialized with " << free_list_.size() << " frames");
 
-    LOG_DEBUG("BufferPoolManager created successfully");
+    // 缩容：每个分片至少保留一个frame
+    size_t remaining = old_pool_size - new_pool_size;
+    size_t per_shard = (remaining + shards_.size() - 1) / shards_.size();
+    for (auto& shard_ptr : shards_) {
+        if (remaining == 0) {
+            break;
+        }
+        size_t retired =
+            RetireFrames(*shard_ptr, std::min(per_shard, remaining));
+        remaining -= retired;
+    }
+    // 第二轮：前面某些分片回收不够时，让其他分片多回收一些
+    for (auto& shard_ptr : shards_) {
+        if (remaining == 0) {
+            break;
+        }
+        remaining -= RetireFrames(*shard_ptr, remaining);
+    }
+
+    // 释放已经完全空出来的arena
+    for (auto it = arenas_.begin(); it != arenas_.end();) {
+        if (it->live_frames == 0) {
+            FreeArena(*it);
+            it = arenas_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    size_t achieved = new_pool_size + remaining;
+    pool_size_ = achieved;
+    LOG_INFO("Buffer pool shrunk from " << old_pool_size << " to " << achieved
+                                        << " frames (target " << new_pool_size
+                                        << ")");
+    return remaining == 0;
 }
 
 /**
- * 析构函数 - 清理资源并确保所有脏页都写回磁盘
+ * 从分片中回收frame
+ *
+ * 实现思路：
+ * 1. 先回收free_list中的空闲frame，不需要任何I/O
+ * 2. 不够的话通过替换器选victim，脏页先写回磁盘
+ * 3. 被pin住的页面永远不会被回收
+ * 4. 每个分片至少保留一个frame
  */
-BufferPoolManager::~BufferPoolManager() {
-    LOG_INFO("Destroying BufferPoolManager");
+size_t BufferPoolManager::RetireFrames(BufferPoolShard& shard, size_t count) {
+    std::unique_lock<std::mutex> lock(shard.latch);
+
+    size_t retired = 0;
+    while (retired < count && shard.pool_size > 1) {
+        size_t frame_id;
+        if (!shard.free_list.empty()) {
+            frame_id = shard.free_list.back();
+            shard.free_list.pop_back();
+        } else if (!AcquireFrame(shard, &frame_id, false)) {
+            break;  // 剩下的页面都被pin住了
+        }
 
-    // 把所有脏页都写回磁盘，确保数据不丢失
-    FlushAllPages();
+        Page* page = shard.frames[frame_id];
+        page->SetPageId(INVALID_PAGE_ID);
+        page->SetDirty(false);
+        shard.frames[frame_id] = nullptr;
+        shard.retired_slots.push_back(frame_id);
+        shard.pool_size--;
+        retired++;
+
+        for (auto& arena : arenas_) {
+            if (page >= arena.pages && page < arena.pages + arena.count) {
+                arena.live_frames--;
+                break;
+            }
+        }
+    }
+    return retired;
+}
 
-    // 释放页面数组内存
-    delete[] pages_;
+/**
+ * 根据page_id找到所属分片
+ *
+ * page_id是连续分配的，直接取模就能把相邻页面打散到不同分片，
+ * 顺序扫描时各个分片的压力也比较均匀
+ */
+BufferPoolManager::BufferPoolShard& BufferPoolManager::GetShard(
+    page_id_t page_id) {
+    return *shards_[GetShardIndex(page_id)];
+}
+
+size_t BufferPoolManager::GetShardIndex(page_id_t page_id) const {
+    if (shards_.size() == 1) {
+        return 0;
+    }
+    size_t hash = std::hash<page_id_t>{}(page_id);
+    return hash % shards_.size();
 }
 
 /**
@@ -79,16 +372,27 @@ BufferPoolManager::~BufferPoolManager() {
  * @return 页面指针，如果获取失败返回nullptr
  *
  * 实现思路：
- * 1. 先检查页面是否已经在缓冲池里，如果在就直接返回并增加pin_count
- * 2. 如果不在，需要从磁盘读取：
+ * 1. 根据page_id定位分片，只锁住这一个分片
+ * 2. 先检查页面是否已经在分片里，如果在就直接返回并增加pin_count
+ * 3. 如果不在，需要从磁盘读取：
  *    - 优先使用free_list里的空闲frame
- *    - 如果没有空闲frame，就用LRU替换器找个victim evict掉
+ *    - 如果没有空闲frame，就用替换器找个victim evict掉
  *    - 如果victim是脏页，先写回磁盘再复用
- * 3. 从磁盘读取页面数据到选定的frame
- * 4. 更新page_table_映射关系，设置pin_count=1
+ * 4. 从磁盘读取页面数据到选定的frame
+ * 5. 更新page_table映射关系，设置pin_count=1
  */
 Page* BufferPoolManager::FetchPage(page_id_t page_id) {
-    std::unique_lock<std::mutex> lock(latch_);
+    return FetchPage(page_id, nullptr);
+}
+
+/**
+ * 按访问策略获取页面
+ *
+ * 和FetchPage的流程一样，只是缓存未命中时通过AcquireRingFrame找frame。
+ * 策略的分片数和缓冲池不一致时（比如缓冲池被重建过）忽略策略。
+ */
+Page* BufferPoolManager::FetchPage(page_id_t page_id,
+                                   BufferAccessStrategy* strategy) {
     LOG_TRACE("FetchPage called with page_id=" << page_id);
 
     if (page_id == INVALID_PAGE_ID) {
@@ -96,16 +400,24 @@ Page* BufferPoolManager::FetchPage(page_id_t page_id) {
         return nullptr;
     }
 
+    if (strategy != nullptr && strategy->rings_.size() != shards_.size()) {
+        strategy = nullptr;
+    }
+
+    size_t shard_index = GetShardIndex(page_id);
+    BufferPoolShard& shard = *shards_[shard_index];
+    std::unique_lock<std::mutex> lock(shard.latch);
+
     // 先看看这个页面是不是已经在内存里了
-    auto it = page_table_.find(page_id);
-    if (it != page_table_.end()) {
+    auto it = shard.page_table.find(page_id);
+    if (it != shard.page_table.end()) {
         // 找到了！直接返回，记得增加引用计数
         STATS.RecordBufferPoolHit();
         size_t frame_id = it->second;
-        Page* page = &pages_[frame_id];
+        Page* page = shard.frames[frame_id];
         page->IncreasePinCount();  // 增加pin计数，表示有人在用
         STATS.RecordPagePin();
-        replacer_->Pin(frame_id);  // 告诉替换器这个frame正在被使用
+        shard.replacer->Pin(frame_id);  // 告诉替换器这个frame正在被使用
         LOG_TRACE("Page " << page_id << " found in buffer pool at frame "
                           << frame_id);
         return page;
@@ -113,42 +425,22 @@ Page* BufferPoolManager::FetchPage(page_id_t page_id) {
 
     // Cache miss
     STATS.RecordBufferPoolMiss();
+    // 区间包括找frame（可能要写回脏页）和读盘
+    TRACE_SPAN_NAMED(miss_span, "buffer", "BufferPool::FetchPageMiss");
+    TRACE_SPAN_SET_ARG(miss_span, static_cast<uint64_t>(page_id));
 
     // 页面不在内存里，需要从磁盘加载
     size_t frame_id;
-    Page* page = nullptr;
-
-    if (!free_list_.empty()) {
-        // 还有空闲的frame，直接用
-        frame_id = free_list_.front();
-        free_list_.pop_front();
-        page = &pages_[frame_id];
-        LOG_TRACE("Using free frame " << frame_id << " for page " << page_id);
-    } else {
-        // 没有空闲frame了，需要踢掉一个页面
-        frame_id = FindVictimPage();
-        if (frame_id == static_cast<size_t>(-1)) {
-            // 所有页面都被pin住了，没法替换
-            LOG_ERROR("No page can be evicted, all pages are pinned");
-            return nullptr;
-        }
-        page = &pages_[frame_id];
-        STATS.RecordPageEviction();
-        LOG_TRACE("Evicting page " << page->GetPageId() << " from frame "
-                                   << frame_id);
-
-        // 如果被踢掉的页面是脏的，先写回磁盘
-        if (page->IsDirty() && page->GetPageId() != INVALID_PAGE_ID) {
-            LOG_DEBUG("Writing dirty page " << page->GetPageId() << " to disk");
-            disk_manager_->WritePage(page->GetPageId(), page->GetData());
-            page->SetDirty(false);
-        }
-
-        // 从映射表里删除旧页面的记录
-        if (page->GetPageId() != INVALID_PAGE_ID) {
-            page_table_.erase(page->GetPageId());
-        }
+    bool acquired =
+        strategy != nullptr
+            ? AcquireRingFrame(shard, shard_index, strategy, page_id, &frame_id)
+            : AcquireFrame(shard, &frame_id, true);
+    if (!acquired) {
+        // 所有页面都被pin住了，没法替换
+        LOG_ERROR("No page can be evicted, all pages are pinned");
+        return nullptr;
     }
+    Page* page = shard.frames[frame_id];
 
     // 从磁盘读取页面数据
     LOG_TRACE("Reading page " << page_id << " from disk (num_pages="
@@ -165,16 +457,18 @@ Page* BufferPoolManager::FetchPage(page_id_t page_id) {
         }
 
         // 从磁盘读取实际数据，这会覆盖页面内容
-        disk_manager_->ReadPage(page_id, page->GetData());
+        LoadPage(page, page_id, strategy);
 
         // 更新映射表，建立page_id -> frame_id的关系
-        page_table_[page_id] = frame_id;
+        shard.page_table[page_id] = frame_id;
+        shard.installs++;
+        resident_pages_++;
 
         // 设置页面为被使用状态
         page->IncreasePinCount();
         STATS.RecordPagePin();
-        replacer_->Pin(frame_id);
-         STATS.UpdateBufferPoolSize(page_table_.size());
+        shard.replacer->Pin(frame_id);
+        STATS.UpdateBufferPoolSize(static_cast<int>(resident_pages_.load()));
 
         return page;
     } catch (const StorageException& e) {
@@ -182,14 +476,16 @@ Page* BufferPoolManager::FetchPage(page_id_t page_id) {
         LOG_DEBUG("Page " << page_id << " does not exist on disk: " << e.what()
                           << " (num_pages=" << disk_manager_->GetNumPages()
                           << ")");
-        free_list_.push_back(frame_id);
+        page->SetPageId(INVALID_PAGE_ID);
+        shard.free_list.push_back(frame_id);
         return nullptr;
     } catch (const std::exception& e) {
         // 其他异常，同样回收frame
         LOG_ERROR("Unexpected exception when reading page "
                   << page_id << ": " << e.what()
                   << " (num_pages=" << disk_manager_->GetNumPages() << ")");
-        free_list_.push_back(frame_id);
+        page->SetPageId(INVALID_PAGE_ID);
+        shard.free_list.push_back(frame_id);
         return nullptr;
     }
 }
@@ -201,13 +497,18 @@ Page* BufferPoolManager::FetchPage(page_id_t page_id) {
  * @return 新页面的指针，失败返回nullptr
  *
  * 实现思路：
- * 1. 找一个可用的frame（优先空闲frame，没有就evict一个）
- * 2. 通过disk_manager分配新的page_id
- * 3. 初始化页面数据（清零），设置为脏页
- * 4. 建立映射关系，设置pin_count=1
+ * 1. 通过disk_manager分配新的page_id（分片由page_id决定，所以要先分配）
+ * 2. 锁住对应分片，找一个可用的frame（优先空闲frame，没有就evict一个）
+ * 3. 找不到frame时把page_id还给disk_manager
+ * 4. 初始化页面数据（清零），设置为脏页
+ * 5. 建立映射关系，设置pin_count=1
  */
 Page* BufferPoolManager::NewPage(page_id_t* page_id) {
-    std::unique_lock<std::mutex> lock(latch_);
+    return NewPage(page_id, nullptr);
+}
+
+Page* BufferPoolManager::NewPage(page_id_t* page_id,
+                                 ExtentReservation* extent) {
     LOG_TRACE("NewPage called");
 
     if (page_id == nullptr) {
@@ -215,50 +516,33 @@ Page* BufferPoolManager::NewPage(page_id_t* page_id) {
         return nullptr;
     }
 
-    // 找一个frame来放新页面
-    size_t frame_id;
-    Page* page = nullptr;
-
-    if (!free_list_.empty()) {
-        // 有空闲frame，直接用
-        frame_id = free_list_.front();
-        free_list_.pop_front();
-        page = &pages_[frame_id];
-        LOG_TRACE("Using free frame " << frame_id << " for new page");
-    } else {
-        // 需要evict一个页面
-        frame_id = FindVictimPage();
-        if (frame_id == static_cast<size_t>(-1)) {
-            // 没有可以evict的页面
-            LOG_ERROR(
-                "No page can be evicted for new page, all pages are pinned");
-            *page_id = INVALID_PAGE_ID;
-            return nullptr;
-        }
-        page = &pages_[frame_id];
-        LOG_TRACE("Evicting page " << page->GetPageId() << " from frame "
-                                   << frame_id << " for new page");
-
-        // 如果被evict的页面是脏的，先写回磁盘
-        if (page->IsDirty() && page->GetPageId() != INVALID_PAGE_ID) {
-            LOG_DEBUG("Writing dirty page " << page->GetPageId()
-                                            << " to disk before eviction");
-            disk_manager_->WritePage(page->GetPageId(), page->GetData());
-            page->SetDirty(false);
-        }
-
-        // 清理旧页面的映射关系
-        if (page->GetPageId() != INVALID_PAGE_ID) {
-            page_table_.erase(page->GetPageId());
-        }
+    if (disk_manager_->IsReadOnly()) {
+        LOG_ERROR("NewPage: database file is opened read-only");
+        return nullptr;
     }
 
     // 通过磁盘管理器分配一个新的page_id
-    *page_id = disk_manager_->AllocatePage();
-    LOG_DEBUG("Allocated new page with id=" << *page_id);
+    page_id_t new_page_id = disk_manager_->AllocatePage(extent);
+    LOG_DEBUG("Allocated new page with id=" << new_page_id);
+
+    BufferPoolShard& shard = GetShard(new_page_id);
+    std::unique_lock<std::mutex> lock(shard.latch);
+
+    // 找一个frame来放新页面
+    size_t frame_id;
+    if (!AcquireFrame(shard, &frame_id, false)) {
+        // 没有可以evict的页面，归还刚分配的page_id
+        LOG_ERROR("No page can be evicted for new page, all pages are pinned");
+        disk_manager_->DeallocatePage(new_page_id);
+        *page_id = INVALID_PAGE_ID;
+        return nullptr;
+    }
+    Page* page = shard.frames[frame_id];
+    *page_id = new_page_id;
 
     // 初始化新页面 - 新页面需要清零数据
     std::memset(page->GetData(), 0, PAGE_SIZE);
+    page->SetChecksumOffset(0);  // 由上层初始化页面格式时设置
     page->SetPageId(*page_id);
     page->SetDirty(true);  // 新页面标记为脏，因为有了新内容
     page->SetLSN(INVALID_LSN);
@@ -269,11 +553,13 @@ Page* BufferPoolManager::NewPage(page_id_t* page_id) {
     }
 
     // 建立映射关系
-    page_table_[*page_id] = frame_id;
+    shard.page_table[*page_id] = frame_id;
+    shard.installs++;
+    resident_pages_++;
 
     // 设置页面为使用状态
     page->IncreasePinCount();
-    replacer_->Pin(frame_id);
+    shard.replacer->Pin(frame_id);
 
     LOG_TRACE("NewPage returning page " << *page_id << " in frame "
                                         << frame_id);
@@ -288,17 +574,23 @@ Page* BufferPoolManager::NewPage(page_id_t* page_id) {
  *
  * 实现思路：
  * 1. 如果页面在缓冲池中，强制unpin（B+树删除时可能需要）
- * 2. 清理page_table_映射关系，frame放回free_list
+ * 2. 清理page_table映射关系，frame放回free_list
  * 3. 调用disk_manager删除磁盘上的页面
  */
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
-    std::unique_lock<std::mutex> lock(latch_);
-
     LOG_TRACE("DeletePage called with page_id=" << page_id);
 
+    if (disk_manager_->IsReadOnly()) {
+        LOG_ERROR("DeletePage: database file is opened read-only");
+        return false;
+    }
+
+    BufferPoolShard& shard = GetShard(page_id);
+    std::unique_lock<std::mutex> lock(shard.latch);
+
     // 检查页面是否在缓冲池中
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
+    auto it = shard.page_table.find(page_id);
+    if (it == shard.page_table.end()) {
         // 页面不在缓冲池中，直接删除磁盘上的页面
         disk_manager_->DeallocatePage(page_id);
         return true;
@@ -306,7 +598,7 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
 
     // 页面在缓冲池中，需要特殊处理
     size_t frame_id = it->second;
-    Page* page = &pages_[frame_id];
+    Page* page = shard.frames[frame_id];
 
     // 强制unpin页面 - B+树节点删除时可能页面还被pin着
     if (page->GetPinCount() > 0) {
@@ -319,11 +611,12 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
     }
 
     // 清理缓冲池中的记录
-    page_table_.erase(page_id);
-    replacer_->Pin(frame_id);  // 从替换器中移除
+    shard.page_table.erase(page_id);
+    resident_pages_--;
+    shard.replacer->Remove(frame_id);  // 从替换器中移除
 
     // frame重新变成空闲的
-    free_list_.push_back(frame_id);
+    shard.free_list.push_back(frame_id);
 
     // 重置页面元数据
     page->SetPageId(INVALID_PAGE_ID);
@@ -350,18 +643,20 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
  * 3. 如果pin_count变成0，告诉替换器这个frame可以被替换了
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-    std::unique_lock<std::mutex> lock(latch_);
     LOG_TRACE("UnpinPage called with page_id=" << page_id
                                                << ", is_dirty=" << is_dirty);
 
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
+    BufferPoolShard& shard = GetShard(page_id);
+    std::unique_lock<std::mutex> lock(shard.latch);
+
+    auto it = shard.page_table.find(page_id);
+    if (it == shard.page_table.end()) {
         LOG_DEBUG("UnpinPage: page " << page_id << " not in buffer pool");
         return false;
     }
 
     size_t frame_id = it->second;
-    Page* page = &pages_[frame_id];
+    Page* page = shard.frames[frame_id];
 
     if (page->GetPinCount() <= 0) {
         // pin_count已经是0了，记录一下但不报错
@@ -374,14 +669,18 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
     // 减少引用计数
     page->DecreasePinCount();
     STATS.RecordPageUnpin();
-    
-    if (is_dirty) {
+
+    if (is_dirty && disk_manager_->IsReadOnly()) {
+        // 只读方式下页面不会写回，修改只留在内存里
+        LOG_WARN("UnpinPage: page " << page_id
+                                    << " modified in a read-only database");
+    } else if (is_dirty) {
         page->SetDirty(true);  // 标记为脏页，之后需要写回磁盘
     }
 
     // 如果没人用了，可以被替换
     if (page->GetPinCount() == 0) {
-        replacer_->Unpin(frame_id);
+        shard.replacer->Unpin(frame_id);
         LOG_TRACE("UnpinPage: page " << page_id
                                      << " unpinned and added to replacer");
     }
@@ -403,12 +702,14 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
  * 3. 这是强制flush，即使页面不脏也要写
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-    std::unique_lock<std::mutex> lock(latch_);
     LOG_DEBUG("FlushPage called with page_id=" << page_id);
 
+    BufferPoolShard& shard = GetShard(page_id);
+    std::unique_lock<std::mutex> lock(shard.latch);
+
     // 检查页面是否在缓冲池中
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
+    auto it = shard.page_table.find(page_id);
+    if (it == shard.page_table.end()) {
         // 页面不在缓冲池中，检查磁盘上是否存在
         LOG_DEBUG("FlushPage: page " << page_id << " not in buffer pool");
 
@@ -429,11 +730,12 @@ bool BufferPoolManager::FlushPage(page_id_t page_id) {
 
     // 页面在缓冲池中，执行强制写回
     size_t frame_id = it->second;
-    Page* page = &pages_[frame_id];
+    Page* page = shard.frames[frame_id];
 
     LOG_DEBUG("Force flushing page " << page_id << " to disk");
     try {
-        disk_manager_->WritePage(page_id, page->GetData());
+        disk_manager_->WritePage(page_id, page->GetData(),
+                                 page->GetChecksumOffset());
         page->SetDirty(false);  // 清除脏标记
 
         LOG_DEBUG("Page " << page_id << " successfully written to disk");
@@ -445,31 +747,89 @@ bool BufferPoolManager::FlushPage(page_id_t page_id) {
     }
 }
 
+/**
+ * 获取脏页表
+ * 没有recLSN的脏页（修改没有写日志）不需要redo，不放进表里
+ */
+std::vector<std::pair<page_id_t, lsn_t>>
+BufferPoolManager::GetDirtyPageTable() {
+    std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+    for (auto& shard_ptr : shards_) {
+        BufferPoolShard& shard = *shard_ptr;
+        std::unique_lock<std::mutex> lock(shard.latch);
+        for (Page* page : shard.frames) {
+            if (page == nullptr || page->GetPageId() == INVALID_PAGE_ID ||
+                !page->IsDirty()) {
+                continue;
+            }
+            lsn_t rec_lsn = page->GetRecLSN();
+            if (rec_lsn != INVALID_LSN) {
+                dirty_pages.emplace_back(page->GetPageId(), rec_lsn);
+            }
+        }
+    }
+    return dirty_pages;
+}
+
 /**
  * 刷新所有脏页到磁盘 - 通常在系统关闭时调用
  *
- * 实现思路：遍历所有frame，找到脏页就写回磁盘
+ * 实现思路：逐个分片加锁，收集分片内所有脏页，通过WritePages批量写回
+ * （io_uring方式下一个分片只需要一次系统调用），失败时退回逐页写
  */
 void BufferPoolManager::FlushAllPages() {
-    std::unique_lock<std::mutex> lock(latch_);
     LOG_INFO("Flushing all pages");
 
     int flushed_count = 0;
     int error_count = 0;
 
-    // 遍历所有frame，找脏页写回
-    for (size_t i = 0; i < pool_size_; i++) {
-        Page* page = &pages_[i];
-        if (page->GetPageId() != INVALID_PAGE_ID && page->IsDirty()) {
-            try {
-                LOG_DEBUG("Flushing page " << page->GetPageId());
-                disk_manager_->WritePage(page->GetPageId(), page->GetData());
+    std::vector<Page*> dirty_pages;
+    std::vector<PageWriteRequest> requests;
+    for (auto& shard_ptr : shards_) {
+        BufferPoolShard& shard = *shard_ptr;
+        std::unique_lock<std::mutex> lock(shard.latch);
+
+        // 收集分片内的所有脏页，一次批量写回
+        dirty_pages.clear();
+        requests.clear();
+        for (Page* page : shard.frames) {
+            if (page == nullptr) {
+                continue;  // 已经被缩容回收的槽位
+            }
+            if (page->GetPageId() != INVALID_PAGE_ID && page->IsDirty()) {
+                dirty_pages.push_back(page);
+                requests.push_back({page->GetPageId(), page->GetData(),
+                                    page->GetChecksumOffset()});
+            }
+        }
+        if (requests.empty()) {
+            continue;
+        }
+
+        try {
+            LOG_DEBUG("Flushing " << requests.size() << " dirty pages");
+            disk_manager_->WritePages(requests);
+            for (Page* page : dirty_pages) {
                 page->SetDirty(false);
-                flushed_count++;
-            } catch (const std::exception& e) {
-                LOG_ERROR("Failed to flush page " << page->GetPageId() << ": "
-                                                  << e.what());
-                error_count++;
+            }
+            flushed_count += static_cast<int>(dirty_pages.size());
+        } catch (const std::exception& e) {
+            // 批量写失败时逐页重试，尽量多写回一些页面
+            LOG_ERROR("Batched flush failed: " << e.what()
+                                               << ", retrying page by page");
+            for (Page* page : dirty_pages) {
+                try {
+                    disk_manager_->WritePage(page->GetPageId(),
+                                             page->GetData(),
+                                             page->GetChecksumOffset());
+                    page->SetDirty(false);
+                    flushed_count++;
+                } catch (const std::exception& page_error) {
+                    LOG_ERROR("Failed to flush page " << page->GetPageId()
+                                                      << ": "
+                                                      << page_error.what());
+                    error_count++;
+                }
             }
         }
     }
@@ -479,17 +839,487 @@ void BufferPoolManager::FlushAllPages() {
 }
 
 /**
- * 寻找可以被替换的页面 - 使用LRU替换策略
+ * 启动后台写脏页线程
+ */
+void BufferPoolManager::StartBackgroundWriter(
+    const BackgroundWriterConfig& config) {
+    StopBackgroundWriter();
+    {
+        std::lock_guard<std::mutex> guard(writer_latch_);
+        writer_config_ = config;
+        writer_running_ = true;
+    }
+    writer_thread_ = std::thread(&BufferPoolManager::BackgroundWriterLoop, this);
+    LOG_INFO("Background writer started: interval="
+             << config.interval.count() << "ms, clean_ratio="
+             << config.clean_ratio
+             << ", max_pages_per_round=" << config.max_pages_per_round);
+}
+
+void BufferPoolManager::StopBackgroundWriter() {
+    {
+        std::lock_guard<std::mutex> guard(writer_latch_);
+        if (!writer_running_) {
+            return;
+        }
+        writer_running_ = false;
+    }
+    writer_cv_.notify_one();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+    LOG_INFO("Background writer stopped, " << background_writes_.load()
+                                           << " pages written");
+}
+
+void BufferPoolManager::BackgroundWriterLoop() {
+    std::unique_lock<std::mutex> lock(writer_latch_);
+    while (writer_running_) {
+        writer_cv_.wait_for(lock, writer_config_.interval, [this] {
+            return !writer_running_ || writer_kick_.load();
+        });
+        if (!writer_running_) {
+            break;
+        }
+        writer_kick_ = false;
+        lock.unlock();
+        try {
+            RunBackgroundWriterRound();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Background writer round failed: " << e.what());
+        }
+        lock.lock();
+    }
+}
+
+// 预热文件：8字节magic，uint32页面数，之后是按最近使用排序的页面ID
+static constexpr char WARMUP_FILE_MAGIC[8] = {'S', 'R', 'D', 'B',
+                                              'W', 'A', 'R', 'M'};
+
+/**
+ * 保存预热文件
+ *
+ * 实现思路：
+ * 1. 逐个分片加锁，按最近使用的顺序列出页面：先是正在被pin住的页面，
+ *    再按替换器的GetRecencyOrder，替换器给不出顺序的页面放在最后
+ * 2. 各分片没有共同的时钟，按轮流取一个的方式合并，
+ *    页面按哈希打散到分片，轮流合并接近全局的最近使用顺序
+ * 3. 先写临时文件再改名，崩溃时不会留下写了一半的文件
+ * 不读页面内容，也不影响替换器的顺序
+ */
+bool BufferPoolManager::SaveWarmupFile(const std::string& path) {
+    std::vector<std::vector<page_id_t>> shard_orders;
+    shard_orders.reserve(shards_.size());
+    size_t total = 0;
+    for (auto& shard_ptr : shards_) {
+        BufferPoolShard& shard = *shard_ptr;
+        std::unique_lock<std::mutex> lock(shard.latch);
+        std::vector<page_id_t> order;
+        order.reserve(shard.page_table.size());
+        std::unordered_map<size_t, bool> listed;
+        for (const auto& [page_id, frame_id] : shard.page_table) {
+            if (shard.frames[frame_id]->GetPinCount() > 0) {
+                order.push_back(page_id);
+                listed[frame_id] = true;
+            }
+        }
+        for (size_t frame_id : shard.replacer->GetRecencyOrder()) {
+            Page* page = shard.frames[frame_id];
+            if (page != nullptr && page->GetPageId() != INVALID_PAGE_ID &&
+                !listed[frame_id]) {
+                order.push_back(page->GetPageId());
+                listed[frame_id] = true;
+            }
+        }
+        for (const auto& [page_id, frame_id] : shard.page_table) {
+            if (!listed[frame_id]) {
+                order.push_back(page_id);
+            }
+        }
+        total += order.size();
+        shard_orders.push_back(std::move(order));
+    }
+
+    std::vector<page_id_t> page_ids;
+    page_ids.reserve(total);
+    for (size_t rank = 0; page_ids.size() < total; rank++) {
+        for (const auto& order : shard_orders) {
+            if (rank < order.size()) {
+                page_ids.push_back(order[rank]);
+            }
+        }
+    }
+
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        auto count = static_cast<uint32_t>(page_ids.size());
+        out.write(WARMUP_FILE_MAGIC, sizeof(WARMUP_FILE_MAGIC));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char*>(page_ids.data()),
+                  static_cast<std::streamsize>(page_ids.size() *
+                                               sizeof(page_id_t)));
+        if (!out.good()) {
+            LOG_ERROR("SaveWarmupFile: cannot write " << temp_path);
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("SaveWarmupFile: cannot rename " << temp_path << " to "
+                                                   << path);
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    LOG_INFO("Saved " << page_ids.size() << " page ids to warmup file "
+                      << path);
+    return true;
+}
+
+void BufferPoolManager::StartWarmup(const std::string& path) {
+    StopWarmup();
+    warmup_stop_ = false;
+    warmup_thread_ = std::thread(&BufferPoolManager::WarmupLoop, this, path);
+}
+
+void BufferPoolManager::StopWarmup() {
+    warmup_stop_ = true;
+    WaitForWarmup();
+}
+
+void BufferPoolManager::WaitForWarmup() {
+    if (warmup_thread_.joinable()) {
+        warmup_thread_.join();
+    }
+}
+
+/**
+ * 预热线程主体
+ *
+ * 实现思路：
+ * 1. 读出预热文件里的页面ID，格式不对就放弃；只保留空闲frame
+ *    装得下的最热的那一段，超出文件末尾的页面跳过
+ * 2. 按WARMUP_READ_BATCH_PAGES个一批，从最热的一批开始：
+ *    批内按页面ID排序，连续的页面由DiskManager::ReadPages合并成一次读，
+ *    读进预热线程自己的暂存区，读的时候不持有任何分片的锁
+ * 3. 逐页装进空闲frame，批内从最冷的开始装，最热的页面最后进入替换器；
+ *    只用空闲frame，缓冲池满了就停下，预热不会挤掉查询已经读进来的页面
+ * 4. 只读映射方式下frame直接指向映射，逐页FetchPage就够了
+ */
+void BufferPoolManager::WarmupLoop(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        LOG_DEBUG("Warmup: no warmup file " << path);
+        return;
+    }
+    char magic[sizeof(WARMUP_FILE_MAGIC)];
+    uint32_t count = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in.good() ||
+        std::memcmp(magic, WARMUP_FILE_MAGIC, sizeof(magic)) != 0) {
+        LOG_WARN("Warmup: " << path << " is not a warmup file");
+        return;
+    }
+    std::vector<page_id_t> page_ids(count);
+    in.read(reinterpret_cast<char*>(page_ids.data()),
+            static_cast<std::streamsize>(count * sizeof(page_id_t)));
+    page_ids.resize(static_cast<size_t>(in.gcount()) / sizeof(page_id_t));
+
+    size_t capacity = pool_size_.load() - std::min(pool_size_.load(),
+                                                   resident_pages_.load());
+    const page_id_t num_pages = disk_manager_->GetNumPages();
+    std::vector<page_id_t> hot;
+    hot.reserve(std::min(page_ids.size(), capacity));
+    for (page_id_t page_id : page_ids) {
+        if (hot.size() >= capacity) {
+            break;
+        }
+        if (page_id >= 0 && page_id < num_pages) {
+            hot.push_back(page_id);
+        }
+    }
+
+    size_t loaded = 0;
+    if (disk_manager_->IsReadOnly()) {
+        for (page_id_t page_id : hot) {
+            if (warmup_stop_.load()) {
+                break;
+            }
+            Page* page = FetchPage(page_id);
+            if (page != nullptr) {
+                UnpinPage(page_id, false);
+                loaded++;
+                warmup_pages_loaded_++;
+            }
+        }
+    } else {
+        loaded = WarmupFromDisk(hot);
+    }
+    LOG_INFO("Warmup: loaded " << loaded << " of " << page_ids.size()
+                               << " pages from " << path);
+}
+
+/**
+ * 分批读入预热的页面，返回装进缓冲池的页面数
+ *
+ * 读的时候不持有分片锁，读完之前页面可能已经被别的线程读进来、
+ * 修改、写回、换出，暂存区里的就是旧数据了。每个页面读之前记下
+ * 所在分片的installs，装入时installs变了就不用暂存区，改成FetchPage
+ */
+size_t BufferPoolManager::WarmupFromDisk(const std::vector<page_id_t>& hot) {
+    const size_t batch_size = WARMUP_READ_BATCH_PAGES;
+    std::unique_ptr<char, decltype(&std::free)> staging(
+        static_cast<char*>(
+            std::aligned_alloc(PAGE_SIZE, batch_size * PAGE_SIZE)),
+        &std::free);
+    if (staging == nullptr) {
+        LOG_ERROR("Warmup: cannot allocate the read buffer");
+        return 0;
+    }
+
+    struct Candidate {
+        page_id_t page_id;
+        size_t rank;       // 在预热文件里的位置，越小越热
+        uint64_t installs;  // 读之前分片的installs
+    };
+    size_t loaded = 0;
+    for (size_t first = 0; first < hot.size(); first += batch_size) {
+        if (warmup_stop_.load() ||
+            resident_pages_.load() >= pool_size_.load()) {
+            break;
+        }
+        size_t last = std::min(hot.size(), first + batch_size);
+
+        // 跳过已经在缓冲池里的页面，记下各分片的installs
+        std::vector<Candidate> batch;
+        batch.reserve(last - first);
+        for (size_t rank = first; rank < last; rank++) {
+            BufferPoolShard& shard = GetShard(hot[rank]);
+            std::unique_lock<std::mutex> lock(shard.latch);
+            if (shard.page_table.count(hot[rank]) == 0) {
+                batch.push_back({hot[rank], rank, shard.installs});
+            }
+        }
+        std::sort(batch.begin(), batch.end(),
+                  [](const Candidate& a, const Candidate& b) {
+                      return a.page_id < b.page_id;
+                  });
+
+        std::vector<PageReadRequest> requests;
+        requests.reserve(batch.size());
+        for (size_t i = 0; i < batch.size(); i++) {
+            requests.push_back({batch[i].page_id, staging.get() + i * PAGE_SIZE});
+        }
+        try {
+            disk_manager_->ReadPages(requests);
+        } catch (const StorageException& e) {
+            LOG_WARN("Warmup: read failed, stopping: " << e.what());
+            break;
+        }
+
+        // 从最冷的开始装，最热的页面最后进入替换器
+        std::vector<size_t> install_order(batch.size());
+        for (size_t i = 0; i < batch.size(); i++) {
+            install_order[i] = i;
+        }
+        std::sort(install_order.begin(), install_order.end(),
+                  [&batch](size_t a, size_t b) {
+                      return batch[a].rank > batch[b].rank;
+                  });
+        for (size_t i : install_order) {
+            int result = InstallWarmupPage(batch[i].page_id,
+                                           requests[i].data, batch[i].installs);
+            if (result < 0) {
+                continue;  // 这个分片的空闲frame用完了
+            }
+            if (result == 0) {
+                // 暂存区可能过期，按普通的缓存未命中重新读
+                Page* page = FetchPage(batch[i].page_id);
+                if (page == nullptr) {
+                    continue;
+                }
+                UnpinPage(batch[i].page_id, false);
+            }
+            loaded++;
+            warmup_pages_loaded_++;
+        }
+    }
+    return loaded;
+}
+
+/**
+ * 把暂存区里的一个页面装进空闲frame
+ * @return 1表示装入；0表示页面已经在缓冲池里或者暂存区可能过期；
+ *         -1表示分片没有空闲frame了
+ */
+int BufferPoolManager::InstallWarmupPage(page_id_t page_id, const char* data,
+                                         uint64_t installs) {
+    BufferPoolShard& shard = GetShard(page_id);
+    std::unique_lock<std::mutex> lock(shard.latch);
+    if (shard.page_table.count(page_id) != 0) {
+        return 0;
+    }
+    if (shard.installs != installs) {
+        return 0;
+    }
+    if (shard.free_list.empty()) {
+        return -1;
+    }
+    size_t frame_id = shard.free_list.front();
+    shard.free_list.pop_front();
+
+    Page* page = shard.frames[frame_id];
+    UpdatePage(page, page_id);
+    page->DetachData();
+    std::memcpy(page->GetData(), data, PAGE_SIZE);
+    page->MarkChecksumUnverified();
+    shard.page_table[page_id] = frame_id;
+    shard.installs++;
+    resident_pages_++;
+    shard.replacer->Unpin(frame_id);
+    STATS.UpdateBufferPoolSize(static_cast<int>(resident_pages_.load()));
+    return 1;
+}
+
+/**
+ * 启动定期保存预热文件的线程
+ * 每隔interval保存一次，进程被杀掉时也有一份不太旧的预热文件
+ */
+void BufferPoolManager::StartWarmupDump(const std::string& path,
+                                        std::chrono::milliseconds interval) {
+    StopWarmupDump();
+    {
+        std::lock_guard<std::mutex> guard(warmup_dump_latch_);
+        warmup_dump_running_ = true;
+    }
+    warmup_dump_thread_ = std::thread([this, path, interval] {
+        std::unique_lock<std::mutex> lock(warmup_dump_latch_);
+        while (warmup_dump_running_) {
+            warmup_dump_cv_.wait_for(lock, interval,
+                                     [this] { return !warmup_dump_running_; });
+            if (!warmup_dump_running_) {
+                break;
+            }
+            lock.unlock();
+            SaveWarmupFile(path);
+            lock.lock();
+        }
+    });
+    LOG_INFO("Warmup file " << path << " is saved every "
+                            << interval.count() << "ms");
+}
+
+void BufferPoolManager::StopWarmupDump() {
+    {
+        std::lock_guard<std::mutex> guard(warmup_dump_latch_);
+        if (!warmup_dump_running_) {
+            return;
+        }
+        warmup_dump_running_ = false;
+    }
+    warmup_dump_cv_.notify_one();
+    if (warmup_dump_thread_.joinable()) {
+        warmup_dump_thread_.join();
+    }
+}
+
+/**
+ * 执行一轮后台写回
+ *
+ * 实现思路：
+ * 1. 逐个分片加锁，空闲frame和未pin的干净页面都算作干净frame，
+ *    达到clean_ratio的分片跳过
+ * 2. 候选页面必须未pin（没人能在持有分片锁期间修改它）且是脏页；
+ *    设置了日志管理器时，页面LSN超过已持久化LSN的页面不能写（WAL规则）
+ * 3. 候选按recLSN从小到大取差额数量，整批写回后清除脏标记，
+ *    页面仍留在缓冲池和替换器中，LRU顺序不变
+ * 4. 一轮写回的总页数不超过max_pages_per_round
+ */
+size_t BufferPoolManager::RunBackgroundWriterRound() {
+    double clean_ratio = writer_config_.clean_ratio;
+    size_t budget = writer_config_.max_pages_per_round;
+    lsn_t persistent_lsn =
+        log_manager_ != nullptr ? log_manager_->GetPersistentLSN() : INVALID_LSN;
+
+    size_t written = 0;
+    std::vector<Page*> candidates;
+    std::vector<PageWriteRequest> requests;
+    for (auto& shard_ptr : shards_) {
+        if (written >= budget) {
+            break;
+        }
+        BufferPoolShard& shard = *shard_ptr;
+        std::unique_lock<std::mutex> lock(shard.latch);
+
+        size_t clean = shard.free_list.size();
+        candidates.clear();
+        for (Page* page : shard.frames) {
+            if (page == nullptr || page->GetPageId() == INVALID_PAGE_ID ||
+                page->GetPinCount() > 0) {
+                continue;
+            }
+            if (!page->IsDirty()) {
+                clean++;
+            } else if (log_manager_ == nullptr ||
+                       page->GetLSN() <= persistent_lsn) {
+                candidates.push_back(page);
+            }
+        }
+
+        size_t target = static_cast<size_t>(
+            std::ceil(clean_ratio * static_cast<double>(shard.pool_size)));
+        if (clean >= target || candidates.empty()) {
+            continue;
+        }
+        size_t count =
+            std::min({target - clean, candidates.size(), budget - written});
+        // recLSN为INVALID_LSN（-1）的页面排在最前面，它们不影响检查点
+        std::partial_sort(candidates.begin(), candidates.begin() + count,
+                          candidates.end(), [](Page* a, Page* b) {
+                              return a->GetRecLSN() < b->GetRecLSN();
+                          });
+        candidates.resize(count);
+
+        requests.clear();
+        for (Page* page : candidates) {
+            requests.push_back({page->GetPageId(), page->GetData(),
+                                page->GetChecksumOffset()});
+        }
+        try {
+            disk_manager_->WritePages(requests);
+        } catch (const std::exception& e) {
+            LOG_WARN("Background writer failed to write " << requests.size()
+                                                          << " pages: "
+                                                          << e.what());
+            continue;
+        }
+        for (Page* page : candidates) {
+            page->SetDirty(false);
+        }
+        written += count;
+    }
+
+    if (written > 0) {
+        background_writes_ += written;
+        LOG_DEBUG("Background writer wrote " << written << " pages");
+    }
+    return written;
+}
+
+/**
+ * 寻找可以被替换的页面
  *
+ * @param shard 所在分片
  * @return 可以被替换的frame_id，如果没有返回-1
  *
- * 实现思路：直接委托给replacer_，它会根据LRU算法选择victim
+ * 实现思路：直接委托给分片的替换器，它会根据替换算法选择victim
  */
-size_t BufferPoolManager::FindVictimPage() {
+size_t BufferPoolManager::FindVictimPage(BufferPoolShard& shard) {
     size_t victim_frame_id;
 
     // 使用替换器找一个victim frame
-    if (!replacer_->Victim(&victim_frame_id)) {
+    if (!shard.replacer->Victim(&victim_frame_id)) {
         // 没有frame可以被替换（都被pin住了）
         return static_cast<size_t>(-1);
     }
@@ -497,6 +1327,172 @@ size_t BufferPoolManager::FindVictimPage() {
     return victim_frame_id;
 }
 
+/**
+ * 为新页面准备一个frame
+ *
+ * 实现思路：
+ * 1. 有空闲frame就直接用
+ * 2. 否则找一个victim，脏页先写回磁盘
+ * 3. 从映射表里删除旧页面的记录
+ */
+bool BufferPoolManager::AcquireFrame(BufferPoolShard& shard, size_t* frame_id,
+                                     bool record_eviction) {
+    if (!shard.free_list.empty()) {
+        // 还有空闲的frame，直接用
+        *frame_id = shard.free_list.front();
+        shard.free_list.pop_front();
+        LOG_TRACE("Using free frame " << *frame_id);
+        return true;
+    }
+
+    // 没有空闲frame了，需要踢掉一个页面
+    *frame_id = FindVictimPage(shard);
+    if (*frame_id == static_cast<size_t>(-1)) {
+        return false;
+    }
+
+    Page* page = shard.frames[*frame_id];
+    if (record_eviction) {
+        STATS.RecordPageEviction();
+    }
+    LOG_TRACE("Evicting page " << page->GetPageId() << " from frame "
+                               << *frame_id);
+
+    // 如果被踢掉的页面是脏的，先写回磁盘
+    if (page->IsDirty() && page->GetPageId() != INVALID_PAGE_ID) {
+        LOG_DEBUG("Writing dirty page " << page->GetPageId() << " to disk");
+        dirty_evictions_++;
+        if (writer_running_ && !writer_kick_.exchange(true)) {
+            writer_cv_.notify_one();  // 干净的frame不够了，让后台线程提前写
+        }
+        disk_manager_->WritePage(page->GetPageId(), page->GetData(),
+                                 page->GetChecksumOffset());
+        page->SetDirty(false);
+    }
+
+    // 从映射表里删除旧页面的记录
+    if (page->GetPageId() != INVALID_PAGE_ID) {
+        shard.page_table.erase(page->GetPageId());
+        resident_pages_--;
+    }
+    return true;
+}
+
+/**
+ * 按访问策略为新页面准备frame
+ *
+ * 实现思路：
+ * 1. 读入页面数还没到启用阈值时，和普通读取一样
+ * 2. 环没满时，正常找frame，然后把它加进环
+ * 3. 环满了就看游标指向的槽位：frame里还是环自己放进去的页面、
+ *    没人pin住，就把它从替换器里拿出来直接复用（脏页先写回）
+ * 4. 槽位里的frame已经被别人用了，就正常找frame并替换掉这个槽位
+ */
+bool BufferPoolManager::AcquireRingFrame(BufferPoolShard& shard,
+                                         size_t shard_index,
+                                         BufferAccessStrategy* strategy,
+                                         page_id_t page_id,
+                                         size_t* frame_id) {
+    size_t pages_read = strategy->pages_read_++;
+    if (pages_read < strategy->activation_pages_) {
+        return AcquireFrame(shard, frame_id, true);
+    }
+
+    auto& ring = strategy->rings_[shard_index];
+    if (ring.size() < strategy->per_shard_ring_size_) {
+        if (!AcquireFrame(shard, frame_id, true)) {
+            return false;
+        }
+        ring.push_back({*frame_id, page_id});
+        return true;
+    }
+
+    size_t& cursor = strategy->cursors_[shard_index];
+    auto& slot = ring[cursor];
+    cursor = (cursor + 1) % ring.size();
+
+    Page* page =
+        slot.frame_id < shard.frames.size() ? shard.frames[slot.frame_id]
+                                            : nullptr;
+    auto it = shard.page_table.find(slot.page_id);
+    bool reusable = page != nullptr && page->GetPageId() == slot.page_id &&
+                    page->GetPinCount() == 0 &&
+                    it != shard.page_table.end() &&
+                    it->second == slot.frame_id;
+
+    if (!reusable) {
+        // 环里的frame已经被别人拿走了，正常找一个新的补进环
+        if (!AcquireFrame(shard, frame_id, true)) {
+            return false;
+        }
+        slot = {*frame_id, page_id};
+        return true;
+    }
+
+    // 复用环中的frame：从替换器中移除，脏页写回，删除旧映射
+    *frame_id = slot.frame_id;
+    shard.replacer->Remove(*frame_id);
+    STATS.RecordPageEviction();
+    if (page->IsDirty()) {
+        LOG_DEBUG("Writing dirty ring page " << page->GetPageId()
+                                             << " to disk");
+        disk_manager_->WritePage(page->GetPageId(), page->GetData(),
+                                 page->GetChecksumOffset());
+        page->SetDirty(false);
+    }
+    shard.page_table.erase(it);
+    resident_pages_--;
+    slot.page_id = page_id;
+    strategy->ring_reuses_++;
+    return true;
+}
+
+/**
+ * 创建批量读取策略
+ * 启用阈值为缓冲池大小的1/4，和PostgreSQL判断"大表"的标准一致
+ */
+std::shared_ptr<BufferAccessStrategy> BufferPoolManager::CreateBulkReadStrategy(
+    size_t ring_size) {
+    return std::make_shared<BufferAccessStrategy>(shards_.size(), ring_size,
+                                                  pool_size_.load() / 4);
+}
+
+/**
+ * 把磁盘上的页面装进frame
+ *
+ * 实现思路：
+ * 1. 只读映射方式下，没有压缩的页面让frame直接指向映射，不复制；
+ *    压缩的页面照常读出解压后的副本
+ * 2. 带批量读取策略的读取来自顺序扫描：读到的页面接近已经madvise过的
+ *    范围末尾（或者不在范围里）时，从这个页面开始再madvise
+ *    MMAP_READ_AHEAD_PAGES个页面，内核在后台把后面的页面读进页缓存
+ * 3. 其它方式读进frame自己的内存，frame之前指向映射时先恢复
+ */
+void BufferPoolManager::LoadPage(Page* page, page_id_t page_id,
+                                 BufferAccessStrategy* strategy) {
+    if (disk_manager_->IsReadOnly()) {
+        if (strategy != nullptr) {
+            page_id_t begin = strategy->advised_begin_.load();
+            page_id_t end = strategy->advised_end_.load();
+            auto window = static_cast<page_id_t>(MMAP_READ_AHEAD_PAGES);
+            if (page_id < begin || page_id + window / 2 >= end) {
+                disk_manager_->AdviseWillNeed(page_id, MMAP_READ_AHEAD_PAGES);
+                strategy->advised_begin_ = page_id;
+                strategy->advised_end_ = page_id + window;
+            }
+        }
+        const char* mapped = disk_manager_->GetMappedPage(page_id);
+        if (mapped != nullptr) {
+            page->AttachMappedData(mapped);
+            page->MarkChecksumUnverified();
+            return;
+        }
+    }
+    page->DetachData();
+    disk_manager_->ReadPage(page_id, page->GetData());
+    page->MarkChecksumUnverified();
+}
+
 /**
  * 更新页面元数据 - 重置页面到初始状态
  *
@@ -518,41 +1514,25 @@ void BufferPoolManager::UpdatePage(Page* page, page_id_t page_id) {
 }
 
 Page* BufferPoolManager::GetSpecificPage(page_id_t page_id) {
-    std::unique_lock<std::mutex> lock(latch_);
+    BufferPoolShard& shard = GetShard(page_id);
+    std::unique_lock<std::mutex> lock(shard.latch);
 
     // 首先尝试从缓冲池获取
-    auto it = page_table_.find(page_id);
-    if (it != page_table_.end()) {
+    auto it = shard.page_table.find(page_id);
+    if (it != shard.page_table.end()) {
         size_t frame_id = it->second;
-        Page* page = &pages_[frame_id];
+        Page* page = shard.frames[frame_id];
         page->IncreasePinCount();
-        replacer_->Pin(frame_id);
+        shard.replacer->Pin(frame_id);
         return page;
     }
 
     // 获取一个空闲frame
     size_t frame_id;
-    Page* page = nullptr;
-    if (!free_list_.empty()) {
-        frame_id = free_list_.front();
-        free_list_.pop_front();
-        page = &pages_[frame_id];
-    } else {
-        frame_id = FindVictimPage();
-        if (frame_id == static_cast<size_t>(-1)) {
-            return nullptr;
-        }
-        page = &pages_[frame_id];
-
-        // 如果被驱逐的页面是脏页，先写回磁盘
-        if (page->IsDirty() && page->GetPageId() != INVALID_PAGE_ID) {
-            disk_manager_->WritePage(page->GetPageId(), page->GetData());
-            page->SetDirty(false);
-        }
-        if (page->GetPageId() != INVALID_PAGE_ID) {
-            page_table_.erase(page->GetPageId());
-        }
+    if (!AcquireFrame(shard, &frame_id, false)) {
+        return nullptr;
     }
+    Page* page = shard.frames[frame_id];
 
     // 尝试从磁盘读取页面
     try {
@@ -565,23 +1545,30 @@ Page* BufferPoolManager::GetSpecificPage(page_id_t page_id) {
 
         // 检查页面是否存在，如果不存在就初始化为空页面
         if (page_id < disk_manager_->GetNumPages()) {
-            disk_manager_->ReadPage(page_id, page->GetData());
+            LoadPage(page, page_id, nullptr);
+        } else if (disk_manager_->IsReadOnly()) {
+            throw StorageException("Page " + std::to_string(page_id) +
+                                   " does not exist in read-only database");
         } else {
             // 页面不存在，初始化为空页面
             std::memset(page->GetData(), 0, PAGE_SIZE);
+            page->SetChecksumOffset(0);
             page->SetDirty(true);
         }
 
-        page_table_[page_id] = frame_id;
+        shard.page_table[page_id] = frame_id;
+        shard.installs++;
+        resident_pages_++;
         page->IncreasePinCount();
-        replacer_->Pin(frame_id);
+        shard.replacer->Pin(frame_id);
         return page;
     } catch (const std::exception& e) {
         LOG_ERROR("Failed to get specific page " << page_id << ": "
                                                  << e.what());
-        free_list_.push_back(frame_id);
+        page->SetPageId(INVALID_PAGE_ID);
+        shard.free_list.push_back(frame_id);
         return nullptr;
     }
 }
 
-}  // namespace SimpleRDBMS
\ No newline at end of file
+}  // namespace SimpleRDBMS
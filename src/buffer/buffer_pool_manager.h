@@ -8,17 +8,48 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/replacer.h"
 #include "storage/disk_manager.h"
 #include "storage/page.h"
 
 namespace SimpleRDBMS {
 
+class LogManager;
+
+/**
+ * 后台写脏页线程的配置
+ */
+struct BackgroundWriterConfig {
+    /** 两轮之间的间隔，evict到脏页时会被提前唤醒 */
+    std::chrono::milliseconds interval{200};
+
+    /** 每个分片希望保持的可直接复用（空闲或干净未pin）frame比例 */
+    double clean_ratio = 0.2;
+
+    /** 每轮最多写回的页面数，限制一轮持有分片锁的时间 */
+    size_t max_pages_per_round = 64;
+};
+
+/**
+ * 替换器工厂 - 分片模式下每个分片都需要一个独立的替换器
+ * 参数是该分片的frame数量，返回对应的Replacer实例
+ */
+using ReplacerFactory =
+    std::function<std::unique_ptr<Replacer>(size_t num_frames)>;
+
 /**
  * BufferPoolManager - 缓冲池管理器
  *
@@ -36,6 +67,17 @@ namespace SimpleRDBMS {
  * - free_list_管理空闲的frame
  * - replacer_实现LRU替换算法
  * - 通过pin_count保护正在使用的页面
+ *
+ * 分片模式：
+ * - 缓冲池可以在构造时被切分成N个相互独立的分片（shard）
+ * - 每个分片有自己的page_table、free_list、replacer和latch
+ * - 页面按照page_id的hash路由到固定的分片，不同分片上的页面访问可以并行
+ * - 分片数为1时和原来的单锁缓冲池行为完全一致
+ *
+ * 只读映射模式（磁盘管理器使用DiskIOMode::MMAP）：
+ * - 缓存未命中时frame直接指向文件映射里的页面，不复制到frame的内存，
+ *   frame只记录元数据；页面数据由操作系统的页缓存持有
+ * - NewPage/DeletePage失败，UnpinPage的脏标记被忽略，不会有页面写回
  */
 class BufferPoolManager {
    public:
@@ -50,6 +92,19 @@ class BufferPoolManager {
                       std::unique_ptr<DiskManager> disk_manager,
                       std::unique_ptr<Replacer> replacer);
 
+    /**
+     * 构造函数 - 初始化分片模式的缓冲池管理器
+     *
+     * @param pool_size 缓冲池总大小（页面数量），会尽量平均分给各个分片
+     * @param num_shards 分片数量，0会被当作1处理，超过pool_size时会被截断
+     * @param disk_manager 磁盘管理器，所有分片共享
+     * @param replacer_factory 替换器工厂，为每个分片创建独立的替换器；
+     *                         为空时默认使用LRUReplacer
+     */
+    BufferPoolManager(size_t pool_size, size_t num_shards,
+                      std::unique_ptr<DiskManager> disk_manager,
+                      ReplacerFactory replacer_factory = nullptr);
+
     /**
      * 析构函数 - 清理资源并确保数据安全
      * 会把所有脏页写回磁盘，防止数据丢失
@@ -71,6 +126,29 @@ class BufferPoolManager {
      */
     Page* FetchPage(page_id_t page_id);
 
+    /**
+     * 按指定访问策略获取页面
+     *
+     * @param page_id 要获取的页面ID
+     * @param strategy 访问策略，为nullptr时和FetchPage(page_id)完全一样
+     * @return 页面指针，失败返回nullptr
+     *
+     * 缓存未命中时优先复用策略环中的frame，见BufferAccessStrategy
+     */
+    Page* FetchPage(page_id_t page_id, BufferAccessStrategy* strategy);
+
+    /**
+     * 创建一个批量读取策略，供大表顺序扫描使用
+     *
+     * @param ring_size 环大小（页面数）
+     * @return 新的策略对象，扫描结束后释放即可
+     *
+     * 读入的页面数超过缓冲池的1/4之后才开始复用环，
+     * 所以能放进缓冲池的小表扫描不受影响
+     */
+    std::shared_ptr<BufferAccessStrategy> CreateBulkReadStrategy(
+        size_t ring_size = BufferAccessStrategy::DEFAULT_RING_SIZE);
+
     /**
      * 创建新页面 - 分配一个全新的页面
      *
@@ -85,6 +163,16 @@ class BufferPoolManager {
      */
     Page* NewPage(page_id_t* page_id);
 
+    /**
+     * 在对象预留的区段里创建新页面
+     * 表和索引用这个版本，各自的页面在文件里连续存放
+     *
+     * @param page_id 输出参数，返回新分配的页面ID
+     * @param extent 对象的区段，为空时和NewPage(page_id)一样
+     * @return 新页面的指针，pin_count=1；失败返回nullptr
+     */
+    Page* NewPage(page_id_t* page_id, ExtentReservation* extent);
+
     /**
      * 删除页面 - 从缓冲池和磁盘中删除页面
      *
@@ -122,52 +210,339 @@ class BufferPoolManager {
      */
     void FlushAllPages();
 
+    /**
+     * 获取脏页表（DPT） - 模糊检查点使用
+     * @return 所有带recLSN的脏页：页面ID -> recLSN（写回后第一次修改的LSN）
+     *
+     * 逐个分片加锁扫描，不写回任何页面，也不会阻塞其他分片的访问
+     */
+    std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable();
+
     /**
      * 获取磁盘管理器 - 主要用于访问磁盘页面数量等信息
      * @return 磁盘管理器指针
      */
     DiskManager* GetDiskManager() { return disk_manager_.get(); }
 
+    /** 是否只读映射模式，这时不能创建、修改和删除页面 */
+    bool IsReadOnly() const { return disk_manager_->IsReadOnly(); }
+
     Page* GetSpecificPage(page_id_t page_id);
 
+    /**
+     * 在线调整缓冲池大小 - 不需要重启就能扩容或缩容
+     *
+     * @param new_pool_size 新的缓冲池大小（页面数量），必须大于0
+     * @return 调整到目标大小返回true；缩容时如果被pin住的页面太多，
+     *         只能缩到部分大小，此时返回false
+     *
+     * 扩容：分配一块新的arena，把新frame平均分给各个分片
+     * 缩容：每个分片优先回收空闲frame，不够再evict未被pin的页面，
+     *       某块arena的frame全部回收后才真正把内存还给系统
+     */
+    bool Resize(size_t new_pool_size);
+
+    /** 获取缓冲池总大小（页面数量） */
+    size_t GetPoolSize() const { return pool_size_.load(); }
+
+    /** 获取分片数量 */
+    size_t GetNumShards() const { return shards_.size(); }
+
+    // ===== 后台写脏页 =====
+
+    /**
+     * 设置日志管理器 - 写回页面前检查WAL规则
+     * @param log_manager 为nullptr时不做检查
+     *
+     * 后台写线程只写回页面LSN不超过已持久化LSN的页面
+     */
+    void SetLogManager(LogManager* log_manager) { log_manager_ = log_manager; }
+
+    /**
+     * 启动后台写脏页线程
+     * @param config 写回间隔、目标干净比例和每轮上限
+     *
+     * 线程周期性地把未pin的脏页写回磁盘，让前台evict时尽量
+     * 拿到干净的victim，不用同步等待写盘。已经启动时先停掉再按新配置启动
+     */
+    void StartBackgroundWriter(const BackgroundWriterConfig& config);
+
+    /** 停止后台写脏页线程，等待正在进行的一轮结束 */
+    void StopBackgroundWriter();
+
+    /**
+     * 执行一轮后台写回
+     * @return 本轮写回的页面数
+     *
+     * 对每个分片：干净frame低于目标比例时，写回差额数量的未pin脏页，
+     * recLSN小的优先（顺便推进检查点的redo起点）。
+     * 一般由后台线程调用，测试里可以直接调用
+     */
+    size_t RunBackgroundWriterRound();
+
+    /** 后台线程累计写回的页面数 */
+    uint64_t GetBackgroundWriteCount() const {
+        return background_writes_.load();
+    }
+
+    /** evict时victim是脏页、需要前台同步写回的次数 */
+    uint64_t GetDirtyEvictionCount() const { return dirty_evictions_.load(); }
+
+    // ===== 预热 =====
+
+    /**
+     * 把当前缓存着的页面ID写到预热文件，下次启动时StartWarmup按它预热
+     * @param path 预热文件路径，先写临时文件再改名，不会留下写了一半的文件
+     * @return 写入成功返回true
+     *
+     * 页面按替换器的最近使用顺序排列，最热的在前，
+     * 缓冲池变小以后预热只读得下前面一段时，读进来的也是最热的页面
+     */
+    bool SaveWarmupFile(const std::string& path);
+
+    /**
+     * 启动后台线程，每隔interval保存一次预热文件
+     * 已经在保存时先停掉再用新的参数重新开始
+     */
+    void StartWarmupDump(const std::string& path,
+                         std::chrono::milliseconds interval);
+
+    /** 停止定期保存预热文件，不会再保存一次 */
+    void StopWarmupDump();
+
+    /**
+     * 启动后台预热线程，把预热文件里的页面读进缓冲池
+     * @param path 预热文件路径，文件不存在或者格式不对时什么都不做
+     *
+     * 不阻塞调用者，预热期间查询照常进行；最热的页面先读，
+     * 每批按页面ID排序后连续的页面合并成一次读。只用空闲的frame，
+     * 缓冲池满了就停下，不会挤掉查询已经读进来的页面。
+     * 已经在预热时先停掉再重新开始
+     */
+    void StartWarmup(const std::string& path);
+
+    /** 停止预热线程，等待正在读的页面读完 */
+    void StopWarmup();
+
+    /** 等待预热线程自己结束（读完文件里的页面或者缓冲池满了） */
+    void WaitForWarmup();
+
+    /** 预热读进缓冲池的页面数 */
+    size_t GetWarmupPagesLoaded() const { return warmup_pages_loaded_.load(); }
+
    private:
+    /**
+     * FrameArena - 一块连续分配的frame内存
+     *
+     * 页面对象按大页（2MB）对齐批量分配，并通过madvise提示内核使用
+     * 透明大页，减少大缓冲池的TLB miss。在线扩容时会追加新的arena。
+     */
+    struct FrameArena {
+        /** 原始内存起始地址（对齐后） */
+        void* memory = nullptr;
+
+        /** 分配的总字节数（向上取整到大页大小） */
+        size_t bytes = 0;
+
+        /** arena中的页面对象数组 */
+        Page* pages = nullptr;
+
+        /** arena中的页面数量 */
+        size_t count = 0;
+
+        /** 还在被分片使用的frame数量，降为0时整块释放 */
+        size_t live_frames = 0;
+    };
+
+    /**
+     * BufferPoolShard - 缓冲池分片
+     *
+     * 每个分片管理一组frame，拥有独立的映射表、空闲列表、
+     * 替换器和互斥锁。frame_id在分片内部从0开始编号。
+     */
+    struct BufferPoolShard {
+        /** 分片内可用的frame数量（不含已回收的槽位） */
+        size_t pool_size = 0;
+
+        /** frame_id到页面对象的映射，缩容回收掉的槽位为nullptr */
+        std::vector<Page*> frames;
+
+        /** 缩容回收掉的frame_id，扩容时优先复用 */
+        std::vector<size_t> retired_slots;
+
+        /** 本分片的页面替换器 */
+        std::unique_ptr<Replacer> replacer;
+
+        /** 本分片的页面表 - page_id到分片内frame_id的映射 */
+        std::unordered_map<page_id_t, size_t> page_table;
+
+        /** 本分片的空闲frame列表 */
+        std::list<size_t> free_list;
+
+        /** 本分片的互斥锁，只保护本分片的数据结构 */
+        std::mutex latch;
+
+        /** 页面装进本分片的次数，预热用它判断暂存区里的数据是否过期 */
+        uint64_t installs = 0;
+    };
+
     // ===== 核心数据结构 =====
 
     /** 缓冲池大小 - 表示内存中最多能缓存多少个页面 */
-    size_t pool_size_;
+    std::atomic<size_t> pool_size_;
 
-    /** 页面数组 - 真正的内存缓冲区，每个元素是一个4KB的页面 */
-    Page* pages_;
+    /** 页面内存 - 所有分片的frame都来自这里的arena */
+    std::vector<FrameArena> arenas_;
 
-    /** 磁盘管理器 - 负责实际的磁盘读写操作 */
+    /** 磁盘管理器 - 负责实际的磁盘读写操作，所有分片共享 */
     std::unique_ptr<DiskManager> disk_manager_;
 
-    /** 页面替换器 - 实现LRU等替换算法，决定哪个页面被踢出内存 */
-    std::unique_ptr<Replacer> replacer_;
+    // ===== 分片结构 =====
+
+    /** 分片数组 - 页面按page_id的hash路由到其中一个分片 */
+    std::vector<std::unique_ptr<BufferPoolShard>> shards_;
+
+    /** 当前驻留在缓冲池中的页面总数，用于统计上报 */
+    std::atomic<size_t> resident_pages_{0};
 
-    // ===== 映射和管理结构 =====
+    /** 扩缩容锁 - 串行化Resize，并保护arenas_ */
+    std::mutex resize_latch_;
 
-    /** 页面表 - 维护page_id到frame_id的映射关系
-     *  这是缓冲池的核心索引，通过page_id快速找到页面在内存中的位置 */
-    std::unordered_map<page_id_t, size_t> page_table_;
+    // ===== 后台写脏页 =====
 
-    /** 空闲列表 - 记录哪些frame当前是空闲的，可以直接使用
-     *  优先使用空闲frame，避免不必要的页面替换 */
-    std::list<size_t> free_list_;
+    /** 日志管理器，用于WAL检查，可以为空 */
+    LogManager* log_manager_ = nullptr;
 
-    // ===== 并发控制 =====
+    /** 后台写线程及其配置 */
+    std::thread writer_thread_;
+    BackgroundWriterConfig writer_config_;
+
+    /** 配合writer_cv_唤醒后台线程，启停时修改writer_running_要持有它 */
+    std::mutex writer_latch_;
+    std::condition_variable writer_cv_;
+    std::atomic<bool> writer_running_{false};
+
+    /** 前台evict到脏页时置位，后台线程被唤醒后立即开始下一轮 */
+    std::atomic<bool> writer_kick_{false};
+
+    std::atomic<uint64_t> background_writes_{0};
+    std::atomic<uint64_t> dirty_evictions_{0};
+
+    // ===== 预热 =====
+
+    /** 预热线程，warmup_stop_置位后尽快退出 */
+    std::thread warmup_thread_;
+    std::atomic<bool> warmup_stop_{false};
+    std::atomic<size_t> warmup_pages_loaded_{0};
+
+    /** 预热线程主体：读预热文件，分批读入页面 */
+    void WarmupLoop(const std::string& path);
+
+    /** 把最热的一段页面分批读进空闲frame，返回读入的页面数 */
+    size_t WarmupFromDisk(const std::vector<page_id_t>& hot);
+
+    /**
+     * 把预热读到的一个页面装进空闲frame
+     * @param installs 读之前页面所在分片的installs，变了说明数据可能过期
+     * @return 1装入，0没有装入（已经在缓冲池或者数据可能过期），
+     *         -1分片没有空闲frame
+     */
+    int InstallWarmupPage(page_id_t page_id, const char* data,
+                          uint64_t installs);
 
-    /** 互斥锁 - 保护缓冲池的并发访问安全
-     *  所有public方法都会获取这个锁，确保线程安全 */
-    std::mutex latch_;
+    /** 定期保存预热文件的线程 */
+    std::thread warmup_dump_thread_;
+    std::mutex warmup_dump_latch_;
+    std::condition_variable warmup_dump_cv_;
+    bool warmup_dump_running_ = false;
 
     // ===== 辅助方法 =====
 
     /**
-     * 寻找victim页面 - 使用LRU算法找到可以被替换的页面
+     * 初始化分片 - 把页面数组切分给各个分片并创建替换器
+     * @param num_shards 分片数量
+     * @param replacer_factory 替换器工厂
+     */
+    void InitShards(size_t num_shards, const ReplacerFactory& replacer_factory);
+
+    /**
+     * 分配一块新的arena
+     * @param count 页面数量
+     * @return 新arena的描述信息，分配失败抛出std::bad_alloc
+     */
+    static FrameArena AllocateArena(size_t count);
+
+    /**
+     * 释放arena - 析构其中的页面对象并归还内存
+     * @param arena 要释放的arena
+     */
+    static void FreeArena(FrameArena& arena);
+
+    /**
+     * 把arena中的frame平均分给各个分片
+     * @param arena_index arena在arenas_中的下标
+     */
+    void DistributeArena(size_t arena_index);
+
+    /**
+     * 从分片中回收最多count个frame
+     * @param shard 目标分片
+     * @param count 希望回收的数量
+     * @return 实际回收的数量
+     */
+    size_t RetireFrames(BufferPoolShard& shard, size_t count);
+
+    /**
+     * 根据page_id找到它所属的分片
+     * @param page_id 页面ID
+     * @return 对应分片的引用
+     */
+    BufferPoolShard& GetShard(page_id_t page_id);
+
+    /**
+     * 根据page_id计算分片下标
+     */
+    size_t GetShardIndex(page_id_t page_id) const;
+
+    /**
+     * 按访问策略为新页面准备frame
+     * @param shard 所在分片，调用者必须持有shard.latch
+     * @param shard_index 分片下标
+     * @param strategy 访问策略
+     * @param page_id 要读入的页面ID，会记录到环中
+     * @param frame_id 输出参数，返回可用的frame_id
+     * @return 成功找到frame返回true
+     *
+     * 环中的frame仍然是本策略读入的页面且没被pin时直接复用，
+     * 否则走AcquireFrame并把新frame放进环
+     */
+    bool AcquireRingFrame(BufferPoolShard& shard, size_t shard_index,
+                          BufferAccessStrategy* strategy, page_id_t page_id,
+                          size_t* frame_id);
+
+    /**
+     * 寻找victim页面 - 使用分片的替换器找到可以被替换的页面
+     * @param shard 所在分片，调用者必须持有shard.latch
      * @return 可以被替换的frame_id，如果所有页面都被pin住则返回-1
      */
-    size_t FindVictimPage();
+    size_t FindVictimPage(BufferPoolShard& shard);
+
+    /**
+     * 为新页面准备一个frame - 优先使用空闲frame，否则evict一个victim
+     * @param shard 所在分片，调用者必须持有shard.latch
+     * @param frame_id 输出参数，返回可用的frame_id
+     * @param record_eviction 发生evict时是否记录统计
+     * @return 成功找到frame返回true，所有页面都被pin住返回false
+     *
+     * 如果victim是脏页会先写回磁盘，并从映射表中删除旧页面
+     */
+    bool AcquireFrame(BufferPoolShard& shard, size_t* frame_id,
+                      bool record_eviction);
+
+    /**
+     * 后台写线程主循环 - 每隔interval执行一轮，被唤醒时提前执行
+     */
+    void BackgroundWriterLoop();
 
     /**
      * 更新页面元数据 - 重置页面到初始状态
@@ -177,6 +552,14 @@ class BufferPoolManager {
      * 主要用于页面复用时的清理工作
      */
     void UpdatePage(Page* page, page_id_t page_id);
+
+    /**
+     * 把磁盘上的页面装进frame，只读映射模式下尽量直接指向映射
+     * @param strategy 顺序扫描的访问策略，映射模式下据此madvise预读
+     * @throws StorageException 页面不存在或者读取失败
+     */
+    void LoadPage(Page* page, page_id_t page_id,
+                  BufferAccessStrategy* strategy);
 };
 
 }  // namespace SimpleRDBMS
\ No newline at end of file
@@ -0,0 +1,166 @@
+/*
+ * 文件: clock_replacer.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: CLOCK页面替换算法实现，使用访问位和时钟指针近似LRU
+ */
+
+#include "buffer/clock_replacer.h"
+
+#include <algorithm>
+
+namespace SimpleRDBMS {
+
+/**
+ * 构造函数 - 初始化环形数组
+ * @param num_pages 缓冲池中页面的总数量
+ */
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : in_replacer_(num_pages, false),
+      ref_bits_(num_pages, false),
+      hand_(0),
+      size_(0) {}
+
+/**
+ * Pin操作 - 将frame从可替换集合中移除
+ * @param frame_id 要pin的frame ID
+ *
+ * 实现思路：
+ * 1. 如果frame在可替换集合中，移除并减少计数
+ * 2. 设置访问位，表示最近被访问过
+ */
+void ClockReplacer::Pin(size_t frame_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+    EnsureFrame(frame_id);
+
+    if (in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = false;
+        size_--;
+    }
+    ref_bits_[frame_id] = true;
+}
+
+/**
+ * Unpin操作 - 将frame加入可替换集合
+ * @param frame_id 要unpin的frame ID
+ *
+ * 实现思路：
+ * 1. 已经在集合中就不重复添加
+ * 2. 访问位保持为1，这样刚用完的页面不会马上被替换
+ */
+void ClockReplacer::Unpin(size_t frame_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+    EnsureFrame(frame_id);
+
+    if (!in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = true;
+        ref_bits_[frame_id] = true;
+        size_++;
+    }
+}
+
+/**
+ * Victim操作 - 转动时钟指针选择victim
+ * @param frame_id 输出参数，返回被选中的frame ID
+ * @return 是否成功找到可替换的页面
+ *
+ * 实现思路：
+ * 1. 没有可替换frame时直接返回false
+ * 2. 从指针位置开始扫描，访问位为1的frame清零后跳过
+ * 3. 遇到可替换且访问位为0的frame就选中它
+ * 4. 最多转两圈一定能找到（第一圈把所有访问位清零）
+ */
+bool ClockReplacer::Victim(size_t* frame_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    if (size_ == 0 || in_replacer_.empty()) {
+        return false;
+    }
+
+    size_t num_frames = in_replacer_.size();
+    for (size_t step = 0; step < 2 * num_frames + 1; step++) {
+        size_t current = hand_;
+        hand_ = (hand_ + 1) % num_frames;
+
+        if (!in_replacer_[current]) {
+            continue;
+        }
+        if (ref_bits_[current]) {
+            // 给第二次机会
+            ref_bits_[current] = false;
+            continue;
+        }
+
+        in_replacer_[current] = false;
+        size_--;
+        *frame_id = current;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Size操作 - 获取当前可替换页面的数量
+ */
+size_t ClockReplacer::Size() const {
+    std::unique_lock<std::mutex> lock(latch_);
+    return size_;
+}
+
+/**
+ * SetCapacity操作 - 调整环的大小
+ * @param num_frames 新的frame数量
+ *
+ * 缩小时被截掉的frame如果还在集合中要扣掉计数
+ */
+void ClockReplacer::SetCapacity(size_t num_frames) {
+    std::unique_lock<std::mutex> lock(latch_);
+    for (size_t i = num_frames; i < in_replacer_.size(); i++) {
+        if (in_replacer_[i]) {
+            size_--;
+        }
+    }
+    in_replacer_.resize(num_frames, false);
+    ref_bits_.resize(num_frames, false);
+    if (hand_ >= num_frames) {
+        hand_ = 0;
+    }
+}
+
+/**
+ * 确保frame_id在数组范围内
+ * 正常情况下缓冲池会先调用SetCapacity，这里只是保护性检查
+ */
+void ClockReplacer::EnsureFrame(size_t frame_id) {
+    if (frame_id >= in_replacer_.size()) {
+        in_replacer_.resize(frame_id + 1, false);
+        ref_bits_.resize(frame_id + 1, false);
+    }
+}
+
+/**
+ * 按最近使用到最久未使用的顺序列出可替换的frame
+ *
+ * 时钟算法没有精确的访问顺序，用Victim会选中的顺序近似：
+ * 从指针位置往前，先是访问位为0的frame，再是访问位为1的frame，
+ * 把这个顺序反过来就是近似的最近使用顺序
+ */
+std::vector<size_t> ClockReplacer::GetRecencyOrder() const {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    std::vector<size_t> order;
+    order.reserve(size_);
+    size_t num_frames = in_replacer_.size();
+    for (bool referenced : {false, true}) {
+        for (size_t step = 0; step < num_frames; step++) {
+            size_t current = (hand_ + step) % num_frames;
+            if (in_replacer_[current] && ref_bits_[current] == referenced) {
+                order.push_back(current);
+            }
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+}  // namespace SimpleRDBMS
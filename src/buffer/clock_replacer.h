@@ -0,0 +1,95 @@
+/*
+ * 文件: clock_replacer.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: CLOCK页面替换算法头文件，用环形数组和访问位近似LRU，
+ *       Pin/Unpin只需要修改两个标志位，不需要链表操作
+ */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * CLOCK页面替换器类
+ *
+ * 核心设计思路：
+ * - 所有frame排成一个环，时钟指针在环上转动
+ * - 每个frame有一个访问位（reference bit），被访问时置1
+ * - 选victim时指针扫过的frame如果访问位是1就清零继续走（给第二次机会），
+ *   遇到访问位为0且可替换的frame就选它
+ * - 和LRUReplacer相比，Pin/Unpin都是O(1)的标志位修改，没有std::list的
+ *   splice和哈希表查找，热路径上的开销更小
+ */
+class ClockReplacer : public Replacer {
+   public:
+    /**
+     * 构造函数
+     * @param num_pages 缓冲池中页面的总数量
+     */
+    explicit ClockReplacer(size_t num_pages);
+
+    ~ClockReplacer() override = default;
+
+    /**
+     * Pin操作 - 页面被访问，从可替换集合中移除并设置访问位
+     * @param frame_id 要pin的frame ID
+     */
+    void Pin(size_t frame_id) override;
+
+    /**
+     * Unpin操作 - 页面可以被替换，加入可替换集合
+     * @param frame_id 要unpin的frame ID
+     */
+    void Unpin(size_t frame_id) override;
+
+    /**
+     * Victim操作 - 转动时钟指针选择一个页面进行替换
+     * @param frame_id 输出参数，返回被选中的frame ID
+     * @return 是否成功找到可替换的页面
+     */
+    bool Victim(size_t* frame_id) override;
+
+    /**
+     * 获取当前可替换页面的数量
+     * @return 在replacer中的页面数量
+     */
+    size_t Size() const override;
+
+    /**
+     * 按最近使用到最久未使用的顺序列出可替换的frame
+     */
+    std::vector<size_t> GetRecencyOrder() const override;
+
+    /**
+     * 调整环的大小，缓冲池扩缩容时调用
+     * @param num_frames 新的frame数量
+     */
+    void SetCapacity(size_t num_frames) override;
+
+   private:
+    // frame是否在可替换集合中
+    std::vector<bool> in_replacer_;
+
+    // 访问位，被访问过的frame在被扫过一次之前不会被替换
+    std::vector<bool> ref_bits_;
+
+    // 时钟指针的当前位置
+    size_t hand_;
+
+    // 可替换frame的数量
+    size_t size_;
+
+    // 互斥锁：保护数据结构的并发访问
+    mutable std::mutex latch_;
+
+    // 确保frame_id在数组范围内，必要时扩容
+    void EnsureFrame(size_t frame_id);
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,167 @@
+/*
+ * 文件: lru_k_replacer.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: LRU-K页面替换算法实现
+ */
+
+#include "buffer/lru_k_replacer.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * 构造函数
+ * @param num_pages 缓冲池中页面的总数量
+ * @param k 统计的访问次数
+ */
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : k_(k == 0 ? 1 : k), current_timestamp_(0) {
+    history_.reserve(num_pages);
+}
+
+/**
+ * Pin操作 - 记录访问并移出可替换集合
+ * @param frame_id 要pin的frame ID
+ *
+ * 实现思路：
+ * 1. 如果frame当前可替换，先从集合中移除（排序键马上要变）
+ * 2. 追加一次访问时间，只保留最近K次
+ */
+void LRUKReplacer::Pin(size_t frame_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    FrameHistory& history = history_[frame_id];
+    if (history.evictable) {
+        RemoveFromSets(frame_id, history);
+        history.evictable = false;
+    }
+
+    history.accesses.push_back(current_timestamp_++);
+    if (history.accesses.size() > k_) {
+        history.accesses.pop_front();
+    }
+}
+
+/**
+ * Unpin操作 - 加入可替换集合
+ * @param frame_id 要unpin的frame ID
+ *
+ * 实现思路：
+ * 1. 已经可替换就不重复添加
+ * 2. 访问不足K次的进cold_set_，否则进hot_set_
+ */
+void LRUKReplacer::Unpin(size_t frame_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    FrameHistory& history = history_[frame_id];
+    if (history.evictable) {
+        return;
+    }
+    if (history.accesses.empty()) {
+        // 没有访问记录的frame（比如直接unpin的），当作刚访问过一次
+        history.accesses.push_back(current_timestamp_++);
+    }
+
+    history.evictable = true;
+    if (history.accesses.size() < k_) {
+        cold_set_.insert(KeyOf(frame_id, history));
+    } else {
+        hot_set_.insert(KeyOf(frame_id, history));
+    }
+}
+
+/**
+ * Victim操作 - 选择backward K-distance最大的frame
+ * @param frame_id 输出参数
+ * @return 是否成功找到可替换的页面
+ *
+ * 实现思路：
+ * 1. 访问不足K次的frame距离为无穷大，优先从cold_set_中选最早访问的
+ * 2. 否则从hot_set_中选倒数第K次访问最早的
+ * 3. 被选中的frame清空访问历史，下一个页面重新开始计数
+ */
+bool LRUKReplacer::Victim(size_t* frame_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    std::set<SetKey>* source = nullptr;
+    if (!cold_set_.empty()) {
+        source = &cold_set_;
+    } else if (!hot_set_.empty()) {
+        source = &hot_set_;
+    } else {
+        return false;
+    }
+
+    auto it = source->begin();
+    *frame_id = it->second;
+    source->erase(it);
+    history_.erase(*frame_id);
+    return true;
+}
+
+/**
+ * Size操作 - 获取当前可替换页面的数量
+ */
+size_t LRUKReplacer::Size() const {
+    std::unique_lock<std::mutex> lock(latch_);
+    return cold_set_.size() + hot_set_.size();
+}
+
+/**
+ * Remove操作 - 移除frame并清空访问历史
+ * 新页面会从零开始计数，不会继承旧页面的访问记录
+ */
+void LRUKReplacer::Remove(size_t frame_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    auto it = history_.find(frame_id);
+    if (it == history_.end()) {
+        return;
+    }
+    if (it->second.evictable) {
+        RemoveFromSets(frame_id, it->second);
+    }
+    history_.erase(it);
+}
+
+/**
+ * 计算frame的排序键
+ * 访问记录的最早一项：不足K次时是第一次访问，满K次时就是倒数第K次访问
+ */
+LRUKReplacer::SetKey LRUKReplacer::KeyOf(size_t frame_id,
+                                         const FrameHistory& history) const {
+    return SetKey(history.accesses.front(), frame_id);
+}
+
+/**
+ * 把frame从所在的可替换集合中移除
+ */
+void LRUKReplacer::RemoveFromSets(size_t frame_id,
+                                  const FrameHistory& history) {
+    SetKey key = KeyOf(frame_id, history);
+    if (history.accesses.size() < k_) {
+        cold_set_.erase(key);
+    } else {
+        hot_set_.erase(key);
+    }
+}
+
+/**
+ * 按最近使用到最久未使用的顺序列出可替换的frame
+ * Victim先选cold_set_再选hot_set_，各自从小到大，这里把整个顺序反过来
+ */
+std::vector<size_t> LRUKReplacer::GetRecencyOrder() const {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    std::vector<size_t> order;
+    order.reserve(cold_set_.size() + hot_set_.size());
+    for (auto it = hot_set_.rbegin(); it != hot_set_.rend(); ++it) {
+        order.push_back(it->second);
+    }
+    for (auto it = cold_set_.rbegin(); it != cold_set_.rend(); ++it) {
+        order.push_back(it->second);
+    }
+    return order;
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,113 @@
+/*
+ * 文件: lru_k_replacer.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: LRU-K页面替换算法头文件，按照倒数第K次访问时间选择victim，
+ *       只被访问过一次的扫描页面会优先被替换
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * LRU-K页面替换器类
+ *
+ * 核心设计思路：
+ * - 每个frame记录最近K次访问的逻辑时间戳
+ * - backward K-distance = 当前时间 - 倒数第K次访问时间
+ * - 访问次数不足K次的frame距离视为无穷大，优先被替换；
+ *   它们之间按最早一次访问时间做FIFO
+ * - 大表顺序扫描的页面只会被访问一次，所以不会把被反复访问的
+ *   B+树内部页面挤出缓冲池
+ *
+ * 数据结构组合：
+ * - history_：frame_id -> 最近K次访问时间
+ * - cold_set_：访问不足K次的可替换frame，按最早访问时间排序
+ * - hot_set_：访问满K次的可替换frame，按倒数第K次访问时间排序
+ */
+class LRUKReplacer : public Replacer {
+   public:
+    /**
+     * 构造函数
+     * @param num_pages 缓冲池中页面的总数量
+     * @param k 统计的访问次数，默认为2（即LRU-2）
+     */
+    explicit LRUKReplacer(size_t num_pages, size_t k = 2);
+
+    ~LRUKReplacer() override = default;
+
+    /**
+     * Pin操作 - 记录一次访问，并将frame从可替换集合中移除
+     * @param frame_id 要pin的frame ID
+     */
+    void Pin(size_t frame_id) override;
+
+    /**
+     * Unpin操作 - 将frame按照访问历史加入对应的可替换集合
+     * @param frame_id 要unpin的frame ID
+     */
+    void Unpin(size_t frame_id) override;
+
+    /**
+     * Victim操作 - 选择backward K-distance最大的frame
+     * @param frame_id 输出参数，返回被选中的frame ID
+     * @return 是否成功找到可替换的页面
+     */
+    bool Victim(size_t* frame_id) override;
+
+    /**
+     * 获取当前可替换页面的数量
+     */
+    size_t Size() const override;
+
+    /**
+     * 按最近使用到最久未使用的顺序列出可替换的frame
+     */
+    std::vector<size_t> GetRecencyOrder() const override;
+
+    /**
+     * 移除frame并清空它的访问历史
+     * @param frame_id 要移除的frame ID
+     */
+    void Remove(size_t frame_id) override;
+
+   private:
+    using SetKey = std::pair<uint64_t, size_t>;  // (时间戳, frame_id)
+
+    // 每个frame的访问记录
+    struct FrameHistory {
+        std::deque<uint64_t> accesses;  // 最近K次访问时间，front最早
+        bool evictable = false;
+    };
+
+    // frame在可替换集合中的排序键
+    SetKey KeyOf(size_t frame_id, const FrameHistory& history) const;
+
+    // 把frame从它所在的可替换集合中移除
+    void RemoveFromSets(size_t frame_id, const FrameHistory& history);
+
+    size_t k_;
+
+    // 逻辑时钟，每次访问加1
+    uint64_t current_timestamp_;
+
+    std::unordered_map<size_t, FrameHistory> history_;
+    std::set<SetKey> cold_set_;
+    std::set<SetKey> hot_set_;
+
+    // 互斥锁：保护数据结构的并发访问
+    mutable std::mutex latch_;
+};
+
+}  // namespace SimpleRDBMS
@@ -140,4 +140,24 @@ size_t LRUReplacer::Size() const {
     return lru_list_.size();
 }
 
-}  // namespace SimpleRDBMS
\ No newline at end of file
+/**
+ * SetCapacity操作 - 调整可管理的页面数量上限
+ * @param num_frames 新的页面数量上限
+ *
+ * 缩容时已经在列表里的frame由缓冲池自己负责移除，这里只更新上限
+ */
+void LRUReplacer::SetCapacity(size_t num_frames) {
+    std::unique_lock<std::mutex> lock(latch_);
+    num_pages_ = num_frames;
+}
+
+/**
+ * 按最近使用到最久未使用的顺序列出可替换的frame
+ * 链表尾部是最近使用的，从尾部往头部走
+ */
+std::vector<size_t> LRUReplacer::GetRecencyOrder() const {
+    std::unique_lock<std::mutex> lock(latch_);
+    return std::vector<size_t>(lru_list_.rbegin(), lru_list_.rend());
+}
+
+}  // namespace SimpleRDBMS
@@ -10,6 +10,7 @@
 #include <list>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/replacer.h"
 
@@ -74,6 +75,17 @@ class LRUReplacer : public Replacer {
      */
     size_t Size() const override;
 
+    /**
+     * 按最近使用到最久未使用的顺序列出可替换的frame
+     */
+    std::vector<size_t> GetRecencyOrder() const override;
+
+    /**
+     * 调整可管理的页面数量上限，缓冲池扩缩容时调用
+     * @param num_frames 新的页面数量上限
+     */
+    void SetCapacity(size_t num_frames) override;
+
    private:
     // 缓冲池中页面的总数量，用于容量检查
     size_t num_pages_;
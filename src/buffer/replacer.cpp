@@ -0,0 +1,68 @@
+/*
+ * 文件: replacer.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 替换器的创建和算法名称解析
+ */
+
+#include "buffer/replacer.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_q_replacer.h"
+
+namespace SimpleRDBMS {
+
+bool ParseReplacerType(const std::string& name, ReplacerType* type) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    if (lower == "lru") {
+        *type = ReplacerType::LRU;
+    } else if (lower == "clock") {
+        *type = ReplacerType::CLOCK;
+    } else if (lower == "lru-k" || lower == "lru_k" || lower == "lruk") {
+        *type = ReplacerType::LRU_K;
+    } else if (lower == "2q" || lower == "two_q") {
+        *type = ReplacerType::TWO_Q;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* ReplacerTypeToString(ReplacerType type) {
+    switch (type) {
+        case ReplacerType::LRU:
+            return "lru";
+        case ReplacerType::CLOCK:
+            return "clock";
+        case ReplacerType::LRU_K:
+            return "lru-k";
+        case ReplacerType::TWO_Q:
+            return "2q";
+    }
+    return "lru";
+}
+
+std::unique_ptr<Replacer> CreateReplacer(ReplacerType type, size_t num_frames,
+                                         size_t lru_k) {
+    switch (type) {
+        case ReplacerType::CLOCK:
+            return std::make_unique<ClockReplacer>(num_frames);
+        case ReplacerType::LRU_K:
+            return std::make_unique<LRUKReplacer>(num_frames, lru_k);
+        case ReplacerType::TWO_Q:
+            return std::make_unique<TwoQReplacer>(num_frames);
+        case ReplacerType::LRU:
+        default:
+            return std::make_unique<LRUReplacer>(num_frames);
+    }
+}
+
+}  // namespace SimpleRDBMS
@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "common/config.h"
 
 namespace SimpleRDBMS {
@@ -76,6 +80,65 @@ class Replacer {
      * - 调试和性能分析
      */
     virtual size_t Size() const = 0;
+
+    /**
+     * SetCapacity操作 - 调整替换器能管理的frame数量上限
+     * @param num_frames 新的frame数量
+     *
+     * 缓冲池在线扩缩容时调用，默认实现什么都不做
+     */
+    virtual void SetCapacity(size_t num_frames) { (void)num_frames; }
+
+    /**
+     * Remove操作 - 把frame从替换器中彻底移除，不计为一次访问
+     * @param frame_id 要移除的frame ID
+     *
+     * frame不经过Victim就被换成别的页面时调用（删除页面、扫描环复用），
+     * 默认实现等同于Pin，记录访问历史的替换器需要同时清空历史
+     */
+    virtual void Remove(size_t frame_id) { Pin(frame_id); }
+
+    /**
+     * GetRecencyOrder操作 - 按替换顺序的反方向列出可替换的frame
+     * @return frame ID，最不会被替换（最近使用）的在前
+     *
+     * 缓冲池保存预热文件时用它给页面排序，默认实现返回空，
+     * 调用者按自己的顺序处理
+     */
+    virtual std::vector<size_t> GetRecencyOrder() const { return {}; }
 };
 
-}  // namespace SimpleRDBMS
\ No newline at end of file
+/**
+ * 替换算法类型 - 用于从配置中选择缓冲池使用的替换器
+ */
+enum class ReplacerType {
+    LRU = 0,  // 最近最少使用，默认
+    CLOCK,    // 时钟算法，Pin/Unpin开销最小
+    LRU_K,    // LRU-K，抗顺序扫描
+    TWO_Q     // 2Q，抗顺序扫描
+};
+
+/**
+ * 解析替换算法名称
+ * @param name 算法名称：lru / clock / lru-k / 2q（不区分大小写）
+ * @param type 输出参数，解析结果
+ * @return 名称合法返回true
+ */
+bool ParseReplacerType(const std::string& name, ReplacerType* type);
+
+/**
+ * 获取替换算法的名称，和ParseReplacerType互为逆操作
+ */
+const char* ReplacerTypeToString(ReplacerType type);
+
+/**
+ * 创建替换器
+ * @param type 替换算法类型
+ * @param num_frames 替换器管理的frame数量
+ * @param lru_k LRU-K算法中的K值，其他算法忽略
+ * @return 新创建的替换器
+ */
+std::unique_ptr<Replacer> CreateReplacer(ReplacerType type, size_t num_frames,
+                                         size_t lru_k = 2);
+
+}  // namespace SimpleRDBMS
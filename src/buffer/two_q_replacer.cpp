@@ -0,0 +1,165 @@
+/*
+ * 文件: two_q_replacer.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 2Q页面替换算法实现
+ */
+
+#include "buffer/two_q_replacer.h"
+
+#include <iterator>
+
+namespace SimpleRDBMS {
+
+/**
+ * 构造函数
+ * @param num_pages 缓冲池中页面的总数量
+ * @param a1_ratio A1队列占容量的比例
+ */
+TwoQReplacer::TwoQReplacer(size_t num_pages, double a1_ratio)
+    : a1_ratio_(a1_ratio), capacity_(num_pages) {
+    if (a1_ratio_ <= 0.0 || a1_ratio_ >= 1.0) {
+        a1_ratio_ = 0.25;
+    }
+}
+
+/**
+ * Pin操作 - 记录访问并移出可替换队列
+ * @param frame_id 要pin的frame ID
+ *
+ * 实现思路：
+ * 1. 如果frame在某个队列里，把它摘下来
+ * 2. 访问次数加1，第二次访问之后Unpin时会进入Am
+ */
+void TwoQReplacer::Pin(size_t frame_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    FrameState& state = states_[frame_id];
+    if (state.evictable) {
+        if (state.in_am) {
+            am_list_.erase(state.pos);
+        } else {
+            a1_list_.erase(state.pos);
+        }
+        state.evictable = false;
+    }
+    if (state.accesses < 2) {
+        state.accesses++;
+    }
+}
+
+/**
+ * Unpin操作 - 放入对应的队列
+ * @param frame_id 要unpin的frame ID
+ *
+ * 实现思路：
+ * 1. 只访问过一次的放到A1尾部
+ * 2. 访问过多次的放到Am尾部（最近使用位置）
+ */
+void TwoQReplacer::Unpin(size_t frame_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    FrameState& state = states_[frame_id];
+    if (state.evictable) {
+        return;
+    }
+
+    state.evictable = true;
+    state.in_am = state.accesses >= 2;
+    if (state.in_am) {
+        am_list_.push_back(frame_id);
+        state.pos = std::prev(am_list_.end());
+    } else {
+        a1_list_.push_back(frame_id);
+        state.pos = std::prev(a1_list_.end());
+    }
+}
+
+/**
+ * Victim操作 - 选择victim
+ * @param frame_id 输出参数
+ * @return 是否成功找到可替换的页面
+ *
+ * 实现思路：
+ * 1. A1超过阈值或者Am为空时，淘汰A1头部（最早进入的）
+ * 2. 否则淘汰Am头部（最久未使用的）
+ * 3. 被淘汰的frame清空状态，新页面从A1重新开始
+ */
+bool TwoQReplacer::Victim(size_t* frame_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    std::list<size_t>* source = nullptr;
+    if (!a1_list_.empty() &&
+        (a1_list_.size() > A1Limit() || am_list_.empty())) {
+        source = &a1_list_;
+    } else if (!am_list_.empty()) {
+        source = &am_list_;
+    } else {
+        return false;
+    }
+
+    *frame_id = source->front();
+    source->pop_front();
+    states_.erase(*frame_id);
+    return true;
+}
+
+/**
+ * Size操作 - 获取当前可替换页面的数量
+ */
+size_t TwoQReplacer::Size() const {
+    std::unique_lock<std::mutex> lock(latch_);
+    return a1_list_.size() + am_list_.size();
+}
+
+/**
+ * Remove操作 - 移除frame并清空访问次数
+ */
+void TwoQReplacer::Remove(size_t frame_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    auto it = states_.find(frame_id);
+    if (it == states_.end()) {
+        return;
+    }
+    if (it->second.evictable) {
+        if (it->second.in_am) {
+            am_list_.erase(it->second.pos);
+        } else {
+            a1_list_.erase(it->second.pos);
+        }
+    }
+    states_.erase(it);
+}
+
+/**
+ * SetCapacity操作 - 更新容量
+ */
+void TwoQReplacer::SetCapacity(size_t num_frames) {
+    std::unique_lock<std::mutex> lock(latch_);
+    capacity_ = num_frames;
+}
+
+/**
+ * A1队列的长度上限，至少为1
+ */
+size_t TwoQReplacer::A1Limit() const {
+    size_t limit = static_cast<size_t>(capacity_ * a1_ratio_);
+    return limit == 0 ? 1 : limit;
+}
+
+/**
+ * 按最近使用到最久未使用的顺序列出可替换的frame
+ * 访问过多次的Am队列排在只访问过一次的A1队列前面，各自从尾部往头部走
+ */
+std::vector<size_t> TwoQReplacer::GetRecencyOrder() const {
+    std::unique_lock<std::mutex> lock(latch_);
+
+    std::vector<size_t> order;
+    order.reserve(a1_list_.size() + am_list_.size());
+    order.insert(order.end(), am_list_.rbegin(), am_list_.rend());
+    order.insert(order.end(), a1_list_.rbegin(), a1_list_.rend());
+    return order;
+}
+
+}  // namespace SimpleRDBMS
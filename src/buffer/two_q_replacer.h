@@ -0,0 +1,108 @@
+/*
+ * 文件: two_q_replacer.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 2Q页面替换算法头文件，新页面先进入FIFO队列，
+ *       被再次访问后才晋升到LRU主队列
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * 2Q页面替换器类
+ *
+ * 核心设计思路：
+ * - A1队列（FIFO）：只被访问过一次的frame，比如顺序扫描读进来的页面
+ * - Am队列（LRU）：在缓冲池中被再次访问过的frame，比如B+树内部页面
+ * - 选victim时，A1超过容量的一定比例（默认25%）时优先淘汰A1，
+ *   否则淘汰Am中最久未使用的
+ *
+ * 说明：
+ * - Replacer接口只知道frame_id而不知道page_id，所以这里没有实现
+ *   原论文中记录已淘汰页面的A1out幽灵队列，晋升条件是"驻留期间被再次访问"
+ */
+class TwoQReplacer : public Replacer {
+   public:
+    /**
+     * 构造函数
+     * @param num_pages 缓冲池中页面的总数量
+     * @param a1_ratio A1队列占容量的比例，默认0.25
+     */
+    explicit TwoQReplacer(size_t num_pages, double a1_ratio = 0.25);
+
+    ~TwoQReplacer() override = default;
+
+    /**
+     * Pin操作 - 记录一次访问，并将frame从可替换集合中移除
+     * @param frame_id 要pin的frame ID
+     */
+    void Pin(size_t frame_id) override;
+
+    /**
+     * Unpin操作 - 根据访问次数把frame放进A1或Am
+     * @param frame_id 要unpin的frame ID
+     */
+    void Unpin(size_t frame_id) override;
+
+    /**
+     * Victim操作 - 优先淘汰A1，再淘汰Am
+     * @param frame_id 输出参数，返回被选中的frame ID
+     * @return 是否成功找到可替换的页面
+     */
+    bool Victim(size_t* frame_id) override;
+
+    /**
+     * 获取当前可替换页面的数量
+     */
+    size_t Size() const override;
+
+    /**
+     * 按最近使用到最久未使用的顺序列出可替换的frame
+     */
+    std::vector<size_t> GetRecencyOrder() const override;
+
+    /**
+     * 移除frame并清空它的访问历史
+     * @param frame_id 要移除的frame ID
+     */
+    void Remove(size_t frame_id) override;
+
+    /**
+     * 调整容量，A1队列的阈值随之变化
+     * @param num_frames 新的frame数量
+     */
+    void SetCapacity(size_t num_frames) override;
+
+   private:
+    // 每个frame的状态
+    struct FrameState {
+        size_t accesses = 0;  // 驻留期间的访问次数（只区分1次和多次）
+        bool evictable = false;
+        bool in_am = false;  // 在Am队列还是A1队列
+        std::list<size_t>::iterator pos;
+    };
+
+    // A1队列允许的最大长度
+    size_t A1Limit() const;
+
+    double a1_ratio_;
+    size_t capacity_;
+
+    std::list<size_t> a1_list_;  // FIFO，头部最早进入
+    std::list<size_t> am_list_;  // LRU，头部最久未使用
+    std::unordered_map<size_t, FrameState> states_;
+
+    // 互斥锁：保护数据结构的并发访问
+    mutable std::mutex latch_;
+};
+
+}  // namespace SimpleRDBMS
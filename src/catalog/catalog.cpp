@@ -10,14 +10,38 @@
 #include <cstring>
 
 #include "buffer/buffer_pool_manager.h"
+#include "catalog/partition.h"
 #include "catalog/schema.h"
 #include "common/debug.h"
 #include "common/exception.h"
+#include "record/column_store.h"
 #include "record/table_heap.h"
 #include "recovery/log_manager.h"
 
 namespace SimpleRDBMS {
 
+// catalog页面中索引根页面段的魔数，旧格式的catalog这里是0
+static constexpr uint32_t INDEX_ROOTS_MAGIC = 0x494e4458;
+// 第二版索引段，每个索引在根页面后面多一个标志字段
+static constexpr uint32_t INDEX_META_MAGIC = 0x494e4459;
+// 索引标志位：非唯一索引
+static constexpr uint32_t INDEX_FLAG_NON_UNIQUE = 0x1;
+// 索引标志位：哈希索引，根页面字段存的是目录页面
+static constexpr uint32_t INDEX_FLAG_HASH = 0x2;
+// 索引段里列数字段的高16位是INCLUDE列数，INCLUDE列名紧跟在键列名后面；
+// 旧格式的高16位都是0，可以直接按新格式读
+static constexpr uint32_t INDEX_INCLUDE_COUNT_SHIFT = 16;
+static constexpr uint32_t INDEX_KEY_COUNT_MASK = 0xFFFF;
+// 索引根页面段后面的列存表段：每个列存表的OID和列存根页面，
+// 没有这一段的catalog里都是行存表
+static constexpr uint32_t TABLE_STORAGE_MAGIC = 0x53544f52;
+// 列存表段后面的页面压缩段：每个压缩表的OID和压缩算法，
+// 没有这一段的catalog里都是不压缩的表
+static constexpr uint32_t TABLE_COMPRESSION_MAGIC = 0x434d5052;
+// 页面压缩段后面的分区表段：每个分区表的OID、分区方式、分区列位置、
+// 分区数、上界个数和范围分区的上界，没有这一段的catalog里没有分区表
+static constexpr uint32_t TABLE_PARTITION_MAGIC = 0x50415254;
+
 /**
  * 构造函数 - 初始化目录管理器
  * @param buffer_pool_manager 缓冲池管理器指针
@@ -87,7 +111,8 @@ Catalog::~Catalog() {
  * 5. 更新内存中的catalog映射
  * 6. 持久化catalog到磁盘
  */
-bool Catalog::CreateTable(const std::string& table_name, const Schema& schema) {
+bool Catalog::CreateTable(const std::string& table_name, const Schema& schema,
+                          TableStorage storage, PageCompression compression) {
     LOG_DEBUG("CreateTable: Starting to create table " << table_name);
 
     // 检查表名是否已存在
@@ -135,8 +160,25 @@ bool Catalog::CreateTable(const std::string& table_name, const Schema& schema) {
         table_info->table_heap->SetLogManager(log_manager_);
     }
 
+    // 压缩表的第一个页面在脏页写盘之前登记，之后的页面从区段分配时登记
+    table_info->compression = compression;
+    table_info->table_heap->SetPageCompression(compression);
+
     buffer_pool_manager_->UnpinPage(first_page_id, true);
 
+    // 列存表的数据在ColumnStore里，表堆只留一个空页面
+    table_info->storage = storage;
+    if (storage == TableStorage::COLUMN) {
+        try {
+            table_info->column_store = ColumnStore::Create(
+                buffer_pool_manager_, table_info->schema.get());
+        } catch (const std::exception& e) {
+            LOG_ERROR("CreateTable: Failed to create column store for table "
+                      << table_name << ": " << e.what());
+            return false;
+        }
+    }
+
     LOG_DEBUG("CreateTable: Adding table to catalog maps");
 
     // 更新catalog的内存映射
@@ -159,6 +201,97 @@ bool Catalog::CreateTable(const std::string& table_name, const Schema& schema) {
     }
 
     LOG_DEBUG("CreateTable: Table " << table_name << " created successfully");
+    schema_version_++;
+    return true;
+}
+
+/**
+ * 创建分区表
+ * 实现思路：
+ * 1. 先检查父表和所有子表的名字都没有被占用
+ * 2. 依次创建父表和子表，中途失败时删掉已经建好的
+ * 3. 记下分区方式和父子关系，再保存一次catalog
+ */
+bool Catalog::CreatePartitionedTable(const std::string& table_name,
+                                     const Schema& schema,
+                                     const PartitionScheme& scheme,
+                                     PageCompression compression) {
+    std::vector<std::string> names{table_name};
+    for (size_t i = 0; i < scheme.partition_count; i++) {
+        names.push_back(PartitionScheme::PartitionTableName(table_name, i));
+    }
+    for (const auto& name : names) {
+        if (tables_.find(name) != tables_.end()) {
+            LOG_WARN("CreatePartitionedTable: Table " << name
+                                                      << " already exists");
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < names.size(); i++) {
+        if (!CreateTable(names[i], schema, TableStorage::ROW, compression)) {
+            for (size_t j = 0; j < i; j++) {
+                DropTable(names[j]);
+            }
+            return false;
+        }
+    }
+
+    tables_[table_name]->partition_scheme =
+        std::make_shared<const PartitionScheme>(scheme);
+    for (size_t i = 1; i < names.size(); i++) {
+        tables_[names[i]]->parent_table = table_name;
+    }
+    schema_version_++;
+    SaveCatalogToDisk();
+    return true;
+}
+
+std::vector<TableInfo*> Catalog::GetPartitions(const TableInfo* table_info) {
+    std::vector<TableInfo*> partitions;
+    if (table_info == nullptr || !table_info->partition_scheme) {
+        return partitions;
+    }
+    for (size_t i = 0; i < table_info->partition_scheme->partition_count;
+         i++) {
+        TableInfo* partition = GetTable(PartitionScheme::PartitionTableName(
+            table_info->table_name, i));
+        if (partition == nullptr) {
+            return {};
+        }
+        partitions.push_back(partition);
+    }
+    return partitions;
+}
+
+/**
+ * 记录表数据的修改
+ * 分区子表的修改也要让读分区表的缓存结果作废，所以父表一起加一
+ */
+void Catalog::BumpModificationCount(TableInfo* table_info) {
+    if (table_info == nullptr) {
+        return;
+    }
+    table_info->modification_count.fetch_add(1);
+    if (!table_info->parent_table.empty()) {
+        TableInfo* parent = GetTable(table_info->parent_table);
+        if (parent != nullptr) {
+            parent->modification_count.fetch_add(1);
+        }
+    }
+}
+
+void Catalog::BumpModificationCount(oid_t table_oid) {
+    BumpModificationCount(GetTable(table_oid));
+}
+
+bool Catalog::GetModificationCount(const std::string& table_name,
+                                   uint64_t* count) {
+    TableInfo* table_info = GetTable(table_name);
+    if (table_info == nullptr) {
+        return false;
+    }
+    *count = table_info->modification_count.load();
     return true;
 }
 
@@ -178,10 +311,16 @@ bool Catalog::DropTable(const std::string& table_name) {
         return false;
     }
 
+    // 表的页面不回收，只把区段里预留而没用到的页面还给磁盘管理器
+    if (it->second->table_heap) {
+        it->second->table_heap->ReleaseExtent();
+    }
+
     // 从映射中移除表信息
     oid_t table_oid = it->second->table_oid;
     table_oid_map_.erase(table_oid);
     tables_.erase(it);
+    schema_version_++;
 
     // 保存到磁盘
     SaveCatalogToDisk();
@@ -201,6 +340,31 @@ TableInfo* Catalog::GetTable(const std::string& table_name) {
     return it->second.get();
 }
 
+/**
+ * 设置表的统计信息
+ * 查询规划的线程可能同时在读，用shared_ptr的原子读写替换
+ */
+bool Catalog::SetTableStatistics(
+    const std::string& table_name,
+    std::shared_ptr<const TableStatistics> statistics) {
+    TableInfo* table_info = GetTable(table_name);
+    if (table_info == nullptr) {
+        return false;
+    }
+    std::atomic_store(&table_info->statistics, std::move(statistics));
+    schema_version_++;
+    return true;
+}
+
+std::shared_ptr<const TableStatistics> Catalog::GetTableStatistics(
+    const std::string& table_name) {
+    TableInfo* table_info = GetTable(table_name);
+    if (table_info == nullptr) {
+        return nullptr;
+    }
+    return std::atomic_load(&table_info->statistics);
+}
+
 /**
  * 根据表OID获取表信息
  * @param table_oid 表的OID
@@ -219,6 +383,9 @@ TableInfo* Catalog::GetTable(oid_t table_oid) {
  * @param index_name 索引名
  * @param table_name 表名
  * @param key_columns 索引键列名列表
+ * @param is_unique 是否唯一索引
+ * @param index_type 索引结构
+ * @param include_columns INCLUDE列
  * @return 是否创建成功
  *
  * 实现思路：
@@ -229,7 +396,9 @@ TableInfo* Catalog::GetTable(oid_t table_oid) {
  */
 bool Catalog::CreateIndex(const std::string& index_name,
                           const std::string& table_name,
-                          const std::vector<std::string>& key_columns) {
+                          const std::vector<std::string>& key_columns,
+                          bool is_unique, IndexType index_type,
+                          const std::vector<std::string>& include_columns) {
     // 检查索引是否已存在
     if (indexes_.find(index_name) != indexes_.end()) {
         return false;
@@ -245,6 +414,9 @@ bool Catalog::CreateIndex(const std::string& index_name,
     index_info->index_name = index_name;
     index_info->table_name = table_name;
     index_info->key_columns = key_columns;
+    index_info->include_columns = include_columns;
+    index_info->is_unique = is_unique;
+    index_info->index_type = index_type;
     index_info->index_oid = next_index_oid_++;  // 分配唯一的index OID
 
     // 存储索引信息到内存映射
@@ -253,6 +425,7 @@ bool Catalog::CreateIndex(const std::string& index_name,
     index_oid_map_[index_oid] = index_name;
 
     LOG_DEBUG("CreateIndex: Index " << index_name << " created in memory");
+    schema_version_++;
 
     // 延迟保存，让上层调用者决定何时保存
     return true;
@@ -273,6 +446,7 @@ bool Catalog::DropIndex(const std::string& index_name) {
     oid_t index_oid = it->second->index_oid;
     index_oid_map_.erase(index_oid);
     indexes_.erase(it);
+    schema_version_++;
 
     // 保存到磁盘
     SaveCatalogToDisk();
@@ -317,6 +491,33 @@ std::vector<IndexInfo*> Catalog::GetTableIndexes(
     return result;
 }
 
+/**
+ * 记录索引的新根页面
+ * @param index_name 索引名
+ * @param root_page_id 新的根页面ID
+ *
+ * 实现思路：根页面变化不频繁，每次变化都立即保存catalog，
+ * 保证catalog里的根页面ID不会落后于树本身
+ */
+void Catalog::UpdateIndexRoot(const std::string& index_name,
+                              page_id_t root_page_id) {
+    auto it = indexes_.find(index_name);
+    if (it == indexes_.end() || it->second->root_page_id == root_page_id) {
+        return;
+    }
+    it->second->root_page_id = root_page_id;
+    SaveCatalogToDisk();
+}
+
+/**
+ * 设置正常关闭标记并保存catalog
+ * @param clean 索引页面是否已经全部刷盘
+ */
+void Catalog::SetIndexesClean(bool clean) {
+    indexes_clean_ = clean;
+    SaveCatalogToDisk();
+}
+
 /**
  * 从磁盘加载catalog元数据
  *
@@ -506,12 +707,16 @@ void Catalog::LoadCatalogFromDisk() {
             index_info->table_name = std::string(data + offset, table_name_len);
             offset += table_name_len;
 
-            // 读取键列信息
-            uint32_t key_column_count;
-            std::memcpy(&key_column_count, data + offset, sizeof(uint32_t));
+            // 读取键列和INCLUDE列信息
+            uint32_t column_counts;
+            std::memcpy(&column_counts, data + offset, sizeof(uint32_t));
             offset += sizeof(uint32_t);
+            uint32_t key_column_count = column_counts & INDEX_KEY_COUNT_MASK;
+            uint32_t include_column_count =
+                column_counts >> INDEX_INCLUDE_COUNT_SHIFT;
 
-            for (uint32_t j = 0; j < key_column_count; ++j) {
+            for (uint32_t j = 0; j < key_column_count + include_column_count;
+                 ++j) {
                 uint32_t column_len;
                 std::memcpy(&column_len, data + offset, sizeof(uint32_t));
                 offset += sizeof(uint32_t);
@@ -524,7 +729,11 @@ void Catalog::LoadCatalogFromDisk() {
                 std::string column_name =
                     std::string(data + offset, column_len);
                 offset += column_len;
-                index_info->key_columns.push_back(column_name);
+                if (j < key_column_count) {
+                    index_info->key_columns.push_back(column_name);
+                } else {
+                    index_info->include_columns.push_back(column_name);
+                }
             }
 
             // 更新索引映射
@@ -539,6 +748,195 @@ void Catalog::LoadCatalogFromDisk() {
         LOG_DEBUG("LoadCatalogFromDisk: No space left to read indexes");
     }
 
+    // 加载索引根页面和正常关闭标记，旧格式的catalog没有这一段
+    uint32_t roots_magic = 0;
+    if (offset + 3 * sizeof(uint32_t) <= PAGE_SIZE) {
+        std::memcpy(&roots_magic, data + offset, sizeof(uint32_t));
+    }
+    if (roots_magic == INDEX_ROOTS_MAGIC || roots_magic == INDEX_META_MAGIC) {
+        // 第一版没有标志字段，那时的索引都是唯一索引
+        bool has_flags = roots_magic == INDEX_META_MAGIC;
+        size_t entry_size = sizeof(oid_t) + sizeof(page_id_t) +
+                            (has_flags ? sizeof(uint32_t) : 0);
+        offset += sizeof(uint32_t);
+        uint32_t clean;
+        std::memcpy(&clean, data + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        uint32_t root_count;
+        std::memcpy(&root_count, data + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+
+        uint32_t loaded_roots = 0;
+        for (; loaded_roots < root_count; ++loaded_roots) {
+            if (offset + entry_size > PAGE_SIZE) {
+                break;
+            }
+            oid_t index_oid;
+            page_id_t root_page_id;
+            uint32_t flags = 0;
+            std::memcpy(&index_oid, data + offset, sizeof(oid_t));
+            offset += sizeof(oid_t);
+            std::memcpy(&root_page_id, data + offset, sizeof(page_id_t));
+            offset += sizeof(page_id_t);
+            if (has_flags) {
+                std::memcpy(&flags, data + offset, sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+            }
+
+            auto it = index_oid_map_.find(index_oid);
+            if (it != index_oid_map_.end()) {
+                IndexInfo* index_info = indexes_[it->second].get();
+                index_info->root_page_id = root_page_id;
+                index_info->is_unique = (flags & INDEX_FLAG_NON_UNIQUE) == 0;
+                index_info->index_type = (flags & INDEX_FLAG_HASH) != 0
+                                             ? IndexType::HASH
+                                             : IndexType::BPLUS_TREE;
+            }
+        }
+
+        // 所有索引的根都在且标记为正常关闭，磁盘上的索引才能直接使用
+        indexes_trusted_ = clean != 0 && loaded_roots == root_count &&
+                           root_count == indexes_.size();
+        LOG_DEBUG("LoadCatalogFromDisk: Loaded " << loaded_roots
+                                                 << " index roots, trusted: "
+                                                 << indexes_trusted_);
+    } else {
+        indexes_trusted_ = false;
+    }
+
+    // 加载列存表段，打不开的列存表保留下来，读写时报错
+    uint32_t storage_magic = 0;
+    if (roots_magic == INDEX_META_MAGIC &&
+        offset + 2 * sizeof(uint32_t) <= PAGE_SIZE) {
+        std::memcpy(&storage_magic, data + offset, sizeof(uint32_t));
+    }
+    if (storage_magic == TABLE_STORAGE_MAGIC) {
+        offset += sizeof(uint32_t);
+        uint32_t column_table_count;
+        std::memcpy(&column_table_count, data + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        for (uint32_t i = 0; i < column_table_count; ++i) {
+            if (offset + sizeof(oid_t) + sizeof(page_id_t) > PAGE_SIZE) {
+                break;
+            }
+            oid_t table_oid;
+            page_id_t root_page_id;
+            std::memcpy(&table_oid, data + offset, sizeof(oid_t));
+            offset += sizeof(oid_t);
+            std::memcpy(&root_page_id, data + offset, sizeof(page_id_t));
+            offset += sizeof(page_id_t);
+
+            auto it = table_oid_map_.find(table_oid);
+            if (it == table_oid_map_.end()) {
+                continue;
+            }
+            TableInfo* table_info = tables_[it->second].get();
+            table_info->storage = TableStorage::COLUMN;
+            try {
+                table_info->column_store =
+                    ColumnStore::Open(buffer_pool_manager_,
+                                      table_info->schema.get(), root_page_id);
+            } catch (const std::exception& e) {
+                LOG_ERROR("LoadCatalogFromDisk: Failed to open column store "
+                          "for table "
+                          << table_info->table_name << ": " << e.what());
+            }
+        }
+    }
+
+    // 加载页面压缩段，压缩表的表堆重新设置压缩算法，之后分配的页面继续压缩
+    uint32_t compression_magic = 0;
+    if (storage_magic == TABLE_STORAGE_MAGIC &&
+        offset + 2 * sizeof(uint32_t) <= PAGE_SIZE) {
+        std::memcpy(&compression_magic, data + offset, sizeof(uint32_t));
+    }
+    if (compression_magic == TABLE_COMPRESSION_MAGIC) {
+        offset += sizeof(uint32_t);
+        uint32_t compressed_table_count;
+        std::memcpy(&compressed_table_count, data + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        for (uint32_t i = 0; i < compressed_table_count; ++i) {
+            if (offset + sizeof(oid_t) + sizeof(uint32_t) > PAGE_SIZE) {
+                break;
+            }
+            oid_t table_oid;
+            uint32_t codec;
+            std::memcpy(&table_oid, data + offset, sizeof(oid_t));
+            offset += sizeof(oid_t);
+            std::memcpy(&codec, data + offset, sizeof(uint32_t));
+            offset += sizeof(uint32_t);
+
+            auto it = table_oid_map_.find(table_oid);
+            if (it == table_oid_map_.end()) {
+                continue;
+            }
+            TableInfo* table_info = tables_[it->second].get();
+            table_info->compression = static_cast<PageCompression>(codec);
+            table_info->table_heap->SetPageCompression(
+                table_info->compression);
+        }
+    }
+
+    // 加载分区表段，分区列的名字和类型从schema里取
+    uint32_t partition_magic = 0;
+    if (compression_magic == TABLE_COMPRESSION_MAGIC &&
+        offset + 2 * sizeof(uint32_t) <= PAGE_SIZE) {
+        std::memcpy(&partition_magic, data + offset, sizeof(uint32_t));
+    }
+    if (partition_magic == TABLE_PARTITION_MAGIC) {
+        offset += sizeof(uint32_t);
+        uint32_t partitioned_table_count;
+        std::memcpy(&partitioned_table_count, data + offset,
+                    sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        for (uint32_t i = 0; i < partitioned_table_count; ++i) {
+            if (offset + sizeof(oid_t) + 4 * sizeof(uint32_t) > PAGE_SIZE) {
+                break;
+            }
+            oid_t table_oid;
+            uint32_t fields[4];  // 分区方式、分区列位置、分区数、上界个数
+            std::memcpy(&table_oid, data + offset, sizeof(oid_t));
+            offset += sizeof(oid_t);
+            std::memcpy(fields, data + offset, sizeof(fields));
+            offset += sizeof(fields);
+            if (offset + fields[3] * sizeof(int64_t) > PAGE_SIZE) {
+                break;
+            }
+            auto scheme = std::make_shared<PartitionScheme>();
+            scheme->type = static_cast<PartitionType>(fields[0]);
+            scheme->column_index = fields[1];
+            scheme->partition_count = fields[2];
+            scheme->upper_bounds.resize(fields[3]);
+            std::memcpy(scheme->upper_bounds.data(), data + offset,
+                        fields[3] * sizeof(int64_t));
+            offset += fields[3] * sizeof(int64_t);
+
+            auto it = table_oid_map_.find(table_oid);
+            if (it == table_oid_map_.end()) {
+                continue;
+            }
+            TableInfo* table_info = tables_[it->second].get();
+            if (scheme->column_index >= table_info->schema->GetColumnCount()) {
+                LOG_ERROR("LoadCatalogFromDisk: Invalid partition column for "
+                          "table "
+                          << table_info->table_name);
+                continue;
+            }
+            const Column& column =
+                table_info->schema->GetColumn(scheme->column_index);
+            scheme->column_name = column.name;
+            scheme->column_type = column.type;
+            table_info->partition_scheme = scheme;
+            for (size_t p = 0; p < scheme->partition_count; p++) {
+                auto child = tables_.find(PartitionScheme::PartitionTableName(
+                    table_info->table_name, p));
+                if (child != tables_.end()) {
+                    child->second->parent_table = table_info->table_name;
+                }
+            }
+        }
+    }
+
     buffer_pool_manager_->UnpinPage(0, false);
     LOG_DEBUG(
         "LoadCatalogFromDisk: Catalog load completed successfully, loaded "
@@ -567,6 +965,10 @@ void Catalog::SaveCatalogToDisk() {
             "SaveCatalogToDisk: BufferPoolManager is null, skipping save");
         return;
     }
+    if (buffer_pool_manager_->IsReadOnly()) {
+        LOG_DEBUG("SaveCatalogToDisk: database is read-only, skipping save");
+        return;
+    }
     save_in_progress_.store(true);
 
     try {
@@ -659,6 +1061,7 @@ void Catalog::SaveCatalogToDisk() {
         }
 
         // 写入索引信息
+        std::vector<const IndexInfo*> written_indexes;
         uint32_t index_count = static_cast<uint32_t>(indexes_.size());
         if (offset + sizeof(uint32_t) <= PAGE_SIZE) {
             std::memcpy(data + offset, &index_count, sizeof(uint32_t));
@@ -677,6 +1080,9 @@ void Catalog::SaveCatalogToDisk() {
                 for (const auto& column : index_info->key_columns) {
                     required_space += sizeof(uint32_t) + column.length();
                 }
+                for (const auto& column : index_info->include_columns) {
+                    required_space += sizeof(uint32_t) + column.length();
+                }
                 if (offset + required_space > PAGE_SIZE) {
                     LOG_ERROR("SaveCatalogToDisk: Not enough space for index "
                               << index_name);
@@ -703,20 +1109,29 @@ void Catalog::SaveCatalogToDisk() {
                             table_name_len);
                 offset += table_name_len;
 
-                uint32_t key_column_count =
-                    static_cast<uint32_t>(index_info->key_columns.size());
-                std::memcpy(data + offset, &key_column_count, sizeof(uint32_t));
+                uint32_t column_counts =
+                    static_cast<uint32_t>(index_info->key_columns.size()) |
+                    (static_cast<uint32_t>(index_info->include_columns.size())
+                     << INDEX_INCLUDE_COUNT_SHIFT);
+                std::memcpy(data + offset, &column_counts, sizeof(uint32_t));
                 offset += sizeof(uint32_t);
 
-                for (const auto& column : index_info->key_columns) {
+                auto write_column = [&](const std::string& column) {
                     uint32_t column_len =
                         static_cast<uint32_t>(column.length());
                     std::memcpy(data + offset, &column_len, sizeof(uint32_t));
                     offset += sizeof(uint32_t);
                     std::memcpy(data + offset, column.c_str(), column_len);
                     offset += column_len;
+                };
+                for (const auto& column : index_info->key_columns) {
+                    write_column(column);
+                }
+                for (const auto& column : index_info->include_columns) {
+                    write_column(column);
                 }
 
+                written_indexes.push_back(index_info.get());
                 LOG_DEBUG("SaveCatalogToDisk: Successfully wrote index "
                           << index_name);
             }
@@ -729,6 +1144,158 @@ void Catalog::SaveCatalogToDisk() {
             }
         }
 
+        // 写入索引根页面和正常关闭标记
+        size_t roots_space = 3 * sizeof(uint32_t) +
+                             written_indexes.size() *
+                                 (sizeof(oid_t) + sizeof(page_id_t) +
+                                  sizeof(uint32_t));
+        if (offset + roots_space <= PAGE_SIZE) {
+            uint32_t roots_magic = INDEX_META_MAGIC;
+            std::memcpy(data + offset, &roots_magic, sizeof(uint32_t));
+            offset += sizeof(uint32_t);
+            uint32_t clean = indexes_clean_ ? 1 : 0;
+            std::memcpy(data + offset, &clean, sizeof(uint32_t));
+            offset += sizeof(uint32_t);
+            uint32_t root_count =
+                static_cast<uint32_t>(written_indexes.size());
+            std::memcpy(data + offset, &root_count, sizeof(uint32_t));
+            offset += sizeof(uint32_t);
+            for (const IndexInfo* index_info : written_indexes) {
+                std::memcpy(data + offset, &index_info->index_oid,
+                            sizeof(oid_t));
+                offset += sizeof(oid_t);
+                std::memcpy(data + offset, &index_info->root_page_id,
+                            sizeof(page_id_t));
+                offset += sizeof(page_id_t);
+                uint32_t flags =
+                    index_info->is_unique ? 0 : INDEX_FLAG_NON_UNIQUE;
+                if (index_info->index_type == IndexType::HASH) {
+                    flags |= INDEX_FLAG_HASH;
+                }
+                std::memcpy(data + offset, &flags, sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+            }
+
+            // 列存表段紧跟在索引根页面段后面
+            std::vector<const TableInfo*> column_tables;
+            for (const auto& [table_name, table_info] : tables_) {
+                if (table_info->column_store) {
+                    column_tables.push_back(table_info.get());
+                }
+            }
+            size_t storage_space =
+                2 * sizeof(uint32_t) +
+                column_tables.size() * (sizeof(oid_t) + sizeof(page_id_t));
+            bool storage_written = offset + storage_space <= PAGE_SIZE;
+            if (storage_written) {
+                uint32_t storage_magic = TABLE_STORAGE_MAGIC;
+                std::memcpy(data + offset, &storage_magic, sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+                uint32_t column_table_count =
+                    static_cast<uint32_t>(column_tables.size());
+                std::memcpy(data + offset, &column_table_count,
+                            sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+                for (const TableInfo* table_info : column_tables) {
+                    std::memcpy(data + offset, &table_info->table_oid,
+                                sizeof(oid_t));
+                    offset += sizeof(oid_t);
+                    page_id_t root_page_id =
+                        table_info->column_store->GetRootPageId();
+                    std::memcpy(data + offset, &root_page_id,
+                                sizeof(page_id_t));
+                    offset += sizeof(page_id_t);
+                }
+            } else if (!column_tables.empty()) {
+                LOG_ERROR(
+                    "SaveCatalogToDisk: No space left for column tables");
+            }
+
+            // 页面压缩段紧跟在列存表段后面
+            std::vector<const TableInfo*> compressed_tables;
+            for (const auto& [table_name, table_info] : tables_) {
+                if (table_info->compression != PageCompression::NONE) {
+                    compressed_tables.push_back(table_info.get());
+                }
+            }
+            size_t compression_space =
+                2 * sizeof(uint32_t) +
+                compressed_tables.size() * (sizeof(oid_t) + sizeof(uint32_t));
+            bool compression_written =
+                storage_written && offset + compression_space <= PAGE_SIZE;
+            if (compression_written) {
+                uint32_t compression_magic = TABLE_COMPRESSION_MAGIC;
+                std::memcpy(data + offset, &compression_magic,
+                            sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+                uint32_t compressed_table_count =
+                    static_cast<uint32_t>(compressed_tables.size());
+                std::memcpy(data + offset, &compressed_table_count,
+                            sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+                for (const TableInfo* table_info : compressed_tables) {
+                    std::memcpy(data + offset, &table_info->table_oid,
+                                sizeof(oid_t));
+                    offset += sizeof(oid_t);
+                    uint32_t codec =
+                        static_cast<uint32_t>(table_info->compression);
+                    std::memcpy(data + offset, &codec, sizeof(uint32_t));
+                    offset += sizeof(uint32_t);
+                }
+            } else if (!compressed_tables.empty()) {
+                LOG_ERROR(
+                    "SaveCatalogToDisk: No space left for compressed tables");
+            }
+
+            // 分区表段紧跟在页面压缩段后面
+            std::vector<const TableInfo*> partitioned_tables;
+            size_t partition_space = 2 * sizeof(uint32_t);
+            for (const auto& [table_name, table_info] : tables_) {
+                if (table_info->partition_scheme) {
+                    partitioned_tables.push_back(table_info.get());
+                    partition_space +=
+                        sizeof(oid_t) + 4 * sizeof(uint32_t) +
+                        table_info->partition_scheme->upper_bounds.size() *
+                            sizeof(int64_t);
+                }
+            }
+            if (compression_written && offset + partition_space <= PAGE_SIZE) {
+                uint32_t partition_magic = TABLE_PARTITION_MAGIC;
+                std::memcpy(data + offset, &partition_magic,
+                            sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+                uint32_t partitioned_table_count =
+                    static_cast<uint32_t>(partitioned_tables.size());
+                std::memcpy(data + offset, &partitioned_table_count,
+                            sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+                for (const TableInfo* table_info : partitioned_tables) {
+                    const PartitionScheme& scheme =
+                        *table_info->partition_scheme;
+                    std::memcpy(data + offset, &table_info->table_oid,
+                                sizeof(oid_t));
+                    offset += sizeof(oid_t);
+                    uint32_t fields[4] = {
+                        static_cast<uint32_t>(scheme.type),
+                        static_cast<uint32_t>(scheme.column_index),
+                        static_cast<uint32_t>(scheme.partition_count),
+                        static_cast<uint32_t>(scheme.upper_bounds.size())};
+                    std::memcpy(data + offset, fields, sizeof(fields));
+                    offset += sizeof(fields);
+                    std::memcpy(data + offset, scheme.upper_bounds.data(),
+                                scheme.upper_bounds.size() * sizeof(int64_t));
+                    offset += scheme.upper_bounds.size() * sizeof(int64_t);
+                }
+            } else if (!partitioned_tables.empty()) {
+                LOG_ERROR(
+                    "SaveCatalogToDisk: No space left for partitioned tables");
+            }
+        } else {
+            LOG_WARN(
+                "SaveCatalogToDisk: No space left for index roots, indexes "
+                "will be rebuilt on next startup");
+        }
+
         LOG_DEBUG("SaveCatalogToDisk: Final offset: " << offset << " bytes");
 
         // 标记页面为脏页并解除固定
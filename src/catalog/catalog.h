@@ -24,8 +24,11 @@ namespace SimpleRDBMS {
 
 // 前向声明，避免头文件循环依赖
 class BufferPoolManager;
+class ColumnStore;
 class Schema;
+struct PartitionScheme;
 class TableHeap;
+struct TableStatistics;
 
 /**
  * 表信息结构体
@@ -37,17 +40,38 @@ struct TableInfo {
     std::unique_ptr<TableHeap> table_heap;  // 表的数据存储管理器
     oid_t table_oid;                        // 表的唯一标识符
     page_id_t first_page_id;                // 表数据的首页ID
+    // ANALYZE收集的统计信息，没有收集过时为空；通过Catalog的方法原子地读写
+    std::shared_ptr<const TableStatistics> statistics;
+    // 列存表的数据都在column_store里，table_heap是空的，只为了让
+    // 按表堆处理的代码不用判空
+    TableStorage storage = TableStorage::ROW;
+    std::unique_ptr<ColumnStore> column_store;
+    // 表和它的B+树索引的页面写盘时使用的压缩算法
+    PageCompression compression = PageCompression::NONE;
+    // 分区表的分区方式，普通表为空；分区表的数据都在分区子表里，
+    // 它自己的table_heap是空的
+    std::shared_ptr<const PartitionScheme> partition_scheme;
+    // 分区子表所属的分区表，普通表为空
+    std::string parent_table;
+    // 数据的修改计数，INSERT/UPDATE/DELETE/COPY FROM修改数据时和提交后加一，
+    // 结果缓存记下查询读过的表的计数，计数变了缓存的结果就作废
+    std::atomic<uint64_t> modification_count{0};
 };
 
 /**
  * 索引信息结构体
- * 包含索引的基本信息：索引名、所属表名、索引列和OID
+ * 包含索引的基本信息：索引名、所属表名、索引列、OID和B+树根页面ID
  */
 struct IndexInfo {
     std::string index_name;                // 索引名称
     std::string table_name;                // 索引所属的表名
     std::vector<std::string> key_columns;  // 索引的键列名列表
+    // INCLUDE列：跟在键列后面存进索引项，只用来覆盖查询，不参与查找
+    std::vector<std::string> include_columns;
     oid_t index_oid;                       // 索引的唯一标识符
+    page_id_t root_page_id = INVALID_PAGE_ID;  // B+树根页面，空树为INVALID
+    bool is_unique = true;  // false表示允许重复键的非唯一索引
+    IndexType index_type = IndexType::BPLUS_TREE;  // 哈希索引的根页面是目录页面
 };
 
 /**
@@ -88,15 +112,43 @@ class Catalog {
      * 创建新表
      * @param table_name 表名
      * @param schema 表的schema定义
+     * @param storage 存储格式，列存表另外分配列存的根页面
+     * @param compression 页面压缩算法，表堆的页面写盘时压缩
      * @return 创建成功返回true，失败返回false（如表已存在）
      *
      * 创建流程：
      * 1. 检查表名是否已存在
      * 2. 分配新的table_oid
-     * 3. 创建TableHeap存储管理器
+     * 3. 创建TableHeap存储管理器，列存表再创建ColumnStore
      * 4. 构建TableInfo并添加到映射表中
      */
-    bool CreateTable(const std::string& table_name, const Schema& schema);
+    bool CreateTable(const std::string& table_name, const Schema& schema,
+                     TableStorage storage = TableStorage::ROW,
+                     PageCompression compression = PageCompression::NONE);
+
+    /**
+     * 创建分区表
+     * @param table_name 表名
+     * @param schema 表的schema定义，所有分区共用
+     * @param scheme 分区方式，column_index和column_type已经按schema填好
+     * @param compression 页面压缩算法，作用于每个分区
+     * @return 创建成功返回true，失败返回false（如表或者分区子表已存在）
+     *
+     * 父表和每个分区子表（PartitionScheme::PartitionTableName）都是普通的
+     * 行存表，之后在父表上记下分区方式，在子表上记下父表。
+     * 删除分区表时由调用者先删除各个分区子表
+     */
+    bool CreatePartitionedTable(const std::string& table_name,
+                                const Schema& schema,
+                                const PartitionScheme& scheme,
+                                PageCompression compression =
+                                    PageCompression::NONE);
+
+    /**
+     * 分区表的所有分区子表，按分区序号排列
+     * @return 不是分区表或者有子表找不到时返回空
+     */
+    std::vector<TableInfo*> GetPartitions(const TableInfo* table_info);
 
     /**
      * 删除表
@@ -132,6 +184,9 @@ class Catalog {
      * @param index_name 索引名
      * @param table_name 所属表名
      * @param key_columns 索引的键列名列表
+     * @param is_unique 是否唯一索引，false时同一个键可以对应多条记录
+     * @param index_type 索引结构，B+树或者哈希
+     * @param include_columns INCLUDE列，只存储不参与查找
      * @return 创建成功返回true，失败返回false
      *
      * 创建流程：
@@ -142,7 +197,10 @@ class Catalog {
      */
     bool CreateIndex(const std::string& index_name,
                      const std::string& table_name,
-                     const std::vector<std::string>& key_columns);
+                     const std::vector<std::string>& key_columns,
+                     bool is_unique = true,
+                     IndexType index_type = IndexType::BPLUS_TREE,
+                     const std::vector<std::string>& include_columns = {});
 
     /**
      * 删除索引
@@ -172,6 +230,74 @@ class Catalog {
      */
     std::vector<IndexInfo*> GetTableIndexes(const std::string& table_name);
 
+    // ======================== 统计信息接口 ========================
+
+    /**
+     * 设置表的统计信息，替换之前收集的
+     * @param table_name 表名
+     * @param statistics 新的统计信息
+     * @return 表不存在时返回false
+     */
+    bool SetTableStatistics(const std::string& table_name,
+                            std::shared_ptr<const TableStatistics> statistics);
+
+    /**
+     * 获取表的统计信息
+     * @return 表不存在或者还没有ANALYZE时返回nullptr
+     */
+    std::shared_ptr<const TableStatistics> GetTableStatistics(
+        const std::string& table_name);
+
+    /**
+     * catalog的版本号，建表、删表、建索引、删索引和更新统计信息时加一
+     * 缓存的执行计划记下生成时的版本，版本变了就要重新生成
+     */
+    uint64_t GetSchemaVersion() const { return schema_version_.load(); }
+
+    /**
+     * 记录一次对表数据的修改：表和它所属的分区表的修改计数都加一
+     * @param table_oid 表的OID，表已经删除时什么都不做
+     */
+    void BumpModificationCount(oid_t table_oid);
+    void BumpModificationCount(TableInfo* table_info);
+
+    /**
+     * 获取表的修改计数
+     * @return 表不存在时返回false
+     *
+     * 表删除后重建时计数从0开始，使用方要同时比较GetSchemaVersion
+     */
+    bool GetModificationCount(const std::string& table_name,
+                              uint64_t* count);
+
+    /**
+     * 记录索引B+树的新根页面并立即保存catalog
+     * @param index_name 索引名
+     * @param root_page_id 新的根页面ID
+     *
+     * B+树的根在分裂、合并和批量构建时变化，由树通过回调通知
+     */
+    void UpdateIndexRoot(const std::string& index_name,
+                         page_id_t root_page_id);
+
+    /**
+     * 磁盘上的索引能否直接使用
+     * @return 加载catalog时带有正常关闭标记返回true
+     *
+     * 索引页面没有写WAL，只有上次关闭前所有页面都刷盘了，磁盘上的
+     * B+树才和表数据一致；否则启动时需要从表数据重建
+     */
+    bool AreIndexesTrusted() const { return indexes_trusted_; }
+
+    /**
+     * 设置并保存正常关闭标记
+     * @param clean true表示所有页面已经刷盘，索引和表数据一致
+     *
+     * 启动时打开索引后写入false，这样运行中崩溃的话下次启动会重建索引；
+     * 正常关闭并刷完所有页面后再写入true
+     */
+    void SetIndexesClean(bool clean);
+
     // ======================== 工具方法 ========================
 
     /**
@@ -239,6 +365,12 @@ class Catalog {
     oid_t next_table_oid_;  // 下一个可用的表OID
     oid_t next_index_oid_;  // 下一个可用的索引OID
 
+    // 索引持久化状态
+    bool indexes_clean_ = false;    // 下次保存时写入的正常关闭标记
+    bool indexes_trusted_ = false;  // 加载时读到的标记，启动时据此决定是否重建
+
+    std::atomic<uint64_t> schema_version_{0};  // 见GetSchemaVersion
+
     // ======================== 序列化辅助方法 ========================
 
     /**
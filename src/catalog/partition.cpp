@@ -0,0 +1,183 @@
+/*
+ * 文件: partition.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 分区方式的实现：分区路由、范围分区的裁剪和命名
+ */
+
+#include "catalog/partition.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "common/crc32c.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+// 分区子表和分区索引名字里的分隔符，词法分析不接受'$'，
+// 所以用户建的表和索引不会和它们重名
+constexpr char PARTITION_NAME_SEPARATOR[] = "$p";
+
+bool IsIntegerType(TypeId type) {
+    return type == TypeId::TINYINT || type == TypeId::SMALLINT ||
+           type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+bool IsFloatType(TypeId type) {
+    return type == TypeId::FLOAT || type == TypeId::DOUBLE ||
+           type == TypeId::DECIMAL;
+}
+
+}  // namespace
+
+bool PartitionValueAsInt64(const Value& value, int64_t* result) {
+    if (std::holds_alternative<int8_t>(value)) {
+        *result = std::get<int8_t>(value);
+    } else if (std::holds_alternative<int16_t>(value)) {
+        *result = std::get<int16_t>(value);
+    } else if (std::holds_alternative<int32_t>(value)) {
+        *result = std::get<int32_t>(value);
+    } else if (std::holds_alternative<int64_t>(value)) {
+        *result = std::get<int64_t>(value);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * 计算分区
+ * 实现思路：
+ * 1. 整数列（以及BOOLEAN）把值转换成int64，浮点列转换成double，
+ *    字符串列取字节；值的类型族和列不一致时无法路由
+ * 2. 哈希分区对归一化后的字节求CRC32C再取模
+ * 3. 范围分区找第一个大于值的上界，没有时落在MAXVALUE分区（如果有）
+ */
+bool PartitionScheme::Route(const Value& value, size_t* partition) const {
+    if (partition_count == 0) {
+        return false;
+    }
+
+    if (IsIntegerType(column_type) || column_type == TypeId::BOOLEAN ||
+        column_type == TypeId::TIMESTAMP) {
+        int64_t key;
+        if (std::holds_alternative<bool>(value)) {
+            key = std::get<bool>(value) ? 1 : 0;
+        } else if (!PartitionValueAsInt64(value, &key)) {
+            return false;
+        }
+        if (type == PartitionType::RANGE) {
+            auto it = std::upper_bound(upper_bounds.begin(),
+                                       upper_bounds.end(), key);
+            size_t index = static_cast<size_t>(it - upper_bounds.begin());
+            if (index >= partition_count) {
+                return false;
+            }
+            *partition = index;
+            return true;
+        }
+        *partition = Crc32c(&key, sizeof(key)) % partition_count;
+        return true;
+    }
+
+    if (type != PartitionType::HASH) {
+        return false;
+    }
+    if (IsFloatType(column_type)) {
+        double key;
+        if (std::holds_alternative<double>(value)) {
+            key = std::get<double>(value);
+        } else if (std::holds_alternative<float>(value)) {
+            key = std::get<float>(value);
+        } else {
+            return false;
+        }
+        if (key == 0.0) {
+            key = 0.0;  // -0.0和0.0相等，哈希也要相同
+        }
+        *partition = Crc32c(&key, sizeof(key)) % partition_count;
+        return true;
+    }
+    if (column_type == TypeId::VARCHAR &&
+        std::holds_alternative<std::string>(value)) {
+        const auto& key = std::get<std::string>(value);
+        *partition = Crc32c(key.data(), key.size()) % partition_count;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * 范围分区的裁剪
+ * 实现思路：low落在的分区到high落在的分区之间的都可能有满足条件的行，
+ * high超过了所有分区时截到最后一个分区
+ */
+std::vector<size_t> PartitionScheme::RangePartitions(int64_t low,
+                                                     int64_t high) const {
+    std::vector<size_t> result;
+    if (type != PartitionType::RANGE || low > high || partition_count == 0) {
+        return result;
+    }
+    auto first = static_cast<size_t>(
+        std::upper_bound(upper_bounds.begin(), upper_bounds.end(), low) -
+        upper_bounds.begin());
+    auto last = static_cast<size_t>(
+        std::upper_bound(upper_bounds.begin(), upper_bounds.end(), high) -
+        upper_bounds.begin());
+    last = std::min(last, partition_count - 1);
+    for (size_t i = first; i <= last; i++) {
+        result.push_back(i);
+    }
+    return result;
+}
+
+bool PartitionScheme::Validate(std::string* reason) const {
+    if (partition_count < 1 || partition_count > MAX_TABLE_PARTITIONS) {
+        *reason = "partition count must be between 1 and " +
+                  std::to_string(MAX_TABLE_PARTITIONS);
+        return false;
+    }
+    if (type == PartitionType::HASH) {
+        if (column_type != TypeId::VARCHAR && !IsIntegerType(column_type) &&
+            !IsFloatType(column_type) && column_type != TypeId::BOOLEAN &&
+            column_type != TypeId::TIMESTAMP) {
+            *reason = "column " + column_name + " cannot be hash partitioned";
+            return false;
+        }
+        return true;
+    }
+    if (!IsIntegerType(column_type) && column_type != TypeId::TIMESTAMP) {
+        *reason = "range partitioning requires an integer column";
+        return false;
+    }
+    if (upper_bounds.size() != partition_count &&
+        upper_bounds.size() + 1 != partition_count) {
+        *reason = "only the last range partition can be MAXVALUE";
+        return false;
+    }
+    for (size_t i = 1; i < upper_bounds.size(); i++) {
+        if (upper_bounds[i] <= upper_bounds[i - 1]) {
+            *reason = "range partition bounds must be strictly increasing";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string PartitionScheme::PartitionTableName(const std::string& table_name,
+                                                size_t partition) {
+    return table_name + PARTITION_NAME_SEPARATOR + std::to_string(partition);
+}
+
+std::string PartitionScheme::PartitionIndexName(const std::string& index_name,
+                                                size_t partition) {
+    return index_name + PARTITION_NAME_SEPARATOR + std::to_string(partition);
+}
+
+bool PartitionScheme::IsPartitionName(const std::string& name) {
+    return name.find(PARTITION_NAME_SEPARATOR) != std::string::npos;
+}
+
+}  // namespace SimpleRDBMS
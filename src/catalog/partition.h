@@ -0,0 +1,88 @@
+/*
+ * 文件: partition.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 分区表的分区方式：按一列做哈希分区或者范围分区，
+ *       决定一行落在哪个分区，以及分区子表和分区索引的命名
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/types.h"
+
+namespace SimpleRDBMS {
+
+// ==================== 分区方式枚举 ====================
+// CREATE TABLE ... PARTITION BY HASH (col) PARTITIONS n
+// CREATE TABLE ... PARTITION BY RANGE (col) (VALUES LESS THAN (v), ...)
+enum class PartitionType : uint32_t {
+    HASH = 0,  // 分区列的哈希值对分区数取模
+    RANGE      // 分区列落在哪个上界之下
+};
+
+/**
+ * PartitionScheme - 一张分区表的分区方式
+ *
+ * 设计思路：
+ * - 每个分区是一张普通的行存子表（名字见PartitionTableName），有自己的
+ *   表堆和索引；父表只保存schema和分区方式，它的表堆一直是空的
+ * - 哈希分区：值按列的类型族归一化（整数都当作int64、浮点都当作double、
+ *   字符串按字节）后求CRC32C，再对分区数取模，同一个值不管以哪种整数
+ *   类型出现都落在同一个分区
+ * - 范围分区只支持整数列：第i个分区保存[upper_bounds[i-1], upper_bounds[i])，
+ *   第一个分区没有下界；上界比分区数少一个时最后一个分区是MAXVALUE，
+ *   否则大于等于最后一个上界的值没有分区可放
+ */
+struct PartitionScheme {
+    PartitionType type = PartitionType::HASH;
+    std::string column_name;  // 分区列
+    size_t column_index = 0;  // 分区列在schema中的位置
+    TypeId column_type = TypeId::INVALID;
+    size_t partition_count = 0;
+    std::vector<int64_t> upper_bounds;  // 范围分区每个分区的上界（不含）
+
+    /**
+     * 计算一个分区列的值落在哪个分区
+     * @param value 分区列的值
+     * @param partition 输出分区序号
+     * @return 值的类型和分区列不是同一类型族，或者超出了所有范围分区时返回false
+     */
+    bool Route(const Value& value, size_t* partition) const;
+
+    /**
+     * 范围分区中可能包含[low, high]之间的值的分区
+     * @param low/high 闭区间的两端，没有下界/上界时传INT64_MIN/INT64_MAX
+     * @return 分区序号，按顺序排列；区间为空时返回空
+     */
+    std::vector<size_t> RangePartitions(int64_t low, int64_t high) const;
+
+    /**
+     * 检查分区方式是否合法
+     * @param reason 不合法时输出原因
+     */
+    bool Validate(std::string* reason) const;
+
+    /** 第i个分区的子表名 */
+    static std::string PartitionTableName(const std::string& table_name,
+                                          size_t partition);
+
+    /** 父表上的索引在第i个分区上对应的索引名 */
+    static std::string PartitionIndexName(const std::string& index_name,
+                                          size_t partition);
+
+    /** 是否是分区子表或者分区索引的名字，这些名字SQL里写不出来 */
+    static bool IsPartitionName(const std::string& name);
+};
+
+/**
+ * 把整数类型的值转换成int64
+ * @return 值不是整数类型时返回false
+ */
+bool PartitionValueAsInt64(const Value& value, int64_t* result);
+
+}  // namespace SimpleRDBMS
@@ -17,6 +17,8 @@ namespace SimpleRDBMS {
  * 思路：
  * 1. 保存列定义的vector
  * 2. 构建列名到索引的映射表，用于快速查找
+ * 3. 跳过版本号和NULL位图后按列顺序累加每列的宽度，得到行格式的偏移表，
+ *    VARCHAR列的宽度是它的条目大小
  * 这样既保持了列的顺序（用vector），又能快速按名称查找（用map）
  */
 Schema::Schema(const std::vector<Column>& columns) : columns_(columns) {
@@ -24,6 +26,14 @@ Schema::Schema(const std::vector<Column>& columns) : columns_(columns) {
     for (size_t i = 0; i < columns_.size(); i++) {
         column_indices_[columns_[i].name] = i;
     }
+
+    size_t offset = sizeof(uint8_t) + GetNullBitmapSize();
+    for (const auto& column : columns_) {
+        column_offsets_.push_back(offset);
+        size_t size = GetFixedSize(column.type);
+        offset += size > 0 ? size : VAR_ENTRY_SIZE;
+    }
+    var_data_offset_ = offset;
 }
 
 /**
@@ -118,4 +128,28 @@ bool Schema::HasColumn(const std::string& name) const {
     return column_indices_.find(name) != column_indices_.end();
 }
 
+/**
+ * 定长类型的序列化大小，和Tuple::SerializeTo写入的字节数一致
+ */
+size_t Schema::GetFixedSize(TypeId type) {
+    switch (type) {
+        case TypeId::BOOLEAN:
+            return sizeof(bool);
+        case TypeId::TINYINT:
+            return sizeof(int8_t);
+        case TypeId::SMALLINT:
+            return sizeof(int16_t);
+        case TypeId::INTEGER:
+            return sizeof(int32_t);
+        case TypeId::BIGINT:
+            return sizeof(int64_t);
+        case TypeId::FLOAT:
+            return sizeof(float);
+        case TypeId::DOUBLE:
+            return sizeof(double);
+        default:
+            return 0;
+    }
+}
+
 }  // namespace SimpleRDBMS
\ No newline at end of file
@@ -109,6 +109,44 @@ class Schema {
      */
     bool HasColumn(const std::string& name) const;
 
+    // ======================== 行格式布局 ========================
+    // 一条记录序列化后的布局（见Tuple::SerializeTo）：
+    //   [版本号 1字节][NULL位图][各列按schema顺序：定长列的值 / VARCHAR的条目]
+    //   [变长数据]
+    // VARCHAR的条目是两个uint16_t：数据相对记录开头的偏移和长度，
+    // 所以每一列的位置都由schema确定，不需要从头解析
+
+    /** 每个VARCHAR列在定长区里占用的字节数 */
+    static constexpr size_t VAR_ENTRY_SIZE = 2 * sizeof(uint16_t);
+
+    /**
+     * NULL位图的字节数，每列一位，第i列在第i/8个字节的第i%8位
+     * @return 位图字节数
+     */
+    size_t GetNullBitmapSize() const { return (columns_.size() + 7) / 8; }
+
+    /**
+     * 获取列在记录中的偏移量
+     * @param index 列的索引位置
+     * @return 定长列是值的偏移，VARCHAR列是它的条目的偏移
+     */
+    size_t GetColumnOffset(size_t index) const {
+        return column_offsets_[index];
+    }
+
+    /**
+     * 变长数据区的起始偏移，也就是没有字符串内容时一条记录的长度
+     * @return 版本号、位图和定长区的总字节数
+     */
+    size_t GetVarDataOffset() const { return var_data_offset_; }
+
+    /**
+     * 定长类型序列化后占用的字节数
+     * @param type 数据类型
+     * @return 字节数，VARCHAR和未知类型返回0
+     */
+    static size_t GetFixedSize(TypeId type);
+
    private:
     // ======================== 内部数据结构 ========================
 
@@ -124,6 +162,13 @@ class Schema {
      * key: 列名, value: 在columns_中的索引位置
      */
     std::unordered_map<std::string, size_t> column_indices_;
+
+    /**
+     * 每列在记录中的偏移，在构造时计算，下标就是列的索引位置
+     */
+    std::vector<size_t> column_offsets_;
+
+    size_t var_data_offset_ = 0;  // 变长数据区的起始偏移
 };
 
 }  // namespace SimpleRDBMS
\ No newline at end of file
@@ -11,23 +11,55 @@
 #include <unordered_set>
 
 #include "catalog/catalog.h"
+#include "catalog/partition.h"
 #include "catalog/schema.h"
 #include "common/debug.h"
 #include "common/exception.h"
 #include "common/types.h"
 #include "index/index_manager.h"
 #include "parser/ast.h"
+#include "record/column_store.h"
 #include "record/table_heap.h"
 
 namespace SimpleRDBMS {
 
+/**
+ * 按索引列的顺序取出记录在各列上的值，作为索引键
+ * 单列索引得到只有一个值的vector；有INCLUDE列时它们的值跟在键列后面，
+ * 所以INCLUDE列变化的UPDATE也会更新索引项
+ */
+static std::vector<Value> ExtractIndexKeys(const IndexInfo& index_info,
+                                           const Schema& schema,
+                                           const Tuple& tuple) {
+    std::vector<Value> keys;
+    keys.reserve(index_info.key_columns.size() +
+                 index_info.include_columns.size());
+    for (const auto& column_name : index_info.key_columns) {
+        keys.push_back(tuple.GetValue(schema.GetColumnIdx(column_name)));
+    }
+    for (const auto& column_name : index_info.include_columns) {
+        keys.push_back(tuple.GetValue(schema.GetColumnIdx(column_name)));
+    }
+    return keys;
+}
+
+/** 索引项里存储的所有列：键列在前，INCLUDE列在后 */
+static std::vector<std::string> StoredIndexColumns(
+    const std::vector<std::string>& key_columns,
+    const std::vector<std::string>& include_columns) {
+    std::vector<std::string> columns = key_columns;
+    columns.insert(columns.end(), include_columns.begin(),
+                   include_columns.end());
+    return columns;
+}
+
 /**
  * TableManager构造函数
  *
  * 初始化思路：
  * 1. 保存buffer pool和catalog的引用
  * 2. 创建IndexManager实例
- * 3. 重建所有现有的索引（恢复时需要）
+ * 3. 打开所有现有的索引，磁盘上的B+树不可信时从表数据重建
  */
 TableManager::TableManager(BufferPoolManager* buffer_pool_manager,
                            Catalog* catalog)
@@ -36,7 +68,7 @@ TableManager::TableManager(BufferPoolManager* buffer_pool_manager,
     index_manager_ =
         std::make_unique<IndexManager>(buffer_pool_manager, catalog);
 
-    // 系统启动时重建所有索引，确保索引和数据的一致性
+    // 系统启动时打开或重建所有索引，确保索引和数据的一致性
     RebuildAllIndexes();
 }
 
@@ -44,10 +76,22 @@ TableManager::TableManager(BufferPoolManager* buffer_pool_manager,
  * TableManager析构函数
  *
  * 清理思路：
- * 1. 确保IndexManager被正确销毁
- * 2. 记录清理过程，便于调试
+ * 1. 刷新所有页面，在catalog中写入正常关闭标记
+ * 2. 确保IndexManager被正确销毁
+ * 3. 记录清理过程，便于调试
  */
 TableManager::~TableManager() {
+    // 所有页面刷盘之后磁盘上的B+树和表数据一致，下次启动可以直接打开
+    if (buffer_pool_manager_ && catalog_) {
+        try {
+            buffer_pool_manager_->FlushAllPages();
+            catalog_->SetIndexesClean(true);
+        } catch (const std::exception& e) {
+            LOG_WARN("TableManager::~TableManager: Failed to mark indexes "
+                     "clean: "
+                     << e.what());
+        }
+    }
     if (index_manager_) {
         LOG_DEBUG("TableManager::~TableManager: Destroying IndexManager");
         index_manager_.reset();  // 显式重置，确保资源释放
@@ -61,14 +105,27 @@ TableManager::~TableManager() {
  * 重建流程：
  * 1. 获取所有表名
  * 2. 对每个表，获取其所有索引信息
- * 3. 重新创建索引的物理结构
- * 4. 用现有数据填充索引
+ * 3. catalog带有正常关闭标记时，只把catalog里的根页面登记给IndexManager，
+ *    第一次使用时才打开，启动时不读索引页面
+ * 4. 否则新建空树，用现有数据批量构建
+ * 5. 在catalog中清除正常关闭标记，运行中崩溃的话下次启动会重建
  *
  * 这个方法主要在系统启动时调用，确保索引和数据的一致性
  */
 void TableManager::RebuildAllIndexes() {
     LOG_DEBUG("TableManager::RebuildAllIndexes: Starting index rebuild");
 
+    // 索引页面不写WAL，只有上次正常关闭时磁盘上的树才和表数据一致；
+    // 只读映射模式下没法重建，要求数据库正常关闭过，总是打开磁盘上的树
+    bool trusted = catalog_->AreIndexesTrusted();
+    if (!trusted && buffer_pool_manager_->IsReadOnly()) {
+        LOG_WARN("TableManager::RebuildAllIndexes: database was not shut "
+                 "down cleanly, opening indexes read-only without rebuild");
+        trusted = true;
+    }
+    size_t opened_count = 0;
+    size_t rebuilt_count = 0;
+
     // 获取系统中所有的表
     std::vector<std::string> table_names = catalog_->GetAllTableNames();
 
@@ -87,10 +144,19 @@ void TableManager::RebuildAllIndexes() {
                 continue;
             }
 
-            // 重新创建索引的物理结构（B+树等）
-            bool success = index_manager_->CreateIndex(
-                index_info->index_name, table_name, index_info->key_columns,
-                table_info->schema.get());
+            // 可信时登记磁盘上的根页面，推迟打开；否则新建空的物理结构
+            bool success =
+                trusted
+                    ? index_manager_->DeferIndex(
+                          index_info->index_name, table_name,
+                          index_info->key_columns, table_info->schema.get(),
+                          index_info->root_page_id, index_info->is_unique,
+                          index_info->index_type, index_info->include_columns)
+                    : index_manager_->CreateIndex(
+                          index_info->index_name, table_name,
+                          index_info->key_columns, table_info->schema.get(),
+                          INVALID_PAGE_ID, index_info->is_unique,
+                          index_info->index_type, index_info->include_columns);
 
             if (!success) {
                 LOG_ERROR(
@@ -99,13 +165,26 @@ void TableManager::RebuildAllIndexes() {
                 continue;
             }
 
-            // 用表中现有的数据填充索引
-            PopulateIndexWithExistingData(index_info->index_name, table_info,
-                                          index_info->key_columns);
+            if (trusted) {
+                opened_count++;
+                continue;
+            }
+
+            // 用表中现有的数据填充索引，旧的树页面不再使用
+            catalog_->UpdateIndexRoot(index_info->index_name, INVALID_PAGE_ID);
+            PopulateIndexWithExistingData(
+                index_info->index_name, table_info,
+                StoredIndexColumns(index_info->key_columns,
+                                   index_info->include_columns));
+            rebuilt_count++;
         }
     }
 
-    LOG_DEBUG("TableManager::RebuildAllIndexes: Index rebuild completed");
+    catalog_->SetIndexesClean(false);
+
+    LOG_INFO("TableManager::RebuildAllIndexes: Opened "
+             << opened_count << " indexes from disk, rebuilt "
+             << rebuilt_count);
 }
 
 /**
@@ -118,14 +197,17 @@ void TableManager::RebuildAllIndexes() {
  * 4. 用现有数据填充索引
  * 5. 保存catalog到磁盘
  */
-bool TableManager::CreateIndex(const std::string& index_name,
-                               const std::string& table_name,
-                               const std::vector<std::string>& key_columns) {
+bool TableManager::CreateIndex(
+    const std::string& index_name, const std::string& table_name,
+    const std::vector<std::string>& key_columns, bool is_unique,
+    IndexType index_type, const std::vector<std::string>& include_columns) {
     LOG_DEBUG("TableManager::CreateIndex: Creating index "
               << index_name << " on table " << table_name);
 
-    // 检查索引名是否已经存在
-    if (catalog_->GetIndex(index_name) != nullptr) {
+    // 检查索引名是否已经存在，分区表上的索引以分区索引的形式存在
+    if (catalog_->GetIndex(index_name) != nullptr ||
+        catalog_->GetIndex(PartitionScheme::PartitionIndexName(index_name,
+                                                               0)) != nullptr) {
         LOG_WARN("TableManager::CreateIndex: Index " << index_name
                                                      << " already exists");
         return false;
@@ -139,15 +221,36 @@ bool TableManager::CreateIndex(const std::string& index_name,
         return false;
     }
 
+    if (table_info->partition_scheme) {
+        return CreatePartitionedIndex(index_name, table_info, key_columns,
+                                      is_unique, index_type, include_columns);
+    }
+
+    // 列存表只能追加，不维护索引
+    if (table_info->storage == TableStorage::COLUMN) {
+        LOG_ERROR("TableManager::CreateIndex: Table "
+                  << table_name << " uses column storage and cannot be indexed");
+        return false;
+    }
+
     // 验证索引列不能为空
     if (key_columns.empty()) {
         LOG_ERROR("TableManager::CreateIndex: Key columns cannot be empty");
         return false;
     }
 
-    // 验证所有索引列都存在于表中
+    // 哈希表按完整的键查找，INCLUDE列没有意义
+    if (!include_columns.empty() && index_type == IndexType::HASH) {
+        LOG_ERROR("TableManager::CreateIndex: Hash index "
+                  << index_name << " cannot have INCLUDE columns");
+        return false;
+    }
+
+    // 验证所有索引列和INCLUDE列都存在于表中
     const Schema* schema = table_info->schema.get();
-    for (const auto& key_column : key_columns) {
+    std::vector<std::string> stored_columns =
+        StoredIndexColumns(key_columns, include_columns);
+    for (const auto& key_column : stored_columns) {
         if (!schema->HasColumn(key_column)) {
             LOG_ERROR("TableManager::CreateIndex: Column "
                       << key_column << " not found in table " << table_name);
@@ -155,17 +258,18 @@ bool TableManager::CreateIndex(const std::string& index_name,
         }
     }
 
-    // 检查索引列是否有重复
-    std::unordered_set<std::string> key_column_set(key_columns.begin(),
-                                                   key_columns.end());
-    if (key_column_set.size() != key_columns.size()) {
+    // 检查索引列是否有重复，INCLUDE列也不能和键列重复
+    std::unordered_set<std::string> key_column_set(stored_columns.begin(),
+                                                   stored_columns.end());
+    if (key_column_set.size() != stored_columns.size()) {
         LOG_ERROR("TableManager::CreateIndex: Duplicate columns in key");
         return false;
     }
 
     // 先在catalog中创建索引元数据
     bool catalog_success =
-        catalog_->CreateIndex(index_name, table_name, key_columns);
+        catalog_->CreateIndex(index_name, table_name, key_columns, is_unique,
+                              index_type, include_columns);
     if (!catalog_success) {
         LOG_ERROR(
             "TableManager::CreateIndex: Failed to create index in catalog");
@@ -173,8 +277,10 @@ bool TableManager::CreateIndex(const std::string& index_name,
     }
 
     // 然后在索引管理器中创建物理索引结构
-    bool index_success = index_manager_->CreateIndex(index_name, table_name,
-                                                     key_columns, schema);
+    bool index_success =
+        index_manager_->CreateIndex(index_name, table_name, key_columns,
+                                    schema, INVALID_PAGE_ID, is_unique,
+                                    index_type, include_columns);
     if (!index_success) {
         LOG_ERROR("TableManager::CreateIndex: Failed to create physical index");
         catalog_->DropIndex(index_name);  // 失败时清理catalog中的记录
@@ -187,7 +293,7 @@ bool TableManager::CreateIndex(const std::string& index_name,
 
     // 用表中现有的数据填充新创建的索引
     bool populate_success =
-        PopulateIndexWithExistingData(index_name, table_info, key_columns);
+        PopulateIndexWithExistingData(index_name, table_info, stored_columns);
     if (!populate_success) {
         LOG_WARN(
             "TableManager::CreateIndex: Failed to populate index with existing "
@@ -212,16 +318,57 @@ bool TableManager::CreateIndex(const std::string& index_name,
     return true;
 }
 
+/**
+ * 在分区表上创建索引
+ * 实现思路：
+ * 1. 唯一索引只能在每个分区内检查唯一性，所以键列必须包含分区列，
+ *    这样相同的键一定在同一个分区
+ * 2. 在每个分区子表上创建同样的索引，名字是PartitionIndexName，
+ *    中途失败时删掉已经建好的
+ */
+bool TableManager::CreatePartitionedIndex(
+    const std::string& index_name, TableInfo* table_info,
+    const std::vector<std::string>& key_columns, bool is_unique,
+    IndexType index_type, const std::vector<std::string>& include_columns) {
+    const PartitionScheme& scheme = *table_info->partition_scheme;
+    if (is_unique &&
+        std::find(key_columns.begin(), key_columns.end(),
+                  scheme.column_name) == key_columns.end()) {
+        LOG_ERROR("TableManager::CreateIndex: Unique index "
+                  << index_name << " on partitioned table "
+                  << table_info->table_name
+                  << " must include the partition column "
+                  << scheme.column_name);
+        return false;
+    }
+
+    std::vector<TableInfo*> partitions = catalog_->GetPartitions(table_info);
+    if (partitions.empty()) {
+        LOG_ERROR("TableManager::CreateIndex: Partitions of table "
+                  << table_info->table_name << " not found");
+        return false;
+    }
+    for (size_t i = 0; i < partitions.size(); i++) {
+        if (!CreateIndex(PartitionScheme::PartitionIndexName(index_name, i),
+                         partitions[i]->table_name, key_columns, is_unique,
+                         index_type, include_columns)) {
+            for (size_t j = 0; j < i; j++) {
+                DropIndex(PartitionScheme::PartitionIndexName(index_name, j));
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * 用现有数据填充索引
  *
  * 填充流程：
  * 1. 验证表信息和索引列的有效性
  * 2. 遍历表中的所有记录
- * 3. 提取每条记录的索引键值
+ * 3. 提取每条记录在所有索引列上的值
  * 4. 将键值和RID插入到索引中
- *
- * 注意：目前只支持单列索引，多列索引需要后续实现
  */
 bool TableManager::PopulateIndexWithExistingData(
     const std::string& index_name, TableInfo* table_info,
@@ -236,82 +383,60 @@ bool TableManager::PopulateIndexWithExistingData(
         return false;
     }
 
-    // 目前只支持单列索引，多列索引是未来的扩展方向
-    if (key_columns.size() != 1) {
-        LOG_ERROR(
-            "TableManager::PopulateIndexWithExistingData: Multi-column indexes "
-            "not supported");
-        return false;
-    }
-
-    const std::string& column_name = key_columns[0];
     const Schema* schema = table_info->schema.get();
 
     try {
-        // 获取索引列在schema中的位置和类型信息
-        size_t column_idx = schema->GetColumnIdx(column_name);
-        const Column& column = schema->GetColumn(column_idx);
+        // 获取索引列在schema中的位置
+        std::vector<size_t> column_indexes;
+        for (const auto& column_name : key_columns) {
+            column_indexes.push_back(schema->GetColumnIdx(column_name));
+        }
 
-        LOG_DEBUG(
-            "TableManager::PopulateIndexWithExistingData: Processing column "
-            << column_name << " of type " << static_cast<int>(column.type));
+        LOG_DEBUG("TableManager::PopulateIndexWithExistingData: Processing "
+                  << key_columns.size() << " key columns");
 
         // 获取表的迭代器，准备遍历所有记录
         auto iter = table_info->table_heap->Begin();
-        auto end_iter = table_info->table_heap->End();
 
         // 统计处理结果
         int processed_count = 0;
-        int success_count = 0;
         int error_count = 0;
 
-        // 遍历表中的每一条记录
-        while (!iter.IsEnd()) {
-            try {
-                Tuple tuple = *iter;
-                RID rid = tuple.GetRID();
-
-                // 从tuple中提取索引键值
-                Value key_value = tuple.GetValue(column_idx);
-
-                // 将键值和RID插入到索引中
-                bool insert_success =
-                    index_manager_->InsertEntry(index_name, key_value, rid);
-                if (insert_success) {
-                    success_count++;
-                } else {
-                    error_count++;
-                    LOG_WARN(
-                        "TableManager::PopulateIndexWithExistingData: Failed "
-                        "to insert key into index");
-                }
-
-                processed_count++;
-
-                // 每处理1000条记录输出一次进度日志
-                if (processed_count % 1000 == 0) {
-                    LOG_DEBUG(
-                        "TableManager::PopulateIndexWithExistingData: "
-                        "Processed "
-                        << processed_count << " records");
+        // 所有记录交给索引管理器排序后一次建好整棵树，
+        // 回调每次从表中取出下一条记录的键值和RID
+        bool build_success = index_manager_->BuildIndex(
+            index_name, [&](std::vector<Value>* key_values, RID* rid) {
+                while (!iter.IsEnd()) {
+                    try {
+                        Tuple tuple = *iter;
+                        *rid = tuple.GetRID();
+                        key_values->clear();
+                        for (size_t column_idx : column_indexes) {
+                            key_values->push_back(tuple.GetValue(column_idx));
+                        }
+                        ++iter;
+                        processed_count++;
+                        return true;
+                    } catch (const std::exception& e) {
+                        LOG_ERROR(
+                            "TableManager::PopulateIndexWithExistingData: "
+                            "Exception processing record: "
+                            << e.what());
+                        error_count++;
+                        ++iter;  // 即使出错也继续处理下一条记录
+                    }
                 }
-
-                ++iter;
-            } catch (const std::exception& e) {
-                LOG_ERROR(
-                    "TableManager::PopulateIndexWithExistingData: Exception "
-                    "processing record: "
-                    << e.what());
-                error_count++;
-                ++iter;  // 即使出错也继续处理下一条记录
-            }
+                return false;
+            });
+        if (!build_success) {
+            error_count++;
         }
 
         LOG_INFO(
             "TableManager::PopulateIndexWithExistingData: Finished populating "
             "index "
             << index_name << ". Processed: " << processed_count
-            << ", Success: " << success_count << ", Errors: " << error_count);
+            << ", Errors: " << error_count);
 
         // 只有所有记录都成功插入才返回true
         return error_count == 0;
@@ -334,12 +459,23 @@ bool TableManager::PopulateIndexWithExistingData(
 bool TableManager::DropIndex(const std::string& index_name) {
     LOG_DEBUG("TableManager::DropIndex: Dropping index " << index_name);
 
-    // 检查索引是否存在
+    // 检查索引是否存在，分区表上的索引删除它在每个分区上的索引
     IndexInfo* index_info = catalog_->GetIndex(index_name);
     if (index_info == nullptr) {
-        LOG_WARN("TableManager::DropIndex: Index " << index_name
-                                                   << " not found");
-        return false;
+        bool dropped = false;
+        for (size_t i = 0; i < MAX_TABLE_PARTITIONS; i++) {
+            std::string partition_index =
+                PartitionScheme::PartitionIndexName(index_name, i);
+            if (catalog_->GetIndex(partition_index) == nullptr) {
+                break;
+            }
+            dropped = DropIndex(partition_index) || dropped;
+        }
+        if (!dropped) {
+            LOG_WARN("TableManager::DropIndex: Index " << index_name
+                                                       << " not found");
+        }
+        return dropped;
     }
 
     // 从索引管理器中删除物理索引
@@ -405,15 +541,6 @@ bool TableManager::UpdateIndexesOnInsert(const std::string& table_name,
             continue;
         }
 
-        // 目前只支持单列索引
-        if (index_info->key_columns.size() != 1) {
-            LOG_WARN(
-                "TableManager::UpdateIndexesOnInsert: Multi-column index not "
-                "supported: "
-                << index_name);
-            continue;
-        }
-
         try {
             TableInfo* table_info = catalog_->GetTable(table_name);
             if (!table_info) {
@@ -425,9 +552,8 @@ bool TableManager::UpdateIndexesOnInsert(const std::string& table_name,
             }
 
             // 提取索引键值
-            const std::string& column_name = index_info->key_columns[0];
-            size_t column_idx = table_info->schema->GetColumnIdx(column_name);
-            Value key_value = tuple.GetValue(column_idx);
+            std::vector<Value> key_values =
+                ExtractIndexKeys(*index_info, *table_info->schema, tuple);
 
             // 添加超时保护，避免索引操作阻塞太久
             auto start_time = std::chrono::steady_clock::now();
@@ -436,7 +562,7 @@ bool TableManager::UpdateIndexesOnInsert(const std::string& table_name,
             bool success = false;
             try {
                 success =
-                    index_manager_->InsertEntry(index_name, key_value, rid);
+                    index_manager_->InsertEntry(index_name, key_values, rid);
 
                 auto current_time = std::chrono::steady_clock::now();
                 if (current_time - start_time > TIMEOUT_DURATION) {
@@ -476,6 +602,149 @@ bool TableManager::UpdateIndexesOnInsert(const std::string& table_name,
     return all_success;
 }
 
+/**
+ * 批量插入记录时更新索引
+ *
+ * 实现思路：
+ * 1. 获取该表的所有索引，逐个索引处理
+ * 2. 提取所有新记录的键值，和RID一起按键排序
+ * 3. 按顺序插入，失败的条目记日志后继续
+ */
+bool TableManager::UpdateIndexesOnBulkInsert(const std::string& table_name,
+                                             const std::vector<Tuple>& tuples,
+                                             const std::vector<RID>& rids) {
+    if (!index_manager_ || rids.empty()) {
+        return true;
+    }
+
+    std::vector<std::string> table_indexes;
+    try {
+        table_indexes = index_manager_->GetTableIndexes(table_name);
+    } catch (const std::exception& e) {
+        LOG_ERROR(
+            "TableManager::UpdateIndexesOnBulkInsert: Failed to get table "
+            "indexes: "
+            << e.what());
+        return false;
+    }
+    if (table_indexes.empty()) {
+        return true;
+    }
+
+    TableInfo* table_info = catalog_->GetTable(table_name);
+    if (!table_info) {
+        LOG_ERROR("TableManager::UpdateIndexesOnBulkInsert: Table info not "
+                  "found");
+        return false;
+    }
+
+    bool all_success = true;
+    for (const auto& index_name : table_indexes) {
+        IndexInfo* index_info = catalog_->GetIndex(index_name);
+        if (!index_info) {
+            LOG_WARN("TableManager::UpdateIndexesOnBulkInsert: Index info not "
+                     "found for "
+                     << index_name);
+            continue;
+        }
+
+        try {
+            std::vector<std::pair<std::vector<Value>, RID>> entries;
+            entries.reserve(rids.size());
+            for (size_t i = 0; i < rids.size(); i++) {
+                entries.emplace_back(
+                    ExtractIndexKeys(*index_info, *table_info->schema,
+                                     tuples[i]),
+                    rids[i]);
+            }
+            std::stable_sort(entries.begin(), entries.end(),
+                             [](const auto& a, const auto& b) {
+                                 return a.first < b.first;
+                             });
+
+            size_t failed = 0;
+            for (const auto& [key, rid] : entries) {
+                if (!index_manager_->InsertEntry(index_name, key, rid)) {
+                    failed++;
+                }
+            }
+            if (failed > 0) {
+                LOG_WARN("TableManager::UpdateIndexesOnBulkInsert: "
+                         << failed << " of " << entries.size()
+                         << " entries failed for index " << index_name);
+                all_success = false;
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR(
+                "TableManager::UpdateIndexesOnBulkInsert: Exception updating "
+                "index "
+                << index_name << ": " << e.what());
+            all_success = false;
+        }
+    }
+    return all_success;
+}
+
+/**
+ * 批量装载后更新索引
+ *
+ * 实现思路：
+ * 1. 获取该表的所有索引，逐个索引处理
+ * 2. 按装载顺序读回记录，RID是连续追加的，读表堆基本是顺序的
+ * 3. 键和RID交给BuildIndex排序后构建，失败的索引记日志后继续
+ */
+bool TableManager::UpdateIndexesOnCopy(const std::string& table_name,
+                                       const std::vector<RID>& rids) {
+    if (!index_manager_ || rids.empty()) {
+        return true;
+    }
+    TableInfo* table_info = catalog_->GetTable(table_name);
+    if (!table_info) {
+        LOG_ERROR("TableManager::UpdateIndexesOnCopy: Table info not found");
+        return false;
+    }
+
+    bool all_success = true;
+    for (IndexInfo* index_info : catalog_->GetTableIndexes(table_name)) {
+        std::vector<size_t> column_indexes;
+        for (const auto& column_name :
+             StoredIndexColumns(index_info->key_columns,
+                                index_info->include_columns)) {
+            column_indexes.push_back(
+                table_info->schema->GetColumnIdx(column_name));
+        }
+
+        size_t next = 0;
+        size_t unreadable = 0;
+        Tuple tuple;
+        bool success = index_manager_->BuildIndex(
+            index_info->index_name,
+            [&](std::vector<Value>* key_values, RID* rid) {
+                while (next < rids.size()) {
+                    *rid = rids[next++];
+                    if (!table_info->table_heap->GetTuple(*rid, &tuple,
+                                                          INVALID_TXN_ID)) {
+                        unreadable++;
+                        continue;
+                    }
+                    key_values->clear();
+                    for (size_t column_idx : column_indexes) {
+                        key_values->push_back(tuple.GetValue(column_idx));
+                    }
+                    return true;
+                }
+                return false;
+            });
+        if (!success || unreadable > 0) {
+            LOG_WARN("TableManager::UpdateIndexesOnCopy: index "
+                     << index_info->index_name << " is incomplete, "
+                     << unreadable << " loaded rows could not be read");
+            all_success = false;
+        }
+    }
+    return all_success;
+}
+
 /**
  * 删除记录时更新索引
  *
@@ -504,15 +773,6 @@ bool TableManager::UpdateIndexesOnDelete(const std::string& table_name,
             continue;
         }
 
-        // 目前只支持单列索引
-        if (index_info->key_columns.size() != 1) {
-            LOG_WARN(
-                "TableManager::UpdateIndexesOnDelete: Multi-column index not "
-                "supported: "
-                << index_name);
-            continue;
-        }
-
         try {
             TableInfo* table_info = catalog_->GetTable(table_name);
             if (!table_info) {
@@ -524,12 +784,12 @@ bool TableManager::UpdateIndexesOnDelete(const std::string& table_name,
             }
 
             // 提取要删除的键值
-            const std::string& column_name = index_info->key_columns[0];
-            size_t column_idx = table_info->schema->GetColumnIdx(column_name);
-            Value key_value = tuple.GetValue(column_idx);
+            std::vector<Value> key_values =
+                ExtractIndexKeys(*index_info, *table_info->schema, tuple);
 
-            // 从索引中删除该键值
-            bool success = index_manager_->DeleteEntry(index_name, key_value);
+            // 从索引中删除该记录对应的条目，非唯一索引只删除这一条
+            bool success = index_manager_->DeleteEntry(index_name, key_values,
+                                                       tuple.GetRID());
             if (!success) {
                 LOG_WARN(
                     "TableManager::UpdateIndexesOnDelete: Failed to delete "
@@ -566,6 +826,19 @@ bool TableManager::UpdateIndexesOnUpdate(const std::string& table_name,
                                          const Tuple& old_tuple,
                                          const Tuple& new_tuple,
                                          const RID& rid) {
+    return UpdateIndexesOnUpdate(table_name, old_tuple, new_tuple, rid, rid);
+}
+
+/**
+ * 更新记录时更新相关索引，记录可能换了位置
+ * 实现思路：逐个索引比较新旧键值，键值和位置都没变的索引不动，
+ * 否则删除(旧键, old_rid)再插入(新键, new_rid)
+ */
+bool TableManager::UpdateIndexesOnUpdate(const std::string& table_name,
+                                         const Tuple& old_tuple,
+                                         const Tuple& new_tuple,
+                                         const RID& old_rid,
+                                         const RID& new_rid) {
     LOG_TRACE("TableManager::UpdateIndexesOnUpdate: Updating indexes for table "
               << table_name);
 
@@ -582,15 +855,6 @@ bool TableManager::UpdateIndexesOnUpdate(const std::string& table_name,
             continue;
         }
 
-        // 目前只支持单列索引
-        if (index_info->key_columns.size() != 1) {
-            LOG_WARN(
-                "TableManager::UpdateIndexesOnUpdate: Multi-column index not "
-                "supported: "
-                << index_name);
-            continue;
-        }
-
         try {
             TableInfo* table_info = catalog_->GetTable(table_name);
             if (!table_info) {
@@ -602,32 +866,20 @@ bool TableManager::UpdateIndexesOnUpdate(const std::string& table_name,
             }
 
             // 提取新旧记录的键值
-            const std::string& column_name = index_info->key_columns[0];
-            size_t column_idx = table_info->schema->GetColumnIdx(column_name);
-            Value old_key_value = old_tuple.GetValue(column_idx);
-            Value new_key_value = new_tuple.GetValue(column_idx);
+            std::vector<Value> old_key_values =
+                ExtractIndexKeys(*index_info, *table_info->schema, old_tuple);
+            std::vector<Value> new_key_values =
+                ExtractIndexKeys(*index_info, *table_info->schema, new_tuple);
 
             // 检查键值是否真的改变了
-            // 只有键值发生变化时才需要更新索引
-            if (old_key_value.index() == new_key_value.index()) {
-                bool keys_equal = false;
-                std::visit(
-                    [&](const auto& old_val) {
-                        using T = std::decay_t<decltype(old_val)>;
-                        if (std::holds_alternative<T>(new_key_value)) {
-                            keys_equal =
-                                (old_val == std::get<T>(new_key_value));
-                        }
-                    },
-                    old_key_value);
-                if (keys_equal) {
-                    continue;  // 键值没有改变，跳过该索引
-                }
+            // 只有键值或者记录位置发生变化时才需要更新索引
+            if (old_key_values == new_key_values && old_rid == new_rid) {
+                continue;  // 键值没有改变，跳过该索引
             }
 
             // 先删除旧的键值，再插入新的键值
-            bool delete_success =
-                index_manager_->DeleteEntry(index_name, old_key_value);
+            bool delete_success = index_manager_->DeleteEntry(
+                index_name, old_key_values, old_rid);
             if (!delete_success) {
                 LOG_WARN(
                     "TableManager::UpdateIndexesOnUpdate: Failed to delete old "
@@ -636,8 +888,8 @@ bool TableManager::UpdateIndexesOnUpdate(const std::string& table_name,
                 all_success = false;
             }
 
-            bool insert_success =
-                index_manager_->InsertEntry(index_name, new_key_value, rid);
+            bool insert_success = index_manager_->InsertEntry(
+                index_name, new_key_values, new_rid);
             if (!insert_success) {
                 LOG_WARN(
                     "TableManager::UpdateIndexesOnUpdate: Failed to insert new "
@@ -645,7 +897,8 @@ bool TableManager::UpdateIndexesOnUpdate(const std::string& table_name,
                     << index_name);
                 all_success = false;
                 // 尝试回滚，恢复旧的键值
-                index_manager_->InsertEntry(index_name, old_key_value, rid);
+                index_manager_->InsertEntry(index_name, old_key_values,
+                                            old_rid);
             }
         } catch (const std::exception& e) {
             LOG_ERROR(
@@ -696,7 +949,25 @@ bool TableManager::CreateTable(const CreateTableStatement* stmt) {
 
     // 创建schema并在catalog中创建表
     Schema schema(columns);
-    bool success = catalog_->CreateTable(table_name, schema);
+    std::string reason;
+    if (stmt->GetStorage() == TableStorage::COLUMN &&
+        !ColumnStore::IsSupportedSchema(schema, &reason)) {
+        LOG_ERROR("TableManager::CreateTable: Table " << table_name
+                                                      << ": " << reason);
+        return false;
+    }
+    bool success;
+    if (stmt->GetPartitionScheme()) {
+        PartitionScheme scheme = *stmt->GetPartitionScheme();
+        if (!PreparePartitionScheme(table_name, schema, &scheme)) {
+            return false;
+        }
+        success = catalog_->CreatePartitionedTable(table_name, schema, scheme,
+                                                   stmt->GetCompression());
+    } else {
+        success = catalog_->CreateTable(table_name, schema, stmt->GetStorage(),
+                                        stmt->GetCompression());
+    }
     if (!success) {
         LOG_ERROR("TableManager::CreateTable: Failed to create table "
                   << table_name);
@@ -717,8 +988,17 @@ bool TableManager::CreateTable(const CreateTableStatement* stmt) {
         }
     }
 
-    // 如果有主键列，创建主键索引
-    if (!primary_key_column.empty()) {
+    // 分区表的主键索引建在每个分区上
+    if (!primary_key_column.empty() && stmt->GetPartitionScheme()) {
+        if (!CreateIndex(table_name + "_pk", table_name, {primary_key_column})) {
+            LOG_ERROR(
+                "TableManager::CreateTable: Failed to create primary key index "
+                "on partitions of "
+                << table_name);
+            DropTable(table_name);
+            return false;
+        }
+    } else if (!primary_key_column.empty()) {
         std::string primary_key_index_name = table_name + "_pk";
         std::vector<std::string> key_columns = {primary_key_column};
 
@@ -796,6 +1076,40 @@ bool TableManager::CreateTable(const CreateTableStatement* stmt) {
     return true;
 }
 
+/**
+ * 检查并补全分区方式
+ * 实现思路：分区列必须存在，按schema填上它的位置和类型后检查分区方式；
+ * 主键只能在分区内检查唯一性，所以有主键时它必须就是分区列
+ */
+bool TableManager::PreparePartitionScheme(const std::string& table_name,
+                                          const Schema& schema,
+                                          PartitionScheme* scheme) {
+    if (!schema.HasColumn(scheme->column_name)) {
+        LOG_ERROR("TableManager::CreateTable: Partition column "
+                  << scheme->column_name << " not found in table "
+                  << table_name);
+        return false;
+    }
+    scheme->column_index = schema.GetColumnIdx(scheme->column_name);
+    scheme->column_type = schema.GetColumn(scheme->column_index).type;
+    std::string reason;
+    if (!scheme->Validate(&reason)) {
+        LOG_ERROR("TableManager::CreateTable: Table " << table_name << ": "
+                                                      << reason);
+        return false;
+    }
+    for (const auto& column : schema.GetColumns()) {
+        if (column.is_primary_key && column.name != scheme->column_name) {
+            LOG_ERROR("TableManager::CreateTable: Primary key of partitioned "
+                      "table "
+                      << table_name << " must be the partition column "
+                      << scheme->column_name);
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * 删除表
  *
@@ -817,6 +1131,12 @@ bool TableManager::DropTable(const std::string& table_name) {
         return false;
     }
 
+    // 分区表先删除各个分区子表和它们的索引
+    for (TableInfo* partition : catalog_->GetPartitions(table_info)) {
+        std::string partition_name = partition->table_name;
+        DropTable(partition_name);
+    }
+
     // 首先删除该表的所有索引
     // 必须先删除索引，因为索引依赖于表的存在
     std::vector<IndexInfo*> indexes = catalog_->GetTableIndexes(table_name);
@@ -843,4 +1163,42 @@ bool TableManager::DropTable(const std::string& table_name) {
     return success;
 }
 
+/**
+ * 回收表的空间
+ * 实现思路：表堆负责整理和搬动，搬动的记录键值没变但位置变了，
+ * 通过UpdateIndexesOnUpdate让每个索引删除旧项、插入指向新位置的项
+ */
+bool TableManager::VacuumTable(const std::string& table_name,
+                               txn_id_t txn_id) {
+    TableInfo* table_info = catalog_->GetTable(table_name);
+    if (table_info == nullptr || !table_info->table_heap) {
+        LOG_WARN("TableManager::VacuumTable: Table " << table_name
+                                                     << " not found");
+        return false;
+    }
+    if (table_info->storage == TableStorage::COLUMN) {
+        LOG_WARN("TableManager::VacuumTable: Table "
+                 << table_name << " uses append-only column storage");
+        return false;
+    }
+
+    auto stats = table_info->table_heap->Vacuum(
+        txn_id, [this, &table_name](const Tuple& tuple, const RID& old_rid,
+                                    const RID& new_rid) {
+            if (!UpdateIndexesOnUpdate(table_name, tuple, tuple, old_rid,
+                                       new_rid)) {
+                LOG_WARN("TableManager::VacuumTable: Failed to repoint "
+                         "indexes of moved row in "
+                         << table_name);
+            }
+        });
+    LOG_DEBUG("TableManager::VacuumTable: " << table_name << " compacted "
+                                            << stats.pages_compacted
+                                            << " pages, moved "
+                                            << stats.tuples_moved
+                                            << " rows, freed "
+                                            << stats.pages_freed << " pages");
+    return true;
+}
+
 }  // namespace SimpleRDBMS
\ No newline at end of file
@@ -23,7 +23,9 @@ class BufferPoolManager;
 class Catalog;
 class CreateTableStatement;
 class IndexManager;
+class Schema;
 class TableInfo;
+struct PartitionScheme;
 class Tuple;
 
 /**
@@ -95,6 +97,17 @@ class TableManager {
      */
     bool DropTable(const std::string& table_name);
 
+    /**
+     * 回收表里删除和更新留下的空间（VACUUM）
+     * @param table_name 表名
+     * @param txn_id 搬动记录时写日志用的事务ID
+     * @return 表不存在或者不是行存表时返回false
+     *
+     * 整理页面碎片、合并稀疏页面并释放搬空的页面，见TableHeap::Vacuum；
+     * 搬动的记录在所有索引里改为指向新的RID。调用者持有表的X锁
+     */
+    bool VacuumTable(const std::string& table_name, txn_id_t txn_id);
+
     // ======================== 索引操作接口 ========================
 
     /**
@@ -102,6 +115,10 @@ class TableManager {
      * @param index_name 索引名称，必须在系统中唯一
      * @param table_name 索引所属的表名
      * @param key_columns 索引的键列名列表
+     * @param is_unique 是否唯一索引，非唯一索引允许多条记录有相同的键
+     * @param index_type 索引结构，哈希索引只支持完整键的等值查找
+     * @param include_columns INCLUDE列，值存在B+树的索引项里，
+     *                        查询只用到键列和这些列时不用回表
      * @return 创建是否成功
      *
      * 创建流程：
@@ -114,7 +131,10 @@ class TableManager {
      */
     bool CreateIndex(const std::string& index_name,
                      const std::string& table_name,
-                     const std::vector<std::string>& key_columns);
+                     const std::vector<std::string>& key_columns,
+                     bool is_unique = true,
+                     IndexType index_type = IndexType::BPLUS_TREE,
+                     const std::vector<std::string>& include_columns = {});
 
     /**
      * 删除索引
@@ -148,6 +168,35 @@ class TableManager {
     bool UpdateIndexesOnInsert(const std::string& table_name,
                                const Tuple& tuple, const RID& rid);
 
+    /**
+     * 批量插入记录时更新相关索引
+     * @param table_name 表名
+     * @param tuples 新插入的记录，前rids.size()个有效
+     * @param rids 每条记录的标识符
+     * @return 所有索引更新是否都成功
+     *
+     * 和逐条调用UpdateIndexesOnInsert相比：
+     * 1. 索引列表和键所在列只查一次
+     * 2. 每个索引的键先排序再插入，相邻的键落在同一个叶子页面上，
+     *    B+树的路径页面一直留在缓冲池里
+     */
+    bool UpdateIndexesOnBulkInsert(const std::string& table_name,
+                                   const std::vector<Tuple>& tuples,
+                                   const std::vector<RID>& rids);
+
+    /**
+     * 批量装载（COPY FROM）结束后一次性维护相关索引
+     * @param table_name 表名
+     * @param rids 装载的所有记录，记录本身从表堆读回
+     * @return 所有索引更新是否都成功
+     *
+     * 和UpdateIndexesOnBulkInsert相比，装载过程中不需要把记录留在内存里：
+     * 每个索引按rids的顺序读回记录取出键，交给IndexManager::BuildIndex
+     * 外部排序，空索引自底向上批量构建，已有数据的索引按键的顺序逐条插入
+     */
+    bool UpdateIndexesOnCopy(const std::string& table_name,
+                             const std::vector<RID>& rids);
+
     /**
      * 删除记录时更新相关索引
      * @param table_name 表名
@@ -187,6 +236,18 @@ class TableManager {
                                const Tuple& old_tuple, const Tuple& new_tuple,
                                const RID& rid);
 
+    /**
+     * 更新时记录换了位置（原页面放不下新记录）时更新相关索引
+     * @param old_rid 更新前记录的位置
+     * @param new_rid 更新后记录的位置
+     *
+     * 位置不变时只维护键值变化的索引；位置变了所有索引项都指向旧位置，
+     * 每个索引都要删除旧项再插入新项
+     */
+    bool UpdateIndexesOnUpdate(const std::string& table_name,
+                               const Tuple& old_tuple, const Tuple& new_tuple,
+                               const RID& old_rid, const RID& new_rid);
+
     // ======================== 访问器接口 ========================
 
     /**
@@ -220,23 +281,39 @@ class TableManager {
      * 使用表中现有数据填充新创建的索引
      * @param index_name 索引名称
      * @param table_info 表信息，包含schema和table_heap
-     * @param key_columns 索引的键列名列表
+     * @param key_columns 索引项里存储的列，键列在前，INCLUDE列在后
      * @return 填充是否成功
      *
      * 填充流程：
      * 1. 验证表信息和索引列的有效性
      * 2. 遍历表中的所有记录
-     * 3. 提取每条记录的索引键值
-     * 4. 将键值和RID插入到索引中
+     * 3. 提取每条记录在所有索引列上的值
+     * 4. 键值和RID交给IndexManager::BuildIndex，排序后批量构建B+树
      * 5. 统计处理结果并记录日志
      *
-     * 注意：目前只支持单列索引，多列索引是未来的扩展方向
      * 这个方法在创建索引和系统启动时的索引重建中使用
      */
     bool PopulateIndexWithExistingData(
         const std::string& index_name, TableInfo* table_info,
         const std::vector<std::string>& key_columns);
 
+    /**
+     * 在分区表的每个分区上创建索引，参数同CreateIndex
+     * 唯一索引的键列必须包含分区列
+     */
+    bool CreatePartitionedIndex(
+        const std::string& index_name, TableInfo* table_info,
+        const std::vector<std::string>& key_columns, bool is_unique,
+        IndexType index_type, const std::vector<std::string>& include_columns);
+
+    /**
+     * 按schema补全分区列的位置和类型并检查分区方式
+     * @return 分区方式不合法时返回false
+     */
+    bool PreparePartitionScheme(const std::string& table_name,
+                                const Schema& schema,
+                                PartitionScheme* scheme);
+
     /**
      * 重建所有索引
      *
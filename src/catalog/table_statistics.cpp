@@ -0,0 +1,357 @@
+/*
+ * 文件: table_statistics.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 表和列统计信息的收集与选择率估计
+ */
+
+#include "catalog/table_statistics.h"
+
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "record/table_heap.h"
+
+namespace SimpleRDBMS {
+
+/** 没有可用统计信息时范围条件的选择率 */
+static constexpr double DEFAULT_RANGE_SELECTIVITY = 1.0 / 3.0;
+
+/** 数值类型的值转换成double，不是数值时返回false */
+static bool NumericValue(const Value& value, double* number) {
+    return std::visit(
+        [number](const auto& v) -> bool {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_arithmetic_v<T>) {
+                *number = static_cast<double>(v);
+                return true;
+            } else {
+                return false;
+            }
+        },
+        value);
+}
+
+bool CompareStatisticsValues(const Value& left, const Value& right,
+                             int* result) {
+    const auto* left_str = std::get_if<std::string>(&left);
+    const auto* right_str = std::get_if<std::string>(&right);
+    if (left_str != nullptr || right_str != nullptr) {
+        if (left_str == nullptr || right_str == nullptr) {
+            return false;
+        }
+        int cmp = left_str->compare(*right_str);
+        *result = cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+        return true;
+    }
+    double left_number = 0;
+    double right_number = 0;
+    if (!NumericValue(left, &left_number) ||
+        !NumericValue(right, &right_number)) {
+        return false;
+    }
+    *result = left_number < right_number
+                  ? -1
+                  : (left_number > right_number ? 1 : 0);
+    return true;
+}
+
+// ==================== ColumnStatistics ====================
+
+double ColumnStatistics::GetMostCommonFraction() const {
+    double total = 0;
+    for (const auto& [value, fraction] : most_common_values) {
+        total += fraction;
+    }
+    return total;
+}
+
+double ColumnStatistics::EstimateEqualSelectivity(const Value& value) const {
+    for (const auto& [mcv, fraction] : most_common_values) {
+        int cmp = 0;
+        if (CompareStatisticsValues(mcv, value, &cmp) && cmp == 0) {
+            return fraction;
+        }
+    }
+    double rest =
+        std::max(0.0, 1.0 - null_fraction - GetMostCommonFraction());
+    double other_distinct = std::max(
+        1.0, distinct_count - static_cast<double>(most_common_values.size()));
+    return rest / other_distinct;
+}
+
+/**
+ * 直方图里小于value的值的比例
+ * 实现思路：找到value所在的桶，前面的桶全部计入，
+ * 所在的桶数值类型按位置线性插值，其他类型算一半
+ */
+double ColumnStatistics::HistogramFractionBelow(const Value& value) const {
+    if (histogram_bounds.size() < 2) {
+        return -1;
+    }
+    size_t buckets = histogram_bounds.size() - 1;
+    int cmp = 0;
+    if (!CompareStatisticsValues(value, histogram_bounds.front(), &cmp)) {
+        return -1;
+    }
+    if (cmp <= 0) {
+        return 0;
+    }
+    CompareStatisticsValues(value, histogram_bounds.back(), &cmp);
+    if (cmp > 0) {
+        return 1;
+    }
+    size_t bucket = 0;
+    while (bucket + 1 < buckets) {
+        CompareStatisticsValues(value, histogram_bounds[bucket + 1], &cmp);
+        if (cmp <= 0) {
+            break;
+        }
+        bucket++;
+    }
+    double within = 0.5;
+    double low = 0;
+    double high = 0;
+    double number = 0;
+    if (NumericValue(histogram_bounds[bucket], &low) &&
+        NumericValue(histogram_bounds[bucket + 1], &high) &&
+        NumericValue(value, &number) && high > low) {
+        within = std::min(1.0, std::max(0.0, (number - low) / (high - low)));
+    }
+    return (static_cast<double>(bucket) + within) /
+           static_cast<double>(buckets);
+}
+
+/**
+ * 估计范围条件的选择率
+ * 实现思路：
+ * 1. 高频值逐个检查是否在范围内，在的话计入它的比例
+ * 2. 其余的非NULL值按直方图算出落在范围里的比例，乘以它们占的比例
+ * 3. 没有直方图（比如所有值都是高频值）时第2部分用默认选择率
+ */
+double ColumnStatistics::EstimateRangeSelectivity(const Value* lower,
+                                                  bool lower_inclusive,
+                                                  const Value* upper,
+                                                  bool upper_inclusive) const {
+    double selectivity = 0;
+    for (const auto& [mcv, fraction] : most_common_values) {
+        int cmp = 0;
+        bool in_range = true;
+        if (lower != nullptr) {
+            if (!CompareStatisticsValues(mcv, *lower, &cmp)) {
+                return DEFAULT_RANGE_SELECTIVITY;
+            }
+            in_range = cmp > 0 || (cmp == 0 && lower_inclusive);
+        }
+        if (in_range && upper != nullptr) {
+            if (!CompareStatisticsValues(mcv, *upper, &cmp)) {
+                return DEFAULT_RANGE_SELECTIVITY;
+            }
+            in_range = cmp < 0 || (cmp == 0 && upper_inclusive);
+        }
+        if (in_range) {
+            selectivity += fraction;
+        }
+    }
+
+    double rest =
+        std::max(0.0, 1.0 - null_fraction - GetMostCommonFraction());
+    double below_upper =
+        upper != nullptr ? HistogramFractionBelow(*upper) : 1.0;
+    double below_lower =
+        lower != nullptr ? HistogramFractionBelow(*lower) : 0.0;
+    if (below_upper < 0 || below_lower < 0) {
+        selectivity += rest * DEFAULT_RANGE_SELECTIVITY;
+    } else {
+        selectivity += rest * std::max(0.0, below_upper - below_lower);
+    }
+    return std::min(1.0, selectivity);
+}
+
+// ==================== TableStatistics ====================
+
+/** 按统计用的比较规则排序，不可比的值按variant的类型排在一起 */
+static bool StatisticsValueLess(const Value& left, const Value& right) {
+    int cmp = 0;
+    if (CompareStatisticsValues(left, right, &cmp)) {
+        return cmp < 0;
+    }
+    return left.index() < right.index();
+}
+
+static bool StatisticsValueEqual(const Value& left, const Value& right) {
+    int cmp = 0;
+    return CompareStatisticsValues(left, right, &cmp) && cmp == 0;
+}
+
+/**
+ * 由一列的样本计算列统计
+ * 实现思路：
+ * 1. 排序后按相等的值分组，得到每个值在样本里的出现次数
+ * 2. 不同值个数：Duj1估计量 n*d / (n - f1 + f1*n/N)，
+ *    n是样本的非NULL行数，d是样本里的不同值个数，f1是只出现一次的值个数，
+ *    N是全表的非NULL行数
+ * 3. 不同值不超过STATISTICS_MCV_COUNT个时全部作为高频值；否则取出现次数
+ *    至少2次并且超过平均次数1.25倍的值，最多STATISTICS_MCV_COUNT个
+ * 4. 其余的值排好序，按等间隔的位置取出直方图的桶边界
+ */
+static ColumnStatistics BuildColumnStatistics(std::vector<Value> values,
+                                              size_t sample_rows,
+                                              size_t row_count) {
+    ColumnStatistics stats;
+    if (sample_rows == 0) {
+        return stats;
+    }
+    double sample = static_cast<double>(sample_rows);
+    stats.null_fraction =
+        static_cast<double>(sample_rows - values.size()) / sample;
+    if (values.empty()) {
+        return stats;
+    }
+
+    std::sort(values.begin(), values.end(), StatisticsValueLess);
+    std::vector<std::pair<size_t, size_t>> groups;  // (第一个下标, 次数)
+    for (size_t i = 0; i < values.size(); i++) {
+        if (groups.empty() ||
+            !StatisticsValueEqual(values[groups.back().first], values[i])) {
+            groups.emplace_back(i, 0);
+        }
+        groups.back().second++;
+    }
+
+    double n = static_cast<double>(values.size());
+    double d = static_cast<double>(groups.size());
+    double f1 = 0;
+    for (const auto& group : groups) {
+        if (group.second == 1) {
+            f1++;
+        }
+    }
+    double total_non_null =
+        static_cast<double>(row_count) * (1.0 - stats.null_fraction);
+    if (total_non_null <= n) {
+        stats.distinct_count = d;
+    } else {
+        stats.distinct_count = n * d / (n - f1 + f1 * n / total_non_null);
+        stats.distinct_count =
+            std::min(total_non_null, std::max(d, stats.distinct_count));
+    }
+
+    std::vector<size_t> mcv_groups;
+    if (groups.size() <= STATISTICS_MCV_COUNT) {
+        for (size_t g = 0; g < groups.size(); g++) {
+            mcv_groups.push_back(g);
+        }
+    } else {
+        std::vector<size_t> order(groups.size());
+        for (size_t g = 0; g < groups.size(); g++) {
+            order[g] = g;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&groups](size_t left, size_t right) {
+                             return groups[left].second > groups[right].second;
+                         });
+        double threshold = 1.25 * n / d;
+        for (size_t g : order) {
+            if (mcv_groups.size() >= STATISTICS_MCV_COUNT ||
+                groups[g].second < 2 ||
+                static_cast<double>(groups[g].second) <= threshold) {
+                break;
+            }
+            mcv_groups.push_back(g);
+        }
+        std::sort(mcv_groups.begin(), mcv_groups.end());
+    }
+
+    std::vector<Value> rest;
+    size_t next_mcv = 0;
+    for (size_t g = 0; g < groups.size(); g++) {
+        const auto& [first, count] = groups[g];
+        if (next_mcv < mcv_groups.size() && mcv_groups[next_mcv] == g) {
+            stats.most_common_values.emplace_back(
+                values[first], static_cast<double>(count) / sample);
+            next_mcv++;
+            continue;
+        }
+        for (size_t i = first; i < first + count; i++) {
+            rest.push_back(values[i]);
+        }
+    }
+
+    size_t rest_distinct = groups.size() - mcv_groups.size();
+    if (rest.size() >= 2 && rest_distinct >= 2) {
+        size_t buckets =
+            std::min(STATISTICS_HISTOGRAM_BUCKETS, rest_distinct - 1);
+        for (size_t b = 0; b <= buckets; b++) {
+            stats.histogram_bounds.push_back(
+                rest[b * (rest.size() - 1) / buckets]);
+        }
+    }
+    return stats;
+}
+
+/**
+ * 收集表的统计信息
+ * 实现思路：
+ * 1. 用批量读取策略扫描整张表，精确统计行数
+ * 2. 前STATISTICS_SAMPLE_ROWS行直接放进样本，之后的第i行以
+ *    样本大小/i的概率替换样本里随机的一行（蓄水池抽样），
+ *    随机数种子固定，同样的表得到同样的统计
+ * 3. 按列计算样本的统计信息
+ */
+std::shared_ptr<TableStatistics> TableStatistics::Collect(
+    BufferPoolManager* buffer_pool_manager, TableHeap* table_heap,
+    const Schema* schema) {
+    auto stats = std::make_shared<TableStatistics>();
+    size_t column_count = schema->GetColumnCount();
+    std::vector<std::vector<std::optional<Value>>> samples;
+    std::mt19937_64 random(0x5eed);
+
+    for (auto it =
+             table_heap->Begin(buffer_pool_manager->CreateBulkReadStrategy());
+         !it.IsEnd(); ++it) {
+        stats->row_count++;
+        size_t slot = samples.size();
+        if (samples.size() >= STATISTICS_SAMPLE_ROWS) {
+            slot = static_cast<size_t>(random() % stats->row_count);
+            if (slot >= STATISTICS_SAMPLE_ROWS) {
+                continue;
+            }
+        }
+        Tuple tuple = *it;
+        std::vector<std::optional<Value>> row(column_count);
+        for (size_t c = 0; c < column_count; c++) {
+            if (!tuple.IsNull(c)) {
+                row[c] = tuple.GetValue(c);
+            }
+        }
+        if (slot == samples.size()) {
+            samples.push_back(std::move(row));
+        } else {
+            samples[slot] = std::move(row);
+        }
+    }
+    stats->page_count = table_heap->GetPageCount();
+    stats->sample_rows = samples.size();
+
+    for (size_t c = 0; c < column_count; c++) {
+        std::vector<Value> values;
+        values.reserve(samples.size());
+        for (const auto& row : samples) {
+            if (row[c].has_value()) {
+                values.push_back(*row[c]);
+            }
+        }
+        stats->columns.push_back(BuildColumnStatistics(
+            std::move(values), samples.size(), stats->row_count));
+    }
+    return stats;
+}
+
+}  // namespace SimpleRDBMS
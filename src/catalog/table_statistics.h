@@ -0,0 +1,100 @@
+/*
+ * 文件: table_statistics.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: ANALYZE收集的表和列统计信息：行数、页面数、每列的NULL比例、
+ *       不同值个数、高频值和等深直方图，优化器据此估计条件的选择率
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/types.h"
+
+namespace SimpleRDBMS {
+
+class BufferPoolManager;
+class Schema;
+class TableHeap;
+
+/**
+ * ColumnStatistics - 一列的统计信息
+ *
+ * 设计思路：
+ * - 出现次数明显高于平均的值记为高频值（MCV），连同它的行数比例，
+ *   等值条件命中高频值时直接用它的比例
+ * - 高频值以外的非NULL值做等深直方图：bounds把这些值按顺序分成
+ *   个数相同的桶，范围条件按落在范围里的桶数（数值类型在桶内线性插值）
+ *   估计比例
+ * - 所有比例都相对于表的总行数，NULL、高频值、直方图三部分加起来是1
+ * - 数值类型之间按数值比较，字符串按字典序比较，类型不可比时返回默认值
+ */
+struct ColumnStatistics {
+    double null_fraction = 0.0;  // NULL行的比例
+    double distinct_count = 0;   // 不同的非NULL值个数的估计
+    std::vector<std::pair<Value, double>> most_common_values;  // 值和比例
+    std::vector<Value> histogram_bounds;  // 等深直方图的桶边界，从小到大
+
+    /** 高频值的比例之和 */
+    double GetMostCommonFraction() const;
+
+    /**
+     * 估计 列 = value 的选择率
+     * 不是高频值时，剩下的比例平均分给其余的不同值
+     */
+    double EstimateEqualSelectivity(const Value& value) const;
+
+    /**
+     * 估计范围条件的选择率
+     * @param lower 下界，nullptr表示没有下界
+     * @param upper 上界，nullptr表示没有上界
+     * 边界是否包含等值只影响高频值，直方图部分不区分
+     */
+    double EstimateRangeSelectivity(const Value* lower, bool lower_inclusive,
+                                    const Value* upper,
+                                    bool upper_inclusive) const;
+
+   private:
+    /** 直方图里小于value的值的比例（0到1），直方图为空时返回-1 */
+    double HistogramFractionBelow(const Value& value) const;
+};
+
+/**
+ * TableStatistics - 一张表的统计信息
+ *
+ * 由ANALYZE扫描整张表生成：行数和页面数是精确值，列统计来自最多
+ * STATISTICS_SAMPLE_ROWS行的蓄水池样本；不同值个数用Haas-Stokes的
+ * Duj1估计量从样本推算，样本就是整张表时是精确值
+ * 统计信息只在内存里，重启或者表结构变化后需要重新ANALYZE
+ */
+struct TableStatistics {
+    size_t row_count = 0;
+    size_t page_count = 0;
+    size_t sample_rows = 0;                // 用来计算列统计的行数
+    std::vector<ColumnStatistics> columns;  // 按schema的列顺序
+
+    /**
+     * 扫描表堆收集统计信息
+     * @param buffer_pool_manager 缓冲池管理器，扫描用批量读取策略
+     * @param table_heap 表堆
+     * @param schema 表的schema
+     */
+    static std::shared_ptr<TableStatistics> Collect(
+        BufferPoolManager* buffer_pool_manager, TableHeap* table_heap,
+        const Schema* schema);
+};
+
+/**
+ * 比较两个统计用的值
+ * @param result 输出参数，小于、等于、大于分别为-1、0、1
+ * @return 两个值不可比（比如数值和字符串）时返回false
+ */
+bool CompareStatisticsValues(const Value& left, const Value& right,
+                             int* result);
+
+}  // namespace SimpleRDBMS
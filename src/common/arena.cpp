@@ -0,0 +1,138 @@
+/*
+ * 文件: arena.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 查询级内存池实现
+ */
+
+#include "common/arena.h"
+
+#include <algorithm>
+#include <new>
+
+namespace SimpleRDBMS {
+
+namespace {
+
+// 对象头的大小，保证头后面的对象仍然按max_align_t对齐
+constexpr size_t OBJECT_HEADER_SIZE = alignof(std::max_align_t);
+constexpr uintptr_t FROM_HEAP = 0;
+constexpr uintptr_t FROM_ARENA = 1;
+
+thread_local QueryArena* current_arena = nullptr;
+thread_local bool thread_arena_in_use = false;
+
+QueryArena& GetThreadArena() {
+    thread_local QueryArena arena;
+    return arena;
+}
+
+}  // namespace
+
+QueryArena::QueryArena(size_t block_size)
+    : block_size_(std::max(block_size, OBJECT_HEADER_SIZE)) {}
+
+QueryArena::~QueryArena() {
+    for (auto& block : blocks_) {
+        ::operator delete(block.data);
+    }
+}
+
+void QueryArena::AddBlock(size_t min_size) {
+    size_t size = blocks_.empty()
+                      ? block_size_
+                      : std::min(blocks_.back().size * 2, MAX_BLOCK_SIZE);
+    size = std::max(size, min_size);
+    char* data = static_cast<char*>(::operator new(size));
+    blocks_.push_back({data, size});
+    cursor_ = data;
+    limit_ = data + size;
+}
+
+/**
+ * 分配
+ * 先在当前块里按对齐要求往后挪指针，放不下就申请新块；
+ * 新块至少能放下这次分配加上最坏情况的对齐填充
+ */
+void* QueryArena::Allocate(size_t size, size_t alignment) {
+    uintptr_t current = reinterpret_cast<uintptr_t>(cursor_);
+    uintptr_t aligned = (current + alignment - 1) & ~(alignment - 1);
+    if (cursor_ == nullptr ||
+        aligned + size > reinterpret_cast<uintptr_t>(limit_)) {
+        AddBlock(size + alignment);
+        current = reinterpret_cast<uintptr_t>(cursor_);
+        aligned = (current + alignment - 1) & ~(alignment - 1);
+    }
+    cursor_ = reinterpret_cast<char*>(aligned + size);
+    bytes_used_ += size;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void QueryArena::Reset() {
+    if (blocks_.empty()) {
+        return;
+    }
+    for (size_t i = 1; i < blocks_.size(); i++) {
+        ::operator delete(blocks_[i].data);
+    }
+    blocks_.resize(1);
+    cursor_ = blocks_[0].data;
+    limit_ = blocks_[0].data + blocks_[0].size;
+    bytes_used_ = 0;
+}
+
+QueryArena* QueryArena::Current() { return current_arena; }
+
+QueryArena::Scope::Scope()
+    : previous_(current_arena), owns_thread_arena_(!thread_arena_in_use) {
+    if (owns_thread_arena_) {
+        thread_arena_in_use = true;
+        current_arena = &GetThreadArena();
+    }
+}
+
+QueryArena::Scope::Scope(QueryArena* arena)
+    : previous_(current_arena), owns_thread_arena_(false) {
+    current_arena = arena;
+}
+
+QueryArena::Scope::~Scope() {
+    if (owns_thread_arena_) {
+        GetThreadArena().Reset();
+        thread_arena_in_use = false;
+    }
+    current_arena = previous_;
+}
+
+QueryArena::Suspend::Suspend() : previous_(current_arena) {
+    current_arena = nullptr;
+}
+
+QueryArena::Suspend::~Suspend() { current_arena = previous_; }
+
+void* ArenaAllocated::operator new(size_t size) {
+    char* base;
+    uintptr_t source;
+    if (current_arena != nullptr) {
+        base = static_cast<char*>(
+            current_arena->Allocate(size + OBJECT_HEADER_SIZE));
+        source = FROM_ARENA;
+    } else {
+        base = static_cast<char*>(::operator new(size + OBJECT_HEADER_SIZE));
+        source = FROM_HEAP;
+    }
+    *reinterpret_cast<uintptr_t*>(base) = source;
+    return base + OBJECT_HEADER_SIZE;
+}
+
+void ArenaAllocated::operator delete(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    char* base = static_cast<char*>(ptr) - OBJECT_HEADER_SIZE;
+    if (*reinterpret_cast<uintptr_t*>(base) == FROM_HEAP) {
+        ::operator delete(base);
+    }
+}
+
+}  // namespace SimpleRDBMS
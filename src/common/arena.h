@@ -0,0 +1,120 @@
+/*
+ * 文件: arena.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 查询级的单调内存池，查询期间的语法树、计划节点、执行器从这里分配，
+ *       查询结束时一次性释放
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleRDBMS {
+
+/**
+ * QueryArena - 单调递增的内存池
+ *
+ * 设计思路：
+ * - 内存按块向系统申请，块内只移动指针，不单独释放；Reset时只保留第一块，
+ *   点查这样的小查询用完第一块之前就结束了，稳定以后一次malloc都没有
+ * - 单线程使用：每个线程有自己的"当前内存池"，Scope把它装上，
+ *   其他线程（比如并行扫描的工作线程）分配时看不到它，走普通的堆
+ * - 不在乎内存什么时候真正回收的对象继承ArenaAllocated，
+ *   有当前内存池时new就从池里分配，delete只析构不回收
+ */
+class QueryArena {
+   public:
+    /** 第一块的大小，后面的块按两倍增长，最大到MAX_BLOCK_SIZE */
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 16 * 1024;
+    static constexpr size_t MAX_BLOCK_SIZE = 1024 * 1024;
+
+    explicit QueryArena(size_t block_size = DEFAULT_BLOCK_SIZE);
+    ~QueryArena();
+
+    QueryArena(const QueryArena&) = delete;
+    QueryArena& operator=(const QueryArena&) = delete;
+
+    /** 分配size字节，alignment必须是2的幂 */
+    void* Allocate(size_t size,
+                   size_t alignment = alignof(std::max_align_t));
+
+    /** 释放所有分配，只保留第一块留着下次用 */
+    void Reset();
+
+    /** 从Reset以来分配出去的字节数 */
+    size_t GetBytesUsed() const { return bytes_used_; }
+
+    /** 当前持有的块数 */
+    size_t GetBlockCount() const { return blocks_.size(); }
+
+    /** 当前线程正在使用的内存池，没有时返回nullptr */
+    static QueryArena* Current();
+
+    /**
+     * 一次查询的作用域
+     * 默认构造使用当前线程自己的内存池，析构时Reset；线程的内存池已经在用
+     * （外层已经有Scope）时什么也不做，对象活到外层查询结束。
+     * 传入内存池时把它装成当前内存池，析构时换回原来的，不Reset
+     */
+    class Scope {
+       public:
+        Scope();
+        explicit Scope(QueryArena* arena);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+       private:
+        QueryArena* previous_;
+        bool owns_thread_arena_;
+    };
+
+    /**
+     * 临时关掉当前内存池
+     * 要活过这次查询的对象（预编译语句、缓存的计划）在这个作用域里创建
+     */
+    class Suspend {
+       public:
+        Suspend();
+        ~Suspend();
+
+        Suspend(const Suspend&) = delete;
+        Suspend& operator=(const Suspend&) = delete;
+
+       private:
+        QueryArena* previous_;
+    };
+
+   private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    void AddBlock(size_t min_size);
+
+    size_t block_size_;
+    std::vector<Block> blocks_;
+    char* cursor_ = nullptr;
+    char* limit_ = nullptr;
+    size_t bytes_used_ = 0;
+};
+
+/**
+ * ArenaAllocated - 从当前内存池分配的对象的基类
+ *
+ * 每个对象前面有一个对齐的头，记录内存来自内存池还是堆，delete据此决定
+ * 要不要真正释放，所以对象在哪个线程、有没有内存池时被删除都没有问题。
+ * 从内存池分配的对象必须在那次查询结束前删除
+ */
+class ArenaAllocated {
+   public:
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr) noexcept;
+};
+
+}  // namespace SimpleRDBMS
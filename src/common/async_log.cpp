@@ -0,0 +1,196 @@
+/*
+ * 文件: async_log.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 异步日志输出实现
+ */
+
+#include "common/async_log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "common/debug.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+// 后台线程攒够这么多字节就先写一次
+constexpr size_t WRITE_BATCH_BYTES = 64 * 1024;
+// 没有日志时最多睡这么久，防止漏掉唤醒
+constexpr auto IDLE_WAIT = std::chrono::milliseconds(50);
+
+}  // namespace
+
+void WriteLogLine(const std::string& line) {
+    AsyncLogSink::GetInstance().Write(line);
+}
+
+AsyncLogSink& AsyncLogSink::GetInstance() {
+    static AsyncLogSink instance;
+    return instance;
+}
+
+AsyncLogSink::AsyncLogSink() : cells_(new Cell[CAPACITY]) {
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0,
+                  "CAPACITY must be a power of two");
+    for (size_t i = 0; i < CAPACITY; i++) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+AsyncLogSink::~AsyncLogSink() { Stop(); }
+
+void AsyncLogSink::Start() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (running_) {
+        return;
+    }
+    stopping_ = false;
+    thread_ = std::thread(&AsyncLogSink::Run, this);
+    running_.store(true, std::memory_order_release);
+}
+
+/**
+ * 停止
+ * 先让新日志回到同步输出，再叫醒后台线程写完剩下的；
+ * 停止前一刻才放进去的几行由这里补写
+ */
+void AsyncLogSink::Stop() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (!running_) {
+        return;
+    }
+    running_.store(false, std::memory_order_release);
+    stopping_ = true;
+    {
+        std::lock_guard<std::mutex> wait_lock(wait_mutex_);
+        wait_cv_.notify_one();
+    }
+    thread_.join();
+
+    std::string line;
+    while (TryPop(&line)) {
+        std::cerr << line << '\n';
+    }
+    std::cerr.flush();
+}
+
+void AsyncLogSink::Write(const std::string& line) {
+    if (!running_.load(std::memory_order_acquire)) {
+        std::cerr << line << std::endl;
+        return;
+    }
+    if (!TryPush(line)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        dropped_total_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (consumer_sleeping_.load()) {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cv_.notify_one();
+    }
+}
+
+/**
+ * 入队
+ * 和线程池的提交队列一样：格子的序号等于位置说明空着，CAS占住位置后
+ * 写入内容，再把序号改成位置+1交给后台线程
+ */
+bool AsyncLogSink::TryPush(const std::string& line) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell = &cells_[pos & (CAPACITY - 1)];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff =
+            static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // 满了
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    size_t length = std::min(line.size(), MAX_LINE);
+    std::memcpy(cell->text, line.data(), length);
+    cell->length = static_cast<uint32_t>(length);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool AsyncLogSink::TryPop(std::string* out) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell = &cells_[pos & (CAPACITY - 1)];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff =
+            static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeue_pos_.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // 空的
+        } else {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    out->assign(cell->text, cell->length);
+    cell->sequence.store(pos + CAPACITY, std::memory_order_release);
+    return true;
+}
+
+/**
+ * 后台线程
+ * 取出所有能取的日志行拼成一块写出去；取空了先报告丢弃的行数，
+ * 再睡到有人写日志或者要停止
+ */
+void AsyncLogSink::Run() {
+    std::string batch;
+    std::string line;
+    batch.reserve(WRITE_BATCH_BYTES + MAX_LINE + 1);
+    while (true) {
+        while (TryPop(&line)) {
+            batch.append(line);
+            batch.push_back('\n');
+            if (batch.size() >= WRITE_BATCH_BYTES) {
+                std::cerr.write(batch.data(), batch.size());
+                batch.clear();
+            }
+        }
+        uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            batch.append("[WARN ] AsyncLogSink: dropped " +
+                         std::to_string(dropped) +
+                         " log line(s), buffer full\n");
+        }
+        if (!batch.empty()) {
+            std::cerr.write(batch.data(), batch.size());
+            std::cerr.flush();
+            batch.clear();
+        }
+        if (stopping_) {
+            break;
+        }
+
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        consumer_sleeping_.store(true);
+        if (!stopping_ && enqueue_pos_.load() == dequeue_pos_.load()) {
+            wait_cv_.wait_for(lock, IDLE_WAIT);
+        }
+        consumer_sleeping_.store(false);
+    }
+}
+
+}  // namespace SimpleRDBMS
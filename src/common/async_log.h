@@ -0,0 +1,87 @@
+/*
+ * 文件: async_log.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 异步日志输出，日志行先放进无锁环形缓冲区，由后台线程批量写到stderr
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace SimpleRDBMS {
+
+/**
+ * AsyncLogSink - 日志的异步输出端
+ *
+ * 设计思路：
+ * - 有界MPMC环形缓冲区（Vyukov），每个格子存一整行日志，写日志的线程
+ *   只做一次CAS和一次拷贝，不碰stderr的锁，也不等写盘
+ * - 后台线程取出日志行攒成一大块再一次写出去，没有日志时睡在条件变量上，
+ *   写日志的一方只在它睡着时才去唤醒
+ * - 缓冲区满了就丢掉这一行并计数，后台线程下次输出时报告丢了多少行；
+ *   生产环境宁可丢日志也不让查询线程卡在日志上
+ * - 超过一个格子的日志行会被截断
+ * - 没有Start时Write直接同步写stderr，行为和以前一样
+ */
+class AsyncLogSink {
+   public:
+    /** 每个格子能存的最长日志行 */
+    static constexpr size_t MAX_LINE = 480;
+    /** 环形缓冲区的格子数，必须是2的幂 */
+    static constexpr size_t CAPACITY = 8192;
+
+    static AsyncLogSink& GetInstance();
+
+    /** 启动后台线程，之后的日志都走环形缓冲区 */
+    void Start();
+
+    /** 写完缓冲区里剩下的日志，停止后台线程，之后回到同步输出 */
+    void Stop();
+
+    bool IsRunning() const { return running_.load(std::memory_order_acquire); }
+
+    /** 输出一行日志（不含换行） */
+    void Write(const std::string& line);
+
+    /** 因为缓冲区满丢掉的日志行数 */
+    uint64_t GetDroppedCount() const { return dropped_total_.load(); }
+
+   private:
+    AsyncLogSink();
+    ~AsyncLogSink();
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        uint32_t length;
+        char text[MAX_LINE];
+    };
+
+    bool TryPush(const std::string& line);
+    bool TryPop(std::string* out);
+    void Run();
+
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> consumer_sleeping_{false};
+    std::atomic<uint64_t> dropped_{0};        // 还没有报告的丢弃行数
+    std::atomic<uint64_t> dropped_total_{0};  // 累计丢弃行数
+
+    std::mutex lifecycle_mutex_;  // 串行化Start/Stop
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+    std::thread thread_;
+};
+
+}  // namespace SimpleRDBMS
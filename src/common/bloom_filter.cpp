@@ -0,0 +1,34 @@
+/*
+ * 文件: bloom_filter.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 分块布隆过滤器的实现
+ */
+
+#include "common/bloom_filter.h"
+
+#include <algorithm>
+
+namespace SimpleRDBMS {
+
+void BloomFilter::Reset(size_t expected_keys, size_t bits_per_key) {
+    size_t bits = std::max<size_t>(expected_keys, 1) * bits_per_key;
+    size_t bits_per_block = kWordsPerBlock * 32;
+    size_t block_count = (bits + bits_per_block - 1) / bits_per_block;
+    if (block_count != block_count_) {
+        blocks_ = std::make_unique<Block[]>(block_count);
+        block_count_ = block_count;
+    }
+    for (size_t b = 0; b < block_count_; b++) {
+        for (auto& word : blocks_[b].words) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void BloomFilter::Clear() {
+    blocks_.reset();
+    block_count_ = 0;
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,124 @@
+/*
+ * 文件: bloom_filter.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 分块布隆过滤器，哈希连接把建表一边的键交给探测一边的扫描，
+ *       索引用它在查找不存在的键时不下降B+树
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * BloomFilter - 只回答"一定不存在"的集合
+ *
+ * 设计思路：
+ * - 分块布隆过滤器：每个块32字节（8个32位字），一个键只落在一个块里，
+ *   在块内每个字各置一位，插入和查询都只碰一条缓存行
+ * - 调用者传入64位哈希值：高32位选块，低32位乘8个不同的奇数常量
+ *   得到块内的8个位置，不再重新哈希
+ * - 按预计的键数分配，每个键BLOOM_FILTER_BITS_PER_KEY位时
+ *   误判率在1%到2%之间；插入的键超过预计很多时误判率上升，但不会漏判
+ * - 字是原子的：Insert只供一个线程建过滤器时使用，
+ *   InsertConcurrent可以和其他插入、查询同时进行
+ */
+class BloomFilter {
+   public:
+    BloomFilter() = default;
+
+    /** 按预计的键数分配，见Reset */
+    explicit BloomFilter(size_t expected_keys,
+                         size_t bits_per_key = BLOOM_FILTER_BITS_PER_KEY) {
+        Reset(expected_keys, bits_per_key);
+    }
+
+    BloomFilter(const BloomFilter&) = delete;
+    BloomFilter& operator=(const BloomFilter&) = delete;
+
+    /**
+     * 清空并重新分配
+     * @param expected_keys 预计插入的键数，0时也至少分配一个块
+     * @param bits_per_key 每个键分到的位数
+     */
+    void Reset(size_t expected_keys,
+               size_t bits_per_key = BLOOM_FILTER_BITS_PER_KEY);
+
+    /** 释放内存，之后IsInitialized返回false */
+    void Clear();
+
+    /** 插入一个键的哈希值，不能和其他插入同时进行 */
+    void Insert(uint64_t hash) {
+        Block& block = blocks_[BlockIndex(hash)];
+        uint32_t key = static_cast<uint32_t>(hash);
+        for (size_t i = 0; i < kWordsPerBlock; i++) {
+            uint32_t word = block.words[i].load(std::memory_order_relaxed);
+            block.words[i].store(word | BitMask(key, i),
+                                 std::memory_order_relaxed);
+        }
+    }
+
+    /** 插入一个键的哈希值，可以和其他插入、查询同时进行 */
+    void InsertConcurrent(uint64_t hash) {
+        Block& block = blocks_[BlockIndex(hash)];
+        uint32_t key = static_cast<uint32_t>(hash);
+        for (size_t i = 0; i < kWordsPerBlock; i++) {
+            block.words[i].fetch_or(BitMask(key, i),
+                                    std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * 查询一个键的哈希值
+     * @return false表示这个键一定没有插入过；true表示可能插入过
+     */
+    bool MayContain(uint64_t hash) const {
+        const Block& block = blocks_[BlockIndex(hash)];
+        uint32_t key = static_cast<uint32_t>(hash);
+        for (size_t i = 0; i < kWordsPerBlock; i++) {
+            uint32_t mask = BitMask(key, i);
+            if ((block.words[i].load(std::memory_order_relaxed) & mask) !=
+                mask) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool IsInitialized() const { return block_count_ > 0; }
+
+    /** 占用的字节数 */
+    size_t GetMemoryUsage() const { return block_count_ * sizeof(Block); }
+
+   private:
+    static constexpr size_t kWordsPerBlock = 8;
+
+    struct alignas(32) Block {
+        std::atomic<uint32_t> words[kWordsPerBlock];
+    };
+
+    /** 高32位乘块数取高位，块数不必是2的幂 */
+    size_t BlockIndex(uint64_t hash) const {
+        return static_cast<size_t>(((hash >> 32) * block_count_) >> 32);
+    }
+
+    /** 块内第i个字里的那一位 */
+    static uint32_t BitMask(uint32_t key, size_t i) {
+        static constexpr uint32_t kSalts[kWordsPerBlock] = {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+        return 1U << ((key * kSalts[i]) >> 27);
+    }
+
+    std::unique_ptr<Block[]> blocks_;
+    size_t block_count_ = 0;
+};
+
+}  // namespace SimpleRDBMS
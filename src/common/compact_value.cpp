@@ -0,0 +1,135 @@
+/*
+ * 文件: compact_value.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 紧凑值的转换和比较实现
+ */
+
+#include "common/compact_value.h"
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace SimpleRDBMS {
+
+namespace {
+
+template <typename T>
+CompactValue::Ordering OrderOf(const T& left, const T& right) {
+    if (left < right) {
+        return CompactValue::Ordering::LESS;
+    }
+    if (right < left) {
+        return CompactValue::Ordering::GREATER;
+    }
+    if (left == right) {
+        return CompactValue::Ordering::EQUAL;
+    }
+    return CompactValue::Ordering::UNORDERED;  // NaN
+}
+
+}  // namespace
+
+CompactValue CompactValue::FromValue(const Value& value) {
+    switch (value.index()) {
+        case 0:
+            return FromInteger(TypeId::BOOLEAN, std::get<bool>(value) ? 1 : 0);
+        case 1:
+            return FromInteger(TypeId::TINYINT, std::get<int8_t>(value));
+        case 2:
+            return FromInteger(TypeId::SMALLINT, std::get<int16_t>(value));
+        case 3:
+            return FromInteger(TypeId::INTEGER, std::get<int32_t>(value));
+        case 4:
+            return FromInteger(TypeId::BIGINT, std::get<int64_t>(value));
+        case 5:
+            return FromDouble(TypeId::FLOAT, std::get<float>(value));
+        case 6:
+            return FromDouble(TypeId::DOUBLE, std::get<double>(value));
+        default: {
+            const std::string& str = std::get<std::string>(value);
+            return FromString(str.data(), str.size());
+        }
+    }
+}
+
+CompactValue CompactValue::FromString(const char* data, size_t size) {
+    if (size > MAX_STRING_LENGTH) {
+        throw std::length_error("String too long for CompactValue");
+    }
+    CompactValue result(TypeId::VARCHAR);
+    result.header_ |= static_cast<uint32_t>(size) << 8;
+    if (size <= INLINE_CAPACITY) {
+        std::memcpy(result.payload_, data, size);
+    } else {
+        std::memcpy(result.payload_, &data, sizeof(data));
+    }
+    return result;
+}
+
+Value CompactValue::ToValue() const {
+    switch (GetType()) {
+        case TypeId::BOOLEAN:
+            return Value(GetInteger() != 0);
+        case TypeId::TINYINT:
+            return Value(static_cast<int8_t>(GetInteger()));
+        case TypeId::SMALLINT:
+            return Value(static_cast<int16_t>(GetInteger()));
+        case TypeId::INTEGER:
+            return Value(static_cast<int32_t>(GetInteger()));
+        case TypeId::BIGINT:
+            return Value(GetInteger());
+        case TypeId::FLOAT:
+            return Value(static_cast<float>(GetDouble()));
+        case TypeId::DOUBLE:
+            return Value(GetDouble());
+        default:
+            return Value(std::string(GetString()));
+    }
+}
+
+/**
+ * 比较
+ * 实现思路：
+ * 1. 同类型：整数类（包括BOOLEAN）比较int64_t，浮点数比较double，
+ *    字符串按字节比较，和std::string的比较一致
+ * 2. 类型不同时两边都必须是数值并且都不是BOOLEAN，转换成double比较
+ * 3. 提升到double是精确的：FLOAT存的时候就是无损转换成double的
+ */
+CompactValue::Ordering CompactValue::Compare(const CompactValue& left,
+                                             const CompactValue& right) {
+    TypeId type = left.GetType();
+    if (type == right.GetType()) {
+        if (left.IsInteger()) {
+            return OrderOf(left.GetInteger(), right.GetInteger());
+        }
+        if (left.IsFloatingPoint()) {
+            return OrderOf(left.GetDouble(), right.GetDouble());
+        }
+        int result = left.GetString().compare(right.GetString());
+        return result < 0    ? Ordering::LESS
+               : result == 0 ? Ordering::EQUAL
+                             : Ordering::GREATER;
+    }
+
+    auto to_double = [](const CompactValue& value, double* out) {
+        if (value.IsFloatingPoint()) {
+            *out = value.GetDouble();
+            return true;
+        }
+        if (value.IsInteger() && value.GetType() != TypeId::BOOLEAN) {
+            *out = static_cast<double>(value.GetInteger());
+            return true;
+        }
+        return false;
+    };
+    double left_number;
+    double right_number;
+    if (!to_double(left, &left_number) || !to_double(right, &right_number)) {
+        return Ordering::INCOMPARABLE;
+    }
+    return OrderOf(left_number, right_number);
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,146 @@
+/*
+ * 文件: compact_value.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 16字节的带类型标记的值，短字符串内联，长字符串只引用别处的字节，
+ *       用于比较和索引键转换这些不需要持有数据的热点路径
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "common/types.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * CompactValue - 紧凑的值表示
+ *
+ * 设计思路：
+ * - Value是std::variant，带着一个std::string有40字节，每次比较都要访问
+ *   两次variant；这里固定16字节：12字节的负载加4字节的头，
+ *   头的低8位是TypeId，高24位是字符串长度
+ * - 所有整数（包括BOOLEAN）统一存成int64_t，FLOAT和DOUBLE统一存成double，
+ *   比较时只需要看两个大类，不用为每一对类型写一个分支
+ * - 不超过INLINE_CAPACITY的字符串直接放在负载里；更长的字符串只存指针，
+ *   指向页面、Value或者QueryArena里的字节，不复制也不分配
+ * - 不持有长字符串的数据，引用的字节必须比CompactValue活得长，
+ *   一般只在一次比较、一次键转换的范围内使用
+ */
+class CompactValue {
+   public:
+    /** 负载里能内联的最长字符串 */
+    static constexpr size_t INLINE_CAPACITY = 12;
+    /** 头里能记录的最长字符串 */
+    static constexpr size_t MAX_STRING_LENGTH = (1u << 24) - 1;
+
+    /** 两个值的大小关系，UNORDERED是有NaN参与，INCOMPARABLE是类型不能比较 */
+    enum class Ordering { LESS, EQUAL, GREATER, UNORDERED, INCOMPARABLE };
+
+    /** 整数0，类型为INTEGER */
+    CompactValue() : CompactValue(TypeId::INTEGER) { SetInteger(0); }
+
+    /**
+     * 从Value转换
+     * 长字符串引用value里的字符，value要在CompactValue用完之前一直有效
+     */
+    static CompactValue FromValue(const Value& value);
+
+    /**
+     * 引用一段字符串，短的直接复制进来
+     * @throws std::length_error 超过MAX_STRING_LENGTH
+     */
+    static CompactValue FromString(const char* data, size_t size);
+
+    static CompactValue FromInteger(TypeId type, int64_t value) {
+        CompactValue result(type);
+        result.SetInteger(value);
+        return result;
+    }
+
+    static CompactValue FromDouble(TypeId type, double value) {
+        CompactValue result(type);
+        result.SetDouble(value);
+        return result;
+    }
+
+    /** 转换回Value，字符串会被复制 */
+    Value ToValue() const;
+
+    TypeId GetType() const { return static_cast<TypeId>(header_ & 0xff); }
+
+    bool IsString() const { return GetType() == TypeId::VARCHAR; }
+
+    /** BOOLEAN、TINYINT、SMALLINT、INTEGER、BIGINT */
+    bool IsInteger() const {
+        TypeId type = GetType();
+        return type == TypeId::BOOLEAN || type == TypeId::TINYINT ||
+               type == TypeId::SMALLINT || type == TypeId::INTEGER ||
+               type == TypeId::BIGINT;
+    }
+
+    /** FLOAT、DOUBLE */
+    bool IsFloatingPoint() const {
+        return GetType() == TypeId::FLOAT || GetType() == TypeId::DOUBLE;
+    }
+
+    /** 整数的值，IsInteger()为true时有效 */
+    int64_t GetInteger() const {
+        int64_t value;
+        std::memcpy(&value, payload_, sizeof(value));
+        return value;
+    }
+
+    /** 浮点数的值，IsFloatingPoint()为true时有效 */
+    double GetDouble() const {
+        double value;
+        std::memcpy(&value, payload_, sizeof(value));
+        return value;
+    }
+
+    /** 字符串内容，IsString()为true时有效 */
+    std::string_view GetString() const {
+        size_t size = header_ >> 8;
+        if (size <= INLINE_CAPACITY) {
+            return std::string_view(payload_, size);
+        }
+        const char* data;
+        std::memcpy(&data, payload_, sizeof(data));
+        return std::string_view(data, size);
+    }
+
+    /** 字符串是否内联保存（不引用外部字节） */
+    bool IsInline() const {
+        return !IsString() || (header_ >> 8) <= INLINE_CAPACITY;
+    }
+
+    /**
+     * 比较两个值，规则和ExpressionEvaluator::CompareValues一致：
+     * 同类型直接比较；类型不同的数值（BOOLEAN除外）转换成double比较；
+     * 其他组合返回INCOMPARABLE
+     */
+    static Ordering Compare(const CompactValue& left, const CompactValue& right);
+
+   private:
+    explicit CompactValue(TypeId type)
+        : header_(static_cast<uint32_t>(type)) {}
+
+    void SetInteger(int64_t value) {
+        std::memcpy(payload_, &value, sizeof(value));
+    }
+
+    void SetDouble(double value) {
+        std::memcpy(payload_, &value, sizeof(value));
+    }
+
+    char payload_[INLINE_CAPACITY] = {};
+    uint32_t header_;
+};
+
+static_assert(sizeof(CompactValue) == 16, "CompactValue must stay 16 bytes");
+
+}  // namespace SimpleRDBMS
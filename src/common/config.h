@@ -13,28 +13,187 @@
 namespace SimpleRDBMS {
 
 // ==================== 页面管理相关常量 ====================
-// 页面大小设置为4KB，这是大多数现代数据库系统的标准选择
+// 页面大小默认4KB，这是大多数现代数据库系统的标准选择
 // 4KB既能保证良好的磁盘I/O效率，又不会造成过多的内存浪费
-static constexpr size_t PAGE_SIZE = 4096;
+// 构建时可以用 -DSIMPLERDBMS_PAGE_SIZE=8192/16384/32768 换成更大的页面，
+// B+树更矮、宽tuple的页内开销更小；页面大小写在database文件头里，
+// 打开页面大小不同的文件会直接报错
+#ifndef SIMPLERDBMS_PAGE_SIZE
+#define SIMPLERDBMS_PAGE_SIZE 4096
+#endif
+static constexpr size_t PAGE_SIZE = SIMPLERDBMS_PAGE_SIZE;
+
+// 表页面的槽位偏移是uint16_t，最大只能到32KB
+static_assert(PAGE_SIZE == 4096 || PAGE_SIZE == 8192 || PAGE_SIZE == 16384 ||
+                  PAGE_SIZE == 32768,
+              "PAGE_SIZE must be 4096, 8192, 16384 or 32768");
 
 // 缓冲池默认大小为100个页面，约400KB内存
 // 这个大小适合教学和小型测试，生产环境中通常会设置得更大
+// 服务器模式下由database.buffer_pool_size配置项决定，并支持在线调整
 static constexpr size_t BUFFER_POOL_SIZE = 100;
 
+// 表和索引每次向磁盘管理器预留的连续页面数（区段大小）
+// 一个对象的页面从自己的区段里顺序分配，不和其他对象的页面交错，
+// 顺序扫描在磁盘上也是顺序读
+static constexpr size_t EXTENT_PAGES = 64;
+
+// 压缩页面在磁盘上按这个粒度占用空间：页面槽位里压缩数据之后的整块
+// 通过打洞（FALLOC_FL_PUNCH_HOLE）还给文件系统，和常见文件系统的块大小一致
+// 页面不大于这个值时压缩省不下空间，不会压缩
+static constexpr size_t PAGE_COMPRESSION_BLOCK_SIZE = 4096;
+
+// 顺序扫描时后台预读最多领先扫描的页面数
+// 表堆页面是链表结构，预读线程只能沿着链表逐页前进，这个值控制窗口大小
+static constexpr size_t READ_AHEAD_PAGES = 8;
+
+// 只读映射方式下顺序扫描每次madvise(MADV_WILLNEED)的页面数
+// 映射里的页面按页面ID连续存放，内核可以按这个范围整段预读
+static constexpr size_t MMAP_READ_AHEAD_PAGES = 64;
+
+// 缓冲池预热一批读取的页面数
+// 一批按页面ID排序后连续的页面合并成一次读，批越大顺序读越长，
+// 但排在后面的热页面要等前面整批读完
+static constexpr size_t WARMUP_READ_BATCH_PAGES = 256;
+
+// 批量执行时一个VectorBatch最多容纳的行数
+// 一次虚函数调用和一次表达式树遍历处理这么多行，把逐行解释的开销分摊掉
+static constexpr size_t VECTOR_BATCH_SIZE = 1024;
+
+// 列存表一个行组的行数，攒够这么多行才按列编码封存
+// 行组是列存表按最小/最大值跳过数据的单位，也是每列一个段的编码单位
+static constexpr size_t COLUMN_ROW_GROUP_SIZE = 8 * VECTOR_BATCH_SIZE;
+
+// 哈希连接的内存预算，建哈希表的输入超过后两边都按哈希值分区写到临时页面，
+// 再逐个分区连接
+static constexpr size_t HASH_JOIN_MEMORY_BUDGET = 16 * 1024 * 1024;
+
+// 哈希连接溢出时的分区数
+static constexpr size_t HASH_JOIN_PARTITIONS = 16;
+
+// 布隆过滤器每个键分到的位数，分块布隆过滤器这时的误判率在1%到2%之间
+// 哈希连接建表后把建表一边的键做成布隆过滤器交给探测一边的顺序扫描，
+// 索引也可以按需开启布隆过滤器
+static constexpr size_t BLOOM_FILTER_BITS_PER_KEY = 10;
+
+// 索引的布隆过滤器至少按这么多个键分配；重建时按当时键数的两倍分配，
+// 之后插入的键超过分配的键数时重新扫描索引重建
+static constexpr size_t INDEX_BLOOM_FILTER_MIN_KEYS = 1024;
+
+// 哈希聚合的内存预算，分组状态超过后把部分聚合结果按分组键的哈希值
+// 写到临时页面，最后逐个分区合并
+static constexpr size_t AGGREGATION_MEMORY_BUDGET = 16 * 1024 * 1024;
+
+// 哈希聚合溢出时的分区数
+static constexpr size_t AGGREGATION_PARTITIONS = 16;
+
+// ANALYZE抽样的行数，表更大时用蓄水池抽样，行数和页面数仍然是精确值
+static constexpr size_t STATISTICS_SAMPLE_ROWS = 30000;
+
+// 每列最多记录的高频值个数
+static constexpr size_t STATISTICS_MCV_COUNT = 10;
+
+// 每列等深直方图的桶数
+static constexpr size_t STATISTICS_HISTOGRAM_BUCKETS = 32;
+
+// 代价模型的单位：顺序读一个页面、随机读一个页面、处理一行、处理一个索引项
+static constexpr double SEQ_PAGE_COST = 1.0;
+static constexpr double RANDOM_PAGE_COST = 4.0;
+static constexpr double CPU_TUPLE_COST = 0.01;
+static constexpr double CPU_INDEX_TUPLE_COST = 0.005;
+
+// 排序的内存预算（work_mem），读入的行超过后排好序写成一个临时页面上的
+// 有序段，最后多路归并所有有序段
+static constexpr size_t SORT_MEMORY_BUDGET = 16 * 1024 * 1024;
+
+// 并行顺序扫描的工作线程数，1表示不并行，执行引擎可以按查询修改
+static constexpr size_t PARALLEL_SCAN_WORKERS = 1;
+
+// 并行扫描每次分给一个工作线程的页面数（一个morsel）
+static constexpr size_t PARALLEL_SCAN_MORSEL_PAGES = 8;
+
+// 流式输出结果时每攒够这么多行交给ResultSink一次
+static constexpr size_t RESULT_STREAM_CHUNK_ROWS = 256;
+
+// 执行器每处理这么多行检查一次查询是否被取消或超时
+static constexpr size_t CANCELLATION_CHECK_INTERVAL = 1024;
+
+// 算子向内存记账器预留内存的粒度，用到的内存增长不到一块时不碰记账器
+static constexpr size_t MEMORY_RESERVATION_CHUNK = 64 * 1024;
+
+// UPDATE/DELETE收集目标RID的内存预算，超过后RID写到临时页面
+static constexpr size_t MODIFY_TARGET_MEMORY_BUDGET = 16 * 1024 * 1024;
+
+// 行格式版本号，写在每条记录的第一个字节
+// 版本1：版本号 + NULL位图 + 按schema偏移存放的定长列和变长列条目 + 变长数据
+static constexpr uint8_t ROW_FORMAT_VERSION = 1;
+
+// VACUUM时记录占用的字节数不超过页面这个比例的页面算稀疏页面，
+// 记录搬到其他页面之后页面被释放
+static constexpr double VACUUM_SPARSE_PAGE_RATIO = 0.25;
+
+// 日志缓冲区大小（双缓冲中的每一块），一块写满后追加切换到另一块继续，
+// 写满的那块由后台线程写出；服务器模式下由database.log_buffer_size配置
+static constexpr size_t LOG_BUFFER_SIZE = 16 * PAGE_SIZE;
+
+// WAL段文件大小，每个段创建时一次性预分配，截断后回收复用
+static constexpr size_t LOG_SEGMENT_SIZE = 16 * 1024 * 1024;
+
+// WAL复制：发送线程等待新日志、接收线程检查停止标志的间隔（毫秒）
+static constexpr int REPLICATION_POLL_INTERVAL_MS = 100;
+
+// WAL复制：副本和主库的连接断开后隔这么久重连（毫秒）
+static constexpr int REPLICATION_RETRY_INTERVAL_MS = 1000;
+
+// 副本上等待事务结束的记录最多攒这么多条，超过以后不等提交直接重放，
+// 防止长事务让副本的内存无限增长
+static constexpr size_t REPLICA_MAX_PENDING_RECORDS = 65536;
+
+// 一张分区表最多的分区数，每个分区是一张子表，它们的schema都存在
+// 只有一个页面的catalog里
+static constexpr size_t MAX_TABLE_PARTITIONS = 32;
+
 // ==================== B+树索引相关常量 ====================
-// 单个tuple的最大大小限制为512字节
+// 单个tuple的最大大小限制为页面的1/8（4KB页面时是512字节）
 // 这个限制确保一个页面能容纳足够多的记录，避免页面利用率过低
-static constexpr size_t MAX_TUPLE_SIZE = 512;
+static constexpr size_t MAX_TUPLE_SIZE = PAGE_SIZE / 8;
 
 // B+树的阶数设置为64，意味着每个内部节点最多有64个子节点
 // 这个值在磁盘I/O效率和树高度之间取得了平衡
 // 阶数越大，树越"胖"，查找时需要的磁盘访问次数越少
 static constexpr size_t B_PLUS_TREE_ORDER = 64;
 
+// 批量构建索引时每个页面的填充率，预留的空间让之后的插入不会马上分裂
+static constexpr double BULK_LOAD_FILL_FACTOR = 0.9;
+
+// 批量构建索引时排序缓冲区的内存上限，超过后有序段写到临时文件再归并
+static constexpr size_t BULK_LOAD_SORT_MEMORY = 64 * 1024 * 1024;
+
+// COPY FROM每次切给一个解析线程的字节数，切分点总在记录边界上
+static constexpr size_t COPY_CHUNK_SIZE = 1024 * 1024;
+
+// COPY FROM同时在解析的块数，每块一个解析线程
+static constexpr size_t COPY_PARSE_WORKERS = 4;
+
+// COPY TO攒够这么多字节写一次文件
+static constexpr size_t COPY_WRITE_BUFFER_SIZE = 1024 * 1024;
+
 // ==================== 事务管理相关常量 ====================
 // 无效事务ID，用于标识未开始或已结束的事务
 static constexpr int INVALID_TXN_ID = -1;
 
+// 锁表的分片数，按RID的哈希值分到各个分片，每个分片有自己的互斥锁
+static constexpr size_t LOCK_TABLE_SHARDS = 64;
+
+// 没有死锁检测线程时等锁的超时时间（毫秒），超时就放弃加锁
+static constexpr int64_t LOCK_WAIT_TIMEOUT_MS = 100;
+
+// 事务在一张表上的记录锁超过这个数时升级成表锁
+static constexpr size_t LOCK_ESCALATION_THRESHOLD = 5000;
+
+// 事务表的槽位数，同时活跃的事务超过这个数时多出来的放进溢出槽位
+static constexpr size_t TRANSACTION_TABLE_SLOTS = 1024;
+
 // 无效日志序列号，用于标识无效的日志记录
 static constexpr int INVALID_LSN = -1;
 
@@ -52,6 +211,10 @@ using slot_offset_t = int32_t;
 // 使用无符号32位整数，支持约42亿个并发事务
 using txn_id_t = uint32_t;
 
+// 提交时间戳类型，MVCC按它判断一个版本对快照是否可见
+// 0表示还没有提交，事务提交时从1开始递增分配
+using timestamp_t = uint64_t;
+
 // 日志序列号类型，用于WAL（Write-Ahead Logging）系统
 // LSN确保日志记录的顺序性，是恢复机制的核心
 using lsn_t = int32_t;
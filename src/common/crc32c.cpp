@@ -0,0 +1,129 @@
+/*
+ * 文件: crc32c.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: CRC32C的硬件实现和查表实现
+ */
+
+#include "common/crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMPLERDBMS_CRC32C_SSE42 1
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#define SIMPLERDBMS_CRC32C_ARMV8 1
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7)
+#endif
+#endif
+
+namespace SimpleRDBMS {
+
+namespace {
+
+// CRC32C多项式0x1EDC6F41按位反转后的值
+constexpr uint32_t CRC32C_POLY = 0x82F63B78u;
+
+struct Crc32cTable {
+    uint32_t entries[256];
+    Crc32cTable() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+uint32_t Crc32cSoftware(const uint8_t* p, size_t size, uint32_t crc) {
+    static const Crc32cTable table;
+    for (size_t i = 0; i < size; i++) {
+        crc = table.entries[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(SIMPLERDBMS_CRC32C_SSE42)
+
+bool CpuSupportsCrc32c() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+
+__attribute__((target("sse4.2"))) uint32_t Crc32cHardware(const uint8_t* p,
+                                                           size_t size,
+                                                           uint32_t crc) {
+    uint64_t crc64 = crc;
+    for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += sizeof(uint64_t);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; size > 0; size--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+
+#elif defined(SIMPLERDBMS_CRC32C_ARMV8)
+
+bool CpuSupportsCrc32c() { return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0; }
+
+__attribute__((target("+crc"))) uint32_t Crc32cHardware(const uint8_t* p,
+                                                         size_t size,
+                                                         uint32_t crc) {
+    for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        crc = __crc32cd(crc, word);
+        p += sizeof(uint64_t);
+    }
+    for (; size > 0; size--) {
+        crc = __crc32cb(crc, *p++);
+    }
+    return crc;
+}
+
+#else
+
+bool CpuSupportsCrc32c() { return false; }
+
+uint32_t Crc32cHardware(const uint8_t* p, size_t size, uint32_t crc) {
+    return Crc32cSoftware(p, size, crc);
+}
+
+#endif
+
+bool UseHardware() {
+    static const bool supported = CpuSupportsCrc32c();
+    return supported;
+}
+
+}  // namespace
+
+/**
+ * 计算CRC32C
+ * 两种实现的中间状态都是取反之前的值，入口和出口各取反一次
+ */
+uint32_t Crc32c(const void* data, size_t size, uint32_t crc) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    if (UseHardware()) {
+        crc = Crc32cHardware(p, size, crc);
+    } else {
+        crc = Crc32cSoftware(p, size, crc);
+    }
+    return ~crc;
+}
+
+bool Crc32cIsHardwareAccelerated() { return UseHardware(); }
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,26 @@
+/*
+ * 文件: crc32c.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: CRC32C（Castagnoli多项式）校验，x86上用SSE4.2的crc32指令，
+ *       ARMv8上用CRC扩展指令，都没有时用查表实现
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleRDBMS {
+
+/**
+ * 计算CRC32C
+ * @param crc 前一段数据的结果，分段计算时传入，第一段为0
+ * @return 和iSCSI/ext4使用的CRC32C一致
+ */
+uint32_t Crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+/** 当前是否使用CPU的CRC32C指令 */
+bool Crc32cIsHardwareAccelerated();
+
+}  // namespace SimpleRDBMS
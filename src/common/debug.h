@@ -63,19 +63,34 @@ inline DebugLevel GetDebugLevel() {
 #define DEBUG_COLOR_CYAN "\033[0;36m"     // 青色 - 调试
 #define DEBUG_COLOR_RESET "\033[0m"       // 重置颜色
 
+// ==================== 编译期日志级别 ====================
+// 比SIMPLERDBMS_MIN_LOG_LEVEL更详细的日志在编译期就被去掉，
+// 连运行时的级别判断都没有；默认全部编译进来，由CMake选项覆盖
+#ifndef SIMPLERDBMS_MIN_LOG_LEVEL
+#define SIMPLERDBMS_MIN_LOG_LEVEL 5
+#endif
+
+// 输出一整行日志，实现在async_log.cpp，启动了AsyncLogSink时走环形缓冲区，
+// 否则同步写stderr
+void WriteLogLine(const std::string& line);
+
 // ==================== 核心调试宏定义 ====================
 // 主要的调试输出宏，支持流式语法和自动的文件名、行号、函数名输出
-// 只有当前设置的调试级别大于等于指定级别时才会输出
-#define DEBUG_LOG(level, msg)                                                 \
-    do {                                                                      \
-        if (static_cast<int>(SimpleRDBMS::GetDebugLevel()) >=                 \
-            static_cast<int>(level)) {                                        \
-            std::ostringstream oss;                                           \
-            oss << msg;                                                       \
-            std::cerr << SimpleRDBMS::GetDebugPrefix(level) << " ["           \
-                      << __FILE__ << ":" << __LINE__ << " " << __FUNCTION__   \
-                      << "] " << oss.str() << DEBUG_COLOR_RESET << std::endl; \
-        }                                                                     \
+// 级别先在编译期和SIMPLERDBMS_MIN_LOG_LEVEL比较，再在运行时和当前设置的
+// 调试级别比较，两关都过了才会格式化日志
+#define DEBUG_LOG(level, msg)                                                \
+    do {                                                                     \
+        if constexpr (static_cast<int>(level) <=                             \
+                      SIMPLERDBMS_MIN_LOG_LEVEL) {                           \
+            if (static_cast<int>(SimpleRDBMS::GetDebugLevel()) >=            \
+                static_cast<int>(level)) {                                   \
+                std::ostringstream oss;                                      \
+                oss << SimpleRDBMS::GetDebugPrefix(level) << " [" << __FILE__ \
+                    << ":" << __LINE__ << " " << __FUNCTION__ << "] " << msg  \
+                    << DEBUG_COLOR_RESET;                                    \
+                SimpleRDBMS::WriteLogLine(oss.str());                        \
+            }                                                                \
+        }                                                                    \
     } while (0)
 
 // ==================== 便捷的日志宏 ====================
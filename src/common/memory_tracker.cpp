@@ -0,0 +1,148 @@
+/*
+ * 文件: memory_tracker.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 分层内存记账的实现
+ */
+
+#include "common/memory_tracker.h"
+
+#include <utility>
+
+namespace SimpleRDBMS {
+
+namespace {
+
+thread_local MemoryTracker* current_memory_tracker = nullptr;
+
+}  // namespace
+
+MemoryTracker::MemoryTracker(std::string label, MemoryTracker* parent,
+                             size_t limit)
+    : label_(std::move(label)), parent_(parent), limit_(limit) {}
+
+MemoryTracker::~MemoryTracker() {
+    size_t remaining = usage_.load();
+    if (remaining > 0 && parent_ != nullptr) {
+        parent_->Release(remaining);
+    }
+}
+
+bool MemoryTracker::AddLocal(size_t bytes) {
+    size_t limit = limit_.load(std::memory_order_relaxed);
+    size_t usage = usage_.fetch_add(bytes) + bytes;
+    if (limit != 0 && usage > limit) {
+        usage_.fetch_sub(bytes);
+        return false;
+    }
+    size_t peak = peak_.load(std::memory_order_relaxed);
+    while (usage > peak && !peak_.compare_exchange_weak(peak, usage)) {
+    }
+    return true;
+}
+
+MemoryTracker* MemoryTracker::ConsumeChain(size_t bytes) {
+    for (MemoryTracker* tracker = this; tracker != nullptr;
+         tracker = tracker->parent_) {
+        if (!tracker->AddLocal(bytes)) {
+            for (MemoryTracker* done = this; done != tracker;
+                 done = done->parent_) {
+                done->usage_.fetch_sub(bytes);
+            }
+            return tracker;
+        }
+    }
+    return nullptr;
+}
+
+bool MemoryTracker::TryConsume(size_t bytes) {
+    return bytes == 0 || ConsumeChain(bytes) == nullptr;
+}
+
+void MemoryTracker::Consume(size_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    MemoryTracker* exceeded = ConsumeChain(bytes);
+    if (exceeded == nullptr) {
+        return;
+    }
+    std::string message = exceeded->label_ + " memory limit of " +
+                          std::to_string(exceeded->GetLimit()) +
+                          " bytes exceeded (" +
+                          std::to_string(exceeded->GetUsage()) +
+                          " bytes in use, requested " +
+                          std::to_string(bytes) + " more)";
+    {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        limit_error_ = message;
+    }
+    throw MemoryLimitExceededException(message);
+}
+
+void MemoryTracker::Release(size_t bytes) {
+    for (MemoryTracker* tracker = this; tracker != nullptr;
+         tracker = tracker->parent_) {
+        tracker->usage_.fetch_sub(bytes);
+    }
+}
+
+void MemoryTracker::SetParent(MemoryTracker* parent) { parent_ = parent; }
+
+std::string MemoryTracker::GetLimitError() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return limit_error_;
+}
+
+MemoryTracker* MemoryTracker::Current() { return current_memory_tracker; }
+
+MemoryTracker::Scope::Scope(MemoryTracker* tracker)
+    : previous_(current_memory_tracker) {
+    current_memory_tracker = tracker;
+}
+
+MemoryTracker::Scope::~Scope() { current_memory_tracker = previous_; }
+
+void MemoryReservation::SetTracker(MemoryTracker* tracker) {
+    Release();
+    tracker_ = tracker;
+}
+
+/**
+ * 调整预留
+ * 目标按块向上取整：比已经预留的多时向记账器要差额，
+ * 少了整块以上时把差额还回去
+ */
+bool MemoryReservation::ResizeSlow(size_t bytes) {
+    size_t target = (bytes + MEMORY_RESERVATION_CHUNK - 1) /
+                    MEMORY_RESERVATION_CHUNK * MEMORY_RESERVATION_CHUNK;
+    if (target > reserved_) {
+        if (tracker_ != nullptr && !tracker_->TryConsume(target - reserved_)) {
+            return false;
+        }
+    } else if (tracker_ != nullptr) {
+        tracker_->Release(reserved_ - target);
+    }
+    reserved_ = target;
+    return true;
+}
+
+void MemoryReservation::Resize(size_t bytes) {
+    if (TryResize(bytes)) {
+        return;
+    }
+    // 走一遍Consume生成错误信息并抛出；万一这时又够了，就记成预留
+    size_t target = (bytes + MEMORY_RESERVATION_CHUNK - 1) /
+                    MEMORY_RESERVATION_CHUNK * MEMORY_RESERVATION_CHUNK;
+    tracker_->Consume(target - reserved_);
+    reserved_ = target;
+}
+
+void MemoryReservation::Release() {
+    if (tracker_ != nullptr && reserved_ > 0) {
+        tracker_->Release(reserved_);
+    }
+    reserved_ = 0;
+}
+
+}  // namespace SimpleRDBMS
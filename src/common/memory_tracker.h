@@ -0,0 +1,188 @@
+/*
+ * 文件: memory_tracker.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 分层的内存记账：服务器、会话、查询、算子各一层，
+ *       每层可以设置上限，超过时算子溢出到临时页面或者查询报错
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+#include "common/config.h"
+#include "common/exception.h"
+
+namespace SimpleRDBMS {
+
+/** 记账超过某一层的上限，而调用者没有办法溢出时抛出 */
+class MemoryLimitExceededException : public ExecutionException {
+   public:
+    explicit MemoryLimitExceededException(const std::string& message)
+        : ExecutionException(message) {}
+};
+
+/**
+ * MemoryTracker - 一层内存记账
+ *
+ * 设计思路：
+ * - 记账器按服务器 -> 会话 -> 查询串成一条链，记到一层时沿着父节点
+ *   一路加上去，任何一层超过自己的上限就把已经加上的撤回，这次记账失败
+ * - 只记账不分配：大块的内存（排序的行、哈希表、结果集、缓存项）由
+ *   使用者估计字节数报上来，小对象不记，记账的开销只在大块增长时发生
+ * - 算子一层用MemoryReservation：按块预留，增长不到一块时只是一次比较
+ * - 和QueryArena一样有线程局部的"当前记账器"，服务器处理一条查询时
+ *   把查询的记账器装上，执行引擎交给ExecutorContext
+ * - 计数都是原子的，并行扫描的工作线程和别的连接的查询可以同时记账；
+ *   上限和work_mem只在查询开始前设置
+ */
+class MemoryTracker {
+   public:
+    /**
+     * 构造函数
+     * @param label 记账层的名字，出现在超限的错误信息里
+     * @param parent 上一层，nullptr表示最上层
+     * @param limit 上限字节数，0表示不限
+     */
+    explicit MemoryTracker(std::string label, MemoryTracker* parent = nullptr,
+                           size_t limit = 0);
+
+    /** 析构时把还没释放的字节从上面各层撤回 */
+    ~MemoryTracker();
+
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+    /**
+     * 记账bytes字节
+     * @return 这一层或上面某一层会超过上限时返回false，什么也不改变
+     */
+    bool TryConsume(size_t bytes);
+
+    /**
+     * 记账bytes字节，失败时记下错误信息
+     * @throws MemoryLimitExceededException 超过了某一层的上限
+     */
+    void Consume(size_t bytes);
+
+    /** 释放之前记账的bytes字节 */
+    void Release(size_t bytes);
+
+    /**
+     * 挂到另一层下面
+     * 只能在这一层没有记账时调用，会话的记账器在第一次执行查询时挂到服务器上
+     */
+    void SetParent(MemoryTracker* parent);
+    MemoryTracker* GetParent() const { return parent_; }
+
+    void SetLimit(size_t limit) { limit_.store(limit); }
+    size_t GetLimit() const { return limit_.load(); }
+
+    /**
+     * 每个会溢出的算子（排序、哈希连接、哈希聚合、UPDATE/DELETE收集RID）
+     * 的内存预算，即work_mem；0表示用计划节点上的预算
+     */
+    void SetOperatorBudget(size_t budget) { operator_budget_ = budget; }
+    size_t GetOperatorBudget() const { return operator_budget_; }
+
+    size_t GetUsage() const { return usage_.load(); }
+    size_t GetPeak() const { return peak_.load(); }
+    const std::string& GetLabel() const { return label_; }
+
+    /** 最近一次Consume超限的错误信息，没有超过限时为空 */
+    std::string GetLimitError() const;
+
+    /** 当前线程正在使用的记账器，没有时返回nullptr */
+    static MemoryTracker* Current();
+
+    /** 把记账器装成当前线程的记账器，析构时换回原来的 */
+    class Scope {
+       public:
+        explicit Scope(MemoryTracker* tracker);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+       private:
+        MemoryTracker* previous_;
+    };
+
+   private:
+    /**
+     * 在这一层加上bytes
+     * @return 超过这一层的上限时撤回并返回false
+     */
+    bool AddLocal(size_t bytes);
+
+    /**
+     * 从这一层开始沿父节点逐层加上bytes
+     * @return 成功返回nullptr；否则撤回已经加上的，返回超限的那一层
+     */
+    MemoryTracker* ConsumeChain(size_t bytes);
+
+    std::string label_;
+    MemoryTracker* parent_;
+    std::atomic<size_t> limit_;
+    size_t operator_budget_ = 0;
+    std::atomic<size_t> usage_{0};
+    std::atomic<size_t> peak_{0};
+
+    mutable std::mutex error_mutex_;
+    std::string limit_error_;
+};
+
+/**
+ * MemoryReservation - 算子在记账器上的一份预留
+ *
+ * 算子用到的内存变化时调用TryResize/Resize，预留按MEMORY_RESERVATION_CHUNK
+ * 向上取整，增长没有超过已经预留的部分时不碰记账器；
+ * 缩小时把多出来的整块还回去。析构时全部释放。
+ * 记账器为nullptr时不记账，TryResize总是成功
+ */
+class MemoryReservation {
+   public:
+    MemoryReservation() = default;
+    explicit MemoryReservation(MemoryTracker* tracker) : tracker_(tracker) {}
+    ~MemoryReservation() { Release(); }
+
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+    /** 换一个记账器，之前的预留先释放 */
+    void SetTracker(MemoryTracker* tracker);
+
+    /**
+     * 把预留调整到至少bytes字节
+     * @return 增长时记账器拒绝返回false，预留保持原样
+     */
+    bool TryResize(size_t bytes) {
+        if (bytes <= reserved_ &&
+            reserved_ - bytes < MEMORY_RESERVATION_CHUNK) {
+            return true;
+        }
+        return ResizeSlow(bytes);
+    }
+
+    /**
+     * 和TryResize一样，增长失败时抛出异常
+     * @throws MemoryLimitExceededException 超过了某一层的上限
+     */
+    void Resize(size_t bytes);
+
+    /** 释放全部预留 */
+    void Release();
+
+    size_t GetReserved() const { return reserved_; }
+
+   private:
+    bool ResizeSlow(size_t bytes);
+
+    MemoryTracker* tracker_ = nullptr;
+    size_t reserved_ = 0;
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,267 @@
+/*
+ * 文件: numa.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: NUMA拓扑探测实现，读取sysfs，用sched/pthread接口绑核，
+ *       用mbind系统调用设置内存交错策略
+ */
+
+#include "common/numa.h"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+
+#include "common/debug.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+// mbind的内存策略编号，见<linux/mempolicy.h>
+constexpr int MPOL_INTERLEAVE_MODE = 3;
+
+const char* const NODE_DIR = "/sys/devices/system/node";
+
+/**
+ * 解析sysfs里的CPU/节点列表，比如"0-3,8,10-11"
+ */
+std::vector<int> ParseList(const std::string& text) {
+    std::vector<int> result;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string item = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (item.empty() || !isdigit(static_cast<unsigned char>(item[0]))) {
+            continue;
+        }
+        size_t dash = item.find('-');
+        int first = std::atoi(item.c_str());
+        int last = dash == std::string::npos
+                       ? first
+                       : std::atoi(item.c_str() + dash + 1);
+        for (int i = first; i <= last; i++) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+std::string ReadFirstLine(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    if (file) {
+        std::getline(file, line);
+    }
+    return line;
+}
+
+std::vector<int> GetAllowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    if (cpus.empty()) {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < std::max(count, 1L); cpu++) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    return cpus;
+}
+
+}  // namespace
+
+const NumaTopology& NumaTopology::Get() {
+    static const NumaTopology topology;
+    return topology;
+}
+
+/**
+ * 探测拓扑
+ *
+ * 实现思路：
+ * 1. 先拿到进程affinity允许的CPU
+ * 2. 遍历/sys/devices/system/node/nodeN，读每个节点的cpulist，
+ *    只保留允许的CPU；没有可用CPU的节点跳过
+ * 3. 一个节点都没读到时，把所有允许的CPU当成节点0
+ * 4. 按节点轮流生成GetSpreadCpus的顺序
+ */
+NumaTopology::NumaTopology() {
+    std::vector<int> allowed = GetAllowedCpus();
+    std::sort(allowed.begin(), allowed.end());
+
+    std::vector<int> node_ids;
+    if (DIR* dir = opendir(NODE_DIR)) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+                isdigit(static_cast<unsigned char>(name[4]))) {
+                node_ids.push_back(std::atoi(name.c_str() + 4));
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(node_ids.begin(), node_ids.end());
+
+    for (int node : node_ids) {
+        std::vector<int> cpus = ParseList(ReadFirstLine(
+            std::string(NODE_DIR) + "/node" + std::to_string(node) +
+            "/cpulist"));
+        std::vector<int> usable;
+        for (int cpu : cpus) {
+            if (std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+                usable.push_back(cpu);
+            }
+        }
+        if (!usable.empty()) {
+            node_ids_.push_back(node);
+            node_cpus_.push_back(std::move(usable));
+        }
+    }
+    if (node_cpus_.empty()) {
+        node_ids_.push_back(0);
+        node_cpus_.push_back(allowed);
+    }
+
+    memory_nodes_ = ParseList(ReadFirstLine(std::string(NODE_DIR) +
+                                            "/has_memory"));
+    if (memory_nodes_.empty()) {
+        memory_nodes_ = node_ids;
+    }
+
+    for (size_t i = 0;; i++) {
+        bool added = false;
+        for (const auto& cpus : node_cpus_) {
+            if (i < cpus.size()) {
+                spread_cpus_.push_back(cpus[i]);
+                added = true;
+            }
+        }
+        if (!added) {
+            break;
+        }
+    }
+
+    LOG_DEBUG("NumaTopology: " << node_cpus_.size() << " node(s), "
+                               << spread_cpus_.size() << " usable cpu(s)");
+}
+
+const std::vector<int>& NumaTopology::GetNodeCpus(int node) const {
+    static const std::vector<int> empty;
+    for (size_t i = 0; i < node_ids_.size(); i++) {
+        if (node_ids_[i] == node) {
+            return node_cpus_[i];
+        }
+    }
+    return empty;
+}
+
+int NumaTopology::GetNodeOfCpu(int cpu) const {
+    for (size_t i = 0; i < node_cpus_.size(); i++) {
+        const auto& cpus = node_cpus_[i];
+        if (std::find(cpus.begin(), cpus.end(), cpu) != cpus.end()) {
+            return node_ids_[i];
+        }
+    }
+    return -1;
+}
+
+/**
+ * 网卡的节点在/sys/class/net/<网卡>/device/numa_node里，
+ * 虚拟网卡没有device目录，单路机器上是-1
+ */
+int NumaTopology::GetNetworkDeviceNode(const std::string& interface) {
+    auto read_node = [](const std::string& name) {
+        std::string line =
+            ReadFirstLine("/sys/class/net/" + name + "/device/numa_node");
+        return line.empty() ? -1 : std::atoi(line.c_str());
+    };
+    if (!interface.empty()) {
+        return read_node(interface);
+    }
+
+    int result = -1;
+    if (DIR* dir = opendir("/sys/class/net")) {
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] == '.') {
+                continue;
+            }
+            int node = read_node(entry->d_name);
+            if (node >= 0) {
+                result = node;
+                break;
+            }
+        }
+        closedir(dir);
+    }
+    return result;
+}
+
+bool NumaTopology::PinCurrentThread(int cpu) {
+    return PinCurrentThread(std::vector<int>{cpu});
+}
+
+bool NumaTopology::PinCurrentThread(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (CPU_COUNT(&set) == 0) {
+        return false;
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+/**
+ * 交错分配
+ * 直接调用mbind系统调用，节点掩码按unsigned long分组；
+ * maxnode要比掩码的位数多1，内核只读maxnode-1位
+ */
+bool NumaTopology::InterleaveMemory(void* addr, size_t length) const {
+#ifdef SYS_mbind
+    if (memory_nodes_.size() < 2 || addr == nullptr || length == 0) {
+        return false;
+    }
+    constexpr size_t BITS = sizeof(unsigned long) * 8;
+    int max_node =
+        *std::max_element(memory_nodes_.begin(), memory_nodes_.end());
+    std::vector<unsigned long> mask(static_cast<size_t>(max_node) / BITS + 1);
+    for (int node : memory_nodes_) {
+        mask[node / BITS] |= 1UL << (node % BITS);
+    }
+    long rc = syscall(SYS_mbind, addr, length, MPOL_INTERLEAVE_MODE,
+                      mask.data(), mask.size() * BITS + 1, 0);
+    if (rc != 0) {
+        LOG_DEBUG("mbind(MPOL_INTERLEAVE) failed, using default placement");
+        return false;
+    }
+    return true;
+#else
+    (void)addr;
+    (void)length;
+    return false;
+#endif
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,76 @@
+/*
+ * 文件: numa.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: CPU/NUMA拓扑探测和线程绑核、内存交错分配的工具
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace SimpleRDBMS {
+
+/**
+ * NumaTopology - 本机的NUMA节点和CPU分布
+ *
+ * 设计思路：
+ * - 拓扑从/sys/devices/system/node读出来，不依赖libnuma；读不到的时候
+ *   （非Linux、容器里没有挂sysfs）当成一个节点，包含进程能用的所有CPU
+ * - 只保留进程当前affinity允许的CPU，taskset/cgroup限制过的CPU不会被分出去
+ * - 绑核和内存策略都是尽力而为，失败时返回false，调用方照常运行
+ */
+class NumaTopology {
+   public:
+    /** 进程级的单例，第一次调用时探测 */
+    static const NumaTopology& Get();
+
+    /** 有可用CPU的NUMA节点数量，至少为1 */
+    size_t GetNodeCount() const { return node_cpus_.size(); }
+
+    /** 有可用CPU的节点编号（sysfs里的编号，不一定连续） */
+    const std::vector<int>& GetNodeIds() const { return node_ids_; }
+
+    /** 某个节点上可用的CPU编号，节点不存在或没有可用CPU时返回空 */
+    const std::vector<int>& GetNodeCpus(int node) const;
+
+    /**
+     * 所有可用CPU，按节点轮流排列：node0的第1个、node1的第1个、
+     * node0的第2个……按下标依次分给线程时各个节点分到的线程数差不多
+     */
+    const std::vector<int>& GetSpreadCpus() const { return spread_cpus_; }
+
+    /** CPU所在的节点，不认识的CPU返回-1 */
+    int GetNodeOfCpu(int cpu) const;
+
+    /**
+     * 网卡所在的NUMA节点
+     * @param interface 网卡名，为空时找第一块报告了节点的网卡
+     * @return 节点编号，不知道时返回-1（单路机器、虚拟网卡都是这样）
+     */
+    static int GetNetworkDeviceNode(const std::string& interface);
+
+    /** 把当前线程绑到一个CPU上 */
+    static bool PinCurrentThread(int cpu);
+
+    /** 把当前线程限制在一组CPU上（比如一个节点的所有CPU） */
+    static bool PinCurrentThread(const std::vector<int>& cpus);
+
+    /**
+     * 让一段还没有被访问过的内存在所有节点之间按页交错分配
+     * 只有一个节点时什么也不做并返回false
+     */
+    bool InterleaveMemory(void* addr, size_t length) const;
+
+   private:
+    NumaTopology();
+
+    std::vector<int> node_ids_;
+    std::vector<std::vector<int>> node_cpus_;  // 和node_ids_一一对应
+    std::vector<int> spread_cpus_;
+    std::vector<int> memory_nodes_;  // 有内存的节点，用于交错分配
+};
+
+}  // namespace SimpleRDBMS
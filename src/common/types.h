@@ -34,6 +34,30 @@ enum class TypeId {
     TIMESTAMP     // 时间戳：日期时间类型（暂未完全实现）
 };
 
+// ==================== 索引结构枚举 ====================
+// CREATE INDEX ... USING HASH 选择哈希索引，默认是B+树
+// B+树支持等值、前缀和范围查找；哈希索引只支持完整键的等值查找
+enum class IndexType {
+    BPLUS_TREE = 0,  // B+树索引
+    HASH             // 可扩展哈希索引
+};
+
+// ==================== 表存储格式枚举 ====================
+// CREATE TABLE ... WITH (storage=column) 选择列存，默认是行存的表堆
+// 列存表只能追加：不支持UPDATE、DELETE和索引
+enum class TableStorage {
+    ROW = 0,  // 行存表堆
+    COLUMN    // 每列一条页面链表的列存
+};
+
+// ==================== 页面压缩算法枚举 ====================
+// CREATE TABLE ... WITH (compression=lz4) 选择，表和它的B+树索引的页面
+// 在写盘时压缩，缓冲池里的页面始终是解压后的
+enum class PageCompression : uint8_t {
+    NONE = 0,  // 不压缩
+    LZ4        // LZ4块格式
+};
+
 // ==================== 通用值存储类型 ====================
 // 使用std::variant实现类型安全的联合体
 // 这样可以在一个变量中存储不同类型的值，同时保持类型安全
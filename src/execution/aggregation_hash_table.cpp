@@ -0,0 +1,476 @@
+/*
+ * 文件: aggregation_hash_table.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 哈希聚合分组哈希表的实现
+ */
+
+#include "execution/aggregation_hash_table.h"
+
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+#include "common/exception.h"
+
+namespace SimpleRDBMS {
+
+static bool IsIntegral(TypeId type) {
+    return type == TypeId::BOOLEAN || type == TypeId::TINYINT ||
+           type == TypeId::SMALLINT || type == TypeId::INTEGER ||
+           type == TypeId::BIGINT;
+}
+
+static bool IsReal(TypeId type) {
+    return type == TypeId::FLOAT || type == TypeId::DOUBLE;
+}
+
+/** 数值类型的值转换成int64，字符串抛异常 */
+static int64_t ToInteger(const Value& value) {
+    return std::visit(
+        [](const auto& v) -> int64_t {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_arithmetic_v<T>) {
+                return static_cast<int64_t>(v);
+            } else {
+                throw ExecutionException(
+                    "Aggregation: expected a numeric value");
+            }
+        },
+        value);
+}
+
+/** 数值类型的值转换成double，字符串抛异常 */
+static double ToReal(const Value& value) {
+    return std::visit(
+        [](const auto& v) -> double {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_arithmetic_v<T>) {
+                return static_cast<double>(v);
+            } else {
+                throw ExecutionException(
+                    "Aggregation: expected a numeric value");
+            }
+        },
+        value);
+}
+
+/** 用整数或者浮点数构造type类型的值，字符串类型得到空串 */
+static Value MakeValue(TypeId type, int64_t integer, double real) {
+    switch (type) {
+        case TypeId::BOOLEAN:
+            return Value(integer != 0);
+        case TypeId::TINYINT:
+            return Value(static_cast<int8_t>(integer));
+        case TypeId::SMALLINT:
+            return Value(static_cast<int16_t>(integer));
+        case TypeId::INTEGER:
+            return Value(static_cast<int32_t>(integer));
+        case TypeId::BIGINT:
+            return Value(integer);
+        case TypeId::FLOAT:
+            return Value(static_cast<float>(real));
+        case TypeId::DOUBLE:
+            return Value(real);
+        default:
+            return Value(std::string());
+    }
+}
+
+/** 把分组键的值转换成key_schema的列类型，保证相同的键序列化结果相同 */
+static Value ConvertKey(const Value& value, TypeId type) {
+    if (type == TypeId::VARCHAR) {
+        if (!std::holds_alternative<std::string>(value)) {
+            throw ExecutionException(
+                "Aggregation: expected a string group key");
+        }
+        return value;
+    }
+    if (IsReal(type)) {
+        return MakeValue(type, 0, ToReal(value));
+    }
+    return MakeValue(type, ToInteger(value), 0.0);
+}
+
+/** 检查每个聚合函数都支持参数的类型，不支持时抛异常 */
+static std::vector<AggregationHashTable::Aggregate> CheckAggregates(
+    std::vector<AggregationHashTable::Aggregate> aggregates) {
+    for (const auto& aggregate : aggregates) {
+        AggregationHashTable::GetResultType(aggregate.type,
+                                            aggregate.input_type);
+    }
+    return aggregates;
+}
+
+/** 部分聚合结果的列：分组键，接着每个聚合函数的计数和值 */
+static std::vector<Column> PartialColumns(
+    const Schema* key_schema,
+    const std::vector<AggregationHashTable::Aggregate>& aggregates) {
+    std::vector<Column> columns = key_schema->GetColumns();
+    for (size_t i = 0; i < aggregates.size(); i++) {
+        const auto& aggregate = aggregates[i];
+        TypeId value_type = TypeId::BIGINT;
+        if (aggregate.type == AggregateType::AVG ||
+            ((aggregate.type == AggregateType::SUM ||
+              aggregate.type == AggregateType::MIN ||
+              aggregate.type == AggregateType::MAX) &&
+             IsReal(aggregate.input_type))) {
+            value_type = TypeId::DOUBLE;
+        } else if ((aggregate.type == AggregateType::MIN ||
+                    aggregate.type == AggregateType::MAX) &&
+                   aggregate.input_type == TypeId::VARCHAR) {
+            value_type = TypeId::VARCHAR;
+        }
+        std::string suffix = std::to_string(i);
+        columns.push_back(
+            Column{"count" + suffix, TypeId::BIGINT, 0, false, false});
+        columns.push_back(Column{"value" + suffix, value_type,
+                                 value_type == TypeId::VARCHAR ? 65535u : 0u,
+                                 false, false});
+    }
+    return columns;
+}
+
+TypeId AggregationHashTable::GetResultType(AggregateType type,
+                                           TypeId input_type) {
+    switch (type) {
+        case AggregateType::COUNT_STAR:
+        case AggregateType::COUNT:
+            return TypeId::BIGINT;
+        case AggregateType::SUM:
+            if (IsIntegral(input_type)) {
+                return TypeId::BIGINT;
+            }
+            if (IsReal(input_type)) {
+                return TypeId::DOUBLE;
+            }
+            break;
+        case AggregateType::AVG:
+            if (IsIntegral(input_type) || IsReal(input_type)) {
+                return TypeId::DOUBLE;
+            }
+            break;
+        case AggregateType::MIN:
+        case AggregateType::MAX:
+            if (IsIntegral(input_type) || IsReal(input_type) ||
+                input_type == TypeId::VARCHAR) {
+                return input_type;
+            }
+            break;
+    }
+    throw ExecutionException(
+        "Aggregation: unsupported argument type " +
+        std::to_string(static_cast<int>(input_type)));
+}
+
+AggregationHashTable::AggregationHashTable(const Schema* key_schema,
+                                           std::vector<Aggregate> aggregates)
+    : key_schema_(key_schema),
+      aggregates_(CheckAggregates(std::move(aggregates))),
+      partial_schema_(PartialColumns(key_schema, aggregates_)) {
+    for (const auto& aggregate : aggregates_) {
+        bool extreme = aggregate.type == AggregateType::MIN ||
+                       aggregate.type == AggregateType::MAX;
+        if (aggregate.type == AggregateType::AVG ||
+            ((extreme || aggregate.type == AggregateType::SUM) &&
+             IsReal(aggregate.input_type))) {
+            classes_.push_back(ValueClass::REAL);
+        } else if (extreme && aggregate.input_type == TypeId::VARCHAR) {
+            classes_.push_back(ValueClass::STRING);
+        } else {
+            classes_.push_back(ValueClass::INTEGER);
+        }
+    }
+}
+
+/** 序列化的分组键之后按8字节对齐放聚合状态 */
+static size_t StateOffset(uint32_t key_size) {
+    return (sizeof(uint32_t) + key_size + 7) & ~static_cast<size_t>(7);
+}
+
+/**
+ * 查找或者新建分组
+ * 实现思路：
+ * 1. 分组键转换成key_schema的类型后按行格式序列化到缓冲区，对字节求哈希
+ * 2. 沿探测序列找哈希值和键字节都相同的分组
+ * 3. 找不到时在内存区里分配[键长度][键][状态]，状态全部清零
+ */
+AggregationHashTable::State* AggregationHashTable::FindOrCreateGroup(
+    const std::vector<Value>& key, const std::vector<bool>& key_nulls) {
+    std::vector<Value> values;
+    values.reserve(key.size());
+    for (size_t i = 0; i < key.size(); i++) {
+        TypeId type = key_schema_->GetColumn(i).type;
+        values.push_back(key_nulls[i] ? MakeValue(type, 0, 0.0)
+                                      : ConvertKey(key[i], type));
+    }
+    Tuple key_tuple(std::move(values), key_schema_);
+    for (size_t i = 0; i < key.size(); i++) {
+        if (key_nulls[i]) {
+            key_tuple.SetNull(i, true);
+        }
+    }
+    uint32_t key_size = static_cast<uint32_t>(key_tuple.GetSerializedSize());
+    key_buffer_.resize(key_size);
+    key_tuple.SerializeTo(key_buffer_.data());
+    uint64_t hash = std::hash<std::string_view>()(
+        std::string_view(key_buffer_.data(), key_size));
+
+    if ((group_count_ + 1) * 2 > slots_.size()) {
+        Grow();
+    }
+    size_t mask = slots_.size() - 1;
+    size_t position = hash & mask;
+    while (slots_[position].group != nullptr) {
+        const Slot& slot = slots_[position];
+        if (slot.hash == hash) {
+            uint32_t size;
+            std::memcpy(&size, slot.group, sizeof(uint32_t));
+            if (size == key_size &&
+                std::memcmp(slot.group + sizeof(uint32_t), key_buffer_.data(),
+                            key_size) == 0) {
+                return reinterpret_cast<State*>(slot.group +
+                                                StateOffset(key_size));
+            }
+        }
+        position = (position + 1) & mask;
+    }
+
+    size_t state_offset = StateOffset(key_size);
+    size_t group_size = state_offset + aggregates_.size() * sizeof(State);
+    // 内存区按块分配，块内的偏移不一定对齐，多申请一些自己对齐
+    char* raw = arena_.Allocate(group_size + alignof(State));
+    char* group = raw + ((alignof(State) - reinterpret_cast<uintptr_t>(raw) %
+                                               alignof(State)) %
+                         alignof(State));
+    std::memcpy(group, &key_size, sizeof(uint32_t));
+    std::memcpy(group + sizeof(uint32_t), key_buffer_.data(), key_size);
+    std::memset(group + state_offset, 0, aggregates_.size() * sizeof(State));
+    slots_[position] = Slot{hash, group};
+    group_count_++;
+    return reinterpret_cast<State*>(group + state_offset);
+}
+
+void AggregationHashTable::Accumulate(
+    const std::vector<Value>& key, const std::vector<bool>& key_nulls,
+    const std::vector<const Value*>& arguments) {
+    State* states = FindOrCreateGroup(key, key_nulls);
+    for (size_t i = 0; i < aggregates_.size(); i++) {
+        if (aggregates_[i].type == AggregateType::COUNT_STAR) {
+            states[i].count++;
+        } else if (arguments[i] != nullptr) {
+            Apply(i, &states[i], 1, *arguments[i]);
+        }
+    }
+}
+
+void AggregationHashTable::AddGroup(const std::vector<Value>& key,
+                                    const std::vector<bool>& key_nulls) {
+    FindOrCreateGroup(key, key_nulls);
+}
+
+void AggregationHashTable::MergePartial(const Tuple& partial) {
+    size_t key_count = key_schema_->GetColumnCount();
+    std::vector<Value> key;
+    std::vector<bool> key_nulls;
+    for (size_t i = 0; i < key_count; i++) {
+        key.push_back(partial.GetValue(i));
+        key_nulls.push_back(partial.IsNull(i));
+    }
+    State* states = FindOrCreateGroup(key, key_nulls);
+    for (size_t i = 0; i < aggregates_.size(); i++) {
+        int64_t count = ToInteger(partial.GetValue(key_count + 2 * i));
+        Apply(i, &states[i], count, partial.GetValue(key_count + 2 * i + 1));
+    }
+}
+
+void AggregationHashTable::Apply(size_t index, State* state, int64_t count,
+                                 const Value& value) {
+    if (count == 0) {
+        return;
+    }
+    switch (aggregates_[index].type) {
+        case AggregateType::SUM:
+        case AggregateType::AVG:
+            if (classes_[index] == ValueClass::REAL) {
+                state->real += ToReal(value);
+            } else {
+                state->integer += ToInteger(value);
+            }
+            break;
+        case AggregateType::MIN:
+        case AggregateType::MAX:
+            UpdateExtreme(index, state, value);
+            break;
+        default:
+            break;
+    }
+    state->count += count;
+}
+
+void AggregationHashTable::UpdateExtreme(size_t index, State* state,
+                                         const Value& value) {
+    bool is_min = aggregates_[index].type == AggregateType::MIN;
+    bool first = state->count == 0;
+    switch (classes_[index]) {
+        case ValueClass::INTEGER: {
+            int64_t v = ToInteger(value);
+            if (first || (is_min ? v < state->integer : v > state->integer)) {
+                state->integer = v;
+            }
+            break;
+        }
+        case ValueClass::REAL: {
+            double v = ToReal(value);
+            if (first || (is_min ? v < state->real : v > state->real)) {
+                state->real = v;
+            }
+            break;
+        }
+        case ValueClass::STRING: {
+            const auto* v = std::get_if<std::string>(&value);
+            if (v == nullptr) {
+                throw ExecutionException(
+                    "Aggregation: expected a string value");
+            }
+            if (first) {
+                state->integer = static_cast<int64_t>(strings_.size());
+                strings_.push_back(*v);
+                string_bytes_ += v->size();
+                break;
+            }
+            std::string& current = strings_[state->integer];
+            if (is_min ? *v < current : *v > current) {
+                string_bytes_ += v->size();
+                string_bytes_ -= current.size();
+                current = *v;
+            }
+            break;
+        }
+    }
+}
+
+Value AggregationHashTable::PartialValue(size_t index,
+                                         const State& state) const {
+    switch (classes_[index]) {
+        case ValueClass::REAL:
+            return Value(state.real);
+        case ValueClass::STRING:
+            return state.count > 0 ? Value(strings_[state.integer])
+                                   : Value(std::string());
+        default:
+            return Value(state.integer);
+    }
+}
+
+void AggregationHashTable::ForEachPartial(
+    const std::function<void(uint64_t, const Tuple&)>& callback) const {
+    for (const Slot& slot : slots_) {
+        if (slot.group == nullptr) {
+            continue;
+        }
+        uint32_t key_size;
+        std::memcpy(&key_size, slot.group, sizeof(uint32_t));
+        Tuple key;
+        key.DeserializeFrom(slot.group + sizeof(uint32_t), key_schema_);
+        const auto* states = reinterpret_cast<const State*>(
+            slot.group + StateOffset(key_size));
+
+        std::vector<Value> values = key.GetValues();
+        for (size_t i = 0; i < aggregates_.size(); i++) {
+            values.push_back(Value(states[i].count));
+            values.push_back(PartialValue(i, states[i]));
+        }
+        Tuple partial(std::move(values), &partial_schema_);
+        for (size_t i = 0; i < key_schema_->GetColumnCount(); i++) {
+            if (key.IsNull(i)) {
+                partial.SetNull(i, true);
+            }
+        }
+        callback(slot.hash, partial);
+    }
+}
+
+/**
+ * 输出最终结果
+ * 实现思路：COUNT直接是计数；其他聚合函数没有非NULL输入时结果为NULL，
+ * 值用结果类型的零值占位；AVG在这里才用和除以计数
+ */
+void AggregationHashTable::ForEachResult(
+    const std::function<void(const Tuple&, const std::vector<Value>&,
+                             const std::vector<bool>&)>& callback) const {
+    std::vector<Value> results(aggregates_.size());
+    std::vector<bool> nulls(aggregates_.size());
+    for (const Slot& slot : slots_) {
+        if (slot.group == nullptr) {
+            continue;
+        }
+        uint32_t key_size;
+        std::memcpy(&key_size, slot.group, sizeof(uint32_t));
+        Tuple key;
+        key.DeserializeFrom(slot.group + sizeof(uint32_t), key_schema_);
+        const auto* states = reinterpret_cast<const State*>(
+            slot.group + StateOffset(key_size));
+
+        for (size_t i = 0; i < aggregates_.size(); i++) {
+            const Aggregate& aggregate = aggregates_[i];
+            const State& state = states[i];
+            TypeId result_type =
+                GetResultType(aggregate.type, aggregate.input_type);
+            bool is_count = aggregate.type == AggregateType::COUNT_STAR ||
+                            aggregate.type == AggregateType::COUNT;
+            nulls[i] = !is_count && state.count == 0;
+            if (is_count) {
+                results[i] = Value(state.count);
+            } else if (nulls[i]) {
+                results[i] = MakeValue(result_type, 0, 0.0);
+            } else if (aggregate.type == AggregateType::AVG) {
+                results[i] = Value(
+                    (classes_[i] == ValueClass::REAL
+                         ? state.real
+                         : static_cast<double>(state.integer)) /
+                    static_cast<double>(state.count));
+            } else if (classes_[i] == ValueClass::STRING) {
+                results[i] = Value(strings_[state.integer]);
+            } else if (classes_[i] == ValueClass::REAL) {
+                results[i] = MakeValue(result_type, 0, state.real);
+            } else {
+                results[i] = MakeValue(result_type, state.integer, 0.0);
+            }
+        }
+        callback(key, results, nulls);
+    }
+}
+
+void AggregationHashTable::Grow() {
+    std::vector<Slot> old_slots = std::move(slots_);
+    slots_.assign(old_slots.empty() ? 16 : old_slots.size() * 2, Slot{});
+    size_t mask = slots_.size() - 1;
+    for (const Slot& slot : old_slots) {
+        if (slot.group == nullptr) {
+            continue;
+        }
+        size_t position = slot.hash & mask;
+        while (slots_[position].group != nullptr) {
+            position = (position + 1) & mask;
+        }
+        slots_[position] = slot;
+    }
+}
+
+void AggregationHashTable::Clear() {
+    arena_.Clear();
+    slots_.clear();
+    group_count_ = 0;
+    strings_.clear();
+    string_bytes_ = 0;
+}
+
+size_t AggregationHashTable::GetMemoryUsage() const {
+    return arena_.GetAllocatedBytes() + slots_.size() * sizeof(Slot) +
+           strings_.capacity() * sizeof(std::string) + string_bytes_;
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,168 @@
+/*
+ * 文件: aggregation_hash_table.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 哈希聚合用到的分组哈希表：分组键和定长的聚合状态放在同一块内存区，
+ *       可以导出、合并部分聚合结果，用于溢出到临时页面后再合并
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/types.h"
+#include "execution/join_hash_table.h"
+#include "execution/plan_node.h"
+#include "parser/ast.h"
+#include "record/tuple.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * AggregationHashTable - 按分组键累加聚合状态的哈希表
+ *
+ * 设计思路：
+ * - 每个分组在TupleArena里占一段连续的内存：
+ *   [分组键按行格式序列化][按8字节对齐的聚合状态，每个聚合函数16字节]
+ *   一个状态是int64的计数加上8字节的值：SUM是int64或double的和，
+ *   AVG是double的和，MIN/MAX是当前的最值；字符串的最值放在单独的数组里，
+ *   状态里只记下标
+ * - 槽位数组开放寻址（线性探测），槽位里保存哈希值和分组地址，
+ *   哈希值相同再比较序列化的键；分组键先转换成key_schema的类型，
+ *   相同的键序列化出来的字节一定相同
+ * - 部分聚合结果是一行：分组键的各列，接着每个聚合函数的计数和值两列，
+ *   两张表各自累加不同的输入后，把一张表导出的部分结果合并进另一张，
+ *   和在一张表里累加全部输入的结果一样
+ */
+class AggregationHashTable {
+   public:
+    /** 一个聚合函数，input_type是参数的类型，COUNT(*)忽略 */
+    struct Aggregate {
+        AggregateType type;
+        TypeId input_type;
+    };
+
+    /**
+     * 构造函数
+     * @param key_schema 分组键的schema，没有GROUP BY时为空schema
+     * @param aggregates 聚合函数
+     * @throws ExecutionException 聚合函数不支持参数的类型，比如SUM(VARCHAR)
+     */
+    AggregationHashTable(const Schema* key_schema,
+                         std::vector<Aggregate> aggregates);
+
+    AggregationHashTable(const AggregationHashTable&) = delete;
+    AggregationHashTable& operator=(const AggregationHashTable&) = delete;
+
+    /**
+     * 把一行输入累加到它的分组上
+     * @param key 分组键，值会转换成key_schema的类型
+     * @param key_nulls 分组键的每一列是否为NULL，NULL和NULL是同一个分组
+     * @param arguments 每个聚合函数的参数值，nullptr表示NULL；COUNT(*)忽略
+     */
+    void Accumulate(const std::vector<Value>& key,
+                    const std::vector<bool>& key_nulls,
+                    const std::vector<const Value*>& arguments);
+
+    /**
+     * 创建一个没有任何输入的分组，已经存在时什么也不做
+     * 用于没有GROUP BY而输入为空的聚合：仍然要输出COUNT为0的一行
+     */
+    void AddGroup(const std::vector<Value>& key,
+                  const std::vector<bool>& key_nulls);
+
+    /** 合并一行部分聚合结果，schema是GetPartialSchema() */
+    void MergePartial(const Tuple& partial);
+
+    /**
+     * 导出所有分组的部分聚合结果
+     * @param callback 参数是分组键的哈希值和部分结果
+     */
+    void ForEachPartial(
+        const std::function<void(uint64_t, const Tuple&)>& callback) const;
+
+    /**
+     * 输出所有分组的最终结果
+     * @param callback 参数是分组键（key_schema）、每个聚合函数的结果，
+     *        以及结果是否为NULL（除COUNT外没有非NULL输入时为NULL）
+     */
+    void ForEachResult(
+        const std::function<void(const Tuple&, const std::vector<Value>&,
+                                 const std::vector<bool>&)>& callback) const;
+
+    /** 释放所有分组 */
+    void Clear();
+
+    size_t GetGroupCount() const { return group_count_; }
+
+    /** 分组、槽位和字符串最值占用的字节数 */
+    size_t GetMemoryUsage() const;
+
+    /** 部分聚合结果的schema */
+    const Schema* GetPartialSchema() const { return &partial_schema_; }
+
+    /**
+     * 聚合函数结果的类型
+     * COUNT是BIGINT；SUM对整数是BIGINT、对浮点数是DOUBLE；AVG是DOUBLE；
+     * MIN/MAX和参数类型相同
+     * @throws ExecutionException 不支持的组合，比如SUM(VARCHAR)
+     */
+    static TypeId GetResultType(AggregateType type, TypeId input_type);
+
+   private:
+    /** 一个聚合状态，MIN/MAX的字符串最值记下标 */
+    struct State {
+        int64_t count;
+        union {
+            int64_t integer;
+            double real;
+        };
+    };
+
+    /** 一个槽位，group为nullptr表示空槽位 */
+    struct Slot {
+        uint64_t hash = 0;
+        char* group = nullptr;
+    };
+
+    /** 参数的类别，决定状态里的值怎么解释 */
+    enum class ValueClass { INTEGER, REAL, STRING };
+
+    /** 找到分组键的状态，不存在时新建一个全零的分组 */
+    State* FindOrCreateGroup(const std::vector<Value>& key,
+                             const std::vector<bool>& key_nulls);
+
+    /**
+     * 把count行、合计为value的输入合并到状态上
+     * 累加一行输入时count是1、value是参数值；合并部分结果时是对方的计数和值
+     */
+    void Apply(size_t index, State* state, int64_t count, const Value& value);
+
+    /** MIN/MAX用value更新最值 */
+    void UpdateExtreme(size_t index, State* state, const Value& value);
+
+    /** 状态里的值转换成部分结果里的值 */
+    Value PartialValue(size_t index, const State& state) const;
+
+    void Grow();
+
+    const Schema* key_schema_;
+    std::vector<Aggregate> aggregates_;
+    std::vector<ValueClass> classes_;
+    Schema partial_schema_;
+
+    TupleArena arena_;
+    std::vector<Slot> slots_;  // 容量总是2的幂
+    size_t group_count_ = 0;
+    std::vector<std::string> strings_;  // 字符串的最值
+    size_t string_bytes_ = 0;
+    std::vector<char> key_buffer_;  // 序列化分组键用的缓冲区
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,84 @@
+/*
+ * 文件: cancellation_token.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 查询取消令牌的实现
+ */
+
+#include "execution/cancellation_token.h"
+
+#include <chrono>
+
+namespace SimpleRDBMS {
+
+namespace {
+
+thread_local CancellationToken* current_cancellation_token = nullptr;
+
+int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace
+
+QueryCancelledException::QueryCancelledException(CancelReason reason)
+    : ExecutionException(CancellationToken::DescribeReason(reason)),
+      reason_(reason) {}
+
+CancellationToken::CancellationToken()
+    : previous_(current_cancellation_token) {
+    current_cancellation_token = this;
+}
+
+CancellationToken::~CancellationToken() {
+    current_cancellation_token = previous_;
+}
+
+CancellationToken* CancellationToken::Current() {
+    return current_cancellation_token;
+}
+
+void CancellationToken::Cancel(CancelReason reason) {
+    CancelReason expected = CancelReason::NONE;
+    reason_.compare_exchange_strong(expected, reason,
+                                    std::memory_order_acq_rel);
+}
+
+void CancellationToken::SetTimeout(int64_t timeout_ms) {
+    deadline_ns_.store(timeout_ms > 0 ? SteadyNowNs() + timeout_ms * 1000000
+                                      : 0,
+                       std::memory_order_release);
+}
+
+bool CancellationToken::IsCancelled() {
+    if (reason_.load(std::memory_order_acquire) != CancelReason::NONE) {
+        return true;
+    }
+    int64_t deadline = deadline_ns_.load(std::memory_order_acquire);
+    if (deadline != 0 && SteadyNowNs() >= deadline) {
+        Cancel(CancelReason::STATEMENT_TIMEOUT);
+        return true;
+    }
+    return false;
+}
+
+void CancellationToken::ThrowIfCancelled() {
+    if (IsCancelled()) {
+        throw QueryCancelledException(GetReason());
+    }
+}
+
+std::string CancellationToken::DescribeReason(CancelReason reason) {
+    switch (reason) {
+        case CancelReason::USER_REQUEST:
+            return "canceling statement due to user request";
+        case CancelReason::STATEMENT_TIMEOUT:
+            return "canceling statement due to statement timeout";
+        default:
+            return "statement not cancelled";
+    }
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,90 @@
+/*
+ * 文件: cancellation_token.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 查询取消令牌：语句超时或者别的连接KILL时让执行器停下来
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "common/exception.h"
+
+namespace SimpleRDBMS {
+
+/** 查询被取消的原因 */
+enum class CancelReason : uint8_t {
+    NONE = 0,
+    USER_REQUEST,      // 别的连接执行了KILL
+    STATEMENT_TIMEOUT  // 超过了会话的statement_timeout
+};
+
+/** 查询被取消时执行器抛出的异常 */
+class QueryCancelledException : public ExecutionException {
+   public:
+    explicit QueryCancelledException(CancelReason reason);
+
+    CancelReason GetReason() const { return reason_; }
+
+   private:
+    CancelReason reason_;
+};
+
+/**
+ * CancellationToken - 一条查询的取消标记
+ *
+ * 设计思路：
+ * - 和PlanCapture一样是线程局部的"当前对象"，服务器处理一条查询时装上，
+ *   执行引擎把它交给ExecutorContext，并行扫描的工作线程从上下文拿到同一个
+ * - 别的线程只调用Cancel，原因是一个原子变量；截止时间也是原子的，
+ *   检查时和当前时间比较，超过了就记成超时，不需要另外的定时线程
+ * - 执行器不是每行都看：ExecutorContext每CANCELLATION_CHECK_INTERVAL次
+ *   才真正检查一次，读时钟的开销分摊到很多行上
+ * - 取消后执行器抛出QueryCancelledException，跟别的执行错误一样一路
+ *   返回，执行器析构时放掉页面和迭代器，事务回滚时放掉锁
+ */
+class CancellationToken {
+   public:
+    /** 装成当前线程的取消令牌，析构时换回原来的 */
+    CancellationToken();
+    ~CancellationToken();
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    /** 当前线程的取消令牌，没有时返回nullptr */
+    static CancellationToken* Current();
+
+    /**
+     * 取消查询，可以从别的线程调用；已经取消时保留第一次的原因
+     */
+    void Cancel(CancelReason reason);
+
+    /**
+     * 从现在起timeout_ms毫秒后超时，0表示不限时
+     */
+    void SetTimeout(int64_t timeout_ms);
+
+    /** 是否已经取消，到了截止时间时记成超时 */
+    bool IsCancelled();
+
+    CancelReason GetReason() const {
+        return reason_.load(std::memory_order_acquire);
+    }
+
+    /** 已经取消时抛出QueryCancelledException */
+    void ThrowIfCancelled();
+
+    /** 取消原因的说明，用作返回给客户端的错误信息 */
+    static std::string DescribeReason(CancelReason reason);
+
+   private:
+    std::atomic<CancelReason> reason_{CancelReason::NONE};
+    std::atomic<int64_t> deadline_ns_{0};  // steady_clock的纳秒数，0表示不限时
+    CancellationToken* previous_;
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,284 @@
+/*
+ * 文件: compiled_expression.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 表达式编译的实现
+ */
+
+#include "execution/compiled_expression.h"
+
+#include "common/exception.h"
+#include "execution/expression_evaluator.h"
+
+namespace SimpleRDBMS {
+
+using OpType = BinaryOpExpression::OpType;
+
+/** 取出tuple里的列值，越界时的错误信息和ExpressionEvaluator一致 */
+static const Value& ColumnValue(const Tuple& tuple, size_t column_index,
+                                const std::string& column_name) {
+    const auto& values = tuple.GetValues();
+    if (column_index >= values.size()) {
+        throw ExecutionException(
+            "Column not found or invalid: " + column_name + " - " +
+            ExecutionException("Column index out of range: " + column_name)
+                .what());
+    }
+    return values[column_index];
+}
+
+/** 取出视图里的列值，只解码这一列，越界时的错误信息和tuple一致 */
+static Value ViewColumnValue(const TupleView& view, size_t column_index,
+                             const std::string& column_name) {
+    if (column_index >= view.GetColumnCount()) {
+        throw ExecutionException(
+            "Column not found or invalid: " + column_name + " - " +
+            ExecutionException("Column index out of range: " + column_name)
+                .what());
+    }
+    return view.GetValue(column_index);
+}
+
+/** 取出视图里的列的紧凑值，VARCHAR直接引用页面，不构造std::string */
+static CompactValue ViewColumnCompact(const TupleView& view,
+                                      size_t column_index,
+                                      const std::string& column_name) {
+    if (column_index >= view.GetColumnCount()) {
+        throw ExecutionException(
+            "Column not found or invalid: " + column_name + " - " +
+            ExecutionException("Column index out of range: " + column_name)
+                .what());
+    }
+    return view.GetCompactValue(column_index);
+}
+
+static bool IsComparison(OpType op) {
+    return op == OpType::EQUALS || op == OpType::NOT_EQUALS ||
+           op == OpType::LESS_THAN || op == OpType::LESS_EQUALS ||
+           op == OpType::GREATER_THAN || op == OpType::GREATER_EQUALS;
+}
+
+CompiledExpression::Function CompiledExpression::Throwing(
+    const std::string& message) {
+    return [message](const Row&) -> Value {
+        throw ExecutionException(message);
+    };
+}
+
+CompiledExpression::CompiledExpression()
+    : function_(Throwing("Null expression")) {}
+
+CompiledExpression CompiledExpression::Compile(const Expression* expr,
+                                               const Schema* schema) {
+    Node node = CompileNode(expr, schema);
+    CompiledExpression compiled;
+    compiled.function_ = std::move(node.function);
+    compiled.is_constant_ = node.is_constant;
+    compiled.constant_ = std::move(node.constant);
+    compiled.is_column_ = node.is_column;
+    compiled.column_index_ = node.column_index;
+    return compiled;
+}
+
+Value CompiledExpression::Evaluate(const TupleView& view) const {
+    return function_(Row{nullptr, &view});
+}
+
+bool CompiledExpression::EvaluateAsBoolean(const Tuple& tuple) const {
+    return ExpressionEvaluator::IsValueTrue(function_(Row{&tuple, nullptr}));
+}
+
+bool CompiledExpression::EvaluateAsBoolean(const TupleView& view) const {
+    return ExpressionEvaluator::IsValueTrue(function_(Row{nullptr, &view}));
+}
+
+CompiledExpression::Node CompiledExpression::MakeConstant(const Value& value) {
+    Node node;
+    node.is_constant = true;
+    node.constant = value;
+    node.function = [value](const Row&) { return value; };
+    return node;
+}
+
+CompiledExpression::Node CompiledExpression::FoldIfConstant(
+    Node node, bool all_children_constant) {
+    if (!all_children_constant) {
+        return node;
+    }
+    try {
+        Tuple empty;
+        return MakeConstant(node.function(Row{&empty, nullptr}));
+    } catch (const std::exception&) {
+        // 比如 1 / 0，错误留到真正求值时报告
+        return node;
+    }
+}
+
+/**
+ * 编译一个节点
+ * 实现思路：
+ * 1. 常量直接捕获值
+ * 2. 列引用在这里查schema得到下标，查不到时编译成抛出异常的节点，
+ *    和逐行求值一样在求值时才报错
+ * 3. 二元和一元操作先编译子节点，再把子节点的闭包捕获进来
+ */
+CompiledExpression::Node CompiledExpression::CompileNode(
+    const Expression* expr, const Schema* schema) {
+    Node node;
+    if (!expr) {
+        node.function = Throwing("Null expression");
+        return node;
+    }
+
+    switch (expr->GetType()) {
+        case Expression::ExprType::CONSTANT:
+            return MakeConstant(
+                static_cast<const ConstantExpression*>(expr)->GetValue());
+
+        case Expression::ExprType::COLUMN_REF: {
+            const std::string& column_name =
+                static_cast<const ColumnRefExpression*>(expr)->GetColumnName();
+            size_t column_index = 0;
+            try {
+                if (!schema) {
+                    throw ExecutionException(
+                        "Schema is null in expression evaluator");
+                }
+                column_index = schema->GetColumnIdx(column_name);
+            } catch (const std::exception& e) {
+                node.function = Throwing("Column not found or invalid: " +
+                                         column_name + " - " + e.what());
+                return node;
+            }
+            node.is_column = true;
+            node.column_index = column_index;
+            node.column_name = column_name;
+            node.function = [column_index, column_name](const Row& row) {
+                if (row.tuple != nullptr) {
+                    return ColumnValue(*row.tuple, column_index, column_name);
+                }
+                return ViewColumnValue(*row.view, column_index, column_name);
+            };
+            return node;
+        }
+
+        case Expression::ExprType::BINARY_OP:
+            return CompileBinary(static_cast<const BinaryOpExpression*>(expr),
+                                 schema);
+
+        case Expression::ExprType::UNARY_OP: {
+            const auto* unary_expr =
+                static_cast<const UnaryOpExpression*>(expr);
+            Node operand = CompileNode(unary_expr->GetOperand(), schema);
+            UnaryOpExpression::OpType op = unary_expr->GetOperator();
+            bool constant_operand = operand.is_constant;
+            node.function = [operand = std::move(operand.function),
+                             op](const Row& row) {
+                return ExpressionEvaluator::ApplyUnaryOp(op, operand(row));
+            };
+            return FoldIfConstant(std::move(node), constant_operand);
+        }
+
+        default:
+            node.function = Throwing("Unsupported expression type");
+            return node;
+    }
+}
+
+/**
+ * 编译二元操作
+ * 实现思路：
+ * 1. AND/OR保持短路求值；左边是常量时直接决定结果或者只剩右边
+ * 2. 列和常量比较时捕获列下标和常量，直接拿tuple里的值比较；
+ *    在视图上求值时只解码这一列
+ * 3. 其他情况组合左右子节点的闭包，子节点都是常量时折叠
+ */
+CompiledExpression::Node CompiledExpression::CompileBinary(
+    const BinaryOpExpression* expr, const Schema* schema) {
+    Node left = CompileNode(expr->GetLeft(), schema);
+    Node right = CompileNode(expr->GetRight(), schema);
+    OpType op = expr->GetOperator();
+    bool all_constant = left.is_constant && right.is_constant;
+    Node node;
+
+    if (op == OpType::AND || op == OpType::OR) {
+        bool is_and = op == OpType::AND;
+        if (left.is_constant) {
+            bool left_true = ExpressionEvaluator::IsValueTrue(left.constant);
+            if (left_true != is_and) {
+                // false AND x 或者 true OR x，右边不会被求值
+                return MakeConstant(Value(left_true));
+            }
+            node.function = [right = std::move(right.function)](
+                                const Row& row) {
+                return Value(ExpressionEvaluator::IsValueTrue(right(row)));
+            };
+            return FoldIfConstant(std::move(node), all_constant);
+        }
+        node.function = [left = std::move(left.function),
+                         right = std::move(right.function),
+                         is_and](const Row& row) {
+            bool left_true = ExpressionEvaluator::IsValueTrue(left(row));
+            if (left_true != is_and) {
+                return Value(left_true);
+            }
+            return Value(ExpressionEvaluator::IsValueTrue(right(row)));
+        };
+        return node;
+    }
+
+    if (op == OpType::PLUS || op == OpType::MINUS || op == OpType::MULTIPLY ||
+        op == OpType::DIVIDE) {
+        node.function = [left = std::move(left.function),
+                         right = std::move(right.function),
+                         op](const Row& row) {
+            Value left_value = left(row);
+            return ExpressionEvaluator::EvaluateArithmeticOp(
+                left_value, right(row), op);
+        };
+        return FoldIfConstant(std::move(node), all_constant);
+    }
+
+    if (IsComparison(op) && left.is_column && right.is_constant) {
+        node.function = [column_index = left.column_index,
+                         column_name = left.column_name,
+                         constant = right.constant, op](const Row& row) {
+            if (row.tuple != nullptr) {
+                return Value(ExpressionEvaluator::CompareValues(
+                    ColumnValue(*row.tuple, column_index, column_name),
+                    constant, op));
+            }
+            return Value(ExpressionEvaluator::CompareCompactValues(
+                ViewColumnCompact(*row.view, column_index, column_name),
+                CompactValue::FromValue(constant), op));
+        };
+        return node;
+    }
+    if (IsComparison(op) && left.is_constant && right.is_column) {
+        node.function = [column_index = right.column_index,
+                         column_name = right.column_name,
+                         constant = left.constant, op](const Row& row) {
+            if (row.tuple != nullptr) {
+                return Value(ExpressionEvaluator::CompareValues(
+                    constant,
+                    ColumnValue(*row.tuple, column_index, column_name), op));
+            }
+            return Value(ExpressionEvaluator::CompareCompactValues(
+                CompactValue::FromValue(constant),
+                ViewColumnCompact(*row.view, column_index, column_name), op));
+        };
+        return node;
+    }
+
+    // 其他操作符交给CompareValues，不支持的操作符会在求值时报错
+    node.function = [left = std::move(left.function),
+                     right = std::move(right.function),
+                     op](const Row& row) {
+        Value left_value = left(row);
+        return Value(
+            ExpressionEvaluator::CompareValues(left_value, right(row), op));
+    };
+    return FoldIfConstant(std::move(node), all_constant);
+}
+
+}  // namespace SimpleRDBMS
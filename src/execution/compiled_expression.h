@@ -0,0 +1,112 @@
+/*
+ * 文件: compiled_expression.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 预编译的表达式，执行器初始化时把表达式树编译成一组预先绑定好的闭包，
+ *       逐行求值时不再按节点类型分发，也不再按列名查找列
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "catalog/schema.h"
+#include "common/types.h"
+#include "parser/ast.h"
+#include "record/tuple.h"
+#include "record/tuple_view.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * CompiledExpression - 编译成闭包树的表达式
+ *
+ * 设计思路：
+ * - 每个表达式节点编译成一个闭包，子节点的闭包被捕获在父节点里，
+ *   节点类型和操作符在编译时就确定了
+ * - 列引用在编译时解析成列下标；列 比较 常量 直接比较tuple里的值，
+ *   不复制列值
+ * - 也可以直接在页面上的TupleView上求值，只解码表达式用到的列
+ * - 只由常量组成的子表达式在编译时算出结果；AND/OR左边是常量时按短路规则化简
+ * - 运算规则沿用ExpressionEvaluator，结果和它逐行求值完全一致；
+ *   找不到列、类型不匹配这类错误在求值时才抛出，抛出的异常也相同
+ *
+ * 编译时用的schema要和求值时tuple的列一致，表达式树在编译后可以释放
+ */
+class CompiledExpression {
+   public:
+    /** 空表达式，求值时抛出异常 */
+    CompiledExpression();
+
+    /**
+     * 编译表达式
+     * @param expr 表达式树，可以为nullptr
+     * @param schema 求值时tuple的schema，用于解析列引用
+     */
+    static CompiledExpression Compile(const Expression* expr,
+                                      const Schema* schema);
+
+    /** 在tuple上求值 */
+    Value Evaluate(const Tuple& tuple) const {
+        return function_(Row{&tuple, nullptr});
+    }
+
+    /** 在页面上的tuple视图上求值，只解码用到的列 */
+    Value Evaluate(const TupleView& view) const;
+
+    /** 求值后按SQL真值语义转换成布尔值，用于WHERE条件 */
+    bool EvaluateAsBoolean(const Tuple& tuple) const;
+    bool EvaluateAsBoolean(const TupleView& view) const;
+
+    /** 整个表达式在编译时就算出了结果，和任何行都无关 */
+    bool IsConstant() const { return is_constant_; }
+
+    /** 常量表达式的值，IsConstant()为true时有效 */
+    const Value& GetConstantValue() const { return constant_; }
+
+    /** 整个表达式就是一个解析出了下标的列引用，结果就是这一列的值 */
+    bool IsColumn() const { return is_column_; }
+
+    /** 列引用的下标，IsColumn()为true时有效 */
+    size_t GetColumnIndex() const { return column_index_; }
+
+   private:
+    /** 求值的输入行，tuple和视图二选一 */
+    struct Row {
+        const Tuple* tuple;
+        const TupleView* view;
+    };
+
+    using Function = std::function<Value(const Row&)>;
+
+    /** 编译出的节点，父节点根据子节点的种类选择更快的组合方式 */
+    struct Node {
+        Function function;
+        bool is_constant = false;
+        Value constant;
+        bool is_column = false;  // 列引用并且已经解析出下标
+        size_t column_index = 0;
+        std::string column_name;
+    };
+
+    static Node CompileNode(const Expression* expr, const Schema* schema);
+    static Node CompileBinary(const BinaryOpExpression* expr,
+                              const Schema* schema);
+
+    /** 子节点都是常量时在编译时求值，出错的保留到运行时再报告 */
+    static Node FoldIfConstant(Node node, bool all_children_constant);
+
+    static Node MakeConstant(const Value& value);
+
+    /** 求值时总是抛出同一个异常的节点 */
+    static Function Throwing(const std::string& message);
+
+    Function function_;
+    bool is_constant_ = false;
+    Value constant_;
+    bool is_column_ = false;
+    size_t column_index_ = 0;
+};
+
+}  // namespace SimpleRDBMS
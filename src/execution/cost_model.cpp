@@ -0,0 +1,181 @@
+/*
+ * 文件: cost_model.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 代价模型的实现
+ */
+
+#include "execution/cost_model.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/config.h"
+
+namespace SimpleRDBMS {
+
+/** 列没有统计信息时等值条件的选择率 */
+static constexpr double DEFAULT_EQUAL_SELECTIVITY = 0.005;
+
+/** 列没有统计信息时范围条件的选择率 */
+static constexpr double DEFAULT_RANGE_SELECTIVITY = 1.0 / 3.0;
+
+/** 无法分析的条件的选择率 */
+static constexpr double DEFAULT_SELECTIVITY = 0.5;
+
+static double Clamp(double selectivity) {
+    return std::min(1.0, std::max(0.0, selectivity));
+}
+
+double CostModel::EstimateSelectivity(const TableStatistics& stats,
+                                      const Schema* schema, Expression* expr) {
+    if (expr == nullptr) {
+        return 1.0;
+    }
+    if (auto* unary_expr = dynamic_cast<UnaryOpExpression*>(expr)) {
+        if (unary_expr->GetOperator() == UnaryOpExpression::OpType::NOT) {
+            return Clamp(1.0 - EstimateSelectivity(stats, schema,
+                                                   unary_expr->GetOperand()));
+        }
+        return DEFAULT_SELECTIVITY;
+    }
+    auto* binary_expr = dynamic_cast<BinaryOpExpression*>(expr);
+    if (binary_expr == nullptr) {
+        return DEFAULT_SELECTIVITY;
+    }
+
+    using OpType = BinaryOpExpression::OpType;
+    switch (binary_expr->GetOperator()) {
+        case OpType::AND:
+            return EstimateSelectivity(stats, schema, binary_expr->GetLeft()) *
+                   EstimateSelectivity(stats, schema, binary_expr->GetRight());
+        case OpType::OR: {
+            double left =
+                EstimateSelectivity(stats, schema, binary_expr->GetLeft());
+            double right =
+                EstimateSelectivity(stats, schema, binary_expr->GetRight());
+            return Clamp(left + right - left * right);
+        }
+        case OpType::EQUALS:
+        case OpType::NOT_EQUALS:
+        case OpType::LESS_THAN:
+        case OpType::LESS_EQUALS:
+        case OpType::GREATER_THAN:
+        case OpType::GREATER_EQUALS: {
+            double selectivity =
+                EstimateComparison(stats, schema, binary_expr);
+            if (selectivity >= 0) {
+                return selectivity;
+            }
+            if (binary_expr->GetOperator() == OpType::EQUALS) {
+                return DEFAULT_EQUAL_SELECTIVITY;
+            }
+            if (binary_expr->GetOperator() == OpType::NOT_EQUALS) {
+                return 1.0 - DEFAULT_EQUAL_SELECTIVITY;
+            }
+            return DEFAULT_RANGE_SELECTIVITY;
+        }
+        default:
+            return DEFAULT_SELECTIVITY;
+    }
+}
+
+/**
+ * 估计列和常量比较的选择率
+ * 实现思路：
+ * 1. 找到 列 op 常量 或 常量 op 列，后者把比较方向反过来
+ * 2. 等值用高频值和不同值个数，不等是1减去NULL和等值的比例，
+ *    范围比较用高频值和直方图
+ */
+double CostModel::EstimateComparison(const TableStatistics& stats,
+                                     const Schema* schema,
+                                     BinaryOpExpression* expr) {
+    using OpType = BinaryOpExpression::OpType;
+    OpType op = expr->GetOperator();
+    auto* col_ref = dynamic_cast<ColumnRefExpression*>(expr->GetLeft());
+    auto* const_expr = dynamic_cast<ConstantExpression*>(expr->GetRight());
+    if (col_ref == nullptr || const_expr == nullptr) {
+        col_ref = dynamic_cast<ColumnRefExpression*>(expr->GetRight());
+        const_expr = dynamic_cast<ConstantExpression*>(expr->GetLeft());
+        switch (op) {
+            case OpType::LESS_THAN:
+                op = OpType::GREATER_THAN;
+                break;
+            case OpType::LESS_EQUALS:
+                op = OpType::GREATER_EQUALS;
+                break;
+            case OpType::GREATER_THAN:
+                op = OpType::LESS_THAN;
+                break;
+            case OpType::GREATER_EQUALS:
+                op = OpType::LESS_EQUALS;
+                break;
+            default:
+                break;
+        }
+    }
+    if (col_ref == nullptr || const_expr == nullptr ||
+        !schema->HasColumn(col_ref->GetColumnName())) {
+        return -1;
+    }
+    size_t column = schema->GetColumnIdx(col_ref->GetColumnName());
+    if (column >= stats.columns.size()) {
+        return -1;
+    }
+
+    const ColumnStatistics& column_stats = stats.columns[column];
+    const Value& value = const_expr->GetValue();
+    switch (op) {
+        case OpType::EQUALS:
+            return Clamp(column_stats.EstimateEqualSelectivity(value));
+        case OpType::NOT_EQUALS:
+            return Clamp(1.0 - column_stats.null_fraction -
+                         column_stats.EstimateEqualSelectivity(value));
+        case OpType::LESS_THAN:
+        case OpType::LESS_EQUALS:
+            return Clamp(column_stats.EstimateRangeSelectivity(
+                nullptr, false, &value, op == OpType::LESS_EQUALS));
+        default:
+            return Clamp(column_stats.EstimateRangeSelectivity(
+                &value, op == OpType::GREATER_EQUALS, nullptr, false));
+    }
+}
+
+double CostModel::EstimateRows(const TableStatistics& stats,
+                               const Schema* schema, Expression* expr) {
+    return static_cast<double>(stats.row_count) *
+           EstimateSelectivity(stats, schema, expr);
+}
+
+double CostModel::SeqScanCost(const TableStatistics& stats) {
+    return static_cast<double>(stats.page_count) * SEQ_PAGE_COST +
+           static_cast<double>(stats.row_count) * CPU_TUPLE_COST;
+}
+
+double CostModel::IndexScanCost(const TableStatistics& stats,
+                                double matched_rows, bool index_only) {
+    double cost = RANDOM_PAGE_COST + matched_rows * CPU_INDEX_TUPLE_COST;
+    if (!index_only) {
+        double heap_pages = std::min(
+            matched_rows, static_cast<double>(stats.page_count));
+        cost += heap_pages * RANDOM_PAGE_COST + matched_rows * CPU_TUPLE_COST;
+    }
+    return cost;
+}
+
+double CostModel::BitmapScanCost(const TableStatistics& stats,
+                                 double index_entries, size_t index_lookups,
+                                 double matched_rows) {
+    double cost = static_cast<double>(index_lookups) * RANDOM_PAGE_COST +
+                  index_entries * CPU_INDEX_TUPLE_COST;
+    double page_count = static_cast<double>(stats.page_count);
+    if (page_count <= 0) {
+        return cost;
+    }
+    double heap_pages = std::min(matched_rows, page_count);
+    double page_cost = RANDOM_PAGE_COST - (RANDOM_PAGE_COST - SEQ_PAGE_COST) *
+                                              std::sqrt(heap_pages / page_count);
+    return cost + heap_pages * page_cost + matched_rows * CPU_TUPLE_COST;
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,82 @@
+/*
+ * 文件: cost_model.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 基于统计信息的代价模型：估计WHERE条件的选择率，
+ *       比较顺序扫描和索引扫描的代价
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "catalog/schema.h"
+#include "catalog/table_statistics.h"
+#include "parser/ast.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * CostModel - 访问路径的代价估计
+ *
+ * 设计思路：
+ * - 代价的单位是顺序读一个页面（SEQ_PAGE_COST），随机读一个页面、
+ *   处理一行、处理一个索引条目各有一个相对的权重，见config.h
+ * - 顺序扫描：读所有页面，每行求值一次条件
+ * - 索引扫描：一次从根到叶子的随机读，每个命中的条目处理一次；
+ *   不是只读索引时还要回表，命中的行分布在不同页面上，
+ *   回表读的页面数按 min(命中行数, 表的页面数) 的随机读计算
+ * - 位图扫描：几次索引查找的条目合并后按页面顺序回表，每个页面只读一次
+ * - 选择率：AND相乘、OR按 s1 + s2 - s1*s2、NOT取 1 - s，
+ *   列和常量的比较用列统计，其他条件用默认值
+ */
+class CostModel {
+   public:
+    /**
+     * 估计条件在表上的选择率
+     * @param stats 表的统计信息
+     * @param schema 表的schema
+     * @param expr 条件表达式，nullptr表示没有条件
+     * @return 0到1之间的比例
+     */
+    static double EstimateSelectivity(const TableStatistics& stats,
+                                      const Schema* schema, Expression* expr);
+
+    /** 估计满足条件的行数 */
+    static double EstimateRows(const TableStatistics& stats,
+                               const Schema* schema, Expression* expr);
+
+    /** 顺序扫描整张表的代价 */
+    static double SeqScanCost(const TableStatistics& stats);
+
+    /**
+     * 索引扫描的代价
+     * @param stats 表的统计信息
+     * @param matched_rows 索引条件命中的行数
+     * @param index_only 是否只读索引不回表
+     */
+    static double IndexScanCost(const TableStatistics& stats,
+                                double matched_rows, bool index_only);
+
+    /**
+     * 位图扫描的代价
+     * 每次索引查找一次随机读，每个取出的条目处理一次；回表按页面号的
+     * 顺序进行，读的页面越多越接近顺序读，页面代价在随机读和顺序读之间
+     * 按读到的页面比例的平方根插值
+     * @param stats 表的统计信息
+     * @param index_entries 所有索引查找取出的条目数
+     * @param index_lookups 索引查找的次数
+     * @param matched_rows 交集/并集之后要回表的行数
+     */
+    static double BitmapScanCost(const TableStatistics& stats,
+                                 double index_entries, size_t index_lookups,
+                                 double matched_rows);
+
+   private:
+    /** 列 op 常量 的选择率，列没有统计信息时返回-1 */
+    static double EstimateComparison(const TableStatistics& stats,
+                                     const Schema* schema,
+                                     BinaryOpExpression* expr);
+};
+
+}  // namespace SimpleRDBMS
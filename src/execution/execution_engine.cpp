@@ -8,18 +8,104 @@
 
 #include "execution/execution_engine.h"
 
+#include "catalog/partition.h"
 #include "catalog/table_manager.h"
+#include "catalog/table_statistics.h"
+#include "common/arena.h"
 #include "common/exception.h"
+#include "common/memory_tracker.h"
+#include "execution/aggregation_hash_table.h"
+#include "execution/cancellation_token.h"
+#include "execution/cost_model.h"
 #include "execution/executor.h"
 #include "execution/expression_cloner.h"
+#include "execution/expression_evaluator.h"
+#include "execution/profiling_executor.h"
+#include "execution/result_cache.h"
+#include "execution/table_copy.h"
 #include "parser/ast.h"
 #include "recovery/log_manager.h"
 #include "stat/stat.h"
+#include "stat/trace.h"
 
+#include <algorithm>
 #include <chrono>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 
 namespace SimpleRDBMS {
 
+namespace {
+thread_local PlanCapture* current_plan_capture = nullptr;
+}  // namespace
+
+PlanCapture::PlanCapture(bool capture_always, double min_elapsed_ms)
+    : capture_always_(capture_always),
+      min_elapsed_ms_(min_elapsed_ms),
+      start_(std::chrono::steady_clock::now()),
+      previous_(current_plan_capture) {
+    current_plan_capture = this;
+}
+
+PlanCapture::~PlanCapture() { current_plan_capture = previous_; }
+
+PlanCapture* PlanCapture::Current() { return current_plan_capture; }
+
+/**
+ * 语句是否会修改表、索引或者catalog
+ * EXPLAIN ANALYZE会真正执行被解释的语句，按被解释的语句判断
+ */
+static bool IsWriteStatement(const Statement* statement) {
+    switch (statement->GetType()) {
+        case Statement::StmtType::INSERT:
+        case Statement::StmtType::UPDATE:
+        case Statement::StmtType::DELETE:
+        case Statement::StmtType::CREATE_TABLE:
+        case Statement::StmtType::DROP_TABLE:
+        case Statement::StmtType::CREATE_INDEX:
+        case Statement::StmtType::DROP_INDEX:
+        case Statement::StmtType::VACUUM:
+            return true;
+        case Statement::StmtType::COPY:
+            return static_cast<const CopyStatement*>(statement)->IsFrom();
+        case Statement::StmtType::EXPLAIN: {
+            const auto* explain = static_cast<const ExplainStatement*>(statement);
+            return explain->IsAnalyze() &&
+                   IsWriteStatement(explain->GetStatement());
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * 只读映射模式下拒绝写语句，这时缓冲池里的页面直接指向只读的文件映射；
+ * WAL复制的副本同样拒绝写语句，它的数据只跟着主库的日志变化
+ */
+static void CheckDatabaseWritable(const BufferPoolManager* buffer_pool_manager,
+                                  bool replica, const Statement* statement) {
+    if (!IsWriteStatement(statement)) {
+        return;
+    }
+    if (buffer_pool_manager->IsReadOnly()) {
+        throw ExecutionException(
+            "Cannot modify a database that is opened read-only");
+    }
+    if (replica) {
+        throw ExecutionException("Cannot modify a read-only replica");
+    }
+}
+
+bool PlanCapture::ShouldCapturePlan() const {
+    if (capture_always_) {
+        return true;
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start_;
+    return elapsed.count() >= min_elapsed_ms_;
+}
+
 /**
  * 构造函数：初始化执行引擎的各个组件
  * @param buffer_pool_manager 缓冲池管理器，用于页面缓存
@@ -52,7 +138,7 @@ ExecutionEngine::ExecutionEngine(BufferPoolManager* buffer_pool_manager,
  */
 bool ExecutionEngine::Execute(Statement* statement,
                               std::vector<Tuple>* result_set,
-                              Transaction* txn) {
+                              Transaction* txn, ResultSink* sink) {
     LOG_DEBUG("ExecutionEngine::Execute: Starting execution");
 
     // 参数有效性检查，确保传入的参数都不为空
@@ -69,7 +155,11 @@ bool ExecutionEngine::Execute(Statement* statement,
         }
         return false;
     }
+    CheckDatabaseWritable(buffer_pool_manager_, replica_, statement);
 
+    // 计划节点、执行器和表达式求值器从查询的内存池分配，返回时一起释放；
+    // 调用方已经开了作用域时沿用调用方的
+    QueryArena::Scope arena_scope;
     std::string query_type;
     auto start_time = std::chrono::high_resolution_clock::now();
 
@@ -113,7 +203,10 @@ bool ExecutionEngine::Execute(Statement* statement,
             bool success = table_manager_->CreateIndex(
                 create_idx_stmt->GetIndexName(),
                 create_idx_stmt->GetTableName(),
-                create_idx_stmt->GetKeyColumns());
+                create_idx_stmt->GetKeyColumns(),
+                create_idx_stmt->IsUnique(),
+                create_idx_stmt->GetIndexType(),
+                create_idx_stmt->GetIncludeColumns());
             
             auto end_time = std::chrono::high_resolution_clock::now();
             auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
@@ -173,11 +266,79 @@ bool ExecutionEngine::Execute(Statement* statement,
             
             return success;
         }
+        case Statement::StmtType::ANALYZE: {
+            query_type = "ANALYZE";
+            auto* analyze_stmt = static_cast<AnalyzeStatement*>(statement);
+            bool success = HandleAnalyze(analyze_stmt);
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+            STATS.RecordQueryExecution(query_type, duration.count() / 1000.0);
+            
+            return success;
+        }
+        case Statement::StmtType::VACUUM: {
+            query_type = "VACUUM";
+            auto* vacuum_stmt = static_cast<VacuumStatement*>(statement);
+            bool success = HandleVacuum(vacuum_stmt, txn);
+
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+            STATS.RecordQueryExecution(query_type, duration.count() / 1000.0);
+
+            return success;
+        }
+        case Statement::StmtType::COPY: {
+            query_type = "COPY";
+            auto* copy_stmt = static_cast<CopyStatement*>(statement);
+            bool success = HandleCopy(copy_stmt, result_set, txn);
+
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+            STATS.RecordQueryExecution(query_type, duration.count() / 1000.0);
+
+            return success;
+        }
+        case Statement::StmtType::PREPARE: {
+            query_type = "PREPARE";
+            auto* prepare_stmt = static_cast<PrepareStatement*>(statement);
+            bool success = HandlePrepare(prepare_stmt);
+
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+            STATS.RecordQueryExecution(query_type, duration.count() / 1000.0);
+
+            return success;
+        }
+        case Statement::StmtType::EXECUTE: {
+            auto* execute_stmt = static_cast<ExecuteStatement*>(statement);
+            auto prepared = GetPreparedStatement(execute_stmt->GetName());
+            if (!prepared) {
+                LOG_ERROR("ExecutionEngine::Execute: Prepared statement '"
+                          << execute_stmt->GetName() << "' does not exist");
+                return false;
+            }
+            return ExecutePrepared(prepared.get(),
+                                   execute_stmt->GetArguments(), result_set,
+                                   txn, sink);
+        }
+        case Statement::StmtType::DEALLOCATE: {
+            query_type = "DEALLOCATE";
+            auto* deallocate_stmt =
+                static_cast<DeallocateStatement*>(statement);
+            bool success = HandleDeallocate(deallocate_stmt);
+
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+            STATS.RecordQueryExecution(query_type, duration.count() / 1000.0);
+
+            return success;
+        }
         case Statement::StmtType::EXPLAIN: {
             LOG_DEBUG("ExecutionEngine::Execute: Handling EXPLAIN");
             query_type = "EXPLAIN";
             auto* explain_stmt = static_cast<ExplainStatement*>(statement);
-            bool success = HandleExplain(explain_stmt, result_set);
+            bool success = HandleExplain(explain_stmt, result_set, txn);
             
             auto end_time = std::chrono::high_resolution_clock::now();
             auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
@@ -217,10 +378,40 @@ bool ExecutionEngine::Execute(Statement* statement,
         return false;
     }
 
+    int tuple_count = 0;
+    if (!RunPlan(std::move(plan), result_set, txn, &tuple_count, sink)) {
+        return false;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+    STATS.RecordQueryExecution(query_type, duration.count() / 1000.0, tuple_count);
+
+    LOG_DEBUG("ExecutionEngine::Execute: Execution completed, processed "
+              << tuple_count << " tuples");
+    return true;
+}
+
+/**
+ * 为计划创建执行器并取出所有结果
+ * 根执行器有批量实现时按批取，否则逐行调用Next；
+ * 有sink时result_set攒够RESULT_STREAM_CHUNK_ROWS行就交给sink并清空
+ */
+bool ExecutionEngine::RunPlan(std::unique_ptr<PlanNode> plan,
+                              std::vector<Tuple>* result_set,
+                              Transaction* txn, int* tuple_count_out,
+                              ResultSink* sink) {
     // 创建执行器上下文，包含事务、catalog等信息
     LOG_DEBUG("ExecutionEngine::Execute: Creating executor context");
     ExecutorContext exec_ctx(txn, catalog_, buffer_pool_manager_,
                              table_manager_.get());
+    if (txn_manager_ != nullptr) {
+        exec_ctx.SetLockManager(txn_manager_->GetLockManager());
+    }
+    CancellationToken* cancellation_token = CancellationToken::Current();
+    exec_ctx.SetCancellationToken(cancellation_token);
+    MemoryTracker* memory_tracker = MemoryTracker::Current();
+    exec_ctx.SetMemoryTracker(memory_tracker);
 
     // 根据执行计划创建对应的executor
     LOG_DEBUG("ExecutionEngine::Execute: Creating executor");
@@ -240,38 +431,130 @@ bool ExecutionEngine::Execute(Statement* statement,
     RID rid;
     int tuple_count = 0;
 
+    // 不管从哪里返回，执行器析构之前都把计划和行数交给PlanCapture
+    struct CaptureGuard {
+        ExecutionEngine* engine;
+        const Executor* executor;
+        const int* tuple_count;
+        ~CaptureGuard() { engine->CapturePlan(executor, *tuple_count); }
+    } capture_guard{this, executor.get(), &tuple_count};
+
     // 防护措施：最多处理百万条记录，避免无限循环导致系统卡死
     const int MAX_TUPLES = 1000000;
 
     // 超时保护：设置10秒超时，防止长时间执行
 
-    while (tuple_count < MAX_TUPLES) {
-
-        bool has_next = false;
-        try {
-            // 调用executor的Next方法获取下一个tuple
-            has_next = executor->Next(&tuple, &rid);
-        } catch (const std::exception& e) {
-            LOG_ERROR(
-                "ExecutionEngine::Execute: Exception during tuple execution: "
-                << e.what());
+    // 把攒下的一块交给sink，sink要求停止时返回false；
+    // 没有sink时结果集一直留在内存里，每攒一块记到查询的记账器上，
+    // 一直记到查询结束，超过上限时返回false
+    size_t charged_rows = result_set->size();
+    auto flush_chunk = [&](size_t min_rows) {
+        if (sink == nullptr) {
+            if (memory_tracker == nullptr ||
+                result_set->size() - charged_rows < min_rows) {
+                return true;
+            }
+            size_t bytes = 0;
+            for (size_t i = charged_rows; i < result_set->size(); i++) {
+                bytes += ResultCache::EstimateRowBytes((*result_set)[i]);
+            }
+            charged_rows = result_set->size();
+            try {
+                memory_tracker->Consume(bytes);
+            } catch (const MemoryLimitExceededException& e) {
+                LOG_ERROR("ExecutionEngine::Execute: Result set too large: "
+                          << e.what());
+                return false;
+            }
+            return true;
+        }
+        if (result_set->empty() ||
+            result_set->size() < min_rows) {
+            return true;
+        }
+        if (!sink->Consume(result_set)) {
+            LOG_DEBUG("ExecutionEngine::Execute: Result sink stopped the "
+                      "query after " << tuple_count << " tuples");
             return false;
         }
-
-        // 如果没有更多tuple，执行完成
-        if (!has_next) {
-            break;
+        result_set->clear();
+        return true;
+    };
+
+    // 根执行器有批量实现时按批取结果，每批只有一次虚函数调用，
+    // 表达式也是整批求值；批次里的行在这里还原成结果集的tuple
+    if (executor->IsVectorized()) {
+        VectorBatch batch;
+        const Schema* output_schema = executor->GetOutputSchema();
+        while (tuple_count < MAX_TUPLES) {
+            bool has_next = false;
+            try {
+                TRACE_SPAN_NAMED(batch_span, "executor", "Executor::NextBatch");
+                exec_ctx.CheckCancellation();
+                has_next = executor->NextBatch(&batch);
+                TRACE_SPAN_SET_ARG(batch_span,
+                                   has_next ? batch.GetSelectedCount() : 0);
+                if (has_next) {
+                    for (uint32_t row : batch.GetSelection()) {
+                        result_set->push_back(
+                            batch.GetTuple(row, output_schema));
+                        if (!flush_chunk(RESULT_STREAM_CHUNK_ROWS)) {
+                            return false;
+                        }
+                    }
+                }
+            } catch (const std::exception& e) {
+                LOG_ERROR(
+                    "ExecutionEngine::Execute: Exception during batch "
+                    "execution: "
+                    << e.what());
+                return false;
+            }
+            if (!has_next) {
+                break;
+            }
+            tuple_count += static_cast<int>(batch.GetSelectedCount());
         }
+    }
 
-        // 将tuple添加到结果集
-        result_set->push_back(tuple);
-        tuple_count++;
+    if (!executor->IsVectorized()) {
+        // 逐行执行时每行一个区间太密，整个取结果的循环算一个区间
+        TRACE_SPAN_NAMED(next_span, "executor", "Executor::Next");
+        while (tuple_count < MAX_TUPLES) {
+
+            bool has_next = false;
+            try {
+                // 调用executor的Next方法获取下一个tuple
+                exec_ctx.CheckCancellation();
+                has_next = executor->Next(&tuple, &rid);
+            } catch (const std::exception& e) {
+                LOG_ERROR(
+                    "ExecutionEngine::Execute: Exception during tuple "
+                    "execution: "
+                    << e.what());
+                return false;
+            }
+
+            // 如果没有更多tuple，执行完成
+            if (!has_next) {
+                break;
+            }
+
+            // 将tuple添加到结果集
+            result_set->push_back(tuple);
+            tuple_count++;
+            if (!flush_chunk(RESULT_STREAM_CHUNK_ROWS)) {
+                return false;
+            }
 
-        // 每处理100个tuple打印一次日志，便于监控执行进度
-        if (tuple_count % 100 == 0) {
-            LOG_DEBUG("ExecutionEngine::Execute: Processed " << tuple_count
-                                                             << " tuples");
+            // 每处理100个tuple打印一次日志，便于监控执行进度
+            if (tuple_count % 100 == 0) {
+                LOG_DEBUG("ExecutionEngine::Execute: Processed " << tuple_count
+                                                                 << " tuples");
+            }
         }
+
+        TRACE_SPAN_SET_ARG(next_span, static_cast<uint64_t>(tuple_count));
     }
 
     // 检查是否达到最大tuple限制
@@ -280,18 +563,26 @@ bool ExecutionEngine::Execute(Statement* statement,
                   << MAX_TUPLES << "), possible infinite loop detected");
         return false;
     }
+    // 有的执行器把子执行器的异常当成数据结束，取消以后结果可能不完整，
+    // 不能当成成功返回
+    if (cancellation_token != nullptr && cancellation_token->IsCancelled()) {
+        LOG_DEBUG("ExecutionEngine::Execute: Query cancelled: "
+                  << CancellationToken::DescribeReason(
+                         cancellation_token->GetReason()));
+        return false;
+    }
+    if (!flush_chunk(1)) {
+        return false;
+    }
 
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    STATS.RecordQueryExecution(query_type, duration.count() / 1000.0, tuple_count);
-
-    LOG_DEBUG("ExecutionEngine::Execute: Execution completed, processed "
-              << tuple_count << " tuples");
+    *tuple_count_out = tuple_count;
     return true;
 }
 
 /**
  * 执行计划生成器：根据SQL语句类型创建相应的执行计划
+ * 生成之后把计划里的表和索引绑定上去，版本在生成之前读取，
+ * 生成期间发生的DDL会让执行器忽略这次绑定
  * @param statement SQL语句
  * @return 执行计划节点
  */
@@ -300,19 +591,86 @@ std::unique_ptr<PlanNode> ExecutionEngine::CreatePlan(Statement* statement) {
         return nullptr;
     }
 
+    uint64_t schema_version = catalog_->GetSchemaVersion();
+    std::unique_ptr<PlanNode> plan;
     // 根据SQL语句类型创建对应的执行计划
     switch (statement->GetType()) {
         case Statement::StmtType::SELECT:
-            return CreateSelectPlan(static_cast<SelectStatement*>(statement));
+            plan = CreateSelectPlan(static_cast<SelectStatement*>(statement));
+            break;
         case Statement::StmtType::INSERT:
-            return CreateInsertPlan(static_cast<InsertStatement*>(statement));
+            plan = CreateInsertPlan(static_cast<InsertStatement*>(statement));
+            break;
         case Statement::StmtType::UPDATE:
-            return CreateUpdatePlan(static_cast<UpdateStatement*>(statement));
+            plan = CreateUpdatePlan(static_cast<UpdateStatement*>(statement));
+            break;
         case Statement::StmtType::DELETE:
-            return CreateDeletePlan(static_cast<DeleteStatement*>(statement));
+            plan = CreateDeletePlan(static_cast<DeleteStatement*>(statement));
+            break;
         default:
             return nullptr;
     }
+    if (plan) {
+        BindPlan(plan.get(), schema_version);
+    }
+    return plan;
+}
+
+/**
+ * 绑定计划树里每个节点访问的表和索引
+ * 缓存的计划每次执行只复制绑定，执行器初始化时不再按名字查catalog
+ */
+void ExecutionEngine::BindPlan(PlanNode* plan, uint64_t schema_version) {
+    const std::string* table_name = nullptr;
+    const std::string* index_name = nullptr;
+    switch (plan->GetType()) {
+        case PlanNodeType::SEQUENTIAL_SCAN:
+            table_name = &static_cast<SeqScanPlanNode*>(plan)->GetTableName();
+            break;
+        case PlanNodeType::INDEX_SCAN: {
+            auto* index_scan = static_cast<IndexScanPlanNode*>(plan);
+            table_name = &index_scan->GetTableName();
+            index_name = &index_scan->GetIndexName();
+            break;
+        }
+        case PlanNodeType::INDEX_RANGE_SCAN: {
+            auto* range_scan = static_cast<IndexRangeScanPlanNode*>(plan);
+            table_name = &range_scan->GetTableName();
+            index_name = &range_scan->GetIndexName();
+            break;
+        }
+        case PlanNodeType::BITMAP_HEAP_SCAN:
+            // 用到几个索引，执行器按名字查找，这里只绑定表
+            table_name =
+                &static_cast<BitmapHeapScanPlanNode*>(plan)->GetTableName();
+            break;
+        case PlanNodeType::INDEX_NESTED_LOOP_JOIN: {
+            auto* join = static_cast<IndexNestedLoopJoinPlanNode*>(plan);
+            table_name = &join->GetInnerTableName();
+            index_name = &join->GetIndexName();
+            break;
+        }
+        case PlanNodeType::INSERT:
+            table_name = &static_cast<InsertPlanNode*>(plan)->GetTableName();
+            break;
+        case PlanNodeType::UPDATE:
+            table_name = &static_cast<UpdatePlanNode*>(plan)->GetTableName();
+            break;
+        case PlanNodeType::DELETE:
+            table_name = &static_cast<DeletePlanNode*>(plan)->GetTableName();
+            break;
+        default:
+            break;
+    }
+    if (table_name != nullptr) {
+        plan->BindCatalogObjects(
+            catalog_->GetTable(*table_name),
+            index_name != nullptr ? catalog_->GetIndex(*index_name) : nullptr,
+            schema_version);
+    }
+    for (const auto& child : plan->GetChildren()) {
+        BindPlan(child.get(), schema_version);
+    }
 }
 
 /**
@@ -347,6 +705,41 @@ std::unique_ptr<PlanNode> ExecutionEngine::CreateUpdatePlan(
         updates.emplace_back(clause.column_name, std::move(cloned_expr));
     }
 
+    // 分区表在每个没有被裁剪掉的分区上各更新一次，影响的行数相加；
+    // 行不会在分区之间移动，所以不能修改分区列
+    if (table_info->partition_scheme) {
+        const PartitionScheme& scheme = *table_info->partition_scheme;
+        for (const auto& [column_name, expr] : updates) {
+            if (column_name == scheme.column_name) {
+                throw ExecutionException(
+                    "Cannot update partition column " + column_name +
+                    " of table " + table_info->table_name);
+            }
+        }
+        std::vector<TableInfo*> partitions =
+            catalog_->GetPartitions(table_info);
+        if (partitions.empty()) {
+            return nullptr;
+        }
+        std::vector<std::unique_ptr<PlanNode>> children;
+        for (size_t partition :
+             SelectPartitions(table_info, stmt->GetWhereClause())) {
+            std::vector<std::pair<std::string, std::unique_ptr<Expression>>>
+                partition_updates;
+            for (const auto& [column_name, expr] : updates) {
+                partition_updates.emplace_back(
+                    column_name, ExpressionCloner::Clone(expr.get()));
+            }
+            children.push_back(std::make_unique<UpdatePlanNode>(
+                std::make_unique<Schema>(*result_schema),
+                partitions[partition]->table_name,
+                std::move(partition_updates),
+                ExpressionCloner::Clone(stmt->GetWhereClause())));
+        }
+        return CreateCountingAppendPlan(std::move(result_schema),
+                                        std::move(children));
+    }
+
     // 克隆WHERE子句表达式
     auto where_copy = ExpressionCloner::Clone(stmt->GetWhereClause());
     return std::make_unique<UpdatePlanNode>(
@@ -376,12 +769,44 @@ std::unique_ptr<PlanNode> ExecutionEngine::CreateDeletePlan(
         {"affected_rows", TypeId::INTEGER, 0, false, false}};
     auto result_schema = std::make_unique<Schema>(result_columns);
 
+    // 分区表在每个没有被裁剪掉的分区上各删除一次，影响的行数相加
+    if (table_info->partition_scheme) {
+        std::vector<TableInfo*> partitions =
+            catalog_->GetPartitions(table_info);
+        if (partitions.empty()) {
+            return nullptr;
+        }
+        std::vector<std::unique_ptr<PlanNode>> children;
+        for (size_t partition :
+             SelectPartitions(table_info, stmt->GetWhereClause())) {
+            children.push_back(std::make_unique<DeletePlanNode>(
+                std::make_unique<Schema>(*result_schema),
+                partitions[partition]->table_name,
+                ExpressionCloner::Clone(stmt->GetWhereClause())));
+        }
+        return CreateCountingAppendPlan(std::move(result_schema),
+                                        std::move(children));
+    }
+
     // 克隆WHERE子句表达式
     auto where_copy = ExpressionCloner::Clone(stmt->GetWhereClause());
     return std::make_unique<DeletePlanNode>(
         std::move(result_schema), stmt->GetTableName(), std::move(where_copy));
 }
 
+/**
+ * 把各个分区上的修改计划拼成输出影响行数之和的追加计划
+ * 所有分区都被裁剪掉时没有子计划，追加计划直接输出0
+ */
+std::unique_ptr<PlanNode> ExecutionEngine::CreateCountingAppendPlan(
+    std::unique_ptr<Schema> result_schema,
+    std::vector<std::unique_ptr<PlanNode>> children) {
+    auto append = std::make_unique<AppendPlanNode>(
+        nullptr, std::move(children), 1, true);
+    append->SetOwnedSchema(std::move(result_schema));
+    return append;
+}
+
 /**
  * 执行器工厂方法：根据执行计划类型创建相应的执行器
  * @param exec_ctx 执行器上下文
@@ -407,12 +832,65 @@ std::unique_ptr<Executor> ExecutionEngine::CreateExecutor(
             return std::make_unique<IndexScanExecutor>(
                 exec_ctx, std::unique_ptr<IndexScanPlanNode>(index_scan_plan));
         }
+        case PlanNodeType::INDEX_RANGE_SCAN: {
+            auto range_scan_plan =
+                static_cast<IndexRangeScanPlanNode*>(plan.release());
+            return std::make_unique<IndexRangeScanExecutor>(
+                exec_ctx,
+                std::unique_ptr<IndexRangeScanPlanNode>(range_scan_plan));
+        }
+        case PlanNodeType::BITMAP_HEAP_SCAN: {
+            auto bitmap_plan =
+                static_cast<BitmapHeapScanPlanNode*>(plan.release());
+            return std::make_unique<BitmapHeapScanExecutor>(
+                exec_ctx,
+                std::unique_ptr<BitmapHeapScanPlanNode>(bitmap_plan));
+        }
+        case PlanNodeType::HASH_JOIN: {
+            auto join_plan = static_cast<HashJoinPlanNode*>(plan.release());
+            return std::make_unique<HashJoinExecutor>(
+                exec_ctx, std::unique_ptr<HashJoinPlanNode>(join_plan));
+        }
+        case PlanNodeType::INDEX_NESTED_LOOP_JOIN: {
+            auto join_plan =
+                static_cast<IndexNestedLoopJoinPlanNode*>(plan.release());
+            return std::make_unique<IndexNestedLoopJoinExecutor>(
+                exec_ctx,
+                std::unique_ptr<IndexNestedLoopJoinPlanNode>(join_plan));
+        }
+        case PlanNodeType::AGGREGATION: {
+            auto aggregation_plan =
+                static_cast<AggregationPlanNode*>(plan.release());
+            return std::make_unique<HashAggregationExecutor>(
+                exec_ctx,
+                std::unique_ptr<AggregationPlanNode>(aggregation_plan));
+        }
+        case PlanNodeType::SORT: {
+            auto sort_plan = static_cast<SortPlanNode*>(plan.release());
+            return std::make_unique<SortExecutor>(
+                exec_ctx, std::unique_ptr<SortPlanNode>(sort_plan));
+        }
+        case PlanNodeType::LIMIT: {
+            auto limit_plan = static_cast<LimitPlanNode*>(plan.release());
+            return std::make_unique<LimitExecutor>(
+                exec_ctx, std::unique_ptr<LimitPlanNode>(limit_plan));
+        }
         case PlanNodeType::PROJECTION: {
             auto projection_plan =
                 static_cast<ProjectionPlanNode*>(plan.release());
             return std::make_unique<ProjectionExecutor>(
                 exec_ctx, std::unique_ptr<ProjectionPlanNode>(projection_plan));
         }
+        case PlanNodeType::GATHER: {
+            auto gather_plan = static_cast<GatherPlanNode*>(plan.release());
+            return std::make_unique<GatherExecutor>(
+                exec_ctx, std::unique_ptr<GatherPlanNode>(gather_plan));
+        }
+        case PlanNodeType::APPEND: {
+            auto append_plan = static_cast<AppendPlanNode*>(plan.release());
+            return std::make_unique<AppendExecutor>(
+                exec_ctx, std::unique_ptr<AppendPlanNode>(append_plan));
+        }
         case PlanNodeType::INSERT: {
             auto insert_plan = static_cast<InsertPlanNode*>(plan.release());
             return std::make_unique<InsertExecutor>(
@@ -433,6 +911,138 @@ std::unique_ptr<Executor> ExecutionEngine::CreateExecutor(
     }
 }
 
+/** 把表达式写成文本，用作聚合结果的列名，也用来比较SELECT项和GROUP BY */
+static std::string ExpressionToString(const Expression* expr) {
+    if (expr == nullptr) {
+        return "";
+    }
+    switch (expr->GetType()) {
+        case Expression::ExprType::CONSTANT: {
+            const auto* constant = static_cast<const ConstantExpression*>(expr);
+            if (constant->IsParameter()) {
+                return "$" + std::to_string(constant->GetParameterIndex() + 1);
+            }
+            const Value& value = constant->GetValue();
+            std::ostringstream oss;
+            std::visit(
+                [&oss](const auto& v) {
+                    using T = std::decay_t<decltype(v)>;
+                    if constexpr (std::is_same_v<T, std::string>) {
+                        oss << "'" << v << "'";
+                    } else if constexpr (std::is_same_v<T, bool>) {
+                        oss << (v ? "true" : "false");
+                    } else if constexpr (std::is_arithmetic_v<T>) {
+                        oss << +v;
+                    }
+                },
+                value);
+            return oss.str();
+        }
+        case Expression::ExprType::COLUMN_REF:
+            return static_cast<const ColumnRefExpression*>(expr)
+                ->GetColumnName();
+        case Expression::ExprType::BINARY_OP: {
+            const auto* binary = static_cast<const BinaryOpExpression*>(expr);
+            static const char* const kOperators[] = {
+                "=", "!=", "<", ">", "<=", ">=", "AND", "OR", "+", "-", "*",
+                "/"};
+            return "(" + ExpressionToString(binary->GetLeft()) + " " +
+                   kOperators[static_cast<int>(binary->GetOperator())] + " " +
+                   ExpressionToString(binary->GetRight()) + ")";
+        }
+        case Expression::ExprType::UNARY_OP: {
+            const auto* unary = static_cast<const UnaryOpExpression*>(expr);
+            return (unary->GetOperator() == UnaryOpExpression::OpType::NOT
+                        ? std::string("NOT ")
+                        : std::string("-")) +
+                   ExpressionToString(unary->GetOperand());
+        }
+        case Expression::ExprType::FUNCTION_CALL: {
+            const auto* call = static_cast<const FunctionCallExpression*>(expr);
+            std::string text = call->GetFunctionName() + "(";
+            if (call->IsStar()) {
+                text += "*";
+            }
+            for (size_t i = 0; i < call->GetArguments().size(); i++) {
+                text += (i > 0 ? ", " : "") +
+                        ExpressionToString(call->GetArguments()[i].get());
+            }
+            return text + ")";
+        }
+        default:
+            return "?";
+    }
+}
+
+/** 表达式里是否有函数调用，目前的函数都是聚合函数 */
+static bool ContainsAggregate(const Expression* expr) {
+    if (expr == nullptr) {
+        return false;
+    }
+    switch (expr->GetType()) {
+        case Expression::ExprType::FUNCTION_CALL:
+            return true;
+        case Expression::ExprType::BINARY_OP: {
+            const auto* binary = static_cast<const BinaryOpExpression*>(expr);
+            return ContainsAggregate(binary->GetLeft()) ||
+                   ContainsAggregate(binary->GetRight());
+        }
+        case Expression::ExprType::UNARY_OP:
+            return ContainsAggregate(
+                static_cast<const UnaryOpExpression*>(expr)->GetOperand());
+        default:
+            return false;
+    }
+}
+
+/** SELECT语句是否需要聚合：有GROUP BY，或者SELECT列表里有聚合函数 */
+static bool HasAggregation(const SelectStatement* stmt) {
+    if (!stmt->GetGroupBy().empty()) {
+        return true;
+    }
+    for (const auto& expr : stmt->GetSelectList()) {
+        if (ContainsAggregate(expr.get())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 在计划上面加ORDER BY和LIMIT
+ * 有排序键时LIMIT交给排序节点做Top-N，只有LIMIT时加限制行数节点
+ * @param keys 排序键，已经解析到plan的输出schema上
+ */
+static std::unique_ptr<PlanNode> AddSortAndLimit(
+    std::unique_ptr<PlanNode> plan, std::vector<SortPlanNode::SortKey> keys,
+    int64_t limit) {
+    if (!keys.empty()) {
+        return std::make_unique<SortPlanNode>(std::move(plan), std::move(keys),
+                                              limit);
+    }
+    if (limit >= 0) {
+        return std::make_unique<LimitPlanNode>(std::move(plan), limit);
+    }
+    return plan;
+}
+
+/**
+ * 把聚合查询的一个ORDER BY项解析到聚合的输出列上
+ * ORDER BY项要和某个SELECT项相同（按文本比较），比如ORDER BY COUNT(*)
+ * @return 引用输出列的表达式，找不到时返回nullptr
+ */
+static std::unique_ptr<Expression> ResolveAggregateOrderBy(
+    const Expression* expr, const Schema* output_schema) {
+    std::string text = ExpressionToString(expr);
+    if (!output_schema->HasColumn(text)) {
+        LOG_ERROR("ORDER BY '" << text
+                               << "' must appear in the SELECT list of an "
+                                  "aggregate query");
+        return nullptr;
+    }
+    return std::make_unique<ColumnRefExpression>("", text);
+}
+
 /**
  * 创建SELECT语句的执行计划，包含扫描方式选择和投影处理
  * @param stmt SELECT语句的AST节点
@@ -444,6 +1054,15 @@ std::unique_ptr<PlanNode> ExecutionEngine::CreateSelectPlan(
         LOG_ERROR("CreateSelectPlan: SelectStatement is null");
         return nullptr;
     }
+    if (ContainsAggregate(stmt->GetWhereClause()) ||
+        ContainsAggregate(stmt->GetJoinCondition())) {
+        LOG_ERROR("CreateSelectPlan: Aggregate functions are not allowed in "
+                  "WHERE or ON");
+        return nullptr;
+    }
+    if (stmt->HasJoin()) {
+        return CreateJoinPlan(stmt);
+    }
 
     LOG_DEBUG("CreateSelectPlan: Creating plan for table "
               << stmt->GetTableName());
@@ -471,31 +1090,113 @@ std::unique_ptr<PlanNode> ExecutionEngine::CreateSelectPlan(
               << stmt->GetTableName() << " with schema containing "
               << table_info->schema->GetColumnCount() << " columns");
 
-    // 查询优化：检查是否可以使用索引扫描
-    std::unique_ptr<PlanNode> scan_plan;
-    if (stmt->GetWhereClause()) {
-        std::string selected_index =
-            SelectBestIndex(stmt->GetTableName(), stmt->GetWhereClause());
-        if (!selected_index.empty()) {
-            LOG_DEBUG("Using index scan with index: " << selected_index);
-            auto where_copy = ExpressionCloner::Clone(stmt->GetWhereClause());
-            scan_plan = std::make_unique<IndexScanPlanNode>(
-                table_info->schema.get(), stmt->GetTableName(), selected_index,
-                std::move(where_copy));
+    bool has_aggregation = HasAggregation(stmt);
+    if (has_aggregation && is_select_all) {
+        LOG_ERROR("CreateSelectPlan: SELECT * cannot be used with GROUP BY "
+                  "or aggregate functions");
+        return nullptr;
+    }
+
+    // 没有聚合时ORDER BY在表的schema上求值，可以用不在SELECT列表里的列
+    std::vector<SortPlanNode::SortKey> sort_keys;
+    if (!has_aggregation) {
+        for (const auto& item : stmt->GetOrderBy()) {
+            if (ContainsAggregate(item.expression.get()) ||
+                ExpressionEvaluator::InferType(item.expression.get(),
+                                               table_info->schema.get()) ==
+                    TypeId::INVALID) {
+                LOG_ERROR("CreateSelectPlan: Cannot resolve ORDER BY "
+                          "expression "
+                          << ExpressionToString(item.expression.get()));
+                return nullptr;
+            }
+            sort_keys.push_back(
+                {ExpressionCloner::Clone(item.expression.get()),
+                 item.ascending});
         }
     }
 
-    // 如果没有合适的索引，使用顺序扫描
+    // 收集查询用到的所有列，全在某个索引里时可以只读索引
+    std::unordered_set<std::string> needed_columns;
+    bool columns_known =
+        CollectReferencedColumns(stmt->GetWhereClause(), &needed_columns);
+    for (const auto& expr : stmt->GetGroupBy()) {
+        columns_known =
+            CollectReferencedColumns(expr.get(), &needed_columns) &&
+            columns_known;
+    }
+    for (const auto& key : sort_keys) {
+        columns_known =
+            CollectReferencedColumns(key.expression.get(), &needed_columns) &&
+            columns_known;
+    }
+    if (is_select_all) {
+        for (const auto& column : table_info->schema->GetColumns()) {
+            needed_columns.insert(column.name);
+        }
+    } else {
+        for (const auto& expr : select_list) {
+            columns_known = CollectReferencedColumns(expr.get(),
+                                                     &needed_columns) &&
+                            columns_known;
+        }
+    }
+
+    // 选择扫描方式，分区表先裁剪分区
+    const std::unordered_set<std::string>* known_columns =
+        columns_known ? &needed_columns : nullptr;
+    std::unique_ptr<PlanNode> scan_plan =
+        table_info->partition_scheme
+            ? CreatePartitionedScanPlan(table_info, stmt->GetWhereClause(),
+                                        known_columns)
+            : CreateScanPlan(table_info, stmt->GetWhereClause(),
+                             known_columns);
     if (!scan_plan) {
-        LOG_DEBUG("Using sequential scan");
-        auto where_copy = ExpressionCloner::Clone(stmt->GetWhereClause());
-        scan_plan = std::make_unique<SeqScanPlanNode>(table_info->schema.get(),
-                                                      stmt->GetTableName(),
-                                                      std::move(where_copy));
+        return nullptr;
+    }
+
+    // 顺序扫描可以并行：没有聚合、排序和LIMIT时整条扫描+投影在工作线程里做，
+    // 否则只并行扫描，上面的算子串行处理汇总后的结果；
+    // 并行扫描按表堆的页面分发，列存表只能串行扫描
+    bool parallel_scan =
+        parallel_scan_workers_ > 1 &&
+        scan_plan->GetType() == PlanNodeType::SEQUENTIAL_SCAN &&
+        table_info->storage == TableStorage::ROW;
+    bool gather_above_projection = parallel_scan && !has_aggregation &&
+                                   sort_keys.empty() && !stmt->HasLimit();
+    if (parallel_scan && !gather_above_projection) {
+        scan_plan = std::make_unique<GatherPlanNode>(std::move(scan_plan),
+                                                     parallel_scan_workers_);
     }
 
+    if (has_aggregation) {
+        auto aggregation_plan = CreateAggregationPlan(
+            std::move(scan_plan), select_list, stmt->GetGroupBy());
+        if (!aggregation_plan) {
+            return nullptr;
+        }
+        for (const auto& item : stmt->GetOrderBy()) {
+            auto key = ResolveAggregateOrderBy(
+                item.expression.get(), aggregation_plan->GetOutputSchema());
+            if (!key) {
+                return nullptr;
+            }
+            sort_keys.push_back({std::move(key), item.ascending});
+        }
+        return AddSortAndLimit(std::move(aggregation_plan),
+                               std::move(sort_keys), stmt->GetLimit());
+    }
+
+    // 排序在投影下面，排序键可以引用没有投影出来的列
+    scan_plan = AddSortAndLimit(std::move(scan_plan), std::move(sort_keys),
+                                stmt->GetLimit());
+
     // 如果是SELECT *，直接返回扫描计划
     if (is_select_all) {
+        if (gather_above_projection) {
+            return std::make_unique<GatherPlanNode>(std::move(scan_plan),
+                                                    parallel_scan_workers_);
+        }
         return std::move(scan_plan);
     } else {
         // 需要投影操作，选择特定的列
@@ -529,118 +1230,1786 @@ std::unique_ptr<PlanNode> ExecutionEngine::CreateSelectPlan(
         auto projection_plan = std::make_unique<ProjectionPlanNode>(
             output_schema, std::move(expressions), std::move(scan_plan));
         projection_plan->SetOwnedSchema(std::move(projection_schema));
+        if (gather_above_projection) {
+            return std::make_unique<GatherPlanNode>(std::move(projection_plan),
+                                                    parallel_scan_workers_);
+        }
         return std::move(projection_plan);
     }
 }
 
 /**
- * 创建INSERT语句的执行计划
- * @param stmt INSERT语句的AST节点
- * @return INSERT执行计划
+ * 沿AND条件找 column = 常量（或 常量 = column）的常量表达式
  */
-std::unique_ptr<PlanNode> ExecutionEngine::CreateInsertPlan(
-    InsertStatement* stmt) {
-    if (!stmt) {
+static ConstantExpression* FindEqualityExpression(Expression* expr,
+                                                  const std::string& column) {
+    auto* binary_expr = dynamic_cast<BinaryOpExpression*>(expr);
+    if (binary_expr == nullptr) {
         return nullptr;
     }
-
+    if (binary_expr->GetOperator() == BinaryOpExpression::OpType::AND) {
+        ConstantExpression* constant =
+            FindEqualityExpression(binary_expr->GetLeft(), column);
+        return constant != nullptr
+                   ? constant
+                   : FindEqualityExpression(binary_expr->GetRight(), column);
+    }
+    if (binary_expr->GetOperator() != BinaryOpExpression::OpType::EQUALS) {
+        return nullptr;
+    }
+    auto* col_ref = dynamic_cast<ColumnRefExpression*>(binary_expr->GetLeft());
+    auto* const_expr =
+        dynamic_cast<ConstantExpression*>(binary_expr->GetRight());
+    if (col_ref == nullptr || const_expr == nullptr) {
+        col_ref = dynamic_cast<ColumnRefExpression*>(binary_expr->GetRight());
+        const_expr = dynamic_cast<ConstantExpression*>(binary_expr->GetLeft());
+    }
+    if (col_ref == nullptr || const_expr == nullptr ||
+        col_ref->GetColumnName() != column) {
+        return nullptr;
+    }
+    return const_expr;
+}
+
+/**
+ * 沿AND条件找 column = 常量（或 常量 = column）的常量
+ */
+static const Value* FindEqualityConstant(Expression* expr,
+                                         const std::string& column) {
+    ConstantExpression* constant = FindEqualityExpression(expr, column);
+    return constant != nullptr ? &constant->GetValue() : nullptr;
+}
+
+/**
+ * 位图条件的值：参数占位符引用参数的槽位，常量复制一份
+ */
+static std::shared_ptr<const Value> BitmapConditionValue(
+    const ConstantExpression* constant) {
+    if (constant->IsParameter()) {
+        return constant->GetParameter();
+    }
+    return std::make_shared<const Value>(constant->GetValue());
+}
+
+/** 位图条件树里索引查找的次数 */
+static size_t CountBitmapLookups(const BitmapIndexCondition& condition) {
+    if (condition.children.empty()) {
+        return 1;
+    }
+    size_t lookups = 0;
+    for (const auto& child : condition.children) {
+        lookups += CountBitmapLookups(child);
+    }
+    return lookups;
+}
+
+/** 收集AND条件里的OR子条件 */
+static void CollectDisjunctions(Expression* expr,
+                                std::vector<Expression*>* disjunctions) {
+    auto* binary_expr = dynamic_cast<BinaryOpExpression*>(expr);
+    if (binary_expr == nullptr) {
+        return;
+    }
+    if (binary_expr->GetOperator() == BinaryOpExpression::OpType::AND) {
+        CollectDisjunctions(binary_expr->GetLeft(), disjunctions);
+        CollectDisjunctions(binary_expr->GetRight(), disjunctions);
+    } else if (binary_expr->GetOperator() == BinaryOpExpression::OpType::OR) {
+        disjunctions->push_back(expr);
+    }
+}
+
+/**
+ * 为一张表选择扫描方式
+ */
+std::unique_ptr<PlanNode> ExecutionEngine::CreateScanPlan(
+    TableInfo* table_info, Expression* where_clause,
+    const std::unordered_set<std::string>* needed_columns) {
+    // 查询优化：检查是否可以使用索引扫描
+    std::unique_ptr<PlanNode> scan_plan;
+    if (where_clause) {
+        std::string selected_index = SelectBestIndex(
+            table_info->table_name, where_clause, needed_columns);
+        if (!selected_index.empty()) {
+            LOG_DEBUG("Using index scan with index: " << selected_index);
+            auto where_copy = ExpressionCloner::Clone(where_clause);
+            auto index_scan = std::make_unique<IndexScanPlanNode>(
+                table_info->schema.get(), table_info->table_name,
+                selected_index, std::move(where_copy));
+            IndexInfo* index_info = catalog_->GetIndex(selected_index);
+            if (needed_columns != nullptr && index_info != nullptr &&
+                IndexCoversColumns(*index_info, *needed_columns)) {
+                LOG_DEBUG("Index " << selected_index << " covers the query");
+                index_scan->SetIndexOnly(true);
+            }
+            scan_plan = std::move(index_scan);
+        } else {
+            // 没有等值条件可用时，尝试用索引做范围扫描
+            scan_plan = CreateIndexRangeScanPlan(table_info, where_clause);
+        }
+    }
+
+    // ANALYZE过的表按代价选择：索引扫描不比顺序扫描便宜时改用顺序扫描，
+    // 比如条件命中的是占了大部分行的高频值；没有统计信息时仍然优先用索引
+    auto statistics = catalog_->GetTableStatistics(table_info->table_name);
+    double estimated_rows = 0;
+    if (statistics) {
+        estimated_rows = CostModel::EstimateRows(
+            *statistics, table_info->schema.get(), where_clause);
+    }
+    if (scan_plan && statistics) {
+        double index_cost =
+            EstimateIndexScanCost(*statistics, table_info, scan_plan.get());
+        double seq_cost = CostModel::SeqScanCost(*statistics);
+        if (index_cost >= seq_cost) {
+            LOG_DEBUG("Index scan cost " << index_cost
+                                         << " is not below sequential scan "
+                                            "cost "
+                                         << seq_cost);
+            scan_plan.reset();
+        } else {
+            scan_plan->SetEstimate(estimated_rows, index_cost);
+        }
+    }
+
+    // 几个索引条件合起来用位图扫描：有统计信息时和上面选出的方式比代价；
+    // 没有统计信息时，除非单个索引已经能定位到一行（唯一索引的完整键）
+    // 或者只读索引就够了，否则优先用位图扫描
+    auto bitmap_plan = CreateBitmapScanPlan(table_info, where_clause);
+    if (bitmap_plan && statistics) {
+        double bitmap_cost = EstimateBitmapScanCost(
+            *statistics, table_info,
+            static_cast<BitmapHeapScanPlanNode*>(bitmap_plan.get()));
+        double best_cost = scan_plan ? scan_plan->GetEstimatedCost()
+                                     : CostModel::SeqScanCost(*statistics);
+        if (bitmap_cost < best_cost) {
+            bitmap_plan->SetEstimate(estimated_rows, bitmap_cost);
+            scan_plan = std::move(bitmap_plan);
+        }
+    } else if (bitmap_plan) {
+        bool pinpoint = false;
+        if (scan_plan && scan_plan->GetType() == PlanNodeType::INDEX_SCAN) {
+            auto* index_scan = static_cast<IndexScanPlanNode*>(scan_plan.get());
+            IndexInfo* index_info =
+                catalog_->GetIndex(index_scan->GetIndexName());
+            pinpoint = index_scan->IsIndexOnly() ||
+                       (index_info != nullptr && index_info->is_unique);
+            for (size_t i = 0; pinpoint && !index_scan->IsIndexOnly() &&
+                               i < index_info->key_columns.size();
+                 i++) {
+                pinpoint = FindEqualityConstant(where_clause,
+                                                index_info->key_columns[i]) !=
+                           nullptr;
+            }
+        }
+        if (!pinpoint) {
+            LOG_DEBUG("Using bitmap heap scan on " << table_info->table_name);
+            scan_plan = std::move(bitmap_plan);
+        }
+    }
+
+    // 如果没有合适的索引，使用顺序扫描
+    if (!scan_plan) {
+        LOG_DEBUG("Using sequential scan");
+        auto where_copy = ExpressionCloner::Clone(where_clause);
+        scan_plan = std::make_unique<SeqScanPlanNode>(
+            table_info->schema.get(), table_info->table_name,
+            std::move(where_copy));
+        if (statistics) {
+            scan_plan->SetEstimate(estimated_rows,
+                                   CostModel::SeqScanCost(*statistics));
+        }
+    }
+    return scan_plan;
+}
+
+/**
+ * 按条件裁剪分区
+ * 实现思路：
+ * 1. AND两边的分区取交集，OR两边取并集
+ * 2. 分区列 = 常量时只留常量所在的分区；范围分区上的<、<=、>、>=
+ *    换成闭区间后留下和它相交的分区
+ * 3. 参数占位符每次执行的值都可能不同，和别的不认识的条件一样保留所有分区
+ */
+static std::vector<bool> PrunePartitions(const PartitionScheme& scheme,
+                                         Expression* expr) {
+    std::vector<bool> all(scheme.partition_count, true);
+    auto* binary_expr = dynamic_cast<BinaryOpExpression*>(expr);
+    if (binary_expr == nullptr) {
+        return all;
+    }
+
+    using OpType = BinaryOpExpression::OpType;
+    OpType op = binary_expr->GetOperator();
+    if (op == OpType::AND || op == OpType::OR) {
+        std::vector<bool> left =
+            PrunePartitions(scheme, binary_expr->GetLeft());
+        std::vector<bool> right =
+            PrunePartitions(scheme, binary_expr->GetRight());
+        for (size_t i = 0; i < left.size(); i++) {
+            left[i] = op == OpType::AND ? left[i] && right[i]
+                                        : left[i] || right[i];
+        }
+        return left;
+    }
+
+    auto* col_ref = dynamic_cast<ColumnRefExpression*>(binary_expr->GetLeft());
+    auto* const_expr =
+        dynamic_cast<ConstantExpression*>(binary_expr->GetRight());
+    if (col_ref == nullptr || const_expr == nullptr) {
+        col_ref = dynamic_cast<ColumnRefExpression*>(binary_expr->GetRight());
+        const_expr = dynamic_cast<ConstantExpression*>(binary_expr->GetLeft());
+        // 5 < col 等价于 col > 5
+        switch (op) {
+            case OpType::LESS_THAN:
+                op = OpType::GREATER_THAN;
+                break;
+            case OpType::LESS_EQUALS:
+                op = OpType::GREATER_EQUALS;
+                break;
+            case OpType::GREATER_THAN:
+                op = OpType::LESS_THAN;
+                break;
+            case OpType::GREATER_EQUALS:
+                op = OpType::LESS_EQUALS;
+                break;
+            default:
+                break;
+        }
+    }
+    if (col_ref == nullptr || const_expr == nullptr ||
+        const_expr->IsParameter() ||
+        col_ref->GetColumnName() != scheme.column_name) {
+        return all;
+    }
+
+    const Value& value = const_expr->GetValue();
+    std::vector<bool> result(scheme.partition_count, false);
+    if (op == OpType::EQUALS) {
+        size_t partition;
+        int64_t key;
+        if (scheme.Route(value, &partition)) {
+            result[partition] = true;
+            return result;
+        }
+        // 整数超出了所有范围分区时没有分区满足条件，类型对不上时保留所有分区
+        return scheme.type == PartitionType::RANGE &&
+                       PartitionValueAsInt64(value, &key)
+                   ? result
+                   : all;
+    }
+
+    int64_t key;
+    if (scheme.type != PartitionType::RANGE ||
+        !PartitionValueAsInt64(value, &key)) {
+        return all;
+    }
+    constexpr int64_t min_key = std::numeric_limits<int64_t>::min();
+    constexpr int64_t max_key = std::numeric_limits<int64_t>::max();
+    int64_t low = min_key;
+    int64_t high = max_key;
+    switch (op) {
+        case OpType::LESS_THAN:
+            if (key == min_key) {
+                return result;
+            }
+            high = key - 1;
+            break;
+        case OpType::LESS_EQUALS:
+            high = key;
+            break;
+        case OpType::GREATER_THAN:
+            if (key == max_key) {
+                return result;
+            }
+            low = key + 1;
+            break;
+        case OpType::GREATER_EQUALS:
+            low = key;
+            break;
+        default:
+            return all;
+    }
+    for (size_t partition : scheme.RangePartitions(low, high)) {
+        result[partition] = true;
+    }
+    return result;
+}
+
+std::vector<size_t> ExecutionEngine::SelectPartitions(
+    TableInfo* table_info, Expression* where_clause) {
+    std::vector<size_t> partitions;
+    if (!table_info->partition_scheme) {
+        return partitions;
+    }
+    std::vector<bool> keep =
+        PrunePartitions(*table_info->partition_scheme, where_clause);
+    for (size_t i = 0; i < keep.size(); i++) {
+        if (keep[i]) {
+            partitions.push_back(i);
+        }
+    }
+    return partitions;
+}
+
+/**
+ * 分区表的扫描
+ * 实现思路：
+ * 1. 裁剪分区，一个分区都不剩时条件不可能满足，仍然扫描第一个分区
+ *    （条件会把行都过滤掉），计划的形状保持简单
+ * 2. 每个分区按自己的索引和统计信息选择扫描方式，估计的行数和代价相加
+ * 3. 多个分区时拼成追加计划，开启并行扫描时工作线程数不超过分区数
+ */
+std::unique_ptr<PlanNode> ExecutionEngine::CreatePartitionedScanPlan(
+    TableInfo* table_info, Expression* where_clause,
+    const std::unordered_set<std::string>* needed_columns) {
+    std::vector<TableInfo*> partitions = catalog_->GetPartitions(table_info);
+    if (partitions.empty()) {
+        LOG_ERROR("CreatePartitionedScanPlan: Partitions of table "
+                  << table_info->table_name << " not found");
+        return nullptr;
+    }
+    std::vector<size_t> selected = SelectPartitions(table_info, where_clause);
+    if (selected.empty()) {
+        selected.push_back(0);
+    }
+    LOG_DEBUG("CreatePartitionedScanPlan: Scanning "
+              << selected.size() << " of " << partitions.size()
+              << " partitions of " << table_info->table_name);
+
+    std::vector<std::unique_ptr<PlanNode>> children;
+    double estimated_rows = 0;
+    double estimated_cost = 0;
+    bool estimated = true;
+    for (size_t partition : selected) {
+        auto child = CreateScanPlan(partitions[partition], where_clause,
+                                    needed_columns);
+        if (child->GetEstimatedRows() < 0) {
+            estimated = false;
+        }
+        estimated_rows += child->GetEstimatedRows();
+        estimated_cost += child->GetEstimatedCost();
+        children.push_back(std::move(child));
+    }
+    if (children.size() == 1) {
+        return std::move(children[0]);
+    }
+
+    size_t workers = parallel_scan_workers_ > 1
+                         ? std::min(parallel_scan_workers_, children.size())
+                         : 1;
+    auto append = std::make_unique<AppendPlanNode>(
+        table_info->schema.get(), std::move(children), workers);
+    if (estimated) {
+        append->SetEstimate(estimated_rows, estimated_cost);
+    }
+    return append;
+}
+
+/** 连接的两张表，下标0是左表，1是右表 */
+struct JoinScope {
+    std::string table_names[2];
+    const Schema* schemas[2];
+};
+
+/**
+ * 复制表达式，把列引用解析到连接的某一张表
+ * @param expr 表达式
+ * @param scope 连接的两张表
+ * @param qualify true时列名写成"表名.列名"，用于连接后的schema；
+ *        false时只保留列名，用于单表的扫描
+ * @param tables 输入输出参数，按位记录用到的表：1是左表，2是右表
+ * @param error 输出参数，失败时的原因
+ * @return 解析后的表达式，表或者列找不到、列名有歧义时返回nullptr
+ */
+static std::unique_ptr<Expression> ResolveJoinColumns(
+    const Expression* expr, const JoinScope& scope, bool qualify, int* tables,
+    std::string* error) {
+    switch (expr->GetType()) {
+        case Expression::ExprType::COLUMN_REF: {
+            const auto* col_ref = static_cast<const ColumnRefExpression*>(expr);
+            const std::string& table = col_ref->GetTableName();
+            const std::string& column = col_ref->GetColumnName();
+            int side = -1;
+            for (int i = 0; i < 2; i++) {
+                bool table_matches =
+                    table.empty() || table == scope.table_names[i];
+                if (!table_matches || !scope.schemas[i]->HasColumn(column)) {
+                    continue;
+                }
+                if (side != -1) {
+                    *error = "Column '" + column + "' is ambiguous";
+                    return nullptr;
+                }
+                side = i;
+            }
+            if (side == -1) {
+                *error = "Column '" +
+                         (table.empty() ? column : table + "." + column) +
+                         "' not found";
+                return nullptr;
+            }
+            *tables |= 1 << side;
+            const std::string& table_name = scope.table_names[side];
+            return std::make_unique<ColumnRefExpression>(
+                table_name, qualify ? table_name + "." + column : column);
+        }
+        case Expression::ExprType::BINARY_OP: {
+            const auto* binary = static_cast<const BinaryOpExpression*>(expr);
+            auto left = ResolveJoinColumns(binary->GetLeft(), scope, qualify,
+                                           tables, error);
+            auto right = ResolveJoinColumns(binary->GetRight(), scope,
+                                            qualify, tables, error);
+            if (!left || !right) {
+                return nullptr;
+            }
+            return std::make_unique<BinaryOpExpression>(
+                std::move(left), binary->GetOperator(), std::move(right));
+        }
+        case Expression::ExprType::UNARY_OP: {
+            const auto* unary = static_cast<const UnaryOpExpression*>(expr);
+            auto operand = ResolveJoinColumns(unary->GetOperand(), scope,
+                                              qualify, tables, error);
+            if (!operand) {
+                return nullptr;
+            }
+            return std::make_unique<UnaryOpExpression>(unary->GetOperator(),
+                                                       std::move(operand));
+        }
+        case Expression::ExprType::FUNCTION_CALL: {
+            const auto* call = static_cast<const FunctionCallExpression*>(expr);
+            std::vector<std::unique_ptr<Expression>> arguments;
+            for (const auto& argument : call->GetArguments()) {
+                auto resolved = ResolveJoinColumns(argument.get(), scope,
+                                                   qualify, tables, error);
+                if (!resolved) {
+                    return nullptr;
+                }
+                arguments.push_back(std::move(resolved));
+            }
+            return std::make_unique<FunctionCallExpression>(
+                call->GetFunctionName(), std::move(arguments),
+                call->IsStar());
+        }
+        default:
+            return ExpressionCloner::Clone(expr);
+    }
+}
+
+/** 把AND连接的条件拆开 */
+static void SplitConjuncts(const Expression* expr,
+                           std::vector<const Expression*>* conjuncts) {
+    if (expr == nullptr) {
+        return;
+    }
+    if (expr->GetType() == Expression::ExprType::BINARY_OP) {
+        const auto* binary = static_cast<const BinaryOpExpression*>(expr);
+        if (binary->GetOperator() == BinaryOpExpression::OpType::AND) {
+            SplitConjuncts(binary->GetLeft(), conjuncts);
+            SplitConjuncts(binary->GetRight(), conjuncts);
+            return;
+        }
+    }
+    conjuncts->push_back(expr);
+}
+
+/** 用AND把条件接到已有的条件后面 */
+static void AppendConjunct(std::unique_ptr<Expression>* condition,
+                           std::unique_ptr<Expression> conjunct) {
+    if (!*condition) {
+        *condition = std::move(conjunct);
+        return;
+    }
+    *condition = std::make_unique<BinaryOpExpression>(
+        std::move(*condition), BinaryOpExpression::OpType::AND,
+        std::move(conjunct));
+}
+
+/**
+ * 连接一边的扫描：普通表顺序扫描，分区表按下推的条件裁剪分区
+ */
+std::unique_ptr<PlanNode> ExecutionEngine::CreateJoinScanPlan(
+    TableInfo* table_info, std::unique_ptr<Expression> predicate) {
+    if (table_info->partition_scheme) {
+        return CreatePartitionedScanPlan(table_info, predicate.get(),
+                                         nullptr);
+    }
+    return std::make_unique<SeqScanPlanNode>(
+        table_info->schema.get(), table_info->table_name, std::move(predicate));
+}
+
+/**
+ * 创建连接计划
+ * 实现思路：
+ * 1. 连接后的schema是左表的列接着右表的列，列名是"表名.列名"
+ * 2. ON和WHERE的条件一起按AND拆开，内连接里两者等价；
+ *    每个条件先解析出用到了哪些表
+ * 3. 只用到一张表的条件下推到这张表的顺序扫描，在连接之前过滤掉
+ * 4. 第一个左表列 = 右表列的条件作为连接键，
+ *    其余用到两张表的条件在连接后的tuple上求值
+ * 5. SELECT *直接返回连接，否则在上面加投影
+ */
+std::unique_ptr<PlanNode> ExecutionEngine::CreateJoinPlan(
+    SelectStatement* stmt) {
+    LOG_DEBUG("CreateJoinPlan: Creating plan for " << stmt->GetTableName()
+                                                  << " JOIN "
+                                                  << stmt->GetJoinTableName());
+    if (stmt->GetTableName() == stmt->GetJoinTableName()) {
+        LOG_ERROR("CreateJoinPlan: Self join of '" << stmt->GetTableName()
+                                                    << "' is not supported");
+        return nullptr;
+    }
+    TableInfo* tables[2] = {catalog_->GetTable(stmt->GetTableName()),
+                            catalog_->GetTable(stmt->GetJoinTableName())};
+    if (!tables[0] || !tables[1]) {
+        LOG_ERROR("CreateJoinPlan: Table '"
+                  << (tables[0] ? stmt->GetJoinTableName()
+                                : stmt->GetTableName())
+                  << "' not found in catalog");
+        return nullptr;
+    }
+
+    JoinScope scope;
+    std::vector<Column> joined_columns;
+    for (int i = 0; i < 2; i++) {
+        scope.table_names[i] = tables[i]->table_name;
+        scope.schemas[i] = tables[i]->schema.get();
+        for (Column column : tables[i]->schema->GetColumns()) {
+            column.name = tables[i]->table_name + "." + column.name;
+            joined_columns.push_back(std::move(column));
+        }
+    }
+    auto joined_schema = std::make_unique<Schema>(joined_columns);
+
+    std::vector<const Expression*> conjuncts;
+    SplitConjuncts(stmt->GetJoinCondition(), &conjuncts);
+    SplitConjuncts(stmt->GetWhereClause(), &conjuncts);
+
+    std::unique_ptr<Expression> scan_predicates[2];
+    std::unique_ptr<Expression> keys[2];
+    std::unique_ptr<Expression> residual;
+    std::string error;
+    for (const Expression* conjunct : conjuncts) {
+        int used_tables = 0;
+        auto qualified =
+            ResolveJoinColumns(conjunct, scope, true, &used_tables, &error);
+        if (!qualified) {
+            LOG_ERROR("CreateJoinPlan: " << error);
+            return nullptr;
+        }
+        if (used_tables == 1 || used_tables == 2) {
+            int side = used_tables == 1 ? 0 : 1;
+            int ignored = 0;
+            AppendConjunct(&scan_predicates[side],
+                           ResolveJoinColumns(conjunct, scope, false, &ignored,
+                                              &error));
+            continue;
+        }
+
+        // 列 = 列，并且两边分属两张表时作为连接键
+        const auto* binary = conjunct->GetType() ==
+                                     Expression::ExprType::BINARY_OP
+                                 ? static_cast<const BinaryOpExpression*>(
+                                       conjunct)
+                                 : nullptr;
+        if (!keys[0] && binary != nullptr &&
+            binary->GetOperator() == BinaryOpExpression::OpType::EQUALS) {
+            int left_tables = 0;
+            int right_tables = 0;
+            auto left = ResolveJoinColumns(binary->GetLeft(), scope, false,
+                                           &left_tables, &error);
+            auto right = ResolveJoinColumns(binary->GetRight(), scope, false,
+                                            &right_tables, &error);
+            if ((left_tables == 1 && right_tables == 2) ||
+                (left_tables == 2 && right_tables == 1)) {
+                bool swapped = left_tables == 2;
+                keys[0] = swapped ? std::move(right) : std::move(left);
+                keys[1] = swapped ? std::move(left) : std::move(right);
+                continue;
+            }
+        }
+        AppendConjunct(&residual, std::move(qualified));
+    }
+    if (!keys[0]) {
+        LOG_ERROR("CreateJoinPlan: JOIN needs an equality condition between "
+                  "columns of "
+                  << stmt->GetTableName() << " and "
+                  << stmt->GetJoinTableName());
+        return nullptr;
+    }
+
+    // 内表的连接列上有索引时不用扫描内表，FROM的表优先做外表
+    int inner = -1;
+    std::string inner_index;
+    for (int i : {1, 0}) {
+        auto* key_column = dynamic_cast<ColumnRefExpression*>(keys[i].get());
+        if (key_column == nullptr) {
+            continue;
+        }
+        inner_index = SelectJoinIndex(tables[i]->table_name,
+                                      key_column->GetColumnName());
+        if (!inner_index.empty()) {
+            inner = i;
+            break;
+        }
+    }
+
+    const Schema* join_schema = joined_schema.get();
+    std::unique_ptr<PlanNode> join_plan;
+    if (inner != -1) {
+        int outer = 1 - inner;
+        LOG_DEBUG("CreateJoinPlan: Using index nested loop join with index "
+                  << inner_index << " on " << tables[inner]->table_name);
+        auto outer_scan = CreateJoinScanPlan(
+            tables[outer], std::move(scan_predicates[outer]));
+        if (!outer_scan) {
+            return nullptr;
+        }
+        std::string inner_column =
+            static_cast<ColumnRefExpression*>(keys[inner].get())
+                ->GetColumnName();
+        join_plan = std::make_unique<IndexNestedLoopJoinPlanNode>(
+            std::move(joined_schema), std::move(outer_scan), outer == 0,
+            tables[inner]->table_name, inner_index, std::move(keys[outer]),
+            inner_column, std::move(scan_predicates[inner]),
+            std::move(residual));
+    } else {
+        std::unique_ptr<PlanNode> scans[2];
+        for (int i = 0; i < 2; i++) {
+            scans[i] =
+                CreateJoinScanPlan(tables[i], std::move(scan_predicates[i]));
+            if (!scans[i]) {
+                return nullptr;
+            }
+        }
+        join_plan = std::make_unique<HashJoinPlanNode>(
+            std::move(joined_schema), std::move(scans[0]),
+            std::move(scans[1]), std::move(keys[0]), std::move(keys[1]),
+            std::move(residual));
+    }
+
+    // ORDER BY和SELECT列表一样按"表名.列名"解析
+    std::vector<SortPlanNode::SortKey> sort_keys;
+    for (const auto& item : stmt->GetOrderBy()) {
+        int used_tables = 0;
+        auto resolved = ResolveJoinColumns(item.expression.get(), scope, true,
+                                           &used_tables, &error);
+        if (!resolved) {
+            LOG_ERROR("CreateJoinPlan: " << error);
+            return nullptr;
+        }
+        sort_keys.push_back({std::move(resolved), item.ascending});
+    }
+
+    const auto& select_list = stmt->GetSelectList();
+    if (select_list.size() == 1) {
+        auto* col_ref =
+            dynamic_cast<ColumnRefExpression*>(select_list[0].get());
+        if (col_ref && col_ref->GetColumnName() == "*") {
+            if (HasAggregation(stmt)) {
+                LOG_ERROR("CreateJoinPlan: SELECT * cannot be used with "
+                          "GROUP BY or aggregate functions");
+                return nullptr;
+            }
+            return AddSortAndLimit(std::move(join_plan), std::move(sort_keys),
+                                   stmt->GetLimit());
+        }
+    }
+
+    // 聚合的分组键和参数同样按"表名.列名"在连接后的schema上求值
+    if (HasAggregation(stmt)) {
+        std::vector<std::unique_ptr<Expression>> resolved_lists[2];
+        const std::vector<std::unique_ptr<Expression>>* lists[] = {
+            &select_list, &stmt->GetGroupBy()};
+        for (int i = 0; i < 2; i++) {
+            for (const auto& expr : *lists[i]) {
+                int used_tables = 0;
+                auto resolved = ResolveJoinColumns(expr.get(), scope, true,
+                                                   &used_tables, &error);
+                if (!resolved) {
+                    LOG_ERROR("CreateJoinPlan: " << error);
+                    return nullptr;
+                }
+                resolved_lists[i].push_back(std::move(resolved));
+            }
+        }
+        auto aggregation_plan = CreateAggregationPlan(
+            std::move(join_plan), resolved_lists[0], resolved_lists[1]);
+        if (!aggregation_plan) {
+            return nullptr;
+        }
+        for (auto& key : sort_keys) {
+            key.expression = ResolveAggregateOrderBy(
+                key.expression.get(), aggregation_plan->GetOutputSchema());
+            if (!key.expression) {
+                return nullptr;
+            }
+        }
+        return AddSortAndLimit(std::move(aggregation_plan),
+                               std::move(sort_keys), stmt->GetLimit());
+    }
+    for (const auto& key : sort_keys) {
+        if (ContainsAggregate(key.expression.get())) {
+            LOG_ERROR("CreateJoinPlan: Aggregate functions in ORDER BY "
+                      "require an aggregate query");
+            return nullptr;
+        }
+    }
+    join_plan = AddSortAndLimit(std::move(join_plan), std::move(sort_keys),
+                                stmt->GetLimit());
+
+    // 投影的列按解析后的"表名.列名"在连接后的schema里查找
+    std::vector<Column> selected_columns;
+    std::vector<std::unique_ptr<Expression>> expressions;
+    for (const auto& expr : select_list) {
+        int used_tables = 0;
+        auto resolved =
+            ResolveJoinColumns(expr.get(), scope, true, &used_tables, &error);
+        if (!resolved) {
+            LOG_ERROR("CreateJoinPlan: " << error);
+            return nullptr;
+        }
+        if (resolved->GetType() == Expression::ExprType::COLUMN_REF) {
+            selected_columns.push_back(join_schema->GetColumn(
+                static_cast<ColumnRefExpression*>(resolved.get())
+                    ->GetColumnName()));
+        }
+        expressions.push_back(std::move(resolved));
+    }
+    auto projection_schema = std::make_unique<Schema>(selected_columns);
+    auto projection_plan = std::make_unique<ProjectionPlanNode>(
+        projection_schema.get(), std::move(expressions), std::move(join_plan));
+    projection_plan->SetOwnedSchema(std::move(projection_schema));
+    return projection_plan;
+}
+
+std::string ExecutionEngine::SelectJoinIndex(const std::string& table_name,
+                                             const std::string& column) {
+    std::string best_index;
+    size_t best_columns = 0;
+    bool best_unique = false;
+    for (auto* index_info : catalog_->GetTableIndexes(table_name)) {
+        const auto& key_columns = index_info->key_columns;
+        if (key_columns.empty() || key_columns[0] != column) {
+            continue;
+        }
+        if (index_info->index_type == IndexType::HASH &&
+            key_columns.size() != 1) {
+            continue;
+        }
+        bool better = best_index.empty() ||
+                      (index_info->is_unique && !best_unique) ||
+                      (index_info->is_unique == best_unique &&
+                       key_columns.size() < best_columns);
+        if (better) {
+            best_index = index_info->index_name;
+            best_columns = key_columns.size();
+            best_unique = index_info->is_unique;
+        }
+    }
+    return best_index;
+}
+
+/**
+ * 创建聚合计划
+ * 实现思路：
+ * 1. GROUP BY表达式不能含聚合函数，类型要能在输入schema上确定
+ * 2. SELECT项是聚合函数调用时记下函数和参数，结果类型由参数类型决定，
+ *    列名是函数调用的文本，比如COUNT(*)
+ * 3. 其他SELECT项必须和某个GROUP BY表达式相同（按文本比较），
+ *    输出这个分组键
+ */
+std::unique_ptr<PlanNode> ExecutionEngine::CreateAggregationPlan(
+    std::unique_ptr<PlanNode> child,
+    const std::vector<std::unique_ptr<Expression>>& select_list,
+    const std::vector<std::unique_ptr<Expression>>& group_by) {
+    const Schema* input_schema = child->GetOutputSchema();
+
+    std::vector<std::string> group_texts;
+    std::vector<std::unique_ptr<Expression>> group_exprs;
+    for (const auto& expr : group_by) {
+        if (ContainsAggregate(expr.get())) {
+            LOG_ERROR("CreateAggregationPlan: Aggregate functions are not "
+                      "allowed in GROUP BY");
+            return nullptr;
+        }
+        if (ExpressionEvaluator::InferType(expr.get(), input_schema) ==
+            TypeId::INVALID) {
+            LOG_ERROR("CreateAggregationPlan: Cannot resolve GROUP BY "
+                      "expression "
+                      << ExpressionToString(expr.get()));
+            return nullptr;
+        }
+        group_texts.push_back(ExpressionToString(expr.get()));
+        group_exprs.push_back(ExpressionCloner::Clone(expr.get()));
+    }
+
+    std::vector<Column> columns;
+    std::vector<AggregationPlanNode::Aggregate> aggregates;
+    std::vector<AggregationPlanNode::OutputColumn> output_columns;
+    for (const auto& expr : select_list) {
+        std::string text = ExpressionToString(expr.get());
+        if (expr->GetType() == Expression::ExprType::FUNCTION_CALL) {
+            const auto* call =
+                static_cast<const FunctionCallExpression*>(expr.get());
+            const std::string& name = call->GetFunctionName();
+            AggregateType type;
+            if (name == "COUNT") {
+                type = call->IsStar() ? AggregateType::COUNT_STAR
+                                      : AggregateType::COUNT;
+            } else if (name == "SUM") {
+                type = AggregateType::SUM;
+            } else if (name == "AVG") {
+                type = AggregateType::AVG;
+            } else if (name == "MIN") {
+                type = AggregateType::MIN;
+            } else if (name == "MAX") {
+                type = AggregateType::MAX;
+            } else {
+                LOG_ERROR("CreateAggregationPlan: Unknown function " << name);
+                return nullptr;
+            }
+            if (call->IsStar() ? type != AggregateType::COUNT_STAR
+                               : call->GetArguments().size() != 1) {
+                LOG_ERROR("CreateAggregationPlan: Invalid arguments in "
+                          << text);
+                return nullptr;
+            }
+            const Expression* argument =
+                call->IsStar() ? nullptr : call->GetArguments()[0].get();
+            if (ContainsAggregate(argument)) {
+                LOG_ERROR("CreateAggregationPlan: Aggregate functions cannot "
+                          "be nested: "
+                          << text);
+                return nullptr;
+            }
+            TypeId input_type =
+                argument == nullptr
+                    ? TypeId::BIGINT
+                    : ExpressionEvaluator::InferType(argument, input_schema);
+            if (input_type == TypeId::INVALID) {
+                LOG_ERROR("CreateAggregationPlan: Cannot resolve the argument "
+                          "of "
+                          << text);
+                return nullptr;
+            }
+            TypeId result_type;
+            try {
+                result_type =
+                    AggregationHashTable::GetResultType(type, input_type);
+            } catch (const ExecutionException& e) {
+                LOG_ERROR("CreateAggregationPlan: " << text << ": "
+                                                    << e.what());
+                return nullptr;
+            }
+            size_t size = 0;
+            if (result_type == TypeId::VARCHAR) {
+                size = argument->GetType() == Expression::ExprType::COLUMN_REF
+                           ? input_schema->GetColumn(ExpressionToString(argument))
+                                 .size
+                           : 65535;
+            }
+            columns.push_back(Column{text, result_type, size, true, false});
+            output_columns.push_back({true, aggregates.size()});
+            aggregates.push_back(AggregationPlanNode::Aggregate{
+                type, ExpressionCloner::Clone(argument)});
+            continue;
+        }
+        if (ContainsAggregate(expr.get())) {
+            LOG_ERROR("CreateAggregationPlan: Aggregate functions must be "
+                      "whole SELECT items: "
+                      << text);
+            return nullptr;
+        }
+        auto group = std::find(group_texts.begin(), group_texts.end(), text);
+        if (group == group_texts.end()) {
+            LOG_ERROR("CreateAggregationPlan: '"
+                      << text
+                      << "' must appear in GROUP BY or be used in an "
+                         "aggregate function");
+            return nullptr;
+        }
+        size_t group_index = group - group_texts.begin();
+        if (expr->GetType() == Expression::ExprType::COLUMN_REF) {
+            Column column = input_schema->GetColumn(text);
+            column.nullable = true;
+            column.is_primary_key = false;
+            columns.push_back(std::move(column));
+        } else {
+            columns.push_back(Column{
+                text, ExpressionEvaluator::InferType(expr.get(), input_schema),
+                0, true, false});
+        }
+        output_columns.push_back({false, group_index});
+    }
+
+    return std::make_unique<AggregationPlanNode>(
+        std::make_unique<Schema>(columns), std::move(child),
+        std::move(group_exprs), std::move(aggregates),
+        std::move(output_columns));
+}
+
+/**
+ * 创建INSERT语句的执行计划
+ * @param stmt INSERT语句的AST节点
+ * @return INSERT执行计划
+ */
+std::unique_ptr<PlanNode> ExecutionEngine::CreateInsertPlan(
+    InsertStatement* stmt) {
+    if (!stmt) {
+        return nullptr;
+    }
+
     // 检查表是否存在
     TableInfo* table_info = catalog_->GetTable(stmt->GetTableName());
     if (!table_info) {
         return nullptr;
     }
 
-    // 创建INSERT执行计划，包含表schema、表名和要插入的值
-    return std::make_unique<InsertPlanNode>(
-        table_info->schema.get(), stmt->GetTableName(), stmt->GetValues());
+    // 预编译的INSERT里 $n 占的位置换成当前绑定的参数值
+    std::vector<std::vector<Value>> values = stmt->GetValues();
+    for (const auto& parameter : stmt->GetParameters()) {
+        values[parameter.row][parameter.column] = *parameter.parameter;
+    }
+
+    // 创建INSERT执行计划，包含表schema、表名和要插入的值
+    return std::make_unique<InsertPlanNode>(
+        table_info->schema.get(), stmt->GetTableName(), std::move(values));
+}
+
+/**
+ * 索引选择优化器：分析WHERE条件，选择最适合的索引
+ * 实现思路：
+ * 1. 收集AND条件里所有做等值比较的列
+ * 2. 对每个索引，从第一列开始数连续有等值条件的列数，
+ *    数量为0的索引用不上
+ * 3. 选列数最多的索引，执行器用这些列的值做（前缀）查找
+ * 4. 哈希索引只能用完整的键查找，所有键列都有等值条件才考虑；
+ *    和B+树匹配的列数相同时优先用哈希索引，点查询少走几层页面
+ * 5. 完整的键都有等值条件的唯一索引最多命中一行，比哈希索引更优先
+ * 6. 但覆盖了查询所有列的B+树索引最优先，省掉回表
+ * @param table_name 表名
+ * @param where_clause WHERE条件表达式
+ * @param needed_columns 查询用到的所有列，可以为nullptr
+ * @return 选中的索引名，如果没有合适索引则返回空字符串
+ */
+std::string ExecutionEngine::SelectBestIndex(
+    const std::string& table_name, Expression* where_clause,
+    const std::unordered_set<std::string>* needed_columns) {
+    if (!where_clause) {
+        return "";
+    }
+
+    LOG_DEBUG("SelectBestIndex: Analyzing WHERE clause for table "
+              << table_name);
+
+    std::unordered_set<std::string> equality_columns;
+    CollectEqualityColumns(where_clause, &equality_columns);
+    if (equality_columns.empty()) {
+        // 范围查询由CreateIndexRangeScanPlan处理
+        LOG_DEBUG("SelectBestIndex: No equality condition in WHERE clause");
+        return "";
+    }
+
+    // 匹配的列数相同时按 覆盖索引 > 完整键的唯一索引 > 哈希索引 >
+    // 普通B+树索引 选择
+    std::string best_index;
+    size_t best_matched = 0;
+    int best_rank = 0;
+    for (auto* index_info : catalog_->GetTableIndexes(table_name)) {
+        size_t matched = 0;
+        while (matched < index_info->key_columns.size() &&
+               equality_columns.count(index_info->key_columns[matched]) > 0) {
+            matched++;
+        }
+        bool is_hash = index_info->index_type == IndexType::HASH;
+        if (is_hash && matched < index_info->key_columns.size()) {
+            continue;
+        }
+        int rank = 0;
+        if (needed_columns != nullptr &&
+            IndexCoversColumns(*index_info, *needed_columns)) {
+            rank = 3;
+        } else if (index_info->is_unique &&
+                   matched == index_info->key_columns.size()) {
+            rank = 2;
+        } else if (is_hash) {
+            rank = 1;
+        }
+        if (matched > best_matched ||
+            (matched == best_matched && matched > 0 && rank > best_rank)) {
+            best_matched = matched;
+            best_index = index_info->index_name;
+            best_rank = rank;
+        }
+    }
+
+    if (best_index.empty()) {
+        LOG_DEBUG(
+            "SelectBestIndex: No suitable index found for the WHERE clause");
+    } else {
+        LOG_DEBUG("SelectBestIndex: Found suitable index: "
+                  << best_index << " matching " << best_matched
+                  << " key columns");
+    }
+    return best_index;
+}
+
+/**
+ * 收集表达式引用的列
+ * 常量、列引用、一元和二元运算之外的表达式无法确定用到哪些列
+ */
+bool ExecutionEngine::CollectReferencedColumns(
+    Expression* expr, std::unordered_set<std::string>* columns) {
+    if (expr == nullptr) {
+        return true;
+    }
+    switch (expr->GetType()) {
+        case Expression::ExprType::CONSTANT:
+            return true;
+        case Expression::ExprType::COLUMN_REF: {
+            const auto& name =
+                static_cast<ColumnRefExpression*>(expr)->GetColumnName();
+            if (name == "*") {
+                return false;
+            }
+            columns->insert(name);
+            return true;
+        }
+        case Expression::ExprType::BINARY_OP: {
+            auto* binary_expr = static_cast<BinaryOpExpression*>(expr);
+            bool left =
+                CollectReferencedColumns(binary_expr->GetLeft(), columns);
+            bool right =
+                CollectReferencedColumns(binary_expr->GetRight(), columns);
+            return left && right;
+        }
+        case Expression::ExprType::UNARY_OP:
+            return CollectReferencedColumns(
+                static_cast<UnaryOpExpression*>(expr)->GetOperand(), columns);
+        case Expression::ExprType::FUNCTION_CALL: {
+            // COUNT(*)不用到任何列，其他函数用到参数里的列
+            bool known = true;
+            for (const auto& argument :
+                 static_cast<FunctionCallExpression*>(expr)->GetArguments()) {
+                known = CollectReferencedColumns(argument.get(), columns) &&
+                        known;
+            }
+            return known;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * 检查查询用到的列是否都在索引列或INCLUDE列里
+ */
+bool ExecutionEngine::IndexCoversColumns(
+    const IndexInfo& index_info,
+    const std::unordered_set<std::string>& columns) {
+    if (index_info.index_type != IndexType::BPLUS_TREE) {
+        return false;
+    }
+    for (const auto& column : columns) {
+        bool stored =
+            std::find(index_info.key_columns.begin(),
+                      index_info.key_columns.end(),
+                      column) != index_info.key_columns.end() ||
+            std::find(index_info.include_columns.begin(),
+                      index_info.include_columns.end(),
+                      column) != index_info.include_columns.end();
+        if (!stored) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 收集等值条件的列
+ * 只沿AND向下找，另一侧必须是常量才能用来查索引
+ */
+void ExecutionEngine::CollectEqualityColumns(
+    Expression* expr, std::unordered_set<std::string>* columns) {
+    auto* binary_expr = dynamic_cast<BinaryOpExpression*>(expr);
+    if (binary_expr == nullptr) {
+        return;
+    }
+    if (binary_expr->GetOperator() == BinaryOpExpression::OpType::AND) {
+        CollectEqualityColumns(binary_expr->GetLeft(), columns);
+        CollectEqualityColumns(binary_expr->GetRight(), columns);
+        return;
+    }
+    if (binary_expr->GetOperator() != BinaryOpExpression::OpType::EQUALS) {
+        return;
+    }
+
+    auto* col_ref = dynamic_cast<ColumnRefExpression*>(binary_expr->GetLeft());
+    Expression* other = binary_expr->GetRight();
+    if (col_ref == nullptr) {
+        col_ref = dynamic_cast<ColumnRefExpression*>(binary_expr->GetRight());
+        other = binary_expr->GetLeft();
+    }
+    if (col_ref != nullptr && dynamic_cast<ConstantExpression*>(other)) {
+        columns->insert(col_ref->GetColumnName());
+    }
+}
+
+/**
+ * 生成索引范围扫描计划
+ * 实现思路：
+ * 1. 依次尝试表上的每个单列B+树索引，从WHERE的AND条件里收集该列的上下界
+ * 2. 第一个至少有一侧边界的索引被选中
+ * 3. 计划里保留完整的WHERE条件，执行器对边界内的每一行再过滤一次，
+ *    所以OR、其他列上的条件等都不影响正确性
+ */
+std::unique_ptr<PlanNode> ExecutionEngine::CreateIndexRangeScanPlan(
+    TableInfo* table_info, Expression* where_clause) {
+    if (!where_clause) {
+        return nullptr;
+    }
+
+    for (auto* index_info : catalog_->GetTableIndexes(table_info->table_name)) {
+        // 哈希索引的键没有顺序，不能做范围扫描
+        if (index_info->key_columns.size() != 1 ||
+            index_info->index_type == IndexType::HASH) {
+            continue;
+        }
+        auto plan = std::make_unique<IndexRangeScanPlanNode>(
+            table_info->schema.get(), table_info->table_name,
+            index_info->index_name, ExpressionCloner::Clone(where_clause));
+        CollectRangeBounds(where_clause, index_info->key_columns[0],
+                           plan.get());
+        if (plan->GetLowerBound() != nullptr ||
+            plan->GetUpperBound() != nullptr) {
+            LOG_DEBUG("CreateIndexRangeScanPlan: Using index "
+                      << index_info->index_name << " for range scan");
+            return plan;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * 生成位图扫描计划
+ * 只有一次索引查找时普通的索引扫描更合适，这里不生成
+ */
+std::unique_ptr<PlanNode> ExecutionEngine::CreateBitmapScanPlan(
+    TableInfo* table_info, Expression* where_clause) {
+    BitmapIndexCondition condition;
+    if (where_clause == nullptr || table_info->storage != TableStorage::ROW ||
+        !BuildBitmapCondition(table_info, where_clause, &condition) ||
+        CountBitmapLookups(condition) < 2) {
+        return nullptr;
+    }
+    return std::make_unique<BitmapHeapScanPlanNode>(
+        table_info->schema.get(), table_info->table_name,
+        std::move(condition), ExpressionCloner::Clone(where_clause));
+}
+
+/**
+ * 把条件换成位图扫描的条件树
+ * 实现思路：
+ * 1. OR：每一支分别转换，有一支用不上索引时整个OR都用不上，
+ *    嵌套的OR摊平成一个节点
+ * 2. 其他条件按AND处理，子节点依次来自：
+ *    - AND里能转换的OR子条件
+ *    - 等值条件：每个索引从第一列开始取连续有等值条件的列作为查找键
+ *      （哈希索引要所有键列都有），按匹配的列数从多到少选，
+ *      第一列已经被选过的索引跳过
+ *    - 范围条件：还没有用到的列上的单列B+树索引，
+ *      和索引范围扫描一样用CollectRangeBounds收集上下界
+ * 3. 只有一个子节点时不需要AND节点
+ */
+bool ExecutionEngine::BuildBitmapCondition(TableInfo* table_info,
+                                           Expression* expr,
+                                           BitmapIndexCondition* condition) {
+    auto* binary_expr = dynamic_cast<BinaryOpExpression*>(expr);
+    if (binary_expr == nullptr) {
+        return false;
+    }
+    using Kind = BitmapIndexCondition::Kind;
+    if (binary_expr->GetOperator() == BinaryOpExpression::OpType::OR) {
+        BitmapIndexCondition result;
+        result.kind = Kind::OR;
+        for (Expression* side :
+             {binary_expr->GetLeft(), binary_expr->GetRight()}) {
+            BitmapIndexCondition child;
+            if (!BuildBitmapCondition(table_info, side, &child)) {
+                return false;
+            }
+            if (child.kind == Kind::OR) {
+                for (auto& grandchild : child.children) {
+                    result.children.push_back(std::move(grandchild));
+                }
+            } else {
+                result.children.push_back(std::move(child));
+            }
+        }
+        *condition = std::move(result);
+        return true;
+    }
+
+    std::vector<BitmapIndexCondition> children;
+    std::vector<Expression*> disjunctions;
+    CollectDisjunctions(expr, &disjunctions);
+    for (Expression* disjunction : disjunctions) {
+        BitmapIndexCondition child;
+        if (BuildBitmapCondition(table_info, disjunction, &child)) {
+            children.push_back(std::move(child));
+        }
+    }
+
+    auto indexes = catalog_->GetTableIndexes(table_info->table_name);
+    std::vector<std::pair<IndexInfo*, std::vector<ConstantExpression*>>>
+        lookups;
+    for (auto* index_info : indexes) {
+        std::vector<ConstantExpression*> keys;
+        for (const auto& column : index_info->key_columns) {
+            ConstantExpression* constant = FindEqualityExpression(expr, column);
+            if (constant == nullptr) {
+                break;
+            }
+            keys.push_back(constant);
+        }
+        if (keys.empty() || (index_info->index_type == IndexType::HASH &&
+                             keys.size() < index_info->key_columns.size())) {
+            continue;
+        }
+        lookups.emplace_back(index_info, std::move(keys));
+    }
+    std::stable_sort(lookups.begin(), lookups.end(),
+                     [](const auto& a, const auto& b) {
+                         return a.second.size() > b.second.size();
+                     });
+    std::unordered_set<std::string> used_columns;
+    for (const auto& [index_info, keys] : lookups) {
+        if (used_columns.count(index_info->key_columns[0]) > 0) {
+            continue;
+        }
+        BitmapIndexCondition child;
+        child.kind = Kind::INDEX_LOOKUP;
+        child.index_name = index_info->index_name;
+        for (size_t i = 0; i < keys.size(); i++) {
+            used_columns.insert(index_info->key_columns[i]);
+            child.key_values.push_back(BitmapConditionValue(keys[i]));
+        }
+        children.push_back(std::move(child));
+    }
+
+    for (auto* index_info : indexes) {
+        if (index_info->key_columns.size() != 1 ||
+            index_info->index_type == IndexType::HASH ||
+            used_columns.count(index_info->key_columns[0]) > 0) {
+            continue;
+        }
+        IndexRangeScanPlanNode bounds(table_info->schema.get(),
+                                      table_info->table_name,
+                                      index_info->index_name);
+        CollectRangeBounds(expr, index_info->key_columns[0], &bounds);
+        if (bounds.GetLowerBound() == nullptr &&
+            bounds.GetUpperBound() == nullptr) {
+            continue;
+        }
+        used_columns.insert(index_info->key_columns[0]);
+        BitmapIndexCondition child;
+        child.kind = Kind::INDEX_RANGE;
+        child.index_name = index_info->index_name;
+        if (bounds.GetLowerBoundParameter()) {
+            child.lower = bounds.GetLowerBoundParameter();
+        } else if (bounds.GetLowerBound() != nullptr) {
+            child.lower = std::make_shared<const Value>(*bounds.GetLowerBound());
+        }
+        if (bounds.GetUpperBoundParameter()) {
+            child.upper = bounds.GetUpperBoundParameter();
+        } else if (bounds.GetUpperBound() != nullptr) {
+            child.upper = std::make_shared<const Value>(*bounds.GetUpperBound());
+        }
+        child.lower_inclusive = bounds.IsLowerInclusive();
+        child.upper_inclusive = bounds.IsUpperInclusive();
+        children.push_back(std::move(child));
+    }
+
+    if (children.empty()) {
+        return false;
+    }
+    if (children.size() == 1) {
+        *condition = std::move(children[0]);
+        return true;
+    }
+    condition->kind = Kind::AND;
+    condition->children = std::move(children);
+    return true;
 }
 
 /**
- * 索引选择优化器：分析WHERE条件，选择最适合的索引
- * @param table_name 表名
- * @param where_clause WHERE条件表达式
- * @return 选中的索引名，如果没有合适索引则返回空字符串
+ * 收集索引列上的范围条件
+ * 实现思路：
+ * 1. 只沿AND向下找，OR下面的条件不能作为整体的边界
+ * 2. 常量 op 列 的形式把比较方向反过来，统一成 列 op 常量
+ * 3. 同一侧出现多个边界时取更紧的：值更大的下界、值更小的上界，
+ *    值相同时开区间比闭区间紧
  */
-std::string ExecutionEngine::SelectBestIndex(const std::string& table_name,
-                                             Expression* where_clause) {
-    if (!where_clause) {
-        return "";
+void ExecutionEngine::CollectRangeBounds(Expression* expr,
+                                         const std::string& column,
+                                         IndexRangeScanPlanNode* plan) {
+    auto* binary_expr = dynamic_cast<BinaryOpExpression*>(expr);
+    if (binary_expr == nullptr) {
+        return;
     }
 
-    LOG_DEBUG("SelectBestIndex: Analyzing WHERE clause for table "
-              << table_name);
+    using OpType = BinaryOpExpression::OpType;
+    OpType op = binary_expr->GetOperator();
+    if (op == OpType::AND) {
+        CollectRangeBounds(binary_expr->GetLeft(), column, plan);
+        CollectRangeBounds(binary_expr->GetRight(), column, plan);
+        return;
+    }
+    if (op != OpType::LESS_THAN && op != OpType::LESS_EQUALS &&
+        op != OpType::GREATER_THAN && op != OpType::GREATER_EQUALS) {
+        return;
+    }
 
-    // 当前实现的索引选择策略：支持等值查询的索引扫描
-    if (auto* binary_expr = dynamic_cast<BinaryOpExpression*>(where_clause)) {
-        if (binary_expr->GetOperator() == BinaryOpExpression::OpType::EQUALS) {
-            std::string column_name;
-
-            // 检查左操作数是否为列引用
-            if (auto* col_ref = dynamic_cast<ColumnRefExpression*>(
-                    binary_expr->GetLeft())) {
-                column_name = col_ref->GetColumnName();
-            }
-            // 检查右操作数是否为列引用，支持 value = column 的情况
-            else if (auto* col_ref = dynamic_cast<ColumnRefExpression*>(
-                         binary_expr->GetRight())) {
-                column_name = col_ref->GetColumnName();
-            }
-
-            if (!column_name.empty()) {
-                // 确保另一个操作数是常量，这样才能有效使用索引
-                bool has_constant = false;
-                if (dynamic_cast<ConstantExpression*>(binary_expr->GetLeft()) ||
-                    dynamic_cast<ConstantExpression*>(
-                        binary_expr->GetRight())) {
-                    has_constant = true;
-                }
+    auto* col_ref = dynamic_cast<ColumnRefExpression*>(binary_expr->GetLeft());
+    auto* const_expr =
+        dynamic_cast<ConstantExpression*>(binary_expr->GetRight());
+    if (col_ref == nullptr || const_expr == nullptr) {
+        col_ref = dynamic_cast<ColumnRefExpression*>(binary_expr->GetRight());
+        const_expr = dynamic_cast<ConstantExpression*>(binary_expr->GetLeft());
+        // 5 < col 等价于 col > 5
+        switch (op) {
+            case OpType::LESS_THAN:
+                op = OpType::GREATER_THAN;
+                break;
+            case OpType::LESS_EQUALS:
+                op = OpType::GREATER_EQUALS;
+                break;
+            case OpType::GREATER_THAN:
+                op = OpType::LESS_THAN;
+                break;
+            default:
+                op = OpType::LESS_EQUALS;
+                break;
+        }
+    }
+    if (col_ref == nullptr || const_expr == nullptr ||
+        col_ref->GetColumnName() != column) {
+        return;
+    }
 
-                if (has_constant) {
-                    LOG_DEBUG(
-                        "SelectBestIndex: Found equality condition on column: "
-                        << column_name);
-
-                    // 在该列上查找索引
-                    std::vector<IndexInfo*> indexes =
-                        catalog_->GetTableIndexes(table_name);
-                    for (auto* index_info : indexes) {
-                        // 目前只支持单列索引
-                        if (index_info->key_columns.size() == 1 &&
-                            index_info->key_columns[0] == column_name) {
-                            LOG_DEBUG("SelectBestIndex: Found suitable index: "
-                                      << index_info->index_name);
-                            return index_info->index_name;
-                        }
+    // 参数占位符的值每次执行都可能不同，和别的边界比不出哪个更紧，
+    // 同一侧已经有边界时就不再替换（任何一个边界都比真正的条件宽）
+    const Value& value = const_expr->GetValue();
+    if (op == OpType::GREATER_THAN || op == OpType::GREATER_EQUALS) {
+        bool inclusive = op == OpType::GREATER_EQUALS;
+        const Value* current = plan->GetLowerBound();
+        if (current == nullptr && const_expr->IsParameter()) {
+            plan->SetLowerBoundParameter(const_expr->GetParameter(),
+                                         inclusive);
+        } else if (current == nullptr ||
+                   (!const_expr->IsParameter() &&
+                    !plan->GetLowerBoundParameter() &&
+                    current->index() == value.index() &&
+                    (*current < value ||
+                     (*current == value && !inclusive)))) {
+            plan->SetLowerBound(value, inclusive);
+        }
+    } else {
+        bool inclusive = op == OpType::LESS_EQUALS;
+        const Value* current = plan->GetUpperBound();
+        if (current == nullptr && const_expr->IsParameter()) {
+            plan->SetUpperBoundParameter(const_expr->GetParameter(),
+                                         inclusive);
+        } else if (current == nullptr ||
+                   (!const_expr->IsParameter() &&
+                    !plan->GetUpperBoundParameter() &&
+                    current->index() == value.index() &&
+                    (value < *current ||
+                     (*current == value && !inclusive)))) {
+            plan->SetUpperBound(value, inclusive);
+        }
+    }
+}
+
+/**
+ * 估计索引扫描的代价
+ * 实现思路：
+ * 1. 等值索引扫描：从第一个键列开始，连续有等值条件的键列的选择率相乘
+ * 2. 范围扫描：用索引列上的上下界估计范围选择率
+ * 3. 命中的行数交给CostModel计算代价，只读索引时不算回表
+ */
+double ExecutionEngine::EstimateIndexScanCost(const TableStatistics& stats,
+                                              TableInfo* table_info,
+                                              PlanNode* plan) {
+    const Schema* schema = table_info->schema.get();
+    double selectivity = 1.0;
+    bool index_only = false;
+    if (plan->GetType() == PlanNodeType::INDEX_SCAN) {
+        auto* index_scan = static_cast<IndexScanPlanNode*>(plan);
+        IndexInfo* index_info = catalog_->GetIndex(index_scan->GetIndexName());
+        if (index_info == nullptr) {
+            return 0;
+        }
+        index_only = index_scan->IsIndexOnly();
+        for (const auto& key_column : index_info->key_columns) {
+            const Value* value =
+                FindEqualityConstant(index_scan->GetPredicate(), key_column);
+            if (value == nullptr) {
+                break;
+            }
+            size_t column = schema->GetColumnIdx(key_column);
+            if (column < stats.columns.size()) {
+                selectivity *=
+                    stats.columns[column].EstimateEqualSelectivity(*value);
+            }
+        }
+    } else if (plan->GetType() == PlanNodeType::INDEX_RANGE_SCAN) {
+        auto* range_scan = static_cast<IndexRangeScanPlanNode*>(plan);
+        IndexInfo* index_info = catalog_->GetIndex(range_scan->GetIndexName());
+        if (index_info == nullptr || index_info->key_columns.empty()) {
+            return 0;
+        }
+        size_t column = schema->GetColumnIdx(index_info->key_columns[0]);
+        if (column < stats.columns.size()) {
+            selectivity = stats.columns[column].EstimateRangeSelectivity(
+                range_scan->GetLowerBound(), range_scan->IsLowerInclusive(),
+                range_scan->GetUpperBound(), range_scan->IsUpperInclusive());
+        }
+    }
+    double matched_rows =
+        static_cast<double>(stats.row_count) * std::min(1.0, selectivity);
+    return CostModel::IndexScanCost(stats, matched_rows, index_only);
+}
+
+/**
+ * 估计位图扫描的代价
+ * 实现思路：
+ * 1. 等值查找的叶子：查找键各列的选择率相乘；范围叶子：用上下界估计
+ * 2. AND的选择率相乘，OR按 s1 + s2 - s1*s2 合并
+ * 3. 每个叶子取出的条目数累加起来算索引部分的代价，
+ *    合并后的选择率决定回表的行数
+ */
+double ExecutionEngine::EstimateBitmapScanCost(
+    const TableStatistics& stats, TableInfo* table_info,
+    const BitmapHeapScanPlanNode* plan) {
+    double index_entries = 0;
+    size_t index_lookups = 0;
+    double selectivity =
+        EstimateBitmapSelectivity(stats, table_info, plan->GetCondition(),
+                                  &index_entries, &index_lookups);
+    return CostModel::BitmapScanCost(
+        stats, index_entries, index_lookups,
+        static_cast<double>(stats.row_count) * selectivity);
+}
+
+double ExecutionEngine::EstimateBitmapSelectivity(
+    const TableStatistics& stats, TableInfo* table_info,
+    const BitmapIndexCondition& condition, double* index_entries,
+    size_t* index_lookups) {
+    using Kind = BitmapIndexCondition::Kind;
+    const Schema* schema = table_info->schema.get();
+    double selectivity = 1.0;
+    switch (condition.kind) {
+        case Kind::INDEX_LOOKUP:
+        case Kind::INDEX_RANGE: {
+            IndexInfo* index_info = catalog_->GetIndex(condition.index_name);
+            if (index_info == nullptr) {
+                break;
+            }
+            if (condition.kind == Kind::INDEX_LOOKUP) {
+                for (size_t i = 0; i < condition.key_values.size() &&
+                                   i < index_info->key_columns.size();
+                     i++) {
+                    size_t column =
+                        schema->GetColumnIdx(index_info->key_columns[i]);
+                    if (column < stats.columns.size()) {
+                        selectivity *=
+                            stats.columns[column].EstimateEqualSelectivity(
+                                *condition.key_values[i]);
                     }
-                    LOG_DEBUG("SelectBestIndex: No index found for column: "
-                              << column_name);
                 }
+            } else {
+                size_t column = schema->GetColumnIdx(index_info->key_columns[0]);
+                if (column < stats.columns.size()) {
+                    selectivity =
+                        stats.columns[column].EstimateRangeSelectivity(
+                            condition.lower.get(), condition.lower_inclusive,
+                            condition.upper.get(), condition.upper_inclusive);
+                }
+            }
+            selectivity = std::min(1.0, selectivity);
+            *index_entries += static_cast<double>(stats.row_count) * selectivity;
+            (*index_lookups)++;
+            break;
+        }
+        case Kind::AND:
+            for (const auto& child : condition.children) {
+                selectivity *= EstimateBitmapSelectivity(
+                    stats, table_info, child, index_entries, index_lookups);
+            }
+            break;
+        case Kind::OR:
+            selectivity = 0.0;
+            for (const auto& child : condition.children) {
+                double child_selectivity = EstimateBitmapSelectivity(
+                    stats, table_info, child, index_entries, index_lookups);
+                selectivity = selectivity + child_selectivity -
+                              selectivity * child_selectivity;
             }
+            break;
+    }
+    return selectivity;
+}
+
+/**
+ * ANALYZE/VACUUM处理的表
+ * 没有指定表时是所有表（分区子表也在里面），指定的是分区表时换成它的
+ * 各个分区；分区表自己的表堆一直是空的，由调用者跳过
+ */
+std::vector<std::string> ExecutionEngine::ExpandPartitionedTable(
+    const std::string& table_name) {
+    if (table_name.empty()) {
+        return catalog_->GetAllTableNames();
+    }
+    std::vector<std::string> table_names;
+    TableInfo* table_info = catalog_->GetTable(table_name);
+    if (table_info != nullptr && table_info->partition_scheme) {
+        for (TableInfo* partition : catalog_->GetPartitions(table_info)) {
+            table_names.push_back(partition->table_name);
+        }
+        return table_names;
+    }
+    table_names.push_back(table_name);
+    return table_names;
+}
+
+/**
+ * 处理ANALYZE命令
+ * 实现思路：扫描指定的表（没有表名时是所有表）收集统计信息，
+ * 整体替换catalog里原来的统计信息
+ */
+bool ExecutionEngine::HandleAnalyze(AnalyzeStatement* stmt) {
+    std::vector<std::string> table_names =
+        ExpandPartitionedTable(stmt->GetTableName());
+    for (const auto& table_name : table_names) {
+        TableInfo* table_info = catalog_->GetTable(table_name);
+        if (table_info == nullptr) {
+            LOG_ERROR("HandleAnalyze: Table '" << table_name
+                                               << "' not found in catalog");
+            return false;
+        }
+        // 统计信息从表堆收集，列存表没有可收集的，规划时按没有统计信息处理；
+        // 分区表的数据在分区里，统计信息按分区收集
+        if (table_info->storage == TableStorage::COLUMN ||
+            table_info->partition_scheme) {
+            continue;
         }
-        // TODO: 扩展支持其他操作符，如 <, >, <=, >= 等范围查询
-        else {
-            LOG_DEBUG("SelectBestIndex: Unsupported operator for index usage");
+        auto statistics = TableStatistics::Collect(
+            buffer_pool_manager_, table_info->table_heap.get(),
+            table_info->schema.get());
+        LOG_DEBUG("HandleAnalyze: Table " << table_name << " has "
+                                          << statistics->row_count
+                                          << " rows in "
+                                          << statistics->page_count
+                                          << " pages");
+        catalog_->SetTableStatistics(table_name, std::move(statistics));
+    }
+    return true;
+}
+
+/**
+ * 处理VACUUM命令
+ * 实现思路：逐个表加X锁（和这张表上的写事务以及SERIALIZABLE的扫描互斥），
+ * 再由TableManager整理页面、合并稀疏页面并维护索引；列存表只追加，跳过
+ */
+bool ExecutionEngine::HandleVacuum(VacuumStatement* stmt, Transaction* txn) {
+    if (txn != nullptr && txn->IsReadOnly()) {
+        LOG_ERROR("HandleVacuum: VACUUM in a read-only transaction");
+        return false;
+    }
+    std::vector<std::string> table_names =
+        ExpandPartitionedTable(stmt->GetTableName());
+    LockManager* lock_manager = txn_manager_->GetLockManager();
+    for (const auto& table_name : table_names) {
+        TableInfo* table_info = catalog_->GetTable(table_name);
+        if (table_info == nullptr) {
+            LOG_ERROR("HandleVacuum: Table '" << table_name
+                                              << "' not found in catalog");
+            return false;
+        }
+        if (table_info->storage == TableStorage::COLUMN ||
+            table_info->partition_scheme) {
+            continue;
+        }
+        if (lock_manager != nullptr && txn != nullptr &&
+            !lock_manager->LockTable(txn, table_info->table_oid,
+                                     LockMode::EXCLUSIVE)) {
+            LOG_ERROR("HandleVacuum: Lock conflict on table " << table_name);
+            return false;
+        }
+        txn_id_t txn_id = txn != nullptr ? txn->GetTxnId() : INVALID_TXN_ID;
+        if (!table_manager_->VacuumTable(table_name, txn_id)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 处理COPY命令
+ * 实现思路：导入加X锁，装载期间没有别的写事务，也不需要逐行加锁；
+ * 导出加S锁，等这张表上的写事务结束后读到的都是已提交的数据。
+ * 具体的读写由TableCopy完成，结果和UPDATE/DELETE一样返回一行行数
+ */
+bool ExecutionEngine::HandleCopy(CopyStatement* stmt,
+                                 std::vector<Tuple>* result_set,
+                                 Transaction* txn) {
+    if (stmt->IsFrom() && txn != nullptr && txn->IsReadOnly()) {
+        LOG_ERROR("HandleCopy: COPY FROM in a read-only transaction");
+        return false;
+    }
+    TableInfo* table_info = catalog_->GetTable(stmt->GetTableName());
+    if (table_info == nullptr) {
+        LOG_ERROR("HandleCopy: Table '" << stmt->GetTableName()
+                                        << "' not found in catalog");
+        return false;
+    }
+    if (table_info->partition_scheme) {
+        LOG_ERROR("HandleCopy: COPY is not supported on partitioned table "
+                  << stmt->GetTableName());
+        return false;
+    }
+    LockManager* lock_manager =
+        txn_manager_ != nullptr ? txn_manager_->GetLockManager() : nullptr;
+    LockMode mode = stmt->IsFrom() ? LockMode::EXCLUSIVE : LockMode::SHARED;
+    if (lock_manager != nullptr && txn != nullptr &&
+        !lock_manager->LockTable(txn, table_info->table_oid, mode)) {
+        LOG_ERROR("HandleCopy: Lock conflict on table "
+                  << stmt->GetTableName());
+        return false;
+    }
+    if (stmt->IsFrom()) {
+        // 导入中途失败时已经写进去的行可能留下，先记下表被修改了
+        catalog_->BumpModificationCount(table_info);
+        if (txn != nullptr) {
+            txn->AddModifiedTable(table_info->table_oid);
         }
     }
-    // 处理AND复合条件，递归查找可用索引
-    else if (auto* and_expr = dynamic_cast<BinaryOpExpression*>(where_clause)) {
-        if (and_expr->GetOperator() == BinaryOpExpression::OpType::AND) {
-            // 递归检查左右子表达式，优先使用左侧找到的索引
-            std::string left_index =
-                SelectBestIndex(table_name, and_expr->GetLeft());
-            if (!left_index.empty()) {
-                return left_index;
+
+    TableCopy::Options options;
+    options.format = stmt->GetFormat();
+    options.delimiter = stmt->GetDelimiter();
+    options.header = stmt->HasHeader();
+    TableCopy copy(buffer_pool_manager_, table_info, table_manager_.get(),
+                   options);
+    size_t row_count = stmt->IsFrom()
+                           ? copy.CopyFrom(stmt->GetFilePath(), txn)
+                           : copy.CopyTo(stmt->GetFilePath());
+
+    Schema result_schema({{"affected_rows", TypeId::INTEGER, 0, false, false}});
+    result_set->emplace_back(
+        std::vector<Value>{Value(static_cast<int32_t>(row_count))},
+        &result_schema);
+    return true;
+}
+
+std::shared_ptr<PreparedStatement> ExecutionEngine::GetPreparedStatement(
+    const std::string& name) {
+    std::lock_guard<std::mutex> lock(prepared_mutex_);
+    auto it = prepared_statements_.find(name);
+    if (it == prepared_statements_.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+/**
+ * 处理PREPARE命令
+ * 语句在解析时已经检查过，这里只按名字登记，计划推迟到第一次EXECUTE生成
+ */
+bool ExecutionEngine::HandlePrepare(PrepareStatement* stmt) {
+    std::lock_guard<std::mutex> lock(prepared_mutex_);
+    if (prepared_statements_.count(stmt->GetName()) > 0) {
+        LOG_ERROR("HandlePrepare: Prepared statement '" << stmt->GetName()
+                                                        << "' already exists");
+        return false;
+    }
+    prepared_statements_[stmt->GetName()] =
+        std::make_shared<PreparedStatement>(stmt->ReleaseStatement(),
+                                            stmt->GetParameters());
+    return true;
+}
+
+/**
+ * 执行预编译语句
+ * 可缓存的计划在生成之前读取catalog版本，生成期间发生的DDL
+ * 会让下一次执行再生成一次；复制出来的计划和缓存的计划共享参数槽位，
+ * 读到的是本次绑定的值
+ */
+bool ExecutionEngine::ExecutePrepared(PreparedStatement* prepared,
+                                      const std::vector<Value>& arguments,
+                                      std::vector<Tuple>* result_set,
+                                      Transaction* txn, ResultSink* sink) {
+    CheckDatabaseWritable(buffer_pool_manager_, replica_,
+                          prepared->GetStatement());
+    QueryArena::Scope arena_scope;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::lock_guard<std::mutex> lock(prepared->GetMutex());
+    std::string error;
+    if (!prepared->Bind(arguments, &error)) {
+        LOG_ERROR("ExecutePrepared: Cannot bind parameters: " << error);
+        return false;
+    }
+
+    std::unique_ptr<PlanNode> plan;
+    if (prepared->IsPlanCacheable()) {
+        uint64_t schema_version = catalog_->GetSchemaVersion();
+        const PlanNode* cached = prepared->GetCachedPlan(schema_version);
+        if (cached == nullptr) {
+            // 缓存的计划活得比这次查询长，不能放进QueryArena
+            std::unique_ptr<PlanNode> new_plan;
+            {
+                QueryArena::Suspend heap_allocation;
+                new_plan = CreatePlan(prepared->GetStatement());
             }
-            std::string right_index =
-                SelectBestIndex(table_name, and_expr->GetRight());
-            if (!right_index.empty()) {
-                return right_index;
+            if (!new_plan) {
+                LOG_ERROR("ExecutePrepared: Failed to create plan");
+                return false;
             }
+            prepared->SetCachedPlan(std::move(new_plan), schema_version);
+            cached = prepared->GetCachedPlan(schema_version);
         }
+        plan = CopyPlan(cached);
+    } else {
+        plan = CreatePlan(prepared->GetStatement());
+    }
+    if (!plan) {
+        LOG_ERROR("ExecutePrepared: Failed to create plan");
+        return false;
+    }
+
+    prepared->IncrementExecuteCount();
+    int tuple_count = 0;
+    if (!RunPlan(std::move(plan), result_set, txn, &tuple_count, sink)) {
+        return false;
     }
 
-    LOG_DEBUG("SelectBestIndex: No suitable index found for the WHERE clause");
-    return "";
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+    STATS.RecordQueryExecution("EXECUTE", duration.count() / 1000.0,
+                               tuple_count);
+    return true;
+}
+
+bool ExecutionEngine::HandleDeallocate(DeallocateStatement* stmt) {
+    std::lock_guard<std::mutex> lock(prepared_mutex_);
+    if (prepared_statements_.erase(stmt->GetName()) == 0) {
+        LOG_ERROR("HandleDeallocate: Prepared statement '"
+                  << stmt->GetName() << "' does not exist");
+        return false;
+    }
+    return true;
 }
 
 /**
@@ -668,7 +3037,9 @@ bool ExecutionEngine::HandleShowTables(std::vector<Tuple>* result_set) {
         // 为每个表的每个列创建一条记录
         for (const std::string& table_name : table_names) {
             TableInfo* table_info = catalog_->GetTable(table_name);
-            if (!table_info || !table_info->schema) {
+            // 分区子表是分区表的内部实现，只显示分区表
+            if (!table_info || !table_info->schema ||
+                !table_info->parent_table.empty()) {
                 continue;
             }
 
@@ -742,12 +3113,16 @@ bool ExecutionEngine::HandleRollback(Transaction* txn) {
 
 /**
  * 处理EXPLAIN命令，显示SQL语句的执行计划
+ * EXPLAIN ANALYZE会真正执行语句（INSERT/UPDATE/DELETE的修改也会生效），
+ * 显示的是执行器树和每个执行器的运行数据
  * @param stmt EXPLAIN语句
  * @param result_set 用于存储执行计划的结果集
+ * @param txn 执行EXPLAIN ANALYZE用的事务
  * @return 执行是否成功
  */
 bool ExecutionEngine::HandleExplain(ExplainStatement* stmt,
-                                    std::vector<Tuple>* result_set) {
+                                    std::vector<Tuple>* result_set,
+                                    Transaction* txn) {
     // 获取要分析的内部SQL语句
     Statement* inner_stmt = stmt->GetStatement();
 
@@ -759,7 +3134,12 @@ bool ExecutionEngine::HandleExplain(ExplainStatement* stmt,
     }
 
     // 将执行计划格式化为可读的文本
-    std::string plan_text = FormatExecutionPlan(plan.get());
+    std::string plan_text;
+    if (!stmt->IsAnalyze()) {
+        plan_text = FormatExecutionPlan(plan.get());
+    } else if (!RunExplainAnalyze(std::move(plan), txn, &plan_text)) {
+        return false;
+    }
 
     // 创建结果schema，只包含一个字符串列用于显示计划
     std::vector<Column> columns = {
@@ -778,25 +3158,176 @@ bool ExecutionEngine::HandleExplain(ExplainStatement* stmt,
     return true;
 }
 
+/**
+ * 执行EXPLAIN ANALYZE
+ * 实现思路：
+ * 1. 上下文装上QueryProfiler，根执行器和之后创建的子执行器都被包装，
+ *    各自记录行数、耗时和本线程的I/O计数
+ * 2. 和RunPlan一样按批或者按行取完所有结果，结果直接丢弃
+ * 3. 按收集到的执行器树格式化，最后一行是总的执行时间
+ */
+bool ExecutionEngine::RunExplainAnalyze(std::unique_ptr<PlanNode> plan,
+                                        Transaction* txn,
+                                        std::string* plan_text) {
+    QueryProfiler profiler;
+    ExecutorContext exec_ctx(txn, catalog_, buffer_pool_manager_,
+                             table_manager_.get());
+    if (txn_manager_ != nullptr) {
+        exec_ctx.SetLockManager(txn_manager_->GetLockManager());
+    }
+    exec_ctx.SetProfiler(&profiler);
+    exec_ctx.SetCancellationToken(CancellationToken::Current());
+    exec_ctx.SetMemoryTracker(MemoryTracker::Current());
+
+    auto start_time = std::chrono::steady_clock::now();
+    try {
+        const PlanNode* raw_plan = plan.get();
+        auto executor = WrapForProfiling(
+            &exec_ctx, raw_plan, CreateExecutor(&exec_ctx, std::move(plan)));
+        if (!executor) {
+            LOG_ERROR("RunExplainAnalyze: Failed to create executor");
+            return false;
+        }
+        executor->Init();
+        if (executor->IsVectorized()) {
+            VectorBatch batch;
+            while (executor->NextBatch(&batch)) {
+            }
+        } else {
+            Tuple tuple;
+            RID rid;
+            while (executor->Next(&tuple, &rid)) {
+            }
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_time);
+
+        // 执行器树（以及它持有的计划）还活着，格式化完才能销毁
+        std::ostringstream oss;
+        oss << FormatAnalyzedPlan(profiler.GetRoot());
+        oss << "Execution Time: " << std::fixed << std::setprecision(3)
+            << elapsed.count() / 1000.0 << " ms\n";
+        *plan_text = oss.str();
+    } catch (const std::exception& e) {
+        LOG_ERROR("RunExplainAnalyze: Exception during execution: "
+                  << e.what());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * 格式化EXPLAIN ANALYZE的结果
+ * 时间和I/O包含子执行器的部分；INSERT这样在Init里完成所有工作的执行器
+ * 耗时主要算在init里
+ */
+std::string ExecutionEngine::FormatAnalyzedPlan(const OperatorProfile* profile,
+                                                int indent) {
+    if (profile == nullptr) {
+        return "";
+    }
+    std::ostringstream oss;
+    for (int i = 0; i < indent; i++) {
+        oss << "  ";
+    }
+    oss << DescribePlanNode(profile->plan) << " (actual rows=" << profile->rows
+        << " loops=" << profile->loops << ")" << std::fixed
+        << std::setprecision(3)
+        << " (time: init=" << profile->init_ns / 1e6
+        << " ms next=" << profile->next_ns / 1e6 << " ms)"
+        << " (buffers: hit=" << profile->io.buffer_hits
+        << " miss=" << profile->io.buffer_misses
+        << " disk reads=" << profile->io.disk_reads << ")"
+        << " (lock waits=" << profile->io.lock_waits << " "
+        << profile->io.lock_wait_ms << " ms)\n";
+    for (const OperatorProfile* child : profile->children) {
+        oss << FormatAnalyzedPlan(child, indent + 1);
+    }
+    return oss.str();
+}
+
+void ExecutionEngine::CapturePlan(const Executor* executor,
+                                  int tuple_count) {
+    PlanCapture* capture = PlanCapture::Current();
+    if (capture == nullptr) {
+        return;
+    }
+    capture->rows_returned_ += static_cast<uint64_t>(tuple_count);
+    const PlanNode* plan = executor->GetPlanNode();
+    if (plan == nullptr || !capture->ShouldCapturePlan()) {
+        return;
+    }
+    // 在析构路径上调用，格式化失败只是丢掉计划
+    try {
+        capture->plan_text_ = FormatExecutionPlan(plan);
+    } catch (const std::exception& e) {
+        LOG_WARN("CapturePlan: Cannot format plan: " << e.what());
+    }
+}
+
 /**
  * 格式化执行计划为树状结构的文本
  * @param plan 执行计划节点
  * @param indent 缩进级别
  * @return 格式化后的执行计划文本
  */
-std::string ExecutionEngine::FormatExecutionPlan(PlanNode* plan, int indent) {
+std::string ExecutionEngine::FormatExecutionPlan(const PlanNode* plan,
+                                                 int indent) {
     std::ostringstream oss;
 
     // 添加缩进，形成树状结构
     for (int i = 0; i < indent; i++) {
         oss << "  ";
     }
-    oss << "-> " << GetPlanNodeTypeString(plan->GetType());
+    oss << DescribePlanNode(plan) << "\n";
+
+    // 递归格式化子计划节点
+    const auto& children = plan->GetChildren();
+    for (const auto& child : children) {
+        oss << FormatExecutionPlan(child.get(), indent + 1);
+    }
+    return oss.str();
+}
+
+/**
+ * 位图条件树的描述，叶子写索引名，比如 idx_a AND (idx_b OR idx_c)
+ */
+static std::string DescribeBitmapCondition(
+    const BitmapIndexCondition& condition) {
+    if (condition.children.empty()) {
+        return condition.index_name;
+    }
+    const char* separator =
+        condition.kind == BitmapIndexCondition::Kind::AND ? " AND " : " OR ";
+    std::string result;
+    for (size_t i = 0; i < condition.children.size(); i++) {
+        const auto& child = condition.children[i];
+        std::string text = DescribeBitmapCondition(child);
+        if (!child.children.empty()) {
+            text = "(" + text + ")";
+        }
+        result += (i == 0 ? "" : separator) + text;
+    }
+    return result;
+}
+
+/**
+ * 一个计划节点的描述：节点类型、访问的表和索引、条件，
+ * 有代价估计时带上估计的行数和代价
+ */
+std::string ExecutionEngine::DescribePlanNode(const PlanNode* plan) {
+    std::ostringstream oss;
+    bool index_only =
+        plan->GetType() == PlanNodeType::INDEX_SCAN &&
+        static_cast<const IndexScanPlanNode*>(plan)->IsIndexOnly();
+    oss << "-> "
+        << (index_only ? "Index Only Scan"
+                       : GetPlanNodeTypeString(plan->GetType()));
 
     // 根据计划节点类型添加具体信息
     switch (plan->GetType()) {
         case PlanNodeType::SEQUENTIAL_SCAN: {
-            auto* seq_scan = static_cast<SeqScanPlanNode*>(plan);
+            auto* seq_scan = static_cast<const SeqScanPlanNode*>(plan);
             oss << " on " << seq_scan->GetTableName();
             if (seq_scan->GetPredicate()) {
                 oss << " (Filter: WHERE clause)";
@@ -804,7 +3335,7 @@ std::string ExecutionEngine::FormatExecutionPlan(PlanNode* plan, int indent) {
             break;
         }
         case PlanNodeType::INDEX_SCAN: {
-            auto* index_scan = static_cast<IndexScanPlanNode*>(plan);
+            auto* index_scan = static_cast<const IndexScanPlanNode*>(plan);
             oss << " using " << index_scan->GetIndexName() << " on "
                 << index_scan->GetTableName();
             if (index_scan->GetPredicate()) {
@@ -812,14 +3343,35 @@ std::string ExecutionEngine::FormatExecutionPlan(PlanNode* plan, int indent) {
             }
             break;
         }
+        case PlanNodeType::INDEX_RANGE_SCAN: {
+            auto* range_scan = static_cast<const IndexRangeScanPlanNode*>(plan);
+            oss << " using " << range_scan->GetIndexName() << " on "
+                << range_scan->GetTableName() << " (Index Range: "
+                << (range_scan->GetLowerBound() == nullptr
+                        ? "unbounded"
+                        : (range_scan->IsLowerInclusive() ? ">=" : ">"))
+                << " .. "
+                << (range_scan->GetUpperBound() == nullptr
+                        ? "unbounded"
+                        : (range_scan->IsUpperInclusive() ? "<=" : "<"))
+                << ")";
+            break;
+        }
+        case PlanNodeType::BITMAP_HEAP_SCAN: {
+            auto* bitmap_scan = static_cast<const BitmapHeapScanPlanNode*>(plan);
+            oss << " on " << bitmap_scan->GetTableName() << " (Bitmap Cond: "
+                << DescribeBitmapCondition(bitmap_scan->GetCondition())
+                << ")";
+            break;
+        }
         case PlanNodeType::INSERT: {
-            auto* insert_plan = static_cast<InsertPlanNode*>(plan);
+            auto* insert_plan = static_cast<const InsertPlanNode*>(plan);
             oss << " into " << insert_plan->GetTableName();
             oss << " (" << insert_plan->GetValues().size() << " rows)";
             break;
         }
         case PlanNodeType::UPDATE: {
-            auto* update_plan = static_cast<UpdatePlanNode*>(plan);
+            auto* update_plan = static_cast<const UpdatePlanNode*>(plan);
             oss << " on " << update_plan->GetTableName();
             if (update_plan->GetPredicate()) {
                 oss << " (Filter: WHERE clause)";
@@ -827,27 +3379,107 @@ std::string ExecutionEngine::FormatExecutionPlan(PlanNode* plan, int indent) {
             break;
         }
         case PlanNodeType::DELETE: {
-            auto* delete_plan = static_cast<DeletePlanNode*>(plan);
+            auto* delete_plan = static_cast<const DeletePlanNode*>(plan);
             oss << " from " << delete_plan->GetTableName();
             if (delete_plan->GetPredicate()) {
                 oss << " (Filter: WHERE clause)";
             }
             break;
         }
+        case PlanNodeType::HASH_JOIN: {
+            auto* join_plan = static_cast<const HashJoinPlanNode*>(plan);
+            auto* left_key =
+                dynamic_cast<ColumnRefExpression*>(join_plan->GetLeftKey());
+            auto* right_key =
+                dynamic_cast<ColumnRefExpression*>(join_plan->GetRightKey());
+            if (left_key && right_key) {
+                oss << " (Hash Cond: " << left_key->GetTableName() << "."
+                    << left_key->GetColumnName() << " = "
+                    << right_key->GetTableName() << "."
+                    << right_key->GetColumnName() << ")";
+            } else {
+                oss << " (Hash Cond: join key)";
+            }
+            if (join_plan->GetPredicate()) {
+                oss << " (Join Filter: residual condition)";
+            }
+            break;
+        }
+        case PlanNodeType::INDEX_NESTED_LOOP_JOIN: {
+            auto* join_plan = static_cast<const IndexNestedLoopJoinPlanNode*>(plan);
+            oss << " using " << join_plan->GetIndexName() << " on "
+                << join_plan->GetInnerTableName() << " (Index Cond: "
+                << join_plan->GetInnerTableName() << "."
+                << join_plan->GetInnerKeyColumn() << " = outer key)";
+            if (join_plan->GetInnerPredicate()) {
+                oss << " (Filter: inner condition)";
+            }
+            if (join_plan->GetPredicate()) {
+                oss << " (Join Filter: residual condition)";
+            }
+            break;
+        }
+        case PlanNodeType::AGGREGATION: {
+            auto* aggregation_plan = static_cast<const AggregationPlanNode*>(plan);
+            const auto& group_by = aggregation_plan->GetGroupBy();
+            if (!group_by.empty()) {
+                oss << " (Group Key: ";
+                for (size_t i = 0; i < group_by.size(); i++) {
+                    oss << (i > 0 ? ", " : "")
+                        << ExpressionToString(group_by[i].get());
+                }
+                oss << ")";
+            }
+            oss << " (" << aggregation_plan->GetAggregates().size()
+                << " aggregates)";
+            break;
+        }
+        case PlanNodeType::SORT: {
+            auto* sort_plan = static_cast<const SortPlanNode*>(plan);
+            oss << " (Sort Key: ";
+            const auto& keys = sort_plan->GetKeys();
+            for (size_t i = 0; i < keys.size(); i++) {
+                oss << (i > 0 ? ", " : "")
+                    << ExpressionToString(keys[i].expression.get())
+                    << (keys[i].ascending ? "" : " DESC");
+            }
+            oss << ")";
+            if (sort_plan->HasLimit()) {
+                oss << " (Top-N: " << sort_plan->GetLimit() << ")";
+            }
+            break;
+        }
+        case PlanNodeType::LIMIT: {
+            auto* limit_plan = static_cast<const LimitPlanNode*>(plan);
+            oss << " (" << limit_plan->GetLimit() << " rows)";
+            break;
+        }
+        case PlanNodeType::GATHER: {
+            auto* gather_plan = static_cast<const GatherPlanNode*>(plan);
+            oss << " (" << gather_plan->GetWorkers() << " workers)";
+            break;
+        }
+        case PlanNodeType::APPEND: {
+            auto* append_plan = static_cast<const AppendPlanNode*>(plan);
+            oss << " (" << append_plan->GetChildren().size() << " partitions";
+            if (append_plan->GetWorkers() > 1) {
+                oss << ", " << append_plan->GetWorkers() << " workers";
+            }
+            oss << ")";
+            break;
+        }
         case PlanNodeType::PROJECTION: {
-            auto* proj_plan = static_cast<ProjectionPlanNode*>(plan);
+            auto* proj_plan = static_cast<const ProjectionPlanNode*>(plan);
             oss << " (" << proj_plan->GetExpressions().size() << " columns)";
             break;
         }
         default:
             break;
     }
-    oss << "\n";
-
-    // 递归格式化子计划节点
-    const auto& children = plan->GetChildren();
-    for (const auto& child : children) {
-        oss << FormatExecutionPlan(child.get(), indent + 1);
+    if (plan->GetEstimatedRows() >= 0) {
+        oss << " (Rows: " << static_cast<size_t>(plan->GetEstimatedRows() + 0.5)
+            << ", Cost: " << std::fixed << std::setprecision(2)
+            << plan->GetEstimatedCost() << ")";
     }
     return oss.str();
 }
@@ -863,6 +3495,10 @@ std::string ExecutionEngine::GetPlanNodeTypeString(PlanNodeType type) {
             return "Seq Scan";
         case PlanNodeType::INDEX_SCAN:
             return "Index Scan";
+        case PlanNodeType::INDEX_RANGE_SCAN:
+            return "Index Range Scan";
+        case PlanNodeType::BITMAP_HEAP_SCAN:
+            return "Bitmap Heap Scan";
         case PlanNodeType::INSERT:
             return "Insert";
         case PlanNodeType::UPDATE:
@@ -877,12 +3513,18 @@ std::string ExecutionEngine::GetPlanNodeTypeString(PlanNodeType type) {
             return "Nested Loop Join";
         case PlanNodeType::HASH_JOIN:
             return "Hash Join";
+        case PlanNodeType::INDEX_NESTED_LOOP_JOIN:
+            return "Index Nested Loop Join";
         case PlanNodeType::AGGREGATION:
             return "Aggregation";
         case PlanNodeType::SORT:
             return "Sort";
         case PlanNodeType::LIMIT:
             return "Limit";
+        case PlanNodeType::GATHER:
+            return "Gather";
+        case PlanNodeType::APPEND:
+            return "Append";
         default:
             return "Unknown";
     }
@@ -8,13 +8,21 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
 #include "catalog/table_manager.h"
 #include "execution/executor.h"
+#include "execution/prepared_statement.h"
+#include "execution/result_sink.h"
 #include "parser/ast.h"
 #include "transaction/transaction_manager.h"
 
@@ -25,6 +33,53 @@ class UpdateStatement;
 class DeleteStatement;
 class UpdatePlanNode;
 class DeletePlanNode;
+struct OperatorProfile;
+
+/**
+ * PlanCapture - 一次查询执行期间记下执行计划和返回的行数，给慢查询日志用
+ *
+ * 设计思路：
+ * - 和QueryArena一样是线程局部的"当前对象"，服务器在处理一条查询时装上，
+ *   执行引擎不用改接口就能把信息交回去
+ * - 执行器析构之前（计划还在）检查一次：要求总是记录，或者从装上到现在
+ *   已经超过min_elapsed_ms，才把计划格式化成文本，快的查询不付这个代价
+ * - 一条语句执行多个计划时行数累加，计划取最后执行完的那个
+ */
+class PlanCapture {
+   public:
+    /**
+     * 装成当前线程的捕获对象，析构时换回原来的
+     * @param capture_always 不管快慢都记录计划
+     * @param min_elapsed_ms 执行到这么久以后才需要记录计划
+     */
+    PlanCapture(bool capture_always, double min_elapsed_ms);
+    ~PlanCapture();
+
+    PlanCapture(const PlanCapture&) = delete;
+    PlanCapture& operator=(const PlanCapture&) = delete;
+
+    /** 当前线程的捕获对象，没有时返回nullptr */
+    static PlanCapture* Current();
+
+    /** 格式化好的计划，没有记录时为空 */
+    const std::string& GetPlanText() const { return plan_text_; }
+
+    /** 计划产生的行数 */
+    uint64_t GetRowsReturned() const { return rows_returned_; }
+
+   private:
+    friend class ExecutionEngine;
+
+    /** 计划执行完、执行器析构之前由执行引擎调用 */
+    bool ShouldCapturePlan() const;
+
+    bool capture_always_;
+    double min_elapsed_ms_;
+    std::chrono::steady_clock::time_point start_;
+    std::string plan_text_;
+    uint64_t rows_returned_ = 0;
+    PlanCapture* previous_;
+};
 
 /**
  * SQL执行引擎类
@@ -40,7 +95,8 @@ class DeletePlanNode;
  * - DDL: CREATE TABLE/INDEX, DROP TABLE/INDEX
  * - DML: SELECT, INSERT, UPDATE, DELETE
  * - 事务控制: BEGIN, COMMIT, ROLLBACK
- * - 管理命令: SHOW TABLES, EXPLAIN
+ * - 管理命令: SHOW TABLES, EXPLAIN, ANALYZE
+ * - 预编译语句: PREPARE, EXECUTE, DEALLOCATE
  */
 class ExecutionEngine {
    public:
@@ -67,10 +123,62 @@ class ExecutionEngine {
      * @param statement 解析后的SQL语句AST节点
      * @param result_set 用于存储查询结果的向量
      * @param txn 当前事务上下文
+     * @param sink 不为空时执行计划产生的行分块交给它，不再放进result_set
      * @return 执行是否成功
      */
     bool Execute(Statement* statement, std::vector<Tuple>* result_set,
-                 Transaction* txn);
+                 Transaction* txn, ResultSink* sink = nullptr);
+
+    /**
+     * 设置单表顺序扫描的并行度
+     * @param workers 工作线程数，大于1时顺序扫描按页面分给多个线程并行执行，
+     *        结果不保证顺序；1表示串行扫描
+     */
+    void SetParallelScanWorkers(size_t workers) {
+        parallel_scan_workers_ = workers;
+    }
+
+    /**
+     * 标记为WAL复制的只读副本，之后所有修改数据的语句都被拒绝，
+     * 数据只能由ReplicaApplier重放主库的日志来修改
+     */
+    void SetReplica(bool replica) { replica_ = replica; }
+
+    /** 是否是只读副本 */
+    bool IsReplica() const { return replica_; }
+
+    /** 表管理器，副本重放日志时用它维护索引 */
+    TableManager* GetTableManager() { return table_manager_.get(); }
+
+    /**
+     * 按名字查找预编译语句
+     * @return 不存在时返回nullptr
+     */
+    std::shared_ptr<PreparedStatement> GetPreparedStatement(
+        const std::string& name);
+
+    /**
+     * 绑定参数后执行预编译语句
+     *
+     * 实现思路：
+     * 1. 持有预编译语句的锁，把参数写进槽位
+     * 2. 计划可缓存时看缓存是否对应当前的catalog版本，不对应就重新生成；
+     *    执行器会接管计划，所以每次执行复制一份缓存的计划
+     * 3. INSERT每次重新生成计划
+     *
+     * EXECUTE语句和查询处理器的计划缓存都走这里，预编译语句不需要登记过名字
+     *
+     * @param prepared 预编译语句
+     * @param arguments 按 $1、$2 ... 顺序的参数值
+     * @param result_set 用于存储查询结果的向量
+     * @param txn 当前事务上下文
+     * @param sink 不为空时结果分块交给它，见Execute
+     * @return 参数个数不对或者执行失败时返回false
+     */
+    bool ExecutePrepared(PreparedStatement* prepared,
+                         const std::vector<Value>& arguments,
+                         std::vector<Tuple>* result_set, Transaction* txn,
+                         ResultSink* sink = nullptr);
 
    private:
     // ============ 核心组件依赖 ============
@@ -79,6 +187,13 @@ class ExecutionEngine {
     TransactionManager* txn_manager_;              // 事务管理器，处理并发控制
     LogManager* log_manager_;                      // 日志管理器，用于恢复
     std::unique_ptr<TableManager> table_manager_;  // 表管理器，封装表相关操作
+    size_t parallel_scan_workers_ = PARALLEL_SCAN_WORKERS;  // 顺序扫描的并行度
+    std::atomic<bool> replica_{false};  // 只读副本，拒绝所有写语句
+
+    // 预编译语句，按名字在整个引擎范围内共享
+    std::unordered_map<std::string, std::shared_ptr<PreparedStatement>>
+        prepared_statements_;
+    std::mutex prepared_mutex_;  // 保护prepared_statements_
 
     // ============ 查询优化相关方法 ============
 
@@ -87,17 +202,169 @@ class ExecutionEngine {
      *
      * 当前支持的优化策略：
      * - 等值查询：WHERE column = value 形式可以使用索引
-     * - AND条件：递归分析左右子表达式
-     * - 单列索引：优先选择匹配度最高的单列索引
+     * - AND条件：收集所有AND分支上的等值列
+     * - 多列索引：从第一列开始连续命中等值条件的列数最多的索引胜出，
+     *   比如 a = 1 AND b = 2 优先选 (a, b) 上的索引而不是 (a) 上的
      *
-     * TODO: 扩展支持范围查询、复合索引、OR条件等
+     * - 覆盖索引：匹配的列数相同时，优先选包含查询所有列的B+树索引，
+     *   可以只读索引不回表
+     *
+     * 范围查询由CreateIndexRangeScanPlan处理
+     * TODO: 扩展支持OR条件等
      *
      * @param table_name 表名
      * @param where_clause WHERE条件表达式
+     * @param needed_columns 查询用到的所有列，nullptr表示不考虑覆盖索引
      * @return 选中的索引名，无合适索引则返回空字符串
      */
-    std::string SelectBestIndex(const std::string& table_name,
-                                Expression* where_clause);
+    std::string SelectBestIndex(
+        const std::string& table_name, Expression* where_clause,
+        const std::unordered_set<std::string>* needed_columns = nullptr);
+
+    /**
+     * 收集表达式里引用的所有列名
+     *
+     * @param expr 表达式，nullptr时什么也不做
+     * @param columns 输出参数，收集到的列名
+     * @return 遇到不认识的表达式或者*返回false，
+     *         这时用到的列不确定，不能只读索引
+     */
+    static bool CollectReferencedColumns(
+        Expression* expr, std::unordered_set<std::string>* columns);
+
+    /**
+     * 索引是否包含查询用到的所有列
+     * 只有B+树索引能取回列值，哈希索引总是返回false
+     */
+    static bool IndexCoversColumns(
+        const IndexInfo& index_info,
+        const std::unordered_set<std::string>& columns);
+
+    /**
+     * 沿AND条件收集 column = 常量（或 常量 = column）中的列名
+     *
+     * @param expr 条件表达式
+     * @param columns 输出参数，收集到的列名
+     */
+    static void CollectEqualityColumns(Expression* expr,
+                                       std::unordered_set<std::string>* columns);
+
+    /**
+     * 范围查询的索引选择：在WHERE的AND条件里找单列索引上的
+     * <、<=、>、>=（BETWEEN在解析时已经展开成 >= AND <=），
+     * 提取出上下界生成索引范围扫描计划
+     *
+     * @param table_info 目标表
+     * @param where_clause WHERE条件表达式
+     * @return 索引范围扫描计划，无合适索引则返回nullptr
+     */
+    std::unique_ptr<PlanNode> CreateIndexRangeScanPlan(
+        TableInfo* table_info, Expression* where_clause);
+
+    /**
+     * 生成位图扫描计划
+     * WHERE的AND条件里有几个条件分别能用不同的索引，或者OR的每一支都能
+     * 用索引时，把它们组成条件树，RID在位图里取交集/并集后按页面顺序回表
+     *
+     * @param table_info 目标表
+     * @param where_clause WHERE条件表达式
+     * @return 位图扫描计划，用到的索引查找少于两次时返回nullptr
+     */
+    std::unique_ptr<PlanNode> CreateBitmapScanPlan(TableInfo* table_info,
+                                                   Expression* where_clause);
+
+    /**
+     * 把一个条件换成位图扫描的条件树
+     * AND里用不上索引的条件直接忽略（回表后会再过滤），OR的每一支都必须
+     * 能用索引，否则整个OR用不上
+     *
+     * @param table_info 目标表
+     * @param expr 条件表达式
+     * @param condition 输出条件树
+     * @return 条件用不上任何索引时返回false
+     */
+    bool BuildBitmapCondition(TableInfo* table_info, Expression* expr,
+                              BitmapIndexCondition* condition);
+
+    /**
+     * 按统计信息估计位图扫描的代价
+     * 每个叶子的命中行数按它的索引条件估计，AND/OR按CostModel的规则合并
+     * 选择率，回表的行数由合并后的选择率决定
+     */
+    double EstimateBitmapScanCost(const TableStatistics& stats,
+                                  TableInfo* table_info,
+                                  const BitmapHeapScanPlanNode* plan);
+
+    /**
+     * 位图条件树的选择率
+     * @param index_entries 累加所有叶子从索引取出的条目数
+     * @param index_lookups 累加叶子的个数
+     */
+    double EstimateBitmapSelectivity(const TableStatistics& stats,
+                                     TableInfo* table_info,
+                                     const BitmapIndexCondition& condition,
+                                     double* index_entries,
+                                     size_t* index_lookups);
+
+    /**
+     * 为一张表选择扫描方式：等值索引扫描、索引范围扫描或者顺序扫描，
+     * ANALYZE过的表按代价在索引扫描和顺序扫描之间选择
+     *
+     * @param table_info 目标表（分区表的一个分区，或者普通表）
+     * @param where_clause WHERE条件表达式，可以为空
+     * @param needed_columns 查询用到的所有列，索引包含它们时只读索引；
+     *        不知道时传nullptr
+     * @return 扫描计划，输出表的所有列
+     */
+    std::unique_ptr<PlanNode> CreateScanPlan(
+        TableInfo* table_info, Expression* where_clause,
+        const std::unordered_set<std::string>* needed_columns);
+
+    /**
+     * 分区表的扫描
+     *
+     * 按WHERE条件裁剪分区，每个剩下的分区用CreateScanPlan选择自己的
+     * 扫描方式（各个分区有自己的索引和统计信息）；只剩一个分区时直接
+     * 返回它的扫描计划，否则用AppendPlanNode拼起来，开启并行扫描时
+     * 各个分区由工作线程并行扫描
+     *
+     * @return 扫描计划，分区子表找不到时返回nullptr
+     */
+    std::unique_ptr<PlanNode> CreatePartitionedScanPlan(
+        TableInfo* table_info, Expression* where_clause,
+        const std::unordered_set<std::string>* needed_columns);
+
+    /**
+     * 分区表上可能有满足WHERE条件的行的分区
+     * 条件只裁剪不证明：不认识的条件保留所有分区
+     * @return 分区序号，按顺序排列
+     */
+    std::vector<size_t> SelectPartitions(TableInfo* table_info,
+                                         Expression* where_clause);
+
+    /**
+     * 把AND条件中 column op 常量 形式的比较收紧到计划的上下界上
+     * 同一侧有多个边界时保留更紧的那个，类型不同无法比较时保留先出现的
+     *
+     * @param expr 条件表达式
+     * @param column 索引列名
+     * @param plan 写入边界的范围扫描计划
+     */
+    static void CollectRangeBounds(Expression* expr, const std::string& column,
+                                   IndexRangeScanPlanNode* plan);
+
+    /**
+     * 按统计信息估计索引扫描（等值或范围）的代价
+     * 等值扫描按从第一列开始连续有等值条件的键列估计命中行数，
+     * 范围扫描按索引列上的上下界估计
+     *
+     * @param stats 表的统计信息
+     * @param table_info 目标表
+     * @param plan 索引扫描或索引范围扫描计划
+     * @return 估计的代价，和CostModel::SeqScanCost可比
+     */
+    double EstimateIndexScanCost(const TableStatistics& stats,
+                                 TableInfo* table_info, PlanNode* plan);
 
     // ============ 执行计划生成方法 ============
 
@@ -108,12 +375,19 @@ class ExecutionEngine {
      */
     std::unique_ptr<PlanNode> CreatePlan(Statement* statement);
 
+    /**
+     * 把计划树里访问的表和索引绑定到节点上
+     * @param schema_version 开始生成计划之前读到的catalog版本
+     */
+    void BindPlan(PlanNode* plan, uint64_t schema_version);
+
     /**
      * 执行器工厂方法：根据执行计划创建对应的执行器
      *
      * 支持的执行器类型：
      * - SeqScanExecutor: 顺序扫描
      * - IndexScanExecutor: 索引扫描
+     * - IndexRangeScanExecutor: 索引范围扫描
      * - ProjectionExecutor: 投影操作
      * - InsertExecutor: 插入操作
      * - UpdateExecutor: 更新操作
@@ -135,13 +409,87 @@ class ExecutionEngine {
      * 1. 检查表是否存在
      * 2. 分析WHERE条件，选择扫描方式（索引扫描 vs 顺序扫描）
      * 3. 处理SELECT列表（* vs 指定列）
-     * 4. 如需投影，创建ProjectionPlanNode
+     * 4. 有聚合函数或者GROUP BY时在扫描上面创建AggregationPlanNode，
+     *    否则如需投影，创建ProjectionPlanNode
      *
      * @param stmt SELECT语句AST节点
      * @return SELECT执行计划
      */
     std::unique_ptr<PlanNode> CreateSelectPlan(SelectStatement* stmt);
 
+    /**
+     * 创建带JOIN的SELECT语句的执行计划
+     *
+     * 处理逻辑：
+     * 1. 把ON和WHERE拆成AND连接的条件，列名解析到所属的表
+     * 2. 只用到一张表的条件下推到这张表的扫描
+     * 3. 第一个左表列 = 右表列的条件作为连接键，其余条件连接后过滤
+     * 4. 一边的连接列上有索引时用索引嵌套循环连接，另一边做外表；
+     *    否则用哈希连接
+     * 5. 有聚合时在连接上面创建AggregationPlanNode，否则如需投影，
+     *    在连接上面创建ProjectionPlanNode
+     *
+     * @param stmt SELECT语句AST节点，HasJoin()为true
+     * @return 连接的执行计划，表或者列找不到、没有等值条件时返回nullptr
+     */
+    std::unique_ptr<PlanNode> CreateJoinPlan(SelectStatement* stmt);
+
+    /**
+     * ANALYZE/VACUUM要处理的表名
+     * @param table_name 语句里的表名，空表示所有表
+     * @return 分区表换成它的各个分区
+     */
+    std::vector<std::string> ExpandPartitionedTable(
+        const std::string& table_name);
+
+    /**
+     * 分区表的UPDATE/DELETE：各个分区的修改计划拼成一个追加计划
+     * @param result_schema 输出schema，只有affected_rows一列
+     * @param children 各个分区的UpdatePlanNode或者DeletePlanNode
+     * @return 输出一行影响行数之和的AppendPlanNode
+     */
+    std::unique_ptr<PlanNode> CreateCountingAppendPlan(
+        std::unique_ptr<Schema> result_schema,
+        std::vector<std::unique_ptr<PlanNode>> children);
+
+    /**
+     * 连接一边的扫描计划
+     * @param table_info 这一边的表
+     * @param predicate 下推到这张表的条件，可以为空
+     * @return 普通表是顺序扫描，分区表见CreatePartitionedScanPlan
+     */
+    std::unique_ptr<PlanNode> CreateJoinScanPlan(
+        TableInfo* table_info, std::unique_ptr<Expression> predicate);
+
+    /**
+     * 为连接列选择内表的索引
+     *
+     * 第一列是连接列的B+树索引都能按前缀查找，哈希索引只能是单列的；
+     * 优先选唯一索引，其次列数少的索引
+     *
+     * @param table_name 内表名
+     * @param column 内表的连接列
+     * @return 索引名，没有可用的索引返回空字符串
+     */
+    std::string SelectJoinIndex(const std::string& table_name,
+                                const std::string& column);
+
+    /**
+     * 在输入计划上面创建聚合计划
+     *
+     * SELECT列表的每一项要么是整个聚合函数调用，要么和某个GROUP BY表达式相同；
+     * 聚合函数不能嵌套，也不能出现在更大的表达式里
+     *
+     * @param child 输入计划，表达式里的列名按它的输出schema解析
+     * @param select_list SELECT列表，列名已经解析到child的schema
+     * @param group_by GROUP BY表达式，列名已经解析到child的schema
+     * @return 聚合计划，SELECT列表不合法或者类型不支持时返回nullptr
+     */
+    std::unique_ptr<PlanNode> CreateAggregationPlan(
+        std::unique_ptr<PlanNode> child,
+        const std::vector<std::unique_ptr<Expression>>& select_list,
+        const std::vector<std::unique_ptr<Expression>>& group_by);
+
     /**
      * 创建INSERT语句的执行计划
      * @param stmt INSERT语句AST节点
@@ -203,7 +551,70 @@ class ExecutionEngine {
      * @param result_set 存储执行计划的结果集
      * @return 执行是否成功
      */
-    bool HandleExplain(ExplainStatement* stmt, std::vector<Tuple>* result_set);
+    bool HandleExplain(ExplainStatement* stmt, std::vector<Tuple>* result_set,
+                       Transaction* txn);
+
+    /**
+     * 执行EXPLAIN ANALYZE的计划，丢弃结果，返回带运行数据的计划文本
+     * @param plan_text 输出参数，格式化后的计划
+     * @return 执行失败时返回false
+     */
+    bool RunExplainAnalyze(std::unique_ptr<PlanNode> plan, Transaction* txn,
+                           std::string* plan_text);
+
+    /**
+     * 处理ANALYZE命令，收集表的统计信息供代价估计使用
+     * @param stmt ANALYZE语句AST节点，没有表名时收集所有表
+     * @return 表不存在时返回false
+     */
+    bool HandleAnalyze(AnalyzeStatement* stmt);
+
+    /**
+     * 处理VACUUM命令，回收表里删除和更新留下的空间
+     * @param stmt VACUUM语句AST节点，没有表名时处理所有表
+     * @param txn 当前事务，在它上面给表加X锁并记录搬动的日志
+     * @return 表不存在或者加锁失败时返回false
+     */
+    bool HandleVacuum(VacuumStatement* stmt, Transaction* txn);
+
+    /**
+     * 处理COPY命令，在表和文件之间批量导入导出
+     * @param result_set 输出一行affected_rows，是导入或导出的行数
+     * @param txn 当前事务，导入时给表加X锁，导出时加S锁
+     * @return 表不存在、只读事务里导入或者加锁失败时返回false
+     * @throws ExecutionException 读写文件失败或者文件内容有误
+     */
+    bool HandleCopy(CopyStatement* stmt, std::vector<Tuple>* result_set,
+                    Transaction* txn);
+
+    /**
+     * 处理PREPARE命令，按名字保存解析好的语句
+     * @return 同名的预编译语句已存在时返回false
+     */
+    bool HandlePrepare(PrepareStatement* stmt);
+
+    /**
+     * 处理DEALLOCATE命令，删除预编译语句
+     * @return 语句不存在时返回false
+     */
+    bool HandleDeallocate(DeallocateStatement* stmt);
+
+    /**
+     * 为计划创建执行器并把所有结果放进result_set
+     * @param plan 执行计划，交给执行器接管
+     * @param tuple_count 输出参数，处理的tuple数
+     * @param sink 不为空时result_set只是一块的缓冲区，攒满就交给sink
+     * @return 执行失败或者sink要求停止时返回false
+     */
+    bool RunPlan(std::unique_ptr<PlanNode> plan, std::vector<Tuple>* result_set,
+                 Transaction* txn, int* tuple_count,
+                 ResultSink* sink = nullptr);
+
+    /**
+     * 当前线程装了PlanCapture时记下计划的行数，需要时把计划格式化进去
+     * @param executor 根执行器，计划还归它所有
+     */
+    void CapturePlan(const Executor* executor, int tuple_count);
 
     // ============ 执行计划格式化方法 ============
 
@@ -214,7 +625,18 @@ class ExecutionEngine {
      * @param indent 缩进级别，用于形成树状结构
      * @return 格式化后的执行计划文本
      */
-    std::string FormatExecutionPlan(PlanNode* plan, int indent = 0);
+    std::string FormatExecutionPlan(const PlanNode* plan, int indent = 0);
+
+    /**
+     * 按EXPLAIN ANALYZE收集的执行器树格式化计划，每个节点后面跟上
+     * 实际行数、Init和Next的耗时、缓冲池命中和未命中、读盘次数和锁等待
+     * @param profile 根执行器的运行数据
+     */
+    std::string FormatAnalyzedPlan(const OperatorProfile* profile,
+                                   int indent = 0);
+
+    /** 一个计划节点的单行描述，不带缩进和换行 */
+    std::string DescribePlanNode(const PlanNode* plan);
 
     /**
      * 将执行计划节点类型转换为可读的字符串描述
@@ -8,17 +8,188 @@
 
 #include "execution/executor.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "catalog/catalog.h"
+#include "catalog/partition.h"
 #include "catalog/table_manager.h"
 #include "common/exception.h"
 #include "execution/expression_cloner.h"
 #include "execution/expression_evaluator.h"
+#include "execution/profiling_executor.h"
 #include "index/index_manager.h"
 #include "record/table_heap.h"
 #include "record/tuple.h"
 
 namespace SimpleRDBMS {
 
+/**
+ * 在columns中标记表达式用到的列
+ * @param expr 表达式，可以为nullptr
+ * @param schema 列所在的schema
+ * @param columns 输入输出参数，大小等于schema的列数
+ * @return 表达式里有无法识别的节点或者找不到的列时返回false，
+ *         这时不知道会用到哪些列
+ */
+static bool MarkReferencedColumns(const Expression* expr, const Schema* schema,
+                                  std::vector<bool>* columns) {
+    if (expr == nullptr) {
+        return true;
+    }
+    switch (expr->GetType()) {
+        case Expression::ExprType::CONSTANT:
+            return true;
+        case Expression::ExprType::COLUMN_REF: {
+            const std::string& name =
+                static_cast<const ColumnRefExpression*>(expr)->GetColumnName();
+            if (!schema->HasColumn(name)) {
+                return false;
+            }
+            (*columns)[schema->GetColumnIdx(name)] = true;
+            return true;
+        }
+        case Expression::ExprType::BINARY_OP: {
+            const auto* binary_expr =
+                static_cast<const BinaryOpExpression*>(expr);
+            return MarkReferencedColumns(binary_expr->GetLeft(), schema,
+                                         columns) &&
+                   MarkReferencedColumns(binary_expr->GetRight(), schema,
+                                         columns);
+        }
+        case Expression::ExprType::UNARY_OP:
+            return MarkReferencedColumns(
+                static_cast<const UnaryOpExpression*>(expr)->GetOperand(),
+                schema, columns);
+        default:
+            return false;
+    }
+}
+
+/**
+ * 找到计划要访问的表
+ * catalog还是规划时的版本就用计划里绑定的指针，否则按表名查找
+ */
+static TableInfo* ResolveTable(ExecutorContext* exec_ctx, const PlanNode* plan,
+                               const std::string& table_name) {
+    Catalog* catalog = exec_ctx->GetCatalog();
+    TableInfo* table_info = plan->GetBoundTable(catalog->GetSchemaVersion());
+    return table_info != nullptr ? table_info : catalog->GetTable(table_name);
+}
+
+/** 找到计划要使用的索引，规则同ResolveTable */
+static IndexInfo* ResolveIndex(ExecutorContext* exec_ctx, const PlanNode* plan,
+                               const std::string& index_name) {
+    Catalog* catalog = exec_ctx->GetCatalog();
+    IndexInfo* index_info = plan->GetBoundIndex(catalog->GetSchemaVersion());
+    return index_info != nullptr ? index_info : catalog->GetIndex(index_name);
+}
+
+/**
+ * SERIALIZABLE 的事务扫描表时给表加 S 锁，防止别的事务修改和插入
+ * 其他隔离级别和只读事务读快照，不加锁
+ */
+static void LockTableForScan(ExecutorContext* exec_ctx,
+                             const TableInfo* table_info) {
+    Transaction* txn = exec_ctx->GetTransaction();
+    LockManager* lock_manager = exec_ctx->GetLockManager();
+    if (lock_manager == nullptr || txn == nullptr || txn->IsReadOnly() ||
+        txn->GetIsolationLevel() != IsolationLevel::SERIALIZABLE) {
+        return;
+    }
+    if (!lock_manager->LockTable(txn, table_info->table_oid,
+                                 LockMode::SHARED)) {
+        throw ExecutionException("Lock conflict on table " +
+                                 table_info->table_name);
+    }
+}
+
+/**
+ * 只读事务不能写表，在加写锁之前检查，这时什么都还没有写
+ */
+static void CheckWritable(const Transaction* txn,
+                          const TableInfo* table_info) {
+    if (txn != nullptr && txn->IsReadOnly()) {
+        throw ExecutionException("Cannot modify table " +
+                                 table_info->table_name +
+                                 " in a read-only transaction");
+    }
+}
+
+/**
+ * 列存表的数据，行存表返回nullptr
+ * 启动时列存没能打开的表不能读写，这时抛出异常
+ */
+static ColumnStore* GetColumnStore(const TableInfo* table_info) {
+    if (table_info->storage != TableStorage::COLUMN) {
+        return nullptr;
+    }
+    if (!table_info->column_store) {
+        throw ExecutionException("Column data of table " +
+                                 table_info->table_name + " is unavailable");
+    }
+    return table_info->column_store.get();
+}
+
+/** 列存表只能追加，UPDATE和DELETE在读表之前报错 */
+static void CheckAppendOnly(const TableInfo* table_info) {
+    if (table_info->storage == TableStorage::COLUMN) {
+        throw ExecutionException("Table " + table_info->table_name +
+                                 " uses column storage and is append-only");
+    }
+}
+
+/**
+ * 插入之前给表加 IX 锁，和持有表 S 锁的扫描冲突时什么都还没有写
+ */
+static void LockTableForInsert(ExecutorContext* exec_ctx,
+                               const TableInfo* table_info) {
+    Transaction* txn = exec_ctx->GetTransaction();
+    LockManager* lock_manager = exec_ctx->GetLockManager();
+    CheckWritable(txn, table_info);
+    if (lock_manager == nullptr || txn == nullptr) {
+        return;
+    }
+    if (!lock_manager->LockTable(txn, table_info->table_oid,
+                                 LockMode::INTENTION_EXCLUSIVE)) {
+        throw ExecutionException("Lock conflict on table " +
+                                 table_info->table_name);
+    }
+}
+
+/**
+ * 记录语句修改了表的数据：表的修改计数加一，事务记下这张表，
+ * 提交后计数再加一。快照读看不到还没提交的修改，只在这里加一的话，
+ * 提交前读到旧数据的查询会带着新的计数把旧结果缓存下来
+ */
+static void RecordTableModification(ExecutorContext* exec_ctx,
+                                    TableInfo* table_info) {
+    exec_ctx->GetCatalog()->BumpModificationCount(table_info);
+    Transaction* txn = exec_ctx->GetTransaction();
+    if (txn != nullptr) {
+        txn->AddModifiedTable(table_info->table_oid);
+    }
+}
+
+/**
+ * 修改记录之前给它加 X 锁，同时在表上加 IX 锁
+ * 一个语句修改的记录多时由锁管理器升级成表锁
+ */
+static void LockRowForWrite(ExecutorContext* exec_ctx,
+                            const TableInfo* table_info, const RID& rid) {
+    Transaction* txn = exec_ctx->GetTransaction();
+    LockManager* lock_manager = exec_ctx->GetLockManager();
+    CheckWritable(txn, table_info);
+    if (lock_manager == nullptr || txn == nullptr) {
+        return;
+    }
+    if (!lock_manager->LockRow(txn, table_info->table_oid, rid,
+                               LockMode::EXCLUSIVE)) {
+        throw ExecutionException("Lock conflict on table " +
+                                 table_info->table_name);
+    }
+}
+
 /**
  * 顺序扫描执行器构造函数
  * 用于全表扫描，支持WHERE条件过滤
@@ -34,8 +205,8 @@ SeqScanExecutor::SeqScanExecutor(ExecutorContext* exec_ctx,
 void SeqScanExecutor::Init() {
     // 从catalog中获取表的元信息
     auto* seq_scan_plan = GetSeqScanPlan();
-    table_info_ =
-        exec_ctx_->GetCatalog()->GetTable(seq_scan_plan->GetTableName());
+    table_info_ = ResolveTable(exec_ctx_, seq_scan_plan,
+                               seq_scan_plan->GetTableName());
     if (table_info_ == nullptr) {
         throw ExecutionException("Table not found: " +
                                  seq_scan_plan->GetTableName());
@@ -44,9 +215,95 @@ void SeqScanExecutor::Init() {
     LOG_DEBUG("SeqScanExecutor::Init: table "
               << seq_scan_plan->GetTableName() << " first_page_id="
               << table_info_->table_heap->GetFirstPageId());
+    LockTableForScan(exec_ctx_, table_info_);
+
+    // 列存表不走表堆，也不会有并行扫描的分发器
+    column_store_ = GetColumnStore(table_info_);
+    column_snapshot_ = ColumnStore::ScanSnapshot();
+    next_row_group_ = 0;
+    tail_loaded_ = false;
+    group_rows_ = 0;
+    group_row_ = 0;
+    skipped_row_groups_ = 0;
+    row_batch_.Reset(0);
+    row_batch_pos_ = 0;
+    runtime_filter_.reset();
+    runtime_filtered_rows_ = 0;
+
+    // 汇总执行器的工作线程只扫描从分发器领到的页面
+    morsel_source_ = exec_ctx_->GetMorselSource();
+    if (morsel_source_ != nullptr &&
+        (column_store_ != nullptr ||
+         morsel_source_->GetTableName() != seq_scan_plan->GetTableName())) {
+        morsel_source_ = nullptr;
+    }
+    morsel_.clear();
+    morsel_index_ = 0;
+    page_rows_.clear();
+    page_row_ = 0;
+    morsel_skipped_pages_ = 0;
+
+    // 有快照时先直接读表堆，每读一条确认一次表堆里没有快照看不到的修改
+    Transaction* txn = exec_ctx_->GetTransaction();
+    read_view_ = txn != nullptr ? txn->GetReadView() : nullptr;
+    snapshot_scan_ = false;
+    resume_page_id_ = table_info_->table_heap->GetFirstPageId();
+    resume_slot_ = 0;
+
+    // 有WHERE条件时按页面的区域摘要过滤，从没有过记录的页面也直接跳过
+    TableHeap::PageFilter page_filter;
+    Expression* predicate = seq_scan_plan->GetPredicate();
+    if (predicate != nullptr) {
+        evaluator_ =
+            std::make_unique<ExpressionEvaluator>(table_info_->schema.get());
+        page_filter = [this, predicate](const ZoneMap::PageZone& zone) {
+            return !zone.columns.empty() && ZoneMayMatch(predicate, zone);
+        };
+        // 逐行过滤用预编译的条件，列名在这里一次解析好
+        compiled_predicate_ = CompiledExpression::Compile(
+            predicate, table_info_->schema.get());
+        if (compiled_predicate_.IsConstant() &&
+            !compiled_predicate_.EvaluateAsBoolean(Tuple())) {
+            // 条件恒为假（比如 WHERE 1 = 0），不用读任何页面
+            LOG_DEBUG("SeqScanExecutor::Init: predicate is always false");
+            table_iterator_ = TableHeap::Iterator();
+            read_view_ = nullptr;
+            return;
+        }
+    }
+
+    // 列存表读扫描开始时的快照，之后追加的记录看不到
+    if (column_store_ != nullptr) {
+        table_iterator_ = TableHeap::Iterator();
+        read_view_ = nullptr;
+        column_snapshot_ = column_store_->GetSnapshot();
+        return;
+    }
 
     // 初始化表的迭代器，从第一条记录开始
-    table_iterator_ = table_info_->table_heap->Begin();
+    // 全表扫描使用批量读取策略，大表扫描只占用一个小环，不会冲掉热点页面；
+    // 同时开启后台预读，冷缓存下的扫描不再一次只等一个页面的I/O
+    auto* bpm = exec_ctx_->GetBufferPoolManager();
+    if (morsel_source_ != nullptr) {
+        morsel_strategy_ =
+            bpm != nullptr ? bpm->CreateBulkReadStrategy() : nullptr;
+        table_iterator_ = TableHeap::Iterator();
+        return;
+    }
+
+    // 上层只需要少量行（LIMIT）时，预读窗口不超过这些行大约占用的页面数，
+    // 提前结束的扫描不会多读页面
+    size_t read_ahead_pages = READ_AHEAD_PAGES;
+    if (row_limit_ != SIZE_MAX) {
+        size_t rows_per_page = std::max<size_t>(
+            1, PAGE_SIZE / std::max<size_t>(
+                               1, table_info_->schema->GetTupleSize()));
+        read_ahead_pages =
+            std::min(read_ahead_pages, row_limit_ / rows_per_page);
+    }
+    table_iterator_ = table_info_->table_heap->Begin(
+        bpm != nullptr ? bpm->CreateBulkReadStrategy() : nullptr,
+        read_ahead_pages, std::move(page_filter));
 
     LOG_DEBUG("SeqScanExecutor::Init: iterator initialized, IsEnd="
               << table_iterator_.IsEnd());
@@ -62,36 +319,83 @@ void SeqScanExecutor::Init() {
 bool SeqScanExecutor::Next(Tuple* tuple, RID* rid) {
     auto* seq_scan_plan = GetSeqScanPlan();
 
-    // 懒加载：在第一次需要时创建表达式求值器
-    if (!evaluator_ && seq_scan_plan->GetPredicate()) {
-        evaluator_ =
-            std::make_unique<ExpressionEvaluator>(table_info_->schema.get());
+    if (column_store_ != nullptr) {
+        return NextColumnRow(tuple, rid);
+    }
+
+    if (morsel_source_ != nullptr) {
+        while (page_row_ >= page_rows_.size()) {
+            if (!LoadNextMorselPage()) {
+                return false;
+            }
+        }
+        *tuple = std::move(page_rows_[page_row_++]);
+        *rid = tuple->GetRID();
+        return true;
+    }
+
+    if (snapshot_scan_) {
+        return NextSnapshotRow(tuple, rid);
     }
 
     // 循环遍历表中的每一条记录
     while (!table_iterator_.IsEnd()) {
+        exec_ctx_->CheckCancellation();
         try {
             LOG_DEBUG("SeqScanExecutor::Next: getting current tuple");
 
-            // 获取当前迭代器指向的记录
-            *tuple = *table_iterator_;
+            RID current = table_iterator_.GetRID();
+            Expression* predicate = seq_scan_plan->GetPredicate();
+            if (predicate == nullptr && runtime_filter_ == nullptr) {
+                // 没有WHERE条件，返回所有记录；直接读进调用方的tuple，
+                // 调用方每次传同一个tuple时不重新分配列值
+                if (!table_iterator_.ReadCurrent(tuple)) {
+                    tuple->Reset();
+                }
+                *rid = tuple->GetRID();
+                ++table_iterator_;
+                if (!VerifySnapshot()) {
+                    return NextSnapshotRow(tuple, rid);
+                }
+                resume_page_id_ = current.page_id;
+                resume_slot_ = current.slot_num + 1;
+                return true;
+            }
+
+            // 在页面上的视图里先查运行时过滤器、再求WHERE条件，
+            // 只解码用到的列，满足条件的记录才反序列化整行
+            bool matched = false;
+            bool found = table_iterator_.ReadCurrent(
+                [this, tuple, predicate, &matched](const TupleView& view) {
+                    matched = RuntimeFilterMayMatch(view) &&
+                              (predicate == nullptr ||
+                               compiled_predicate_.EvaluateAsBoolean(view));
+                    if (matched) {
+                        view.ToTuple(tuple);
+                    }
+                });
+            if (!found) {
+                // 读不到记录时和以前一样对空tuple求值
+                if (!table_iterator_.ReadCurrent(tuple)) {
+                    tuple->Reset();
+                }
+                matched = predicate == nullptr ||
+                          compiled_predicate_.EvaluateAsBoolean(*tuple);
+            }
             *rid = tuple->GetRID();
-            LOG_DEBUG("SeqScanExecutor::Next: got tuple with RID "
-                      << rid->page_id << ":" << rid->slot_num);
 
             // 移动到下一条记录，为下次调用做准备
             ++table_iterator_;
             LOG_DEBUG("SeqScanExecutor::Next: moved to next, IsEnd="
                       << table_iterator_.IsEnd());
 
-            // 应用WHERE条件过滤
-            Expression* predicate = seq_scan_plan->GetPredicate();
-            if (predicate == nullptr) {
-                return true;  // 没有WHERE条件，返回所有记录
+            if (!VerifySnapshot()) {
+                return NextSnapshotRow(tuple, rid);
             }
+            resume_page_id_ = current.page_id;
+            resume_slot_ = current.slot_num + 1;
 
-            // 使用表达式求值器计算WHERE条件
-            if (evaluator_->EvaluateAsBoolean(predicate, *tuple)) {
+            if (matched) {
                 return true;  // 满足WHERE条件，返回这条记录
             }
             // 不满足条件，继续下一条记录
@@ -103,10 +407,461 @@ bool SeqScanExecutor::Next(Tuple* tuple, RID* rid) {
         }
     }
 
+    // 表堆里已经删除的记录读不到，结束之前再确认一次
+    if (!VerifySnapshot()) {
+        return NextSnapshotRow(tuple, rid);
+    }
+    resume_page_id_ = INVALID_PAGE_ID;
+
     LOG_DEBUG("SeqScanExecutor::Next: iterator is at end");
     return false;  // 遍历完所有记录，没有更多数据
 }
 
+/**
+ * 确认直接读表堆的结果
+ * 对快照不可见的撤销记录在快照结束前不会被回收，这时没有就说明
+ * 之前读到的每一条都是快照可见的版本，包括被区域摘要跳过的页面
+ */
+bool SeqScanExecutor::VerifySnapshot() {
+    if (read_view_ == nullptr ||
+        !table_info_->table_heap->HasInvisibleVersions(*read_view_)) {
+        return true;
+    }
+    LOG_DEBUG("SeqScanExecutor: invisible versions found, reading pages "
+              "from page "
+              << resume_page_id_ << " slot " << resume_slot_);
+    snapshot_scan_ = true;
+    table_iterator_ = TableHeap::Iterator();
+    page_rows_.clear();
+    page_row_ = 0;
+    if (morsel_strategy_ == nullptr) {
+        auto* bpm = exec_ctx_->GetBufferPoolManager();
+        morsel_strategy_ =
+            bpm != nullptr ? bpm->CreateBulkReadStrategy() : nullptr;
+    }
+    return false;
+}
+
+bool SeqScanExecutor::NextSnapshotRow(Tuple* tuple, RID* rid) {
+    while (page_row_ >= page_rows_.size()) {
+        if (resume_page_id_ == INVALID_PAGE_ID) {
+            return false;
+        }
+        page_rows_.clear();
+        page_row_ = 0;
+        page_id_t next_page_id = INVALID_PAGE_ID;
+        LoadPage(resume_page_id_, resume_slot_, &next_page_id);
+        exec_ctx_->CheckCancellation(page_rows_.size() + 1);
+        resume_page_id_ = next_page_id;
+        resume_slot_ = 0;
+    }
+    *tuple = std::move(page_rows_[page_row_++]);
+    *rid = tuple->GetRID();
+    return true;
+}
+
+/**
+ * 批量获取满足条件的记录
+ * 实现思路：
+ * 1. 从迭代器连续取出最多VECTOR_BATCH_SIZE条记录按列装入批次，
+ *    直接从页面上的视图解码，计划指定了解码的列时其余列不解码
+ * 2. 有WHERE条件时整批过滤，只改写选择向量
+ * 3. 整批都被过滤掉时继续装下一批，返回的批次至少有一行有效
+ * 4. 过滤出错时退回逐行求值，出错之前的行照常返回，之后结束扫描，
+ *    和Next遇到异常时的行为一致
+ */
+/**
+ * 并行扫描时读入下一个页面
+ * 页面已经有区域摘要并且不可能满足条件时跳过，不读页面
+ */
+bool SeqScanExecutor::LoadNextMorselPage() {
+    page_rows_.clear();
+    page_row_ = 0;
+    while (morsel_index_ >= morsel_.size()) {
+        if (!morsel_source_->NextMorsel(&morsel_)) {
+            return false;
+        }
+        morsel_index_ = 0;
+    }
+    page_id_t page_id = morsel_[morsel_index_++];
+    Expression* predicate = GetSeqScanPlan()->GetPredicate();
+    TableHeap* table_heap = table_info_->table_heap.get();
+    ZoneMap::PageZone zone;
+    // 有快照看不到的修改时，旧版本可能不在摘要的范围里，不跳过页面
+    if (predicate != nullptr && table_heap->GetCachedPageZone(page_id, &zone) &&
+        (zone.columns.empty() || !ZoneMayMatch(predicate, zone)) &&
+        (read_view_ == nullptr ||
+         !table_heap->HasInvisibleVersions(*read_view_))) {
+        morsel_skipped_pages_++;
+        return true;
+    }
+    LoadPage(page_id, 0, nullptr);
+    exec_ctx_->CheckCancellation(page_rows_.size() + 1);
+    return true;
+}
+
+void SeqScanExecutor::LoadPage(page_id_t page_id, slot_offset_t first_slot,
+                               page_id_t* next_page_id) {
+    Expression* predicate = GetSeqScanPlan()->GetPredicate();
+    bool read = table_info_->table_heap->ScanPage(
+        page_id,
+        [this, predicate, first_slot](const TupleView& view) {
+            if (view.GetRID().slot_num < first_slot ||
+                !RuntimeFilterMayMatch(view)) {
+                return;
+            }
+            if (predicate == nullptr ||
+                compiled_predicate_.EvaluateAsBoolean(view)) {
+                page_rows_.push_back(view.ToTuple());
+            }
+        },
+        morsel_strategy_.get(), read_view_, next_page_id);
+    if (!read) {
+        throw ExecutionException("SeqScanExecutor: Cannot read page " +
+                                 std::to_string(page_id));
+    }
+}
+
+bool SeqScanExecutor::NextBatch(VectorBatch* batch) {
+    if (column_store_ != nullptr) {
+        return NextColumnBatch(batch);
+    }
+    if (morsel_source_ != nullptr || snapshot_scan_) {
+        return Executor::NextBatch(batch);
+    }
+    Expression* predicate = GetSeqScanPlan()->GetPredicate();
+    size_t column_count = table_info_->schema->GetColumnCount();
+    std::vector<bool> decoded_columns = GetSeqScanPlan()->GetDecodedColumns();
+    if (decoded_columns.size() != column_count) {
+        decoded_columns.clear();
+    }
+    auto append = [batch, &decoded_columns](const TupleView& view) {
+        batch->AppendRow(view, decoded_columns);
+    };
+    while (!table_iterator_.IsEnd()) {
+        batch->Reset(column_count);
+        RID last_read{INVALID_PAGE_ID, -1};
+        try {
+            while (!table_iterator_.IsEnd() && !batch->IsFull()) {
+                last_read = table_iterator_.GetRID();
+                if (!table_iterator_.ReadCurrent(append)) {
+                    batch->AppendRow(*table_iterator_);
+                }
+                ++table_iterator_;
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR("SeqScanExecutor::NextBatch: Exception during scan: "
+                      << e.what());
+            table_iterator_ = TableHeap::Iterator();
+            return batch->GetRowCount() > 0 && FilterBatchByRow(batch);
+        }
+        exec_ctx_->CheckCancellation(batch->GetRowCount());
+        // 整批确认一次，有快照看不到的修改时丢掉这一批，从批次开头按页面重读
+        if (!VerifySnapshot()) {
+            return Executor::NextBatch(batch);
+        }
+        // 这一批一行也没读到时保持原来的续读位置
+        if (last_read.page_id != INVALID_PAGE_ID) {
+            resume_page_id_ = last_read.page_id;
+            resume_slot_ = last_read.slot_num + 1;
+        }
+
+        ApplyRuntimeFilter(batch);
+        if (predicate != nullptr) {
+            try {
+                evaluator_->FilterBatch(predicate, batch);
+            } catch (const std::exception& e) {
+                LOG_ERROR("SeqScanExecutor::NextBatch: Exception during "
+                          "filter: "
+                          << e.what());
+                table_iterator_ = TableHeap::Iterator();
+                return FilterBatchByRow(batch);
+            }
+        }
+        if (batch->GetSelectedCount() > 0) {
+            return true;
+        }
+    }
+    if (!VerifySnapshot()) {
+        return Executor::NextBatch(batch);
+    }
+    resume_page_id_ = INVALID_PAGE_ID;
+    return false;
+}
+
+/**
+ * 逐行过滤批次，遇到求值异常的行时丢弃它和之后的所有行
+ */
+bool SeqScanExecutor::FilterBatchByRow(VectorBatch* batch) {
+    Expression* predicate = GetSeqScanPlan()->GetPredicate();
+    auto* selection = batch->GetMutableSelection();
+    const Schema* schema = table_info_->schema.get();
+    size_t kept = 0;
+    for (size_t i = 0; i < selection->size(); i++) {
+        uint32_t row = (*selection)[i];
+        try {
+            if (predicate == nullptr || compiled_predicate_.EvaluateAsBoolean(
+                                             batch->GetTuple(row, schema))) {
+                (*selection)[kept++] = row;
+            }
+        } catch (const std::exception&) {
+            break;
+        }
+    }
+    selection->resize(kept);
+    return kept > 0;
+}
+
+/**
+ * 读入列存表的下一个行组
+ * 实现思路：
+ * 1. 有WHERE条件时先用行组的最小/最大值判断，不可能满足的行组整个跳过，
+ *    不读它的任何页面
+ * 2. 只解码计划用到的列，其余列留空，装批次时填占位值
+ * 3. 行组读完以后把快照里的尾部记录按列拷贝出来，当作最后一个行组
+ */
+bool SeqScanExecutor::LoadNextRowGroup() {
+    auto* seq_scan_plan = GetSeqScanPlan();
+    Expression* predicate = seq_scan_plan->GetPredicate();
+    size_t column_count = table_info_->schema->GetColumnCount();
+    const std::vector<bool>& decoded_columns =
+        seq_scan_plan->GetDecodedColumns();
+    auto decoded = [&decoded_columns, column_count](size_t c) {
+        return decoded_columns.size() != column_count || decoded_columns[c];
+    };
+    group_columns_.resize(column_count);
+    group_row_ = 0;
+
+    const auto& row_groups = column_snapshot_.row_groups;
+    while (next_row_group_ < row_groups.size()) {
+        exec_ctx_->CheckCancellation(row_groups[next_row_group_]->row_count);
+        const ColumnStore::RowGroup& group = *row_groups[next_row_group_];
+        current_row_group_ = next_row_group_++;
+        if (predicate != nullptr && !ZoneMayMatch(predicate, group.zone)) {
+            skipped_row_groups_++;
+            continue;
+        }
+        for (size_t c = 0; c < column_count; c++) {
+            if (decoded(c)) {
+                column_store_->ReadColumn(group, c, &group_columns_[c],
+                                          nullptr);
+            } else {
+                group_columns_[c].clear();
+            }
+        }
+        group_rows_ = group.row_count;
+        return true;
+    }
+
+    if (tail_loaded_) {
+        return false;
+    }
+    tail_loaded_ = true;
+    current_row_group_ = row_groups.size();
+    const auto& tail_rows = column_snapshot_.tail_rows;
+    for (size_t c = 0; c < column_count; c++) {
+        group_columns_[c].clear();
+        if (decoded(c)) {
+            for (const Tuple& row : tail_rows) {
+                group_columns_[c].push_back(row.GetValues()[c]);
+            }
+        }
+    }
+    group_rows_ = tail_rows.size();
+    return true;
+}
+
+/**
+ * 列存表的批量扫描
+ * 每个批次是当前行组里连续的最多VECTOR_BATCH_SIZE行，
+ * 过滤的方式和出错时的处理都和表堆的批量扫描一样
+ */
+bool SeqScanExecutor::NextColumnBatch(VectorBatch* batch) {
+    Expression* predicate = GetSeqScanPlan()->GetPredicate();
+    const Schema* schema = table_info_->schema.get();
+    size_t column_count = schema->GetColumnCount();
+    while (true) {
+        if (group_row_ >= group_rows_) {
+            if (!LoadNextRowGroup()) {
+                return false;
+            }
+            continue;
+        }
+        size_t count = std::min(VECTOR_BATCH_SIZE, group_rows_ - group_row_);
+        batch->Reset(column_count);
+        for (size_t c = 0; c < column_count; c++) {
+            auto* column = batch->GetMutableColumn(c);
+            const auto& values = group_columns_[c];
+            if (values.empty()) {
+                column->assign(count, VectorBatch::PlaceholderValue(
+                                          schema->GetColumn(c).type));
+            } else {
+                column->assign(values.begin() + group_row_,
+                               values.begin() + group_row_ + count);
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            batch->AppendRID(
+                RID{static_cast<page_id_t>(current_row_group_),
+                    static_cast<slot_offset_t>(group_row_ + i)});
+        }
+        group_row_ += count;
+
+        ApplyRuntimeFilter(batch);
+        if (predicate != nullptr) {
+            try {
+                evaluator_->FilterBatch(predicate, batch);
+            } catch (const std::exception& e) {
+                LOG_ERROR("SeqScanExecutor::NextBatch: Exception during "
+                          "filter: "
+                          << e.what());
+                next_row_group_ = column_snapshot_.row_groups.size();
+                tail_loaded_ = true;
+                group_rows_ = 0;
+                group_row_ = 0;
+                return FilterBatchByRow(batch);
+            }
+        }
+        if (batch->GetSelectedCount() > 0) {
+            return true;
+        }
+    }
+}
+
+bool SeqScanExecutor::NextColumnRow(Tuple* tuple, RID* rid) {
+    while (row_batch_pos_ >= row_batch_.GetSelectedCount()) {
+        if (!NextColumnBatch(&row_batch_)) {
+            return false;
+        }
+        row_batch_pos_ = 0;
+    }
+    uint32_t row = row_batch_.GetSelection()[row_batch_pos_++];
+    *tuple = row_batch_.GetTuple(row, table_info_->schema.get());
+    *rid = tuple->GetRID();
+    return true;
+}
+
+/**
+ * 接受哈希连接交过来的运行时过滤器
+ * 连接键在本表的schema上编译，只接受单独一列的连接键：
+ * 逐行扫描在页面视图上只解码这一列，批量扫描直接取这一列的值
+ */
+bool SeqScanExecutor::SetRuntimeFilter(
+    std::shared_ptr<const BloomFilter> filter, const Expression* key) {
+    if (table_info_ == nullptr || filter == nullptr || key == nullptr) {
+        return false;
+    }
+    CompiledExpression compiled;
+    try {
+        compiled = CompiledExpression::Compile(key, table_info_->schema.get());
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (!compiled.IsColumn()) {
+        return false;
+    }
+    runtime_filter_ = std::move(filter);
+    runtime_filter_column_ = compiled.GetColumnIndex();
+    LOG_DEBUG("SeqScanExecutor: runtime filter on column "
+              << runtime_filter_column_ << " of "
+              << GetSeqScanPlan()->GetTableName());
+    return true;
+}
+
+void SeqScanExecutor::ApplyRuntimeFilter(VectorBatch* batch) {
+    // 计划没有解码连接键这一列时批次里是占位值，不能过滤
+    const std::vector<bool>& decoded = GetSeqScanPlan()->GetDecodedColumns();
+    if (runtime_filter_ == nullptr ||
+        (decoded.size() == batch->GetColumnCount() &&
+         !decoded[runtime_filter_column_])) {
+        return;
+    }
+    const auto& keys = batch->GetColumn(runtime_filter_column_);
+    auto* selection = batch->GetMutableSelection();
+    size_t kept = 0;
+    for (uint32_t row : *selection) {
+        if (runtime_filter_->MayContain(JoinHashTable::HashValue(keys[row]))) {
+            (*selection)[kept++] = row;
+        }
+    }
+    runtime_filtered_rows_ += selection->size() - kept;
+    selection->resize(kept);
+}
+
+/**
+ * 用区域摘要判断页面是否可能满足条件
+ * 实现思路：
+ * 1. AND两边都可能满足才可能满足，OR任意一边可能满足即可
+ * 2. 列 op 常量：= 要求常量落在 [min, max] 内，< 和 <= 看最小值，
+ *    > 和 >= 看最大值；常量在左边时把操作符反过来
+ * 3. 比较沿用ExpressionEvaluator的规则，数值之间的转换都是单调的，
+ *    按最小/最大值判断不会漏掉页面；类型无法比较时当作可能满足
+ * 4. 一列上没有可比较的值（全是NaN）时比较条件都不成立
+ */
+bool SeqScanExecutor::ZoneMayMatch(const Expression* expr,
+                                   const ZoneMap::PageZone& zone) {
+    const auto* binary_expr = dynamic_cast<const BinaryOpExpression*>(expr);
+    if (binary_expr == nullptr) {
+        return true;
+    }
+    using OpType = BinaryOpExpression::OpType;
+    OpType op = binary_expr->GetOperator();
+    if (op == OpType::AND) {
+        return ZoneMayMatch(binary_expr->GetLeft(), zone) &&
+               ZoneMayMatch(binary_expr->GetRight(), zone);
+    }
+    if (op == OpType::OR) {
+        return ZoneMayMatch(binary_expr->GetLeft(), zone) ||
+               ZoneMayMatch(binary_expr->GetRight(), zone);
+    }
+
+    const auto* col_ref =
+        dynamic_cast<const ColumnRefExpression*>(binary_expr->GetLeft());
+    const auto* constant =
+        dynamic_cast<const ConstantExpression*>(binary_expr->GetRight());
+    if (col_ref == nullptr || constant == nullptr) {
+        col_ref =
+            dynamic_cast<const ColumnRefExpression*>(binary_expr->GetRight());
+        constant =
+            dynamic_cast<const ConstantExpression*>(binary_expr->GetLeft());
+        op = ExpressionEvaluator::FlipComparison(op);
+    }
+    const Schema* schema = table_info_->schema.get();
+    if (col_ref == nullptr || constant == nullptr ||
+        !schema->HasColumn(col_ref->GetColumnName())) {
+        return true;
+    }
+    size_t column_index = schema->GetColumnIdx(col_ref->GetColumnName());
+    if (column_index >= zone.columns.size()) {
+        return true;
+    }
+    const ZoneMap::ColumnRange& range = zone.columns[column_index];
+    const Value& value = constant->GetValue();
+
+    try {
+        switch (op) {
+            case OpType::EQUALS:
+                return range.has_value &&
+                       evaluator_->CompareValues(range.min, value,
+                                                 OpType::LESS_EQUALS) &&
+                       evaluator_->CompareValues(range.max, value,
+                                                 OpType::GREATER_EQUALS);
+            case OpType::LESS_THAN:
+            case OpType::LESS_EQUALS:
+                return range.has_value &&
+                       evaluator_->CompareValues(range.min, value, op);
+            case OpType::GREATER_THAN:
+            case OpType::GREATER_EQUALS:
+                return range.has_value &&
+                       evaluator_->CompareValues(range.max, value, op);
+            default:
+                return true;
+        }
+    } catch (const std::exception&) {
+        return true;
+    }
+}
+
 /**
  * 索引扫描执行器构造函数
  * 用于基于索引的高效查找
@@ -115,8 +870,64 @@ IndexScanExecutor::IndexScanExecutor(ExecutorContext* exec_ctx,
                                      std::unique_ptr<IndexScanPlanNode> plan)
     : Executor(exec_ctx, std::move(plan)),
       table_info_(nullptr),
-      index_info_(nullptr),
-      has_found_tuple_(false) {}
+      index_info_(nullptr) {}
+
+/**
+ * 取出快照下和表堆当前内容不同的记录，索引扫描用它补齐结果
+ * 索引里是最新的键，这些记录不能按索引的结果读：调用者从RID里去掉它们，
+ * 改为用visible里快照下存在的版本，按完整的WHERE条件过滤
+ * @return 有这样的记录时返回true
+ */
+static bool CollectSnapshotChanges(TableHeap* table_heap, const ReadView* view,
+                                   std::unordered_set<RID>* changed,
+                                   std::vector<Tuple>* visible) {
+    if (view == nullptr || !table_heap->HasInvisibleVersions(*view)) {
+        return false;
+    }
+    table_heap->GetSnapshotChanges(*view, changed, visible);
+    return !changed->empty();
+}
+
+/**
+ * 从索引的结果里去掉快照下已经不同的记录
+ * entry_values不为nullptr时和rids一一对应，一起压缩
+ */
+static void DropChangedRids(const std::unordered_set<RID>& changed,
+                            std::vector<RID>* rids,
+                            std::vector<std::vector<Value>>* entry_values) {
+    size_t kept = 0;
+    for (size_t i = 0; i < rids->size(); i++) {
+        if (changed.count((*rids)[i]) > 0) {
+            continue;
+        }
+        if (entry_values != nullptr && i < entry_values->size()) {
+            (*entry_values)[kept] = std::move((*entry_values)[i]);
+        }
+        (*rids)[kept++] = (*rids)[i];
+    }
+    rids->resize(kept);
+    if (entry_values != nullptr && entry_values->size() > kept) {
+        entry_values->resize(kept);
+    }
+}
+
+/** 依次返回快照下的旧版本中满足条件的一行 */
+static bool NextSnapshotVersion(ExpressionEvaluator* evaluator,
+                                Expression* predicate,
+                                const std::vector<Tuple>& rows, size_t* next,
+                                Tuple* tuple, RID* rid) {
+    while (*next < rows.size()) {
+        const Tuple& row = rows[(*next)++];
+        if (predicate != nullptr &&
+            !evaluator->EvaluateAsBoolean(predicate, row)) {
+            continue;
+        }
+        *tuple = row;
+        *rid = row.GetRID();
+        return true;
+    }
+    return false;
+}
 
 /**
  * 初始化索引扫描执行器
@@ -126,94 +937,481 @@ void IndexScanExecutor::Init() {
     auto* index_scan_plan = GetIndexScanPlan();
 
     // 获取表信息
-    table_info_ =
-        exec_ctx_->GetCatalog()->GetTable(index_scan_plan->GetTableName());
+    table_info_ = ResolveTable(exec_ctx_, index_scan_plan,
+                               index_scan_plan->GetTableName());
     if (table_info_ == nullptr) {
         throw ExecutionException("Table not found: " +
                                  index_scan_plan->GetTableName());
     }
 
     // 获取索引信息
-    index_info_ =
-        exec_ctx_->GetCatalog()->GetIndex(index_scan_plan->GetIndexName());
+    index_info_ = ResolveIndex(exec_ctx_, index_scan_plan,
+                               index_scan_plan->GetIndexName());
     if (index_info_ == nullptr) {
         throw ExecutionException("Index not found: " +
                                  index_scan_plan->GetIndexName());
     }
+    LockTableForScan(exec_ctx_, table_info_);
 
     // 创建表达式求值器
     evaluator_ =
         std::make_unique<ExpressionEvaluator>(table_info_->schema.get());
-    has_found_tuple_ = false;
+    rids_.clear();
+    entry_values_.clear();
+    next_rid_ = 0;
+
+    // 从WHERE条件中提取用于索引查找的键值，再取出键匹配的所有RID
+    // 唯一索引最多一条，非唯一索引可能有多条
+    if (!ExtractSearchKey(index_scan_plan->GetPredicate())) {
+        return;
+    }
+    IndexManager* index_manager =
+        exec_ctx_->GetTableManager()->GetIndexManager();
+    Transaction* txn = exec_ctx_->GetTransaction();
+    read_view_ = txn != nullptr ? txn->GetReadView() : nullptr;
+    snapshot_rows_.clear();
+    next_snapshot_row_ = 0;
+    if (!index_scan_plan->IsIndexOnly()) {
+        index_manager->FindEntry(index_scan_plan->GetIndexName(), search_keys_,
+                                 &rids_);
+        std::unordered_set<RID> changed;
+        if (CollectSnapshotChanges(table_info_->table_heap.get(), read_view_,
+                                   &changed, &snapshot_rows_)) {
+            DropChangedRids(changed, &rids_, nullptr);
+        }
+        return;
+    }
 
-    // 从WHERE条件中提取用于索引查找的键值
-    ExtractSearchKey(index_scan_plan->GetPredicate());
+    // 只读索引：连同索引项里的列值一起取出，Next里直接组成结果
+    const Schema* schema = table_info_->schema.get();
+    stored_column_indexes_.clear();
+    for (const auto& column : index_info_->key_columns) {
+        stored_column_indexes_.push_back(schema->GetColumnIdx(column));
+    }
+    for (const auto& column : index_info_->include_columns) {
+        stored_column_indexes_.push_back(schema->GetColumnIdx(column));
+    }
+    std::vector<std::pair<std::vector<Value>, RID>> entries;
+    index_manager->FindEntryWithValues(index_scan_plan->GetIndexName(),
+                                       search_keys_, &entries);
+    for (auto& entry : entries) {
+        entry_values_.push_back(std::move(entry.first));
+        rids_.push_back(entry.second);
+    }
+    std::unordered_set<RID> changed;
+    if (CollectSnapshotChanges(table_info_->table_heap.get(), read_view_,
+                               &changed, &snapshot_rows_)) {
+        DropChangedRids(changed, &rids_, &entry_values_);
+    }
 }
 
 /**
  * 通过索引查找记录
- * 索引扫描通常只返回一个或少数几个结果（点查询）
+ * 依次返回键匹配的记录，点查询在唯一索引上只有一条
  * @param tuple 输出参数，存储找到的记录
  * @param rid 输出参数，存储记录的RID
  * @return 是否找到记录
  */
 bool IndexScanExecutor::Next(Tuple* tuple, RID* rid) {
-    if (has_found_tuple_) {
-        return false;  // 已经返回过结果，索引点查询只返回一次
+    // WHERE里除了索引列的等值条件可能还有别的条件，需要再过滤一次
+    Expression* predicate = GetIndexScanPlan()->GetPredicate();
+    while (next_rid_ < rids_.size()) {
+        exec_ctx_->CheckCancellation();
+        size_t position = next_rid_++;
+        RID current = rids_[position];
+        // 只读索引时用索引项里的值组成tuple，否则通过RID从表堆中获取
+        bool from_index = position < entry_values_.size() &&
+                          BuildTupleFromIndex(entry_values_[position], tuple);
+        if (!from_index &&
+            !table_info_->table_heap->GetTuple(
+                current, tuple, exec_ctx_->GetTransaction()->GetTxnId(),
+                read_view_)) {
+            continue;
+        }
+        if (predicate != nullptr &&
+            !evaluator_->EvaluateAsBoolean(predicate, *tuple)) {
+            continue;
+        }
+        tuple->SetRID(current);
+        *rid = current;
+        return true;
     }
+    // 索引里已经查不到、快照下仍然存在的旧版本
+    return NextSnapshotVersion(evaluator_.get(), predicate, snapshot_rows_,
+                               &next_snapshot_row_, tuple, rid);
+}
 
-    auto* index_scan_plan = GetIndexScanPlan();
-    TableManager* table_manager = exec_ctx_->GetTableManager();
-    IndexManager* index_manager = table_manager->GetIndexManager();
-
-    // 使用索引查找记录的RID
-    RID found_rid;
-    bool found = index_manager->FindEntry(index_scan_plan->GetIndexName(),
-                                          search_key_, &found_rid);
-
-    if (found) {
-        // 通过RID从表堆中获取完整的tuple
-        bool success = table_info_->table_heap->GetTuple(
-            found_rid, tuple, exec_ctx_->GetTransaction()->GetTxnId());
-        if (success) {
-            *rid = found_rid;
-            has_found_tuple_ = true;
-            return true;
+/**
+ * 用索引项里的列值组成一行
+ * 实现思路：
+ * 1. 先按schema给每一列填对应类型的零值，保证Tuple构造时类型检查能通过
+ * 2. 再把索引列和INCLUDE列的值放到各自在schema里的位置
+ * 3. 组合键里的VARCHAR按声明长度编码，取回的长度达到声明长度时
+ *    原值可能更长（插入时不检查长度），这一行交给表堆读取
+ */
+bool IndexScanExecutor::BuildTupleFromIndex(const std::vector<Value>& values,
+                                            Tuple* tuple) {
+    const Schema* schema = table_info_->schema.get();
+    std::vector<Value> row;
+    row.reserve(schema->GetColumnCount());
+    for (size_t i = 0; i < schema->GetColumnCount(); i++) {
+        switch (schema->GetColumn(i).type) {
+            case TypeId::BOOLEAN:
+                row.emplace_back(false);
+                break;
+            case TypeId::TINYINT:
+                row.emplace_back(int8_t{0});
+                break;
+            case TypeId::SMALLINT:
+                row.emplace_back(int16_t{0});
+                break;
+            case TypeId::BIGINT:
+                row.emplace_back(int64_t{0});
+                break;
+            case TypeId::FLOAT:
+                row.emplace_back(0.0f);
+                break;
+            case TypeId::DOUBLE:
+                row.emplace_back(0.0);
+                break;
+            case TypeId::VARCHAR:
+                row.emplace_back(std::string());
+                break;
+            default:
+                row.emplace_back(int32_t{0});
+                break;
         }
     }
-
-    return false;  // 没有找到匹配的记录
+    for (size_t i = 0; i < values.size() && i < stored_column_indexes_.size();
+         i++) {
+        size_t column_index = stored_column_indexes_[i];
+        const Column& column = schema->GetColumn(column_index);
+        const auto* text = std::get_if<std::string>(&values[i]);
+        if (text != nullptr && column.type == TypeId::VARCHAR &&
+            text->size() >= column.size) {
+            return false;
+        }
+        row[column_index] = values[i];
+    }
+    *tuple = Tuple(std::move(row), schema);
+    return true;
 }
 
 /**
  * 从WHERE条件中提取搜索键
- * 解析等值条件（如 column = value），提取用于索引查找的键值
+ * 多列索引按列的顺序取等值条件的值，只有连续的前缀才能用来查找，
+ * 比如 (a, b, c) 上的索引遇到 a = 1 AND c = 3 只用 a = 1
  * @param predicate WHERE条件表达式
+ * @return 是否找到了等值条件
  */
-void IndexScanExecutor::ExtractSearchKey(Expression* predicate) {
-    // 处理二元操作表达式，目前支持等值查询
-    if (auto* binary_expr = dynamic_cast<BinaryOpExpression*>(predicate)) {
-        if (binary_expr->GetOperator() == BinaryOpExpression::OpType::EQUALS) {
-            // 提取常量值作为搜索键
-            if (auto* const_expr = dynamic_cast<ConstantExpression*>(
-                    binary_expr->GetRight())) {
-                search_key_ = const_expr->GetValue();
-            }
+bool IndexScanExecutor::ExtractSearchKey(Expression* predicate) {
+    search_keys_.clear();
+    for (const auto& column : index_info_->key_columns) {
+        Value value;
+        if (!FindEqualityValue(predicate, column, &value)) {
+            break;
         }
+        search_keys_.push_back(std::move(value));
     }
+    return !search_keys_.empty();
 }
 
 /**
- * 插入执行器构造函数
- * 用于向表中插入新记录
+ * 在AND条件里找指定列上的等值条件
+ * 解析 column = value 或 value = column，AND条件递归查找左右两边
  */
-InsertExecutor::InsertExecutor(ExecutorContext* exec_ctx,
-                               std::unique_ptr<InsertPlanNode> plan)
-    : Executor(exec_ctx, std::move(plan)),
-      table_info_(nullptr),
-      current_index_(0) {}
+bool IndexScanExecutor::FindEqualityValue(Expression* predicate,
+                                          const std::string& column,
+                                          Value* value) {
+    auto* binary_expr = dynamic_cast<BinaryOpExpression*>(predicate);
+    if (binary_expr == nullptr) {
+        return false;
+    }
 
-/**
+    if (binary_expr->GetOperator() == BinaryOpExpression::OpType::AND) {
+        return FindEqualityValue(binary_expr->GetLeft(), column, value) ||
+               FindEqualityValue(binary_expr->GetRight(), column, value);
+    }
+    if (binary_expr->GetOperator() != BinaryOpExpression::OpType::EQUALS) {
+        return false;
+    }
+
+    auto* col_ref = dynamic_cast<ColumnRefExpression*>(binary_expr->GetLeft());
+    auto* const_expr =
+        dynamic_cast<ConstantExpression*>(binary_expr->GetRight());
+    if (col_ref == nullptr || const_expr == nullptr) {
+        col_ref = dynamic_cast<ColumnRefExpression*>(binary_expr->GetRight());
+        const_expr = dynamic_cast<ConstantExpression*>(binary_expr->GetLeft());
+    }
+    if (col_ref == nullptr || const_expr == nullptr ||
+        col_ref->GetColumnName() != column) {
+        return false;
+    }
+
+    // 提取常量值作为搜索键
+    *value = const_expr->GetValue();
+    return true;
+}
+
+/**
+ * 索引范围扫描执行器构造函数
+ */
+IndexRangeScanExecutor::IndexRangeScanExecutor(
+    ExecutorContext* exec_ctx, std::unique_ptr<IndexRangeScanPlanNode> plan)
+    : Executor(exec_ctx, std::move(plan)), table_info_(nullptr) {}
+
+/**
+ * 初始化索引范围扫描执行器
+ * 实现思路：
+ * 1. 获取表信息，创建表达式求值器
+ * 2. 从索引里取出边界内的RID：扫描叶子时持有树的共享锁，
+ *    先取完一批RID再去表堆取记录，不会在持有索引锁的时候做表堆I/O
+ * 3. 没有LIMIT时一批就是全部；有LIMIT时第一批只取LIMIT个，
+ *    分页查询的代价和页大小成正比，而不是和范围内的行数成正比
+ */
+void IndexRangeScanExecutor::Init() {
+    auto* range_plan = GetIndexRangeScanPlan();
+
+    table_info_ =
+        ResolveTable(exec_ctx_, range_plan, range_plan->GetTableName());
+    if (table_info_ == nullptr) {
+        throw ExecutionException("Table not found: " +
+                                 range_plan->GetTableName());
+    }
+    LockTableForScan(exec_ctx_, table_info_);
+
+    evaluator_ =
+        std::make_unique<ExpressionEvaluator>(table_info_->schema.get());
+    rids_.clear();
+    next_rid_ = 0;
+    scanned_entries_ = 0;
+    exhausted_ = false;
+    // 没有LIMIT时一次取出范围内的所有RID
+    batch_size_ = row_limit_ != SIZE_MAX ? std::max<size_t>(row_limit_, 1)
+                                         : SIZE_MAX;
+    Transaction* txn = exec_ctx_->GetTransaction();
+    read_view_ = txn != nullptr ? txn->GetReadView() : nullptr;
+    snapshot_changed_.clear();
+    snapshot_rows_.clear();
+    next_snapshot_row_ = 0;
+    CollectSnapshotChanges(table_info_->table_heap.get(), read_view_,
+                           &snapshot_changed_, &snapshot_rows_);
+    FetchRids();
+
+    LOG_DEBUG("IndexRangeScanExecutor::Init: " << rids_.size()
+                                               << " candidate rows from index "
+                                               << range_plan->GetIndexName());
+}
+
+void IndexRangeScanExecutor::FetchRids() {
+    auto* range_plan = GetIndexRangeScanPlan();
+    rids_.clear();
+    next_rid_ = 0;
+    size_t skip = scanned_entries_;
+    size_t batch_size = batch_size_;
+    IndexManager* index_manager =
+        exec_ctx_->GetTableManager()->GetIndexManager();
+    bool success = index_manager->ScanRange(
+        range_plan->GetIndexName(), range_plan->GetLowerBound(),
+        range_plan->IsLowerInclusive(), range_plan->GetUpperBound(),
+        range_plan->IsUpperInclusive(),
+        [this, &skip, batch_size](const RID& rid) {
+            if (skip > 0) {
+                skip--;
+                return true;
+            }
+            rids_.push_back(rid);
+            return rids_.size() < batch_size;
+        });
+    if (!success) {
+        throw ExecutionException("Index not found: " +
+                                 range_plan->GetIndexName());
+    }
+    exhausted_ = rids_.size() < batch_size;
+    scanned_entries_ += rids_.size();
+    if (batch_size_ != SIZE_MAX) {
+        batch_size_ = batch_size_ > SIZE_MAX / 2 ? SIZE_MAX : batch_size_ * 2;
+    }
+    if (!snapshot_changed_.empty()) {
+        DropChangedRids(snapshot_changed_, &rids_, nullptr);
+    }
+}
+
+/**
+ * 返回下一条满足条件的记录
+ * 按索引键的顺序取记录，用完整的WHERE条件过滤
+ * @param tuple 输出参数，存储找到的记录
+ * @param rid 输出参数，存储记录的RID
+ * @return 是否还有记录
+ */
+bool IndexRangeScanExecutor::Next(Tuple* tuple, RID* rid) {
+    Expression* predicate = GetIndexRangeScanPlan()->GetPredicate();
+    while (true) {
+        while (next_rid_ < rids_.size()) {
+            exec_ctx_->CheckCancellation();
+            RID current = rids_[next_rid_++];
+            if (!table_info_->table_heap->GetTuple(
+                    current, tuple, exec_ctx_->GetTransaction()->GetTxnId(),
+                    read_view_)) {
+                continue;
+            }
+            if (predicate != nullptr &&
+                !evaluator_->EvaluateAsBoolean(predicate, *tuple)) {
+                continue;
+            }
+            *rid = current;
+            return true;
+        }
+        // 这一批用完了，上层还在要行，再从索引取一批；
+        // 索引取完之后输出快照下的旧版本
+        if (exhausted_) {
+            return NextSnapshotVersion(evaluator_.get(), predicate,
+                                       snapshot_rows_, &next_snapshot_row_,
+                                       tuple, rid);
+        }
+        FetchRids();
+    }
+}
+
+/**
+ * 位图堆扫描执行器构造函数
+ */
+BitmapHeapScanExecutor::BitmapHeapScanExecutor(
+    ExecutorContext* exec_ctx, std::unique_ptr<BitmapHeapScanPlanNode> plan)
+    : Executor(exec_ctx, std::move(plan)) {}
+
+/**
+ * 初始化位图堆扫描执行器
+ * 实现思路：
+ * 1. 获取表信息，加表锁，创建表达式求值器
+ * 2. 按条件树从索引取出RID建好位图，索引锁在每次查找结束时就释放了，
+ *    回表时不持有任何索引锁
+ * 3. 快照下和表堆不同的记录从位图里去掉，改为在最后输出快照下的版本
+ */
+void BitmapHeapScanExecutor::Init() {
+    auto* bitmap_plan = GetBitmapHeapScanPlan();
+    table_info_ =
+        ResolveTable(exec_ctx_, bitmap_plan, bitmap_plan->GetTableName());
+    if (table_info_ == nullptr) {
+        throw ExecutionException("Table not found: " +
+                                 bitmap_plan->GetTableName());
+    }
+    LockTableForScan(exec_ctx_, table_info_);
+
+    evaluator_ =
+        std::make_unique<ExpressionEvaluator>(table_info_->schema.get());
+    Transaction* txn = exec_ctx_->GetTransaction();
+    read_view_ = txn != nullptr ? txn->GetReadView() : nullptr;
+    snapshot_rows_.clear();
+    next_snapshot_row_ = 0;
+
+    bitmap_ = BuildBitmap(bitmap_plan->GetCondition());
+    std::unordered_set<RID> changed;
+    if (CollectSnapshotChanges(table_info_->table_heap.get(), read_view_,
+                               &changed, &snapshot_rows_)) {
+        for (const RID& rid : changed) {
+            bitmap_.Remove(rid);
+        }
+    }
+    candidate_count_ = bitmap_.GetCardinality();
+    iterator_ = RidBitmap::Iterator(&bitmap_);
+
+    LOG_DEBUG("BitmapHeapScanExecutor::Init: "
+              << candidate_count_ << " candidate rows on "
+              << bitmap_.GetPageCount() << " pages");
+}
+
+/**
+ * 按条件树取RID
+ * AND的子条件依次求交集，中间结果已经为空时后面的索引不用再查
+ */
+RidBitmap BitmapHeapScanExecutor::BuildBitmap(
+    const BitmapIndexCondition& condition) {
+    IndexManager* index_manager =
+        exec_ctx_->GetTableManager()->GetIndexManager();
+    RidBitmap bitmap;
+    switch (condition.kind) {
+        case BitmapIndexCondition::Kind::INDEX_LOOKUP: {
+            std::vector<Value> keys;
+            for (const auto& value : condition.key_values) {
+                keys.push_back(*value);
+            }
+            std::vector<RID> rids;
+            index_manager->FindEntry(condition.index_name, keys, &rids);
+            for (const RID& rid : rids) {
+                bitmap.Add(rid);
+            }
+            break;
+        }
+        case BitmapIndexCondition::Kind::INDEX_RANGE: {
+            bool success = index_manager->ScanRange(
+                condition.index_name, condition.lower.get(),
+                condition.lower_inclusive, condition.upper.get(),
+                condition.upper_inclusive, [&bitmap](const RID& rid) {
+                    bitmap.Add(rid);
+                    return true;
+                });
+            if (!success) {
+                throw ExecutionException("Index not found: " +
+                                         condition.index_name);
+            }
+            break;
+        }
+        case BitmapIndexCondition::Kind::AND:
+            for (size_t i = 0; i < condition.children.size(); i++) {
+                if (i == 0) {
+                    bitmap = BuildBitmap(condition.children[i]);
+                } else if (!bitmap.IsEmpty()) {
+                    bitmap.IntersectWith(BuildBitmap(condition.children[i]));
+                }
+            }
+            break;
+        case BitmapIndexCondition::Kind::OR:
+            for (const auto& child : condition.children) {
+                bitmap.UnionWith(BuildBitmap(child));
+            }
+            break;
+    }
+    return bitmap;
+}
+
+/**
+ * 返回下一条满足条件的记录
+ * 位图按页面号排序，同一个页面上的记录连续读出，页面只需要换入一次
+ */
+bool BitmapHeapScanExecutor::Next(Tuple* tuple, RID* rid) {
+    Expression* predicate = GetBitmapHeapScanPlan()->GetPredicate();
+    RID current;
+    while (iterator_.Next(&current)) {
+        exec_ctx_->CheckCancellation();
+        if (!table_info_->table_heap->GetTuple(
+                current, tuple, exec_ctx_->GetTransaction()->GetTxnId(),
+                read_view_)) {
+            continue;
+        }
+        if (predicate != nullptr &&
+            !evaluator_->EvaluateAsBoolean(predicate, *tuple)) {
+            continue;
+        }
+        tuple->SetRID(current);
+        *rid = current;
+        return true;
+    }
+    return NextSnapshotVersion(evaluator_.get(), predicate, snapshot_rows_,
+                               &next_snapshot_row_, tuple, rid);
+}
+
+/**
+ * 插入执行器构造函数
+ * 用于向表中插入新记录
+ */
+InsertExecutor::InsertExecutor(ExecutorContext* exec_ctx,
+                               std::unique_ptr<InsertPlanNode> plan)
+    : Executor(exec_ctx, std::move(plan)),
+      table_info_(nullptr),
+      current_index_(0) {}
+
+/**
  * 初始化插入执行器
  * 主要工作：获取表信息，准备插入操作
  */
@@ -221,7 +1419,7 @@ void InsertExecutor::Init() {
     // 从catalog中获取目标表的信息
     auto* insert_plan = GetInsertPlan();
     table_info_ =
-        exec_ctx_->GetCatalog()->GetTable(insert_plan->GetTableName());
+        ResolveTable(exec_ctx_, insert_plan, insert_plan->GetTableName());
 
     if (table_info_ == nullptr) {
         throw ExecutionException("Table not found: " +
@@ -229,6 +1427,7 @@ void InsertExecutor::Init() {
     }
 
     current_index_ = 0;  // 重置当前处理的记录索引
+    inserted_rids_.clear();
 }
 
 /**
@@ -247,16 +1446,47 @@ bool InsertExecutor::Next(Tuple* tuple, RID* rid) {
         return false;
     }
 
+    // 列存表整条语句的记录一次追加，返回的RID没有意义
+    if (table_info_->storage == TableStorage::COLUMN) {
+        if (current_index_ == 0) {
+            AppendColumnRows();
+        }
+        *rid = RID{INVALID_PAGE_ID, 0};
+        current_index_++;
+        *tuple = Tuple();
+        return true;
+    }
+
+    // 多行插入走批量路径，每个页面只加锁、写日志一次；
+    // 分区表的行先按分区分组，再分别批量插入各个分区
+    if (values_list.size() > 1 || table_info_->partition_scheme) {
+        if (current_index_ == 0) {
+            if (table_info_->partition_scheme) {
+                InsertPartitionedRows();
+            } else {
+                InsertAllRows();
+            }
+        }
+        *rid = inserted_rids_[current_index_];
+        current_index_++;
+        *tuple = Tuple();
+        return true;
+    }
+
     // 获取当前要插入的记录值
     const auto& values = values_list[current_index_];
     Tuple insert_tuple(values, table_info_->schema.get());
 
     // 向表堆中插入记录
+    Transaction* txn = exec_ctx_->GetTransaction();
+    LockTableForInsert(exec_ctx_, table_info_);
     bool success = table_info_->table_heap->InsertTuple(
-        insert_tuple, rid, exec_ctx_->GetTransaction()->GetTxnId());
+        insert_tuple, rid, txn->GetTxnId(), txn);
     if (!success) {
         throw ExecutionException("Failed to insert tuple");
     }
+    LockRowForWrite(exec_ctx_, table_info_, *rid);
+    RecordTableModification(exec_ctx_, table_info_);
 
     // 插入成功后，更新相关的索引
     TableManager* table_manager = exec_ctx_->GetTableManager();
@@ -273,6 +1503,124 @@ bool InsertExecutor::Next(Tuple* tuple, RID* rid) {
     return true;
 }
 
+/**
+ * 批量插入所有行
+ */
+void InsertExecutor::InsertAllRows() {
+    const auto& values_list = GetInsertPlan()->GetValues();
+    std::vector<Tuple> tuples;
+    tuples.reserve(values_list.size());
+    for (const auto& values : values_list) {
+        tuples.emplace_back(values, table_info_->schema.get());
+    }
+    InsertRows(table_info_, tuples, &inserted_rids_);
+}
+
+/**
+ * 插入分区表
+ * 实现思路：
+ * 1. 先按分区列算出每一行的分区，有一行没有分区可放时什么都不插入，
+ *    直接报错
+ * 2. 每个分区的行一起批量插入那个分区的子表，得到的RID按原来的行顺序放回
+ */
+void InsertExecutor::InsertPartitionedRows() {
+    const PartitionScheme& scheme = *table_info_->partition_scheme;
+    std::vector<TableInfo*> partitions =
+        exec_ctx_->GetCatalog()->GetPartitions(table_info_);
+    if (partitions.empty()) {
+        throw ExecutionException("Partitions of table " +
+                                 table_info_->table_name + " not found");
+    }
+
+    const auto& values_list = GetInsertPlan()->GetValues();
+    std::vector<std::vector<size_t>> rows_by_partition(partitions.size());
+    for (size_t i = 0; i < values_list.size(); i++) {
+        size_t partition;
+        if (scheme.column_index >= values_list[i].size() ||
+            !scheme.Route(values_list[i][scheme.column_index], &partition)) {
+            throw ExecutionException("No partition of table " +
+                                     table_info_->table_name +
+                                     " for the value of column " +
+                                     scheme.column_name);
+        }
+        rows_by_partition[partition].push_back(i);
+    }
+
+    inserted_rids_.assign(values_list.size(), RID{INVALID_PAGE_ID, 0});
+    for (size_t p = 0; p < partitions.size(); p++) {
+        if (rows_by_partition[p].empty()) {
+            continue;
+        }
+        std::vector<Tuple> tuples;
+        tuples.reserve(rows_by_partition[p].size());
+        for (size_t row : rows_by_partition[p]) {
+            tuples.emplace_back(values_list[row], partitions[p]->schema.get());
+        }
+        std::vector<RID> rids;
+        InsertRows(partitions[p], tuples, &rids);
+        for (size_t i = 0; i < rids.size(); i++) {
+            inserted_rids_[rows_by_partition[p][i]] = rids[i];
+        }
+    }
+}
+
+/**
+ * 把一批行插入一张行存表并维护它的索引
+ * 插入中途失败时，已经插入的行照样维护索引，然后抛出异常，
+ * 和逐行插入时失败前的行保留下来一致
+ */
+void InsertExecutor::InsertRows(TableInfo* table_info,
+                                const std::vector<Tuple>& tuples,
+                                std::vector<RID>* rids) {
+    Transaction* txn = exec_ctx_->GetTransaction();
+    LockTableForInsert(exec_ctx_, table_info);
+    bool success = table_info->table_heap->InsertTuples(
+        tuples, rids, txn->GetTxnId(), txn);
+    RecordTableModification(exec_ctx_, table_info);
+    // 新记录的锁不会和别的事务冲突，行数多时升级成表锁
+    for (const RID& inserted_rid : *rids) {
+        LockRowForWrite(exec_ctx_, table_info, inserted_rid);
+    }
+
+    TableManager* table_manager = exec_ctx_->GetTableManager();
+    if (table_manager) {
+        bool index_success = table_manager->UpdateIndexesOnBulkInsert(
+            table_info->table_name, tuples, *rids);
+        if (!index_success) {
+            LOG_WARN("Failed to update indexes for insert operation");
+        }
+    }
+
+    if (!success) {
+        throw ExecutionException("Failed to insert tuple");
+    }
+}
+
+/**
+ * 追加到列存表
+ * 列存不写日志、不加行锁，只加表的 IX 锁和 SERIALIZABLE 的扫描互斥
+ */
+void InsertExecutor::AppendColumnRows() {
+    ColumnStore* column_store = GetColumnStore(table_info_);
+    const auto& values_list = GetInsertPlan()->GetValues();
+    std::vector<Tuple> tuples;
+    tuples.reserve(values_list.size());
+    for (const auto& values : values_list) {
+        tuples.emplace_back(values, table_info_->schema.get());
+    }
+
+    LockTableForInsert(exec_ctx_, table_info_);
+    try {
+        column_store->Append(tuples);
+    } catch (const ExecutionException&) {
+        throw;
+    } catch (const std::exception& e) {
+        throw ExecutionException("Failed to append to table " +
+                                 table_info_->table_name + ": " + e.what());
+    }
+    RecordTableModification(exec_ctx_, table_info_);
+}
+
 /**
  * 更新执行器构造函数
  * 用于更新表中满足条件的记录
@@ -284,6 +1632,67 @@ UpdateExecutor::UpdateExecutor(ExecutorContext* exec_ctx,
       current_index_(0),
       is_executed_(false) {}
 
+void TargetRidList::Reset(ExecutorContext* exec_ctx, size_t budget) {
+    buffer_pool_manager_ = exec_ctx->GetBufferPoolManager();
+    budget_ = budget;
+    rids_.clear();
+    rids_.shrink_to_fit();
+    reservation_.SetTracker(exec_ctx->GetMemoryTracker());
+    spill_.reset();
+    spilled_count_ = 0;
+}
+
+void TargetRidList::Grow() {
+    size_t capacity = std::max<size_t>(rids_.capacity() * 2, 64);
+    if (capacity * sizeof(RID) <= budget_ &&
+        reservation_.TryResize(capacity * sizeof(RID))) {
+        rids_.reserve(capacity);
+        return;
+    }
+    Spill();
+}
+
+void TargetRidList::Spill() {
+    if (!spill_) {
+        spill_ = std::make_unique<SpillPartition>(buffer_pool_manager_);
+    }
+    for (const RID& rid : rids_) {
+        spill_->Append(reinterpret_cast<const char*>(&rid), sizeof(RID));
+    }
+    spilled_count_ += rids_.size();
+    rids_.clear();
+}
+
+void TargetRidList::Finish() {
+    if (spill_) {
+        spill_->Finish();
+    }
+}
+
+TargetRidList::Cursor::Cursor(const TargetRidList* list) : list_(list) {
+    if (list_->spill_) {
+        reader_ =
+            std::make_unique<SpillPartition::Reader>(list_->spill_.get());
+    }
+}
+
+bool TargetRidList::Cursor::Next(RID* rid) {
+    if (reader_) {
+        const char* data;
+        uint16_t size;
+        if (reader_->Next(&data, &size)) {
+            std::memcpy(rid, data, sizeof(RID));
+            return true;
+        }
+        reader_.reset();
+    }
+    if (index_ < list_->rids_.size()) {
+        *rid = list_->rids_[index_++];
+        return true;
+    }
+    return false;
+}
+
 /**
  * 初始化更新执行器
  * 主要工作：扫描表找出所有需要更新的记录RID
@@ -293,32 +1702,59 @@ void UpdateExecutor::Init() {
     // 获取表信息
     auto* update_plan = GetUpdatePlan();
     table_info_ =
-        exec_ctx_->GetCatalog()->GetTable(update_plan->GetTableName());
+        ResolveTable(exec_ctx_, update_plan, update_plan->GetTableName());
     if (table_info_ == nullptr) {
         throw ExecutionException("Table not found: " +
                                  update_plan->GetTableName());
     }
+    CheckAppendOnly(table_info_);
 
     // 创建表达式求值器，用于计算WHERE条件和SET子句
     evaluator_ =
         std::make_unique<ExpressionEvaluator>(table_info_->schema.get());
 
+    // 只改非索引列的UPDATE在记录原地更新时不用碰任何索引
+    updates_indexed_column_ = false;
+    Catalog* catalog = exec_ctx_->GetCatalog();
+    if (catalog != nullptr) {
+        for (const IndexInfo* index_info :
+             catalog->GetTableIndexes(table_info_->table_name)) {
+            for (const auto& update_pair : update_plan->GetUpdates()) {
+                const std::string& column = update_pair.first;
+                auto stores = [&column](const std::vector<std::string>& cols) {
+                    return std::find(cols.begin(), cols.end(), column) !=
+                           cols.end();
+                };
+                if (stores(index_info->key_columns) ||
+                    stores(index_info->include_columns)) {
+                    updates_indexed_column_ = true;
+                }
+            }
+        }
+    } else {
+        updates_indexed_column_ = true;
+    }
+
     // 第一阶段：扫描表，收集所有需要更新的记录RID
-    target_rids_.clear();
+    target_rids_.Reset(
+        exec_ctx_, exec_ctx_->GetOperatorBudget(MODIFY_TARGET_MEMORY_BUDGET));
     current_index_ = 0;
     is_executed_ = false;
 
     auto iter = table_info_->table_heap->Begin();
     while (!iter.IsEnd()) {
+        // 只在收集阶段检查，开始修改以后不再中途停下
+        exec_ctx_->CheckCancellation();
         Tuple tuple = *iter;
         // 检查记录是否满足WHERE条件
         Expression* predicate = update_plan->GetPredicate();
         if (predicate == nullptr ||
             evaluator_->EvaluateAsBoolean(predicate, tuple)) {
-            target_rids_.push_back(tuple.GetRID());
+            target_rids_.Add(tuple.GetRID());
         }
         ++iter;
     }
+    target_rids_.Finish();
 }
 
 /**
@@ -336,9 +1772,13 @@ bool UpdateExecutor::Next(Tuple* tuple, RID* rid) {
     auto* update_plan = GetUpdatePlan();
     int updated_count = 0;
     TableManager* table_manager = exec_ctx_->GetTableManager();
+    Transaction* txn = exec_ctx_->GetTransaction();
 
     // 第二阶段：对所有目标记录执行更新
-    for (const RID& target_rid : target_rids_) {
+    TargetRidList::Cursor cursor(&target_rids_);
+    RID target_rid;
+    while (cursor.Next(&target_rid)) {
+        LockRowForWrite(exec_ctx_, table_info_, target_rid);
         Tuple old_tuple;
         if (!table_info_->table_heap->GetTuple(
                 target_rid, &old_tuple,
@@ -371,21 +1811,42 @@ bool UpdateExecutor::Next(Tuple* tuple, RID* rid) {
             }
         }
 
-        // 执行更新操作
+        // 执行更新操作：新记录在原页面放得下时原地更新，RID不变
         Tuple new_tuple(new_values, table_info_->schema.get());
-        if (table_info_->table_heap->UpdateTuple(
-                new_tuple, target_rid,
-                exec_ctx_->GetTransaction()->GetTxnId())) {
-            // 更新相关索引
-            if (table_manager) {
-                bool index_success = table_manager->UpdateIndexesOnUpdate(
-                    table_info_->table_name, old_tuple, new_tuple, target_rid);
-                if (!index_success) {
-                    LOG_WARN("Failed to update indexes for update operation");
-                }
+        RID new_rid = target_rid;
+        bool updated = table_info_->table_heap->UpdateTuple(
+            new_tuple, target_rid, txn->GetTxnId(), txn);
+        if (!updated) {
+            if (table_info_->table_heap->HasWriteConflict(target_rid, txn)) {
+                // 别的事务还没提交的修改，或者快照之后提交的修改
+                throw ExecutionException("Write conflict on table " +
+                                         table_info_->table_name);
+            }
+            // 原页面放不下变大的记录：插入到别的页面再删除旧记录，RID改变
+            updated = table_info_->table_heap->InsertTuple(
+                          new_tuple, &new_rid, txn->GetTxnId(), txn) &&
+                      table_info_->table_heap->DeleteTuple(
+                          target_rid, txn->GetTxnId(), txn);
+            if (!updated) {
+                throw ExecutionException("Failed to relocate updated row in "
+                                         "table " + table_info_->table_name);
+            }
+        }
+
+        // 更新相关索引，RID不变且没改索引列时所有索引项都还有效
+        if (table_manager &&
+            (updates_indexed_column_ || !(new_rid == target_rid))) {
+            bool index_success = table_manager->UpdateIndexesOnUpdate(
+                table_info_->table_name, old_tuple, new_tuple, target_rid,
+                new_rid);
+            if (!index_success) {
+                LOG_WARN("Failed to update indexes for update operation");
             }
-            updated_count++;
         }
+        updated_count++;
+    }
+    if (updated_count > 0) {
+        RecordTableModification(exec_ctx_, table_info_);
     }
 
     is_executed_ = true;
@@ -417,32 +1878,37 @@ void DeleteExecutor::Init() {
     // 获取表信息
     auto* delete_plan = GetDeletePlan();
     table_info_ =
-        exec_ctx_->GetCatalog()->GetTable(delete_plan->GetTableName());
+        ResolveTable(exec_ctx_, delete_plan, delete_plan->GetTableName());
     if (table_info_ == nullptr) {
         throw ExecutionException("Table not found: " +
                                  delete_plan->GetTableName());
     }
+    CheckAppendOnly(table_info_);
 
     // 创建表达式求值器，用于计算WHERE条件
     evaluator_ =
         std::make_unique<ExpressionEvaluator>(table_info_->schema.get());
 
     // 第一阶段：扫描表，收集所有需要删除的记录RID
-    target_rids_.clear();
+    target_rids_.Reset(
+        exec_ctx_, exec_ctx_->GetOperatorBudget(MODIFY_TARGET_MEMORY_BUDGET));
     current_index_ = 0;
     is_executed_ = false;
 
     auto iter = table_info_->table_heap->Begin();
     while (!iter.IsEnd()) {
+        // 只在收集阶段检查，开始修改以后不再中途停下
+        exec_ctx_->CheckCancellation();
         Tuple tuple = *iter;
         // 检查记录是否满足WHERE条件
         Expression* predicate = delete_plan->GetPredicate();
         if (predicate == nullptr ||
             evaluator_->EvaluateAsBoolean(predicate, tuple)) {
-            target_rids_.push_back(tuple.GetRID());
+            target_rids_.Add(tuple.GetRID());
         }
         ++iter;
     }
+    target_rids_.Finish();
 }
 
 /**
@@ -459,9 +1925,13 @@ bool DeleteExecutor::Next(Tuple* tuple, RID* rid) {
 
     int deleted_count = 0;
     TableManager* table_manager = exec_ctx_->GetTableManager();
+    Transaction* txn = exec_ctx_->GetTransaction();
 
     // 第二阶段：对所有目标记录执行删除
-    for (const RID& target_rid : target_rids_) {
+    TargetRidList::Cursor cursor(&target_rids_);
+    RID target_rid;
+    while (cursor.Next(&target_rid)) {
+        LockRowForWrite(exec_ctx_, table_info_, target_rid);
         Tuple tuple_to_delete;
 
         // 先获取要删除的记录（用于更新索引）
@@ -470,8 +1940,8 @@ bool DeleteExecutor::Next(Tuple* tuple, RID* rid) {
             exec_ctx_->GetTransaction()->GetTxnId());
 
         // 执行删除操作
-        if (table_info_->table_heap->DeleteTuple(
-                target_rid, exec_ctx_->GetTransaction()->GetTxnId())) {
+        if (table_info_->table_heap->DeleteTuple(target_rid, txn->GetTxnId(),
+                                                 txn)) {
             // 从相关索引中删除记录
             if (got_tuple && table_manager) {
                 bool index_success = table_manager->UpdateIndexesOnDelete(
@@ -481,8 +1951,15 @@ bool DeleteExecutor::Next(Tuple* tuple, RID* rid) {
                 }
             }
             deleted_count++;
+        } else if (table_info_->table_heap->HasWriteConflict(target_rid,
+                                                             txn)) {
+            throw ExecutionException("Write conflict on table " +
+                                     table_info_->table_name);
         }
     }
+    if (deleted_count > 0) {
+        RecordTableModification(exec_ctx_, table_info_);
+    }
 
     is_executed_ = true;
 
@@ -493,6 +1970,317 @@ bool DeleteExecutor::Next(Tuple* tuple, RID* rid) {
     return true;
 }
 
+/**
+ * 执行器的默认批量接口
+ * 逐行调用Next把结果装进批次，没有批量实现的执行器也能接在批量算子下面
+ */
+bool Executor::NextBatch(VectorBatch* batch) {
+    batch->Reset(GetOutputSchema()->GetColumnCount());
+    Tuple tuple;
+    RID rid;
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+        tuple.SetRID(rid);
+        batch->AppendRow(tuple);
+    }
+    return batch->GetRowCount() > 0;
+}
+
+/**
+ * 复制执行计划
+ * 实现思路：按节点类型用同样的参数构造一个新节点，子计划递归复制，
+ * 表达式用ExpressionCloner复制，节点自己持有的schema也复制一份；
+ * 规划时绑定的表和索引、代价估计由CopyPlan带过去
+ */
+static std::unique_ptr<PlanNode> CopyPlanNode(const PlanNode* plan) {
+    switch (plan->GetType()) {
+        case PlanNodeType::SEQUENTIAL_SCAN: {
+            auto* seq_scan = static_cast<const SeqScanPlanNode*>(plan);
+            auto copy = std::make_unique<SeqScanPlanNode>(
+                seq_scan->GetOutputSchema(), seq_scan->GetTableName(),
+                ExpressionCloner::Clone(seq_scan->GetPredicate()));
+            copy->SetDecodedColumns(seq_scan->GetDecodedColumns());
+            return copy;
+        }
+        case PlanNodeType::INDEX_SCAN: {
+            auto* index_scan = static_cast<const IndexScanPlanNode*>(plan);
+            auto copy = std::make_unique<IndexScanPlanNode>(
+                index_scan->GetOutputSchema(), index_scan->GetTableName(),
+                index_scan->GetIndexName(),
+                ExpressionCloner::Clone(index_scan->GetPredicate()));
+            copy->SetIndexOnly(index_scan->IsIndexOnly());
+            return copy;
+        }
+        case PlanNodeType::INDEX_RANGE_SCAN: {
+            auto* range_scan = static_cast<const IndexRangeScanPlanNode*>(plan);
+            auto copy = std::make_unique<IndexRangeScanPlanNode>(
+                range_scan->GetOutputSchema(), range_scan->GetTableName(),
+                range_scan->GetIndexName(),
+                ExpressionCloner::Clone(range_scan->GetPredicate()));
+            if (range_scan->GetLowerBoundParameter()) {
+                copy->SetLowerBoundParameter(
+                    range_scan->GetLowerBoundParameter(),
+                    range_scan->IsLowerInclusive());
+            } else if (range_scan->GetLowerBound() != nullptr) {
+                copy->SetLowerBound(*range_scan->GetLowerBound(),
+                                    range_scan->IsLowerInclusive());
+            }
+            if (range_scan->GetUpperBoundParameter()) {
+                copy->SetUpperBoundParameter(
+                    range_scan->GetUpperBoundParameter(),
+                    range_scan->IsUpperInclusive());
+            } else if (range_scan->GetUpperBound() != nullptr) {
+                copy->SetUpperBound(*range_scan->GetUpperBound(),
+                                    range_scan->IsUpperInclusive());
+            }
+            return copy;
+        }
+        case PlanNodeType::BITMAP_HEAP_SCAN: {
+            auto* bitmap_scan = static_cast<const BitmapHeapScanPlanNode*>(plan);
+            return std::make_unique<BitmapHeapScanPlanNode>(
+                bitmap_scan->GetOutputSchema(), bitmap_scan->GetTableName(),
+                bitmap_scan->GetCondition(),
+                ExpressionCloner::Clone(bitmap_scan->GetPredicate()));
+        }
+        case PlanNodeType::HASH_JOIN: {
+            auto* join = static_cast<const HashJoinPlanNode*>(plan);
+            auto left = CopyPlan(join->GetLeftPlan());
+            auto right = CopyPlan(join->GetRightPlan());
+            if (!left || !right) {
+                return nullptr;
+            }
+            auto copy = std::make_unique<HashJoinPlanNode>(
+                std::make_unique<Schema>(*join->GetOutputSchema()),
+                std::move(left), std::move(right),
+                ExpressionCloner::Clone(join->GetLeftKey()),
+                ExpressionCloner::Clone(join->GetRightKey()),
+                ExpressionCloner::Clone(join->GetPredicate()));
+            copy->SetMemoryBudget(join->GetMemoryBudget());
+            return copy;
+        }
+        case PlanNodeType::INDEX_NESTED_LOOP_JOIN: {
+            auto* join = static_cast<const IndexNestedLoopJoinPlanNode*>(plan);
+            auto outer = CopyPlan(join->GetOuterPlan());
+            if (!outer) {
+                return nullptr;
+            }
+            return std::make_unique<IndexNestedLoopJoinPlanNode>(
+                std::make_unique<Schema>(*join->GetOutputSchema()),
+                std::move(outer), join->IsOuterLeft(),
+                join->GetInnerTableName(), join->GetIndexName(),
+                ExpressionCloner::Clone(join->GetOuterKey()),
+                join->GetInnerKeyColumn(),
+                ExpressionCloner::Clone(join->GetInnerPredicate()),
+                ExpressionCloner::Clone(join->GetPredicate()));
+        }
+        case PlanNodeType::AGGREGATION: {
+            auto* aggregation = static_cast<const AggregationPlanNode*>(plan);
+            auto child = CopyPlan(aggregation->GetChild(0));
+            if (!child) {
+                return nullptr;
+            }
+            std::vector<std::unique_ptr<Expression>> group_by;
+            for (const auto& expr : aggregation->GetGroupBy()) {
+                group_by.push_back(ExpressionCloner::Clone(expr.get()));
+            }
+            std::vector<AggregationPlanNode::Aggregate> aggregates;
+            for (const auto& aggregate : aggregation->GetAggregates()) {
+                aggregates.push_back(
+                    {aggregate.type,
+                     ExpressionCloner::Clone(aggregate.argument.get())});
+            }
+            auto copy = std::make_unique<AggregationPlanNode>(
+                std::make_unique<Schema>(*aggregation->GetOutputSchema()),
+                std::move(child), std::move(group_by), std::move(aggregates),
+                aggregation->GetOutputColumns());
+            copy->SetMemoryBudget(aggregation->GetMemoryBudget());
+            return copy;
+        }
+        case PlanNodeType::SORT: {
+            auto* sort = static_cast<const SortPlanNode*>(plan);
+            auto child = CopyPlan(sort->GetChild(0));
+            if (!child) {
+                return nullptr;
+            }
+            std::vector<SortPlanNode::SortKey> keys;
+            for (const auto& key : sort->GetKeys()) {
+                keys.push_back({ExpressionCloner::Clone(key.expression.get()),
+                                key.ascending});
+            }
+            auto copy = std::make_unique<SortPlanNode>(
+                std::move(child), std::move(keys), sort->GetLimit());
+            copy->SetMemoryBudget(sort->GetMemoryBudget());
+            return copy;
+        }
+        case PlanNodeType::LIMIT: {
+            auto* limit = static_cast<const LimitPlanNode*>(plan);
+            auto child = CopyPlan(limit->GetChild(0));
+            if (!child) {
+                return nullptr;
+            }
+            return std::make_unique<LimitPlanNode>(std::move(child),
+                                                   limit->GetLimit());
+        }
+        case PlanNodeType::PROJECTION: {
+            auto* projection = static_cast<const ProjectionPlanNode*>(plan);
+            auto child = CopyPlan(projection->GetChild(0));
+            if (!child) {
+                return nullptr;
+            }
+            std::vector<std::unique_ptr<Expression>> expressions;
+            for (const auto& expr : projection->GetExpressions()) {
+                expressions.push_back(ExpressionCloner::Clone(expr.get()));
+            }
+            auto schema =
+                std::make_unique<Schema>(*projection->GetOutputSchema());
+            auto copy = std::make_unique<ProjectionPlanNode>(
+                schema.get(), std::move(expressions), std::move(child));
+            copy->SetOwnedSchema(std::move(schema));
+            return copy;
+        }
+        case PlanNodeType::GATHER: {
+            auto* gather = static_cast<const GatherPlanNode*>(plan);
+            auto child = CopyPlan(gather->GetChild(0));
+            if (!child) {
+                return nullptr;
+            }
+            return std::make_unique<GatherPlanNode>(
+                std::move(child), gather->GetWorkers(),
+                gather->GetMorselPages());
+        }
+        case PlanNodeType::APPEND: {
+            auto* append = static_cast<const AppendPlanNode*>(plan);
+            std::vector<std::unique_ptr<PlanNode>> children;
+            for (const auto& child : append->GetChildren()) {
+                auto child_copy = CopyPlan(child.get());
+                if (!child_copy) {
+                    return nullptr;
+                }
+                children.push_back(std::move(child_copy));
+            }
+            const Schema* output_schema =
+                append->IsCountRows() ? nullptr : children[0]->GetOutputSchema();
+            auto copy = std::make_unique<AppendPlanNode>(
+                output_schema, std::move(children), append->GetWorkers(),
+                append->IsCountRows());
+            if (append->IsCountRows()) {
+                copy->SetOwnedSchema(
+                    std::make_unique<Schema>(*append->GetOutputSchema()));
+            }
+            return copy;
+        }
+        case PlanNodeType::UPDATE: {
+            auto* update = static_cast<const UpdatePlanNode*>(plan);
+            std::vector<std::pair<std::string, std::unique_ptr<Expression>>>
+                updates;
+            for (const auto& [column, expr] : update->GetUpdates()) {
+                updates.emplace_back(column, ExpressionCloner::Clone(expr.get()));
+            }
+            return std::make_unique<UpdatePlanNode>(
+                std::make_unique<Schema>(*update->GetOutputSchema()),
+                update->GetTableName(), std::move(updates),
+                ExpressionCloner::Clone(update->GetPredicate()));
+        }
+        case PlanNodeType::DELETE: {
+            auto* delete_plan = static_cast<const DeletePlanNode*>(plan);
+            return std::make_unique<DeletePlanNode>(
+                std::make_unique<Schema>(*delete_plan->GetOutputSchema()),
+                delete_plan->GetTableName(),
+                ExpressionCloner::Clone(delete_plan->GetPredicate()));
+        }
+        default:
+            return nullptr;
+    }
+}
+
+std::unique_ptr<PlanNode> CopyPlan(const PlanNode* plan) {
+    auto copy = CopyPlanNode(plan);
+    if (copy) {
+        copy->CopyBindingFrom(*plan);
+        copy->SetEstimate(plan->GetEstimatedRows(), plan->GetEstimatedCost());
+    }
+    return copy;
+}
+
+/** 按计划类型创建子执行器 */
+static std::unique_ptr<Executor> CreateChildExecutorForPlan(
+    ExecutorContext* exec_ctx, std::unique_ptr<PlanNode> plan) {
+    switch (plan->GetType()) {
+        case PlanNodeType::SEQUENTIAL_SCAN:
+            return std::make_unique<SeqScanExecutor>(
+                exec_ctx, std::unique_ptr<SeqScanPlanNode>(
+                              static_cast<SeqScanPlanNode*>(plan.release())));
+        case PlanNodeType::INDEX_SCAN:
+            return std::make_unique<IndexScanExecutor>(
+                exec_ctx,
+                std::unique_ptr<IndexScanPlanNode>(
+                    static_cast<IndexScanPlanNode*>(plan.release())));
+        case PlanNodeType::INDEX_RANGE_SCAN:
+            return std::make_unique<IndexRangeScanExecutor>(
+                exec_ctx,
+                std::unique_ptr<IndexRangeScanPlanNode>(
+                    static_cast<IndexRangeScanPlanNode*>(plan.release())));
+        case PlanNodeType::BITMAP_HEAP_SCAN:
+            return std::make_unique<BitmapHeapScanExecutor>(
+                exec_ctx,
+                std::unique_ptr<BitmapHeapScanPlanNode>(
+                    static_cast<BitmapHeapScanPlanNode*>(plan.release())));
+        case PlanNodeType::HASH_JOIN:
+            return std::make_unique<HashJoinExecutor>(
+                exec_ctx, std::unique_ptr<HashJoinPlanNode>(
+                              static_cast<HashJoinPlanNode*>(plan.release())));
+        case PlanNodeType::INDEX_NESTED_LOOP_JOIN:
+            return std::make_unique<IndexNestedLoopJoinExecutor>(
+                exec_ctx, std::unique_ptr<IndexNestedLoopJoinPlanNode>(
+                              static_cast<IndexNestedLoopJoinPlanNode*>(
+                                  plan.release())));
+        case PlanNodeType::AGGREGATION:
+            return std::make_unique<HashAggregationExecutor>(
+                exec_ctx,
+                std::unique_ptr<AggregationPlanNode>(
+                    static_cast<AggregationPlanNode*>(plan.release())));
+        case PlanNodeType::SORT:
+            return std::make_unique<SortExecutor>(
+                exec_ctx, std::unique_ptr<SortPlanNode>(
+                              static_cast<SortPlanNode*>(plan.release())));
+        case PlanNodeType::LIMIT:
+            return std::make_unique<LimitExecutor>(
+                exec_ctx, std::unique_ptr<LimitPlanNode>(
+                              static_cast<LimitPlanNode*>(plan.release())));
+        case PlanNodeType::PROJECTION:
+            return std::make_unique<ProjectionExecutor>(
+                exec_ctx,
+                std::unique_ptr<ProjectionPlanNode>(
+                    static_cast<ProjectionPlanNode*>(plan.release())));
+        case PlanNodeType::GATHER:
+            return std::make_unique<GatherExecutor>(
+                exec_ctx, std::unique_ptr<GatherPlanNode>(
+                              static_cast<GatherPlanNode*>(plan.release())));
+        case PlanNodeType::APPEND:
+            return std::make_unique<AppendExecutor>(
+                exec_ctx, std::unique_ptr<AppendPlanNode>(
+                              static_cast<AppendPlanNode*>(plan.release())));
+        case PlanNodeType::UPDATE:
+            return std::make_unique<UpdateExecutor>(
+                exec_ctx, std::unique_ptr<UpdatePlanNode>(
+                              static_cast<UpdatePlanNode*>(plan.release())));
+        case PlanNodeType::DELETE:
+            return std::make_unique<DeleteExecutor>(
+                exec_ctx, std::unique_ptr<DeletePlanNode>(
+                              static_cast<DeletePlanNode*>(plan.release())));
+        default:
+            throw ExecutionException("Unsupported child plan type");
+    }
+}
+
+/** 为CopyPlan复制出的计划创建执行器，EXPLAIN ANALYZE时包装一层 */
+static std::unique_ptr<Executor> CreateChildExecutor(
+    ExecutorContext* exec_ctx, std::unique_ptr<PlanNode> plan) {
+    const PlanNode* raw_plan = plan.get();
+    return WrapForProfiling(
+        exec_ctx, raw_plan,
+        CreateChildExecutorForPlan(exec_ctx, std::move(plan)));
+}
+
 /**
  * 投影执行器构造函数
  * 用于SELECT语句中的列投影操作
@@ -512,61 +2300,1458 @@ void ProjectionExecutor::Init() {
         throw ExecutionException("ProjectionExecutor: No child plan");
     }
 
-    // 根据子计划类型创建相应的执行器
-    // 这里采用plan复制的方式，避免所有权转移问题
-    if (child_plan->GetType() == PlanNodeType::SEQUENTIAL_SCAN) {
-        auto* seq_scan_plan = static_cast<const SeqScanPlanNode*>(child_plan);
-        auto new_seq_scan_plan = std::make_unique<SeqScanPlanNode>(
-            seq_scan_plan->GetOutputSchema(), seq_scan_plan->GetTableName(),
-            nullptr  // 暂不处理复杂的WHERE条件传递
-        );
-        child_executor_ = std::make_unique<SeqScanExecutor>(
-            exec_ctx_, std::move(new_seq_scan_plan));
-    } else {
+    // 这里采用plan复制的方式，避免所有权转移问题，WHERE条件一起复制
+    std::unique_ptr<PlanNode> child_copy = CopyPlan(child_plan);
+    if (!child_copy) {
         throw ExecutionException(
             "ProjectionExecutor: Unsupported child plan type");
     }
+    if (child_plan->GetType() == PlanNodeType::SEQUENTIAL_SCAN) {
+        auto* seq_scan_plan = static_cast<const SeqScanPlanNode*>(child_plan);
+        // 批量扫描只解码投影和WHERE条件用到的列
+        const Schema* scan_schema = seq_scan_plan->GetOutputSchema();
+        std::vector<bool> decoded_columns(scan_schema->GetColumnCount(),
+                                          false);
+        bool columns_known = MarkReferencedColumns(
+            seq_scan_plan->GetPredicate(), scan_schema, &decoded_columns);
+        for (const auto& expr : projection_plan->GetExpressions()) {
+            columns_known = columns_known &&
+                            MarkReferencedColumns(expr.get(), scan_schema,
+                                                  &decoded_columns);
+        }
+        if (columns_known) {
+            static_cast<SeqScanPlanNode*>(child_copy.get())
+                ->SetDecodedColumns(std::move(decoded_columns));
+        }
+    }
+    child_executor_ = CreateChildExecutor(exec_ctx_, std::move(child_copy));
 
     // 初始化子执行器
     child_executor_->Init();
 
-    // 创建表达式求值器，用于计算投影表达式
+    // 创建表达式求值器，用于批量计算投影表达式
     evaluator_ = std::make_unique<ExpressionEvaluator>(
         child_executor_->GetOutputSchema());
+
+    // 逐行计算用的投影表达式在这里编译一次
+    compiled_expressions_.clear();
+    for (const auto& expr : projection_plan->GetExpressions()) {
+        compiled_expressions_.push_back(CompiledExpression::Compile(
+            expr.get(), child_executor_->GetOutputSchema()));
+    }
 }
 
 /**
  * 执行投影操作
  * 从子执行器获取记录，应用投影表达式，返回指定的列
+ * 子记录读进成员child_tuple_，投影结果原地写进调用方的tuple，
+ * 两边的列值存储都跨Next复用；直接的列引用从子记录原地复制，不经过临时值
  * @param tuple 输出参数，存储投影后的记录
  * @param rid 输出参数，存储记录的RID
  * @return 是否还有更多记录
  */
 bool ProjectionExecutor::Next(Tuple* tuple, RID* rid) {
-    auto* projection_plan = GetProjectionPlan();
-
     // 从子执行器获取下一条记录
-    Tuple child_tuple;
     RID child_rid;
-    if (!child_executor_->Next(&child_tuple, &child_rid)) {
+    if (!child_executor_->Next(&child_tuple_, &child_rid)) {
         return false;  // 子执行器没有更多数据
     }
 
     // 计算投影表达式，生成新的列值
-    std::vector<Value> projected_values;
-    const auto& expressions = projection_plan->GetExpressions();
-
-    for (const auto& expr : expressions) {
-        // 对每个投影表达式求值
-        Value value = evaluator_->Evaluate(expr.get(), child_tuple);
-        projected_values.push_back(value);
+    const auto& child_values = child_tuple_.GetValues();
+    tuple->Reset(compiled_expressions_.size());
+    for (size_t i = 0; i < compiled_expressions_.size(); i++) {
+        const auto& compiled = compiled_expressions_[i];
+        if (compiled.IsColumn() &&
+            compiled.GetColumnIndex() < child_values.size()) {
+            tuple->SetValue(i, child_values[compiled.GetColumnIndex()]);
+        } else {
+            tuple->SetValue(i, compiled.Evaluate(child_tuple_));
+        }
     }
 
-    // 创建投影后的tuple
-    *tuple = Tuple(projected_values, GetOutputSchema());
+    // 按输出schema整理投影后的tuple
+    tuple->Normalize(GetOutputSchema());
     *rid = child_rid;
 
     return true;
 }
 
-}  // namespace SimpleRDBMS
\ No newline at end of file
+/**
+ * 批量执行投影
+ * 实现思路：从子执行器取一批记录，每个投影表达式对整批按列求值一次，
+ * 输出批次只包含子批次里选中的行，所有行都有效
+ */
+bool ProjectionExecutor::NextBatch(VectorBatch* batch) {
+    if (!child_executor_->NextBatch(&child_batch_)) {
+        return false;
+    }
+
+    const auto& expressions = GetProjectionPlan()->GetExpressions();
+    batch->Reset(expressions.size());
+    for (uint32_t row : child_batch_.GetSelection()) {
+        batch->AppendRID(child_batch_.GetRID(row));
+    }
+    for (size_t i = 0; i < expressions.size(); i++) {
+        evaluator_->EvaluateBatch(expressions[i].get(), child_batch_,
+                                  batch->GetMutableColumn(i));
+    }
+    return batch->GetRowCount() > 0;
+}
+
+/**
+ * 哈希连接执行器构造函数
+ */
+HashJoinExecutor::HashJoinExecutor(ExecutorContext* exec_ctx,
+                                   std::unique_ptr<HashJoinPlanNode> plan)
+    : Executor(exec_ctx, std::move(plan)) {}
+
+/** 连接键的哈希值决定tuple所在的分区，用高位，低位留给哈希表的槽位 */
+static size_t PartitionOf(uint64_t hash) {
+    return (hash >> 40) % HASH_JOIN_PARTITIONS;
+}
+
+/**
+ * 初始化哈希连接
+ * 实现思路：
+ * 1. 按计划复制左右子计划，创建并初始化子执行器，在各自的schema上编译连接键
+ * 2. 轮流从两边各读一行，直到有一边读完或者读出的数据超过内存预算
+ * 3. 有一边读完：用它建哈希表（两边都读完时用小的一边），另一边探测；
+ *    探测的一边还没读完时，建表的同时把键放进布隆过滤器交给探测一边，
+ *    剩下的探测行里连接不上的在扫描里求WHERE条件之前就被丢掉
+ * 4. 超过预算：两边全部分区写到临时页面，Next时逐个分区建表和探测
+ */
+void HashJoinExecutor::Init() {
+    auto* join_plan = GetHashJoinPlan();
+    if (!join_plan->GetLeftPlan() || !join_plan->GetRightPlan()) {
+        throw ExecutionException("HashJoinExecutor: Missing child plan");
+    }
+
+    JoinInput* inputs[] = {&left_, &right_};
+    const PlanNode* child_plans[] = {join_plan->GetLeftPlan(),
+                                     join_plan->GetRightPlan()};
+    const Expression* keys[] = {join_plan->GetLeftKey(),
+                                join_plan->GetRightKey()};
+    for (int i = 0; i < 2; i++) {
+        JoinInput* input = inputs[i];
+        std::unique_ptr<PlanNode> child_copy = CopyPlan(child_plans[i]);
+        if (!child_copy) {
+            throw ExecutionException(
+                "HashJoinExecutor: Unsupported child plan type");
+        }
+        input->executor =
+            CreateChildExecutor(exec_ctx_, std::move(child_copy));
+        input->executor->Init();
+        input->schema = input->executor->GetOutputSchema();
+        input->key = CompiledExpression::Compile(keys[i], input->schema);
+        input->exhausted = false;
+        input->arena.Clear();
+        input->rows.clear();
+        input->partitions.clear();
+    }
+    has_predicate_ = join_plan->GetPredicate() != nullptr;
+    if (has_predicate_) {
+        predicate_ = CompiledExpression::Compile(join_plan->GetPredicate(),
+                                                 GetOutputSchema());
+    }
+
+    table_.Clear();
+    runtime_filter_.reset();
+    build_arena_.Clear();
+    spilled_ = false;
+    partition_index_ = 0;
+    probe_reader_.reset();
+    probe_row_index_ = 0;
+    has_probe_row_ = false;
+
+    // 轮流读两边，先读完的一边就是较小的输入；超过预算或者记账器不给
+    // 更多内存时分区
+    size_t budget = exec_ctx_->GetOperatorBudget(join_plan->GetMemoryBudget());
+    reservation_.SetTracker(exec_ctx_->GetMemoryTracker());
+    while (!left_.exhausted && !right_.exhausted) {
+        exec_ctx_->CheckCancellation(2);
+        BufferRow(&left_);
+        BufferRow(&right_);
+        size_t used = left_.arena.GetAllocatedBytes() +
+                      right_.arena.GetAllocatedBytes();
+        if (used > budget || !reservation_.TryResize(used)) {
+            spilled_ = true;
+            break;
+        }
+    }
+
+    if (!spilled_) {
+        if (left_.exhausted && right_.exhausted) {
+            build_is_left_ = left_.arena.GetAllocatedBytes() <=
+                             right_.arena.GetAllocatedBytes();
+        } else {
+            build_is_left_ = left_.exhausted;
+        }
+        build_ = build_is_left_ ? &left_ : &right_;
+        probe_ = build_is_left_ ? &right_ : &left_;
+        bool push_filter = !probe_->exhausted && !build_->rows.empty();
+        if (push_filter) {
+            runtime_filter_ =
+                std::make_shared<BloomFilter>(build_->rows.size());
+        }
+        for (const auto& row : build_->rows) {
+            exec_ctx_->CheckCancellation();
+            InsertBuildRow(row.first, row.second);
+        }
+        if (push_filter &&
+            !probe_->executor->SetRuntimeFilter(
+                runtime_filter_, build_is_left_ ? join_plan->GetRightKey()
+                                                : join_plan->GetLeftKey())) {
+            runtime_filter_.reset();
+        }
+        // 两边都已经读完，不能再分区，哈希表要不到内存时查询失败
+        reservation_.Resize(
+            left_.arena.GetAllocatedBytes() + right_.arena.GetAllocatedBytes() +
+            table_.GetMemoryUsage() +
+            (runtime_filter_ != nullptr ? runtime_filter_->GetMemoryUsage()
+                                        : 0));
+        LOG_DEBUG("HashJoinExecutor::Init: Built hash table on "
+                  << (build_is_left_ ? "left" : "right") << " input with "
+                  << table_.GetSize() << " rows");
+        return;
+    }
+
+    LOG_DEBUG("HashJoinExecutor::Init: Memory budget of "
+              << budget << " bytes exceeded, partitioning both inputs");
+    PartitionInput(&left_);
+    PartitionInput(&right_);
+    reservation_.TryResize(0);
+}
+
+bool HashJoinExecutor::BufferRow(JoinInput* input) {
+    Tuple tuple;
+    RID rid;
+    if (!input->executor->Next(&tuple, &rid)) {
+        input->exhausted = true;
+        return false;
+    }
+    size_t size = tuple.GetSerializedSize();
+    char* data = input->arena.Allocate(size);
+    tuple.SerializeTo(data);
+    input->rows.emplace_back(data, static_cast<uint16_t>(size));
+    return true;
+}
+
+/**
+ * 把一边的所有行写到分区
+ * 实现思路：已经序列化在内存里的行用TupleView求连接键，
+ * 剩下的行从子执行器读出后序列化到一个复用的缓冲区再写入；
+ * 写完后释放内存里的行，结束每个分区的最后一页
+ */
+void HashJoinExecutor::PartitionInput(JoinInput* input) {
+    BufferPoolManager* bpm = exec_ctx_->GetBufferPoolManager();
+    input->partitions.clear();
+    for (size_t i = 0; i < HASH_JOIN_PARTITIONS; i++) {
+        input->partitions.push_back(std::make_unique<SpillPartition>(bpm));
+    }
+
+    for (const auto& row : input->rows) {
+        TupleView view(row.first, row.second, input->schema, RID{});
+        uint64_t hash = JoinHashTable::HashValue(input->key.Evaluate(view));
+        input->partitions[PartitionOf(hash)]->Append(row.first, row.second);
+    }
+    input->rows.clear();
+    input->arena.Clear();
+
+    std::vector<char> buffer;
+    Tuple tuple;
+    RID rid;
+    while (!input->exhausted) {
+        exec_ctx_->CheckCancellation();
+        if (!input->executor->Next(&tuple, &rid)) {
+            input->exhausted = true;
+            break;
+        }
+        buffer.resize(tuple.GetSerializedSize());
+        tuple.SerializeTo(buffer.data());
+        uint64_t hash = JoinHashTable::HashValue(input->key.Evaluate(tuple));
+        input->partitions[PartitionOf(hash)]->Append(
+            buffer.data(), static_cast<uint16_t>(buffer.size()));
+    }
+
+    for (auto& partition : input->partitions) {
+        partition->Finish();
+    }
+}
+
+void HashJoinExecutor::InsertBuildRow(const char* data, uint16_t size) {
+    TupleView view(data, size, build_->schema, RID{});
+    uint64_t hash = JoinHashTable::HashValue(build_->key.Evaluate(view));
+    table_.Insert(hash, data, size);
+    if (runtime_filter_ != nullptr) {
+        runtime_filter_->Insert(hash);
+    }
+}
+
+/**
+ * 切换到下一个分区
+ * 实现思路：跳过有一边为空的分区（内连接不会有结果），
+ * 用字节数较小的一边建表，建表的行复制到build_arena_，另一边顺序探测；
+ * 处理过的分区立即释放临时页面
+ */
+bool HashJoinExecutor::AdvancePartition() {
+    if (partition_index_ > 0) {
+        left_.partitions[partition_index_ - 1]->Drop();
+        right_.partitions[partition_index_ - 1]->Drop();
+    }
+    probe_reader_.reset();
+    table_.Clear();
+    build_arena_.Clear();
+
+    while (partition_index_ < HASH_JOIN_PARTITIONS) {
+        SpillPartition* left_partition =
+            left_.partitions[partition_index_].get();
+        SpillPartition* right_partition =
+            right_.partitions[partition_index_].get();
+        partition_index_++;
+        if (left_partition->GetTupleCount() == 0 ||
+            right_partition->GetTupleCount() == 0) {
+            left_partition->Drop();
+            right_partition->Drop();
+            continue;
+        }
+
+        build_is_left_ =
+            left_partition->GetBytes() <= right_partition->GetBytes();
+        build_ = build_is_left_ ? &left_ : &right_;
+        probe_ = build_is_left_ ? &right_ : &left_;
+        SpillPartition* build_partition =
+            build_is_left_ ? left_partition : right_partition;
+
+        SpillPartition::Reader reader(build_partition);
+        const char* data = nullptr;
+        uint16_t size = 0;
+        while (reader.Next(&data, &size)) {
+            exec_ctx_->CheckCancellation();
+            InsertBuildRow(build_arena_.Append(data, size), size);
+            // 分区不再继续细分，一个分区放不下时查询失败
+            reservation_.Resize(build_arena_.GetAllocatedBytes() +
+                                table_.GetMemoryUsage());
+        }
+        probe_reader_ = std::make_unique<SpillPartition::Reader>(
+            build_is_left_ ? right_partition : left_partition);
+        return true;
+    }
+    return false;
+}
+
+void HashJoinExecutor::SetProbeRow(const char* data) {
+    probe_tuple_.DeserializeFrom(data, probe_->schema);
+    probe_key_ = probe_->key.Evaluate(probe_tuple_);
+    probe_hash_ = JoinHashTable::HashValue(probe_key_);
+    probe_position_ = table_.Begin(probe_hash_);
+}
+
+bool HashJoinExecutor::NextProbeRow() {
+    if (spilled_) {
+        const char* data = nullptr;
+        uint16_t size = 0;
+        while (!probe_reader_ || !probe_reader_->Next(&data, &size)) {
+            if (!AdvancePartition()) {
+                return false;
+            }
+        }
+        SetProbeRow(data);
+        return true;
+    }
+
+    // 建表的一边为空时不会有结果，剩下的探测行不用再读
+    if (table_.GetSize() == 0) {
+        return false;
+    }
+    if (probe_row_index_ < probe_->rows.size()) {
+        SetProbeRow(probe_->rows[probe_row_index_++].first);
+        return true;
+    }
+    RID rid;
+    if (probe_->exhausted || !probe_->executor->Next(&probe_tuple_, &rid)) {
+        probe_->exhausted = true;
+        return false;
+    }
+    probe_key_ = probe_->key.Evaluate(probe_tuple_);
+    probe_hash_ = JoinHashTable::HashValue(probe_key_);
+    probe_position_ = table_.Begin(probe_hash_);
+    return true;
+}
+
+/**
+ * 获取下一条连接结果
+ * 实现思路：沿当前探测行在哈希表里的探测序列找哈希值相同的槽位，
+ * 用TupleView解码建表一边的连接键确认相等，再拼出左右两边的值，
+ * 通过连接后的过滤条件才返回；当前探测行没有更多匹配时取下一条
+ */
+bool HashJoinExecutor::Next(Tuple* tuple, RID* rid) {
+    while (true) {
+        if (has_probe_row_) {
+            const JoinHashTable::Entry* entry;
+            while ((entry = table_.FindNext(probe_hash_, &probe_position_)) !=
+                   nullptr) {
+                exec_ctx_->CheckCancellation();
+                TupleView view(entry->data, entry->size, build_->schema,
+                               RID{});
+                if (!ExpressionEvaluator::CompareValues(
+                        build_->key.Evaluate(view), probe_key_,
+                        BinaryOpExpression::OpType::EQUALS)) {
+                    continue;
+                }
+                Tuple build_tuple = view.ToTuple();
+                const Tuple& left_tuple =
+                    build_is_left_ ? build_tuple : probe_tuple_;
+                const Tuple& right_tuple =
+                    build_is_left_ ? probe_tuple_ : build_tuple;
+                std::vector<Value> values = left_tuple.GetValues();
+                values.insert(values.end(), right_tuple.GetValues().begin(),
+                              right_tuple.GetValues().end());
+                Tuple joined(std::move(values), GetOutputSchema());
+                if (has_predicate_ && !predicate_.EvaluateAsBoolean(joined)) {
+                    continue;
+                }
+                *tuple = std::move(joined);
+                *rid = RID{INVALID_PAGE_ID, 0};
+                return true;
+            }
+        }
+        exec_ctx_->CheckCancellation();
+        has_probe_row_ = NextProbeRow();
+        if (!has_probe_row_) {
+            return false;
+        }
+    }
+}
+
+/**
+ * 索引嵌套循环连接执行器构造函数
+ */
+IndexNestedLoopJoinExecutor::IndexNestedLoopJoinExecutor(
+    ExecutorContext* exec_ctx,
+    std::unique_ptr<IndexNestedLoopJoinPlanNode> plan)
+    : Executor(exec_ctx, std::move(plan)) {}
+
+/**
+ * 初始化索引嵌套循环连接
+ * 按计划复制外表的扫描计划并初始化，查找内表、内表的连接列，
+ * 编译外表连接键、内表条件和连接后的条件
+ */
+void IndexNestedLoopJoinExecutor::Init() {
+    auto* join_plan = GetJoinPlan();
+    inner_table_ = ResolveTable(exec_ctx_, join_plan,
+                                join_plan->GetInnerTableName());
+    if (inner_table_ == nullptr) {
+        throw ExecutionException("Table not found: " +
+                                 join_plan->GetInnerTableName());
+    }
+    if (ResolveIndex(exec_ctx_, join_plan, join_plan->GetIndexName()) ==
+        nullptr) {
+        throw ExecutionException("Index not found: " +
+                                 join_plan->GetIndexName());
+    }
+    const Schema* inner_schema = inner_table_->schema.get();
+    inner_key_index_ =
+        inner_schema->GetColumnIdx(join_plan->GetInnerKeyColumn());
+
+    std::unique_ptr<PlanNode> outer_copy = CopyPlan(join_plan->GetOuterPlan());
+    if (!outer_copy) {
+        throw ExecutionException(
+            "IndexNestedLoopJoinExecutor: Unsupported outer plan type");
+    }
+    outer_executor_ = CreateChildExecutor(exec_ctx_, std::move(outer_copy));
+    outer_executor_->Init();
+
+    outer_key_ = CompiledExpression::Compile(
+        join_plan->GetOuterKey(), outer_executor_->GetOutputSchema());
+    has_inner_predicate_ = join_plan->GetInnerPredicate() != nullptr;
+    if (has_inner_predicate_) {
+        inner_predicate_ = CompiledExpression::Compile(
+            join_plan->GetInnerPredicate(), inner_schema);
+    }
+    has_predicate_ = join_plan->GetPredicate() != nullptr;
+    if (has_predicate_) {
+        predicate_ = CompiledExpression::Compile(join_plan->GetPredicate(),
+                                                 GetOutputSchema());
+    }
+    inner_rids_.clear();
+    next_inner_ = 0;
+    Transaction* txn = exec_ctx_->GetTransaction();
+    read_view_ = txn != nullptr ? txn->GetReadView() : nullptr;
+    inner_changed_.clear();
+    inner_snapshot_rows_.clear();
+    next_snapshot_inner_ = 0;
+    CollectSnapshotChanges(inner_table_->table_heap.get(), read_view_,
+                           &inner_changed_, &inner_snapshot_rows_);
+    // 还没有外表行，第一次Next直接去读外表
+    next_snapshot_inner_ = inner_snapshot_rows_.size();
+}
+
+/**
+ * 获取下一条连接结果
+ * 实现思路：当前外表行的RID用完后读下一条外表行并查索引；
+ * 每个RID从表堆读出内表记录，确认连接列相等、满足内表条件后
+ * 拼出左右两边的值，再检查连接后的条件；
+ * 快照下和表堆不同的内表记录跳过，改用它们在快照下的版本逐个比较
+ */
+bool IndexNestedLoopJoinExecutor::Next(Tuple* tuple, RID* rid) {
+    auto* join_plan = GetJoinPlan();
+    IndexManager* index_manager =
+        exec_ctx_->GetTableManager()->GetIndexManager();
+    txn_id_t txn_id = exec_ctx_->GetTransaction()->GetTxnId();
+    while (true) {
+        while (next_inner_ < inner_rids_.size()) {
+            exec_ctx_->CheckCancellation();
+            Tuple inner_tuple;
+            const RID& inner_rid = inner_rids_[next_inner_++];
+            if (inner_changed_.count(inner_rid) > 0 ||
+                !inner_table_->table_heap->GetTuple(inner_rid, &inner_tuple,
+                                                    txn_id, read_view_)) {
+                continue;
+            }
+            if (JoinInner(inner_tuple, tuple)) {
+                *rid = RID{INVALID_PAGE_ID, 0};
+                return true;
+            }
+        }
+        // 索引里的键是最新的，快照下的旧版本逐个比较连接键
+        while (next_snapshot_inner_ < inner_snapshot_rows_.size()) {
+            exec_ctx_->CheckCancellation();
+            if (JoinInner(inner_snapshot_rows_[next_snapshot_inner_++],
+                          tuple)) {
+                *rid = RID{INVALID_PAGE_ID, 0};
+                return true;
+            }
+        }
+
+        exec_ctx_->CheckCancellation();
+        RID outer_rid;
+        if (!outer_executor_->Next(&outer_tuple_, &outer_rid)) {
+            return false;
+        }
+        outer_key_value_ = outer_key_.Evaluate(outer_tuple_);
+        inner_rids_.clear();
+        next_inner_ = 0;
+        next_snapshot_inner_ = 0;
+        index_manager->FindEntry(join_plan->GetIndexName(),
+                                 std::vector<Value>{outer_key_value_},
+                                 &inner_rids_);
+    }
+}
+
+bool IndexNestedLoopJoinExecutor::JoinInner(const Tuple& inner_tuple,
+                                            Tuple* tuple) {
+    auto* join_plan = GetJoinPlan();
+    if (!ExpressionEvaluator::CompareValues(
+            inner_tuple.GetValue(inner_key_index_), outer_key_value_,
+            BinaryOpExpression::OpType::EQUALS)) {
+        return false;
+    }
+    if (has_inner_predicate_ &&
+        !inner_predicate_.EvaluateAsBoolean(inner_tuple)) {
+        return false;
+    }
+    const Tuple& left_tuple =
+        join_plan->IsOuterLeft() ? outer_tuple_ : inner_tuple;
+    const Tuple& right_tuple =
+        join_plan->IsOuterLeft() ? inner_tuple : outer_tuple_;
+    std::vector<Value> values = left_tuple.GetValues();
+    values.insert(values.end(), right_tuple.GetValues().begin(),
+                  right_tuple.GetValues().end());
+    Tuple joined(std::move(values), GetOutputSchema());
+    if (has_predicate_ && !predicate_.EvaluateAsBoolean(joined)) {
+        return false;
+    }
+    *tuple = std::move(joined);
+    return true;
+}
+
+/**
+ * 哈希聚合执行器构造函数
+ */
+HashAggregationExecutor::HashAggregationExecutor(
+    ExecutorContext* exec_ctx, std::unique_ptr<AggregationPlanNode> plan)
+    : Executor(exec_ctx, std::move(plan)) {}
+
+/** 分组键的哈希值决定部分结果所在的分区，用高位，低位留给哈希表的槽位 */
+static size_t AggregationPartitionOf(uint64_t hash) {
+    return (hash >> 40) % AGGREGATION_PARTITIONS;
+}
+
+/** 表达式是schema里的列引用时返回列下标，用来读取NULL标记，否则返回-1 */
+static int NullableColumnIndex(const Expression* expr, const Schema* schema) {
+    if (expr == nullptr || expr->GetType() != Expression::ExprType::COLUMN_REF) {
+        return -1;
+    }
+    const std::string& name =
+        static_cast<const ColumnRefExpression*>(expr)->GetColumnName();
+    if (!schema->HasColumn(name)) {
+        return -1;
+    }
+    return static_cast<int>(schema->GetColumnIdx(name));
+}
+
+/**
+ * 初始化哈希聚合
+ * 实现思路：
+ * 1. 按计划复制子计划并初始化子执行器，推断分组键的类型建立key schema
+ * 2. 在子执行器的schema上编译分组表达式和聚合参数
+ * 3. 读完所有输入累加到哈希表，超过预算就把部分结果写到分区
+ * 4. 没有溢出时直接算出全部结果；没有GROUP BY且输入为空时也输出一行
+ */
+void HashAggregationExecutor::Init() {
+    auto* aggregation_plan = GetAggregationPlan();
+    const PlanNode* child_plan = aggregation_plan->GetChild(0);
+    if (!child_plan) {
+        throw ExecutionException("HashAggregationExecutor: No child plan");
+    }
+    std::unique_ptr<PlanNode> child_copy = CopyPlan(child_plan);
+    if (!child_copy) {
+        throw ExecutionException(
+            "HashAggregationExecutor: Unsupported child plan type");
+    }
+    child_executor_ = CreateChildExecutor(exec_ctx_, std::move(child_copy));
+    child_executor_->Init();
+    const Schema* child_schema = child_executor_->GetOutputSchema();
+
+    std::vector<Column> key_columns;
+    group_by_.clear();
+    group_by_columns_.clear();
+    for (const auto& expr : aggregation_plan->GetGroupBy()) {
+        TypeId type = ExpressionEvaluator::InferType(expr.get(), child_schema);
+        if (type == TypeId::INVALID) {
+            throw ExecutionException(
+                "HashAggregationExecutor: Cannot determine the type of a "
+                "GROUP BY expression");
+        }
+        key_columns.push_back(
+            Column{"group" + std::to_string(key_columns.size()), type,
+                   type == TypeId::VARCHAR ? 65535u : 0u, true, false});
+        group_by_.push_back(CompiledExpression::Compile(expr.get(), child_schema));
+        group_by_columns_.push_back(
+            NullableColumnIndex(expr.get(), child_schema));
+    }
+    key_schema_ = std::make_unique<Schema>(key_columns);
+
+    std::vector<AggregationHashTable::Aggregate> aggregates;
+    arguments_.clear();
+    argument_columns_.clear();
+    for (const auto& aggregate : aggregation_plan->GetAggregates()) {
+        const Expression* argument = aggregate.argument.get();
+        TypeId input_type =
+            aggregate.type == AggregateType::COUNT_STAR
+                ? TypeId::BIGINT
+                : ExpressionEvaluator::InferType(argument, child_schema);
+        aggregates.push_back({aggregate.type, input_type});
+        arguments_.push_back(argument != nullptr
+                                 ? CompiledExpression::Compile(argument,
+                                                               child_schema)
+                                 : CompiledExpression());
+        argument_columns_.push_back(NullableColumnIndex(argument, child_schema));
+    }
+    table_ = std::make_unique<AggregationHashTable>(key_schema_.get(),
+                                                    std::move(aggregates));
+
+    spilled_ = false;
+    partitions_.clear();
+    partition_index_ = 0;
+    results_.clear();
+    result_index_ = 0;
+
+    size_t budget =
+        exec_ctx_->GetOperatorBudget(aggregation_plan->GetMemoryBudget());
+    reservation_.SetTracker(exec_ctx_->GetMemoryTracker());
+    const auto& plan_aggregates = aggregation_plan->GetAggregates();
+    std::vector<Value> key(group_by_.size());
+    std::vector<bool> key_nulls(group_by_.size());
+    std::vector<Value> argument_values(arguments_.size());
+    std::vector<const Value*> arguments(arguments_.size());
+    Tuple tuple;
+    RID rid;
+    while (child_executor_->Next(&tuple, &rid)) {
+        exec_ctx_->CheckCancellation();
+        for (size_t i = 0; i < group_by_.size(); i++) {
+            int column = group_by_columns_[i];
+            key_nulls[i] = column >= 0 && tuple.IsNull(column);
+            if (!key_nulls[i]) {
+                key[i] = group_by_[i].Evaluate(tuple);
+            }
+        }
+        for (size_t i = 0; i < arguments_.size(); i++) {
+            int column = argument_columns_[i];
+            arguments[i] = nullptr;
+            if (plan_aggregates[i].type == AggregateType::COUNT_STAR ||
+                (column >= 0 && tuple.IsNull(column))) {
+                continue;
+            }
+            argument_values[i] = arguments_[i].Evaluate(tuple);
+            arguments[i] = &argument_values[i];
+        }
+        table_->Accumulate(key, key_nulls, arguments);
+        size_t used = table_->GetMemoryUsage();
+        if (used > budget || !reservation_.TryResize(used)) {
+            SpillTable();
+            reservation_.TryResize(table_->GetMemoryUsage());
+        }
+    }
+
+    if (spilled_) {
+        SpillTable();
+        for (auto& partition : partitions_) {
+            partition->Finish();
+        }
+        LOG_DEBUG("HashAggregationExecutor::Init: Memory budget of "
+                  << budget << " bytes exceeded, merging "
+                  << partitions_.size() << " partitions");
+        return;
+    }
+    if (group_by_.empty() && table_->GetGroupCount() == 0) {
+        table_->AddGroup(key, key_nulls);
+    }
+    CollectResults();
+    table_->Clear();
+}
+
+void HashAggregationExecutor::SpillTable() {
+    if (partitions_.empty()) {
+        BufferPoolManager* bpm = exec_ctx_->GetBufferPoolManager();
+        for (size_t i = 0; i < AGGREGATION_PARTITIONS; i++) {
+            partitions_.push_back(std::make_unique<SpillPartition>(bpm));
+        }
+    }
+    std::vector<char> buffer;
+    table_->ForEachPartial([this, &buffer](uint64_t hash,
+                                           const Tuple& partial) {
+        buffer.resize(partial.GetSerializedSize());
+        partial.SerializeTo(buffer.data());
+        partitions_[AggregationPartitionOf(hash)]->Append(
+            buffer.data(), static_cast<uint16_t>(buffer.size()));
+    });
+    table_->Clear();
+    spilled_ = true;
+}
+
+void HashAggregationExecutor::CollectResults() {
+    const auto& output_columns = GetAggregationPlan()->GetOutputColumns();
+    const Schema* output_schema = GetOutputSchema();
+    table_->ForEachResult([this, &output_columns, output_schema](
+                              const Tuple& key,
+                              const std::vector<Value>& values,
+                              const std::vector<bool>& nulls) {
+        std::vector<Value> row;
+        std::vector<bool> row_nulls;
+        for (const auto& column : output_columns) {
+            if (column.is_aggregate) {
+                row.push_back(values[column.index]);
+                row_nulls.push_back(nulls[column.index]);
+            } else {
+                row.push_back(key.GetValue(column.index));
+                row_nulls.push_back(key.IsNull(column.index));
+            }
+        }
+        Tuple output(std::move(row), output_schema);
+        for (size_t i = 0; i < row_nulls.size(); i++) {
+            if (row_nulls[i]) {
+                output.SetNull(i, true);
+            }
+        }
+        results_.push_back(std::move(output));
+    });
+}
+
+bool HashAggregationExecutor::AdvancePartition() {
+    results_.clear();
+    result_index_ = 0;
+    while (partition_index_ < partitions_.size()) {
+        SpillPartition* partition = partitions_[partition_index_++].get();
+        if (partition->GetTupleCount() == 0) {
+            continue;
+        }
+        SpillPartition::Reader reader(partition);
+        const char* data;
+        uint16_t size;
+        Tuple partial;
+        while (reader.Next(&data, &size)) {
+            exec_ctx_->CheckCancellation();
+            partial.DeserializeFrom(data, table_->GetPartialSchema());
+            table_->MergePartial(partial);
+            // 分区不再继续细分，一个分区的分组放不下时查询失败
+            reservation_.Resize(table_->GetMemoryUsage());
+        }
+        partition->Drop();
+        CollectResults();
+        table_->Clear();
+        return true;
+    }
+    return false;
+}
+
+bool HashAggregationExecutor::Next(Tuple* tuple, RID* rid) {
+    while (true) {
+        if (result_index_ < results_.size()) {
+            *tuple = std::move(results_[result_index_++]);
+            *rid = RID{INVALID_PAGE_ID, 0};
+            return true;
+        }
+        if (!spilled_ || !AdvancePartition()) {
+            return false;
+        }
+    }
+}
+
+/**
+ * 排序执行器构造函数
+ */
+SortExecutor::SortExecutor(ExecutorContext* exec_ctx,
+                           std::unique_ptr<SortPlanNode> plan)
+    : Executor(exec_ctx, std::move(plan)) {}
+
+int SortExecutor::CompareRows(const SortRow& a, const SortRow& b) const {
+    for (size_t i = 0; i < keys_.size(); i++) {
+        int result = 0;
+        if (a.nulls[i] || b.nulls[i]) {
+            // NULL比任何值都大
+            result = a.nulls[i] == b.nulls[i] ? 0 : (a.nulls[i] ? 1 : -1);
+        } else if (ExpressionEvaluator::CompareValues(
+                       a.keys[i], b.keys[i],
+                       BinaryOpExpression::OpType::LESS_THAN)) {
+            result = -1;
+        } else if (ExpressionEvaluator::CompareValues(
+                       b.keys[i], a.keys[i],
+                       BinaryOpExpression::OpType::LESS_THAN)) {
+            result = 1;
+        }
+        if (result != 0) {
+            return ascending_[i] ? result : -result;
+        }
+    }
+    return 0;
+}
+
+void SortExecutor::EvaluateKeys(const Tuple& tuple, SortRow* row) const {
+    row->keys.resize(keys_.size());
+    row->nulls.resize(keys_.size());
+    for (size_t i = 0; i < keys_.size(); i++) {
+        int column = key_columns_[i];
+        row->nulls[i] = column >= 0 && tuple.IsNull(column);
+        if (!row->nulls[i]) {
+            row->keys[i] = keys_[i].Evaluate(tuple);
+        }
+    }
+}
+
+void SortExecutor::EvaluateKeys(const TupleView& view, SortRow* row) const {
+    row->keys.resize(keys_.size());
+    row->nulls.resize(keys_.size());
+    for (size_t i = 0; i < keys_.size(); i++) {
+        int column = key_columns_[i];
+        row->nulls[i] = column >= 0 && view.IsNull(column);
+        if (!row->nulls[i]) {
+            row->keys[i] = keys_[i].Evaluate(view);
+        }
+    }
+}
+
+void SortExecutor::StoreRow(const Tuple& tuple, SortRow* row) {
+    size_t size = tuple.GetSerializedSize();
+    if (size > UINT16_MAX) {
+        throw ExecutionException("SortExecutor: tuple too large to sort (" +
+                                 std::to_string(size) + " bytes)");
+    }
+    char* data = arena_.Allocate(size);
+    tuple.SerializeTo(data);
+    row->data = data;
+    row->size = static_cast<uint16_t>(size);
+    live_bytes_ += size;
+}
+
+void SortExecutor::OfferTopN(const Tuple& tuple) {
+    auto less = [this](const SortRow& a, const SortRow& b) {
+        return CompareRows(a, b) < 0;
+    };
+    size_t limit = static_cast<size_t>(GetSortPlan()->GetLimit());
+    EvaluateKeys(tuple, &candidate_);
+    if (rows_.size() < limit) {
+        StoreRow(tuple, &candidate_);
+        rows_.push_back(std::move(candidate_));
+        std::push_heap(rows_.begin(), rows_.end(), less);
+        return;
+    }
+    // 不比堆顶（目前第n好的行）更好的行直接丢掉，不用序列化
+    if (CompareRows(candidate_, rows_.front()) >= 0) {
+        return;
+    }
+    std::pop_heap(rows_.begin(), rows_.end(), less);
+    live_bytes_ -= rows_.back().size;
+    StoreRow(tuple, &candidate_);
+    std::swap(rows_.back(), candidate_);
+    std::push_heap(rows_.begin(), rows_.end(), less);
+    if (arena_.GetAllocatedBytes() > 2 * live_bytes_ + 64 * 1024) {
+        CompactArena();
+    }
+}
+
+void SortExecutor::CompactArena() {
+    TupleArena arena;
+    for (auto& row : rows_) {
+        row.data = arena.Append(row.data, row.size);
+    }
+    arena_ = std::move(arena);
+}
+
+void SortExecutor::SpillRun() {
+    std::sort(rows_.begin(), rows_.end(),
+              [this](const SortRow& a, const SortRow& b) {
+                  return CompareRows(a, b) < 0;
+              });
+    auto run = std::make_unique<SpillPartition>(
+        exec_ctx_->GetBufferPoolManager());
+    for (const auto& row : rows_) {
+        run->Append(row.data, row.size);
+    }
+    run->Finish();
+    runs_.push_back(std::move(run));
+    exec_ctx_->CheckCancellation(rows_.size());
+    rows_.clear();
+    arena_.Clear();
+    live_bytes_ = 0;
+    reservation_.TryResize(GetMemoryUsage());
+}
+
+bool SortExecutor::AdvanceRun(RunCursor* cursor) const {
+    const char* data;
+    uint16_t size;
+    if (!cursor->reader->Next(&data, &size)) {
+        return false;
+    }
+    cursor->row.data = data;
+    cursor->row.size = size;
+    EvaluateKeys(
+        TupleView(data, size, child_executor_->GetOutputSchema(), RID{}),
+        &cursor->row);
+    return true;
+}
+
+bool SortExecutor::RunAfter(size_t a, size_t b) const {
+    int result = CompareRows(cursors_[a].row, cursors_[b].row);
+    // 键相同时先输出前面的段，段内部是按输入顺序排的
+    return result != 0 ? result > 0 : a > b;
+}
+
+size_t SortExecutor::GetMemoryUsage() const {
+    // 按存进来的字节数计算，内存区整块申请，已申请的字节数粒度太粗
+    return live_bytes_ + rows_.capacity() * sizeof(SortRow) +
+           rows_.size() * keys_.size() * (sizeof(Value) + 1);
+}
+
+/**
+ * 初始化排序
+ * 实现思路：
+ * 1. 按计划复制子计划并初始化子执行器，在它的schema上编译排序键
+ * 2. 有LIMIT时把每一行交给Top-N堆，堆超过预算时改成外部排序
+ * 3. 没有LIMIT时行存进内存区，超过预算就写成一个有序段
+ * 4. 没有写过有序段时直接在内存里排序；否则剩下的行也写成一段，
+ *    每个段读出第一行，建立归并用的小顶堆
+ */
+void SortExecutor::Init() {
+    auto* sort_plan = GetSortPlan();
+    const PlanNode* child_plan = sort_plan->GetChild(0);
+    if (!child_plan) {
+        throw ExecutionException("SortExecutor: No child plan");
+    }
+    std::unique_ptr<PlanNode> child_copy = CopyPlan(child_plan);
+    if (!child_copy) {
+        throw ExecutionException("SortExecutor: Unsupported child plan type");
+    }
+    child_executor_ = CreateChildExecutor(exec_ctx_, std::move(child_copy));
+    child_executor_->Init();
+    const Schema* child_schema = child_executor_->GetOutputSchema();
+
+    keys_.clear();
+    key_columns_.clear();
+    ascending_.clear();
+    for (const auto& key : sort_plan->GetKeys()) {
+        keys_.push_back(
+            CompiledExpression::Compile(key.expression.get(), child_schema));
+        key_columns_.push_back(
+            NullableColumnIndex(key.expression.get(), child_schema));
+        ascending_.push_back(key.ascending);
+    }
+
+    arena_.Clear();
+    rows_.clear();
+    live_bytes_ = 0;
+    runs_.clear();
+    cursors_.clear();
+    merge_heap_.clear();
+    next_row_ = 0;
+    emitted_ = 0;
+
+    top_n_ = sort_plan->HasLimit();
+    if (top_n_ && sort_plan->GetLimit() == 0) {
+        return;
+    }
+    size_t budget = exec_ctx_->GetOperatorBudget(sort_plan->GetMemoryBudget());
+    reservation_.SetTracker(exec_ctx_->GetMemoryTracker());
+    Tuple tuple;
+    RID rid;
+    while (child_executor_->Next(&tuple, &rid)) {
+        exec_ctx_->CheckCancellation();
+        if (top_n_) {
+            OfferTopN(tuple);
+            if (GetMemoryUsage() > budget ||
+                !reservation_.TryResize(GetMemoryUsage())) {
+                // 堆里已经是目前最好的n行，其余的行不可能进入结果
+                LOG_DEBUG("SortExecutor::Init: Top-N heap exceeds the memory "
+                          "budget, falling back to external sort");
+                top_n_ = false;
+                SpillRun();
+            }
+            continue;
+        }
+        SortRow row;
+        EvaluateKeys(tuple, &row);
+        StoreRow(tuple, &row);
+        rows_.push_back(std::move(row));
+        if (GetMemoryUsage() > budget ||
+            !reservation_.TryResize(GetMemoryUsage())) {
+            SpillRun();
+        }
+    }
+
+    if (runs_.empty()) {
+        std::sort(rows_.begin(), rows_.end(),
+                  [this](const SortRow& a, const SortRow& b) {
+                      return CompareRows(a, b) < 0;
+                  });
+        // 排序本身不能中途停下，排完按排序的行数记一次
+        exec_ctx_->CheckCancellation(rows_.size());
+        return;
+    }
+    if (!rows_.empty()) {
+        SpillRun();
+    }
+    LOG_DEBUG("SortExecutor::Init: Memory budget of "
+              << budget << " bytes exceeded, merging " << runs_.size()
+              << " sorted runs");
+    cursors_.resize(runs_.size());
+    for (size_t i = 0; i < runs_.size(); i++) {
+        cursors_[i].reader =
+            std::make_unique<SpillPartition::Reader>(runs_[i].get());
+        if (AdvanceRun(&cursors_[i])) {
+            merge_heap_.push_back(i);
+        }
+    }
+    std::make_heap(merge_heap_.begin(), merge_heap_.end(),
+                   [this](size_t a, size_t b) { return RunAfter(a, b); });
+}
+
+bool SortExecutor::Next(Tuple* tuple, RID* rid) {
+    auto* sort_plan = GetSortPlan();
+    if (sort_plan->HasLimit() && emitted_ >= sort_plan->GetLimit()) {
+        return false;
+    }
+    const Schema* schema = child_executor_->GetOutputSchema();
+    if (runs_.empty()) {
+        if (next_row_ >= rows_.size()) {
+            return false;
+        }
+        tuple->DeserializeFrom(rows_[next_row_++].data, schema);
+    } else {
+        if (merge_heap_.empty()) {
+            return false;
+        }
+        exec_ctx_->CheckCancellation();
+        auto after = [this](size_t a, size_t b) { return RunAfter(a, b); };
+        std::pop_heap(merge_heap_.begin(), merge_heap_.end(), after);
+        size_t run = merge_heap_.back();
+        tuple->DeserializeFrom(cursors_[run].row.data, schema);
+        if (AdvanceRun(&cursors_[run])) {
+            std::push_heap(merge_heap_.begin(), merge_heap_.end(), after);
+        } else {
+            merge_heap_.pop_back();
+            runs_[run]->Drop();
+        }
+    }
+    *rid = RID{INVALID_PAGE_ID, 0};
+    emitted_++;
+    return true;
+}
+
+/**
+ * 限制行数执行器构造函数
+ */
+LimitExecutor::LimitExecutor(ExecutorContext* exec_ctx,
+                             std::unique_ptr<LimitPlanNode> plan)
+    : Executor(exec_ctx, std::move(plan)) {}
+
+void LimitExecutor::Init() {
+    const PlanNode* child_plan = GetLimitPlan()->GetChild(0);
+    if (!child_plan) {
+        throw ExecutionException("LimitExecutor: No child plan");
+    }
+    std::unique_ptr<PlanNode> child_copy = CopyPlan(child_plan);
+    if (!child_copy) {
+        throw ExecutionException("LimitExecutor: Unsupported child plan type");
+    }
+    child_executor_ = CreateChildExecutor(exec_ctx_, std::move(child_copy));
+    child_executor_->SetRowLimit(
+        static_cast<size_t>(GetLimitPlan()->GetLimit()));
+    child_executor_->Init();
+    emitted_ = 0;
+}
+
+bool LimitExecutor::Next(Tuple* tuple, RID* rid) {
+    if (emitted_ >= GetLimitPlan()->GetLimit()) {
+        return false;
+    }
+    if (!child_executor_->Next(tuple, rid)) {
+        return false;
+    }
+    emitted_++;
+    return true;
+}
+
+/**
+ * 汇总执行器构造函数
+ */
+GatherExecutor::GatherExecutor(ExecutorContext* exec_ctx,
+                               std::unique_ptr<GatherPlanNode> plan)
+    : Executor(exec_ctx, std::move(plan)) {}
+
+GatherExecutor::~GatherExecutor() { Shutdown(); }
+
+/** 每个批次的行数，攒够一批才放进交换队列，减少线程之间的同步 */
+static constexpr size_t GATHER_BATCH_ROWS = 256;
+
+/**
+ * 初始化汇总执行器
+ * 实现思路：
+ * 1. 沿子计划找到顺序扫描，为它的表建页面分发器
+ * 2. 每个工作线程复制一份子计划，用设置了分发器的上下文创建子执行器
+ * 3. 启动工作线程，子执行器的Init也在工作线程里做
+ */
+void GatherExecutor::Init() {
+    Shutdown();
+    auto* gather_plan = GetGatherPlan();
+    const PlanNode* child_plan = gather_plan->GetChild(0);
+    if (!child_plan) {
+        throw ExecutionException("GatherExecutor: No child plan");
+    }
+    const PlanNode* scan = child_plan;
+    while (scan != nullptr &&
+           scan->GetType() != PlanNodeType::SEQUENTIAL_SCAN) {
+        scan = scan->GetChildren().size() == 1 ? scan->GetChild(0) : nullptr;
+    }
+    if (scan == nullptr) {
+        throw ExecutionException(
+            "GatherExecutor: Child plan has no sequential scan");
+    }
+    const std::string& table_name =
+        static_cast<const SeqScanPlanNode*>(scan)->GetTableName();
+    TableInfo* table_info = ResolveTable(exec_ctx_, scan, table_name);
+    if (table_info == nullptr) {
+        throw ExecutionException("Table not found: " + table_name);
+    }
+    // 工作线程的上下文没有锁管理器，表锁在这里加一次
+    LockTableForScan(exec_ctx_, table_info);
+    morsel_source_ = std::make_unique<MorselSource>(
+        table_info->table_heap.get(), table_name,
+        gather_plan->GetMorselPages());
+
+    size_t workers = std::max<size_t>(gather_plan->GetWorkers(), 1);
+    worker_contexts_.clear();
+    worker_executors_.clear();
+    for (size_t i = 0; i < workers; i++) {
+        std::unique_ptr<PlanNode> child_copy = CopyPlan(child_plan);
+        if (!child_copy) {
+            throw ExecutionException(
+                "GatherExecutor: Unsupported child plan type");
+        }
+        auto context = std::make_unique<ExecutorContext>(
+            exec_ctx_->GetTransaction(), exec_ctx_->GetCatalog(),
+            exec_ctx_->GetBufferPoolManager(), exec_ctx_->GetTableManager());
+        context->SetMorselSource(morsel_source_.get());
+        context->SetCancellationToken(exec_ctx_->GetCancellationToken());
+        context->SetMemoryTracker(exec_ctx_->GetMemoryTracker());
+        worker_executors_.push_back(
+            CreateChildExecutor(context.get(), std::move(child_copy)));
+        worker_contexts_.push_back(std::move(context));
+    }
+
+    batch_.clear();
+    batch_index_ = 0;
+    queue_ = std::make_unique<ExchangeQueue>(workers * 2, workers);
+    for (size_t i = 0; i < workers; i++) {
+        workers_.emplace_back(&GatherExecutor::RunWorker, this, i);
+    }
+    LOG_DEBUG("GatherExecutor::Init: started " << workers
+                                               << " workers scanning "
+                                               << table_name);
+}
+
+void GatherExecutor::RunWorker(size_t index) {
+    try {
+        Executor* executor = worker_executors_[index].get();
+        executor->Init();
+        std::vector<Tuple> batch;
+        batch.reserve(GATHER_BATCH_ROWS);
+        Tuple tuple;
+        RID rid;
+        while (executor->Next(&tuple, &rid)) {
+            tuple.SetRID(rid);
+            batch.push_back(std::move(tuple));
+            if (batch.size() == GATHER_BATCH_ROWS) {
+                if (!queue_->Push(std::move(batch))) {
+                    break;
+                }
+                batch.clear();
+                batch.reserve(GATHER_BATCH_ROWS);
+            }
+        }
+        if (!batch.empty()) {
+            queue_->Push(std::move(batch));
+        }
+        queue_->ProducerDone();
+    } catch (...) {
+        queue_->ProducerDone(std::current_exception());
+    }
+}
+
+bool GatherExecutor::Next(Tuple* tuple, RID* rid) {
+    while (batch_index_ >= batch_.size()) {
+        batch_index_ = 0;
+        if (queue_ == nullptr || !queue_->Pop(&batch_)) {
+            batch_.clear();
+            return false;
+        }
+    }
+    *tuple = std::move(batch_[batch_index_++]);
+    *rid = tuple->GetRID();
+    return true;
+}
+
+void GatherExecutor::Shutdown() {
+    if (queue_ != nullptr) {
+        queue_->Close();
+    }
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+/**
+ * 追加执行器构造函数
+ */
+AppendExecutor::AppendExecutor(ExecutorContext* exec_ctx,
+                               std::unique_ptr<AppendPlanNode> plan)
+    : Executor(exec_ctx, std::move(plan)) {}
+
+AppendExecutor::~AppendExecutor() { Shutdown(); }
+
+/**
+ * 沿单子节点的链找到扫描节点扫描的表
+ * @return 找不到扫描节点时返回nullptr
+ */
+static TableInfo* ResolveScannedTable(ExecutorContext* exec_ctx,
+                                      const PlanNode* plan) {
+    while (plan != nullptr) {
+        switch (plan->GetType()) {
+            case PlanNodeType::SEQUENTIAL_SCAN:
+                return ResolveTable(
+                    exec_ctx, plan,
+                    static_cast<const SeqScanPlanNode*>(plan)->GetTableName());
+            case PlanNodeType::INDEX_SCAN:
+                return ResolveTable(
+                    exec_ctx, plan,
+                    static_cast<const IndexScanPlanNode*>(plan)
+                        ->GetTableName());
+            case PlanNodeType::INDEX_RANGE_SCAN:
+                return ResolveTable(
+                    exec_ctx, plan,
+                    static_cast<const IndexRangeScanPlanNode*>(plan)
+                        ->GetTableName());
+            case PlanNodeType::BITMAP_HEAP_SCAN:
+                return ResolveTable(
+                    exec_ctx, plan,
+                    static_cast<const BitmapHeapScanPlanNode*>(plan)
+                        ->GetTableName());
+            default:
+                plan = plan->GetChildren().size() == 1 ? plan->GetChild(0)
+                                                       : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * 初始化追加执行器
+ * 实现思路：
+ * 1. 串行（包括count_rows）时只准备好第一个子执行器，Next逐个推进
+ * 2. 并行时先给每个子计划扫描的表加锁，再为每个工作线程建一个执行器
+ *    上下文，启动工作线程；工作线程的数目不超过子计划的个数
+ */
+void AppendExecutor::Init() {
+    Shutdown();
+    auto* append_plan = GetAppendPlan();
+    const auto& children = append_plan->GetChildren();
+    current_child_.reset();
+    next_child_ = 0;
+    count_done_ = false;
+    batch_.clear();
+    batch_index_ = 0;
+
+    size_t workers = std::min(append_plan->GetWorkers(), children.size());
+    if (append_plan->IsCountRows() || workers <= 1) {
+        if (!append_plan->IsCountRows() && !children.empty()) {
+            current_child_ = OpenChild(exec_ctx_, next_child_++);
+        }
+        return;
+    }
+
+    for (const auto& child : children) {
+        TableInfo* table_info = ResolveScannedTable(exec_ctx_, child.get());
+        if (table_info == nullptr) {
+            throw ExecutionException(
+                "AppendExecutor: Child plan has no table scan");
+        }
+        LockTableForScan(exec_ctx_, table_info);
+    }
+
+    worker_contexts_.clear();
+    for (size_t i = 0; i < workers; i++) {
+        worker_contexts_.push_back(std::make_unique<ExecutorContext>(
+            exec_ctx_->GetTransaction(), exec_ctx_->GetCatalog(),
+            exec_ctx_->GetBufferPoolManager(), exec_ctx_->GetTableManager()));
+        worker_contexts_.back()->SetCancellationToken(
+            exec_ctx_->GetCancellationToken());
+        worker_contexts_.back()->SetMemoryTracker(
+            exec_ctx_->GetMemoryTracker());
+    }
+    next_task_ = 0;
+    queue_ = std::make_unique<ExchangeQueue>(workers * 2, workers);
+    for (size_t i = 0; i < workers; i++) {
+        workers_.emplace_back(&AppendExecutor::RunWorker, this, i);
+    }
+    LOG_DEBUG("AppendExecutor::Init: started " << workers << " workers for "
+                                               << children.size()
+                                               << " partitions");
+}
+
+std::unique_ptr<Executor> AppendExecutor::OpenChild(ExecutorContext* context,
+                                                    size_t index) {
+    std::unique_ptr<PlanNode> child_copy =
+        CopyPlan(GetAppendPlan()->GetChild(index));
+    if (!child_copy) {
+        throw ExecutionException("AppendExecutor: Unsupported child plan type");
+    }
+    auto executor = CreateChildExecutor(context, std::move(child_copy));
+    executor->Init();
+    return executor;
+}
+
+bool AppendExecutor::Next(Tuple* tuple, RID* rid) {
+    auto* append_plan = GetAppendPlan();
+    if (append_plan->IsCountRows()) {
+        return NextCount(tuple, rid);
+    }
+
+    if (queue_ == nullptr) {
+        while (current_child_ != nullptr) {
+            if (current_child_->Next(tuple, rid)) {
+                return true;
+            }
+            current_child_.reset();
+            if (next_child_ < append_plan->GetChildren().size()) {
+                current_child_ = OpenChild(exec_ctx_, next_child_++);
+            }
+        }
+        return false;
+    }
+
+    while (batch_index_ >= batch_.size()) {
+        batch_index_ = 0;
+        if (!queue_->Pop(&batch_)) {
+            batch_.clear();
+            return false;
+        }
+    }
+    *tuple = std::move(batch_[batch_index_++]);
+    *rid = tuple->GetRID();
+    return true;
+}
+
+/**
+ * 依次运行修改语句的子计划
+ * 每个子计划输出一行affected_rows，加起来作为整个语句影响的行数
+ */
+bool AppendExecutor::NextCount(Tuple* tuple, RID* rid) {
+    if (count_done_) {
+        return false;
+    }
+    int64_t affected_rows = 0;
+    for (size_t i = 0; i < GetAppendPlan()->GetChildren().size(); i++) {
+        auto executor = OpenChild(exec_ctx_, i);
+        Tuple result;
+        RID result_rid;
+        while (executor->Next(&result, &result_rid)) {
+            int64_t rows = 0;
+            PartitionValueAsInt64(result.GetValue(0), &rows);
+            affected_rows += rows;
+        }
+    }
+    count_done_ = true;
+    std::vector<Value> result_values = {
+        Value(static_cast<int32_t>(affected_rows))};
+    *tuple = Tuple(result_values, GetOutputSchema());
+    *rid = RID{INVALID_PAGE_ID, -1};
+    return true;
+}
+
+void AppendExecutor::RunWorker(size_t index) {
+    try {
+        ExecutorContext* context = worker_contexts_[index].get();
+        size_t child_count = GetAppendPlan()->GetChildren().size();
+        std::vector<Tuple> batch;
+        batch.reserve(GATHER_BATCH_ROWS);
+        bool open = true;
+        for (size_t task = next_task_++; open && task < child_count;
+             task = next_task_++) {
+            auto executor = OpenChild(context, task);
+            Tuple tuple;
+            RID rid;
+            while (executor->Next(&tuple, &rid)) {
+                tuple.SetRID(rid);
+                batch.push_back(std::move(tuple));
+                if (batch.size() == GATHER_BATCH_ROWS) {
+                    if (!queue_->Push(std::move(batch))) {
+                        open = false;
+                        break;
+                    }
+                    batch.clear();
+                    batch.reserve(GATHER_BATCH_ROWS);
+                }
+            }
+        }
+        if (open && !batch.empty()) {
+            queue_->Push(std::move(batch));
+        }
+        queue_->ProducerDone();
+    } catch (...) {
+        queue_->ProducerDone(std::current_exception());
+    }
+}
+
+void AppendExecutor::Shutdown() {
+    if (queue_ != nullptr) {
+        queue_->Close();
+    }
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+    queue_.reset();
+}
+
+}  // namespace SimpleRDBMS
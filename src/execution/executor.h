@@ -8,14 +8,29 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <unordered_set>
 
 #include "catalog/catalog.h"
+#include "common/arena.h"
+#include "common/bloom_filter.h"
+#include "common/memory_tracker.h"
+#include "execution/aggregation_hash_table.h"
+#include "execution/cancellation_token.h"
+#include "execution/compiled_expression.h"
 #include "execution/expression_evaluator.h"
+#include "execution/join_hash_table.h"
+#include "execution/parallel_scan.h"
 #include "execution/plan_node.h"
+#include "execution/rid_bitmap.h"
+#include "execution/vector_batch.h"
 #include "parser/ast.h"
+#include "record/column_store.h"
 #include "record/table_heap.h"
 #include "record/tuple.h"
+#include "transaction/lock_manager.h"
 #include "transaction/transaction.h"
 
 namespace SimpleRDBMS {
@@ -29,6 +44,15 @@ class TableInfo;
 class UpdatePlanNode;
 class DeletePlanNode;
 class TableManager;
+class QueryProfiler;
+
+/**
+ * 复制一个执行计划，表达式用ExpressionCloner复制
+ * 执行器持有自己的计划：父执行器按子计划复制一份再创建子执行器，
+ * 预编译语句缓存的计划也是每次执行时复制一份交给执行器
+ * @return 不支持的计划类型（INSERT）返回nullptr
+ */
+std::unique_ptr<PlanNode> CopyPlan(const PlanNode* plan);
 
 /**
  * 执行器上下文类
@@ -64,19 +88,99 @@ class ExecutorContext {
     /** 获取表管理器 */
     TableManager* GetTableManager() { return table_manager_; }
 
+    /**
+     * 设置并行扫描的页面分发器
+     * 汇总执行器给每个工作线程一个设置了分发器的上下文，
+     * 这张表的顺序扫描只扫描从分发器领到的页面
+     */
+    void SetMorselSource(MorselSource* source) { morsel_source_ = source; }
+    MorselSource* GetMorselSource() { return morsel_source_; }
+
+    /**
+     * 设置锁管理器
+     * 写操作给修改的记录加 X 锁，SERIALIZABLE 的扫描给表加 S 锁；
+     * 没有设置时不加锁。并行扫描的工作线程不设置，表锁由汇总执行器加
+     */
+    void SetLockManager(LockManager* lock_manager) {
+        lock_manager_ = lock_manager;
+    }
+    LockManager* GetLockManager() { return lock_manager_; }
+
+    /**
+     * 设置EXPLAIN ANALYZE的数据收集器
+     * 设置以后创建的执行器都包装成ProfilingExecutor；没有设置时不收集
+     */
+    void SetProfiler(QueryProfiler* profiler) { profiler_ = profiler; }
+    QueryProfiler* GetProfiler() { return profiler_; }
+
+    /**
+     * 设置查询的取消令牌
+     * 执行引擎设置成当前线程的令牌，并行执行的工作线程的上下文用同一个；
+     * 没有设置时不检查
+     */
+    void SetCancellationToken(CancellationToken* token) {
+        cancellation_token_ = token;
+    }
+    CancellationToken* GetCancellationToken() { return cancellation_token_; }
+
+    /**
+     * 扫描、连接、排序处理完一些行以后调用，累计处理了
+     * CANCELLATION_CHECK_INTERVAL行才真正检查一次令牌
+     * @param rows 这次处理的行数，按页面或批次处理时是页面或批次的行数
+     * 查询已经取消或超时时抛出QueryCancelledException
+     */
+    void CheckCancellation(size_t rows = 1) {
+        if (cancellation_token_ == nullptr) {
+            return;
+        }
+        cancellation_rows_ += rows;
+        if (cancellation_rows_ >= CANCELLATION_CHECK_INTERVAL) {
+            cancellation_rows_ = 0;
+            cancellation_token_->ThrowIfCancelled();
+        }
+    }
+
+    /**
+     * 设置查询的内存记账器
+     * 执行引擎设置成当前线程的记账器，并行执行的工作线程的上下文用同一个；
+     * 没有设置时不记账，算子只按计划节点上的预算溢出
+     */
+    void SetMemoryTracker(MemoryTracker* tracker) { memory_tracker_ = tracker; }
+    MemoryTracker* GetMemoryTracker() { return memory_tracker_; }
+
+    /**
+     * 会溢出的算子实际使用的内存预算
+     * @param plan_budget 计划节点上的预算
+     * @return 记账器设置了work_mem时取两者中较小的一个
+     */
+    size_t GetOperatorBudget(size_t plan_budget) const {
+        size_t work_mem = memory_tracker_ != nullptr
+                              ? memory_tracker_->GetOperatorBudget()
+                              : 0;
+        return work_mem != 0 && work_mem < plan_budget ? work_mem
+                                                       : plan_budget;
+    }
+
    private:
     Transaction* transaction_;                // 当前事务
     Catalog* catalog_;                        // 元数据管理器
     BufferPoolManager* buffer_pool_manager_;  // 缓冲池管理器
     TableManager* table_manager_;             // 表管理器
+    MorselSource* morsel_source_ = nullptr;   // 并行扫描的页面分发器
+    LockManager* lock_manager_ = nullptr;     // 锁管理器
+    QueryProfiler* profiler_ = nullptr;       // EXPLAIN ANALYZE的数据收集器
+    CancellationToken* cancellation_token_ = nullptr;  // 查询的取消令牌
+    size_t cancellation_rows_ = 0;  // 上次检查令牌以后处理的行数
+    MemoryTracker* memory_tracker_ = nullptr;  // 查询的内存记账器
 };
 
 /**
  * 执行器基类
  * 所有具体执行器的抽象基类，定义了执行器的基本接口
- * 采用Volcano模型，通过Next()方法逐个返回结果tuple
+ * 采用Volcano模型，通过Next()方法逐个返回结果tuple；
+ * 扫描和投影另外实现了NextBatch()，一次返回一批按列存放的记录
  */
-class Executor {
+class Executor : public ArenaAllocated {
    public:
     /**
      * 构造函数
@@ -102,8 +206,49 @@ class Executor {
      */
     virtual bool Next(Tuple* tuple, RID* rid) = 0;
 
+    /**
+     * 获取下一批结果
+     * 默认实现逐行调用Next装满批次，有批量实现的执行器覆盖它
+     * @param batch 输出参数，按输出schema的列存放，选择向量标记有效行
+     * @return false表示没有更多结果；返回true时批次至少有一行有效
+     */
+    virtual bool NextBatch(VectorBatch* batch);
+
+    /**
+     * 是否有真正的批量实现
+     * 执行引擎据此决定按批还是按行从根执行器取结果
+     */
+    virtual bool IsVectorized() const { return false; }
+
+    /**
+     * 提示上层最多只需要limit行，在Init之前调用
+     * LIMIT用它告诉扫描提前结束：扫描据此少预读页面、少取索引项；
+     * 只是提示，执行器返回更多行也是正确的，默认忽略
+     */
+    virtual void SetRowLimit(size_t limit) { (void)limit; }
+
+    /**
+     * 交给执行器一个运行时过滤器，在Init之后调用
+     * 哈希连接建好表以后用它把建表一边的键交给探测一边：
+     * 键的JoinHashTable::HashValue不在filter里的行一定连接不上，
+     * 执行器可以在求WHERE条件之前就丢掉；只是提示，默认忽略
+     * @param key 探测一边的连接键
+     * @return 执行器是否会使用这个过滤器
+     */
+    virtual bool SetRuntimeFilter(std::shared_ptr<const BloomFilter> filter,
+                                  const Expression* key) {
+        (void)filter;
+        (void)key;
+        return false;
+    }
+
     /** 获取输出schema */
-    const Schema* GetOutputSchema() const { return plan_->GetOutputSchema(); }
+    virtual const Schema* GetOutputSchema() const {
+        return plan_->GetOutputSchema();
+    }
+
+    /** 执行器持有的计划，包装类的执行器没有计划时返回nullptr */
+    const PlanNode* GetPlanNode() const { return plan_.get(); }
 
    protected:
     ExecutorContext* exec_ctx_;       // 执行器上下文
@@ -131,15 +276,137 @@ class SeqScanExecutor : public Executor {
     /** 获取下一个满足条件的tuple */
     bool Next(Tuple* tuple, RID* rid) override;
 
+    /** 批量扫描，WHERE条件整批过滤 */
+    bool NextBatch(VectorBatch* batch) override;
+
+    bool IsVectorized() const override { return true; }
+
     /** 获取顺序扫描计划节点 */
     SeqScanPlanNode* GetSeqScanPlan() const {
         return static_cast<SeqScanPlanNode*>(plan_.get());
     }
 
+    /** 根据区域摘要跳过的页面数，列存表跳过的行组也算在里面 */
+    size_t GetSkippedPages() const {
+        return table_iterator_.GetSkippedPages() + morsel_skipped_pages_ +
+               skipped_row_groups_;
+    }
+
+    /** 最多只需要limit行时，预读窗口不超过这些行大约占用的页面数 */
+    void SetRowLimit(size_t limit) override { row_limit_ = limit; }
+
+    /** 连接键是本表的一列时接受，之后读出的行先查过滤器再求WHERE条件 */
+    bool SetRuntimeFilter(std::shared_ptr<const BloomFilter> filter,
+                          const Expression* key) override;
+
+    /** 被运行时过滤器丢掉的行数 */
+    size_t GetRuntimeFilteredRows() const { return runtime_filtered_rows_; }
+
    private:
+    /**
+     * 并行扫描时读入下一个页面上满足条件的记录到page_rows_
+     * 当前morsel用完了再从分发器领一个
+     * @return 分发器的页面已经领完时返回false
+     */
+    bool LoadNextMorselPage();
+
+    /**
+     * 在页面读锁内按快照读出一个页面上满足条件的记录到page_rows_
+     * @param first_slot 只要slot不小于它的记录
+     * @param next_page_id 输出参数，链表上的下一个页面，可以为空
+     */
+    void LoadPage(page_id_t page_id, slot_offset_t first_slot,
+                  page_id_t* next_page_id);
+
+    /**
+     * 确认到目前为止直接从表堆读到的内容就是快照看到的内容
+     * 表堆里没有对快照不可见的修改时返回true；否则转为按页面读快照，
+     * 从最后一条确认过的记录之后接着读
+     */
+    bool VerifySnapshot();
+
+    /** 按页面读快照时返回下一条记录 */
+    bool NextSnapshotRow(Tuple* tuple, RID* rid);
+
     TableInfo* table_info_;                           // 表信息
     TableHeap::Iterator table_iterator_;              // 表迭代器
+    size_t row_limit_ = SIZE_MAX;                     // 上层需要的行数
+
+    // 并行扫描时使用：只扫描从分发器领到的页面，一次读入一页
+    MorselSource* morsel_source_ = nullptr;
+    std::shared_ptr<BufferAccessStrategy> morsel_strategy_;
+    std::vector<page_id_t> morsel_;  // 当前morsel的页面
+    size_t morsel_index_ = 0;        // 下一个要扫描的页面
+    std::vector<Tuple> page_rows_;   // 当前页面上满足条件的记录
+    size_t page_row_ = 0;
+    size_t morsel_skipped_pages_ = 0;  // 根据区域摘要跳过的页面数
+
+    // 快照读：表堆里出现对快照不可见的修改之后，从最后一条确认过的
+    // 记录之后改为一次读一个页面，在页面读锁内合并旧版本
+    const ReadView* read_view_ = nullptr;  // 为空时直接读表堆
+    bool snapshot_scan_ = false;           // 是否已经改为按页面读
+    page_id_t resume_page_id_ = INVALID_PAGE_ID;  // 下一个要读的页面
+    slot_offset_t resume_slot_ = 0;               // 页面上从这个slot开始
     std::unique_ptr<ExpressionEvaluator> evaluator_;  // 表达式求值器
+    CompiledExpression compiled_predicate_;           // 编译好的WHERE条件
+
+    /**
+     * 判断页面上是否可能有满足条件的记录
+     * 沿AND、OR向下检查 列 比较 常量 形式的条件，
+     * 其他条件无法从摘要判断，一律当作可能满足
+     * @param expr WHERE条件或其中的子表达式
+     * @param zone 页面的区域摘要
+     * @return false表示页面上一定没有满足条件的记录
+     */
+    bool ZoneMayMatch(const Expression* expr, const ZoneMap::PageZone& zone);
+
+    /** 批量过滤出错时逐行重新过滤，返回是否还有有效行 */
+    bool FilterBatchByRow(VectorBatch* batch);
+
+    /**
+     * 列存表：解码下一个可能满足条件的行组里用到的列，
+     * 行组都读完以后读一次快照里的尾部记录
+     * @return 没有更多数据时返回false
+     */
+    bool LoadNextRowGroup();
+
+    /** 列存表的批量扫描，直接把解码好的列切成批次 */
+    bool NextColumnBatch(VectorBatch* batch);
+
+    /** 列存表的逐行扫描，从内部的批次里逐行取 */
+    bool NextColumnRow(Tuple* tuple, RID* rid);
+
+    // 列存表：扫描开始时取出快照，一次解码一个行组
+    ColumnStore* column_store_ = nullptr;  // 行存表为空
+    ColumnStore::ScanSnapshot column_snapshot_;
+    size_t next_row_group_ = 0;      // 下一个要读的行组
+    bool tail_loaded_ = false;       // 尾部记录已经读过
+    size_t current_row_group_ = 0;   // 当前行组的序号，RID的page_id就是它
+    std::vector<std::vector<Value>> group_columns_;  // 不用的列为空
+    size_t group_rows_ = 0;          // 当前行组的行数
+    size_t group_row_ = 0;           // 下一个批次从这一行开始
+    size_t skipped_row_groups_ = 0;  // 根据最小/最大值跳过的行组数
+    VectorBatch row_batch_;          // 逐行扫描时的内部批次
+    size_t row_batch_pos_ = 0;       // 下一个要返回的选择向量下标
+
+    // 运行时过滤器：哈希连接交过来的建表一边的键，为空时不过滤
+    std::shared_ptr<const BloomFilter> runtime_filter_;
+    size_t runtime_filter_column_ = 0;  // 连接键在本表里的列下标
+    size_t runtime_filtered_rows_ = 0;
+
+    /** 这一行的连接键可能在运行时过滤器里，没有过滤器时总是true */
+    bool RuntimeFilterMayMatch(const TupleView& view) {
+        if (runtime_filter_ == nullptr ||
+            runtime_filter_->MayContain(JoinHashTable::HashValue(
+                view.GetValue(runtime_filter_column_)))) {
+            return true;
+        }
+        runtime_filtered_rows_++;
+        return false;
+    }
+
+    /** 按运行时过滤器缩小批次的选择向量 */
+    void ApplyRuntimeFilter(VectorBatch* batch);
 };
 
 /**
@@ -172,15 +439,136 @@ class IndexScanExecutor : public Executor {
     TableInfo* table_info_;                           // 表信息
     IndexInfo* index_info_;                           // 索引信息
     std::unique_ptr<ExpressionEvaluator> evaluator_;  // 表达式求值器
-    Value search_key_;                                // 搜索键值
-    bool has_found_tuple_;                            // 是否已找到记录
-    RID found_rid_;                                   // 找到的记录RID
+    std::vector<Value> search_keys_;  // 索引前几列上的等值条件的值
+    std::vector<RID> rids_;  // 键匹配的RID，非唯一索引可能有多条
+    size_t next_rid_ = 0;    // 下一个要返回的RID
+    // 只读索引时每个RID对应的索引项列值，和rids_一一对应
+    std::vector<std::vector<Value>> entry_values_;
+    // 索引项里第i个存储列（索引列之后是INCLUDE列）在表schema里的位置
+    std::vector<size_t> stored_column_indexes_;
+    const ReadView* read_view_ = nullptr;  // 事务的快照，没有时为nullptr
+    // 快照下和表堆不同、键仍可能匹配的记录，索引的结果用完后再过滤输出
+    std::vector<Tuple> snapshot_rows_;
+    size_t next_snapshot_row_ = 0;
+
+    /**
+     * 用索引项里的列值组成一行，只读索引时代替回表
+     * 查询用不到的列填成对应类型的零值
+     * @return VARCHAR列的值可能被截断时返回false，调用者需要回表
+     */
+    bool BuildTupleFromIndex(const std::vector<Value>& values, Tuple* tuple);
 
     /**
      * 从WHERE条件中提取搜索键
+     * 从索引的第一列开始，依次取出有等值条件的列的值，遇到没有的列就停止
      * @param predicate WHERE条件表达式
+     * @return 至少第一列上有等值条件返回true
      */
-    void ExtractSearchKey(Expression* predicate);
+    bool ExtractSearchKey(Expression* predicate);
+
+    /**
+     * 在AND条件里找指定列上的等值条件
+     * @param predicate WHERE条件表达式
+     * @param column 列名
+     * @param value 输出参数，等值条件的常量
+     * @return 找到返回true
+     */
+    static bool FindEqualityValue(Expression* predicate,
+                                  const std::string& column, Value* value);
+};
+
+/**
+ * 索引范围扫描执行器
+ * 按键的顺序读出索引上 [lower, upper] 范围内的记录，
+ * 再用完整的WHERE条件过滤，适用于 <、<=、>、>=、BETWEEN 查询
+ */
+class IndexRangeScanExecutor : public Executor {
+   public:
+    /**
+     * 构造函数
+     * @param exec_ctx 执行器上下文
+     * @param plan 索引范围扫描计划节点
+     */
+    IndexRangeScanExecutor(ExecutorContext* exec_ctx,
+                           std::unique_ptr<IndexRangeScanPlanNode> plan);
+
+    /** 初始化扫描器，从索引中取出第一批RID，没有LIMIT时是范围内的全部 */
+    void Init() override;
+
+    /** 按键的顺序返回下一条满足WHERE条件的记录 */
+    bool Next(Tuple* tuple, RID* rid) override;
+
+    /** 获取索引范围扫描计划节点 */
+    IndexRangeScanPlanNode* GetIndexRangeScanPlan() const {
+        return static_cast<IndexRangeScanPlanNode*>(plan_.get());
+    }
+
+    /**
+     * 最多只需要limit行时，第一次只从索引取limit个RID，
+     * 用完了还需要更多行再取，每次取的个数翻倍
+     */
+    void SetRowLimit(size_t limit) override { row_limit_ = limit; }
+
+    /** 目前为止从索引取出的RID数 */
+    size_t GetCandidateCount() const { return scanned_entries_; }
+
+   private:
+    /**
+     * 取下一批RID到rids_
+     * 从范围的起点重新扫描索引，跳过已经取过的scanned_entries_项
+     */
+    void FetchRids();
+
+    TableInfo* table_info_;                           // 表信息
+    std::unique_ptr<ExpressionEvaluator> evaluator_;  // 表达式求值器
+    std::vector<RID> rids_;         // 当前这一批RID，按键排序
+    size_t next_rid_ = 0;           // 下一个要返回的RID
+    size_t row_limit_ = SIZE_MAX;   // 上层需要的行数
+    size_t batch_size_ = SIZE_MAX;  // 下一批最多取的RID数
+    size_t scanned_entries_ = 0;    // 已经取过的索引项数
+    bool exhausted_ = false;        // 范围内的索引项已经取完
+    const ReadView* read_view_ = nullptr;  // 事务的快照
+    // 快照下和表堆不同的记录，每一批RID都要去掉它们
+    std::unordered_set<RID> snapshot_changed_;
+    std::vector<Tuple> snapshot_rows_;  // 其中快照下存在的版本
+    size_t next_snapshot_row_ = 0;
+};
+
+/**
+ * 位图堆扫描执行器
+ * Init里按计划的条件树从索引取出所有RID组成位图，
+ * Next按 (页面号, 槽位号) 的顺序回表，用完整的WHERE条件过滤
+ */
+class BitmapHeapScanExecutor : public Executor {
+   public:
+    BitmapHeapScanExecutor(ExecutorContext* exec_ctx,
+                           std::unique_ptr<BitmapHeapScanPlanNode> plan);
+
+    /** 初始化扫描器，建好位图 */
+    void Init() override;
+
+    /** 按页面顺序返回下一条满足WHERE条件的记录 */
+    bool Next(Tuple* tuple, RID* rid) override;
+
+    BitmapHeapScanPlanNode* GetBitmapHeapScanPlan() const {
+        return static_cast<BitmapHeapScanPlanNode*>(plan_.get());
+    }
+
+    /** 位图里的RID数 */
+    size_t GetCandidateCount() const { return candidate_count_; }
+
+   private:
+    /** 按条件树的一个节点从索引取RID */
+    RidBitmap BuildBitmap(const BitmapIndexCondition& condition);
+
+    TableInfo* table_info_ = nullptr;
+    std::unique_ptr<ExpressionEvaluator> evaluator_;
+    RidBitmap bitmap_;
+    RidBitmap::Iterator iterator_;
+    size_t candidate_count_ = 0;
+    const ReadView* read_view_ = nullptr;  // 事务的快照
+    std::vector<Tuple> snapshot_rows_;     // 快照下和表堆不同的记录
+    size_t next_snapshot_row_ = 0;
 };
 
 /**
@@ -210,8 +598,90 @@ class InsertExecutor : public Executor {
     }
 
    private:
+    /**
+     * 多行插入：第一次调用Next时把所有行一次性交给TableHeap::InsertTuples，
+     * 再批量维护索引，之后的Next只依次返回RID
+     */
+    void InsertAllRows();
+
+    /** 分区表：按分区列把行分到各个分区，每个分区批量插入 */
+    void InsertPartitionedRows();
+
+    /**
+     * 把一批行插入一张行存表，维护它的索引
+     * @param rids 输出插入得到的RID，和tuples一一对应
+     */
+    void InsertRows(TableInfo* table_info, const std::vector<Tuple>& tuples,
+                    std::vector<RID>* rids);
+
+    /** 列存表：把所有行一次追加到列存，追加返回时已经持久化 */
+    void AppendColumnRows();
+
     TableInfo* table_info_;  // 表信息
     size_t current_index_;   // 当前处理的记录索引
+    std::vector<RID> inserted_rids_;  // 多行插入得到的RID
+};
+
+/**
+ * TargetRidList - UPDATE/DELETE收集的目标RID
+ *
+ * 修改语句先扫描出所有满足条件的RID再逐个修改，修改过的记录不会又被扫到。
+ * RID先放在内存里，数组要扩容时超过预算或者记账器不给，
+ * 就把内存里的RID整批写到临时页面上，清空后继续收集；
+ * 遍历时先读临时页面上的，再读内存里剩下的
+ */
+class TargetRidList {
+   public:
+    /**
+     * 开始收集，丢掉之前的RID
+     * @param exec_ctx 执行器上下文，提供缓冲池和记账器
+     * @param budget 内存里最多放的RID字节数
+     */
+    void Reset(ExecutorContext* exec_ctx, size_t budget);
+
+    /** 追加一个RID */
+    void Add(const RID& rid) {
+        if (rids_.size() == rids_.capacity()) {
+            Grow();
+        }
+        rids_.push_back(rid);
+    }
+
+    /** 收集结束，写出临时页面的最后一页 */
+    void Finish();
+
+    size_t Size() const { return spilled_count_ + rids_.size(); }
+
+    /** 是否有RID写到了临时页面 */
+    bool IsSpilled() const { return spill_ != nullptr; }
+
+    /** 按收集的顺序读出所有RID */
+    class Cursor {
+       public:
+        explicit Cursor(const TargetRidList* list);
+
+        /** 读取下一个RID，没有更多时返回false */
+        bool Next(RID* rid);
+
+       private:
+        const TargetRidList* list_;
+        std::unique_ptr<SpillPartition::Reader> reader_;
+        size_t index_ = 0;  // 读完临时页面以后内存里的下一个
+    };
+
+   private:
+    /** 数组满了：预算和记账器允许时翻倍，否则把内存里的RID写出去 */
+    void Grow();
+
+    /** 把内存里的RID写到临时页面，清空数组但保留容量 */
+    void Spill();
+
+    BufferPoolManager* buffer_pool_manager_ = nullptr;
+    size_t budget_ = 0;
+    MemoryReservation reservation_;
+    std::vector<RID> rids_;
+    std::unique_ptr<SpillPartition> spill_;
+    size_t spilled_count_ = 0;
 };
 
 /**
@@ -240,6 +710,9 @@ class UpdateExecutor : public Executor {
         return static_cast<UpdatePlanNode*>(plan_.get());
     }
 
+    /** 收集的目标RID是否超出内存预算写到了临时页面 */
+    bool IsTargetSpilled() const { return target_rids_.IsSpilled(); }
+
     /** 获取表的schema，用于数据操作 */
     const Schema* GetTableSchema() const {
         return table_info_ ? table_info_->schema.get() : nullptr;
@@ -248,9 +721,11 @@ class UpdateExecutor : public Executor {
    private:
     TableInfo* table_info_;                           // 表信息
     std::unique_ptr<ExpressionEvaluator> evaluator_;  // 表达式求值器
-    std::vector<RID> target_rids_;                    // 需要更新的记录RID列表
+    TargetRidList target_rids_;                       // 需要更新的记录RID
     size_t current_index_;                            // 当前处理索引
     bool is_executed_;                                // 是否已执行
+    // SET子句是否改到了某个索引存储的列，没改到时原地更新不用维护索引
+    bool updates_indexed_column_ = true;
 };
 
 /**
@@ -279,6 +754,9 @@ class DeleteExecutor : public Executor {
         return static_cast<DeletePlanNode*>(plan_.get());
     }
 
+    /** 收集的目标RID是否超出内存预算写到了临时页面 */
+    bool IsTargetSpilled() const { return target_rids_.IsSpilled(); }
+
     /** 获取表的schema，用于数据操作 */
     const Schema* GetTableSchema() const {
         return table_info_ ? table_info_->schema.get() : nullptr;
@@ -287,7 +765,7 @@ class DeleteExecutor : public Executor {
    private:
     TableInfo* table_info_;                           // 表信息
     std::unique_ptr<ExpressionEvaluator> evaluator_;  // 表达式求值器
-    std::vector<RID> target_rids_;                    // 需要删除的记录RID列表
+    TargetRidList target_rids_;                       // 需要删除的记录RID
     size_t current_index_;                            // 当前处理索引
     bool is_executed_;                                // 是否已执行
 };
@@ -313,6 +791,11 @@ class ProjectionExecutor : public Executor {
     /** 获取投影后的tuple */
     bool Next(Tuple* tuple, RID* rid) override;
 
+    /** 批量投影，每个表达式对整批求值一次 */
+    bool NextBatch(VectorBatch* batch) override;
+
+    bool IsVectorized() const override { return true; }
+
     /** 获取投影计划节点 */
     ProjectionPlanNode* GetProjectionPlan() const {
         return static_cast<ProjectionPlanNode*>(plan_.get());
@@ -321,6 +804,489 @@ class ProjectionExecutor : public Executor {
    private:
     std::unique_ptr<Executor> child_executor_;        // 子执行器
     std::unique_ptr<ExpressionEvaluator> evaluator_;  // 表达式求值器
+    VectorBatch child_batch_;                         // 子执行器的批次，反复使用
+    Tuple child_tuple_;                               // 子执行器逐行输出的记录，反复使用
+    std::vector<CompiledExpression> compiled_expressions_;  // 编译好的投影表达式
+};
+
+/**
+ * 哈希连接执行器
+ * 执行两张表的等值内连接，输出左表的列接着右表的列
+ *
+ * 实现思路：
+ * 1. Init时轮流从左右两边各读一行，先读完的一边是较小的输入，用它建哈希表，
+ *    另一边已经读出来的行和剩下的行依次探测
+ * 2. 建表的tuple按行格式序列化存放在TupleArena里，哈希表是开放寻址的，
+ *    只保存哈希值和tuple地址，比较键时用TupleView只解码键列
+ * 3. 两边都还没读完时已经用掉的内存超过预算（或者查询的内存记账器
+ *    不再给内存），就把两边都按键的哈希值分区写到临时页面上，
+ *    再逐个分区连接，每个分区用较小的一边建表；
+ *    同一个分区里两边的键哈希值相同，所以分区之间不会漏掉匹配
+ */
+class HashJoinExecutor : public Executor {
+   public:
+    /**
+     * 构造函数
+     * @param exec_ctx 执行器上下文
+     * @param plan 哈希连接计划节点
+     */
+    HashJoinExecutor(ExecutorContext* exec_ctx,
+                     std::unique_ptr<HashJoinPlanNode> plan);
+
+    /** 初始化左右子执行器并建哈希表，内存不够时先完成分区 */
+    void Init() override;
+
+    /** 获取下一条连接结果 */
+    bool Next(Tuple* tuple, RID* rid) override;
+
+    /** 获取哈希连接计划节点 */
+    HashJoinPlanNode* GetHashJoinPlan() const {
+        return static_cast<HashJoinPlanNode*>(plan_.get());
+    }
+
+    /** 是否超出内存预算，分区写到了临时页面 */
+    bool IsSpilled() const { return spilled_; }
+
+    /** 是否用左表建的哈希表；溢出时每个分区单独选择，这里是最后一个分区的 */
+    bool IsBuildLeft() const { return build_is_left_; }
+
+    /** 是否把建表一边的布隆过滤器交给了探测一边的扫描 */
+    bool IsRuntimeFilterPushed() const { return runtime_filter_ != nullptr; }
+
+   private:
+    /** 连接的一边 */
+    struct JoinInput {
+        std::unique_ptr<Executor> executor;
+        const Schema* schema = nullptr;
+        CompiledExpression key;
+        bool exhausted = false;
+        TupleArena arena;  // 分区之前读出来的行
+        std::vector<std::pair<const char*, uint16_t>> rows;
+        std::vector<std::unique_ptr<SpillPartition>> partitions;
+    };
+
+    /** 从子执行器读一行，序列化后追加到input的rows */
+    bool BufferRow(JoinInput* input);
+
+    /** 把input的所有行（已经读出的和剩下的）按哈希值写到分区 */
+    void PartitionInput(JoinInput* input);
+
+    /** 用build里的一行建表 */
+    void InsertBuildRow(const char* data, uint16_t size);
+
+    /** 溢出时切换到下一个两边都非空的分区，建好哈希表 */
+    bool AdvancePartition();
+
+    /** 取下一条探测行，设置probe_tuple_和它的键 */
+    bool NextProbeRow();
+
+    /** 把一条序列化的探测行设置为当前探测行 */
+    void SetProbeRow(const char* data);
+
+    JoinInput left_;
+    JoinInput right_;
+    JoinInput* build_ = nullptr;
+    JoinInput* probe_ = nullptr;
+    bool build_is_left_ = true;
+    CompiledExpression predicate_;
+    bool has_predicate_ = false;
+
+    JoinHashTable table_;
+    // 建表一边所有键的布隆过滤器，探测一边的扫描接受了才保留
+    std::shared_ptr<BloomFilter> runtime_filter_;
+    TupleArena build_arena_;  // 溢出时当前分区建表的行
+    MemoryReservation reservation_;  // 读入的行和哈希表在记账器上的预留
+
+    bool spilled_ = false;
+    size_t partition_index_ = 0;  // 溢出时下一个要处理的分区
+    std::unique_ptr<SpillPartition::Reader> probe_reader_;
+    size_t probe_row_index_ = 0;  // 不溢出时下一条已经读出的探测行
+
+    bool has_probe_row_ = false;
+    Tuple probe_tuple_;
+    Value probe_key_;
+    uint64_t probe_hash_ = 0;
+    size_t probe_position_ = 0;  // 哈希表里的探测位置
+};
+
+/**
+ * 索引嵌套循环连接执行器
+ * 外表每读一行，用连接键在内表的索引上查找，再按RID读出内表的记录
+ *
+ * 实现思路：
+ * 1. 连接键在外表的schema上编译一次，每个外表行求出键值
+ * 2. 用IndexManager::FindEntry按键（多列索引按第一列前缀）取出所有RID，
+ *    唯一索引最多一条
+ * 3. 索引查找可能做了类型转换，读出内表记录后再比较一次连接列，
+ *    然后检查内表条件和连接后的条件
+ */
+class IndexNestedLoopJoinExecutor : public Executor {
+   public:
+    /**
+     * 构造函数
+     * @param exec_ctx 执行器上下文
+     * @param plan 索引嵌套循环连接计划节点
+     */
+    IndexNestedLoopJoinExecutor(
+        ExecutorContext* exec_ctx,
+        std::unique_ptr<IndexNestedLoopJoinPlanNode> plan);
+
+    /** 初始化外表执行器，查找内表和索引 */
+    void Init() override;
+
+    /** 获取下一条连接结果 */
+    bool Next(Tuple* tuple, RID* rid) override;
+
+    /** 获取计划节点 */
+    IndexNestedLoopJoinPlanNode* GetJoinPlan() const {
+        return static_cast<IndexNestedLoopJoinPlanNode*>(plan_.get());
+    }
+
+   private:
+    std::unique_ptr<Executor> outer_executor_;  // 外表执行器
+    TableInfo* inner_table_ = nullptr;          // 内表信息
+    size_t inner_key_index_ = 0;                // 内表连接列的下标
+    CompiledExpression outer_key_;
+    CompiledExpression inner_predicate_;
+    bool has_inner_predicate_ = false;
+    CompiledExpression predicate_;
+    bool has_predicate_ = false;
+
+    Tuple outer_tuple_;           // 当前外表行
+    Value outer_key_value_;       // 当前外表行的连接键
+    std::vector<RID> inner_rids_;  // 当前外表行在索引上找到的RID
+    size_t next_inner_ = 0;
+    const ReadView* read_view_ = nullptr;  // 事务的快照
+    // 内表在快照下和表堆不同的记录，索引查到它们时跳过，
+    // 改为和快照下存在的版本逐个比较连接键
+    std::unordered_set<RID> inner_changed_;
+    std::vector<Tuple> inner_snapshot_rows_;
+    size_t next_snapshot_inner_ = 0;
+
+    /**
+     * 内表的一行和当前外表行连接
+     * @return 连接列相等、满足内表条件和连接后的条件时返回true
+     */
+    bool JoinInner(const Tuple& inner_tuple, Tuple* tuple);
+};
+
+/**
+ * 哈希聚合执行器
+ * 按GROUP BY表达式分组，计算每个分组的COUNT/SUM/AVG/MIN/MAX，
+ * 输出列按计划节点给出的SELECT列表顺序排列
+ *
+ * 实现思路：
+ * 1. Init时读完子执行器的所有行，分组表达式和聚合参数都预先编译；
+ *    表达式是列引用时按子tuple的NULL标记处理NULL
+ * 2. 分组状态放在AggregationHashTable里；超过内存预算或者记账器
+ *    不再给内存时把所有分组的部分聚合结果按分组键的哈希值
+ *    写到临时页面的分区里，清空哈希表继续累加
+ * 3. 溢出过时最后剩下的分组也写到分区，Next逐个分区合并部分结果再输出，
+ *    同一个分组的部分结果哈希值相同，一定在同一个分区里
+ */
+class HashAggregationExecutor : public Executor {
+   public:
+    /**
+     * 构造函数
+     * @param exec_ctx 执行器上下文
+     * @param plan 聚合计划节点
+     */
+    HashAggregationExecutor(ExecutorContext* exec_ctx,
+                            std::unique_ptr<AggregationPlanNode> plan);
+
+    /** 初始化子执行器，读完所有输入并完成累加 */
+    void Init() override;
+
+    /** 获取下一个分组的结果 */
+    bool Next(Tuple* tuple, RID* rid) override;
+
+    /** 获取聚合计划节点 */
+    AggregationPlanNode* GetAggregationPlan() const {
+        return static_cast<AggregationPlanNode*>(plan_.get());
+    }
+
+    /** 是否超出内存预算，部分聚合结果写到了临时页面 */
+    bool IsSpilled() const { return spilled_; }
+
+   private:
+    /** 把哈希表里所有分组的部分结果写到分区，然后清空哈希表 */
+    void SpillTable();
+
+    /** 把哈希表里的最终结果转换成输出行，追加到results_ */
+    void CollectResults();
+
+    /** 溢出时合并下一个非空分区，结果放到results_ */
+    bool AdvancePartition();
+
+    std::unique_ptr<Executor> child_executor_;  // 子执行器
+    std::unique_ptr<Schema> key_schema_;        // 分组键的schema
+    std::unique_ptr<AggregationHashTable> table_;
+    MemoryReservation reservation_;  // 分组状态在记账器上的预留
+    std::vector<CompiledExpression> group_by_;
+    std::vector<CompiledExpression> arguments_;  // COUNT(*)的位置不使用
+    std::vector<int> group_by_columns_;  // 分组表达式是列引用时的下标，否则-1
+    std::vector<int> argument_columns_;  // 参数是列引用时的下标，否则-1
+
+    bool spilled_ = false;
+    std::vector<std::unique_ptr<SpillPartition>> partitions_;
+    size_t partition_index_ = 0;  // 溢出时下一个要合并的分区
+
+    std::vector<Tuple> results_;  // 已经算好、还没输出的结果
+    size_t result_index_ = 0;
+};
+
+/**
+ * 排序执行器
+ * 按SortPlanNode的排序键输出子执行器的所有行，带LIMIT时只输出前n行
+ *
+ * 实现思路：
+ * 1. 每一行按行格式序列化到TupleArena里，排序键预先求值放在行旁边，
+ *    比较时不再解码tuple；NULL比任何值都大
+ * 2. 没有LIMIT时读入的行超过内存预算（work_mem）或者记账器不再给内存
+ *    就排好序，作为一个有序段写到临时页面上；读完以后内存里剩下的行
+ *    也写成一段，Next用按各段当前行组织的小顶堆做多路归并，
+ *    每个段只在内存里留一行
+ * 3. 有LIMIT n时维护n行的大顶堆，堆顶是目前最差的一行，新的一行
+ *    只有比堆顶好才序列化进来；被换掉的行占的空间累积到一半时压缩内存区。
+ *    n行本身超过内存预算时退回外部排序
+ */
+class SortExecutor : public Executor {
+   public:
+    /**
+     * 构造函数
+     * @param exec_ctx 执行器上下文
+     * @param plan 排序计划节点
+     */
+    SortExecutor(ExecutorContext* exec_ctx, std::unique_ptr<SortPlanNode> plan);
+
+    /** 初始化子执行器，读完所有输入并排好序或者写出有序段 */
+    void Init() override;
+
+    /** 按顺序获取下一行 */
+    bool Next(Tuple* tuple, RID* rid) override;
+
+    /** 获取排序计划节点 */
+    SortPlanNode* GetSortPlan() const {
+        return static_cast<SortPlanNode*>(plan_.get());
+    }
+
+    /** 是否用堆做了Top-N，没有排序整个输入 */
+    bool IsTopN() const { return top_n_; }
+
+    /** 是否超出内存预算，把有序段写到了临时页面 */
+    bool IsSpilled() const { return !runs_.empty(); }
+
+    /** 写到临时页面的有序段数 */
+    size_t GetRunCount() const { return runs_.size(); }
+
+   private:
+    /** 内存里的一行：序列化的tuple和它的排序键 */
+    struct SortRow {
+        const char* data;
+        uint16_t size;
+        std::vector<Value> keys;
+        std::vector<bool> nulls;
+    };
+
+    /** 一个有序段的读取位置，row是当前行，数据在读取下一行之前有效 */
+    struct RunCursor {
+        std::unique_ptr<SpillPartition::Reader> reader;
+        SortRow row;
+    };
+
+    /** 比较两行的排序键，a排在b前面返回负数，相同返回0 */
+    int CompareRows(const SortRow& a, const SortRow& b) const;
+
+    /** 对tuple的排序键求值 */
+    void EvaluateKeys(const Tuple& tuple, SortRow* row) const;
+
+    /** 对有序段里一行的排序键求值 */
+    void EvaluateKeys(const TupleView& view, SortRow* row) const;
+
+    /** 把tuple序列化到内存区 */
+    void StoreRow(const Tuple& tuple, SortRow* row);
+
+    /** Top-N：用一行替换堆顶或者放进还没满的堆 */
+    void OfferTopN(const Tuple& tuple);
+
+    /** Top-N：只把堆里的行复制到新的内存区，释放被换掉的行 */
+    void CompactArena();
+
+    /** 把内存里的行排好序写成一个有序段，然后清空内存 */
+    void SpillRun();
+
+    /** 读取有序段的下一行，段读完返回false */
+    bool AdvanceRun(RunCursor* cursor) const;
+
+    /** 归并时第a个段的当前行是否排在第b个段的后面，用于小顶堆 */
+    bool RunAfter(size_t a, size_t b) const;
+
+    /** 内存里的行和排序键占用的字节数 */
+    size_t GetMemoryUsage() const;
+
+    std::unique_ptr<Executor> child_executor_;  // 子执行器
+    std::vector<CompiledExpression> keys_;      // 编译好的排序键
+    std::vector<int> key_columns_;  // 排序键是列引用时的下标，否则-1
+    std::vector<bool> ascending_;
+
+    TupleArena arena_;
+    std::vector<SortRow> rows_;  // 内存里的行；Top-N时是大顶堆
+    MemoryReservation reservation_;  // 内存里的行在记账器上的预留
+    size_t live_bytes_ = 0;      // 内存区里还在用的行的字节数
+    bool top_n_ = false;
+    SortRow candidate_;  // Top-N时还没决定是否保留的一行
+
+    std::vector<std::unique_ptr<SpillPartition>> runs_;  // 有序段
+    std::vector<RunCursor> cursors_;
+    std::vector<size_t> merge_heap_;  // 还有行的有序段，当前行最小的在堆顶
+
+    size_t next_row_ = 0;  // 没有溢出时下一个输出的行
+    int64_t emitted_ = 0;  // 已经输出的行数
+};
+
+/**
+ * 限制行数执行器
+ * 输出子执行器的前n行，之后不再读取子执行器
+ */
+class LimitExecutor : public Executor {
+   public:
+    LimitExecutor(ExecutorContext* exec_ctx,
+                  std::unique_ptr<LimitPlanNode> plan);
+
+    void Init() override;
+    bool Next(Tuple* tuple, RID* rid) override;
+
+    /** 获取限制行数计划节点 */
+    LimitPlanNode* GetLimitPlan() const {
+        return static_cast<LimitPlanNode*>(plan_.get());
+    }
+
+   private:
+    std::unique_ptr<Executor> child_executor_;  // 子执行器
+    int64_t emitted_ = 0;                       // 已经输出的行数
+};
+
+/**
+ * 汇总执行器
+ * 用多个工作线程并行运行子计划（顺序扫描，可以带投影），汇总输出结果
+ *
+ * 实现思路：
+ * 1. Init为子计划里的表建一个页面分发器，每个工作线程有自己的执行器上下文、
+ *    子计划副本和子执行器，扫描从分发器按morsel领取页面，
+ *    过滤和投影都在工作线程里完成
+ * 2. 工作线程把结果攒成批次放进有界的交换队列，Next从队列逐批取出；
+ *    队列满时工作线程等待，消费得慢不会让结果堆积在内存里
+ * 3. 工作线程出错时异常经过队列在Next里重新抛出；提前析构（比如LIMIT
+ *    已经够了）时关闭队列，工作线程停止扫描后才等待它们退出
+ */
+class GatherExecutor : public Executor {
+   public:
+    /**
+     * 构造函数
+     * @param exec_ctx 执行器上下文
+     * @param plan 汇总计划节点
+     */
+    GatherExecutor(ExecutorContext* exec_ctx,
+                   std::unique_ptr<GatherPlanNode> plan);
+
+    /** 停止并等待所有工作线程 */
+    ~GatherExecutor() override;
+
+    /** 创建分发器和各工作线程的子执行器，启动工作线程 */
+    void Init() override;
+
+    /** 获取下一行，行的顺序不确定 */
+    bool Next(Tuple* tuple, RID* rid) override;
+
+    /** 获取汇总计划节点 */
+    GatherPlanNode* GetGatherPlan() const {
+        return static_cast<GatherPlanNode*>(plan_.get());
+    }
+
+    /** 已经分发的morsel数 */
+    size_t GetMorselCount() const {
+        return morsel_source_ != nullptr ? morsel_source_->GetMorselCount() : 0;
+    }
+
+   private:
+    /** 第index个工作线程：运行自己的子执行器，结果按批放进交换队列 */
+    void RunWorker(size_t index);
+
+    /** 关闭交换队列并等待工作线程退出 */
+    void Shutdown();
+
+    std::unique_ptr<MorselSource> morsel_source_;
+    std::unique_ptr<ExchangeQueue> queue_;
+    std::vector<std::unique_ptr<ExecutorContext>> worker_contexts_;
+    std::vector<std::unique_ptr<Executor>> worker_executors_;
+    std::vector<std::thread> workers_;
+
+    std::vector<Tuple> batch_;  // 当前从队列取出的批次
+    size_t batch_index_ = 0;
+};
+
+/**
+ * 追加执行器
+ * 按分区表的各个子计划依次或者并行输出结果
+ *
+ * 实现思路：
+ * 1. 串行时子执行器用同一个上下文，一个输出完再初始化下一个
+ * 2. 并行时每个工作线程有自己的执行器上下文，从共享的计数器领取下一个
+ *    子计划，创建子执行器运行，结果和GatherExecutor一样攒成批次经过
+ *    交换队列输出；工作线程的上下文没有锁管理器，表锁在Init里加
+ * 3. count_rows时依次运行各个修改语句的子计划，把它们输出的
+ *    affected_rows加起来，只输出一行
+ */
+class AppendExecutor : public Executor {
+   public:
+    /**
+     * 构造函数
+     * @param exec_ctx 执行器上下文
+     * @param plan 追加计划节点
+     */
+    AppendExecutor(ExecutorContext* exec_ctx,
+                   std::unique_ptr<AppendPlanNode> plan);
+
+    /** 停止并等待所有工作线程 */
+    ~AppendExecutor() override;
+
+    /** 串行时初始化第一个子执行器，并行时启动工作线程 */
+    void Init() override;
+
+    /** 获取下一行 */
+    bool Next(Tuple* tuple, RID* rid) override;
+
+    /** 获取追加计划节点 */
+    AppendPlanNode* GetAppendPlan() const {
+        return static_cast<AppendPlanNode*>(plan_.get());
+    }
+
+   private:
+    /** 为第index个子计划创建并初始化执行器 */
+    std::unique_ptr<Executor> OpenChild(ExecutorContext* context,
+                                        size_t index);
+
+    /** 运行所有修改语句的子计划，输出影响行数的和 */
+    bool NextCount(Tuple* tuple, RID* rid);
+
+    /** 工作线程：领取子计划运行，结果按批放进交换队列 */
+    void RunWorker(size_t index);
+
+    /** 关闭交换队列并等待工作线程退出 */
+    void Shutdown();
+
+    // 串行
+    std::unique_ptr<Executor> current_child_;
+    size_t next_child_ = 0;
+    bool count_done_ = false;
+
+    // 并行
+    std::atomic<size_t> next_task_{0};
+    std::unique_ptr<ExchangeQueue> queue_;
+    std::vector<std::unique_ptr<ExecutorContext>> worker_contexts_;
+    std::vector<std::thread> workers_;
+    std::vector<Tuple> batch_;  // 当前从队列取出的批次
+    size_t batch_index_ = 0;
 };
 
-}  // namespace SimpleRDBMS
\ No newline at end of file
+}  // namespace SimpleRDBMS
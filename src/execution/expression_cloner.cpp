@@ -40,6 +40,11 @@ std::unique_ptr<Expression> ExpressionCloner::Clone(const Expression* expr) {
             // 一元操作表达式：递归克隆操作数
             return CloneUnaryOp(static_cast<const UnaryOpExpression*>(expr));
 
+        case Expression::ExprType::FUNCTION_CALL:
+            // 函数调用表达式：递归克隆所有参数
+            return CloneFunctionCall(
+                static_cast<const FunctionCallExpression*>(expr));
+
         default:
             // 未知类型，返回空指针
             return nullptr;
@@ -54,6 +59,11 @@ std::unique_ptr<Expression> ExpressionCloner::Clone(const Expression* expr) {
  */
 std::unique_ptr<Expression> ExpressionCloner::CloneConstant(
     const ConstantExpression* expr) {
+    // 参数占位符共享原来的槽位，绑定的值对所有副本都可见
+    if (expr->IsParameter()) {
+        return std::make_unique<ConstantExpression>(expr->GetParameterIndex(),
+                                                    expr->GetParameter());
+    }
     // 复制Value对象，创建新的常量表达式
     return std::make_unique<ConstantExpression>(expr->GetValue());
 }
@@ -104,4 +114,20 @@ std::unique_ptr<Expression> ExpressionCloner::CloneUnaryOp(
                                                std::move(operand));
 }
 
+/**
+ * 克隆函数调用表达式
+ * 逐个克隆参数，函数名和*标记原样复制
+ * @param expr 原始函数调用表达式
+ * @return 新的函数调用表达式
+ */
+std::unique_ptr<Expression> ExpressionCloner::CloneFunctionCall(
+    const FunctionCallExpression* expr) {
+    std::vector<std::unique_ptr<Expression>> arguments;
+    for (const auto& argument : expr->GetArguments()) {
+        arguments.push_back(Clone(argument.get()));
+    }
+    return std::make_unique<FunctionCallExpression>(
+        expr->GetFunctionName(), std::move(arguments), expr->IsStar());
+}
+
 }  // namespace SimpleRDBMS
\ No newline at end of file
@@ -68,6 +68,15 @@ class ExpressionCloner {
      */
     static std::unique_ptr<Expression> CloneUnaryOp(
         const UnaryOpExpression* expr);
+
+    /**
+     * 克隆函数调用表达式
+     * 逐个递归克隆参数，保留函数名和COUNT(*)标记
+     * @param expr 原始函数调用表达式
+     * @return 新的函数调用表达式
+     */
+    static std::unique_ptr<Expression> CloneFunctionCall(
+        const FunctionCallExpression* expr);
 };
 
 }  // namespace SimpleRDBMS
\ No newline at end of file
@@ -8,9 +8,12 @@
 
 #include "execution/expression_evaluator.h"
 
+#include <algorithm>
+#include <iterator>
 #include <stdexcept>
 
 #include "common/exception.h"
+#include "execution/vector_kernels.h"
 
 namespace SimpleRDBMS {
 
@@ -248,8 +251,18 @@ Value ExpressionEvaluator::EvaluateArithmeticOp(const Value& left,
 Value ExpressionEvaluator::EvaluateUnaryOp(const UnaryOpExpression* expr,
                                            const Tuple& tuple) {
     Value operand_val = Evaluate(expr->GetOperand(), tuple);
+    return ApplyUnaryOp(expr->GetOperator(), operand_val);
+}
 
-    switch (expr->GetOperator()) {
+/**
+ * 应用一元操作符
+ * @param op 一元操作符
+ * @param operand_val 已经求出的操作数
+ * @return 运算结果
+ */
+Value ExpressionEvaluator::ApplyUnaryOp(UnaryOpExpression::OpType op,
+                                        const Value& operand_val) {
+    switch (op) {
         case UnaryOpExpression::OpType::NOT:
             // 逻辑NOT：对操作数取反
             return Value(!IsValueTrue(operand_val));
@@ -284,68 +297,42 @@ Value ExpressionEvaluator::EvaluateUnaryOp(const UnaryOpExpression* expr,
  */
 bool ExpressionEvaluator::CompareValues(const Value& left, const Value& right,
                                         BinaryOpExpression::OpType op) {
-    // 优先处理相同类型的比较，性能更好
-    if (left.index() == right.index()) {
-        switch (left.index()) {
-            case 0:  // bool类型
-                return CompareNumeric(std::get<bool>(left),
-                                      std::get<bool>(right), op);
-            case 1:  // int8_t类型
-                return CompareNumeric(std::get<int8_t>(left),
-                                      std::get<int8_t>(right), op);
-            case 2:  // int16_t类型
-                return CompareNumeric(std::get<int16_t>(left),
-                                      std::get<int16_t>(right), op);
-            case 3:  // int32_t类型
-                return CompareNumeric(std::get<int32_t>(left),
-                                      std::get<int32_t>(right), op);
-            case 4:  // int64_t类型
-                return CompareNumeric(std::get<int64_t>(left),
-                                      std::get<int64_t>(right), op);
-            case 5:  // float类型
-                return CompareNumeric(std::get<float>(left),
-                                      std::get<float>(right), op);
-            case 6:  // double类型
-                return CompareNumeric(std::get<double>(left),
-                                      std::get<double>(right), op);
-            case 7:  // string类型
-                return CompareNumeric(std::get<std::string>(left),
-                                      std::get<std::string>(right), op);
-        }
-    }
-
-    // 处理不同数值类型间的转换比较
-    auto safe_to_double = [](const Value& val) -> std::pair<bool, double> {
-        try {
-            if (std::holds_alternative<int8_t>(val))
-                return {true, static_cast<double>(std::get<int8_t>(val))};
-            if (std::holds_alternative<int16_t>(val))
-                return {true, static_cast<double>(std::get<int16_t>(val))};
-            if (std::holds_alternative<int32_t>(val))
-                return {true, static_cast<double>(std::get<int32_t>(val))};
-            if (std::holds_alternative<int64_t>(val))
-                return {true, static_cast<double>(std::get<int64_t>(val))};
-            if (std::holds_alternative<float>(val))
-                return {true, static_cast<double>(std::get<float>(val))};
-            if (std::holds_alternative<double>(val))
-                return {true, std::get<double>(val)};
-            return {false, 0.0};
-        } catch (const std::bad_variant_access&) {
-            return {false, 0.0};
-        }
-    };
-
-    auto left_result = safe_to_double(left);
-    auto right_result = safe_to_double(right);
+    return CompareCompactValues(CompactValue::FromValue(left),
+                                CompactValue::FromValue(right), op);
+}
 
-    // 如果两个操作数都能转换为数值，则进行数值比较
-    if (left_result.first && right_result.first) {
-        return CompareNumeric(left_result.second, right_result.second, op);
+/**
+ * 比较两个紧凑值
+ * 先由CompactValue::Compare得到大小关系（同类型直接比较，不同的数值类型
+ * 转换成double），再按操作符取结果；有NaN参与时只有!=成立
+ */
+bool ExpressionEvaluator::CompareCompactValues(const CompactValue& left,
+                                               const CompactValue& right,
+                                               BinaryOpExpression::OpType op) {
+    using Ordering = CompactValue::Ordering;
+    Ordering ordering = CompactValue::Compare(left, right);
+    if (ordering == Ordering::INCOMPARABLE) {
+        throw ExecutionException(
+            "Type mismatch in comparison - cannot convert operands to "
+            "comparable types");
+    }
+    switch (op) {
+        case BinaryOpExpression::OpType::EQUALS:
+            return ordering == Ordering::EQUAL;
+        case BinaryOpExpression::OpType::NOT_EQUALS:
+            return ordering != Ordering::EQUAL;
+        case BinaryOpExpression::OpType::LESS_THAN:
+            return ordering == Ordering::LESS;
+        case BinaryOpExpression::OpType::LESS_EQUALS:
+            return ordering == Ordering::LESS || ordering == Ordering::EQUAL;
+        case BinaryOpExpression::OpType::GREATER_THAN:
+            return ordering == Ordering::GREATER;
+        case BinaryOpExpression::OpType::GREATER_EQUALS:
+            return ordering == Ordering::GREATER ||
+                   ordering == Ordering::EQUAL;
+        default:
+            throw ExecutionException("Unsupported comparison operator");
     }
-
-    throw ExecutionException(
-        "Type mismatch in comparison - cannot convert operands to comparable "
-        "types");
 }
 
 /**
@@ -415,4 +402,622 @@ bool ExpressionEvaluator::IsValueTrue(const Value& value) {
     return false;
 }
 
-}  // namespace SimpleRDBMS
\ No newline at end of file
+BinaryOpExpression::OpType ExpressionEvaluator::FlipComparison(
+    BinaryOpExpression::OpType op) {
+    switch (op) {
+        case BinaryOpExpression::OpType::LESS_THAN:
+            return BinaryOpExpression::OpType::GREATER_THAN;
+        case BinaryOpExpression::OpType::GREATER_THAN:
+            return BinaryOpExpression::OpType::LESS_THAN;
+        case BinaryOpExpression::OpType::LESS_EQUALS:
+            return BinaryOpExpression::OpType::GREATER_EQUALS;
+        case BinaryOpExpression::OpType::GREATER_EQUALS:
+            return BinaryOpExpression::OpType::LESS_EQUALS;
+        default:
+            return op;
+    }
+}
+
+/** 值对应的类型，和Value里各个选项的顺序一致 */
+static TypeId TypeOfValue(const Value& value) {
+    if (std::holds_alternative<bool>(value)) return TypeId::BOOLEAN;
+    if (std::holds_alternative<int8_t>(value)) return TypeId::TINYINT;
+    if (std::holds_alternative<int16_t>(value)) return TypeId::SMALLINT;
+    if (std::holds_alternative<int32_t>(value)) return TypeId::INTEGER;
+    if (std::holds_alternative<int64_t>(value)) return TypeId::BIGINT;
+    if (std::holds_alternative<float>(value)) return TypeId::FLOAT;
+    if (std::holds_alternative<double>(value)) return TypeId::DOUBLE;
+    if (std::holds_alternative<std::string>(value)) return TypeId::VARCHAR;
+    return TypeId::INVALID;
+}
+
+TypeId ExpressionEvaluator::InferType(const Expression* expr,
+                                      const Schema* schema) {
+    if (expr == nullptr) {
+        return TypeId::INVALID;
+    }
+    switch (expr->GetType()) {
+        case Expression::ExprType::CONSTANT:
+            return TypeOfValue(
+                static_cast<const ConstantExpression*>(expr)->GetValue());
+        case Expression::ExprType::COLUMN_REF: {
+            const std::string& name =
+                static_cast<const ColumnRefExpression*>(expr)->GetColumnName();
+            if (schema == nullptr || !schema->HasColumn(name)) {
+                return TypeId::INVALID;
+            }
+            return schema->GetColumn(name).type;
+        }
+        case Expression::ExprType::UNARY_OP: {
+            const auto* unary = static_cast<const UnaryOpExpression*>(expr);
+            if (unary->GetOperator() == UnaryOpExpression::OpType::NOT) {
+                return TypeId::BOOLEAN;
+            }
+            return InferType(unary->GetOperand(), schema);
+        }
+        case Expression::ExprType::BINARY_OP: {
+            const auto* binary = static_cast<const BinaryOpExpression*>(expr);
+            BinaryOpExpression::OpType op = binary->GetOperator();
+            if (op != BinaryOpExpression::OpType::PLUS &&
+                op != BinaryOpExpression::OpType::MINUS &&
+                op != BinaryOpExpression::OpType::MULTIPLY &&
+                op != BinaryOpExpression::OpType::DIVIDE) {
+                return TypeId::BOOLEAN;
+            }
+            TypeId left = InferType(binary->GetLeft(), schema);
+            TypeId right = InferType(binary->GetRight(), schema);
+            if (left == TypeId::INVALID || right == TypeId::INVALID ||
+                left == TypeId::VARCHAR || right == TypeId::VARCHAR) {
+                return TypeId::INVALID;
+            }
+            bool real = left == TypeId::FLOAT || left == TypeId::DOUBLE ||
+                        right == TypeId::FLOAT || right == TypeId::DOUBLE;
+            return real || op == BinaryOpExpression::OpType::DIVIDE
+                       ? TypeId::DOUBLE
+                       : TypeId::BIGINT;
+        }
+        default:
+            return TypeId::INVALID;
+    }
+}
+
+size_t ExpressionEvaluator::ResolveColumn(const ColumnRefExpression* expr,
+                                          size_t column_count) {
+    const std::string& column_name = expr->GetColumnName();
+    try {
+        if (!schema_) {
+            throw ExecutionException("Schema is null in expression evaluator");
+        }
+        size_t column_idx = schema_->GetColumnIdx(column_name);
+        if (column_idx >= column_count) {
+            throw ExecutionException("Column index out of range: " +
+                                     column_name);
+        }
+        return column_idx;
+    } catch (const std::exception& e) {
+        throw ExecutionException("Column not found or invalid: " + column_name +
+                                 " - " + e.what());
+    }
+}
+
+void ExpressionEvaluator::EvaluateBatch(const Expression* expr,
+                                        const VectorBatch& batch,
+                                        std::vector<Value>* results) {
+    EvaluateRows(expr, batch, batch.GetSelection(), results);
+}
+
+void ExpressionEvaluator::FilterBatch(const Expression* expr,
+                                      VectorBatch* batch) {
+    FilterRows(expr, *batch, batch->GetMutableSelection());
+}
+
+/**
+ * 批量求值
+ * 实现思路：
+ * 1. 常量和列引用直接填充或者按行号取出整列的值
+ * 2. 算术和比较先把左右两边各自求成一列，再逐行合并
+ * 3. AND/OR用FilterRows求出成立的行，再按行号写回true/false，
+ *    这样右边只对需要的行求值，和逐行的短路求值一致
+ */
+void ExpressionEvaluator::EvaluateRows(const Expression* expr,
+                                       const VectorBatch& batch,
+                                       const std::vector<uint32_t>& rows,
+                                       std::vector<Value>* results) {
+    if (!expr) {
+        throw ExecutionException("Null expression");
+    }
+    results->clear();
+    results->reserve(rows.size());
+
+    switch (expr->GetType()) {
+        case Expression::ExprType::CONSTANT:
+            results->assign(
+                rows.size(),
+                static_cast<const ConstantExpression*>(expr)->GetValue());
+            return;
+
+        case Expression::ExprType::COLUMN_REF: {
+            size_t column_idx =
+                ResolveColumn(static_cast<const ColumnRefExpression*>(expr),
+                              batch.GetColumnCount());
+            const auto& column = batch.GetColumn(column_idx);
+            for (uint32_t row : rows) {
+                results->push_back(column[row]);
+            }
+            return;
+        }
+
+        case Expression::ExprType::BINARY_OP: {
+            const auto* binary_expr =
+                static_cast<const BinaryOpExpression*>(expr);
+            BinaryOpExpression::OpType op = binary_expr->GetOperator();
+            if (op == BinaryOpExpression::OpType::AND ||
+                op == BinaryOpExpression::OpType::OR) {
+                std::vector<uint32_t> true_rows = rows;
+                FilterRows(expr, batch, &true_rows);
+                size_t next_true = 0;
+                for (uint32_t row : rows) {
+                    bool is_true = next_true < true_rows.size() &&
+                                   true_rows[next_true] == row;
+                    if (is_true) {
+                        next_true++;
+                    }
+                    results->push_back(Value(is_true));
+                }
+                return;
+            }
+
+            std::vector<Value> left_values;
+            std::vector<Value> right_values;
+            EvaluateRows(binary_expr->GetLeft(), batch, rows, &left_values);
+            EvaluateRows(binary_expr->GetRight(), batch, rows, &right_values);
+            bool is_arithmetic = op == BinaryOpExpression::OpType::PLUS ||
+                                 op == BinaryOpExpression::OpType::MINUS ||
+                                 op == BinaryOpExpression::OpType::MULTIPLY ||
+                                 op == BinaryOpExpression::OpType::DIVIDE;
+            if (is_arithmetic &&
+                ArithmeticWithKernel(left_values, right_values, op, results)) {
+                return;
+            }
+            for (size_t i = 0; i < rows.size(); i++) {
+                if (is_arithmetic) {
+                    results->push_back(EvaluateArithmeticOp(
+                        left_values[i], right_values[i], op));
+                } else {
+                    results->push_back(Value(
+                        CompareValues(left_values[i], right_values[i], op)));
+                }
+            }
+            return;
+        }
+
+        case Expression::ExprType::UNARY_OP: {
+            const auto* unary_expr =
+                static_cast<const UnaryOpExpression*>(expr);
+            std::vector<Value> operand_values;
+            EvaluateRows(unary_expr->GetOperand(), batch, rows,
+                         &operand_values);
+            for (const auto& operand : operand_values) {
+                results->push_back(
+                    ApplyUnaryOp(unary_expr->GetOperator(), operand));
+            }
+            return;
+        }
+
+        default:
+            throw ExecutionException("Unsupported expression type");
+    }
+}
+
+/**
+ * 批量过滤
+ * 实现思路：
+ * 1. AND依次用左右两边过滤，右边只看到左边留下的行
+ * 2. OR先用左边过滤一份副本，剩下的行再交给右边，两部分按行号归并
+ * 3. 列和常量的比较走FilterColumnCompare，不生成中间结果
+ * 4. 其他表达式批量求值后按真值保留行
+ */
+void ExpressionEvaluator::FilterRows(const Expression* expr,
+                                     const VectorBatch& batch,
+                                     std::vector<uint32_t>* rows) {
+    if (!expr) {
+        throw ExecutionException("Null expression");
+    }
+    if (rows->empty()) {
+        return;
+    }
+
+    if (IsKernelPredicate(expr)) {
+        std::vector<uint8_t> matches;
+        if (KernelMask(expr, batch, *rows, &matches)) {
+            size_t kept = 0;
+            for (size_t i = 0; i < rows->size(); i++) {
+                if (matches[i]) {
+                    (*rows)[kept++] = (*rows)[i];
+                }
+            }
+            rows->resize(kept);
+            return;
+        }
+    }
+
+    if (expr->GetType() == Expression::ExprType::BINARY_OP) {
+        const auto* binary_expr = static_cast<const BinaryOpExpression*>(expr);
+        BinaryOpExpression::OpType op = binary_expr->GetOperator();
+        if (op == BinaryOpExpression::OpType::AND) {
+            FilterRows(binary_expr->GetLeft(), batch, rows);
+            FilterRows(binary_expr->GetRight(), batch, rows);
+            return;
+        }
+        if (op == BinaryOpExpression::OpType::OR) {
+            std::vector<uint32_t> left_rows = *rows;
+            FilterRows(binary_expr->GetLeft(), batch, &left_rows);
+            std::vector<uint32_t> right_rows;
+            std::set_difference(rows->begin(), rows->end(), left_rows.begin(),
+                                left_rows.end(),
+                                std::back_inserter(right_rows));
+            FilterRows(binary_expr->GetRight(), batch, &right_rows);
+            rows->clear();
+            std::merge(left_rows.begin(), left_rows.end(), right_rows.begin(),
+                       right_rows.end(), std::back_inserter(*rows));
+            return;
+        }
+
+        bool is_comparison = op == BinaryOpExpression::OpType::EQUALS ||
+                             op == BinaryOpExpression::OpType::NOT_EQUALS ||
+                             op == BinaryOpExpression::OpType::LESS_THAN ||
+                             op == BinaryOpExpression::OpType::LESS_EQUALS ||
+                             op == BinaryOpExpression::OpType::GREATER_THAN ||
+                             op == BinaryOpExpression::OpType::GREATER_EQUALS;
+        const Expression* left = binary_expr->GetLeft();
+        const Expression* right = binary_expr->GetRight();
+        if (is_comparison && left->GetType() == Expression::ExprType::CONSTANT &&
+            right->GetType() == Expression::ExprType::COLUMN_REF) {
+            std::swap(left, right);
+            op = FlipComparison(op);
+        }
+        if (is_comparison &&
+            left->GetType() == Expression::ExprType::COLUMN_REF &&
+            right->GetType() == Expression::ExprType::CONSTANT) {
+            size_t column_idx =
+                ResolveColumn(static_cast<const ColumnRefExpression*>(left),
+                              batch.GetColumnCount());
+            const auto& column = batch.GetColumn(column_idx);
+            const Value& constant =
+                static_cast<const ConstantExpression*>(right)->GetValue();
+            if (std::holds_alternative<int32_t>(constant)) {
+                FilterColumnCompare<int32_t>(column, constant, op, rows);
+            } else if (std::holds_alternative<int64_t>(constant)) {
+                FilterColumnCompare<int64_t>(column, constant, op, rows);
+            } else if (std::holds_alternative<double>(constant)) {
+                FilterColumnCompare<double>(column, constant, op, rows);
+            } else if (std::holds_alternative<std::string>(constant)) {
+                FilterColumnCompare<std::string>(column, constant, op, rows);
+            } else {
+                size_t kept = 0;
+                for (uint32_t row : *rows) {
+                    if (CompareValues(column[row], constant, op)) {
+                        (*rows)[kept++] = row;
+                    }
+                }
+                rows->resize(kept);
+            }
+            return;
+        }
+
+        // 计算出来的值和常量比较，比如 price * 2 > 100
+        if (is_comparison &&
+            right->GetType() == Expression::ExprType::CONSTANT) {
+            const Value& constant =
+                static_cast<const ConstantExpression*>(right)->GetValue();
+            std::vector<Value> values;
+            EvaluateRows(left, batch, *rows, &values);
+            std::vector<uint8_t> matches;
+            if (!CompareWithKernel(
+                    [&values](size_t i) -> const Value& { return values[i]; },
+                    values.size(), constant, op, &matches)) {
+                matches.resize(values.size());
+                for (size_t i = 0; i < values.size(); i++) {
+                    matches[i] = CompareValues(values[i], constant, op);
+                }
+            }
+            size_t kept = 0;
+            for (size_t i = 0; i < values.size(); i++) {
+                if (matches[i]) {
+                    (*rows)[kept++] = (*rows)[i];
+                }
+            }
+            rows->resize(kept);
+            return;
+        }
+    }
+
+    std::vector<Value> values;
+    EvaluateRows(expr, batch, *rows, &values);
+    size_t kept = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (IsValueTrue(values[i])) {
+            (*rows)[kept++] = (*rows)[i];
+        }
+    }
+    rows->resize(kept);
+}
+
+template <typename T>
+void ExpressionEvaluator::FilterColumnCompare(const std::vector<Value>& column,
+                                              const Value& constant,
+                                              BinaryOpExpression::OpType op,
+                                              std::vector<uint32_t>* rows) {
+    const T& typed_constant = std::get<T>(constant);
+    size_t kept = 0;
+    auto keep_if = [&](auto compare) {
+        for (uint32_t row : *rows) {
+            const T* value = std::get_if<T>(&column[row]);
+            bool matched = value != nullptr
+                               ? compare(*value, typed_constant)
+                               : CompareValues(column[row], constant, op);
+            if (matched) {
+                (*rows)[kept++] = row;
+            }
+        }
+    };
+    switch (op) {
+        case BinaryOpExpression::OpType::EQUALS:
+            keep_if([](const T& a, const T& b) { return a == b; });
+            break;
+        case BinaryOpExpression::OpType::NOT_EQUALS:
+            keep_if([](const T& a, const T& b) { return a != b; });
+            break;
+        case BinaryOpExpression::OpType::LESS_THAN:
+            keep_if([](const T& a, const T& b) { return a < b; });
+            break;
+        case BinaryOpExpression::OpType::LESS_EQUALS:
+            keep_if([](const T& a, const T& b) { return a <= b; });
+            break;
+        case BinaryOpExpression::OpType::GREATER_THAN:
+            keep_if([](const T& a, const T& b) { return a > b; });
+            break;
+        case BinaryOpExpression::OpType::GREATER_EQUALS:
+            keep_if([](const T& a, const T& b) { return a >= b; });
+            break;
+        default:
+            throw ExecutionException("Unsupported comparison operator");
+    }
+    rows->resize(kept);
+}
+
+/** 比较操作符 */
+static bool IsComparisonOp(BinaryOpExpression::OpType op) {
+    return op == BinaryOpExpression::OpType::EQUALS ||
+           op == BinaryOpExpression::OpType::NOT_EQUALS ||
+           op == BinaryOpExpression::OpType::LESS_THAN ||
+           op == BinaryOpExpression::OpType::LESS_EQUALS ||
+           op == BinaryOpExpression::OpType::GREATER_THAN ||
+           op == BinaryOpExpression::OpType::GREATER_EQUALS;
+}
+
+/** 转换成double，bool和字符串不是数值，和CompareValues的规则一致 */
+static bool NumericToDouble(const Value& value, double* result) {
+    switch (value.index()) {
+        case 1:
+            *result = std::get<int8_t>(value);
+            return true;
+        case 2:
+            *result = std::get<int16_t>(value);
+            return true;
+        case 3:
+            *result = std::get<int32_t>(value);
+            return true;
+        case 4:
+            *result = static_cast<double>(std::get<int64_t>(value));
+            return true;
+        case 5:
+            *result = std::get<float>(value);
+            return true;
+        case 6:
+            *result = std::get<double>(value);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/** 按原生类型取出所有值，有一个类型不同就返回false */
+template <typename T, typename ValueAt>
+static bool GatherNative(ValueAt value_at, size_t count,
+                         std::vector<T>* buffer) {
+    buffer->resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const T* value = std::get_if<T>(&value_at(i));
+        if (value == nullptr) {
+            return false;
+        }
+        (*buffer)[i] = *value;
+    }
+    return true;
+}
+
+/** 把所有值转换成double取出，有非数值就返回false */
+template <typename ValueAt>
+static bool GatherDouble(ValueAt value_at, size_t count,
+                         std::vector<double>* buffer) {
+    buffer->resize(count);
+    for (size_t i = 0; i < count; i++) {
+        if (!NumericToDouble(value_at(i), &(*buffer)[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ExpressionEvaluator::IsKernelPredicate(const Expression* expr) const {
+    if (expr == nullptr || expr->GetType() != Expression::ExprType::BINARY_OP) {
+        return false;
+    }
+    const auto* binary_expr = static_cast<const BinaryOpExpression*>(expr);
+    BinaryOpExpression::OpType op = binary_expr->GetOperator();
+    if (op == BinaryOpExpression::OpType::AND ||
+        op == BinaryOpExpression::OpType::OR) {
+        return IsKernelPredicate(binary_expr->GetLeft()) &&
+               IsKernelPredicate(binary_expr->GetRight());
+    }
+    if (!IsComparisonOp(op)) {
+        return false;
+    }
+    const Expression* left = binary_expr->GetLeft();
+    const Expression* right = binary_expr->GetRight();
+    if (left->GetType() == Expression::ExprType::CONSTANT) {
+        std::swap(left, right);
+    }
+    if (left->GetType() != Expression::ExprType::COLUMN_REF ||
+        right->GetType() != Expression::ExprType::CONSTANT) {
+        return false;
+    }
+    double unused;
+    if (!NumericToDouble(
+            static_cast<const ConstantExpression*>(right)->GetValue(),
+            &unused)) {
+        return false;
+    }
+    // 列必须存在，否则要走逐值比较报告和逐行求值相同的错误
+    const auto& column_name =
+        static_cast<const ColumnRefExpression*>(left)->GetColumnName();
+    return schema_ != nullptr && schema_->HasColumn(column_name);
+}
+
+/**
+ * 计算条件的字节掩码
+ * 实现思路：AND/OR分别算出两边的掩码再合并，
+ * 比较条件从列里按行号取出值交给比较内核
+ */
+bool ExpressionEvaluator::KernelMask(const Expression* expr,
+                                     const VectorBatch& batch,
+                                     const std::vector<uint32_t>& rows,
+                                     std::vector<uint8_t>* matches) {
+    const auto* binary_expr = static_cast<const BinaryOpExpression*>(expr);
+    BinaryOpExpression::OpType op = binary_expr->GetOperator();
+    if (op == BinaryOpExpression::OpType::AND ||
+        op == BinaryOpExpression::OpType::OR) {
+        std::vector<uint8_t> other;
+        if (!KernelMask(binary_expr->GetLeft(), batch, rows, matches) ||
+            !KernelMask(binary_expr->GetRight(), batch, rows, &other)) {
+            return false;
+        }
+        if (op == BinaryOpExpression::OpType::AND) {
+            VectorKernels::And(matches->data(), other.data(), rows.size());
+        } else {
+            VectorKernels::Or(matches->data(), other.data(), rows.size());
+        }
+        return true;
+    }
+
+    const Expression* left = binary_expr->GetLeft();
+    const Expression* right = binary_expr->GetRight();
+    if (left->GetType() == Expression::ExprType::CONSTANT) {
+        std::swap(left, right);
+        op = FlipComparison(op);
+    }
+    size_t column_idx =
+        ResolveColumn(static_cast<const ColumnRefExpression*>(left),
+                      batch.GetColumnCount());
+    const auto& column = batch.GetColumn(column_idx);
+    return CompareWithKernel(
+        [&column, &rows](size_t i) -> const Value& { return column[rows[i]]; },
+        rows.size(), static_cast<const ConstantExpression*>(right)->GetValue(),
+        op, matches);
+}
+
+template <typename ValueAt>
+bool ExpressionEvaluator::CompareWithKernel(ValueAt value_at, size_t count,
+                                            const Value& constant,
+                                            BinaryOpExpression::OpType op,
+                                            std::vector<uint8_t>* matches) {
+    if (!IsComparisonOp(op)) {
+        return false;
+    }
+    matches->resize(count);
+    if (count == 0) {
+        return true;
+    }
+
+    if (const auto* c = std::get_if<int32_t>(&constant)) {
+        if (GatherNative(value_at, count, &int32_buffer_)) {
+            VectorKernels::Compare(int32_buffer_.data(), count, *c, op,
+                                   matches->data());
+            return true;
+        }
+    } else if (const auto* c = std::get_if<int64_t>(&constant)) {
+        // BIGINT之间转换成double会丢精度，同类型的值只能原生比较
+        if (std::holds_alternative<int64_t>(value_at(0))) {
+            if (!GatherNative(value_at, count, &int64_buffer_)) {
+                return false;
+            }
+            VectorKernels::Compare(int64_buffer_.data(), count, *c, op,
+                                   matches->data());
+            return true;
+        }
+    }
+
+    double double_constant;
+    if (!NumericToDouble(constant, &double_constant) ||
+        !GatherDouble(value_at, count, &double_buffer_)) {
+        return false;
+    }
+    if (std::holds_alternative<int64_t>(constant)) {
+        for (size_t i = 0; i < count; i++) {
+            if (std::holds_alternative<int64_t>(value_at(i))) {
+                return false;
+            }
+        }
+    }
+    VectorKernels::Compare(double_buffer_.data(), count, double_constant, op,
+                           matches->data());
+    return true;
+}
+
+/**
+ * 整列算术运算
+ * 实现思路：两边都转换成double交给算术内核，
+ * 然后逐行按EvaluateArithmeticOp的规则决定结果是INT还是DOUBLE
+ */
+bool ExpressionEvaluator::ArithmeticWithKernel(
+    const std::vector<Value>& left, const std::vector<Value>& right,
+    BinaryOpExpression::OpType op, std::vector<Value>* results) {
+    size_t count = left.size();
+    std::vector<double> left_numbers;
+    std::vector<double> right_numbers;
+    if (!GatherDouble([&left](size_t i) -> const Value& { return left[i]; },
+                      count, &left_numbers) ||
+        !GatherDouble([&right](size_t i) -> const Value& { return right[i]; },
+                      count, &right_numbers)) {
+        return false;
+    }
+    if (op == BinaryOpExpression::OpType::DIVIDE) {
+        for (double divisor : right_numbers) {
+            if (divisor == 0) {
+                return false;
+            }
+        }
+    }
+
+    double_buffer_.resize(count);
+    VectorKernels::Arithmetic(left_numbers.data(), right_numbers.data(), count,
+                              op, double_buffer_.data());
+    auto is_integer = [](const Value& value) {
+        return std::holds_alternative<int32_t>(value) ||
+               std::holds_alternative<int64_t>(value);
+    };
+    results->clear();
+    results->reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (op != BinaryOpExpression::OpType::DIVIDE && is_integer(left[i]) &&
+            is_integer(right[i])) {
+            results->push_back(Value(static_cast<int32_t>(double_buffer_[i])));
+        } else {
+            results->push_back(Value(double_buffer_[i]));
+        }
+    }
+    return true;
+}
+
+}  // namespace SimpleRDBMS
@@ -8,10 +8,15 @@
 
 #pragma once
 
+#include <cstdint>
 #include <variant>
+#include <vector>
 
 #include "catalog/schema.h"
+#include "common/arena.h"
+#include "common/compact_value.h"
 #include "common/types.h"
+#include "execution/vector_batch.h"
 #include "parser/ast.h"
 #include "record/tuple.h"
 
@@ -27,8 +32,10 @@ namespace SimpleRDBMS {
  * 2. 支持多种数据类型的自动转换和比较
  * 3. 实现短路求值优化（AND/OR逻辑运算）
  * 4. 提供统一的Value类型作为计算结果
+ * 5. 批量接口按列处理一整个VectorBatch，结果和逐行求值一致；
+ *    数值列和常量的比较、AND/OR和算术运算交给VectorKernels
  */
-class ExpressionEvaluator {
+class ExpressionEvaluator : public ArenaAllocated {
    public:
     /**
      * 构造函数
@@ -55,7 +62,67 @@ class ExpressionEvaluator {
      */
     bool EvaluateAsBoolean(const Expression* expr, const Tuple& tuple);
 
+    /**
+     * 值比较功能
+     * 支持同类型直接比较和不同数值类型间的自动转换比较
+     * 实现SQL的比较语义，处理类型兼容性
+     * 顺序扫描用区域摘要过滤页面时也用它，保证和逐行求值的结果一致
+     * @param left 左操作数
+     * @param right 右操作数
+     * @param op 比较操作符
+     * @return 比较结果
+     * @throws ExecutionException 两个值无法比较时
+     */
+    static bool CompareValues(const Value& left, const Value& right,
+                              BinaryOpExpression::OpType op);
+
+    /**
+     * 紧凑值的比较，规则和异常都同CompareValues
+     * CompareValues把两边转换成CompactValue后调用它，
+     * 从页面视图直接解码出的列值也可以不经过Value直接比较
+     */
+    static bool CompareCompactValues(const CompactValue& left,
+                                     const CompactValue& right,
+                                     BinaryOpExpression::OpType op);
+
+    /**
+     * 批量求值
+     * 对批次里每个选中的行计算表达式，一次遍历表达式树处理整批数据
+     * @param expr 要计算的表达式
+     * @param batch 输入批次，列的顺序和schema一致
+     * @param results 输出参数，按选择向量的顺序给出每个选中行的结果
+     */
+    void EvaluateBatch(const Expression* expr, const VectorBatch& batch,
+                       std::vector<Value>* results);
+
+    /**
+     * 批量过滤
+     * 把不满足条件的行从批次的选择向量里去掉，真值语义和EvaluateAsBoolean相同；
+     * AND的右边只对左边成立的行求值，OR的右边只对左边不成立的行求值
+     * @param expr WHERE条件
+     * @param batch 输入输出批次
+     */
+    void FilterBatch(const Expression* expr, VectorBatch* batch);
+
+    /**
+     * 交换比较操作数后对应的操作符，比如 5 < x 等价于 x > 5
+     * 非比较操作符和对称的 =、!= 原样返回
+     */
+    static BinaryOpExpression::OpType FlipComparison(
+        BinaryOpExpression::OpType op);
+
+    /**
+     * 推断表达式结果的类型
+     * 列引用取schema里的类型，常量取值的类型；比较和逻辑运算是BOOLEAN，
+     * 不含除法的整数运算是BIGINT，其他算术运算是DOUBLE
+     * @return 列找不到或者表达式不支持时返回TypeId::INVALID
+     */
+    static TypeId InferType(const Expression* expr, const Schema* schema);
+
    private:
+    // 预编译的表达式复用这里的运算规则，保证两种求值方式的结果一致
+    friend class CompiledExpression;
+
     const Schema* schema_;  // 表schema，用于列名到索引的映射
 
     /**
@@ -99,6 +166,78 @@ class ExpressionEvaluator {
      */
     Value EvaluateUnaryOp(const UnaryOpExpression* expr, const Tuple& tuple);
 
+    /** 对已经求出的操作数应用一元操作符，逐行和批量求值共用 */
+    static Value ApplyUnaryOp(UnaryOpExpression::OpType op,
+                              const Value& operand);
+
+    /** 找到列引用在schema里的位置，找不到时抛出和逐行求值相同的异常 */
+    size_t ResolveColumn(const ColumnRefExpression* expr,
+                         size_t column_count);
+
+    /**
+     * 批量求值的实现，rows给出要计算的行号
+     * AND/OR借助FilterRows求出成立的行，保持短路求值的语义
+     */
+    void EvaluateRows(const Expression* expr, const VectorBatch& batch,
+                      const std::vector<uint32_t>& rows,
+                      std::vector<Value>* results);
+
+    /** 批量过滤的实现，从rows里去掉条件不成立的行 */
+    void FilterRows(const Expression* expr, const VectorBatch& batch,
+                    std::vector<uint32_t>* rows);
+
+    /**
+     * 列和常量比较的批量过滤
+     * 常量的类型确定后操作符的分支提到循环外面，
+     * 列值和常量同类型时直接比较原生值，类型不同的行退回CompareValues
+     */
+    template <typename T>
+    void FilterColumnCompare(const std::vector<Value>& column,
+                             const Value& constant,
+                             BinaryOpExpression::OpType op,
+                             std::vector<uint32_t>* rows);
+
+    /**
+     * 条件是否只由 数值列 比较 数值常量 和AND/OR组成
+     * 这样的条件不会抛出异常，可以不做短路，整批算出掩码再合并
+     */
+    bool IsKernelPredicate(const Expression* expr) const;
+
+    /**
+     * 用内核计算IsKernelPredicate条件在rows上的字节掩码
+     * @return 列里出现了内核处理不了的值时返回false，调用者改走逐值比较
+     */
+    bool KernelMask(const Expression* expr, const VectorBatch& batch,
+                    const std::vector<uint32_t>& rows,
+                    std::vector<uint8_t>* matches);
+
+    /**
+     * 取出count个值和数值常量比较，结果写成字节掩码
+     * 常量和值同为INT或BIGINT时按原生类型比较，
+     * 其他数值组合像CompareValues一样都转换成double比较
+     * @param value_at 返回第i个值的函数
+     * @return 有值不是数值类型时返回false
+     */
+    template <typename ValueAt>
+    bool CompareWithKernel(ValueAt value_at, size_t count,
+                           const Value& constant,
+                           BinaryOpExpression::OpType op,
+                           std::vector<uint8_t>* matches);
+
+    /**
+     * 用内核做整列的算术运算，结果类型的规则和EvaluateArithmeticOp相同
+     * @return 有非数值或者除数为0时返回false，调用者逐行计算并报告错误
+     */
+    bool ArithmeticWithKernel(const std::vector<Value>& left,
+                              const std::vector<Value>& right,
+                              BinaryOpExpression::OpType op,
+                              std::vector<Value>* results);
+
+    // 内核输入的暂存区，批次之间复用
+    std::vector<int32_t> int32_buffer_;
+    std::vector<int64_t> int64_buffer_;
+    std::vector<double> double_buffer_;
+
     /**
      * 算术运算专用求值方法
      * 处理数值类型的加减乘除运算
@@ -108,20 +247,8 @@ class ExpressionEvaluator {
      * @param op 算术操作符
      * @return 运算结果
      */
-    Value EvaluateArithmeticOp(const Value& left, const Value& right,
-                               BinaryOpExpression::OpType op);
-
-    /**
-     * 值比较功能
-     * 支持同类型直接比较和不同数值类型间的自动转换比较
-     * 实现SQL的比较语义，处理类型兼容性
-     * @param left 左操作数
-     * @param right 右操作数
-     * @param op 比较操作符
-     * @return 比较结果
-     */
-    bool CompareValues(const Value& left, const Value& right,
-                       BinaryOpExpression::OpType op);
+    static Value EvaluateArithmeticOp(const Value& left, const Value& right,
+                                      BinaryOpExpression::OpType op);
 
     /**
      * Value真值判断
@@ -133,7 +260,7 @@ class ExpressionEvaluator {
      * @param value 要判断的值
      * @return 真值结果
      */
-    bool IsValueTrue(const Value& value);
+    static bool IsValueTrue(const Value& value);
 
     /**
      * 模板化的数值比较方法
@@ -145,8 +272,8 @@ class ExpressionEvaluator {
      * @return 比较结果
      */
     template <typename T>
-    bool CompareNumeric(const T& left, const T& right,
-                        BinaryOpExpression::OpType op);
+    static bool CompareNumeric(const T& left, const T& right,
+                               BinaryOpExpression::OpType op);
 };
 
 }  // namespace SimpleRDBMS
\ No newline at end of file
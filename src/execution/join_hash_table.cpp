@@ -0,0 +1,214 @@
+/*
+ * 文件: join_hash_table.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 哈希连接数据结构的实现
+ */
+
+#include "execution/join_hash_table.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+#include "common/exception.h"
+
+namespace SimpleRDBMS {
+
+// ==================== TupleArena ====================
+
+char* TupleArena::Allocate(size_t size) {
+    if (block_used_ + size > block_capacity_) {
+        size_t capacity = std::max(block_size_, size);
+        blocks_.push_back(std::make_unique<char[]>(capacity));
+        block_used_ = 0;
+        block_capacity_ = capacity;
+        allocated_bytes_ += capacity;
+    }
+    char* result = blocks_.back().get() + block_used_;
+    block_used_ += size;
+    return result;
+}
+
+const char* TupleArena::Append(const char* data, size_t size) {
+    char* result = Allocate(size);
+    std::memcpy(result, data, size);
+    return result;
+}
+
+void TupleArena::Clear() {
+    blocks_.clear();
+    block_used_ = 0;
+    block_capacity_ = 0;
+    allocated_bytes_ = 0;
+}
+
+// ==================== JoinHashTable ====================
+
+/** 把哈希值的比特打散，std::hash对整数是恒等映射，低位直接当槽位下标会聚集 */
+static uint64_t MixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+uint64_t JoinHashTable::HashValue(const Value& value) {
+    if (const auto* str = std::get_if<std::string>(&value)) {
+        return MixHash(std::hash<std::string>()(*str));
+    }
+    double number = std::visit(
+        [](const auto& v) -> double {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_arithmetic_v<T>) {
+                return static_cast<double>(v);
+            } else {
+                return 0.0;
+            }
+        },
+        value);
+    // 整数值按int64哈希，这样INTEGER和BIGINT、整数值的DOUBLE都能互相匹配
+    if (std::isfinite(number) && number == std::floor(number) &&
+        std::fabs(number) < 9.2e18) {
+        return MixHash(static_cast<uint64_t>(static_cast<int64_t>(number)));
+    }
+    return MixHash(std::hash<double>()(number));
+}
+
+void JoinHashTable::Insert(uint64_t hash, const char* data, uint32_t size) {
+    if ((size_ + 1) * 2 > slots_.size()) {
+        Grow();
+    }
+    size_t mask = slots_.size() - 1;
+    size_t position = hash & mask;
+    while (slots_[position].data != nullptr) {
+        position = (position + 1) & mask;
+    }
+    slots_[position] = Entry{hash, data, size};
+    size_++;
+}
+
+const JoinHashTable::Entry* JoinHashTable::FindNext(uint64_t hash,
+                                                    size_t* position) const {
+    if (slots_.empty()) {
+        return nullptr;
+    }
+    size_t mask = slots_.size() - 1;
+    while (slots_[*position].data != nullptr) {
+        const Entry* entry = &slots_[*position];
+        *position = (*position + 1) & mask;
+        if (entry->hash == hash) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+void JoinHashTable::Grow() {
+    std::vector<Entry> old_slots = std::move(slots_);
+    slots_.assign(old_slots.empty() ? 16 : old_slots.size() * 2, Entry{});
+    size_t mask = slots_.size() - 1;
+    for (const Entry& entry : old_slots) {
+        if (entry.data == nullptr) {
+            continue;
+        }
+        size_t position = entry.hash & mask;
+        while (slots_[position].data != nullptr) {
+            position = (position + 1) & mask;
+        }
+        slots_[position] = entry;
+    }
+}
+
+void JoinHashTable::Clear() {
+    slots_.clear();
+    size_ = 0;
+}
+
+// ==================== SpillPartition ====================
+
+void SpillPartition::Append(const char* data, uint16_t size) {
+    size_t needed = sizeof(uint16_t) + size;
+    if (sizeof(uint32_t) + needed > PAGE_SIZE) {
+        throw ExecutionException("Hash join: tuple too large to spill (" +
+                                 std::to_string(size) + " bytes)");
+    }
+    if (buffer_.empty()) {
+        buffer_.resize(sizeof(uint32_t));
+    } else if (buffer_.size() + needed > PAGE_SIZE) {
+        FlushBuffer();
+        buffer_.resize(sizeof(uint32_t));
+    }
+    size_t offset = buffer_.size();
+    buffer_.resize(offset + needed);
+    std::memcpy(buffer_.data() + offset, &size, sizeof(uint16_t));
+    std::memcpy(buffer_.data() + offset + sizeof(uint16_t), data, size);
+    buffered_count_++;
+    bytes_ += size;
+    tuple_count_++;
+}
+
+void SpillPartition::Finish() {
+    if (buffered_count_ > 0) {
+        FlushBuffer();
+    }
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+}
+
+void SpillPartition::FlushBuffer() {
+    page_id_t page_id = INVALID_PAGE_ID;
+    Page* page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+        throw ExecutionException(
+            "Hash join: failed to allocate a temp page for spilling");
+    }
+    std::memcpy(buffer_.data(), &buffered_count_, sizeof(uint32_t));
+    std::memcpy(page->GetData(), buffer_.data(), buffer_.size());
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    pages_.push_back(page_id);
+    buffered_count_ = 0;
+    buffer_.clear();
+}
+
+void SpillPartition::Drop() {
+    for (page_id_t page_id : pages_) {
+        buffer_pool_manager_->DeletePage(page_id);
+    }
+    pages_.clear();
+    buffer_.clear();
+    buffered_count_ = 0;
+    bytes_ = 0;
+    tuple_count_ = 0;
+}
+
+bool SpillPartition::Reader::Next(const char** data, uint16_t* size) {
+    while (remaining_ == 0) {
+        if (page_index_ >= partition_->pages_.size()) {
+            return false;
+        }
+        page_id_t page_id = partition_->pages_[page_index_++];
+        Page* page = partition_->buffer_pool_manager_->FetchPage(page_id);
+        if (page == nullptr) {
+            throw ExecutionException("Hash join: failed to fetch temp page " +
+                                     std::to_string(page_id));
+        }
+        page_data_.assign(page->GetData(), page->GetData() + PAGE_SIZE);
+        partition_->buffer_pool_manager_->UnpinPage(page_id, false);
+        std::memcpy(&remaining_, page_data_.data(), sizeof(uint32_t));
+        offset_ = sizeof(uint32_t);
+    }
+    std::memcpy(size, page_data_.data() + offset_, sizeof(uint16_t));
+    *data = page_data_.data() + offset_ + sizeof(uint16_t);
+    offset_ += sizeof(uint16_t) + *size;
+    remaining_--;
+    return true;
+}
+
+}  // namespace SimpleRDBMS
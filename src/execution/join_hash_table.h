@@ -0,0 +1,180 @@
+/*
+ * 文件: join_hash_table.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 哈希连接用到的数据结构：存放序列化tuple的内存区、开放寻址哈希表，
+ *       以及超出内存预算时把一个分区写到临时页面上的溢出分区
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/types.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * TupleArena - 按块分配的字节区
+ *
+ * 每条tuple按行格式序列化后追加到当前块，块用完再申请一块新的，
+ * 已经分配出去的地址在Clear之前一直有效，哈希表里只保存指针
+ */
+class TupleArena {
+   public:
+    /**
+     * 构造函数
+     * @param block_size 每块的字节数，超过块大小的tuple单独占一块
+     */
+    explicit TupleArena(size_t block_size = 64 * 1024)
+        : block_size_(block_size) {}
+
+    /** 复制size个字节到内存区，返回复制后的地址 */
+    const char* Append(const char* data, size_t size);
+
+    /** 为size个字节分配空间，由调用者写入内容 */
+    char* Allocate(size_t size);
+
+    /** 释放所有块 */
+    void Clear();
+
+    /** 已经申请的内存字节数，包括块里还没用到的部分 */
+    size_t GetAllocatedBytes() const { return allocated_bytes_; }
+
+   private:
+    size_t block_size_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_used_ = 0;      // 当前块已经用掉的字节数
+    size_t block_capacity_ = 0;  // 当前块的大小
+    size_t allocated_bytes_ = 0;
+};
+
+/**
+ * JoinHashTable - 开放寻址（线性探测）的哈希表
+ *
+ * 设计思路：
+ * - 槽位里只保存键的哈希值和tuple在TupleArena里的地址，不保存键本身，
+ *   哈希值相同的槽位由调用者用TupleView解码键再比较
+ * - 相同键的多条记录各占一个槽位，查找时沿探测序列找出所有哈希值相同的槽位，
+ *   遇到空槽位结束
+ * - 装载因子超过1/2时容量翻倍，用保存的哈希值重新放置，不需要重新计算
+ */
+class JoinHashTable {
+   public:
+    /** 一个槽位，data为nullptr表示空槽位 */
+    struct Entry {
+        uint64_t hash = 0;
+        const char* data = nullptr;
+        uint32_t size = 0;
+    };
+
+    /** 插入一条记录，data要在哈希表使用期间保持有效 */
+    void Insert(uint64_t hash, const char* data, uint32_t size);
+
+    /**
+     * 从*position开始查找下一个哈希值为hash的槽位
+     * @param hash 键的哈希值
+     * @param position 输入输出参数，第一次查找前用Begin(hash)初始化
+     * @return 找到的槽位，没有更多时返回nullptr
+     */
+    const Entry* FindNext(uint64_t hash, size_t* position) const;
+
+    /** 哈希值hash的探测起点 */
+    size_t Begin(uint64_t hash) const {
+        return slots_.empty() ? 0 : hash & (slots_.size() - 1);
+    }
+
+    void Clear();
+
+    size_t GetSize() const { return size_; }
+
+    /** 槽位数组占用的字节数 */
+    size_t GetMemoryUsage() const { return slots_.size() * sizeof(Entry); }
+
+    /**
+     * 计算连接键的哈希值
+     * 数值类型按值哈希：整数值的浮点数和整数得到相同的哈希值，
+     * 和CompareValues按数值比较的规则一致
+     */
+    static uint64_t HashValue(const Value& value);
+
+   private:
+    void Grow();
+
+    std::vector<Entry> slots_;  // 容量总是2的幂
+    size_t size_ = 0;
+};
+
+/**
+ * SpillPartition - 写到临时页面上的一个分区
+ *
+ * 页面格式：[uint32 tuple数][每条tuple：uint16 长度 + 数据]
+ * 写入时在内存里攒满一页再通过缓冲池分配新页面写出，任何时候最多固定一个页面；
+ * 读取时把页面复制出来再解除固定，所以读取中途不持有任何页面
+ * 分区析构或者Drop时删除所有临时页面
+ */
+class SpillPartition {
+   public:
+    explicit SpillPartition(BufferPoolManager* buffer_pool_manager)
+        : buffer_pool_manager_(buffer_pool_manager) {}
+    ~SpillPartition() { Drop(); }
+
+    SpillPartition(const SpillPartition&) = delete;
+    SpillPartition& operator=(const SpillPartition&) = delete;
+
+    /**
+     * 追加一条序列化的tuple
+     * @throws ExecutionException 缓冲池分配不出页面
+     */
+    void Append(const char* data, uint16_t size);
+
+    /** 把还在内存里的最后一页写出，之后才能读取 */
+    void Finish();
+
+    /** 删除所有临时页面 */
+    void Drop();
+
+    /** 分区里tuple的总字节数，用来决定哪一边建哈希表 */
+    size_t GetBytes() const { return bytes_; }
+    size_t GetTupleCount() const { return tuple_count_; }
+
+    /** 顺序读取分区里的tuple */
+    class Reader {
+       public:
+        explicit Reader(const SpillPartition* partition)
+            : partition_(partition) {}
+
+        /**
+         * 读取下一条tuple
+         * @param data 输出参数，在下一次调用Next之前有效
+         * @param size 输出参数
+         * @return 没有更多tuple时返回false
+         */
+        bool Next(const char** data, uint16_t* size);
+
+       private:
+        const SpillPartition* partition_;
+        size_t page_index_ = 0;
+        uint32_t remaining_ = 0;  // 当前页面还没读的tuple数
+        size_t offset_ = 0;
+        std::vector<char> page_data_;
+    };
+
+   private:
+    /** 把缓冲的一页写到新的临时页面 */
+    void FlushBuffer();
+
+    BufferPoolManager* buffer_pool_manager_;
+    std::vector<page_id_t> pages_;
+    std::vector<char> buffer_;  // 还没写出的一页
+    uint32_t buffered_count_ = 0;
+    size_t bytes_ = 0;
+    size_t tuple_count_ = 0;
+};
+
+}  // namespace SimpleRDBMS
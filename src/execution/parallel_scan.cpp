@@ -0,0 +1,84 @@
+/*
+ * 文件: parallel_scan.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 并行顺序扫描的页面分发器和交换队列的实现
+ */
+
+#include "execution/parallel_scan.h"
+
+#include <utility>
+
+namespace SimpleRDBMS {
+
+// ==================== MorselSource ====================
+
+MorselSource::MorselSource(TableHeap* table_heap, std::string table_name,
+                           size_t pages_per_morsel)
+    : table_heap_(table_heap),
+      table_name_(std::move(table_name)),
+      pages_per_morsel_(pages_per_morsel > 0 ? pages_per_morsel : 1) {}
+
+bool MorselSource::NextMorsel(std::vector<page_id_t>* pages) {
+    size_t begin = cursor_.fetch_add(pages_per_morsel_);
+    if (table_heap_->GetPageRange(begin, pages_per_morsel_, pages) == 0) {
+        return false;
+    }
+    morsel_count_++;
+    return true;
+}
+
+size_t MorselSource::GetMorselCount() const { return morsel_count_.load(); }
+
+// ==================== ExchangeQueue ====================
+
+ExchangeQueue::ExchangeQueue(size_t capacity, size_t producers)
+    : capacity_(capacity > 0 ? capacity : 1), active_producers_(producers) {}
+
+bool ExchangeQueue::Push(std::vector<Tuple> batch) {
+    std::unique_lock<std::mutex> lock(latch_);
+    not_full_.wait(lock,
+                   [this] { return closed_ || batches_.size() < capacity_; });
+    if (closed_) {
+        return false;
+    }
+    batches_.push_back(std::move(batch));
+    not_empty_.notify_one();
+    return true;
+}
+
+void ExchangeQueue::ProducerDone(std::exception_ptr error) {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (error != nullptr && error_ == nullptr) {
+        error_ = error;
+    }
+    active_producers_--;
+    not_empty_.notify_all();
+}
+
+bool ExchangeQueue::Pop(std::vector<Tuple>* batch) {
+    std::unique_lock<std::mutex> lock(latch_);
+    not_empty_.wait(lock, [this] {
+        return !batches_.empty() || active_producers_ == 0 ||
+               error_ != nullptr;
+    });
+    if (error_ != nullptr) {
+        std::rethrow_exception(error_);
+    }
+    if (batches_.empty()) {
+        return false;
+    }
+    *batch = std::move(batches_.front());
+    batches_.pop_front();
+    not_full_.notify_one();
+    return true;
+}
+
+void ExchangeQueue::Close() {
+    std::lock_guard<std::mutex> guard(latch_);
+    closed_ = true;
+    batches_.clear();
+    not_full_.notify_all();
+}
+
+}  // namespace SimpleRDBMS
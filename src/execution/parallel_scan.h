@@ -0,0 +1,123 @@
+/*
+ * 文件: parallel_scan.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 并行顺序扫描用到的数据结构：把表堆的页面按morsel分发给工作线程的
+ *       页面分发器，以及把各工作线程的结果汇总到一个消费者的交换队列
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "record/table_heap.h"
+#include "record/tuple.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * MorselSource - 把一张表的页面按morsel分发给并行扫描的工作线程
+ *
+ * 设计思路：
+ * - 按表堆的页面目录把表切成连续的页面区间，每个morsel是目录中
+ *   pages_per_morsel个相邻的页面，取morsel只是原子地推进一个序号，
+ *   不读页面也不用加锁
+ * - 工作线程做完一个morsel再来要下一个，快的线程自然多拿，
+ *   各线程的负载不需要预先划分
+ *
+ * 所有方法都是线程安全的
+ */
+class MorselSource {
+   public:
+    /**
+     * 构造函数
+     * @param table_heap 要扫描的表堆
+     * @param table_name 表名，扫描执行器据此判断分发器是不是给自己的
+     * @param pages_per_morsel 每个morsel的页面数
+     */
+    MorselSource(TableHeap* table_heap, std::string table_name,
+                 size_t pages_per_morsel = PARALLEL_SCAN_MORSEL_PAGES);
+
+    MorselSource(const MorselSource&) = delete;
+    MorselSource& operator=(const MorselSource&) = delete;
+
+    /**
+     * 取下一个morsel
+     * @param pages 输出参数，按链表顺序的页面ID
+     * @return 页面已经分发完时返回false
+     */
+    bool NextMorsel(std::vector<page_id_t>* pages);
+
+    const std::string& GetTableName() const { return table_name_; }
+
+    /** 已经分发的morsel数 */
+    size_t GetMorselCount() const;
+
+   private:
+    TableHeap* table_heap_;
+    std::string table_name_;
+    size_t pages_per_morsel_;
+
+    std::atomic<size_t> cursor_{0};  // 下一个要分发的页面在目录中的序号
+    std::atomic<size_t> morsel_count_{0};
+};
+
+/**
+ * ExchangeQueue - 多个生产者、一个消费者的有界批次队列
+ *
+ * 工作线程把结果攒成批次放进队列，队列满时等待消费者取走；
+ * 消费者取批次，所有生产者都结束并且队列为空时结束。
+ * 生产者出错时记下第一个异常，消费者下一次取批次时重新抛出；
+ * 消费者提前结束（比如LIMIT）时关闭队列，等待中的生产者醒来不再放入
+ */
+class ExchangeQueue {
+   public:
+    /**
+     * 构造函数
+     * @param capacity 最多缓存的批次数
+     * @param producers 生产者的个数，每个生产者结束时调用一次ProducerDone
+     */
+    ExchangeQueue(size_t capacity, size_t producers);
+
+    /**
+     * 放入一个批次，队列满时等待
+     * @return 队列已经被消费者关闭时返回false，生产者应当停止
+     */
+    bool Push(std::vector<Tuple> batch);
+
+    /**
+     * 一个生产者结束
+     * @param error 生产者出错时的异常，正常结束时为空
+     */
+    void ProducerDone(std::exception_ptr error = nullptr);
+
+    /**
+     * 取出一个批次，队列为空时等待
+     * @return 所有生产者都结束并且队列为空时返回false
+     * @throws 生产者记下的第一个异常
+     */
+    bool Pop(std::vector<Tuple>* batch);
+
+    /** 消费者不再需要结果，唤醒等待中的生产者 */
+    void Close();
+
+   private:
+    size_t capacity_;
+    std::mutex latch_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<std::vector<Tuple>> batches_;
+    size_t active_producers_;
+    bool closed_ = false;
+    std::exception_ptr error_;
+};
+
+}  // namespace SimpleRDBMS
@@ -8,16 +8,22 @@
 
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "common/arena.h"
 #include "common/types.h"
 
 // 前向声明，避免循环依赖
 namespace SimpleRDBMS {
 class Schema;
 class Expression;
+struct TableInfo;
+struct IndexInfo;
 
 /**
  * 计划节点类型枚举
@@ -26,6 +32,7 @@ class Expression;
 enum class PlanNodeType {
     SEQUENTIAL_SCAN,   // 顺序扫描（全表扫描）
     INDEX_SCAN,        // 索引扫描
+    INDEX_RANGE_SCAN,  // 索引范围扫描
     INSERT,            // 插入操作
     UPDATE,            // 更新操作
     DELETE,            // 删除操作
@@ -33,9 +40,13 @@ enum class PlanNodeType {
     FILTER,            // 过滤操作（WHERE子句）
     NESTED_LOOP_JOIN,  // 嵌套循环连接
     HASH_JOIN,         // 哈希连接
+    INDEX_NESTED_LOOP_JOIN,  // 索引嵌套循环连接
     AGGREGATION,       // 聚合操作（GROUP BY）
     SORT,              // 排序操作（ORDER BY）
-    LIMIT              // 限制操作（LIMIT子句）
+    LIMIT,             // 限制操作（LIMIT子句）
+    GATHER,            // 汇总并行工作线程的结果
+    APPEND,            // 依次（或者并行）输出各个分区子计划的结果
+    BITMAP_HEAP_SCAN   // 位图扫描：多个索引的RID取交集/并集后按页面顺序回表
 };
 
 /**
@@ -47,8 +58,9 @@ enum class PlanNodeType {
  * - 基于Volcano模型的迭代器执行模式
  * - 每个节点负责特定的数据库操作
  * - 通过组合不同节点构建复杂查询的执行计划
+ * - 查询期间从QueryArena分配，缓存的计划在QueryArena::Suspend里生成
  */
-class PlanNode {
+class PlanNode : public ArenaAllocated {
    public:
     /**
      * 构造函数
@@ -85,9 +97,62 @@ class PlanNode {
         return index < children_.size() ? children_[index].get() : nullptr;
     }
 
+    /**
+     * 设置优化器按统计信息估计的输出行数和代价，供EXPLAIN显示
+     * 表没有ANALYZE过时不设置
+     */
+    void SetEstimate(double rows, double cost) {
+        estimated_rows_ = rows;
+        estimated_cost_ = cost;
+    }
+
+    /** 估计的输出行数，没有估计时为-1 */
+    double GetEstimatedRows() const { return estimated_rows_; }
+
+    /** 估计的代价，没有估计时为-1 */
+    double GetEstimatedCost() const { return estimated_cost_; }
+
+    /**
+     * 绑定规划时查到的表和索引
+     * @param version 查找之前读到的catalog版本
+     *
+     * 执行器初始化时catalog还是这个版本就直接用绑定的指针，
+     * 不再按名字查找；版本变了说明中间有过DDL，指针可能已经失效
+     */
+    void BindCatalogObjects(TableInfo* table, IndexInfo* index,
+                            uint64_t version) {
+        bound_table_ = table;
+        bound_index_ = index;
+        bound_version_ = version;
+    }
+
+    /** 绑定的表，没有绑定或者catalog版本不是current_version时返回nullptr */
+    TableInfo* GetBoundTable(uint64_t current_version) const {
+        return bound_version_ == current_version ? bound_table_ : nullptr;
+    }
+
+    /** 绑定的索引，规则同GetBoundTable */
+    IndexInfo* GetBoundIndex(uint64_t current_version) const {
+        return bound_version_ == current_version ? bound_index_ : nullptr;
+    }
+
+    /** 复制计划时带上原计划的绑定 */
+    void CopyBindingFrom(const PlanNode& other) {
+        BindCatalogObjects(other.bound_table_, other.bound_index_,
+                           other.bound_version_);
+    }
+
    protected:
+    static constexpr uint64_t UNBOUND_VERSION =
+        std::numeric_limits<uint64_t>::max();
+
     const Schema* output_schema_;                      // 输出数据的schema
     std::vector<std::unique_ptr<PlanNode>> children_;  // 子节点列表
+    double estimated_rows_ = -1;
+    double estimated_cost_ = -1;
+    TableInfo* bound_table_ = nullptr;  // 见BindCatalogObjects
+    IndexInfo* bound_index_ = nullptr;
+    uint64_t bound_version_ = UNBOUND_VERSION;
 };
 
 /**
@@ -125,9 +190,23 @@ class SeqScanPlanNode : public PlanNode {
     /** 获取WHERE条件表达式 */
     Expression* GetPredicate() const { return predicate_.get(); }
 
+    /**
+     * 设置批量扫描需要解码的列
+     * 第i项为true时解码第i列，其余列只填占位值；为空时解码所有列
+     * 由投影根据用到的列设置，逐行接口总是返回完整的tuple
+     */
+    void SetDecodedColumns(std::vector<bool> columns) {
+        decoded_columns_ = std::move(columns);
+    }
+
+    const std::vector<bool>& GetDecodedColumns() const {
+        return decoded_columns_;
+    }
+
    private:
     std::string table_name_;                 // 目标表名
     std::unique_ptr<Expression> predicate_;  // WHERE条件
+    std::vector<bool> decoded_columns_;      // 批量扫描解码的列，空表示全部
 };
 
 /**
@@ -357,10 +436,559 @@ class IndexScanPlanNode : public PlanNode {
     /** 获取查询条件表达式 */
     Expression* GetPredicate() const { return predicate_.get(); }
 
+    /**
+     * 设置是否只读索引
+     * 查询用到的列都存在索引里（索引列加INCLUDE列）时由优化器设置，
+     * 执行器直接用索引项里的值组成结果，不再回表读取记录
+     */
+    void SetIndexOnly(bool index_only) { index_only_ = index_only; }
+
+    /** 是否只读索引 */
+    bool IsIndexOnly() const { return index_only_; }
+
    private:
     std::string table_name_;                 // 目标表名
     std::string index_name_;                 // 索引名
     std::unique_ptr<Expression> predicate_;  // 查询条件
+    bool index_only_ = false;                // 是否只读索引，不回表
+};
+
+/**
+ * 索引范围扫描计划节点
+ * 用B+树叶子链表按键的顺序读出 [lower, upper] 范围内的记录
+ *
+ * 适用场景：
+ * - WHERE indexed_col > a、<、<=、>= 以及它们的AND组合
+ * - WHERE indexed_col BETWEEN a AND b
+ *
+ * 边界由优化器从WHERE条件里提取，没有边界的一侧一直扫到索引的头或尾；
+ * predicate保存完整的WHERE条件，执行器对每一行再过滤一次，
+ * 所以边界只需要比真正的条件宽，不需要完全等价
+ */
+class IndexRangeScanPlanNode : public PlanNode {
+   public:
+    /**
+     * 构造函数
+     * @param output_schema 输出schema
+     * @param table_name 目标表名
+     * @param index_name 使用的索引名
+     * @param predicate 完整的WHERE条件，用于过滤边界内的每一行
+     */
+    IndexRangeScanPlanNode(const Schema* output_schema,
+                           const std::string& table_name,
+                           const std::string& index_name,
+                           std::unique_ptr<Expression> predicate = nullptr)
+        : PlanNode(output_schema, {}),
+          table_name_(table_name),
+          index_name_(index_name),
+          predicate_(std::move(predicate)) {}
+
+    /** 返回节点类型 */
+    PlanNodeType GetType() const override {
+        return PlanNodeType::INDEX_RANGE_SCAN;
+    }
+
+    /** 获取目标表名 */
+    const std::string& GetTableName() const { return table_name_; }
+
+    /** 获取使用的索引名 */
+    const std::string& GetIndexName() const { return index_name_; }
+
+    /** 获取WHERE条件表达式 */
+    Expression* GetPredicate() const { return predicate_.get(); }
+
+    /** 设置下界，inclusive为true表示包含等于下界的键 */
+    void SetLowerBound(const Value& value, bool inclusive) {
+        lower_parameter_.reset();
+        lower_bound_ = value;
+        lower_inclusive_ = inclusive;
+    }
+
+    /** 设置上界，inclusive为true表示包含等于上界的键 */
+    void SetUpperBound(const Value& value, bool inclusive) {
+        upper_parameter_.reset();
+        upper_bound_ = value;
+        upper_inclusive_ = inclusive;
+    }
+
+    /**
+     * 设置来自参数占位符的下界，边界跟着每次EXECUTE绑定的参数值变化，
+     * 预编译语句缓存的计划因此可以重复使用
+     */
+    void SetLowerBoundParameter(std::shared_ptr<const Value> parameter,
+                                bool inclusive) {
+        lower_bound_.reset();
+        lower_parameter_ = std::move(parameter);
+        lower_inclusive_ = inclusive;
+    }
+
+    /** 设置来自参数占位符的上界 */
+    void SetUpperBoundParameter(std::shared_ptr<const Value> parameter,
+                                bool inclusive) {
+        upper_bound_.reset();
+        upper_parameter_ = std::move(parameter);
+        upper_inclusive_ = inclusive;
+    }
+
+    /** 获取下界，没有下界时返回nullptr */
+    const Value* GetLowerBound() const {
+        if (lower_parameter_) {
+            return lower_parameter_.get();
+        }
+        return lower_bound_ ? &*lower_bound_ : nullptr;
+    }
+
+    /** 获取上界，没有上界时返回nullptr */
+    const Value* GetUpperBound() const {
+        if (upper_parameter_) {
+            return upper_parameter_.get();
+        }
+        return upper_bound_ ? &*upper_bound_ : nullptr;
+    }
+
+    /** 下界来自参数占位符时返回它的槽位，否则返回nullptr */
+    const std::shared_ptr<const Value>& GetLowerBoundParameter() const {
+        return lower_parameter_;
+    }
+
+    /** 上界来自参数占位符时返回它的槽位，否则返回nullptr */
+    const std::shared_ptr<const Value>& GetUpperBoundParameter() const {
+        return upper_parameter_;
+    }
+
+    bool IsLowerInclusive() const { return lower_inclusive_; }
+    bool IsUpperInclusive() const { return upper_inclusive_; }
+
+   private:
+    std::string table_name_;                 // 目标表名
+    std::string index_name_;                 // 索引名
+    std::unique_ptr<Expression> predicate_;  // 完整的WHERE条件
+    std::optional<Value> lower_bound_;       // 下界
+    std::optional<Value> upper_bound_;       // 上界
+    std::shared_ptr<const Value> lower_parameter_;  // 来自参数的下界
+    std::shared_ptr<const Value> upper_parameter_;  // 来自参数的上界
+    bool lower_inclusive_ = true;            // 下界是否闭区间
+    bool upper_inclusive_ = true;            // 上界是否闭区间
+};
+
+/**
+ * 位图扫描从索引取RID的条件树
+ * 叶子是一次索引查找，取出的RID放进位图；AND/OR节点对子节点的位图
+ * 取交集/并集。值都用shared_ptr保存：常量是规划时的副本，参数占位符
+ * 直接引用参数的槽位，预编译语句缓存的计划每次执行用当前绑定的值
+ */
+struct BitmapIndexCondition {
+    enum class Kind {
+        INDEX_LOOKUP,  // index_name上用key_values（键的前缀）做等值查找
+        INDEX_RANGE,   // 单列B+树索引index_name上的[lower, upper]范围
+        AND,           // 子条件的交集
+        OR             // 子条件的并集
+    };
+
+    Kind kind = Kind::INDEX_LOOKUP;
+    std::string index_name;
+    std::vector<std::shared_ptr<const Value>> key_values;
+    std::shared_ptr<const Value> lower;  // nullptr表示没有下界
+    std::shared_ptr<const Value> upper;  // nullptr表示没有上界
+    bool lower_inclusive = true;
+    bool upper_inclusive = true;
+    std::vector<BitmapIndexCondition> children;
+};
+
+/**
+ * 位图堆扫描计划节点
+ * WHERE里有几个条件分别能用不同的索引（AND），或者OR的每一支都能用索引时，
+ * 按条件树从各个索引取出RID组成位图，交集/并集之后按页面号的顺序回表，
+ * 每个页面只读一次；回表后用完整的WHERE条件再过滤
+ */
+class BitmapHeapScanPlanNode : public PlanNode {
+   public:
+    /**
+     * 构造函数
+     * @param output_schema 输出schema
+     * @param table_name 目标表名
+     * @param condition 取RID的条件树
+     * @param predicate 完整的WHERE条件
+     */
+    BitmapHeapScanPlanNode(const Schema* output_schema,
+                           const std::string& table_name,
+                           BitmapIndexCondition condition,
+                           std::unique_ptr<Expression> predicate = nullptr)
+        : PlanNode(output_schema, {}),
+          table_name_(table_name),
+          condition_(std::move(condition)),
+          predicate_(std::move(predicate)) {}
+
+    PlanNodeType GetType() const override {
+        return PlanNodeType::BITMAP_HEAP_SCAN;
+    }
+
+    const std::string& GetTableName() const { return table_name_; }
+    const BitmapIndexCondition& GetCondition() const { return condition_; }
+    Expression* GetPredicate() const { return predicate_.get(); }
+
+   private:
+    std::string table_name_;
+    BitmapIndexCondition condition_;
+    std::unique_ptr<Expression> predicate_;  // 完整的WHERE条件
+};
+
+/**
+ * 哈希连接计划节点
+ * 对应 FROM a [INNER] JOIN b ON a.x = b.y，两个子节点分别扫描左右两张表
+ *
+ * 输出schema是左表的列接着右表的列，列名写成"表名.列名"，
+ * 上层的投影和过滤条件都按这个名字引用列
+ * 连接键是子节点schema上的表达式；ON里其他的条件和WHERE里
+ * 同时用到两张表的条件放在predicate里，在连接后的tuple上求值
+ */
+class HashJoinPlanNode : public PlanNode {
+   public:
+    /**
+     * 构造函数
+     * @param output_schema 连接后的schema，由节点持有
+     * @param left 左表的扫描计划
+     * @param right 右表的扫描计划
+     * @param left_key 左表的连接键表达式
+     * @param right_key 右表的连接键表达式
+     * @param predicate 连接后再过滤的条件，可为空
+     */
+    HashJoinPlanNode(std::unique_ptr<Schema> output_schema,
+                     std::unique_ptr<PlanNode> left,
+                     std::unique_ptr<PlanNode> right,
+                     std::unique_ptr<Expression> left_key,
+                     std::unique_ptr<Expression> right_key,
+                     std::unique_ptr<Expression> predicate = nullptr)
+        : PlanNode(output_schema.get(), {}),
+          owned_schema_(std::move(output_schema)),
+          left_key_(std::move(left_key)),
+          right_key_(std::move(right_key)),
+          predicate_(std::move(predicate)) {
+        children_.push_back(std::move(left));
+        children_.push_back(std::move(right));
+    }
+
+    /** 返回节点类型 */
+    PlanNodeType GetType() const override { return PlanNodeType::HASH_JOIN; }
+
+    const PlanNode* GetLeftPlan() const { return GetChild(0); }
+    const PlanNode* GetRightPlan() const { return GetChild(1); }
+
+    Expression* GetLeftKey() const { return left_key_.get(); }
+    Expression* GetRightKey() const { return right_key_.get(); }
+
+    /** 获取连接后的过滤条件 */
+    Expression* GetPredicate() const { return predicate_.get(); }
+
+    /**
+     * 设置内存预算
+     * 建哈希表的输入超过预算时两边都分区写到临时页面
+     */
+    void SetMemoryBudget(size_t bytes) { memory_budget_ = bytes; }
+    size_t GetMemoryBudget() const { return memory_budget_; }
+
+   private:
+    std::unique_ptr<Schema> owned_schema_;   // 连接后的schema
+    std::unique_ptr<Expression> left_key_;   // 左表连接键
+    std::unique_ptr<Expression> right_key_;  // 右表连接键
+    std::unique_ptr<Expression> predicate_;  // 连接后的过滤条件
+    size_t memory_budget_ = HASH_JOIN_MEMORY_BUDGET;
+};
+
+/**
+ * 索引嵌套循环连接计划节点
+ * 外表逐行扫描，每一行用连接键在内表的索引上查找匹配的记录，
+ * 内表不需要整表扫描，也不需要放进内存
+ *
+ * 输出schema和HashJoinPlanNode一样是左表的列接着右表的列，
+ * 外表可以是左表也可以是右表；列名是"表名.列名"
+ */
+class IndexNestedLoopJoinPlanNode : public PlanNode {
+   public:
+    /**
+     * 构造函数
+     * @param output_schema 连接后的schema，由节点持有
+     * @param outer 外表的扫描计划
+     * @param outer_is_left 外表是不是连接的左表
+     * @param inner_table_name 内表名
+     * @param index_name 内表上第一列是连接列的索引
+     * @param outer_key 外表的连接键表达式，在外表的schema上求值
+     * @param inner_key_column 内表的连接列
+     * @param inner_predicate 只用到内表的条件，可为空
+     * @param predicate 连接后再过滤的条件，可为空
+     */
+    IndexNestedLoopJoinPlanNode(std::unique_ptr<Schema> output_schema,
+                                std::unique_ptr<PlanNode> outer,
+                                bool outer_is_left,
+                                const std::string& inner_table_name,
+                                const std::string& index_name,
+                                std::unique_ptr<Expression> outer_key,
+                                const std::string& inner_key_column,
+                                std::unique_ptr<Expression> inner_predicate,
+                                std::unique_ptr<Expression> predicate)
+        : PlanNode(output_schema.get(), {}),
+          owned_schema_(std::move(output_schema)),
+          outer_is_left_(outer_is_left),
+          inner_table_name_(inner_table_name),
+          index_name_(index_name),
+          outer_key_(std::move(outer_key)),
+          inner_key_column_(inner_key_column),
+          inner_predicate_(std::move(inner_predicate)),
+          predicate_(std::move(predicate)) {
+        children_.push_back(std::move(outer));
+    }
+
+    /** 返回节点类型 */
+    PlanNodeType GetType() const override {
+        return PlanNodeType::INDEX_NESTED_LOOP_JOIN;
+    }
+
+    const PlanNode* GetOuterPlan() const { return GetChild(0); }
+    bool IsOuterLeft() const { return outer_is_left_; }
+    const std::string& GetInnerTableName() const { return inner_table_name_; }
+    const std::string& GetIndexName() const { return index_name_; }
+    Expression* GetOuterKey() const { return outer_key_.get(); }
+    const std::string& GetInnerKeyColumn() const { return inner_key_column_; }
+    Expression* GetInnerPredicate() const { return inner_predicate_.get(); }
+
+    /** 获取连接后的过滤条件 */
+    Expression* GetPredicate() const { return predicate_.get(); }
+
+   private:
+    std::unique_ptr<Schema> owned_schema_;         // 连接后的schema
+    bool outer_is_left_;                           // 外表是否是左表
+    std::string inner_table_name_;                 // 内表名
+    std::string index_name_;                       // 内表的索引
+    std::unique_ptr<Expression> outer_key_;        // 外表连接键
+    std::string inner_key_column_;                 // 内表连接列
+    std::unique_ptr<Expression> inner_predicate_;  // 内表上的条件
+    std::unique_ptr<Expression> predicate_;        // 连接后的过滤条件
+};
+
+/** 聚合函数 */
+enum class AggregateType {
+    COUNT_STAR,  // COUNT(*)，统计行数
+    COUNT,       // COUNT(expr)，统计非NULL值的个数
+    SUM,
+    AVG,
+    MIN,
+    MAX
+};
+
+/**
+ * 聚合计划节点
+ * 对应 SELECT k, COUNT(*), SUM(x) FROM t [WHERE ...] GROUP BY k
+ *
+ * 子节点的每一行先算出分组键，再累加到这个分组的聚合状态上；
+ * 输出按SELECT列表的顺序排列，每一列要么是某个GROUP BY表达式，
+ * 要么是某个聚合函数的结果，不需要再加投影
+ * 没有GROUP BY时整个输入是一个分组，输入为空也输出一行
+ */
+class AggregationPlanNode : public PlanNode {
+   public:
+    /** 一个聚合函数和它的参数，COUNT(*)的参数为空 */
+    struct Aggregate {
+        AggregateType type;
+        std::unique_ptr<Expression> argument;
+    };
+
+    /** 一个输出列：第index个GROUP BY表达式，或者第index个聚合函数 */
+    struct OutputColumn {
+        bool is_aggregate;
+        size_t index;
+    };
+
+    /**
+     * 构造函数
+     * @param output_schema 输出schema，由节点持有
+     * @param child 输入计划
+     * @param group_by 分组表达式，在子节点的schema上求值
+     * @param aggregates 聚合函数
+     * @param output_columns 每个输出列的来源
+     */
+    AggregationPlanNode(std::unique_ptr<Schema> output_schema,
+                        std::unique_ptr<PlanNode> child,
+                        std::vector<std::unique_ptr<Expression>> group_by,
+                        std::vector<Aggregate> aggregates,
+                        std::vector<OutputColumn> output_columns)
+        : PlanNode(output_schema.get(), {}),
+          owned_schema_(std::move(output_schema)),
+          group_by_(std::move(group_by)),
+          aggregates_(std::move(aggregates)),
+          output_columns_(std::move(output_columns)) {
+        children_.push_back(std::move(child));
+    }
+
+    /** 返回节点类型 */
+    PlanNodeType GetType() const override { return PlanNodeType::AGGREGATION; }
+
+    const std::vector<std::unique_ptr<Expression>>& GetGroupBy() const {
+        return group_by_;
+    }
+    const std::vector<Aggregate>& GetAggregates() const { return aggregates_; }
+    const std::vector<OutputColumn>& GetOutputColumns() const {
+        return output_columns_;
+    }
+
+    /**
+     * 设置内存预算
+     * 分组状态超过预算时把部分聚合结果分区写到临时页面
+     */
+    void SetMemoryBudget(size_t bytes) { memory_budget_ = bytes; }
+    size_t GetMemoryBudget() const { return memory_budget_; }
+
+   private:
+    std::unique_ptr<Schema> owned_schema_;                // 输出schema
+    std::vector<std::unique_ptr<Expression>> group_by_;  // 分组表达式
+    std::vector<Aggregate> aggregates_;                   // 聚合函数
+    std::vector<OutputColumn> output_columns_;            // 输出列的来源
+    size_t memory_budget_ = AGGREGATION_MEMORY_BUDGET;
+};
+
+/**
+ * 排序计划节点
+ * 对应 ORDER BY key [ASC|DESC], ... [LIMIT n]
+ *
+ * 输出和子节点的schema相同，行按排序键排列；NULL比任何值都大，
+ * 升序时排在最后、降序时排在最前
+ * 带LIMIT时只需要最前面的n行，执行器用大小为n的堆做Top-N，不排序整个输入
+ */
+class SortPlanNode : public PlanNode {
+   public:
+    /** 一个排序键 */
+    struct SortKey {
+        std::unique_ptr<Expression> expression;  // 在子节点的schema上求值
+        bool ascending;
+    };
+
+    /**
+     * 构造函数
+     * @param child 输入计划，输出schema和它相同
+     * @param keys 排序键，前面的键优先
+     * @param limit 只输出前limit行，-1表示输出全部
+     */
+    SortPlanNode(std::unique_ptr<PlanNode> child, std::vector<SortKey> keys,
+                 int64_t limit = -1)
+        : PlanNode(child->GetOutputSchema(), {}),
+          keys_(std::move(keys)),
+          limit_(limit) {
+        children_.push_back(std::move(child));
+    }
+
+    /** 返回节点类型 */
+    PlanNodeType GetType() const override { return PlanNodeType::SORT; }
+
+    const std::vector<SortKey>& GetKeys() const { return keys_; }
+
+    bool HasLimit() const { return limit_ >= 0; }
+    int64_t GetLimit() const { return limit_; }
+
+    /**
+     * 设置内存预算（work_mem）
+     * 读入的行超过预算时排好序写成临时页面上的一个有序段
+     */
+    void SetMemoryBudget(size_t bytes) { memory_budget_ = bytes; }
+    size_t GetMemoryBudget() const { return memory_budget_; }
+
+   private:
+    std::vector<SortKey> keys_;  // 排序键
+    int64_t limit_;              // LIMIT的行数，-1表示没有
+    size_t memory_budget_ = SORT_MEMORY_BUDGET;
+};
+
+/**
+ * 限制行数计划节点
+ * 对应没有ORDER BY的LIMIT n：输出子节点的前n行后不再读取子节点
+ */
+class LimitPlanNode : public PlanNode {
+   public:
+    LimitPlanNode(std::unique_ptr<PlanNode> child, int64_t limit)
+        : PlanNode(child->GetOutputSchema(), {}), limit_(limit) {
+        children_.push_back(std::move(child));
+    }
+
+    /** 返回节点类型 */
+    PlanNodeType GetType() const override { return PlanNodeType::LIMIT; }
+
+    int64_t GetLimit() const { return limit_; }
+
+   private:
+    int64_t limit_;
+};
+
+/**
+ * 汇总计划节点
+ * 子计划是一条顺序扫描（可以带投影）的流水线，执行时每个工作线程运行
+ * 一份子计划的副本，扫描的页面按morsel从同一个分发器领取，
+ * 各线程的结果经过交换队列汇总输出；输出行的顺序不确定
+ */
+class GatherPlanNode : public PlanNode {
+   public:
+    /**
+     * 构造函数
+     * @param child 每个工作线程运行的子计划，输出schema和它相同
+     * @param workers 工作线程数
+     * @param morsel_pages 每个morsel的页面数
+     */
+    GatherPlanNode(std::unique_ptr<PlanNode> child, size_t workers,
+                   size_t morsel_pages = PARALLEL_SCAN_MORSEL_PAGES)
+        : PlanNode(child->GetOutputSchema(), {}),
+          workers_(workers),
+          morsel_pages_(morsel_pages) {
+        children_.push_back(std::move(child));
+    }
+
+    /** 返回节点类型 */
+    PlanNodeType GetType() const override { return PlanNodeType::GATHER; }
+
+    size_t GetWorkers() const { return workers_; }
+    size_t GetMorselPages() const { return morsel_pages_; }
+
+   private:
+    size_t workers_;       // 工作线程数
+    size_t morsel_pages_;  // 每个morsel的页面数
+};
+
+/**
+ * 追加计划节点
+ * 分区表上的查询和修改：每个没有被裁剪掉的分区一个子计划，
+ * 输出schema相同，结果按顺序拼在一起；workers大于1时工作线程各自领取
+ * 子计划执行，结果经过交换队列汇总输出，这时输出行的顺序不确定。
+ * count_rows为true时子计划是UPDATE/DELETE，各自输出一行affected_rows，
+ * 追加节点把它们加起来只输出一行
+ */
+class AppendPlanNode : public PlanNode {
+   public:
+    /**
+     * 构造函数
+     * @param output_schema 输出schema，和每个子计划的相同
+     * @param children 各个分区的子计划
+     * @param workers 并行执行子计划的工作线程数，1表示串行
+     * @param count_rows 子计划是修改语句，输出它们影响行数的和
+     */
+    AppendPlanNode(const Schema* output_schema,
+                   std::vector<std::unique_ptr<PlanNode>> children,
+                   size_t workers = 1, bool count_rows = false)
+        : PlanNode(output_schema, std::move(children)),
+          workers_(workers),
+          count_rows_(count_rows) {}
+
+    /** 返回节点类型 */
+    PlanNodeType GetType() const override { return PlanNodeType::APPEND; }
+
+    size_t GetWorkers() const { return workers_; }
+    bool IsCountRows() const { return count_rows_; }
+
+    /** count_rows时输出schema（affected_rows）由节点自己持有 */
+    void SetOwnedSchema(std::unique_ptr<Schema> schema) {
+        owned_schema_ = std::move(schema);
+        output_schema_ = owned_schema_.get();
+    }
+
+   private:
+    size_t workers_;   // 工作线程数
+    bool count_rows_;  // 子计划输出影响的行数
+    std::unique_ptr<Schema> owned_schema_;  // 管理schema生命周期
 };
 
-}  // namespace SimpleRDBMS
\ No newline at end of file
+}  // namespace SimpleRDBMS
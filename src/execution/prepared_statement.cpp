@@ -0,0 +1,49 @@
+/*
+ * 文件: prepared_statement.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 预编译语句的参数绑定和计划缓存
+ */
+
+#include "execution/prepared_statement.h"
+
+namespace SimpleRDBMS {
+
+PreparedStatement::PreparedStatement(
+    std::unique_ptr<Statement> statement,
+    std::vector<std::shared_ptr<Value>> parameters)
+    : statement_(std::move(statement)), parameters_(std::move(parameters)) {}
+
+bool PreparedStatement::Bind(const std::vector<Value>& arguments,
+                             std::string* error) {
+    if (arguments.size() != parameters_.size()) {
+        *error = "expected " + std::to_string(parameters_.size()) +
+                 " parameters, got " + std::to_string(arguments.size());
+        return false;
+    }
+    for (size_t i = 0; i < arguments.size(); i++) {
+        *parameters_[i] = arguments[i];
+    }
+    return true;
+}
+
+bool PreparedStatement::IsPlanCacheable() const {
+    return statement_->GetType() != Statement::StmtType::INSERT;
+}
+
+const PlanNode* PreparedStatement::GetCachedPlan(
+    uint64_t schema_version) const {
+    if (!cached_plan_ || cached_version_ != schema_version) {
+        return nullptr;
+    }
+    return cached_plan_.get();
+}
+
+void PreparedStatement::SetCachedPlan(std::unique_ptr<PlanNode> plan,
+                                      uint64_t schema_version) {
+    cached_plan_ = std::move(plan);
+    cached_version_ = schema_version;
+    plan_count_++;
+}
+
+}  // namespace SimpleRDBMS
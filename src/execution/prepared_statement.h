@@ -0,0 +1,94 @@
+/*
+ * 文件: prepared_statement.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 预编译语句：解析一次的语句、参数槽位和缓存的执行计划
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/types.h"
+#include "execution/plan_node.h"
+#include "parser/ast.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * PreparedStatement - 一个PREPARE过的语句
+ *
+ * 设计思路：
+ * - 语句里的 $n 是共享槽位的ConstantExpression，Bind把参数值写进槽位，
+ *   语句和从它生成的计划里的所有副本都读到新值，不需要重新解析
+ * - SELECT、UPDATE、DELETE的计划在第一次执行时生成并缓存，之后每次执行
+ *   复制一份交给执行器；生成计划时记下catalog的版本号，建删表、建删索引、
+ *   ANALYZE之后版本变了，下次执行重新生成
+ * - 第一次执行绑定的参数值参与了代价估计（比如是不是高频值），
+ *   之后的执行沿用同一个计划
+ * - INSERT的值在生成计划时拷进计划节点，每次执行都重新生成，
+ *   这一步只是查一次catalog和拷贝这一行，仍然省掉了解析
+ * - 槽位是共享的，同一个预编译语句的绑定和执行要持有GetMutex()串行进行
+ */
+class PreparedStatement {
+   public:
+    /**
+     * 构造函数
+     * @param statement 解析好的语句
+     * @param parameters 参数槽位，下标i对应 $(i+1)
+     */
+    PreparedStatement(std::unique_ptr<Statement> statement,
+                      std::vector<std::shared_ptr<Value>> parameters);
+
+    Statement* GetStatement() const { return statement_.get(); }
+
+    size_t GetParameterCount() const { return parameters_.size(); }
+
+    /**
+     * 把参数值写进槽位
+     * @param arguments 按 $1、$2 ... 顺序的参数值
+     * @param error 输出参数，失败时的原因
+     * @return 参数个数不对时返回false
+     */
+    bool Bind(const std::vector<Value>& arguments, std::string* error);
+
+    /** 计划能否缓存：INSERT每次执行重新生成 */
+    bool IsPlanCacheable() const;
+
+    /**
+     * 获取缓存的计划
+     * @param schema_version catalog当前的版本号
+     * @return 没有缓存或者缓存时的版本不同返回nullptr
+     */
+    const PlanNode* GetCachedPlan(uint64_t schema_version) const;
+
+    /** 缓存计划，记下生成计划时catalog的版本号 */
+    void SetCachedPlan(std::unique_ptr<PlanNode> plan, uint64_t schema_version);
+
+    /** 执行过的次数 */
+    size_t GetExecuteCount() const { return execute_count_; }
+
+    /** 计划生成的次数，用来观察缓存是否生效 */
+    size_t GetPlanCount() const { return plan_count_; }
+
+    void IncrementExecuteCount() { execute_count_++; }
+
+    std::mutex& GetMutex() { return mutex_; }
+
+   private:
+    std::unique_ptr<Statement> statement_;
+    std::vector<std::shared_ptr<Value>> parameters_;
+    std::unique_ptr<PlanNode> cached_plan_;
+    uint64_t cached_version_ = 0;
+    size_t execute_count_ = 0;
+    size_t plan_count_ = 0;
+    std::mutex mutex_;
+};
+
+}  // namespace SimpleRDBMS
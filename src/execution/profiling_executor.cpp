@@ -0,0 +1,106 @@
+/*
+ * 文件: profiling_executor.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: EXPLAIN ANALYZE执行器包装的实现
+ */
+
+#include "execution/profiling_executor.h"
+
+#include <chrono>
+
+namespace SimpleRDBMS {
+
+OperatorProfile* QueryProfiler::AddOperator(const PlanNode* plan) {
+    operators_.push_back(std::make_unique<OperatorProfile>());
+    OperatorProfile* profile = operators_.back().get();
+    profile->plan = plan;
+    if (current_ != nullptr) {
+        current_->children.push_back(profile);
+    }
+    return profile;
+}
+
+class ProfilingExecutor::CallScope {
+   public:
+    CallScope(QueryProfiler* profiler, OperatorProfile* profile,
+              uint64_t* elapsed_ns)
+        : profiler_(profiler),
+          profile_(profile),
+          elapsed_ns_(elapsed_ns),
+          previous_(profiler->GetCurrent()),
+          io_(Statistics::GetThreadIOCounters()),
+          start_(std::chrono::steady_clock::now()) {
+        profiler_->SetCurrent(profile_);
+    }
+
+    ~CallScope() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        *elapsed_ns_ += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count());
+        const ThreadIOCounters& now = Statistics::GetThreadIOCounters();
+        ThreadIOCounters& total = profile_->io;
+        total.buffer_hits += now.buffer_hits - io_.buffer_hits;
+        total.buffer_misses += now.buffer_misses - io_.buffer_misses;
+        total.disk_reads += now.disk_reads - io_.disk_reads;
+        total.lock_waits += now.lock_waits - io_.lock_waits;
+        total.lock_wait_ms += now.lock_wait_ms - io_.lock_wait_ms;
+        total.rows_examined += now.rows_examined - io_.rows_examined;
+        profiler_->SetCurrent(previous_);
+    }
+
+   private:
+    QueryProfiler* profiler_;
+    OperatorProfile* profile_;
+    uint64_t* elapsed_ns_;
+    OperatorProfile* previous_;
+    ThreadIOCounters io_;  // 调用开始时的计数
+    std::chrono::steady_clock::time_point start_;
+};
+
+ProfilingExecutor::ProfilingExecutor(ExecutorContext* exec_ctx,
+                                     std::unique_ptr<Executor> inner,
+                                     OperatorProfile* profile)
+    : Executor(exec_ctx, nullptr),
+      inner_(std::move(inner)),
+      profile_(profile),
+      profiler_(exec_ctx->GetProfiler()) {}
+
+void ProfilingExecutor::Init() {
+    CallScope scope(profiler_, profile_, &profile_->init_ns);
+    profile_->loops++;
+    inner_->Init();
+}
+
+bool ProfilingExecutor::Next(Tuple* tuple, RID* rid) {
+    CallScope scope(profiler_, profile_, &profile_->next_ns);
+    bool has_next = inner_->Next(tuple, rid);
+    if (has_next) {
+        profile_->rows++;
+    }
+    return has_next;
+}
+
+bool ProfilingExecutor::NextBatch(VectorBatch* batch) {
+    CallScope scope(profiler_, profile_, &profile_->next_ns);
+    bool has_next = inner_->NextBatch(batch);
+    if (has_next) {
+        profile_->rows += batch->GetSelectedCount();
+    }
+    return has_next;
+}
+
+std::unique_ptr<Executor> WrapForProfiling(ExecutorContext* exec_ctx,
+                                           const PlanNode* plan,
+                                           std::unique_ptr<Executor> executor) {
+    QueryProfiler* profiler = exec_ctx->GetProfiler();
+    if (profiler == nullptr || executor == nullptr) {
+        return executor;
+    }
+    OperatorProfile* profile = profiler->AddOperator(plan);
+    return std::make_unique<ProfilingExecutor>(exec_ctx, std::move(executor),
+                                               profile);
+}
+
+}  // namespace SimpleRDBMS
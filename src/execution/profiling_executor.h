@@ -0,0 +1,101 @@
+/*
+ * 文件: profiling_executor.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: EXPLAIN ANALYZE用的执行器包装，记录每个执行器的行数、耗时和I/O
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "execution/executor.h"
+#include "stat/stat.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * 一个执行器的运行数据
+ * 时间和I/O都包含子执行器的部分，和PostgreSQL的EXPLAIN ANALYZE一样
+ */
+struct OperatorProfile {
+    const PlanNode* plan = nullptr;  // 执行器持有的计划，执行器析构后失效
+    uint64_t rows = 0;               // 返回的行数
+    uint64_t loops = 0;              // Init的次数
+    uint64_t init_ns = 0;
+    uint64_t next_ns = 0;            // Next和NextBatch的总耗时
+    ThreadIOCounters io;
+    std::vector<OperatorProfile*> children;
+};
+
+/**
+ * QueryProfiler - 一次查询所有执行器的运行数据
+ *
+ * 设计思路：
+ * - 执行器的子执行器都是在父执行器的Init或者Next里创建的，
+ *   记下当前正在运行的执行器，新建的执行器就挂在它下面，
+ *   得到的树和执行器树一致（复制出来的子计划也能对上）
+ * - 数据只在执行查询的线程上记录，不加锁；并行扫描的工作线程
+ *   不记录，它们的时间算在汇总执行器等待的时间里
+ */
+class QueryProfiler {
+   public:
+    /** 登记一个执行器，挂在当前正在运行的执行器下面 */
+    OperatorProfile* AddOperator(const PlanNode* plan);
+
+    /** 第一个登记的执行器，也就是根执行器 */
+    const OperatorProfile* GetRoot() const {
+        return operators_.empty() ? nullptr : operators_.front().get();
+    }
+
+    OperatorProfile* GetCurrent() const { return current_; }
+    void SetCurrent(OperatorProfile* current) { current_ = current; }
+
+   private:
+    std::vector<std::unique_ptr<OperatorProfile>> operators_;
+    OperatorProfile* current_ = nullptr;
+};
+
+/**
+ * ProfilingExecutor - 记录运行数据的执行器包装
+ * 把调用原样转给被包装的执行器，前后各取一次时钟和线程的I/O计数
+ */
+class ProfilingExecutor : public Executor {
+   public:
+    ProfilingExecutor(ExecutorContext* exec_ctx,
+                      std::unique_ptr<Executor> inner,
+                      OperatorProfile* profile);
+
+    void Init() override;
+    bool Next(Tuple* tuple, RID* rid) override;
+    bool NextBatch(VectorBatch* batch) override;
+    bool IsVectorized() const override { return inner_->IsVectorized(); }
+    void SetRowLimit(size_t limit) override { inner_->SetRowLimit(limit); }
+    bool SetRuntimeFilter(std::shared_ptr<const BloomFilter> filter,
+                          const Expression* key) override {
+        return inner_->SetRuntimeFilter(std::move(filter), key);
+    }
+    const Schema* GetOutputSchema() const override {
+        return inner_->GetOutputSchema();
+    }
+
+   private:
+    /** 调用期间把自己设成当前执行器，结束后累加耗时和I/O */
+    class CallScope;
+
+    std::unique_ptr<Executor> inner_;
+    OperatorProfile* profile_;
+    QueryProfiler* profiler_;
+};
+
+/**
+ * 上下文开启了性能分析时把执行器包装成ProfilingExecutor，否则原样返回
+ * @param plan 执行器持有的计划
+ */
+std::unique_ptr<Executor> WrapForProfiling(ExecutorContext* exec_ctx,
+                                           const PlanNode* plan,
+                                           std::unique_ptr<Executor> executor);
+
+}  // namespace SimpleRDBMS
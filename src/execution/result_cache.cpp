@@ -0,0 +1,208 @@
+/*
+ * 文件: result_cache.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 查询结果缓存的实现
+ */
+
+#include "execution/result_cache.h"
+
+#include <iterator>
+#include <type_traits>
+#include <variant>
+
+#include "catalog/catalog.h"
+
+namespace SimpleRDBMS {
+
+ResultCache::ResultCache(size_t capacity_bytes)
+    : capacity_bytes_(capacity_bytes) {}
+
+/**
+ * 生成键
+ * 指纹后面依次接每个参数的类型序号和值的字节，字符串带上长度，
+ * 不同的参数序列不会拼出同一个键
+ */
+std::string ResultCache::MakeKey(const std::string& fingerprint,
+                                 const std::vector<Value>& params) {
+    std::string key = fingerprint;
+    key += '\n';
+    for (const Value& param : params) {
+        key += static_cast<char>(param.index());
+        std::visit(
+            [&key](const auto& value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, std::string>) {
+                    key += std::to_string(value.size());
+                    key += ':';
+                    key += value;
+                } else {
+                    key.append(reinterpret_cast<const char*>(&value),
+                               sizeof(value));
+                }
+            },
+            param);
+    }
+    return key;
+}
+
+bool ResultCache::CaptureVersions(Catalog* catalog,
+                                  const std::vector<std::string>& tables,
+                                  TableVersions* versions) {
+    versions->clear();
+    for (const auto& table : tables) {
+        uint64_t count;
+        if (!catalog->GetModificationCount(table, &count)) {
+            return false;
+        }
+        versions->emplace_back(table, count);
+    }
+    return true;
+}
+
+bool ResultCache::IsCurrent(const Entry& entry, Catalog* catalog) {
+    if (entry.schema_version != catalog->GetSchemaVersion()) {
+        return false;
+    }
+    for (const auto& [table, count] : entry.versions) {
+        uint64_t current;
+        if (!catalog->GetModificationCount(table, &current) ||
+            current != count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ResultCache::Lookup(const std::string& key, Catalog* catalog,
+                         std::vector<Tuple>* rows) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        stats_.misses++;
+        return false;
+    }
+    if (!IsCurrent(*it->second, catalog)) {
+        Erase(it->second);
+        stats_.invalidations++;
+        stats_.misses++;
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    *rows = it->second->rows;
+    stats_.hits++;
+    return true;
+}
+
+void ResultCache::Insert(const std::string& key, uint64_t schema_version,
+                         TableVersions versions, std::vector<Tuple> rows) {
+    size_t bytes = sizeof(Entry) + key.size();
+    for (const auto& [table, count] : versions) {
+        bytes += sizeof(std::pair<std::string, uint64_t>) + table.size();
+    }
+    for (const Tuple& row : rows) {
+        bytes += EstimateRowBytes(row);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (bytes > capacity_bytes_ / 4) {
+        return;
+    }
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        Erase(it->second);
+    }
+    if (memory_tracker_ != nullptr && !memory_tracker_->TryConsume(bytes)) {
+        return;
+    }
+    lru_.push_front(Entry{key, schema_version, std::move(versions),
+                          std::move(rows), bytes});
+    index_[key] = lru_.begin();
+    used_bytes_ += bytes;
+    EvictToFit();
+}
+
+size_t ResultCache::GetMaxEntryBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_bytes_ / 4;
+}
+
+void ResultCache::SetCapacity(size_t capacity_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_bytes_ = capacity_bytes;
+    EvictToFit();
+}
+
+void ResultCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    if (memory_tracker_ != nullptr) {
+        memory_tracker_->Release(used_bytes_);
+    }
+    used_bytes_ = 0;
+}
+
+ResultCacheStats ResultCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ResultCacheStats stats = stats_;
+    stats.entries = lru_.size();
+    stats.bytes = used_bytes_;
+    return stats;
+}
+
+/**
+ * 估计一行的内存
+ * 行对象本身、每个值，再加上字符串放不进对象内部时另外分配的空间
+ */
+size_t ResultCache::EstimateRowBytes(const Tuple& row) {
+    size_t bytes = sizeof(Tuple);
+    for (const Value& value : row.GetValues()) {
+        bytes += sizeof(Value);
+        if (const auto* text = std::get_if<std::string>(&value)) {
+            if (text->capacity() >= sizeof(std::string)) {
+                bytes += text->capacity() + 1;
+            }
+        }
+    }
+    return bytes;
+}
+
+void ResultCache::Erase(EntryList::iterator entry) {
+    used_bytes_ -= entry->bytes;
+    if (memory_tracker_ != nullptr) {
+        memory_tracker_->Release(entry->bytes);
+    }
+    index_.erase(entry->key);
+    lru_.erase(entry);
+}
+
+void ResultCache::EvictToFit() {
+    while (used_bytes_ > capacity_bytes_ && !lru_.empty()) {
+        Erase(std::prev(lru_.end()));
+        stats_.evictions++;
+    }
+}
+
+bool ResultCaptureSink::Consume(std::vector<Tuple>* rows) {
+    Capture(*rows);
+    return downstream_->Consume(rows);
+}
+
+void ResultCaptureSink::Capture(const std::vector<Tuple>& rows) {
+    if (overflow_) {
+        return;
+    }
+    for (const Tuple& row : rows) {
+        bytes_ += ResultCache::EstimateRowBytes(row);
+    }
+    if (bytes_ > max_bytes_) {
+        overflow_ = true;
+        rows_.clear();
+        rows_.shrink_to_fit();
+        return;
+    }
+    rows_.insert(rows_.end(), rows.begin(), rows.end());
+}
+
+}  // namespace SimpleRDBMS
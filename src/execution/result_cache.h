@@ -0,0 +1,172 @@
+/*
+ * 文件: result_cache.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 查询结果缓存：按规范化的查询文本和参数缓存SELECT的结果，
+ *       查询读过的表被修改后结果作废
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/memory_tracker.h"
+#include "common/types.h"
+#include "execution/result_sink.h"
+#include "record/tuple.h"
+
+namespace SimpleRDBMS {
+
+class Catalog;
+
+/** 结果缓存的统计 */
+struct ResultCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t invalidations = 0;  // 读过的表被修改而作废的结果
+    uint64_t evictions = 0;      // 超出内存预算被淘汰的结果
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+/**
+ * ResultCache - 查询结果缓存
+ *
+ * 设计思路：
+ * - 键是查询的指纹（字面量换成参数占位符的规范化文本）加上参数值，
+ *   只差在空白和关键字大小写上的同一个查询共用一个结果
+ * - 每个结果记下查询开始前的catalog版本和读过的每张表的修改计数，
+ *   查找时有一个变了，结果就作废并删掉；表删除后重建时修改计数
+ *   从0开始，靠catalog版本区分
+ * - 修改计数要在查询拿快照之前读：之后提交的修改都会让计数变大，
+ *   所以缓存的结果不会比它记下的计数所代表的数据旧
+ * - 按估计的内存大小记账，超过预算时淘汰最久没用的结果；
+ *   超过预算1/4的结果不缓存，免得一个大结果冲掉所有别的结果
+ * - 设置了记账器时缓存的结果同时记到它上面，服务器的内存不够时
+ *   记账器不给，这个结果就不缓存
+ */
+class ResultCache {
+   public:
+    /** 查询读的表，以及查询开始前它们的修改计数 */
+    using TableVersions = std::vector<std::pair<std::string, uint64_t>>;
+
+    /**
+     * @param capacity_bytes 缓存结果的内存预算
+     */
+    explicit ResultCache(size_t capacity_bytes);
+
+    /**
+     * 生成缓存的键
+     * @param fingerprint 查询的指纹
+     * @param params 按顺序的参数值，类型也是键的一部分
+     */
+    static std::string MakeKey(const std::string& fingerprint,
+                               const std::vector<Value>& params);
+
+    /**
+     * 读出查询读的表现在的修改计数
+     * @return 有表不存在时返回false
+     */
+    static bool CaptureVersions(Catalog* catalog,
+                                const std::vector<std::string>& tables,
+                                TableVersions* versions);
+
+    /**
+     * 查找缓存的结果
+     * @param rows 命中时输出结果行的副本
+     * @return 没有缓存或者已经作废时返回false
+     */
+    bool Lookup(const std::string& key, Catalog* catalog,
+                std::vector<Tuple>* rows);
+
+    /**
+     * 缓存一个结果，已经有同一个键的结果时替换它
+     * @param schema_version 查询开始前的catalog版本
+     * @param versions 查询开始前读的表的修改计数
+     */
+    void Insert(const std::string& key, uint64_t schema_version,
+                TableVersions versions, std::vector<Tuple> rows);
+
+    /** 一个结果最多多少字节，超过时不缓存 */
+    size_t GetMaxEntryBytes() const;
+
+    /**
+     * 设置记账器，在缓存任何结果之前调用
+     * @param tracker 服务器记账器下面的一层，nullptr表示不记账
+     */
+    void SetMemoryTracker(MemoryTracker* tracker) { memory_tracker_ = tracker; }
+
+    /** 修改内存预算，超出新预算的结果立即淘汰 */
+    void SetCapacity(size_t capacity_bytes);
+
+    void Clear();
+
+    ResultCacheStats GetStats() const;
+
+    /** 估计一行结果占用的内存 */
+    static size_t EstimateRowBytes(const Tuple& row);
+
+   private:
+    struct Entry {
+        std::string key;
+        uint64_t schema_version;
+        TableVersions versions;
+        std::vector<Tuple> rows;
+        size_t bytes;
+    };
+    using EntryList = std::list<Entry>;
+
+    /** 结果记下的版本和计数是否都还是现在的 */
+    static bool IsCurrent(const Entry& entry, Catalog* catalog);
+
+    /** 调用者持有mutex_ */
+    void Erase(EntryList::iterator entry);
+    void EvictToFit();
+
+    mutable std::mutex mutex_;
+    size_t capacity_bytes_;
+    size_t used_bytes_ = 0;
+    MemoryTracker* memory_tracker_ = nullptr;
+    EntryList lru_;  // 最近用过的在前面
+    std::unordered_map<std::string, EntryList::iterator> index_;
+    ResultCacheStats stats_;
+};
+
+/**
+ * ResultCaptureSink - 把流式发出去的结果行留一份给结果缓存
+ * 每一块先复制再交给下游的接收器；复制的行超过上限后不再复制，
+ * 这个结果也就不缓存了
+ */
+class ResultCaptureSink : public ResultSink {
+   public:
+    ResultCaptureSink(ResultSink* downstream, size_t max_bytes)
+        : downstream_(downstream), max_bytes_(max_bytes) {}
+
+    bool Consume(std::vector<Tuple>* rows) override;
+
+    /**
+     * 记上没有经过流式发送、留在结果集里的行
+     */
+    void Capture(const std::vector<Tuple>& rows);
+
+    /** 结果是否完整地复制下来了 */
+    bool IsComplete() const { return !overflow_; }
+
+    std::vector<Tuple> TakeRows() { return std::move(rows_); }
+
+   private:
+    ResultSink* downstream_;
+    size_t max_bytes_;
+    size_t bytes_ = 0;
+    bool overflow_ = false;
+    std::vector<Tuple> rows_;
+};
+
+}  // namespace SimpleRDBMS
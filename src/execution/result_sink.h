@@ -0,0 +1,42 @@
+/*
+ * 文件: result_sink.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 结果接收器：执行引擎边执行边把结果行交出去，不必先攒满整个结果集
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "record/tuple.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * ResultSink - 流式接收查询结果
+ *
+ * 设计思路：
+ * - 执行引擎拿到一个ResultSink时，计划产生的行每攒够
+ *   RESULT_STREAM_CHUNK_ROWS行调用一次Consume，最后不满一块的也会交出；
+ *   交出去的行不再留在result_set里，服务器内存里只有一块结果
+ * - Consume在执行线程里同步调用，它阻塞（比如socket发送缓冲区满了）
+ *   执行就停下来等，这就是对执行的反压
+ * - Consume返回false表示不要更多结果（比如客户端已经断开），
+ *   执行引擎停止执行并返回失败
+ * - 只对有执行计划的语句生效，SHOW TABLES、EXPLAIN这类语句的结果
+ *   仍然放在result_set里
+ */
+class ResultSink {
+   public:
+    virtual ~ResultSink() = default;
+
+    /**
+     * 接收一块结果行
+     * @param rows 这一块的行，接收器可以直接移走
+     * @return false表示停止执行
+     */
+    virtual bool Consume(std::vector<Tuple>* rows) = 0;
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,279 @@
+/*
+ * 文件: rid_bitmap.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: RID位图的实现
+ */
+
+#include "execution/rid_bitmap.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace SimpleRDBMS {
+
+namespace {
+
+constexpr size_t BITS_PER_WORD = 64;
+
+uint32_t CountBits(uint64_t word) {
+    return static_cast<uint32_t>(__builtin_popcountll(word));
+}
+
+}  // namespace
+
+bool RidBitmap::SlotSet::Contains(uint16_t slot) const {
+    if (IsBitset()) {
+        size_t word = slot / BITS_PER_WORD;
+        return word < words.size() &&
+               (words[word] >> (slot % BITS_PER_WORD) & 1) != 0;
+    }
+    return std::binary_search(slots.begin(), slots.end(), slot);
+}
+
+/**
+ * 选择存储形式
+ * 数组每个槽位2字节，位图的大小由最大的槽位决定；数组比位图大时换成位图，
+ * 位图比数组大一倍以上时换回数组，中间留一段余量，避免在边界上来回转换
+ */
+void RidBitmap::SlotSet::Optimize() {
+    if (IsBitset()) {
+        while (words.size() > 1 && words.back() == 0) {
+            words.pop_back();
+        }
+        if (count * sizeof(uint16_t) * 2 < words.size() * sizeof(uint64_t)) {
+            ToArray();
+        }
+        return;
+    }
+    if (slots.empty()) {
+        return;
+    }
+    size_t bitset_words = slots.back() / BITS_PER_WORD + 1;
+    if (count * sizeof(uint16_t) > bitset_words * sizeof(uint64_t)) {
+        ToBitset();
+    }
+}
+
+void RidBitmap::SlotSet::ToBitset() {
+    if (IsBitset()) {
+        return;
+    }
+    words.assign(slots.empty() ? 1 : slots.back() / BITS_PER_WORD + 1, 0);
+    for (uint16_t slot : slots) {
+        words[slot / BITS_PER_WORD] |= uint64_t{1} << (slot % BITS_PER_WORD);
+    }
+    slots.clear();
+    slots.shrink_to_fit();
+}
+
+void RidBitmap::SlotSet::ToArray() {
+    std::vector<uint16_t> result;
+    result.reserve(count);
+    for (size_t word = 0; word < words.size(); word++) {
+        uint64_t bits = words[word];
+        while (bits != 0) {
+            result.push_back(static_cast<uint16_t>(
+                word * BITS_PER_WORD + __builtin_ctzll(bits)));
+            bits &= bits - 1;
+        }
+    }
+    slots = std::move(result);
+    words.clear();
+    words.shrink_to_fit();
+}
+
+void RidBitmap::Add(const RID& rid) {
+    auto slot = static_cast<uint16_t>(rid.slot_num);
+    SlotSet& set = pages_[rid.page_id];
+    if (set.IsBitset()) {
+        size_t word = slot / BITS_PER_WORD;
+        if (word >= set.words.size()) {
+            set.words.resize(word + 1, 0);
+        }
+        uint64_t bit = uint64_t{1} << (slot % BITS_PER_WORD);
+        if ((set.words[word] & bit) == 0) {
+            set.words[word] |= bit;
+            set.count++;
+        }
+        return;
+    }
+    auto it = std::lower_bound(set.slots.begin(), set.slots.end(), slot);
+    if (it != set.slots.end() && *it == slot) {
+        return;
+    }
+    set.slots.insert(it, slot);
+    set.count++;
+    set.Optimize();
+}
+
+void RidBitmap::Remove(const RID& rid) {
+    auto page = pages_.find(rid.page_id);
+    if (page == pages_.end()) {
+        return;
+    }
+    auto slot = static_cast<uint16_t>(rid.slot_num);
+    SlotSet& set = page->second;
+    if (set.IsBitset()) {
+        size_t word = slot / BITS_PER_WORD;
+        uint64_t bit = uint64_t{1} << (slot % BITS_PER_WORD);
+        if (word >= set.words.size() || (set.words[word] & bit) == 0) {
+            return;
+        }
+        set.words[word] &= ~bit;
+    } else {
+        auto it = std::lower_bound(set.slots.begin(), set.slots.end(), slot);
+        if (it == set.slots.end() || *it != slot) {
+            return;
+        }
+        set.slots.erase(it);
+    }
+    if (--set.count == 0) {
+        pages_.erase(page);
+    } else {
+        set.Optimize();
+    }
+}
+
+bool RidBitmap::Contains(const RID& rid) const {
+    auto page = pages_.find(rid.page_id);
+    return page != pages_.end() &&
+           page->second.Contains(static_cast<uint16_t>(rid.slot_num));
+}
+
+/**
+ * 取交集
+ * 实现思路：
+ * 1. 只在一边出现的页面直接去掉
+ * 2. 两边都是位图时逐个字按位与；有一边是数组时用数组里的槽位
+ *    去查另一边，结果一定不比这个数组大，直接存成数组
+ * 3. 页面变空就去掉，否则重新选择存储形式
+ */
+void RidBitmap::IntersectWith(const RidBitmap& other) {
+    auto page = pages_.begin();
+    while (page != pages_.end()) {
+        auto other_page = other.pages_.find(page->first);
+        if (other_page == other.pages_.end()) {
+            page = pages_.erase(page);
+            continue;
+        }
+        SlotSet& set = page->second;
+        const SlotSet& other_set = other_page->second;
+        if (set.IsBitset() && other_set.IsBitset()) {
+            set.words.resize(std::min(set.words.size(), other_set.words.size()));
+            set.count = 0;
+            for (size_t i = 0; i < set.words.size(); i++) {
+                set.words[i] &= other_set.words[i];
+                set.count += CountBits(set.words[i]);
+            }
+        } else {
+            const SlotSet& array = set.IsBitset() ? other_set : set;
+            const SlotSet& probe = set.IsBitset() ? set : other_set;
+            std::vector<uint16_t> slots;
+            for (uint16_t slot : array.slots) {
+                if (probe.Contains(slot)) {
+                    slots.push_back(slot);
+                }
+            }
+            set.words.clear();
+            set.slots = std::move(slots);
+            set.count = static_cast<uint32_t>(set.slots.size());
+        }
+        if (set.count == 0) {
+            page = pages_.erase(page);
+        } else {
+            set.Optimize();
+            ++page;
+        }
+    }
+}
+
+/**
+ * 取并集
+ * 只在other里出现的页面整个复制过来；两边都有的页面，
+ * 都是数组时归并成新的数组，否则在位图上按位或
+ */
+void RidBitmap::UnionWith(const RidBitmap& other) {
+    for (const auto& [page_id, other_set] : other.pages_) {
+        auto page = pages_.find(page_id);
+        if (page == pages_.end()) {
+            pages_.emplace_hint(page, page_id, other_set);
+            continue;
+        }
+        SlotSet& set = page->second;
+        if (!set.IsBitset() && !other_set.IsBitset()) {
+            std::vector<uint16_t> slots;
+            slots.reserve(set.slots.size() + other_set.slots.size());
+            std::set_union(set.slots.begin(), set.slots.end(),
+                           other_set.slots.begin(), other_set.slots.end(),
+                           std::back_inserter(slots));
+            set.slots = std::move(slots);
+            set.count = static_cast<uint32_t>(set.slots.size());
+        } else {
+            set.ToBitset();
+            if (other_set.IsBitset()) {
+                if (set.words.size() < other_set.words.size()) {
+                    set.words.resize(other_set.words.size(), 0);
+                }
+                for (size_t i = 0; i < other_set.words.size(); i++) {
+                    set.words[i] |= other_set.words[i];
+                }
+            } else {
+                for (uint16_t slot : other_set.slots) {
+                    size_t word = slot / BITS_PER_WORD;
+                    if (word >= set.words.size()) {
+                        set.words.resize(word + 1, 0);
+                    }
+                    set.words[word] |= uint64_t{1} << (slot % BITS_PER_WORD);
+                }
+            }
+            set.count = 0;
+            for (uint64_t word : set.words) {
+                set.count += CountBits(word);
+            }
+        }
+        set.Optimize();
+    }
+}
+
+size_t RidBitmap::GetCardinality() const {
+    size_t cardinality = 0;
+    for (const auto& page : pages_) {
+        cardinality += page.second.count;
+    }
+    return cardinality;
+}
+
+RidBitmap::Iterator::Iterator(const RidBitmap* bitmap)
+    : bitmap_(bitmap), page_(bitmap->pages_.begin()) {}
+
+bool RidBitmap::Iterator::Next(RID* rid) {
+    if (bitmap_ == nullptr) {
+        return false;
+    }
+    while (page_ != bitmap_->pages_.end()) {
+        const SlotSet& set = page_->second;
+        if (set.IsBitset()) {
+            while (position_ < set.words.size() * BITS_PER_WORD) {
+                size_t word = position_ / BITS_PER_WORD;
+                uint64_t bits = set.words[word] >> (position_ % BITS_PER_WORD);
+                if (bits == 0) {
+                    position_ = (word + 1) * BITS_PER_WORD;
+                    continue;
+                }
+                position_ += __builtin_ctzll(bits);
+                *rid = RID{page_->first, static_cast<slot_offset_t>(position_)};
+                position_++;
+                return true;
+            }
+        } else if (position_ < set.slots.size()) {
+            *rid = RID{page_->first, set.slots[position_++]};
+            return true;
+        }
+        ++page_;
+        position_ = 0;
+    }
+    return false;
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,96 @@
+/*
+ * 文件: rid_bitmap.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 位图扫描用的RID集合：按页面分组的压缩位图，
+ *       支持交集、并集，按页面号的顺序遍历
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "common/types.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * RidBitmap - 一组RID
+ *
+ * 设计思路（和Roaring位图一样分两级）：
+ * - 第一级按页面号分组，有序map保证遍历时按页面号从小到大，
+ *   位图扫描回表时每个页面只访问一次，页面的访问顺序和文件里的顺序一致
+ * - 第二级是一个页面里的槽位集合，槽位少的时候是排好序的槽位号数组，
+ *   数组比覆盖到最大槽位的位图还大时换成位图，取交集后又变稀疏时换回数组
+ * - 槽位号不超过页面大小，数组元素用uint16_t
+ */
+class RidBitmap {
+   public:
+    /** 加入一个RID，已经在集合里时不变 */
+    void Add(const RID& rid);
+
+    /** 去掉一个RID */
+    void Remove(const RID& rid);
+
+    /** 是否包含rid */
+    bool Contains(const RID& rid) const;
+
+    /** 只保留同时在other里的RID */
+    void IntersectWith(const RidBitmap& other);
+
+    /** 加入other里的所有RID */
+    void UnionWith(const RidBitmap& other);
+
+    /** RID的个数 */
+    size_t GetCardinality() const;
+
+    /** 涉及的页面数 */
+    size_t GetPageCount() const { return pages_.size(); }
+
+    bool IsEmpty() const { return pages_.empty(); }
+
+   private:
+    /** 一个页面里的槽位集合，words为空时是数组形式 */
+    struct SlotSet {
+        std::vector<uint16_t> slots;  // 数组形式：排好序的槽位号
+        std::vector<uint64_t> words;  // 位图形式：第i位表示槽位i
+        uint32_t count = 0;
+
+        bool IsBitset() const { return !words.empty(); }
+        bool Contains(uint16_t slot) const;
+        /** 按数组和位图哪个更小选择存储形式 */
+        void Optimize();
+        void ToBitset();
+        void ToArray();
+    };
+
+   public:
+    /**
+     * Iterator - 按 (页面号, 槽位号) 从小到大遍历
+     * 遍历期间位图不能修改
+     */
+    class Iterator {
+       public:
+        Iterator() = default;
+        explicit Iterator(const RidBitmap* bitmap);
+
+        /**
+         * 取下一个RID
+         * @return 已经遍历完时返回false
+         */
+        bool Next(RID* rid);
+
+       private:
+        const RidBitmap* bitmap_ = nullptr;
+        std::map<page_id_t, SlotSet>::const_iterator page_;
+        size_t position_ = 0;  // 数组里的下标，或者位图里下一个要看的槽位
+    };
+
+   private:
+    std::map<page_id_t, SlotSet> pages_;
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,771 @@
+/*
+ * 文件: table_copy.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: COPY语句批量导入导出的实现
+ */
+
+#include "execution/table_copy.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/table_manager.h"
+#include "common/config.h"
+#include "common/debug.h"
+#include "common/exception.h"
+#include "record/column_store.h"
+#include "record/table_heap.h"
+#include "transaction/transaction.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+constexpr char BINARY_MAGIC[8] = {'S', 'R', 'D', 'B', 'C', 'O', 'P', 'Y'};
+constexpr uint32_t BINARY_VERSION = 1;
+
+[[noreturn]] void ThrowCopyError(const char* unit, size_t number,
+                                 const std::string& message) {
+    throw ExecutionException("COPY: " + std::string(unit) + " " +
+                             std::to_string(number) + ": " + message);
+}
+
+/** NULL列占位用的同类型零值，让Tuple按列类型检查通过 */
+Value ZeroValue(TypeId type) {
+    switch (type) {
+        case TypeId::BOOLEAN:
+            return Value(false);
+        case TypeId::TINYINT:
+            return Value(int8_t(0));
+        case TypeId::SMALLINT:
+            return Value(int16_t(0));
+        case TypeId::INTEGER:
+            return Value(int32_t(0));
+        case TypeId::BIGINT:
+            return Value(int64_t(0));
+        case TypeId::FLOAT:
+            return Value(0.0f);
+        case TypeId::DOUBLE:
+            return Value(0.0);
+        default:
+            return Value(std::string());
+    }
+}
+
+/** 整个字段都被解析才算成功，from_chars不接受前导的+号 */
+template <typename T>
+bool ParseNumber(std::string_view text, T* value) {
+    if (!text.empty() && text.front() == '+') {
+        text.remove_prefix(1);
+    }
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, *value);
+    return ec == std::errc() && ptr == end;
+}
+
+template <typename T>
+bool ParseInteger(std::string_view text, Value* value) {
+    int64_t parsed;
+    if (!ParseNumber(text, &parsed) ||
+        parsed < std::numeric_limits<T>::min() ||
+        parsed > std::numeric_limits<T>::max()) {
+        return false;
+    }
+    *value = Value(static_cast<T>(parsed));
+    return true;
+}
+
+bool EqualsIgnoreCase(std::string_view text, const char* word) {
+    size_t length = std::strlen(word);
+    if (text.size() != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (std::tolower(static_cast<unsigned char>(text[i])) != word[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+void AppendNumber(T value, std::string* out) {
+    char buffer[64];
+    auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out->append(buffer, ptr);
+}
+
+template <typename T>
+void AppendRaw(T value, std::string* out) {
+    out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+}  // namespace
+
+TableCopy::TableCopy(BufferPoolManager* buffer_pool_manager,
+                     TableInfo* table_info, TableManager* table_manager,
+                     Options options)
+    : buffer_pool_manager_(buffer_pool_manager),
+      table_info_(table_info),
+      table_manager_(table_manager),
+      schema_(table_info->schema.get()),
+      options_(options) {}
+
+// ==================== 导入 ====================
+
+/**
+ * 导入
+ *
+ * 实现思路：
+ * 1. 读一块数据接在上一块剩下的尾巴后面，找到最后一个完整记录的末尾，
+ *    前面的部分成为一块交给解析线程，尾巴留到下一轮；
+ *    一条记录比一块还长时继续读，直到读到它的末尾
+ * 2. 在解析的块达到COPY_PARSE_WORKERS时，主线程等最早的一块解析完
+ *    并写进表，所以读文件、解析和写表是同时进行的
+ * 3. 文件读完后写完剩下的块，最后维护索引
+ */
+size_t TableCopy::CopyFrom(const std::string& path, Transaction* txn) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw ExecutionException("COPY: cannot open file '" + path + "'");
+    }
+    if (options_.format == CopyFormat::BINARY) {
+        ReadBinaryHeader(in);
+    }
+
+    bool row_storage = table_info_->storage != TableStorage::COLUMN;
+    std::vector<RID> loaded;
+    size_t row_count = 0;
+    std::deque<std::future<std::vector<Tuple>>> pending;
+    auto load_oldest = [&]() {
+        std::vector<Tuple> tuples = pending.front().get();
+        pending.pop_front();
+        LoadTuples(tuples, txn, &loaded);
+        row_count += tuples.size();
+    };
+
+    try {
+        std::string buffer;
+        size_t next_unit = options_.format == CopyFormat::CSV ? 1 : 0;
+        bool first_chunk = true;
+        bool at_eof = false;
+        while (!at_eof) {
+            size_t carried = buffer.size();
+            buffer.resize(carried + COPY_CHUNK_SIZE);
+            in.read(buffer.data() + carried, COPY_CHUNK_SIZE);
+            size_t read_bytes = static_cast<size_t>(in.gcount());
+            buffer.resize(carried + read_bytes);
+            if (in.bad()) {
+                throw ExecutionException("COPY: failed to read file '" +
+                                         path + "'");
+            }
+            at_eof = read_bytes < COPY_CHUNK_SIZE;
+
+            size_t units = 0;
+            size_t end = FindChunkEnd(buffer, at_eof, &units);
+            if (end == 0) {
+                continue;
+            }
+            Chunk chunk;
+            chunk.first_line = next_unit;
+            chunk.first_record = next_unit;
+            chunk.skip_header = first_chunk && options_.header &&
+                                options_.format == CopyFormat::CSV;
+            chunk.data = std::move(buffer);
+            buffer = chunk.data.substr(end);
+            chunk.data.resize(end);
+            next_unit += units;
+            first_chunk = false;
+
+            pending.push_back(std::async(
+                std::launch::async,
+                [this, chunk = std::move(chunk)]() { return ParseChunk(chunk); }));
+            if (pending.size() >= COPY_PARSE_WORKERS) {
+                load_oldest();
+            }
+        }
+        while (!pending.empty()) {
+            load_oldest();
+        }
+    } catch (...) {
+        // 等正在解析的块结束，已经写进表的行照样维护索引
+        pending.clear();
+        if (row_storage && table_manager_ != nullptr) {
+            table_manager_->UpdateIndexesOnCopy(table_info_->table_name,
+                                                loaded);
+        }
+        throw;
+    }
+
+    if (row_storage && table_manager_ != nullptr &&
+        !table_manager_->UpdateIndexesOnCopy(table_info_->table_name,
+                                             loaded)) {
+        LOG_WARN("TableCopy::CopyFrom: Failed to update indexes of table "
+                 << table_info_->table_name);
+    }
+    return row_count;
+}
+
+/**
+ * 找到数据里最后一个完整记录的末尾
+ * CSV按行切分，引号里的换行不算；二进制按每条记录的长度前缀前进
+ * @param at_eof 后面没有数据了，CSV最后一条记录可以没有换行
+ * @param units 输出参数，切下的部分里的行数（CSV）或记录数（二进制）
+ * @return 切分点，0表示还没有完整的记录
+ */
+size_t TableCopy::FindChunkEnd(const std::string& data, bool at_eof,
+                               size_t* units) const {
+    *units = 0;
+    if (options_.format == CopyFormat::CSV) {
+        if (at_eof) {
+            *units = static_cast<size_t>(
+                std::count(data.begin(), data.end(), '\n'));
+            return data.size();
+        }
+        bool in_quotes = false;
+        size_t lines = 0;
+        size_t end = 0;
+        for (size_t i = 0; i < data.size(); i++) {
+            char ch = data[i];
+            if (ch == '"') {
+                in_quotes = !in_quotes;
+            } else if (ch == '\n') {
+                lines++;
+                if (!in_quotes) {
+                    end = i + 1;
+                    *units = lines;
+                }
+            }
+        }
+        return end;
+    }
+
+    size_t pos = 0;
+    while (pos + sizeof(uint32_t) <= data.size()) {
+        uint32_t length;
+        std::memcpy(&length, data.data() + pos, sizeof(length));
+        if (length < schema_->GetVarDataOffset() || length > PAGE_SIZE) {
+            throw ExecutionException("COPY: corrupt binary record length " +
+                                     std::to_string(length));
+        }
+        if (pos + sizeof(uint32_t) + length > data.size()) {
+            break;
+        }
+        pos += sizeof(uint32_t) + length;
+        (*units)++;
+    }
+    if (at_eof && pos != data.size()) {
+        throw ExecutionException("COPY: truncated binary record at end of file");
+    }
+    return pos;
+}
+
+/**
+ * 读取并检查二进制文件头
+ * 列数和每列的类型都要和表一致
+ */
+void TableCopy::ReadBinaryHeader(std::istream& in) const {
+    char magic[sizeof(BINARY_MAGIC)];
+    uint32_t version = 0;
+    uint32_t column_count = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&column_count), sizeof(column_count));
+    if (!in || std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) {
+        throw ExecutionException("COPY: not a binary COPY file");
+    }
+    if (version != BINARY_VERSION) {
+        throw ExecutionException("COPY: unsupported binary COPY version " +
+                                 std::to_string(version));
+    }
+    if (column_count != schema_->GetColumnCount()) {
+        throw ExecutionException(
+            "COPY: file has " + std::to_string(column_count) +
+            " columns, table " + table_info_->table_name + " has " +
+            std::to_string(schema_->GetColumnCount()));
+    }
+    for (size_t i = 0; i < column_count; i++) {
+        uint8_t type = 0;
+        in.read(reinterpret_cast<char*>(&type), sizeof(type));
+        if (!in || static_cast<TypeId>(type) != schema_->GetColumn(i).type) {
+            throw ExecutionException("COPY: type of column " +
+                                     schema_->GetColumn(i).name +
+                                     " does not match the file");
+        }
+    }
+}
+
+std::vector<Tuple> TableCopy::ParseChunk(const Chunk& chunk) const {
+    if (options_.format == CopyFormat::CSV) {
+        return ParseCsvChunk(chunk);
+    }
+    return ParseBinaryChunk(chunk);
+}
+
+/**
+ * 解析一块CSV
+ *
+ * 规则和RFC 4180一致：字段可以用双引号括起来，引号里的两个双引号表示
+ * 一个双引号，分隔符和换行在引号里是普通字符；行尾的\r忽略。
+ * 没有引号的空字段是NULL，""是空字符串；空行跳过
+ */
+std::vector<Tuple> TableCopy::ParseCsvChunk(const Chunk& chunk) const {
+    const std::string& data = chunk.data;
+    const size_t size = data.size();
+    const size_t column_count = schema_->GetColumnCount();
+    const char delimiter = options_.delimiter;
+    std::string_view view(data);
+
+    std::vector<Tuple> tuples;
+    std::vector<Value> values;
+    std::vector<size_t> null_columns;
+    std::string unquoted;
+    size_t pos = 0;
+    size_t line = chunk.first_line;
+    bool skip_record = chunk.skip_header;
+
+    while (pos < size) {
+        if (data[pos] == '\n' ||
+            (data[pos] == '\r' && pos + 1 < size && data[pos + 1] == '\n')) {
+            pos += data[pos] == '\r' ? 2 : 1;
+            line++;
+            continue;
+        }
+
+        size_t record_line = line;
+        size_t column = 0;
+        values.clear();
+        values.reserve(column_count);
+        null_columns.clear();
+        while (true) {
+            std::string_view text;
+            bool quoted = pos < size && data[pos] == '"';
+            if (quoted) {
+                unquoted.clear();
+                pos++;
+                while (true) {
+                    size_t quote = data.find('"', pos);
+                    if (quote == std::string::npos) {
+                        ThrowCopyError("line", record_line,
+                                       "unterminated quoted field");
+                    }
+                    line += static_cast<size_t>(std::count(
+                        data.begin() + pos, data.begin() + quote, '\n'));
+                    unquoted.append(data, pos, quote - pos);
+                    pos = quote + 1;
+                    if (pos < size && data[pos] == '"') {
+                        unquoted.push_back('"');
+                        pos++;
+                        continue;
+                    }
+                    break;
+                }
+                text = unquoted;
+            } else {
+                size_t start = pos;
+                while (pos < size && data[pos] != delimiter &&
+                       data[pos] != '\n') {
+                    pos++;
+                }
+                size_t stop = pos;
+                if (stop > start && data[stop - 1] == '\r' &&
+                    (pos == size || data[pos] == '\n')) {
+                    stop--;
+                }
+                text = view.substr(start, stop - start);
+            }
+
+            if (!skip_record) {
+                if (column >= column_count) {
+                    ThrowCopyError("line", record_line,
+                                   "more than " +
+                                       std::to_string(column_count) +
+                                       " columns");
+                }
+                bool is_null = false;
+                values.push_back(
+                    ParseCsvField(text, quoted, column, record_line, &is_null));
+                if (is_null) {
+                    null_columns.push_back(column);
+                }
+            }
+            column++;
+
+            if (pos < size && data[pos] == delimiter) {
+                pos++;
+                continue;
+            }
+            if (quoted && pos < size && data[pos] == '\r') {
+                pos++;
+            }
+            if (pos < size && data[pos] != '\n') {
+                ThrowCopyError("line", record_line,
+                               "unexpected character after quoted field");
+            }
+            pos++;
+            line++;
+            break;
+        }
+
+        if (skip_record) {
+            skip_record = false;
+            continue;
+        }
+        if (column != column_count) {
+            ThrowCopyError("line", record_line,
+                           "expected " + std::to_string(column_count) +
+                               " columns, found " + std::to_string(column));
+        }
+        try {
+            tuples.emplace_back(std::move(values), schema_);
+        } catch (const std::exception& e) {
+            ThrowCopyError("line", record_line, e.what());
+        }
+        values = std::vector<Value>();
+        for (size_t null_column : null_columns) {
+            tuples.back().SetNull(null_column, true);
+        }
+    }
+    return tuples;
+}
+
+/**
+ * 把一个CSV字段转换成列的类型
+ * 布尔值接受true/false、t/f、yes/no、1/0，不区分大小写；
+ * VARCHAR不能超过声明的长度，也不能超过MAX_TUPLE_SIZE（否则读不回来）
+ */
+Value TableCopy::ParseCsvField(std::string_view text, bool quoted,
+                               size_t column, size_t line,
+                               bool* is_null) const {
+    const Column& definition = schema_->GetColumn(column);
+    if (!quoted && text.empty()) {
+        if (!definition.nullable) {
+            ThrowCopyError("line", line,
+                           "missing value for NOT NULL column " +
+                               definition.name);
+        }
+        *is_null = true;
+        return ZeroValue(definition.type);
+    }
+
+    Value value;
+    bool valid = false;
+    switch (definition.type) {
+        case TypeId::BOOLEAN:
+            if (EqualsIgnoreCase(text, "true") || EqualsIgnoreCase(text, "t") ||
+                EqualsIgnoreCase(text, "yes") || text == "1") {
+                value = Value(true);
+                valid = true;
+            } else if (EqualsIgnoreCase(text, "false") ||
+                       EqualsIgnoreCase(text, "f") ||
+                       EqualsIgnoreCase(text, "no") || text == "0") {
+                value = Value(false);
+                valid = true;
+            }
+            break;
+        case TypeId::TINYINT:
+            valid = ParseInteger<int8_t>(text, &value);
+            break;
+        case TypeId::SMALLINT:
+            valid = ParseInteger<int16_t>(text, &value);
+            break;
+        case TypeId::INTEGER:
+            valid = ParseInteger<int32_t>(text, &value);
+            break;
+        case TypeId::BIGINT:
+            valid = ParseInteger<int64_t>(text, &value);
+            break;
+        case TypeId::FLOAT: {
+            float parsed;
+            valid = ParseNumber(text, &parsed);
+            value = Value(parsed);
+            break;
+        }
+        case TypeId::DOUBLE: {
+            double parsed;
+            valid = ParseNumber(text, &parsed);
+            value = Value(parsed);
+            break;
+        }
+        case TypeId::VARCHAR: {
+            size_t limit = definition.size > 0
+                               ? std::min(definition.size, MAX_TUPLE_SIZE)
+                               : MAX_TUPLE_SIZE;
+            if (text.size() > limit) {
+                ThrowCopyError("line", line,
+                               "value too long for column " +
+                                   definition.name);
+            }
+            return Value(std::string(text));
+        }
+        default:
+            ThrowCopyError("line", line,
+                           "unsupported type of column " + definition.name);
+    }
+    if (!valid) {
+        ThrowCopyError("line", line,
+                       "invalid value '" + std::string(text) +
+                           "' for column " + definition.name);
+    }
+    return value;
+}
+
+/**
+ * 解析一块二进制记录
+ * 反序列化之前检查每个VARCHAR条目都落在这条记录里面，
+ * 损坏的文件不会读到记录之外
+ */
+std::vector<Tuple> TableCopy::ParseBinaryChunk(const Chunk& chunk) const {
+    const std::string& data = chunk.data;
+    const size_t column_count = schema_->GetColumnCount();
+    std::vector<Tuple> tuples;
+    size_t record = chunk.first_record;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        uint32_t length;
+        std::memcpy(&length, data.data() + pos, sizeof(length));
+        const char* row = data.data() + pos + sizeof(length);
+        pos += sizeof(length) + length;
+        record++;
+
+        if (static_cast<uint8_t>(row[0]) != ROW_FORMAT_VERSION) {
+            ThrowCopyError("record", record, "unknown row format version");
+        }
+        for (size_t i = 0; i < column_count; i++) {
+            if (schema_->GetColumn(i).type != TypeId::VARCHAR) {
+                continue;
+            }
+            uint16_t entry[2];
+            std::memcpy(entry, row + schema_->GetColumnOffset(i),
+                        sizeof(entry));
+            if (entry[0] < schema_->GetVarDataOffset() ||
+                size_t{entry[0]} + entry[1] > length) {
+                ThrowCopyError("record", record, "corrupt VARCHAR entry");
+            }
+        }
+        tuples.emplace_back();
+        tuples.back().DeserializeFrom(row, schema_);
+        if (tuples.back().GetValues().size() != column_count ||
+            tuples.back().GetSerializedSize() != length) {
+            ThrowCopyError("record", record, "corrupt record");
+        }
+    }
+    return tuples;
+}
+
+/**
+ * 把解析好的一块写进表
+ * 行存表直接追加到末尾，列存表整块追加
+ */
+void TableCopy::LoadTuples(const std::vector<Tuple>& tuples, Transaction* txn,
+                           std::vector<RID>* loaded) const {
+    if (tuples.empty()) {
+        return;
+    }
+    if (table_info_->storage == TableStorage::COLUMN) {
+        if (!table_info_->column_store) {
+            throw ExecutionException("Column data of table " +
+                                     table_info_->table_name +
+                                     " is unavailable");
+        }
+        try {
+            table_info_->column_store->Append(tuples);
+        } catch (const std::exception& e) {
+            throw ExecutionException("COPY: failed to append to table " +
+                                     table_info_->table_name + ": " +
+                                     e.what());
+        }
+        return;
+    }
+
+    std::vector<RID> rids;
+    txn_id_t txn_id = txn != nullptr ? txn->GetTxnId() : INVALID_TXN_ID;
+    bool success =
+        table_info_->table_heap->AppendTuples(tuples, &rids, txn_id, txn);
+    loaded->insert(loaded->end(), rids.begin(), rids.end());
+    if (!success) {
+        throw ExecutionException(
+            "COPY: failed to store row " + std::to_string(loaded->size() + 1) +
+            " in table " + table_info_->table_name +
+            " (row too large for a page?)");
+    }
+}
+
+// ==================== 导出 ====================
+
+/**
+ * 导出
+ * 行存表用批量读取策略加预读顺序遍历，不会冲掉缓冲池里的热点页面；
+ * 列存表读一份快照，逐个行组解码后按行写出
+ */
+size_t TableCopy::CopyTo(const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw ExecutionException("COPY: cannot open file '" + path +
+                                 "' for writing");
+    }
+
+    std::string buffer;
+    buffer.reserve(COPY_WRITE_BUFFER_SIZE + PAGE_SIZE);
+    auto flush = [&]() {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (!out) {
+            throw ExecutionException("COPY: failed to write file '" + path +
+                                     "'");
+        }
+        buffer.clear();
+    };
+    size_t row_count = 0;
+    auto emit = [&](const Tuple& tuple) {
+        WriteRow(tuple, &buffer);
+        row_count++;
+        if (buffer.size() >= COPY_WRITE_BUFFER_SIZE) {
+            flush();
+        }
+    };
+
+    WriteHeader(&buffer);
+    if (table_info_->storage == TableStorage::COLUMN) {
+        if (!table_info_->column_store) {
+            throw ExecutionException("Column data of table " +
+                                     table_info_->table_name +
+                                     " is unavailable");
+        }
+        const ColumnStore* store = table_info_->column_store.get();
+        ColumnStore::ScanSnapshot snapshot = store->GetSnapshot();
+        size_t column_count = schema_->GetColumnCount();
+        std::vector<std::vector<Value>> columns(column_count);
+        std::vector<std::vector<bool>> nulls(column_count);
+        for (const auto& group : snapshot.row_groups) {
+            for (size_t c = 0; c < column_count; c++) {
+                store->ReadColumn(*group, c, &columns[c], &nulls[c]);
+            }
+            for (size_t r = 0; r < group->row_count; r++) {
+                std::vector<Value> values;
+                values.reserve(column_count);
+                for (size_t c = 0; c < column_count; c++) {
+                    values.push_back(columns[c][r]);
+                }
+                Tuple tuple(std::move(values), schema_);
+                for (size_t c = 0; c < column_count; c++) {
+                    if (nulls[c][r]) {
+                        tuple.SetNull(c, true);
+                    }
+                }
+                emit(tuple);
+            }
+        }
+        for (const Tuple& tuple : snapshot.tail_rows) {
+            emit(tuple);
+        }
+    } else {
+        TableHeap* heap = table_info_->table_heap.get();
+        for (auto it = heap->Begin(
+                 buffer_pool_manager_->CreateBulkReadStrategy(),
+                 READ_AHEAD_PAGES);
+             !it.IsEnd(); ++it) {
+            emit(*it);
+        }
+    }
+    flush();
+    out.close();
+    if (!out) {
+        throw ExecutionException("COPY: failed to write file '" + path + "'");
+    }
+    return row_count;
+}
+
+/**
+ * 写文件头：CSV在header选项打开时写列名，二进制总是写格式说明
+ */
+void TableCopy::WriteHeader(std::string* out) const {
+    size_t column_count = schema_->GetColumnCount();
+    if (options_.format == CopyFormat::BINARY) {
+        out->append(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        AppendRaw(BINARY_VERSION, out);
+        AppendRaw(static_cast<uint32_t>(column_count), out);
+        for (size_t i = 0; i < column_count; i++) {
+            AppendRaw(static_cast<uint8_t>(schema_->GetColumn(i).type), out);
+        }
+        return;
+    }
+    if (!options_.header) {
+        return;
+    }
+    for (size_t i = 0; i < column_count; i++) {
+        if (i > 0) {
+            out->push_back(options_.delimiter);
+        }
+        WriteCsvField(Value(schema_->GetColumn(i).name), out);
+    }
+    out->push_back('\n');
+}
+
+void TableCopy::WriteRow(const Tuple& tuple, std::string* out) const {
+    if (options_.format == CopyFormat::BINARY) {
+        uint32_t length = static_cast<uint32_t>(tuple.GetSerializedSize());
+        AppendRaw(length, out);
+        size_t offset = out->size();
+        out->resize(offset + length);
+        tuple.SerializeTo(out->data() + offset);
+        return;
+    }
+    const std::vector<Value>& values = tuple.GetValues();
+    for (size_t i = 0; i < values.size(); i++) {
+        if (i > 0) {
+            out->push_back(options_.delimiter);
+        }
+        if (!tuple.IsNull(i)) {
+            WriteCsvField(values[i], out);
+        }
+    }
+    out->push_back('\n');
+}
+
+/**
+ * 写一个CSV字段
+ * 空字符串和含有分隔符、引号、换行的字符串加引号，和NULL（空字段）区分开；
+ * 浮点数用最短的能精确读回的写法
+ */
+void TableCopy::WriteCsvField(const Value& value, std::string* out) const {
+    std::visit(
+        [this, out](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, bool>) {
+                out->append(v ? "true" : "false");
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                bool needs_quotes =
+                    v.empty() ||
+                    v.find_first_of(std::string{options_.delimiter, '"', '\n',
+                                                '\r'}) != std::string::npos;
+                if (!needs_quotes) {
+                    out->append(v);
+                    return;
+                }
+                out->push_back('"');
+                for (char ch : v) {
+                    if (ch == '"') {
+                        out->push_back('"');
+                    }
+                    out->push_back(ch);
+                }
+                out->push_back('"');
+            } else {
+                AppendNumber(v, out);
+            }
+        },
+        value);
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,112 @@
+/*
+ * 文件: table_copy.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: COPY语句的批量导入和导出：CSV和二进制两种文件格式，
+ *       导入时多线程解析、直接追加到表末尾，最后统一维护索引
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "parser/ast.h"
+#include "record/tuple.h"
+
+namespace SimpleRDBMS {
+
+class BufferPoolManager;
+class TableManager;
+class Transaction;
+
+/**
+ * TableCopy - 一张表和一个文件之间的批量导入导出
+ *
+ * 导入（COPY FROM）的流水线：
+ * - 主线程按COPY_CHUNK_SIZE读文件，在最后一个完整记录的末尾切开，
+ *   不完整的尾巴留给下一块；CSV切分时跟踪引号，引号里的换行不是记录边界
+ * - 每块交给一个解析线程转换成Tuple，同时最多COPY_PARSE_WORKERS块在解析
+ * - 主线程按文件顺序取回解析好的块，行存表用TableHeap::AppendTuples
+ *   直接写满末尾的页面（每个页面一条MULTI_INSERT日志），列存表整块追加
+ * - 全部装载完以后由TableManager::UpdateIndexesOnCopy一次维护索引，
+ *   空索引走批量构建
+ * - 中途出错时已经写进表的块保留并维护索引，然后抛出异常，
+ *   和多行INSERT中途失败的处理一致；出错的那一块整块不装载
+ *
+ * 导出（COPY TO）用批量读取策略和预读遍历表堆（列存表读快照），
+ * 结果攒到COPY_WRITE_BUFFER_SIZE字节再写一次文件
+ *
+ * 二进制格式（本机字节序）：
+ * - 文件头：8字节"SRDBCOPY"，uint32版本号，uint32列数，每列1字节的TypeId
+ * - 之后每条记录：uint32长度，加上按行格式（Tuple::SerializeTo）序列化的字节
+ * 导入时检查列数和列类型与表一致，行格式版本不同的文件不能导入
+ *
+ * 调用者负责加表锁：导入加X锁，导出加S锁
+ */
+class TableCopy {
+   public:
+    /** 文件格式选项，对应COPY语句的WITH选项 */
+    struct Options {
+        CopyFormat format = CopyFormat::CSV;
+        char delimiter = ',';
+        bool header = false;
+    };
+
+    TableCopy(BufferPoolManager* buffer_pool_manager, TableInfo* table_info,
+              TableManager* table_manager, Options options);
+
+    /**
+     * 把文件里的记录装入表
+     * @param txn 装载所在的事务，可以为空
+     * @return 装载的行数
+     * @throws ExecutionException 文件打不开、格式错误或者写表失败，
+     *         消息里带有出错的行号
+     */
+    size_t CopyFrom(const std::string& path, Transaction* txn);
+
+    /**
+     * 把整张表写到文件，文件已经存在时覆盖
+     * @return 写出的行数
+     * @throws ExecutionException 文件打不开或者写入失败
+     */
+    size_t CopyTo(const std::string& path);
+
+   private:
+    /** 交给解析线程的一块数据，总是从记录的开头开始、在记录的末尾结束 */
+    struct Chunk {
+        std::string data;
+        size_t first_line = 1;     // CSV：第一条记录所在的行号
+        size_t first_record = 0;   // 二进制：第一条记录的序号
+        bool skip_header = false;  // CSV：第一条记录是列名
+    };
+
+    // ---------- 导入 ----------
+    size_t FindChunkEnd(const std::string& data, bool at_eof,
+                        size_t* units) const;
+    void ReadBinaryHeader(std::istream& in) const;
+    std::vector<Tuple> ParseChunk(const Chunk& chunk) const;
+    std::vector<Tuple> ParseCsvChunk(const Chunk& chunk) const;
+    std::vector<Tuple> ParseBinaryChunk(const Chunk& chunk) const;
+    Value ParseCsvField(std::string_view text, bool quoted, size_t column,
+                        size_t line, bool* is_null) const;
+    void LoadTuples(const std::vector<Tuple>& tuples, Transaction* txn,
+                    std::vector<RID>* loaded) const;
+
+    // ---------- 导出 ----------
+    void WriteHeader(std::string* out) const;
+    void WriteRow(const Tuple& tuple, std::string* out) const;
+    void WriteCsvField(const Value& value, std::string* out) const;
+
+    BufferPoolManager* buffer_pool_manager_;
+    TableInfo* table_info_;
+    TableManager* table_manager_;
+    const Schema* schema_;
+    Options options_;
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,88 @@
+/*
+ * 文件: vector_batch.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 批量执行数据块的实现
+ */
+
+#include "execution/vector_batch.h"
+
+#include "common/exception.h"
+
+namespace SimpleRDBMS {
+
+void VectorBatch::Reset(size_t column_count) {
+    columns_.resize(column_count);
+    for (auto& column : columns_) {
+        column.clear();
+        column.reserve(VECTOR_BATCH_SIZE);
+    }
+    rids_.clear();
+    selection_.clear();
+}
+
+void VectorBatch::AppendRow(const Tuple& tuple) {
+    const auto& values = tuple.GetValues();
+    if (values.size() != columns_.size()) {
+        throw ExecutionException("VectorBatch: column count mismatch");
+    }
+    for (size_t i = 0; i < columns_.size(); i++) {
+        columns_[i].push_back(values[i]);
+    }
+    AppendRID(tuple.GetRID());
+}
+
+Value VectorBatch::PlaceholderValue(TypeId type) {
+    switch (type) {
+        case TypeId::BOOLEAN:
+            return false;
+        case TypeId::TINYINT:
+            return static_cast<int8_t>(0);
+        case TypeId::SMALLINT:
+            return static_cast<int16_t>(0);
+        case TypeId::INTEGER:
+            return static_cast<int32_t>(0);
+        case TypeId::BIGINT:
+            return static_cast<int64_t>(0);
+        case TypeId::FLOAT:
+            return 0.0f;
+        case TypeId::DOUBLE:
+            return 0.0;
+        default:
+            return std::string();
+    }
+}
+
+void VectorBatch::AppendRow(const TupleView& view,
+                            const std::vector<bool>& decoded_columns) {
+    if (view.GetColumnCount() != columns_.size()) {
+        throw ExecutionException("VectorBatch: column count mismatch");
+    }
+    const Schema* schema = view.GetSchema();
+    for (size_t i = 0; i < columns_.size(); i++) {
+        if (decoded_columns.empty() || decoded_columns[i]) {
+            columns_[i].push_back(view.GetValue(i));
+        } else {
+            columns_[i].push_back(PlaceholderValue(schema->GetColumn(i).type));
+        }
+    }
+    AppendRID(view.GetRID());
+}
+
+void VectorBatch::AppendRID(const RID& rid) {
+    selection_.push_back(static_cast<uint32_t>(rids_.size()));
+    rids_.push_back(rid);
+}
+
+Tuple VectorBatch::GetTuple(uint32_t row, const Schema* schema) const {
+    std::vector<Value> values;
+    values.reserve(columns_.size());
+    for (const auto& column : columns_) {
+        values.push_back(column[row]);
+    }
+    Tuple tuple(std::move(values), schema);
+    tuple.SetRID(rids_[row]);
+    return tuple;
+}
+
+}  // namespace SimpleRDBMS
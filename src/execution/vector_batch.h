@@ -0,0 +1,100 @@
+/*
+ * 文件: vector_batch.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 批量执行的数据块，按列存放一批记录，用选择向量标记有效的行
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/types.h"
+#include "record/tuple.h"
+#include "record/tuple_view.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * VectorBatch - 执行器之间一次传递的一批记录
+ *
+ * 设计思路：
+ * - 每一列是一个std::vector<Value>，表达式按列求值时
+ *   一次遍历表达式树处理整批数据，不用每行做一次虚函数调用和树遍历
+ * - 选择向量按递增顺序记录仍然有效的行号，过滤只改写选择向量，
+ *   列数据原地不动；刚装入的批次所有行都有效
+ * - 行数最多VECTOR_BATCH_SIZE，Reset后保留已分配的内存，批次对象可以反复使用
+ */
+class VectorBatch {
+   public:
+    /**
+     * 清空批次，准备装入新的一批记录
+     * @param column_count 每行的列数
+     */
+    void Reset(size_t column_count);
+
+    /** 追加一行，列数必须和Reset时一致，新行进入选择向量 */
+    void AppendRow(const Tuple& tuple);
+
+    /**
+     * 从页面上的tuple视图追加一行，只解码需要的列
+     * @param view tuple视图，列数必须和Reset时一致
+     * @param decoded_columns 第i项为true时解码第i列，为空时解码所有列；
+     *                        不解码的列填入该类型的默认值，不应再被读取
+     */
+    void AppendRow(const TupleView& view,
+                   const std::vector<bool>& decoded_columns);
+
+    /**
+     * 追加一行的RID并选中这一行，列值由调用者直接写入各列
+     * 投影这类按列生成输出的算子使用
+     */
+    void AppendRID(const RID& rid);
+
+    /** 批次已经装满 */
+    bool IsFull() const { return rids_.size() >= VECTOR_BATCH_SIZE; }
+
+    /** 装入的行数，包括已经被过滤掉的行 */
+    size_t GetRowCount() const { return rids_.size(); }
+
+    size_t GetColumnCount() const { return columns_.size(); }
+
+    /** 第column_index列所有行的值，下标是行号 */
+    const std::vector<Value>& GetColumn(size_t column_index) const {
+        return columns_[column_index];
+    }
+
+    std::vector<Value>* GetMutableColumn(size_t column_index) {
+        return &columns_[column_index];
+    }
+
+    /** 选择向量：有效行的行号，递增 */
+    const std::vector<uint32_t>& GetSelection() const { return selection_; }
+
+    std::vector<uint32_t>* GetMutableSelection() { return &selection_; }
+
+    /** 有效行数 */
+    size_t GetSelectedCount() const { return selection_.size(); }
+
+    const RID& GetRID(uint32_t row) const { return rids_[row]; }
+
+    /**
+     * 把一行还原成tuple，供逐行接口和结果集使用
+     * @param row 行号
+     * @param schema 输出schema，值按它的列类型转换
+     */
+    Tuple GetTuple(uint32_t row, const Schema* schema) const;
+
+    /** 不解码的列的占位值，类型和列一致，还原成tuple时不会转换失败 */
+    static Value PlaceholderValue(TypeId type);
+
+   private:
+    std::vector<std::vector<Value>> columns_;  // 列数据
+    std::vector<RID> rids_;                    // 每行的RID
+    std::vector<uint32_t> selection_;          // 有效行的行号
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,362 @@
+/*
+ * 文件: vector_kernels.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 批量运算内核的标量实现和AVX2实现
+ */
+
+#include "execution/vector_kernels.h"
+
+#include <atomic>
+
+#include "common/exception.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMPLERDBMS_AVX2_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace SimpleRDBMS {
+
+using OpType = BinaryOpExpression::OpType;
+
+static bool CpuSupportsAvx2() {
+#ifdef SIMPLERDBMS_AVX2_KERNELS
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+/** 是否使用AVX2实现，默认取决于CPU是否支持 */
+static std::atomic<bool>& SimdFlag() {
+    static std::atomic<bool> flag(CpuSupportsAvx2());
+    return flag;
+}
+
+bool VectorKernels::IsSimdEnabled() {
+    return SimdFlag().load(std::memory_order_relaxed);
+}
+
+void VectorKernels::SetSimdEnabled(bool enabled) {
+    SimdFlag().store(enabled && CpuSupportsAvx2(), std::memory_order_relaxed);
+}
+
+// ==================== 标量实现 ====================
+
+template <typename T>
+static void CompareScalar(const T* values, size_t count, T constant,
+                          OpType op, uint8_t* matches) {
+    switch (op) {
+        case OpType::EQUALS:
+            for (size_t i = 0; i < count; i++) {
+                matches[i] = values[i] == constant;
+            }
+            break;
+        case OpType::NOT_EQUALS:
+            for (size_t i = 0; i < count; i++) {
+                matches[i] = values[i] != constant;
+            }
+            break;
+        case OpType::LESS_THAN:
+            for (size_t i = 0; i < count; i++) {
+                matches[i] = values[i] < constant;
+            }
+            break;
+        case OpType::LESS_EQUALS:
+            for (size_t i = 0; i < count; i++) {
+                matches[i] = values[i] <= constant;
+            }
+            break;
+        case OpType::GREATER_THAN:
+            for (size_t i = 0; i < count; i++) {
+                matches[i] = values[i] > constant;
+            }
+            break;
+        case OpType::GREATER_EQUALS:
+            for (size_t i = 0; i < count; i++) {
+                matches[i] = values[i] >= constant;
+            }
+            break;
+        default:
+            throw ExecutionException("Unsupported comparison operator");
+    }
+}
+
+static void ArithmeticScalar(const double* left, const double* right,
+                             size_t count, OpType op, double* results) {
+    switch (op) {
+        case OpType::PLUS:
+            for (size_t i = 0; i < count; i++) {
+                results[i] = left[i] + right[i];
+            }
+            break;
+        case OpType::MINUS:
+            for (size_t i = 0; i < count; i++) {
+                results[i] = left[i] - right[i];
+            }
+            break;
+        case OpType::MULTIPLY:
+            for (size_t i = 0; i < count; i++) {
+                results[i] = left[i] * right[i];
+            }
+            break;
+        case OpType::DIVIDE:
+            for (size_t i = 0; i < count; i++) {
+                results[i] = left[i] / right[i];
+            }
+            break;
+        default:
+            throw ExecutionException("Unsupported arithmetic operator");
+    }
+}
+
+// ==================== AVX2实现 ====================
+// 每个函数处理能整块装进寄存器的部分，返回处理了多少个元素，
+// 剩下不足一个寄存器的尾巴交给标量实现
+
+#ifdef SIMPLERDBMS_AVX2_KERNELS
+
+/** 把比较结果的位掩码展开成字节掩码 */
+static inline void StoreMask(int mask, int lanes, uint8_t* matches) {
+    for (int j = 0; j < lanes; j++) {
+        matches[j] = static_cast<uint8_t>((mask >> j) & 1);
+    }
+}
+
+/**
+ * 整数比较只有相等和大于两种指令：
+ * < 交换操作数用大于，!=、<=、>= 是 =、>、< 取反
+ */
+enum class IntCompareKind { EQUAL, GREATER, LESS };
+
+static void NormalizeIntCompare(OpType op, IntCompareKind* kind,
+                                bool* invert) {
+    *invert = op == OpType::NOT_EQUALS || op == OpType::LESS_EQUALS ||
+              op == OpType::GREATER_EQUALS;
+    switch (op) {
+        case OpType::EQUALS:
+        case OpType::NOT_EQUALS:
+            *kind = IntCompareKind::EQUAL;
+            break;
+        case OpType::GREATER_THAN:
+        case OpType::LESS_EQUALS:
+            *kind = IntCompareKind::GREATER;
+            break;
+        case OpType::LESS_THAN:
+        case OpType::GREATER_EQUALS:
+            *kind = IntCompareKind::LESS;
+            break;
+        default:
+            throw ExecutionException("Unsupported comparison operator");
+    }
+}
+
+__attribute__((target("avx2"))) static size_t CompareInt32Avx2(
+    const int32_t* values, size_t count, int32_t constant, OpType op,
+    uint8_t* matches) {
+    IntCompareKind kind;
+    bool invert;
+    NormalizeIntCompare(op, &kind, &invert);
+    const __m256i c = _mm256_set1_epi32(constant);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i m;
+        if (kind == IntCompareKind::EQUAL) {
+            m = _mm256_cmpeq_epi32(v, c);
+        } else if (kind == IntCompareKind::GREATER) {
+            m = _mm256_cmpgt_epi32(v, c);
+        } else {
+            m = _mm256_cmpgt_epi32(c, v);
+        }
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+        StoreMask(invert ? ~mask : mask, 8, matches + i);
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) static size_t CompareInt64Avx2(
+    const int64_t* values, size_t count, int64_t constant, OpType op,
+    uint8_t* matches) {
+    IntCompareKind kind;
+    bool invert;
+    NormalizeIntCompare(op, &kind, &invert);
+    const __m256i c = _mm256_set1_epi64x(constant);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i m;
+        if (kind == IntCompareKind::EQUAL) {
+            m = _mm256_cmpeq_epi64(v, c);
+        } else if (kind == IntCompareKind::GREATER) {
+            m = _mm256_cmpgt_epi64(v, c);
+        } else {
+            m = _mm256_cmpgt_epi64(c, v);
+        }
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(m));
+        StoreMask(invert ? ~mask : mask, 4, matches + i);
+    }
+    return i;
+}
+
+/** 浮点比较的谓词是立即数，每种比较单独实例化一份循环 */
+template <int kPredicate>
+__attribute__((target("avx2"))) static size_t CompareDoubleAvx2Loop(
+    const double* values, size_t count, double constant, uint8_t* matches) {
+    const __m256d c = _mm256_set1_pd(constant);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_loadu_pd(values + i);
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(v, c, kPredicate));
+        StoreMask(mask, 4, matches + i);
+    }
+    return i;
+}
+
+static size_t CompareDoubleAvx2(const double* values, size_t count,
+                                double constant, OpType op, uint8_t* matches) {
+    // 有序比较（_OQ）遇到NaN不成立，!= 用无序比较（_UQ）遇到NaN成立，
+    // 和C++运算符的结果一致
+    switch (op) {
+        case OpType::EQUALS:
+            return CompareDoubleAvx2Loop<_CMP_EQ_OQ>(values, count, constant,
+                                                     matches);
+        case OpType::NOT_EQUALS:
+            return CompareDoubleAvx2Loop<_CMP_NEQ_UQ>(values, count, constant,
+                                                      matches);
+        case OpType::LESS_THAN:
+            return CompareDoubleAvx2Loop<_CMP_LT_OQ>(values, count, constant,
+                                                     matches);
+        case OpType::LESS_EQUALS:
+            return CompareDoubleAvx2Loop<_CMP_LE_OQ>(values, count, constant,
+                                                     matches);
+        case OpType::GREATER_THAN:
+            return CompareDoubleAvx2Loop<_CMP_GT_OQ>(values, count, constant,
+                                                     matches);
+        case OpType::GREATER_EQUALS:
+            return CompareDoubleAvx2Loop<_CMP_GE_OQ>(values, count, constant,
+                                                     matches);
+        default:
+            throw ExecutionException("Unsupported comparison operator");
+    }
+}
+
+__attribute__((target("avx2"))) static size_t CombineMasksAvx2(
+    uint8_t* matches, const uint8_t* other, size_t count, bool is_and) {
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i a =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(matches + i));
+        __m256i b =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(other + i));
+        __m256i r = is_and ? _mm256_and_si256(a, b) : _mm256_or_si256(a, b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(matches + i), r);
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) static size_t ArithmeticAvx2(
+    const double* left, const double* right, size_t count, OpType op,
+    double* results) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d a = _mm256_loadu_pd(left + i);
+        __m256d b = _mm256_loadu_pd(right + i);
+        __m256d r;
+        if (op == OpType::PLUS) {
+            r = _mm256_add_pd(a, b);
+        } else if (op == OpType::MINUS) {
+            r = _mm256_sub_pd(a, b);
+        } else if (op == OpType::MULTIPLY) {
+            r = _mm256_mul_pd(a, b);
+        } else {
+            r = _mm256_div_pd(a, b);
+        }
+        _mm256_storeu_pd(results + i, r);
+    }
+    return i;
+}
+
+#endif  // SIMPLERDBMS_AVX2_KERNELS
+
+// ==================== 对外接口 ====================
+
+void VectorKernels::Compare(const int32_t* values, size_t count,
+                            int32_t constant, OpType op, uint8_t* matches) {
+    size_t done = 0;
+#ifdef SIMPLERDBMS_AVX2_KERNELS
+    if (IsSimdEnabled()) {
+        done = CompareInt32Avx2(values, count, constant, op, matches);
+    }
+#endif
+    CompareScalar(values + done, count - done, constant, op, matches + done);
+}
+
+void VectorKernels::Compare(const int64_t* values, size_t count,
+                            int64_t constant, OpType op, uint8_t* matches) {
+    size_t done = 0;
+#ifdef SIMPLERDBMS_AVX2_KERNELS
+    if (IsSimdEnabled()) {
+        done = CompareInt64Avx2(values, count, constant, op, matches);
+    }
+#endif
+    CompareScalar(values + done, count - done, constant, op, matches + done);
+}
+
+void VectorKernels::Compare(const double* values, size_t count,
+                            double constant, OpType op, uint8_t* matches) {
+    size_t done = 0;
+#ifdef SIMPLERDBMS_AVX2_KERNELS
+    if (IsSimdEnabled()) {
+        done = CompareDoubleAvx2(values, count, constant, op, matches);
+    }
+#endif
+    CompareScalar(values + done, count - done, constant, op, matches + done);
+}
+
+void VectorKernels::And(uint8_t* matches, const uint8_t* other,
+                        size_t count) {
+    size_t i = 0;
+#ifdef SIMPLERDBMS_AVX2_KERNELS
+    if (IsSimdEnabled()) {
+        i = CombineMasksAvx2(matches, other, count, true);
+    }
+#endif
+    for (; i < count; i++) {
+        matches[i] = matches[i] & other[i];
+    }
+}
+
+void VectorKernels::Or(uint8_t* matches, const uint8_t* other, size_t count) {
+    size_t i = 0;
+#ifdef SIMPLERDBMS_AVX2_KERNELS
+    if (IsSimdEnabled()) {
+        i = CombineMasksAvx2(matches, other, count, false);
+    }
+#endif
+    for (; i < count; i++) {
+        matches[i] = matches[i] | other[i];
+    }
+}
+
+void VectorKernels::Arithmetic(const double* left, const double* right,
+                               size_t count, OpType op, double* results) {
+    if (op != OpType::PLUS && op != OpType::MINUS &&
+        op != OpType::MULTIPLY && op != OpType::DIVIDE) {
+        throw ExecutionException("Unsupported arithmetic operator");
+    }
+    size_t done = 0;
+#ifdef SIMPLERDBMS_AVX2_KERNELS
+    if (IsSimdEnabled()) {
+        done = ArithmeticAvx2(left, right, count, op, results);
+    }
+#endif
+    ArithmeticScalar(left + done, right + done, count - done, op,
+                     results + done);
+}
+
+}  // namespace SimpleRDBMS
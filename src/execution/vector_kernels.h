@@ -0,0 +1,68 @@
+/*
+ * 文件: vector_kernels.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 批量过滤用的比较、逻辑和算术内核，x86-64上有AVX2实现，
+ *       其他平台和不支持AVX2的CPU使用标量实现
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "parser/ast.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * VectorKernels - 定长原生数组上的批量运算
+ *
+ * 设计思路：
+ * - 输入是连续的int32_t/int64_t/double数组，ExpressionEvaluator
+ *   先从VectorBatch的列里把选中行的值取出来再交给内核，
+ *   内核里只有原生类型的循环，没有variant访问和表达式树遍历
+ * - 比较结果写成字节掩码，1表示成立；AND/OR直接合并掩码
+ * - AVX2版本用编译器的target属性单独编译，启动时检测CPU特性选择实现，
+ *   不需要改编译选项，在不支持AVX2的机器上运行也是安全的
+ * - 比较语义和C++运算符一致，NaN和任何值比较都不成立，!= 成立
+ */
+class VectorKernels {
+   public:
+    /**
+     * values[i] op constant，结果写入matches[i]
+     * @param op 比较操作符：=、!=、<、<=、>、>=
+     */
+    static void Compare(const int32_t* values, size_t count, int32_t constant,
+                        BinaryOpExpression::OpType op, uint8_t* matches);
+    static void Compare(const int64_t* values, size_t count, int64_t constant,
+                        BinaryOpExpression::OpType op, uint8_t* matches);
+    static void Compare(const double* values, size_t count, double constant,
+                        BinaryOpExpression::OpType op, uint8_t* matches);
+
+    /** matches[i] = matches[i] && other[i] */
+    static void And(uint8_t* matches, const uint8_t* other, size_t count);
+
+    /** matches[i] = matches[i] || other[i] */
+    static void Or(uint8_t* matches, const uint8_t* other, size_t count);
+
+    /**
+     * results[i] = left[i] op right[i]
+     * @param op 算术操作符：+、-、*、/，除数为0时结果按IEEE 754规则得到inf或NaN，
+     *           调用者需要预先检查
+     */
+    static void Arithmetic(const double* left, const double* right,
+                           size_t count, BinaryOpExpression::OpType op,
+                           double* results);
+
+    /** 当前是否使用AVX2实现 */
+    static bool IsSimdEnabled();
+
+    /**
+     * 打开或关闭AVX2实现，CPU不支持AVX2时打开也不会生效
+     * 主要用于测试对比两种实现
+     */
+    static void SetSimdEnabled(bool enabled);
+};
+
+}  // namespace SimpleRDBMS
@@ -8,11 +8,15 @@
 
 #include "index/b_plus_tree.h"
 
-#include <unordered_set>
+#include <algorithm>
 
 #include "common/debug.h"
 #include "common/types.h"
 #include "index/b_plus_tree_page.h"
+#include "index/generic_key.h"
+#include "index/inline_string_key.h"
+#include "index/non_unique_key.h"
+#include "stat/trace.h"
 
 namespace SimpleRDBMS {
 
@@ -56,6 +60,70 @@ BPlusTree<KeyType, ValueType>::BPlusTree(const std::string& name,
     }
 }
 
+/**
+ * 用已知的根页面打开B+树
+ * @param name 索引名称
+ * @param buffer_pool_manager 缓冲池管理器
+ * @param root_page_id 根页面ID，通常来自catalog
+ *
+ * 实现思路：
+ * 1. 根页面ID由调用方保证有效，不再去header page按名字查找，
+ *    也就不会受到header page槽位冲突的影响
+ * 2. 只检查根页面能否读取且页面ID一致，不一致时当作空树处理
+ */
+template <typename KeyType, typename ValueType>
+BPlusTree<KeyType, ValueType>::BPlusTree(const std::string& name,
+                                         BufferPoolManager* buffer_pool_manager,
+                                         page_id_t root_page_id)
+    : index_name_(name),
+      buffer_pool_manager_(buffer_pool_manager),
+      root_page_id_(INVALID_PAGE_ID) {
+    if (!buffer_pool_manager_) {
+        throw std::invalid_argument("BufferPoolManager cannot be null");
+    }
+
+    if (index_name_.empty()) {
+        throw std::invalid_argument("Index name cannot be empty");
+    }
+
+    if (root_page_id == INVALID_PAGE_ID) {
+        return;
+    }
+
+    Page* root_page = FetchTreePage(root_page_id);
+    if (root_page == nullptr) {
+        LOG_WARN("BPlusTree: root page " << root_page_id << " of index "
+                                         << index_name_
+                                         << " cannot be fetched");
+        return;
+    }
+    auto root = reinterpret_cast<BPlusTreePage*>(root_page->GetData());
+    bool valid = root->GetPageId() == root_page_id && root->IsRootPage();
+    buffer_pool_manager_->UnpinPage(root_page_id, false);
+    if (!valid) {
+        LOG_WARN("BPlusTree: page " << root_page_id
+                                    << " is not the root of index "
+                                    << index_name_);
+        return;
+    }
+    root_page_id_ = root_page_id;
+    LOG_DEBUG("BPlusTree " << index_name_ << " opened with root page "
+                           << root_page_id_);
+}
+
+template <typename KeyType, typename ValueType>
+void BPlusTree<KeyType, ValueType>::SetRootChangeCallback(
+    std::function<void(page_id_t)> callback) {
+    std::lock_guard<std::shared_mutex> lock(latch_);
+    root_change_callback_ = std::move(callback);
+}
+
+template <typename KeyType, typename ValueType>
+page_id_t BPlusTree<KeyType, ValueType>::GetRootPageId() {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    return root_page_id_;
+}
+
 /**
  * B+树析构函数
  *
@@ -68,7 +136,7 @@ BPlusTree<KeyType, ValueType>::BPlusTree(const std::string& name,
 template <typename KeyType, typename ValueType>
 BPlusTree<KeyType, ValueType>::~BPlusTree() {
     try {
-        std::lock_guard<std::mutex> lock(latch_);
+        std::lock_guard<std::shared_mutex> lock(latch_);
         // 不在析构中访问buffer_pool_manager_，避免悬挂指针
         // 只是简单清理根页面ID
         root_page_id_ = INVALID_PAGE_ID;
@@ -157,7 +225,7 @@ void BPlusTree<KeyType, ValueType>::LoadRootPageId() {
     }
 
     // 验证root page确实存在且是有效的B+树页面
-    Page* root_page = buffer_pool_manager_->FetchPage(stored_root_page_id);
+    Page* root_page = FetchTreePage(stored_root_page_id);
     if (root_page == nullptr) {
         LOG_WARN("Root page " << stored_root_page_id
                               << " does not exist, resetting to INVALID");
@@ -218,8 +286,16 @@ template <typename KeyType, typename ValueType>
 bool BPlusTree<KeyType, ValueType>::Insert(const KeyType& key,
                                            const ValueType& value,
                                            txn_id_t txn_id) {
-    std::lock_guard<std::mutex> lock(latch_);
     (void)txn_id;  // 当前未使用事务ID
+
+    // 先走乐观路径：大多数插入不会让叶子分裂，只锁叶子即可完成
+    bool optimistic_result = false;
+    if (OptimisticInsert(key, value, &optimistic_result)) {
+        return optimistic_result;
+    }
+
+    // 需要分裂或者树为空，独占整棵树
+    std::lock_guard<std::shared_mutex> lock(latch_);
     LOG_TRACE("Inserting key: " << key << " into index: " << index_name_);
 
     // 情况1：树为空，需要创建根页面
@@ -234,7 +310,7 @@ bool BPlusTree<KeyType, ValueType>::Insert(const KeyType& key,
             // 如果header page不存在，通过UpdateRootPageId来创建
             // 先创建根页面，然后调用UpdateRootPageId
             page_id_t new_page_id;
-            Page* root_page = buffer_pool_manager_->NewPage(&new_page_id);
+            Page* root_page = NewTreePage(&new_page_id);
             if (root_page == nullptr) {
                 LOG_ERROR("Failed to create root page");
                 return false;
@@ -275,7 +351,7 @@ bool BPlusTree<KeyType, ValueType>::Insert(const KeyType& key,
 
         // 创建根页面（叶子页面）
         page_id_t new_page_id;
-        Page* root_page = buffer_pool_manager_->NewPage(&new_page_id);
+        Page* root_page = NewTreePage(&new_page_id);
         if (root_page == nullptr) {
             LOG_ERROR("Failed to create root page");
             return false;
@@ -370,7 +446,14 @@ bool BPlusTree<KeyType, ValueType>::Insert(const KeyType& key,
 template <typename KeyType, typename ValueType>
 bool BPlusTree<KeyType, ValueType>::Remove(const KeyType& key,
                                            txn_id_t txn_id) {
-    std::lock_guard<std::mutex> lock(latch_);
+    // 先走乐观路径：删除后叶子仍然足够满时不需要合并，只锁叶子即可完成
+    bool optimistic_result = false;
+    if (OptimisticRemove(key, &optimistic_result)) {
+        return optimistic_result;
+    }
+
+    // 需要合并或重分布，独占整棵树
+    std::lock_guard<std::shared_mutex> lock(latch_);
     (void)txn_id;
 
     if (root_page_id_ == INVALID_PAGE_ID) {
@@ -434,7 +517,7 @@ template <typename KeyType, typename ValueType>
 bool BPlusTree<KeyType, ValueType>::GetValue(const KeyType& key,
                                              ValueType* value,
                                              txn_id_t txn_id) {
-    std::lock_guard<std::mutex> lock(latch_);
+    std::shared_lock<std::shared_mutex> lock(latch_);
     (void)txn_id;
 
     if (root_page_id_ == INVALID_PAGE_ID) {
@@ -450,19 +533,327 @@ bool BPlusTree<KeyType, ValueType>::GetValue(const KeyType& key,
     auto leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType>*>(
         leaf_page->GetData());
 
-    // 在叶子页面中查找键
+    // 在叶子页面中查找键，乐观写入者可能同时在修改这个叶子
+    leaf_page->RLatch();
     int index = leaf->KeyIndex(key);
     bool found = (index < leaf->GetSize() && leaf->KeyAt(index) == key);
 
     if (found) {
         *value = leaf->ValueAt(index);
     }
+    leaf_page->RUnlatch();
 
     buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
 
     return found;
 }
 
+/**
+ * 检查树是否为空
+ * @return 没有根页面时返回true
+ */
+template <typename KeyType, typename ValueType>
+bool BPlusTree<KeyType, ValueType>::IsEmpty() {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    return root_page_id_ == INVALID_PAGE_ID;
+}
+
+namespace {
+
+/** total个元素平均分成parts份时第i份的大小，前total % parts份各多一个 */
+size_t BulkLoadPartSize(size_t total, size_t parts, size_t i) {
+    return total / parts + (i < total % parts ? 1 : 0);
+}
+
+/** 按BulkLoadPartSize分配时第j个元素落在哪一份 */
+size_t BulkLoadPartOf(size_t total, size_t parts, size_t j) {
+    size_t base = total / parts;
+    size_t larger = (total % parts) * (base + 1);
+    if (j < larger) {
+        return j / (base + 1);
+    }
+    return total % parts + (j - larger) / base;
+}
+
+/** 按填充率折算每个页面实际放的元素数 */
+int BulkLoadCapacity(int max_size, double fill_factor) {
+    int capacity = static_cast<int>(max_size * fill_factor);
+    return std::max(2, std::min(capacity, max_size));
+}
+
+/**
+ * 提升到内部页面的分隔键，要求 left < right，结果s满足 left < s <= right
+ * 内联字符串键截成能区分两边的最短前缀；非唯一索引的原始键不同时，
+ * 分隔键取 (最短前缀, 最小RID)；其他类型直接用right
+ */
+template <typename KeyType>
+KeyType SeparatorKey(const KeyType& left, const KeyType& right) {
+    if constexpr (IsInlineStringKey<KeyType>::value) {
+        return KeyType::ShortestSeparator(left, right);
+    } else if constexpr (IsNonUniqueKey<KeyType>::value) {
+        if (left.key < right.key) {
+            return KeyType::Lowest(SeparatorKey(left.key, right.key));
+        }
+        return right;
+    } else {
+        (void)left;
+        return right;
+    }
+}
+
+}  // namespace
+
+/**
+ * 自底向上批量构建
+ * @param count 键值对总数
+ * @param next 产生键值对的回调
+ * @param fill_factor 页面填充率
+ * @return 构建是否成功
+ *
+ * 实现思路：
+ * 1. 根据总数和每页容量算出每层的页面数，一直到只剩一个根页面
+ * 2. 先分配所有内部页面，这样每个叶子创建时就知道父页面ID，
+ *    不需要之后再回头改叶子的父指针
+ * 3. 从左到右填叶子，每个叶子拿到平均分配的那部分键值对，
+ *    上一个叶子的next_page_id指向当前叶子，同一时间最多pin两个叶子
+ * 4. 记录每个节点的第一个键，逐层向上填内部页面：
+ *    第k个子节点的第一个键就是内部页面的key[k]
+ * 5. 最后一层的唯一页面就是根，写入header page
+ *
+ * 内部页面每个至少有3个子节点（容量至少2个键），平均分配后不会出现
+ * 只有一个子节点的内部页面
+ */
+template <typename KeyType, typename ValueType>
+bool BPlusTree<KeyType, ValueType>::BulkLoad(
+    size_t count, const std::function<bool(KeyType*, ValueType*)>& next,
+    double fill_factor) {
+    std::lock_guard<std::shared_mutex> lock(latch_);
+
+    if (root_page_id_ != INVALID_PAGE_ID) {
+        LOG_WARN("BulkLoad: index " << index_name_ << " is not empty");
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+    if (!(fill_factor > 0.0 && fill_factor <= 1.0)) {
+        LOG_WARN("BulkLoad: invalid fill factor " << fill_factor
+                                                  << ", using 1.0");
+        fill_factor = 1.0;
+    }
+
+    // header page要占住page 1，必须在分配树页面之前存在
+    page_id_t header_page_id = GetHeaderPageId();
+    Page* header_page = buffer_pool_manager_->FetchPage(header_page_id);
+    if (header_page == nullptr) {
+        UpdateRootPageId(INVALID_PAGE_ID);
+    } else {
+        buffer_pool_manager_->UnpinPage(header_page_id, false);
+    }
+
+    // 页面容量由Init计算，在临时缓冲区上初始化一次取出来
+    alignas(8) char scratch[PAGE_SIZE];
+    auto scratch_leaf =
+        reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType>*>(scratch);
+    scratch_leaf->Init(INVALID_PAGE_ID);
+    size_t leaf_capacity =
+        BulkLoadCapacity(scratch_leaf->GetMaxSize(), fill_factor);
+    auto scratch_internal =
+        reinterpret_cast<BPlusTreeInternalPage<KeyType>*>(scratch);
+    scratch_internal->Init(INVALID_PAGE_ID);
+    size_t fanout =
+        BulkLoadCapacity(scratch_internal->GetMaxSize(), fill_factor) + 1;
+
+    // 1. 规划每层的页面数，level 0是叶子
+    std::vector<size_t> level_sizes{(count + leaf_capacity - 1) /
+                                    leaf_capacity};
+    while (level_sizes.back() > 1) {
+        level_sizes.push_back((level_sizes.back() + fanout - 1) / fanout);
+    }
+    size_t height = level_sizes.size();
+
+    std::vector<std::vector<page_id_t>> level_pages(height);
+    std::vector<std::vector<KeyType>> level_keys(height);
+    std::vector<page_id_t> allocated;
+    auto abort_load = [&](const char* reason) {
+        LOG_ERROR("BulkLoad: " << reason << " for index " << index_name_);
+        for (page_id_t page_id : allocated) {
+            buffer_pool_manager_->DeletePage(page_id);
+        }
+        return false;
+    };
+    auto parent_of = [&](size_t level, size_t index) {
+        if (level + 1 >= height) {
+            return INVALID_PAGE_ID;
+        }
+        return level_pages[level + 1][BulkLoadPartOf(
+            level_sizes[level], level_sizes[level + 1], index)];
+    };
+
+    // 2. 从上往下分配内部页面
+    for (size_t level = height; level-- > 1;) {
+        for (size_t i = 0; i < level_sizes[level]; i++) {
+            page_id_t page_id;
+            Page* page = NewTreePage(&page_id);
+            if (page == nullptr) {
+                return abort_load("failed to allocate internal page");
+            }
+            allocated.push_back(page_id);
+            auto internal =
+                reinterpret_cast<BPlusTreeInternalPage<KeyType>*>(
+                    page->GetData());
+            internal->Init(page_id, parent_of(level, i));
+            buffer_pool_manager_->UnpinPage(page_id, true);
+            level_pages[level].push_back(page_id);
+        }
+    }
+
+    // 3. 从左到右填叶子
+    Page* prev_page = nullptr;
+    KeyType key{};
+    KeyType last_key{};
+    ValueType value{};
+    size_t loaded = 0;
+    std::vector<std::pair<KeyType, ValueType>> leaf_entries;
+    for (size_t i = 0; i < level_sizes[0]; i++) {
+        page_id_t page_id;
+        Page* page = NewTreePage(&page_id);
+        if (page == nullptr) {
+            if (prev_page != nullptr) {
+                buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+            }
+            return abort_load("failed to allocate leaf page");
+        }
+        allocated.push_back(page_id);
+        auto leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType>*>(
+            page->GetData());
+        leaf->Init(page_id, parent_of(0, i));
+
+        size_t entries = BulkLoadPartSize(count, level_sizes[0], i);
+        const char* error = nullptr;
+        leaf_entries.clear();
+        for (size_t k = 0; k < entries; k++) {
+            if (!next(&key, &value)) {
+                error = "source ended before the expected count";
+                break;
+            }
+            if (loaded > 0 && !(last_key < key)) {
+                error = "keys are not strictly increasing";
+                break;
+            }
+            leaf_entries.emplace_back(key, value);
+            if (k == 0) {
+                level_keys[0].push_back(loaded > 0 ? SeparatorKey(last_key, key)
+                                                   : key);
+            }
+            last_key = key;
+            loaded++;
+        }
+        // 一次写入整个叶子，前缀压缩的页面据此算出公共前缀
+        if (error == nullptr &&
+            !leaf->Assign(leaf_entries.data(),
+                          static_cast<int>(leaf_entries.size()))) {
+            error = "entries do not fit into a leaf page";
+        }
+
+        if (prev_page != nullptr) {
+            reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType>*>(
+                prev_page->GetData())
+                ->SetNextPageId(page_id);
+            buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+        }
+        prev_page = page;
+        level_pages[0].push_back(page_id);
+
+        if (error != nullptr) {
+            buffer_pool_manager_->UnpinPage(page_id, true);
+            return abort_load(error);
+        }
+    }
+    buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+
+    // 4. 逐层向上填内部页面
+    for (size_t level = 1; level < height; level++) {
+        const auto& children = level_pages[level - 1];
+        const auto& child_keys = level_keys[level - 1];
+        size_t child = 0;
+        for (size_t i = 0; i < level_sizes[level]; i++) {
+            page_id_t page_id = level_pages[level][i];
+            Page* page = FetchTreePage(page_id);
+            if (page == nullptr) {
+                return abort_load("failed to fetch internal page");
+            }
+            auto internal =
+                reinterpret_cast<BPlusTreeInternalPage<KeyType>*>(
+                    page->GetData());
+            size_t num_children =
+                BulkLoadPartSize(level_sizes[level - 1], level_sizes[level], i);
+            internal->SetValueAt(0, children[child]);
+            for (size_t k = 1; k < num_children; k++) {
+                internal->SetKeyAt(static_cast<int>(k), child_keys[child + k]);
+                internal->SetValueAt(static_cast<int>(k), children[child + k]);
+            }
+            internal->SetSize(static_cast<int>(num_children - 1));
+            level_keys[level].push_back(child_keys[child]);
+            child += num_children;
+            buffer_pool_manager_->UnpinPage(page_id, true);
+        }
+    }
+
+    // 5. 设置根页面
+    root_page_id_ = level_pages[height - 1][0];
+    UpdateRootPageId(root_page_id_);
+
+    LOG_DEBUG("BulkLoad: built index " << index_name_ << " with " << count
+                                       << " entries, " << level_sizes[0]
+                                       << " leaves, height " << height);
+    return true;
+}
+
+/**
+ * 从内存中的键值对批量构建
+ * @param entries 键值对
+ * @param fill_factor 页面填充率
+ * @return 构建是否成功
+ *
+ * 实现思路：按键稳定排序，相同的键只留最后一个（和逐条Insert的覆盖
+ * 语义一致），然后交给按序列构建的版本
+ */
+template <typename KeyType, typename ValueType>
+bool BPlusTree<KeyType, ValueType>::BulkLoad(
+    std::vector<std::pair<KeyType, ValueType>> entries, double fill_factor) {
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const auto& a, const auto& b) {
+                         return a.first < b.first;
+                     });
+    size_t out = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (i + 1 < entries.size() &&
+            !(entries[i].first < entries[i + 1].first)) {
+            continue;
+        }
+        if (out != i) {
+            entries[out] = std::move(entries[i]);
+        }
+        out++;
+    }
+    entries.resize(out);
+
+    size_t pos = 0;
+    return BulkLoad(
+        entries.size(),
+        [&entries, &pos](KeyType* key, ValueType* value) {
+            if (pos >= entries.size()) {
+                return false;
+            }
+            *key = entries[pos].first;
+            *value = entries[pos].second;
+            pos++;
+            return true;
+        },
+        fill_factor);
+}
+
 /**
  * 返回指向第一个键值对的迭代器
  * @return 指向第一个键值对的迭代器
@@ -476,7 +867,7 @@ bool BPlusTree<KeyType, ValueType>::GetValue(const KeyType& key,
 template <typename KeyType, typename ValueType>
 typename BPlusTree<KeyType, ValueType>::Iterator
 BPlusTree<KeyType, ValueType>::Begin() {
-    std::lock_guard<std::mutex> lock(latch_);
+    std::shared_lock<std::shared_mutex> lock(latch_);
 
     if (root_page_id_ == INVALID_PAGE_ID) {
         return End();
@@ -486,7 +877,7 @@ BPlusTree<KeyType, ValueType>::Begin() {
 
     // 一直向左走，找到最左边的叶子页面
     while (true) {
-        Page* page = buffer_pool_manager_->FetchPage(current_page_id);
+        Page* page = FetchTreePage(current_page_id);
         if (page == nullptr) {
             return End();
         }
@@ -498,11 +889,13 @@ BPlusTree<KeyType, ValueType>::Begin() {
             auto leaf =
                 reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType>*>(
                     page->GetData());
-            if (leaf->GetSize() == 0) {
-                buffer_pool_manager_->UnpinPage(current_page_id, false);
+            page->RLatch();
+            bool empty = leaf->GetSize() == 0;
+            page->RUnlatch();
+            buffer_pool_manager_->UnpinPage(current_page_id, false);
+            if (empty) {
                 return End();
             }
-            buffer_pool_manager_->UnpinPage(current_page_id, false);
             return Iterator(this, current_page_id, 0);
         }
 
@@ -529,7 +922,7 @@ BPlusTree<KeyType, ValueType>::Begin() {
 template <typename KeyType, typename ValueType>
 typename BPlusTree<KeyType, ValueType>::Iterator
 BPlusTree<KeyType, ValueType>::Begin(const KeyType& key) {
-    std::lock_guard<std::mutex> lock(latch_);
+    std::shared_lock<std::shared_mutex> lock(latch_);
 
     if (root_page_id_ == INVALID_PAGE_ID) {
         return End();
@@ -544,11 +937,22 @@ BPlusTree<KeyType, ValueType>::Begin(const KeyType& key) {
         leaf_page->GetData());
 
     // 找到第一个大于等于key的位置
+    leaf_page->RLatch();
     int index = leaf->KeyIndex(key);
+    int size = leaf->GetSize();
+    page_id_t next_page_id = leaf->GetNextPageId();
+    leaf_page->RUnlatch();
     page_id_t page_id = leaf_page->GetPageId();
 
     buffer_pool_manager_->UnpinPage(page_id, false);
 
+    // key比这个叶子里所有的键都大，第一个大于等于key的键在下一个叶子的开头
+    if (index >= size) {
+        if (next_page_id == INVALID_PAGE_ID) {
+            return End();
+        }
+        return Iterator(this, next_page_id, 0);
+    }
     return Iterator(this, page_id, index);
 }
 
@@ -575,6 +979,95 @@ BPlusTree<KeyType, ValueType>::End() {
  * 4. 添加循环检测和深度限制，防止无限循环
  * 5. 验证页面的有效性，确保数据一致性
  */
+/**
+ * 乐观插入，只锁目标叶子
+ *
+ * 实现思路：
+ * 1. 持有树的共享锁向下查找：结构修改（分裂、合并、换根）都要独占整棵树，
+ *    所以下降过程中内部节点不会变化，不需要逐层加页锁
+ * 2. 只对叶子加写锁，其他乐观写入者和读者通过叶子的页锁互斥
+ * 3. 键已存在（更新值）或者叶子没满时直接完成
+ * 4. 叶子已满说明会分裂，放掉所有锁返回false，由调用者独占整棵树重做
+ */
+template <typename KeyType, typename ValueType>
+bool BPlusTree<KeyType, ValueType>::OptimisticInsert(const KeyType& key,
+                                                     const ValueType& value,
+                                                     bool* result) {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    if (root_page_id_ == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    Page* leaf_page = FindLeafPage(key, true);
+    if (leaf_page == nullptr) {
+        return false;
+    }
+    page_id_t leaf_page_id = leaf_page->GetPageId();
+    auto leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType>*>(
+        leaf_page->GetData());
+
+    bool handled = true;
+    leaf_page->WLatch();
+    int index = leaf->KeyIndex(key);
+    if (index < leaf->GetSize() && leaf->KeyAt(index) == key) {
+        leaf->SetValueAt(index, value);
+        *result = true;
+    } else if (leaf->HasRoomFor(key)) {
+        *result = leaf->Insert(key, value);
+    } else {
+        handled = false;
+    }
+    leaf_page->WUnlatch();
+
+    buffer_pool_manager_->UnpinPage(leaf_page_id, handled && *result);
+    return handled;
+}
+
+/**
+ * 乐观删除，只锁目标叶子
+ *
+ * 实现思路：
+ * 1. 和OptimisticInsert一样持有树的共享锁下降，只对叶子加写锁
+ * 2. 键不存在时直接返回false
+ * 3. 删除后叶子仍然不需要合并时直接删除：
+ *    根叶子至少保留一个键，非根叶子不低于最小填充
+ * 4. 否则返回false，由调用者独占整棵树处理合并或重分布
+ */
+template <typename KeyType, typename ValueType>
+bool BPlusTree<KeyType, ValueType>::OptimisticRemove(const KeyType& key,
+                                                     bool* result) {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    if (root_page_id_ == INVALID_PAGE_ID) {
+        *result = false;
+        return true;
+    }
+
+    Page* leaf_page = FindLeafPage(key, true);
+    if (leaf_page == nullptr) {
+        return false;
+    }
+    page_id_t leaf_page_id = leaf_page->GetPageId();
+    auto leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType>*>(
+        leaf_page->GetData());
+
+    bool handled = true;
+    leaf_page->WLatch();
+    int index = leaf->KeyIndex(key);
+    int size = leaf->GetSize();
+    if (index >= size || !(leaf->KeyAt(index) == key)) {
+        *result = false;
+    } else if (leaf->IsRootPage() ? size > 1
+                                  : size - 1 >= (leaf->GetMaxSize() + 1) / 2) {
+        *result = leaf->Delete(key);
+    } else {
+        handled = false;
+    }
+    leaf_page->WUnlatch();
+
+    buffer_pool_manager_->UnpinPage(leaf_page_id, handled && *result);
+    return handled;
+}
+
 template <typename KeyType, typename ValueType>
 Page* BPlusTree<KeyType, ValueType>::FindLeafPage(const KeyType& key,
                                                   bool is_write_op) {
@@ -588,24 +1081,11 @@ Page* BPlusTree<KeyType, ValueType>::FindLeafPage(const KeyType& key,
     page_id_t current_page_id = root_page_id_;
     Page* current_page = nullptr;
 
-    // 循环检测和深度限制，防止无限循环
-    std::unordered_set<page_id_t> visited_pages;
+    // 深度限制，防止页面链接损坏时无限循环
     const int MAX_TREE_DEPTH = 20;  // 合理的最大树深度
     int depth = 0;
 
     while (true) {
-        // 检查是否已访问过此页面（循环检测）
-        if (visited_pages.count(current_page_id) > 0) {
-            LOG_ERROR(
-                "FindLeafPage: Detected cycle in B+tree traversal at page "
-                << current_page_id);
-            if (current_page != nullptr) {
-                buffer_pool_manager_->UnpinPage(current_page->GetPageId(),
-                                                false);
-            }
-            return nullptr;
-        }
-
         // 检查树深度
         if (depth >= MAX_TREE_DEPTH) {
             LOG_ERROR("FindLeafPage: Tree depth exceeded maximum limit "
@@ -617,7 +1097,6 @@ Page* BPlusTree<KeyType, ValueType>::FindLeafPage(const KeyType& key,
             return nullptr;
         }
 
-        visited_pages.insert(current_page_id);
         depth++;
 
         // 释放上一个页面
@@ -628,7 +1107,7 @@ Page* BPlusTree<KeyType, ValueType>::FindLeafPage(const KeyType& key,
         // 获取当前页面
         LOG_TRACE("FindLeafPage: fetching page " << current_page_id
                                                  << " at depth " << depth);
-        current_page = buffer_pool_manager_->FetchPage(current_page_id);
+        current_page = FetchTreePage(current_page_id);
         if (current_page == nullptr) {
             LOG_ERROR("Failed to fetch page: "
                       << current_page_id << " (num_pages="
@@ -734,18 +1213,20 @@ bool BPlusTree<KeyType, ValueType>::InsertIntoLeaf(
     }
 
     // 检查页面是否有空间
-    if (leaf->GetSize() < leaf->GetMaxSize()) {
+    if (leaf->HasRoomFor(key)) {
         // 有空间，直接插入
         return leaf->Insert(key, value);
     }
 
     // 页面已满，需要分裂
+    TRACE_SPAN_NAMED(split_span, "index", "BPlusTree::SplitLeaf");
+    TRACE_SPAN_SET_ARG(split_span, static_cast<uint64_t>(leaf->GetPageId()));
     LOG_DEBUG("Leaf page is full, need to split. Size: "
               << leaf->GetSize() << ", MaxSize: " << leaf->GetMaxSize());
 
     // 创建新的叶子页面
     page_id_t new_page_id;
-    Page* new_page = buffer_pool_manager_->NewPage(&new_page_id);
+    Page* new_page = NewTreePage(&new_page_id);
     if (new_page == nullptr) {
         LOG_ERROR("Failed to allocate new page for split");
         return false;
@@ -784,29 +1265,27 @@ bool BPlusTree<KeyType, ValueType>::InsertIntoLeaf(
     // 计算分裂点（通常是中间位置）
     int split_point = total_entries / 2;
 
-    // 清空原页面并填入前半部分数据
-    leaf->SetSize(0);
-    for (int i = 0; i < split_point; i++) {
-        leaf->SetKeyAt(i, temp_entries[i].first);
-        leaf->SetValueAt(i, temp_entries[i].second);
-    }
-    leaf->SetSize(split_point);
-
-    // 填入新页面后半部分数据
-    for (int i = split_point; i < total_entries; i++) {
-        new_leaf->SetKeyAt(i - split_point, temp_entries[i].first);
-        new_leaf->SetValueAt(i - split_point, temp_entries[i].second);
+    // 原页面重写为前半部分数据，新页面放后半部分
+    // 前缀压缩的页面会各自重新计算公共前缀
+    if (!leaf->Assign(temp_entries.data(), split_point) ||
+        !new_leaf->Assign(temp_entries.data() + split_point,
+                          total_entries - split_point)) {
+        LOG_ERROR("Split halves do not fit into leaf pages");
+        buffer_pool_manager_->UnpinPage(new_page_id, false);
+        buffer_pool_manager_->DeletePage(new_page_id);
+        return false;
     }
-    new_leaf->SetSize(total_entries - split_point);
 
     // 更新叶子页面间的链表指针
     new_leaf->SetNextPageId(leaf->GetNextPageId());
     leaf->SetNextPageId(new_page_id);
 
-    // 获取中间键（新页面的第一个键）用于提升到父页面
+    // 获取中间键用于提升到父页面：左页面最后一个键和新页面第一个键之间的
+    // 最短分隔键，对大多数类型就是新页面的第一个键
     KeyType middle_key;
     if (new_leaf->GetSize() > 0) {
-        middle_key = new_leaf->KeyAt(0);
+        middle_key = SeparatorKey(leaf->KeyAt(leaf->GetSize() - 1),
+                                  new_leaf->KeyAt(0));
     } else {
         LOG_ERROR("New leaf node has no elements after split");
         buffer_pool_manager_->UnpinPage(new_page_id, false);
@@ -863,7 +1342,7 @@ void BPlusTree<KeyType, ValueType>::InsertIntoParent(BPlusTreePage* old_node,
     // 情况1：原节点是根节点，需要创建新的根节点
     if (old_node->IsRootPage()) {
         page_id_t new_root_id;
-        Page* new_root_page = buffer_pool_manager_->NewPage(&new_root_id);
+        Page* new_root_page = NewTreePage(&new_root_id);
         if (new_root_page == nullptr) {
             LOG_ERROR("Failed to create new root page");
             return;
@@ -898,8 +1377,7 @@ void BPlusTree<KeyType, ValueType>::InsertIntoParent(BPlusTreePage* old_node,
     }
 
     // 情况2：不是根节点，获取父页面
-    Page* parent_page =
-        buffer_pool_manager_->FetchPage(old_node->GetParentPageId());
+    Page* parent_page = FetchTreePage(old_node->GetParentPageId());
     if (parent_page == nullptr) {
         LOG_ERROR("Failed to fetch parent page");
         return;
@@ -929,11 +1407,14 @@ void BPlusTree<KeyType, ValueType>::InsertIntoParent(BPlusTreePage* old_node,
 
             // 现在分裂父页面
             if (parent->GetSize() > parent->GetMaxSize()) {
+                TRACE_SPAN_NAMED(split_span, "index",
+                                 "BPlusTree::SplitInternal");
+                TRACE_SPAN_SET_ARG(split_span,
+                                   static_cast<uint64_t>(parent->GetPageId()));
                 LOG_DEBUG("Parent page needs splitting after insertion");
                 // 创建新的内部页面
                 page_id_t new_parent_page_id;
-                Page* new_parent_page =
-                    buffer_pool_manager_->NewPage(&new_parent_page_id);
+                Page* new_parent_page = NewTreePage(&new_parent_page_id);
                 if (new_parent_page != nullptr) {
                     auto new_parent =
                         reinterpret_cast<BPlusTreeInternalPage<KeyType>*>(
@@ -1015,8 +1496,7 @@ bool BPlusTree<KeyType, ValueType>::CoalesceOrRedistribute(BPlusTreePage* node,
         return AdjustRoot(node);
     }
 
-    Page* parent_page =
-        buffer_pool_manager_->FetchPage(node->GetParentPageId());
+    Page* parent_page = FetchTreePage(node->GetParentPageId());
     if (parent_page == nullptr) {
         return false;
     }
@@ -1040,7 +1520,7 @@ bool BPlusTree<KeyType, ValueType>::CoalesceOrRedistribute(BPlusTreePage* node,
 
     page_id_t sibling_page_id = parent->ValueAt(sibling_index);
 
-    Page* sibling_page = buffer_pool_manager_->FetchPage(sibling_page_id);
+    Page* sibling_page = FetchTreePage(sibling_page_id);
     if (sibling_page == nullptr) {
         buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), false);
         return false;
@@ -1051,7 +1531,16 @@ bool BPlusTree<KeyType, ValueType>::CoalesceOrRedistribute(BPlusTreePage* node,
     bool node_deleted = false;
 
     // 判断是合并还是重分布
-    if (node->GetSize() + sibling->GetSize() < node->GetMaxSize()) {
+    // 前缀压缩的叶子容量和前缀有关，由叶子页面自己判断能不能合并
+    bool can_merge;
+    if (node->IsLeafPage()) {
+        using LeafPage = BPlusTreeLeafPage<KeyType, ValueType>;
+        can_merge = reinterpret_cast<LeafPage*>(node)->CanMergeWith(
+            reinterpret_cast<LeafPage*>(sibling));
+    } else {
+        can_merge = node->GetSize() + sibling->GetSize() < node->GetMaxSize();
+    }
+    if (can_merge) {
         // 合并
         bool is_predecessor = sibling_index < node_index;
         node_deleted =
@@ -1103,7 +1592,7 @@ bool BPlusTree<KeyType, ValueType>::AdjustRoot(BPlusTreePage* old_root_node) {
         page_id_t new_root_id = root->ValueAt(0);
 
         if (new_root_id != INVALID_PAGE_ID) {
-            Page* new_root_page = buffer_pool_manager_->FetchPage(new_root_id);
+            Page* new_root_page = FetchTreePage(new_root_id);
             if (new_root_page != nullptr) {
                 auto new_root =
                     reinterpret_cast<BPlusTreePage*>(new_root_page->GetData());
@@ -1220,7 +1709,7 @@ template <typename KeyType, typename ValueType>
 template <typename N>
 void BPlusTree<KeyType, ValueType>::Redistribute(N* neighbor_node, N* node,
                                                  int index) {
-    auto parent_page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
+    auto parent_page = FetchTreePage(node->GetParentPageId());
     if (parent_page == nullptr) {
         return;
     }
@@ -1283,6 +1772,11 @@ void BPlusTree<KeyType, ValueType>::UpdateRootPageId(page_id_t root_page_id) {
     LOG_DEBUG("UpdateRootPageId called with root_page_id: "
               << root_page_id << " for index: " << index_name_);
 
+    // catalog里的根页面是打开索引的依据，header page写失败也要通知
+    if (root_change_callback_) {
+        root_change_callback_(root_page_id);
+    }
+
     page_id_t header_page_id = GetHeaderPageId();
     Page* header_page = buffer_pool_manager_->FetchPage(header_page_id);
 
@@ -1380,7 +1874,9 @@ BPlusTree<KeyType, ValueType>::Iterator::operator*() {
         throw std::runtime_error("Iterator is at end");
     }
 
-    Page* page = tree_->buffer_pool_manager_->FetchPage(current_page_id_);
+    // 结构修改会独占整棵树，持有共享锁期间叶子不会被合并或释放
+    std::shared_lock<std::shared_mutex> lock(tree_->latch_);
+    Page* page = tree_->FetchTreePage(current_page_id_);
     if (page == nullptr) {
         throw std::runtime_error("Failed to fetch page");
     }
@@ -1388,14 +1884,17 @@ BPlusTree<KeyType, ValueType>::Iterator::operator*() {
     auto leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType>*>(
         page->GetData());
 
+    page->RLatch();
     // 添加边界检查
     if (current_index_ >= leaf->GetSize() || current_index_ < 0) {
+        page->RUnlatch();
         tree_->buffer_pool_manager_->UnpinPage(current_page_id_, false);
         throw std::runtime_error("Iterator index out of range");
     }
 
     KeyType key = leaf->KeyAt(current_index_);
     ValueType value = leaf->ValueAt(current_index_);
+    page->RUnlatch();
 
     tree_->buffer_pool_manager_->UnpinPage(current_page_id_, false);
 
@@ -1418,7 +1917,8 @@ void BPlusTree<KeyType, ValueType>::Iterator::operator++() {
         return;
     }
 
-    Page* page = tree_->buffer_pool_manager_->FetchPage(current_page_id_);
+    std::shared_lock<std::shared_mutex> lock(tree_->latch_);
+    Page* page = tree_->FetchTreePage(current_page_id_);
     if (page == nullptr) {
         current_page_id_ = INVALID_PAGE_ID;
         return;
@@ -1427,40 +1927,40 @@ void BPlusTree<KeyType, ValueType>::Iterator::operator++() {
     auto leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType>*>(
         page->GetData());
 
+    page->RLatch();
+    int size = leaf->GetSize();
+    page_id_t next_page_id = leaf->GetNextPageId();
+    page->RUnlatch();
+    tree_->buffer_pool_manager_->UnpinPage(current_page_id_, false);
+
     current_index_++;
+    if (current_index_ < size) {
+        return;
+    }
 
-    if (current_index_ >= leaf->GetSize()) {
-        // 移动到下一个页面
-        page_id_t next_page_id = leaf->GetNextPageId();
-        tree_->buffer_pool_manager_->UnpinPage(current_page_id_, false);
+    // 移动到下一个页面的第一个元素
+    current_index_ = 0;
+    current_page_id_ = next_page_id;
+    if (next_page_id == INVALID_PAGE_ID) {
+        // 没有下一个页面，迭代结束
+        return;
+    }
 
-        if (next_page_id == INVALID_PAGE_ID) {
-            // 没有下一个页面，迭代结束
-            current_page_id_ = INVALID_PAGE_ID;
-            current_index_ = 0;
-        } else {
-            // 移动到下一个页面的第一个元素
-            current_page_id_ = next_page_id;
-            current_index_ = 0;
-
-            // 验证下一个页面是否有效且有数据
-            Page* next_page =
-                tree_->buffer_pool_manager_->FetchPage(next_page_id);
-            if (next_page == nullptr) {
-                current_page_id_ = INVALID_PAGE_ID;
-            } else {
-                auto next_leaf =
-                    reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType>*>(
-                        next_page->GetData());
-                if (next_leaf->GetSize() == 0) {
-                    // 下一个页面为空，迭代结束
-                    current_page_id_ = INVALID_PAGE_ID;
-                }
-                tree_->buffer_pool_manager_->UnpinPage(next_page_id, false);
-            }
-        }
-    } else {
-        tree_->buffer_pool_manager_->UnpinPage(current_page_id_, false);
+    // 验证下一个页面是否有效且有数据
+    Page* next_page = tree_->FetchTreePage(next_page_id);
+    if (next_page == nullptr) {
+        current_page_id_ = INVALID_PAGE_ID;
+        return;
+    }
+    auto next_leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType>*>(
+        next_page->GetData());
+    next_page->RLatch();
+    bool empty = next_leaf->GetSize() == 0;
+    next_page->RUnlatch();
+    tree_->buffer_pool_manager_->UnpinPage(next_page_id, false);
+    if (empty) {
+        // 下一个页面为空，迭代结束
+        current_page_id_ = INVALID_PAGE_ID;
     }
 }
 
@@ -1471,4 +1971,31 @@ template class BPlusTree<float, RID>;
 template class BPlusTree<double, RID>;
 template class BPlusTree<std::string, RID>;
 
+// 非唯一索引的复合键
+template class BPlusTree<NonUniqueKey<int32_t>, RID>;
+template class BPlusTree<NonUniqueKey<int64_t>, RID>;
+template class BPlusTree<NonUniqueKey<float>, RID>;
+template class BPlusTree<NonUniqueKey<double>, RID>;
+template class BPlusTree<NonUniqueKey<std::string>, RID>;
+
+// 多列索引的定长键
+template class BPlusTree<GenericKey<8>, RID>;
+template class BPlusTree<GenericKey<16>, RID>;
+template class BPlusTree<GenericKey<32>, RID>;
+template class BPlusTree<GenericKey<64>, RID>;
+template class BPlusTree<NonUniqueKey<GenericKey<8>>, RID>;
+template class BPlusTree<NonUniqueKey<GenericKey<16>>, RID>;
+template class BPlusTree<NonUniqueKey<GenericKey<32>>, RID>;
+template class BPlusTree<NonUniqueKey<GenericKey<64>>, RID>;
+
+// VARCHAR索引的内联字符串键
+template class BPlusTree<InlineStringKey<16>, RID>;
+template class BPlusTree<InlineStringKey<32>, RID>;
+template class BPlusTree<InlineStringKey<64>, RID>;
+template class BPlusTree<InlineStringKey<128>, RID>;
+template class BPlusTree<NonUniqueKey<InlineStringKey<16>>, RID>;
+template class BPlusTree<NonUniqueKey<InlineStringKey<32>>, RID>;
+template class BPlusTree<NonUniqueKey<InlineStringKey<64>>, RID>;
+template class BPlusTree<NonUniqueKey<InlineStringKey<128>>, RID>;
+
 }  // namespace SimpleRDBMS
\ No newline at end of file
@@ -8,8 +8,12 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "index/b_plus_tree_page.h"
@@ -28,7 +32,8 @@ class BPlusTreeInternalPage;
  * 2. 内部节点只存储键和指向子节点的指针，用于快速导航
  * 3. 叶子节点之间通过链表连接，支持高效的范围查询
  * 4. 使用buffer pool管理页面，支持数据持久化
- * 5. 线程安全设计，支持并发访问
+ * 5. 线程安全设计：读者和不改变结构的写入者并发执行，只锁叶子页面；
+ *    分裂、合并等结构修改独占整棵树
  *
  * @tparam KeyType 键的类型，支持int32_t, int64_t, float, double, string
  * @tparam ValueType 值的类型，通常是RID（Record ID）
@@ -48,6 +53,19 @@ class BPlusTree {
      */
     BPlusTree(const std::string& name, BufferPoolManager* buffer_pool_manager);
 
+    /**
+     * 用已知的根页面打开B+树
+     * @param name 索引名称
+     * @param buffer_pool_manager 缓冲池管理器
+     * @param root_page_id 根页面ID，INVALID_PAGE_ID表示新建空树
+     *
+     * 功能说明：
+     * - 根页面ID由catalog持久化，不依赖header page中按名字hash的槽位
+     * - 根页面读不出来或不是根时当作空树
+     */
+    BPlusTree(const std::string& name, BufferPoolManager* buffer_pool_manager,
+              page_id_t root_page_id);
+
     /**
      * B+树析构函数
      *
@@ -106,6 +124,66 @@ class BPlusTree {
      */
     bool GetValue(const KeyType& key, ValueType* value, txn_id_t txn_id = -1);
 
+    /**
+     * 树是否为空
+     * @return 没有根页面时返回true
+     */
+    bool IsEmpty();
+
+    /**
+     * 获取当前根页面ID
+     * @return 根页面ID，空树为INVALID_PAGE_ID
+     */
+    page_id_t GetRootPageId();
+
+    /**
+     * 设置根页面变化时的回调
+     * @param callback 参数是新的根页面ID
+     *
+     * 功能说明：
+     * - 插入导致根分裂、删除导致根下降、批量构建完成时都会调用
+     * - 调用时持有树的锁，回调里不能再访问这棵树
+     */
+    void SetRootChangeCallback(std::function<void(page_id_t)> callback);
+
+    /**
+     * 设置树的新页面写盘时使用的压缩算法，已有的页面读进来时按磁盘上的格式登记
+     * 要在树分配页面之前调用
+     */
+    void SetPageCompression(PageCompression compression) {
+        extent_.compression = compression;
+    }
+
+    // ========================================================================
+    // 批量构建接口 - Bulk Load
+    // ========================================================================
+
+    /**
+     * 从有序的键值对序列自底向上构建整棵树
+     * @param count 键值对总数，用来事先规划每层的页面数
+     * @param next 依次产生键值对的回调，键必须严格递增，取完时返回false
+     * @param fill_factor 叶子和内部页面的填充率，取值(0, 1]
+     * @return 构建是否成功，失败时已分配的页面全部释放，树保持为空
+     *
+     * 功能说明：
+     * - 只能在空树上调用，非空树直接返回false
+     * - 叶子从左到右依次填满并串成链表，上层用每个子节点的第一个键做分隔键
+     * - 同一层的页面平均分配元素，不会出现最后一个页面过空的情况
+     * - 填充率小于1时每个页面预留空间，之后的插入不会马上触发分裂
+     */
+    bool BulkLoad(size_t count,
+                  const std::function<bool(KeyType*, ValueType*)>& next,
+                  double fill_factor = 1.0);
+
+    /**
+     * 从内存中的键值对构建整棵树
+     * @param entries 键值对，不要求有序，相同的键保留最后一个
+     * @param fill_factor 页面填充率
+     * @return 构建是否成功
+     */
+    bool BulkLoad(std::vector<std::pair<KeyType, ValueType>> entries,
+                  double fill_factor = 1.0);
+
     // ========================================================================
     // 迭代器接口 - Iterator for Range Scan
     // ========================================================================
@@ -206,7 +284,22 @@ class BPlusTree {
     std::string index_name_;                  // 索引名称，用于持久化标识
     BufferPoolManager* buffer_pool_manager_;  // 缓冲池管理器，不拥有所有权
     page_id_t root_page_id_;  // 根页面ID，INVALID_PAGE_ID表示空树
-    std::mutex latch_;        // 互斥锁，保护并发访问
+    ExtentReservation extent_;  // 树的页面从这个区段里连续分配
+    // 树锁：查找和不改变结构的插入、删除持有共享锁，
+    // 分裂、合并、换根持有独占锁；叶子内容由叶子页面的读写锁保护
+    std::shared_mutex latch_;
+    std::function<void(page_id_t)> root_change_callback_;  // 根页面变化通知
+
+    /** 取得树的页面并核对校验值，损坏的页面和取不到一样返回nullptr */
+    Page* FetchTreePage(page_id_t page_id) {
+        return BPlusTreePage::FetchTreePage(buffer_pool_manager_, page_id);
+    }
+
+    /** 从树的区段里分配页面 */
+    Page* NewTreePage(page_id_t* page_id) {
+        return BPlusTreePage::NewTreePage(buffer_pool_manager_, page_id,
+                                          &extent_);
+    }
 
     // ========================================================================
     // 查找和插入的辅助函数 - Helper Functions for Search and Insertion
@@ -221,11 +314,26 @@ class BPlusTree {
      * 实现思路：
      * - 从根节点开始，逐层向下查找
      * - 在内部节点中使用二分查找确定下一个子节点
-     * - 包含循环检测和深度限制，防止无限循环
+     * - 包含深度限制，防止页面链接损坏时无限循环
      * - 验证每个页面的有效性
      */
     Page* FindLeafPage(const KeyType& key, bool is_write_op);
 
+    /**
+     * 乐观插入：持有树的共享锁，只锁目标叶子
+     * @param result 处理完成时写入插入结果
+     * @return true表示已处理，false表示叶子会分裂，需要独占整棵树重做
+     */
+    bool OptimisticInsert(const KeyType& key, const ValueType& value,
+                          bool* result);
+
+    /**
+     * 乐观删除：持有树的共享锁，只锁目标叶子
+     * @param result 处理完成时写入删除结果
+     * @return true表示已处理，false表示叶子会合并或重分布，需要独占整棵树重做
+     */
+    bool OptimisticRemove(const KeyType& key, bool* result);
+
     /**
      * 向叶子页面插入键值对，必要时触发分裂
      * @param key 要插入的键
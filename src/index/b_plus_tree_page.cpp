@@ -9,13 +9,75 @@
 
 #include <algorithm>
 #include <cstring>
+#include <type_traits>
 
 #include "buffer/buffer_pool_manager.h"
 #include "common/debug.h"
 #include "common/types.h"
+#include "index/generic_key.h"
+#include "index/inline_string_key.h"
+#include "index/non_unique_key.h"
 
 namespace SimpleRDBMS {
 
+namespace {
+
+/**
+ * 在页面里按stride间隔存放的有序键上二分查找
+ * @param base 第0个键的地址
+ * @param stride 相邻两个键之间的字节数
+ * @param count 键的个数
+ * @param upper false时返回第一个不小于key的位置（lower_bound），
+ *              true时返回第一个大于key的位置（upper_bound）
+ *
+ * 实现思路：
+ * - 整数和浮点键：无分支的二分查找。每轮固定砍掉一半区间，
+ *   用条件选择代替if，编译器生成cmov，循环次数只由count决定，
+ *   不会因为分支预测失败打断流水线；页面里的键不一定对齐，用memcpy读取
+ * - 其他键类型：普通的二分查找，直接在页面上按引用比较，不拷贝键
+ */
+template <typename KeyType>
+int SearchKeys(const char* base, size_t stride, int count, const KeyType& key,
+               bool upper) {
+    if (count <= 0) {
+        return 0;
+    }
+    if constexpr (std::is_arithmetic_v<KeyType>) {
+        // 答案始终在[first, first + length]里
+        const char* first = base;
+        size_t length = static_cast<size_t>(count);
+        while (length > 1) {
+            size_t half = length / 2;
+            KeyType probe;
+            std::memcpy(&probe, first + half * stride, sizeof(KeyType));
+            bool go_right = upper ? !(key < probe) : probe < key;
+            first = go_right ? first + half * stride : first;
+            length -= half;
+        }
+        KeyType probe;
+        std::memcpy(&probe, first, sizeof(KeyType));
+        bool go_right = upper ? !(key < probe) : probe < key;
+        return static_cast<int>((first - base) / stride) + (go_right ? 1 : 0);
+    } else {
+        int left = 0;
+        int right = count;
+        while (left < right) {
+            int mid = left + (right - left) / 2;
+            const KeyType& probe =
+                *reinterpret_cast<const KeyType*>(base + mid * stride);
+            bool go_right = upper ? !(key < probe) : probe < key;
+            if (go_right) {
+                left = mid + 1;
+            } else {
+                right = mid;
+            }
+        }
+        return left;
+    }
+}
+
+}  // namespace
+
 /**
  * 叶子页面初始化 - 设置页面的基本属性和计算最大容量
  * 这里需要精确计算能放多少个key-value对，给分裂操作留点空间
@@ -27,6 +89,15 @@ void BPlusTreeLeafPage<KeyType, ValueType>::Init(page_id_t page_id,
     SetPageId(page_id);
     SetParentPageId(parent_id);
     SetSize(0);
+    next_page_id_ = INVALID_PAGE_ID;
+
+    if constexpr (PREFIX_COMPRESSED) {
+        // 空页面还没有公共前缀
+        PrefixHeader header{PREFIX_LEAF_PAGE_FORMAT, 0};
+        std::memcpy(data_, &header, sizeof(header));
+        SetMaxSize(CapacityFor(0));
+        return;
+    }
 
     // 计算页面能容纳多少个key-value对
     // header占用的空间 = BPlusTreePage基类大小 + next_page_id_字段
@@ -40,8 +111,35 @@ void BPlusTreeLeafPage<KeyType, ValueType>::Init(page_id_t page_id,
     // 实际设置时要保守一点，为分裂操作预留1个元素的空间
     // 这样可以提高空间利用率，同时确保分裂时有足够空间
     SetMaxSize(std::max(16, theoretical_max - 1));
+}
 
-    next_page_id_ = INVALID_PAGE_ID;
+static_assert(sizeof(BPlusTreePage) ==
+                  BPlusTreePage::CHECKSUM_OFFSET + sizeof(uint32_t),
+              "B+ tree page checksum must be the last header field");
+
+/**
+ * 取得B+树页面并核对校验值
+ * 损坏的页面和取不到的页面一样返回nullptr，调用者原有的错误处理不用改
+ */
+Page* BPlusTreePage::FetchTreePage(BufferPoolManager* buffer_pool_manager,
+                                   page_id_t page_id) {
+    Page* page = buffer_pool_manager->FetchPage(page_id);
+    if (page != nullptr && !page->VerifyChecksum(CHECKSUM_OFFSET)) {
+        LOG_ERROR("Checksum mismatch on B+ tree page " << page_id);
+        buffer_pool_manager->UnpinPage(page_id, false);
+        return nullptr;
+    }
+    return page;
+}
+
+Page* BPlusTreePage::NewTreePage(BufferPoolManager* buffer_pool_manager,
+                                 page_id_t* page_id,
+                                 ExtentReservation* extent) {
+    Page* page = buffer_pool_manager->NewPage(page_id, extent);
+    if (page != nullptr) {
+        page->SetChecksumOffset(CHECKSUM_OFFSET);
+    }
+    return page;
 }
 
 /**
@@ -80,6 +178,19 @@ KeyType BPlusTreeLeafPage<KeyType, ValueType>::KeyAt(int index) const {
         throw std::out_of_range("Index out of range");
     }
 
+    if constexpr (PREFIX_COMPRESSED) {
+        // 公共前缀 + 槽位里的后缀拼回完整的编码，再还原成键
+        size_t prefix_length = PrefixLength();
+        const char* entry = EntryAt(index);
+        uint16_t suffix_length;
+        std::memcpy(&suffix_length, entry, sizeof(suffix_length));
+        uint8_t bytes[Codec::MAX_BYTES];
+        std::memcpy(bytes, PrefixBytes(), prefix_length);
+        std::memcpy(bytes + prefix_length, entry + sizeof(uint16_t),
+                    suffix_length);
+        return Codec::Decode(bytes, prefix_length + suffix_length);
+    }
+
     // 直接计算内存offset，每个entry就是一个key+value的连续存储
     char* data_ptr = const_cast<char*>(data_);
     size_t offset = index * (sizeof(KeyType) + sizeof(ValueType));
@@ -95,6 +206,15 @@ ValueType BPlusTreeLeafPage<KeyType, ValueType>::ValueAt(int index) const {
         throw std::out_of_range("Index out of range");
     }
 
+    if constexpr (PREFIX_COMPRESSED) {
+        ValueType value;
+        std::memcpy(&value,
+                    EntryAt(index) + sizeof(uint16_t) + Codec::MAX_BYTES -
+                        PrefixLength(),
+                    sizeof(ValueType));
+        return value;
+    }
+
     // value在key后面，所以offset要加上key的大小
     char* data_ptr = const_cast<char*>(data_);
     size_t offset =
@@ -112,6 +232,25 @@ void BPlusTreeLeafPage<KeyType, ValueType>::SetKeyAt(int index,
         throw std::out_of_range("Index out of range");
     }
 
+    if constexpr (PREFIX_COMPRESSED) {
+        // 只写后缀，键必须带着页面的公共前缀
+        uint8_t bytes[Codec::MAX_BYTES];
+        size_t length = Codec::Encode(key, bytes);
+        size_t prefix_length = PrefixLength();
+        if (length < prefix_length ||
+            std::memcmp(bytes, PrefixBytes(), prefix_length) != 0) {
+            throw std::invalid_argument("Key does not share the page prefix");
+        }
+        char* entry = EntryAt(index);
+        uint16_t suffix_length = static_cast<uint16_t>(length - prefix_length);
+        std::memcpy(entry, &suffix_length, sizeof(suffix_length));
+        std::memcpy(entry + sizeof(uint16_t), bytes + prefix_length,
+                    suffix_length);
+        std::memset(entry + sizeof(uint16_t) + suffix_length, 0,
+                    Codec::MAX_BYTES - length);
+        return;
+    }
+
     size_t offset = index * (sizeof(KeyType) + sizeof(ValueType));
     *reinterpret_cast<KeyType*>(data_ + offset) = key;
 }
@@ -126,6 +265,13 @@ void BPlusTreeLeafPage<KeyType, ValueType>::SetValueAt(int index,
         throw std::out_of_range("Index out of range");
     }
 
+    if constexpr (PREFIX_COMPRESSED) {
+        std::memcpy(EntryAt(index) + sizeof(uint16_t) + Codec::MAX_BYTES -
+                        PrefixLength(),
+                    &value, sizeof(ValueType));
+        return;
+    }
+
     size_t offset =
         index * (sizeof(KeyType) + sizeof(ValueType)) + sizeof(KeyType);
     *reinterpret_cast<ValueType*>(data_ + offset) = value;
@@ -137,26 +283,24 @@ void BPlusTreeLeafPage<KeyType, ValueType>::SetValueAt(int index,
  */
 template <typename KeyType, typename ValueType>
 int BPlusTreeLeafPage<KeyType, ValueType>::KeyIndex(const KeyType& key) const {
-    if (GetSize() == 0) {
-        return 0;  // 空页面直接返回0
-    }
-
-    // 标准的lower_bound二分查找逻辑
-    // 找到第一个不小于key的位置
-    int left = 0, right = GetSize();
-
-    while (left < right) {
-        int mid = left + (right - left) / 2;
-        KeyType mid_key = KeyAt(mid);
-
-        if (mid_key < key) {
-            left = mid + 1;  // key在右半部分
-        } else {
-            right = mid;  // key在左半部分（包括mid）
+    if constexpr (PREFIX_COMPRESSED) {
+        // 槽位里只有后缀，逐个还原出完整的键再比较
+        int left = 0;
+        int right = GetSize();
+        while (left < right) {
+            int mid = left + (right - left) / 2;
+            if (KeyAt(mid) < key) {
+                left = mid + 1;
+            } else {
+                right = mid;
+            }
         }
+        return left;
     }
 
-    return left;  // 返回应该插入的位置
+    // lower_bound：找到第一个不小于key的位置，也就是应该插入的位置
+    return SearchKeys(data_, sizeof(KeyType) + sizeof(ValueType), GetSize(),
+                      key, false);
 }
 
 /**
@@ -181,26 +325,11 @@ int BPlusTreeInternalPage<KeyType>::KeyIndex(const KeyType& key) const {
         return 0;
     }
 
-    try {
-        // 在内部页面中，key[i]是第i个和第i+1个子节点的分割点
-        // 如果search_key < key[i]，那么应该走第i-1个子节点
-        for (int i = 1; i <= size; i++) {
-            if (i > GetMaxSize()) {
-                LOG_ERROR("BPlusTreeInternalPage::KeyIndex: Index "
-                          << i << " exceeds max size " << GetMaxSize());
-                return 0;
-            }
-            if (key < KeyAt(i)) {
-                return i - 1;  // 走第i-1个子节点
-            }
-        }
-    } catch (const std::exception& e) {
-        LOG_ERROR("BPlusTreeInternalPage::KeyIndex: Exception at size "
-                  << size << ": " << e.what());
-        return 0;
-    }
-
-    return size;  // 如果key比所有分割键都大，走最后一个子节点
+    // 在内部页面中，key[i]是第i个和第i+1个子节点的分割点
+    // 应该走的子节点下标 = 不大于search_key的分割键个数，
+    // 也就是在key[1..size]上做upper_bound
+    return SearchKeys(data_ + sizeof(page_id_t),
+                      sizeof(KeyType) + sizeof(page_id_t), size, key, true);
 }
 
 /**
@@ -210,6 +339,34 @@ int BPlusTreeInternalPage<KeyType>::KeyIndex(const KeyType& key) const {
 template <typename KeyType, typename ValueType>
 bool BPlusTreeLeafPage<KeyType, ValueType>::Insert(const KeyType& key,
                                                    const ValueType& value) {
+    if constexpr (PREFIX_COMPRESSED) {
+        int insert_index = KeyIndex(key);
+        if (insert_index < GetSize() && KeyAt(insert_index) == key) {
+            SetValueAt(insert_index, value);
+            return true;
+        }
+        if (!HasRoomFor(key)) {
+            return false;
+        }
+        if (SharedPrefixLength(key) < PrefixLength()) {
+            // 新键不带当前的公共前缀：缩短前缀，整个页面重排
+            std::vector<std::pair<KeyType, ValueType>> entries;
+            CollectEntries(&entries);
+            entries.insert(entries.begin() + insert_index, {key, value});
+            return Assign(entries.data(), static_cast<int>(entries.size()));
+        }
+        size_t entry_size = EntrySize(PrefixLength());
+        int move_count = GetSize() - insert_index;
+        if (move_count > 0) {
+            std::memmove(EntryAt(insert_index + 1), EntryAt(insert_index),
+                         move_count * entry_size);
+        }
+        SetKeyAt(insert_index, key);
+        SetValueAt(insert_index, value);
+        IncreaseSize(1);
+        return true;
+    }
+
     // 先检查页面是否已满，满了就不能插入了，需要调用者处理分裂
     if (GetSize() >= GetMaxSize()) {
         return false;
@@ -257,12 +414,20 @@ bool BPlusTreeLeafPage<KeyType, ValueType>::Delete(const KeyType& key) {
     }
 
     // 把后面的数据往前移动，覆盖要删除的数据
-    size_t pair_size = sizeof(KeyType) + sizeof(ValueType);
     int move_count = GetSize() - delete_index - 1;
-    if (move_count > 0) {
-        std::memmove(data_ + delete_index * pair_size,
-                     data_ + (delete_index + 1) * pair_size,
-                     move_count * pair_size);
+    if constexpr (PREFIX_COMPRESSED) {
+        // 删除不会破坏公共前缀，前缀保持不变
+        if (move_count > 0) {
+            std::memmove(EntryAt(delete_index), EntryAt(delete_index + 1),
+                         move_count * EntrySize(PrefixLength()));
+        }
+    } else {
+        size_t pair_size = sizeof(KeyType) + sizeof(ValueType);
+        if (move_count > 0) {
+            std::memmove(data_ + delete_index * pair_size,
+                         data_ + (delete_index + 1) * pair_size,
+                         move_count * pair_size);
+        }
     }
 
     // 更新size，确保不会变成负数
@@ -290,6 +455,15 @@ void BPlusTreeLeafPage<KeyType, ValueType>::MoveHalfTo(
         return;  // 没有数据需要移动
     }
 
+    if constexpr (PREFIX_COMPRESSED) {
+        // 两半各自重新计算公共前缀
+        std::vector<std::pair<KeyType, ValueType>> entries;
+        CollectEntries(&entries);
+        recipient->Assign(entries.data() + split_point, move_size);
+        Assign(entries.data(), split_point);
+        return;
+    }
+
     // 直接内存拷贝，效率比较高
     size_t pair_size = sizeof(KeyType) + sizeof(ValueType);
     size_t move_bytes = move_size * pair_size;
@@ -311,6 +485,22 @@ void BPlusTreeLeafPage<KeyType, ValueType>::MoveHalfTo(
 template <typename KeyType, typename ValueType>
 void BPlusTreeLeafPage<KeyType, ValueType>::MoveAllTo(
     BPlusTreeLeafPage* recipient) {
+    if constexpr (PREFIX_COMPRESSED) {
+        // 合并后的公共前缀可能变短，接收页面整体重排
+        // 调用者已经用CanMergeWith确认放得下
+        std::vector<std::pair<KeyType, ValueType>> entries;
+        recipient->CollectEntries(&entries);
+        CollectEntries(&entries);
+        if (!recipient->Assign(entries.data(),
+                               static_cast<int>(entries.size()))) {
+            LOG_ERROR("BPlusTreeLeafPage::MoveAllTo: recipient page "
+                      << recipient->GetPageId() << " cannot hold "
+                      << entries.size() << " entries");
+        }
+        SetSize(0);
+        return;
+    }
+
     size_t pair_size = sizeof(KeyType) + sizeof(ValueType);
     size_t move_bytes = GetSize() * pair_size;
 
@@ -355,6 +545,12 @@ void BPlusTreeLeafPage<KeyType, ValueType>::MoveLastToFrontOf(
     // 先减少当前页面的大小
     IncreaseSize(-1);
 
+    if constexpr (PREFIX_COMPRESSED) {
+        // key比目标页面的所有键都小，插入后就在最前面
+        recipient->Insert(key, value);
+        return;
+    }
+
     // 在目标页面前面插入数据，需要把原有数据往后移
     size_t pair_size = sizeof(KeyType) + sizeof(ValueType);
     std::memmove(recipient->data_ + pair_size, recipient->data_,
@@ -364,6 +560,173 @@ void BPlusTreeLeafPage<KeyType, ValueType>::MoveLastToFrontOf(
     recipient->IncreaseSize(1);
 }
 
+/**
+ * 用有序的键值对重写整个页面
+ * 实现思路：
+ * 1. 前缀压缩页面先算出所有键编码后的公共前缀，
+ *    容量由前缀长度决定，放不下直接返回false
+ * 2. 写入新的前缀和容量，再逐个写入后缀和value
+ * 3. 定长布局的页面直接按顺序写入
+ */
+template <typename KeyType, typename ValueType>
+bool BPlusTreeLeafPage<KeyType, ValueType>::Assign(
+    const std::pair<KeyType, ValueType>* entries, int count) {
+    if constexpr (PREFIX_COMPRESSED) {
+        uint8_t first[Codec::MAX_BYTES];
+        size_t prefix_length = 0;
+        if (count > 0) {
+            prefix_length = Codec::Encode(entries[0].first, first);
+            uint8_t bytes[Codec::MAX_BYTES];
+            for (int i = 1; i < count && prefix_length > 0; i++) {
+                size_t length = Codec::Encode(entries[i].first, bytes);
+                prefix_length =
+                    CommonPrefix(first, prefix_length, bytes, length);
+            }
+        }
+        if (count > CapacityFor(prefix_length)) {
+            return false;
+        }
+        PrefixHeader header{PREFIX_LEAF_PAGE_FORMAT,
+                            static_cast<uint16_t>(prefix_length)};
+        std::memcpy(data_, &header, sizeof(header));
+        std::memcpy(data_ + sizeof(header), first, prefix_length);
+        SetMaxSize(CapacityFor(prefix_length));
+    } else if (count > GetMaxSize()) {
+        return false;
+    }
+
+    SetSize(count);
+    for (int i = 0; i < count; i++) {
+        SetKeyAt(i, entries[i].first);
+        SetValueAt(i, entries[i].second);
+    }
+    return true;
+}
+
+/**
+ * 判断再插入一个新的key是否放得下
+ * 前缀压缩页面要按插入后的公共前缀重新算容量
+ */
+template <typename KeyType, typename ValueType>
+bool BPlusTreeLeafPage<KeyType, ValueType>::HasRoomFor(
+    const KeyType& key) const {
+    if constexpr (PREFIX_COMPRESSED) {
+        if (GetSize() == 0) {
+            return true;
+        }
+        return GetSize() + 1 <= CapacityFor(SharedPrefixLength(key));
+    } else {
+        (void)key;
+        return GetSize() < GetMaxSize();
+    }
+}
+
+/**
+ * 判断other的元素全部合并进来后是否放得下
+ * 两个页面公共前缀的公共部分，是合并后所有键都带着的前缀
+ */
+template <typename KeyType, typename ValueType>
+bool BPlusTreeLeafPage<KeyType, ValueType>::CanMergeWith(
+    const BPlusTreeLeafPage* other) const {
+    if constexpr (PREFIX_COMPRESSED) {
+        size_t prefix_length;
+        if (GetSize() == 0) {
+            prefix_length = other->PrefixLength();
+        } else if (other->GetSize() == 0) {
+            prefix_length = PrefixLength();
+        } else {
+            prefix_length =
+                CommonPrefix(PrefixBytes(), PrefixLength(),
+                             other->PrefixBytes(), other->PrefixLength());
+        }
+        return GetSize() + other->GetSize() < CapacityFor(prefix_length);
+    } else {
+        return GetSize() + other->GetSize() < GetMaxSize();
+    }
+}
+
+template <typename KeyType, typename ValueType>
+size_t BPlusTreeLeafPage<KeyType, ValueType>::PrefixLength() const {
+    PrefixHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    return header.prefix_length;
+}
+
+template <typename KeyType, typename ValueType>
+const uint8_t* BPlusTreeLeafPage<KeyType, ValueType>::PrefixBytes() const {
+    return reinterpret_cast<const uint8_t*>(data_ + sizeof(PrefixHeader));
+}
+
+template <typename KeyType, typename ValueType>
+const char* BPlusTreeLeafPage<KeyType, ValueType>::EntryAt(int index) const {
+    size_t prefix_length = PrefixLength();
+    return data_ + sizeof(PrefixHeader) + prefix_length +
+           index * EntrySize(prefix_length);
+}
+
+template <typename KeyType, typename ValueType>
+char* BPlusTreeLeafPage<KeyType, ValueType>::EntryAt(int index) {
+    return const_cast<char*>(
+        static_cast<const BPlusTreeLeafPage*>(this)->EntryAt(index));
+}
+
+/** key编码后和页面公共前缀相同的字节数 */
+template <typename KeyType, typename ValueType>
+size_t BPlusTreeLeafPage<KeyType, ValueType>::SharedPrefixLength(
+    const KeyType& key) const {
+    if constexpr (PREFIX_COMPRESSED) {
+        uint8_t bytes[Codec::MAX_BYTES];
+        size_t length = Codec::Encode(key, bytes);
+        return CommonPrefix(PrefixBytes(), PrefixLength(), bytes, length);
+    } else {
+        (void)key;
+        return 0;
+    }
+}
+
+template <typename KeyType, typename ValueType>
+void BPlusTreeLeafPage<KeyType, ValueType>::CollectEntries(
+    std::vector<std::pair<KeyType, ValueType>>* out) const {
+    for (int i = 0; i < GetSize(); i++) {
+        out->emplace_back(KeyAt(i), ValueAt(i));
+    }
+}
+
+/** 前缀压缩页面一个槽位的字节数：后缀长度 + 后缀 + value */
+template <typename KeyType, typename ValueType>
+size_t BPlusTreeLeafPage<KeyType, ValueType>::EntrySize(
+    size_t prefix_length) {
+    return sizeof(uint16_t) + (Codec::MAX_BYTES - prefix_length) +
+           sizeof(ValueType);
+}
+
+/**
+ * 前缀长度为prefix_length时页面的容量
+ * 和Init一样预留一个元素；不超过不压缩时容量的两倍减一，
+ * 满页分裂出的每一半都不超过不压缩时的容量，在任何前缀下都放得下
+ */
+template <typename KeyType, typename ValueType>
+int BPlusTreeLeafPage<KeyType, ValueType>::CapacityFor(size_t prefix_length) {
+    size_t space = PAGE_SIZE - sizeof(BPlusTreePage) - sizeof(page_id_t) -
+                   sizeof(PrefixHeader);
+    int plain = std::max(16, static_cast<int>(space / EntrySize(0)) - 1);
+    int compressed =
+        static_cast<int>((space - prefix_length) / EntrySize(prefix_length)) -
+        1;
+    return std::max(plain, std::min(compressed, 2 * plain - 1));
+}
+
+template <typename KeyType, typename ValueType>
+size_t BPlusTreeLeafPage<KeyType, ValueType>::CommonPrefix(
+    const uint8_t* a, size_t a_length, const uint8_t* b, size_t b_length) {
+    size_t limit = std::min(a_length, b_length);
+    size_t length = 0;
+    while (length < limit && a[length] == b[length]) {
+        length++;
+    }
+    return length;
+}
+
 /**
  * 内部页面初始化 - 和叶子页面类似，但布局不同
  * 内部页面布局：[value0] [key1] [value1] [key2] [value2] ... [keyN] [valueN]
@@ -576,7 +939,8 @@ void BPlusTreeInternalPage<KeyType>::MoveHalfTo(
     for (int i = 0; i <= move_count; i++) {
         page_id_t child_page_id = recipient->ValueAt(i);
         if (child_page_id != INVALID_PAGE_ID) {
-            Page* child_page = buffer_pool_manager->FetchPage(child_page_id);
+            Page* child_page =
+                FetchTreePage(buffer_pool_manager, child_page_id);
             if (child_page) {
                 auto* child_tree_page =
                     reinterpret_cast<BPlusTreePage*>(child_page->GetData());
@@ -615,7 +979,8 @@ void BPlusTreeInternalPage<KeyType>::MoveAllTo(
     for (int i = 0; i <= GetSize(); i++) {
         page_id_t child_page_id = ValueAt(i);
         if (child_page_id != INVALID_PAGE_ID) {
-            Page* child_page = buffer_pool_manager->FetchPage(child_page_id);
+            Page* child_page =
+                FetchTreePage(buffer_pool_manager, child_page_id);
             if (child_page) {
                 auto* child_tree_page =
                     reinterpret_cast<BPlusTreePage*>(child_page->GetData());
@@ -648,7 +1013,7 @@ void BPlusTreeInternalPage<KeyType>::MoveFirstToEndOf(
 
     // 更新子页面的父指针
     if (first_child != INVALID_PAGE_ID) {
-        Page* child_page = buffer_pool_manager->FetchPage(first_child);
+        Page* child_page = FetchTreePage(buffer_pool_manager, first_child);
         if (child_page) {
             auto* child_tree_page =
                 reinterpret_cast<BPlusTreePage*>(child_page->GetData());
@@ -691,7 +1056,7 @@ void BPlusTreeInternalPage<KeyType>::MoveLastToFrontOf(
 
     // 更新子页面的父指针
     if (last_child != INVALID_PAGE_ID) {
-        Page* child_page = buffer_pool_manager->FetchPage(last_child);
+        Page* child_page = FetchTreePage(buffer_pool_manager, last_child);
         if (child_page) {
             auto* child_tree_page =
                 reinterpret_cast<BPlusTreePage*>(child_page->GetData());
@@ -717,4 +1082,52 @@ template class BPlusTreeInternalPage<float>;
 template class BPlusTreeInternalPage<double>;
 template class BPlusTreeInternalPage<std::string>;
 
+// 非唯一索引的复合键
+template class BPlusTreeLeafPage<NonUniqueKey<int32_t>, RID>;
+template class BPlusTreeLeafPage<NonUniqueKey<int64_t>, RID>;
+template class BPlusTreeLeafPage<NonUniqueKey<float>, RID>;
+template class BPlusTreeLeafPage<NonUniqueKey<double>, RID>;
+template class BPlusTreeLeafPage<NonUniqueKey<std::string>, RID>;
+template class BPlusTreeInternalPage<NonUniqueKey<int32_t>>;
+template class BPlusTreeInternalPage<NonUniqueKey<int64_t>>;
+template class BPlusTreeInternalPage<NonUniqueKey<float>>;
+template class BPlusTreeInternalPage<NonUniqueKey<double>>;
+template class BPlusTreeInternalPage<NonUniqueKey<std::string>>;
+
+// 多列索引的定长键
+template class BPlusTreeLeafPage<GenericKey<8>, RID>;
+template class BPlusTreeLeafPage<GenericKey<16>, RID>;
+template class BPlusTreeLeafPage<GenericKey<32>, RID>;
+template class BPlusTreeLeafPage<GenericKey<64>, RID>;
+template class BPlusTreeInternalPage<GenericKey<8>>;
+template class BPlusTreeInternalPage<GenericKey<16>>;
+template class BPlusTreeInternalPage<GenericKey<32>>;
+template class BPlusTreeInternalPage<GenericKey<64>>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<8>>, RID>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<16>>, RID>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<32>>, RID>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<64>>, RID>;
+template class BPlusTreeInternalPage<NonUniqueKey<GenericKey<8>>>;
+template class BPlusTreeInternalPage<NonUniqueKey<GenericKey<16>>>;
+template class BPlusTreeInternalPage<NonUniqueKey<GenericKey<32>>>;
+template class BPlusTreeInternalPage<NonUniqueKey<GenericKey<64>>>;
+
+// VARCHAR索引的内联字符串键
+template class BPlusTreeLeafPage<InlineStringKey<16>, RID>;
+template class BPlusTreeLeafPage<InlineStringKey<32>, RID>;
+template class BPlusTreeLeafPage<InlineStringKey<64>, RID>;
+template class BPlusTreeLeafPage<InlineStringKey<128>, RID>;
+template class BPlusTreeInternalPage<InlineStringKey<16>>;
+template class BPlusTreeInternalPage<InlineStringKey<32>>;
+template class BPlusTreeInternalPage<InlineStringKey<64>>;
+template class BPlusTreeInternalPage<InlineStringKey<128>>;
+template class BPlusTreeLeafPage<NonUniqueKey<InlineStringKey<16>>, RID>;
+template class BPlusTreeLeafPage<NonUniqueKey<InlineStringKey<32>>, RID>;
+template class BPlusTreeLeafPage<NonUniqueKey<InlineStringKey<64>>, RID>;
+template class BPlusTreeLeafPage<NonUniqueKey<InlineStringKey<128>>, RID>;
+template class BPlusTreeInternalPage<NonUniqueKey<InlineStringKey<16>>>;
+template class BPlusTreeInternalPage<NonUniqueKey<InlineStringKey<32>>>;
+template class BPlusTreeInternalPage<NonUniqueKey<InlineStringKey<64>>>;
+template class BPlusTreeInternalPage<NonUniqueKey<InlineStringKey<128>>>;
+
 }  // namespace SimpleRDBMS
\ No newline at end of file
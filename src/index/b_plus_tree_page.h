@@ -7,18 +7,23 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cstring>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "common/types.h"
+#include "index/prefix_key_codec.h"
 #include "storage/page.h"
 
 namespace SimpleRDBMS {
 
 // 前向声明
 class BufferPoolManager;
+struct ExtentReservation;
 
 /**
  * 索引页面类型枚举 - 用来区分是叶子页面还是内部页面
@@ -29,6 +34,12 @@ enum class IndexPageType {
     INTERNAL_PAGE  // 内部页面，存储路由信息
 };
 
+/**
+ * 前缀压缩叶子页面的格式版本，写在页面数据区的开头
+ * 键类型不支持前缀压缩的叶子页面保持原来的定长布局，没有这个字段
+ */
+static constexpr uint16_t PREFIX_LEAF_PAGE_FORMAT = 1;
+
 /**
  * B+树页面基类 - 所有B+树页面的公共属性和操作
  *
@@ -64,12 +75,32 @@ class BPlusTreePage {
     page_id_t GetPageId() const { return page_id_; }
     void SetPageId(page_id_t page_id) { page_id_ = page_id; }
 
+    /** 校验值字段在页面里的偏移，紧跟在page_id_后面 */
+    static constexpr size_t CHECKSUM_OFFSET =
+        sizeof(IndexPageType) + 2 * sizeof(int) + 2 * sizeof(page_id_t);
+
+    /**
+     * 取得B+树页面并核对从磁盘读入后的校验值
+     * 修改页面之前必须核对过，否则写盘时不会更新校验值
+     * @return 取不到页面或者校验值不对时返回nullptr，校验值不对的页面已经unpin
+     */
+    static Page* FetchTreePage(BufferPoolManager* buffer_pool_manager,
+                               page_id_t page_id);
+
+    /**
+     * 分配一个B+树页面，写盘时带上校验值
+     * @param extent 从这个区段分配，为nullptr时按普通页面分配
+     */
+    static Page* NewTreePage(BufferPoolManager* buffer_pool_manager,
+                             page_id_t* page_id, ExtentReservation* extent);
+
    protected:
     IndexPageType page_type_;   // 页面类型（叶子或内部）
     int size_;                  // 当前存储的元素数量
     int max_size_;              // 最大容量
     page_id_t parent_page_id_;  // 父页面ID
     page_id_t page_id_;         // 当前页面ID
+    uint32_t checksum_;         // 整个页面的CRC32C，写盘时由磁盘管理器填写
 };
 
 /**
@@ -82,6 +113,16 @@ class BPlusTreePage {
  * - 叶子页面之间通过next_page_id形成链表，方便范围查询
  * - 使用flexible array member (data_[0])来存储变长数据
  * - 键值对按key排序存储，支持二分查找
+ *
+ * 前缀压缩布局（PrefixKeyCodec<KeyType>::ENABLED时使用）：
+ * [header] [format,prefix_len] [prefix] [len1,suffix1,value1] ...
+ * - 页面里所有键编码后的公共前缀只存一份，每个槽位只放剩下的后缀，
+ *   槽位宽度 = 最长编码 - 前缀长度，前缀越长一页放下的键越多
+ * - 插入不带这个前缀的键时缩短前缀、重排整个页面；
+ *   容量随前缀变化，所以调用者要用HasRoomFor/CanMergeWith判断空间，
+ *   而不是直接比较GetSize和GetMaxSize
+ * - 容量最多是不压缩时的两倍减一，这样满页分裂出的两半、
+ *   欠满页借来的一个元素在任何前缀下都放得下
  */
 template <typename KeyType, typename ValueType>
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -108,6 +149,18 @@ class BPlusTreeLeafPage : public BPlusTreePage {
     bool Insert(const KeyType& key, const ValueType& value);  // 插入键值对
     bool Delete(const KeyType& key);                          // 删除指定key
 
+    /**
+     * 用有序的键值对重写整个页面，前缀压缩页面会重新计算公共前缀
+     * @return 放不下时返回false，页面内容不变
+     */
+    bool Assign(const std::pair<KeyType, ValueType>* entries, int count);
+
+    /** 再插入一个新的key是否还放得下 */
+    bool HasRoomFor(const KeyType& key) const;
+
+    /** 把other的所有元素合并进来之后是否还放得下 */
+    bool CanMergeWith(const BPlusTreeLeafPage* other) const;
+
     // 分裂合并操作 - 当页面满了或太空时需要这些操作
     void MoveHalfTo(BPlusTreeLeafPage* recipient);  // 分裂时移动一半数据
     void MoveAllTo(BPlusTreeLeafPage* recipient);   // 合并时移动所有数据
@@ -121,6 +174,27 @@ class BPlusTreeLeafPage : public BPlusTreePage {
     void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
    private:
+    using Codec = PrefixKeyCodec<KeyType>;
+    static constexpr bool PREFIX_COMPRESSED = Codec::ENABLED;
+
+    /** 前缀压缩页面数据区开头的格式信息 */
+    struct PrefixHeader {
+        uint16_t format;         // PREFIX_LEAF_PAGE_FORMAT
+        uint16_t prefix_length;  // 公共前缀的字节数
+    };
+
+    // 前缀压缩布局的辅助函数
+    size_t PrefixLength() const;
+    const uint8_t* PrefixBytes() const;
+    const char* EntryAt(int index) const;
+    char* EntryAt(int index);
+    size_t SharedPrefixLength(const KeyType& key) const;
+    void CollectEntries(std::vector<std::pair<KeyType, ValueType>>* out) const;
+    static size_t EntrySize(size_t prefix_length);
+    static int CapacityFor(size_t prefix_length);
+    static size_t CommonPrefix(const uint8_t* a, size_t a_length,
+                               const uint8_t* b, size_t b_length);
+
     page_id_t next_page_id_;  // 指向下一个叶子页面，形成链表
     // 灵活数组成员 - 实际的key-value对存储在这里
     // 这是C的一个特性，允许结构体最后一个成员是大小为0的数组
@@ -0,0 +1,240 @@
+/*
+ * 文件: bulk_load_sorter.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: B+树批量构建外部排序器实现
+ */
+
+#include "index/bulk_load_sorter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+#include <string>
+
+#include "common/debug.h"
+#include "common/types.h"
+#include "index/generic_key.h"
+#include "index/inline_string_key.h"
+#include "index/non_unique_key.h"
+
+namespace SimpleRDBMS {
+
+template <typename KeyType, typename ValueType>
+BulkLoadSorter<KeyType, ValueType>::BulkLoadSorter(size_t memory_limit)
+    : max_buffer_entries_(std::max<size_t>(memory_limit / sizeof(Entry), 1)) {}
+
+template <typename KeyType, typename ValueType>
+BulkLoadSorter<KeyType, ValueType>::~BulkLoadSorter() {
+    for (std::FILE* run : runs_) {
+        std::fclose(run);
+    }
+    if (merged_ != nullptr) {
+        std::fclose(merged_);
+    }
+}
+
+template <typename KeyType, typename ValueType>
+void BulkLoadSorter<KeyType, ValueType>::Add(const KeyType& key,
+                                             const ValueType& value) {
+    buffer_.emplace_back(key, value);
+    if constexpr (CAN_SPILL) {
+        if (buffer_.size() >= max_buffer_entries_ && !failed_) {
+            failed_ = !SpillRun();
+        }
+    }
+}
+
+template <typename KeyType, typename ValueType>
+void BulkLoadSorter<KeyType, ValueType>::SortAndDedup() {
+    std::stable_sort(
+        buffer_.begin(), buffer_.end(),
+        [](const Entry& a, const Entry& b) { return a.first < b.first; });
+
+    // 相同的键相邻，只留每组的最后一个
+    size_t out = 0;
+    for (size_t i = 0; i < buffer_.size(); i++) {
+        if (i + 1 < buffer_.size() && !(buffer_[i].first < buffer_[i + 1].first)) {
+            continue;
+        }
+        if (out != i) {
+            buffer_[out] = std::move(buffer_[i]);
+        }
+        out++;
+    }
+    buffer_.resize(out);
+}
+
+template <typename KeyType, typename ValueType>
+bool BulkLoadSorter<KeyType, ValueType>::SpillRun() {
+    SortAndDedup();
+    std::FILE* run = std::tmpfile();
+    if (run == nullptr) {
+        LOG_ERROR("BulkLoadSorter: cannot create temporary run file");
+        return false;
+    }
+    runs_.push_back(run);
+    for (const auto& entry : buffer_) {
+        if (!WriteEntry(run, entry)) {
+            LOG_ERROR("BulkLoadSorter: failed to write run " << runs_.size());
+            return false;
+        }
+    }
+    std::rewind(run);
+    buffer_.clear();
+    return true;
+}
+
+/**
+ * 完成排序
+ * 实现思路：
+ * 1. 没有溢出过：内存里排序去重，Next直接读缓冲区
+ * 2. 溢出过：剩下的缓冲区也写成一个段，然后归并所有段
+ */
+template <typename KeyType, typename ValueType>
+bool BulkLoadSorter<KeyType, ValueType>::Finish() {
+    if (failed_) {
+        return false;
+    }
+    if (runs_.empty()) {
+        SortAndDedup();
+        count_ = buffer_.size();
+        read_pos_ = 0;
+        return true;
+    }
+    if (!buffer_.empty() && !SpillRun()) {
+        return false;
+    }
+    return MergeRuns();
+}
+
+/**
+ * 多路归并
+ * 实现思路：
+ * 1. 每个段取出第一条放进小顶堆，堆顶是最小的键
+ * 2. 弹出堆顶后把所有相同键的条目一起弹出，保留段号最大的那个：
+ *    段号越大加入得越晚，和段内去重保留最后一个是同样的规则
+ * 3. 每弹出一条就从它所在的段补一条
+ */
+template <typename KeyType, typename ValueType>
+bool BulkLoadSorter<KeyType, ValueType>::MergeRuns() {
+    merged_ = std::tmpfile();
+    if (merged_ == nullptr) {
+        LOG_ERROR("BulkLoadSorter: cannot create temporary merge file");
+        return false;
+    }
+
+    using HeapItem = std::pair<Entry, size_t>;
+    auto greater = [](const HeapItem& a, const HeapItem& b) {
+        return b.first.first < a.first.first;
+    };
+    std::priority_queue<HeapItem, std::vector<HeapItem>, decltype(greater)>
+        heap(greater);
+    for (size_t i = 0; i < runs_.size(); i++) {
+        Entry entry;
+        if (ReadEntry(runs_[i], &entry)) {
+            heap.emplace(std::move(entry), i);
+        }
+    }
+
+    auto advance = [this, &heap](size_t run) {
+        Entry entry;
+        if (ReadEntry(runs_[run], &entry)) {
+            heap.emplace(std::move(entry), run);
+        }
+    };
+
+    count_ = 0;
+    while (!heap.empty()) {
+        HeapItem current = heap.top();
+        heap.pop();
+        advance(current.second);
+        while (!heap.empty() &&
+               !(current.first.first < heap.top().first.first)) {
+            HeapItem duplicate = heap.top();
+            heap.pop();
+            advance(duplicate.second);
+            if (duplicate.second > current.second) {
+                current = std::move(duplicate);
+            }
+        }
+        if (!WriteEntry(merged_, current.first)) {
+            LOG_ERROR("BulkLoadSorter: failed to write merged output");
+            return false;
+        }
+        count_++;
+    }
+
+    LOG_DEBUG("BulkLoadSorter: merged " << runs_.size() << " runs into "
+                                        << count_ << " entries");
+    std::rewind(merged_);
+    return true;
+}
+
+template <typename KeyType, typename ValueType>
+bool BulkLoadSorter<KeyType, ValueType>::Next(Entry* entry) {
+    if (merged_ != nullptr) {
+        return ReadEntry(merged_, entry);
+    }
+    if (read_pos_ >= buffer_.size()) {
+        return false;
+    }
+    *entry = buffer_[read_pos_++];
+    return true;
+}
+
+template <typename KeyType, typename ValueType>
+bool BulkLoadSorter<KeyType, ValueType>::WriteEntry(std::FILE* file,
+                                                    const Entry& entry) {
+    if constexpr (CAN_SPILL) {
+        return std::fwrite(&entry.first, sizeof(KeyType), 1, file) == 1 &&
+               std::fwrite(&entry.second, sizeof(ValueType), 1, file) == 1;
+    } else {
+        (void)file;
+        (void)entry;
+        return false;
+    }
+}
+
+template <typename KeyType, typename ValueType>
+bool BulkLoadSorter<KeyType, ValueType>::ReadEntry(std::FILE* file,
+                                                   Entry* entry) {
+    if constexpr (CAN_SPILL) {
+        return std::fread(&entry->first, sizeof(KeyType), 1, file) == 1 &&
+               std::fread(&entry->second, sizeof(ValueType), 1, file) == 1;
+    } else {
+        (void)file;
+        (void)entry;
+        return false;
+    }
+}
+
+// 和BPlusTree支持的键类型一致
+template class BulkLoadSorter<int32_t, RID>;
+template class BulkLoadSorter<int64_t, RID>;
+template class BulkLoadSorter<float, RID>;
+template class BulkLoadSorter<double, RID>;
+template class BulkLoadSorter<std::string, RID>;
+template class BulkLoadSorter<NonUniqueKey<int32_t>, RID>;
+template class BulkLoadSorter<NonUniqueKey<int64_t>, RID>;
+template class BulkLoadSorter<NonUniqueKey<float>, RID>;
+template class BulkLoadSorter<NonUniqueKey<double>, RID>;
+template class BulkLoadSorter<NonUniqueKey<std::string>, RID>;
+template class BulkLoadSorter<GenericKey<8>, RID>;
+template class BulkLoadSorter<GenericKey<16>, RID>;
+template class BulkLoadSorter<GenericKey<32>, RID>;
+template class BulkLoadSorter<GenericKey<64>, RID>;
+template class BulkLoadSorter<NonUniqueKey<GenericKey<8>>, RID>;
+template class BulkLoadSorter<NonUniqueKey<GenericKey<16>>, RID>;
+template class BulkLoadSorter<NonUniqueKey<GenericKey<32>>, RID>;
+template class BulkLoadSorter<NonUniqueKey<GenericKey<64>>, RID>;
+template class BulkLoadSorter<InlineStringKey<16>, RID>;
+template class BulkLoadSorter<InlineStringKey<32>, RID>;
+template class BulkLoadSorter<InlineStringKey<64>, RID>;
+template class BulkLoadSorter<InlineStringKey<128>, RID>;
+template class BulkLoadSorter<NonUniqueKey<InlineStringKey<16>>, RID>;
+template class BulkLoadSorter<NonUniqueKey<InlineStringKey<32>>, RID>;
+template class BulkLoadSorter<NonUniqueKey<InlineStringKey<64>>, RID>;
+template class BulkLoadSorter<NonUniqueKey<InlineStringKey<128>>, RID>;
+
+}  // namespace SimpleRDBMS
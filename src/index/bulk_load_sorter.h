@@ -0,0 +1,95 @@
+/*
+ * 文件: bulk_load_sorter.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: B+树批量构建使用的外部排序器，内存放不下时把有序段写到临时文件再归并
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace SimpleRDBMS {
+
+/**
+ * BulkLoadSorter - 批量构建索引前的排序
+ *
+ * 设计思路：
+ * - 键值对先攒在内存缓冲区里，缓冲区满了就排序、去重后写成一个有序段
+ *   （临时文件，进程退出时自动删除）
+ * - Finish时把所有段做一次多路归并，结果写进一个新的临时文件，
+ *   同时得到去重后的准确个数，批量构建需要先知道总数才能均匀分配页面
+ * - 没有发生溢出时直接在内存里排序，不读写文件
+ * - 重复的键只保留最后加入的那个，和逐条Insert时后插入覆盖前面的一致
+ * - std::string这类不能按字节写文件的键不溢出，内存上限对它们不生效
+ *
+ * 用法：Add ... Add -> Finish -> Next ... Next
+ */
+template <typename KeyType, typename ValueType>
+class BulkLoadSorter {
+   public:
+    using Entry = std::pair<KeyType, ValueType>;
+
+    /**
+     * 构造函数
+     * @param memory_limit 缓冲区最多占用的字节数
+     */
+    explicit BulkLoadSorter(size_t memory_limit);
+
+    ~BulkLoadSorter();
+
+    BulkLoadSorter(const BulkLoadSorter&) = delete;
+    BulkLoadSorter& operator=(const BulkLoadSorter&) = delete;
+
+    /** 加入一个键值对，必须在Finish之前调用 */
+    void Add(const KeyType& key, const ValueType& value);
+
+    /**
+     * 排序并去重，之后才能调用Next
+     * @return 临时文件读写失败时返回false
+     */
+    bool Finish();
+
+    /** 去重后的键值对个数，Finish之后有效 */
+    size_t GetCount() const { return count_; }
+
+    /** 写到临时文件的有序段数，0表示全部在内存中排序 */
+    size_t GetRunCount() const { return runs_.size(); }
+
+    /**
+     * 按键递增的顺序取出下一个键值对
+     * @return 已经取完时返回false
+     */
+    bool Next(Entry* entry);
+
+   private:
+    /** 键和值都能按字节写进文件时才溢出 */
+    static constexpr bool CAN_SPILL = std::is_trivially_copyable_v<KeyType> &&
+                                      std::is_trivially_copyable_v<ValueType>;
+
+    /** 缓冲区按键稳定排序，相同的键只留最后一个 */
+    void SortAndDedup();
+
+    /** 把排好序的缓冲区写成一个有序段 */
+    bool SpillRun();
+
+    /** 归并所有有序段，写进merged_ */
+    bool MergeRuns();
+
+    static bool WriteEntry(std::FILE* file, const Entry& entry);
+    static bool ReadEntry(std::FILE* file, Entry* entry);
+
+    size_t max_buffer_entries_;
+    std::vector<Entry> buffer_;
+    std::vector<std::FILE*> runs_;
+    std::FILE* merged_ = nullptr;
+    size_t count_ = 0;
+    size_t read_pos_ = 0;  // 没有溢出时在buffer_中的读取位置
+    bool failed_ = false;
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,532 @@
+/*
+ * 文件: extendible_hash_table.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 可扩展哈希索引的实现，包括插入时的桶分裂、删除时的合并和目录伸缩
+ */
+
+#include "index/extendible_hash_table.h"
+
+#include <mutex>
+
+#include "common/debug.h"
+#include "index/generic_key.h"
+#include "index/hash_function.h"
+#include "index/inline_string_key.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * 构造函数
+ * 实现思路：已有目录页面时先读一遍，确认是目录页面再使用，
+ * 否则当作空表，和BPlusTree处理读不出来的根页面一样
+ */
+template <typename KeyType, typename ValueType>
+ExtendibleHashTable<KeyType, ValueType>::ExtendibleHashTable(
+    const std::string& name, BufferPoolManager* buffer_pool_manager,
+    page_id_t directory_page_id, bool unique)
+    : index_name_(name),
+      buffer_pool_manager_(buffer_pool_manager),
+      directory_page_id_(INVALID_PAGE_ID),
+      unique_(unique) {
+    if (directory_page_id == INVALID_PAGE_ID) {
+        return;
+    }
+    Page* page = buffer_pool_manager_->FetchPage(directory_page_id);
+    if (page == nullptr) {
+        LOG_WARN("ExtendibleHashTable: Cannot read directory page "
+                 << directory_page_id << " of index " << index_name_);
+        return;
+    }
+    auto* directory =
+        reinterpret_cast<HashTableDirectoryPage*>(page->GetData());
+    if (directory->IsValid() && directory->GetPageId() == directory_page_id) {
+        directory_page_id_ = directory_page_id;
+    } else {
+        LOG_WARN("ExtendibleHashTable: Page " << directory_page_id
+                                              << " is not a hash directory");
+    }
+    buffer_pool_manager_->UnpinPage(directory_page_id, false);
+}
+
+/**
+ * 插入键值对
+ * 实现思路：
+ * 1. 哈希值的低位在目录里选出桶，沿桶链表找相同的键：
+ *    唯一模式覆盖值，非唯一模式遇到相同的 (键, 值) 直接返回
+ * 2. 链表里有空位就写进去
+ * 3. 没有空位时，局部深度还没到最大就分裂桶，然后重新选桶再试；
+ *    已经到最大深度就在链表末尾挂一个溢出页面
+ */
+template <typename KeyType, typename ValueType>
+bool ExtendibleHashTable<KeyType, ValueType>::Insert(const KeyType& key,
+                                                     const ValueType& value) {
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    if (!EnsureDirectory()) {
+        return false;
+    }
+
+    uint32_t hash = HashFunction<KeyType>::Hash(key);
+    while (true) {
+        Page* directory_page =
+            buffer_pool_manager_->FetchPage(directory_page_id_);
+        if (directory_page == nullptr) {
+            return false;
+        }
+        auto* directory = reinterpret_cast<HashTableDirectoryPage*>(
+            directory_page->GetData());
+        uint32_t index = directory->IndexOf(hash);
+
+        page_id_t room_page_id = INVALID_PAGE_ID;
+        page_id_t tail_page_id = INVALID_PAGE_ID;
+        page_id_t page_id = directory->GetBucketPageId(index);
+        while (page_id != INVALID_PAGE_ID) {
+            Page* page = buffer_pool_manager_->FetchPage(page_id);
+            if (page == nullptr) {
+                buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+                return false;
+            }
+            auto* bucket = reinterpret_cast<BucketPage*>(page->GetData());
+            for (int i = bucket->Find(key); i >= 0;
+                 i = bucket->Find(key, i + 1)) {
+                if (unique_ || bucket->ValueAt(i) == value) {
+                    bucket->SetValueAt(i, value);
+                    buffer_pool_manager_->UnpinPage(page_id, true);
+                    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+                    return true;
+                }
+            }
+            if (room_page_id == INVALID_PAGE_ID && !bucket->IsFull()) {
+                room_page_id = page_id;
+            }
+            tail_page_id = page_id;
+            page_id_t next_page_id = bucket->GetOverflowPageId();
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            page_id = next_page_id;
+        }
+
+        if (room_page_id != INVALID_PAGE_ID ||
+            directory->GetLocalDepth(index) >=
+                HashTableDirectoryPage::MAX_DEPTH) {
+            page_id_t target = room_page_id != INVALID_PAGE_ID ? room_page_id
+                                                               : tail_page_id;
+            Page* page = buffer_pool_manager_->FetchPage(target);
+            bool success = false;
+            if (page != nullptr) {
+                auto* bucket = reinterpret_cast<BucketPage*>(page->GetData());
+                success = bucket->Append(key, value) ||
+                          AppendOverflow(bucket, key, value);
+                buffer_pool_manager_->UnpinPage(target, true);
+            }
+            buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+            return success;
+        }
+
+        bool split = SplitBucket(directory, index);
+        buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+        if (!split) {
+            return false;
+        }
+    }
+}
+
+/**
+ * 删除键的所有项，删除后尝试合并桶
+ */
+template <typename KeyType, typename ValueType>
+bool ExtendibleHashTable<KeyType, ValueType>::Remove(const KeyType& key) {
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    if (directory_page_id_ == INVALID_PAGE_ID) {
+        return false;
+    }
+    Page* directory_page = buffer_pool_manager_->FetchPage(directory_page_id_);
+    if (directory_page == nullptr) {
+        return false;
+    }
+    auto* directory =
+        reinterpret_cast<HashTableDirectoryPage*>(directory_page->GetData());
+    uint32_t index = directory->IndexOf(HashFunction<KeyType>::Hash(key));
+    bool removed =
+        RemoveMatching(directory->GetBucketPageId(index), key, nullptr);
+    if (removed) {
+        MergeBuckets(directory, index);
+    }
+    buffer_pool_manager_->UnpinPage(directory_page_id_, removed);
+    return removed;
+}
+
+/**
+ * 删除 (key, value) 这一项，删除后尝试合并桶
+ */
+template <typename KeyType, typename ValueType>
+bool ExtendibleHashTable<KeyType, ValueType>::Remove(const KeyType& key,
+                                                     const ValueType& value) {
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    if (directory_page_id_ == INVALID_PAGE_ID) {
+        return false;
+    }
+    Page* directory_page = buffer_pool_manager_->FetchPage(directory_page_id_);
+    if (directory_page == nullptr) {
+        return false;
+    }
+    auto* directory =
+        reinterpret_cast<HashTableDirectoryPage*>(directory_page->GetData());
+    uint32_t index = directory->IndexOf(HashFunction<KeyType>::Hash(key));
+    bool removed =
+        RemoveMatching(directory->GetBucketPageId(index), key, &value);
+    if (removed) {
+        MergeBuckets(directory, index);
+    }
+    buffer_pool_manager_->UnpinPage(directory_page_id_, removed);
+    return removed;
+}
+
+/**
+ * 查找键对应的所有值
+ * 实现思路：读目录选出桶，沿桶链表收集所有相等的键，
+ * 只固定目录和当前桶两个页面
+ */
+template <typename KeyType, typename ValueType>
+bool ExtendibleHashTable<KeyType, ValueType>::GetValue(
+    const KeyType& key, std::vector<ValueType>* values) {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    if (directory_page_id_ == INVALID_PAGE_ID) {
+        return false;
+    }
+    Page* directory_page = buffer_pool_manager_->FetchPage(directory_page_id_);
+    if (directory_page == nullptr) {
+        return false;
+    }
+    auto* directory =
+        reinterpret_cast<HashTableDirectoryPage*>(directory_page->GetData());
+    page_id_t page_id = directory->GetBucketPageId(
+        directory->IndexOf(HashFunction<KeyType>::Hash(key)));
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+    bool found = false;
+    while (page_id != INVALID_PAGE_ID) {
+        Page* page = buffer_pool_manager_->FetchPage(page_id);
+        if (page == nullptr) {
+            break;
+        }
+        auto* bucket = reinterpret_cast<BucketPage*>(page->GetData());
+        for (int i = bucket->Find(key); i >= 0; i = bucket->Find(key, i + 1)) {
+            values->push_back(bucket->ValueAt(i));
+            found = true;
+        }
+        page_id_t next_page_id = bucket->GetOverflowPageId();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        if (found && unique_) {
+            break;
+        }
+        page_id = next_page_id;
+    }
+    return found;
+}
+
+template <typename KeyType, typename ValueType>
+bool ExtendibleHashTable<KeyType, ValueType>::GetValue(const KeyType& key,
+                                                       ValueType* value) {
+    std::vector<ValueType> values;
+    if (!GetValue(key, &values)) {
+        return false;
+    }
+    *value = values.front();
+    return true;
+}
+
+template <typename KeyType, typename ValueType>
+page_id_t ExtendibleHashTable<KeyType, ValueType>::GetDirectoryPageId() {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    return directory_page_id_;
+}
+
+template <typename KeyType, typename ValueType>
+uint32_t ExtendibleHashTable<KeyType, ValueType>::GetGlobalDepth() {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    if (directory_page_id_ == INVALID_PAGE_ID) {
+        return 0;
+    }
+    Page* page = buffer_pool_manager_->FetchPage(directory_page_id_);
+    if (page == nullptr) {
+        return 0;
+    }
+    uint32_t depth =
+        reinterpret_cast<HashTableDirectoryPage*>(page->GetData())
+            ->GetGlobalDepth();
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+    return depth;
+}
+
+/**
+ * 创建目录页面和第一个桶，全局深度为0
+ * 目录页面ID通过回调写回catalog
+ */
+template <typename KeyType, typename ValueType>
+bool ExtendibleHashTable<KeyType, ValueType>::EnsureDirectory() {
+    if (directory_page_id_ != INVALID_PAGE_ID) {
+        return true;
+    }
+
+    page_id_t bucket_page_id;
+    Page* bucket_page = buffer_pool_manager_->NewPage(&bucket_page_id);
+    if (bucket_page == nullptr) {
+        LOG_ERROR("ExtendibleHashTable: Cannot allocate bucket page for index "
+                  << index_name_);
+        return false;
+    }
+    reinterpret_cast<BucketPage*>(bucket_page->GetData())->Init(bucket_page_id);
+
+    page_id_t directory_page_id;
+    Page* directory_page = buffer_pool_manager_->NewPage(&directory_page_id);
+    if (directory_page == nullptr) {
+        LOG_ERROR("ExtendibleHashTable: Cannot allocate directory page for "
+                  "index "
+                  << index_name_);
+        buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+        buffer_pool_manager_->DeletePage(bucket_page_id);
+        return false;
+    }
+    reinterpret_cast<HashTableDirectoryPage*>(directory_page->GetData())
+        ->Init(directory_page_id, bucket_page_id);
+
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    buffer_pool_manager_->UnpinPage(directory_page_id, true);
+    directory_page_id_ = directory_page_id;
+    if (root_change_callback_) {
+        root_change_callback_(directory_page_id_);
+    }
+    return true;
+}
+
+/**
+ * 分裂桶
+ * 实现思路：
+ * 1. 局部深度等于全局深度时先把目录扩大一倍
+ * 2. 分配新桶，原来指向旧桶的槽位里第local_depth位为1的改指新桶，
+ *    这些槽位的局部深度都加一
+ * 3. 旧桶里哈希值第local_depth位为1的项搬到新桶
+ */
+template <typename KeyType, typename ValueType>
+bool ExtendibleHashTable<KeyType, ValueType>::SplitBucket(
+    HashTableDirectoryPage* directory, uint32_t index) {
+    uint32_t local_depth = directory->GetLocalDepth(index);
+    if (local_depth == directory->GetGlobalDepth()) {
+        if (!directory->CanGrow()) {
+            return false;
+        }
+        directory->IncrGlobalDepth();
+    }
+
+    page_id_t old_page_id = directory->GetBucketPageId(index);
+    Page* old_page = buffer_pool_manager_->FetchPage(old_page_id);
+    if (old_page == nullptr) {
+        return false;
+    }
+    page_id_t new_page_id;
+    Page* new_page = buffer_pool_manager_->NewPage(&new_page_id);
+    if (new_page == nullptr) {
+        LOG_ERROR("ExtendibleHashTable: Cannot allocate bucket page for index "
+                  << index_name_);
+        buffer_pool_manager_->UnpinPage(old_page_id, false);
+        return false;
+    }
+    auto* old_bucket = reinterpret_cast<BucketPage*>(old_page->GetData());
+    auto* new_bucket = reinterpret_cast<BucketPage*>(new_page->GetData());
+    new_bucket->Init(new_page_id);
+
+    uint32_t split_bit = 1u << local_depth;
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+        if (directory->GetBucketPageId(i) == old_page_id) {
+            directory->SetLocalDepth(i, local_depth + 1);
+            if ((i & split_bit) != 0) {
+                directory->SetBucketPageId(i, new_page_id);
+            }
+        }
+    }
+
+    for (int i = 0; i < old_bucket->GetSize();) {
+        KeyType key = old_bucket->KeyAt(i);
+        if ((HashFunction<KeyType>::Hash(key) & split_bit) != 0) {
+            new_bucket->Append(key, old_bucket->ValueAt(i));
+            old_bucket->RemoveAt(i);
+        } else {
+            i++;
+        }
+    }
+
+    LOG_DEBUG("ExtendibleHashTable: Split bucket "
+              << old_page_id << " of index " << index_name_ << " into "
+              << new_page_id << " at depth " << local_depth + 1);
+    buffer_pool_manager_->UnpinPage(old_page_id, true);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    return true;
+}
+
+/**
+ * 合并桶
+ * 实现思路：
+ * 1. 桶和分裂镜像的局部深度相同、都没有溢出页面、
+ *    加起来不超过半页时，把镜像里的项搬过来，释放镜像页面
+ * 2. 半页的余量避免在分裂阈值附近反复分裂合并
+ * 3. 合并后局部深度减一，可以继续和更上一层的镜像合并
+ * 4. 最后只要所有桶的局部深度都小于全局深度，目录就减半
+ */
+template <typename KeyType, typename ValueType>
+void ExtendibleHashTable<KeyType, ValueType>::MergeBuckets(
+    HashTableDirectoryPage* directory, uint32_t index) {
+    while (directory->GetLocalDepth(index) > 0) {
+        uint32_t local_depth = directory->GetLocalDepth(index);
+        uint32_t image = directory->GetSplitImageIndex(index);
+        page_id_t page_id = directory->GetBucketPageId(index);
+        page_id_t image_page_id = directory->GetBucketPageId(image);
+        if (directory->GetLocalDepth(image) != local_depth ||
+            page_id == image_page_id) {
+            break;
+        }
+
+        Page* page = buffer_pool_manager_->FetchPage(page_id);
+        if (page == nullptr) {
+            break;
+        }
+        Page* image_page = buffer_pool_manager_->FetchPage(image_page_id);
+        if (image_page == nullptr) {
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            break;
+        }
+        auto* bucket = reinterpret_cast<BucketPage*>(page->GetData());
+        auto* image_bucket =
+            reinterpret_cast<BucketPage*>(image_page->GetData());
+        if (bucket->GetOverflowPageId() != INVALID_PAGE_ID ||
+            image_bucket->GetOverflowPageId() != INVALID_PAGE_ID ||
+            bucket->GetSize() + image_bucket->GetSize() >
+                BucketPage::MAX_ENTRIES / 2) {
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            buffer_pool_manager_->UnpinPage(image_page_id, false);
+            break;
+        }
+
+        for (int i = 0; i < image_bucket->GetSize(); i++) {
+            bucket->Append(image_bucket->KeyAt(i), image_bucket->ValueAt(i));
+        }
+        buffer_pool_manager_->UnpinPage(page_id, true);
+        buffer_pool_manager_->UnpinPage(image_page_id, false);
+        buffer_pool_manager_->DeletePage(image_page_id);
+
+        for (uint32_t i = 0; i < directory->Size(); i++) {
+            page_id_t slot_page_id = directory->GetBucketPageId(i);
+            if (slot_page_id == page_id || slot_page_id == image_page_id) {
+                directory->SetBucketPageId(i, page_id);
+                directory->SetLocalDepth(i, local_depth - 1);
+            }
+        }
+        LOG_DEBUG("ExtendibleHashTable: Merged bucket "
+                  << image_page_id << " into " << page_id << " of index "
+                  << index_name_);
+    }
+
+    while (directory->CanShrink()) {
+        directory->DecrGlobalDepth();
+    }
+}
+
+/**
+ * 挂溢出页面
+ * 只有到达最大深度的桶才会走到这里，tail是桶链表的最后一个页面
+ */
+template <typename KeyType, typename ValueType>
+bool ExtendibleHashTable<KeyType, ValueType>::AppendOverflow(
+    BucketPage* tail, const KeyType& key, const ValueType& value) {
+    page_id_t page_id;
+    Page* page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+        LOG_ERROR("ExtendibleHashTable: Cannot allocate overflow page for "
+                  "index "
+                  << index_name_);
+        return false;
+    }
+    auto* bucket = reinterpret_cast<BucketPage*>(page->GetData());
+    bucket->Init(page_id);
+    bucket->Append(key, value);
+    tail->SetOverflowPageId(page_id);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return true;
+}
+
+/**
+ * 删除桶链表里键等于key（value不为空时值也要相等）的项
+ * 实现思路：
+ * 1. 沿链表逐页删除，前一个页面一直固定着，方便摘掉删空的溢出页面
+ * 2. 第一个页面是目录指向的桶本身，删空了也保留
+ * 3. 指定了value时 (键, 值) 最多只有一项，找到就停
+ */
+template <typename KeyType, typename ValueType>
+bool ExtendibleHashTable<KeyType, ValueType>::RemoveMatching(
+    page_id_t bucket_page_id, const KeyType& key, const ValueType* value) {
+    bool removed = false;
+    page_id_t prev_page_id = INVALID_PAGE_ID;
+    BucketPage* prev_bucket = nullptr;
+    bool prev_dirty = false;
+
+    page_id_t page_id = bucket_page_id;
+    while (page_id != INVALID_PAGE_ID) {
+        Page* page = buffer_pool_manager_->FetchPage(page_id);
+        if (page == nullptr) {
+            break;
+        }
+        auto* bucket = reinterpret_cast<BucketPage*>(page->GetData());
+        bool dirty = false;
+        for (int i = 0; i < bucket->GetSize();) {
+            if (!(bucket->KeyAt(i) == key) ||
+                (value != nullptr && !(bucket->ValueAt(i) == *value))) {
+                i++;
+                continue;
+            }
+            bucket->RemoveAt(i);
+            dirty = true;
+            removed = true;
+            if (value != nullptr) {
+                break;
+            }
+        }
+        page_id_t next_page_id = bucket->GetOverflowPageId();
+
+        if (prev_bucket != nullptr && bucket->IsEmpty()) {
+            prev_bucket->SetOverflowPageId(next_page_id);
+            prev_dirty = true;
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            buffer_pool_manager_->DeletePage(page_id);
+        } else {
+            if (prev_bucket != nullptr) {
+                buffer_pool_manager_->UnpinPage(prev_page_id, prev_dirty);
+            }
+            prev_page_id = page_id;
+            prev_bucket = bucket;
+            prev_dirty = dirty;
+        }
+        if (removed && value != nullptr) {
+            break;
+        }
+        page_id = next_page_id;
+    }
+    if (prev_bucket != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev_page_id, prev_dirty);
+    }
+    return removed;
+}
+
+// 显式实例化，和IndexManager支持的哈希索引键类型一致
+template class ExtendibleHashTable<int32_t, RID>;
+template class ExtendibleHashTable<int64_t, RID>;
+template class ExtendibleHashTable<float, RID>;
+template class ExtendibleHashTable<double, RID>;
+template class ExtendibleHashTable<InlineStringKey<16>, RID>;
+template class ExtendibleHashTable<InlineStringKey<32>, RID>;
+template class ExtendibleHashTable<InlineStringKey<64>, RID>;
+template class ExtendibleHashTable<InlineStringKey<128>, RID>;
+template class ExtendibleHashTable<GenericKey<8>, RID>;
+template class ExtendibleHashTable<GenericKey<16>, RID>;
+template class ExtendibleHashTable<GenericKey<32>, RID>;
+template class ExtendibleHashTable<GenericKey<64>, RID>;
+
+}  // namespace SimpleRDBMS
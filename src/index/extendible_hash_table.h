@@ -0,0 +1,131 @@
+/*
+ * 文件: extendible_hash_table.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 可扩展哈希索引，只支持等值查找，目录和桶页面都放在缓冲池里
+ */
+
+#pragma once
+
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/hash_table_page.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * 可扩展哈希表
+ *
+ * 设计思路：
+ * 1. 一个目录页面加若干桶页面，等值查找只读目录和一个桶，
+ *    不需要像B+树那样从根一层层找到叶子
+ * 2. 桶满了就按哈希值的下一位分裂成两个，只有局部深度等于全局深度时
+ *    目录才扩大一倍；目录到达最大深度后，满了的桶挂溢出页面
+ * 3. 删除后桶和它的分裂镜像加起来不到半页时合并回去，
+ *    所有桶的局部深度都小于全局深度时目录减半
+ * 4. 唯一模式下同一个键只保留一项，再次插入会覆盖值（和BPlusTree::Insert一致）；
+ *    非唯一模式下同一个键可以有多项，(键, 值) 完全相同的只保留一项
+ * 5. 线程安全：查找之间并发执行，插入和删除独占整个哈希表
+ *
+ * @tparam KeyType 键的类型，必须能按值拷贝进页面，哈希由HashFunction提供
+ * @tparam ValueType 值的类型，通常是RID
+ */
+template <typename KeyType, typename ValueType>
+class ExtendibleHashTable {
+   public:
+    /**
+     * 打开或者新建哈希表
+     * @param name 索引名称，用于日志
+     * @param buffer_pool_manager 缓冲池管理器
+     * @param directory_page_id 已有目录页面（来自catalog），
+     *                          INVALID_PAGE_ID表示新建空表，
+     *                          第一次插入时才分配页面
+     * @param unique 是否唯一模式
+     *
+     * 目录页面读不出来或者内容不是目录时当作空表
+     */
+    ExtendibleHashTable(const std::string& name,
+                        BufferPoolManager* buffer_pool_manager,
+                        page_id_t directory_page_id = INVALID_PAGE_ID,
+                        bool unique = true);
+
+    ExtendibleHashTable(const ExtendibleHashTable&) = delete;
+    ExtendibleHashTable& operator=(const ExtendibleHashTable&) = delete;
+
+    /**
+     * 插入键值对
+     * @return 成功返回true；缓冲池分配不到页面时返回false
+     */
+    bool Insert(const KeyType& key, const ValueType& value);
+
+    /**
+     * 删除键的所有项
+     * @return 至少删除了一项返回true
+     */
+    bool Remove(const KeyType& key);
+
+    /**
+     * 删除 (key, value) 这一项
+     * @return 找到并删除返回true
+     */
+    bool Remove(const KeyType& key, const ValueType& value);
+
+    /**
+     * 查找键对应的值
+     * @param values 输出参数，追加所有匹配的值，顺序不确定
+     * @return 至少找到一项返回true
+     */
+    bool GetValue(const KeyType& key, std::vector<ValueType>* values);
+
+    /**
+     * 查找键对应的一个值，唯一模式下就是唯一的那一项
+     */
+    bool GetValue(const KeyType& key, ValueType* value);
+
+    /** 目录页面ID，空表为INVALID_PAGE_ID */
+    page_id_t GetDirectoryPageId();
+
+    /** 当前全局深度，空表为0 */
+    uint32_t GetGlobalDepth();
+
+    /**
+     * 设置目录页面变化时的回调
+     * 目录在第一次插入时创建，之后页面ID不再变化
+     */
+    void SetRootChangeCallback(std::function<void(page_id_t)> callback) {
+        root_change_callback_ = std::move(callback);
+    }
+
+   private:
+    using BucketPage = HashTableBucketPage<KeyType, ValueType>;
+
+    /** 第一次插入时创建目录和第一个桶 */
+    bool EnsureDirectory();
+
+    /** 把目录里index槽位指向的桶分裂成两个，调用者持有写锁 */
+    bool SplitBucket(HashTableDirectoryPage* directory, uint32_t index);
+
+    /** 尝试把index槽位的桶和分裂镜像合并，然后尽量缩小目录 */
+    void MergeBuckets(HashTableDirectoryPage* directory, uint32_t index);
+
+    /** 在桶页面链表末尾挂一个溢出页面并写入键值对 */
+    bool AppendOverflow(BucketPage* tail, const KeyType& key,
+                        const ValueType& value);
+
+    /** 删除桶链表里符合条件的项，删空的溢出页面从链表上摘掉 */
+    bool RemoveMatching(page_id_t bucket_page_id, const KeyType& key,
+                        const ValueType* value);
+
+    std::string index_name_;
+    BufferPoolManager* buffer_pool_manager_;
+    page_id_t directory_page_id_;
+    bool unique_;
+    std::shared_mutex latch_;
+    std::function<void(page_id_t)> root_change_callback_;
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,164 @@
+/*
+ * 文件: generic_key.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 多列索引使用的定长B+树键，把多个列编码成可以直接memcmp比较的字节串
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace SimpleRDBMS {
+
+/**
+ * GenericKey - 定长的多列索引键
+ *
+ * 设计思路：
+ * - 每一列按声明顺序编码成固定宽度的字节，拼在一起，剩余部分补0
+ * - 编码保持顺序：两个键按字节memcmp的结果和逐列比较原始值的结果一致，
+ *   所以B+树不需要知道键里有哪些列
+ * - 大小在编译期确定（8/16/32/64字节），可以直接按值存进B+树页面
+ *
+ * @tparam KeySize 键的字节数
+ */
+template <size_t KeySize>
+struct GenericKey {
+    static constexpr size_t SIZE = KeySize;
+
+    uint8_t data[KeySize] = {};
+
+    bool operator<(const GenericKey& other) const {
+        return std::memcmp(data, other.data, KeySize) < 0;
+    }
+
+    bool operator==(const GenericKey& other) const {
+        return std::memcmp(data, other.data, KeySize) == 0;
+    }
+
+    bool operator!=(const GenericKey& other) const {
+        return !(*this == other);
+    }
+};
+
+/** 日志输出，按十六进制打印 */
+template <size_t KeySize>
+std::ostream& operator<<(std::ostream& os, const GenericKey<KeySize>& key) {
+    std::ios_base::fmtflags flags = os.flags();
+    os << std::hex << std::setfill('0');
+    for (size_t i = 0; i < KeySize; i++) {
+        os << std::setw(2) << static_cast<int>(key.data[i]);
+    }
+    os.flags(flags);
+    return os;
+}
+
+/**
+ * GenericKeyEncoder - 把单个列值编码成保持顺序的字节
+ *
+ * 编码规则：
+ * - 有符号整数：翻转符号位后按大端序写出，负数排在正数前面
+ * - 浮点数：正数翻转符号位，负数翻转所有位，-0.0 先规整成 0.0
+ * - 字符串：截断或补0到列宽，短字符串是长字符串的前缀时排在前面
+ *
+ * Decode*是对应的逆过程，覆盖索引从索引项直接取出列值时使用；
+ * 字符串解码去掉末尾补的0，长度等于列宽时可能被截断过
+ */
+class GenericKeyEncoder {
+   public:
+    static void EncodeInt32(int32_t value, uint8_t* out) {
+        WriteBigEndian(static_cast<uint32_t>(value) ^ 0x80000000u, out);
+    }
+
+    static void EncodeInt64(int64_t value, uint8_t* out) {
+        WriteBigEndian(static_cast<uint64_t>(value) ^ 0x8000000000000000ull,
+                       out);
+    }
+
+    static void EncodeFloat(float value, uint8_t* out) {
+        if (value == 0.0f) {
+            value = 0.0f;
+        }
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        WriteBigEndian(bits, out);
+    }
+
+    static void EncodeDouble(double value, uint8_t* out) {
+        if (value == 0.0) {
+            value = 0.0;
+        }
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits = (bits & 0x8000000000000000ull) ? ~bits
+                                              : (bits | 0x8000000000000000ull);
+        WriteBigEndian(bits, out);
+    }
+
+    static void EncodeString(std::string_view value, uint8_t* out,
+                             size_t width) {
+        size_t length = value.size() < width ? value.size() : width;
+        std::memcpy(out, value.data(), length);
+        std::memset(out + length, 0, width - length);
+    }
+
+    static int32_t DecodeInt32(const uint8_t* in) {
+        return static_cast<int32_t>(ReadBigEndian<uint32_t>(in) ^
+                                    0x80000000u);
+    }
+
+    static int64_t DecodeInt64(const uint8_t* in) {
+        return static_cast<int64_t>(ReadBigEndian<uint64_t>(in) ^
+                                    0x8000000000000000ull);
+    }
+
+    static float DecodeFloat(const uint8_t* in) {
+        uint32_t bits = ReadBigEndian<uint32_t>(in);
+        bits = (bits & 0x80000000u) ? (bits & ~0x80000000u) : ~bits;
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    static double DecodeDouble(const uint8_t* in) {
+        uint64_t bits = ReadBigEndian<uint64_t>(in);
+        bits = (bits & 0x8000000000000000ull) ? (bits & ~0x8000000000000000ull)
+                                              : ~bits;
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    static std::string DecodeString(const uint8_t* in, size_t width) {
+        size_t length = width;
+        while (length > 0 && in[length - 1] == 0) {
+            length--;
+        }
+        return std::string(reinterpret_cast<const char*>(in), length);
+    }
+
+   private:
+    template <typename UInt>
+    static void WriteBigEndian(UInt value, uint8_t* out) {
+        for (size_t i = 0; i < sizeof(UInt); i++) {
+            out[i] = static_cast<uint8_t>(value >> (8 * (sizeof(UInt) - 1 - i)));
+        }
+    }
+
+    template <typename UInt>
+    static UInt ReadBigEndian(const uint8_t* in) {
+        UInt value = 0;
+        for (size_t i = 0; i < sizeof(UInt); i++) {
+            value = static_cast<UInt>((value << 8) | in[i]);
+        }
+        return value;
+    }
+};
+
+}  // namespace SimpleRDBMS
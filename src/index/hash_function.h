@@ -0,0 +1,75 @@
+/*
+ * 文件: hash_function.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 哈希索引使用的键哈希函数，相等的键一定得到相同的哈希值
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "index/generic_key.h"
+#include "index/inline_string_key.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * HashFunction - 把索引键映射成32位哈希值
+ *
+ * 设计思路：
+ * - 按键的有效字节做FNV-1a，再用murmur3的收尾步骤打散，
+ *   可扩展哈希按低位选桶，低位必须分布均匀
+ * - 相等的键字节也必须相同：浮点数的-0.0和0.0先规整，
+ *   内联字符串只哈希length之内的字符
+ * - 只支持能按值放进页面的键类型，std::string不在其中
+ */
+template <typename KeyType>
+struct HashFunction {
+    static_assert(std::is_arithmetic<KeyType>::value,
+                  "unsupported hash index key type");
+
+    static uint32_t Hash(const KeyType& key) {
+        KeyType normalized = key;
+        if constexpr (std::is_floating_point<KeyType>::value) {
+            if (normalized == 0) {
+                normalized = 0;
+            }
+        }
+        return HashBytes(&normalized, sizeof(normalized));
+    }
+
+    /** 对一段字节求哈希 */
+    static uint32_t HashBytes(const void* data, size_t length) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ull;
+        hash ^= hash >> 33;
+        return static_cast<uint32_t>(hash);
+    }
+};
+
+template <size_t Capacity>
+struct HashFunction<InlineStringKey<Capacity>> {
+    static uint32_t Hash(const InlineStringKey<Capacity>& key) {
+        return HashFunction<uint8_t>::HashBytes(key.data, key.length);
+    }
+};
+
+template <size_t KeySize>
+struct HashFunction<GenericKey<KeySize>> {
+    static uint32_t Hash(const GenericKey<KeySize>& key) {
+        return HashFunction<uint8_t>::HashBytes(key.data, KeySize);
+    }
+};
+
+}  // namespace SimpleRDBMS
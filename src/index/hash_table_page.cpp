@@ -0,0 +1,133 @@
+/*
+ * 文件: hash_table_page.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 可扩展哈希索引页面的实现，包含目录页面和桶页面的操作
+ */
+
+#include "index/hash_table_page.h"
+
+#include "index/generic_key.h"
+#include "index/inline_string_key.h"
+
+namespace SimpleRDBMS {
+
+// ============================================================================
+// HashTableDirectoryPage 实现
+// ============================================================================
+
+void HashTableDirectoryPage::Init(page_id_t page_id, page_id_t first_bucket) {
+    magic_ = DIRECTORY_MAGIC;
+    page_id_ = page_id;
+    global_depth_ = 0;
+    std::memset(local_depths_, 0, sizeof(local_depths_));
+    for (uint32_t i = 0; i < MAX_SIZE; i++) {
+        bucket_page_ids_[i] = INVALID_PAGE_ID;
+    }
+    bucket_page_ids_[0] = first_bucket;
+}
+
+/**
+ * 目录扩大一倍
+ * 新增的槽位i + old_size和槽位i指向同一个桶，局部深度也相同，
+ * 这样扩大前后每个哈希值找到的桶不变
+ */
+void HashTableDirectoryPage::IncrGlobalDepth() {
+    uint32_t old_size = Size();
+    for (uint32_t i = 0; i < old_size; i++) {
+        bucket_page_ids_[i + old_size] = bucket_page_ids_[i];
+        local_depths_[i + old_size] = local_depths_[i];
+    }
+    global_depth_++;
+}
+
+bool HashTableDirectoryPage::CanShrink() const {
+    if (global_depth_ == 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < Size(); i++) {
+        if (local_depths_[i] >= global_depth_) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// HashTableBucketPage 实现
+// ============================================================================
+
+template <typename KeyType, typename ValueType>
+void HashTableBucketPage<KeyType, ValueType>::Init(page_id_t page_id) {
+    page_id_ = page_id;
+    overflow_page_id_ = INVALID_PAGE_ID;
+    size_ = 0;
+}
+
+template <typename KeyType, typename ValueType>
+KeyType HashTableBucketPage<KeyType, ValueType>::KeyAt(int index) const {
+    KeyType key;
+    std::memcpy(&key, EntryAt(index), sizeof(KeyType));
+    return key;
+}
+
+template <typename KeyType, typename ValueType>
+ValueType HashTableBucketPage<KeyType, ValueType>::ValueAt(int index) const {
+    ValueType value;
+    std::memcpy(&value, EntryAt(index) + sizeof(KeyType), sizeof(ValueType));
+    return value;
+}
+
+template <typename KeyType, typename ValueType>
+void HashTableBucketPage<KeyType, ValueType>::SetValueAt(
+    int index, const ValueType& value) {
+    std::memcpy(EntryAt(index) + sizeof(KeyType), &value, sizeof(ValueType));
+}
+
+template <typename KeyType, typename ValueType>
+bool HashTableBucketPage<KeyType, ValueType>::Append(const KeyType& key,
+                                                     const ValueType& value) {
+    if (IsFull()) {
+        return false;
+    }
+    char* entry = EntryAt(size_);
+    std::memcpy(entry, &key, sizeof(KeyType));
+    std::memcpy(entry + sizeof(KeyType), &value, sizeof(ValueType));
+    size_++;
+    return true;
+}
+
+template <typename KeyType, typename ValueType>
+void HashTableBucketPage<KeyType, ValueType>::RemoveAt(int index) {
+    size_--;
+    if (index != size_) {
+        std::memcpy(EntryAt(index), EntryAt(size_), ENTRY_SIZE);
+    }
+}
+
+template <typename KeyType, typename ValueType>
+int HashTableBucketPage<KeyType, ValueType>::Find(const KeyType& key,
+                                                  int start) const {
+    for (int i = start; i < size_; i++) {
+        if (KeyAt(i) == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 显式实例化，和IndexManager支持的哈希索引键类型一致
+template class HashTableBucketPage<int32_t, RID>;
+template class HashTableBucketPage<int64_t, RID>;
+template class HashTableBucketPage<float, RID>;
+template class HashTableBucketPage<double, RID>;
+template class HashTableBucketPage<InlineStringKey<16>, RID>;
+template class HashTableBucketPage<InlineStringKey<32>, RID>;
+template class HashTableBucketPage<InlineStringKey<64>, RID>;
+template class HashTableBucketPage<InlineStringKey<128>, RID>;
+template class HashTableBucketPage<GenericKey<8>, RID>;
+template class HashTableBucketPage<GenericKey<16>, RID>;
+template class HashTableBucketPage<GenericKey<32>, RID>;
+template class HashTableBucketPage<GenericKey<64>, RID>;
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,162 @@
+/*
+ * 文件: hash_table_page.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 可扩展哈希索引的页面定义，包含目录页面和桶页面
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "common/config.h"
+#include "common/types.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * 可扩展哈希的目录页面
+ *
+ * 存储布局：
+ * [magic] [page_id] [global_depth] [local_depths...] [bucket_page_ids...]
+ *
+ * 设计思路：
+ * - 目录有 2^global_depth 个槽位，哈希值的低global_depth位选槽位，
+ *   每个槽位指向一个桶页面，多个槽位可以指向同一个桶
+ * - 每个槽位记录所指桶的局部深度，局部深度小于全局深度的桶
+ *   被 2^(global_depth - local_depth) 个槽位共享
+ * - 目录只占一个页面，最大深度由页面大小决定（4KB页面是9，即512个桶）；
+ *   到达最大深度的桶不再分裂，改为挂溢出页面
+ */
+class HashTableDirectoryPage {
+   public:
+    // 目录页面的魔数，打开已有索引时用来确认页面内容
+    static constexpr uint32_t DIRECTORY_MAGIC = 0x48534844;
+
+    // 页面能放下的最大全局深度
+    static constexpr uint32_t MAX_DEPTH = [] {
+        uint32_t depth = 0;
+        while (3 * sizeof(uint32_t) +
+                   (size_t{1} << (depth + 1)) *
+                       (sizeof(uint8_t) + sizeof(page_id_t)) <=
+               PAGE_SIZE) {
+            depth++;
+        }
+        return depth;
+    }();
+    static constexpr uint32_t MAX_SIZE = 1u << MAX_DEPTH;
+
+    /**
+     * 初始化目录：全局深度为0，唯一的槽位指向first_bucket
+     */
+    void Init(page_id_t page_id, page_id_t first_bucket);
+
+    /** 页面内容是不是一个目录 */
+    bool IsValid() const { return magic_ == DIRECTORY_MAGIC; }
+
+    page_id_t GetPageId() const { return page_id_; }
+    uint32_t GetGlobalDepth() const { return global_depth_; }
+    uint32_t Size() const { return 1u << global_depth_; }
+
+    /** 哈希值对应的槽位 */
+    uint32_t IndexOf(uint32_t hash) const { return hash & (Size() - 1); }
+
+    page_id_t GetBucketPageId(uint32_t index) const {
+        return bucket_page_ids_[index];
+    }
+    void SetBucketPageId(uint32_t index, page_id_t page_id) {
+        bucket_page_ids_[index] = page_id;
+    }
+
+    uint32_t GetLocalDepth(uint32_t index) const {
+        return local_depths_[index];
+    }
+    void SetLocalDepth(uint32_t index, uint32_t depth) {
+        local_depths_[index] = static_cast<uint8_t>(depth);
+    }
+
+    /**
+     * 槽位的分裂镜像：局部深度为d的桶分裂时，
+     * 第d-1位不同的两组槽位分到两个桶
+     */
+    uint32_t GetSplitImageIndex(uint32_t index) const {
+        uint32_t depth = local_depths_[index];
+        return depth == 0 ? index : index ^ (1u << (depth - 1));
+    }
+
+    /** 目录扩大一倍，新的一半复制原来的槽位 */
+    bool CanGrow() const { return global_depth_ < MAX_DEPTH; }
+    void IncrGlobalDepth();
+
+    /** 所有桶的局部深度都小于全局深度时目录可以减半 */
+    bool CanShrink() const;
+    void DecrGlobalDepth() { global_depth_--; }
+
+   private:
+    uint32_t magic_;
+    page_id_t page_id_;
+    uint32_t global_depth_;
+    uint8_t local_depths_[MAX_SIZE];
+    page_id_t bucket_page_ids_[MAX_SIZE];
+};
+
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE,
+              "hash directory must fit into a page");
+
+/**
+ * 可扩展哈希的桶页面
+ *
+ * 存储布局：
+ * [page_id] [overflow_page_id] [size] [key1,value1] ... [keyN,valueN]
+ *
+ * 设计思路：
+ * - 桶内的键值对不排序，插入追加到末尾，删除时用最后一项填补空位
+ * - 同一个键可以出现多次（非唯一索引），由上层决定是否允许
+ * - 键值对按字节拷贝进出页面，不要求页面里的数据对齐
+ * - overflow_page_id只在桶到达最大深度以后使用，把满了的桶串成链表
+ */
+template <typename KeyType, typename ValueType>
+class HashTableBucketPage {
+   public:
+    static constexpr size_t HEADER_SIZE = 3 * sizeof(int32_t);
+    static constexpr size_t ENTRY_SIZE = sizeof(KeyType) + sizeof(ValueType);
+    static constexpr int MAX_ENTRIES =
+        static_cast<int>((PAGE_SIZE - HEADER_SIZE) / ENTRY_SIZE);
+
+    void Init(page_id_t page_id);
+
+    page_id_t GetPageId() const { return page_id_; }
+    page_id_t GetOverflowPageId() const { return overflow_page_id_; }
+    void SetOverflowPageId(page_id_t page_id) { overflow_page_id_ = page_id; }
+
+    int GetSize() const { return size_; }
+    bool IsFull() const { return size_ >= MAX_ENTRIES; }
+    bool IsEmpty() const { return size_ == 0; }
+
+    KeyType KeyAt(int index) const;
+    ValueType ValueAt(int index) const;
+    void SetValueAt(int index, const ValueType& value);
+
+    /** 追加一项，页面已满返回false */
+    bool Append(const KeyType& key, const ValueType& value);
+
+    /** 删除第index项，最后一项移到这个位置 */
+    void RemoveAt(int index);
+
+    /** 第一个等于key的位置，找不到返回-1 */
+    int Find(const KeyType& key, int start = 0) const;
+
+   private:
+    char* EntryAt(int index) { return data_ + index * ENTRY_SIZE; }
+    const char* EntryAt(int index) const {
+        return data_ + index * ENTRY_SIZE;
+    }
+
+    page_id_t page_id_;
+    page_id_t overflow_page_id_;
+    int32_t size_;
+    char data_[PAGE_SIZE - HEADER_SIZE];
+};
+
+}  // namespace SimpleRDBMS
@@ -8,18 +8,32 @@
 
 #include "index/index_manager.h"
 
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <shared_mutex>
+#include <string_view>
+#include <type_traits>
+
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
 #include "catalog/catalog.h"  // 为了 Catalog, TableInfo
 #include "catalog/schema.h"
 #include "catalog/schema.h"  // 为了 Schema
 #include "catalog/table_manager.h"
+#include "common/bloom_filter.h"
+#include "common/compact_value.h"
 #include "common/config.h"
 #include "common/debug.h"  // 为了 LOG_* 宏
 #include "common/exception.h"
 #include "common/types.h"
 #include "index/b_plus_tree.h"
+#include "index/bulk_load_sorter.h"
+#include "index/extendible_hash_table.h"
+#include "index/generic_key.h"
 #include "index/index_manager.h"  // 为了 IndexManager
+#include "index/inline_string_key.h"
+#include "index/non_unique_key.h"
 #include "parser/ast.h"           // 为了 CreateTableStatement
 #include "record/table_heap.h"    // 为了 TableHeap
 #include "stat/stat.h"            // 为了统计信息
@@ -36,7 +50,17 @@ enum class IndexKeyType {
     INT64,        // 64位整数
     FLOAT,        // 单精度浮点数
     DOUBLE,       // 双精度浮点数
-    STRING        // 字符串类型
+    STRING,       // 字符串类型，B+树的键是InlineStringKey<N>
+    COMPOSITE     // 多列组合键，B+树的键是GenericKey<N>
+};
+
+/**
+ * 组合键中一列的编码信息
+ * 各列按声明顺序依次排在GenericKey里，每列占固定的宽度
+ */
+struct KeyColumnLayout {
+    TypeId type;   // 列的数据类型
+    size_t width;  // 编码后占用的字节数
 };
 
 /**
@@ -47,17 +71,38 @@ struct IndexMetadata {
     IndexKeyType key_type;                 // 索引键的数据类型
     std::string index_name;                // 索引名称
     std::string table_name;                // 对应的表名
-    std::vector<std::string> key_columns;  // 索引列名（目前只支持单列）
+    std::vector<std::string> key_columns;  // 索引列名
+    // INCLUDE列，接在key_columns后面一起编码进组合键，key_layout覆盖两者
+    std::vector<std::string> include_columns;
+    bool is_unique;  // false时B+树的键是NonUniqueKey<原始键类型>
+    // HASH时index_instance是ExtendibleHashTable，键就是原始键，
+    // 非唯一由哈希表自己处理，不用NonUniqueKey
+    IndexType index_type = IndexType::BPLUS_TREE;
+    std::vector<KeyColumnLayout> key_layout;  // 组合键各列的编码信息
+    // 组合键GenericKey的字节数；STRING索引是InlineStringKey的容量，
+    // 0表示列太长放不进内联键，退回std::string
+    size_t key_size = 0;
     std::unique_ptr<void, std::function<void(void*)>>
         index_instance;  // B+树实例指针
 
+    // 可选的布隆过滤器，只用于单列B+树索引，见IndexManagerImpl::SetBloomFilter
+    // bloom_enabled为false时插入和查找都不碰下面这些成员；
+    // 重建时独占bloom_latch，插入和查找共享
+    std::atomic<bool> bloom_enabled{false};
+    std::shared_mutex bloom_latch;
+    BloomFilter bloom_filter;
+    size_t bloom_capacity = 0;          // 过滤器按这么多个键分配
+    std::atomic<size_t> bloom_keys{0};  // 已经放进过滤器的键数
+    std::atomic<size_t> bloom_skips{0};  // 被过滤器挡掉的查找次数
+
     IndexMetadata(IndexKeyType type, const std::string& idx_name,
                   const std::string& tbl_name,
-                  const std::vector<std::string>& columns)
+                  const std::vector<std::string>& columns, bool unique = true)
         : key_type(type),
           index_name(idx_name),
           table_name(tbl_name),
           key_columns(columns),
+          is_unique(unique),
           index_instance(nullptr, [](void*) {}) {}
 };
 
@@ -119,6 +164,21 @@ class IndexManagerImpl {
         }
     }
 
+    /**
+     * 生成把根页面变化写回catalog的回调，没有catalog时返回空回调
+     * @param index_name 索引名称
+     */
+    std::function<void(page_id_t)> MakeRootChangeCallback(
+        const std::string& index_name) {
+        if (catalog_ == nullptr) {
+            return nullptr;
+        }
+        Catalog* catalog = catalog_;
+        return [catalog, index_name](page_id_t root_page_id) {
+            catalog->UpdateIndexRoot(index_name, root_page_id);
+        };
+    }
+
     /**
      * 创建新的B+树索引
      * 目前只支持单列索引，多列索引需要后续扩展
@@ -126,13 +186,94 @@ class IndexManagerImpl {
      * @param table_name 表名
      * @param key_columns 索引列名列表
      * @param table_schema 表的schema信息
+     * @param root_page_id 已有B+树的根页面，INVALID_PAGE_ID表示新建空树
+     * @param is_unique 是否唯一索引
+     * @param index_type 索引结构，HASH时root_page_id是哈希表的目录页面
      * @return 成功返回true，失败返回false
      */
     bool CreateIndex(const std::string& index_name,
                      const std::string& table_name,
                      const std::vector<std::string>& key_columns,
-                     const Schema* table_schema) {
+                     const Schema* table_schema, page_id_t root_page_id,
+                     bool is_unique, IndexType index_type,
+                     const std::vector<std::string>& include_columns) {
+        std::lock_guard<std::mutex> lock(latch_);
+        if (deferred_.find(index_name) != deferred_.end()) {
+            LOG_WARN("IndexManager: Index " << index_name << " already exists");
+            return false;
+        }
+        return CreateIndexLocked(index_name, table_name, key_columns,
+                                 table_schema, root_page_id, is_unique,
+                                 index_type, include_columns);
+    }
+
+    /**
+     * 登记一个磁盘上已有的索引，第一次使用时才打开
+     * 参数和CreateIndex相同，root_page_id必须是已有的根页面或目录页面
+     * @return 索引名已经存在时返回false
+     */
+    bool DeferIndex(const std::string& index_name,
+                    const std::string& table_name,
+                    const std::vector<std::string>& key_columns,
+                    const Schema* table_schema, page_id_t root_page_id,
+                    bool is_unique, IndexType index_type,
+                    const std::vector<std::string>& include_columns) {
         std::lock_guard<std::mutex> lock(latch_);
+        if (indexes_.find(index_name) != indexes_.end() ||
+            deferred_.find(index_name) != deferred_.end()) {
+            LOG_WARN("IndexManager: Index " << index_name << " already exists");
+            return false;
+        }
+        deferred_.emplace(
+            index_name,
+            DeferredIndex{table_name, key_columns, include_columns,
+                          table_schema, root_page_id, is_unique, index_type});
+        LOG_DEBUG("IndexManager: Deferred opening index " << index_name);
+        return true;
+    }
+
+   private:
+    /**
+     * 登记了但还没有打开的索引，保存CreateIndex需要的全部参数
+     */
+    struct DeferredIndex {
+        std::string table_name;
+        std::vector<std::string> key_columns;
+        std::vector<std::string> include_columns;
+        const Schema* table_schema;
+        page_id_t root_page_id;
+        bool is_unique;
+        IndexType index_type;
+    };
+
+    /**
+     * 打开登记过的索引，调用者持有latch_
+     * 打开失败时索引就不存在了，和启动时CreateIndex失败的结果一样
+     */
+    void OpenDeferredLocked(const std::string& index_name) {
+        auto it = deferred_.find(index_name);
+        if (it == deferred_.end()) {
+            return;
+        }
+        DeferredIndex deferred = std::move(it->second);
+        deferred_.erase(it);
+        if (!CreateIndexLocked(index_name, deferred.table_name,
+                               deferred.key_columns, deferred.table_schema,
+                               deferred.root_page_id, deferred.is_unique,
+                               deferred.index_type,
+                               deferred.include_columns)) {
+            LOG_ERROR("IndexManager: Failed to open deferred index "
+                      << index_name);
+        }
+    }
+
+    /** CreateIndex的实现，调用者持有latch_ */
+    bool CreateIndexLocked(const std::string& index_name,
+                           const std::string& table_name,
+                           const std::vector<std::string>& key_columns,
+                           const Schema* table_schema, page_id_t root_page_id,
+                           bool is_unique, IndexType index_type,
+                           const std::vector<std::string>& include_columns) {
         LOG_DEBUG("IndexManager: Creating index "
                   << index_name << " on table " << table_name
                   << " (currently have " << indexes_.size() << " indexes)");
@@ -143,9 +284,9 @@ class IndexManagerImpl {
             return false;
         }
 
-        // 目前只支持单列索引
-        if (key_columns.size() != 1) {
-            LOG_ERROR("IndexManager: Multi-column indexes not supported yet");
+        if (key_columns.empty()) {
+            LOG_ERROR("IndexManager: Index " << index_name
+                                             << " has no key columns");
             return false;
         }
 
@@ -171,6 +312,30 @@ class IndexManagerImpl {
             }
         }
 
+        if (!include_columns.empty() && index_type == IndexType::HASH) {
+            LOG_ERROR("IndexManager: Hash index "
+                      << index_name << " cannot have INCLUDE columns");
+            return false;
+        }
+
+        // 多列索引和带INCLUDE列的索引把所有列编码进一个定长的组合键
+        if (key_columns.size() > 1 || !include_columns.empty()) {
+            auto metadata = CreateCompositeIndex(
+                index_name, table_name, key_columns, include_columns,
+                table_schema, root_page_id, is_unique, index_type);
+            if (!metadata) {
+                LOG_ERROR("IndexManager: Failed to create index "
+                          << index_name);
+                return false;
+            }
+            indexes_[index_name] = std::move(metadata);
+            LOG_INFO("IndexManager: Successfully created composite index "
+                     << index_name << " on " << key_columns.size()
+                     << " columns");
+            STATS.RecordIndexCreation(index_name);
+            return true;
+        }
+
         // 验证索引列是否存在
         const std::string& column_name = key_columns[0];
         if (!table_schema->HasColumn(column_name)) {
@@ -191,75 +356,115 @@ class IndexManagerImpl {
 
         // 创建索引元数据
         auto metadata = std::make_unique<IndexMetadata>(
-            key_type, index_name, table_name, key_columns);
+            key_type, index_name, table_name, key_columns, is_unique);
+        if (key_type == IndexKeyType::STRING) {
+            metadata->key_size = ChooseInlineStringCapacity(column.size);
+        }
+        metadata->index_type = index_type;
 
         bool success = false;
 
-        // 根据数据类型创建对应的B+树实例
-        // 使用模板特化为不同类型创建专用的B+树
-        switch (key_type) {
-            case IndexKeyType::INT32: {
-                auto tree = std::make_unique<BPlusTree<int32_t, RID>>(
-                    index_name, buffer_pool_manager_);
-                // 使用自定义删除器保存B+树实例
-                metadata->index_instance =
-                    std::unique_ptr<void, std::function<void(void*)>>(
-                        tree.release(), [](void* ptr) {
-                            delete static_cast<BPlusTree<int32_t, RID>*>(ptr);
-                        });
-                success = true;
-                break;
-            }
-            case IndexKeyType::INT64: {
-                auto tree = std::make_unique<BPlusTree<int64_t, RID>>(
-                    index_name, buffer_pool_manager_);
-                metadata->index_instance =
-                    std::unique_ptr<void, std::function<void(void*)>>(
-                        tree.release(), [](void* ptr) {
-                            delete static_cast<BPlusTree<int64_t, RID>*>(ptr);
-                        });
-                success = true;
-                break;
-            }
-            case IndexKeyType::FLOAT: {
-                auto tree = std::make_unique<BPlusTree<float, RID>>(
-                    index_name, buffer_pool_manager_);
-                metadata->index_instance =
-                    std::unique_ptr<void, std::function<void(void*)>>(
-                        tree.release(), [](void* ptr) {
-                            delete static_cast<BPlusTree<float, RID>*>(ptr);
-                        });
-                success = true;
-                break;
-            }
-            case IndexKeyType::DOUBLE: {
-                auto tree = std::make_unique<BPlusTree<double, RID>>(
-                    index_name, buffer_pool_manager_);
-                metadata->index_instance =
-                    std::unique_ptr<void, std::function<void(void*)>>(
-                        tree.release(), [](void* ptr) {
-                            delete static_cast<BPlusTree<double, RID>*>(ptr);
-                        });
-                success = true;
-                break;
-            }
-            case IndexKeyType::STRING: {
-                auto tree = std::make_unique<BPlusTree<std::string, RID>>(
-                    index_name, buffer_pool_manager_);
-                metadata->index_instance =
-                    std::unique_ptr<void, std::function<void(void*)>>(
-                        tree.release(), [](void* ptr) {
-                            delete static_cast<BPlusTree<std::string, RID>*>(
-                                ptr);
-                        });
-                success = true;
-                break;
+        if (index_type == IndexType::HASH) {
+            // 哈希表的键按值存进桶页面，放不进内联键的长字符串不支持
+            success = VisitKeyType(*metadata, [&](auto tag) {
+                using KeyType = decltype(tag);
+                if constexpr (std::is_trivially_copyable<KeyType>::value) {
+                    InstallHashTable<KeyType>(metadata.get(), root_page_id);
+                    return true;
+                } else {
+                    LOG_ERROR("IndexManager: Hash index "
+                              << index_name << " does not support column "
+                              << column_name << " longer than 128");
+                    return false;
+                }
+            });
+        } else if (!is_unique) {
+            // 非唯一索引的键是 (原始键, RID) 的复合键
+            success = VisitKeyType(*metadata, [&](auto tag) {
+                InstallTree<NonUniqueKey<decltype(tag)>>(metadata.get(),
+                                                         root_page_id);
+                return true;
+            });
+        } else {
+            // 根据数据类型创建对应的B+树实例
+            // 使用模板特化为不同类型创建专用的B+树
+            switch (key_type) {
+                case IndexKeyType::INT32: {
+                    auto tree = std::make_unique<BPlusTree<int32_t, RID>>(
+                        index_name, buffer_pool_manager_, root_page_id);
+                    tree->SetRootChangeCallback(
+                        MakeRootChangeCallback(index_name));
+                    tree->SetPageCompression(GetTableCompression(table_name));
+                    // 使用自定义删除器保存B+树实例
+                    metadata->index_instance =
+                        std::unique_ptr<void, std::function<void(void*)>>(
+                            tree.release(), [](void* ptr) {
+                                delete static_cast<BPlusTree<int32_t, RID>*>(
+                                    ptr);
+                            });
+                    success = true;
+                    break;
+                }
+                case IndexKeyType::INT64: {
+                    auto tree = std::make_unique<BPlusTree<int64_t, RID>>(
+                        index_name, buffer_pool_manager_, root_page_id);
+                    tree->SetRootChangeCallback(
+                        MakeRootChangeCallback(index_name));
+                    tree->SetPageCompression(GetTableCompression(table_name));
+                    metadata->index_instance =
+                        std::unique_ptr<void, std::function<void(void*)>>(
+                            tree.release(), [](void* ptr) {
+                                delete static_cast<BPlusTree<int64_t, RID>*>(
+                                    ptr);
+                            });
+                    success = true;
+                    break;
+                }
+                case IndexKeyType::FLOAT: {
+                    auto tree = std::make_unique<BPlusTree<float, RID>>(
+                        index_name, buffer_pool_manager_, root_page_id);
+                    tree->SetRootChangeCallback(
+                        MakeRootChangeCallback(index_name));
+                    tree->SetPageCompression(GetTableCompression(table_name));
+                    metadata->index_instance =
+                        std::unique_ptr<void, std::function<void(void*)>>(
+                            tree.release(), [](void* ptr) {
+                                delete static_cast<BPlusTree<float, RID>*>(
+                                    ptr);
+                            });
+                    success = true;
+                    break;
+                }
+                case IndexKeyType::DOUBLE: {
+                    auto tree = std::make_unique<BPlusTree<double, RID>>(
+                        index_name, buffer_pool_manager_, root_page_id);
+                    tree->SetRootChangeCallback(
+                        MakeRootChangeCallback(index_name));
+                    tree->SetPageCompression(GetTableCompression(table_name));
+                    metadata->index_instance =
+                        std::unique_ptr<void, std::function<void(void*)>>(
+                            tree.release(), [](void* ptr) {
+                                delete static_cast<BPlusTree<double, RID>*>(
+                                    ptr);
+                            });
+                    success = true;
+                    break;
+                }
+                case IndexKeyType::STRING: {
+                    success = VisitKeyType(*metadata, [&](auto tag) {
+                        InstallTree<decltype(tag)>(metadata.get(),
+                                                   root_page_id);
+                        return true;
+                    });
+                    break;
+                }
+                default:
+                    LOG_ERROR(
+                        "IndexManager: Unsupported key type for index "
+                        "creation");
+                    success = false;
+                    break;
             }
-            default:
-                LOG_ERROR(
-                    "IndexManager: Unsupported key type for index creation");
-                success = false;
-                break;
         }
 
         if (success) {
@@ -288,8 +493,10 @@ class IndexManagerImpl {
      * @param index_name 要删除的索引名称
      * @return 成功返回true，失败返回false
      */
+   public:
     bool DropIndex(const std::string& index_name) {
         std::lock_guard<std::mutex> lock(latch_);
+        OpenDeferredLocked(index_name);
         LOG_DEBUG("IndexManager: Dropping index "
                   << index_name << " (currently have " << indexes_.size()
                   << " indexes)");
@@ -326,6 +533,7 @@ class IndexManagerImpl {
     template <typename KeyType>
     BPlusTree<KeyType, RID>* GetIndex(const std::string& index_name) {
         std::lock_guard<std::mutex> lock(latch_);
+        OpenDeferredLocked(index_name);
 
         auto it = indexes_.find(index_name);
         if (it == indexes_.end()) {
@@ -333,6 +541,12 @@ class IndexManagerImpl {
             return nullptr;
         }
 
+        // 唯一索引和非唯一索引的B+树键类型不同，不能混用；哈希索引没有B+树
+        if (it->second->index_type != IndexType::BPLUS_TREE ||
+            it->second->is_unique == IsNonUniqueKey<KeyType>::value) {
+            return nullptr;
+        }
+
         // 强制类型转换到具体的B+树类型
         return static_cast<BPlusTree<KeyType, RID>*>(
             it->second->index_instance.get());
@@ -345,6 +559,7 @@ class IndexManagerImpl {
      */
     IndexMetadata* GetIndexMetadata(const std::string& index_name) {
         std::lock_guard<std::mutex> lock(latch_);
+        OpenDeferredLocked(index_name);
 
         auto it = indexes_.find(index_name);
         if (it == indexes_.end()) {
@@ -369,74 +584,14 @@ class IndexManagerImpl {
                                              << " not found for insertion");
             return false;
         }
-
-        bool result = false;
-
-        // 根据索引类型调用对应的B+树插入方法
-        switch (metadata->key_type) {
-            case IndexKeyType::INT32: {
-                auto* tree = GetIndex<int32_t>(index_name);
-                if (tree && std::holds_alternative<int32_t>(key)) {
-                    result = tree->Insert(std::get<int32_t>(key), rid);
-                    if (result) {
-                        STATS.RecordBTreeInsertion(index_name);
-                    }
-                    return result;
-                }
-                break;
-            }
-            case IndexKeyType::INT64: {
-                auto* tree = GetIndex<int64_t>(index_name);
-                if (tree && std::holds_alternative<int64_t>(key)) {
-                    result = tree->Insert(std::get<int64_t>(key), rid);
-                    if (result) {
-                        STATS.RecordBTreeInsertion(index_name);
-                    }
-                    return result;
-                }
-                break;
-            }
-            case IndexKeyType::FLOAT: {
-                auto* tree = GetIndex<float>(index_name);
-                if (tree && std::holds_alternative<float>(key)) {
-                    result = tree->Insert(std::get<float>(key), rid);
-                    if (result) {
-                        STATS.RecordBTreeInsertion(index_name);
-                    }
-                    return result;
-                }
-                break;
-            }
-            case IndexKeyType::DOUBLE: {
-                auto* tree = GetIndex<double>(index_name);
-                if (tree && std::holds_alternative<double>(key)) {
-                    result = tree->Insert(std::get<double>(key), rid);
-                    if (result) {
-                        STATS.RecordBTreeInsertion(index_name);
-                    }
-                    return result;
-                }
-                break;
-            }
-            case IndexKeyType::STRING: {
-                auto* tree = GetIndex<std::string>(index_name);
-                if (tree && std::holds_alternative<std::string>(key)) {
-                    result = tree->Insert(std::get<std::string>(key), rid);
-                    if (result) {
-                        STATS.RecordBTreeInsertion(index_name);
-                    }
-                    return result;
-                }
-                break;
-            }
-            default:
-                LOG_ERROR("IndexManager: Unsupported key type for insertion");
-                return false;
+        if (metadata->index_type == IndexType::HASH) {
+            return HashInsert(*metadata, {key}, rid);
         }
-
-        LOG_ERROR("IndexManager: Type mismatch or invalid tree for index "
-                  << index_name);
-        return false;
+        bool result = InsertTreeEntry(metadata, index_name, key, rid);
+        if (result) {
+            BloomAdd(metadata, key);
+        }
+        return result;
     }
 
     /**
@@ -452,6 +607,14 @@ class IndexManagerImpl {
                                              << " not found for deletion");
             return false;
         }
+        if (metadata->index_type == IndexType::HASH) {
+            return HashDelete(*metadata, {key}, nullptr);
+        }
+        if (!metadata->is_unique) {
+            return VisitValueKey(*metadata, key, [&](const auto& raw_key) {
+                return DeleteNonUnique(index_name, raw_key, nullptr);
+            });
+        }
 
         bool result = false;
 
@@ -502,15 +665,15 @@ class IndexManagerImpl {
                 break;
             }
             case IndexKeyType::STRING: {
-                auto* tree = GetIndex<std::string>(index_name);
-                if (tree && std::holds_alternative<std::string>(key)) {
-                    result = tree->Remove(std::get<std::string>(key));
+                return VisitValueKey(*metadata, key, [&](const auto& raw_key) {
+                    auto* tree =
+                        GetIndex<std::decay_t<decltype(raw_key)>>(index_name);
+                    result = tree != nullptr && tree->Remove(raw_key);
                     if (result) {
                         STATS.RecordBTreeDeletion(index_name);
                     }
                     return result;
-                }
-                break;
+                });
             }
             default:
                 LOG_ERROR("IndexManager: Unsupported key type for deletion");
@@ -522,6 +685,34 @@ class IndexManagerImpl {
         return false;
     }
 
+    /**
+     * 从索引中删除一条记录的索引项
+     * 唯一索引一个键只有一条记录，直接按键删除；
+     * 非唯一索引只删除 (key, rid) 这一项，同键的其他记录不受影响
+     * @param index_name 索引名称
+     * @param key 记录的键值
+     * @param rid 记录的RID
+     * @return 成功返回true，失败返回false
+     */
+    bool DeleteEntry(const std::string& index_name, const Value& key,
+                     const RID& rid) {
+        auto metadata = GetIndexMetadata(index_name);
+        if (!metadata) {
+            LOG_ERROR("IndexManager: Index " << index_name
+                                             << " not found for deletion");
+            return false;
+        }
+        if (metadata->index_type == IndexType::HASH) {
+            return HashDelete(*metadata, {key}, &rid);
+        }
+        if (metadata->is_unique) {
+            return DeleteEntry(index_name, key);
+        }
+        return VisitValueKey(*metadata, key, [&](const auto& raw_key) {
+            return DeleteNonUnique(index_name, raw_key, &rid);
+        });
+    }
+
     /**
      * 在索引中查找指定键值对应的记录ID
      * 这是索引最核心的功能，用于加速查询
@@ -537,6 +728,28 @@ class IndexManagerImpl {
                                              << " not found for search");
             return false;
         }
+        if (BloomRejects(metadata, key)) {
+            return false;
+        }
+        if (metadata->index_type == IndexType::HASH) {
+            std::vector<RID> rids;
+            if (!HashFind(*metadata, {key}, &rids)) {
+                return false;
+            }
+            *rid = rids.front();
+            return true;
+        }
+        if (!metadata->is_unique) {
+            std::vector<RID> rids;
+            bool found =
+                VisitValueKey(*metadata, key, [&](const auto& raw_key) {
+                    return FindNonUnique(index_name, raw_key, &rids, 1);
+                });
+            if (found) {
+                *rid = rids.front();
+            }
+            return found;
+        }
 
         LOG_DEBUG("IndexManager::FindEntry: Searching in index "
                   << index_name << " for key type "
@@ -598,18 +811,15 @@ class IndexManagerImpl {
                 break;
             }
             case IndexKeyType::STRING: {
-                auto* tree = GetIndex<std::string>(index_name);
-                if (tree && std::holds_alternative<std::string>(key)) {
+                return VisitValueKey(*metadata, key, [&](const auto& raw_key) {
+                    auto* tree =
+                        GetIndex<std::decay_t<decltype(raw_key)>>(index_name);
                     bool found =
-                        tree->GetValue(std::get<std::string>(key), rid);
+                        tree != nullptr && tree->GetValue(raw_key, rid);
                     LOG_DEBUG("IndexManager::FindEntry: STRING search result = "
                               << found);
                     return found;
-                }
-                LOG_DEBUG(
-                    "IndexManager::FindEntry: STRING type mismatch or invalid "
-                    "tree");
-                break;
+                });
             }
             default:
                 LOG_ERROR("IndexManager: Unsupported key type for search");
@@ -622,60 +832,1542 @@ class IndexManagerImpl {
     }
 
     /**
-     * 获取所有索引的名称列表
-     * 用于管理和调试
-     * @return 索引名称的vector
+     * 查找键值对应的所有记录ID
+     * @param index_name 索引名称
+     * @param key 要查找的键值
+     * @param rids 输出参数，按RID顺序追加所有匹配的记录
+     * @return 至少找到一条返回true
      */
-    std::vector<std::string> GetAllIndexNames() const {
-        std::lock_guard<std::mutex> lock(latch_);
-        std::vector<std::string> names;
-        names.reserve(indexes_.size());
-
-        LOG_DEBUG("IndexManager::GetAllIndexNames: Scanning " << indexes_.size()
-                                                              << " indexes");
-        for (const auto& [name, metadata] : indexes_) {
-            names.push_back(name);
-            LOG_DEBUG("IndexManager::GetAllIndexNames: Found index "
-                      << name << " on table " << metadata->table_name);
+    bool FindEntry(const std::string& index_name, const Value& key,
+                   std::vector<RID>* rids) {
+        auto metadata = GetIndexMetadata(index_name);
+        if (!metadata) {
+            LOG_ERROR("IndexManager: Index " << index_name
+                                             << " not found for search");
+            return false;
         }
-        LOG_DEBUG("IndexManager::GetAllIndexNames: Total "
-                  << names.size() << " indexes returned");
-        return names;
+        if (metadata->index_type == IndexType::HASH) {
+            return HashFind(*metadata, {key}, rids);
+        }
+        if (metadata->key_type == IndexKeyType::COMPOSITE) {
+            // 多列索引上按第一列做前缀查找
+            return FindEntry(index_name, std::vector<Value>{key}, rids);
+        }
+        if (metadata->is_unique) {
+            RID rid;
+            if (!FindEntry(index_name, key, &rid)) {
+                return false;
+            }
+            rids->push_back(rid);
+            return true;
+        }
+        if (BloomRejects(metadata, key)) {
+            return false;
+        }
+        return VisitValueKey(*metadata, key, [&](const auto& raw_key) {
+            return FindNonUnique(index_name, raw_key, rids, 0);
+        });
     }
 
     /**
-     * 获取指定表的所有索引
-     * 用于表删除时的清理工作
-     * @param table_name 表名
-     * @return 该表的所有索引名称
+     * 插入多列索引项，keys按索引列的顺序给出每一列的值
+     * 单列索引转给按单个Value插入的版本
      */
-    std::vector<std::string> GetTableIndexes(
-        const std::string& table_name) const {
-        std::lock_guard<std::mutex> lock(latch_);
-        std::vector<std::string> table_indexes;
-        for (const auto& [index_name, metadata] : indexes_) {
-            if (metadata->table_name == table_name) {
-                table_indexes.push_back(index_name);
-                LOG_DEBUG("IndexManager::GetTableIndexes: Found index "
-                          << index_name << " for table " << table_name);
-            }
+    bool InsertEntry(const std::string& index_name,
+                     const std::vector<Value>& keys, const RID& rid) {
+        auto metadata = GetIndexMetadata(index_name);
+        if (!metadata) {
+            LOG_ERROR("IndexManager: Index " << index_name
+                                             << " not found for insertion");
+            return false;
         }
-        LOG_DEBUG("IndexManager::GetTableIndexes: Table "
-                  << table_name << " has " << table_indexes.size()
-                  << " indexes");
-        return table_indexes;
+        if (metadata->index_type == IndexType::HASH) {
+            return HashInsert(*metadata, keys, rid);
+        }
+        if (metadata->key_type != IndexKeyType::COMPOSITE) {
+            return keys.size() == 1 && InsertEntry(index_name, keys[0], rid);
+        }
+        return VisitGenericKey(metadata->key_size, [&](auto tag) {
+            using KeyType = decltype(tag);
+            KeyType key;
+            if (keys.size() != metadata->key_layout.size() ||
+                !EncodeGenericKey(*metadata, keys, 0x00, &key)) {
+                LOG_ERROR("IndexManager: Type mismatch for index "
+                          << index_name);
+                return false;
+            }
+            if (!metadata->is_unique) {
+                return InsertNonUnique(index_name, key, rid);
+            }
+            auto* tree = GetIndex<KeyType>(index_name);
+            bool result = tree != nullptr && tree->Insert(key, rid);
+            if (result) {
+                STATS.RecordBTreeInsertion(index_name);
+            }
+            return result;
+        });
     }
 
-   private:
-    BufferPoolManager*
-        buffer_pool_manager_;  // 缓冲池管理器，用于B+树的页面管理
-    Catalog* catalog_;         // 目录管理器，用于验证表信息
-    std::unordered_map<std::string, std::unique_ptr<IndexMetadata>>
-        indexes_;               // 索引名到元数据的映射
-    mutable std::mutex latch_;  // 保护indexes_的互斥锁，确保线程安全
-};
+    /**
+     * 删除一条记录的多列索引项
+     */
+    bool DeleteEntry(const std::string& index_name,
+                     const std::vector<Value>& keys, const RID& rid) {
+        auto metadata = GetIndexMetadata(index_name);
+        if (!metadata) {
+            LOG_ERROR("IndexManager: Index " << index_name
+                                             << " not found for deletion");
+            return false;
+        }
+        if (metadata->index_type == IndexType::HASH) {
+            return HashDelete(*metadata, keys, &rid);
+        }
+        if (metadata->key_type != IndexKeyType::COMPOSITE) {
+            return keys.size() == 1 && DeleteEntry(index_name, keys[0], rid);
+        }
+        return VisitGenericKey(metadata->key_size, [&](auto tag) {
+            using KeyType = decltype(tag);
+            KeyType key;
+            if (keys.size() != metadata->key_layout.size() ||
+                !EncodeGenericKey(*metadata, keys, 0x00, &key)) {
+                LOG_ERROR("IndexManager: Type mismatch for index "
+                          << index_name);
+                return false;
+            }
+            if (!metadata->is_unique) {
+                return DeleteNonUnique(index_name, key, &rid);
+            }
+            auto* tree = GetIndex<KeyType>(index_name);
+            bool result = tree != nullptr && tree->Remove(key);
+            if (result) {
+                STATS.RecordBTreeDeletion(index_name);
+            }
+            return result;
+        });
+    }
 
-// ==================== IndexManager 公共接口实现 ====================
+    /**
+     * 按多列的值查找记录
+     * keys可以只给索引的前几列：把前缀编码成最小键和最大键，
+     * 取出两者之间的所有索引项。哈希索引必须给出所有列
+     */
+    bool FindEntry(const std::string& index_name,
+                   const std::vector<Value>& keys, std::vector<RID>* rids) {
+        auto metadata = GetIndexMetadata(index_name);
+        if (!metadata) {
+            LOG_ERROR("IndexManager: Index " << index_name
+                                             << " not found for search");
+            return false;
+        }
+        if (metadata->index_type == IndexType::HASH) {
+            return HashFind(*metadata, keys, rids);
+        }
+        if (metadata->key_type != IndexKeyType::COMPOSITE) {
+            return keys.size() == 1 && FindEntry(index_name, keys[0], rids);
+        }
+        return VisitGenericKey(metadata->key_size, [&](auto tag) {
+            using KeyType = decltype(tag);
+            KeyType lower;
+            KeyType upper;
+            if (keys.empty() ||
+                !EncodeGenericKey(*metadata, keys, 0x00, &lower) ||
+                !EncodeGenericKey(*metadata, keys, 0xFF, &upper)) {
+                return false;
+            }
+            if (metadata->is_unique) {
+                return CollectKeyRange<KeyType>(index_name, lower, upper, rids,
+                                                0);
+            }
+            return CollectKeyRange<NonUniqueKey<KeyType>>(index_name, lower,
+                                                          upper, rids, 0);
+        });
+    }
+
+    /**
+     * 按多列的值查找记录，同时从索引项里取出所有存储列的值
+     * 实现思路：
+     * 1. 单列索引的索引项就是查找的键本身，按FindEntry找到RID即可
+     * 2. 组合键和FindEntry一样按前缀取出范围内的索引项，
+     *    再按key_layout把每一列解码回Value
+     * 3. 哈希索引只有等值查找，不用于覆盖查询，直接返回false
+     */
+    bool FindEntryWithValues(
+        const std::string& index_name, const std::vector<Value>& keys,
+        std::vector<std::pair<std::vector<Value>, RID>>* entries) {
+        auto metadata = GetIndexMetadata(index_name);
+        if (!metadata) {
+            LOG_ERROR("IndexManager: Index " << index_name
+                                             << " not found for search");
+            return false;
+        }
+        if (metadata->index_type == IndexType::HASH) {
+            return false;
+        }
+        if (metadata->key_type != IndexKeyType::COMPOSITE) {
+            std::vector<RID> rids;
+            if (keys.size() != 1 || !FindEntry(index_name, keys[0], &rids)) {
+                return false;
+            }
+            for (const RID& rid : rids) {
+                entries->emplace_back(keys, rid);
+            }
+            return true;
+        }
+        size_t before = entries->size();
+        VisitGenericKey(metadata->key_size, [&](auto tag) {
+            using KeyType = decltype(tag);
+            KeyType lower;
+            KeyType upper;
+            if (keys.empty() ||
+                !EncodeGenericKey(*metadata, keys, 0x00, &lower) ||
+                !EncodeGenericKey(*metadata, keys, 0xFF, &upper)) {
+                return false;
+            }
+            auto collect = [&](const KeyType& key, const RID& rid) {
+                entries->emplace_back(DecodeGenericKey(*metadata, key), rid);
+                return true;
+            };
+            if (metadata->is_unique) {
+                return VisitKeyRange<KeyType>(index_name, lower, upper,
+                                              collect);
+            }
+            return VisitKeyRange<NonUniqueKey<KeyType>>(index_name, lower,
+                                                        upper, collect);
+        });
+        return entries->size() > before;
+    }
+
+    /**
+     * 用多列的值批量构建索引
+     * 单列索引转给按单个Value构建的版本
+     */
+    bool BuildIndex(
+        const std::string& index_name,
+        const std::function<bool(std::vector<Value>*, RID*)>& source) {
+        auto metadata = GetIndexMetadata(index_name);
+        if (!metadata) {
+            LOG_ERROR("IndexManager: Index " << index_name
+                                             << " not found for bulk build");
+            return false;
+        }
+        std::vector<Value> keys;
+        if (metadata->index_type == IndexType::HASH) {
+            // 哈希表没有顺序，排序没有意义，逐条插入
+            RID rid;
+            bool success = true;
+            while (source(&keys, &rid)) {
+                success = HashInsert(*metadata, keys, rid) && success;
+            }
+            return success;
+        }
+        if (metadata->key_type != IndexKeyType::COMPOSITE) {
+            return BuildIndex(index_name, [&](Value* key, RID* rid) {
+                if (!source(&keys, rid) || keys.size() != 1) {
+                    return false;
+                }
+                *key = std::move(keys[0]);
+                return true;
+            });
+        }
+
+        size_t mismatched = 0;
+        bool success = VisitGenericKey(metadata->key_size, [&](auto tag) {
+            using KeyType = decltype(tag);
+            auto next = [&](KeyType* key, RID* rid) {
+                while (source(&keys, rid)) {
+                    if (keys.size() == metadata->key_layout.size() &&
+                        EncodeGenericKey(*metadata, keys, 0x00, key)) {
+                        return true;
+                    }
+                    mismatched++;
+                }
+                return false;
+            };
+            if (metadata->is_unique) {
+                return BuildIndexFromKeys<KeyType>(index_name, next);
+            }
+            return BuildIndexFromKeys<KeyType, NonUniqueKey<KeyType>>(
+                index_name, next);
+        });
+        if (mismatched > 0) {
+            LOG_WARN("IndexManager: Skipped "
+                     << mismatched << " entries with mismatched key types for "
+                     << "index " << index_name);
+        }
+        return success && mismatched == 0;
+    }
+
+    /**
+     * 批量构建索引
+     * 根据索引的数据类型分派到对应的模板实现
+     * @param index_name 索引名称
+     * @param source 键和RID的来源
+     * @return 所有条目都进入索引返回true
+     */
+    bool BuildIndex(const std::string& index_name,
+                    const std::function<bool(Value*, RID*)>& source) {
+        auto metadata = GetIndexMetadata(index_name);
+        if (!metadata) {
+            LOG_ERROR("IndexManager: Index " << index_name
+                                             << " not found for bulk build");
+            return false;
+        }
+        if (metadata->index_type == IndexType::HASH) {
+            Value key;
+            RID rid;
+            bool success = true;
+            while (source(&key, &rid)) {
+                success = HashInsert(*metadata, {key}, rid) && success;
+            }
+            return success;
+        }
+        if (!metadata->is_unique) {
+            return VisitKeyType(*metadata, [&](auto tag) {
+                using KeyType = decltype(tag);
+                return BuildIndexTyped<KeyType, NonUniqueKey<KeyType>>(
+                    index_name, source);
+            });
+        }
+
+        switch (metadata->key_type) {
+            case IndexKeyType::INT32:
+                return BuildIndexTyped<int32_t>(index_name, source);
+            case IndexKeyType::INT64:
+                return BuildIndexTyped<int64_t>(index_name, source);
+            case IndexKeyType::FLOAT:
+                return BuildIndexTyped<float>(index_name, source);
+            case IndexKeyType::DOUBLE:
+                return BuildIndexTyped<double>(index_name, source);
+            case IndexKeyType::STRING:
+                return VisitKeyType(*metadata, [&](auto tag) {
+                    return BuildIndexTyped<decltype(tag)>(index_name, source);
+                });
+            default:
+                LOG_ERROR("IndexManager: Unsupported key type for bulk build");
+                return false;
+        }
+    }
+
+    /**
+     * 范围扫描索引
+     * 根据索引的数据类型分派到对应的模板实现
+     * @return 索引不存在或者是哈希索引时返回false
+     */
+    bool ScanRange(const std::string& index_name, const Value* lower,
+                   bool lower_inclusive, const Value* upper,
+                   bool upper_inclusive,
+                   const std::function<bool(const RID&)>& visitor) {
+        auto metadata = GetIndexMetadata(index_name);
+        if (!metadata) {
+            LOG_ERROR("IndexManager: Index " << index_name
+                                             << " not found for range scan");
+            return false;
+        }
+        if (metadata->index_type == IndexType::HASH) {
+            LOG_ERROR("IndexManager: Hash index "
+                      << index_name << " does not support range scans");
+            return false;
+        }
+        if (!metadata->is_unique) {
+            return VisitKeyType(*metadata, [&](auto tag) {
+                using KeyType = decltype(tag);
+                return ScanRangeTyped<KeyType, NonUniqueKey<KeyType>>(
+                    index_name, lower, lower_inclusive, upper, upper_inclusive,
+                    visitor);
+            });
+        }
+
+        switch (metadata->key_type) {
+            case IndexKeyType::INT32:
+                return ScanRangeTyped<int32_t>(index_name, lower,
+                                               lower_inclusive, upper,
+                                               upper_inclusive, visitor);
+            case IndexKeyType::INT64:
+                return ScanRangeTyped<int64_t>(index_name, lower,
+                                               lower_inclusive, upper,
+                                               upper_inclusive, visitor);
+            case IndexKeyType::FLOAT:
+                return ScanRangeTyped<float>(index_name, lower,
+                                             lower_inclusive, upper,
+                                             upper_inclusive, visitor);
+            case IndexKeyType::DOUBLE:
+                return ScanRangeTyped<double>(index_name, lower,
+                                              lower_inclusive, upper,
+                                              upper_inclusive, visitor);
+            case IndexKeyType::STRING:
+                return VisitKeyType(*metadata, [&](auto tag) {
+                    return ScanRangeTyped<decltype(tag)>(
+                        index_name, lower, lower_inclusive, upper,
+                        upper_inclusive, visitor);
+                });
+            default:
+                LOG_ERROR("IndexManager: Unsupported key type for range scan");
+                return false;
+        }
+    }
+
+    void SetBulkLoadOptions(double fill_factor, size_t sort_memory) {
+        std::lock_guard<std::mutex> lock(latch_);
+        bulk_load_fill_factor_ = fill_factor;
+        bulk_load_sort_memory_ = sort_memory;
+    }
+
+    /**
+     * 开启或关闭索引的布隆过滤器
+     * 只支持单列B+树索引：哈希索引查找只读一个桶页面，组合键的查找
+     * 多是前缀查找，过滤器帮不上忙。开启时扫描整个索引建过滤器
+     */
+    bool SetBloomFilter(const std::string& index_name, bool enabled) {
+        auto metadata = GetIndexMetadata(index_name);
+        if (!metadata) {
+            LOG_ERROR("IndexManager: Index " << index_name << " not found");
+            return false;
+        }
+        if (metadata->index_type != IndexType::BPLUS_TREE ||
+            metadata->key_type == IndexKeyType::COMPOSITE) {
+            LOG_WARN("IndexManager: Index "
+                     << index_name
+                     << " does not support bloom filters, only "
+                        "single-column B+ tree indexes do");
+            return false;
+        }
+        if (enabled) {
+            return RebuildBloomFilter(metadata);
+        }
+        std::unique_lock<std::shared_mutex> lock(metadata->bloom_latch);
+        metadata->bloom_enabled = false;
+        metadata->bloom_filter.Clear();
+        metadata->bloom_capacity = 0;
+        metadata->bloom_keys = 0;
+        return true;
+    }
+
+    size_t GetBloomFilterSkips(const std::string& index_name) const {
+        std::lock_guard<std::mutex> lock(latch_);
+        auto it = indexes_.find(index_name);
+        return it != indexes_.end() ? it->second->bloom_skips.load() : 0;
+    }
+
+    /**
+     * 获取所有索引的名称列表
+     * 用于管理和调试
+     * @return 索引名称的vector
+     */
+    std::vector<std::string> GetAllIndexNames() const {
+        std::lock_guard<std::mutex> lock(latch_);
+        std::vector<std::string> names;
+        names.reserve(indexes_.size() + deferred_.size());
+        for (const auto& [name, deferred] : deferred_) {
+            names.push_back(name);
+        }
+
+        LOG_DEBUG("IndexManager::GetAllIndexNames: Scanning " << indexes_.size()
+                                                              << " indexes");
+        for (const auto& [name, metadata] : indexes_) {
+            names.push_back(name);
+            LOG_DEBUG("IndexManager::GetAllIndexNames: Found index "
+                      << name << " on table " << metadata->table_name);
+        }
+        LOG_DEBUG("IndexManager::GetAllIndexNames: Total "
+                  << names.size() << " indexes returned");
+        return names;
+    }
+
+    /**
+     * 获取指定表的所有索引
+     * 用于表删除时的清理工作
+     * @param table_name 表名
+     * @return 该表的所有索引名称
+     */
+    std::vector<std::string> GetTableIndexes(
+        const std::string& table_name) const {
+        std::lock_guard<std::mutex> lock(latch_);
+        std::vector<std::string> table_indexes;
+        for (const auto& [index_name, deferred] : deferred_) {
+            if (deferred.table_name == table_name) {
+                table_indexes.push_back(index_name);
+            }
+        }
+        for (const auto& [index_name, metadata] : indexes_) {
+            if (metadata->table_name == table_name) {
+                table_indexes.push_back(index_name);
+                LOG_DEBUG("IndexManager::GetTableIndexes: Found index "
+                          << index_name << " for table " << table_name);
+            }
+        }
+        LOG_DEBUG("IndexManager::GetTableIndexes: Table "
+                  << table_name << " has " << table_indexes.size()
+                  << " indexes");
+        return table_indexes;
+    }
+
+   private:
+    /**
+     * 重新扫描索引建布隆过滤器
+     * 实现思路：
+     * 1. 先把bloom_enabled置为true再扫描，扫描期间独占bloom_latch：
+     *    插入在写完B+树之后才往过滤器里加键，扫描开始之后写进树的键
+     *    要么被扫描读到，要么它的插入看到bloom_enabled、等扫描结束后自己加，
+     *    不会漏掉；查找也等扫描结束才用新的过滤器
+     * 2. 过滤器按扫到的键数的两倍分配，之后插入的键超过分配的键数时
+     *    由插入的线程再次重建，每个键分摊的重建开销是常数
+     * 3. 删除不清除过滤器里的位，只会让误判变多，重建时一并清掉
+     */
+    bool RebuildBloomFilter(IndexMetadata* metadata) {
+        std::unique_lock<std::shared_mutex> lock(metadata->bloom_latch);
+        metadata->bloom_enabled = true;
+        std::vector<uint64_t> hashes;
+        bool scanned =
+            metadata->is_unique
+                ? VisitKeyType(*metadata,
+                               [&](auto tag) {
+                                   return CollectBloomHashes<decltype(tag)>(
+                                       metadata->index_name, &hashes);
+                               })
+                : VisitKeyType(*metadata, [&](auto tag) {
+                      using KeyType = decltype(tag);
+                      return CollectBloomHashes<KeyType, NonUniqueKey<KeyType>>(
+                          metadata->index_name, &hashes);
+                  });
+        if (!scanned) {
+            metadata->bloom_enabled = false;
+            metadata->bloom_filter.Clear();
+            return false;
+        }
+        size_t capacity =
+            std::max(hashes.size() * 2, INDEX_BLOOM_FILTER_MIN_KEYS);
+        metadata->bloom_filter.Reset(capacity);
+        for (uint64_t hash : hashes) {
+            metadata->bloom_filter.Insert(hash);
+        }
+        metadata->bloom_capacity = capacity;
+        metadata->bloom_keys = hashes.size();
+        LOG_DEBUG("IndexManager: Built bloom filter for index "
+                  << metadata->index_name << " with " << hashes.size()
+                  << " keys, " << metadata->bloom_filter.GetMemoryUsage()
+                  << " bytes");
+        return true;
+    }
+
+    /** 扫描B+树，收集所有键的布隆过滤器哈希值 */
+    template <typename KeyType, typename TreeKeyType = KeyType>
+    bool CollectBloomHashes(const std::string& index_name,
+                            std::vector<uint64_t>* hashes) {
+        auto* tree = GetIndex<TreeKeyType>(index_name);
+        if (!tree) {
+            return false;
+        }
+        for (auto it = tree->Begin(); !it.IsEnd(); ++it) {
+            hashes->push_back(BloomKeyHash(LogicalKey((*it).first)));
+        }
+        return true;
+    }
+
+    /**
+     * 布隆过滤器用的键哈希
+     * 在原始键类型上计算，查找的Value先按ExactValueToKey转换，
+     * 和B+树比较的是同一个值；浮点数的-0.0和0.0先规整
+     */
+    template <typename KeyType>
+    static uint64_t BloomKeyHash(const KeyType& key) {
+        uint64_t hash;
+        if constexpr (IsInlineStringKey<KeyType>::value) {
+            hash = std::hash<std::string_view>()(
+                std::string_view(key.data, key.length));
+        } else if constexpr (std::is_same_v<KeyType, std::string>) {
+            hash = std::hash<std::string_view>()(key);
+        } else if constexpr (std::is_floating_point_v<KeyType>) {
+            double number = key == 0 ? 0.0 : static_cast<double>(key);
+            std::memcpy(&hash, &number, sizeof(hash));
+        } else {
+            hash = static_cast<uint64_t>(static_cast<int64_t>(key));
+        }
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    /**
+     * 计算Value的布隆过滤器哈希
+     * @return 类型和索引键不一致时返回false，这时查找本来就找不到
+     */
+    static bool BloomValueHash(const IndexMetadata& metadata, const Value& key,
+                               uint64_t* hash) {
+        return VisitKeyType(metadata, [&](auto tag) {
+            using KeyType = decltype(tag);
+            KeyType raw_key{};
+            if (!ExactValueToKey(key, &raw_key)) {
+                return false;
+            }
+            *hash = BloomKeyHash(raw_key);
+            return true;
+        });
+    }
+
+    /** 插入成功后把键加进布隆过滤器，超过分配的键数时重建 */
+    void BloomAdd(IndexMetadata* metadata, const Value& key) {
+        uint64_t hash = 0;
+        if (!metadata->bloom_enabled ||
+            !BloomValueHash(*metadata, key, &hash)) {
+            return;
+        }
+        bool overloaded;
+        {
+            std::shared_lock<std::shared_mutex> lock(metadata->bloom_latch);
+            if (!metadata->bloom_enabled) {
+                return;
+            }
+            metadata->bloom_filter.InsertConcurrent(hash);
+            overloaded = ++metadata->bloom_keys > metadata->bloom_capacity;
+        }
+        if (overloaded) {
+            RebuildBloomFilter(metadata);
+        }
+    }
+
+    /** 布隆过滤器确定键不在索引里时返回true，这次查找不用下降B+树 */
+    bool BloomRejects(IndexMetadata* metadata, const Value& key) {
+        uint64_t hash = 0;
+        if (!metadata->bloom_enabled ||
+            !BloomValueHash(*metadata, key, &hash)) {
+            return false;
+        }
+        std::shared_lock<std::shared_mutex> lock(metadata->bloom_latch);
+        if (!metadata->bloom_enabled ||
+            metadata->bloom_filter.MayContain(hash)) {
+            return false;
+        }
+        metadata->bloom_skips++;
+        return true;
+    }
+
+    /** InsertEntry插入B+树的部分 */
+    bool InsertTreeEntry(IndexMetadata* metadata, const std::string& index_name,
+                         const Value& key, const RID& rid) {
+        if (!metadata->is_unique) {
+            return VisitValueKey(*metadata, key, [&](const auto& raw_key) {
+                return InsertNonUnique(index_name, raw_key, rid);
+            });
+        }
+
+        bool result = false;
+
+        // 根据索引类型调用对应的B+树插入方法
+        switch (metadata->key_type) {
+            case IndexKeyType::INT32: {
+                auto* tree = GetIndex<int32_t>(index_name);
+                if (tree && std::holds_alternative<int32_t>(key)) {
+                    result = tree->Insert(std::get<int32_t>(key), rid);
+                    if (result) {
+                        STATS.RecordBTreeInsertion(index_name);
+                    }
+                    return result;
+                }
+                break;
+            }
+            case IndexKeyType::INT64: {
+                auto* tree = GetIndex<int64_t>(index_name);
+                if (tree && std::holds_alternative<int64_t>(key)) {
+                    result = tree->Insert(std::get<int64_t>(key), rid);
+                    if (result) {
+                        STATS.RecordBTreeInsertion(index_name);
+                    }
+                    return result;
+                }
+                break;
+            }
+            case IndexKeyType::FLOAT: {
+                auto* tree = GetIndex<float>(index_name);
+                if (tree && std::holds_alternative<float>(key)) {
+                    result = tree->Insert(std::get<float>(key), rid);
+                    if (result) {
+                        STATS.RecordBTreeInsertion(index_name);
+                    }
+                    return result;
+                }
+                break;
+            }
+            case IndexKeyType::DOUBLE: {
+                auto* tree = GetIndex<double>(index_name);
+                if (tree && std::holds_alternative<double>(key)) {
+                    result = tree->Insert(std::get<double>(key), rid);
+                    if (result) {
+                        STATS.RecordBTreeInsertion(index_name);
+                    }
+                    return result;
+                }
+                break;
+            }
+            case IndexKeyType::STRING: {
+                return VisitValueKey(*metadata, key, [&](const auto& raw_key) {
+                    auto* tree =
+                        GetIndex<std::decay_t<decltype(raw_key)>>(index_name);
+                    result = tree != nullptr && tree->Insert(raw_key, rid);
+                    if (result) {
+                        STATS.RecordBTreeInsertion(index_name);
+                    }
+                    return result;
+                });
+            }
+            default:
+                LOG_ERROR("IndexManager: Unsupported key type for insertion");
+                return false;
+        }
+
+        LOG_ERROR("IndexManager: Type mismatch or invalid tree for index "
+                  << index_name);
+        return false;
+    }
+
+    /**
+     * 批量构建的模板实现
+     * 实现思路：
+     * 1. 把来源的所有条目放进外部排序器，排序、去重
+     * 2. 树为空时用排好序的序列自底向上构建
+     * 3. 树不为空（比如启动时从磁盘加载了已有的根）就按顺序逐条插入，
+     *    有序插入每次都落在相邻的叶子上，缓冲池命中率也比乱序高
+     */
+    template <typename KeyType, typename TreeKeyType = KeyType>
+    bool BuildIndexTyped(const std::string& index_name,
+                         const std::function<bool(Value*, RID*)>& source) {
+        size_t mismatched = 0;
+        bool success = BuildIndexFromKeys<KeyType, TreeKeyType>(
+            index_name, [&source, &mismatched](KeyType* key, RID* rid) {
+                Value value;
+                while (source(&value, rid)) {
+                    if (ExactValueToKey(value, key)) {
+                        return true;
+                    }
+                    mismatched++;
+                }
+                return false;
+            });
+        if (mismatched > 0) {
+            LOG_WARN("IndexManager: Skipped " << mismatched
+                                              << " entries with mismatched "
+                                                 "key type for index "
+                                              << index_name);
+        }
+        return success && mismatched == 0;
+    }
+
+    /**
+     * 批量构建的核心部分，source直接给出原始键类型的键
+     */
+    template <typename KeyType, typename TreeKeyType = KeyType>
+    bool BuildIndexFromKeys(
+        const std::string& index_name,
+        const std::function<bool(KeyType*, RID*)>& source) {
+        auto* tree = GetIndex<TreeKeyType>(index_name);
+        if (!tree) {
+            return false;
+        }
+
+        double fill_factor;
+        size_t sort_memory;
+        {
+            std::lock_guard<std::mutex> lock(latch_);
+            fill_factor = bulk_load_fill_factor_;
+            sort_memory = bulk_load_sort_memory_;
+        }
+
+        BulkLoadSorter<TreeKeyType, RID> sorter(sort_memory);
+        KeyType key{};
+        RID rid;
+        while (source(&key, &rid)) {
+            sorter.Add(MakeTreeKey<TreeKeyType>(key, rid), rid);
+        }
+        if (!sorter.Finish()) {
+            LOG_ERROR("IndexManager: Failed to sort entries for index "
+                      << index_name);
+            return false;
+        }
+
+        typename BulkLoadSorter<TreeKeyType, RID>::Entry entry;
+        bool success = true;
+        if (tree->IsEmpty()) {
+            success = tree->BulkLoad(
+                sorter.GetCount(),
+                [&sorter, &entry](TreeKeyType* out_key, RID* out_rid) {
+                    if (!sorter.Next(&entry)) {
+                        return false;
+                    }
+                    *out_key = std::move(entry.first);
+                    *out_rid = entry.second;
+                    return true;
+                },
+                fill_factor);
+        } else {
+            while (sorter.Next(&entry)) {
+                success = tree->Insert(entry.first, entry.second) && success;
+            }
+        }
+
+        LOG_DEBUG("IndexManager: Built index "
+                  << index_name << " from " << sorter.GetCount()
+                  << " entries using " << sorter.GetRunCount()
+                  << " sorted runs");
+        // 批量构建不经过InsertEntry，开启了布隆过滤器时整个重建
+        IndexMetadata* metadata = GetIndexMetadata(index_name);
+        if (metadata != nullptr && metadata->bloom_enabled) {
+            RebuildBloomFilter(metadata);
+        }
+        return success;
+    }
+
+    /**
+     * 按索引键类型分派到模板实现
+     * fn接收一个对应C++类型的值（只用它的类型），返回bool
+     * STRING索引按容量分派到InlineStringKey<N>
+     */
+    template <typename Fn>
+    static bool VisitKeyType(const IndexMetadata& metadata, Fn&& fn) {
+        switch (metadata.key_type) {
+            case IndexKeyType::INT32:
+                return fn(int32_t{});
+            case IndexKeyType::INT64:
+                return fn(int64_t{});
+            case IndexKeyType::FLOAT:
+                return fn(float{});
+            case IndexKeyType::DOUBLE:
+                return fn(double{});
+            case IndexKeyType::STRING:
+                return VisitStringKey(metadata.key_size, fn);
+            default:
+                LOG_ERROR("IndexManager: Unsupported key type "
+                          << static_cast<int>(metadata.key_type));
+                return false;
+        }
+    }
+
+    /**
+     * 按内联容量分派到对应的InlineStringKey<N>，容量为0时用std::string
+     */
+    template <typename Fn>
+    static bool VisitStringKey(size_t capacity, Fn&& fn) {
+        switch (capacity) {
+            case 0:
+                return fn(std::string{});
+            case 16:
+                return fn(InlineStringKey<16>{});
+            case 32:
+                return fn(InlineStringKey<32>{});
+            case 64:
+                return fn(InlineStringKey<64>{});
+            case 128:
+                return fn(InlineStringKey<128>{});
+            default:
+                LOG_ERROR("IndexManager: Unsupported inline string capacity "
+                          << capacity);
+                return false;
+        }
+    }
+
+    /**
+     * 能放下column_size个字符的最小InlineStringKey容量
+     * 超过128的列退回std::string，否则叶子页面放不下足够多的键
+     */
+    static size_t ChooseInlineStringCapacity(size_t column_size) {
+        for (size_t capacity : {16, 32, 64, 128}) {
+            if (column_size <= capacity) {
+                return capacity;
+            }
+        }
+        return 0;
+    }
+
+    /** 由原始键和RID生成B+树的键，唯一索引就是原始键本身 */
+    template <typename TreeKeyType, typename KeyType>
+    static TreeKeyType MakeTreeKey(const KeyType& key, const RID& rid) {
+        if constexpr (IsNonUniqueKey<TreeKeyType>::value) {
+            return TreeKeyType{key, rid};
+        } else {
+            (void)rid;
+            return key;
+        }
+    }
+
+    /** 原始键对应的最小B+树键，作为扫描起点 */
+    template <typename TreeKeyType, typename KeyType>
+    static TreeKeyType MakeLowestTreeKey(const KeyType& key) {
+        if constexpr (IsNonUniqueKey<TreeKeyType>::value) {
+            return TreeKeyType::Lowest(key);
+        } else {
+            return key;
+        }
+    }
+
+    /** 从B+树的键中取出原始键 */
+    template <typename TreeKeyType>
+    static const auto& LogicalKey(const TreeKeyType& key) {
+        if constexpr (IsNonUniqueKey<TreeKeyType>::value) {
+            return key.key;
+        } else {
+            return key;
+        }
+    }
+
+    /**
+     * 非唯一索引插入：键是 (key, rid)，同一个key的多条记录互不覆盖
+     */
+    template <typename KeyType>
+    bool InsertNonUnique(const std::string& index_name, const KeyType& key,
+                         const RID& rid) {
+        auto* tree = GetIndex<NonUniqueKey<KeyType>>(index_name);
+        if (!tree) {
+            LOG_ERROR("IndexManager: Type mismatch or invalid tree for index "
+                      << index_name);
+            return false;
+        }
+        bool result = tree->Insert(NonUniqueKey<KeyType>{key, rid}, rid);
+        if (result) {
+            STATS.RecordBTreeInsertion(index_name);
+        }
+        return result;
+    }
+
+    /**
+     * 非唯一索引删除
+     * @param rid 只删除这条记录的索引项；nullptr表示删除key的所有索引项
+     */
+    template <typename KeyType>
+    bool DeleteNonUnique(const std::string& index_name, const KeyType& key,
+                         const RID* rid) {
+        auto* tree = GetIndex<NonUniqueKey<KeyType>>(index_name);
+        if (!tree) {
+            LOG_ERROR("IndexManager: Type mismatch or invalid tree for index "
+                      << index_name);
+            return false;
+        }
+
+        std::vector<RID> rids;
+        if (rid != nullptr) {
+            rids.push_back(*rid);
+        } else {
+            FindNonUnique(index_name, key, &rids, 0);
+        }
+
+        bool removed = false;
+        for (const RID& entry_rid : rids) {
+            if (tree->Remove(NonUniqueKey<KeyType>{key, entry_rid})) {
+                STATS.RecordBTreeDeletion(index_name);
+                removed = true;
+            }
+        }
+        return removed;
+    }
+
+    /**
+     * 非唯一索引查找：从 (key, 最小RID) 开始沿叶子链表扫，直到key变化
+     * @param rids 输出参数，追加找到的RID
+     * @param limit 最多取几条，0表示不限制
+     * @return 至少找到一条返回true
+     */
+    template <typename KeyType>
+    bool FindNonUnique(const std::string& index_name, const KeyType& key,
+                       std::vector<RID>* rids, size_t limit) {
+        return CollectKeyRange<NonUniqueKey<KeyType>>(index_name, key, key,
+                                                      rids, limit);
+    }
+
+    /**
+     * 取出原始键落在 [lower, upper] 内的所有RID
+     * 唯一索引和非唯一索引都适用，组合键的前缀查找也用它
+     * @param rids 输出参数，按键的顺序追加找到的RID
+     * @param limit 最多取几条，0表示不限制
+     * @return 至少找到一条返回true
+     */
+    template <typename TreeKeyType, typename KeyType>
+    bool CollectKeyRange(const std::string& index_name, const KeyType& lower,
+                         const KeyType& upper, std::vector<RID>* rids,
+                         size_t limit) {
+        size_t found = 0;
+        VisitKeyRange<TreeKeyType>(
+            index_name, lower, upper, [&](const KeyType&, const RID& rid) {
+                rids->push_back(rid);
+                found++;
+                return limit == 0 || found < limit;
+            });
+        return found > 0;
+    }
+
+    /**
+     * 按键的顺序把原始键落在 [lower, upper] 内的索引项交给fn
+     * fn(原始键, RID) 返回false时提前结束
+     * @return 索引不存在或者键类型不匹配时返回false
+     */
+    template <typename TreeKeyType, typename KeyType, typename Fn>
+    bool VisitKeyRange(const std::string& index_name, const KeyType& lower,
+                       const KeyType& upper, Fn&& fn) {
+        auto* tree = GetIndex<TreeKeyType>(index_name);
+        if (!tree) {
+            LOG_DEBUG("IndexManager::FindEntry: type mismatch or invalid "
+                      "tree for index "
+                      << index_name);
+            return false;
+        }
+
+        for (auto it = tree->Begin(MakeLowestTreeKey<TreeKeyType>(lower));
+             !it.IsEnd(); ++it) {
+            auto entry = *it;
+            const KeyType& key = LogicalKey(entry.first);
+            if (upper < key || !fn(key, entry.second)) {
+                break;
+            }
+        }
+        STATS.RecordBTreeSearch(index_name);
+        return true;
+    }
+
+    /**
+     * 按单列索引的键类型取出Value里的原始键，交给fn处理
+     * Value的类型和索引键类型不一致时直接失败
+     */
+    template <typename Fn>
+    static bool VisitValueKey(const IndexMetadata& metadata, const Value& key,
+                              Fn&& fn) {
+        return VisitKeyType(metadata, [&](auto tag) {
+            using KeyType = decltype(tag);
+            KeyType raw_key{};
+            if (!ExactValueToKey(key, &raw_key)) {
+                LOG_ERROR("IndexManager: Type mismatch for index "
+                          << metadata.index_name);
+                return false;
+            }
+            return fn(raw_key);
+        });
+    }
+
+    /**
+     * 取出Value里的原始键，类型必须和索引键类型一致
+     * 内联字符串键从std::string转换，超过容量的字符串转换失败
+     */
+    template <typename KeyType>
+    static bool ExactValueToKey(const Value& value, KeyType* key) {
+        return ExactValueToKey(CompactValue::FromValue(value), key);
+    }
+
+    /** 同上，直接从紧凑值转换，字符串不经过std::string */
+    template <typename KeyType>
+    static bool ExactValueToKey(const CompactValue& value, KeyType* key) {
+        if (value.GetType() != KeyTypeIdOf<KeyType>()) {
+            return false;
+        }
+        if constexpr (IsInlineStringKey<KeyType>::value) {
+            if (!KeyType::Fits(value.GetString())) {
+                return false;
+            }
+            *key = KeyType(value.GetString());
+        } else if constexpr (std::is_same_v<KeyType, std::string>) {
+            key->assign(value.GetString());
+        } else if constexpr (std::is_floating_point_v<KeyType>) {
+            *key = static_cast<KeyType>(value.GetDouble());
+        } else {
+            *key = static_cast<KeyType>(value.GetInteger());
+        }
+        return true;
+    }
+
+    /** 键类型对应的列类型，ExactValueToKey用它判断类型是否一致 */
+    template <typename KeyType>
+    static constexpr TypeId KeyTypeIdOf() {
+        if constexpr (std::is_same_v<KeyType, bool>) {
+            return TypeId::BOOLEAN;
+        } else if constexpr (std::is_same_v<KeyType, int8_t>) {
+            return TypeId::TINYINT;
+        } else if constexpr (std::is_same_v<KeyType, int16_t>) {
+            return TypeId::SMALLINT;
+        } else if constexpr (std::is_same_v<KeyType, int32_t>) {
+            return TypeId::INTEGER;
+        } else if constexpr (std::is_same_v<KeyType, int64_t>) {
+            return TypeId::BIGINT;
+        } else if constexpr (std::is_same_v<KeyType, float>) {
+            return TypeId::FLOAT;
+        } else if constexpr (std::is_same_v<KeyType, double>) {
+            return TypeId::DOUBLE;
+        } else {
+            return TypeId::VARCHAR;
+        }
+    }
+
+    /**
+     * 按组合键的字节数分派到对应的GenericKey<N>
+     * fn接收一个GenericKey<N>的值（只用它的类型），返回bool
+     */
+    template <typename Fn>
+    static bool VisitGenericKey(size_t key_size, Fn&& fn) {
+        switch (key_size) {
+            case 8:
+                return fn(GenericKey<8>{});
+            case 16:
+                return fn(GenericKey<16>{});
+            case 32:
+                return fn(GenericKey<32>{});
+            case 64:
+                return fn(GenericKey<64>{});
+            default:
+                LOG_ERROR("IndexManager: Unsupported composite key size "
+                          << key_size);
+                return false;
+        }
+    }
+
+    /** 能容纳total_width字节的最小GenericKey尺寸，放不下返回0 */
+    static size_t ChooseGenericKeySize(size_t total_width) {
+        for (size_t size : {8, 16, 32, 64}) {
+            if (total_width <= size) {
+                return size;
+            }
+        }
+        return 0;
+    }
+
+    /** 列在组合键里占用的字节数，不支持的类型返回0 */
+    static size_t KeyColumnWidth(const Column& column) {
+        switch (column.type) {
+            case TypeId::INTEGER:
+            case TypeId::FLOAT:
+                return 4;
+            case TypeId::BIGINT:
+            case TypeId::DOUBLE:
+                return 8;
+            case TypeId::VARCHAR:
+                return column.size;
+            default:
+                return 0;
+        }
+    }
+
+    /** 创建一棵键类型为TreeKeyType的B+树，保存到索引元数据里 */
+    template <typename TreeKeyType>
+    void InstallTree(IndexMetadata* metadata, page_id_t root_page_id) {
+        using TreeType = BPlusTree<TreeKeyType, RID>;
+        auto tree = std::make_unique<TreeType>(
+            metadata->index_name, buffer_pool_manager_, root_page_id);
+        tree->SetRootChangeCallback(
+            MakeRootChangeCallback(metadata->index_name));
+        tree->SetPageCompression(GetTableCompression(metadata->table_name));
+        // 使用自定义删除器保存B+树实例
+        metadata->index_instance =
+            std::unique_ptr<void, std::function<void(void*)>>(
+                tree.release(),
+                [](void* ptr) { delete static_cast<TreeType*>(ptr); });
+    }
+
+    /** B+树索引的页面和所在表使用同样的压缩算法 */
+    PageCompression GetTableCompression(const std::string& table_name) const {
+        if (catalog_ == nullptr) {
+            return PageCompression::NONE;
+        }
+        TableInfo* table_info = catalog_->GetTable(table_name);
+        return table_info != nullptr ? table_info->compression
+                                     : PageCompression::NONE;
+    }
+
+    /** 创建一个键类型为KeyType的哈希表，保存到索引元数据里 */
+    template <typename KeyType>
+    void InstallHashTable(IndexMetadata* metadata,
+                          page_id_t directory_page_id) {
+        using TableType = ExtendibleHashTable<KeyType, RID>;
+        auto table = std::make_unique<TableType>(
+            metadata->index_name, buffer_pool_manager_, directory_page_id,
+            metadata->is_unique);
+        table->SetRootChangeCallback(
+            MakeRootChangeCallback(metadata->index_name));
+        metadata->index_instance =
+            std::unique_ptr<void, std::function<void(void*)>>(
+                table.release(),
+                [](void* ptr) { delete static_cast<TableType*>(ptr); });
+    }
+
+    template <typename KeyType>
+    static ExtendibleHashTable<KeyType, RID>* GetHashTable(
+        const IndexMetadata& metadata) {
+        return static_cast<ExtendibleHashTable<KeyType, RID>*>(
+            metadata.index_instance.get());
+    }
+
+    /**
+     * 把所有索引列的值转换成哈希表的键，交给fn处理
+     * 单列索引按列类型取原始键，多列索引编码成GenericKey；
+     * 哈希只能按完整的键查找，少给列或者类型不对时直接失败
+     */
+    template <typename Fn>
+    static bool VisitHashKey(const IndexMetadata& metadata,
+                             const std::vector<Value>& keys, Fn&& fn) {
+        if (metadata.key_type == IndexKeyType::COMPOSITE) {
+            return VisitGenericKey(metadata.key_size, [&](auto tag) {
+                using KeyType = decltype(tag);
+                KeyType key;
+                if (keys.size() != metadata.key_layout.size() ||
+                    !EncodeGenericKey(metadata, keys, 0x00, &key)) {
+                    LOG_ERROR("IndexManager: Type mismatch for index "
+                              << metadata.index_name);
+                    return false;
+                }
+                return fn(key);
+            });
+        }
+        if (keys.size() != 1) {
+            return false;
+        }
+        return VisitValueKey(metadata, keys[0], [&](const auto& raw_key) {
+            using KeyType = std::decay_t<decltype(raw_key)>;
+            if constexpr (std::is_trivially_copyable<KeyType>::value) {
+                return fn(raw_key);
+            } else {
+                return false;
+            }
+        });
+    }
+
+    /** 哈希索引插入，唯一索引上已有的键会被覆盖 */
+    static bool HashInsert(const IndexMetadata& metadata,
+                           const std::vector<Value>& keys, const RID& rid) {
+        return VisitHashKey(metadata, keys, [&](const auto& key) {
+            using KeyType = std::decay_t<decltype(key)>;
+            bool result = GetHashTable<KeyType>(metadata)->Insert(key, rid);
+            if (result) {
+                STATS.RecordBTreeInsertion(metadata.index_name);
+            }
+            return result;
+        });
+    }
+
+    /**
+     * 哈希索引删除
+     * @param rid 非唯一索引只删除这条记录的索引项；
+     *            nullptr或者唯一索引删除键的所有索引项
+     */
+    static bool HashDelete(const IndexMetadata& metadata,
+                           const std::vector<Value>& keys, const RID* rid) {
+        return VisitHashKey(metadata, keys, [&](const auto& key) {
+            using KeyType = std::decay_t<decltype(key)>;
+            auto* table = GetHashTable<KeyType>(metadata);
+            bool result = rid != nullptr && !metadata.is_unique
+                              ? table->Remove(key, *rid)
+                              : table->Remove(key);
+            if (result) {
+                STATS.RecordBTreeDeletion(metadata.index_name);
+            }
+            return result;
+        });
+    }
+
+    /** 哈希索引查找，rids里追加的顺序不确定 */
+    static bool HashFind(const IndexMetadata& metadata,
+                         const std::vector<Value>& keys,
+                         std::vector<RID>* rids) {
+        return VisitHashKey(metadata, keys, [&](const auto& key) {
+            using KeyType = std::decay_t<decltype(key)>;
+            bool found = GetHashTable<KeyType>(metadata)->GetValue(key, rids);
+            STATS.RecordBTreeSearch(metadata.index_name);
+            return found;
+        });
+    }
+
+    /**
+     * 创建多列索引
+     * 实现思路：
+     * 1. 逐列确定编码宽度，VARCHAR按声明的长度占位，
+     *    INCLUDE列排在索引列后面，也是键的一部分
+     * 2. 选能放下所有列的最小GenericKey<N>，超过64字节的组合不支持
+     * 3. 唯一索引的键是GenericKey<N>，非唯一索引是NonUniqueKey<GenericKey<N>>
+     * 4. 哈希索引直接用GenericKey<N>做哈希表的键
+     * @return 创建好的索引元数据，失败返回nullptr
+     */
+    std::unique_ptr<IndexMetadata> CreateCompositeIndex(
+        const std::string& index_name, const std::string& table_name,
+        const std::vector<std::string>& key_columns,
+        const std::vector<std::string>& include_columns,
+        const Schema* table_schema, page_id_t root_page_id, bool is_unique,
+        IndexType index_type) {
+        std::vector<std::string> stored_columns = key_columns;
+        stored_columns.insert(stored_columns.end(), include_columns.begin(),
+                              include_columns.end());
+        std::vector<KeyColumnLayout> layout;
+        size_t total_width = 0;
+        for (const auto& column_name : stored_columns) {
+            if (!table_schema->HasColumn(column_name)) {
+                LOG_ERROR("IndexManager: Column "
+                          << column_name << " not found in table "
+                          << table_name);
+                return nullptr;
+            }
+            const Column& column = table_schema->GetColumn(column_name);
+            size_t width = KeyColumnWidth(column);
+            if (width == 0) {
+                LOG_ERROR("IndexManager: Column "
+                          << column_name
+                          << " has a type unsupported in composite keys");
+                return nullptr;
+            }
+            layout.push_back({column.type, width});
+            total_width += width;
+        }
+
+        size_t key_size = ChooseGenericKeySize(total_width);
+        if (key_size == 0) {
+            LOG_ERROR("IndexManager: Composite key of index "
+                      << index_name << " needs " << total_width
+                      << " bytes, at most 64 are supported");
+            return nullptr;
+        }
+
+        auto metadata = std::make_unique<IndexMetadata>(
+            IndexKeyType::COMPOSITE, index_name, table_name, key_columns,
+            is_unique);
+        metadata->include_columns = include_columns;
+        metadata->key_layout = std::move(layout);
+        metadata->key_size = key_size;
+        metadata->index_type = index_type;
+        VisitGenericKey(key_size, [&](auto tag) {
+            using KeyType = decltype(tag);
+            if (index_type == IndexType::HASH) {
+                InstallHashTable<KeyType>(metadata.get(), root_page_id);
+            } else if (is_unique) {
+                InstallTree<KeyType>(metadata.get(), root_page_id);
+            } else {
+                InstallTree<NonUniqueKey<KeyType>>(metadata.get(),
+                                                   root_page_id);
+            }
+            return true;
+        });
+        return metadata;
+    }
+
+    /**
+     * 把多列的值编码成组合键
+     * values可以只给前几列（前缀），没给的列和末尾的空闲字节都填成fill：
+     * fill为0x00得到前缀的最小键，0xFF得到最大键
+     * @return 某一列的值转换不成列类型时返回false
+     */
+    template <typename KeyType>
+    static bool EncodeGenericKey(const IndexMetadata& metadata,
+                                 const std::vector<Value>& values, uint8_t fill,
+                                 KeyType* key) {
+        if (values.size() > metadata.key_layout.size()) {
+            return false;
+        }
+        uint8_t* out = key->data;
+        for (size_t i = 0; i < values.size(); i++) {
+            const KeyColumnLayout& column = metadata.key_layout[i];
+            CompactValue value = CompactValue::FromValue(values[i]);
+            switch (column.type) {
+                case TypeId::INTEGER: {
+                    int32_t v;
+                    if (!ValueToKey(value, &v)) {
+                        return false;
+                    }
+                    GenericKeyEncoder::EncodeInt32(v, out);
+                    break;
+                }
+                case TypeId::BIGINT: {
+                    int64_t v;
+                    if (!ValueToKey(value, &v)) {
+                        return false;
+                    }
+                    GenericKeyEncoder::EncodeInt64(v, out);
+                    break;
+                }
+                case TypeId::FLOAT: {
+                    float v;
+                    if (!ValueToKey(value, &v)) {
+                        return false;
+                    }
+                    GenericKeyEncoder::EncodeFloat(v, out);
+                    break;
+                }
+                case TypeId::DOUBLE: {
+                    double v;
+                    if (!ValueToKey(value, &v)) {
+                        return false;
+                    }
+                    GenericKeyEncoder::EncodeDouble(v, out);
+                    break;
+                }
+                case TypeId::VARCHAR: {
+                    if (!value.IsString()) {
+                        return false;
+                    }
+                    GenericKeyEncoder::EncodeString(value.GetString(), out,
+                                                    column.width);
+                    break;
+                }
+                default:
+                    return false;
+            }
+            out += column.width;
+        }
+        std::memset(out, fill, KeyType::SIZE - (out - key->data));
+        return true;
+    }
+
+    /**
+     * 把组合键按key_layout解码回每一列的值，是EncodeGenericKey的逆过程
+     * VARCHAR列只能取回声明长度以内的部分
+     */
+    template <typename KeyType>
+    static std::vector<Value> DecodeGenericKey(const IndexMetadata& metadata,
+                                               const KeyType& key) {
+        std::vector<Value> values;
+        values.reserve(metadata.key_layout.size());
+        const uint8_t* in = key.data;
+        for (const KeyColumnLayout& column : metadata.key_layout) {
+            switch (column.type) {
+                case TypeId::INTEGER:
+                    values.emplace_back(GenericKeyEncoder::DecodeInt32(in));
+                    break;
+                case TypeId::BIGINT:
+                    values.emplace_back(GenericKeyEncoder::DecodeInt64(in));
+                    break;
+                case TypeId::FLOAT:
+                    values.emplace_back(GenericKeyEncoder::DecodeFloat(in));
+                    break;
+                case TypeId::DOUBLE:
+                    values.emplace_back(GenericKeyEncoder::DecodeDouble(in));
+                    break;
+                default:
+                    values.emplace_back(
+                        GenericKeyEncoder::DecodeString(in, column.width));
+                    break;
+            }
+            in += column.width;
+        }
+        return values;
+    }
+
+    /**
+     * 把查询里的常量转换成索引键类型
+     * 只做无损的转换：整数之间、整数和浮点数之间转换后能原样转回来才算成功，
+     * 比如INT索引上的 id < 2.5 不能把边界截断成2，否则会漏掉id = 2；
+     * 字符串键只接受类型一致、放得下的字符串
+     * @return 转换失败返回false
+     */
+    template <typename KeyType>
+    static bool ValueToKey(const Value& value, KeyType* key) {
+        return ValueToKey(CompactValue::FromValue(value), key);
+    }
+
+    /**
+     * 同上，直接从紧凑值转换
+     * 紧凑值里整数都是int64_t、浮点数都是double，所以只需要两种源类型：
+     * FLOAT提升到double是精确的，转换后能原样转回double也就能原样转回float
+     */
+    template <typename KeyType>
+    static bool ValueToKey(const CompactValue& value, KeyType* key) {
+        if (ExactValueToKey(value, key)) {
+            return true;
+        }
+        if constexpr (std::is_arithmetic_v<KeyType> &&
+                      !std::is_same_v<KeyType, bool>) {
+            if (value.IsFloatingPoint()) {
+                return LosslessToKey(value.GetDouble(), key);
+            }
+            if (value.IsInteger() && value.GetType() != TypeId::BOOLEAN) {
+                return LosslessToKey(value.GetInteger(), key);
+            }
+        }
+        return false;
+    }
+
+    /** 把一个数值无损地转换成键类型，不能原样转回来时失败 */
+    template <typename T, typename KeyType>
+    static bool LosslessToKey(T v, KeyType* key) {
+        if constexpr (std::is_floating_point_v<T> &&
+                      std::is_integral_v<KeyType>) {
+            // 超出整数范围的浮点数转换是未定义行为
+            if (!(v >= static_cast<T>(std::numeric_limits<KeyType>::min()) &&
+                  v < -static_cast<T>(std::numeric_limits<KeyType>::min()))) {
+                return false;
+            }
+        }
+        if constexpr (std::is_integral_v<T> &&
+                      std::is_floating_point_v<KeyType>) {
+            // 转换回整数之前同样要检查范围，2^63这样的值会溢出
+            KeyType converted = static_cast<KeyType>(v);
+            if (!(converted >= static_cast<KeyType>(
+                                   std::numeric_limits<T>::min()) &&
+                  converted < -static_cast<KeyType>(
+                                  std::numeric_limits<T>::min()))) {
+                return false;
+            }
+        }
+        KeyType converted = static_cast<KeyType>(v);
+        if (static_cast<T>(converted) != v) {
+            return false;
+        }
+        *key = converted;
+        return true;
+    }
+
+    /**
+     * 范围扫描的模板实现
+     * 实现思路：
+     * 1. 有下界时用Begin(lower)直接定位到第一个不小于下界的位置，
+     *    否则从最左边的叶子开始
+     * 2. 沿叶子链表向后走，跳过等于开区间下界的键，越过上界就停止
+     * 3. 转换不了的边界当作不存在，扫描范围只会变大，
+     *    调用者还会用完整的WHERE条件过滤每一行
+     * 4. 非唯一索引从 (下界, 最小RID) 开始，比较时只看原始键
+     */
+    template <typename KeyType, typename TreeKeyType = KeyType>
+    bool ScanRangeTyped(const std::string& index_name, const Value* lower,
+                        bool lower_inclusive, const Value* upper,
+                        bool upper_inclusive,
+                        const std::function<bool(const RID&)>& visitor) {
+        auto* tree = GetIndex<TreeKeyType>(index_name);
+        if (!tree) {
+            return false;
+        }
+
+        KeyType lower_key{};
+        KeyType upper_key{};
+        bool has_lower = lower != nullptr && ValueToKey(*lower, &lower_key);
+        bool has_upper = upper != nullptr && ValueToKey(*upper, &upper_key);
+
+        size_t visited = 0;
+        auto it = has_lower ? tree->Begin(MakeLowestTreeKey<TreeKeyType>(
+                                  lower_key))
+                            : tree->Begin();
+        for (; !it.IsEnd(); ++it) {
+            auto entry = *it;
+            const KeyType& entry_key = LogicalKey(entry.first);
+            if (has_lower && !lower_inclusive && !(lower_key < entry_key)) {
+                continue;
+            }
+            if (has_upper && (upper_inclusive ? upper_key < entry_key
+                                              : !(entry_key < upper_key))) {
+                break;
+            }
+            visited++;
+            if (!visitor(entry.second)) {
+                break;
+            }
+        }
+
+        STATS.RecordBTreeSearch(index_name);
+        LOG_DEBUG("IndexManager::ScanRange: index " << index_name << " returned "
+                                                    << visited << " entries");
+        return true;
+    }
+
+    BufferPoolManager*
+        buffer_pool_manager_;  // 缓冲池管理器，用于B+树的页面管理
+    Catalog* catalog_;         // 目录管理器，用于验证表信息
+    std::unordered_map<std::string, std::unique_ptr<IndexMetadata>>
+        indexes_;               // 索引名到元数据的映射
+    // 启动时登记、还没有打开的索引，和indexes_的名字不重复
+    std::unordered_map<std::string, DeferredIndex> deferred_;
+    mutable std::mutex latch_;  // 保护indexes_的互斥锁，确保线程安全
+    double bulk_load_fill_factor_ = BULK_LOAD_FILL_FACTOR;  // 批量构建填充率
+    size_t bulk_load_sort_memory_ = BULK_LOAD_SORT_MEMORY;  // 排序内存上限
+};
+
+// ==================== IndexManager 公共接口实现 ====================
 
 IndexManager::IndexManager(BufferPoolManager* buffer_pool_manager,
                            Catalog* catalog)
@@ -686,9 +2378,25 @@ IndexManager::~IndexManager() = default;
 bool IndexManager::CreateIndex(const std::string& index_name,
                                const std::string& table_name,
                                const std::vector<std::string>& key_columns,
-                               const Schema* table_schema) {
+                               const Schema* table_schema,
+                               page_id_t root_page_id, bool is_unique,
+                               IndexType index_type,
+                               const std::vector<std::string>& include_columns) {
     return impl_->CreateIndex(index_name, table_name, key_columns,
-                              table_schema);
+                              table_schema, root_page_id, is_unique,
+                              index_type, include_columns);
+}
+
+bool IndexManager::DeferIndex(const std::string& index_name,
+                              const std::string& table_name,
+                              const std::vector<std::string>& key_columns,
+                              const Schema* table_schema,
+                              page_id_t root_page_id, bool is_unique,
+                              IndexType index_type,
+                              const std::vector<std::string>& include_columns) {
+    return impl_->DeferIndex(index_name, table_name, key_columns,
+                             table_schema, root_page_id, is_unique,
+                             index_type, include_columns);
 }
 
 bool IndexManager::DropIndex(const std::string& index_name) {
@@ -705,11 +2413,77 @@ bool IndexManager::DeleteEntry(const std::string& index_name,
     return impl_->DeleteEntry(index_name, key);
 }
 
+bool IndexManager::DeleteEntry(const std::string& index_name, const Value& key,
+                               const RID& rid) {
+    return impl_->DeleteEntry(index_name, key, rid);
+}
+
 bool IndexManager::FindEntry(const std::string& index_name, const Value& key,
                              RID* rid) {
     return impl_->FindEntry(index_name, key, rid);
 }
 
+bool IndexManager::FindEntry(const std::string& index_name, const Value& key,
+                             std::vector<RID>* rids) {
+    return impl_->FindEntry(index_name, key, rids);
+}
+
+bool IndexManager::InsertEntry(const std::string& index_name,
+                               const std::vector<Value>& keys,
+                               const RID& rid) {
+    return impl_->InsertEntry(index_name, keys, rid);
+}
+
+bool IndexManager::DeleteEntry(const std::string& index_name,
+                               const std::vector<Value>& keys,
+                               const RID& rid) {
+    return impl_->DeleteEntry(index_name, keys, rid);
+}
+
+bool IndexManager::FindEntry(const std::string& index_name,
+                             const std::vector<Value>& keys,
+                             std::vector<RID>* rids) {
+    return impl_->FindEntry(index_name, keys, rids);
+}
+
+bool IndexManager::FindEntryWithValues(
+    const std::string& index_name, const std::vector<Value>& keys,
+    std::vector<std::pair<std::vector<Value>, RID>>* entries) {
+    return impl_->FindEntryWithValues(index_name, keys, entries);
+}
+
+bool IndexManager::BuildIndex(const std::string& index_name,
+                              const std::function<bool(Value*, RID*)>& source) {
+    return impl_->BuildIndex(index_name, source);
+}
+
+bool IndexManager::BuildIndex(
+    const std::string& index_name,
+    const std::function<bool(std::vector<Value>*, RID*)>& source) {
+    return impl_->BuildIndex(index_name, source);
+}
+
+bool IndexManager::ScanRange(const std::string& index_name, const Value* lower,
+                             bool lower_inclusive, const Value* upper,
+                             bool upper_inclusive,
+                             const std::function<bool(const RID&)>& visitor) {
+    return impl_->ScanRange(index_name, lower, lower_inclusive, upper,
+                            upper_inclusive, visitor);
+}
+
+void IndexManager::SetBulkLoadOptions(double fill_factor, size_t sort_memory) {
+    impl_->SetBulkLoadOptions(fill_factor, sort_memory);
+}
+
+bool IndexManager::SetBloomFilter(const std::string& index_name,
+                                  bool enabled) {
+    return impl_->SetBloomFilter(index_name, enabled);
+}
+
+size_t IndexManager::GetBloomFilterSkips(const std::string& index_name) const {
+    return impl_->GetBloomFilterSkips(index_name);
+}
+
 std::vector<std::string> IndexManager::GetAllIndexNames() const {
     return impl_->GetAllIndexNames();
 }
@@ -30,7 +30,7 @@ class IndexManagerImpl;
  * 索引管理器类
  *
  * 这个类是整个索引系统的核心管理器，负责：
- * 1. 管理数据库中所有的B+树索引
+ * 1. 管理数据库中所有的B+树索引和哈希索引
  * 2. 提供统一的索引操作接口
  * 3. 处理不同数据类型的索引创建和操作
  * 4. 与catalog系统配合维护索引元信息
@@ -64,23 +64,56 @@ class IndexManager {
     /**
      * 创建新索引
      *
-     * 根据指定的列创建B+树索引，支持单列和复合索引（当前主要支持单列）
+     * 根据指定的列创建B+树索引，支持单列和多列组合索引
      *
      * @param index_name 索引名称，必须在数据库中唯一
      * @param table_name 目标表名
-     * @param key_columns 索引列名列表，当前主要支持单列索引
+     * @param key_columns 索引列名列表，多列时按顺序组成组合键
      * @param table_schema 表结构信息，用于获取列类型和约束
+     * @param root_page_id 磁盘上已有B+树的根页面（来自catalog），
+     *                     默认INVALID_PAGE_ID表示新建空树
+     * @param is_unique 是否唯一索引，false时同一个键可以对应多条记录
+     * @param index_type 索引结构，HASH时root_page_id是目录页面
+     * @param include_columns INCLUDE列，只存值不参与查找条件，
+     *                        接在索引列后面编码进组合键，哈希索引不支持
      * @return true表示创建成功，false表示失败（如索引已存在、列不存在等）
      *
      * 实现要点：
      * - 根据列的数据类型创建对应的B+树实例
+     * - 多列索引的键是定长的GenericKey<8/16/32/64>，各列编码后
+     *   可以直接按字节比较，所有列加起来不能超过64字节
+     * - 非唯一索引的B+树键是 (原始键, RID)，RID区分重复的键
      * - 将索引信息注册到catalog系统
-     * - 初始化B+树的root页面
+     * - B+树的根页面变化时写回catalog
+     * - 哈希索引是ExtendibleHashTable，只能用完整的键做等值查找，
+     *   前缀查找和ScanRange都不支持；超过128字符的VARCHAR列不支持
      */
     bool CreateIndex(const std::string& index_name,
                      const std::string& table_name,
                      const std::vector<std::string>& key_columns,
-                     const Schema* table_schema);
+                     const Schema* table_schema,
+                     page_id_t root_page_id = INVALID_PAGE_ID,
+                     bool is_unique = true,
+                     IndexType index_type = IndexType::BPLUS_TREE,
+                     const std::vector<std::string>& include_columns = {});
+
+    /**
+     * 登记磁盘上已有的索引，推迟到第一次使用时再打开
+     *
+     * 参数和CreateIndex相同，root_page_id是catalog里记录的根页面。
+     * 启动时用它代替CreateIndex，不用为每个索引读根页面；
+     * 索引名照常出现在GetAllIndexNames和GetTableIndexes里，
+     * 第一次查找、维护或删除时才打开B+树或哈希表
+     *
+     * @return 索引名已经存在时返回false
+     */
+    bool DeferIndex(const std::string& index_name,
+                    const std::string& table_name,
+                    const std::vector<std::string>& key_columns,
+                    const Schema* table_schema, page_id_t root_page_id,
+                    bool is_unique = true,
+                    IndexType index_type = IndexType::BPLUS_TREE,
+                    const std::vector<std::string>& include_columns = {});
 
     /**
      * 删除指定索引
@@ -105,7 +138,8 @@ class IndexManager {
      *
      * 使用场景：
      * - 当向表中insert新记录时，需要更新所有相关索引
-     * - 支持重复键值的插入（B+树允许重复键）
+     * - 唯一索引插入已存在的键会覆盖旧的RID；
+     *   非唯一索引同一个键的每条记录各占一项
      */
     bool InsertEntry(const std::string& index_name, const Value& key,
                      const RID& rid);
@@ -123,6 +157,20 @@ class IndexManager {
      */
     bool DeleteEntry(const std::string& index_name, const Value& key);
 
+    /**
+     * 从索引中删除一条记录的索引项
+     *
+     * @param index_name 目标索引名称
+     * @param key 记录的键值
+     * @param rid 记录的标识符
+     * @return true表示删除成功，false表示失败（如索引项不存在）
+     *
+     * 唯一索引等同于按键删除；非唯一索引只删除这条记录，
+     * 同一个键的其他记录保留。删除和更新记录时应该用这个版本
+     */
+    bool DeleteEntry(const std::string& index_name, const Value& key,
+                     const RID& rid);
+
     /**
      * 在索引中查找键值
      *
@@ -138,6 +186,140 @@ class IndexManager {
      */
     bool FindEntry(const std::string& index_name, const Value& key, RID* rid);
 
+    /**
+     * 在索引中查找键值对应的所有记录
+     *
+     * @param index_name 目标索引名称
+     * @param key 要查找的键值
+     * @param rids 输出参数，追加所有匹配的记录标识符，非唯一索引按RID排序
+     * @return true表示至少找到一条
+     */
+    bool FindEntry(const std::string& index_name, const Value& key,
+                   std::vector<RID>* rids);
+
+    /**
+     * 按键的范围扫描索引
+     *
+     * @param index_name 目标索引名称
+     * @param lower 下界，nullptr表示没有下界
+     * @param lower_inclusive 下界是否包含等于下界的键
+     * @param upper 上界，nullptr表示没有上界
+     * @param upper_inclusive 上界是否包含等于上界的键
+     * @param visitor 按键递增的顺序接收每个RID，返回false提前结束扫描
+     * @return true表示扫描完成，false表示索引不存在或者是哈希索引
+     *
+     * 实现要点：
+     * - 用BPlusTree::Begin(lower)定位起点，沿叶子链表走到上界为止
+     * - 边界和索引键类型不一致时只做无损的数值转换，
+     *   转换不了的边界当作不存在，调用者需要再用WHERE条件过滤
+     */
+    bool ScanRange(const std::string& index_name, const Value* lower,
+                   bool lower_inclusive, const Value* upper,
+                   bool upper_inclusive,
+                   const std::function<bool(const RID&)>& visitor);
+
+    /**
+     * 用一批键值对构建索引
+     *
+     * @param index_name 目标索引名称
+     * @param source 依次产生键和RID的回调，取完时返回false，顺序任意
+     * @return true表示所有条目都进入了索引
+     *
+     * 实现要点：
+     * - 先把全部条目交给外部排序器，排序后自底向上一次建好整棵树，
+     *   比逐条InsertEntry少了每次从根查找和所有分裂
+     * - 索引里已经有数据时不能批量构建，改为按排好的顺序逐条插入
+     * - 键类型和索引不匹配的条目跳过，返回false
+     */
+    bool BuildIndex(const std::string& index_name,
+                    const std::function<bool(Value*, RID*)>& source);
+
+    // ==================== 多列索引接口 ====================
+    // keys按索引列的顺序给出每一列的值，单列索引传一个值即可，
+    // 所以维护索引的调用者可以统一使用这一组接口
+
+    /**
+     * 插入一条记录的索引项
+     *
+     * @param index_name 目标索引名称
+     * @param keys 记录在所有索引列上的值
+     * @param rid 记录的标识符
+     * @return true表示插入成功
+     */
+    bool InsertEntry(const std::string& index_name,
+                     const std::vector<Value>& keys, const RID& rid);
+
+    /**
+     * 删除一条记录的索引项
+     *
+     * @param index_name 目标索引名称
+     * @param keys 记录在所有索引列上的值
+     * @param rid 记录的标识符
+     * @return true表示删除成功
+     */
+    bool DeleteEntry(const std::string& index_name,
+                     const std::vector<Value>& keys, const RID& rid);
+
+    /**
+     * 查找索引列取指定值的所有记录
+     *
+     * @param index_name 目标索引名称
+     * @param keys 前几个索引列的值，可以少于索引列数（前缀查找），
+     *             比如 (tenant_id, created_at) 上的索引只给tenant_id
+     * @param rids 输出参数，按键的顺序追加所有匹配的记录
+     * @return true表示至少找到一条
+     */
+    bool FindEntry(const std::string& index_name,
+                   const std::vector<Value>& keys, std::vector<RID>* rids);
+
+    /**
+     * 查找记录，同时取出索引项里存储的列值，供覆盖索引的查询使用
+     *
+     * @param index_name 目标索引名称
+     * @param keys 前几个索引列的值，和FindEntry一样可以是前缀
+     * @param entries 输出参数，按键的顺序追加 (列值, RID)，
+     *                列值依次是所有索引列和INCLUDE列
+     * @return true表示至少找到一条；哈希索引不支持，返回false
+     *
+     * VARCHAR列按声明的长度编码，更长的值只能取回前面一段，
+     * 取回的长度等于声明长度时调用者需要回表读取完整的值
+     */
+    bool FindEntryWithValues(
+        const std::string& index_name, const std::vector<Value>& keys,
+        std::vector<std::pair<std::vector<Value>, RID>>* entries);
+
+    /**
+     * 用一批记录构建索引，source每次给出一条记录所有索引列的值
+     */
+    bool BuildIndex(
+        const std::string& index_name,
+        const std::function<bool(std::vector<Value>*, RID*)>& source);
+
+    /**
+     * 设置批量构建参数
+     *
+     * @param fill_factor 叶子和内部页面的填充率，取值(0, 1]
+     * @param sort_memory 排序缓冲区的字节上限
+     */
+    void SetBulkLoadOptions(double fill_factor, size_t sort_memory);
+
+    /**
+     * 开启或关闭索引的布隆过滤器
+     *
+     * @param index_name 目标索引名称
+     * @param enabled true时扫描整个索引建过滤器，false时释放过滤器
+     * @return 索引不存在，或者不是单列B+树索引时返回false
+     *
+     * 开启后FindEntry先查过滤器，过滤器确定不存在的键直接返回，
+     * 不下降B+树；"这个键存在吗"一类多半找不到的查找受益最多。
+     * InsertEntry和BuildIndex同步维护过滤器，键数超过分配的两倍时
+     * 自动重建；删除的键留在过滤器里，只让误判变多
+     */
+    bool SetBloomFilter(const std::string& index_name, bool enabled);
+
+    /** 被布隆过滤器直接判定不存在、没有下降B+树的查找次数 */
+    size_t GetBloomFilterSkips(const std::string& index_name) const;
+
     /**
      * 获取指定类型的索引实例
      *
@@ -145,7 +327,8 @@ class IndexManager {
      *
      * @tparam KeyType 键的C++类型（如int32_t, std::string等）
      * @param index_name 索引名称
-     * @return 索引实例指针，如果不存在或类型不匹配则返回nullptr
+     * @return 索引实例指针，如果不存在或类型不匹配则返回nullptr，
+     *         非唯一索引的B+树键是NonUniqueKey，这里也返回nullptr
      *
      * 使用示例：
      * auto* tree = GetIndex<int32_t>("idx_id");
@@ -0,0 +1,108 @@
+/*
+ * 文件: inline_string_key.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: VARCHAR索引使用的定长内联字符串键，字符直接存放在B+树页面里
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace SimpleRDBMS {
+
+/**
+ * InlineStringKey - 带长度前缀的定长字符串键
+ *
+ * 设计思路：
+ * - std::string放进页面存的是堆指针，每次比较都要跳一次指针，
+ *   进程重启后页面里的指针也不再有效；这里把字符直接内联在键里，
+ *   整个键可以按值拷贝进页面，也能被外部排序器写进临时文件
+ * - 容量在编译期确定（16/32/64/128字节），按VARCHAR声明的长度选择
+ * - 比较规则和std::string一致：先比公共前缀，前缀相同时短的在前
+ * - 内部页面只用来路由，分隔键不需要是完整的键，
+ *   ShortestSeparator截出能区分左右两边的最短前缀，减少比较的字节数
+ *
+ * @tparam Capacity 最多能存放的字符数
+ */
+template <size_t Capacity>
+struct InlineStringKey {
+    static_assert(Capacity <= UINT16_MAX, "length prefix is 16 bits");
+    static constexpr size_t CAPACITY = Capacity;
+
+    uint16_t length = 0;          // 实际字符数
+    char data[Capacity] = {};     // 字符内容，length之后的部分为0
+
+    InlineStringKey() = default;
+
+    /** 超过容量的部分会被截断，调用者应该先用Fits检查 */
+    explicit InlineStringKey(std::string_view value) {
+        length = static_cast<uint16_t>(Fits(value) ? value.size() : Capacity);
+        std::memcpy(data, value.data(), length);
+    }
+
+    static bool Fits(std::string_view value) {
+        return value.size() <= Capacity;
+    }
+
+    std::string ToString() const { return std::string(data, length); }
+
+    bool operator<(const InlineStringKey& other) const {
+        size_t common = length < other.length ? length : other.length;
+        int result = std::memcmp(data, other.data, common);
+        return result < 0 || (result == 0 && length < other.length);
+    }
+
+    bool operator==(const InlineStringKey& other) const {
+        return length == other.length &&
+               std::memcmp(data, other.data, length) == 0;
+    }
+
+    bool operator!=(const InlineStringKey& other) const {
+        return !(*this == other);
+    }
+
+    /**
+     * 左右两边之间的最短分隔键
+     * 要求 left < right，返回的键s满足 left < s <= right：
+     * 取right到第一个和left不同的字符为止（left是right的前缀时多取一个），
+     * 这个前缀大于left，又是right的前缀所以不大于right
+     */
+    static InlineStringKey ShortestSeparator(const InlineStringKey& left,
+                                             const InlineStringKey& right) {
+        size_t common = left.length < right.length ? left.length : right.length;
+        size_t prefix = 0;
+        while (prefix < common && left.data[prefix] == right.data[prefix]) {
+            prefix++;
+        }
+        if (prefix >= right.length) {
+            // right不大于left，调用方式不对，退回完整的键
+            return right;
+        }
+        InlineStringKey separator;
+        separator.length = static_cast<uint16_t>(prefix + 1);
+        std::memcpy(separator.data, right.data, separator.length);
+        return separator;
+    }
+};
+
+/** 日志输出，打印字符串内容 */
+template <size_t Capacity>
+std::ostream& operator<<(std::ostream& os,
+                         const InlineStringKey<Capacity>& key) {
+    return os.write(key.data, key.length);
+}
+
+/** 判断键类型是不是内联字符串键 */
+template <typename KeyType>
+struct IsInlineStringKey : std::false_type {};
+
+template <size_t Capacity>
+struct IsInlineStringKey<InlineStringKey<Capacity>> : std::true_type {};
+
+}  // namespace SimpleRDBMS
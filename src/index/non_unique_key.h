@@ -0,0 +1,86 @@
+/*
+ * 文件: non_unique_key.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 非唯一索引使用的B+树键，把RID接在原始键后面，
+ *       让相同的键在树里也互不相同
+ */
+
+#pragma once
+
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+#include "common/types.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * NonUniqueKey - 非唯一索引的复合键 (key, rid)
+ *
+ * 设计思路：
+ * - B+树要求键唯一，插入已存在的键会覆盖旧值；
+ *   非唯一索引把记录的RID作为第二关键字，同一个key的多条记录
+ *   变成多个不同的复合键，按RID顺序相邻存放在叶子里
+ * - 查找key的所有记录：从 (key, 最小RID) 开始沿叶子链表向后扫，
+ *   直到key变化为止
+ * - 删除某条记录时带上它的RID，只删除这一个复合键
+ *
+ * @tparam KeyType 原始键类型
+ */
+template <typename KeyType>
+struct NonUniqueKey {
+    KeyType key;  // 原始键
+    RID rid;      // 记录标识符，相同key之间的排序依据
+
+    /** 先按key比较，key相同再按RID比较 */
+    bool operator<(const NonUniqueKey& other) const {
+        if (key < other.key) {
+            return true;
+        }
+        if (other.key < key) {
+            return false;
+        }
+        if (rid.page_id != other.rid.page_id) {
+            return rid.page_id < other.rid.page_id;
+        }
+        return rid.slot_num < other.rid.slot_num;
+    }
+
+    bool operator==(const NonUniqueKey& other) const {
+        return key == other.key && rid == other.rid;
+    }
+
+    bool operator!=(const NonUniqueKey& other) const {
+        return !(*this == other);
+    }
+
+    /** 同一个key的所有复合键中最小的那个，用于定位扫描起点 */
+    static NonUniqueKey Lowest(const KeyType& key) {
+        return NonUniqueKey{
+            key, RID{std::numeric_limits<page_id_t>::lowest(),
+                     std::numeric_limits<slot_offset_t>::lowest()}};
+    }
+
+    /** 同一个key的所有复合键中最大的那个 */
+    static NonUniqueKey Highest(const KeyType& key) {
+        return NonUniqueKey{key, RID{std::numeric_limits<page_id_t>::max(),
+                                     std::numeric_limits<slot_offset_t>::max()}};
+    }
+};
+
+/** 日志输出，格式为 key@page:slot */
+template <typename KeyType>
+std::ostream& operator<<(std::ostream& os, const NonUniqueKey<KeyType>& key) {
+    return os << key.key << "@" << key.rid.page_id << ":" << key.rid.slot_num;
+}
+
+/** 判断B+树的键类型是不是非唯一索引的复合键 */
+template <typename KeyType>
+struct IsNonUniqueKey : std::false_type {};
+
+template <typename KeyType>
+struct IsNonUniqueKey<NonUniqueKey<KeyType>> : std::true_type {};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,93 @@
+/*
+ * 文件: prefix_key_codec.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 叶子页面前缀压缩用到的键编码，把键转换成可以截取公共前缀的字节串
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "common/types.h"
+#include "index/generic_key.h"
+#include "index/inline_string_key.h"
+#include "index/non_unique_key.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * PrefixKeyCodec - 键和字节串之间的转换
+ *
+ * 设计思路：
+ * - 只有字节串形式的键才值得做前缀压缩：字符串、组合键，
+ *   以及它们作为非唯一索引原始键的情况；整数和浮点键没有特化，
+ *   ENABLED为false，叶子页面继续用原来的定长布局
+ * - Encode写出的字节数不超过MAX_BYTES，Decode按长度还原出同一个键
+ * - 同一页面里的键按编码后的字节计算公共前缀，前缀只存一份
+ */
+template <typename KeyType>
+struct PrefixKeyCodec {
+    static constexpr bool ENABLED = false;
+    static constexpr size_t MAX_BYTES = 0;
+};
+
+template <size_t Capacity>
+struct PrefixKeyCodec<InlineStringKey<Capacity>> {
+    static constexpr bool ENABLED = true;
+    static constexpr size_t MAX_BYTES = Capacity;
+
+    static size_t Encode(const InlineStringKey<Capacity>& key, uint8_t* out) {
+        std::memcpy(out, key.data, key.length);
+        return key.length;
+    }
+
+    static InlineStringKey<Capacity> Decode(const uint8_t* in, size_t length) {
+        InlineStringKey<Capacity> key;
+        key.length = static_cast<uint16_t>(length);
+        std::memcpy(key.data, in, length);
+        return key;
+    }
+};
+
+template <size_t KeySize>
+struct PrefixKeyCodec<GenericKey<KeySize>> {
+    static constexpr bool ENABLED = true;
+    static constexpr size_t MAX_BYTES = KeySize;
+
+    static size_t Encode(const GenericKey<KeySize>& key, uint8_t* out) {
+        std::memcpy(out, key.data, KeySize);
+        return KeySize;
+    }
+
+    static GenericKey<KeySize> Decode(const uint8_t* in, size_t length) {
+        (void)length;
+        GenericKey<KeySize> key;
+        std::memcpy(key.data, in, KeySize);
+        return key;
+    }
+};
+
+/** 非唯一索引的复合键：原始键的字节后面接上RID */
+template <typename KeyType>
+struct PrefixKeyCodec<NonUniqueKey<KeyType>> {
+    static constexpr bool ENABLED = PrefixKeyCodec<KeyType>::ENABLED;
+    static constexpr size_t MAX_BYTES =
+        PrefixKeyCodec<KeyType>::MAX_BYTES + sizeof(RID);
+
+    static size_t Encode(const NonUniqueKey<KeyType>& key, uint8_t* out) {
+        size_t length = PrefixKeyCodec<KeyType>::Encode(key.key, out);
+        std::memcpy(out + length, &key.rid, sizeof(RID));
+        return length + sizeof(RID);
+    }
+
+    static NonUniqueKey<KeyType> Decode(const uint8_t* in, size_t length) {
+        NonUniqueKey<KeyType> key;
+        key.key = PrefixKeyCodec<KeyType>::Decode(in, length - sizeof(RID));
+        std::memcpy(&key.rid, in + length - sizeof(RID), sizeof(RID));
+        return key;
+    }
+};
+
+}  // namespace SimpleRDBMS
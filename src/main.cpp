@@ -10,7 +10,6 @@
 #include "buffer/buffer_pool_manager.h"
 #include "buffer/lru_replacer.h"
 #include "catalog/catalog.h"
-#include "catalog/table_manager.h"
 #include "execution/execution_engine.h"
 #include "parser/parser.h"
 #include "recovery/log_manager.h"
@@ -26,12 +25,11 @@ class SimpleRDBMSServer {
    public:
     SimpleRDBMSServer(const std::string& db_file) {
         disk_manager_ = std::make_unique<DiskManager>(db_file);
-        log_disk_manager_ = std::make_unique<DiskManager>(db_file + ".log");
         replacer_ = std::make_unique<LRUReplacer>(BUFFER_POOL_SIZE);
         buffer_pool_manager_ = std::make_unique<BufferPoolManager>(
             BUFFER_POOL_SIZE, std::move(disk_manager_), std::move(replacer_));
 
-        log_manager_ = std::make_unique<LogManager>(log_disk_manager_.get());
+        log_manager_ = std::make_unique<LogManager>(db_file + ".log");
         lock_manager_ = std::make_unique<LockManager>();
         transaction_manager_ = std::make_unique<TransactionManager>(
             lock_manager_.get(), log_manager_.get());
@@ -40,13 +38,13 @@ class SimpleRDBMSServer {
         catalog_ = std::make_unique<Catalog>(buffer_pool_manager_.get(),
                                              log_manager_.get());
 
-        table_manager_ = std::make_unique<TableManager>(
-            buffer_pool_manager_.get(), catalog_.get());
-
         recovery_manager_ = std::make_unique<RecoveryManager>(
             buffer_pool_manager_.get(), catalog_.get(), log_manager_.get(),
             lock_manager_.get());
 
+        // 先恢复表数据，执行引擎打开索引时如果需要重建，看到的是恢复后的表
+        recovery_manager_->Recover();
+
         // 重要：传递log_manager_给execution_engine
         execution_engine_ = std::make_unique<ExecutionEngine>(
             buffer_pool_manager_.get(), catalog_.get(),
@@ -54,8 +52,6 @@ class SimpleRDBMSServer {
 
         LOG_INFO("Initializing statistics system");
         STATS.Reset();  // Start with clean statistics
-
-        recovery_manager_->Recover();
     }
 
     void Run() {
@@ -278,7 +274,11 @@ class SimpleRDBMSServer {
             // 特殊处理事务控制语句
             if (stmt_type == Statement::StmtType::BEGIN_TXN) {
                 // 不需要现有事务，直接开始新事务
-                auto* txn = transaction_manager_->Begin();
+                auto* begin_stmt =
+                    static_cast<BeginStatement*>(statement.get());
+                auto* txn = transaction_manager_->Begin(
+                    IsolationLevel::REPEATABLE_READ,
+                    begin_stmt->IsReadOnly());
                 std::cout << "Transaction started with ID: " << txn->GetTxnId()
                           << std::endl;
                 return;
@@ -297,8 +297,10 @@ class SimpleRDBMSServer {
                 return;
             }
 
-            // Begin transaction
-            auto* txn = transaction_manager_->Begin();
+            // Begin transaction，单独的SELECT走只读事务
+            auto* txn = transaction_manager_->Begin(
+                IsolationLevel::REPEATABLE_READ,
+                stmt_type == Statement::StmtType::SELECT);
 
             // Execute statement
             std::vector<Tuple> result_set;
@@ -336,6 +338,27 @@ class SimpleRDBMSServer {
                         std::cout << "DDL operation completed successfully."
                                   << std::endl;
                         break;
+                    case Statement::StmtType::ANALYZE:
+                        std::cout << "ANALYZE completed successfully."
+                                  << std::endl;
+                        break;
+                    case Statement::StmtType::VACUUM:
+                        std::cout << "VACUUM completed successfully."
+                                  << std::endl;
+                        break;
+                    case Statement::StmtType::COPY:
+                        DisplayCopyResults(result_set);
+                        break;
+                    case Statement::StmtType::PREPARE:
+                    case Statement::StmtType::DEALLOCATE:
+                        std::cout << "Prepared statement updated successfully."
+                                  << std::endl;
+                        break;
+                    case Statement::StmtType::EXECUTE:
+                        DisplayExecuteResults(
+                            result_set,
+                            static_cast<ExecuteStatement*>(statement.get()));
+                        break;
                     case Statement::StmtType::EXPLAIN:
                         DisplayExplainResults(result_set);
                         break;
@@ -351,6 +374,34 @@ class SimpleRDBMSServer {
         }
     }
 
+    // EXECUTE的结果按预编译语句本身的类型显示
+    void DisplayExecuteResults(const std::vector<Tuple>& result_set,
+                               ExecuteStatement* stmt) {
+        auto prepared = execution_engine_->GetPreparedStatement(stmt->GetName());
+        if (!prepared) {
+            return;
+        }
+        Statement* prepared_stmt = prepared->GetStatement();
+        switch (prepared_stmt->GetType()) {
+            case Statement::StmtType::SELECT:
+                DisplaySelectResults(
+                    result_set, static_cast<SelectStatement*>(prepared_stmt));
+                break;
+            case Statement::StmtType::INSERT:
+                DisplayInsertResults(result_set);
+                break;
+            case Statement::StmtType::UPDATE:
+                DisplayUpdateResults(
+                    result_set, static_cast<UpdateStatement*>(prepared_stmt));
+                break;
+            case Statement::StmtType::DELETE:
+                DisplayDeleteResults(result_set);
+                break;
+            default:
+                break;
+        }
+    }
+
     void DisplayExplainResults(const std::vector<Tuple>& result_set) {
         if (result_set.empty()) {
             std::cout << "No execution plan available." << std::endl;
@@ -478,6 +529,17 @@ class SimpleRDBMSServer {
             return;
         }
 
+        // 连接和聚合的结果按位置显示，连接的列名带上表名
+        bool has_aggregate = !select_stmt->GetGroupBy().empty();
+        for (const auto& expr : select_stmt->GetSelectList()) {
+            has_aggregate = has_aggregate ||
+                            dynamic_cast<FunctionCallExpression*>(expr.get());
+        }
+        if (select_stmt->HasJoin() || has_aggregate) {
+            DisplayJoinResults(result_set, select_stmt);
+            return;
+        }
+
         // 获取表信息和schema
         TableInfo* table_info = catalog_->GetTable(select_stmt->GetTableName());
         if (!table_info) {
@@ -556,12 +618,101 @@ class SimpleRDBMSServer {
                   << std::endl;
     }
 
+    // SELECT列表里一项的列名，聚合函数显示成 COUNT(*)、SUM(amount)
+    std::string SelectItemName(const Expression* expr) {
+        if (auto* col_ref = dynamic_cast<const ColumnRefExpression*>(expr)) {
+            return col_ref->GetTableName().empty()
+                       ? col_ref->GetColumnName()
+                       : col_ref->GetTableName() + "." +
+                             col_ref->GetColumnName();
+        }
+        if (auto* call = dynamic_cast<const FunctionCallExpression*>(expr)) {
+            std::string name = call->GetFunctionName() + "(";
+            if (call->IsStar()) {
+                name += "*";
+            }
+            for (size_t i = 0; i < call->GetArguments().size(); i++) {
+                name += (i > 0 ? ", " : "") +
+                        SelectItemName(call->GetArguments()[i].get());
+            }
+            return name + ")";
+        }
+        return "?column?";
+    }
+
+    // 显示 JOIN 和聚合查询的结果，结果tuple的列和SELECT列表一一对应，
+    // SELECT * 时是左表的列接着右表的列
+    void DisplayJoinResults(const std::vector<Tuple>& result_set,
+                            SelectStatement* select_stmt) {
+        std::vector<std::string> column_names;
+        const auto& select_list = select_stmt->GetSelectList();
+        auto* first = dynamic_cast<ColumnRefExpression*>(select_list[0].get());
+        if (select_list.size() == 1 && first &&
+            first->GetColumnName() == "*") {
+            for (const std::string& table_name :
+                 {select_stmt->GetTableName(),
+                  select_stmt->GetJoinTableName()}) {
+                TableInfo* table_info = catalog_->GetTable(table_name);
+                if (!table_info) {
+                    std::cout << "Table not found." << std::endl;
+                    return;
+                }
+                for (const auto& column : table_info->schema->GetColumns()) {
+                    column_names.push_back(table_name + "." + column.name);
+                }
+            }
+        } else {
+            for (const auto& expr : select_list) {
+                column_names.push_back(SelectItemName(expr.get()));
+            }
+        }
+
+        std::vector<size_t> column_widths;
+        for (const auto& name : column_names) {
+            column_widths.push_back(
+                std::max(name.length(), static_cast<size_t>(15)));
+        }
+
+        std::cout << "\n";
+        PrintSeparator(column_widths);
+        std::cout << "|";
+        for (size_t i = 0; i < column_names.size(); ++i) {
+            std::cout << " " << std::setw(column_widths[i]) << std::left
+                      << column_names[i] << " |";
+        }
+        std::cout << "\n";
+        PrintSeparator(column_widths);
+        for (const auto& tuple : result_set) {
+            std::cout << "|";
+            for (size_t i = 0; i < column_names.size(); ++i) {
+                std::cout << " " << std::setw(column_widths[i]) << std::left
+                          << (tuple.IsNull(i) ? std::string("NULL")
+                                              : ValueToString(tuple.GetValue(i)))
+                          << " |";
+            }
+            std::cout << "\n";
+        }
+        PrintSeparator(column_widths);
+
+        std::cout << "\n"
+                  << result_set.size() << " row(s) returned.\n"
+                  << std::endl;
+    }
+
     // 显示 INSERT 结果
     void DisplayInsertResults(const std::vector<Tuple>& result_set) {
         // INSERT 通常不返回数据，只显示影响的行数
         std::cout << "Insert operation completed." << std::endl;
     }
 
+    // 显示 COPY 结果
+    void DisplayCopyResults(const std::vector<Tuple>& result_set) {
+        int32_t count = result_set.empty()
+                            ? 0
+                            : std::get<int32_t>(result_set[0].GetValue(0));
+        std::cout << count << " row(s) copied." << std::endl;
+    }
+
     // 显示 UPDATE 结果
     void DisplayUpdateResults(const std::vector<Tuple>& result_set,
                               UpdateStatement* update_stmt) {
@@ -727,7 +878,6 @@ class SimpleRDBMSServer {
 
     // Storage components
     std::unique_ptr<DiskManager> disk_manager_;
-    std::unique_ptr<DiskManager> log_disk_manager_;
     std::unique_ptr<Replacer> replacer_;
     std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
     // Transaction components
@@ -737,7 +887,6 @@ class SimpleRDBMSServer {
     std::unique_ptr<RecoveryManager> recovery_manager_;
     // Catalog and execution
     std::unique_ptr<Catalog> catalog_;
-    std::unique_ptr<TableManager> table_manager_;
     std::unique_ptr<ExecutionEngine> execution_engine_;
 };
 
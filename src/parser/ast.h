@@ -11,6 +11,8 @@
 #include <string>
 #include <vector>
 
+#include "catalog/partition.h"
+#include "common/arena.h"
 #include "common/types.h"
 
 namespace SimpleRDBMS {
@@ -26,8 +28,10 @@ class ASTVisitor;
  * 1. 可以在不修改AST节点的情况下添加新的操作
  * 2. 将操作逻辑从数据结构中分离出来
  * 3. 方便实现代码生成、优化、解释执行等功能
+ *
+ * 有当前QueryArena时节点从查询的内存池分配，查询结束时一起释放
  */
-class ASTNode {
+class ASTNode : public ArenaAllocated {
    public:
     virtual ~ASTNode() = default;
 
@@ -59,7 +63,7 @@ class Expression : public ASTNode {
         COLUMN_REF,    // 列引用表达式
         BINARY_OP,     // 二元操作表达式
         UNARY_OP,      // 一元操作表达式
-        FUNCTION_CALL  // 函数调用表达式（暂未实现）
+        FUNCTION_CALL  // 函数调用表达式（目前只有聚合函数）
     };
 
     /**
@@ -86,17 +90,40 @@ class ConstantExpression : public Expression {
    public:
     explicit ConstantExpression(const Value& value) : value_(value) {}
 
+    /**
+     * 参数占位符 $n
+     * 同一个预编译语句里的 $n 共享一个槽位，复制表达式时也共享，
+     * EXECUTE把参数值写进槽位后，语句和缓存的执行计划里的所有 $n 都读到新值
+     * @param parameter_index 参数下标，从0开始（$1是0）
+     * @param parameter 参数值的槽位
+     */
+    ConstantExpression(size_t parameter_index,
+                       std::shared_ptr<const Value> parameter)
+        : parameter_index_(parameter_index),
+          parameter_(std::move(parameter)) {}
+
     ExprType GetType() const override { return ExprType::CONSTANT; }
     void Accept(ASTVisitor* visitor) override;
 
     /**
      * 获取常量值
-     * @return 存储的常量值
+     * @return 存储的常量值，参数占位符返回当前绑定的值
      */
-    const Value& GetValue() const { return value_; }
+    const Value& GetValue() const { return parameter_ ? *parameter_ : value_; }
+
+    /** 是否是参数占位符 */
+    bool IsParameter() const { return parameter_ != nullptr; }
+
+    size_t GetParameterIndex() const { return parameter_index_; }
+
+    const std::shared_ptr<const Value>& GetParameter() const {
+        return parameter_;
+    }
 
    private:
-    Value value_;  // 存储的常量值
+    Value value_;                // 存储的常量值
+    size_t parameter_index_ = 0;  // 参数下标，只对参数占位符有意义
+    std::shared_ptr<const Value> parameter_;  // 参数的槽位，普通常量为空
 };
 
 /**
@@ -156,7 +183,15 @@ class Statement : public ASTNode {
         BEGIN_TXN,     // 开始事务
         COMMIT_TXN,    // 提交事务
         ROLLBACK_TXN,  // 回滚事务
-        EXPLAIN        // 执行计划解释
+        EXPLAIN,       // 执行计划解释
+        ANALYZE,       // 收集统计信息
+        VACUUM,        // 回收表空间
+        COPY,          // 批量导入导出
+        PREPARE,       // 预编译语句
+        EXECUTE,       // 执行预编译语句
+        DEALLOCATE,    // 释放预编译语句
+        SET_VARIABLE,  // 设置会话变量
+        KILL           // 取消别的会话正在执行的查询
     };
 
     /**
@@ -172,16 +207,29 @@ class Statement : public ASTNode {
  * - 列选择（SELECT列表）
  * - 表指定（FROM子句）
  * - 条件过滤（WHERE子句）
+ * - 两张表的内连接（[INNER] JOIN ... ON）
+ * - 分组聚合（GROUP BY，COUNT/SUM/AVG/MIN/MAX）
+ * - 排序（ORDER BY ... [ASC|DESC]）和限制行数（LIMIT）
  *
  * 当前限制：
- * - 只支持单表查询，不支持JOIN
- * - 不支持GROUP BY、ORDER BY、LIMIT等子句
+ * - 一条语句最多连接两张表，只支持内连接
+ * - 不支持HAVING、OFFSET等子句
  *
  * 示例SQL：
  * SELECT id, name FROM users WHERE age > 18;
+ * SELECT status, COUNT(*) FROM orders GROUP BY status;
+ * SELECT id FROM events ORDER BY created_at DESC LIMIT 50;
+ * SELECT users.name, orders.amount FROM users JOIN orders
+ *     ON users.id = orders.user_id;
  */
 class SelectStatement : public Statement {
    public:
+    /** ORDER BY的一项 */
+    struct OrderByItem {
+        std::unique_ptr<Expression> expression;
+        bool ascending;
+    };
+
     SelectStatement(std::vector<std::unique_ptr<Expression>> select_list,
                     std::string table_name,
                     std::unique_ptr<Expression> where_clause = nullptr)
@@ -198,11 +246,52 @@ class SelectStatement : public Statement {
     const std::string& GetTableName() const { return table_name_; }
     Expression* GetWhereClause() const { return where_clause_.get(); }
 
+    /**
+     * 设置JOIN子句
+     * @param table_name JOIN的右表名
+     * @param condition ON条件
+     */
+    void SetJoin(std::string table_name,
+                 std::unique_ptr<Expression> condition) {
+        join_table_name_ = std::move(table_name);
+        join_condition_ = std::move(condition);
+    }
+
+    /** 设置GROUP BY列表 */
+    void SetGroupBy(std::vector<std::unique_ptr<Expression>> group_by) {
+        group_by_ = std::move(group_by);
+    }
+
+    const std::vector<std::unique_ptr<Expression>>& GetGroupBy() const {
+        return group_by_;
+    }
+
+    /** 设置ORDER BY列表 */
+    void SetOrderBy(std::vector<OrderByItem> order_by) {
+        order_by_ = std::move(order_by);
+    }
+
+    const std::vector<OrderByItem>& GetOrderBy() const { return order_by_; }
+
+    /** 设置LIMIT的行数 */
+    void SetLimit(int64_t limit) { limit_ = limit; }
+    bool HasLimit() const { return limit_ >= 0; }
+    int64_t GetLimit() const { return limit_; }
+
+    bool HasJoin() const { return !join_table_name_.empty(); }
+    const std::string& GetJoinTableName() const { return join_table_name_; }
+    Expression* GetJoinCondition() const { return join_condition_.get(); }
+
    private:
     std::vector<std::unique_ptr<Expression>>
         select_list_;                           // SELECT子句的列表达式
     std::string table_name_;                    // FROM子句的表名
     std::unique_ptr<Expression> where_clause_;  // WHERE子句，可选
+    std::string join_table_name_;               // JOIN的右表名，没有JOIN时为空
+    std::unique_ptr<Expression> join_condition_;  // JOIN的ON条件
+    std::vector<std::unique_ptr<Expression>> group_by_;  // GROUP BY列表
+    std::vector<OrderByItem> order_by_;                  // ORDER BY列表
+    int64_t limit_ = -1;  // LIMIT的行数，-1表示没有LIMIT
 };
 
 /**
@@ -222,22 +311,43 @@ class SelectStatement : public Statement {
  *     name VARCHAR(50) NOT NULL,
  *     age INT
  * );
+ * CREATE TABLE events (ts BIGINT, kind VARCHAR(16)) WITH (storage = column);
+ * CREATE TABLE notes (id INT, body VARCHAR(200)) WITH (compression = lz4);
+ * CREATE TABLE logs (id INT, day INT) PARTITION BY HASH (id) PARTITIONS 4;
+ * CREATE TABLE sales (id INT, day INT) PARTITION BY RANGE (day)
+ *     (VALUES LESS THAN (100), VALUES LESS THAN (MAXVALUE));
  */
 class CreateTableStatement : public Statement {
    public:
-    CreateTableStatement(const std::string& table_name,
-                         std::vector<Column> columns)
-        : table_name_(table_name), columns_(std::move(columns)) {}
+    CreateTableStatement(
+        const std::string& table_name, std::vector<Column> columns,
+        TableStorage storage = TableStorage::ROW,
+        PageCompression compression = PageCompression::NONE,
+        std::shared_ptr<const PartitionScheme> partition_scheme = nullptr)
+        : table_name_(table_name),
+          columns_(std::move(columns)),
+          storage_(storage),
+          compression_(compression),
+          partition_scheme_(std::move(partition_scheme)) {}
 
     StmtType GetType() const override { return StmtType::CREATE_TABLE; }
     void Accept(ASTVisitor* visitor) override;
 
     const std::string& GetTableName() const { return table_name_; }
     const std::vector<Column>& GetColumns() const { return columns_; }
+    TableStorage GetStorage() const { return storage_; }
+    PageCompression GetCompression() const { return compression_; }
+    // 分区方式，不是分区表时为空；分区列的位置和类型还没有填
+    const std::shared_ptr<const PartitionScheme>& GetPartitionScheme() const {
+        return partition_scheme_;
+    }
 
    private:
     std::string table_name_;       // 要创建的表名
     std::vector<Column> columns_;  // 列定义列表
+    TableStorage storage_;         // WITH (storage = ...) 指定的存储格式
+    PageCompression compression_;  // WITH (compression = ...) 指定的页面压缩
+    std::shared_ptr<const PartitionScheme> partition_scheme_;  // PARTITION BY
 };
 
 /**
@@ -256,19 +366,33 @@ class CreateTableStatement : public Statement {
  */
 class InsertStatement : public Statement {
    public:
+    /** VALUES里的一个参数占位符，生成计划时用绑定的值替换 */
+    struct ValueParameter {
+        size_t row;
+        size_t column;
+        std::shared_ptr<const Value> parameter;
+    };
+
     InsertStatement(const std::string& table_name,
-                    std::vector<std::vector<Value>> values)
-        : table_name_(table_name), values_(std::move(values)) {}
+                    std::vector<std::vector<Value>> values,
+                    std::vector<ValueParameter> parameters = {})
+        : table_name_(table_name),
+          values_(std::move(values)),
+          parameters_(std::move(parameters)) {}
 
     StmtType GetType() const override { return StmtType::INSERT; }
     void Accept(ASTVisitor* visitor) override;
 
     const std::string& GetTableName() const { return table_name_; }
     const std::vector<std::vector<Value>>& GetValues() const { return values_; }
+    const std::vector<ValueParameter>& GetParameters() const {
+        return parameters_;
+    }
 
    private:
     std::string table_name_;                  // 目标表名
     std::vector<std::vector<Value>> values_;  // 要插入的数据，支持多行
+    std::vector<ValueParameter> parameters_;  // VALUES里的参数占位符
 };
 
 /**
@@ -302,23 +426,32 @@ class DropTableStatement : public Statement {
  * 当前支持：
  * - 单列索引
  * - 唯一索引名称
+ * - 唯一索引（CREATE UNIQUE INDEX）和允许重复键的普通索引
  *
  * 未来扩展：
  * - 复合索引（多列）
- * - 唯一索引
  * - 部分索引
  *
  * 示例SQL：
  * CREATE INDEX idx_name ON users(name);
+ * CREATE UNIQUE INDEX idx_email ON users(email);
+ * CREATE UNIQUE INDEX idx_token ON sessions(token) USING HASH;
+ * CREATE INDEX idx_user ON orders(user_id) INCLUDE (status, total);
  */
 class CreateIndexStatement : public Statement {
    public:
     CreateIndexStatement(const std::string& index_name,
                          const std::string& table_name,
-                         const std::vector<std::string>& key_columns)
+                         const std::vector<std::string>& key_columns,
+                         bool is_unique = false,
+                         IndexType index_type = IndexType::BPLUS_TREE,
+                         const std::vector<std::string>& include_columns = {})
         : index_name_(index_name),
           table_name_(table_name),
-          key_columns_(key_columns) {}
+          key_columns_(key_columns),
+          include_columns_(include_columns),
+          is_unique_(is_unique),
+          index_type_(index_type) {}
 
     StmtType GetType() const override { return StmtType::CREATE_INDEX; }
     void Accept(ASTVisitor* visitor) override;
@@ -328,11 +461,19 @@ class CreateIndexStatement : public Statement {
     const std::vector<std::string>& GetKeyColumns() const {
         return key_columns_;
     }
+    const std::vector<std::string>& GetIncludeColumns() const {
+        return include_columns_;
+    }
+    bool IsUnique() const { return is_unique_; }
+    IndexType GetIndexType() const { return index_type_; }
 
    private:
     std::string index_name_;                // 索引名称
     std::string table_name_;                // 目标表名
     std::vector<std::string> key_columns_;  // 索引列名列表
+    std::vector<std::string> include_columns_;  // 只存储不参与查找的列
+    bool is_unique_;                        // 是否唯一索引
+    IndexType index_type_;                  // 索引结构
 };
 
 /**
@@ -532,6 +673,40 @@ class UnaryOpExpression : public Expression {
     std::unique_ptr<Expression> operand_;  // 操作数
 };
 
+/**
+ * 函数调用表达式
+ *
+ * 目前用于聚合函数：COUNT、SUM、AVG、MIN、MAX
+ * 函数名在解析时统一转成大写；COUNT(*)没有参数，IsStar()为true
+ *
+ * 使用场景：
+ * - SELECT COUNT(*) FROM orders
+ * - SELECT status, SUM(amount) FROM orders GROUP BY status
+ */
+class FunctionCallExpression : public Expression {
+   public:
+    FunctionCallExpression(std::string function_name,
+                           std::vector<std::unique_ptr<Expression>> arguments,
+                           bool is_star = false)
+        : function_name_(std::move(function_name)),
+          arguments_(std::move(arguments)),
+          is_star_(is_star) {}
+
+    ExprType GetType() const override { return ExprType::FUNCTION_CALL; }
+    void Accept(ASTVisitor* visitor) override;
+
+    const std::string& GetFunctionName() const { return function_name_; }
+    const std::vector<std::unique_ptr<Expression>>& GetArguments() const {
+        return arguments_;
+    }
+    bool IsStar() const { return is_star_; }
+
+   private:
+    std::string function_name_;                          // 大写的函数名
+    std::vector<std::unique_ptr<Expression>> arguments_;  // 参数列表
+    bool is_star_;                                       // 参数是 *
+};
+
 /**
  * SHOW TABLES语句
  *
@@ -556,12 +731,19 @@ class ShowTablesStatement : public Statement {
  *
  * 示例SQL：
  * BEGIN;
+ * BEGIN READ ONLY;
  */
 class BeginStatement : public Statement {
    public:
-    BeginStatement() = default;
+    explicit BeginStatement(bool read_only = false) : read_only_(read_only) {}
     StmtType GetType() const override { return StmtType::BEGIN_TXN; }
     void Accept(ASTVisitor* visitor) override;
+
+    /** BEGIN READ ONLY：只读事务，不写日志、不加锁 */
+    bool IsReadOnly() const { return read_only_; }
+
+   private:
+    bool read_only_;
 };
 
 /**
@@ -602,19 +784,252 @@ class RollbackStatement : public Statement {
  *
  * 示例SQL：
  * EXPLAIN SELECT * FROM users WHERE age > 18;
+ * EXPLAIN ANALYZE SELECT * FROM users WHERE age > 18;
  */
 class ExplainStatement : public Statement {
    public:
-    explicit ExplainStatement(std::unique_ptr<Statement> stmt)
-        : statement_(std::move(stmt)) {}
+    explicit ExplainStatement(std::unique_ptr<Statement> stmt,
+                              bool analyze = false)
+        : statement_(std::move(stmt)), analyze_(analyze) {}
 
     StmtType GetType() const override { return StmtType::EXPLAIN; }
     void Accept(ASTVisitor* visitor) override;
 
     Statement* GetStatement() const { return statement_.get(); }
 
+    /** EXPLAIN ANALYZE：真正执行语句，报告每个执行器的运行数据 */
+    bool IsAnalyze() const { return analyze_; }
+
    private:
     std::unique_ptr<Statement> statement_;  // 要解释的语句
+    bool analyze_;                          // 是否EXPLAIN ANALYZE
+};
+
+/**
+ * ANALYZE统计信息收集语句
+ *
+ * 扫描表收集行数、页面数和列统计，供优化器估计代价
+ * 不指定表名时收集所有表
+ *
+ * 示例SQL：
+ * ANALYZE users;
+ */
+class AnalyzeStatement : public Statement {
+   public:
+    explicit AnalyzeStatement(std::string table_name = "")
+        : table_name_(std::move(table_name)) {}
+
+    StmtType GetType() const override { return StmtType::ANALYZE; }
+    void Accept(ASTVisitor* visitor) override;
+
+    /** 表名，为空表示所有表 */
+    const std::string& GetTableName() const { return table_name_; }
+
+   private:
+    std::string table_name_;
+};
+
+/**
+ * VACUUM空间回收语句
+ *
+ * 整理表页面的碎片，合并稀疏页面并释放空出来的页面
+ * 不指定表名时处理所有行存表
+ *
+ * 示例SQL：
+ * VACUUM users;
+ */
+class VacuumStatement : public Statement {
+   public:
+    explicit VacuumStatement(std::string table_name = "")
+        : table_name_(std::move(table_name)) {}
+
+    StmtType GetType() const override { return StmtType::VACUUM; }
+    void Accept(ASTVisitor* visitor) override;
+
+    /** 表名，为空表示所有表 */
+    const std::string& GetTableName() const { return table_name_; }
+
+   private:
+    std::string table_name_;
+};
+
+/** COPY使用的文件格式 */
+enum class CopyFormat {
+    CSV,     // 文本，RFC 4180的引号规则，未加引号的空字段是NULL
+    BINARY,  // 文件头加上按行格式序列化的记录，见TableCopy
+};
+
+/**
+ * COPY批量导入导出语句
+ *
+ * FROM把文件里的记录批量装入表，TO把整张表写到文件
+ * 文件路径是服务器上的路径
+ *
+ * 示例SQL：
+ * COPY users FROM '/data/users.csv' WITH (format = csv, header = true);
+ * COPY users TO '/data/users.bin' WITH (format = binary);
+ */
+class CopyStatement : public Statement {
+   public:
+    CopyStatement(std::string table_name, std::string file_path, bool is_from)
+        : table_name_(std::move(table_name)),
+          file_path_(std::move(file_path)),
+          is_from_(is_from) {}
+
+    StmtType GetType() const override { return StmtType::COPY; }
+    void Accept(ASTVisitor* visitor) override;
+
+    const std::string& GetTableName() const { return table_name_; }
+    const std::string& GetFilePath() const { return file_path_; }
+
+    /** true表示COPY FROM（导入），false表示COPY TO（导出） */
+    bool IsFrom() const { return is_from_; }
+
+    CopyFormat GetFormat() const { return format_; }
+    void SetFormat(CopyFormat format) { format_ = format; }
+
+    /** CSV的字段分隔符 */
+    char GetDelimiter() const { return delimiter_; }
+    void SetDelimiter(char delimiter) { delimiter_ = delimiter; }
+
+    /** CSV的第一行是不是列名：导入时跳过，导出时写出 */
+    bool HasHeader() const { return header_; }
+    void SetHeader(bool header) { header_ = header; }
+
+   private:
+    std::string table_name_;
+    std::string file_path_;
+    bool is_from_;
+    CopyFormat format_ = CopyFormat::CSV;
+    char delimiter_ = ',';
+    bool header_ = false;
+};
+
+/**
+ * PREPARE预编译语句
+ *
+ * 语句只解析一次，里面的 $1、$2 ... 是参数占位符，
+ * 每个占位符对应parameters里的一个槽位，EXECUTE时把参数值写进槽位
+ *
+ * 示例SQL：
+ * PREPARE find_user AS SELECT * FROM users WHERE id = $1;
+ */
+class PrepareStatement : public Statement {
+   public:
+    PrepareStatement(std::string name, std::unique_ptr<Statement> stmt,
+                     std::vector<std::shared_ptr<Value>> parameters)
+        : name_(std::move(name)),
+          statement_(std::move(stmt)),
+          parameters_(std::move(parameters)) {}
+
+    StmtType GetType() const override { return StmtType::PREPARE; }
+    void Accept(ASTVisitor* visitor) override;
+
+    const std::string& GetName() const { return name_; }
+    Statement* GetStatement() const { return statement_.get(); }
+
+    /** 交出语句的所有权，预编译语句注册后由执行引擎保存 */
+    std::unique_ptr<Statement> ReleaseStatement() {
+        return std::move(statement_);
+    }
+
+    /** 参数槽位，下标i对应 $(i+1) */
+    std::vector<std::shared_ptr<Value>>& GetParameters() { return parameters_; }
+
+   private:
+    std::string name_;                               // 预编译语句名
+    std::unique_ptr<Statement> statement_;           // 被预编译的语句
+    std::vector<std::shared_ptr<Value>> parameters_;  // 参数槽位
+};
+
+/**
+ * EXECUTE执行预编译语句
+ *
+ * 只带参数值，不再解析语句文本
+ *
+ * 示例SQL：
+ * EXECUTE find_user (42);
+ */
+class ExecuteStatement : public Statement {
+   public:
+    ExecuteStatement(std::string name, std::vector<Value> arguments)
+        : name_(std::move(name)), arguments_(std::move(arguments)) {}
+
+    StmtType GetType() const override { return StmtType::EXECUTE; }
+    void Accept(ASTVisitor* visitor) override;
+
+    const std::string& GetName() const { return name_; }
+    const std::vector<Value>& GetArguments() const { return arguments_; }
+
+   private:
+    std::string name_;              // 预编译语句名
+    std::vector<Value> arguments_;  // 按 $1、$2 ... 顺序的参数值
+};
+
+/**
+ * DEALLOCATE释放预编译语句
+ *
+ * 示例SQL：
+ * DEALLOCATE find_user;
+ */
+class DeallocateStatement : public Statement {
+   public:
+    explicit DeallocateStatement(std::string name) : name_(std::move(name)) {}
+
+    StmtType GetType() const override { return StmtType::DEALLOCATE; }
+    void Accept(ASTVisitor* visitor) override;
+
+    const std::string& GetName() const { return name_; }
+
+   private:
+    std::string name_;  // 预编译语句名
+};
+
+/**
+ * SET设置会话变量
+ *
+ * 值按原样保存成字符串，由服务器按变量名检查和解释
+ *
+ * 示例SQL：
+ * SET statement_timeout = 5000;
+ * SET statement_timeout TO '30s';
+ */
+class SetStatement : public Statement {
+   public:
+    SetStatement(std::string name, std::string value)
+        : name_(std::move(name)), value_(std::move(value)) {}
+
+    StmtType GetType() const override { return StmtType::SET_VARIABLE; }
+    void Accept(ASTVisitor* visitor) override;
+
+    const std::string& GetName() const { return name_; }
+    const std::string& GetValue() const { return value_; }
+
+   private:
+    std::string name_;   // 变量名，转换成小写
+    std::string value_;  // 变量值
+};
+
+/**
+ * KILL取消别的会话正在执行的查询
+ *
+ * 只停下那个会话当前的语句，连接和会话保持不变
+ *
+ * 示例SQL：
+ * KILL QUERY '3f2a...';
+ */
+class KillStatement : public Statement {
+   public:
+    explicit KillStatement(std::string session_id)
+        : session_id_(std::move(session_id)) {}
+
+    StmtType GetType() const override { return StmtType::KILL; }
+    void Accept(ASTVisitor* visitor) override;
+
+    const std::string& GetSessionId() const { return session_id_; }
+
+   private:
+    std::string session_id_;  // 要取消的查询所在的会话
 };
 
 /**
@@ -642,6 +1057,7 @@ class ASTVisitor {
     virtual void Visit(ColumnRefExpression* expr) = 0;
     virtual void Visit(BinaryOpExpression* expr) = 0;
     virtual void Visit(UnaryOpExpression* expr) = 0;
+    virtual void Visit(FunctionCallExpression* expr) = 0;
 
     // 语句节点访问方法
     virtual void Visit(SelectStatement* stmt) = 0;
@@ -657,6 +1073,14 @@ class ASTVisitor {
     virtual void Visit(CommitStatement* stmt) = 0;
     virtual void Visit(RollbackStatement* stmt) = 0;
     virtual void Visit(ExplainStatement* stmt) = 0;
+    virtual void Visit(AnalyzeStatement* stmt) = 0;
+    virtual void Visit(VacuumStatement* stmt) = 0;
+    virtual void Visit(CopyStatement* stmt) = 0;
+    virtual void Visit(PrepareStatement* stmt) = 0;
+    virtual void Visit(ExecuteStatement* stmt) = 0;
+    virtual void Visit(DeallocateStatement* stmt) = 0;
+    virtual void Visit(SetStatement* stmt) = 0;
+    virtual void Visit(KillStatement* stmt) = 0;
 };
 
 }  // namespace SimpleRDBMS
\ No newline at end of file
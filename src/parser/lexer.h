@@ -7,9 +7,13 @@
 
 #pragma once
 
+#include <deque>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "common/types.h"
+
 namespace SimpleRDBMS {
 
 /**
@@ -29,6 +33,14 @@ enum class TokenType {
     SELECT,  // SELECT关键字，用于查询语句
     FROM,    // FROM关键字，指定查询的表
     WHERE,   // WHERE关键字，指定过滤条件
+    JOIN,    // JOIN关键字，连接两张表
+    INNER,   // INNER关键字，INNER JOIN，可以省略
+    GROUP,   // GROUP关键字，GROUP BY分组
+    BY,      // BY关键字，配合GROUP、ORDER使用
+    ORDER,   // ORDER关键字，ORDER BY排序
+    ASC,     // ASC关键字，升序（默认）
+    DESC,    // DESC关键字，降序
+    LIMIT,   // LIMIT关键字，限制返回的行数
 
     // SQL关键字 - 数据操作
     INSERT,  // INSERT关键字，插入数据
@@ -44,10 +56,12 @@ enum class TokenType {
     DROP,    // DROP关键字，删除数据库对象
     INDEX,   // INDEX关键字，索引对象
     ON,      // ON关键字，指定索引的列
+    USING,   // USING关键字，指定索引结构（HASH / BTREE）
 
     // SQL关键字 - 约束和属性
     PRIMARY,  // PRIMARY关键字，主键约束
     KEY,      // KEY关键字，配合PRIMARY使用
+    UNIQUE,   // UNIQUE关键字，唯一索引
     NOT,      // NOT关键字，否定操作符
     _NULL,    // NULL关键字，空值（加下划线避免与C++关键字冲突）
 
@@ -62,6 +76,7 @@ enum class TokenType {
     // 逻辑操作符
     AND,  // AND逻辑操作符，逻辑与
     OR,   // OR逻辑操作符，逻辑或
+    BETWEEN,  // BETWEEN范围比较，col BETWEEN a AND b
 
     // 比较操作符
     EQUALS,          // = 等于操作符
@@ -92,6 +107,7 @@ enum class TokenType {
     COMMA,      // , 逗号分隔符
     SEMICOLON,  // ; 语句结束符
     STAR,       // * 星号（SELECT *中使用）
+    DOT,        // . 点号，table.column中分隔表名和列名
 
     // 特殊token
     EOF_TOKEN,  // 文件结束标记
@@ -108,6 +124,16 @@ enum class TokenType {
 
     // 查询计划相关
     EXPLAIN,  // EXPLAIN关键字，显示执行计划
+    ANALYZE,  // ANALYZE关键字，收集统计信息
+    VACUUM,   // VACUUM关键字，回收表空间
+    COPY,     // COPY关键字，批量导入导出
+
+    // 预编译语句
+    PREPARE,     // PREPARE关键字，预编译语句
+    EXECUTE,     // EXECUTE关键字，执行预编译语句
+    DEALLOCATE,  // DEALLOCATE关键字，释放预编译语句
+    AS,          // AS关键字，PREPARE name AS statement
+    PARAMETER,   // 参数占位符 $n，value是n
 };
 
 /**
@@ -120,16 +146,21 @@ enum class TokenType {
  * - value：token的原始文本值，用于获取具体内容（如标识符名称、字面量值）
  * - line/column：位置信息，用于错误报告和调试
  *
+ * value不持有文本，指向词法分析器输入里的那一段（字符串字面量去掉引号，
+ * 布尔字面量指向静态的"TRUE"/"FALSE"），只有带转义的字符串字面量
+ * 指向词法分析器自己保存的转义结果。token只在词法分析器和它的输入
+ * 都还活着时有效，要保存下来的名称和值由语法分析器拷贝成std::string
+ *
  * 使用场景：
  * - 语法分析器根据type进行语法规则匹配
  * - 语义分析时使用value获取具体的名称或值
  * - 错误报告时使用line/column定位错误位置
  */
 struct Token {
-    TokenType type;     // token类型
-    std::string value;  // token的文本值
-    size_t line;        // 所在行号（从1开始）
-    size_t column;      // 所在列号（从1开始）
+    TokenType type;          // token类型
+    std::string_view value;  // token的文本值，指向输入缓冲区
+    size_t line;             // 所在行号（从1开始）
+    size_t column;           // 所在列号（从1开始）
 };
 
 /**
@@ -150,19 +181,24 @@ struct Token {
  * - 大小写不敏感的关键字识别
  * - 支持单引号和双引号字符串
  * - 详细的位置跟踪用于错误报告
+ * - 不拷贝：token的value是输入上的string_view，扫描过程中不分配内存
+ *   （带转义的字符串字面量除外）
+ * - 关键字用编译期生成的完美哈希表识别，不区分大小写地比较一次即可，
+ *   不需要先转成大写的副本
  */
 class Lexer {
    public:
     /**
      * 构造函数
-     * @param input 要分析的SQL文本
+     * @param input 要分析的SQL文本，不拷贝，
+     *              在词法分析器和它产生的token用完之前必须一直有效
      *
      * 初始化词法分析器的状态：
-     * - 保存输入文本
+     * - 记下输入文本的位置
      * - 设置扫描位置为开始
      * - 初始化行号和列号
      */
-    explicit Lexer(const std::string& input);
+    explicit Lexer(std::string_view input);
 
     /**
      * 获取下一个token
@@ -178,11 +214,44 @@ class Lexer {
      */
     Token NextToken();
 
+    /**
+     * 计算查询的指纹：把字面量换成参数占位符后的规范化文本
+     * @param sql SQL文本
+     * @param literals 输出参数，按出现顺序的字面量值，第i个对应 $(i+1)
+     * @return 规范化文本，token之间用一个空格分隔，关键字转成大写，
+     *         字面量换成 $1、$2 ...，去掉末尾的分号；
+     *         不是SELECT、INSERT、UPDATE、DELETE，或者有词法错误、
+     *         已经带参数占位符时返回空字符串
+     *
+     * 只差在常量上的查询得到相同的指纹，返回的文本可以直接PREPARE，
+     * 用来让这些查询共享一个参数化的计划
+     */
+    static std::string Fingerprint(const std::string& sql,
+                                   std::vector<Value>* literals);
+
+    /**
+     * 把字面量token转换成值
+     * 整数是INTEGER，浮点数是DOUBLE，字符串是VARCHAR
+     * @throws std::exception 整数超出范围时
+     */
+    static Value LiteralValue(const Token& token);
+
+    /**
+     * 查找关键字，不区分大小写
+     * @param word 标识符文本
+     * @param type 输出参数，是关键字时写入对应的token类型
+     * @return 是否是关键字
+     */
+    static bool LookupKeyword(std::string_view word, TokenType* type);
+
    private:
-    std::string input_;  // 输入的SQL文本
-    size_t position_;    // 当前扫描位置
-    size_t line_;        // 当前行号
-    size_t column_;      // 当前列号
+    std::string_view input_;  // 输入的SQL文本
+    size_t position_;         // 当前扫描位置
+    size_t line_;             // 当前行号
+    size_t column_;           // 当前列号
+    // 带转义的字符串字面量转义后的文本，deque追加时不移动已有的元素，
+    // 之前返回的token仍然有效
+    std::deque<std::string> unescaped_;
 
     /**
      * 查看当前位置的字符但不前进
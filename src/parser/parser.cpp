@@ -9,9 +9,13 @@
 
 #include <algorithm>
 #include <cctype>
-#include <unordered_map>
+#include <charconv>
+#include <stdexcept>
 
+#include "common/arena.h"
 #include "common/exception.h"
+#include "execution/expression_cloner.h"
+#include "storage/page_compression.h"
 
 namespace SimpleRDBMS {
 
@@ -42,24 +46,42 @@ void DeleteStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
 
 void UnaryOpExpression::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
 
+void FunctionCallExpression::Accept(ASTVisitor* visitor) {
+    visitor->Visit(this);
+}
+
 // ==================== 词法分析器实现 ====================
 
+namespace {
+
 /**
- * SQL关键字映射表
+ * SQL关键字表
  *
- * 将SQL关键字字符串映射到对应的Token类型
- * 使用static确保只初始化一次，提高性能
+ * 将SQL关键字映射到对应的Token类型，拼写一律大写
  *
  * 设计要点：
  * - 支持常见的数据类型别名（如INTEGER -> INT, BOOL -> BOOLEAN）
  * - 包含布尔字面量TRUE/FALSE
  * - 涵盖了基本的DDL/DML/TCL命令
  */
-static std::unordered_map<std::string, TokenType> keywords = {
+struct KeywordEntry {
+    std::string_view text;
+    TokenType type;
+};
+
+constexpr KeywordEntry kKeywords[] = {
     // DML查询相关
     {"SELECT", TokenType::SELECT},
     {"FROM", TokenType::FROM},
     {"WHERE", TokenType::WHERE},
+    {"JOIN", TokenType::JOIN},
+    {"INNER", TokenType::INNER},
+    {"GROUP", TokenType::GROUP},
+    {"BY", TokenType::BY},
+    {"ORDER", TokenType::ORDER},
+    {"ASC", TokenType::ASC},
+    {"DESC", TokenType::DESC},
+    {"LIMIT", TokenType::LIMIT},
 
     // DML数据操作
     {"INSERT", TokenType::INSERT},
@@ -75,10 +97,12 @@ static std::unordered_map<std::string, TokenType> keywords = {
     {"DROP", TokenType::DROP},
     {"INDEX", TokenType::INDEX},
     {"ON", TokenType::ON},
+    {"USING", TokenType::USING},
 
     // 约束和属性
     {"PRIMARY", TokenType::PRIMARY},
     {"KEY", TokenType::KEY},
+    {"UNIQUE", TokenType::UNIQUE},
     {"NOT", TokenType::NOT},
     {"NULL", TokenType::_NULL},
 
@@ -95,6 +119,7 @@ static std::unordered_map<std::string, TokenType> keywords = {
     // 逻辑操作符
     {"AND", TokenType::AND},
     {"OR", TokenType::OR},
+    {"BETWEEN", TokenType::BETWEEN},
 
     // 布尔字面量
     {"TRUE", TokenType::BOOLEAN_LITERAL},
@@ -111,13 +136,124 @@ static std::unordered_map<std::string, TokenType> keywords = {
 
     // 查询计划
     {"EXPLAIN", TokenType::EXPLAIN},
+    {"ANALYZE", TokenType::ANALYZE},
+    {"VACUUM", TokenType::VACUUM},
+    {"COPY", TokenType::COPY},
+
+    // 预编译语句
+    {"PREPARE", TokenType::PREPARE},
+    {"EXECUTE", TokenType::EXECUTE},
+    {"DEALLOCATE", TokenType::DEALLOCATE},
+    {"AS", TokenType::AS},
 };
 
+constexpr size_t kKeywordCount = sizeof(kKeywords) / sizeof(kKeywords[0]);
+
+// 哈希表的槽位数，2的幂；比关键字数大得多，很快能找到没有冲突的种子
+constexpr size_t kKeywordSlots = 512;
+
+constexpr size_t LongestKeyword() {
+    size_t longest = 0;
+    for (const KeywordEntry& entry : kKeywords) {
+        longest = std::max(longest, entry.text.size());
+    }
+    return longest;
+}
+
+// 比它长的标识符不可能是关键字，不用算哈希
+constexpr size_t kMaxKeywordLength = LongestKeyword();
+
+constexpr char AsciiUpper(char ch) {
+    return ch >= 'a' && ch <= 'z' ? static_cast<char>(ch - 'a' + 'A') : ch;
+}
+
+/** 不区分大小写的哈希，seed不同得到不同的哈希函数 */
+constexpr uint32_t KeywordHash(std::string_view word, uint32_t seed) {
+    uint32_t hash = static_cast<uint32_t>(word.size());
+    for (char ch : word) {
+        hash = hash * seed + static_cast<uint8_t>(AsciiUpper(ch));
+    }
+    hash ^= hash >> 15;
+    hash *= 0x2C1B3C6Du;
+    hash ^= hash >> 12;
+    return hash & (kKeywordSlots - 1);
+}
+
+struct KeywordTable {
+    uint32_t seed;
+    int8_t slots[kKeywordSlots];  // 关键字在kKeywords里的下标，-1表示空
+};
+
+/**
+ * 生成关键字的完美哈希表
+ * 实现思路：和gperf一样，离线找一个让所有关键字落到不同槽位的哈希函数，
+ * 只不过搜索放在编译期做：从小到大试奇数种子，第一个没有冲突的就用它。
+ * 关键字表改了以后重新编译就会重新搜索，找不到时static_assert报错
+ */
+constexpr KeywordTable BuildKeywordTable() {
+    KeywordTable table{};
+    for (uint32_t seed = 3; seed < 1u << 16; seed += 2) {
+        for (int8_t& slot : table.slots) {
+            slot = -1;
+        }
+        bool collision = false;
+        for (size_t i = 0; i < kKeywordCount && !collision; i++) {
+            int8_t& slot = table.slots[KeywordHash(kKeywords[i].text, seed)];
+            collision = slot != -1;
+            slot = static_cast<int8_t>(i);
+        }
+        if (!collision) {
+            table.seed = seed;
+            return table;
+        }
+    }
+    table.seed = 0;
+    return table;
+}
+
+constexpr KeywordTable kKeywordTable = BuildKeywordTable();
+
+static_assert(kKeywordCount < 128, "keyword index must fit in int8_t");
+static_assert(kKeywordTable.seed != 0, "no perfect hash for the keywords");
+
+bool IsDigit(char ch) { return ch >= '0' && ch <= '9'; }
+
+bool IsIdentifierChar(char ch) {
+    return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_';
+}
+
+}  // namespace
+
+/**
+ * 查找关键字
+ * 一次哈希定位到唯一可能的关键字，再不区分大小写地比较一遍
+ */
+bool Lexer::LookupKeyword(std::string_view word, TokenType* type) {
+    if (word.empty() || word.size() > kMaxKeywordLength) {
+        return false;
+    }
+    int8_t index = kKeywordTable.slots[KeywordHash(word, kKeywordTable.seed)];
+    if (index < 0) {
+        return false;
+    }
+    std::string_view keyword = kKeywords[index].text;
+    if (keyword.size() != word.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < word.size(); i++) {
+        if (AsciiUpper(word[i]) != keyword[i]) {
+            return false;
+        }
+    }
+    *type = kKeywords[index].type;
+    return true;
+}
+
 /**
  * 词法分析器构造函数
  * 初始化扫描状态为起始位置
  */
-Lexer::Lexer(const std::string& input)
+Lexer::Lexer(std::string_view input)
     : input_(input), position_(0), line_(1), column_(1) {}
 
 /**
@@ -157,7 +293,7 @@ char Lexer::Advance() {
  * 空白字符包括空格、制表符、换行符等，在SQL中只起分隔作用
  */
 void Lexer::SkipWhitespace() {
-    while (std::isspace(Peek())) {
+    while (std::isspace(static_cast<unsigned char>(Peek()))) {
         Advance();
     }
 }
@@ -171,26 +307,28 @@ void Lexer::SkipWhitespace() {
  * 1. 扫描连续的数字字符
  * 2. 如果遇到小数点，标记为浮点数并继续扫描
  * 3. 最多只允许一个小数点
+ * 4. value直接取输入上扫过的那一段
  */
 Token Lexer::ScanNumber() {
     Token token;
     token.line = line_;
     token.column = column_;
 
-    std::string value;
+    size_t start = position_;
     bool has_dot = false;  // 是否已经遇到小数点
 
-    // 扫描数字和小数点
-    while (std::isdigit(Peek()) || Peek() == '.') {
+    // 扫描数字和小数点，数字里没有换行，直接移动位置
+    while (IsDigit(Peek()) || Peek() == '.') {
         if (Peek() == '.') {
             // 如果已经有小数点了，就停止扫描
             if (has_dot) break;
             has_dot = true;
         }
-        value += Advance();
+        position_++;
     }
+    column_ += position_ - start;
 
-    token.value = value;
+    token.value = input_.substr(start, position_ - start);
     // 根据是否有小数点决定token类型
     token.type =
         has_dot ? TokenType::FLOAT_LITERAL : TokenType::INTEGER_LITERAL;
@@ -209,6 +347,9 @@ Token Lexer::ScanNumber() {
  * \\ -> 反斜杠
  * \' -> 单引号
  * \" -> 双引号
+ *
+ * 没有转义字符时value就是两个引号之间的输入；
+ * 有转义时才把转义结果存进unescaped_，value指向它
  */
 Token Lexer::ScanString() {
     Token token;
@@ -217,8 +358,23 @@ Token Lexer::ScanString() {
     token.type = TokenType::STRING_LITERAL;
 
     char quote = Advance();  // 记住开始的引号类型
-    std::string value;
+    size_t start = position_;
 
+    // 先按没有转义字符扫描，大多数字符串到这里就结束了
+    while (Peek() != quote && Peek() != '\\' && Peek() != '\0') {
+        Advance();
+    }
+    if (Peek() != '\\') {
+        token.value = input_.substr(start, position_ - start);
+        // 如果找到了结束引号，跳过它
+        // 注意：如果没有找到结束引号，这里应该报错，但当前实现比较宽松
+        if (Peek() == quote) {
+            Advance();
+        }
+        return token;
+    }
+
+    std::string value(input_.substr(start, position_ - start));
     // 扫描直到遇到匹配的结束引号
     while (Peek() != quote && Peek() != '\0') {
         if (Peek() == '\\') {
@@ -258,9 +414,9 @@ Token Lexer::ScanString() {
     if (Peek() == quote) {
         Advance();
     }
-    // 注意：如果没有找到结束引号，这里应该报错，但当前实现比较宽松
 
-    token.value = value;
+    unescaped_.push_back(std::move(value));
+    token.value = unescaped_.back();
     return token;
 }
 
@@ -271,7 +427,7 @@ Token Lexer::ScanString() {
  *
  * 处理流程：
  * 1. 扫描连续的字母、数字、下划线字符
- * 2. 将结果转换为大写并查找关键字表
+ * 2. 在关键字的完美哈希表里查找（不区分大小写）
  * 3. 如果是关键字，返回对应的关键字token
  * 4. 否则返回IDENTIFIER token
  */
@@ -280,31 +436,21 @@ Token Lexer::ScanIdentifier() {
     token.line = line_;
     token.column = column_;
 
-    std::string value;
-    // 扫描标识符字符（字母、数字、下划线）
-    while (std::isalnum(Peek()) || Peek() == '_') {
-        value += Advance();
+    size_t start = position_;
+    // 扫描标识符字符（字母、数字、下划线），标识符里没有换行
+    while (IsIdentifierChar(Peek())) {
+        position_++;
     }
+    column_ += position_ - start;
+    token.value = input_.substr(start, position_ - start);
 
-    // 转换为大写用于关键字查找（SQL关键字不区分大小写）
-    std::string upper_value = value;
-    std::transform(upper_value.begin(), upper_value.end(), upper_value.begin(),
-                   ::toupper);
-
-    // 查找是否为关键字
-    auto it = keywords.find(upper_value);
-    if (it != keywords.end()) {
-        token.type = it->second;
-        // 布尔字面量使用大写值，其他关键字保持原始大小写
-        if (token.type == TokenType::BOOLEAN_LITERAL) {
-            token.value = upper_value;
-        } else {
-            token.value = value;
-        }
-    } else {
+    // 查找是否为关键字（SQL关键字不区分大小写）
+    if (!LookupKeyword(token.value, &token.type)) {
         // 不是关键字，就是普通标识符
         token.type = TokenType::IDENTIFIER;
-        token.value = value;
+    } else if (token.type == TokenType::BOOLEAN_LITERAL) {
+        // 布尔字面量使用大写值，其他关键字保持原始大小写
+        token.value = AsciiUpper(token.value[0]) == 'T' ? "TRUE" : "FALSE";
     }
 
     return token;
@@ -319,7 +465,7 @@ Token Lexer::ScanIdentifier() {
  * 1. 跳过空白字符
  * 2. 根据第一个字符判断token类型
  * 3. 调用相应的扫描方法
- * 4. 处理多字符操作符（如<=、>=、!=、<>）
+ * 4. 处理多字符操作符（如<=、>=、!=、<>），value是输入上的操作符文本
  */
 Token Lexer::NextToken() {
     SkipWhitespace();
@@ -336,12 +482,12 @@ Token Lexer::NextToken() {
     }
 
     // 数字字面量
-    if (std::isdigit(ch)) {
+    if (IsDigit(ch)) {
         return ScanNumber();
     }
 
     // 标识符或关键字
-    if (std::isalpha(ch) || ch == '_') {
+    if (std::isalpha(static_cast<unsigned char>(ch)) || ch == '_') {
         return ScanIdentifier();
     }
 
@@ -350,59 +496,65 @@ Token Lexer::NextToken() {
         return ScanString();
     }
 
+    size_t start = position_;
+
+    // 参数占位符 $n，n从1开始
+    if (ch == '$') {
+        Advance();
+        while (IsDigit(Peek())) {
+            Advance();
+        }
+        token.value = input_.substr(start + 1, position_ - start - 1);
+        token.type = token.value.empty() || token.value == "0"
+                         ? TokenType::INVALID
+                         : TokenType::PARAMETER;
+        return token;
+    }
+
     // 其他单字符或多字符token
     Advance();
     switch (ch) {
         case '(':
             token.type = TokenType::LPAREN;
-            token.value = "(";
             break;
         case ')':
             token.type = TokenType::RPAREN;
-            token.value = ")";
             break;
         case ',':
             token.type = TokenType::COMMA;
-            token.value = ",";
             break;
         case ';':
             token.type = TokenType::SEMICOLON;
-            token.value = ";";
+            break;
+        case '.':
+            token.type = TokenType::DOT;
             break;
         case '*':
             // 乘法操作符（也用于SELECT *）
             token.type = TokenType::MULTIPLY;
-            token.value = "*";
             break;
         case '+':
             token.type = TokenType::PLUS;
-            token.value = "+";
             break;
         case '-':
             token.type = TokenType::MINUS;
-            token.value = "-";
             break;
         case '/':
             token.type = TokenType::DIVIDE;
-            token.value = "/";
             break;
         case '=':
             token.type = TokenType::EQUALS;
-            token.value = "=";
             break;
         case '<':
             // 处理 <、<=、<> 三种情况
             if (Peek() == '=') {
                 Advance();
                 token.type = TokenType::LESS_EQUALS;
-                token.value = "<=";
             } else if (Peek() == '>') {
                 Advance();
                 token.type = TokenType::NOT_EQUALS;
-                token.value = "<>";
             } else {
                 token.type = TokenType::LESS_THAN;
-                token.value = "<";
             }
             break;
         case '>':
@@ -410,10 +562,8 @@ Token Lexer::NextToken() {
             if (Peek() == '=') {
                 Advance();
                 token.type = TokenType::GREATER_EQUALS;
-                token.value = ">=";
             } else {
                 token.type = TokenType::GREATER_THAN;
-                token.value = ">";
             }
             break;
         case '!':
@@ -421,29 +571,129 @@ Token Lexer::NextToken() {
             if (Peek() == '=') {
                 Advance();
                 token.type = TokenType::NOT_EQUALS;
-                token.value = "!=";
             } else {
                 // 单独的!不是有效的SQL操作符
                 token.type = TokenType::INVALID;
-                token.value = "!";
             }
             break;
         default:
             // 未识别的字符
             token.type = TokenType::INVALID;
-            token.value = std::string(1, ch);
             break;
     }
+    token.value = input_.substr(start, position_ - start);
     return token;
 }
 
+/**
+ * 把字面量token转换成值
+ * 数字直接从token指向的输入上解析，不构造临时字符串
+ */
+Value Lexer::LiteralValue(const Token& token) {
+    const char* begin = token.value.data();
+    const char* end = begin + token.value.size();
+    switch (token.type) {
+        case TokenType::INTEGER_LITERAL: {
+            int32_t integer = 0;
+            auto [ptr, ec] = std::from_chars(begin, end, integer);
+            if (ec == std::errc::result_out_of_range) {
+                throw std::out_of_range("integer literal out of range: " +
+                                        std::string(token.value));
+            }
+            if (ec != std::errc() || ptr != end) {
+                throw std::invalid_argument("invalid integer literal: " +
+                                            std::string(token.value));
+            }
+            return Value(integer);
+        }
+        case TokenType::FLOAT_LITERAL: {
+            double real = 0;
+            auto [ptr, ec] = std::from_chars(begin, end, real);
+            if (ec != std::errc()) {
+                throw std::invalid_argument("invalid float literal: " +
+                                            std::string(token.value));
+            }
+            return Value(real);
+        }
+        default:
+            return Value(std::string(token.value));
+    }
+}
+
+/**
+ * 计算查询指纹
+ * 实现思路：
+ * 1. 逐个取token，第一个token决定语句类型，只处理DML
+ * 2. 数字和字符串字面量换成 $n，值放进literals；布尔字面量、
+ *    标识符、操作符原样保留，关键字统一成大写
+ * 3. 负号不并进字面量，-5 规范化成 - $1，和解析器的处理一致
+ */
+std::string Lexer::Fingerprint(const std::string& sql,
+                               std::vector<Value>* literals) {
+    literals->clear();
+    Lexer lexer(sql);
+    Token token = lexer.NextToken();
+    if (token.type != TokenType::SELECT && token.type != TokenType::INSERT &&
+        token.type != TokenType::UPDATE && token.type != TokenType::DELETE) {
+        return "";
+    }
+
+    std::string fingerprint;
+    fingerprint.reserve(sql.size());
+    try {
+        while (token.type != TokenType::EOF_TOKEN) {
+            if (token.type == TokenType::SEMICOLON) {
+                // 分号之后只能是结尾，否则交给解析器报错
+                token = lexer.NextToken();
+                if (token.type != TokenType::EOF_TOKEN) {
+                    literals->clear();
+                    return "";
+                }
+                break;
+            }
+            if (!fingerprint.empty()) {
+                fingerprint += ' ';
+            }
+            switch (token.type) {
+                case TokenType::INVALID:
+                case TokenType::PARAMETER:
+                    literals->clear();
+                    return "";
+                case TokenType::INTEGER_LITERAL:
+                case TokenType::FLOAT_LITERAL:
+                case TokenType::STRING_LITERAL:
+                    literals->push_back(LiteralValue(token));
+                    fingerprint += '$';
+                    fingerprint += std::to_string(literals->size());
+                    break;
+                case TokenType::IDENTIFIER:
+                    fingerprint += token.value;
+                    break;
+                default:
+                    for (char ch : token.value) {
+                        fingerprint += AsciiUpper(ch);
+                    }
+                    break;
+            }
+            token = lexer.NextToken();
+        }
+    } catch (const std::exception&) {
+        // 整数字面量超出范围，交给解析器报错
+        literals->clear();
+        return "";
+    }
+    return fingerprint;
+}
+
 // ==================== 语法分析器实现 ====================
 
 /**
  * 语法分析器构造函数
  * 初始化词法分析器并读取第一个token
  */
-Parser::Parser(const std::string& sql) : lexer_(sql) { Advance(); }
+Parser::Parser(const std::string& sql) : sql_(sql), lexer_(sql_) {
+    Advance();
+}
 
 /**
  * 读取下一个token
@@ -472,7 +722,8 @@ bool Parser::Match(TokenType type) {
  */
 void Parser::Expect(TokenType type) {
     if (!Match(type)) {
-        throw Exception("Unexpected token: " + current_token_.value);
+        throw Exception("Unexpected token: " +
+                        std::string(current_token_.value));
     }
 }
 
@@ -484,6 +735,11 @@ void Parser::Expect(TokenType type) {
 std::unique_ptr<Statement> Parser::Parse() {
     auto stmt = ParseStatement();
 
+    // 参数占位符只能出现在PREPARE的语句里，PREPARE会把槽位取走
+    if (!parameters_.empty()) {
+        throw Exception("Parameter placeholders are only allowed in PREPARE");
+    }
+
     // 确保语句结束时到达文件末尾或分号
     if (current_token_.type != TokenType::EOF_TOKEN &&
         current_token_.type != TokenType::SEMICOLON) {
@@ -494,7 +750,10 @@ std::unique_ptr<Statement> Parser::Parse() {
 
 /**
  * 解析SELECT查询语句
- * 语法：SELECT column_list FROM table_name [WHERE condition]
+ * 语法：SELECT column_list FROM table_name
+ *       [[INNER] JOIN table_name ON condition] [WHERE condition]
+ *       [GROUP BY expression_list]
+ *       [ORDER BY expression [ASC|DESC], ...] [LIMIT count]
  * @return SelectStatement AST节点
  */
 std::unique_ptr<Statement> Parser::ParseSelectStatement() {
@@ -520,22 +779,84 @@ std::unique_ptr<Statement> Parser::ParseSelectStatement() {
     if (current_token_.type != TokenType::IDENTIFIER) {
         throw Exception("Expected table name");
     }
-    std::string table_name = current_token_.value;
+    std::string table_name(current_token_.value);
     Advance();
 
+    // 解析可选的JOIN子句：[INNER] JOIN table ON condition
+    std::string join_table_name;
+    std::unique_ptr<Expression> join_condition = nullptr;
+    if (Match(TokenType::INNER)) {
+        if (current_token_.type != TokenType::JOIN) {
+            throw Exception("Expected JOIN after INNER");
+        }
+    }
+    if (Match(TokenType::JOIN)) {
+        if (current_token_.type != TokenType::IDENTIFIER) {
+            throw Exception("Expected table name after JOIN");
+        }
+        join_table_name = current_token_.value;
+        Advance();
+        Expect(TokenType::ON);
+        join_condition = ParseExpression();
+    }
+
     // 解析可选的WHERE子句
     std::unique_ptr<Expression> where_clause = nullptr;
     if (Match(TokenType::WHERE)) {
         where_clause = ParseExpression();
     }
 
-    return std::make_unique<SelectStatement>(std::move(select_list), table_name,
-                                             std::move(where_clause));
+    // 解析可选的GROUP BY子句
+    std::vector<std::unique_ptr<Expression>> group_by;
+    if (Match(TokenType::GROUP)) {
+        Expect(TokenType::BY);
+        do {
+            group_by.push_back(ParseExpression());
+        } while (Match(TokenType::COMMA));
+    }
+
+    // 解析可选的ORDER BY子句
+    std::vector<SelectStatement::OrderByItem> order_by;
+    if (Match(TokenType::ORDER)) {
+        Expect(TokenType::BY);
+        do {
+            auto expression = ParseExpression();
+            bool ascending = !Match(TokenType::DESC);
+            if (ascending) {
+                Match(TokenType::ASC);
+            }
+            order_by.push_back({std::move(expression), ascending});
+        } while (Match(TokenType::COMMA));
+    }
+
+    // 解析可选的LIMIT子句
+    int64_t limit = -1;
+    if (Match(TokenType::LIMIT)) {
+        if (current_token_.type != TokenType::INTEGER_LITERAL) {
+            throw Exception("Expected row count after LIMIT");
+        }
+        limit = std::stoll(std::string(current_token_.value));
+        Advance();
+    }
+
+    auto stmt = std::make_unique<SelectStatement>(
+        std::move(select_list), table_name, std::move(where_clause));
+    if (!join_table_name.empty()) {
+        stmt->SetJoin(std::move(join_table_name), std::move(join_condition));
+    }
+    stmt->SetGroupBy(std::move(group_by));
+    stmt->SetOrderBy(std::move(order_by));
+    if (limit >= 0) {
+        stmt->SetLimit(limit);
+    }
+    return stmt;
 }
 
 /**
  * 解析CREATE TABLE语句
  * 语法：CREATE TABLE table_name (column_definitions)
+ *       [PARTITION BY HASH|RANGE ...]
+ *       [WITH (storage = column|row, compression = lz4|none)]
  * @return CreateTableStatement AST节点
  */
 std::unique_ptr<Statement> Parser::ParseCreateTableStatement() {
@@ -545,14 +866,48 @@ std::unique_ptr<Statement> Parser::ParseCreateTableStatement() {
     if (current_token_.type != TokenType::IDENTIFIER) {
         throw Exception("Expected table name");
     }
-    std::string table_name = current_token_.value;
+    std::string table_name(current_token_.value);
     Advance();
 
     // 解析列定义
     auto columns = ParseColumnDefinitions();
 
-    return std::make_unique<CreateTableStatement>(table_name,
-                                                  std::move(columns));
+    auto upper_word = [this]() {
+        std::string word(current_token_.value);
+        std::transform(word.begin(), word.end(), word.begin(), ::toupper);
+        return word;
+    };
+
+    // 可选的分区子句，PARTITION不是保留字
+    std::shared_ptr<const PartitionScheme> partition_scheme;
+    if (current_token_.type == TokenType::IDENTIFIER &&
+        upper_word() == "PARTITION") {
+        Advance();
+        partition_scheme = ParsePartitionClause();
+    }
+
+    // 可选的表选项，WITH不是保留字
+    TableStorage storage = TableStorage::ROW;
+    PageCompression compression = PageCompression::NONE;
+    if (current_token_.type == TokenType::IDENTIFIER) {
+        std::string keyword(current_token_.value);
+        std::transform(keyword.begin(), keyword.end(), keyword.begin(),
+                       ::toupper);
+        if (keyword != "WITH") {
+            throw Exception("Unexpected token after column definitions: " +
+                            std::string(current_token_.value));
+        }
+        Advance();
+        ParseTableOptions(&storage, &compression);
+    }
+
+    if (partition_scheme && storage == TableStorage::COLUMN) {
+        throw Exception("Column storage tables cannot be partitioned");
+    }
+
+    return std::make_unique<CreateTableStatement>(
+        table_name, std::move(columns), storage, compression,
+        std::move(partition_scheme));
 }
 
 /**
@@ -576,7 +931,7 @@ std::unique_ptr<Statement> Parser::ParseInsertStatement() {
         LOG_ERROR("ParseInsertStatement: Expected table name");
         throw Exception("Expected table name");
     }
-    std::string table_name = current_token_.value;
+    std::string table_name(current_token_.value);
     LOG_DEBUG("ParseInsertStatement: Table name: " << table_name);
     Advance();
 
@@ -588,7 +943,7 @@ std::unique_ptr<Statement> Parser::ParseInsertStatement() {
             if (current_token_.type != TokenType::IDENTIFIER) {
                 throw Exception("Expected column name");
             }
-            column_names.push_back(current_token_.value);
+            column_names.emplace_back(current_token_.value);
             Advance();
         } while (Match(TokenType::COMMA));
         Expect(TokenType::RPAREN);
@@ -601,6 +956,7 @@ std::unique_ptr<Statement> Parser::ParseInsertStatement() {
 
     // 解析多个值列表：VALUES (1,2,3), (4,5,6), ...
     std::vector<std::vector<Value>> values_list;
+    std::vector<InsertStatement::ValueParameter> parameters;
     int value_list_count = 0;
     do {
         LOG_DEBUG("ParseInsertStatement: Parsing value list "
@@ -613,9 +969,14 @@ std::unique_ptr<Statement> Parser::ParseInsertStatement() {
                       << value_count << " in list " << value_list_count);
             auto expr = ParsePrimaryExpression();
 
-            // 将表达式转换为值（当前只支持常量）
+            // 将表达式转换为值（当前只支持常量）；参数占位符先放默认值，
+            // 生成计划时替换成绑定的参数值
             if (auto* const_expr =
                     dynamic_cast<ConstantExpression*>(expr.get())) {
+                if (const_expr->IsParameter()) {
+                    parameters.push_back({values_list.size(), values.size(),
+                                          const_expr->GetParameter()});
+                }
                 values.push_back(const_expr->GetValue());
                 LOG_DEBUG("ParseInsertStatement: Added constant value");
             } else {
@@ -635,8 +996,8 @@ std::unique_ptr<Statement> Parser::ParseInsertStatement() {
 
     LOG_DEBUG("ParseInsertStatement: Completed parsing, " << values_list.size()
                                                           << " value lists");
-    return std::make_unique<InsertStatement>(table_name,
-                                             std::move(values_list));
+    return std::make_unique<InsertStatement>(
+        table_name, std::move(values_list), std::move(parameters));
 }
 
 /**
@@ -677,7 +1038,7 @@ std::vector<Column> Parser::ParseColumnDefinitions() {
             if (current_token_.type != TokenType::INTEGER_LITERAL) {
                 throw Exception("Expected varchar size");
             }
-            col.size = std::stoi(current_token_.value);
+            col.size = std::stoi(std::string(current_token_.value));
             Advance();
             Expect(TokenType::RPAREN);
         } else {
@@ -724,7 +1085,7 @@ std::unique_ptr<Statement> Parser::ParseUpdateStatement() {
     if (current_token_.type != TokenType::IDENTIFIER) {
         throw Exception("Expected table name");
     }
-    std::string table_name = current_token_.value;
+    std::string table_name(current_token_.value);
     Advance();
 
     Expect(TokenType::SET);
@@ -736,7 +1097,7 @@ std::unique_ptr<Statement> Parser::ParseUpdateStatement() {
         if (current_token_.type != TokenType::IDENTIFIER) {
             throw Exception("Expected column name");
         }
-        std::string column_name = current_token_.value;
+        std::string column_name(current_token_.value);
         Advance();
 
         Expect(TokenType::EQUALS);
@@ -771,7 +1132,7 @@ std::unique_ptr<Statement> Parser::ParseDeleteStatement() {
     if (current_token_.type != TokenType::IDENTIFIER) {
         throw Exception("Expected table name");
     }
-    std::string table_name = current_token_.value;
+    std::string table_name(current_token_.value);
     Advance();
 
     // 解析可选的WHERE子句
@@ -878,7 +1239,8 @@ std::unique_ptr<Statement> Parser::ParseStatement() {
             Advance();  // 跳过CREATE
             if (current_token_.type == TokenType::TABLE) {
                 return ParseCreateTableStatement();
-            } else if (current_token_.type == TokenType::INDEX) {
+            } else if (current_token_.type == TokenType::INDEX ||
+                       current_token_.type == TokenType::UNIQUE) {
                 return ParseCreateIndexStatement();
             } else {
                 throw Exception("Expected TABLE or INDEX after CREATE");
@@ -910,6 +1272,30 @@ std::unique_ptr<Statement> Parser::ParseStatement() {
             return ParseRollbackStatement();
         case TokenType::EXPLAIN:
             return ParseExplainStatement();
+        case TokenType::ANALYZE:
+            return ParseAnalyzeStatement();
+        case TokenType::VACUUM:
+            return ParseVacuumStatement();
+        case TokenType::COPY:
+            return ParseCopyStatement();
+        case TokenType::PREPARE:
+            return ParsePrepareStatement();
+        case TokenType::EXECUTE:
+            return ParseExecuteStatement();
+        case TokenType::DEALLOCATE:
+            return ParseDeallocateStatement();
+        case TokenType::SET:
+            return ParseSetStatement();
+        case TokenType::IDENTIFIER: {
+            // KILL不是保留字，只在语句开头按标识符识别
+            std::string keyword(current_token_.value);
+            std::transform(keyword.begin(), keyword.end(), keyword.begin(),
+                           ::toupper);
+            if (keyword == "KILL") {
+                return ParseKillStatement();
+            }
+            throw Exception("Unsupported statement type");
+        }
         default:
             throw Exception("Unsupported statement type");
     }
@@ -918,11 +1304,29 @@ std::unique_ptr<Statement> Parser::ParseStatement() {
 /**
  * 解析比较表达式
  * 语法：arithmetic_expr [comparison_op arithmetic_expr]
+ *     | arithmetic_expr BETWEEN arithmetic_expr AND arithmetic_expr
  * 比较操作符：=, !=, <, >, <=, >=
+ * BETWEEN直接展开成 expr >= a AND expr <= b，执行器和优化器不需要单独处理
  */
 std::unique_ptr<Expression> Parser::ParseComparisonExpression() {
     auto left = ParseArithmeticExpression();
 
+    if (Match(TokenType::BETWEEN)) {
+        auto lower = ParseArithmeticExpression();
+        Expect(TokenType::AND);
+        auto upper = ParseArithmeticExpression();
+        auto left_copy = ExpressionCloner::Clone(left.get());
+        auto lower_cmp = std::make_unique<BinaryOpExpression>(
+            std::move(left), BinaryOpExpression::OpType::GREATER_EQUALS,
+            std::move(lower));
+        auto upper_cmp = std::make_unique<BinaryOpExpression>(
+            std::move(left_copy), BinaryOpExpression::OpType::LESS_EQUALS,
+            std::move(upper));
+        return std::make_unique<BinaryOpExpression>(
+            std::move(lower_cmp), BinaryOpExpression::OpType::AND,
+            std::move(upper_cmp));
+    }
+
     // 检查是否有比较操作符
     if (current_token_.type == TokenType::EQUALS ||
         current_token_.type == TokenType::NOT_EQUALS ||
@@ -1037,25 +1441,13 @@ std::unique_ptr<Expression> Parser::ParsePrimaryExpression() {
         return expr;
     }
 
-    // 整数字面量
-    if (current_token_.type == TokenType::INTEGER_LITERAL) {
-        int32_t value = std::stoi(current_token_.value);
-        Advance();
-        return std::make_unique<ConstantExpression>(Value(value));
-    }
-
-    // 浮点数字面量
-    if (current_token_.type == TokenType::FLOAT_LITERAL) {
-        double value = std::stod(current_token_.value);
-        Advance();
-        return std::make_unique<ConstantExpression>(Value(value));
-    }
-
-    // 字符串字面量
-    if (current_token_.type == TokenType::STRING_LITERAL) {
-        std::string value = current_token_.value;
+    // 整数、浮点数和字符串字面量
+    if (current_token_.type == TokenType::INTEGER_LITERAL ||
+        current_token_.type == TokenType::FLOAT_LITERAL ||
+        current_token_.type == TokenType::STRING_LITERAL) {
+        Value value = Lexer::LiteralValue(current_token_);
         Advance();
-        return std::make_unique<ConstantExpression>(Value(value));
+        return std::make_unique<ConstantExpression>(std::move(value));
     }
 
     // 布尔字面量
@@ -1065,19 +1457,46 @@ std::unique_ptr<Expression> Parser::ParsePrimaryExpression() {
         return std::make_unique<ConstantExpression>(Value(value));
     }
 
-    // 标识符（列引用）
+    // 参数占位符：同一个 $n 在语句里出现多次时共享一个槽位
+    if (current_token_.type == TokenType::PARAMETER) {
+        size_t index = std::stoul(std::string(current_token_.value)) - 1;
+        Advance();
+        if (index >= parameters_.size()) {
+            parameters_.resize(index + 1);
+        }
+        if (!parameters_[index]) {
+            parameters_[index] = std::make_shared<Value>();
+        }
+        return std::make_unique<ConstantExpression>(index, parameters_[index]);
+    }
+
+    // 标识符（列引用或者函数调用）
     if (current_token_.type == TokenType::IDENTIFIER) {
-        std::string name = current_token_.value;
+        std::string name(current_token_.value);
         Advance();
 
+        // 函数调用：name(*) 或 name(arg, ...)
+        if (Match(TokenType::LPAREN)) {
+            std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+            std::vector<std::unique_ptr<Expression>> arguments;
+            bool is_star = Match(TokenType::MULTIPLY);
+            if (!is_star && current_token_.type != TokenType::RPAREN) {
+                do {
+                    arguments.push_back(ParseExpression());
+                } while (Match(TokenType::COMMA));
+            }
+            Expect(TokenType::RPAREN);
+            return std::make_unique<FunctionCallExpression>(
+                name, std::move(arguments), is_star);
+        }
+
         // 检查是否是table.column格式
-        if (current_token_.type == TokenType::IDENTIFIER &&
-            current_token_.value == ".") {
+        if (current_token_.type == TokenType::DOT) {
             Advance();
             if (current_token_.type != TokenType::IDENTIFIER) {
                 throw Exception("Expected column name after .");
             }
-            std::string col_name = current_token_.value;
+            std::string col_name(current_token_.value);
             Advance();
             return std::make_unique<ColumnRefExpression>(name, col_name);
         }
@@ -1097,7 +1516,7 @@ std::unique_ptr<Statement> Parser::ParseDropTableStatement() {
     if (current_token_.type != TokenType::IDENTIFIER) {
         throw Exception("Expected table name");
     }
-    std::string table_name = current_token_.value;
+    std::string table_name(current_token_.value);
     Advance();
     return std::make_unique<DropTableStatement>(table_name);
 }
@@ -1112,7 +1531,7 @@ std::unique_ptr<Statement> Parser::ParseDropIndexStatement() {
     if (current_token_.type != TokenType::IDENTIFIER) {
         throw Exception("Expected index name");
     }
-    std::string index_name = current_token_.value;
+    std::string index_name(current_token_.value);
     Advance();
 
     // 可选的 ON table_name 部分
@@ -1121,7 +1540,7 @@ std::unique_ptr<Statement> Parser::ParseDropIndexStatement() {
             throw Exception("Expected table name after ON");
         }
         // 解析表名但不使用（因为索引名在数据库中是唯一的）
-        std::string table_name = current_token_.value;
+        std::string table_name(current_token_.value);
         Advance();
         LOG_DEBUG("ParseDropIndexStatement: Parsed table name "
                   << table_name << " but ignoring it");
@@ -1142,11 +1561,24 @@ std::unique_ptr<Statement> Parser::ParseShowTablesStatement() {
 
 /**
  * 解析BEGIN语句
- * 语法：BEGIN
+ * 语法：BEGIN [READ ONLY]
+ * READ、ONLY不是保留字，按标识符比较，不影响同名的列
  */
 std::unique_ptr<Statement> Parser::ParseBeginStatement() {
     Expect(TokenType::BEGIN);
-    return std::make_unique<BeginStatement>();
+    if (current_token_.type != TokenType::IDENTIFIER) {
+        return std::make_unique<BeginStatement>();
+    }
+    for (const char* expected : {"READ", "ONLY"}) {
+        std::string word(current_token_.value);
+        std::transform(word.begin(), word.end(), word.begin(), ::toupper);
+        if (current_token_.type != TokenType::IDENTIFIER || word != expected) {
+            throw Exception("Expected READ ONLY after BEGIN, got: " +
+                            std::string(current_token_.value));
+        }
+        Advance();
+    }
+    return std::make_unique<BeginStatement>(true);
 }
 
 /**
@@ -1169,11 +1601,12 @@ std::unique_ptr<Statement> Parser::ParseRollbackStatement() {
 
 /**
  * 解析EXPLAIN语句
- * 语法：EXPLAIN statement
- * 用于显示SQL语句的执行计划
+ * 语法：EXPLAIN [ANALYZE] statement
+ * 用于显示SQL语句的执行计划，带ANALYZE时执行语句并显示运行数据
  */
 std::unique_ptr<Statement> Parser::ParseExplainStatement() {
     Expect(TokenType::EXPLAIN);
+    bool analyze = Match(TokenType::ANALYZE);
 
     // 解析要EXPLAIN的语句
     auto stmt = ParseStatement();
@@ -1181,21 +1614,321 @@ std::unique_ptr<Statement> Parser::ParseExplainStatement() {
         throw Exception("Expected statement after EXPLAIN");
     }
 
-    return std::make_unique<ExplainStatement>(std::move(stmt));
+    return std::make_unique<ExplainStatement>(std::move(stmt), analyze);
+}
+
+/**
+ * 解析PREPARE语句
+ * 语法：PREPARE name AS statement
+ * 只有SELECT、INSERT、UPDATE、DELETE可以预编译，
+ * 语句里的参数占位符收集到parameters_里，交给PrepareStatement；
+ * 预编译的语句要活过这次查询，所以不从QueryArena分配
+ */
+std::unique_ptr<Statement> Parser::ParsePrepareStatement() {
+    Expect(TokenType::PREPARE);
+    if (current_token_.type != TokenType::IDENTIFIER) {
+        throw Exception("Expected prepared statement name");
+    }
+    std::string name(current_token_.value);
+    Advance();
+    Expect(TokenType::AS);
+
+    if (current_token_.type != TokenType::SELECT &&
+        current_token_.type != TokenType::INSERT &&
+        current_token_.type != TokenType::UPDATE &&
+        current_token_.type != TokenType::DELETE) {
+        throw Exception(
+            "Only SELECT, INSERT, UPDATE and DELETE can be prepared");
+    }
+    std::unique_ptr<Statement> stmt;
+    {
+        QueryArena::Suspend heap_allocation;
+        stmt = ParseStatement();
+    }
+    for (size_t i = 0; i < parameters_.size(); i++) {
+        if (!parameters_[i]) {
+            throw Exception("Parameter $" + std::to_string(i + 1) +
+                            " is not used in the statement");
+        }
+    }
+    auto parameters = std::move(parameters_);
+    parameters_.clear();
+    return std::make_unique<PrepareStatement>(name, std::move(stmt),
+                                              std::move(parameters));
+}
+
+/**
+ * 解析EXECUTE语句
+ * 语法：EXECUTE name [(literal, ...)]
+ * 参数只能是字面量，数字前面可以有负号
+ */
+std::unique_ptr<Statement> Parser::ParseExecuteStatement() {
+    Expect(TokenType::EXECUTE);
+    if (current_token_.type != TokenType::IDENTIFIER) {
+        throw Exception("Expected prepared statement name");
+    }
+    std::string name(current_token_.value);
+    Advance();
+
+    std::vector<Value> arguments;
+    if (Match(TokenType::LPAREN)) {
+        do {
+            bool negative = Match(TokenType::MINUS);
+            auto expr = ParsePrimaryExpression();
+            auto* const_expr = dynamic_cast<ConstantExpression*>(expr.get());
+            if (const_expr == nullptr || const_expr->IsParameter()) {
+                throw Exception("EXECUTE arguments must be literals");
+            }
+            Value value = const_expr->GetValue();
+            if (negative) {
+                if (auto* integer = std::get_if<int32_t>(&value)) {
+                    value = Value(-*integer);
+                } else if (auto* real = std::get_if<double>(&value)) {
+                    value = Value(-*real);
+                } else {
+                    throw Exception("Expected number after -");
+                }
+            }
+            arguments.push_back(std::move(value));
+        } while (Match(TokenType::COMMA));
+        Expect(TokenType::RPAREN);
+    }
+    return std::make_unique<ExecuteStatement>(name, std::move(arguments));
+}
+
+/**
+ * 解析DEALLOCATE语句
+ * 语法：DEALLOCATE name
+ */
+std::unique_ptr<Statement> Parser::ParseDeallocateStatement() {
+    Expect(TokenType::DEALLOCATE);
+    if (current_token_.type != TokenType::IDENTIFIER) {
+        throw Exception("Expected prepared statement name");
+    }
+    std::string name(current_token_.value);
+    Advance();
+    return std::make_unique<DeallocateStatement>(name);
+}
+
+/**
+ * 解析SET语句
+ * 语法：SET name {= | TO} value
+ * TO不是保留字，按标识符读取；值可以是数字、字符串、布尔值或者标识符，
+ * 都按原样保存成字符串
+ */
+std::unique_ptr<Statement> Parser::ParseSetStatement() {
+    Expect(TokenType::SET);
+    if (current_token_.type != TokenType::IDENTIFIER) {
+        throw Exception("Expected variable name after SET");
+    }
+    std::string name(current_token_.value);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    Advance();
+
+    std::string separator(current_token_.value);
+    std::transform(separator.begin(), separator.end(), separator.begin(),
+                   ::toupper);
+    if (!Match(TokenType::EQUALS)) {
+        if (current_token_.type != TokenType::IDENTIFIER || separator != "TO") {
+            throw Exception("Expected = or TO after SET " + name);
+        }
+        Advance();
+    }
+
+    switch (current_token_.type) {
+        case TokenType::INTEGER_LITERAL:
+        case TokenType::FLOAT_LITERAL:
+        case TokenType::STRING_LITERAL:
+        case TokenType::BOOLEAN_LITERAL:
+        case TokenType::IDENTIFIER:
+        case TokenType::ON:
+            break;
+        default:
+            throw Exception("Expected a value for SET " + name);
+    }
+    std::string value(current_token_.value);
+    Advance();
+    return std::make_unique<SetStatement>(name, value);
+}
+
+/**
+ * 解析KILL语句
+ * 语法：KILL [QUERY] 'session_id'
+ * 调用方已经确认当前token是标识符KILL；QUERY也按标识符读取
+ */
+std::unique_ptr<Statement> Parser::ParseKillStatement() {
+    Advance();
+    if (current_token_.type == TokenType::IDENTIFIER) {
+        std::string keyword(current_token_.value);
+        std::transform(keyword.begin(), keyword.end(), keyword.begin(),
+                       ::toupper);
+        if (keyword != "QUERY") {
+            throw Exception("Expected QUERY or a quoted session id after KILL");
+        }
+        Advance();
+    }
+    if (current_token_.type != TokenType::STRING_LITERAL) {
+        throw Exception("Expected quoted session id in KILL");
+    }
+    std::string session_id(current_token_.value);
+    Advance();
+    return std::make_unique<KillStatement>(session_id);
+}
+
+/**
+ * 解析ANALYZE语句
+ * 语法：ANALYZE [table_name]
+ */
+std::unique_ptr<Statement> Parser::ParseAnalyzeStatement() {
+    Expect(TokenType::ANALYZE);
+    if (current_token_.type != TokenType::IDENTIFIER) {
+        return std::make_unique<AnalyzeStatement>();
+    }
+    std::string table_name(current_token_.value);
+    Advance();
+    return std::make_unique<AnalyzeStatement>(table_name);
+}
+
+/**
+ * 解析VACUUM语句
+ * 语法：VACUUM [table_name]
+ */
+std::unique_ptr<Statement> Parser::ParseVacuumStatement() {
+    Expect(TokenType::VACUUM);
+    if (current_token_.type != TokenType::IDENTIFIER) {
+        return std::make_unique<VacuumStatement>();
+    }
+    std::string table_name(current_token_.value);
+    Advance();
+    return std::make_unique<VacuumStatement>(table_name);
+}
+
+/**
+ * 解析COPY语句
+ * 语法：COPY table_name {FROM | TO} 'file_path'
+ *       [WITH (format = csv|binary, header = true|false, delimiter = 'c')]
+ * TO和WITH不是保留字，按标识符读取
+ */
+std::unique_ptr<Statement> Parser::ParseCopyStatement() {
+    Expect(TokenType::COPY);
+    if (current_token_.type != TokenType::IDENTIFIER) {
+        throw Exception("Expected table name after COPY");
+    }
+    std::string table_name(current_token_.value);
+    Advance();
+
+    bool is_from;
+    std::string direction(current_token_.value);
+    std::transform(direction.begin(), direction.end(), direction.begin(),
+                   ::toupper);
+    if (current_token_.type == TokenType::FROM) {
+        is_from = true;
+    } else if (current_token_.type == TokenType::IDENTIFIER &&
+               direction == "TO") {
+        is_from = false;
+    } else {
+        throw Exception("Expected FROM or TO after COPY table name");
+    }
+    Advance();
+
+    if (current_token_.type != TokenType::STRING_LITERAL) {
+        throw Exception("Expected quoted file path in COPY");
+    }
+    auto stmt = std::make_unique<CopyStatement>(
+        table_name, std::string(current_token_.value), is_from);
+    Advance();
+
+    if (current_token_.type == TokenType::IDENTIFIER) {
+        std::string keyword(current_token_.value);
+        std::transform(keyword.begin(), keyword.end(), keyword.begin(),
+                       ::toupper);
+        if (keyword != "WITH") {
+            throw Exception("Unexpected token after COPY file path: " +
+                            std::string(current_token_.value));
+        }
+        Advance();
+        ParseCopyOptions(stmt.get());
+    }
+    return stmt;
+}
+
+/**
+ * 解析COPY选项
+ * 语法：(option = value [, option = value ...])
+ * 支持的选项：format = csv|binary，header = true|false，
+ * delimiter = 'c'（一个字符，'\t'表示制表符）
+ */
+void Parser::ParseCopyOptions(CopyStatement* stmt) {
+    Expect(TokenType::LPAREN);
+    while (true) {
+        if (current_token_.type != TokenType::IDENTIFIER) {
+            throw Exception("Expected COPY option after WITH (");
+        }
+        std::string option(current_token_.value);
+        std::string upper_option = option;
+        std::transform(upper_option.begin(), upper_option.end(),
+                       upper_option.begin(), ::toupper);
+        Advance();
+        Expect(TokenType::EQUALS);
+
+        std::string value(current_token_.value);
+        std::string upper_value = value;
+        std::transform(upper_value.begin(), upper_value.end(),
+                       upper_value.begin(), ::toupper);
+        TokenType value_type = current_token_.type;
+        Advance();
+
+        if (upper_option == "FORMAT") {
+            if (upper_value == "CSV") {
+                stmt->SetFormat(CopyFormat::CSV);
+            } else if (upper_value == "BINARY") {
+                stmt->SetFormat(CopyFormat::BINARY);
+            } else {
+                throw Exception("Unknown COPY format: " + value);
+            }
+        } else if (upper_option == "HEADER") {
+            if (value_type != TokenType::BOOLEAN_LITERAL) {
+                throw Exception("COPY option header expects TRUE or FALSE");
+            }
+            stmt->SetHeader(upper_value == "TRUE");
+        } else if (upper_option == "DELIMITER") {
+            if (value_type != TokenType::STRING_LITERAL) {
+                throw Exception("COPY option delimiter expects a quoted "
+                                "character");
+            }
+            if (value.size() != 1 || value[0] == '"' || value[0] == '\n' ||
+                value[0] == '\r') {
+                throw Exception("Invalid COPY delimiter: " + value);
+            }
+            stmt->SetDelimiter(value[0]);
+        } else {
+            throw Exception("Unknown COPY option: " + option);
+        }
+        if (current_token_.type != TokenType::COMMA) {
+            break;
+        }
+        Advance();
+    }
+    Expect(TokenType::RPAREN);
 }
 
 /**
  * 解析CREATE INDEX语句
- * 语法：CREATE INDEX index_name ON table_name (column_list)
+ * 语法：CREATE [UNIQUE] INDEX index_name ON table_name
+ *       [USING method] (column_list) [INCLUDE (column_list)] [USING method]
+ * 不带UNIQUE的索引允许多条记录有相同的键；
+ * USING可以写在列名列表前面（PostgreSQL）或者后面（MySQL），默认是B+树；
+ * INCLUDE的列只存在索引项里，不参与查找，和PostgreSQL一样不是保留字
  */
 std::unique_ptr<Statement> Parser::ParseCreateIndexStatement() {
+    bool is_unique = Match(TokenType::UNIQUE);
     Expect(TokenType::INDEX);
 
     // 解析索引名
     if (current_token_.type != TokenType::IDENTIFIER) {
         throw Exception("Expected index name");
     }
-    std::string index_name = current_token_.value;
+    std::string index_name(current_token_.value);
     Advance();
 
     Expect(TokenType::ON);
@@ -1204,25 +1937,219 @@ std::unique_ptr<Statement> Parser::ParseCreateIndexStatement() {
     if (current_token_.type != TokenType::IDENTIFIER) {
         throw Exception("Expected table name");
     }
-    std::string table_name = current_token_.value;
+    std::string table_name(current_token_.value);
     Advance();
 
-    Expect(TokenType::LPAREN);
+    IndexType index_type = IndexType::BPLUS_TREE;
+    bool has_using = Match(TokenType::USING);
+    if (has_using) {
+        index_type = ParseIndexType();
+    }
+
+    std::vector<std::string> key_columns = ParseIndexColumnList();
+
+    std::vector<std::string> include_columns;
+    if (current_token_.type == TokenType::IDENTIFIER) {
+        std::string keyword(current_token_.value);
+        std::transform(keyword.begin(), keyword.end(), keyword.begin(),
+                       ::toupper);
+        if (keyword != "INCLUDE") {
+            throw Exception("Unexpected token after index columns: " +
+                            std::string(current_token_.value));
+        }
+        Advance();
+        include_columns = ParseIndexColumnList();
+    }
+
+    if (!has_using && Match(TokenType::USING)) {
+        index_type = ParseIndexType();
+    }
 
-    // 解析列名列表
-    std::vector<std::string> key_columns;
+    return std::make_unique<CreateIndexStatement>(
+        index_name, table_name, key_columns, is_unique, index_type,
+        include_columns);
+}
+
+/**
+ * 解析括号里的索引列名列表
+ * 语法：(column [, column ...])
+ */
+std::vector<std::string> Parser::ParseIndexColumnList() {
+    Expect(TokenType::LPAREN);
+    std::vector<std::string> columns;
     do {
         if (current_token_.type != TokenType::IDENTIFIER) {
             throw Exception("Expected column name");
         }
-        key_columns.push_back(current_token_.value);
+        columns.emplace_back(current_token_.value);
         Advance();
     } while (Match(TokenType::COMMA));
+    Expect(TokenType::RPAREN);
+    return columns;
+}
+
+/**
+ * 解析索引结构名称
+ * HASH和BTREE不是保留字，按标识符读取，避免占用常见的列名
+ */
+IndexType Parser::ParseIndexType() {
+    if (current_token_.type != TokenType::IDENTIFIER) {
+        throw Exception("Expected index method after USING");
+    }
+    std::string method(current_token_.value);
+    std::string upper_method = method;
+    std::transform(upper_method.begin(), upper_method.end(),
+                   upper_method.begin(), ::toupper);
+    Advance();
+    if (upper_method == "HASH") {
+        return IndexType::HASH;
+    }
+    if (upper_method == "BTREE") {
+        return IndexType::BPLUS_TREE;
+    }
+    throw Exception("Unknown index method: " + method);
+}
+
+/**
+ * 解析表选项
+ * 语法：(option = value [, option = value ...])
+ * 支持的选项：storage = column|row，compression = lz4|none
+ */
+void Parser::ParseTableOptions(TableStorage* storage,
+                               PageCompression* compression) {
+    auto read_word = [this](const char* what) {
+        if (current_token_.type != TokenType::IDENTIFIER) {
+            throw Exception(std::string("Expected ") + what);
+        }
+        std::string word(current_token_.value);
+        std::transform(word.begin(), word.end(), word.begin(), ::toupper);
+        Advance();
+        return word;
+    };
 
+    Expect(TokenType::LPAREN);
+    while (true) {
+        std::string option(current_token_.value);
+        std::string upper_option = read_word("table option after WITH (");
+        Expect(TokenType::EQUALS);
+        std::string value(current_token_.value);
+        std::string upper_value = read_word("table option value");
+        if (upper_option == "STORAGE") {
+            if (upper_value == "COLUMN") {
+                *storage = TableStorage::COLUMN;
+            } else if (upper_value == "ROW") {
+                *storage = TableStorage::ROW;
+            } else {
+                throw Exception("Unknown storage format: " + value);
+            }
+        } else if (upper_option == "COMPRESSION") {
+            if (!ParsePageCompression(value, compression)) {
+                throw Exception("Unknown page compression: " + value);
+            }
+        } else {
+            throw Exception("Unknown table option: " + option);
+        }
+        if (current_token_.type != TokenType::COMMA) {
+            break;
+        }
+        Advance();
+    }
     Expect(TokenType::RPAREN);
+}
 
-    return std::make_unique<CreateIndexStatement>(index_name, table_name,
-                                                  key_columns);
+/**
+ * 解析分区子句
+ * 实现思路：
+ * 1. BY HASH|RANGE之后是括号里的分区列
+ * 2. 哈希分区读PARTITIONS后面的分区数
+ * 3. 范围分区读括号里逗号分隔的VALUES LESS THAN (上界)，上界是可以带负号
+ *    的整数或MAXVALUE，单独一个MAXVALUE等价于VALUES LESS THAN (MAXVALUE)，
+ *    MAXVALUE只能是最后一个
+ */
+std::shared_ptr<const PartitionScheme> Parser::ParsePartitionClause() {
+    auto expect_word = [this](const char* word) {
+        std::string upper(current_token_.value);
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        if (current_token_.type != TokenType::IDENTIFIER || upper != word) {
+            throw Exception(std::string("Expected ") + word +
+                            " in PARTITION clause");
+        }
+        Advance();
+    };
+    auto match_maxvalue = [this]() {
+        std::string upper(current_token_.value);
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        if (current_token_.type != TokenType::IDENTIFIER ||
+            upper != "MAXVALUE") {
+            return false;
+        }
+        Advance();
+        return true;
+    };
+
+    auto scheme = std::make_shared<PartitionScheme>();
+    Expect(TokenType::BY);
+    std::string method(current_token_.value);
+    std::transform(method.begin(), method.end(), method.begin(), ::toupper);
+    if (current_token_.type != TokenType::IDENTIFIER ||
+        (method != "HASH" && method != "RANGE")) {
+        throw Exception("Expected HASH or RANGE after PARTITION BY");
+    }
+    Advance();
+    scheme->type =
+        method == "HASH" ? PartitionType::HASH : PartitionType::RANGE;
+
+    Expect(TokenType::LPAREN);
+    if (current_token_.type != TokenType::IDENTIFIER) {
+        throw Exception("Expected partition column name");
+    }
+    scheme->column_name = current_token_.value;
+    Advance();
+    Expect(TokenType::RPAREN);
+
+    if (scheme->type == PartitionType::HASH) {
+        expect_word("PARTITIONS");
+        if (current_token_.type != TokenType::INTEGER_LITERAL) {
+            throw Exception("Expected partition count after PARTITIONS");
+        }
+        scheme->partition_count =
+            std::stoul(std::string(current_token_.value));
+        Advance();
+        return scheme;
+    }
+
+    Expect(TokenType::LPAREN);
+    bool has_maxvalue = false;
+    do {
+        if (has_maxvalue) {
+            throw Exception("MAXVALUE partition must be the last one");
+        }
+        // 单独的MAXVALUE是VALUES LESS THAN (MAXVALUE)的简写
+        if (match_maxvalue()) {
+            has_maxvalue = true;
+            scheme->partition_count++;
+            continue;
+        }
+        Expect(TokenType::VALUES);
+        expect_word("LESS");
+        expect_word("THAN");
+        Expect(TokenType::LPAREN);
+        if (match_maxvalue()) {
+            has_maxvalue = true;
+        } else {
+            bool negative = Match(TokenType::MINUS);
+            if (current_token_.type != TokenType::INTEGER_LITERAL) {
+                throw Exception("Expected integer partition bound");
+            }
+            int64_t bound = std::stoll(std::string(current_token_.value));
+            scheme->upper_bounds.push_back(negative ? -bound : bound);
+            Advance();
+        }
+        Expect(TokenType::RPAREN);
+        scheme->partition_count++;
+    } while (Match(TokenType::COMMA));
+    Expect(TokenType::RPAREN);
+    return scheme;
 }
 
 // AST节点的Accept方法实现（剩余部分）
@@ -1231,5 +2158,13 @@ void BeginStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
 void CommitStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
 void RollbackStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
 void ExplainStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
+void AnalyzeStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
+void VacuumStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
+void CopyStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
+void PrepareStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
+void ExecuteStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
+void DeallocateStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
+void SetStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
+void KillStatement::Accept(ASTVisitor* visitor) { visitor->Visit(this); }
 
 }  // namespace SimpleRDBMS
\ No newline at end of file
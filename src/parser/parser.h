@@ -56,6 +56,10 @@ class Parser {
      */
     explicit Parser(const std::string& sql);
 
+    // token指向sql_，拷贝或移动后会指向原来的对象
+    Parser(const Parser&) = delete;
+    Parser& operator=(const Parser&) = delete;
+
     /**
      * 解析SQL语句的主入口方法
      * @return 解析得到的Statement AST节点
@@ -80,13 +84,20 @@ class Parser {
      * 主要用于交互式SQL环境或批处理场景
      */
     void SetQuery(const std::string& sql) {
-        lexer_ = Lexer(sql);
+        sql_ = sql;
+        lexer_ = Lexer(sql_);
+        parameters_.clear();
         Advance();  // 读取第一个token
     }
 
    private:
+    // SQL文本的唯一一份拷贝，词法分析器和token都指向它，
+    // 解析过程中不再为token分配字符串
+    std::string sql_;
     Lexer lexer_;          // 词法分析器实例
     Token current_token_;  // 当前正在处理的token
+    // 解析到的参数占位符的槽位，下标i对应 $(i+1)
+    std::vector<std::shared_ptr<Value>> parameters_;
 
     // ==================== 基础解析工具方法 ====================
 
@@ -199,7 +210,7 @@ class Parser {
 
     /**
      * 解析BEGIN事务开始语句
-     * 语法：BEGIN
+     * 语法：BEGIN [READ ONLY]
      * @return BeginStatement AST节点
      */
     std::unique_ptr<Statement> ParseBeginStatement();
@@ -220,18 +231,113 @@ class Parser {
 
     /**
      * 解析EXPLAIN执行计划语句
-     * 语法：EXPLAIN statement
+     * 语法：EXPLAIN [ANALYZE] statement
      * @return ExplainStatement AST节点
      */
     std::unique_ptr<Statement> ParseExplainStatement();
 
+    /**
+     * 解析ANALYZE统计信息收集语句
+     * 语法：ANALYZE [table_name]
+     * @return AnalyzeStatement AST节点
+     */
+    std::unique_ptr<Statement> ParseAnalyzeStatement();
+
+    /**
+     * 解析VACUUM空间回收语句
+     * 语法：VACUUM [table_name]
+     * @return VacuumStatement AST节点
+     */
+    std::unique_ptr<Statement> ParseVacuumStatement();
+
+    /**
+     * 解析COPY批量导入导出语句
+     * 语法：COPY table_name {FROM | TO} 'file_path' [WITH (options)]
+     * @return CopyStatement AST节点
+     */
+    std::unique_ptr<Statement> ParseCopyStatement();
+
+    /**
+     * 解析COPY的WITH选项列表，写入stmt
+     */
+    void ParseCopyOptions(CopyStatement* stmt);
+
+    /**
+     * 解析PREPARE预编译语句
+     * 语法：PREPARE name AS statement
+     * @return PrepareStatement AST节点
+     */
+    std::unique_ptr<Statement> ParsePrepareStatement();
+
+    /**
+     * 解析EXECUTE语句
+     * 语法：EXECUTE name [(literal, ...)]
+     * @return ExecuteStatement AST节点
+     */
+    std::unique_ptr<Statement> ParseExecuteStatement();
+
+    /**
+     * 解析DEALLOCATE语句
+     * 语法：DEALLOCATE name
+     * @return DeallocateStatement AST节点
+     */
+    std::unique_ptr<Statement> ParseDeallocateStatement();
+
+    /**
+     * 解析SET语句
+     * 语法：SET name {= | TO} value
+     * @return SetStatement AST节点
+     */
+    std::unique_ptr<Statement> ParseSetStatement();
+
+    /**
+     * 解析KILL语句
+     * 语法：KILL [QUERY] 'session_id'
+     * @return KillStatement AST节点
+     */
+    std::unique_ptr<Statement> ParseKillStatement();
+
     /**
      * 解析CREATE INDEX语句
-     * 语法：CREATE INDEX index_name ON table_name (column_list)
+     * 语法：CREATE [UNIQUE] INDEX index_name ON table_name
+     *       [USING method] (column_list) [INCLUDE (column_list)]
+     *       [USING method]
      * @return CreateIndexStatement AST节点
      */
     std::unique_ptr<Statement> ParseCreateIndexStatement();
 
+    /**
+     * 解析括号里的索引列名列表，键列和INCLUDE列共用
+     * @return 列名列表
+     */
+    std::vector<std::string> ParseIndexColumnList();
+
+    /**
+     * 解析USING后面的索引结构名称：HASH或者BTREE，不区分大小写
+     * @return 对应的IndexType
+     */
+    IndexType ParseIndexType();
+
+    /**
+     * 解析CREATE TABLE列定义后面的
+     * WITH (storage = column|row, compression = lz4|none)
+     * 选项名和值都按标识符读取，不区分大小写，没写的选项保持默认值
+     * @param storage 输出参数，存储格式
+     * @param compression 输出参数，页面压缩算法
+     */
+    void ParseTableOptions(TableStorage* storage,
+                           PageCompression* compression);
+
+    /**
+     * 解析CREATE TABLE列定义后面的分区子句（PARTITION已经读过）
+     * 语法：BY HASH (column) PARTITIONS n
+     *     | BY RANGE (column) (VALUES LESS THAN (integer | MAXVALUE), ...)
+     * 范围分区的最后一项也可以只写MAXVALUE
+     * HASH、RANGE、PARTITIONS、LESS、THAN、MAXVALUE都按标识符读取
+     * @return 分区方式，分区列的位置和类型由建表时填写
+     */
+    std::shared_ptr<const PartitionScheme> ParsePartitionClause();
+
     /**
      * 解析DROP INDEX语句
      * 语法：DROP INDEX index_name [ON table_name]
@@ -0,0 +1,950 @@
+/*
+ * 文件: column_store.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 列存表的页面链表、段编码和追加提交的实现
+ */
+
+#include "record/column_store.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/debug.h"
+#include "common/exception.h"
+#include "storage/page.h"
+
+namespace SimpleRDBMS {
+
+// 根页面的魔数，打开时用来确认页面确实是列存的根页面
+static constexpr uint32_t COLUMN_STORE_MAGIC = 0x434f4c53;
+
+// 字节流页面的开头是下一个页面的ID，后面都是数据
+static constexpr size_t STREAM_DATA_OFFSET = sizeof(page_id_t);
+static constexpr size_t STREAM_PAGE_CAPACITY = PAGE_SIZE - STREAM_DATA_OFFSET;
+
+// 根页面：魔数、列数、行组数、目录字节流和长度、尾部字节流、
+// 尾部记录的位置和行数，然后每列一条字节流
+static constexpr size_t STREAM_SIZE =
+    2 * sizeof(page_id_t) + sizeof(uint32_t);
+static constexpr size_t ROOT_HEADER_SIZE =
+    3 * sizeof(uint32_t) + STREAM_SIZE + sizeof(uint64_t) + STREAM_SIZE +
+    sizeof(page_id_t) + 2 * sizeof(uint32_t) + sizeof(uint32_t);
+static constexpr size_t MAX_COLUMNS =
+    (PAGE_SIZE - ROOT_HEADER_SIZE) / STREAM_SIZE;
+
+namespace {
+
+/** 段里的值按这几种方式存放，由列的类型决定 */
+enum class ValueKind { INTEGER, FLOAT, DOUBLE, STRING, UNSUPPORTED };
+
+ValueKind KindOf(TypeId type) {
+    switch (type) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+        case TypeId::SMALLINT:
+        case TypeId::INTEGER:
+        case TypeId::BIGINT:
+            return ValueKind::INTEGER;
+        case TypeId::FLOAT:
+            return ValueKind::FLOAT;
+        case TypeId::DOUBLE:
+            return ValueKind::DOUBLE;
+        case TypeId::VARCHAR:
+            return ValueKind::STRING;
+        default:
+            return ValueKind::UNSUPPORTED;
+    }
+}
+
+int64_t ToInt64(const Value& value) {
+    return std::visit(
+        [](const auto& v) -> int64_t {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string>) {
+                return 0;
+            } else {
+                return static_cast<int64_t>(v);
+            }
+        },
+        value);
+}
+
+Value FromInt64(TypeId type, int64_t v) {
+    switch (type) {
+        case TypeId::BOOLEAN:
+            return v != 0;
+        case TypeId::TINYINT:
+            return static_cast<int8_t>(v);
+        case TypeId::SMALLINT:
+            return static_cast<int16_t>(v);
+        case TypeId::INTEGER:
+            return static_cast<int32_t>(v);
+        default:
+            return v;
+    }
+}
+
+template <typename T>
+void PutFixed(std::string* out, T value) {
+    out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void PutVarint(std::string* out, uint64_t value) {
+    while (value >= 0x80) {
+        out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out->push_back(static_cast<char>(value));
+}
+
+uint64_t ZigZag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t UnZigZag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+/** 顺序读取字节，越界时说明数据损坏 */
+class ByteReader {
+   public:
+    ByteReader(const std::string& data, size_t offset = 0)
+        : data_(data), offset_(offset) {}
+
+    template <typename T>
+    T Fixed() {
+        Require(sizeof(T));
+        T value;
+        std::memcpy(&value, data_.data() + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return value;
+    }
+
+    uint64_t Varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = Fixed<uint8_t>();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw Exception("ColumnStore: Corrupted varint");
+    }
+
+    const char* Bytes(size_t count) {
+        Require(count);
+        const char* bytes = data_.data() + offset_;
+        offset_ += count;
+        return bytes;
+    }
+
+    size_t GetOffset() const { return offset_; }
+
+   private:
+    void Require(size_t count) const {
+        if (offset_ + count > data_.size()) {
+            throw Exception("ColumnStore: Corrupted column data");
+        }
+    }
+
+    const std::string& data_;
+    size_t offset_;
+};
+
+/** 按列的类型写一个值：整数用zigzag变长编码，字符串前面是长度 */
+void PutScalar(std::string* out, ValueKind kind, const Value& value) {
+    switch (kind) {
+        case ValueKind::INTEGER:
+            PutVarint(out, ZigZag(ToInt64(value)));
+            break;
+        case ValueKind::FLOAT:
+            PutFixed(out, std::get<float>(value));
+            break;
+        case ValueKind::DOUBLE:
+            PutFixed(out, std::get<double>(value));
+            break;
+        default: {
+            const auto& str = std::get<std::string>(value);
+            PutVarint(out, str.size());
+            out->append(str);
+            break;
+        }
+    }
+}
+
+Value GetScalar(ByteReader* reader, TypeId type) {
+    switch (KindOf(type)) {
+        case ValueKind::INTEGER:
+            return FromInt64(type, UnZigZag(reader->Varint()));
+        case ValueKind::FLOAT:
+            return reader->Fixed<float>();
+        case ValueKind::DOUBLE:
+            return reader->Fixed<double>();
+        default: {
+            size_t length = reader->Varint();
+            return std::string(reader->Bytes(length), length);
+        }
+    }
+}
+
+/** 装下max需要的位数 */
+uint8_t BitWidth(uint64_t max) {
+    uint8_t width = 0;
+    while (width < 64 && (max >> width) != 0) {
+        width++;
+    }
+    return width;
+}
+
+/** 每个值占width位，低位在前依次打包 */
+void PackBits(const std::vector<uint64_t>& codes, uint8_t width,
+              std::string* out) {
+    size_t start = out->size();
+    out->resize(start + (codes.size() * width + 7) / 8, 0);
+    auto* bytes = reinterpret_cast<uint8_t*>(&(*out)[start]);
+    size_t bit = 0;
+    for (uint64_t code : codes) {
+        for (uint8_t done = 0; done < width;) {
+            unsigned shift = bit % 8;
+            unsigned take = std::min<unsigned>(8 - shift, width - done);
+            uint8_t part = static_cast<uint8_t>((code >> done) &
+                                                ((1u << take) - 1));
+            bytes[bit / 8] |= static_cast<uint8_t>(part << shift);
+            done += take;
+            bit += take;
+        }
+    }
+}
+
+void UnpackBits(ByteReader* reader, size_t count, uint8_t width,
+                std::vector<uint64_t>* codes) {
+    if (width > 64) {
+        throw Exception("ColumnStore: Corrupted bit width");
+    }
+    const auto* bytes = reinterpret_cast<const uint8_t*>(
+        reader->Bytes((count * width + 7) / 8));
+    codes->assign(count, 0);
+    size_t bit = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t code = 0;
+        for (uint8_t done = 0; done < width;) {
+            unsigned shift = bit % 8;
+            unsigned take = std::min<unsigned>(8 - shift, width - done);
+            uint64_t part = (bytes[bit / 8] >> shift) & ((1u << take) - 1);
+            code |= part << done;
+            done += take;
+            bit += take;
+        }
+        (*codes)[i] = code;
+    }
+}
+
+void EncodePlain(ValueKind kind, const std::vector<Value>& values,
+                 std::string* out) {
+    for (const auto& value : values) {
+        PutScalar(out, kind, value);
+    }
+}
+
+void EncodeRLE(ValueKind kind, const std::vector<Value>& values,
+               std::string* out) {
+    std::string runs;
+    size_t run_count = 0;
+    for (size_t i = 0; i < values.size();) {
+        size_t j = i + 1;
+        while (j < values.size() && values[j] == values[i]) {
+            j++;
+        }
+        PutScalar(&runs, kind, values[i]);
+        PutVarint(&runs, j - i);
+        run_count++;
+        i = j;
+    }
+    PutVarint(out, run_count);
+    out->append(runs);
+}
+
+void EncodeDictionary(const std::vector<Value>& values, std::string* out) {
+    std::unordered_map<std::string, uint64_t> codes;
+    std::vector<const std::string*> entries;
+    std::vector<uint64_t> row_codes;
+    row_codes.reserve(values.size());
+    for (const auto& value : values) {
+        const auto& str = std::get<std::string>(value);
+        auto [it, inserted] = codes.emplace(str, entries.size());
+        if (inserted) {
+            entries.push_back(&it->first);
+        }
+        row_codes.push_back(it->second);
+    }
+    PutVarint(out, entries.size());
+    for (const std::string* entry : entries) {
+        PutVarint(out, entry->size());
+        out->append(*entry);
+    }
+    uint8_t width = BitWidth(entries.empty() ? 0 : entries.size() - 1);
+    PutFixed(out, width);
+    PackBits(row_codes, width, out);
+}
+
+/** 差值用无符号运算，最小值和最大值相差超过int64的范围也不会溢出 */
+void EncodeFrameOfReference(const std::vector<Value>& values,
+                            std::string* out) {
+    int64_t min = values.empty() ? 0 : ToInt64(values[0]);
+    for (const auto& value : values) {
+        min = std::min(min, ToInt64(value));
+    }
+    std::vector<uint64_t> deltas;
+    deltas.reserve(values.size());
+    uint64_t max_delta = 0;
+    for (const auto& value : values) {
+        uint64_t delta =
+            static_cast<uint64_t>(ToInt64(value)) - static_cast<uint64_t>(min);
+        max_delta = std::max(max_delta, delta);
+        deltas.push_back(delta);
+    }
+    uint8_t width = BitWidth(max_delta);
+    PutFixed(out, min);
+    PutFixed(out, width);
+    PackBits(deltas, width, out);
+}
+
+}  // namespace
+
+ColumnStore::ColumnStore(BufferPoolManager* bpm, const Schema* schema,
+                         page_id_t root_page_id)
+    : bpm_(bpm),
+      schema_(schema),
+      root_page_id_(root_page_id),
+      column_streams_(schema->GetColumnCount()) {}
+
+bool ColumnStore::IsSupportedSchema(const Schema& schema,
+                                    std::string* reason) {
+    if (schema.GetColumnCount() > MAX_COLUMNS) {
+        *reason = "column storage supports at most " +
+                  std::to_string(MAX_COLUMNS) + " columns";
+        return false;
+    }
+    for (size_t i = 0; i < schema.GetColumnCount(); i++) {
+        const Column& column = schema.GetColumn(i);
+        if (KindOf(column.type) == ValueKind::UNSUPPORTED) {
+            *reason = "column " + column.name +
+                      " has a type that column storage does not support";
+            return false;
+        }
+        if (column.is_primary_key) {
+            *reason = "column storage is append-only and cannot have a "
+                      "primary key";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<ColumnStore> ColumnStore::Create(BufferPoolManager* bpm,
+                                                 const Schema* schema) {
+    std::string reason;
+    if (!IsSupportedSchema(*schema, &reason)) {
+        throw Exception("ColumnStore: " + reason);
+    }
+    page_id_t root_page_id;
+    Page* root_page = bpm->NewPage(&root_page_id);
+    if (root_page == nullptr) {
+        throw Exception("ColumnStore: Failed to allocate root page");
+    }
+    bpm->UnpinPage(root_page_id, true);
+    std::unique_ptr<ColumnStore> store(
+        new ColumnStore(bpm, schema, root_page_id));
+    store->WriteRoot(0, 0);
+    return store;
+}
+
+/**
+ * 打开列存
+ * 实现思路：根页面给出目录和尾部的位置，目录整个读进来逐项解析，
+ * 尾部记录按行格式反序列化回内存
+ */
+std::unique_ptr<ColumnStore> ColumnStore::Open(BufferPoolManager* bpm,
+                                               const Schema* schema,
+                                               page_id_t root_page_id) {
+    std::unique_ptr<ColumnStore> store(
+        new ColumnStore(bpm, schema, root_page_id));
+    size_t row_group_count = 0;
+    size_t tail_row_count = 0;
+    store->ReadRoot(&row_group_count, &tail_row_count);
+
+    if (store->directory_bytes_ > 0) {
+        SegmentRef directory_ref;
+        directory_ref.page_id = store->directory_stream_.head;
+        directory_ref.length =
+            static_cast<uint32_t>(store->directory_bytes_);
+        std::string directory = store->ReadBytes(directory_ref);
+        size_t offset = 0;
+        while (offset < directory.size()) {
+            store->row_groups_.push_back(
+                store->ParseDirectoryEntry(directory, &offset));
+        }
+    }
+    if (store->row_groups_.size() != row_group_count) {
+        throw Exception("ColumnStore: Row group directory does not match "
+                        "the root page");
+    }
+
+    if (tail_row_count > 0) {
+        std::string tail = store->ReadBytes(store->tail_ref_);
+        ByteReader reader(tail);
+        for (size_t i = 0; i < tail_row_count; i++) {
+            uint32_t size = reader.Fixed<uint32_t>();
+            Tuple tuple;
+            tuple.DeserializeFrom(reader.Bytes(size), schema);
+            store->tail_rows_.push_back(std::move(tuple));
+        }
+    }
+    LOG_DEBUG("ColumnStore::Open: root page "
+              << root_page_id << " has " << row_group_count
+              << " row groups and " << tail_row_count << " tail rows");
+    return store;
+}
+
+ColumnStore::SegmentRef ColumnStore::AppendBytes(
+    Stream* stream, const std::string& data,
+    std::vector<page_id_t>* dirty_pages) {
+    // 新页面的下一页ID是无效值，链到尾页面后面
+    auto extend = [this, stream, dirty_pages]() {
+        page_id_t page_id;
+        Page* page = bpm_->NewPage(&page_id);
+        if (page == nullptr) {
+            throw Exception("ColumnStore: Failed to allocate page");
+        }
+        page->WLatch();
+        std::memset(page->GetData(), 0, PAGE_SIZE);
+        page_id_t next_page_id = INVALID_PAGE_ID;
+        std::memcpy(page->GetData(), &next_page_id, sizeof(page_id_t));
+        page->WUnlatch();
+        bpm_->UnpinPage(page_id, true);
+        dirty_pages->push_back(page_id);
+
+        if (stream->tail == INVALID_PAGE_ID) {
+            stream->head = page_id;
+        } else {
+            Page* tail_page = bpm_->FetchPage(stream->tail);
+            if (tail_page == nullptr) {
+                throw Exception("ColumnStore: Failed to fetch page " +
+                                std::to_string(stream->tail));
+            }
+            tail_page->WLatch();
+            std::memcpy(tail_page->GetData(), &page_id, sizeof(page_id_t));
+            tail_page->WUnlatch();
+            bpm_->UnpinPage(stream->tail, true);
+            dirty_pages->push_back(stream->tail);
+        }
+        stream->tail = page_id;
+        stream->tail_used = 0;
+    };
+
+    if (stream->tail == INVALID_PAGE_ID ||
+        stream->tail_used == STREAM_PAGE_CAPACITY) {
+        extend();
+    }
+    SegmentRef ref;
+    ref.page_id = stream->tail;
+    ref.offset = stream->tail_used;
+    ref.length = static_cast<uint32_t>(data.size());
+
+    size_t written = 0;
+    while (written < data.size()) {
+        if (stream->tail_used == STREAM_PAGE_CAPACITY) {
+            extend();
+        }
+        Page* page = bpm_->FetchPage(stream->tail);
+        if (page == nullptr) {
+            throw Exception("ColumnStore: Failed to fetch page " +
+                            std::to_string(stream->tail));
+        }
+        size_t chunk = std::min(data.size() - written,
+                                STREAM_PAGE_CAPACITY - stream->tail_used);
+        page->WLatch();
+        std::memcpy(
+            page->GetData() + STREAM_DATA_OFFSET + stream->tail_used,
+            data.data() + written, chunk);
+        page->WUnlatch();
+        bpm_->UnpinPage(stream->tail, true);
+        dirty_pages->push_back(stream->tail);
+        stream->tail_used += static_cast<uint32_t>(chunk);
+        written += chunk;
+    }
+    return ref;
+}
+
+std::string ColumnStore::ReadBytes(const SegmentRef& ref) const {
+    std::string data(ref.length, '\0');
+    page_id_t page_id = ref.page_id;
+    size_t offset = ref.offset;
+    size_t read = 0;
+    while (read < data.size()) {
+        if (page_id == INVALID_PAGE_ID || offset >= STREAM_PAGE_CAPACITY) {
+            throw Exception("ColumnStore: Data extends past its page chain");
+        }
+        Page* page = bpm_->FetchPage(page_id);
+        if (page == nullptr) {
+            throw Exception("ColumnStore: Failed to fetch page " +
+                            std::to_string(page_id));
+        }
+        size_t chunk =
+            std::min(data.size() - read, STREAM_PAGE_CAPACITY - offset);
+        page_id_t next_page_id;
+        page->RLatch();
+        std::memcpy(&data[read], page->GetData() + STREAM_DATA_OFFSET + offset,
+                    chunk);
+        std::memcpy(&next_page_id, page->GetData(), sizeof(page_id_t));
+        page->RUnlatch();
+        bpm_->UnpinPage(page_id, false);
+        read += chunk;
+        page_id = next_page_id;
+        offset = 0;
+    }
+    return data;
+}
+
+/**
+ * 编码一列
+ * 实现思路：
+ * 1. 段头是编码方式、行数和可选的NULL位图，NULL行的值是零值，照常编码
+ * 2. 把这一列的类型能用的编码都试一遍，留下最短的结果；
+ *    一个行组最多COLUMN_ROW_GROUP_SIZE行，多编码几次的开销可以接受
+ */
+std::string ColumnStore::EncodeSegment(TypeId type,
+                                       const std::vector<Value>& values,
+                                       const std::vector<bool>& nulls,
+                                       Encoding* encoding) {
+    ValueKind kind = KindOf(type);
+    std::vector<Encoding> candidates = {Encoding::PLAIN, Encoding::RLE};
+    if (kind == ValueKind::INTEGER) {
+        candidates.push_back(Encoding::FRAME_OF_REFERENCE);
+    } else if (kind == ValueKind::STRING) {
+        candidates.push_back(Encoding::DICTIONARY);
+    }
+
+    std::string best;
+    for (Encoding candidate : candidates) {
+        std::string payload;
+        switch (candidate) {
+            case Encoding::PLAIN:
+                EncodePlain(kind, values, &payload);
+                break;
+            case Encoding::RLE:
+                EncodeRLE(kind, values, &payload);
+                break;
+            case Encoding::DICTIONARY:
+                EncodeDictionary(values, &payload);
+                break;
+            case Encoding::FRAME_OF_REFERENCE:
+                EncodeFrameOfReference(values, &payload);
+                break;
+        }
+        if (best.empty() || payload.size() < best.size()) {
+            best = std::move(payload);
+            *encoding = candidate;
+        }
+    }
+
+    std::string segment;
+    PutFixed(&segment, static_cast<uint8_t>(*encoding));
+    PutVarint(&segment, values.size());
+    bool has_nulls = std::find(nulls.begin(), nulls.end(), true) != nulls.end();
+    PutFixed(&segment, static_cast<uint8_t>(has_nulls ? 1 : 0));
+    if (has_nulls) {
+        std::vector<uint64_t> bits(nulls.begin(), nulls.end());
+        PackBits(bits, 1, &segment);
+    }
+    segment.append(best);
+    return segment;
+}
+
+void ColumnStore::DecodeSegment(TypeId type, const std::string& data,
+                                std::vector<Value>* values,
+                                std::vector<bool>* nulls) {
+    ByteReader reader(data);
+    auto encoding = static_cast<Encoding>(reader.Fixed<uint8_t>());
+    size_t count = reader.Varint();
+    bool has_nulls = reader.Fixed<uint8_t>() != 0;
+    std::vector<uint64_t> codes;
+    if (has_nulls) {
+        UnpackBits(&reader, count, 1, &codes);
+    }
+    if (nulls != nullptr) {
+        nulls->assign(count, false);
+        for (size_t i = 0; i < codes.size(); i++) {
+            (*nulls)[i] = codes[i] != 0;
+        }
+    }
+
+    values->clear();
+    values->reserve(count);
+    switch (encoding) {
+        case Encoding::PLAIN:
+            for (size_t i = 0; i < count; i++) {
+                values->push_back(GetScalar(&reader, type));
+            }
+            break;
+        case Encoding::RLE: {
+            size_t run_count = reader.Varint();
+            for (size_t i = 0; i < run_count; i++) {
+                Value value = GetScalar(&reader, type);
+                size_t length = reader.Varint();
+                if (values->size() + length > count) {
+                    throw Exception("ColumnStore: Corrupted RLE segment");
+                }
+                values->insert(values->end(), length, value);
+            }
+            break;
+        }
+        case Encoding::DICTIONARY: {
+            size_t entry_count = reader.Varint();
+            std::vector<Value> entries;
+            entries.reserve(entry_count);
+            for (size_t i = 0; i < entry_count; i++) {
+                entries.push_back(GetScalar(&reader, type));
+            }
+            UnpackBits(&reader, count, reader.Fixed<uint8_t>(), &codes);
+            for (uint64_t code : codes) {
+                if (code >= entries.size()) {
+                    throw Exception("ColumnStore: Corrupted dictionary code");
+                }
+                values->push_back(entries[code]);
+            }
+            break;
+        }
+        case Encoding::FRAME_OF_REFERENCE: {
+            auto min = static_cast<uint64_t>(reader.Fixed<int64_t>());
+            UnpackBits(&reader, count, reader.Fixed<uint8_t>(), &codes);
+            for (uint64_t delta : codes) {
+                values->push_back(
+                    FromInt64(type, static_cast<int64_t>(min + delta)));
+            }
+            break;
+        }
+        default:
+            throw Exception("ColumnStore: Unknown segment encoding");
+    }
+    if (values->size() != count) {
+        throw Exception("ColumnStore: Segment has the wrong row count");
+    }
+}
+
+/**
+ * 封存一个行组
+ * 目录项：长度、行数，然后每列的段位置、编码和最小/最大值
+ */
+std::shared_ptr<ColumnStore::RowGroup> ColumnStore::SealRowGroup(
+    const std::vector<const Tuple*>& rows, std::string* directory_entry,
+    std::vector<page_id_t>* dirty_pages) {
+    auto group = std::make_shared<RowGroup>();
+    group->row_count = static_cast<uint32_t>(rows.size());
+    for (const Tuple* row : rows) {
+        ZoneMap::Extend(&group->zone, *row);
+    }
+    group->zone.columns.resize(schema_->GetColumnCount());
+
+    std::string entry;
+    PutFixed(&entry, group->row_count);
+    std::vector<Value> values;
+    std::vector<bool> nulls;
+    for (size_t c = 0; c < schema_->GetColumnCount(); c++) {
+        values.clear();
+        nulls.clear();
+        for (const Tuple* row : rows) {
+            values.push_back(row->GetValues()[c]);
+            nulls.push_back(row->IsNull(c));
+        }
+        TypeId type = schema_->GetColumn(c).type;
+        Encoding encoding = Encoding::PLAIN;
+        std::string segment = EncodeSegment(type, values, nulls, &encoding);
+        SegmentRef ref =
+            AppendBytes(&column_streams_[c], segment, dirty_pages);
+        ref.encoding = encoding;
+        group->segments.push_back(ref);
+
+        PutFixed(&entry, ref.page_id);
+        PutFixed(&entry, ref.offset);
+        PutFixed(&entry, ref.length);
+        PutFixed(&entry, static_cast<uint8_t>(ref.encoding));
+        const ZoneMap::ColumnRange& range = group->zone.columns[c];
+        PutFixed(&entry, static_cast<uint8_t>(range.has_value ? 1 : 0));
+        if (range.has_value) {
+            ValueKind kind = KindOf(type);
+            PutScalar(&entry, kind, range.min);
+            PutScalar(&entry, kind, range.max);
+        }
+    }
+
+    directory_entry->clear();
+    PutFixed(directory_entry, static_cast<uint32_t>(entry.size()));
+    directory_entry->append(entry);
+    return group;
+}
+
+std::shared_ptr<ColumnStore::RowGroup> ColumnStore::ParseDirectoryEntry(
+    const std::string& data, size_t* offset) const {
+    ByteReader length_reader(data, *offset);
+    uint32_t length = length_reader.Fixed<uint32_t>();
+    size_t end = length_reader.GetOffset() + length;
+    if (end > data.size()) {
+        throw Exception("ColumnStore: Corrupted row group directory");
+    }
+    ByteReader reader(data, length_reader.GetOffset());
+    auto group = std::make_shared<RowGroup>();
+    group->row_count = reader.Fixed<uint32_t>();
+    group->zone.columns.resize(schema_->GetColumnCount());
+    for (size_t c = 0; c < schema_->GetColumnCount(); c++) {
+        SegmentRef ref;
+        ref.page_id = reader.Fixed<page_id_t>();
+        ref.offset = reader.Fixed<uint32_t>();
+        ref.length = reader.Fixed<uint32_t>();
+        ref.encoding = static_cast<Encoding>(reader.Fixed<uint8_t>());
+        group->segments.push_back(ref);
+        ZoneMap::ColumnRange& range = group->zone.columns[c];
+        range.has_value = reader.Fixed<uint8_t>() != 0;
+        if (range.has_value) {
+            TypeId type = schema_->GetColumn(c).type;
+            range.min = GetScalar(&reader, type);
+            range.max = GetScalar(&reader, type);
+        }
+    }
+    if (reader.GetOffset() != end) {
+        throw Exception("ColumnStore: Corrupted row group directory");
+    }
+    *offset = end;
+    return group;
+}
+
+/**
+ * 追加记录
+ * 实现思路：
+ * 1. 尾部记录和新记录合起来每够COLUMN_ROW_GROUP_SIZE行封存一个行组，
+ *    段写进各列的字节流，目录项写进目录字节流
+ * 2. 没有封存时新记录接在尾部后面写；封存了的话剩下的记录
+ *    在尾部字节流上重新写一份，成为新的尾部
+ * 3. 刷新写过的数据页，再写根页面提交；失败时退回原来的字节流位置，
+ *    这次写下的字节在下一次追加时被覆盖
+ * 4. 提交以后才换上新的行组和尾部，扫描不会看到没提交的数据
+ */
+void ColumnStore::Append(const std::vector<Tuple>& tuples) {
+    if (tuples.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> append_guard(append_latch_);
+
+    // tail_rows_只在持有append_latch_时修改，这里读不需要latch_
+    std::vector<const Tuple*> rows;
+    rows.reserve(tail_rows_.size() + tuples.size());
+    for (const Tuple& row : tail_rows_) {
+        rows.push_back(&row);
+    }
+    for (const Tuple& row : tuples) {
+        rows.push_back(&row);
+    }
+
+    auto saved_column_streams = column_streams_;
+    Stream saved_directory_stream = directory_stream_;
+    uint64_t saved_directory_bytes = directory_bytes_;
+    Stream saved_tail_stream = tail_stream_;
+    SegmentRef saved_tail_ref = tail_ref_;
+
+    std::vector<std::shared_ptr<const RowGroup>> sealed;
+    size_t row_group_count = 0;
+    size_t tail_begin = 0;
+    try {
+        std::vector<page_id_t> dirty_pages;
+        std::vector<const Tuple*> group_rows;
+        std::string entry;
+        while (rows.size() - tail_begin >= COLUMN_ROW_GROUP_SIZE) {
+            group_rows.assign(rows.begin() + tail_begin,
+                              rows.begin() + tail_begin +
+                                  COLUMN_ROW_GROUP_SIZE);
+            sealed.push_back(SealRowGroup(group_rows, &entry, &dirty_pages));
+            AppendBytes(&directory_stream_, entry, &dirty_pages);
+            directory_bytes_ += entry.size();
+            tail_begin += COLUMN_ROW_GROUP_SIZE;
+        }
+
+        // 没有封存时只需要写新记录，否则整个剩下的尾部重新写
+        size_t write_begin = sealed.empty() ? tail_rows_.size() : tail_begin;
+        std::string tail_bytes;
+        for (size_t i = write_begin; i < rows.size(); i++) {
+            uint32_t size = static_cast<uint32_t>(rows[i]->GetSerializedSize());
+            PutFixed(&tail_bytes, size);
+            size_t offset = tail_bytes.size();
+            tail_bytes.resize(offset + size);
+            rows[i]->SerializeTo(&tail_bytes[offset]);
+        }
+        if (!sealed.empty()) {
+            tail_ref_ = SegmentRef();
+        }
+        if (!tail_bytes.empty()) {
+            SegmentRef ref = AppendBytes(&tail_stream_, tail_bytes,
+                                         &dirty_pages);
+            if (tail_ref_.length == 0) {
+                tail_ref_ = ref;
+            } else {
+                tail_ref_.length += ref.length;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(latch_);
+            row_group_count = row_groups_.size() + sealed.size();
+        }
+        Commit(dirty_pages, row_group_count, rows.size() - tail_begin);
+    } catch (...) {
+        column_streams_ = std::move(saved_column_streams);
+        directory_stream_ = saved_directory_stream;
+        directory_bytes_ = saved_directory_bytes;
+        tail_stream_ = saved_tail_stream;
+        tail_ref_ = saved_tail_ref;
+        throw;
+    }
+
+    std::vector<Tuple> new_tail;
+    if (!sealed.empty()) {
+        for (size_t i = tail_begin; i < rows.size(); i++) {
+            new_tail.push_back(*rows[i]);
+        }
+    }
+    std::lock_guard<std::mutex> guard(latch_);
+    row_groups_.insert(row_groups_.end(), sealed.begin(), sealed.end());
+    if (sealed.empty()) {
+        tail_rows_.insert(tail_rows_.end(), tuples.begin(), tuples.end());
+    } else {
+        tail_rows_ = std::move(new_tail);
+    }
+}
+
+void ColumnStore::Commit(const std::vector<page_id_t>& dirty_pages,
+                         size_t row_group_count, size_t tail_row_count) {
+    std::vector<page_id_t> pages = dirty_pages;
+    std::sort(pages.begin(), pages.end());
+    pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+    // 已经被换出的页面写回过磁盘，刷新失败不影响顺序
+    for (page_id_t page_id : pages) {
+        bpm_->FlushPage(page_id);
+    }
+    WriteRoot(row_group_count, tail_row_count);
+}
+
+void ColumnStore::WriteRoot(size_t row_group_count, size_t tail_row_count) {
+    Page* page = bpm_->FetchPage(root_page_id_);
+    if (page == nullptr) {
+        throw Exception("ColumnStore: Failed to fetch root page " +
+                        std::to_string(root_page_id_));
+    }
+    std::string root;
+    auto put_stream = [&root](const Stream& stream) {
+        PutFixed(&root, stream.head);
+        PutFixed(&root, stream.tail);
+        PutFixed(&root, stream.tail_used);
+    };
+    PutFixed(&root, COLUMN_STORE_MAGIC);
+    PutFixed(&root, static_cast<uint32_t>(column_streams_.size()));
+    PutFixed(&root, static_cast<uint32_t>(row_group_count));
+    put_stream(directory_stream_);
+    PutFixed(&root, directory_bytes_);
+    put_stream(tail_stream_);
+    PutFixed(&root, tail_ref_.page_id);
+    PutFixed(&root, tail_ref_.offset);
+    PutFixed(&root, tail_ref_.length);
+    PutFixed(&root, static_cast<uint32_t>(tail_row_count));
+    for (const Stream& stream : column_streams_) {
+        put_stream(stream);
+    }
+
+    page->WLatch();
+    std::memset(page->GetData(), 0, PAGE_SIZE);
+    std::memcpy(page->GetData(), root.data(), root.size());
+    page->WUnlatch();
+    bpm_->UnpinPage(root_page_id_, true);
+    if (!bpm_->FlushPage(root_page_id_)) {
+        throw Exception("ColumnStore: Failed to flush root page " +
+                        std::to_string(root_page_id_));
+    }
+}
+
+void ColumnStore::ReadRoot(size_t* row_group_count, size_t* tail_row_count) {
+    Page* page = bpm_->FetchPage(root_page_id_);
+    if (page == nullptr) {
+        throw Exception("ColumnStore: Failed to fetch root page " +
+                        std::to_string(root_page_id_));
+    }
+    page->RLatch();
+    std::string root(page->GetData(), PAGE_SIZE);
+    page->RUnlatch();
+    bpm_->UnpinPage(root_page_id_, false);
+
+    ByteReader reader(root);
+    auto get_stream = [&reader]() {
+        Stream stream;
+        stream.head = reader.Fixed<page_id_t>();
+        stream.tail = reader.Fixed<page_id_t>();
+        stream.tail_used = reader.Fixed<uint32_t>();
+        return stream;
+    };
+    if (reader.Fixed<uint32_t>() != COLUMN_STORE_MAGIC) {
+        throw Exception("ColumnStore: Page " + std::to_string(root_page_id_) +
+                        " is not a column store root page");
+    }
+    if (reader.Fixed<uint32_t>() != column_streams_.size()) {
+        throw Exception("ColumnStore: Column count does not match the schema");
+    }
+    *row_group_count = reader.Fixed<uint32_t>();
+    directory_stream_ = get_stream();
+    directory_bytes_ = reader.Fixed<uint64_t>();
+    tail_stream_ = get_stream();
+    tail_ref_.page_id = reader.Fixed<page_id_t>();
+    tail_ref_.offset = reader.Fixed<uint32_t>();
+    tail_ref_.length = reader.Fixed<uint32_t>();
+    *tail_row_count = reader.Fixed<uint32_t>();
+    for (Stream& stream : column_streams_) {
+        stream = get_stream();
+    }
+}
+
+ColumnStore::ScanSnapshot ColumnStore::GetSnapshot() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    ScanSnapshot snapshot;
+    snapshot.row_groups = row_groups_;
+    snapshot.tail_rows = tail_rows_;
+    return snapshot;
+}
+
+void ColumnStore::ReadColumn(const RowGroup& group, size_t column_index,
+                             std::vector<Value>* values,
+                             std::vector<bool>* nulls) const {
+    std::string segment = ReadBytes(group.segments[column_index]);
+    DecodeSegment(schema_->GetColumn(column_index).type, segment, values,
+                  nulls);
+    if (values->size() != group.row_count) {
+        throw Exception("ColumnStore: Segment does not match its row group");
+    }
+}
+
+size_t ColumnStore::GetRowCount() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    size_t rows = tail_rows_.size();
+    for (const auto& group : row_groups_) {
+        rows += group->row_count;
+    }
+    return rows;
+}
+
+size_t ColumnStore::GetRowGroupCount() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    return row_groups_.size();
+}
+
+}  // namespace SimpleRDBMS
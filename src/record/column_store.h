@@ -0,0 +1,206 @@
+/*
+ * 文件: column_store.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 列存表的数据存储，每列一条页面链表，按行组用轻量编码压缩，
+ *       顺序扫描只解码用到的列，并按行组的最小/最大值跳过数据
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/types.h"
+#include "record/tuple.h"
+#include "record/zone_map.h"
+
+namespace SimpleRDBMS {
+
+class BufferPoolManager;
+
+/**
+ * ColumnStore - 只追加的列存表
+ *
+ * 设计思路：
+ * - 记录先进入尾部，攒够COLUMN_ROW_GROUP_SIZE行后封存成一个行组：
+ *   每列编码成一个段，追加到这一列自己的页面链表上
+ * - 段的编码按数据选择最小的一种：整数列在PLAIN、RLE和
+ *   FRAME_OF_REFERENCE（减去最小值后按位打包）中选，字符串列在
+ *   PLAIN、RLE和DICTIONARY中选，浮点列在PLAIN和RLE中选
+ * - 每个行组记下各列的最小/最大值（ZoneMap::PageZone），
+ *   扫描时和表堆的页面摘要一样据此跳过整个行组
+ * - 还没封存的尾部记录按行格式写在单独的页面链表上，重启后读回内存
+ * - 所有页面链表都是只追加的字节流，各自的末尾位置、行组目录的长度
+ *   和尾部记录的位置都记在根页面上；追加时先把写过的数据页刷盘，
+ *   最后改写并刷新根页面，根页面就是提交点，只写了一半的追加在
+ *   重启后看不到，留下的字节之后被覆盖
+ * - 不写WAL，也不参与MVCC：一次追加返回后所有事务都能看到，
+ *   事务回滚不撤销已经追加的记录
+ *
+ * 追加之间互斥；追加只在提交之后才换上新的行组和尾部，
+ * 已经写入的段不再改变，扫描拿到快照以后不再需要任何锁
+ */
+class ColumnStore {
+   public:
+    /** 列段的编码方式 */
+    enum class Encoding : uint8_t {
+        PLAIN = 0,           // 逐个存放值
+        RLE,                 // 游程编码：值 + 连续出现的次数
+        DICTIONARY,          // 字典 + 按位打包的字典下标
+        FRAME_OF_REFERENCE,  // 最小值 + 按位打包的差值
+    };
+
+    /** 一个列段在页面链表上的位置 */
+    struct SegmentRef {
+        page_id_t page_id = INVALID_PAGE_ID;  // 段的第一个字节所在的页面
+        uint32_t offset = 0;                  // 在页面数据区里的偏移
+        uint32_t length = 0;                  // 段的字节数
+        Encoding encoding = Encoding::PLAIN;
+    };
+
+    /** 封存的行组，写入以后不再改变 */
+    struct RowGroup {
+        uint32_t row_count = 0;
+        std::vector<SegmentRef> segments;  // 每列一个段
+        ZoneMap::PageZone zone;            // 各列的最小/最大值
+    };
+
+    /** 扫描开始时看到的数据 */
+    struct ScanSnapshot {
+        std::vector<std::shared_ptr<const RowGroup>> row_groups;
+        std::vector<Tuple> tail_rows;  // 还没有封存的记录
+    };
+
+    /**
+     * 新建一个空的列存，分配根页面
+     * @throws Exception 列的类型不支持列存，或者分配页面失败
+     */
+    static std::unique_ptr<ColumnStore> Create(BufferPoolManager* bpm,
+                                               const Schema* schema);
+
+    /**
+     * 打开已有的列存，读回行组目录和尾部记录
+     * @throws Exception 根页面不是列存的根页面，或者和schema对不上
+     */
+    static std::unique_ptr<ColumnStore> Open(BufferPoolManager* bpm,
+                                             const Schema* schema,
+                                             page_id_t root_page_id);
+
+    /** 检查schema的所有列都能按列存放，不能时返回false并给出原因 */
+    static bool IsSupportedSchema(const Schema& schema, std::string* reason);
+
+    page_id_t GetRootPageId() const { return root_page_id_; }
+
+    /**
+     * 追加一批记录，返回前已经持久化
+     * 尾部够一个行组时封存，剩下的记录重新写成新的尾部
+     * @throws Exception 分配或读取页面失败，这时追加不生效
+     */
+    void Append(const std::vector<Tuple>& tuples);
+
+    /** 取出当前所有行组和尾部记录，扫描从头到尾只看这一份 */
+    ScanSnapshot GetSnapshot() const;
+
+    /**
+     * 解码行组的一列
+     * @param values 输出参数，行组的每一行一个值；NULL是同类型的零值
+     * @param nulls 输出参数，可以为空；非空时每行一项，true表示NULL
+     */
+    void ReadColumn(const RowGroup& group, size_t column_index,
+                    std::vector<Value>* values,
+                    std::vector<bool>* nulls) const;
+
+    /** 总行数，包括尾部记录 */
+    size_t GetRowCount() const;
+
+    size_t GetRowGroupCount() const;
+
+    /**
+     * 把一列值编码成段，在可用的编码里选结果最小的一种
+     * @param type 列的类型
+     * @param encoding 输出参数，选中的编码
+     */
+    static std::string EncodeSegment(TypeId type,
+                                     const std::vector<Value>& values,
+                                     const std::vector<bool>& nulls,
+                                     Encoding* encoding);
+
+    /**
+     * 解码EncodeSegment的结果
+     * @throws Exception 段的内容损坏
+     */
+    static void DecodeSegment(TypeId type, const std::string& data,
+                              std::vector<Value>* values,
+                              std::vector<bool>* nulls);
+
+   private:
+    /** 页面链表上只追加的字节流 */
+    struct Stream {
+        page_id_t head = INVALID_PAGE_ID;  // 第一个页面，还没写过时无效
+        page_id_t tail = INVALID_PAGE_ID;  // 最后一个页面
+        uint32_t tail_used = 0;            // 最后一个页面已经用掉的字节数
+    };
+
+    ColumnStore(BufferPoolManager* bpm, const Schema* schema,
+                page_id_t root_page_id);
+
+    /**
+     * 把数据写到字节流末尾
+     * @param dirty_pages 输出参数，写过的页面，提交前要刷盘
+     * @return 写入位置，length是data的长度
+     */
+    SegmentRef AppendBytes(Stream* stream, const std::string& data,
+                           std::vector<page_id_t>* dirty_pages);
+
+    /** 读出从ref开始的ref.length个字节 */
+    std::string ReadBytes(const SegmentRef& ref) const;
+
+    /** 把rows里的记录编码成一个行组，写入各列的字节流 */
+    std::shared_ptr<RowGroup> SealRowGroup(
+        const std::vector<const Tuple*>& rows, std::string* directory_entry,
+        std::vector<page_id_t>* dirty_pages);
+
+    /** 刷新写过的页面，再把当前状态写入根页面并刷盘 */
+    void Commit(const std::vector<page_id_t>& dirty_pages,
+                size_t row_group_count, size_t tail_row_count);
+
+    /** 把字节流的位置和两个计数写入根页面并刷盘 */
+    void WriteRoot(size_t row_group_count, size_t tail_row_count);
+
+    /**
+     * 读出根页面上的字节流位置
+     * @param row_group_count 输出参数，行组数
+     * @param tail_row_count 输出参数，尾部记录数
+     */
+    void ReadRoot(size_t* row_group_count, size_t* tail_row_count);
+
+    /** 解析行组目录里的一项 */
+    std::shared_ptr<RowGroup> ParseDirectoryEntry(const std::string& data,
+                                                  size_t* offset) const;
+
+    BufferPoolManager* bpm_;
+    const Schema* schema_;
+    page_id_t root_page_id_;
+
+    // 以下字节流的状态只有追加会改，由append_latch_保护
+    std::mutex append_latch_;
+    std::vector<Stream> column_streams_;  // 每列一条字节流
+    Stream directory_stream_;             // 行组目录
+    uint64_t directory_bytes_ = 0;        // 目录的总字节数
+    Stream tail_stream_;                  // 尾部记录的行格式
+    SegmentRef tail_ref_;                 // 当前尾部记录的位置和长度
+
+    // 扫描看到的行组和尾部记录，由latch_保护，追加提交之后才更新
+    mutable std::mutex latch_;
+    std::vector<std::shared_ptr<const RowGroup>> row_groups_;
+    std::vector<Tuple> tail_rows_;
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,82 @@
+/*
+ * 文件: free_space_map.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 表堆空闲空间映射实现
+ */
+
+#include "record/free_space_map.h"
+
+#include <algorithm>
+
+namespace SimpleRDBMS {
+
+size_t FreeSpaceMap::CategoryOf(size_t free_bytes) {
+    return std::min(free_bytes / CATEGORY_BYTES, NUM_CATEGORIES - 1);
+}
+
+/**
+ * 更新页面的类别
+ * 实现思路：类别没变时什么都不做，否则从旧类别的集合移到新类别，
+ * 同时维护非空位图
+ */
+void FreeSpaceMap::Update(page_id_t page_id, size_t free_bytes) {
+    size_t category = CategoryOf(free_bytes);
+    std::lock_guard<std::mutex> guard(latch_);
+
+    auto it = page_categories_.find(page_id);
+    if (it != page_categories_.end()) {
+        size_t old_category = it->second;
+        if (old_category == category) {
+            return;
+        }
+        buckets_[old_category].erase(page_id);
+        if (buckets_[old_category].empty()) {
+            non_empty_.reset(old_category);
+        }
+        it->second = static_cast<uint16_t>(category);
+    } else {
+        page_categories_.emplace(page_id, static_cast<uint16_t>(category));
+    }
+
+    buckets_[category].insert(page_id);
+    non_empty_.set(category);
+}
+
+/**
+ * 查找有足够空间的页面
+ * 实现思路：需要的字节数向上取整到类别，这个类别及以上的页面一定放得下，
+ * 沿位图找第一个非空类别，取页号最小的页面
+ */
+page_id_t FreeSpaceMap::FindPage(size_t required_bytes) const {
+    size_t category =
+        (required_bytes + CATEGORY_BYTES - 1) / CATEGORY_BYTES;
+    std::lock_guard<std::mutex> guard(latch_);
+    for (; category < NUM_CATEGORIES; category++) {
+        if (non_empty_.test(category)) {
+            return *buckets_[category].begin();
+        }
+    }
+    return INVALID_PAGE_ID;
+}
+
+void FreeSpaceMap::Remove(page_id_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto it = page_categories_.find(page_id);
+    if (it == page_categories_.end()) {
+        return;
+    }
+    size_t category = it->second;
+    buckets_[category].erase(page_id);
+    if (buckets_[category].empty()) {
+        non_empty_.reset(category);
+    }
+    page_categories_.erase(it);
+}
+
+size_t FreeSpaceMap::GetPageCount() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    return page_categories_.size();
+}
+
+}  // namespace SimpleRDBMS
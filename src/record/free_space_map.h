@@ -0,0 +1,79 @@
+/*
+ * 文件: free_space_map.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 表堆的空闲空间映射，按空闲字节数把页面分类，插入时直接找到有空间的页面
+ */
+
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * FreeSpaceMap - 空闲空间映射
+ *
+ * 设计思路：
+ * - 每个页面的空闲空间压缩成一个字节的类别：类别c表示至少有
+ *   c * CATEGORY_BYTES字节可以放新tuple，向下取整，所以类别只会低估
+ * - 每个类别一个有序的页面集合，另有一张位图记录哪些类别非空，
+ *   查找时从需要的类别开始找第一个非空类别，取其中页号最小的页面，
+ *   数据尽量集中在表的前部
+ * - 映射只在内存里，不落盘；和页面内容不一致时只可能偏高（比如恢复
+ *   直接改了页面），插入失败后用页面的实际空间更新一次再重新查找即可
+ *
+ * 所有方法都是线程安全的，内部的锁不会在持有时再去拿页面锁
+ */
+class FreeSpaceMap {
+   public:
+    /** 一个类别对应的字节数 */
+    static constexpr size_t CATEGORY_BYTES = 16;
+
+    /** 类别数，最高类别对应整页空闲 */
+    static constexpr size_t NUM_CATEGORIES = PAGE_SIZE / CATEGORY_BYTES;
+
+    /**
+     * 记录页面当前可用于插入的空闲字节数，页面不在映射里时加入
+     * @param page_id 页面ID
+     * @param free_bytes 能放下的最大tuple字节数
+     */
+    void Update(page_id_t page_id, size_t free_bytes);
+
+    /**
+     * 找一个至少有required_bytes空闲字节的页面
+     * @return 页面ID，没有这样的页面时返回INVALID_PAGE_ID
+     */
+    page_id_t FindPage(size_t required_bytes) const;
+
+    /** 页面从表中释放时把它移出映射 */
+    void Remove(page_id_t page_id);
+
+    /** 映射中的页面数 */
+    size_t GetPageCount() const;
+
+   private:
+    /** 空闲字节数对应的类别，向下取整 */
+    static size_t CategoryOf(size_t free_bytes);
+
+    mutable std::mutex latch_;
+
+    /** 页面当前所在的类别 */
+    std::unordered_map<page_id_t, uint16_t> page_categories_;
+
+    /** 每个类别中的页面 */
+    std::vector<std::set<page_id_t>> buckets_{NUM_CATEGORIES};
+
+    /** 非空类别的位图 */
+    std::bitset<NUM_CATEGORIES> non_empty_;
+};
+
+}  // namespace SimpleRDBMS
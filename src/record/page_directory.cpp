@@ -0,0 +1,103 @@
+/*
+ * 文件: page_directory.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 表堆页面目录实现
+ */
+
+#include "record/page_directory.h"
+
+#include <algorithm>
+
+namespace SimpleRDBMS {
+
+/**
+ * 追加页面
+ * 页面ID紧接着最后一个区段时并入这个区段，否则开始一个新区段
+ */
+void PageDirectory::Append(page_id_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (!extents_.empty()) {
+        Extent& last = extents_.back();
+        if (last.first_page_id + static_cast<page_id_t>(last.page_count) ==
+            page_id) {
+            last.page_count++;
+            page_count_++;
+            return;
+        }
+    }
+    extents_.push_back(Extent{page_id, page_count_, 1});
+    page_count_++;
+}
+
+void PageDirectory::Clear() {
+    std::lock_guard<std::mutex> guard(latch_);
+    extents_.clear();
+    page_count_ = 0;
+}
+
+size_t PageDirectory::GetPageCount() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    return page_count_;
+}
+
+size_t PageDirectory::GetExtentCount() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    return extents_.size();
+}
+
+size_t PageDirectory::FindExtent(size_t index) const {
+    auto it = std::upper_bound(
+        extents_.begin(), extents_.end(), index,
+        [](size_t value, const Extent& extent) {
+            return value < extent.start_index;
+        });
+    return static_cast<size_t>(it - extents_.begin()) - 1;
+}
+
+page_id_t PageDirectory::GetPage(size_t index) const {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (index >= page_count_) {
+        return INVALID_PAGE_ID;
+    }
+    const Extent& extent = extents_[FindExtent(index)];
+    return extent.first_page_id +
+           static_cast<page_id_t>(index - extent.start_index);
+}
+
+/**
+ * 取出一段页面
+ * 实现思路：二分找到begin所在的区段，然后逐个区段往后展开，直到取够count个
+ */
+size_t PageDirectory::GetPages(size_t begin, size_t count,
+                               std::vector<page_id_t>* pages) const {
+    pages->clear();
+    std::lock_guard<std::mutex> guard(latch_);
+    if (begin >= page_count_) {
+        return 0;
+    }
+    size_t end = std::min(page_count_, begin + count);
+    size_t index = begin;
+    for (size_t e = FindExtent(begin); e < extents_.size() && index < end;
+         e++) {
+        const Extent& extent = extents_[e];
+        size_t extent_end =
+            std::min(end, extent.start_index + extent.page_count);
+        for (; index < extent_end; index++) {
+            pages->push_back(extent.first_page_id +
+                             static_cast<page_id_t>(index - extent.start_index));
+        }
+    }
+    return pages->size();
+}
+
+page_id_t PageDirectory::GetLastPage() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (extents_.empty()) {
+        return INVALID_PAGE_ID;
+    }
+    const Extent& last = extents_.back();
+    return last.first_page_id + static_cast<page_id_t>(last.page_count) - 1;
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,81 @@
+/*
+ * 文件: page_directory.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 表堆的页面目录，按链表顺序记录表的所有页面，
+ *       不用沿链表走就能找到第N个页面，并行扫描据此把表切成页面区间
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * PageDirectory - 页面目录
+ *
+ * 设计思路：
+ * - 页面按表堆链表上的顺序编号，第0个是第一个页面
+ * - 表扩展时新页面通常紧接着前一个页面分配，所以按区段（extent）记录：
+ *   每个区段是一串连续的页面ID，记下第一个页面ID、页数和区段在目录中的
+ *   起始序号；取第N个页面时按起始序号二分查找区段
+ * - 表堆平时只在末尾追加页面，目录也只追加；VACUUM释放页面之后
+ *   清空目录，按链表顺序重新追加剩下的页面
+ * - 目录只在内存里，不落盘，和空闲空间映射一起在第一次使用时沿链表
+ *   扫描一遍建立，之后随表的扩展维护
+ *
+ * 所有方法都是线程安全的
+ */
+class PageDirectory {
+   public:
+    /** 在目录末尾追加一个页面 */
+    void Append(page_id_t page_id);
+
+    /** 清空目录 */
+    void Clear();
+
+    /** 目录中的页面数 */
+    size_t GetPageCount() const;
+
+    /** 区段数，页面ID连续时只有一个区段 */
+    size_t GetExtentCount() const;
+
+    /**
+     * 第index个页面的ID
+     * @return 超出范围时返回INVALID_PAGE_ID
+     */
+    page_id_t GetPage(size_t index) const;
+
+    /**
+     * 取出从第begin个页面开始的最多count个页面
+     * @param pages 输出参数，按链表顺序的页面ID
+     * @return 取出的页面数，begin超出范围时为0
+     */
+    size_t GetPages(size_t begin, size_t count,
+                    std::vector<page_id_t>* pages) const;
+
+    /** 目录中的最后一个页面，目录为空时返回INVALID_PAGE_ID */
+    page_id_t GetLastPage() const;
+
+   private:
+    /** 一串连续的页面ID */
+    struct Extent {
+        page_id_t first_page_id;
+        size_t start_index;  // 第一个页面在目录中的序号
+        size_t page_count;
+    };
+
+    /** 包含第index个页面的区段下标，调用者持有锁并保证index在范围内 */
+    size_t FindExtent(size_t index) const;
+
+    mutable std::mutex latch_;
+    std::vector<Extent> extents_;
+    size_t page_count_ = 0;
+};
+
+}  // namespace SimpleRDBMS
@@ -9,11 +9,18 @@
 #include "record/table_heap.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstring>
+#include <limits>
 #include <unordered_set>
+#include <string>
+#include <utility>
 
 #include "common/exception.h"
+#include "record/table_read_ahead.h"
 #include "recovery/recovery_manager.h"
+#include "stat/stat.h"
+#include "transaction/transaction.h"
 
 namespace SimpleRDBMS {
 
@@ -31,6 +38,14 @@ struct Slot {
     Slot(uint16_t off, uint16_t sz) : offset(off), size(sz) {}
 };
 
+static_assert(offsetof(TablePage::TablePageHeader, checksum) ==
+                  TablePage::CHECKSUM_OFFSET,
+              "table page checksum must be the last header field");
+
+// 一个页面最多能放下的slot数量，跟着页面大小变化
+static const size_t MAX_SLOTS_PER_PAGE =
+    (PAGE_SIZE - sizeof(TablePage::TablePageHeader)) / sizeof(Slot);
+
 /**
  * 初始化表页面
  * @param page_id 页面ID
@@ -41,8 +56,9 @@ void TablePage::Init(page_id_t page_id, page_id_t prev_page_id) {
     SetLSN(INVALID_LSN);
     (void)prev_page_id;
 
-    // 完全清零页面数据
+    // 完全清零页面数据，校验值在写盘时填写
     std::memset(GetData(), 0, PAGE_SIZE);
+    SetChecksumOffset(CHECKSUM_OFFSET);
 
     auto* header = GetHeader();
     header->next_page_id = INVALID_PAGE_ID;
@@ -57,59 +73,6 @@ void TablePage::Init(page_id_t page_id, page_id_t prev_page_id) {
               << " num_tuples=" << header->num_tuples);
 }
 
-static bool ValidateAndFixTablePageHeader(TablePage::TablePageHeader* header,
-                                          page_id_t expected_page_id) {
-    bool need_fix = false;
-
-    // 检查next_page_id是否被破坏（包含catalog魔数）
-    if (header->next_page_id == static_cast<page_id_t>(0x12345678)) {
-        LOG_ERROR(
-            "ValidateAndFixTablePageHeader: Detected catalog magic number in "
-            "next_page_id, fixing");
-        header->next_page_id = INVALID_PAGE_ID;
-        need_fix = true;
-    }
-
-    // 检查next_page_id是否在合理范围内
-    if (header->next_page_id != INVALID_PAGE_ID &&
-        (header->next_page_id < 2 || header->next_page_id > 1000000)) {
-        LOG_ERROR("ValidateAndFixTablePageHeader: Invalid next_page_id "
-                  << header->next_page_id << ", resetting to INVALID_PAGE_ID");
-        header->next_page_id = INVALID_PAGE_ID;
-        need_fix = true;
-    }
-
-    // 检查num_tuples是否合理
-    if (header->num_tuples < 0 || header->num_tuples > 1000) {
-        LOG_ERROR("ValidateAndFixTablePageHeader: Invalid num_tuples "
-                  << header->num_tuples << ", resetting to 0");
-        header->num_tuples = 0;
-        header->free_space_offset = PAGE_SIZE;
-        need_fix = true;
-    }
-
-    // 检查free_space_offset是否合理
-    size_t min_offset =
-        sizeof(TablePage::TablePageHeader) + header->num_tuples * sizeof(Slot);
-    if (header->free_space_offset < min_offset ||
-        header->free_space_offset > PAGE_SIZE) {
-        LOG_ERROR("ValidateAndFixTablePageHeader: Invalid free_space_offset "
-                  << header->free_space_offset << ", fixing");
-        header->free_space_offset = PAGE_SIZE;
-        need_fix = true;
-    }
-
-    if (need_fix) {
-        LOG_DEBUG("ValidateAndFixTablePageHeader: Fixed header for page "
-                  << expected_page_id
-                  << " - next_page_id=" << header->next_page_id
-                  << " num_tuples=" << header->num_tuples
-                  << " free_space_offset=" << header->free_space_offset);
-    }
-
-    return !need_fix;  // 返回true表示头部是有效的
-}
-
 /**
  * 页面布局说明：
  * [Header] [Slot Directory] [Free Space] [Tuple Data (grows backward)]
@@ -122,91 +85,6 @@ static bool ValidateAndFixTablePageHeader(TablePage::TablePageHeader* header,
  * Tuple Data: 实际的tuple数据，从右向左增长
  */
 
-/**
- * 验证并修复slot目录结构
- * 这个函数负责检查页面的完整性，清理无效的slot，压缩slot目录
- * @param header 页面头部指针
- * @param page_data 页面数据指针
- * @return 验证是否成功
- */
-static bool ValidateAndRepairSlotDirectory(TablePage::TablePageHeader* header,
-                                           char* page_data, page_id_t page_id) {
-    const size_t header_size = sizeof(TablePage::TablePageHeader);
-    const size_t slot_size = sizeof(Slot);
-
-    LOG_DEBUG("ValidateAndRepairSlotDirectory: page "
-              << page_id << " num_tuples=" << header->num_tuples
-              << " free_space_offset=" << header->free_space_offset
-              << " next_page_id=" << header->next_page_id);
-
-    // 首先修复头部
-    if (!ValidateAndFixTablePageHeader(header, page_id)) {
-        LOG_WARN("ValidateAndRepairSlotDirectory: Fixed corrupted header");
-    }
-
-    if (header->num_tuples == 0) {
-        header->free_space_offset = PAGE_SIZE;
-        LOG_DEBUG(
-            "ValidateAndRepairSlotDirectory: empty page, reset "
-            "free_space_offset");
-        return true;
-    }
-
-    size_t slot_end_offset = header_size + header->num_tuples * slot_size;
-    if (slot_end_offset > PAGE_SIZE) {
-        LOG_ERROR(
-            "ValidateAndRepairSlotDirectory: slot directory exceeds page size");
-        header->num_tuples = 0;
-        header->free_space_offset = PAGE_SIZE;
-        return false;
-    }
-
-    Slot* slots = reinterpret_cast<Slot*>(page_data + header_size);
-    size_t calculated_free_offset = PAGE_SIZE;
-    int valid_tuples = 0;
-
-    for (int i = 0; i < header->num_tuples; i++) {
-        if (slots[i].size > 0) {
-            if (slots[i].offset >= slot_end_offset &&
-                slots[i].offset < PAGE_SIZE && slots[i].size <= PAGE_SIZE &&
-                slots[i].offset + slots[i].size <= PAGE_SIZE) {
-                calculated_free_offset =
-                    std::min(calculated_free_offset,
-                             static_cast<size_t>(slots[i].offset));
-                if (valid_tuples != i) {
-                    slots[valid_tuples] = slots[i];
-                }
-                valid_tuples++;
-            } else {
-                LOG_DEBUG(
-                    "ValidateAndRepairSlotDirectory: removing invalid slot "
-                    << i);
-            }
-        }
-    }
-
-    // 清理多余的slot
-    for (int i = valid_tuples; i < header->num_tuples; i++) {
-        slots[i].offset = 0;
-        slots[i].size = 0;
-    }
-
-    header->num_tuples = valid_tuples;
-
-    if (calculated_free_offset < header_size + valid_tuples * slot_size) {
-        calculated_free_offset = PAGE_SIZE;
-    }
-
-    header->free_space_offset = calculated_free_offset;
-
-    LOG_DEBUG("ValidateAndRepairSlotDirectory: page "
-              << page_id << " validated with " << valid_tuples
-              << " valid tuples"
-              << " free_offset=" << header->free_space_offset);
-
-    return true;
-}
-
 /**
  * 删除指定RID的tuple
  * 实现思路：将对应slot的size设为0表示删除，不实际移动数据
@@ -247,17 +125,49 @@ bool TablePage::DeleteTuple(const RID& rid) {
  * 实现思路：
  * 1. 如果新tuple大小相同，直接原地覆盖
  * 2. 如果新tuple更小，原地更新并调整size
- * 3. 如果新tuple更大，先删除原tuple，再尝试在页面末尾插入新tuple
+ * 3. 如果新tuple更大且原tuple就在空闲区边上，连同原来的字节一起使用
+ * 4. 否则在页面的空闲区写入新tuple，slot指向新位置，
+ *    连续空间不够但整理碎片后够用时先整理页面
+ * 所有情况RID都不变，页面放不下时返回false，由调用者决定是否迁移
  * @param tuple 新的tuple数据
  * @param rid 要更新的tuple的RID
  * @return 更新是否成功
  */
 bool TablePage::UpdateTuple(const Tuple& tuple, const RID& rid) {
+    char* tuple_data = PrepareUpdate(rid, tuple.GetSerializedSize());
+    if (tuple_data == nullptr) {
+        return false;
+    }
+    tuple.SerializeTo(tuple_data);
+    return true;
+}
+
+/**
+ * 用序列化好的字节更新tuple，空间安排和UpdateTuple完全相同
+ */
+bool TablePage::UpdateTupleData(const RID& rid, const char* data,
+                                size_t size) {
+    if (size == 0) {
+        return false;
+    }
+    char* tuple_data = PrepareUpdate(rid, size);
+    if (tuple_data == nullptr) {
+        return false;
+    }
+    std::memmove(tuple_data, data, size);
+    return true;
+}
+
+/**
+ * 为更新安排空间，返回新tuple应该写入的位置，slot已经指向这个位置
+ * 四种情况见UpdateTuple的说明；返回nullptr时页面没有改动
+ */
+char* TablePage::PrepareUpdate(const RID& rid, size_t new_tuple_size) {
     auto* header = GetHeader();
 
     // 验证RID的合法性
     if (rid.slot_num < 0 || rid.slot_num >= header->num_tuples) {
-        return false;
+        return nullptr;
     }
 
     const size_t header_size = sizeof(TablePageHeader);
@@ -265,60 +175,81 @@ bool TablePage::UpdateTuple(const Tuple& tuple, const RID& rid) {
 
     // 检查slot是否有效
     if (slots[rid.slot_num].size == 0) {
-        return false;
+        return nullptr;
     }
 
-    size_t new_tuple_size = tuple.GetSerializedSize();
     size_t old_tuple_size = slots[rid.slot_num].size;
 
-    // 情况1：大小相同，直接原地覆盖
-    if (new_tuple_size == old_tuple_size) {
-        char* tuple_data = GetData() + slots[rid.slot_num].offset;
-        tuple.SerializeTo(tuple_data);
-        return true;
-    }
-
-    // 情况2：新tuple更小，原地更新
-    if (new_tuple_size < old_tuple_size) {
-        char* tuple_data = GetData() + slots[rid.slot_num].offset;
-        tuple.SerializeTo(tuple_data);
-        slots[rid.slot_num].size = new_tuple_size;
-        return true;
+    // 情况1和2：大小相同或者新tuple更小，直接原地覆盖
+    if (new_tuple_size <= old_tuple_size) {
+        slots[rid.slot_num].size = static_cast<uint16_t>(new_tuple_size);
+        return GetData() + slots[rid.slot_num].offset;
     }
 
-    // 情况3：新tuple更大，使用删除-插入策略
-    // 保存原始slot信息用于可能的回滚
     uint16_t old_offset = slots[rid.slot_num].offset;
     uint16_t old_size = slots[rid.slot_num].size;
+    size_t slot_end_offset = header_size + header->num_tuples * sizeof(Slot);
+
+    // 情况3：原tuple紧挨着空闲区，向空闲区延伸，原来的字节继续使用
+    if (old_offset == header->free_space_offset &&
+        old_offset + old_size >= slot_end_offset + new_tuple_size) {
+        uint16_t new_offset =
+            static_cast<uint16_t>(old_offset + old_size - new_tuple_size);
+        header->free_space_offset = new_offset;
+        slots[rid.slot_num].offset = new_offset;
+        slots[rid.slot_num].size = static_cast<uint16_t>(new_tuple_size);
+        return GetData() + new_offset;
+    }
+
+    // 情况4：新tuple更大，在空闲区写入新tuple，原位置的字节作废
+    // 连续空间不够时原tuple的字节和其他空洞一起整理出来，整理后仍然放不下
+    // 就不改动页面
+    bool fits = header->free_space_offset >= slot_end_offset + new_tuple_size;
+    if (!fits &&
+        slot_end_offset + GetTupleBytes() - old_size + new_tuple_size >
+            PAGE_SIZE) {
+        return nullptr;
+    }
 
     // 先标记原slot为删除状态
     slots[rid.slot_num].size = 0;
     slots[rid.slot_num].offset = 0;
+    if (!fits) {
+        Compact();
+    }
 
-    // 尝试在页面末尾插入新tuple
-    size_t slot_end_offset = header_size + header->num_tuples * sizeof(Slot);
-    if (header->free_space_offset >= slot_end_offset + new_tuple_size) {
-        // 有足够空间，执行插入
-        header->free_space_offset -= new_tuple_size;
-        char* new_tuple_data = GetData() + header->free_space_offset;
-        tuple.SerializeTo(new_tuple_data);
-
-        // 更新原slot信息指向新位置
-        slots[rid.slot_num].offset = header->free_space_offset;
-        slots[rid.slot_num].size = new_tuple_size;
+    // 在空闲区末尾分配新tuple的空间，原slot指向新位置
+    header->free_space_offset -= new_tuple_size;
+    slots[rid.slot_num].offset = header->free_space_offset;
+    slots[rid.slot_num].size = static_cast<uint16_t>(new_tuple_size);
+    return GetData() + header->free_space_offset;
+}
 
-        return true;
-    } else {
-        // 空间不足，恢复原状态
-        slots[rid.slot_num].offset = old_offset;
-        slots[rid.slot_num].size = old_size;
+/**
+ * 取得slot里序列化的字节，校验和GetTupleView相同
+ */
+bool TablePage::GetTupleData(const RID& rid, const char** data,
+                             size_t* size) {
+    auto* header = GetHeader();
+    if (rid.slot_num < 0 || rid.slot_num >= header->num_tuples) {
         return false;
     }
+    const size_t header_size = sizeof(TablePageHeader);
+    const Slot* slots =
+        reinterpret_cast<const Slot*>(GetData() + header_size);
+    const Slot& slot = slots[rid.slot_num];
+    if (slot.size == 0 || slot.offset < header_size ||
+        slot.offset + slot.size > PAGE_SIZE) {
+        return false;
+    }
+    *data = GetData() + slot.offset;
+    *size = slot.size;
+    return true;
 }
 
 /**
  * 根据RID获取tuple数据
- * 实现思路：验证RID有效性 -> 验证页面结构 -> 反序列化tuple数据
+ * 实现思路：取得页面上的tuple视图 -> 反序列化tuple数据
  * @param rid tuple的RID
  * @param tuple 输出参数，存储获取到的tuple
  * @param schema tuple的schema信息
@@ -331,74 +262,85 @@ bool TablePage::GetTuple(const RID& rid, Tuple* tuple, const Schema* schema) {
         return false;
     }
 
+    TupleView view;
+    if (!GetTupleView(rid, schema, &view)) {
+        return false;
+    }
+
+    try {
+        LOG_DEBUG(
+            "TablePage::GetTuple: About to deserialize tuple data, schema has "
+            << schema->GetColumnCount() << " columns");
+
+        view.ToTuple(tuple);
+
+        LOG_DEBUG("TablePage::GetTuple: Successfully retrieved tuple from slot "
+                  << rid.slot_num << " with " << tuple->GetValues().size()
+                  << " values");
+
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR("TablePage::GetTuple: Failed to deserialize tuple from slot "
+                  << rid.slot_num << ": " << e.what());
+        return false;
+    }
+}
+
+/**
+ * 取得指向页面上tuple数据的视图
+ * 实现思路：验证RID有效性 -> 验证页面结构 -> 检查slot的偏移和大小
+ * @param rid tuple的RID
+ * @param schema tuple的schema信息
+ * @param view 输出参数，引用页面数据的视图
+ * @return slot有效返回true
+ */
+bool TablePage::GetTupleView(const RID& rid, const Schema* schema,
+                             TupleView* view) {
+    if (!view || !schema) {
+        LOG_ERROR("TablePage::GetTupleView: null view or schema pointer");
+        return false;
+    }
+
     auto* header = GetHeader();
     if (!header) {
-        LOG_ERROR("TablePage::GetTuple: null header");
+        LOG_ERROR("TablePage::GetTupleView: null header");
         return false;
     }
 
-    LOG_DEBUG("TablePage::GetTuple: Attempting to get tuple from slot "
+    LOG_DEBUG("TablePage::GetTupleView: Attempting to get tuple from slot "
               << rid.slot_num << " (total slots: " << header->num_tuples
               << ")");
 
     // 验证slot编号范围
     if (rid.slot_num < 0 || rid.slot_num >= header->num_tuples) {
-        LOG_DEBUG("TablePage::GetTuple: slot "
+        LOG_DEBUG("TablePage::GetTupleView: slot "
                   << rid.slot_num << " out of range [0, " << header->num_tuples
                   << ")");
         return false;
     }
 
-    // 验证和修复页面结构
-    if (!ValidateAndRepairSlotDirectory(header, GetData(), GetPageId())) {
-        LOG_ERROR("TablePage::GetTuple: page structure validation failed");
-        return false;
-    }
-
     const size_t header_size = sizeof(TablePageHeader);
     Slot* slots = reinterpret_cast<Slot*>(GetData() + header_size);
 
     // 检查slot是否有效（未被删除）
     if (slots[rid.slot_num].size == 0) {
-        LOG_DEBUG("TablePage::GetTuple: slot " << rid.slot_num
-                                               << " is deleted (size=0)");
+        LOG_DEBUG("TablePage::GetTupleView: slot " << rid.slot_num
+                                                   << " is deleted (size=0)");
         return false;
     }
 
-    LOG_DEBUG("TablePage::GetTuple: slot "
-              << rid.slot_num << " has offset=" << slots[rid.slot_num].offset
-              << ", size=" << slots[rid.slot_num].size);
-
     // 验证slot的offset和size的合理性
     if (slots[rid.slot_num].offset < header_size ||
         slots[rid.slot_num].offset + slots[rid.slot_num].size > PAGE_SIZE) {
-        LOG_WARN("TablePage::GetTuple: invalid slot "
+        LOG_WARN("TablePage::GetTupleView: invalid slot "
                  << rid.slot_num << " (offset=" << slots[rid.slot_num].offset
                  << ", size=" << slots[rid.slot_num].size << ")");
         return false;
     }
 
-    // 获取tuple数据并反序列化
-    char* tuple_data = GetData() + slots[rid.slot_num].offset;
-
-    try {
-        LOG_DEBUG(
-            "TablePage::GetTuple: About to deserialize tuple data, schema has "
-            << schema->GetColumnCount() << " columns");
-
-        tuple->DeserializeFrom(tuple_data, schema);
-        tuple->SetRID(rid);
-
-        LOG_DEBUG("TablePage::GetTuple: Successfully retrieved tuple from slot "
-                  << rid.slot_num << " with " << tuple->GetValues().size()
-                  << " values");
-
-        return true;
-    } catch (const std::exception& e) {
-        LOG_ERROR("TablePage::GetTuple: Failed to deserialize tuple from slot "
-                  << rid.slot_num << ": " << e.what());
-        return false;
-    }
+    *view = TupleView(GetData() + slots[rid.slot_num].offset,
+                      slots[rid.slot_num].size, schema, rid);
+    return true;
 }
 
 /**
@@ -411,13 +353,6 @@ bool TablePage::GetTuple(const RID& rid, Tuple* tuple, const Schema* schema) {
 bool TablePage::GetNextTupleRID(const RID& current_rid, RID* next_rid) {
     auto* header = GetHeader();
 
-    // 验证和修复页面结构
-    if (!ValidateAndRepairSlotDirectory(header, GetData(), GetPageId())) {
-        LOG_ERROR("TablePage::GetNextTupleRID: page corrupted, reinitializing");
-        Init(GetPageId(), INVALID_PAGE_ID);
-        return false;
-    }
-
     // 空页面直接返回false
     if (header->num_tuples == 0) {
         return false;
@@ -448,50 +383,100 @@ bool TablePage::GetNextTupleRID(const RID& current_rid, RID* next_rid) {
  * 获取下一页面的ID
  */
 page_id_t TablePage::GetNextPageId() const {
-    auto* header = GetHeader();
-
-    // 验证头部完整性
-    TablePage::TablePageHeader temp_header = *header;
-    if (!ValidateAndFixTablePageHeader(&temp_header, GetPageId())) {
-        LOG_WARN("TablePage::GetNextPageId: Header corruption detected on page "
-                 << GetPageId() << ", using fixed value");
-        return temp_header.next_page_id;
-    }
-
-    return header->next_page_id;
+    return GetHeader()->next_page_id;
 }
 
 /**
  * 设置下一页面的ID
  */
 void TablePage::SetNextPageId(page_id_t next_page_id) {
-    // 验证输入参数
-    if (next_page_id != INVALID_PAGE_ID &&
-        (next_page_id < 2 || next_page_id > 1000000)) {
+    // 0号和1号页面是catalog和索引头部页面，不会出现在表的页面链表里
+    if (next_page_id != INVALID_PAGE_ID && next_page_id < 2) {
         LOG_ERROR("TablePage::SetNextPageId: Invalid next_page_id "
                   << next_page_id << " for page " << GetPageId());
         return;
     }
 
-    auto* header = GetHeader();
+    GetHeader()->next_page_id = next_page_id;
 
-    // 验证当前头部状态
-    if (!ValidateAndFixTablePageHeader(header, GetPageId())) {
-        LOG_WARN(
-            "TablePage::SetNextPageId: Fixed corrupted header before setting "
-            "next_page_id");
+    LOG_DEBUG("TablePage::SetNextPageId: Set next_page_id to "
+              << next_page_id << " on page " << GetPageId());
+}
+
+/**
+ * 获取页面头中的LSN
+ */
+lsn_t TablePage::GetPageLSN() const { return GetHeader()->lsn; }
+
+/**
+ * 设置页面LSN，页面头和内存中的LSN保持一致
+ */
+void TablePage::SetPageLSN(lsn_t lsn) {
+    GetHeader()->lsn = lsn;
+    SetLSN(lsn);
+}
+
+/**
+ * 计算页面的空闲空间
+ * 和InsertTuple的空间检查一致：slot目录再多一项之后到tuple数据起点之间的字节
+ */
+size_t TablePage::GetFreeSpace() const {
+    const auto* header = GetHeader();
+    size_t slot_end_offset =
+        sizeof(TablePageHeader) + (header->num_tuples + 1) * sizeof(Slot);
+    if (header->free_space_offset > PAGE_SIZE) {
+        return 0;
     }
+    size_t used = slot_end_offset + GetTupleBytes();
+    return used < PAGE_SIZE ? PAGE_SIZE - used : 0;
+}
 
-    header->next_page_id = next_page_id;
+size_t TablePage::GetTupleBytes() const {
+    const auto* header = GetHeader();
+    const Slot* slots =
+        reinterpret_cast<const Slot*>(GetData() + sizeof(TablePageHeader));
+    size_t bytes = 0;
+    for (uint16_t i = 0; i < header->num_tuples; i++) {
+        bytes += slots[i].size;
+    }
+    return bytes;
+}
 
-    LOG_DEBUG("TablePage::SetNextPageId: Set next_page_id to "
-              << next_page_id << " on page " << GetPageId());
+/**
+ * 整理页面碎片
+ * 实现思路：按slot顺序把有效tuple依次复制到临时缓冲区的末尾，
+ * 再整体拷回页面，slot只改偏移；没有空洞时什么都不做
+ */
+bool TablePage::Compact() {
+    auto* header = GetHeader();
+    size_t live_bytes = GetTupleBytes();
+    if (header->free_space_offset + live_bytes >= PAGE_SIZE) {
+        return false;
+    }
+
+    Slot* slots = reinterpret_cast<Slot*>(GetData() + sizeof(TablePageHeader));
+    char buffer[PAGE_SIZE];
+    size_t offset = PAGE_SIZE;
+    for (uint16_t i = 0; i < header->num_tuples; i++) {
+        if (slots[i].size == 0) {
+            continue;
+        }
+        offset -= slots[i].size;
+        std::memcpy(buffer + offset, GetData() + slots[i].offset,
+                    slots[i].size);
+        slots[i].offset = static_cast<uint16_t>(offset);
+    }
+    std::memcpy(GetData() + offset, buffer + offset, PAGE_SIZE - offset);
+    header->free_space_offset = static_cast<uint16_t>(offset);
+    return true;
 }
 
 /**
  * 获取页面头部指针（可写）
+ * 页面的所有操作都从这里开始，从磁盘读入后的第一次访问在这里核对校验值
  */
 TablePage::TablePageHeader* TablePage::GetHeader() {
+    CheckChecksum();
     return reinterpret_cast<TablePageHeader*>(GetData());
 }
 
@@ -499,9 +484,17 @@ TablePage::TablePageHeader* TablePage::GetHeader() {
  * 获取页面头部指针（只读）
  */
 const TablePage::TablePageHeader* TablePage::GetHeader() const {
+    CheckChecksum();
     return reinterpret_cast<const TablePageHeader*>(GetData());
 }
 
+void TablePage::CheckChecksum() const {
+    if (!VerifyChecksum(CHECKSUM_OFFSET)) {
+        throw StorageException("Checksum mismatch on table page " +
+                               std::to_string(GetPageId()));
+    }
+}
+
 /**
  * TableHeap构造函数 - 创建新的表堆
  * 实现思路：申请第一个页面并初始化为表页面
@@ -531,8 +524,15 @@ TableHeap::TableHeap(BufferPoolManager* buffer_pool_manager,
     first_page->WLatch();
     auto* table_page = reinterpret_cast<TablePage*>(first_page);
     table_page->Init(first_page_id_, INVALID_PAGE_ID);
+    free_space_map_.Update(first_page_id_, table_page->GetFreeSpace());
+    zone_map_.Set(first_page_id_, ZoneMap::PageZone());
+    page_directory_.Append(first_page_id_);
     first_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(first_page_id_, true);
+
+    // 新表只有一个页面，映射不需要再扫描建立
+    last_page_id_ = first_page_id_;
+    free_space_map_built_.store(true);
     
     LOG_DEBUG("TableHeap: Created new table heap with first_page_id=" 
               << first_page_id_);
@@ -541,6 +541,8 @@ TableHeap::TableHeap(BufferPoolManager* buffer_pool_manager,
 /**
  * TableHeap构造函数 - 从已存在的页面恢复表堆
  * 这个构造函数用于数据库恢复时重建TableHeap对象
+ * 打开时不读任何页面，第一次访问时由FetchTablePage读入并核对校验值，
+ * 启动时打开很多张表不用为每张表读一次磁盘
  * @param buffer_pool_manager 缓冲池管理器
  * @param schema 表的schema
  * @param first_page_id 已存在的第一个页面ID
@@ -550,7 +552,7 @@ TableHeap::TableHeap(BufferPoolManager* buffer_pool_manager,
     : buffer_pool_manager_(buffer_pool_manager),
       schema_(schema),
       first_page_id_(first_page_id) {
-    LOG_DEBUG("TableHeap: Creating TableHeap with existing first_page_id="
+    LOG_DEBUG("TableHeap: Opening TableHeap with existing first_page_id="
               << first_page_id);
     
     // 确保first_page_id不是保留页面
@@ -559,33 +561,12 @@ TableHeap::TableHeap(BufferPoolManager* buffer_pool_manager,
                   << ", must be >= 2 (pages 0-1 are reserved)");
         throw Exception("Invalid first page ID for table heap");
     }
-    
-    Page* first_page = buffer_pool_manager_->FetchPage(first_page_id_);
-    if (first_page == nullptr) {
-        LOG_ERROR("TableHeap: Cannot fetch first page "
-                  << first_page_id << " for table heap recovery");
+    if (first_page_id >=
+        buffer_pool_manager_->GetDiskManager()->GetNumPages()) {
+        LOG_ERROR("TableHeap: first_page_id " << first_page_id
+                  << " is beyond the end of the database file");
         throw Exception("Cannot fetch first page for table heap recovery");
     }
-    
-    // 验证页面完整性
-    first_page->RLatch();
-    auto* table_page = reinterpret_cast<TablePage*>(first_page);
-    auto* header = table_page->GetHeader();
-    
-    // 使用我们的验证函数检查和修复头部
-    if (!ValidateAndFixTablePageHeader(header, first_page_id)) {
-        LOG_WARN("TableHeap: Fixed corrupted header in first page " << first_page_id);
-        first_page->RUnlatch();
-        first_page->WLatch();
-        first_page->SetDirty(true);
-        first_page->WUnlatch();
-    } else {
-        first_page->RUnlatch();
-    }
-    
-    LOG_DEBUG("TableHeap: Successfully validated first page " << first_page_id);
-    buffer_pool_manager_->UnpinPage(first_page_id_, false);
-    LOG_DEBUG("TableHeap: TableHeap created successfully");
 }
 
 /**
@@ -593,102 +574,392 @@ TableHeap::TableHeap(BufferPoolManager* buffer_pool_manager,
  */
 TableHeap::~TableHeap() = default;
 
+/**
+ * 取得表页面并核对校验值
+ * 校验值不对时先unpin再抛异常，调用者还没有加锁，不会留下被锁住的页面
+ */
+Page* TableHeap::FetchTablePage(page_id_t page_id,
+                                BufferAccessStrategy* strategy) {
+    Page* page = buffer_pool_manager_->FetchPage(page_id, strategy);
+    if (page != nullptr && !page->VerifyChecksum(TablePage::CHECKSUM_OFFSET)) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        throw StorageException("Checksum mismatch on table page " +
+                               std::to_string(page_id));
+    }
+    return page;
+}
+
+/**
+ * 写一次页面修改的日志
+ * recLSN取追加之前的日志末尾，它不大于这条记录的LSN
+ */
+void TableHeap::LogPageModification(TablePage* table_page,
+                                    LogRecord* log_record) {
+    table_page->MarkRecLSN(log_manager_->GetLastReservedLSN() + 1);
+    lsn_t lsn = log_manager_->AppendLogRecord(log_record);
+    table_page->SetPageLSN(lsn);
+}
+
+/**
+ * 建立空闲空间映射和页面目录
+ * 实现思路：
+ * 1. 双重检查，只有第一个插入（或者访问目录）的线程扫描链表
+ * 2. 逐页加读锁读出空闲空间和下一页ID，页面按顺序追加到目录，
+ *    扫描结束时记下末尾页面
+ * 3. 扫描时表不会扩展（扩展也要持有extend_latch_），其他线程的删除和更新
+ *    不影响结果的正确性，映射偏高的部分在插入时纠正
+ */
+void TableHeap::EnsureFreeSpaceMap() {
+    if (free_space_map_built_.load()) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(extend_latch_);
+    if (free_space_map_built_.load()) {
+        return;
+    }
+
+    page_id_t current_page_id = first_page_id_;
+    while (current_page_id != INVALID_PAGE_ID) {
+        Page* page = FetchTablePage(current_page_id);
+        if (page == nullptr) {
+            LOG_WARN("TableHeap: cannot fetch page "
+                     << current_page_id << " while building free space map");
+            break;
+        }
+        page->RLatch();
+        auto* table_page = reinterpret_cast<TablePage*>(page);
+        free_space_map_.Update(current_page_id, table_page->GetFreeSpace());
+        page_directory_.Append(current_page_id);
+        page_id_t next_page_id = table_page->GetNextPageId();
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(current_page_id, false);
+
+        last_page_id_ = current_page_id;
+        current_page_id = next_page_id;
+    }
+
+    LOG_DEBUG("TableHeap: built free space map for "
+              << free_space_map_.GetPageCount() << " pages, last page "
+              << last_page_id_);
+    free_space_map_built_.store(true);
+}
+
+bool TableHeap::InsertIntoPage(TablePage* table_page, const Tuple& tuple,
+                               RID* rid, txn_id_t txn_id, Transaction* txn) {
+    bool inserted = table_page->InsertTuple(tuple, rid);
+    if (inserted) {
+        zone_map_.Widen(rid->page_id, tuple);
+        RecordVersion(txn, *rid, false, nullptr, 0);
+        // 插入成功，记录INSERT日志
+        if (log_manager_ &&
+            txn_id != static_cast<txn_id_t>(INVALID_TXN_ID)) {
+            InsertLogRecord log_record(txn_id, INVALID_LSN, *rid, tuple);
+            LogPageModification(table_page, &log_record);
+        } else {
+            table_page->SetLSN(0);
+        }
+    }
+    free_space_map_.Update(table_page->GetPageId(),
+                           table_page->GetFreeSpace());
+    return inserted;
+}
+
 /**
  * 向表中插入一个tuple
  * 实现思路：
- * 1. 从第一个页面开始遍历，尝试在现有页面中插入
- * 2. 如果现有页面都满了，创建新页面并插入
- * 3. 记录WAL日志（如果启用了日志管理）
+ * 1. 从空闲空间映射中找一个放得下的页面，只读取这一个页面
+ * 2. 映射可能偏高（并发插入抢先用掉了空间），插入失败时映射已经按
+ *    页面实际空间更新，重新查找；多次失败就直接去表末尾
+ * 3. 没有页面放得下时在表末尾插入，必要时扩展表
+ * 4. 记录WAL日志（如果启用了日志管理）
  * @param tuple 要插入的tuple
  * @param rid 输出参数，存储插入后的RID
  * @param txn_id 事务ID
  * @return 插入是否成功
  */
-bool TableHeap::InsertTuple(const Tuple& tuple, RID* rid, txn_id_t txn_id) {
-    page_id_t current_page_id = first_page_id_;
+bool TableHeap::InsertTuple(const Tuple& tuple, RID* rid, txn_id_t txn_id,
+                            Transaction* txn) {
+    EnsureFreeSpaceMap();
+
+    constexpr int kMaxAttempts = 4;
+    size_t required_bytes = tuple.GetSerializedSize();
+    for (int attempt = 0; attempt < kMaxAttempts; attempt++) {
+        page_id_t page_id = free_space_map_.FindPage(required_bytes);
+        if (page_id == INVALID_PAGE_ID) {
+            break;
+        }
 
-    // 遍历所有页面寻找可插入的位置
-    while (current_page_id != INVALID_PAGE_ID) {
-        Page* page = buffer_pool_manager_->FetchPage(current_page_id);
+        Page* page = FetchTablePage(page_id);
         if (page == nullptr) {
             return false;
         }
+        page->WLatch();
+        bool inserted = InsertIntoPage(reinterpret_cast<TablePage*>(page),
+                                       tuple, rid, txn_id, txn);
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, inserted);
+        if (inserted) {
+            return true;
+        }
+    }
 
+    return InsertAtEnd(tuple, rid, txn_id, txn);
+}
+
+/**
+ * 在表末尾插入
+ * 实现思路：
+ * 1. 持有extend_latch_，先试末尾页面：等锁期间别的线程可能刚扩展过表，
+ *    新的末尾页面多半还有空间
+ * 2. 末尾页面放不下，申请新页面并链接到末尾页面之后，在新页面中插入
+ */
+bool TableHeap::InsertAtEnd(const Tuple& tuple, RID* rid, txn_id_t txn_id,
+                            Transaction* txn) {
+    std::lock_guard<std::mutex> guard(extend_latch_);
+
+    page_id_t page_id;
+    Page* page = FetchLastPage(&page_id);
+    if (page == nullptr) {
+        return false;
+    }
+    if (InsertIntoPage(reinterpret_cast<TablePage*>(page), tuple, rid,
+                       txn_id, txn)) {
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, true);
+        return true;
+    }
+
+    // 需要创建新页面，在新页面中插入tuple
+    page = ExtendTable(page, &page_id);
+    if (page == nullptr) {
+        return false;
+    }
+    bool inserted = InsertIntoPage(reinterpret_cast<TablePage*>(page), tuple,
+                                   rid, txn_id, txn);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return inserted;
+}
+
+Page* TableHeap::FetchLastPage(page_id_t* page_id) {
+    page_id_t current_page_id = last_page_id_;
+    Page* page = FetchTablePage(current_page_id);
+    if (page == nullptr) {
+        return nullptr;
+    }
+    page->WLatch();
+    auto* table_page = reinterpret_cast<TablePage*>(page);
+    while (table_page->GetNextPageId() != INVALID_PAGE_ID) {
+        page_id_t next_page_id = table_page->GetNextPageId();
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(current_page_id, false);
+        // 记下的末尾之后还有页面（比如恢复接上的页面），目录也要跟上
+        if (page_directory_.GetLastPage() == current_page_id) {
+            page_directory_.Append(next_page_id);
+        }
+        current_page_id = next_page_id;
+        page = FetchTablePage(current_page_id);
+        if (page == nullptr) {
+            return nullptr;
+        }
         page->WLatch();
-        auto* table_page = reinterpret_cast<TablePage*>(page);
+        table_page = reinterpret_cast<TablePage*>(page);
+    }
+    last_page_id_ = current_page_id;
+    *page_id = current_page_id;
+    return page;
+}
 
-        // 尝试在当前页面插入tuple
-        if (table_page->InsertTuple(tuple, rid)) {
-            // 插入成功，记录INSERT日志
-            if (log_manager_ && txn_id != INVALID_TXN_ID) {
-                InsertLogRecord log_record(txn_id, INVALID_LSN, *rid, tuple);
-                lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
-                page->SetLSN(lsn);
-            } else {
-                page->SetLSN(0);
-            }
+Page* TableHeap::ExtendTable(Page* last_page, page_id_t* page_id) {
+    page_id_t last_page_id = *page_id;
+    page_id_t new_page_id;
+    Page* new_page = buffer_pool_manager_->NewPage(&new_page_id, &extent_);
+    if (new_page == nullptr) {
+        last_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(last_page_id, false);
+        return nullptr;
+    }
 
-            page->WUnlatch();
-            buffer_pool_manager_->UnpinPage(current_page_id, true);
-            return true;
+    // 初始化新页面并链接到当前页面
+    new_page->WLatch();
+    auto* new_table_page = reinterpret_cast<TablePage*>(new_page);
+    new_table_page->Init(new_page_id, last_page_id);
+    auto* last_table_page = reinterpret_cast<TablePage*>(last_page);
+    last_table_page->SetNextPageId(new_page_id);
+    if (log_manager_) {
+        // 新页面和链表指针都靠这条记录重做，两个页面的LSN都推进到这条记录，
+        // 后台写线程要等日志落盘才能写出它们
+        NewPageLogRecord log_record(new_page_id, last_page_id);
+        last_table_page->MarkRecLSN(log_manager_->GetLastReservedLSN() + 1);
+        LogPageModification(new_table_page, &log_record);
+        last_table_page->SetPageLSN(log_record.GetLSN());
+    }
+    zone_map_.Set(new_page_id, ZoneMap::PageZone());
+    zone_map_.SetNextPageId(last_page_id, new_page_id);
+    page_directory_.Append(new_page_id);
+
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+    last_page_id_ = new_page_id;
+    *page_id = new_page_id;
+    return new_page;
+}
+
+/**
+ * 重放接上的新页面
+ * 实现思路：页面目录已经建立并且末尾就是last_page_id时直接追加，
+ * 否则等下次EnsureFreeSpaceMap或FetchLastPage沿链表补上
+ */
+void TableHeap::OnPageAppended(page_id_t last_page_id,
+                               page_id_t new_page_id) {
+    std::lock_guard<std::mutex> guard(extend_latch_);
+    if (free_space_map_built_ &&
+        page_directory_.GetLastPage() == last_page_id) {
+        page_directory_.Append(new_page_id);
+    }
+    zone_map_.SetNextPageId(last_page_id, new_page_id);
+    zone_map_.Remove(new_page_id);
+    if (last_page_id_ == last_page_id) {
+        last_page_id_ = new_page_id;
+    }
+}
+
+/**
+ * 批量插入
+ * 实现思路：
+ * 1. 和InsertTuple一样通过空闲空间映射找页面，但拿到页面后一直插到
+ *    页面放不下为止，每个页面只fetch、加锁、写日志一次
+ * 2. 映射找不到页面（或者连续几次找到的页面都已经满了）时转到表末尾，
+ *    持有扩展锁把剩下的tuple全部放进末尾页面和新申请的页面
+ */
+bool TableHeap::InsertTuples(const std::vector<Tuple>& tuples,
+                             std::vector<RID>* rids, txn_id_t txn_id,
+                             Transaction* txn) {
+    EnsureFreeSpaceMap();
+    rids->clear();
+    rids->reserve(tuples.size());
+
+    constexpr int kMaxAttempts = 4;
+    int misses = 0;
+    size_t next = 0;
+    while (next < tuples.size()) {
+        page_id_t page_id = INVALID_PAGE_ID;
+        if (misses < kMaxAttempts) {
+            page_id =
+                free_space_map_.FindPage(tuples[next].GetSerializedSize());
+        }
+        if (page_id == INVALID_PAGE_ID) {
+            return FillPagesAtEnd(tuples, &next, rids, txn_id, txn);
         }
 
-        // 当前页面插入失败，检查是否需要创建新页面
-        page_id_t next_page_id = table_page->GetNextPageId();
-        if (next_page_id == INVALID_PAGE_ID) {
-            // 需要创建新页面
-            page_id_t new_page_id;
-            Page* new_page = buffer_pool_manager_->NewPage(&new_page_id);
-            if (new_page == nullptr) {
-                page->WUnlatch();
-                buffer_pool_manager_->UnpinPage(current_page_id, false);
-                return false;
-            }
+        Page* page = FetchTablePage(page_id);
+        if (page == nullptr) {
+            return false;
+        }
+        page->WLatch();
+        size_t inserted = FillPage(reinterpret_cast<TablePage*>(page), tuples,
+                                   &next, rids, txn_id, txn);
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, inserted > 0);
+        misses = inserted > 0 ? 0 : misses + 1;
+    }
+    return true;
+}
 
-            // 初始化新页面并链接到当前页面
-            new_page->WLatch();
-            auto* new_table_page = reinterpret_cast<TablePage*>(new_page);
-            new_table_page->Init(new_page_id, current_page_id);
-            table_page->SetNextPageId(new_page_id);
-
-            page->WUnlatch();
-            buffer_pool_manager_->UnpinPage(current_page_id, true);
-
-            // 在新页面中插入tuple
-            if (new_table_page->InsertTuple(tuple, rid)) {
-                // 插入成功，记录INSERT日志
-                if (log_manager_ && txn_id != INVALID_TXN_ID) {
-                    InsertLogRecord log_record(txn_id, INVALID_LSN, *rid,
-                                               tuple);
-                    lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
-                    new_page->SetLSN(lsn);
-                } else {
-                    new_page->SetLSN(0);
-                }
+bool TableHeap::AppendTuples(const std::vector<Tuple>& tuples,
+                             std::vector<RID>* rids, txn_id_t txn_id,
+                             Transaction* txn) {
+    EnsureFreeSpaceMap();
+    rids->clear();
+    rids->reserve(tuples.size());
+    size_t next = 0;
+    return tuples.empty() || FillPagesAtEnd(tuples, &next, rids, txn_id, txn);
+}
 
-                new_page->WUnlatch();
-                buffer_pool_manager_->UnpinPage(new_page_id, true);
-                return true;
-            } else {
-                new_page->WUnlatch();
-                buffer_pool_manager_->UnpinPage(new_page_id, true);
-                return false;
+bool TableHeap::FillPagesAtEnd(const std::vector<Tuple>& tuples, size_t* next,
+                               std::vector<RID>* rids, txn_id_t txn_id,
+                               Transaction* txn) {
+    std::lock_guard<std::mutex> guard(extend_latch_);
+
+    page_id_t page_id;
+    Page* page = FetchLastPage(&page_id);
+    if (page == nullptr) {
+        return false;
+    }
+    FillPage(reinterpret_cast<TablePage*>(page), tuples, next, rids, txn_id,
+             txn);
+    while (*next < tuples.size()) {
+        page = ExtendTable(page, &page_id);
+        if (page == nullptr) {
+            return false;
+        }
+        // 空页面都放不下说明tuple本身无效，不再继续申请页面
+        if (FillPage(reinterpret_cast<TablePage*>(page), tuples, next, rids,
+                     txn_id, txn) == 0) {
+            break;
+        }
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return *next == tuples.size();
+}
+
+size_t TableHeap::FillPage(TablePage* table_page,
+                           const std::vector<Tuple>& tuples, size_t* next,
+                           std::vector<RID>* rids, txn_id_t txn_id,
+                           Transaction* txn) {
+    bool logging = log_manager_ &&
+                   txn_id != static_cast<txn_id_t>(INVALID_TXN_ID);
+    size_t inserted = 0;
+    bool page_full = false;
+    while (*next < tuples.size() && !page_full) {
+        MultiInsertLogRecord log_record(txn_id, INVALID_LSN,
+                                        table_page->GetPageId());
+        size_t batch_begin = *next;
+        while (*next < tuples.size()) {
+            const Tuple& tuple = tuples[*next];
+            if (logging && !log_record.HasRoomFor(tuple.GetSerializedSize())) {
+                break;  // 这条日志满了，同一页面上开始下一批
+            }
+            RID rid;
+            if (!table_page->InsertTuple(tuple, &rid)) {
+                page_full = true;
+                break;
             }
+            zone_map_.Widen(rid.page_id, tuple);
+            RecordVersion(txn, rid, false, nullptr, 0);
+            if (logging) {
+                log_record.AddTuple(rid.slot_num, tuple);
+            }
+            rids->push_back(rid);
+            (*next)++;
+        }
+
+        size_t batch_size = *next - batch_begin;
+        if (batch_size == 0) {
+            break;
+        }
+        inserted += batch_size;
+        if (!logging) {
+            table_page->SetLSN(0);
+        } else if (batch_size == 1) {
+            InsertLogRecord single_record(txn_id, INVALID_LSN, rids->back(),
+                                          tuples[batch_begin]);
+            LogPageModification(table_page, &single_record);
         } else {
-            // 继续检查下一个页面
-            page->WUnlatch();
-            buffer_pool_manager_->UnpinPage(current_page_id, false);
-            current_page_id = next_page_id;
+            LogPageModification(table_page, &log_record);
         }
     }
-    return false;
+    free_space_map_.Update(table_page->GetPageId(),
+                           table_page->GetFreeSpace());
+    return inserted;
 }
 
 /**
  * 在页面中插入tuple
  * 实现思路：
  * 1. 验证tuple大小和页面结构
- * 2. 检查是否有足够的空间（slot目录 + tuple数据）
+ * 2. 检查是否有足够的空间（slot目录 + tuple数据），碎片化时先整理页面
  * 3. 在页面末尾分配空间存储tuple数据
  * 4. 在slot目录中添加新的slot条目
  * @param tuple 要插入的tuple
@@ -712,26 +983,23 @@ bool TablePage::InsertTuple(const Tuple& tuple, RID* rid) {
         return false;
     }
 
-    // 验证和修复页面结构
-    if (!ValidateAndRepairSlotDirectory(header, GetData(), GetPageId())) {
-        LOG_ERROR(
-            "TablePage::InsertTuple: page severely corrupted, reinitializing");
-        Init(GetPageId(), INVALID_PAGE_ID);
-        header = GetHeader();
-    }
-
     // 计算插入所需的空间
     size_t slot_end_offset =
         header_size + (header->num_tuples + 1) * slot_size;  // +1 for new slot
     size_t required_data_space = tuple_size;
 
     // 检查总空间是否足够（slot目录不能与tuple数据重叠）
+    // 连续空间不够时看删除和更新留下的空洞，整理之后够用就先整理页面
     if (slot_end_offset + required_data_space > header->free_space_offset) {
-        LOG_DEBUG("TablePage::InsertTuple: insufficient space. "
-                  << "slot_end=" << slot_end_offset
-                  << " + data=" << required_data_space
-                  << " > free_offset=" << header->free_space_offset);
-        return false;
+        if (slot_end_offset + required_data_space >
+            PAGE_SIZE - GetTupleBytes()) {
+            LOG_DEBUG("TablePage::InsertTuple: insufficient space. "
+                      << "slot_end=" << slot_end_offset
+                      << " + data=" << required_data_space
+                      << " > free_offset=" << header->free_space_offset);
+            return false;
+        }
+        Compact();
     }
 
     // 执行插入操作
@@ -758,6 +1026,47 @@ bool TablePage::InsertTuple(const Tuple& tuple, RID* rid) {
 
     return true;
 }
+
+/**
+ * 把序列化好的tuple放进指定的slot
+ * 实现思路：
+ * 1. slot在现有范围之内时必须是空的（被删除过）
+ * 2. slot超出现有范围时，中间跳过的slot补成空slot
+ * 3. 空间检查和整理碎片与InsertTuple相同，放不下时不改动页面
+ */
+bool TablePage::InsertTupleAt(slot_offset_t slot_num, const char* data,
+                              size_t size) {
+    auto* header = GetHeader();
+    const size_t header_size = sizeof(TablePageHeader);
+    if (size == 0 || size > PAGE_SIZE / 2 || slot_num < 0 ||
+        static_cast<size_t>(slot_num) >= MAX_SLOTS_PER_PAGE) {
+        return false;
+    }
+
+    Slot* slots = reinterpret_cast<Slot*>(GetData() + header_size);
+    size_t num_slots = std::max<size_t>(header->num_tuples, slot_num + 1);
+    if (slot_num < header->num_tuples && slots[slot_num].size != 0) {
+        return false;
+    }
+
+    size_t slot_end_offset = header_size + num_slots * sizeof(Slot);
+    if (slot_end_offset + size > header->free_space_offset) {
+        if (slot_end_offset + size > PAGE_SIZE - GetTupleBytes()) {
+            return false;
+        }
+        Compact();
+    }
+
+    for (size_t i = header->num_tuples; i < num_slots; i++) {
+        slots[i] = Slot();
+    }
+    header->num_tuples = static_cast<uint16_t>(num_slots);
+    header->free_space_offset -= size;
+    std::memcpy(GetData() + header->free_space_offset, data, size);
+    slots[slot_num].offset = header->free_space_offset;
+    slots[slot_num].size = static_cast<uint16_t>(size);
+    return true;
+}
 /**
  * 删除指定RID位置的tuple
  *
@@ -773,15 +1082,30 @@ bool TablePage::InsertTuple(const Tuple& tuple, RID* rid) {
  * @param txn_id 事务ID，用于日志记录
  * @return 删除成功返回true，失败返回false
  */
-bool TableHeap::DeleteTuple(const RID& rid, txn_id_t txn_id) {
-    Page* page = buffer_pool_manager_->FetchPage(rid.page_id);
+bool TableHeap::DeleteTuple(const RID& rid, txn_id_t txn_id,
+                            Transaction* txn) {
+    Page* page = FetchTablePage(rid.page_id);
     if (page == nullptr) {
         return false;
     }
 
     page->WLatch();
     auto* table_page = reinterpret_cast<TablePage*>(page);
-    
+    if (HasWriteConflict(rid, txn)) {
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(rid.page_id, false);
+        return false;
+    }
+
+    // 删除之前留下修改前的内容，旧快照还要读它
+    std::string before;
+    if (txn != nullptr && txn->HasSnapshot()) {
+        TupleView view;
+        if (table_page->GetTupleView(rid, schema_, &view)) {
+            before.assign(view.GetData(), view.GetSize());
+        }
+    }
+
     Tuple deleted_tuple;
     bool got_tuple = false;
     if (log_manager_ && txn_id != INVALID_TXN_ID) {
@@ -790,11 +1114,15 @@ bool TableHeap::DeleteTuple(const RID& rid, txn_id_t txn_id) {
 
     bool result = table_page->DeleteTuple(rid);
     if (result) {
+        // 删除留下的空洞之后的插入可以用，页面满时整理碎片
+        if (free_space_map_built_.load()) {
+            free_space_map_.Update(rid.page_id, table_page->GetFreeSpace());
+        }
+        RecordVersion(txn, rid, true, before.data(), before.size());
         if (log_manager_ && txn_id != INVALID_TXN_ID && got_tuple) {
             // 使用专门的DeleteLogRecord
             DeleteLogRecord log_record(txn_id, INVALID_LSN, rid, deleted_tuple);
-            lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
-            page->SetLSN(lsn);
+            LogPageModification(table_page, &log_record);
         } else {
             page->SetLSN(0);
         }
@@ -822,14 +1150,27 @@ bool TableHeap::DeleteTuple(const RID& rid, txn_id_t txn_id) {
  * @return 更新成功返回true，失败返回false
  */
 bool TableHeap::UpdateTuple(const Tuple& tuple, const RID& rid,
-                            txn_id_t txn_id) {
-    Page* page = buffer_pool_manager_->FetchPage(rid.page_id);
+                            txn_id_t txn_id, Transaction* txn) {
+    Page* page = FetchTablePage(rid.page_id);
     if (page == nullptr) {
         return false;
     }
 
     page->WLatch();
     auto* table_page = reinterpret_cast<TablePage*>(page);
+    if (HasWriteConflict(rid, txn)) {
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(rid.page_id, false);
+        return false;
+    }
+
+    std::string before;
+    if (txn != nullptr && txn->HasSnapshot()) {
+        TupleView view;
+        if (table_page->GetTupleView(rid, schema_, &view)) {
+            before.assign(view.GetData(), view.GetSize());
+        }
+    }
 
     // 获取更新前的tuple用于WAL日志
     Tuple old_tuple;
@@ -838,16 +1179,32 @@ bool TableHeap::UpdateTuple(const Tuple& tuple, const RID& rid,
         got_old_tuple = table_page->GetTuple(rid, &old_tuple, schema_);
     }
 
-    // 执行实际的更新操作
+    // 执行实际的更新操作，变大的tuple会占用页面的空闲空间
     bool result = table_page->UpdateTuple(tuple, rid);
+    if (result && free_space_map_built_.load()) {
+        free_space_map_.Update(rid.page_id, table_page->GetFreeSpace());
+    }
+    if (result) {
+        zone_map_.Widen(rid.page_id, tuple);
+        RecordVersion(txn, rid, true, before.data(), before.size());
+    }
 
     if (result) {
         // 记录UPDATE日志：包含before和after的tuple内容
         if (log_manager_ && txn_id != INVALID_TXN_ID && got_old_tuple) {
-            UpdateLogRecord log_record(txn_id, INVALID_LSN, rid, old_tuple,
-                                       tuple);
-            lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
-            page->SetLSN(lsn);
+            // 只改了少数几列时差异记录比完整的前后镜像小得多
+            UpdateDeltaLogRecord delta_record(txn_id, INVALID_LSN, rid,
+                                              old_tuple, tuple);
+            size_t full_size = old_tuple.GetSerializedSize() +
+                               tuple.GetSerializedSize() +
+                               sizeof(page_id_t) + sizeof(slot_offset_t);
+            if (delta_record.GetLogRecordSize() < full_size) {
+                LogPageModification(table_page, &delta_record);
+            } else {
+                UpdateLogRecord log_record(txn_id, INVALID_LSN, rid, old_tuple,
+                                           tuple);
+                LogPageModification(table_page, &log_record);
+            }
         } else {
             page->SetLSN(0);
         }
@@ -871,8 +1228,9 @@ bool TableHeap::UpdateTuple(const Tuple& tuple, const RID& rid,
  * @param txn_id 事务ID（当前未使用）
  * @return 读取成功返回true，失败返回false
  */
-bool TableHeap::GetTuple(const RID& rid, Tuple* tuple, txn_id_t txn_id) {
-    Page* page = buffer_pool_manager_->FetchPage(rid.page_id);
+bool TableHeap::GetTuple(const RID& rid, Tuple* tuple, txn_id_t txn_id,
+                         const ReadView* view) {
+    Page* page = FetchTablePage(rid.page_id);
     (void)txn_id;  // 当前版本未使用事务ID参数
 
     if (page == nullptr) {
@@ -883,19 +1241,417 @@ bool TableHeap::GetTuple(const RID& rid, Tuple* tuple, txn_id_t txn_id) {
     page->RLatch();
     auto* table_page = reinterpret_cast<TablePage*>(page);
     bool result = table_page->GetTuple(rid, tuple, schema_);
+    SnapshotVersion version;
+    if (GetSnapshotVersion(rid, view, &version)) {
+        result = version.exists;
+        if (result) {
+            TupleView(version.data.data(), version.data.size(), schema_, rid)
+                .ToTuple(tuple);
+        }
+    }
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(rid.page_id, false);  // 读操作不会修改页面
+    if (result) {
+        Statistics::RecordRowsExamined();
+    }
     return result;
 }
 
+/**
+ * 在页面固定期间读取一条tuple
+ * 实现思路：
+ * 1. 固定页面并加读锁，取得tuple视图
+ * 2. 调用reader，视图只在调用期间有效
+ * 3. reader抛出异常时同样释放读锁和页面，再把异常继续抛出
+ */
+bool TableHeap::ReadTuple(const RID& rid, const TupleReader& reader,
+                          const ReadView* view) {
+    Page* page = FetchTablePage(rid.page_id);
+    if (page == nullptr) {
+        return false;
+    }
+
+    page->RLatch();
+    bool found = false;
+    try {
+        TupleView tuple_view;
+        found = reinterpret_cast<TablePage*>(page)->GetTupleView(rid, schema_,
+                                                                 &tuple_view);
+        SnapshotVersion version;
+        if (GetSnapshotVersion(rid, view, &version)) {
+            found = version.exists;
+            tuple_view = TupleView(version.data.data(), version.data.size(),
+                                   schema_, rid);
+        }
+        if (found) {
+            Statistics::RecordRowsExamined();
+            reader(tuple_view);
+        }
+    } catch (...) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(rid.page_id, false);
+        throw;
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(rid.page_id, false);
+    return found;
+}
+
 /**
  * Iterator构造函数
  *
  * @param table_heap 所属的TableHeap指针
  * @param rid 当前迭代器指向的RID位置
+ * @param strategy 读取页面时使用的缓冲区访问策略
+ * @param read_ahead_pages 后台预读的页面数，0表示不预读
+ */
+/**
+ * 取出或者建立页面的区域摘要
+ * 实现思路：
+ * 1. 映射里已有摘要时直接返回
+ * 2. 否则加读锁读出页面上的所有tuple，连同下一页ID一起登记，
+ *    登记时仍持有读锁，插入和更新要等页面写锁，不会漏掉并发写入的值
+ */
+bool TableHeap::GetPageZone(page_id_t page_id, ZoneMap::PageZone* zone,
+                            BufferAccessStrategy* strategy) {
+    if (zone_map_.Get(page_id, zone)) {
+        return true;
+    }
+
+    Page* page = FetchTablePage(page_id, strategy);
+    if (page == nullptr) {
+        return false;
+    }
+    page->RLatch();
+    auto* table_page = reinterpret_cast<TablePage*>(page);
+    ZoneMap::PageZone built;
+    built.next_page_id = table_page->GetNextPageId();
+    RID rid{page_id, -1};
+    RID next_rid;
+    while (table_page->GetNextTupleRID(rid, &next_rid)) {
+        Tuple tuple;
+        if (table_page->GetTuple(next_rid, &tuple, schema_)) {
+            ZoneMap::Extend(&built, tuple);
+        }
+        rid = next_rid;
+    }
+    zone_map_.Set(page_id, built);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+
+    *zone = std::move(built);
+    return true;
+}
+
+size_t TableHeap::GetPageCount() {
+    EnsureFreeSpaceMap();
+    return page_directory_.GetPageCount();
+}
+
+size_t TableHeap::GetPageRange(size_t begin, size_t count,
+                               std::vector<page_id_t>* pages) {
+    EnsureFreeSpaceMap();
+    return page_directory_.GetPages(begin, count, pages);
+}
+
+/**
+ * 回收表里的空间
+ * 实现思路：
+ * 1. 沿链表逐页整理碎片，记下每个页面的有效字节数
+ * 2. 从表尾往前处理稀疏页面：先把页面移出空闲空间映射，记录不会搬回
+ *    自己；后面搬空的页面也已经移出映射，记录只会往留下的页面搬
+ * 3. 留下的页面按原顺序重新链接，链接改变的页面先写回磁盘再释放
+ *    搬空的页面，崩溃之后链表不会指向已经被复用的页面
+ * 4. 按留下的页面重建页面目录
  */
-TableHeap::Iterator::Iterator(TableHeap* table_heap, const RID& rid)
-    : table_heap_(table_heap), current_rid_(rid) {}
+TableHeap::VacuumStats TableHeap::Vacuum(txn_id_t txn_id,
+                                         const RelocateCallback& on_relocate) {
+    EnsureFreeSpaceMap();
+    std::lock_guard<std::mutex> guard(extend_latch_);
+    VacuumStats stats;
+
+    std::vector<page_id_t> pages;
+    std::vector<size_t> tuple_bytes;
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID) {
+        Page* page = FetchTablePage(page_id);
+        if (page == nullptr) {
+            LOG_WARN("TableHeap::Vacuum: cannot fetch page " << page_id);
+            return stats;
+        }
+        page->WLatch();
+        auto* table_page = reinterpret_cast<TablePage*>(page);
+        bool compacted = table_page->Compact();
+        if (compacted) {
+            stats.pages_compacted++;
+        }
+        pages.push_back(page_id);
+        tuple_bytes.push_back(table_page->GetTupleBytes());
+        free_space_map_.Update(page_id, table_page->GetFreeSpace());
+        page_id_t next_page_id = table_page->GetNextPageId();
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, compacted);
+        page_id = next_page_id;
+    }
+
+    const size_t sparse_bytes =
+        static_cast<size_t>(PAGE_SIZE * VACUUM_SPARSE_PAGE_RATIO);
+    std::vector<bool> emptied(pages.size(), false);
+    for (size_t i = pages.size(); i-- > 1;) {
+        if (tuple_bytes[i] > sparse_bytes ||
+            versions_->HasPageVersions(pages[i])) {
+            continue;
+        }
+        free_space_map_.Update(pages[i], 0);
+        emptied[i] =
+            MovePageTuples(pages[i], txn_id, on_relocate, &stats.tuples_moved);
+    }
+
+    std::vector<page_id_t> kept;
+    for (size_t i = 0; i < pages.size(); i++) {
+        if (!emptied[i]) {
+            kept.push_back(pages[i]);
+        }
+    }
+    if (kept.size() == pages.size()) {
+        return stats;
+    }
+
+    for (size_t i = 0; i < kept.size(); i++) {
+        page_id_t next_page_id =
+            i + 1 < kept.size() ? kept[i + 1] : INVALID_PAGE_ID;
+        Page* page = FetchTablePage(kept[i]);
+        if (page == nullptr) {
+            LOG_WARN("TableHeap::Vacuum: cannot relink page " << kept[i]);
+            return stats;
+        }
+        page->WLatch();
+        auto* table_page = reinterpret_cast<TablePage*>(page);
+        bool relinked = table_page->GetNextPageId() != next_page_id;
+        if (relinked) {
+            table_page->SetNextPageId(next_page_id);
+            zone_map_.SetNextPageId(kept[i], next_page_id);
+        }
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(kept[i], relinked);
+        if (relinked) {
+            buffer_pool_manager_->FlushPage(kept[i]);
+        }
+    }
+
+    for (size_t i = 0; i < pages.size(); i++) {
+        if (!emptied[i]) {
+            continue;
+        }
+        free_space_map_.Remove(pages[i]);
+        zone_map_.Remove(pages[i]);
+        buffer_pool_manager_->DeletePage(pages[i]);
+        stats.pages_freed++;
+    }
+    page_directory_.Clear();
+    for (page_id_t kept_page_id : kept) {
+        page_directory_.Append(kept_page_id);
+    }
+    last_page_id_ = kept.back();
+
+    LOG_DEBUG("TableHeap::Vacuum: compacted " << stats.pages_compacted
+                                              << " pages, moved "
+                                              << stats.tuples_moved
+                                              << " tuples, freed "
+                                              << stats.pages_freed
+                                              << " pages");
+    return stats;
+}
+
+/**
+ * 搬空一个页面
+ * 实现思路：持有页面写锁逐条取出记录，在映射找到的页面里插入（写INSERT
+ * 日志），再从原页面删除（写DELETE日志）；回调在释放页面锁之后统一调用
+ */
+bool TableHeap::MovePageTuples(page_id_t page_id, txn_id_t txn_id,
+                               const RelocateCallback& on_relocate,
+                               size_t* moved) {
+    Page* page = FetchTablePage(page_id);
+    if (page == nullptr) {
+        return false;
+    }
+    page->WLatch();
+    auto* table_page = reinterpret_cast<TablePage*>(page);
+    bool logging = log_manager_ &&
+                   txn_id != static_cast<txn_id_t>(INVALID_TXN_ID);
+
+    std::vector<std::pair<Tuple, std::pair<RID, RID>>> relocated;
+    bool emptied = true;
+    RID rid{page_id, -1};
+    RID next_rid;
+    while (table_page->GetNextTupleRID(rid, &next_rid)) {
+        rid = next_rid;
+        Tuple tuple;
+        if (!table_page->GetTuple(rid, &tuple, schema_)) {
+            emptied = false;
+            continue;
+        }
+        page_id_t target_page_id =
+            free_space_map_.FindPage(tuple.GetSerializedSize());
+        if (target_page_id == INVALID_PAGE_ID) {
+            emptied = false;
+            break;
+        }
+        Page* target = FetchTablePage(target_page_id);
+        if (target == nullptr) {
+            emptied = false;
+            break;
+        }
+        target->WLatch();
+        RID new_rid;
+        bool inserted = InsertIntoPage(reinterpret_cast<TablePage*>(target),
+                                       tuple, &new_rid, txn_id, nullptr);
+        target->WUnlatch();
+        buffer_pool_manager_->UnpinPage(target_page_id, inserted);
+        if (!inserted) {
+            emptied = false;
+            break;
+        }
+
+        table_page->DeleteTuple(rid);
+        if (logging) {
+            DeleteLogRecord log_record(txn_id, INVALID_LSN, rid, tuple);
+            LogPageModification(table_page, &log_record);
+        } else {
+            table_page->SetLSN(0);
+        }
+        relocated.push_back({std::move(tuple), {rid, new_rid}});
+    }
+    if (!emptied) {
+        table_page->Compact();
+        free_space_map_.Update(page_id, table_page->GetFreeSpace());
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, !relocated.empty());
+
+    *moved += relocated.size();
+    if (on_relocate) {
+        for (const auto& entry : relocated) {
+            on_relocate(entry.first, entry.second.first, entry.second.second);
+        }
+    }
+    return emptied;
+}
+
+/**
+ * 读取一个页面
+ * 实现思路：
+ * 1. 持有读锁期间取出页面上的旧版本（按slot排序），和页面内容是一致的
+ * 2. 按slot顺序合并：有旧版本的slot用旧版本（快照下不存在时跳过），
+ *    页面上已经删除但快照下还存在的记录也在这里补上
+ */
+bool TableHeap::ScanPage(page_id_t page_id, const TupleReader& reader,
+                         BufferAccessStrategy* strategy, const ReadView* view,
+                         page_id_t* next_page_id) {
+    Page* page = FetchTablePage(page_id, strategy);
+    if (page == nullptr) {
+        return false;
+    }
+    page->RLatch();
+    try {
+        auto* table_page = reinterpret_cast<TablePage*>(page);
+        std::vector<SnapshotVersion> versions;
+        if (view != nullptr && versions_->HasInvisibleVersions(*view)) {
+            versions_->GetPageVersions(page_id, *view, &versions);
+        }
+        size_t next_version = 0;
+        auto emit_versions_before = [&](slot_offset_t slot) {
+            while (next_version < versions.size() &&
+                   versions[next_version].rid.slot_num < slot) {
+                const SnapshotVersion& version = versions[next_version++];
+                if (version.exists) {
+                    Statistics::RecordRowsExamined();
+                    reader(TupleView(version.data.data(), version.data.size(),
+                                     schema_, version.rid));
+                }
+            }
+        };
+
+        RID rid{page_id, -1};
+        RID next_rid;
+        while (table_page->GetNextTupleRID(rid, &next_rid)) {
+            rid = next_rid;
+            emit_versions_before(next_rid.slot_num);
+            if (next_version < versions.size() &&
+                versions[next_version].rid.slot_num == next_rid.slot_num) {
+                emit_versions_before(next_rid.slot_num + 1);
+                continue;
+            }
+            TupleView tuple_view;
+            if (table_page->GetTupleView(next_rid, schema_, &tuple_view)) {
+                Statistics::RecordRowsExamined();
+                reader(tuple_view);
+            }
+        }
+        emit_versions_before(std::numeric_limits<slot_offset_t>::max());
+        if (next_page_id != nullptr) {
+            *next_page_id = table_page->GetNextPageId();
+        }
+    } catch (...) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        throw;
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return true;
+}
+
+void TableHeap::GetSnapshotChanges(const ReadView& view,
+                                   std::unordered_set<RID>* changed,
+                                   std::vector<Tuple>* visible) {
+    std::vector<SnapshotVersion> versions;
+    versions_->GetAllVersions(view, &versions);
+    for (const auto& version : versions) {
+        changed->insert(version.rid);
+        if (version.exists) {
+            visible->push_back(TupleView(version.data.data(),
+                                         version.data.size(), schema_,
+                                         version.rid)
+                                   .ToTuple());
+        }
+    }
+}
+
+bool TableHeap::HasWriteConflict(const RID& rid, Transaction* txn) const {
+    if (txn == nullptr || !txn->HasSnapshot()) {
+        return false;
+    }
+    bool check_snapshot =
+        txn->GetIsolationLevel() >= IsolationLevel::REPEATABLE_READ;
+    return versions_->HasWriteConflict(rid, txn->GetSnapshot(),
+                                       check_snapshot);
+}
+
+void TableHeap::RecordVersion(Transaction* txn, const RID& rid, bool existed,
+                              const char* before, size_t size) {
+    if (txn == nullptr || !txn->HasSnapshot()) {
+        return;
+    }
+    versions_->AddVersion(rid, txn->GetVersionWriter(), existed, before, size);
+    txn->AddVersionStore(versions_);
+}
+
+bool TableHeap::GetSnapshotVersion(const RID& rid, const ReadView* view,
+                                   SnapshotVersion* version) const {
+    if (view == nullptr || !versions_->HasInvisibleVersions(*view)) {
+        return false;
+    }
+    return versions_->GetVisibleVersion(rid, *view, version);
+}
+
+TableHeap::Iterator::Iterator(TableHeap* table_heap, const RID& rid,
+                              std::shared_ptr<BufferAccessStrategy> strategy,
+                              size_t read_ahead_pages)
+    : table_heap_(table_heap),
+      current_rid_(rid),
+      strategy_(std::move(strategy)),
+      read_ahead_pages_(read_ahead_pages) {}
 
 /**
  * 判断迭代器是否到达末尾
@@ -925,8 +1681,8 @@ void TableHeap::Iterator::operator++() {
     LOG_DEBUG("TableHeap::Iterator::operator++: current RID page="
               << current_rid_.page_id << " slot=" << current_rid_.slot_num);
 
-    Page* page =
-        table_heap_->buffer_pool_manager_->FetchPage(current_rid_.page_id);
+    Page* page = table_heap_->FetchTablePage(current_rid_.page_id,
+                                              strategy_.get());
     if (page == nullptr) {
         LOG_ERROR("TableHeap::Iterator: Cannot fetch current page "
                   << current_rid_.page_id);
@@ -968,6 +1724,9 @@ void TableHeap::Iterator::operator++() {
     page->RUnlatch();
     table_heap_->buffer_pool_manager_->UnpinPage(current_page_id, false);
 
+    // 不满足过滤条件的页面只看摘要，直接跳过
+    next_page_id = NextUnfilteredPage(next_page_id);
+
     // 检查下一个页面ID是否有效
     if (next_page_id == INVALID_PAGE_ID) {
         LOG_DEBUG("TableHeap::Iterator: reached end of table");
@@ -986,7 +1745,7 @@ void TableHeap::Iterator::operator++() {
         return;
     }
 
-    page = table_heap_->buffer_pool_manager_->FetchPage(next_page_id);
+    page = table_heap_->FetchTablePage(next_page_id, strategy_.get());
     if (page == nullptr) {
         LOG_ERROR("TableHeap::Iterator: Cannot fetch next page "
                   << next_page_id << " (total pages: " << total_pages << ")");
@@ -1007,6 +1766,20 @@ void TableHeap::Iterator::operator++() {
         return;
     }
 
+    // 进入了新页面，通知预读器；第一次跨页时才启动预读线程
+    if (read_ahead_pages_ > 0) {
+        if (read_ahead_ == nullptr) {
+            page_id_t ahead_page_id = table_page->GetNextPageId();
+            if (ahead_page_id != INVALID_PAGE_ID) {
+                read_ahead_ = std::make_shared<TableReadAhead>(
+                    table_heap_->buffer_pool_manager_, strategy_,
+                    ahead_page_id, read_ahead_pages_);
+            }
+        } else {
+            read_ahead_->OnPageVisited(next_page_id);
+        }
+    }
+
     RID first_rid{next_page_id, -1};
     if (table_page->GetNextTupleRID(first_rid, &next_rid)) {
         LOG_DEBUG("TableHeap::Iterator: found first tuple in next page: "
@@ -1028,6 +1801,37 @@ void TableHeap::Iterator::operator++() {
     operator++();
 }
 
+/**
+ * 沿链表跳过不满足过滤条件的页面
+ * 摘要取不到时不跳过，交给正常的读取流程处理
+ */
+page_id_t TableHeap::Iterator::NextUnfilteredPage(page_id_t next_page_id) {
+    if (!page_filter_) {
+        return next_page_id;
+    }
+    ZoneMap::PageZone zone;
+    while (next_page_id != INVALID_PAGE_ID &&
+           table_heap_->GetPageZone(next_page_id, &zone, strategy_.get()) &&
+           !page_filter_(zone)) {
+        skipped_pages_++;
+        next_page_id = zone.next_page_id;
+    }
+    return next_page_id;
+}
+
+/**
+ * 跳过当前页面
+ * 把位置移到页面最后一个slot之后，再前进一次就进入下一个页面
+ */
+void TableHeap::Iterator::SkipPage() {
+    if (IsEnd()) {
+        return;
+    }
+    skipped_pages_++;
+    current_rid_.slot_num = static_cast<slot_offset_t>(MAX_SLOTS_PER_PAGE);
+    operator++();
+}
+
 /**
  * 迭代器解引用操作（*运算符重载）
  *
@@ -1035,10 +1839,18 @@ void TableHeap::Iterator::operator++() {
  */
 Tuple TableHeap::Iterator::operator*() {
     Tuple tuple;
-    table_heap_->GetTuple(current_rid_, &tuple, INVALID_TXN_ID);
+    ReadCurrent(&tuple);
     return tuple;
 }
 
+bool TableHeap::Iterator::ReadCurrent(Tuple* tuple) {
+    return table_heap_->GetTuple(current_rid_, tuple, INVALID_TXN_ID);
+}
+
+bool TableHeap::Iterator::ReadCurrent(const TupleReader& reader) {
+    return table_heap_->ReadTuple(current_rid_, reader);
+}
+
 /**
  * 获取指向表开始位置的迭代器
  *
@@ -1049,7 +1861,17 @@ Tuple TableHeap::Iterator::operator*() {
  *
  * @return 指向第一个有效tuple的迭代器
  */
-TableHeap::Iterator TableHeap::Begin() {
+TableHeap::Iterator TableHeap::Begin() { return Begin(nullptr); }
+
+/**
+ * 获取使用指定访问策略的迭代器
+ *
+ * 和Begin()一样，读取的页面都通过strategy进入缓冲池，
+ * 返回的迭代器继续持有strategy，read_ahead_pages大于0时开启后台预读
+ */
+TableHeap::Iterator TableHeap::Begin(
+    std::shared_ptr<BufferAccessStrategy> strategy, size_t read_ahead_pages,
+    PageFilter page_filter) {
     LOG_DEBUG(
         "TableHeap::Begin: starting with first_page_id=" << first_page_id_);
 
@@ -1067,7 +1889,7 @@ TableHeap::Iterator TableHeap::Begin() {
         return Iterator(this, RID{INVALID_PAGE_ID, -1});
     }
 
-    Page* first_page = buffer_pool_manager_->FetchPage(first_page_id_);
+    Page* first_page = FetchTablePage(first_page_id_, strategy.get());
     if (first_page == nullptr) {
         LOG_ERROR("TableHeap::Begin: Cannot fetch first page "
                   << first_page_id_);
@@ -1088,7 +1910,7 @@ TableHeap::Iterator TableHeap::Begin() {
 
     // 验证页面头部
     auto* header = table_page->GetHeader();
-    if (header->num_tuples < 0 || header->num_tuples > 10000) {
+    if (header->num_tuples < 0 || header->num_tuples > MAX_SLOTS_PER_PAGE) {
         LOG_ERROR("TableHeap::Begin: Invalid num_tuples " << header->num_tuples
                                                           << " in first page");
         first_page->RUnlatch();
@@ -1107,7 +1929,18 @@ TableHeap::Iterator TableHeap::Begin() {
         LOG_DEBUG("TableHeap::Begin: found first tuple at "
                   << first_valid_rid.page_id << ":"
                   << first_valid_rid.slot_num);
-        return Iterator(this, first_valid_rid);
+        Iterator it(this, first_valid_rid, std::move(strategy),
+                    read_ahead_pages);
+        if (page_filter) {
+            ZoneMap::PageZone zone;
+            bool skip_first = GetPageZone(first_page_id_, &zone) &&
+                              !page_filter(zone);
+            it.SetPageFilter(std::move(page_filter));
+            if (skip_first) {
+                it.SkipPage();
+            }
+        }
+        return it;
     } else {
         LOG_DEBUG("TableHeap::Begin: no tuples found in first page");
         return Iterator(this, RID{INVALID_PAGE_ID, -1});
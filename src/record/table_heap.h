@@ -9,15 +9,28 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "record/free_space_map.h"
+#include "record/page_directory.h"
 #include "record/tuple.h"
+#include "record/tuple_view.h"
+#include "record/zone_map.h"
 #include "recovery/log_manager.h"
+#include "transaction/version_store.h"
 
 namespace SimpleRDBMS {
 
+class TableReadAhead;
+class Transaction;
+
 /**
  * TablePage类 - 表页面的实现
  *
@@ -65,6 +78,24 @@ class TablePage : public Page {
      */
     bool UpdateTuple(const Tuple& tuple, const RID& rid);
 
+    /**
+     * 用序列化好的字节更新tuple，恢复和副本重放日志时使用
+     * 空间的安排和UpdateTuple相同，RID不变
+     */
+    bool UpdateTupleData(const RID& rid, const char* data, size_t size);
+
+    /**
+     * 把序列化好的tuple放进指定的slot，恢复和副本重放日志时使用
+     * slot超出现有的slot数时中间补空slot；slot已经有tuple或者空间不够时返回false
+     */
+    bool InsertTupleAt(slot_offset_t slot_num, const char* data, size_t size);
+
+    /**
+     * 取得slot里tuple的序列化字节，指针引用页面内存
+     * @return slot有效返回true，RID无效或已删除返回false
+     */
+    bool GetTupleData(const RID& rid, const char** data, size_t* size);
+
     /**
      * 从页面中读取指定的tuple
      *
@@ -75,6 +106,17 @@ class TablePage : public Page {
      */
     bool GetTuple(const RID& rid, Tuple* tuple, const Schema* schema);
 
+    /**
+     * 取得指向页面上tuple数据的视图，不反序列化
+     * 视图引用页面内存，调用者需要在使用期间保持页面固定并持有读锁
+     *
+     * @param rid 要读取的tuple的RID
+     * @param schema 表的schema信息，用于按列解码
+     * @param view 输出参数，引用tuple数据的视图
+     * @return slot有效返回true，RID无效或已删除返回false
+     */
+    bool GetTupleView(const RID& rid, const Schema* schema, TupleView* view);
+
     /**
      * 获取当前RID之后的下一个有效tuple的RID
      * 用于实现迭代器的顺序遍历功能
@@ -99,6 +141,42 @@ class TablePage : public Page {
      */
     void SetNextPageId(page_id_t next_page_id);
 
+    /**
+     * 获取页面头中持久化的LSN
+     *
+     * @return 最后一次修改本页面的日志记录LSN，没有记录过时为INVALID_LSN
+     */
+    lsn_t GetPageLSN() const;
+
+    /**
+     * 记录修改本页面的日志LSN
+     * 同时写入页面头（随页面落盘，恢复时用来判断是否需要redo）和内存中的LSN
+     *
+     * @param lsn 日志记录的LSN
+     */
+    void SetPageLSN(lsn_t lsn);
+
+    /**
+     * 获取页面还能放下的最大tuple字节数（已经扣除新slot占用的空间）
+     * 删除和更新留下的空洞也算在内，插入时不够连续空间会先整理页面
+     *
+     * @return 空闲字节数，页面已满时为0
+     */
+    size_t GetFreeSpace() const;
+
+    /**
+     * 获取页面上有效tuple占用的字节数
+     */
+    size_t GetTupleBytes() const;
+
+    /**
+     * 整理页面碎片：把有效tuple紧凑地排到页面末尾，空洞合并进空闲区
+     * slot编号不变，RID保持稳定；调用者持有页面写锁
+     *
+     * @return 整理前确实有空洞时返回true
+     */
+    bool Compact();
+
     /**
      * 表页面头结构
      * 存储页面的元数据信息，位于页面的开始位置
@@ -108,8 +186,13 @@ class TablePage : public Page {
         lsn_t lsn;                   // 日志序列号，用于WAL恢复
         uint16_t num_tuples;         // 当前页面中的tuple数量
         uint16_t free_space_offset;  // 空闲空间的起始偏移量
+        uint32_t checksum;           // 整个页面的CRC32C，写盘时填写
     };
 
+    /** 校验值字段在页面里的偏移，放在页面头最后，前面的字段位置不变 */
+    static constexpr size_t CHECKSUM_OFFSET =
+        sizeof(page_id_t) + sizeof(lsn_t) + 2 * sizeof(uint16_t);
+
     /**
      * 获取页面头指针（只读版本）
      *
@@ -124,6 +207,15 @@ class TablePage : public Page {
      */
     TablePageHeader* GetHeader();
 
+    /**
+     * 核对页面从磁盘读入后的校验值，核对过的页面只是一次原子读
+     * @throws StorageException 校验值不对，页面已经损坏
+     */
+    void CheckChecksum() const;
+
+   private:
+    /** 为更新安排空间，返回写入新tuple的位置，放不下时返回nullptr */
+    char* PrepareUpdate(const RID& rid, size_t new_tuple_size);
 };
 
 /**
@@ -170,25 +262,58 @@ class TableHeap {
      * 插入新的tuple到表中
      *
      * 实现思路：
-     * - 从当前页面开始查找有足够空间的页面
-     * - 如果所有页面都满了，分配新页面
+     * - 通过空闲空间映射直接找到有足够空间的页面，不遍历页面链表
+     * - 如果没有页面放得下，在表末尾分配新页面
      * - 记录INSERT操作到WAL日志
      *
      * @param tuple 要插入的tuple
      * @param rid 输出参数，返回插入位置的RID
      * @param txn_id 事务ID，用于日志记录
+     * @param txn 写事务，有快照时在页面写锁内记下撤销记录，可以为空
      * @return 插入成功返回true，失败返回false
      */
-    bool InsertTuple(const Tuple& tuple, RID* rid, txn_id_t txn_id);
+    bool InsertTuple(const Tuple& tuple, RID* rid, txn_id_t txn_id,
+                     Transaction* txn = nullptr);
+
+    /**
+     * 批量插入多个tuple
+     *
+     * 实现思路：
+     * - 每取得一个页面就持有它，把后续tuple一直插到页面放不下为止
+     * - 一个页面上的一批tuple只写一条MULTI_INSERT日志，只更新一次页面LSN
+     * - 表末尾的页面写满后，持有扩展锁连续申请新页面
+     *
+     * @param tuples 要插入的tuple，按顺序插入
+     * @param rids 输出参数，依次返回插入成功的tuple的RID
+     * @param txn_id 事务ID，用于日志记录
+     * @param txn 写事务，有快照时记下撤销记录，可以为空
+     * @return 全部插入成功返回true；失败时rids中是之前已经插入的tuple
+     */
+    bool InsertTuples(const std::vector<Tuple>& tuples, std::vector<RID>* rids,
+                      txn_id_t txn_id, Transaction* txn = nullptr);
+
+    /**
+     * 把一批tuple追加到表的末尾，供批量装载使用
+     *
+     * 和InsertTuples的区别是不查空闲空间映射、不回头填前面页面的空隙，
+     * 直接在扩展锁下写满末尾页面再连续申请新页面，
+     * 装载的记录在页面上连续存放，日志同样是每个页面一条MULTI_INSERT
+     *
+     * @return 全部插入成功返回true；失败时rids中是之前已经插入的tuple
+     */
+    bool AppendTuples(const std::vector<Tuple>& tuples, std::vector<RID>* rids,
+                      txn_id_t txn_id, Transaction* txn = nullptr);
 
     /**
      * 删除指定RID的tuple
      *
      * @param rid 要删除的tuple的RID
      * @param txn_id 事务ID，用于日志记录
-     * @return 删除成功返回true，失败返回false
+     * @param txn 写事务，有快照时先检查写冲突再记下撤销记录，可以为空
+     * @return 删除成功返回true，失败（包括写冲突）返回false
      */
-    bool DeleteTuple(const RID& rid, txn_id_t txn_id);
+    bool DeleteTuple(const RID& rid, txn_id_t txn_id,
+                     Transaction* txn = nullptr);
 
     /**
      * 更新指定RID的tuple内容
@@ -196,9 +321,11 @@ class TableHeap {
      * @param tuple 新的tuple内容
      * @param rid 要更新的tuple的RID
      * @param txn_id 事务ID，用于日志记录
-     * @return 更新成功返回true，失败返回false
+     * @param txn 写事务，有快照时先检查写冲突再记下撤销记录，可以为空
+     * @return 更新成功返回true，失败（包括写冲突）返回false
      */
-    bool UpdateTuple(const Tuple& tuple, const RID& rid, txn_id_t txn_id);
+    bool UpdateTuple(const Tuple& tuple, const RID& rid, txn_id_t txn_id,
+                     Transaction* txn = nullptr);
 
     /**
      * 读取指定RID的tuple内容
@@ -206,9 +333,28 @@ class TableHeap {
      * @param rid 要读取的tuple的RID
      * @param tuple 输出参数，存储读取的tuple内容
      * @param txn_id 事务ID（当前版本未使用）
-     * @return 读取成功返回true，失败返回false
+     * @param view 快照，不为空时读快照下的版本
+     * @return 读取成功返回true，失败（包括快照下不存在）返回false
+     */
+    bool GetTuple(const RID& rid, Tuple* tuple, txn_id_t txn_id,
+                  const ReadView* view = nullptr);
+
+    /**
+     * 读取tuple的回调，参数是引用页面数据的视图，只在回调期间有效
+     */
+    using TupleReader = std::function<void(const TupleView&)>;
+
+    /**
+     * 在页面固定并持有读锁期间用视图读取tuple
+     * 只需要其中几列时按列解码，不用反序列化整行
+     *
+     * @param rid 要读取的tuple的RID
+     * @param reader 读取回调，tuple不存在时不会被调用
+     * @param view 快照，不为空时读快照下的版本
+     * @return tuple存在返回true
      */
-    bool GetTuple(const RID& rid, Tuple* tuple, txn_id_t txn_id);
+    bool ReadTuple(const RID& rid, const TupleReader& reader,
+                   const ReadView* view = nullptr);
 
     /**
      * 获取第一个页面的ID
@@ -226,6 +372,151 @@ class TableHeap {
      */
     void SetLogManager(LogManager* log_manager) { log_manager_ = log_manager; }
 
+    /**
+     * 顺序扫描用来判断页面是否需要读取的过滤函数
+     * 参数是页面的区域摘要，返回false表示页面上不可能有满足条件的记录
+     */
+    using PageFilter = std::function<bool(const ZoneMap::PageZone&)>;
+
+    /**
+     * 取出页面的区域摘要，没有时读一遍页面建立
+     *
+     * @param page_id 页面ID
+     * @param zone 输出参数，页面的摘要
+     * @param strategy 建立摘要时读取页面使用的访问策略，可以为空
+     * @return 页面读取失败返回false
+     */
+    bool GetPageZone(page_id_t page_id, ZoneMap::PageZone* zone,
+                     BufferAccessStrategy* strategy = nullptr);
+
+    /**
+     * 取出已经建立的区域摘要，没有时返回false，不读页面
+     */
+    bool GetCachedPageZone(page_id_t page_id, ZoneMap::PageZone* zone) const {
+        return zone_map_.Get(page_id, zone);
+    }
+
+    /**
+     * 表的页面数，从页面目录直接得到
+     * 打开已有的表后第一次调用会沿链表建立目录和空闲空间映射
+     */
+    size_t GetPageCount();
+
+    /**
+     * 按链表顺序取出第begin个页面开始的最多count个页面，不读页面
+     * 并行扫描据此把表切成页面区间
+     *
+     * @param pages 输出参数，页面ID
+     * @return 取出的页面数，begin超出表的页面数时为0
+     */
+    size_t GetPageRange(size_t begin, size_t count,
+                        std::vector<page_id_t>* pages);
+
+    /**
+     * 读取一个页面上所有有效的tuple，供并行扫描的工作线程使用
+     * 页面固定并持有读锁期间按slot顺序用视图调用reader；
+     * 有快照时同样在读锁内取出页面上的旧版本，用它们代替表堆里的内容
+     *
+     * @param page_id 页面ID
+     * @param reader 读取回调，视图只在回调期间有效
+     * @param strategy 读取页面使用的访问策略，可以为空
+     * @param view 快照，不为空时读快照下的版本
+     * @param next_page_id 输出参数，链表上的下一个页面，可以为空
+     * @return 页面读取失败返回false
+     */
+    bool ScanPage(page_id_t page_id, const TupleReader& reader,
+                  BufferAccessStrategy* strategy = nullptr,
+                  const ReadView* view = nullptr,
+                  page_id_t* next_page_id = nullptr);
+
+    /** 表堆的撤销链 */
+    VersionStore* GetVersionStore() const { return versions_.get(); }
+
+    /**
+     * 是否可能有对快照不可见的修改
+     * 返回false时表堆里的内容就是快照看到的内容
+     */
+    bool HasInvisibleVersions(const ReadView& view) const {
+        return versions_->HasInvisibleVersions(view);
+    }
+
+    /**
+     * 取出快照下和表堆当前内容不同的所有记录，供索引扫描补齐结果
+     *
+     * @param view 快照
+     * @param changed 输出参数，这些记录的RID，索引查到它们时不能直接用
+     * @param visible 输出参数，其中快照下存在的记录的版本，设置了RID
+     */
+    void GetSnapshotChanges(const ReadView& view,
+                            std::unordered_set<RID>* changed,
+                            std::vector<Tuple>* visible);
+
+    /**
+     * 修改一条记录是否会和别的事务冲突
+     * 最新的修改属于别的未提交事务时冲突；REPEATABLE_READ及以上的事务
+     * 遇到快照之后提交的修改也冲突（先更新者胜）
+     */
+    bool HasWriteConflict(const RID& rid, Transaction* txn) const;
+
+    /**
+     * 归还表的区段里还没分配的页面
+     * 删除表时调用，之后表不应再扩展
+     */
+    void ReleaseExtent() {
+        buffer_pool_manager_->GetDiskManager()->ReleaseExtent(&extent_);
+    }
+
+    /**
+     * 设置表的页面写盘时使用的压缩算法
+     * 登记第一个页面，之后从区段分配的页面也都登记上
+     */
+    void SetPageCompression(PageCompression compression) {
+        extent_.compression = compression;
+        buffer_pool_manager_->GetDiskManager()->SetPageCompression(
+            first_page_id_, compression);
+    }
+
+    /** VACUUM的结果 */
+    struct VacuumStats {
+        size_t pages_compacted = 0;  // 整理过碎片的页面数
+        size_t tuples_moved = 0;     // 从稀疏页面搬走的记录数
+        size_t pages_freed = 0;      // 从链表摘下并归还磁盘管理器的页面数
+    };
+
+    /** 记录被VACUUM搬到新位置后调用，索引据此改为指向新的RID */
+    using RelocateCallback = std::function<void(
+        const Tuple& tuple, const RID& old_rid, const RID& new_rid)>;
+
+    /**
+     * 回收删除和更新留下的空间
+     * 1. 整理每个页面的碎片
+     * 2. 从表尾往前，把稀疏页面上的记录搬到其他有空间的页面
+     * 3. 搬空的页面从链表上摘下，归还给DiskManager::DeallocatePage
+     *
+     * 调用者保证期间没有别的事务读写这张表（VACUUM语句持有表的X锁）；
+     * 还有撤销链的页面上的记录可能被旧快照读到，不搬动。第一个页面
+     * 由catalog记录，永远不释放
+     *
+     * @param txn_id 记录搬动时写INSERT/DELETE日志用的事务ID
+     * @param on_relocate 每搬动一条记录调用一次，可以为空
+     */
+    VacuumStats Vacuum(txn_id_t txn_id, const RelocateCallback& on_relocate);
+
+    /**
+     * 页面已经被重放日志接到链表末尾页面之后，更新页面目录、区域摘要和
+     * 末尾页面，副本重放NEW_PAGE记录后调用
+     *
+     * @param last_page_id 新页面之前的页面
+     * @param new_page_id 新页面，页面本身已经初始化并链接好
+     */
+    void OnPageAppended(page_id_t last_page_id, page_id_t new_page_id);
+
+    /**
+     * 丢弃页面的区域摘要，下次使用时重新读页面建立
+     * 重放日志直接改了页面上的记录时调用
+     */
+    void InvalidatePageZone(page_id_t page_id) { zone_map_.Remove(page_id); }
+
     /**
      * Iterator类 - 表的顺序扫描迭代器
      *
@@ -239,8 +530,12 @@ class TableHeap {
          *
          * @param table_heap 所属的TableHeap指针
          * @param rid 初始RID位置
+         * @param strategy 读取页面时使用的缓冲区访问策略，可以为空
+         * @param read_ahead_pages 后台预读的页面数，0表示不预读
          */
-        Iterator(TableHeap* table_heap, const RID& rid);
+        Iterator(TableHeap* table_heap, const RID& rid,
+                 std::shared_ptr<BufferAccessStrategy> strategy = nullptr,
+                 size_t read_ahead_pages = 0);
 
         /**
          * 默认构造函数
@@ -269,9 +564,54 @@ class TableHeap {
          */
         Tuple operator*();
 
+        /**
+         * 用视图读取当前位置的tuple，不反序列化整行
+         *
+         * @param reader 读取回调，视图只在回调期间有效
+         * @return 当前位置的tuple存在返回true
+         */
+        bool ReadCurrent(const TupleReader& reader);
+
+        /**
+         * 把当前位置的tuple读进已有的tuple，复用它的列值存储
+         *
+         * @return 当前位置的tuple存在返回true，读不到时tuple的内容不确定
+         */
+        bool ReadCurrent(Tuple* tuple);
+
+        /**
+         * 设置页面过滤函数
+         * 之后进入新页面之前先检查它的区域摘要，
+         * 不满足条件的页面连同其中的记录一起跳过，不读取页面
+         */
+        void SetPageFilter(PageFilter filter) {
+            page_filter_ = std::move(filter);
+        }
+
+        /** 跳过当前页面剩下的记录，移到下一个通过过滤的页面 */
+        void SkipPage();
+
+        /** 当前位置的RID */
+        const RID& GetRID() const { return current_rid_; }
+
+        /** 因为过滤函数而跳过的页面数 */
+        size_t GetSkippedPages() const { return skipped_pages_; }
+
        private:
+        /**
+         * 从next_page_id开始沿链表找第一个通过过滤的页面
+         * 跳过的页面只读区域摘要，不读页面本身
+         */
+        page_id_t NextUnfilteredPage(page_id_t next_page_id);
+
         TableHeap* table_heap_;  // 所属的TableHeap指针
         RID current_rid_;        // 当前迭代器位置
+        std::shared_ptr<BufferAccessStrategy> strategy_;  // 页面访问策略
+        size_t read_ahead_pages_ = 0;                     // 预读窗口大小
+        // 扫描跨过第一个页面之后才创建，迭代器的拷贝共享同一个预读器
+        std::shared_ptr<TableReadAhead> read_ahead_;
+        PageFilter page_filter_;    // 页面过滤函数，为空时不过滤
+        size_t skipped_pages_ = 0;  // 跳过的页面数
     };
 
     /**
@@ -281,6 +621,19 @@ class TableHeap {
      */
     Iterator Begin();
 
+    /**
+     * 获取使用指定访问策略的迭代器
+     *
+     * @param strategy 缓冲区访问策略，全表扫描一般传批量读取策略，
+     *                 避免把缓冲池中的热点页面挤出去
+     * @param read_ahead_pages 后台预读的页面数，0表示不预读
+     * @param page_filter 页面过滤函数，为空时读取所有页面
+     * @return 指向第一个有效tuple的迭代器
+     */
+    Iterator Begin(std::shared_ptr<BufferAccessStrategy> strategy,
+                   size_t read_ahead_pages = 0,
+                   PageFilter page_filter = nullptr);
+
     /**
      * 获取指向表结束位置的迭代器
      *
@@ -289,10 +642,131 @@ class TableHeap {
     Iterator End();
 
    private:
+    /**
+     * 取得表页面并核对校验值
+     * @param strategy 访问策略，可以为nullptr
+     * @return 页面不在缓冲池也读不进来时返回nullptr
+     * @throws StorageException 校验值不对，这时页面已经unpin
+     */
+    Page* FetchTablePage(page_id_t page_id,
+                         BufferAccessStrategy* strategy = nullptr);
+
+    /**
+     * 为页面上的一次修改写WAL日志并更新页面LSN
+     * 页面写回后的第一次修改会在追加日志之前记下recLSN（当前日志末尾），
+     * 这样模糊检查点要么在脏页表里看到这个页面，要么从检查点开始的
+     * 分析扫描一定能看到这条记录
+     *
+     * @param table_page 被修改的页面，调用者持有写锁
+     * @param log_record 要追加的日志记录
+     */
+    void LogPageModification(TablePage* table_page, LogRecord* log_record);
+
+    /**
+     * 第一次插入或者访问页面目录时沿页面链表扫描一遍，
+     * 建立空闲空间映射和页面目录，并记下最后一个页面
+     * 新建的表堆在构造时就建好了，不需要扫描
+     */
+    void EnsureFreeSpaceMap();
+
+    /**
+     * 尝试把tuple插入到页面中，成功时写INSERT日志，
+     * 无论成功与否都用页面的实际空闲空间更新映射
+     *
+     * @param table_page 目标页面，调用者持有写锁
+     * @return 插入成功返回true
+     */
+    bool InsertIntoPage(TablePage* table_page, const Tuple& tuple, RID* rid,
+                        txn_id_t txn_id, Transaction* txn);
+
+    /**
+     * 在表的末尾插入，末尾页面放不下时申请新页面接到链表上
+     * 持有extend_latch_，同一时刻只有一个线程扩展表
+     */
+    bool InsertAtEnd(const Tuple& tuple, RID* rid, txn_id_t txn_id,
+                     Transaction* txn);
+
+    /**
+     * 把tuples[*next]开始的tuple依次插入页面，直到页面放不下或者全部插完
+     * 每批写一条MULTI_INSERT日志（只有一个tuple时写INSERT日志），
+     * 一条日志放不下时在同一页面上开始下一批
+     *
+     * @param table_page 目标页面，调用者持有写锁
+     * @param next 输入输出参数，下一个要插入的tuple下标
+     * @return 插入到这个页面的tuple数
+     */
+    size_t FillPage(TablePage* table_page, const std::vector<Tuple>& tuples,
+                    size_t* next, std::vector<RID>* rids, txn_id_t txn_id,
+                    Transaction* txn);
+
+    /**
+     * 批量插入的表末尾部分：先填满末尾页面，再连续扩展表
+     * 持有extend_latch_
+     */
+    bool FillPagesAtEnd(const std::vector<Tuple>& tuples, size_t* next,
+                        std::vector<RID>* rids, txn_id_t txn_id,
+                        Transaction* txn);
+
+    /**
+     * 写事务有快照时记下一条撤销记录，调用者持有页面写锁
+     *
+     * @param existed 修改前记录是否存在，插入时为false
+     * @param before 修改前的记录字节
+     */
+    void RecordVersion(Transaction* txn, const RID& rid, bool existed,
+                       const char* before, size_t size);
+
+    /**
+     * 在快照下读取页面上的一条记录，调用者持有页面读锁
+     * @param version 输出参数，快照下的版本和页面不同时填入
+     * @return 快照下的版本和页面不同时返回true
+     */
+    bool GetSnapshotVersion(const RID& rid, const ReadView* view,
+                            SnapshotVersion* version) const;
+
+    /**
+     * 把页面上的记录全部搬到空闲空间映射里找到的其他页面
+     * 调用者持有extend_latch_，并且已经把页面移出了映射
+     *
+     * @param moved 输出参数，搬动的记录数累加到这里
+     * @return 页面被搬空时返回true，其他页面放不下时留下剩余的记录
+     */
+    bool MovePageTuples(page_id_t page_id, txn_id_t txn_id,
+                        const RelocateCallback& on_relocate, size_t* moved);
+
+    /**
+     * 取得表末尾的页面并加写锁，调用者持有extend_latch_
+     * 记下的末尾页面过时时沿链表找到真正的末尾
+     *
+     * @param page_id 输出参数，末尾页面ID
+     * @return 末尾页面，读取失败返回nullptr
+     */
+    Page* FetchLastPage(page_id_t* page_id);
+
+    /**
+     * 申请新页面接在末尾页面之后，调用者持有extend_latch_
+     * 原末尾页面会被解锁并unpin
+     *
+     * @param last_page 当前末尾页面，调用者持有写锁
+     * @param page_id 输入末尾页面ID，输出新页面ID
+     * @return 加了写锁的新页面，申请失败返回nullptr
+     */
+    Page* ExtendTable(Page* last_page, page_id_t* page_id);
+
     BufferPoolManager* buffer_pool_manager_;  // 缓冲池管理器，负责页面的读写
     const Schema* schema_;               // 表的schema定义，用于tuple的序列化
     page_id_t first_page_id_;            // 第一个页面的ID，页面链表的头部
     LogManager* log_manager_ = nullptr;  // 日志管理器，用于WAL记录和恢复
+
+    FreeSpaceMap free_space_map_;             // 各页面的空闲空间类别
+    ZoneMap zone_map_;                        // 各页面上列值的范围摘要
+    PageDirectory page_directory_;            // 按链表顺序的所有页面
+    ExtentReservation extent_;  // 表扩展时新页面从这个区段里连续分配
+    // 撤销链，提交的事务通过弱引用通知它，表删除之后引用自动失效
+    std::shared_ptr<VersionStore> versions_ = std::make_shared<VersionStore>();
+    std::atomic<bool> free_space_map_built_{false};
+    std::mutex extend_latch_;                 // 保护映射的建立和表的扩展
+    page_id_t last_page_id_ = INVALID_PAGE_ID;  // 链表末尾页面，受extend_latch_保护
 };
 
 }  // namespace SimpleRDBMS
\ No newline at end of file
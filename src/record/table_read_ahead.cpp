@@ -0,0 +1,140 @@
+/*
+ * 文件: table_read_ahead.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 表堆顺序扫描异步预读器实现
+ */
+
+#include "record/table_read_ahead.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/debug.h"
+#include "record/table_heap.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * 构造函数
+ * distance至少为1，构造完成后后台线程立即从start_page_id开始预读
+ */
+TableReadAhead::TableReadAhead(BufferPoolManager* buffer_pool_manager,
+                               std::shared_ptr<BufferAccessStrategy> strategy,
+                               page_id_t start_page_id, size_t distance)
+    : buffer_pool_manager_(buffer_pool_manager),
+      strategy_(std::move(strategy)),
+      distance_(std::max<size_t>(distance, 1)),
+      cursor_(start_page_id) {
+    worker_ = std::thread(&TableReadAhead::WorkerLoop, this);
+}
+
+/**
+ * 析构函数 - 通知后台线程退出并等待它结束
+ * 正在进行的单页读取会先完成，不会留下被pin住的页面
+ */
+TableReadAhead::~TableReadAhead() {
+    {
+        std::unique_lock<std::mutex> lock(latch_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+/**
+ * 扫描进入了一个新页面
+ *
+ * 实现思路：
+ * 1. 页面在预读窗口里：把它以及之前的页面移出窗口，腾出预读额度
+ * 2. 页面不在窗口里：预读已经和扫描脱节，清空窗口并从这个页面重新开始
+ */
+void TableReadAhead::OnPageVisited(page_id_t page_id) {
+    {
+        std::unique_lock<std::mutex> lock(latch_);
+        auto it = std::find(window_.begin(), window_.end(), page_id);
+        if (it != window_.end()) {
+            window_.erase(window_.begin(), it + 1);
+        } else if (cursor_ != page_id) {
+            window_.clear();
+            cursor_ = page_id;
+            generation_++;
+        }
+    }
+    cv_.notify_all();
+}
+
+size_t TableReadAhead::GetPagesPrefetched() const {
+    std::unique_lock<std::mutex> lock(latch_);
+    return pages_prefetched_;
+}
+
+/**
+ * 后台线程主循环
+ *
+ * 实现思路：
+ * 1. 等到窗口有空位并且还有页面可读
+ * 2. 放开锁读入cursor_指向的页面，得到下一个页面ID
+ * 3. 读的过程中扫描重新定位过（generation变了）就丢弃结果
+ * 4. 否则把页面放进窗口，cursor_前进到下一个页面
+ */
+void TableReadAhead::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (true) {
+        cv_.wait(lock, [this] {
+            return stop_ || (cursor_ != INVALID_PAGE_ID &&
+                             window_.size() < distance_);
+        });
+        if (stop_) {
+            return;
+        }
+
+        page_id_t page_id = cursor_;
+        uint64_t generation = generation_;
+        lock.unlock();
+        page_id_t next_page_id = LoadPage(page_id);
+        lock.lock();
+
+        if (generation != generation_) {
+            continue;
+        }
+        pages_prefetched_++;
+        window_.push_back(page_id);
+        cursor_ = next_page_id;
+    }
+}
+
+/**
+ * 读入一个页面并取出它的next_page_id
+ * 页面读入缓冲池后马上unpin，留给扫描线程命中
+ */
+page_id_t TableReadAhead::LoadPage(page_id_t page_id) {
+    int total_pages = buffer_pool_manager_->GetDiskManager()->GetNumPages();
+    if (page_id < 0 || page_id >= total_pages) {
+        return INVALID_PAGE_ID;
+    }
+
+    Page* page = buffer_pool_manager_->FetchPage(page_id, strategy_.get());
+    if (page == nullptr) {
+        LOG_DEBUG("TableReadAhead: cannot prefetch page " << page_id);
+        return INVALID_PAGE_ID;
+    }
+    // 校验值不对时停止预读，扫描线程读到这个页面时会报错
+    if (!page->VerifyChecksum(TablePage::CHECKSUM_OFFSET)) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return INVALID_PAGE_ID;
+    }
+
+    page->RLatch();
+    page_id_t next_page_id = reinterpret_cast<TablePage*>(page)->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+
+    LOG_TRACE("TableReadAhead: prefetched page " << page_id << ", next "
+                                                 << next_page_id);
+    return next_page_id;
+}
+
+}  // namespace SimpleRDBMS
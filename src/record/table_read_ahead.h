@@ -0,0 +1,91 @@
+/*
+ * 文件: table_read_ahead.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 表堆顺序扫描的异步预读器，在后台沿着页面链表提前把后续页面读进缓冲池
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * TableReadAhead - 顺序扫描预读器
+ *
+ * 设计思路：
+ * - 表堆的页面通过next_page_id串成链表，不读当前页就不知道下一页在哪，
+ *   所以预读只能沿着链表一页一页往前走，但可以和扫描线程并行进行
+ * - 后台线程从cursor_开始读页面（只读入缓冲池，马上unpin），
+ *   读出next_page_id后继续往前，最多领先扫描distance_个页面
+ * - 扫描每进入一个新页面就调用OnPageVisited，预读器据此滑动窗口；
+ *   扫描跳到了不在窗口里的页面（比如表被并发修改），就从那个页面重新开始
+ * - 扫描线程读到已预读的页面时直接命中缓冲池，磁盘延迟被隐藏到后台
+ *
+ * 预读和扫描共享同一个BufferAccessStrategy，所以批量读取的环同样限制
+ * 预读占用的frame数量。析构时停止并等待后台线程退出。
+ */
+class TableReadAhead {
+   public:
+    /**
+     * 构造函数，立即启动后台预读线程
+     * @param buffer_pool_manager 缓冲池管理器
+     * @param strategy 读取页面使用的访问策略，可以为空
+     * @param start_page_id 第一个要预读的页面
+     * @param distance 最多领先扫描多少个页面
+     */
+    TableReadAhead(BufferPoolManager* buffer_pool_manager,
+                   std::shared_ptr<BufferAccessStrategy> strategy,
+                   page_id_t start_page_id, size_t distance);
+
+    ~TableReadAhead();
+
+    TableReadAhead(const TableReadAhead&) = delete;
+    TableReadAhead& operator=(const TableReadAhead&) = delete;
+
+    /**
+     * 扫描进入了一个新页面
+     * @param page_id 扫描当前所在的页面
+     */
+    void OnPageVisited(page_id_t page_id);
+
+    /** 获取后台线程读过的页面数量 */
+    size_t GetPagesPrefetched() const;
+
+   private:
+    /** 后台线程主循环 */
+    void WorkerLoop();
+
+    /**
+     * 读入一个页面并取出它的next_page_id
+     * @return 读取失败或者到达链表末尾时返回INVALID_PAGE_ID
+     */
+    page_id_t LoadPage(page_id_t page_id);
+
+    BufferPoolManager* buffer_pool_manager_;
+    std::shared_ptr<BufferAccessStrategy> strategy_;
+    size_t distance_;
+
+    // 以下成员受latch_保护
+    page_id_t cursor_;                // 下一个要预读的页面
+    std::deque<page_id_t> window_;    // 已预读但扫描还没到达的页面
+    uint64_t generation_ = 0;         // 重新定位时加1，作废正在进行的读取
+    size_t pages_prefetched_ = 0;
+    bool stop_ = false;
+
+    mutable std::mutex latch_;
+    std::condition_variable cv_;
+    std::thread worker_;
+};
+
+}  // namespace SimpleRDBMS
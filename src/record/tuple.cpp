@@ -7,8 +7,10 @@
 
 #include "record/tuple.h"
 
+#include <cstdint>
 #include <cstring>
 #include <stdexcept>
+#include <type_traits>
 
 #include "common/debug.h"
 
@@ -19,14 +21,47 @@ namespace SimpleRDBMS {
  * @param values 要存储的值列表
  * @param schema 表的Schema信息，用于类型检查和转换
  *
- * 这个构造函数的核心任务：
+ * 列值的检查和转换都在Normalize里完成
+ */
+Tuple::Tuple(std::vector<Value> values, const Schema* schema)
+    : values_(std::move(values)), serialized_size_(0) {
+    Normalize(schema);
+}
+
+void Tuple::Reset(size_t column_count) {
+    values_.resize(column_count);
+    nulls_.clear();
+    rid_ = RID{INVALID_PAGE_ID, -1};
+    serialized_size_ = 0;
+}
+
+void Tuple::SetValue(size_t index, const Value& value) {
+    if (index >= values_.size()) {
+        throw std::out_of_range("Index out of range");
+    }
+    Value& slot = values_[index];
+    if (slot.index() == value.index()) {
+        // 同类型直接赋值，字符串容量够时不重新分配
+        std::visit(
+            [&slot](const auto& v) {
+                std::get<std::decay_t<decltype(v)>>(slot) = v;
+            },
+            value);
+    } else {
+        slot = value;
+    }
+}
+
+/**
+ * 按schema整理列值
+ *
+ * 核心任务：
  * 1. 验证输入参数的有效性
  * 2. 检查值的数量和schema的列数是否匹配
  * 3. 对每个值进行类型检查和必要的类型转换
- * 4. 计算序列化后的总大小
+ * 4. 计算序列化后的总大小：定长区由schema决定，再加上字符串内容
  */
-Tuple::Tuple(std::vector<Value> values, const Schema* schema)
-    : values_(std::move(values)) {
+void Tuple::Normalize(const Schema* schema) {
     serialized_size_ = 0;
 
     // 基本参数校验 - schema不能为空
@@ -46,6 +81,7 @@ Tuple::Tuple(std::vector<Value> values, const Schema* schema)
         throw std::runtime_error(
             "Value count doesn't match schema column count");
     }
+    serialized_size_ = schema->GetVarDataOffset();
 
     // 遍历每个值，进行类型检查和转换
     for (size_t i = 0; i < values_.size(); i++) {
@@ -87,7 +123,6 @@ Tuple::Tuple(std::vector<Value> values, const Schema* schema)
                                 "Cannot convert value to BOOLEAN");
                         }
                     }
-                    serialized_size_ += sizeof(bool);
                     break;
                 }
                 case TypeId::TINYINT: {
@@ -105,7 +140,6 @@ Tuple::Tuple(std::vector<Value> values, const Schema* schema)
                                 "Cannot convert value to TINYINT");
                         }
                     }
-                    serialized_size_ += sizeof(int8_t);
                     break;
                 }
                 case TypeId::SMALLINT: {
@@ -123,7 +157,6 @@ Tuple::Tuple(std::vector<Value> values, const Schema* schema)
                                 "Cannot convert value to SMALLINT");
                         }
                     }
-                    serialized_size_ += sizeof(int16_t);
                     break;
                 }
                 case TypeId::INTEGER: {
@@ -156,7 +189,6 @@ Tuple::Tuple(std::vector<Value> values, const Schema* schema)
                                 "Cannot convert value to INTEGER");
                         }
                     }
-                    serialized_size_ += sizeof(int32_t);
                     break;
                 }
                 case TypeId::BIGINT: {
@@ -174,7 +206,6 @@ Tuple::Tuple(std::vector<Value> values, const Schema* schema)
                                 "Cannot convert value to BIGINT");
                         }
                     }
-                    serialized_size_ += sizeof(int64_t);
                     break;
                 }
                 case TypeId::FLOAT: {
@@ -199,7 +230,6 @@ Tuple::Tuple(std::vector<Value> values, const Schema* schema)
                                 "Cannot convert value to FLOAT");
                         }
                     }
-                    serialized_size_ += sizeof(float);
                     break;
                 }
                 case TypeId::DOUBLE: {
@@ -224,7 +254,6 @@ Tuple::Tuple(std::vector<Value> values, const Schema* schema)
                                 "Cannot convert value to DOUBLE");
                         }
                     }
-                    serialized_size_ += sizeof(double);
                     break;
                 }
                 case TypeId::VARCHAR: {
@@ -235,8 +264,8 @@ Tuple::Tuple(std::vector<Value> values, const Schema* schema)
                             column.name);
                     }
                     const std::string& str = std::get<std::string>(value);
-                    // VARCHAR的序列化格式：4字节长度 + 实际字符串内容
-                    serialized_size_ += sizeof(uint32_t) + str.size();
+                    // 字符串内容放在变长数据区，条目已经算在定长区里
+                    serialized_size_ += str.size();
                     LOG_DEBUG("VARCHAR column '" << column.name
                                                  << "' length: " << str.size());
                     break;
@@ -252,66 +281,103 @@ Tuple::Tuple(std::vector<Value> values, const Schema* schema)
         }
     }
 
+    // 变长条目里的偏移和长度都是uint16_t
+    if (serialized_size_ > UINT16_MAX) {
+        throw std::runtime_error("Tuple exceeds maximum row size");
+    }
+
     LOG_DEBUG("Tuple construction completed: " << values_.size()
                                                << " values, serialized_size="
                                                << serialized_size_);
 }
 
+/** 把定长值写进已有的列值对象，类型相同时不重建variant */
+template <typename T>
+static void AssignFixed(Value* slot, const char* field) {
+    T v;
+    std::memcpy(&v, field, sizeof(T));
+    if (T* existing = std::get_if<T>(slot)) {
+        *existing = v;
+    } else {
+        slot->emplace<T>(v);
+    }
+}
+
+/** 第index列的NULL位 */
+static bool NullBit(const char* data, size_t index) {
+    return (static_cast<uint8_t>(data[1 + index / 8]) >> (index % 8)) & 1;
+}
+
+/** 定长值序列化后的字节数，字符串返回0 */
+static size_t FixedValueSize(const Value& value) {
+    return std::visit(
+        [](const auto& v) -> size_t {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string>) {
+                return 0;
+            } else {
+                return sizeof(T);
+            }
+        },
+        value);
+}
+
 /**
  * 将Tuple序列化到指定的内存缓冲区
  * @param data 目标缓冲区指针，调用者需要确保有足够空间
  *
  * 序列化的核心思路：
- * 1. 按照values_的顺序逐个序列化每个值
- * 2. 对于固定长度类型，直接memcpy到缓冲区
- * 3. 对于VARCHAR，先写入长度(4字节)，再写入内容
- * 4. 通过offset追踪当前写入位置
+ * 1. 第一个字节写行格式版本号，后面是NULL位图，NULL列对应的位为1
+ * 2. 按values_的顺序写定长区：定长值直接memcpy，字符串写条目
+ *    （数据偏移和长度各一个uint16_t），NULL列的这部分写0
+ * 3. 字符串内容按列顺序接在定长区之后
+ * 4. 各列的偏移和Schema::GetColumnOffset算出的一致，
+ *    构造时已经按schema完成了类型转换，这里只看值的类型
  */
 void Tuple::SerializeTo(char* data) const {
-    size_t offset = 0;
+    if (serialized_size_ == 0) {
+        return;  // 默认构造的空tuple
+    }
 
-    // 遍历所有值进行序列化
+    size_t bitmap_size = (values_.size() + 7) / 8;
+    size_t offset = sizeof(uint8_t) + bitmap_size;
+    size_t var_offset = offset;
     for (const auto& value : values_) {
-        // 根据Value的实际类型进行序列化
-        if (std::holds_alternative<bool>(value)) {
-            bool v = std::get<bool>(value);
-            std::memcpy(data + offset, &v, sizeof(bool));
-            offset += sizeof(bool);
-        } else if (std::holds_alternative<int8_t>(value)) {
-            int8_t v = std::get<int8_t>(value);
-            std::memcpy(data + offset, &v, sizeof(int8_t));
-            offset += sizeof(int8_t);
-        } else if (std::holds_alternative<int16_t>(value)) {
-            int16_t v = std::get<int16_t>(value);
-            std::memcpy(data + offset, &v, sizeof(int16_t));
-            offset += sizeof(int16_t);
-        } else if (std::holds_alternative<int32_t>(value)) {
-            int32_t v = std::get<int32_t>(value);
-            std::memcpy(data + offset, &v, sizeof(int32_t));
-            offset += sizeof(int32_t);
-        } else if (std::holds_alternative<int64_t>(value)) {
-            int64_t v = std::get<int64_t>(value);
-            std::memcpy(data + offset, &v, sizeof(int64_t));
-            offset += sizeof(int64_t);
-        } else if (std::holds_alternative<float>(value)) {
-            float v = std::get<float>(value);
-            std::memcpy(data + offset, &v, sizeof(float));
-            offset += sizeof(float);
-        } else if (std::holds_alternative<double>(value)) {
-            double v = std::get<double>(value);
-            std::memcpy(data + offset, &v, sizeof(double));
-            offset += sizeof(double);
-        } else if (std::holds_alternative<std::string>(value)) {
-            // VARCHAR的序列化：长度(uint32_t) + 字符串内容
+        size_t size = FixedValueSize(value);
+        var_offset += size > 0 ? size : Schema::VAR_ENTRY_SIZE;
+    }
+
+    data[0] = static_cast<char>(ROW_FORMAT_VERSION);
+    std::memset(data + 1, 0, bitmap_size);
+    for (size_t i = 0; i < values_.size(); i++) {
+        const Value& value = values_[i];
+        bool is_null = IsNull(i);
+        if (is_null) {
+            data[1 + i / 8] |= static_cast<char>(1 << (i % 8));
+        }
+
+        if (std::holds_alternative<std::string>(value)) {
             const std::string& str = std::get<std::string>(value);
-            uint32_t len = static_cast<uint32_t>(str.size());
-            // 先写入长度
-            std::memcpy(data + offset, &len, sizeof(uint32_t));
-            offset += sizeof(uint32_t);
-            // 再写入字符串内容
-            std::memcpy(data + offset, str.data(), len);
-            offset += len;
+            uint16_t entry[2] = {static_cast<uint16_t>(var_offset),
+                                 static_cast<uint16_t>(str.size())};
+            std::memcpy(data + offset, entry, sizeof(entry));
+            std::memcpy(data + var_offset, str.data(), str.size());
+            offset += Schema::VAR_ENTRY_SIZE;
+            var_offset += str.size();
+            continue;
+        }
+
+        size_t size = FixedValueSize(value);
+        if (is_null) {
+            std::memset(data + offset, 0, size);
+        } else {
+            std::visit(
+                [data, offset](const auto& v) {
+                    std::memcpy(data + offset, &v, sizeof(v));
+                },
+                value);
         }
+        offset += size;
     }
 }
 
@@ -321,107 +387,91 @@ void Tuple::SerializeTo(char* data) const {
  * @param schema 表Schema，用于确定数据类型和列数
  *
  * 反序列化的核心思路：
- * 1. 清空当前的values_并重置serialized_size_
- * 2. 根据schema的列定义，按顺序从缓冲区读取数据
- * 3. 对于固定长度类型，直接memcpy
- * 4. 对于VARCHAR，先读长度再读内容，并进行边界检查
- * 5. 发生任何错误时清空数据并抛出异常
+ * 1. 重置NULL标记和serialized_size_，values_调整成schema的列数，
+ *    上一行留下的列值对象原地覆盖，不重新分配
+ * 2. 检查版本号，不认识的格式不解析
+ * 3. 按schema里的偏移读取每一列：定长列直接memcpy，
+ *    VARCHAR读出条目再取字符串内容，并进行边界检查
+ * 4. NULL位为1的列记为NULL，值是该类型的零值
+ * 5. 发生任何错误时清空数据
  */
 void Tuple::DeserializeFrom(const char* data, const Schema* schema) {
-    values_.clear();
+    nulls_.clear();
     serialized_size_ = 0;
 
     // 基本参数校验
     if (!data || !schema) {
         LOG_ERROR("Tuple::DeserializeFrom: null data or schema");
+        values_.clear();
+        return;
+    }
+
+    if (static_cast<uint8_t>(data[0]) != ROW_FORMAT_VERSION) {
+        LOG_ERROR("Tuple::DeserializeFrom: unknown row format version "
+                  << static_cast<int>(static_cast<uint8_t>(data[0])));
+        values_.clear();
         return;
     }
 
-    size_t offset = 0;
+    size_t var_size = 0;
+    // 保留上一行留下的列值对象，同类型的列直接覆盖
+    values_.resize(schema->GetColumnCount());
 
     try {
-        // 按照schema定义的列顺序进行反序列化
         for (size_t i = 0; i < schema->GetColumnCount(); i++) {
             const auto& column = schema->GetColumn(i);
+            const char* field = data + schema->GetColumnOffset(i);
+            Value* slot = &values_[i];
 
             // 根据列类型进行相应的反序列化操作
             switch (column.type) {
-                case TypeId::BOOLEAN: {
-                    bool v;
-                    std::memcpy(&v, data + offset, sizeof(bool));
-                    values_.emplace_back(v);
-                    offset += sizeof(bool);
-                    serialized_size_ += sizeof(bool);
+                case TypeId::BOOLEAN:
+                    AssignFixed<bool>(slot, field);
                     break;
-                }
-                case TypeId::TINYINT: {
-                    int8_t v;
-                    std::memcpy(&v, data + offset, sizeof(int8_t));
-                    values_.emplace_back(v);
-                    offset += sizeof(int8_t);
-                    serialized_size_ += sizeof(int8_t);
+                case TypeId::TINYINT:
+                    AssignFixed<int8_t>(slot, field);
                     break;
-                }
-                case TypeId::SMALLINT: {
-                    int16_t v;
-                    std::memcpy(&v, data + offset, sizeof(int16_t));
-                    values_.emplace_back(v);
-                    offset += sizeof(int16_t);
-                    serialized_size_ += sizeof(int16_t);
+                case TypeId::SMALLINT:
+                    AssignFixed<int16_t>(slot, field);
                     break;
-                }
-                case TypeId::INTEGER: {
-                    int32_t v;
-                    std::memcpy(&v, data + offset, sizeof(int32_t));
-                    values_.emplace_back(v);
-                    offset += sizeof(int32_t);
-                    serialized_size_ += sizeof(int32_t);
+                case TypeId::INTEGER:
+                    AssignFixed<int32_t>(slot, field);
                     break;
-                }
-                case TypeId::BIGINT: {
-                    int64_t v;
-                    std::memcpy(&v, data + offset, sizeof(int64_t));
-                    values_.emplace_back(v);
-                    offset += sizeof(int64_t);
-                    serialized_size_ += sizeof(int64_t);
+                case TypeId::BIGINT:
+                    AssignFixed<int64_t>(slot, field);
                     break;
-                }
-                case TypeId::FLOAT: {
-                    float v;
-                    std::memcpy(&v, data + offset, sizeof(float));
-                    values_.emplace_back(v);
-                    offset += sizeof(float);
-                    serialized_size_ += sizeof(float);
+                case TypeId::FLOAT:
+                    AssignFixed<float>(slot, field);
                     break;
-                }
-                case TypeId::DOUBLE: {
-                    double v;
-                    std::memcpy(&v, data + offset, sizeof(double));
-                    values_.emplace_back(v);
-                    offset += sizeof(double);
-                    serialized_size_ += sizeof(double);
+                case TypeId::DOUBLE:
+                    AssignFixed<double>(slot, field);
                     break;
-                }
                 case TypeId::VARCHAR: {
-                    // VARCHAR反序列化：先读长度，再读内容
-                    uint32_t len;
-                    std::memcpy(&len, data + offset, sizeof(uint32_t));
-                    offset += sizeof(uint32_t);
-
-                    // 防止恶意数据导致内存分配过大
-                    if (len > MAX_TUPLE_SIZE) {
-                        LOG_ERROR("Tuple::DeserializeFrom: VARCHAR length "
-                                  << len << " exceeds maximum");
+                    // VARCHAR反序列化：先读条目，再从变长数据区取内容
+                    uint16_t entry[2];
+                    std::memcpy(entry, field, sizeof(entry));
+
+                    // 防止损坏的数据导致越界读取
+                    if (entry[1] > MAX_TUPLE_SIZE ||
+                        entry[0] < schema->GetVarDataOffset()) {
+                        LOG_ERROR("Tuple::DeserializeFrom: invalid VARCHAR "
+                                  "entry (offset "
+                                  << entry[0] << ", length " << entry[1]
+                                  << ")");
                         values_.clear();
+                        nulls_.clear();
                         serialized_size_ = 0;
                         return;
                     }
 
-                    // 构造字符串并移动到values_中
-                    std::string str(data + offset, len);
-                    values_.emplace_back(std::move(str));
-                    offset += len;
-                    serialized_size_ += sizeof(uint32_t) + len;
+                    // 已经是字符串时原地赋值：短字符串在对象内部，
+                    // 长字符串沿用上一行的缓冲区，都不需要分配
+                    if (auto* str = std::get_if<std::string>(slot)) {
+                        str->assign(data + entry[0], entry[1]);
+                    } else {
+                        slot->emplace<std::string>(data + entry[0], entry[1]);
+                    }
+                    var_size += entry[1];
                     break;
                 }
                 default:
@@ -429,10 +479,18 @@ void Tuple::DeserializeFrom(const char* data, const Schema* schema) {
                         "Tuple::DeserializeFrom: Unsupported column type: "
                         << static_cast<int>(column.type));
                     values_.clear();
+                    nulls_.clear();
                     serialized_size_ = 0;
                     return;
             }
+            if (NullBit(data, i)) {
+                if (nulls_.empty()) {
+                    nulls_.resize(schema->GetColumnCount(), false);
+                }
+                nulls_[i] = true;
+            }
         }
+        serialized_size_ = schema->GetVarDataOffset() + var_size;
 
         LOG_DEBUG("Tuple::DeserializeFrom: Successfully deserialized "
                   << values_.size()
@@ -442,6 +500,7 @@ void Tuple::DeserializeFrom(const char* data, const Schema* schema) {
         LOG_ERROR("Tuple::DeserializeFrom: Exception during deserialization: "
                   << e.what());
         values_.clear();
+        nulls_.clear();
         serialized_size_ = 0;
         throw;
     }
@@ -453,6 +512,36 @@ void Tuple::DeserializeFrom(const char* data, const Schema* schema) {
  */
 size_t Tuple::GetSerializedSize() const { return serialized_size_; }
 
+bool Tuple::IsNull(size_t index) const {
+    return index < nulls_.size() && nulls_[index];
+}
+
+/**
+ * 设置列是否为NULL
+ * 实现思路：第一次设置NULL时才分配标记数组；NULL列的值换成同类型的零值，
+ * 字符串清空并从序列化大小里扣掉它的长度，和反序列化得到的结果一致
+ */
+void Tuple::SetNull(size_t index, bool is_null) {
+    if (index >= values_.size()) {
+        throw std::out_of_range("Index out of range");
+    }
+    if (!is_null) {
+        if (index < nulls_.size()) {
+            nulls_[index] = false;
+        }
+        return;
+    }
+    if (nulls_.empty()) {
+        nulls_.resize(values_.size(), false);
+    }
+    nulls_[index] = true;
+    Value& value = values_[index];
+    if (std::holds_alternative<std::string>(value)) {
+        serialized_size_ -= std::get<std::string>(value).size();
+    }
+    std::visit([](auto& v) { v = std::decay_t<decltype(v)>(); }, value);
+}
+
 /**
  * 根据索引获取指定位置的值
  * @param index 值的索引位置
@@ -469,4 +558,11 @@ Value Tuple::GetValue(size_t index) const {
     return values_[index];
 }
 
+CompactValue Tuple::GetCompactValue(size_t index) const {
+    if (index >= values_.size()) {
+        throw std::out_of_range("Index out of range");
+    }
+    return CompactValue::FromValue(values_[index]);
+}
+
 }  // namespace SimpleRDBMS
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/compact_value.h"
 #include "common/types.h"
 
 namespace SimpleRDBMS {
@@ -51,6 +52,36 @@ class Tuple {
      */
     Tuple(std::vector<Value> values, const Schema* schema);
 
+    /**
+     * 清空tuple，准备原地写入新的一行
+     * @param column_count 新一行的列数
+     *
+     * NULL标记、RID和序列化大小都回到默认值，但values_的容量和其中
+     * 已有的列值对象都保留下来：之后SetValue或DeserializeFrom写入同类型的值时
+     * 直接覆盖，字符串沿用原来的缓冲区。执行器在Next之间反复使用同一个
+     * 输出tuple时，稳定以后每行不再分配内存
+     */
+    void Reset(size_t column_count = 0);
+
+    /**
+     * 设置指定列的值
+     * @param index 列的索引位置
+     * @param value 新值，和原来的值类型相同时原地赋值
+     * @throws std::out_of_range 当索引超出范围时抛出异常
+     *
+     * 写完所有列后要调用Normalize，序列化大小才是对的
+     */
+    void SetValue(size_t index, const Value& value);
+
+    /**
+     * 按schema检查、转换列值并重新计算序列化大小
+     * @param schema 表的Schema指针
+     * @throws std::runtime_error 列数不匹配或者值不能转换成列的类型
+     *
+     * 构造函数做的就是这一步；Reset + SetValue原地重建一行之后调用
+     */
+    void Normalize(const Schema* schema);
+
     /**
      * 根据索引获取指定列的值
      * @param index 列的索引位置，从0开始
@@ -61,6 +92,14 @@ class Tuple {
      */
     Value GetValue(size_t index) const;
 
+    /**
+     * 获取指定列的紧凑值，不复制字符串
+     * @throws std::out_of_range 当索引超出范围时抛出异常
+     *
+     * 长字符串引用tuple里的字符，tuple被修改或者析构之后就不能再用
+     */
+    CompactValue GetCompactValue(size_t index) const;
+
     /**
      * 获取所有列值的引用
      * @return values_的const引用
@@ -72,14 +111,33 @@ class Tuple {
      */
     const std::vector<Value>& GetValues() const { return values_; }
 
+    /**
+     * 判断指定列是否为NULL
+     * @param index 列的索引位置
+     * @return NULL返回true；索引超出范围时返回false
+     */
+    bool IsNull(size_t index) const;
+
+    /**
+     * 设置指定列是否为NULL
+     * @param index 列的索引位置
+     * @param is_null 为true时把列设为NULL，值换成同类型的零值
+     * @throws std::out_of_range 当索引超出范围时抛出异常
+     *
+     * NULL标记随序列化写入NULL位图，反序列化后仍然保留
+     */
+    void SetNull(size_t index, bool is_null);
+
     /**
      * 将Tuple序列化到指定的内存缓冲区
      * @param data 目标缓冲区指针，调用者需要确保有足够的空间
      *
-     * 序列化格式说明：
-     * - 固定长度类型：直接按字节序列化
-     * - VARCHAR类型：4字节长度 + 字符串内容
-     * - 所有数据按照values_的顺序连续存储
+     * 序列化格式说明（行格式版本ROW_FORMAT_VERSION）：
+     * - 1字节版本号，然后是NULL位图，每列一位
+     * - 定长区：按列顺序，定长类型直接按字节存放，
+     *   VARCHAR存放条目（数据偏移和长度各一个uint16_t）
+     * - 变长数据区：字符串内容按列顺序连续存放
+     * - 每列的偏移由Schema::GetColumnOffset给出，可以直接读取任意一列
      *
      * 注意：调用前需要通过GetSerializedSize()确保缓冲区足够大
      */
@@ -91,8 +149,8 @@ class Tuple {
      * @param schema 表Schema，用于确定数据类型和列数
      *
      * 反序列化过程：
-     * 1. 清空当前数据
-     * 2. 根据schema按列顺序读取数据
+     * 1. 清空当前数据，列值对象和容量保留下来复用（见Reset）
+     * 2. 检查版本号，根据schema里的偏移读取每一列
      * 3. 进行必要的边界检查和类型验证
      * 4. 重新计算serialized_size_
      *
@@ -141,6 +199,11 @@ class Tuple {
      */
     std::vector<Value> values_;
 
+    /**
+     * 每列的NULL标记，没有NULL列时为空，不占用额外内存
+     */
+    std::vector<bool> nulls_;
+
     /**
      * 记录标识符，用于在存储层定位这条记录
      * 包含页面ID和在页面内的slot编号
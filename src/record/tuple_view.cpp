@@ -0,0 +1,138 @@
+/*
+ * 文件: tuple_view.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: TupleView的实现，按列解码页面上的tuple数据
+ */
+
+#include "record/tuple_view.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace SimpleRDBMS {
+
+/** 从data + offset读出一个定长值 */
+template <typename T>
+static T ReadFixed(const char* data, size_t offset) {
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+void TupleView::CheckRange(size_t offset, size_t length) const {
+    if (offset > size_ || length > size_ - offset) {
+        throw std::runtime_error("TupleView: column data exceeds tuple size");
+    }
+}
+
+void TupleView::CheckColumn(size_t index) const {
+    if (schema_ == nullptr || index >= schema_->GetColumnCount()) {
+        throw std::out_of_range("Index out of range");
+    }
+    CheckRange(0, schema_->GetVarDataOffset());
+    if (static_cast<uint8_t>(data_[0]) != ROW_FORMAT_VERSION) {
+        throw std::runtime_error("TupleView: unknown row format version");
+    }
+}
+
+bool TupleView::IsNull(size_t index) const {
+    CheckColumn(index);
+    return (static_cast<uint8_t>(data_[1 + index / 8]) >> (index % 8)) & 1;
+}
+
+/**
+ * 解码一列
+ * 实现思路：从Schema取得列的偏移，定长列直接读出；
+ * VARCHAR先读条目，检查数据范围后取字符串内容
+ */
+Value TupleView::GetValue(size_t index) const {
+    CheckColumn(index);
+
+    size_t offset = schema_->GetColumnOffset(index);
+    TypeId type = schema_->GetColumn(index).type;
+    switch (type) {
+        case TypeId::BOOLEAN:
+            return ReadFixed<bool>(data_, offset);
+        case TypeId::TINYINT:
+            return ReadFixed<int8_t>(data_, offset);
+        case TypeId::SMALLINT:
+            return ReadFixed<int16_t>(data_, offset);
+        case TypeId::INTEGER:
+            return ReadFixed<int32_t>(data_, offset);
+        case TypeId::BIGINT:
+            return ReadFixed<int64_t>(data_, offset);
+        case TypeId::FLOAT:
+            return ReadFixed<float>(data_, offset);
+        case TypeId::DOUBLE:
+            return ReadFixed<double>(data_, offset);
+        case TypeId::VARCHAR: {
+            uint16_t data_offset = ReadFixed<uint16_t>(data_, offset);
+            uint16_t length =
+                ReadFixed<uint16_t>(data_, offset + sizeof(uint16_t));
+            CheckRange(data_offset, length);
+            return std::string(data_ + data_offset, length);
+        }
+        default:
+            throw std::runtime_error("TupleView: unsupported column type " +
+                                     std::to_string(static_cast<int>(type)));
+    }
+}
+
+/**
+ * 解码一列成紧凑值
+ * 和GetValue读同样的字节、做同样的检查，VARCHAR直接引用页面上的字符
+ */
+CompactValue TupleView::GetCompactValue(size_t index) const {
+    CheckColumn(index);
+
+    size_t offset = schema_->GetColumnOffset(index);
+    TypeId type = schema_->GetColumn(index).type;
+    switch (type) {
+        case TypeId::BOOLEAN:
+            return CompactValue::FromInteger(
+                type, ReadFixed<bool>(data_, offset) ? 1 : 0);
+        case TypeId::TINYINT:
+            return CompactValue::FromInteger(type,
+                                             ReadFixed<int8_t>(data_, offset));
+        case TypeId::SMALLINT:
+            return CompactValue::FromInteger(type,
+                                             ReadFixed<int16_t>(data_, offset));
+        case TypeId::INTEGER:
+            return CompactValue::FromInteger(type,
+                                             ReadFixed<int32_t>(data_, offset));
+        case TypeId::BIGINT:
+            return CompactValue::FromInteger(type,
+                                             ReadFixed<int64_t>(data_, offset));
+        case TypeId::FLOAT:
+            return CompactValue::FromDouble(type,
+                                            ReadFixed<float>(data_, offset));
+        case TypeId::DOUBLE:
+            return CompactValue::FromDouble(type,
+                                            ReadFixed<double>(data_, offset));
+        case TypeId::VARCHAR: {
+            uint16_t data_offset = ReadFixed<uint16_t>(data_, offset);
+            uint16_t length =
+                ReadFixed<uint16_t>(data_, offset + sizeof(uint16_t));
+            CheckRange(data_offset, length);
+            return CompactValue::FromString(data_ + data_offset, length);
+        }
+        default:
+            throw std::runtime_error("TupleView: unsupported column type " +
+                                     std::to_string(static_cast<int>(type)));
+    }
+}
+
+Tuple TupleView::ToTuple() const {
+    Tuple tuple;
+    ToTuple(&tuple);
+    return tuple;
+}
+
+void TupleView::ToTuple(Tuple* tuple) const {
+    tuple->DeserializeFrom(data_, schema_);
+    tuple->SetRID(rid_);
+}
+
+}  // namespace SimpleRDBMS
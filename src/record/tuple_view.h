@@ -0,0 +1,107 @@
+/*
+ * 文件: tuple_view.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: TupleView类的定义，直接引用页面上的tuple字节，按需解码单个列，
+ *       扫描只用到少数几列时不必反序列化整行
+ */
+
+#pragma once
+
+#include "catalog/schema.h"
+#include "common/compact_value.h"
+#include "common/types.h"
+#include "record/tuple.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * TupleView类 - 页面上一条记录的只读视图
+ *
+ * 设计思路：
+ * - 只保存指向页面数据的指针和长度，不复制任何字节
+ * - GetValue只解码请求的那一列；行格式里每列的位置都可以从
+ *   Schema的偏移表直接得到，VARCHAR再读一次条目，取任意一列都是O(1)
+ * - 需要完整记录时用ToTuple反序列化，结果和TablePage::GetTuple一致
+ *
+ * 视图引用的是缓冲池里的页面，只在页面被固定并持有读锁期间有效，
+ * 一般通过TableHeap::ReadTuple在回调里使用，不要保存到回调之外
+ */
+class TupleView {
+   public:
+    /** 空视图，不能取列值 */
+    TupleView() = default;
+
+    /**
+     * 构造函数
+     * @param data tuple在页面中的起始地址
+     * @param size tuple的字节数（slot记录的大小）
+     * @param schema 表的schema，用于确定每列的类型和偏移
+     * @param rid tuple的RID
+     */
+    TupleView(const char* data, size_t size, const Schema* schema,
+              const RID& rid)
+        : data_(data), size_(size), schema_(schema), rid_(rid) {}
+
+    /**
+     * 解码指定列的值
+     * @param index 列的索引位置
+     * @return 列值
+     * @throws std::out_of_range 索引超出范围
+     * @throws std::runtime_error 数据超出tuple的范围、行格式版本不对
+     *         或者列类型不支持
+     *
+     * NULL列返回该类型的零值，用IsNull区分
+     */
+    Value GetValue(size_t index) const;
+
+    /**
+     * 解码指定列的紧凑值，检查和抛出的异常同GetValue
+     * VARCHAR引用页面上的字符，不分配内存，只在视图有效期间可用
+     */
+    CompactValue GetCompactValue(size_t index) const;
+
+    /**
+     * 判断指定列是否为NULL，只读NULL位图
+     * @param index 列的索引位置
+     * @throws std::out_of_range 索引超出范围
+     */
+    bool IsNull(size_t index) const;
+
+    /** 反序列化出完整的tuple，并设置RID */
+    Tuple ToTuple() const;
+
+    /** 反序列化到已有的tuple里，复用它的列值存储，并设置RID */
+    void ToTuple(Tuple* tuple) const;
+
+    /** 列数 */
+    size_t GetColumnCount() const {
+        return schema_ != nullptr ? schema_->GetColumnCount() : 0;
+    }
+
+    /** 解码用的schema */
+    const Schema* GetSchema() const { return schema_; }
+
+    /** tuple的RID */
+    const RID& GetRID() const { return rid_; }
+
+    /** tuple数据的起始地址 */
+    const char* GetData() const { return data_; }
+
+    /** tuple数据的字节数 */
+    size_t GetSize() const { return size_; }
+
+   private:
+    /** 检查列索引有效，并且数据至少包含版本号、位图和定长区 */
+    void CheckColumn(size_t index) const;
+
+    /** 检查从offset开始的length个字节都在tuple范围内 */
+    void CheckRange(size_t offset, size_t length) const;
+
+    const char* data_ = nullptr;    // 页面中的tuple数据
+    size_t size_ = 0;               // tuple的字节数
+    const Schema* schema_ = nullptr;
+    RID rid_;
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,94 @@
+/*
+ * 文件: zone_map.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 表堆区域映射实现
+ */
+
+#include "record/zone_map.h"
+
+#include <cmath>
+
+namespace SimpleRDBMS {
+
+/** NaN和任何值比较都是false，不能放进最小/最大值 */
+static bool IsNaN(const Value& value) {
+    if (const auto* f = std::get_if<float>(&value)) {
+        return std::isnan(*f);
+    }
+    if (const auto* d = std::get_if<double>(&value)) {
+        return std::isnan(*d);
+    }
+    return false;
+}
+
+/**
+ * 并入一个tuple
+ * 实现思路：同一列的值在tuple里总是schema规定的类型，
+ * 直接用variant的比较运算更新最小值和最大值
+ */
+void ZoneMap::Extend(PageZone* zone, const Tuple& tuple) {
+    const auto& values = tuple.GetValues();
+    if (zone->columns.size() < values.size()) {
+        zone->columns.resize(values.size());
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+        const Value& value = values[i];
+        if (IsNaN(value)) {
+            continue;
+        }
+        ColumnRange& range = zone->columns[i];
+        if (!range.has_value) {
+            range.min = value;
+            range.max = value;
+            range.has_value = true;
+        } else if (value < range.min) {
+            range.min = value;
+        } else if (range.max < value) {
+            range.max = value;
+        }
+    }
+}
+
+void ZoneMap::Set(page_id_t page_id, PageZone zone) {
+    std::lock_guard<std::mutex> guard(latch_);
+    zones_[page_id] = std::move(zone);
+}
+
+void ZoneMap::Widen(page_id_t page_id, const Tuple& tuple) {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto it = zones_.find(page_id);
+    if (it != zones_.end()) {
+        Extend(&it->second, tuple);
+    }
+}
+
+void ZoneMap::SetNextPageId(page_id_t page_id, page_id_t next_page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto it = zones_.find(page_id);
+    if (it != zones_.end()) {
+        it->second.next_page_id = next_page_id;
+    }
+}
+
+bool ZoneMap::Get(page_id_t page_id, PageZone* zone) const {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto it = zones_.find(page_id);
+    if (it == zones_.end()) {
+        return false;
+    }
+    *zone = it->second;
+    return true;
+}
+
+void ZoneMap::Remove(page_id_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    zones_.erase(page_id);
+}
+
+size_t ZoneMap::GetPageCount() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    return zones_.size();
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,88 @@
+/*
+ * 文件: zone_map.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 表堆的区域映射，记录每个页面上各列的最小值和最大值，
+ *       顺序扫描据此跳过不可能满足WHERE条件的页面
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/types.h"
+#include "record/tuple.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * ZoneMap - 页面级的最小/最大值摘要
+ *
+ * 设计思路：
+ * - 每个页面一条摘要，按列记录页面上出现过的最小值和最大值，
+ *   同时记下页面的下一页ID，跳过页面时不用读取它
+ * - 摘要只会放宽不会收紧：插入和更新把新值并入，删除不处理，
+ *   所以范围可能比页面实际内容宽，但不会漏掉页面上的值
+ * - 不在映射里的页面没有摘要，扫描时由TableHeap读一遍页面建立；
+ *   新分配的页面直接登记一条空摘要，之后的插入都会并入
+ * - 映射只在内存里，不落盘，重启后由扫描重新建立；
+ *   恢复直接改写页面的操作需要在映射建立之前完成
+ * - NaN不参与最小/最大值，它不满足任何比较条件
+ *
+ * 所有方法都是线程安全的，内部的锁不会在持有时再去拿页面锁
+ */
+class ZoneMap {
+   public:
+    /** 一列在页面上的取值范围 */
+    struct ColumnRange {
+        bool has_value = false;  // false表示页面上这一列还没有可比较的值
+        Value min;
+        Value max;
+    };
+
+    /** 一个页面的摘要 */
+    struct PageZone {
+        page_id_t next_page_id = INVALID_PAGE_ID;  // 页面链表的下一页
+        std::vector<ColumnRange> columns;  // 为空表示页面上从没有过记录
+    };
+
+    /**
+     * 登记页面的完整摘要，已有的摘要被替换
+     * 调用者持有页面锁，保证摘要和页面内容一致
+     */
+    void Set(page_id_t page_id, PageZone zone);
+
+    /**
+     * 把tuple的值并入页面的摘要，页面没有摘要时什么也不做
+     * 调用者持有页面的写锁
+     */
+    void Widen(page_id_t page_id, const Tuple& tuple);
+
+    /** 页面链接到新的下一页时更新摘要里的下一页ID */
+    void SetNextPageId(page_id_t page_id, page_id_t next_page_id);
+
+    /** 页面从表中释放时删除它的摘要 */
+    void Remove(page_id_t page_id);
+
+    /**
+     * 取出页面的摘要
+     * @return 页面没有摘要时返回false
+     */
+    bool Get(page_id_t page_id, PageZone* zone) const;
+
+    /** 有摘要的页面数 */
+    size_t GetPageCount() const;
+
+    /** 把tuple的各列值并入摘要的范围 */
+    static void Extend(PageZone* zone, const Tuple& tuple);
+
+   private:
+    mutable std::mutex latch_;
+    std::unordered_map<page_id_t, PageZone> zones_;
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,394 @@
+/*
+ * 文件: log_cursor.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: WAL日志游标实现，按块读取并按需解析日志记录
+ */
+
+#include "recovery/log_cursor.h"
+
+#include <cstring>
+
+#include "common/crc32c.h"
+#include "common/debug.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+template <typename T>
+T ReadField(const char* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+}  // namespace
+
+LogCursor::LogCursor(const WalFile* wal_file, uint64_t begin_block,
+                     uint64_t end_block)
+    : wal_file_(wal_file),
+      begin_block_(begin_block),
+      end_block_(end_block),
+      block_(PAGE_SIZE),
+      begin_record_(INVALID_TXN_ID),
+      commit_record_(INVALID_TXN_ID, INVALID_LSN),
+      abort_record_(INVALID_TXN_ID, INVALID_LSN),
+      insert_record_(INVALID_TXN_ID, INVALID_LSN, RID{}, Tuple()),
+      update_record_(INVALID_TXN_ID, INVALID_LSN, RID{}, Tuple(), Tuple()),
+      update_delta_record_(INVALID_TXN_ID, INVALID_LSN, RID{}, nullptr, 0),
+      multi_insert_record_(INVALID_TXN_ID, INVALID_LSN, INVALID_PAGE_ID),
+      delete_record_(INVALID_TXN_ID, INVALID_LSN, RID{}, Tuple()),
+      new_page_record_(INVALID_PAGE_ID, INVALID_PAGE_ID) {}
+
+bool LogCursor::SeekToFirst() {
+    for (uint64_t block = begin_block_; block < end_block_; block++) {
+        if (!LoadBlock(block)) {
+            return Invalidate();
+        }
+        if (!record_offsets_.empty()) {
+            DecodeRecord(0);
+            return true;
+        }
+    }
+    return Invalidate();
+}
+
+bool LogCursor::SeekToLast() {
+    for (uint64_t block = end_block_; block > begin_block_; block--) {
+        if (!LoadBlock(block - 1)) {
+            return Invalidate();
+        }
+        if (!record_offsets_.empty()) {
+            DecodeRecord(record_offsets_.size() - 1);
+            return true;
+        }
+    }
+    return Invalidate();
+}
+
+/**
+ * 定位到第一条LSN不小于lsn的记录
+ * 实现思路：
+ * 1. LSN随块号单调递增，按块中第一条记录的LSN二分查找，
+ *    找到最后一个首条LSN不大于lsn的块（没有记录的块视为属于后一个块）
+ * 2. 从这个块开始向后移动，直到LSN不小于lsn
+ */
+bool LogCursor::SeekToLSN(lsn_t lsn) {
+    uint64_t low = begin_block_;
+    uint64_t high = end_block_;
+    uint64_t start = begin_block_;
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        if (!LoadBlock(mid)) {
+            return Invalidate();
+        }
+        if (record_offsets_.empty()) {
+            // 空块只会出现在日志末尾，之前的块都有记录
+            high = mid;
+            continue;
+        }
+        DecodeRecord(0);
+        if (record_->GetLSN() <= lsn) {
+            start = mid;
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    bool ok = false;
+    for (uint64_t block = start; block < end_block_ && !ok; block++) {
+        if (!LoadBlock(block)) {
+            return Invalidate();
+        }
+        if (!record_offsets_.empty()) {
+            DecodeRecord(0);
+            ok = true;
+        }
+    }
+    if (!ok) {
+        return Invalidate();
+    }
+    while (ok && record_->GetLSN() < lsn) {
+        ok = Next();
+    }
+    return ok;
+}
+
+/**
+ * 移动到下一条记录
+ * 实现思路：块内还有记录就直接解析，否则依次读入后面的块，
+ * 跳过没有记录的块
+ */
+bool LogCursor::Next() {
+    if (!Valid()) {
+        return false;
+    }
+    if (record_index_ + 1 < record_offsets_.size()) {
+        DecodeRecord(record_index_ + 1);
+        return true;
+    }
+    for (uint64_t block = current_block_ + 1; block < end_block_; block++) {
+        if (!LoadBlock(block)) {
+            return Invalidate();
+        }
+        if (!record_offsets_.empty()) {
+            DecodeRecord(0);
+            return true;
+        }
+    }
+    return Invalidate();
+}
+
+/**
+ * 移动到上一条记录，和Next对称
+ */
+bool LogCursor::Prev() {
+    if (!Valid()) {
+        return false;
+    }
+    if (record_index_ > 0) {
+        DecodeRecord(record_index_ - 1);
+        return true;
+    }
+    for (uint64_t block = current_block_; block > begin_block_; block--) {
+        if (!LoadBlock(block - 1)) {
+            return Invalidate();
+        }
+        if (!record_offsets_.empty()) {
+            DecodeRecord(record_offsets_.size() - 1);
+            return true;
+        }
+    }
+    return Invalidate();
+}
+
+const char* LogCursor::GetBody() const {
+    return block_.data() + record_offsets_[record_index_] + sizeof(uint32_t) +
+           LOG_RECORD_HEADER_SIZE;
+}
+
+size_t LogCursor::GetBodySize() const {
+    uint32_t record_size =
+        ReadField<uint32_t>(block_.data() + record_offsets_[record_index_]);
+    return record_size - LOG_RECORD_HEADER_SIZE;
+}
+
+const char* LogCursor::GetRawRecord() const {
+    return block_.data() + record_offsets_[record_index_];
+}
+
+size_t LogCursor::GetRawRecordSize() const {
+    return sizeof(uint32_t) + LOG_RECORD_HEADER_SIZE + GetBodySize();
+}
+
+std::unique_ptr<LogRecord> LogCursor::CloneRecord() const {
+    std::unique_ptr<LogRecord> clone;
+    switch (record_->GetType()) {
+        case LogRecordType::BEGIN:
+            clone = std::make_unique<BeginLogRecord>(begin_record_);
+            break;
+        case LogRecordType::COMMIT:
+            clone = std::make_unique<CommitLogRecord>(commit_record_);
+            break;
+        case LogRecordType::ABORT:
+            clone = std::make_unique<AbortLogRecord>(abort_record_);
+            break;
+        case LogRecordType::CHECKPOINT:
+            clone = std::make_unique<CheckpointLogRecord>(checkpoint_record_);
+            break;
+        case LogRecordType::INSERT:
+            clone = std::make_unique<InsertLogRecord>(insert_record_);
+            break;
+        case LogRecordType::UPDATE:
+            clone = std::make_unique<UpdateLogRecord>(update_record_);
+            break;
+        case LogRecordType::UPDATE_DELTA:
+            clone = std::make_unique<UpdateDeltaLogRecord>(update_delta_record_);
+            break;
+        case LogRecordType::MULTI_INSERT:
+            clone = std::make_unique<MultiInsertLogRecord>(multi_insert_record_);
+            break;
+        case LogRecordType::DELETE:
+            clone = std::make_unique<DeleteLogRecord>(delete_record_);
+            break;
+        case LogRecordType::NEW_PAGE:
+            clone = std::make_unique<NewPageLogRecord>(new_page_record_);
+            break;
+        default:
+            break;
+    }
+    return clone;
+}
+
+/**
+ * 读入日志块
+ * 实现思路：
+ * 1. 块已经在缓冲区里就不再读
+ * 2. 核对块末尾的校验值，不对的块（崩溃时写了一半、介质损坏）当作没有记录
+ * 3. 从头按长度字段扫描，记下每条记录的偏移，
+ *    遇到长度为0或越界的记录说明块内后面都是空白
+ * 4. 无法识别类型的记录也会被跳过，不计入偏移
+ */
+bool LogCursor::LoadBlock(uint64_t block) {
+    if (block_loaded_ && current_block_ == block) {
+        return true;
+    }
+    block_loaded_ = false;
+    record_offsets_.clear();
+    if (!wal_file_->ReadBlock(block, block_.data())) {
+        LOG_WARN("LogCursor: cannot read log block " << block);
+        return false;
+    }
+    current_block_ = block;
+    block_loaded_ = true;
+
+    uint32_t checksum =
+        ReadField<uint32_t>(block_.data() + LOG_BLOCK_DATA_SIZE);
+    if (checksum != Crc32c(block_.data(), LOG_BLOCK_DATA_SIZE)) {
+        LOG_WARN("LogCursor: checksum mismatch in log block "
+                 << block << ", skipping its records");
+        return true;
+    }
+
+    size_t offset = 0;
+    while (offset + sizeof(uint32_t) <= LOG_BLOCK_DATA_SIZE) {
+        uint32_t record_size = ReadField<uint32_t>(block_.data() + offset);
+        if (record_size < LOG_RECORD_HEADER_SIZE ||
+            offset + sizeof(uint32_t) + record_size > LOG_BLOCK_DATA_SIZE) {
+            break;  // 到达块内记录的末尾
+        }
+        auto type = ReadField<LogRecordType>(block_.data() + offset +
+                                             sizeof(uint32_t));
+        bool known = type >= LogRecordType::INSERT &&
+                     type <= LogRecordType::NEW_PAGE;
+        bool is_dml = type == LogRecordType::INSERT ||
+                      type == LogRecordType::UPDATE ||
+                      type == LogRecordType::UPDATE_DELTA ||
+                      type == LogRecordType::MULTI_INSERT ||
+                      type == LogRecordType::DELETE;
+        if (is_dml && record_size < LOG_RECORD_HEADER_SIZE + sizeof(page_id_t) +
+                                        sizeof(slot_offset_t)) {
+            known = false;
+        }
+        if (type == LogRecordType::NEW_PAGE &&
+            record_size < LOG_RECORD_HEADER_SIZE + 2 * sizeof(page_id_t)) {
+            known = false;
+        }
+        if (known) {
+            record_offsets_.push_back(static_cast<uint16_t>(offset));
+        } else {
+            LOG_DEBUG("LogCursor: skipping unknown log record type "
+                      << static_cast<int>(type) << " in block " << block);
+        }
+        offset += sizeof(uint32_t) + record_size;
+    }
+    return true;
+}
+
+/**
+ * 解析记录头，把字段写进对应类型的复用对象
+ */
+void LogCursor::DecodeRecord(size_t index) {
+    record_index_ = index;
+    const char* data = block_.data() + record_offsets_[index] + sizeof(uint32_t);
+
+    auto type = ReadField<LogRecordType>(data);
+    data += sizeof(LogRecordType);
+    auto txn_id = ReadField<txn_id_t>(data);
+    data += sizeof(txn_id_t);
+    auto prev_lsn = ReadField<lsn_t>(data);
+    data += sizeof(lsn_t);
+    auto lsn = ReadField<lsn_t>(data);
+    data += sizeof(lsn_t);
+
+    // DML记录的数据以RID开头，tuple要有表的schema才能解析
+    RID rid{};
+    if (type == LogRecordType::INSERT || type == LogRecordType::UPDATE ||
+        type == LogRecordType::UPDATE_DELTA ||
+        type == LogRecordType::MULTI_INSERT || type == LogRecordType::DELETE) {
+        rid.page_id = ReadField<page_id_t>(data);
+        rid.slot_num = ReadField<slot_offset_t>(data + sizeof(page_id_t));
+    }
+
+    switch (type) {
+        case LogRecordType::BEGIN:
+            begin_record_ = BeginLogRecord(txn_id);
+            record_ = &begin_record_;
+            break;
+        case LogRecordType::COMMIT:
+            commit_record_ = CommitLogRecord(txn_id, prev_lsn);
+            record_ = &commit_record_;
+            break;
+        case LogRecordType::ABORT:
+            abort_record_ = AbortLogRecord(txn_id, prev_lsn);
+            record_ = &abort_record_;
+            break;
+        case LogRecordType::CHECKPOINT:
+            // 检查点很少，直接解析两张表
+            if (!checkpoint_record_.DeserializePayload(data, GetBodySize())) {
+                LOG_WARN("LogCursor: malformed checkpoint record at LSN "
+                         << lsn);
+            }
+            record_ = &checkpoint_record_;
+            break;
+        case LogRecordType::INSERT: {
+            // tuple的原始字节和RID一起取出来，redo直接写回页面
+            size_t rid_size = sizeof(page_id_t) + sizeof(slot_offset_t);
+            insert_record_ =
+                InsertLogRecord(txn_id, prev_lsn, rid, data + rid_size,
+                                GetBodySize() - rid_size);
+            record_ = &insert_record_;
+            break;
+        }
+        case LogRecordType::UPDATE: {
+            size_t rid_size = sizeof(page_id_t) + sizeof(slot_offset_t);
+            update_record_ =
+                UpdateLogRecord(txn_id, prev_lsn, rid, data + rid_size,
+                                GetBodySize() - rid_size);
+            record_ = &update_record_;
+            break;
+        }
+        case LogRecordType::UPDATE_DELTA: {
+            // 差异数据很小，和RID一起解析出来，redo/undo不需要schema
+            size_t rid_size = sizeof(page_id_t) + sizeof(slot_offset_t);
+            update_delta_record_ = UpdateDeltaLogRecord(
+                txn_id, prev_lsn, rid, data + rid_size,
+                GetBodySize() - rid_size);
+            record_ = &update_delta_record_;
+            break;
+        }
+        case LogRecordType::MULTI_INSERT: {
+            // 和UPDATE_DELTA一样带上完整数据，undo需要知道tuple数
+            size_t rid_size = sizeof(page_id_t) + sizeof(slot_offset_t);
+            multi_insert_record_ = MultiInsertLogRecord(
+                txn_id, prev_lsn, rid, data + rid_size,
+                GetBodySize() - rid_size);
+            record_ = &multi_insert_record_;
+            break;
+        }
+        case LogRecordType::DELETE:
+            delete_record_ = DeleteLogRecord(txn_id, prev_lsn, rid, Tuple());
+            record_ = &delete_record_;
+            break;
+        case LogRecordType::NEW_PAGE:
+            new_page_record_ = NewPageLogRecord(
+                ReadField<page_id_t>(data),
+                ReadField<page_id_t>(data + sizeof(page_id_t)));
+            record_ = &new_page_record_;
+            break;
+        default:
+            // LoadBlock已经过滤掉未知类型
+            record_ = nullptr;
+            return;
+    }
+    record_->SetLSN(lsn);
+}
+
+bool LogCursor::Invalidate() {
+    record_ = nullptr;
+    return false;
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,151 @@
+/*
+ * 文件: log_cursor.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: WAL日志游标，按块流式读取日志记录，支持正向和逆向遍历
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "recovery/log_record.h"
+#include "recovery/wal_file.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * LogCursor - 日志游标
+ *
+ * 设计思路：
+ * - 游标只持有一个日志块的缓冲区，移动到别的块时才从WAL读入，
+ *   整个日志不会同时出现在内存里，内存占用和日志长度无关
+ * - 记录按需解析：每种记录类型各有一个复用的记录对象，
+ *   移动游标时覆盖其中的字段，不为每条记录分配对象
+ * - 块内记录的起始偏移在读入块时记下来，逆向移动也是O(1)
+ * - 游标的范围是创建时WAL中已经写出的块，之后追加的记录看不到
+ *
+ * 用法：
+ *   for (bool ok = cursor.SeekToFirst(); ok; ok = cursor.Next()) {...}
+ *   for (bool ok = cursor.SeekToLast(); ok; ok = cursor.Prev()) {...}
+ *
+ * 注意：GetRecord()返回的引用在游标下一次移动后失效，
+ * 需要保留的记录用CloneRecord()复制一份
+ */
+class LogCursor {
+   public:
+    /**
+     * 构造函数
+     * @param wal_file 要读取的WAL文件
+     * @param begin_block 第一个日志块
+     * @param end_block 最后一个日志块之后的块号
+     */
+    LogCursor(const WalFile* wal_file, uint64_t begin_block,
+              uint64_t end_block);
+
+    /**
+     * 定位到第一条记录
+     * @return 日志为空时返回false
+     */
+    bool SeekToFirst();
+
+    /**
+     * 定位到最后一条记录
+     * @return 日志为空时返回false
+     */
+    bool SeekToLast();
+
+    /**
+     * 定位到第一条LSN不小于lsn的记录，按块二分查找
+     * @return 没有这样的记录时返回false
+     */
+    bool SeekToLSN(lsn_t lsn);
+
+    /**
+     * 移动到下一条记录
+     * @return 已经没有更多记录时返回false，游标变为无效
+     */
+    bool Next();
+
+    /**
+     * 移动到上一条记录
+     * @return 已经是第一条记录时返回false，游标变为无效
+     */
+    bool Prev();
+
+    /** 游标是否指向一条记录 */
+    bool Valid() const { return record_ != nullptr; }
+
+    /**
+     * 当前记录，tuple内容需要schema才能解析：INSERT/UPDATE带有tuple的原始字节，
+     * DELETE只包含RID；UPDATE_DELTA和MULTI_INSERT记录带有完整的数据
+     * 游标必须有效，引用在下一次移动后失效
+     */
+    const LogRecord& GetRecord() const { return *record_; }
+
+    /** 当前记录去掉头部之后的数据 */
+    const char* GetBody() const;
+
+    /** 当前记录数据部分的字节数 */
+    size_t GetBodySize() const;
+
+    /** 复制当前记录，游标必须有效 */
+    std::unique_ptr<LogRecord> CloneRecord() const;
+
+    /**
+     * 当前记录在日志块里的原始字节，从长度字段开始
+     * WAL复制原样发送，接收方用LogRecord::DeserializeFrom解析
+     */
+    const char* GetRawRecord() const;
+
+    /** 当前记录连同长度字段的字节数 */
+    size_t GetRawRecordSize() const;
+
+   private:
+    /** 读入一个日志块并记下其中所有记录的偏移，读取失败返回false */
+    bool LoadBlock(uint64_t block);
+
+    /** 解析当前块中第index条记录 */
+    void DecodeRecord(size_t index);
+
+    /** 游标置为无效 */
+    bool Invalidate();
+
+    const WalFile* wal_file_;
+    uint64_t begin_block_;
+    uint64_t end_block_;
+
+    /** 当前块，块中没有记录时仍然记录块号 */
+    uint64_t current_block_{0};
+    bool block_loaded_{false};
+
+    /** 当前块中的第几条记录 */
+    size_t record_index_{0};
+
+    /** 当前块的内容，大小为PAGE_SIZE */
+    std::vector<char> block_;
+
+    /** 当前块中每条记录（长度字段）的起始偏移 */
+    std::vector<uint16_t> record_offsets_;
+
+    /** 当前记录，指向下面某个复用对象，无效时为nullptr */
+    LogRecord* record_{nullptr};
+
+    // ========== 复用的记录对象 ==========
+
+    BeginLogRecord begin_record_;
+    CommitLogRecord commit_record_;
+    AbortLogRecord abort_record_;
+    CheckpointLogRecord checkpoint_record_;
+    InsertLogRecord insert_record_;
+    UpdateLogRecord update_record_;
+    UpdateDeltaLogRecord update_delta_record_;
+    MultiInsertLogRecord multi_insert_record_;
+    DeleteLogRecord delete_record_;
+    NewPageLogRecord new_page_record_;
+};
+
+}  // namespace SimpleRDBMS
@@ -7,44 +7,109 @@
 
 #include "recovery/log_manager.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "common/config.h"
+#include "common/crc32c.h"
 #include "common/debug.h"
+#include "common/exception.h"
+#include "recovery/log_cursor.h"
 #include "recovery/log_record.h"
 #include "storage/disk_manager.h"
 
 #include "stat/stat.h"
+#include "stat/trace.h"
 
 namespace SimpleRDBMS {
 
+namespace {
+
+// reserve_state_的布局：高32位LSN，第31位缓冲区下标，低31位偏移
+constexpr uint64_t RESERVE_INDEX_BIT = uint64_t(1) << 31;
+constexpr uint64_t RESERVE_OFFSET_MASK = RESERVE_INDEX_BIT - 1;
+
+uint64_t PackReserveState(lsn_t next_lsn, int index, size_t offset) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(next_lsn)) << 32) |
+           (index != 0 ? RESERVE_INDEX_BIT : 0) |
+           (static_cast<uint64_t>(offset) & RESERVE_OFFSET_MASK);
+}
+
+lsn_t ReserveStateLSN(uint64_t state) {
+    return static_cast<lsn_t>(static_cast<uint32_t>(state >> 32));
+}
+
+int ReserveStateIndex(uint64_t state) {
+    return (state & RESERVE_INDEX_BIT) != 0 ? 1 : 0;
+}
+
+size_t ReserveStateOffset(uint64_t state) {
+    return static_cast<size_t>(state & RESERVE_OFFSET_MASK);
+}
+
+}  // namespace
+
+namespace {
+
+const std::string& LogFileOf(DiskManager* disk_manager) {
+    // 参数合法性检查
+    if (disk_manager == nullptr) {
+        throw std::invalid_argument("DiskManager cannot be null");
+    }
+    return disk_manager->GetFileName();
+}
+
+}  // namespace
+
 /**
  * LogManager构造函数
- * @param disk_manager 磁盘管理器指针，用于实际的页面读写操作
+ * @param disk_manager 磁盘管理器指针，WAL段文件以它的文件名为前缀
+ * @param buffer_size 每块日志缓冲区的大小
  */
-LogManager::LogManager(DiskManager* disk_manager)
-    : disk_manager_(disk_manager),
-      log_buffer_size_(PAGE_SIZE),
-      log_buffer_offset_(0),
-      current_log_page_id_(0),
+LogManager::LogManager(DiskManager* disk_manager, size_t buffer_size)
+    : LogManager(LogFileOf(disk_manager), buffer_size) {}
+
+/**
+ * LogManager构造函数
+ * @param log_file WAL段文件的路径前缀
+ * @param buffer_size 每块日志缓冲区的大小
+ * @param segment_size WAL段文件大小
+ */
+LogManager::LogManager(const std::string& log_file, size_t buffer_size,
+                       size_t segment_size)
+    : wal_file_(std::make_unique<WalFile>(log_file, segment_size)),
       last_checkpoint_lsn_(INVALID_LSN) {
-    // 参数合法性检查
-    if (disk_manager_ == nullptr) {
-        throw std::invalid_argument("DiskManager cannot be null");
-    }
 
-    // 初始化日志缓冲区，大小为一个页面
-    log_buffer_ = new char[log_buffer_size_];
-    memset(log_buffer_, 0, log_buffer_size_);
+    // 缓冲区大小取整到页面的整数倍，偏移字段只有31位
+    size_t pages = std::max<size_t>((buffer_size + PAGE_SIZE - 1) / PAGE_SIZE, 1);
+    pages = std::min<size_t>(pages, RESERVE_OFFSET_MASK / PAGE_SIZE);
+    log_buffer_size_ = pages * PAGE_SIZE;
+
+    // 初始化两块日志缓冲区，第0块先作为active
+    for (auto& buffer : buffers_) {
+        buffer.data = new char[log_buffer_size_];
+        memset(buffer.data, 0, log_buffer_size_);
+    }
+    buffers_[0].state = BufferState::ACTIVE;
 
     // 初始化LSN相关变量
-    // next_lsn_: 下一个要分配的LSN，从1开始
-    // persistent_lsn_: 已经持久化到磁盘的最大LSN
-    next_lsn_.store(1);
-    persistent_lsn_.store(0);
-    flush_thread_running_ = false;
+    // 从WAL最后一个日志块找出已经用过的最大LSN，重启后接着往后分配，
+    // 页面头中持久化的LSN才能和新写的日志记录比较；空日志从1开始
+    lsn_t last_lsn = 0;
+    LogCursor tail(wal_file_.get(), wal_file_->GetBeginBlock(),
+                   wal_file_->GetEndBlock());
+    if (tail.SeekToLast()) {
+        last_lsn = std::max<lsn_t>(tail.GetRecord().GetLSN(), 0);
+    }
+    reserve_state_.store(PackReserveState(last_lsn + 1, 0, 0));
+    persistent_lsn_.store(last_lsn);
+
+    // 启动后台刷盘线程，负责组提交
+    flush_thread_running_ = true;
+    flush_thread_ = std::thread(&LogManager::BackgroundFlush, this);
 
-    LOG_DEBUG("LogManager initialized with buffer size: " << log_buffer_size_);
+    LOG_DEBUG("LogManager initialized with buffer size: "
+              << log_buffer_size_ << " x 2");
 }
 
 /**
@@ -52,10 +117,24 @@ LogManager::LogManager(DiskManager* disk_manager)
  * 确保所有缓冲区内容都已刷盘
  */
 LogManager::~LogManager() {
+    // 先停掉刷盘线程，它会写完所有缓冲区再退出
+    {
+        std::unique_lock<std::mutex> lock(latch_);
+        stop_flush_thread_ = true;
+    }
+    flush_cv_.notify_all();
+    if (flush_thread_.joinable()) {
+        flush_thread_.join();
+    }
+    flush_thread_running_ = false;
+    flush_done_cv_.notify_all();
+
     try {
-        // 如果缓冲区还有数据，先刷盘再销毁
-        if (log_buffer_offset_ > 0) {
-            FlushLogBuffer();
+        // 刷盘线程退出后如果还有遗留内容，自己写完
+        std::unique_lock<std::mutex> lock(latch_);
+        WriteSealedBuffer(&lock);
+        if (SealActiveBuffer()) {
+            WriteSealedBuffer(&lock);
         }
     } catch (const std::exception& e) {
         LOG_ERROR("Exception in LogManager destructor: " << e.what());
@@ -64,7 +143,9 @@ LogManager::~LogManager() {
     }
 
     // 释放缓冲区内存
-    delete[] log_buffer_;
+    for (auto& buffer : buffers_) {
+        delete[] buffer.data;
+    }
     LOG_DEBUG("LogManager destroyed");
 }
 
@@ -72,6 +153,14 @@ LogManager::~LogManager() {
  * 追加日志记录到缓冲区
  * @param log_record 要写入的日志记录
  * @return 分配给该记录的LSN，如果失败返回INVALID_LSN
+ *
+ * 实现思路：
+ * 1. 读取reserve_state_，算出记录在active缓冲区中的位置，
+ *    当前页面剩余空间不够时跳到下一页开头
+ * 2. 放得下就CAS推进偏移和LSN，成功后不持锁拷贝记录，
+ *    最后累加written表示拷贝完成
+ * 3. 放不下说明active满了：加锁等另一块缓冲区刷完，封存active并切换，
+ *    然后回到第1步重试
  */
 lsn_t LogManager::AppendLogRecord(LogRecord* log_record) {
     // 如果日志功能未启用或记录为空，直接返回
@@ -79,374 +168,441 @@ lsn_t LogManager::AppendLogRecord(LogRecord* log_record) {
         return INVALID_LSN;
     }
 
-    // 获取互斥锁，保证线程安全
-    std::unique_lock<std::mutex> lock(latch_);
-
-    // 分配新的LSN，使用原子操作确保唯一性
-    lsn_t lsn = next_lsn_.fetch_add(1);
-
     // 计算记录的各个部分大小
-    // header包含：记录类型 + 事务ID + 前一个LSN
-    size_t header_size =
-        sizeof(LogRecordType) + sizeof(txn_id_t) + sizeof(lsn_t);
+    // header包含：记录类型 + 事务ID + 前一个LSN + 本记录LSN
+    size_t header_size = LOG_RECORD_HEADER_SIZE;
     size_t record_data_size = log_record->GetLogRecordSize();
     size_t total_record_size = header_size + record_data_size;
     // 每条记录前还要存储记录长度(4字节)
     size_t total_size_with_length = sizeof(uint32_t) + total_record_size;
 
-    LOG_DEBUG("AppendLogRecord: LSN=" << lsn << ", type="
-                                      << static_cast<int>(log_record->GetType())
-                                      << ", txn=" << log_record->GetTxnId()
-                                      << ", size=" << total_size_with_length);
-
-    // 检查缓冲区是否有足够空间，如果不够就先刷盘
-    if (log_buffer_offset_ + total_size_with_length > log_buffer_size_) {
-        LOG_DEBUG("Log buffer full, flushing before append");
-        FlushLogBuffer();
+    // 记录不跨页，也不能占用页面末尾的校验值，放不进一个日志块的记录无法写入
+    if (total_size_with_length > LOG_BLOCK_DATA_SIZE) {
+        LOG_ERROR("AppendLogRecord: record of " << total_size_with_length
+                                                << " bytes exceeds log block");
+        return INVALID_LSN;
     }
 
-    // 开始序列化日志记录到缓冲区
-    char* buffer_ptr = log_buffer_ + log_buffer_offset_;
+    while (true) {
+        uint64_t state = reserve_state_.load(std::memory_order_acquire);
+        lsn_t lsn = ReserveStateLSN(state);
+        int index = ReserveStateIndex(state);
+        size_t offset = ReserveStateOffset(state);
 
-    // 1. 写入记录总长度
-    *reinterpret_cast<uint32_t*>(buffer_ptr) =
-        static_cast<uint32_t>(total_record_size);
-    buffer_ptr += sizeof(uint32_t);
+        // 当前页面放不下就从下一页开头写，跳过的部分保持为0
+        size_t start = offset;
+        if (offset % PAGE_SIZE + total_size_with_length > LOG_BLOCK_DATA_SIZE) {
+            start = (offset / PAGE_SIZE + 1) * PAGE_SIZE;
+        }
 
-    // 2. 写入记录类型
-    *reinterpret_cast<LogRecordType*>(buffer_ptr) = log_record->GetType();
-    buffer_ptr += sizeof(LogRecordType);
+        if (start + total_size_with_length <= log_buffer_size_) {
+            uint64_t next_state = PackReserveState(
+                lsn + 1, index, start + total_size_with_length);
+            if (!reserve_state_.compare_exchange_weak(
+                    state, next_state, std::memory_order_acq_rel)) {
+                continue;
+            }
 
-    // 3. 写入事务ID
-    *reinterpret_cast<txn_id_t*>(buffer_ptr) = log_record->GetTxnId();
-    buffer_ptr += sizeof(txn_id_t);
+            LOG_DEBUG("AppendLogRecord: LSN="
+                      << lsn << ", type="
+                      << static_cast<int>(log_record->GetType())
+                      << ", txn=" << log_record->GetTxnId()
+                      << ", size=" << total_size_with_length);
+
+            // 开始序列化日志记录到缓冲区
+            LogBuffer& buffer = buffers_[index];
+            char* buffer_ptr = buffer.data + start;
+
+            // 1. 写入记录总长度
+            *reinterpret_cast<uint32_t*>(buffer_ptr) =
+                static_cast<uint32_t>(total_record_size);
+            buffer_ptr += sizeof(uint32_t);
+
+            // 2. 写入记录类型
+            *reinterpret_cast<LogRecordType*>(buffer_ptr) =
+                log_record->GetType();
+            buffer_ptr += sizeof(LogRecordType);
+
+            // 3. 写入事务ID
+            *reinterpret_cast<txn_id_t*>(buffer_ptr) = log_record->GetTxnId();
+            buffer_ptr += sizeof(txn_id_t);
+
+            // 4. 写入前一个LSN（用于链接同一事务的日志记录）
+            *reinterpret_cast<lsn_t*>(buffer_ptr) = log_record->GetPrevLSN();
+            buffer_ptr += sizeof(lsn_t);
+
+            // 5. 写入本记录的LSN，恢复时用来和页面LSN比较
+            *reinterpret_cast<lsn_t*>(buffer_ptr) = lsn;
+            buffer_ptr += sizeof(lsn_t);
+            log_record->SetLSN(lsn);
+
+            // 6. 如果有额外数据，调用记录自己的序列化方法
+            if (record_data_size > 0) {
+                log_record->SerializeTo(buffer_ptr);
+            }
 
-    // 4. 写入前一个LSN（用于链接同一事务的日志记录）
-    *reinterpret_cast<lsn_t*>(buffer_ptr) = log_record->GetPrevLSN();
-    buffer_ptr += sizeof(lsn_t);
+            // 拷贝完成，刷盘线程等written追上封存偏移后才会写出
+            buffer.written.fetch_add(start + total_size_with_length - offset,
+                                     std::memory_order_release);
 
-    // 5. 如果有额外数据，调用记录自己的序列化方法
-    if (record_data_size > 0) {
-        log_record->SerializeTo(buffer_ptr);
-    }
+            STATS.RecordLogWrite(total_size_with_length);
+            return lsn;
+        }
 
-    // 更新缓冲区偏移量
-    log_buffer_offset_ += total_size_with_length;
+        // active缓冲区已满，切换到另一块
+        LOG_DEBUG("Log buffer " << index << " full, switching buffers");
+        std::unique_lock<std::mutex> lock(latch_);
+        int other = 1 - index;
+        flush_cv_.notify_one();
+        flush_done_cv_.wait(lock, [this, index, other] {
+            return buffers_[other].state == BufferState::FREE ||
+                   ReserveStateIndex(reserve_state_.load()) != index ||
+                   !flush_thread_running_;
+        });
+        if (ReserveStateIndex(reserve_state_.load()) != index) {
+            continue;  // 别的追加者已经切换过了
+        }
+        if (buffers_[other].state == BufferState::SEALED) {
+            // 刷盘线程已经停止，自己把另一块写完
+            WriteSealedBuffer(&lock);
+        }
+        if (SealActiveBuffer(index)) {
+            flush_cv_.notify_one();
+            flush_done_cv_.notify_all();
+        }
+    }
+}
 
-    STATS.RecordLogWrite(total_size_with_length);
+/**
+ * 分配一个不对应任何记录的LSN
+ * LSN和缓冲区位置打包在一起，这里只推进LSN部分
+ */
+lsn_t LogManager::GetNextLSN() {
+    uint64_t state = reserve_state_.load();
+    while (true) {
+        lsn_t lsn = ReserveStateLSN(state);
+        uint64_t next_state = PackReserveState(
+            lsn + 1, ReserveStateIndex(state), ReserveStateOffset(state));
+        if (reserve_state_.compare_exchange_weak(state, next_state)) {
+            return lsn;
+        }
+    }
+}
 
-    return lsn;
+lsn_t LogManager::GetLastReservedLSN() const {
+    return ReserveStateLSN(reserve_state_.load()) - 1;
 }
 
 /**
- * 强制刷盘操作，确保指定LSN之前的所有日志都持久化
+ * 等待日志持久化，确保指定LSN之前的所有日志都写入磁盘
  * @param lsn 需要持久化的LSN，-1表示刷新所有当前缓冲区内容
+ *
+ * 实现思路：
+ * 1. 目标LSN不超过已经分配的最大LSN，已经持久化就直接返回
+ * 2. 登记刷盘请求并唤醒后台线程，然后等待persistent_lsn_追上目标
+ * 3. 后台线程已经停止（析构阶段）时自己同步刷盘
+ * 4. 等待期间刷盘失败次数变化，说明这次刷盘失败，抛出异常
  */
 void LogManager::Flush(lsn_t lsn) {
     std::unique_lock<std::mutex> lock(latch_);
 
-    // 如果缓冲区为空，没有内容需要刷盘
-    if (log_buffer_offset_ == 0) {
-        LOG_DEBUG("Log buffer empty, nothing to flush");
+    lsn_t last_lsn = GetLastReservedLSN();
+    lsn_t target = (lsn == -1 || lsn > last_lsn) ? last_lsn : lsn;
+    if (persistent_lsn_.load() >= target) {
+        LOG_DEBUG("Log already persistent up to LSN " << target);
         return;
     }
 
-    LOG_DEBUG(
-        "Flushing log buffer to disk, buffer size: " << log_buffer_offset_);
+    uint64_t failures = flush_failures_;
+    if (flush_thread_running_) {
+        flush_requested_ = true;
+        flush_cv_.notify_one();
+        flush_done_cv_.wait(lock, [this, target, failures] {
+            return persistent_lsn_.load() >= target ||
+                   flush_failures_ != failures || !flush_thread_running_;
+        });
+    }
 
-    try {
-        // 执行实际的缓冲区刷盘操作
-        FlushLogBuffer();
-
-        // 更新持久化LSN标记
-        if (lsn != -1) {
-            persistent_lsn_.store(lsn);
-        } else {
-            // 如果没有指定LSN，就用当前最大的LSN减1
-            persistent_lsn_.store(next_lsn_.load() - 1);
+    if (persistent_lsn_.load() < target && flush_failures_ == failures) {
+        // 刷盘线程没有运行，自己把剩下的写完
+        WriteSealedBuffer(&lock);
+        if (SealActiveBuffer()) {
+            WriteSealedBuffer(&lock);
         }
+    }
 
-        STATS.RecordLogFlush();
-
-        LOG_DEBUG(
-            "Log flush completed, persistent LSN: " << persistent_lsn_.load());
-    } catch (const std::exception& e) {
-        LOG_ERROR("Exception during log flush: " << e.what());
-        throw;
+    if (flush_failures_ != failures) {
+        throw StorageException("Log flush failed before LSN " +
+                               std::to_string(target));
     }
 }
 
+bool LogManager::WaitForPersistentLSN(lsn_t lsn,
+                                      std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(latch_);
+    return flush_done_cv_.wait_for(lock, timeout, [this, lsn] {
+        return persistent_lsn_.load() >= lsn;
+    });
+}
+
+void LogManager::SetGroupCommitMaxWait(std::chrono::microseconds max_wait) {
+    std::unique_lock<std::mutex> lock(latch_);
+    group_commit_max_wait_ = max_wait;
+}
+
 /**
- * 内部方法：将日志缓冲区内容写入磁盘页面
- * 这里实现WAL的核心机制 - 先写日志再写数据
+ * 后台刷盘线程主循环
+ *
+ * 实现思路：
+ * 1. 等待封存的缓冲区、刷盘请求或者退出通知
+ * 2. 有封存的缓冲区就先写它（active写满时追加者封存的）
+ * 3. 否则是Flush请求：配置了最长等待时间时先等一会儿让更多提交进入
+ *    缓冲区，再封存active并写出，同一批提交共享一次写入和fsync
+ * 4. 每次写完唤醒所有等待者，它们自己判断目标LSN是否已经持久化
+ * 5. 退出前把active里剩下的内容也写完
  */
-void LogManager::FlushLogBuffer() {
-    // 如果缓冲区为空，直接返回
-    if (log_buffer_offset_ == 0) {
-        return;
+void LogManager::BackgroundFlush() {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (true) {
+        flush_cv_.wait(lock, [this] {
+            return flush_requested_ || stop_flush_thread_ ||
+                   FindSealedBuffer() >= 0;
+        });
+
+        if (FindSealedBuffer() < 0) {
+            if (flush_requested_) {
+                if (group_commit_max_wait_.count() > 0 && !stop_flush_thread_) {
+                    flush_cv_.wait_for(lock, group_commit_max_wait_,
+                                       [this] { return stop_flush_thread_; });
+                }
+                flush_requested_ = false;
+                if (!SealActiveBuffer()) {
+                    flush_done_cv_.notify_all();
+                    continue;
+                }
+            } else if (!SealActiveBuffer()) {
+                break;  // 收到退出通知并且没有剩余内容
+            }
+        }
+
+        WriteSealedBuffer(&lock);
     }
+}
 
-    try {
-        // 向disk_manager申请一个新的页面来存储日志
-        page_id_t log_page_id = disk_manager_->AllocatePage();
+/**
+ * 封存active缓冲区并切换到另一块
+ *
+ * 实现思路：
+ * 1. 一次CAS把reserve_state_切换到另一块缓冲区的偏移0，
+ *    之后新的追加都落到另一块，CAS之前成功的追加都在被封存的这块里
+ * 2. 记下封存时的偏移和最后一个LSN，交给WriteSealedBuffer
+ * 3. active为空时没有东西可写，没有在途的缓冲区时直接推进persistent_lsn_
+ *    （GetNextLSN分配的LSN没有对应的记录）
+ */
+bool LogManager::SealActiveBuffer(int expected_index) {
+    uint64_t state = reserve_state_.load();
+    while (true) {
+        int index = ReserveStateIndex(state);
+        size_t offset = ReserveStateOffset(state);
+        lsn_t next_lsn = ReserveStateLSN(state);
+        if (expected_index >= 0 && index != expected_index) {
+            return false;
+        }
+        if (offset == 0) {
+            if (FindSealedBuffer() < 0 && persistent_lsn_.load() < next_lsn - 1) {
+                persistent_lsn_.store(next_lsn - 1);
+            }
+            return false;
+        }
 
-        // 创建一个完整页面大小的缓冲区，确保写入完整页面
-        char page_buffer[PAGE_SIZE];
-        memset(page_buffer, 0, PAGE_SIZE);
+        int other = 1 - index;
+        if (buffers_[other].state != BufferState::FREE) {
+            return false;
+        }
+        if (!reserve_state_.compare_exchange_weak(
+                state, PackReserveState(next_lsn, other, 0))) {
+            continue;
+        }
 
-        // 将日志缓冲区的内容复制到页面缓冲区
-        memcpy(page_buffer, log_buffer_, log_buffer_offset_);
+        buffers_[index].end = offset;
+        buffers_[index].last_lsn = next_lsn - 1;
+        buffers_[index].state = BufferState::SEALED;
+        buffers_[other].state = BufferState::ACTIVE;
+        return true;
+    }
+}
 
-        // 通过disk_manager写入磁盘
-        disk_manager_->WritePage(log_page_id, page_buffer);
+int LogManager::FindSealedBuffer() const {
+    for (int i = 0; i < 2; i++) {
+        if (buffers_[i].state == BufferState::SEALED) {
+            return i;
+        }
+    }
+    return -1;
+}
 
-        // 记录日志页面ID
-        log_page_ids_.push_back(log_page_id);
+/**
+ * 把封存的缓冲区写入WAL文件
+ * 这里实现WAL的核心机制 - 先写日志再写数据
+ *
+ * 实现思路：
+ * 1. 释放latch_，等所有已经预留空间的追加者拷贝完成
+ * 2. 用到的页面填好末尾的校验值，作为日志块一次追加到WAL文件，然后fdatasync
+ * 3. 清零缓冲区，重新加锁，更新persistent_lsn_并把缓冲区标记为FREE
+ * 4. 写入失败时记录失败次数，等待这块缓冲区的提交者会收到异常
+ */
+void LogManager::WriteSealedBuffer(std::unique_lock<std::mutex>* lock) {
+    int index = FindSealedBuffer();
+    if (index < 0) {
+        return;
+    }
+    LogBuffer& buffer = buffers_[index];
+    size_t end = buffer.end;
+    lsn_t last_lsn = buffer.last_lsn;
+    size_t num_pages = (end + PAGE_SIZE - 1) / PAGE_SIZE;
 
-        LOG_DEBUG("Log buffer flushed to page "
-                  << log_page_id << ", bytes written: " << log_buffer_offset_);
+    flush_in_progress_ = true;
+    lock->unlock();
 
-        // 重置缓冲区状态，准备接收新的日志记录
-        log_buffer_offset_ = 0;
-        memset(log_buffer_, 0, log_buffer_size_);
+    while (buffer.written.load(std::memory_order_acquire) < end) {
+        std::this_thread::yield();
+    }
 
-        // 记录当前使用的日志页面ID
-        current_log_page_id_ = log_page_id;
+    bool success = true;
+    double flush_ms = 0.0;
+    try {
+        TRACE_SPAN_NAMED(flush_span, "log", "LogManager::FlushLogBuffer");
+        TRACE_SPAN_SET_ARG(flush_span, static_cast<uint64_t>(end));
+        Statistics::PerformanceTimer flush_timer;
+        // 每个日志块填好末尾的校验值，顺序追加到WAL末尾并落盘
+        for (size_t i = 0; i < num_pages; i++) {
+            char* block = buffer.data + i * PAGE_SIZE;
+            uint32_t checksum = Crc32c(block, LOG_BLOCK_DATA_SIZE);
+            std::memcpy(block + LOG_BLOCK_DATA_SIZE, &checksum,
+                        sizeof(checksum));
+        }
+        wal_file_->Append(buffer.data, num_pages);
+        wal_file_->Sync();
+        flush_ms = flush_timer.GetElapsedMs();
 
+        LOG_DEBUG("Log buffer " << index << " flushed, " << num_pages
+                                << " blocks, bytes written: " << end);
     } catch (const std::exception& e) {
         LOG_ERROR("Failed to flush log buffer: " << e.what());
-        throw;
+        success = false;
+    }
+
+    // 重置缓冲区状态，准备接收新的日志记录
+    memset(buffer.data, 0, num_pages * PAGE_SIZE);
+    buffer.written.store(0);
+
+    lock->lock();
+    flush_in_progress_ = false;
+    if (success) {
+        if (persistent_lsn_.load() < last_lsn) {
+            persistent_lsn_.store(last_lsn);
+        }
+        flush_count_++;
+        STATS.RecordLogFlush(flush_ms);
+    } else {
+        flush_failures_++;
     }
+    buffer.end = 0;
+    buffer.last_lsn = INVALID_LSN;
+    buffer.state = BufferState::FREE;
+    flush_done_cv_.notify_all();
 }
 
 /**
- * 清空日志文件，通常在截断日志时调用
- * 这将删除所有旧的日志记录，保留从指定LSN开始的记录
+ * 截断日志，通常在检查点之后调用
+ * 这将删除所有旧的日志记录，缓冲区中尚未写出的记录会保留下来
  */
 void LogManager::TruncateLog(lsn_t checkpoint_lsn) {
-    std::unique_lock<std::mutex> lock(latch_);
-    
-    if (checkpoint_lsn <= last_checkpoint_lsn_) {
-        LOG_DEBUG("TruncateLog: checkpoint_lsn " << checkpoint_lsn 
-                  << " <= last_checkpoint_lsn " << last_checkpoint_lsn_ 
-                  << ", skipping truncation");
-        return;
+    // 先把当前缓冲区的内容全部刷盘
+    Flush();
+
+    {
+        std::unique_lock<std::mutex> lock(latch_);
+
+        if (checkpoint_lsn <= last_checkpoint_lsn_) {
+            LOG_DEBUG("TruncateLog: checkpoint_lsn " << checkpoint_lsn
+                      << " <= last_checkpoint_lsn " << last_checkpoint_lsn_
+                      << ", skipping truncation");
+            return;
+        }
+
+        LOG_INFO("TruncateLog: Truncating log up to LSN " << checkpoint_lsn);
+
+        // 等刷盘线程写完手上的缓冲区，避免页面在写入过程中被释放
+        flush_done_cv_.wait(lock, [this] { return !flush_in_progress_; });
+
+        // 清空日志文件
+        ClearLogFile();
+
+        // 重置LSN跟踪
+        last_checkpoint_lsn_ = checkpoint_lsn;
     }
-    
-    LOG_INFO("TruncateLog: Truncating log up to LSN " << checkpoint_lsn);
-    
-    // 先刷新当前缓冲区
-    if (log_buffer_offset_ > 0) {
-        FlushLogBuffer();
+
+    // 截断后的日志以一条CHECKPOINT记录开头，重启时据此接着分配LSN
+    CheckpointLogRecord checkpoint_record;
+    lsn_t lsn = AppendLogRecord(&checkpoint_record);
+    if (lsn != INVALID_LSN) {
+        Flush(lsn);
     }
-    
-    // 清空日志文件
-    ClearLogFile();
-    
-    // 重置LSN跟踪
-    last_checkpoint_lsn_ = checkpoint_lsn;
-    log_page_ids_.clear();
 
     STATS.RecordLogTruncation();
-    
+
     LOG_INFO("TruncateLog: Log truncation completed");
 }
 
+/**
+ * 回收所有已经写出的WAL段，调用者需要保证没有正在进行的刷盘
+ * 缓冲区中还没写出的记录不受影响
+ */
 void LogManager::ClearLogFile() {
     LOG_INFO("ClearLogFile: Clearing log file");
-    
-    // 释放所有日志页面
-    for (page_id_t page_id : log_page_ids_) {
-        try {
-            disk_manager_->DeallocatePage(page_id);
-            LOG_DEBUG("ClearLogFile: Deallocated log page " << page_id);
-        } catch (const std::exception& e) {
-            LOG_WARN("ClearLogFile: Failed to deallocate page " << page_id 
-                     << ": " << e.what());
-        }
-    }
-    
-    // 清空缓冲区
-    log_buffer_offset_ = 0;
-    memset(log_buffer_, 0, log_buffer_size_);
-    
-    // 重置页面跟踪
-    log_page_ids_.clear();
-    current_log_page_id_ = 0;
-    
-    LOG_INFO("ClearLogFile: Log file cleared, " << log_page_ids_.size() 
-             << " pages deallocated");
+
+    size_t cleared = wal_file_->GetSize();
+    wal_file_->Truncate();
+
+    LOG_INFO("ClearLogFile: Log file cleared, " << cleared
+             << " bytes released");
+}
+
+void LogManager::RemoveLogFiles(const std::string& log_file) {
+    WalFile::RemoveAll(log_file);
 }
 
 size_t LogManager::GetLogFileSize() {
     std::unique_lock<std::mutex> lock(latch_);
-    return log_page_ids_.size() * PAGE_SIZE + log_buffer_offset_;
+    return wal_file_->GetSize() + ReserveStateOffset(reserve_state_.load());
 }
 
 /**
- * 后台异步刷盘方法（预留接口）
- * 可以实现定期自动刷盘，避免缓冲区积累过多数据
+ * 创建日志游标
+ * 等正在进行的刷盘结束，游标的范围是此时WAL中已经写出的所有日志块
  */
-void LogManager::BackgroundFlush() {
-    // 目前暂时不实现，可以后续添加定时刷盘逻辑
+std::unique_ptr<LogCursor> LogManager::CreateLogCursor() {
+    std::unique_lock<std::mutex> lock(latch_);
+    flush_done_cv_.wait(lock, [this] { return !flush_in_progress_; });
+    return std::make_unique<LogCursor>(wal_file_.get(),
+                                       wal_file_->GetBeginBlock(),
+                                       wal_file_->GetEndBlock());
 }
 
 /**
- * 从磁盘读取所有日志记录，主要用于崩溃恢复
- * 扫描所有磁盘页面，解析其中的日志记录
+ * 从磁盘读取所有日志记录
+ * 用游标顺序扫描WAL，把每条记录复制一份；恢复时直接用游标，避免整个日志进内存
  * @return 包含所有日志记录的vector
  */
 std::vector<std::unique_ptr<LogRecord>> LogManager::ReadLogRecords() {
-    std::unique_lock<std::mutex> lock(latch_);
     std::vector<std::unique_ptr<LogRecord>> log_records;
-
-    // 获取磁盘上的总页面数，需要扫描所有页面找日志
-    int total_pages = disk_manager_->GetNumPages();
-    LOG_DEBUG("ReadLogRecords: Scanning " << total_pages
-                                          << " pages for log records");
-
-    if (total_pages <= 0) {
-        LOG_DEBUG("No pages on disk, no log records to read");
-        return log_records;
-    }
-
-    // 逐页扫描寻找日志记录
-    for (page_id_t page_id = 0; page_id < total_pages; page_id++) {
-        try {
-            char page_buffer[PAGE_SIZE];
-            disk_manager_->ReadPage(page_id, page_buffer);
-
-            // 简单的启发式判断：检查页面是否包含有效的日志记录
-            // 通过检查第一个记录长度是否合理来判断
-            if (page_id > 0) {  // 跳过第一个页面（通常是系统元数据页面）
-                uint32_t first_record_size =
-                    *reinterpret_cast<uint32_t*>(page_buffer);
-                if (first_record_size == 0 || first_record_size > PAGE_SIZE) {
-                    continue;  // 这个页面可能不是日志页面
-                }
-            }
-
-            // 解析当前页面中的所有日志记录
-            size_t offset = 0;
-            int records_in_page = 0;
-
-            // 按照我们的日志格式逐条解析记录
-            while (offset + sizeof(uint32_t) <= PAGE_SIZE) {
-                // 读取记录长度
-                uint32_t record_size =
-                    *reinterpret_cast<uint32_t*>(page_buffer + offset);
-
-                // 检查记录长度的合理性
-                if (record_size == 0 || record_size > PAGE_SIZE ||
-                    offset + sizeof(uint32_t) + record_size > PAGE_SIZE) {
-                    break;  // 到达页面末尾或遇到无效记录
-                }
-
-                offset += sizeof(uint32_t);
-
-                // 确保有足够空间读取记录头部信息
-                if (offset + sizeof(LogRecordType) + sizeof(txn_id_t) +
-                        sizeof(lsn_t) >
-                    PAGE_SIZE) {
-                    break;
-                }
-
-                // 解析记录头部：类型、事务ID、前一个LSN
-                LogRecordType type =
-                    *reinterpret_cast<LogRecordType*>(page_buffer + offset);
-                offset += sizeof(LogRecordType);
-
-                txn_id_t txn_id =
-                    *reinterpret_cast<txn_id_t*>(page_buffer + offset);
-                offset += sizeof(txn_id_t);
-
-                lsn_t prev_lsn =
-                    *reinterpret_cast<lsn_t*>(page_buffer + offset);
-                offset += sizeof(lsn_t);
-
-                // 根据记录类型创建对应的日志记录对象
-                std::unique_ptr<LogRecord> record;
-                switch (type) {
-                    case LogRecordType::BEGIN:
-                        record = std::make_unique<BeginLogRecord>(txn_id);
-                        LOG_DEBUG("Found BEGIN record for txn " << txn_id);
-                        break;
-                    case LogRecordType::COMMIT:
-                        record =
-                            std::make_unique<CommitLogRecord>(txn_id, prev_lsn);
-                        LOG_DEBUG("Found COMMIT record for txn " << txn_id);
-                        break;
-                    case LogRecordType::ABORT:
-                        record =
-                            std::make_unique<AbortLogRecord>(txn_id, prev_lsn);
-                        LOG_DEBUG("Found ABORT record for txn " << txn_id);
-                        break;
-                    case LogRecordType::INSERT:
-                        LOG_DEBUG("Found INSERT record for txn " << txn_id);
-                        {
-                            size_t remaining_size =
-                                record_size - sizeof(LogRecordType) -
-                                sizeof(txn_id_t) - sizeof(lsn_t);
-                            offset += remaining_size;
-                            record = std::make_unique<BeginLogRecord>(
-                                txn_id);  // 简化处理
-                        }
-                        break;
-                    case LogRecordType::UPDATE:
-                        LOG_DEBUG("Found UPDATE record for txn " << txn_id);
-                        {
-                            size_t remaining_size =
-                                record_size - sizeof(LogRecordType) -
-                                sizeof(txn_id_t) - sizeof(lsn_t);
-                            offset += remaining_size;
-                            record = std::make_unique<BeginLogRecord>(
-                                txn_id);  // 简化处理
-                        }
-                        break;
-                    case LogRecordType::DELETE:
-                        LOG_DEBUG("Found DELETE record for txn " << txn_id);
-                        {
-                            size_t remaining_size =
-                                record_size - sizeof(LogRecordType) -
-                                sizeof(txn_id_t) - sizeof(lsn_t);
-                            offset += remaining_size;
-                            record = std::make_unique<BeginLogRecord>(
-                                txn_id);  // 简化处理
-                        }
-                        break;
-                    default:
-                        LOG_DEBUG("Unknown log record type: "
-                                  << static_cast<int>(type));
-                        // 跳过未知类型的记录，继续处理后续记录
-                        {
-                            size_t remaining_size =
-                                record_size - sizeof(LogRecordType) -
-                                sizeof(txn_id_t) - sizeof(lsn_t);
-                            offset += remaining_size;
-                        }
-                        continue;
-                }
-
-                // 将解析出的记录添加到结果集合
-                if (record) {
-                    log_records.push_back(std::move(record));
-                    records_in_page++;
-                }
-            }
-
-            if (records_in_page > 0) {
-                LOG_DEBUG("Found " << records_in_page << " records in page "
-                                   << page_id);
-            }
-
-        } catch (const std::exception& e) {
-            LOG_DEBUG("Exception reading page " << page_id << ": " << e.what());
-            continue;  // 跳过有问题的页面，继续处理其他页面
-        }
+    auto cursor = CreateLogCursor();
+    for (bool ok = cursor->SeekToFirst(); ok; ok = cursor->Next()) {
+        log_records.push_back(cursor->CloneRecord());
     }
 
-    LOG_DEBUG("ReadLogRecords: Found " << log_records.size()
-                                       << " total log records");
+    LOG_DEBUG("ReadLogRecords: Total records found: " << log_records.size());
     return log_records;
 }
 
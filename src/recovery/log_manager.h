@@ -8,13 +8,17 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <future>
 #include <mutex>
 #include <queue>
+#include <thread>
 
 #include "common/config.h"
+#include "recovery/log_cursor.h"
 #include "recovery/log_record.h"
+#include "recovery/wal_file.h"
 #include "storage/disk_manager.h"
 
 namespace SimpleRDBMS {
@@ -30,14 +34,48 @@ namespace SimpleRDBMS {
  * 5. 线程安全的并发访问控制
  *
  * WAL核心原则：在数据页面写入磁盘之前，相关的日志记录必须先写入磁盘
+ *
+ * 组提交（group commit）：
+ * - 后台刷盘线程负责所有的日志写入和fsync
+ * - Flush(lsn)只是登记"需要lsn持久化"并等待，不自己做I/O
+ * - 刷盘线程一次把缓冲区里积累的所有记录写出去，同一时间段内提交的
+ *   多个事务共享一次写入和fsync
+ * - 可以配置最长等待时间，让刷盘线程在开始写之前再等一小会儿，
+ *   凑更多的提交；默认为0，即正在刷盘期间到达的提交自然成组
+ *
+ * 双缓冲：
+ * - 两块同样大小的缓冲区，一块接收新记录（active），另一块由刷盘线程写出
+ * - 追加记录的快速路径只做一次CAS：reserve_state_把下一个LSN、active
+ *   缓冲区下标和写入偏移打包在一个64位原子变量里，LSN和缓冲区位置一起分配，
+ *   保证缓冲区中的记录按LSN顺序排列；拷贝记录内容不持有任何锁
+ * - active写满时由追加者把它封存（seal）并切换到另一块，
+ *   只有另一块还在刷盘时追加者才需要等待
+ * - 记录不跨越页面边界，页面剩余空间放不下时跳到下一页开头，
+ *   磁盘上每个日志页面都可以独立解析
+ *
+ * 存储：日志写入专用的分段WAL文件（WalFile），和数据文件完全分开，
+ * 每次刷盘都是在日志末尾的顺序追加
  */
 class LogManager {
    public:
     /**
      * 构造函数
-     * @param disk_manager 磁盘管理器指针，用于实际的页面I/O操作
+     * @param log_file WAL段文件的路径前缀，段文件为"<log_file>.000001"……
+     * @param buffer_size 每块日志缓冲区的大小，向上取整到PAGE_SIZE的倍数
+     * @param segment_size WAL段文件大小
+     */
+    explicit LogManager(const std::string& log_file,
+                        size_t buffer_size = LOG_BUFFER_SIZE,
+                        size_t segment_size = LOG_SEGMENT_SIZE);
+
+    /**
+     * 构造函数
+     * @param disk_manager 磁盘管理器指针，WAL段文件放在它的文件旁边，
+     *                     以它的文件名作为路径前缀；日志不会写入它本身
+     * @param buffer_size 每块日志缓冲区的大小，向上取整到PAGE_SIZE的倍数
      */
-    explicit LogManager(DiskManager* disk_manager);
+    explicit LogManager(DiskManager* disk_manager,
+                        size_t buffer_size = LOG_BUFFER_SIZE);
 
     /**
      * 析构函数
@@ -49,21 +87,38 @@ class LogManager {
      * 追加日志记录到缓冲区
      * @param log_record 要写入的日志记录指针
      * @return 分配给该记录的LSN，失败时返回INVALID_LSN
+     *
+     * 记录连同长度字段不能超过一个页面
      */
     lsn_t AppendLogRecord(LogRecord* log_record);
 
     /**
-     * 强制将日志缓冲区刷盘
+     * 等待日志持久化
      * @param lsn 需要确保持久化的LSN，默认-1表示刷新所有当前缓冲区内容
+     *
+     * 唤醒后台刷盘线程并阻塞到lsn持久化为止；lsn已经持久化时立即返回。
+     * 刷盘失败时抛出StorageException
      */
     void Flush(lsn_t lsn = -1);
 
+    /**
+     * 设置组提交的最长等待时间
+     * @param max_wait 刷盘线程收到请求后最多再等多久才开始写，0表示不等待
+     */
+    void SetGroupCommitMaxWait(std::chrono::microseconds max_wait);
+
+    /**
+     * 获取实际执行的刷盘次数（每次包含一次写入和一次fsync）
+     * 和提交次数对比可以看出组提交的效果
+     */
+    uint64_t GetFlushCount() const { return flush_count_.load(); }
+
     /**
      * 获取下一个可用的LSN
      * @return 新分配的LSN值
      * 注意：这个方法会原子性地递增LSN计数器
      */
-    lsn_t GetNextLSN() { return next_lsn_.fetch_add(1); }
+    lsn_t GetNextLSN();
 
     /**
      * 获取已持久化到磁盘的最大LSN
@@ -71,12 +126,34 @@ class LogManager {
      */
     lsn_t GetPersistentLSN() const { return persistent_lsn_.load(); }
 
+    /**
+     * 等待日志持久化到指定LSN，不主动触发刷盘
+     * WAL发送线程用它等待新的日志，提交和后台刷盘推进persistent_lsn_
+     * @return 超时之前persistent_lsn_达到lsn时返回true
+     */
+    bool WaitForPersistentLSN(lsn_t lsn, std::chrono::milliseconds timeout);
+
+    /**
+     * 获取已经分配出去的最大LSN，不分配新的LSN
+     * 模糊检查点用它记下开始收集时的日志位置
+     */
+    lsn_t GetLastReservedLSN() const;
+
     /**
      * 从磁盘读取所有日志记录
-     * @return 包含所有日志记录的vector，主要用于崩溃恢复
+     * @return 包含所有日志记录的vector
+     * 每条记录一个对象，日志很大时占用大量内存，恢复请使用CreateLogCursor
      */
     std::vector<std::unique_ptr<LogRecord>> ReadLogRecords();
 
+    /**
+     * 创建日志游标，在已经写出的日志上正向或逆向流式读取
+     * @return 游标，只能看到创建时已经写入WAL的记录
+     *
+     * 游标只缓存一个日志块，内存占用和日志长度无关
+     */
+    std::unique_ptr<LogCursor> CreateLogCursor();
+
     /**
      * 启用或禁用日志记录功能
      * @param enable true启用，false禁用
@@ -90,11 +167,23 @@ class LogManager {
     void TruncateLog(lsn_t checkpoint_lsn);
 
     /**
-     * 清除日志文件，释放所有日志页面
+     * 清除日志文件，回收所有已写出的WAL段
      * 主要用于系统重启或清理操作
      */
     void ClearLogFile();
 
+    /** 获取底层的WAL文件 */
+    const WalFile* GetWalFile() const { return wal_file_.get(); }
+
+    /**
+     * 删除log_file对应的所有WAL段文件
+     * 用于测试清理以及重建数据库
+     */
+    static void RemoveLogFiles(const std::string& log_file);
+
+    /** 获取每块日志缓冲区的大小 */
+    size_t GetBufferSize() const { return log_buffer_size_; }
+
     /**
      * 获取当前日志文件大小
      * @return 日志文件的总字节数
@@ -104,25 +193,46 @@ class LogManager {
    private:
     // ========== 核心组件 ==========
 
-    /** 磁盘管理器指针，负责实际的页面读写 */
-    DiskManager* disk_manager_;
+    /** WAL文件，负责日志块的顺序追加和读取 */
+    std::unique_ptr<WalFile> wal_file_;
 
     // ========== 日志缓冲区管理 ==========
 
-    /** 日志缓冲区指针，用于暂存日志记录 */
-    char* log_buffer_;
+    /** 缓冲区状态 */
+    enum class BufferState { FREE, ACTIVE, SEALED };
+
+    /** 一块日志缓冲区 */
+    struct LogBuffer {
+        /** 缓冲区内存，大小为log_buffer_size_ */
+        char* data{nullptr};
+
+        /** 已经拷贝完成的字节数（包括跳页留下的空白），追加者拷贝完后累加 */
+        std::atomic<size_t> written{0};
+
+        /** 封存时的结束偏移，受latch_保护 */
+        size_t end{0};
+
+        /** 缓冲区中最后一条记录的LSN，受latch_保护 */
+        lsn_t last_lsn{INVALID_LSN};
 
-    /** 缓冲区总大小，通常为一个页面大小 */
+        /** 缓冲区状态，受latch_保护 */
+        BufferState state{BufferState::FREE};
+    };
+
+    /** 双缓冲 */
+    LogBuffer buffers_[2];
+
+    /** 每块缓冲区的大小，PAGE_SIZE的整数倍 */
     size_t log_buffer_size_;
 
-    /** 当前缓冲区使用的偏移量，指示下一条记录的写入位置 */
-    size_t log_buffer_offset_;
+    /**
+     * 追加位置：高32位是下一个LSN，第31位是active缓冲区下标，
+     * 低31位是active缓冲区中的写入偏移
+     */
+    std::atomic<uint64_t> reserve_state_{0};
 
     // ========== LSN跟踪管理 ==========
 
-    /** 下一个要分配的LSN，使用原子变量保证线程安全 */
-    std::atomic<lsn_t> next_lsn_{0};
-
     /** 已持久化到磁盘的最大LSN，用于恢复时确定重做起点 */
     std::atomic<lsn_t> persistent_lsn_{INVALID_LSN};
 
@@ -131,38 +241,69 @@ class LogManager {
     /** 互斥锁，保护缓冲区和其他共享资源的并发访问 */
     std::mutex latch_;
 
-    /** 条件变量，用于协调刷盘操作（预留接口） */
+    /** 条件变量，唤醒后台刷盘线程 */
     std::condition_variable flush_cv_;
 
+    /** 条件变量，刷盘完成后唤醒等待的提交者 */
+    std::condition_variable flush_done_cv_;
+
     // ========== 后台处理控制 ==========
 
-    /** 后台刷盘线程运行标志（预留接口，当前未使用） */
+    /** 后台刷盘线程运行标志 */
     std::atomic<bool> flush_thread_running_{false};
 
+    /** 后台刷盘线程 */
+    std::thread flush_thread_;
+
+    /** 是否有等待中的刷盘请求，受latch_保护 */
+    bool flush_requested_{false};
+
+    /** 通知刷盘线程退出，受latch_保护 */
+    bool stop_flush_thread_{false};
+
+    /** 组提交最长等待时间，受latch_保护 */
+    std::chrono::microseconds group_commit_max_wait_{0};
+
+    /** 刷盘线程正在写封存的缓冲区（此时不持有latch_），受latch_保护 */
+    bool flush_in_progress_{false};
+
+    /** 后台刷盘失败的次数，等待者据此判断自己等的那次刷盘是否失败 */
+    uint64_t flush_failures_{0};
+
+    /** 刷盘次数统计 */
+    std::atomic<uint64_t> flush_count_{0};
+
     // ========== 功能控制标志 ==========
 
     /** 日志功能启用标志，可用于性能测试时临时关闭日志 */
     bool enable_logging_{true};
 
-    /** 当前正在使用的日志页面ID，用于跟踪日志文件增长 */
-    page_id_t current_log_page_id_{0};
-
-    /** 日志页面ID列表，记录所有已写入的日志页面 */
-    std::vector<page_id_t> log_page_ids_;
     /** 最后一个检查点LSN，用于日志截断和恢复 */
     lsn_t last_checkpoint_lsn_{INVALID_LSN};
 
     // ========== 内部辅助方法 ==========
 
     /**
-     * 将缓冲区内容写入磁盘页面
+     * 封存active缓冲区并切换到另一块，调用者必须持有latch_
+     * 另一块缓冲区必须是FREE状态
+     * @param expected_index 只在active仍是这块缓冲区时才封存，-1表示不检查
+     * @return 确实封存了一块非空缓冲区时返回true
+     */
+    bool SealActiveBuffer(int expected_index = -1);
+
+    /**
+     * 把封存的缓冲区追加到WAL文件并fdatasync，调用者必须持有lock
+     * I/O期间释放lock，追加者可以继续写active缓冲区
      * 这是WAL机制的核心实现，确保日志先于数据写入磁盘
      */
-    void FlushLogBuffer();
+    void WriteSealedBuffer(std::unique_lock<std::mutex>* lock);
+
+    /** 返回处于SEALED状态的缓冲区下标，没有时返回-1，调用者必须持有latch_ */
+    int FindSealedBuffer() const;
 
     /**
-     * 后台异步刷盘方法（预留接口）
-     * 可用于实现定期自动刷盘，减少同步刷盘的性能影响
+     * 后台刷盘线程主循环
+     * 等待刷盘请求，把缓冲区中积累的记录一次写出，再唤醒所有等待者
      */
     void BackgroundFlush();
 };
@@ -7,6 +7,7 @@
 
 #include "recovery/log_record.h"
 
+#include <algorithm>
 #include <memory>
 
 namespace SimpleRDBMS {
@@ -15,50 +16,127 @@ namespace SimpleRDBMS {
  * 从buffer中反序列化出LogRecord对象
  * 这是个工厂方法，根据log type创建对应的具体log record
  *
+ * 实现思路：
+ * 1. 格式和LogManager写进日志块的一样：长度字段、记录头（类型、事务ID、
+ *    前一个LSN、本记录LSN），之后是记录自己的数据
+ * 2. 长度字段超出buffer、数据短于类型要求的最小长度时按损坏处理
+ * 3. tuple要有schema才能解析，INSERT/UPDATE只保留原始字节，
+ *    DELETE的redo/undo不需要tuple内容，只解析RID
+ *
  * @param buffer 包含序列化数据的缓冲区
+ * @param size buffer的字节数
  * @return 反序列化得到的LogRecord智能指针，失败时返回nullptr
  */
-std::unique_ptr<LogRecord> LogRecord::DeserializeFrom(const char* buffer) {
-    // 跳过size字段，这个在LogManager那边已经用过了
-    buffer += sizeof(size_t);
+std::unique_ptr<LogRecord> LogRecord::DeserializeFrom(const char* buffer,
+                                                      size_t size) {
+    auto read = [](const char* data, auto* value) {
+        std::memcpy(value, data, sizeof(*value));
+    };
 
-    // 读取log record的类型，用来决定创建哪种具体的record
-    LogRecordType type = *reinterpret_cast<const LogRecordType*>(buffer);
-    buffer += sizeof(LogRecordType);
+    if (size < sizeof(uint32_t) + LOG_RECORD_HEADER_SIZE) {
+        return nullptr;
+    }
+    uint32_t record_size;
+    read(buffer, &record_size);
+    if (record_size < LOG_RECORD_HEADER_SIZE ||
+        sizeof(uint32_t) + record_size > size) {
+        return nullptr;
+    }
+    buffer += sizeof(uint32_t);
 
-    // 读取事务ID，所有log record都有这个字段
-    txn_id_t txn_id = *reinterpret_cast<const txn_id_t*>(buffer);
+    LogRecordType type;
+    txn_id_t txn_id;
+    lsn_t prev_lsn;
+    lsn_t lsn;
+    read(buffer, &type);
+    buffer += sizeof(LogRecordType);
+    read(buffer, &txn_id);
     buffer += sizeof(txn_id_t);
-
-    // 读取前一个LSN，用于构建undo chain
-    lsn_t prev_lsn = *reinterpret_cast<const lsn_t*>(buffer);
+    read(buffer, &prev_lsn);
+    buffer += sizeof(lsn_t);
+    read(buffer, &lsn);
     buffer += sizeof(lsn_t);
 
-    // 根据log type创建对应的log record对象
+    const char* body = buffer;
+    size_t body_size = record_size - LOG_RECORD_HEADER_SIZE;
+    constexpr size_t rid_size = sizeof(page_id_t) + sizeof(slot_offset_t);
+    RID rid{};
+    if (body_size >= rid_size) {
+        read(body, &rid.page_id);
+        read(body + sizeof(page_id_t), &rid.slot_num);
+    }
+
+    std::unique_ptr<LogRecord> record;
     switch (type) {
         case LogRecordType::BEGIN:
-            // BEGIN log比较简单，只需要txn_id
-            return std::make_unique<BeginLogRecord>(txn_id);
-
+            record = std::make_unique<BeginLogRecord>(txn_id);
+            break;
         case LogRecordType::COMMIT:
-            // COMMIT log需要prev_lsn来链接之前的操作
-            return std::make_unique<CommitLogRecord>(txn_id, prev_lsn);
-
+            record = std::make_unique<CommitLogRecord>(txn_id, prev_lsn);
+            break;
         case LogRecordType::ABORT:
-            // ABORT log类似COMMIT，也需要链接信息
-            return std::make_unique<AbortLogRecord>(txn_id, prev_lsn);
-
+            record = std::make_unique<AbortLogRecord>(txn_id, prev_lsn);
+            break;
+        case LogRecordType::CHECKPOINT: {
+            auto checkpoint = std::make_unique<CheckpointLogRecord>();
+            if (!checkpoint->DeserializePayload(body, body_size)) {
+                return nullptr;
+            }
+            record = std::move(checkpoint);
+            break;
+        }
         case LogRecordType::INSERT:
+            if (body_size < rid_size) {
+                return nullptr;
+            }
+            record = std::make_unique<InsertLogRecord>(
+                txn_id, prev_lsn, rid, body + rid_size, body_size - rid_size);
+            break;
         case LogRecordType::UPDATE:
+            if (body_size < rid_size) {
+                return nullptr;
+            }
+            record = std::make_unique<UpdateLogRecord>(
+                txn_id, prev_lsn, rid, body + rid_size, body_size - rid_size);
+            break;
+        case LogRecordType::UPDATE_DELTA:
+            if (body_size < rid_size) {
+                return nullptr;
+            }
+            record = std::make_unique<UpdateDeltaLogRecord>(
+                txn_id, prev_lsn, rid, body + rid_size, body_size - rid_size);
+            break;
+        case LogRecordType::MULTI_INSERT:
+            if (body_size < rid_size) {
+                return nullptr;
+            }
+            record = std::make_unique<MultiInsertLogRecord>(
+                txn_id, prev_lsn, rid, body + rid_size, body_size - rid_size);
+            break;
         case LogRecordType::DELETE:
-            // DML操作的log record比较复杂，涉及到具体的数据
-            // 目前还没实现，等record layer完善后再补充
-            return nullptr;
-
+            if (body_size < rid_size) {
+                return nullptr;
+            }
+            record = std::make_unique<DeleteLogRecord>(txn_id, prev_lsn, rid,
+                                                       Tuple());
+            break;
+        case LogRecordType::NEW_PAGE: {
+            if (body_size < 2 * sizeof(page_id_t)) {
+                return nullptr;
+            }
+            page_id_t page_id;
+            page_id_t prev_page_id;
+            read(body, &page_id);
+            read(body + sizeof(page_id_t), &prev_page_id);
+            record = std::make_unique<NewPageLogRecord>(page_id, prev_page_id);
+            break;
+        }
         default:
             // 未知的log type，直接返回空
             return nullptr;
     }
+    record->SetLSN(lsn);
+    return record;
 }
 
 /**
@@ -77,7 +155,11 @@ void InsertLogRecord::SerializeTo(char* buffer) const {
     buffer += sizeof(slot_offset_t);
 
     // 最后写入完整的tuple数据，undo时需要知道插入了什么
-    tuple_.SerializeTo(buffer);
+    if (!image_.empty()) {
+        std::memcpy(buffer, image_.data(), image_.size());
+    } else {
+        tuple_.SerializeTo(buffer);
+    }
 }
 
 /**
@@ -94,6 +176,12 @@ void UpdateLogRecord::SerializeTo(char* buffer) const {
     *reinterpret_cast<slot_offset_t*>(buffer) = rid_.slot_num;
     buffer += sizeof(slot_offset_t);
 
+    // 从日志读出的记录原样写回两个镜像
+    if (!images_.empty()) {
+        std::memcpy(buffer, images_.data(), images_.size());
+        return;
+    }
+
     // 先写old tuple，undo时恢复用
     old_tuple_.SerializeTo(buffer);
     buffer += old_tuple_.GetSerializedSize();
@@ -102,6 +190,258 @@ void UpdateLogRecord::SerializeTo(char* buffer) const {
     new_tuple_.SerializeTo(buffer);
 }
 
+namespace {
+
+/** 差异段头：偏移、旧长度、新长度 */
+constexpr size_t DELTA_RUN_HEADER_SIZE = 3 * sizeof(uint16_t);
+
+/** 差异数据头：旧长度、新长度、段数 */
+constexpr size_t DELTA_HEADER_SIZE = 3 * sizeof(uint16_t);
+
+void AppendU16(std::vector<char>* out, size_t value) {
+    uint16_t v = static_cast<uint16_t>(value);
+    const char* bytes = reinterpret_cast<const char*>(&v);
+    out->insert(out->end(), bytes, bytes + sizeof(uint16_t));
+}
+
+uint16_t ReadU16(const char* data) {
+    uint16_t v;
+    std::memcpy(&v, data, sizeof(uint16_t));
+    return v;
+}
+
+}  // namespace
+
+/**
+ * UPDATE_DELTA log record构造
+ *
+ * 实现思路：
+ * 1. 把两个tuple都序列化，在公共长度内找出不同的字节
+ * 2. 两个差异之间相同的字节少于一个段头时并进同一段
+ * 3. 长度不同时，从公共长度（或者离它很近的上一段）开始的一段
+ *    覆盖两个tuple各自剩下的全部字节
+ */
+UpdateDeltaLogRecord::UpdateDeltaLogRecord(txn_id_t txn_id, lsn_t prev_lsn,
+                                           const RID& rid,
+                                           const Tuple& old_tuple,
+                                           const Tuple& new_tuple)
+    : LogRecord(LogRecordType::UPDATE_DELTA, txn_id, prev_lsn), rid_(rid) {
+    std::vector<char> old_image(old_tuple.GetSerializedSize());
+    std::vector<char> new_image(new_tuple.GetSerializedSize());
+    if (!old_image.empty()) {
+        old_tuple.SerializeTo(old_image.data());
+    }
+    if (!new_image.empty()) {
+        new_tuple.SerializeTo(new_image.data());
+    }
+    size_t old_size = old_image.size();
+    size_t new_size = new_image.size();
+    size_t common = std::min(old_size, new_size);
+
+    struct Run {
+        size_t offset;
+        size_t old_len;
+        size_t new_len;
+    };
+    std::vector<Run> runs;
+    size_t i = 0;
+    while (i < common) {
+        if (old_image[i] == new_image[i]) {
+            i++;
+            continue;
+        }
+        size_t end = i + 1;
+        for (size_t j = end; j < common && j - end < DELTA_RUN_HEADER_SIZE;
+             j++) {
+            if (old_image[j] != new_image[j]) {
+                end = j + 1;
+            }
+        }
+        runs.push_back({i, end - i, end - i});
+        i = end;
+    }
+    if (old_size != new_size) {
+        size_t start = common;
+        if (!runs.empty() && common - (runs.back().offset + runs.back().old_len) <
+                                 DELTA_RUN_HEADER_SIZE) {
+            start = runs.back().offset;
+            runs.pop_back();
+        }
+        runs.push_back({start, old_size - start, new_size - start});
+    }
+
+    AppendU16(&delta_, old_size);
+    AppendU16(&delta_, new_size);
+    AppendU16(&delta_, runs.size());
+    for (const Run& run : runs) {
+        AppendU16(&delta_, run.offset);
+        AppendU16(&delta_, run.old_len);
+        AppendU16(&delta_, run.new_len);
+        delta_.insert(delta_.end(), old_image.begin() + run.offset,
+                      old_image.begin() + run.offset + run.old_len);
+        delta_.insert(delta_.end(), new_image.begin() + run.offset,
+                      new_image.begin() + run.offset + run.new_len);
+    }
+}
+
+UpdateDeltaLogRecord::UpdateDeltaLogRecord(txn_id_t txn_id, lsn_t prev_lsn,
+                                           const RID& rid, const char* delta,
+                                           size_t size)
+    : LogRecord(LogRecordType::UPDATE_DELTA, txn_id, prev_lsn),
+      rid_(rid),
+      delta_(delta, delta + size) {}
+
+void UpdateDeltaLogRecord::SerializeTo(char* buffer) const {
+    *reinterpret_cast<page_id_t*>(buffer) = rid_.page_id;
+    buffer += sizeof(page_id_t);
+    *reinterpret_cast<slot_offset_t*>(buffer) = rid_.slot_num;
+    buffer += sizeof(slot_offset_t);
+    if (!delta_.empty()) {
+        std::memcpy(buffer, delta_.data(), delta_.size());
+    }
+}
+
+size_t UpdateDeltaLogRecord::GetOldSize() const {
+    return delta_.size() < DELTA_HEADER_SIZE ? 0 : ReadU16(delta_.data());
+}
+
+size_t UpdateDeltaLogRecord::GetNewSize() const {
+    return delta_.size() < DELTA_HEADER_SIZE
+               ? 0
+               : ReadU16(delta_.data() + sizeof(uint16_t));
+}
+
+bool UpdateDeltaLogRecord::ApplyRedo(const char* old_image, size_t old_size,
+                                     std::vector<char>* new_image) const {
+    return Apply(old_image, old_size, true, new_image);
+}
+
+bool UpdateDeltaLogRecord::ApplyUndo(const char* new_image, size_t new_size,
+                                     std::vector<char>* old_image) const {
+    return Apply(new_image, new_size, false, old_image);
+}
+
+/**
+ * 应用差异
+ * 除了最后一段，所有段前后长度相同，所以段的偏移在两个镜像里一样，
+ * 按顺序拷贝段之间不变的字节、再拷贝段的另一侧字节即可；
+ * 每段在image里的字节必须和记录里这一侧的字节相同，否则image不是
+ * 这条记录修改之前（或之后）的镜像
+ */
+bool UpdateDeltaLogRecord::Apply(const char* image, size_t size, bool from_old,
+                                 std::vector<char>* result) const {
+    if (delta_.size() < DELTA_HEADER_SIZE) {
+        return false;
+    }
+    const char* data = delta_.data();
+    const char* data_end = data + delta_.size();
+    size_t source_size = ReadU16(from_old ? data : data + sizeof(uint16_t));
+    size_t target_size = ReadU16(from_old ? data + sizeof(uint16_t) : data);
+    size_t run_count = ReadU16(data + 2 * sizeof(uint16_t));
+    if (size != source_size) {
+        return false;
+    }
+    data += DELTA_HEADER_SIZE;
+
+    result->clear();
+    result->reserve(target_size);
+    size_t pos = 0;
+    for (size_t r = 0; r < run_count; r++) {
+        if (data + DELTA_RUN_HEADER_SIZE > data_end) {
+            return false;
+        }
+        size_t offset = ReadU16(data);
+        size_t old_len = ReadU16(data + sizeof(uint16_t));
+        size_t new_len = ReadU16(data + 2 * sizeof(uint16_t));
+        data += DELTA_RUN_HEADER_SIZE;
+        size_t source_len = from_old ? old_len : new_len;
+        size_t target_len = from_old ? new_len : old_len;
+        if (offset < pos || offset + source_len > size ||
+            data + old_len + new_len > data_end) {
+            return false;
+        }
+        const char* source_bytes = from_old ? data : data + old_len;
+        if (std::memcmp(image + offset, source_bytes, source_len) != 0) {
+            return false;
+        }
+        result->insert(result->end(), image + pos, image + offset);
+        const char* target_bytes = from_old ? data + old_len : data;
+        result->insert(result->end(), target_bytes, target_bytes + target_len);
+        pos = offset + source_len;
+        data += old_len + new_len;
+    }
+    result->insert(result->end(), image + pos, image + size);
+    return result->size() == target_size;
+}
+
+MultiInsertLogRecord::MultiInsertLogRecord(txn_id_t txn_id, lsn_t prev_lsn,
+                                           page_id_t page_id)
+    : LogRecord(LogRecordType::MULTI_INSERT, txn_id, prev_lsn),
+      first_rid_{page_id, 0} {
+    AppendU16(&data_, 0);
+}
+
+MultiInsertLogRecord::MultiInsertLogRecord(txn_id_t txn_id, lsn_t prev_lsn,
+                                           const RID& first_rid,
+                                           const char* data, size_t size)
+    : LogRecord(LogRecordType::MULTI_INSERT, txn_id, prev_lsn),
+      first_rid_(first_rid),
+      data_(data, data + size) {}
+
+/**
+ * 追加一个tuple
+ * 第一个tuple决定起始slot，之后只需要把tuple数加一并写入数据
+ */
+void MultiInsertLogRecord::AddTuple(slot_offset_t slot_num,
+                                    const Tuple& tuple) {
+    size_t count = GetTupleCount();
+    if (count == 0) {
+        first_rid_.slot_num = slot_num;
+    }
+    uint16_t new_count = static_cast<uint16_t>(count + 1);
+    std::memcpy(data_.data(), &new_count, sizeof(uint16_t));
+
+    size_t tuple_size = tuple.GetSerializedSize();
+    AppendU16(&data_, tuple_size);
+    size_t offset = data_.size();
+    data_.resize(offset + tuple_size);
+    tuple.SerializeTo(data_.data() + offset);
+}
+
+size_t MultiInsertLogRecord::GetTupleCount() const {
+    return data_.size() < sizeof(uint16_t) ? 0 : ReadU16(data_.data());
+}
+
+bool MultiInsertLogRecord::GetTupleImages(
+    std::vector<std::pair<const char*, size_t>>* images) const {
+    images->clear();
+    size_t count = GetTupleCount();
+    size_t offset = sizeof(uint16_t);
+    for (size_t i = 0; i < count; i++) {
+        if (offset + sizeof(uint16_t) > data_.size()) {
+            return false;
+        }
+        size_t tuple_size = ReadU16(data_.data() + offset);
+        offset += sizeof(uint16_t);
+        if (offset + tuple_size > data_.size()) {
+            return false;
+        }
+        images->emplace_back(data_.data() + offset, tuple_size);
+        offset += tuple_size;
+    }
+    return true;
+}
+
+void MultiInsertLogRecord::SerializeTo(char* buffer) const {
+    *reinterpret_cast<page_id_t*>(buffer) = first_rid_.page_id;
+    buffer += sizeof(page_id_t);
+    *reinterpret_cast<slot_offset_t*>(buffer) = first_rid_.slot_num;
+    buffer += sizeof(slot_offset_t);
+    if (!data_.empty()) {
+        std::memcpy(buffer, data_.data(), data_.size());
+    }
+}
+
 void DeleteLogRecord::SerializeTo(char* buffer) const {
     *reinterpret_cast<page_id_t*>(buffer) = rid_.page_id;
     buffer += sizeof(page_id_t);
@@ -110,6 +450,11 @@ void DeleteLogRecord::SerializeTo(char* buffer) const {
     deleted_tuple_.SerializeTo(buffer);
 }
 
+void NewPageLogRecord::SerializeTo(char* buffer) const {
+    std::memcpy(buffer, &page_id_, sizeof(page_id_t));
+    std::memcpy(buffer + sizeof(page_id_t), &prev_page_id_, sizeof(page_id_t));
+}
+
 /**
  * BEGIN log record的序列化实现
  * BEGIN record很简单，base class已经处理了基本字段，这里没有额外数据
@@ -143,4 +488,103 @@ void AbortLogRecord::SerializeTo(char* buffer) const {
     // ABORT record没有额外的数据需要序列化
 }
 
+/**
+ * CHECKPOINT log record构造
+ * 先算出完整DPT的最小recLSN，再按recLSN排序，放不下的部分截掉
+ */
+CheckpointLogRecord::CheckpointLogRecord(lsn_t begin_lsn, TxnTable att,
+                                         DirtyPageTable dpt)
+    : LogRecord(LogRecordType::CHECKPOINT, INVALID_TXN_ID, INVALID_LSN),
+      begin_lsn_(begin_lsn),
+      att_(std::move(att)),
+      dpt_(std::move(dpt)) {
+    std::sort(dpt_.begin(), dpt_.end(),
+              [](const auto& a, const auto& b) { return a.second < b.second; });
+    if (!dpt_.empty()) {
+        redo_lsn_ = dpt_.front().second;
+    }
+
+    size_t used = FIXED_SIZE + att_.size() * sizeof(TxnTable::value_type);
+    size_t capacity =
+        used < MAX_PAYLOAD_SIZE
+            ? (MAX_PAYLOAD_SIZE - used) / sizeof(DirtyPageTable::value_type)
+            : 0;
+    if (dpt_.size() > capacity) {
+        dpt_.resize(capacity);
+        flags_ |= DPT_TRUNCATED;
+    }
+}
+
+/**
+ * CHECKPOINT log record的序列化实现
+ * 固定部分之后依次是ATT和DPT的所有条目
+ */
+void CheckpointLogRecord::SerializeTo(char* buffer) const {
+    auto write = [&buffer](const void* value, size_t size) {
+        std::memcpy(buffer, value, size);
+        buffer += size;
+    };
+    uint32_t att_count = static_cast<uint32_t>(att_.size());
+    uint32_t dpt_count = static_cast<uint32_t>(dpt_.size());
+    write(&begin_lsn_, sizeof(lsn_t));
+    write(&redo_lsn_, sizeof(lsn_t));
+    write(&flags_, sizeof(uint32_t));
+    write(&att_count, sizeof(uint32_t));
+    write(&dpt_count, sizeof(uint32_t));
+    for (const auto& [txn_id, lsn] : att_) {
+        write(&txn_id, sizeof(txn_id_t));
+        write(&lsn, sizeof(lsn_t));
+    }
+    for (const auto& [page_id, rec_lsn] : dpt_) {
+        write(&page_id, sizeof(page_id_t));
+        write(&rec_lsn, sizeof(lsn_t));
+    }
+}
+
+bool CheckpointLogRecord::DeserializePayload(const char* data, size_t size) {
+    begin_lsn_ = INVALID_LSN;
+    redo_lsn_ = INVALID_LSN;
+    flags_ = 0;
+    att_.clear();
+    dpt_.clear();
+    if (size == 0) {
+        return true;
+    }
+    if (size < FIXED_SIZE) {
+        return false;
+    }
+
+    auto read = [&data](void* value, size_t length) {
+        std::memcpy(value, data, length);
+        data += length;
+    };
+    uint32_t att_count;
+    uint32_t dpt_count;
+    read(&begin_lsn_, sizeof(lsn_t));
+    read(&redo_lsn_, sizeof(lsn_t));
+    read(&flags_, sizeof(uint32_t));
+    read(&att_count, sizeof(uint32_t));
+    read(&dpt_count, sizeof(uint32_t));
+
+    size_t entry_size = sizeof(txn_id_t) + sizeof(lsn_t);
+    if (FIXED_SIZE + (static_cast<size_t>(att_count) + dpt_count) * entry_size >
+        size) {
+        begin_lsn_ = INVALID_LSN;
+        redo_lsn_ = INVALID_LSN;
+        flags_ = 0;
+        return false;
+    }
+    att_.resize(att_count);
+    for (auto& [txn_id, lsn] : att_) {
+        read(&txn_id, sizeof(txn_id_t));
+        read(&lsn, sizeof(lsn_t));
+    }
+    dpt_.resize(dpt_count);
+    for (auto& [page_id, rec_lsn] : dpt_) {
+        read(&page_id, sizeof(page_id_t));
+        read(&rec_lsn, sizeof(lsn_t));
+    }
+    return true;
+}
+
 }  // namespace SimpleRDBMS
\ No newline at end of file
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <cstring>
+#include <utility>
 #include <vector>
 
 #include "common/config.h"
@@ -29,9 +30,28 @@ enum class LogRecordType {
     BEGIN,        // 事务开始的日志
     COMMIT,       // 事务提交的日志
     ABORT,        // 事务中止的日志
-    CHECKPOINT    // 检查点日志，用于优化recovery过程
+    CHECKPOINT,   // 检查点日志，用于优化recovery过程
+    UPDATE_DELTA,  // 只记录变化字节的更新日志
+    MULTI_INSERT,  // 同一页面上批量插入的日志
+    NEW_PAGE       // 表堆在链表末尾接上新页面的日志
 };
 
+/**
+ * 日志记录在WAL中的头部大小，不含最前面的长度字段
+ * 依次是：记录类型、事务ID、前一个LSN、本记录LSN，之后是记录自己的数据
+ */
+constexpr size_t LOG_RECORD_HEADER_SIZE =
+    sizeof(LogRecordType) + sizeof(txn_id_t) + sizeof(lsn_t) + sizeof(lsn_t);
+
+/**
+ * 日志块末尾的校验值
+ * 每个PAGE_SIZE大小的日志块最后4个字节是前面所有内容的CRC32C，
+ * 记录只能放在前LOG_BLOCK_DATA_SIZE个字节里；读日志时校验不通过的块
+ * （写了一半、介质损坏）按没有记录处理
+ */
+constexpr size_t LOG_BLOCK_CHECKSUM_SIZE = sizeof(uint32_t);
+constexpr size_t LOG_BLOCK_DATA_SIZE = PAGE_SIZE - LOG_BLOCK_CHECKSUM_SIZE;
+
 /**
  * 日志记录的基类
  * 所有具体的log record都继承自这个类，提供统一的接口
@@ -46,7 +66,11 @@ class LogRecord {
      * @param prev_lsn 前一个LSN，构建事务的undo chain
      */
     LogRecord(LogRecordType type, txn_id_t txn_id, lsn_t prev_lsn)
-        : type_(type), txn_id_(txn_id), prev_lsn_(prev_lsn), size_(0) {}
+        : type_(type),
+          txn_id_(txn_id),
+          prev_lsn_(prev_lsn),
+          lsn_(INVALID_LSN),
+          size_(0) {}
 
     virtual ~LogRecord() = default;
 
@@ -67,10 +91,15 @@ class LogRecord {
     /**
      * 静态工厂方法：从buffer中反序列化出LogRecord对象
      * 根据buffer中的type字段创建对应的具体log record
-     * @param buffer 包含序列化数据的缓冲区
-     * @return 反序列化得到的LogRecord智能指针
+     * @param buffer 一条WAL格式的记录，从长度字段开始（见LogManager）
+     * @param size buffer的字节数
+     * @return 反序列化得到的LogRecord智能指针，数据不完整或类型未知时为nullptr
+     *
+     * DML记录的tuple要有schema才能解析，INSERT/UPDATE保留原始镜像
+     * （见GetTupleImage），DELETE只有RID
      */
-    static std::unique_ptr<LogRecord> DeserializeFrom(const char* buffer);
+    static std::unique_ptr<LogRecord> DeserializeFrom(const char* buffer,
+                                                      size_t size);
 
     // getter方法，用于访问log record的基本信息
     LogRecordType GetType() const { return type_; }
@@ -78,10 +107,17 @@ class LogRecord {
     lsn_t GetPrevLSN() const { return prev_lsn_; }
     size_t GetSize() const { return size_; }
 
+    /**
+     * 记录自己的LSN，AppendLogRecord分配后写入，读日志时从记录头恢复
+     */
+    lsn_t GetLSN() const { return lsn_; }
+    void SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
    protected:
     LogRecordType type_;  // 日志类型
     txn_id_t txn_id_;     // 事务ID
     lsn_t prev_lsn_;      // 前一个LSN，用于链接同一事务的日志
+    lsn_t lsn_;           // 本条记录的LSN
     size_t size_;         // 日志记录的大小
 };
 
@@ -104,6 +140,17 @@ class InsertLogRecord : public LogRecord {
           rid_(rid),
           tuple_(tuple) {}
 
+    /**
+     * 构造函数，使用tuple序列化后的字节（读日志时使用）
+     * @param image RID之后的全部数据
+     * @param size 数据字节数
+     */
+    InsertLogRecord(txn_id_t txn_id, lsn_t prev_lsn, const RID& rid,
+                    const char* image, size_t size)
+        : LogRecord(LogRecordType::INSERT, txn_id, prev_lsn),
+          rid_(rid),
+          image_(image, image + size) {}
+
     void SerializeTo(char* buffer) const override;
 
     /**
@@ -112,16 +159,20 @@ class InsertLogRecord : public LogRecord {
      */
     size_t GetLogRecordSize() const override {
         return sizeof(page_id_t) + sizeof(slot_offset_t) +
-               tuple_.GetSerializedSize();
+               (image_.empty() ? tuple_.GetSerializedSize() : image_.size());
     }
 
     // getter方法
     const RID& GetRID() const { return rid_; }
     const Tuple& GetTuple() const { return tuple_; }
 
+    /** 从日志读出的tuple字节，redo直接写进页面；内存中构造的记录为空 */
+    const std::vector<char>& GetTupleImage() const { return image_; }
+
    private:
-    RID rid_;      // 插入位置
-    Tuple tuple_;  // 插入的数据
+    RID rid_;                  // 插入位置
+    Tuple tuple_;              // 插入的数据
+    std::vector<char> image_;  // 从日志读出的tuple字节
 };
 
 /**
@@ -145,6 +196,18 @@ class UpdateLogRecord : public LogRecord {
           old_tuple_(old_tuple),
           new_tuple_(new_tuple) {}
 
+    /**
+     * 构造函数，使用两个tuple序列化后的字节（读日志时使用）
+     * @param images RID之后的全部数据：旧镜像紧接着新镜像，中间没有长度，
+     *        分界要按页面上旧tuple的长度确定
+     * @param size 数据字节数
+     */
+    UpdateLogRecord(txn_id_t txn_id, lsn_t prev_lsn, const RID& rid,
+                    const char* images, size_t size)
+        : LogRecord(LogRecordType::UPDATE, txn_id, prev_lsn),
+          rid_(rid),
+          images_(images, images + size) {}
+
     void SerializeTo(char* buffer) const override;
 
     /**
@@ -153,7 +216,9 @@ class UpdateLogRecord : public LogRecord {
      */
     size_t GetLogRecordSize() const override {
         return sizeof(page_id_t) + sizeof(slot_offset_t) +
-               old_tuple_.GetSerializedSize() + new_tuple_.GetSerializedSize();
+               (images_.empty() ? old_tuple_.GetSerializedSize() +
+                                      new_tuple_.GetSerializedSize()
+                                : images_.size());
     }
 
     // getter方法
@@ -161,10 +226,166 @@ class UpdateLogRecord : public LogRecord {
     const Tuple& GetOldTuple() const { return old_tuple_; }
     const Tuple& GetNewTuple() const { return new_tuple_; }
 
+    /** 从日志读出的旧镜像和新镜像字节；内存中构造的记录为空 */
+    const std::vector<char>& GetTupleImages() const { return images_; }
+
+   private:
+    RID rid_;                   // 更新位置
+    Tuple old_tuple_;           // 旧数据
+    Tuple new_tuple_;           // 新数据
+    std::vector<char> images_;  // 从日志读出的旧镜像和新镜像
+};
+
+/**
+ * UPDATE_DELTA日志记录
+ *
+ * 宽行只改一两列时，完整的old/new tuple大部分是重复的。
+ * 这里只保存两个tuple序列化结果中不同的字节段，每段同时带旧字节和新字节，
+ * 有旧镜像就能redo，有新镜像就能undo：
+ * - 公共长度内的差异段前后长度相同
+ * - 长度不同（VARCHAR变长）时，最后一段覆盖到两个tuple的末尾
+ * - 相距很近的两段合并，避免段头比省下的字节还多
+ *
+ * 数据格式：[RID][旧长度 u16][新长度 u16][段数 u16]
+ *          每段：[偏移 u16][旧长度 u16][新长度 u16][旧字节][新字节]
+ */
+class UpdateDeltaLogRecord : public LogRecord {
+   public:
+    /**
+     * 构造函数，计算两个tuple之间的差异
+     * @param txn_id 事务ID
+     * @param prev_lsn 前一个LSN
+     * @param rid 更新记录的位置
+     * @param old_tuple 更新前的数据
+     * @param new_tuple 更新后的数据
+     */
+    UpdateDeltaLogRecord(txn_id_t txn_id, lsn_t prev_lsn, const RID& rid,
+                         const Tuple& old_tuple, const Tuple& new_tuple);
+
+    /**
+     * 构造函数，使用已经编码好的差异数据（读日志时使用）
+     * @param delta RID之后的全部数据
+     * @param size 数据字节数
+     */
+    UpdateDeltaLogRecord(txn_id_t txn_id, lsn_t prev_lsn, const RID& rid,
+                         const char* delta, size_t size);
+
+    ~UpdateDeltaLogRecord() override = default;
+
+    void SerializeTo(char* buffer) const override;
+
+    size_t GetLogRecordSize() const override {
+        return sizeof(page_id_t) + sizeof(slot_offset_t) + delta_.size();
+    }
+
+    const RID& GetRID() const { return rid_; }
+
+    /** 更新前tuple序列化后的字节数 */
+    size_t GetOldSize() const;
+
+    /** 更新后tuple序列化后的字节数 */
+    size_t GetNewSize() const;
+
+    /**
+     * 在更新前的镜像上应用差异，得到更新后的镜像（redo）
+     * @param old_image 更新前tuple的序列化数据
+     * @param old_size 字节数，必须等于GetOldSize()
+     * @param new_image 输出更新后的序列化数据
+     * @return 长度不符或数据损坏时返回false
+     */
+    bool ApplyRedo(const char* old_image, size_t old_size,
+                   std::vector<char>* new_image) const;
+
+    /**
+     * 在更新后的镜像上反向应用差异，得到更新前的镜像（undo）
+     */
+    bool ApplyUndo(const char* new_image, size_t new_size,
+                   std::vector<char>* old_image) const;
+
    private:
-    RID rid_;          // 更新位置
-    Tuple old_tuple_;  // 旧数据
-    Tuple new_tuple_;  // 新数据
+    /** 对image应用所有段，from_old为true时把旧字节换成新字节 */
+    bool Apply(const char* image, size_t size, bool from_old,
+               std::vector<char>* result) const;
+
+    RID rid_;
+    std::vector<char> delta_;  // RID之后的编码数据
+};
+
+/**
+ * MULTI_INSERT日志记录
+ *
+ * 批量插入时一个页面上连续插入的多个tuple合并成一条记录，
+ * 每个页面只追加一次日志、只更新一次页面LSN。
+ * 同一批tuple在页面写锁下依次插入，slot从第一个开始连续编号，
+ * 所以只需要记录第一个tuple的RID。
+ * 记录和其他日志一样不能跨日志块，放满MAX_PAYLOAD_SIZE就要换一条记录
+ *
+ * 数据格式：[第一个RID][tuple数 u16]
+ *          每个tuple：[长度 u16][序列化数据]
+ */
+class MultiInsertLogRecord : public LogRecord {
+   public:
+    /** RID之后能存放的最大字节数（含tuple数） */
+    static constexpr size_t MAX_PAYLOAD_SIZE =
+        LOG_BLOCK_DATA_SIZE - sizeof(uint32_t) - LOG_RECORD_HEADER_SIZE -
+        sizeof(page_id_t) - sizeof(slot_offset_t);
+
+    /**
+     * 构造函数，创建一条空记录，之后用AddTuple追加
+     * @param page_id 插入的页面
+     */
+    MultiInsertLogRecord(txn_id_t txn_id, lsn_t prev_lsn, page_id_t page_id);
+
+    /**
+     * 构造函数，使用已经编码好的数据（读日志时使用）
+     * @param first_rid 第一个tuple的RID
+     * @param data RID之后的全部数据
+     * @param size 数据字节数
+     */
+    MultiInsertLogRecord(txn_id_t txn_id, lsn_t prev_lsn, const RID& first_rid,
+                         const char* data, size_t size);
+
+    ~MultiInsertLogRecord() override = default;
+
+    void SerializeTo(char* buffer) const override;
+
+    size_t GetLogRecordSize() const override {
+        return sizeof(page_id_t) + sizeof(slot_offset_t) + data_.size();
+    }
+
+    /** 记录是否还放得下一个tuple_size字节的tuple */
+    bool HasRoomFor(size_t tuple_size) const {
+        return data_.size() + sizeof(uint16_t) + tuple_size <=
+               MAX_PAYLOAD_SIZE;
+    }
+
+    /**
+     * 追加一个已经插入页面的tuple
+     * @param slot_num tuple所在的slot，必须紧接着上一个tuple
+     */
+    void AddTuple(slot_offset_t slot_num, const Tuple& tuple);
+
+    /** 第一个tuple的RID */
+    const RID& GetRID() const { return first_rid_; }
+
+    size_t GetTupleCount() const;
+
+    /** 第index个tuple的RID */
+    RID GetRID(size_t index) const {
+        return RID{first_rid_.page_id,
+                   first_rid_.slot_num + static_cast<slot_offset_t>(index)};
+    }
+
+    /**
+     * 按顺序取出每个tuple的序列化字节，指针引用记录内部的数据
+     * @return 数据被截断时返回false
+     */
+    bool GetTupleImages(
+        std::vector<std::pair<const char*, size_t>>* images) const;
+
+   private:
+    RID first_rid_;
+    std::vector<char> data_;  // RID之后的编码数据
 };
 
 class DeleteLogRecord : public LogRecord {
@@ -192,6 +413,37 @@ class DeleteLogRecord : public LogRecord {
     Tuple deleted_tuple_;
 };
 
+/**
+ * NEW_PAGE日志记录
+ *
+ * 表堆在页面链表末尾接上新页面时写这条记录，不属于任何事务。
+ * 之后这个页面上的插入要重做，页面必须已经初始化并且接在链表里：
+ * 重做时新页面的页面LSN小于记录LSN就重新初始化，
+ * 上一页的下一页ID还是空的就指向新页面（只改链接，不动上一页的页面LSN）
+ *
+ * 数据格式：[新页面ID][上一页ID]
+ */
+class NewPageLogRecord : public LogRecord {
+   public:
+    NewPageLogRecord(page_id_t page_id, page_id_t prev_page_id)
+        : LogRecord(LogRecordType::NEW_PAGE, INVALID_TXN_ID, INVALID_LSN),
+          page_id_(page_id),
+          prev_page_id_(prev_page_id) {}
+
+    ~NewPageLogRecord() override = default;
+
+    void SerializeTo(char* buffer) const override;
+
+    size_t GetLogRecordSize() const override { return 2 * sizeof(page_id_t); }
+
+    page_id_t GetPageId() const { return page_id_; }
+    page_id_t GetPrevPageId() const { return prev_page_id_; }
+
+   private:
+    page_id_t page_id_;
+    page_id_t prev_page_id_;
+};
+
 /**
  * BEGIN操作的日志记录
  * 标记事务开始，比较简单，只有基本的事务信息
@@ -264,4 +516,83 @@ class AbortLogRecord : public LogRecord {
     size_t GetLogRecordSize() const override { return 0; }
 };
 
-}  // namespace SimpleRDBMS
\ No newline at end of file
+/**
+ * CHECKPOINT日志记录
+ *
+ * 模糊检查点：不刷任何页面，只把当时的活跃事务表（ATT）和
+ * 脏页表（DPT）记下来，恢复时从这里开始分析：
+ * - begin_lsn：开始收集两张表时的下一个LSN，分析阶段至少从这里开始扫描，
+ *   收集期间结束的事务才能被正确识别
+ * - redo_lsn：完整DPT中最小的recLSN，redo从这里开始；没有脏页时为INVALID_LSN
+ * - DPT很大时放不进一条记录，只保存recLSN最小的那些页面，
+ *   并标记为不完整，redo_lsn仍然按完整的表计算
+ *
+ * 日志截断后也会写一条空的检查点在新日志开头，重启时根据它接上之前的LSN
+ *
+ * 数据格式：[begin_lsn][redo_lsn][flags][ATT条数][DPT条数][ATT...][DPT...]
+ */
+class CheckpointLogRecord : public LogRecord {
+   public:
+    using TxnTable = std::vector<std::pair<txn_id_t, lsn_t>>;
+    using DirtyPageTable = std::vector<std::pair<page_id_t, lsn_t>>;
+
+    /** flags：DPT被截断，只包含recLSN最小的一部分页面 */
+    static constexpr uint32_t DPT_TRUNCATED = 1;
+
+    /** 固定部分的大小 */
+    static constexpr size_t FIXED_SIZE = 2 * sizeof(lsn_t) + 3 * sizeof(uint32_t);
+
+    /** 一条记录最多能放下的数据大小（记录不跨日志块） */
+    static constexpr size_t MAX_PAYLOAD_SIZE =
+        LOG_BLOCK_DATA_SIZE - sizeof(uint32_t) - LOG_RECORD_HEADER_SIZE;
+
+    CheckpointLogRecord()
+        : LogRecord(LogRecordType::CHECKPOINT, INVALID_TXN_ID, INVALID_LSN) {}
+
+    /**
+     * 构造函数
+     * @param begin_lsn 开始收集时的下一个LSN
+     * @param att 活跃事务表：事务ID -> 最后一条记录的LSN
+     * @param dpt 脏页表：页面ID -> recLSN，放不下时只保留recLSN最小的部分
+     */
+    CheckpointLogRecord(lsn_t begin_lsn, TxnTable att, DirtyPageTable dpt);
+
+    ~CheckpointLogRecord() override = default;
+
+    void SerializeTo(char* buffer) const override;
+
+    size_t GetLogRecordSize() const override {
+        return FIXED_SIZE + att_.size() * sizeof(TxnTable::value_type) +
+               dpt_.size() * sizeof(DirtyPageTable::value_type);
+    }
+
+    /**
+     * 从记录数据中解析两张表，复用已有的vector空间
+     * @param data 记录数据
+     * @param size 数据字节数，0表示没有数据的旧格式检查点
+     * @return 数据不完整时返回false，此时两张表为空
+     */
+    bool DeserializePayload(const char* data, size_t size);
+
+    /** ATT能放下的最大条数（DPT为空时） */
+    static size_t MaxTxnEntries() {
+        return (MAX_PAYLOAD_SIZE - FIXED_SIZE) / sizeof(TxnTable::value_type);
+    }
+
+    lsn_t GetBeginLSN() const { return begin_lsn_; }
+    lsn_t GetRedoLSN() const { return redo_lsn_; }
+    bool IsDirtyPageTableComplete() const {
+        return (flags_ & DPT_TRUNCATED) == 0;
+    }
+    const TxnTable& GetActiveTxnTable() const { return att_; }
+    const DirtyPageTable& GetDirtyPageTable() const { return dpt_; }
+
+   private:
+    lsn_t begin_lsn_{INVALID_LSN};
+    lsn_t redo_lsn_{INVALID_LSN};
+    uint32_t flags_{0};
+    TxnTable att_;
+    DirtyPageTable dpt_;
+};
+
+}  // namespace SimpleRDBMS
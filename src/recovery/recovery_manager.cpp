@@ -9,13 +9,99 @@
 #include "recovery/recovery_manager.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
 #include <set>
+#include <thread>
 
 #include "record/table_heap.h"
 #include "recovery/log_record.h"
+#include "transaction/transaction_manager.h"
 
 namespace SimpleRDBMS {
 
+namespace {
+
+/** 分发线程攒够这么多条记录才交给工作线程，减少加锁次数 */
+constexpr size_t REDO_DISPATCH_BATCH = 64;
+
+/** 每个工作线程队列中最多积压的记录数，超过时分发线程等待 */
+constexpr size_t REDO_QUEUE_CAPACITY = 1024;
+
+/**
+ * redo工作线程的任务队列
+ * 分发线程按日志顺序入队，工作线程按入队顺序执行，
+ * 所以同一页面的记录总是按LSN顺序应用
+ * 队列有容量上限，redo过程中内存里的记录数和日志长度无关
+ */
+struct RedoQueue {
+    std::mutex latch;
+    std::condition_variable cv;
+    std::condition_variable space_cv;
+    std::deque<std::unique_ptr<LogRecord>> records;
+    bool closed{false};
+
+    void Push(std::vector<std::unique_ptr<LogRecord>>* batch) {
+        if (batch->empty()) {
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(latch);
+            space_cv.wait(lock, [this] {
+                return records.size() < REDO_QUEUE_CAPACITY;
+            });
+            for (auto& record : *batch) {
+                records.push_back(std::move(record));
+            }
+        }
+        batch->clear();
+        cv.notify_one();
+    }
+
+    void Close() {
+        {
+            std::lock_guard<std::mutex> guard(latch);
+            closed = true;
+        }
+        cv.notify_one();
+    }
+};
+
+/** 日志记录修改的页面，不修改数据页面的记录返回INVALID_PAGE_ID */
+page_id_t RedoPageOf(const LogRecord& log_record) {
+    switch (log_record.GetType()) {
+        case LogRecordType::INSERT:
+            return static_cast<const InsertLogRecord&>(log_record)
+                .GetRID()
+                .page_id;
+        case LogRecordType::UPDATE:
+            return static_cast<const UpdateLogRecord&>(log_record)
+                .GetRID()
+                .page_id;
+        case LogRecordType::UPDATE_DELTA:
+            return static_cast<const UpdateDeltaLogRecord&>(log_record)
+                .GetRID()
+                .page_id;
+        case LogRecordType::MULTI_INSERT:
+            return static_cast<const MultiInsertLogRecord&>(log_record)
+                .GetRID()
+                .page_id;
+        case LogRecordType::DELETE:
+            return static_cast<const DeleteLogRecord&>(log_record)
+                .GetRID()
+                .page_id;
+        case LogRecordType::NEW_PAGE:
+            return static_cast<const NewPageLogRecord&>(log_record)
+                .GetPageId();
+        default:
+            return INVALID_PAGE_ID;
+    }
+}
+
+}  // namespace
+
 /**
  * @brief RecoveryManager构造函数
  * @param buffer_pool_manager 缓冲池管理器指针
@@ -32,6 +118,10 @@ RecoveryManager::RecoveryManager(BufferPoolManager* buffer_pool_manager,
       lock_manager_(lock_manager),
       last_checkpoint_lsn_(INVALID_LSN) {}
 
+void RecoveryManager::SetRedoThreads(size_t threads) {
+    redo_threads_ = std::max<size_t>(threads, 1);
+}
+
 /**
  * @brief 创建检查点并截断日志
  *
@@ -88,102 +178,208 @@ void RecoveryManager::CheckpointWithLogTruncation() {
 void RecoveryManager::Recover() {
     LOG_INFO("Starting recovery process");
 
-    // 从log manager读取所有日志记录
-    auto log_records = log_manager_->ReadLogRecords();
+    // 用游标流式读取日志，每个阶段各自扫描一遍，不把整个日志读进内存
+    auto cursor = log_manager_->CreateLogCursor();
 
-    if (log_records.empty()) {
+    if (!cursor->SeekToFirst()) {
         LOG_INFO("No log records found, recovery complete");
         return;
     }
 
-    LOG_INFO("Found " << log_records.size() << " log records for recovery");
-
     // 按顺序执行ARIES算法的三个阶段
-    AnalysisPhase(log_records);
-    RedoPhase(log_records);
-    UndoPhase(log_records);
+    AnalysisPhase(cursor.get());
+    RedoPhase(cursor.get());
+    UndoPhase(cursor.get());
 
     LOG_INFO("Recovery process completed");
 }
 
 /**
- * @brief 创建检查点，将所有脏页刷到磁盘并刷新日志
+ * @brief 创建模糊检查点
  *
- * Checkpoint的作用是减少恢复时需要处理的日志量
- * 通过将内存中的脏页写入磁盘，可以确保某个时间点之前的修改已经持久化
+ * 实现思路：
+ * 1. 先记下当前日志末尾begin_lsn，再依次收集活跃事务表和脏页表，
+ *    收集期间事务和页面修改照常进行
+ * 2. 收集期间发生的修改要么已经在脏页表里，要么LSN不小于begin_lsn，
+ *    恢复时从begin_lsn开始分析就能把它们补进脏页表
+ * 3. 两张表写进一条CHECKPOINT记录，只刷日志，不写回任何页面
  */
 void RecoveryManager::Checkpoint() {
-    // 先flush所有脏页到磁盘
-    buffer_pool_manager_->FlushAllPages();
-    // 再flush日志缓冲区
-    log_manager_->Flush();
+    lsn_t begin_lsn = log_manager_->GetLastReservedLSN() + 1;
+
+    CheckpointLogRecord::TxnTable active_txns;
+    if (txn_manager_ != nullptr) {
+        active_txns = txn_manager_->GetActiveTransactionTable();
+    }
+    if (active_txns.size() > CheckpointLogRecord::MaxTxnEntries()) {
+        LOG_WARN("Skipping checkpoint, " << active_txns.size()
+                                         << " active transactions do not fit "
+                                            "in one log record");
+        return;
+    }
+
+    CheckpointLogRecord checkpoint_record(
+        begin_lsn, std::move(active_txns),
+        buffer_pool_manager_->GetDirtyPageTable());
+    lsn_t lsn = log_manager_->AppendLogRecord(&checkpoint_record);
+    if (lsn == INVALID_LSN) {
+        LOG_DEBUG("Logging disabled, checkpoint not written");
+        return;
+    }
+    log_manager_->Flush(lsn);
+
+    LOG_INFO("Checkpoint written at LSN "
+             << lsn << ": " << checkpoint_record.GetActiveTxnTable().size()
+             << " active transactions, "
+             << checkpoint_record.GetDirtyPageTable().size()
+             << " dirty pages, redo LSN " << checkpoint_record.GetRedoLSN());
+}
+
+/**
+ * @brief 逆向查找最后一个CHECKPOINT记录
+ *
+ * 实现思路：
+ * 1. 从日志末尾向前找到第一条CHECKPOINT记录，用它初始化ATT和DPT
+ * 2. 分析从begin_lsn、redo_lsn和检查点本身中最小的位置开始：
+ *    begin_lsn之后的记录可能还没反映在两张表里，
+ *    redo_lsn之后的记录要redo，需要知道它们所属事务的结果
+ * 3. 日志截断时写的空检查点没有begin_lsn，此时所有页面都已写回，
+ *    从它自己开始即可
+ */
+lsn_t RecoveryManager::LoadLastCheckpoint(LogCursor* cursor) {
+    for (bool ok = cursor->SeekToLast(); ok; ok = cursor->Prev()) {
+        const LogRecord& log_record = cursor->GetRecord();
+        if (log_record.GetType() != LogRecordType::CHECKPOINT) {
+            continue;
+        }
+        const auto& checkpoint =
+            static_cast<const CheckpointLogRecord&>(log_record);
+        checkpoint_lsn_ = checkpoint.GetLSN();
+        dpt_complete_ = checkpoint.IsDirtyPageTableComplete();
+        for (const auto& [txn_id, lsn] : checkpoint.GetActiveTxnTable()) {
+            active_txn_table_[txn_id] = lsn;
+        }
+        for (const auto& [page_id, rec_lsn] : checkpoint.GetDirtyPageTable()) {
+            dirty_page_table_[page_id] = rec_lsn;
+        }
+
+        lsn_t scan_start = checkpoint_lsn_;
+        if (checkpoint.GetBeginLSN() != INVALID_LSN) {
+            scan_start = std::min(scan_start, checkpoint.GetBeginLSN());
+        }
+        if (checkpoint.GetRedoLSN() != INVALID_LSN) {
+            scan_start = std::min(scan_start, checkpoint.GetRedoLSN());
+        }
+        LOG_INFO("Found checkpoint at LSN "
+                 << checkpoint_lsn_ << " with "
+                 << checkpoint.GetActiveTxnTable().size()
+                 << " active transactions and "
+                 << checkpoint.GetDirtyPageTable().size()
+                 << " dirty pages, analysis starts at LSN " << scan_start);
+        return scan_start;
+    }
+    return INVALID_LSN;
 }
 
 /**
  * @brief Analysis阶段：分析日志记录确定事务状态
- * @param log_records 所有日志记录的vector
+ * @param cursor 日志游标
  *
  * 这一阶段的主要工作：
- * 1. 扫描所有日志记录
- * 2. 识别出所有的事务ID
- * 3. 根据BEGIN/COMMIT/ABORT记录确定哪些事务是活跃的（未提交）
- * 4. 构建active_txn_table_，为Undo阶段做准备
+ * 1. 正向扫描所有日志记录
+ * 2. 每个事务的记录出现时放进active_txn_table_，值为它最后一条记录的LSN
+ * 3. COMMIT/ABORT时把事务移出active_txn_table_，ABORT的事务另外记下来，
+ *    扫描结束时剩下的就是崩溃时仍然活跃的事务，为Undo阶段做准备
+ * 4. 有检查点时两张表从检查点开始，只扫描检查点附近以后的记录；
+ *    DPT完整时把扫描到的修改所在页面补进DPT（已有的保留更早的recLSN），
+ *    最后确定redo的起点
+ *
+ * 内存只和活跃事务、中止事务的数量有关，已提交的事务不需要保留
  */
-void RecoveryManager::AnalysisPhase(
-    const std::vector<std::unique_ptr<LogRecord>>& log_records) {
+void RecoveryManager::AnalysisPhase(LogCursor* cursor) {
     LOG_DEBUG("Starting analysis phase");
     active_txn_table_.clear();
+    dirty_page_table_.clear();
+    aborted_txns_.clear();
+    checkpoint_lsn_ = INVALID_LSN;
+    dpt_complete_ = false;
+    redo_start_lsn_ = INVALID_LSN;
+
+    size_t num_records = 0;
+    size_t committed_transactions = 0;
+
+    lsn_t scan_start = LoadLastCheckpoint(cursor);
+    bool has_checkpoint = scan_start != INVALID_LSN;
+    bool ok = has_checkpoint ? cursor->SeekToLSN(scan_start)
+                             : cursor->SeekToFirst();
+    if (!has_checkpoint && ok) {
+        redo_start_lsn_ = cursor->GetRecord().GetLSN();
+    }
 
-    // 用set来收集不同状态的事务ID，方便后续判断
-    std::set<txn_id_t> all_transactions;        // 所有出现过的事务
-    std::set<txn_id_t> committed_transactions;  // 已提交的事务
-    std::set<txn_id_t> aborted_transactions;    // 已中止的事务
+    for (; ok; ok = cursor->Next()) {
+        const LogRecord& log_record = cursor->GetRecord();
+        num_records++;
 
-    // 第一遍扫描：收集所有事务的状态信息
-    for (const auto& log_record : log_records) {
-        txn_id_t txn_id = log_record->GetTxnId();
-        all_transactions.insert(txn_id);
+        // CHECKPOINT记录不属于任何事务
+        if (log_record.GetType() == LogRecordType::CHECKPOINT) {
+            continue;
+        }
+        txn_id_t txn_id = log_record.GetTxnId();
 
-        switch (log_record->GetType()) {
-            case LogRecordType::BEGIN:
-                LOG_DEBUG("Analysis: Transaction " << txn_id << " began");
-                break;
+        if (has_checkpoint && dpt_complete_) {
+            page_id_t page_id = RedoPageOf(log_record);
+            if (page_id != INVALID_PAGE_ID) {
+                dirty_page_table_.emplace(page_id, log_record.GetLSN());
+            }
+        }
+
+        // NEW_PAGE是系统记录，只影响脏页表
+        if (log_record.GetType() == LogRecordType::NEW_PAGE) {
+            continue;
+        }
+
+        switch (log_record.GetType()) {
             case LogRecordType::COMMIT:
-                committed_transactions.insert(txn_id);
+                active_txn_table_.erase(txn_id);
+                committed_transactions++;
                 LOG_DEBUG("Analysis: Transaction " << txn_id << " committed");
                 break;
             case LogRecordType::ABORT:
-                aborted_transactions.insert(txn_id);
+                active_txn_table_.erase(txn_id);
+                aborted_txns_.insert(txn_id);
                 LOG_DEBUG("Analysis: Transaction " << txn_id << " aborted");
                 break;
             default:
-                // INSERT/UPDATE/DELETE等操作记录不影响事务状态判断
+                // BEGIN以及INSERT/UPDATE/DELETE：事务仍在进行
+                active_txn_table_[txn_id] = log_record.GetLSN();
                 break;
         }
     }
 
-    // 第二遍扫描：确定活跃事务
-    // 活跃事务 = 所有事务 - 已提交事务 - 已中止事务
-    for (txn_id_t txn_id : all_transactions) {
-        if (committed_transactions.find(txn_id) ==
-                committed_transactions.end() &&
-            aborted_transactions.find(txn_id) == aborted_transactions.end()) {
-            // 这个事务没有COMMIT也没有ABORT记录，说明是活跃的（未完成的）
-            active_txn_table_[txn_id] = INVALID_LSN;
-            LOG_DEBUG("Analysis: Transaction "
-                      << txn_id << " is active (not committed/aborted)");
+    if (has_checkpoint) {
+        if (!dpt_complete_) {
+            redo_start_lsn_ = scan_start;  // DPT不完整，从分析起点开始全部redo
+        } else {
+            for (const auto& [page_id, rec_lsn] : dirty_page_table_) {
+                if (redo_start_lsn_ == INVALID_LSN || rec_lsn < redo_start_lsn_) {
+                    redo_start_lsn_ = rec_lsn;
+                }
+            }
         }
     }
 
+    LOG_INFO("Found " << num_records << " log records for recovery");
     LOG_DEBUG("Analysis phase completed. Active transactions: "
               << active_txn_table_.size());
-    LOG_DEBUG("Committed transactions: " << committed_transactions.size());
-    LOG_DEBUG("Aborted transactions: " << aborted_transactions.size());
+    LOG_DEBUG("Committed transactions: " << committed_transactions);
+    LOG_DEBUG("Aborted transactions: " << aborted_txns_.size());
+    LOG_DEBUG("Dirty pages: " << dirty_page_table_.size()
+                              << ", redo starts at LSN " << redo_start_lsn_);
 }
 
 /**
  * @brief Undo阶段：撤销所有未提交事务的操作
- * @param log_records 所有日志记录的vector
+ * @param cursor 日志游标
  *
  * 实现思路：
  * 1. 对于每个活跃事务，需要撤销它所做的所有修改
@@ -192,8 +388,7 @@ void RecoveryManager::AnalysisPhase(
  * 4. 从每个表的末尾删除N条记录（N=活跃事务数）
  * 5. 为所有活跃事务生成ABORT日志记录
  */
-void RecoveryManager::UndoPhase(
-    const std::vector<std::unique_ptr<LogRecord>>& log_records) {
+void RecoveryManager::UndoPhase(LogCursor* cursor) {
     LOG_DEBUG("Starting undo phase");
 
     if (active_txn_table_.empty()) {
@@ -250,7 +445,7 @@ void RecoveryManager::UndoPhase(
                 const RID& rid = all_records[idx].first;
 
                 // 获取页面并删除tuple
-                Page* page = buffer_pool_manager_->FetchPage(rid.page_id);
+                Page* page = FetchTablePage(rid.page_id);
                 if (page != nullptr) {
                     page->WLatch();  // 写锁保护
                     auto* table_page = reinterpret_cast<TablePage*>(page);
@@ -285,73 +480,409 @@ void RecoveryManager::UndoPhase(
 
 /**
  * @brief Redo阶段：重做已提交事务的所有操作
- * @param log_records 所有日志记录的vector
+ * @param cursor 日志游标
  *
- * 当前实现说明：
- * 这是一个简化的实现，主要用于统计需要redo的操作数量
- * 在完整的实现中，这里应该：
- * 1. 对每个已提交事务的每个操作进行重做
- * 2. 确保所有已提交的修改都被应用到数据库中
- * 3. 处理页面LSN和日志LSN的比较，避免重复redo
+ * 实现思路：
+ * 1. 只重做已提交事务的INSERT/UPDATE/DELETE，是否真的需要重做
+ *    由各个Redo函数比较页面LSN来判断
+ * 2. redo_threads_为1时在当前线程按日志顺序执行
+ * 3. 否则按page_id % 线程数把记录复制一份分发到各个工作线程的队列，
+ *    日志只遍历一遍；同一页面的记录总在同一个线程里按LSN顺序应用，
+ *    不同页面并行，互相之间没有顺序要求；队列满时分发线程等待
+ * 4. 分发完毕后关闭所有队列，等待工作线程执行完
+ * 5. 从Analysis确定的redo起点开始扫描；有完整DPT时，
+ *    页面不在DPT中或LSN小于页面recLSN的记录已经在磁盘上，直接跳过
  */
-void RecoveryManager::RedoPhase(
-    const std::vector<std::unique_ptr<LogRecord>>& log_records) {
-    LOG_DEBUG("Starting redo phase");
-
-    int redo_operations = 0;
-
-    // 扫描所有日志记录，识别需要redo的操作
-    for (const auto& log_record : log_records) {
-        switch (log_record->GetType()) {
-            case LogRecordType::INSERT:
-                RedoInsert(
-                    static_cast<const InsertLogRecord*>(log_record.get()));
-                // 统计重做的插入操作
-                redo_operations++;
-                break;
-            case LogRecordType::UPDATE:
-                RedoUpdate(
-                    static_cast<const UpdateLogRecord*>(log_record.get()));
-                // 统计重做的更新操作
-                redo_operations++;
-                break;
-            case LogRecordType::DELETE:
-                RedoDelete(
-                    static_cast<const DeleteLogRecord*>(log_record.get()));
-                redo_operations++;
-                break;
-            default:
-                // BEGIN/COMMIT/ABORT等控制记录不需要redo
-                break;
+void RecoveryManager::RedoPhase(LogCursor* cursor) {
+    LOG_DEBUG("Starting redo phase with " << redo_threads_ << " threads");
+
+    redo_operations_ = 0;
+
+    if (redo_start_lsn_ == INVALID_LSN) {
+        LOG_DEBUG("No dirty pages, nothing to redo");
+        return;
+    }
+
+    if (redo_threads_ <= 1) {
+        for (bool ok = cursor->SeekToLSN(redo_start_lsn_); ok;
+             ok = cursor->Next()) {
+            if (!InRedoRange(cursor->GetRecord())) {
+                continue;
+            }
+            if (RedoRecord(&cursor->GetRecord())) {
+                redo_operations_++;
+            }
+        }
+        LOG_DEBUG("Redo phase completed. " << redo_operations_.load()
+                                           << " operations identified");
+        return;
+    }
+
+    size_t num_workers = redo_threads_;
+    std::vector<RedoQueue> queues(num_workers);
+    std::vector<std::thread> workers;
+    workers.reserve(num_workers);
+
+    for (size_t i = 0; i < num_workers; i++) {
+        workers.emplace_back([this, &queue = queues[i]] {
+            std::deque<std::unique_ptr<LogRecord>> pending;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(queue.latch);
+                    queue.cv.wait(lock, [&queue] {
+                        return !queue.records.empty() || queue.closed;
+                    });
+                    if (queue.records.empty()) {
+                        return;  // 队列已关闭并且处理完毕
+                    }
+                    pending.swap(queue.records);
+                }
+                queue.space_cv.notify_one();
+                for (const auto& log_record : pending) {
+                    if (RedoRecord(log_record.get())) {
+                        redo_operations_++;
+                    }
+                }
+                pending.clear();
+            }
+        });
+    }
+
+    // 分发：控制记录不需要redo，直接跳过
+    std::vector<std::vector<std::unique_ptr<LogRecord>>> batches(num_workers);
+    for (bool ok = cursor->SeekToLSN(redo_start_lsn_); ok;
+         ok = cursor->Next()) {
+        page_id_t page_id = RedoPageOf(cursor->GetRecord());
+        if (page_id == INVALID_PAGE_ID || !InRedoRange(cursor->GetRecord())) {
+            continue;
+        }
+        size_t worker = static_cast<size_t>(page_id) % num_workers;
+        batches[worker].push_back(cursor->CloneRecord());
+        if (batches[worker].size() >= REDO_DISPATCH_BATCH) {
+            queues[worker].Push(&batches[worker]);
+        }
+    }
+    for (size_t i = 0; i < num_workers; i++) {
+        queues[i].Push(&batches[i]);
+        queues[i].Close();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    LOG_DEBUG("Parallel redo phase completed. " << redo_operations_.load()
+                                                << " operations identified");
+}
+
+bool RecoveryManager::InRedoRange(const LogRecord& log_record) const {
+    if (checkpoint_lsn_ == INVALID_LSN || !dpt_complete_) {
+        return true;
+    }
+    page_id_t page_id = RedoPageOf(log_record);
+    if (page_id == INVALID_PAGE_ID) {
+        return true;
+    }
+    // 新页面还可能要接到前一个页面上，前一个页面不一定在DPT中
+    if (log_record.GetType() == LogRecordType::NEW_PAGE) {
+        return true;
+    }
+    auto it = dirty_page_table_.find(page_id);
+    return it != dirty_page_table_.end() && log_record.GetLSN() >= it->second;
+}
+
+/**
+ * @brief 重做单条日志记录
+ * @param log_record 日志记录
+ * @return 是已提交事务的数据修改记录时返回true
+ *
+ * NEW_PAGE是不属于任何事务的系统记录，总是重做，但不算作数据修改
+ */
+bool RecoveryManager::RedoRecord(const LogRecord* log_record) {
+    txn_id_t txn_id = log_record->GetTxnId();
+    if (log_record->GetType() != LogRecordType::NEW_PAGE &&
+        (active_txn_table_.count(txn_id) > 0 ||
+         aborted_txns_.count(txn_id) > 0)) {
+        return false;  // 未提交事务的修改交给Undo阶段处理
+    }
+    page_id_t page_id = RedoPageOf(*log_record);
+    if (page_id == INVALID_PAGE_ID) {
+        return false;  // BEGIN/COMMIT/ABORT等控制记录不需要redo
+    }
+    if (log_record->GetType() == LogRecordType::NEW_PAGE) {
+        ReplayRecord(*log_record, page_id,
+                     static_cast<const NewPageLogRecord*>(log_record)
+                         ->GetPrevPageId());
+        return false;
+    }
+    ReplayRecord(*log_record, page_id);
+    return true;
+}
+
+/**
+ * @brief 在指定页面上重放一条日志记录
+ *
+ * 按类型分发到各个Redo函数，页面ID由调用者给出：崩溃恢复就是记录里的
+ * 页面，副本是翻译之后的本地页面
+ */
+bool RecoveryManager::ReplayRecord(const LogRecord& log_record,
+                                   page_id_t page_id,
+                                   page_id_t prev_page_id) {
+    switch (log_record.GetType()) {
+        case LogRecordType::INSERT:
+            return RedoInsert(static_cast<const InsertLogRecord*>(&log_record),
+                              page_id);
+        case LogRecordType::MULTI_INSERT:
+            return RedoMultiInsert(
+                static_cast<const MultiInsertLogRecord*>(&log_record),
+                page_id);
+        case LogRecordType::UPDATE:
+            return RedoUpdate(static_cast<const UpdateLogRecord*>(&log_record),
+                              page_id);
+        case LogRecordType::UPDATE_DELTA:
+            return RedoUpdateDelta(
+                static_cast<const UpdateDeltaLogRecord*>(&log_record),
+                page_id);
+        case LogRecordType::DELETE:
+            return RedoDelete(static_cast<const DeleteLogRecord*>(&log_record),
+                              page_id);
+        case LogRecordType::NEW_PAGE:
+            return RedoNewPage(
+                static_cast<const NewPageLogRecord*>(&log_record), page_id,
+                prev_page_id);
+        default:
+            return false;
+    }
+}
+
+/**
+ * 取得要redo的页面并加写锁
+ * 页面LSN不小于日志LSN时这条记录已经反映在页面上，释放页面返回nullptr
+ */
+TablePage* RecoveryManager::FetchRedoPage(page_id_t page_id, lsn_t lsn) {
+    Page* page = FetchTablePage(page_id);
+    if (page == nullptr) {
+        LOG_WARN("Cannot fetch page " << page_id << " for redo");
+        return nullptr;
+    }
+    page->WLatch();
+    auto* table_page = reinterpret_cast<TablePage*>(page);
+    lsn_t page_lsn = table_page->GetPageLSN();
+    if (page_lsn != INVALID_LSN && page_lsn >= lsn) {
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return nullptr;
+    }
+    return table_page;
+}
+
+/**
+ * 释放redo的页面，修改成功时把页面LSN推进到这条记录
+ */
+void RecoveryManager::FinishRedo(TablePage* table_page, lsn_t lsn,
+                                 bool applied) {
+    page_id_t page_id = table_page->GetPageId();
+    if (applied) {
+        table_page->SetPageLSN(lsn);
+        table_page->SetDirty(true);
+    }
+    table_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, applied);
+}
+
+/**
+ * @brief 重做插入操作
+ * 实现思路：tuple的字节原样放回日志里记下的slot，slot已经被占用说明
+ * 页面和日志对不上，不做修改
+ */
+bool RecoveryManager::RedoInsert(const InsertLogRecord* log_record,
+                                 page_id_t page_id) {
+    const RID& rid = log_record->GetRID();
+    TablePage* table_page = FetchRedoPage(page_id, log_record->GetLSN());
+    if (table_page == nullptr) {
+        return false;
+    }
+
+    std::vector<char> image = log_record->GetTupleImage();
+    if (image.empty()) {
+        image.resize(log_record->GetTuple().GetSerializedSize());
+        log_record->GetTuple().SerializeTo(image.data());
+    }
+    bool applied =
+        table_page->InsertTupleAt(rid.slot_num, image.data(), image.size());
+    if (!applied) {
+        LOG_WARN("Redo insert failed on page " << page_id << " slot "
+                                               << rid.slot_num);
+    }
+    FinishRedo(table_page, log_record->GetLSN(), applied);
+    return applied;
+}
+
+/**
+ * @brief 重做批量插入操作，tuple依次放进从第一个RID开始的连续slot
+ */
+bool RecoveryManager::RedoMultiInsert(const MultiInsertLogRecord* log_record,
+                                      page_id_t page_id) {
+    std::vector<std::pair<const char*, size_t>> images;
+    if (!log_record->GetTupleImages(&images)) {
+        LOG_WARN("Malformed multi insert record at LSN "
+                 << log_record->GetLSN());
+        return false;
+    }
+    TablePage* table_page = FetchRedoPage(page_id, log_record->GetLSN());
+    if (table_page == nullptr) {
+        return false;
+    }
+
+    bool applied = !images.empty();
+    for (size_t i = 0; i < images.size() && applied; i++) {
+        applied = table_page->InsertTupleAt(
+            log_record->GetRID(i).slot_num, images[i].first, images[i].second);
+    }
+    if (!applied) {
+        LOG_WARN("Redo multi insert failed on page " << page_id);
+    }
+    FinishRedo(table_page, log_record->GetLSN(), applied);
+    return applied;
+}
+
+/**
+ * @brief 重做更新操作
+ * 实现思路：日志里旧镜像后面紧跟着新镜像，中间没有长度；
+ * 页面上的tuple就是旧镜像，用它的长度切开，字节不一致时不做修改
+ */
+bool RecoveryManager::RedoUpdate(const UpdateLogRecord* log_record,
+                                 page_id_t page_id) {
+    RID rid{page_id, log_record->GetRID().slot_num};
+    TablePage* table_page = FetchRedoPage(page_id, log_record->GetLSN());
+    if (table_page == nullptr) {
+        return false;
+    }
+
+    bool applied = false;
+    const char* old_data = nullptr;
+    size_t old_size = 0;
+    const std::vector<char>& images = log_record->GetTupleImages();
+    if (table_page->GetTupleData(rid, &old_data, &old_size)) {
+        if (images.empty()) {
+            const Tuple& new_tuple = log_record->GetNewTuple();
+            std::vector<char> image(new_tuple.GetSerializedSize());
+            new_tuple.SerializeTo(image.data());
+            applied =
+                table_page->UpdateTupleData(rid, image.data(), image.size());
+        } else if (images.size() > old_size &&
+                   std::memcmp(images.data(), old_data, old_size) == 0) {
+            applied = table_page->UpdateTupleData(
+                rid, images.data() + old_size, images.size() - old_size);
         }
     }
+    if (!applied) {
+        LOG_WARN("Redo update failed for RID " << page_id << ":"
+                                               << rid.slot_num);
+    }
+    FinishRedo(table_page, log_record->GetLSN(), applied);
+    return applied;
+}
 
-    LOG_DEBUG("Redo phase completed. " << redo_operations
-                                       << " operations identified");
+/**
+ * @brief 重做差异更新操作
+ * 实现思路：页面上的tuple就是旧镜像，套用差异得到新镜像后写回
+ */
+bool RecoveryManager::RedoUpdateDelta(const UpdateDeltaLogRecord* log_record,
+                                      page_id_t page_id) {
+    RID rid{page_id, log_record->GetRID().slot_num};
+    TablePage* table_page = FetchRedoPage(page_id, log_record->GetLSN());
+    if (table_page == nullptr) {
+        return false;
+    }
+
+    bool applied = false;
+    const char* old_data = nullptr;
+    size_t old_size = 0;
+    std::vector<char> new_image;
+    if (table_page->GetTupleData(rid, &old_data, &old_size) &&
+        log_record->ApplyRedo(old_data, old_size, &new_image)) {
+        applied = table_page->UpdateTupleData(rid, new_image.data(),
+                                              new_image.size());
+    }
+    if (!applied) {
+        LOG_WARN("Redo delta update failed for RID " << page_id << ":"
+                                                     << rid.slot_num);
+    }
+    FinishRedo(table_page, log_record->GetLSN(), applied);
+    return applied;
 }
 
 /**
- * @brief 重做插入操作的具体实现
- * @param log_record 插入操作的日志记录
+ * @brief 重做新页面
  *
- * 简化实现说明：
- * 当前版本假设数据已经在磁盘上，实际实现中需要：
- * 1. 检查页面LSN是否小于日志LSN
- * 2. 如果需要redo，则重新执行插入操作
- * 3. 更新页面LSN
+ * 实现思路：
+ * 1. 页面可能从没写到磁盘上，用GetSpecificPage取得，文件末尾之外的页面
+ *    是全零的；页面头直接读取，不核对校验值，反正要重新初始化
+ * 2. 页面没有初始化过或者LSN小于日志LSN时重新初始化
+ * 3. 前一个页面还没有后继时接上；前一个页面的其他内容由它自己的记录重做
+ * 4. 文件末尾之外的页面立即写出，磁盘管理器以后不会再把这个ID分配出去
  */
-void RecoveryManager::RedoInsert(const InsertLogRecord* log_record) {
-    LOG_DEBUG("Redo insert for RID " << log_record->GetRID().page_id << ":"
-                                     << log_record->GetRID().slot_num);
+bool RecoveryManager::RedoNewPage(const NewPageLogRecord* log_record,
+                                  page_id_t page_id, page_id_t prev_page_id) {
+    lsn_t lsn = log_record->GetLSN();
+    bool beyond_eof =
+        page_id >= buffer_pool_manager_->GetDiskManager()->GetNumPages();
+    Page* page = buffer_pool_manager_->GetSpecificPage(page_id);
+    if (page == nullptr) {
+        LOG_WARN("Cannot get page " << page_id << " for redo new page");
+        return false;
+    }
+
+    page->WLatch();
+    TablePage::TablePageHeader header;
+    std::memcpy(&header, page->GetData(), sizeof(header));
+    bool applied = header.free_space_offset == 0 || header.lsn < lsn;
+    if (applied) {
+        auto* table_page = reinterpret_cast<TablePage*>(page);
+        table_page->Init(page_id, prev_page_id);
+        table_page->SetPageLSN(lsn);
+        page->SetDirty(true);
+    }
+    page->WUnlatch();
+    if (applied && beyond_eof) {
+        buffer_pool_manager_->FlushPage(page_id);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, applied);
+
+    if (prev_page_id == INVALID_PAGE_ID) {
+        return applied;
+    }
+    Page* prev_page = FetchTablePage(prev_page_id);
+    if (prev_page == nullptr) {
+        LOG_WARN("Cannot fetch page " << prev_page_id
+                                      << " for redo new page link");
+        return applied;
+    }
+    prev_page->WLatch();
+    auto* prev_table_page = reinterpret_cast<TablePage*>(prev_page);
+    bool linked = prev_table_page->GetNextPageId() == INVALID_PAGE_ID;
+    if (linked) {
+        // 不推进前一个页面的LSN：并行redo时它自己更早的记录可能还没重做
+        prev_table_page->SetNextPageId(page_id);
+    }
+    prev_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(prev_page_id, linked);
+    return applied || linked;
 }
 
 /**
- * @brief 重做更新操作的具体实现
- * @param log_record 更新操作的日志记录
+ * 取得表页面并核对校验值
+ * 损坏的页面不能在上面redo/undo，记下错误后和取不到页面一样跳过
  */
-void RecoveryManager::RedoUpdate(const UpdateLogRecord* log_record) {
-    LOG_DEBUG("Redo update for RID " << log_record->GetRID().page_id << ":"
-                                     << log_record->GetRID().slot_num);
+Page* RecoveryManager::FetchTablePage(page_id_t page_id) {
+    Page* page = buffer_pool_manager_->FetchPage(page_id);
+    if (page != nullptr && !page->VerifyChecksum(TablePage::CHECKSUM_OFFSET)) {
+        LOG_ERROR("Checksum mismatch on table page " << page_id
+                                                     << " during recovery");
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return nullptr;
+    }
+    return page;
 }
 
 /**
@@ -365,7 +896,7 @@ void RecoveryManager::RedoUpdate(const UpdateLogRecord* log_record) {
  */
 void RecoveryManager::UndoInsert(const InsertLogRecord* log_record) {
     RID rid = log_record->GetRID();
-    Page* page = buffer_pool_manager_->FetchPage(rid.page_id);
+    Page* page = FetchTablePage(rid.page_id);
     if (page == nullptr) {
         LOG_WARN("Cannot fetch page " << rid.page_id << " for undo insert");
         return;
@@ -397,7 +928,7 @@ void RecoveryManager::UndoInsert(const InsertLogRecord* log_record) {
  */
 void RecoveryManager::UndoUpdate(const UpdateLogRecord* log_record) {
     RID rid = log_record->GetRID();
-    Page* page = buffer_pool_manager_->FetchPage(rid.page_id);
+    Page* page = FetchTablePage(rid.page_id);
     if (page == nullptr) {
         LOG_WARN("Cannot fetch page " << rid.page_id << " for undo update");
         return;
@@ -419,26 +950,22 @@ void RecoveryManager::UndoUpdate(const UpdateLogRecord* log_record) {
     buffer_pool_manager_->UnpinPage(rid.page_id, updated);
 }
 
-void RecoveryManager::RedoDelete(const DeleteLogRecord* log_record) {
-    RID rid = log_record->GetRID();
-    Page* page = buffer_pool_manager_->FetchPage(rid.page_id);
-    if (page == nullptr) {
-        LOG_WARN("Cannot fetch page " << rid.page_id << " for redo delete");
-        return;
+bool RecoveryManager::RedoDelete(const DeleteLogRecord* log_record,
+                                 page_id_t page_id) {
+    RID rid{page_id, log_record->GetRID().slot_num};
+    // 页面LSN不小于日志LSN，说明这次删除已经在磁盘上了
+    TablePage* table_page = FetchRedoPage(page_id, log_record->GetLSN());
+    if (table_page == nullptr) {
+        return false;
     }
-    
-    page->WLatch();
-    auto* table_page = reinterpret_cast<TablePage*>(page);
+
     bool deleted = table_page->DeleteTuple(rid);
-    
     if (deleted) {
-        page->SetDirty(true);
         LOG_DEBUG("Redo delete: deleted tuple at RID " << rid.page_id << ":"
                                                        << rid.slot_num);
     }
-    
-    page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(rid.page_id, deleted);
+    FinishRedo(table_page, log_record->GetLSN(), deleted);
+    return deleted;
 }
 
 /**
@@ -452,7 +979,7 @@ void RecoveryManager::RedoDelete(const DeleteLogRecord* log_record) {
  */
 void RecoveryManager::UndoDelete(const DeleteLogRecord* log_record) {
     RID rid = log_record->GetRID();
-    Page* page = buffer_pool_manager_->FetchPage(rid.page_id);
+    Page* page = FetchTablePage(rid.page_id);
     if (page == nullptr) {
         LOG_WARN("Cannot fetch page " << rid.page_id << " for undo delete");
         return;
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -18,6 +19,9 @@
 
 namespace SimpleRDBMS {
 
+class TablePage;
+class TransactionManager;
+
 /**
  * @brief WAL恢复管理器类
  *
@@ -56,10 +60,13 @@ class RecoveryManager {
     void Recover();
 
     /**
-     * @brief 创建检查点
+     * @brief 创建模糊检查点
+     *
+     * 不写回任何页面，只把活跃事务表和脏页表（带recLSN）写进一条
+     * CHECKPOINT日志记录并刷盘；事务和页面访问不需要暂停
+     * 恢复时从最后一个检查点开始分析，redo从最小的recLSN开始
      *
-     * 将内存中的所有脏页flush到磁盘，并记录检查点信息
-     * 检查点可以减少恢复时需要处理的日志量，提高恢复效率
+     * 活跃事务太多放不进一条记录时跳过这次检查点
      */
     void Checkpoint();
 
@@ -71,14 +78,65 @@ class RecoveryManager {
      */
     void CheckpointWithLogTruncation();
 
+    /**
+     * @brief 设置Redo阶段的并行线程数
+     * @param threads 工作线程数，小于1时按1处理，1表示在当前线程顺序redo
+     *
+     * 并行redo按页面分区：同一个页面的记录总是交给同一个线程，
+     * 按LSN顺序应用，不同页面之间互不依赖
+     */
+    void SetRedoThreads(size_t threads);
+
+    /** @brief 获取Redo阶段的并行线程数 */
+    size_t GetRedoThreads() const { return redo_threads_; }
+
+    /** @brief 获取最近一次Recover中重做的操作数 */
+    size_t GetRedoOperationCount() const { return redo_operations_.load(); }
+
+    /**
+     * @brief 设置事务管理器，检查点从中获取活跃事务表
+     * @param txn_manager 事务管理器，为nullptr时检查点的活跃事务表为空
+     */
+    void SetTransactionManager(TransactionManager* txn_manager) {
+        txn_manager_ = txn_manager;
+    }
+
+    /**
+     * @brief 获取最近一次Recover中redo开始的LSN
+     * @return 没有检查点时为第一条记录的LSN，不需要redo时为INVALID_LSN
+     */
+    lsn_t GetRedoStartLSN() const { return redo_start_lsn_; }
+
+    /**
+     * @brief 在指定页面上重放一条数据修改或者NEW_PAGE日志记录
+     * @param log_record 日志记录，INSERT/UPDATE需要带着tuple的原始字节
+     * @param page_id 要修改的页面，副本上是主库页面翻译成的本地页面
+     * @param prev_page_id NEW_PAGE记录中新页面前面的页面，其他记录不使用
+     * @return 页面确实被修改时返回true；页面LSN不小于日志LSN（已经重放过）
+     *         或者页面内容和日志对不上时返回false
+     *
+     * 和崩溃恢复的redo一样用页面LSN保证幂等，WAL复制的副本也用它重放
+     * 主库发来的日志
+     */
+    bool ReplayRecord(const LogRecord& log_record, page_id_t page_id,
+                      page_id_t prev_page_id = INVALID_PAGE_ID);
+
    private:
     // ====== 核心组件指针 ======
     BufferPoolManager* buffer_pool_manager_;  ///< 缓冲池管理器
     Catalog* catalog_;                        ///< 元数据管理器
     LogManager* log_manager_;                 ///< 日志管理器
     LockManager* lock_manager_;               ///< 锁管理器
+    TransactionManager* txn_manager_{nullptr};  ///< 事务管理器，检查点使用
     lsn_t last_checkpoint_lsn_{
         INVALID_LSN};  ///< 最后一个检查点的LSN，用于日志截断
+    size_t redo_threads_{1};  ///< Redo阶段的并行线程数
+    std::atomic<size_t> redo_operations_{0};  ///< 重做的操作数，工作线程并发累加
+
+    // ====== 最近一次Recover找到的检查点 ======
+    lsn_t checkpoint_lsn_{INVALID_LSN};  ///< 检查点记录的LSN，没有时为INVALID_LSN
+    bool dpt_complete_{false};           ///< 脏页表是否完整，完整时redo按它过滤
+    lsn_t redo_start_lsn_{INVALID_LSN};  ///< redo开始的LSN
 
     // ====== ARIES算法的数据结构 ======
 
@@ -104,30 +162,53 @@ class RecoveryManager {
      *
      * 用途：
      * - Analysis阶段构建，记录可能需要redo的页面
-     * - Redo阶段使用，确定从哪个LSN开始redo
+     * - Redo阶段使用，确定从哪个LSN开始redo，跳过不在表中的页面
      *
-     * 注意：当前实现中暂未完全使用，但保留了接口
+     * 只有找到检查点时才会构建，初始内容来自检查点记录
      */
     std::unordered_map<page_id_t, lsn_t> dirty_page_table_;
 
+    /**
+     * @brief 已中止事务集合
+     *
+     * Analysis阶段构建，Redo阶段跳过这些事务和活跃事务的修改，
+     * 只重做已提交事务的修改
+     */
+    std::unordered_set<txn_id_t> aborted_txns_;
+
     // ====== ARIES算法三个阶段的实现 ======
 
     /**
      * @brief Analysis阶段：分析日志记录确定恢复所需信息
-     * @param log_records 从日志文件读取的所有日志记录
+     * @param cursor 日志游标，各阶段各自从头扫描
      *
      * 工作内容：
      * 1. 扫描所有日志记录
      * 2. 构建活跃事务表(ATT)，识别未提交的事务
      * 3. 构建脏页表(DPT)，识别可能需要redo的页面
      * 4. 为后续的Redo和Undo阶段准备数据结构
+     *
+     * 有检查点时从检查点中的两张表开始，只扫描检查点附近以后的记录
      */
-    void AnalysisPhase(
-        const std::vector<std::unique_ptr<LogRecord>>& log_records);
+    void AnalysisPhase(LogCursor* cursor);
+
+    /**
+     * @brief 逆向查找最后一个CHECKPOINT记录，用它初始化ATT和DPT
+     * @param cursor 日志游标
+     * @return 分析阶段开始扫描的LSN，没有检查点时返回INVALID_LSN
+     */
+    lsn_t LoadLastCheckpoint(LogCursor* cursor);
+
+    /**
+     * @brief 根据脏页表判断一条记录是否可能需要redo
+     * @param log_record 日志记录
+     * @return 页面不在DPT中或LSN小于页面的recLSN时返回false
+     */
+    bool InRedoRange(const LogRecord& log_record) const;
 
     /**
      * @brief Redo阶段：重做所有必要的操作
-     * @param log_records 从日志文件读取的所有日志记录
+     * @param cursor 日志游标
      *
      * 工作内容：
      * 1. 对于每个数据修改类型的日志记录(INSERT/UPDATE/DELETE)
@@ -135,11 +216,20 @@ class RecoveryManager {
      * 3. 重新执行操作，确保已提交事务的修改都被应用
      * 4. 更新页面LSN
      */
-    void RedoPhase(const std::vector<std::unique_ptr<LogRecord>>& log_records);
+    void RedoPhase(LogCursor* cursor);
+
+    /**
+     * @brief 重做单条日志记录
+     * @param log_record 日志记录
+     * @return 记录是需要重做的数据修改时返回true
+     *
+     * 可以被多个redo线程并发调用，调用者保证同一页面的记录不会并发执行
+     */
+    bool RedoRecord(const LogRecord* log_record);
 
     /**
      * @brief Undo阶段：撤销未提交事务的所有操作
-     * @param log_records 从日志文件读取的所有日志记录
+     * @param cursor 日志游标
      *
      * 工作内容：
      * 1. 对于ATT中的每个活跃事务
@@ -147,33 +237,65 @@ class RecoveryManager {
      * 3. 为每个撤销操作生成CLR(Compensation Log Record)
      * 4. 最后为事务生成ABORT日志记录
      */
-    void UndoPhase(const std::vector<std::unique_ptr<LogRecord>>& log_records);
+    void UndoPhase(LogCursor* cursor);
 
     // ====== 具体操作的Redo实现 ======
+    // 都先比较页面LSN和日志LSN，页面已经包含这次修改时什么都不做；
+    // 修改成功后把页面LSN推进到日志LSN，返回页面是否被修改
 
     /**
-     * @brief 重做插入操作
+     * @brief 重做插入操作，tuple的字节放回日志里记下的slot
      * @param log_record 插入操作的日志记录
-     *
-     * 实现逻辑：
-     * 1. 检查页面LSN < 日志LSN，确认需要redo
-     * 2. 重新执行插入操作
-     * 3. 更新页面LSN为当前日志LSN
+     * @param page_id 要修改的页面
      */
-    void RedoInsert(const InsertLogRecord* log_record);
+    bool RedoInsert(const InsertLogRecord* log_record, page_id_t page_id);
 
     /**
-     * @brief 重做更新操作
+     * @brief 重做批量插入操作，和RedoInsert相同，逐个tuple处理
+     * @param log_record 批量插入的日志记录
+     * @param page_id 要修改的页面
+     */
+    bool RedoMultiInsert(const MultiInsertLogRecord* log_record,
+                         page_id_t page_id);
+
+    /**
+     * @brief 重做更新操作，页面上的旧镜像和日志一致时换成新镜像
      * @param log_record 更新操作的日志记录
-     *
-     * 实现逻辑：
-     * 1. 检查页面LSN < 日志LSN，确认需要redo
-     * 2. 将tuple更新为new_value
-     * 3. 更新页面LSN为当前日志LSN
+     * @param page_id 要修改的页面
+     */
+    bool RedoUpdate(const UpdateLogRecord* log_record, page_id_t page_id);
+
+    /**
+     * @brief 重做差异更新操作
+     * @param log_record UPDATE_DELTA日志记录，只包含变化的字节
+     * @param page_id 要修改的页面
+     */
+    bool RedoUpdateDelta(const UpdateDeltaLogRecord* log_record,
+                         page_id_t page_id);
+
+    /**
+     * @brief 重做新页面：初始化页面并接到前一个页面之后
+     * @param log_record NEW_PAGE日志记录
+     * @param page_id 新页面
+     * @param prev_page_id 前一个页面，INVALID_PAGE_ID时只初始化
      */
-    void RedoUpdate(const UpdateLogRecord* log_record);
+    bool RedoNewPage(const NewPageLogRecord* log_record, page_id_t page_id,
+                     page_id_t prev_page_id);
 
-    // void RedoDelete(const DeleteLogRecord* log_record);  // 暂未实现
+    /**
+     * 取得要redo的页面并加写锁
+     * @return 页面LSN不小于lsn或者取不到页面时返回nullptr
+     */
+    TablePage* FetchRedoPage(page_id_t page_id, lsn_t lsn);
+
+    /** 释放FetchRedoPage取得的页面，applied为true时推进页面LSN */
+    void FinishRedo(TablePage* table_page, lsn_t lsn, bool applied);
+
+    /**
+     * 取得表页面并核对校验值
+     * @return 取不到页面或者校验值不对时返回nullptr，页面已经unpin
+     */
+    Page* FetchTablePage(page_id_t page_id);
 
     // ====== 具体操作的Undo实现 ======
 
@@ -213,13 +335,14 @@ class RecoveryManager {
     /**
      * @brief 重做删除操作
      * @param log_record 删除操作的日志记录
+     * @param page_id 要修改的页面
      *
      * 实现逻辑：
      * 1. 找到被删除的tuple位置(通过RID)
      * 2. 删除该tuple
      * 3. 更新页面LSN为当前日志LSN
      */
-    void RedoDelete(const DeleteLogRecord* log_record);
+    bool RedoDelete(const DeleteLogRecord* log_record, page_id_t page_id);
 
     /**
      * @brief 撤销删除操作：重新插入被删除的tuple
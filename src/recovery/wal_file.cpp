@@ -0,0 +1,445 @@
+/*
+ * 文件: wal_file.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 分段WAL文件实现，负责段文件的预分配、顺序追加、落盘和回收
+ */
+
+#include "recovery/wal_file.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "common/debug.h"
+#include "common/exception.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+// 段文件序号的位数，"<base>.000001"
+constexpr int SEGMENT_SEQ_DIGITS = 6;
+
+std::string DirectoryOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        return ".";
+    }
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+std::string FileNameOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool PwriteAll(int fd, const char* data, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t written = pwrite(fd, data, length, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+        offset += written;
+    }
+    return true;
+}
+
+bool PreadAll(int fd, char* data, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t bytes = pread(fd, data, length, offset);
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (bytes == 0) {
+            return false;
+        }
+        data += bytes;
+        length -= static_cast<size_t>(bytes);
+        offset += bytes;
+    }
+    return true;
+}
+
+}  // namespace
+
+/**
+ * 构造函数
+ * 段大小取整到页面的整数倍，然后扫描已有的段文件
+ */
+WalFile::WalFile(const std::string& base_path, size_t segment_size)
+    : base_path_(base_path) {
+    blocks_per_segment_ =
+        std::max<size_t>((segment_size + PAGE_SIZE - 1) / PAGE_SIZE, 1);
+    segment_size_ = blocks_per_segment_ * PAGE_SIZE;
+    Open();
+}
+
+WalFile::~WalFile() {
+    for (const auto& entry : segments_) {
+        close(entry.second);
+    }
+}
+
+std::string WalFile::SegmentPath(const std::string& base_path, uint64_t seq) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), ".%0*llu", SEGMENT_SEQ_DIGITS,
+                  static_cast<unsigned long long>(seq));
+    return base_path + suffix;
+}
+
+std::set<uint64_t> WalFile::ListSegments(const std::string& base_path) {
+    std::set<uint64_t> seqs;
+    std::string prefix = FileNameOf(base_path) + ".";
+
+    DIR* dir = opendir(DirectoryOf(base_path).c_str());
+    if (dir == nullptr) {
+        return seqs;
+    }
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() < prefix.size() + SEGMENT_SEQ_DIGITS ||
+            name.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        std::string digits = name.substr(prefix.size());
+        if (!std::all_of(digits.begin(), digits.end(),
+                         [](unsigned char c) { return std::isdigit(c); })) {
+            continue;
+        }
+        seqs.insert(std::stoull(digits));
+    }
+    closedir(dir);
+    return seqs;
+}
+
+void WalFile::RemoveAll(const std::string& base_path) {
+    for (uint64_t seq : ListSegments(base_path)) {
+        unlink(SegmentPath(base_path, seq).c_str());
+    }
+}
+
+/**
+ * 扫描已有段文件
+ *
+ * 实现思路：
+ * 1. 第一个块有记录的最小序号段就是日志起点，比它小的段是回收到一半的残留，删除
+ * 2. 从起点逐块向后找第一个没有记录的块，就是日志末尾
+ * 3. 末尾所在段的剩余部分清零，末尾之后的段清零后作为备用段，
+ *    避免崩溃时写了一半的数据在将来被当成日志读出
+ */
+void WalFile::Open() {
+    std::set<uint64_t> seqs = ListSegments(base_path_);
+
+    uint64_t begin_seq = seqs.empty() ? 1 : *seqs.begin();
+    for (uint64_t seq : seqs) {
+        int fd = open(SegmentPath(base_path_, seq).c_str(), O_RDWR);
+        if (fd < 0) {
+            throw StorageException("Cannot open log segment " +
+                                   SegmentPath(base_path_, seq) + ": " +
+                                   std::strerror(errno));
+        }
+        segments_[seq] = fd;
+        if (BlockHasRecords(fd, 0)) {
+            begin_seq = seq;
+            break;
+        }
+    }
+
+    // 找日志末尾，段必须连续
+    uint64_t end_block = begin_seq * blocks_per_segment_;
+    for (uint64_t seq = begin_seq; seqs.count(seq) > 0; seq++) {
+        if (segments_.count(seq) == 0) {
+            int fd = open(SegmentPath(base_path_, seq).c_str(), O_RDWR);
+            if (fd < 0) {
+                break;
+            }
+            segments_[seq] = fd;
+        }
+        int fd = segments_[seq];
+        uint64_t block = 0;
+        while (block < blocks_per_segment_ && BlockHasRecords(fd, block)) {
+            block++;
+        }
+        end_block = seq * blocks_per_segment_ + block;
+        if (block < blocks_per_segment_) {
+            break;
+        }
+    }
+    begin_block_ = begin_seq * blocks_per_segment_;
+    end_block_ = end_block;
+
+    uint64_t end_seq = end_block_ / blocks_per_segment_;
+    for (uint64_t seq : seqs) {
+        std::string path = SegmentPath(base_path_, seq);
+        auto it = segments_.find(seq);
+        if (seq < begin_seq) {
+            if (it != segments_.end()) {
+                close(it->second);
+                segments_.erase(it);
+            }
+            unlink(path.c_str());
+        } else if (seq == end_seq && it != segments_.end()) {
+            ZeroRange(it->second,
+                      static_cast<off_t>((end_block_ % blocks_per_segment_) *
+                                         PAGE_SIZE));
+        } else if (seq > end_seq) {
+            int fd = it != segments_.end() ? it->second
+                                           : open(path.c_str(), O_RDWR);
+            if (it != segments_.end()) {
+                segments_.erase(it);
+            }
+            bool keep = fd >= 0 && spare_segments_.size() < MAX_SPARE_SEGMENTS;
+            if (keep) {
+                ZeroRange(fd, 0);
+                spare_segments_.insert(seq);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+            if (!keep) {
+                unlink(path.c_str());
+            }
+        }
+    }
+
+    LOG_DEBUG("WalFile " << base_path_ << ": blocks [" << begin_block_ << ", "
+                         << end_block_ << "), " << spare_segments_.size()
+                         << " spare segments");
+}
+
+bool WalFile::BlockHasRecords(int fd, uint64_t block_in_segment) const {
+    uint32_t first_record_size = 0;
+    if (!PreadAll(fd, reinterpret_cast<char*>(&first_record_size),
+                  sizeof(first_record_size),
+                  static_cast<off_t>(block_in_segment * PAGE_SIZE))) {
+        return false;
+    }
+    return first_record_size != 0;
+}
+
+/**
+ * 清零段文件的一部分
+ * 优先用FALLOC_FL_ZERO_RANGE只改元数据，文件系统不支持时写0
+ */
+void WalFile::ZeroRange(int fd, off_t offset) {
+    off_t end = static_cast<off_t>(segment_size_);
+    if (offset >= end) {
+        return;
+    }
+#ifdef FALLOC_FL_ZERO_RANGE
+    if (fallocate(fd, FALLOC_FL_ZERO_RANGE, offset, end - offset) == 0) {
+        return;
+    }
+#endif
+    std::vector<char> zeros(std::min<size_t>(segment_size_, 64 * PAGE_SIZE), 0);
+    while (offset < end) {
+        size_t length =
+            std::min<size_t>(zeros.size(), static_cast<size_t>(end - offset));
+        if (!PwriteAll(fd, zeros.data(), length, offset)) {
+            throw StorageException("Cannot zero log segment of " + base_path_ +
+                                   ": " + std::strerror(errno));
+        }
+        offset += static_cast<off_t>(length);
+    }
+}
+
+void WalFile::SyncDirectory() const {
+    int fd = open(DirectoryOf(base_path_).c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+/**
+ * 打开一个段
+ * 备用段已经清零并且分配好了空间，直接使用；否则创建新文件并预分配整个段
+ */
+int WalFile::GetSegmentFd(uint64_t seq) {
+    auto it = segments_.find(seq);
+    if (it != segments_.end()) {
+        return it->second;
+    }
+
+    std::string path = SegmentPath(base_path_, seq);
+    bool spare = spare_segments_.erase(seq) > 0;
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw StorageException("Cannot create log segment " + path + ": " +
+                               std::strerror(errno));
+    }
+    if (!spare) {
+        if (posix_fallocate(fd, 0, static_cast<off_t>(segment_size_)) != 0 &&
+            ftruncate(fd, static_cast<off_t>(segment_size_)) != 0) {
+            int error = errno;
+            close(fd);
+            throw StorageException("Cannot preallocate log segment " + path +
+                                   ": " + std::strerror(error));
+        }
+        SyncDirectory();
+        LOG_DEBUG("WalFile: created segment " << path);
+    } else {
+        LOG_DEBUG("WalFile: reusing recycled segment " << path);
+    }
+    segments_[seq] = fd;
+    return fd;
+}
+
+/**
+ * 追加日志块
+ * 按段边界切分，每一段用一次pwrite写入
+ */
+void WalFile::Append(const char* data, size_t num_blocks) {
+    std::lock_guard<std::mutex> lock(latch_);
+    while (num_blocks > 0) {
+        uint64_t seq = end_block_ / blocks_per_segment_;
+        uint64_t block_in_segment = end_block_ % blocks_per_segment_;
+        size_t count = static_cast<size_t>(std::min<uint64_t>(
+            num_blocks, blocks_per_segment_ - block_in_segment));
+
+        int fd = GetSegmentFd(seq);
+        if (!PwriteAll(fd, data, count * PAGE_SIZE,
+                       static_cast<off_t>(block_in_segment * PAGE_SIZE))) {
+            throw StorageException("Failed to write log segment " +
+                                   SegmentPath(base_path_, seq) + ": " +
+                                   std::strerror(errno));
+        }
+        unsynced_segments_.insert(seq);
+
+        data += count * PAGE_SIZE;
+        num_blocks -= count;
+        end_block_ += count;
+    }
+}
+
+void WalFile::Sync() {
+    std::lock_guard<std::mutex> lock(latch_);
+    for (uint64_t seq : unsynced_segments_) {
+        auto it = segments_.find(seq);
+        if (it != segments_.end() && fdatasync(it->second) != 0) {
+            throw StorageException("Failed to sync log segment " +
+                                   SegmentPath(base_path_, seq) + ": " +
+                                   std::strerror(errno));
+        }
+    }
+    unsynced_segments_.clear();
+}
+
+bool WalFile::ReadBlock(uint64_t block, char* data) const {
+    std::lock_guard<std::mutex> lock(latch_);
+    if (block < begin_block_ || block >= end_block_) {
+        return false;
+    }
+    auto it = segments_.find(block / blocks_per_segment_);
+    if (it == segments_.end()) {
+        return false;
+    }
+    return PreadAll(
+        it->second, data, PAGE_SIZE,
+        static_cast<off_t>((block % blocks_per_segment_) * PAGE_SIZE));
+}
+
+/**
+ * 丢弃已经写出的全部日志
+ *
+ * 实现思路：
+ * 1. 当前段已经写了一部分时，后续追加从下一个段开始，保证起点总是段对齐的，
+ *    重启时按"第一个块有记录的段"就能找到起点
+ * 2. 之前的段全部回收
+ */
+void WalFile::Truncate() {
+    std::lock_guard<std::mutex> lock(latch_);
+    uint64_t begin_seq = begin_block_ / blocks_per_segment_;
+    uint64_t new_seq = (end_block_ + blocks_per_segment_ - 1) /
+                       blocks_per_segment_;
+    begin_block_ = end_block_ = new_seq * blocks_per_segment_;
+
+    for (uint64_t seq = begin_seq; seq < new_seq; seq++) {
+        RecycleSegment(seq);
+    }
+    SyncDirectory();
+}
+
+/**
+ * 回收一个段：清零、落盘后改名为一个比所有已知序号都大的备用段
+ * 任何一步失败都退化成直接删除
+ */
+void WalFile::RecycleSegment(uint64_t seq) {
+    std::string path = SegmentPath(base_path_, seq);
+    auto it = segments_.find(seq);
+    if (it == segments_.end()) {
+        unlink(path.c_str());
+        return;
+    }
+    int fd = it->second;
+    segments_.erase(it);
+    unsynced_segments_.erase(seq);
+
+    if (spare_segments_.size() >= MAX_SPARE_SEGMENTS) {
+        close(fd);
+        unlink(path.c_str());
+        return;
+    }
+
+    uint64_t spare_seq = end_block_ / blocks_per_segment_;
+    if (!segments_.empty()) {
+        spare_seq = std::max(spare_seq, segments_.rbegin()->first);
+    }
+    if (!spare_segments_.empty()) {
+        spare_seq = std::max(spare_seq, *spare_segments_.rbegin());
+    }
+    spare_seq++;
+
+    try {
+        ZeroRange(fd, 0);
+        if (fdatasync(fd) != 0 ||
+            rename(path.c_str(), SegmentPath(base_path_, spare_seq).c_str()) !=
+                0) {
+            throw StorageException(std::strerror(errno));
+        }
+        spare_segments_.insert(spare_seq);
+        LOG_DEBUG("WalFile: recycled segment " << seq << " as " << spare_seq);
+    } catch (const std::exception& e) {
+        LOG_WARN("WalFile: cannot recycle segment " << path << ": " << e.what());
+        unlink(path.c_str());
+    }
+    close(fd);
+}
+
+uint64_t WalFile::GetBeginBlock() const {
+    std::lock_guard<std::mutex> lock(latch_);
+    return begin_block_;
+}
+
+uint64_t WalFile::GetEndBlock() const {
+    std::lock_guard<std::mutex> lock(latch_);
+    return end_block_;
+}
+
+size_t WalFile::GetSize() const {
+    std::lock_guard<std::mutex> lock(latch_);
+    return static_cast<size_t>(end_block_ - begin_block_) * PAGE_SIZE;
+}
+
+size_t WalFile::GetSpareSegmentCount() const {
+    std::lock_guard<std::mutex> lock(latch_);
+    return spare_segments_.size();
+}
+
+}  // namespace SimpleRDBMS
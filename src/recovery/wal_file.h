@@ -0,0 +1,151 @@
+/*
+ * 文件: wal_file.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 顺序追加的分段WAL文件，日志不再和数据页面共用一个文件
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "common/config.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * WalFile - 分段的顺序日志文件
+ *
+ * 设计思路：
+ * - 日志由一串段文件组成，命名为"<base>.000001"、"<base>.000002"……
+ *   每个段大小固定（LOG_SEGMENT_SIZE），创建时一次性预分配，
+ *   追加写入不会再引起文件扩展和元数据更新
+ * - 段内按PAGE_SIZE划分为日志块，块号是全局连续编号：
+ *   段seq包含块[seq * 每段块数, (seq + 1) * 每段块数)
+ * - 只在末尾追加整块，写入是纯顺序I/O；Sync用fdatasync落盘
+ * - 每个日志块都以一条记录开头，第一个uint32为0的块就是日志末尾，
+ *   因此段文件在交给写入者之前必须是全0
+ * - Truncate之后完全落在截断点之前的段会被回收：清零后改名为一个
+ *   未来的序号留作备用，写到那里时直接打开使用；备用段超过上限时删除
+ *
+ * 线程安全：所有方法都在latch_保护下执行
+ */
+class WalFile {
+   public:
+    /** 最多保留的备用段数量 */
+    static constexpr size_t MAX_SPARE_SEGMENTS = 2;
+
+    /**
+     * 构造函数 - 打开（或创建）日志
+     * @param base_path 段文件路径前缀
+     * @param segment_size 每个段的大小，向上取整到PAGE_SIZE的倍数
+     *
+     * 已有的段文件会被扫描，找到日志的起点和末尾，之后从末尾继续追加
+     */
+    explicit WalFile(const std::string& base_path,
+                     size_t segment_size = LOG_SEGMENT_SIZE);
+
+    ~WalFile();
+
+    WalFile(const WalFile&) = delete;
+    WalFile& operator=(const WalFile&) = delete;
+
+    /**
+     * 在日志末尾追加若干完整的日志块
+     * @param data 日志块数据，num_blocks * PAGE_SIZE字节
+     * @param num_blocks 块数，可以跨越段边界
+     *
+     * 写入失败抛出StorageException
+     */
+    void Append(const char* data, size_t num_blocks);
+
+    /**
+     * 把上次Sync之后写入的段全部fdatasync
+     * 失败抛出StorageException
+     */
+    void Sync();
+
+    /**
+     * 读取一个日志块
+     * @param block 全局块号，必须位于[GetBeginBlock(), GetEndBlock())
+     * @param data PAGE_SIZE大小的缓冲区
+     * @return 块号越界或读取失败时返回false
+     */
+    bool ReadBlock(uint64_t block, char* data) const;
+
+    /**
+     * 丢弃已经写出的全部日志
+     * 之后的追加从一个新段开始，之前的段全部回收
+     */
+    void Truncate();
+
+    /** 日志中第一个有效块的块号 */
+    uint64_t GetBeginBlock() const;
+
+    /** 下一个要写入的块号 */
+    uint64_t GetEndBlock() const;
+
+    /** 有效日志的字节数 */
+    size_t GetSize() const;
+
+    /** 当前备用段数量 */
+    size_t GetSpareSegmentCount() const;
+
+    /** 每个段的大小 */
+    size_t GetSegmentSize() const { return segment_size_; }
+
+    /** 段文件路径 */
+    static std::string SegmentPath(const std::string& base_path, uint64_t seq);
+
+    /**
+     * 删除base_path下的所有段文件
+     * 主要用于测试清理以及重建日志
+     */
+    static void RemoveAll(const std::string& base_path);
+
+   private:
+    /** 扫描已有段文件，确定起点和末尾，清理末尾之后可能残留的数据 */
+    void Open();
+
+    /** 返回段文件描述符，需要时打开已有的备用段或者创建新段 */
+    int GetSegmentFd(uint64_t seq);
+
+    /** 回收一个段：清零后改名为备用段，备用段已满时直接删除 */
+    void RecycleSegment(uint64_t seq);
+
+    /** 把[offset, segment_size_)清零 */
+    void ZeroRange(int fd, off_t offset);
+
+    /** 块的第一个uint32是否非0，即块里是否有日志记录 */
+    bool BlockHasRecords(int fd, uint64_t block_in_segment) const;
+
+    /** fsync所在目录，让创建和改名持久化 */
+    void SyncDirectory() const;
+
+    /** 目录中base_path的所有段序号 */
+    static std::set<uint64_t> ListSegments(const std::string& base_path);
+
+    std::string base_path_;
+    size_t segment_size_;
+    uint64_t blocks_per_segment_;
+
+    uint64_t begin_block_{0};
+    uint64_t end_block_{0};
+
+    /** 有效段和已经打开的备用段：序号 -> 文件描述符 */
+    std::map<uint64_t, int> segments_;
+
+    /** 备用段序号，都大于当前写入的段 */
+    std::set<uint64_t> spare_segments_;
+
+    /** 上次Sync之后写入过的段 */
+    std::set<uint64_t> unsynced_segments_;
+
+    mutable std::mutex latch_;
+};
+
+}  // namespace SimpleRDBMS
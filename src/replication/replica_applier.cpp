@@ -0,0 +1,306 @@
+/*
+ * 文件: replica_applier.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 副本重放日志的实现
+ */
+
+#include "replication/replica_applier.h"
+
+#include <cstring>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/table_manager.h"
+#include "common/debug.h"
+#include "common/exception.h"
+#include "record/table_heap.h"
+
+namespace SimpleRDBMS {
+
+ReplicaApplier::ReplicaApplier(BufferPoolManager* buffer_pool_manager,
+                               Catalog* catalog, TableManager* table_manager)
+    : buffer_pool_manager_(buffer_pool_manager),
+      catalog_(catalog),
+      table_manager_(table_manager),
+      redo_(buffer_pool_manager, catalog, nullptr, nullptr) {
+    BuildPageMap();
+}
+
+/**
+ * 沿每张行存表的页面链表建立页面映射，基础备份里的页面两边ID相同
+ */
+void ReplicaApplier::BuildPageMap() {
+    for (const auto& table_name : catalog_->GetAllTableNames()) {
+        TableInfo* table = catalog_->GetTable(table_name);
+        if (table == nullptr || table->storage != TableStorage::ROW) {
+            continue;
+        }
+        page_id_t page_id = table->first_page_id;
+        while (page_id != INVALID_PAGE_ID && page_map_.count(page_id) == 0) {
+            Page* page = buffer_pool_manager_->FetchPage(page_id);
+            if (page == nullptr) {
+                LOG_WARN("ReplicaApplier: cannot read page "
+                         << page_id << " of table " << table_name);
+                break;
+            }
+            page_map_[page_id] = PageMapping{table, page_id};
+            page_id_t next_page_id = INVALID_PAGE_ID;
+            page->RLatch();
+            try {
+                next_page_id =
+                    reinterpret_cast<TablePage*>(page)->GetNextPageId();
+            } catch (const StorageException& e) {
+                LOG_WARN("ReplicaApplier: " << e.what());
+            }
+            page->RUnlatch();
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            page_id = next_page_id;
+        }
+    }
+    LOG_INFO("ReplicaApplier: tracking " << page_map_.size()
+                                         << " table pages");
+}
+
+/**
+ * 接收一条记录
+ * 实现思路：
+ * 1. BEGIN或者事务的第一条记录打开事务，记下它的LSN；
+ *    COMMIT/ABORT结束事务。NEW_PAGE等系统记录不属于任何事务
+ * 2. 记录放进等待队列，然后重放可见的前缀
+ */
+void ReplicaApplier::Apply(std::unique_ptr<LogRecord> log_record) {
+    lsn_t lsn = log_record->GetLSN();
+    txn_id_t txn_id = log_record->GetTxnId();
+    LogRecordType type = log_record->GetType();
+    received_lsn_ = lsn;
+
+    pending_.push_back(std::move(log_record));
+    if (type == LogRecordType::COMMIT || type == LogRecordType::ABORT) {
+        auto it = open_txns_.find(txn_id);
+        if (it != open_txns_.end()) {
+            open_txn_first_lsns_.erase(it->second);
+            open_txns_.erase(it);
+        }
+    } else if (type != LogRecordType::CHECKPOINT &&
+               type != LogRecordType::NEW_PAGE &&
+               txn_id != static_cast<txn_id_t>(INVALID_TXN_ID) &&
+               open_txns_.count(txn_id) == 0) {
+        open_txns_[txn_id] = lsn;
+        open_txn_first_lsns_.insert(lsn);
+    }
+
+    Drain(pending_.size() > REPLICA_MAX_PENDING_RECORDS);
+}
+
+void ReplicaApplier::Drain(bool force) {
+    if (force) {
+        LOG_WARN("ReplicaApplier: " << pending_.size()
+                                    << " records waiting for open "
+                                       "transactions, applying them now");
+    }
+    while (!pending_.empty()) {
+        const LogRecord& log_record = *pending_.front();
+        if (!force && !open_txn_first_lsns_.empty() &&
+            log_record.GetLSN() >= *open_txn_first_lsns_.begin()) {
+            break;
+        }
+        ApplyRecord(log_record);
+        applied_lsn_ = log_record.GetLSN();
+        pending_.pop_front();
+    }
+}
+
+void ReplicaApplier::ApplyRecord(const LogRecord& log_record) {
+    switch (log_record.GetType()) {
+        case LogRecordType::NEW_PAGE:
+            ApplyNewPage(static_cast<const NewPageLogRecord&>(log_record));
+            break;
+        case LogRecordType::INSERT:
+            ApplyTupleChange(
+                log_record,
+                static_cast<const InsertLogRecord&>(log_record).GetRID());
+            break;
+        case LogRecordType::MULTI_INSERT:
+            ApplyTupleChange(
+                log_record,
+                static_cast<const MultiInsertLogRecord&>(log_record).GetRID());
+            break;
+        case LogRecordType::UPDATE:
+            ApplyTupleChange(
+                log_record,
+                static_cast<const UpdateLogRecord&>(log_record).GetRID());
+            break;
+        case LogRecordType::UPDATE_DELTA:
+            ApplyTupleChange(
+                log_record,
+                static_cast<const UpdateDeltaLogRecord&>(log_record).GetRID());
+            break;
+        case LogRecordType::DELETE:
+            ApplyTupleChange(
+                log_record,
+                static_cast<const DeleteLogRecord&>(log_record).GetRID());
+            break;
+        default:
+            break;  // BEGIN/COMMIT/ABORT/CHECKPOINT不修改页面
+    }
+}
+
+/**
+ * 重放NEW_PAGE
+ * 实现思路：
+ * 1. 前一个页面不认识时跳过，这张表不在副本上
+ * 2. 页面已经在映射里并且本地页面包含这条记录，说明页面来自基础备份
+ * 3. 否则申请一个本地页面，初始化并接到前一个页面的本地页面之后，
+ *    再通知表堆更新页面目录和末尾页面
+ */
+void ReplicaApplier::ApplyNewPage(const NewPageLogRecord& log_record) {
+    auto prev = page_map_.find(log_record.GetPrevPageId());
+    if (prev == page_map_.end()) {
+        skipped_records_++;
+        LOG_DEBUG("ReplicaApplier: skipping new page "
+                  << log_record.GetPageId() << " of an unknown table");
+        return;
+    }
+    auto known = page_map_.find(log_record.GetPageId());
+    if (known != page_map_.end() &&
+        ReadPageLSN(known->second.local_page_id) >= log_record.GetLSN()) {
+        return;
+    }
+
+    PageMapping mapping{prev->second.table, INVALID_PAGE_ID};
+    page_id_t prev_local_page_id = prev->second.local_page_id;
+    Page* page = buffer_pool_manager_->NewPage(&mapping.local_page_id);
+    if (page == nullptr) {
+        LOG_ERROR("ReplicaApplier: cannot allocate a page for primary page "
+                  << log_record.GetPageId());
+        return;
+    }
+    buffer_pool_manager_->UnpinPage(mapping.local_page_id, true);
+
+    if (redo_.ReplayRecord(log_record, mapping.local_page_id,
+                           prev_local_page_id)) {
+        applied_records_++;
+    }
+    page_map_[log_record.GetPageId()] = mapping;
+    mapping.table->table_heap->OnPageAppended(prev_local_page_id,
+                                              mapping.local_page_id);
+}
+
+/**
+ * 重放记录的增删改
+ * 实现思路：
+ * 1. 主库页面翻译成本地页面，不认识的页面跳过
+ * 2. 重放前读出旧记录（删除和更新需要），重放后读出新记录
+ *    （插入和更新需要），只有页面确实被修改时才维护索引
+ * 3. 页面上的记录变了，丢弃页面的区域摘要
+ */
+void ReplicaApplier::ApplyTupleChange(const LogRecord& log_record,
+                                      const RID& rid) {
+    auto it = page_map_.find(rid.page_id);
+    if (it == page_map_.end()) {
+        skipped_records_++;
+        LOG_DEBUG("ReplicaApplier: skipping LSN " << log_record.GetLSN()
+                                                  << " on unknown page "
+                                                  << rid.page_id);
+        return;
+    }
+    TableInfo* table = it->second.table;
+    page_id_t local_page_id = it->second.local_page_id;
+    RID local_rid{local_page_id, rid.slot_num};
+    LogRecordType type = log_record.GetType();
+
+    Tuple old_tuple;
+    bool has_old = (type == LogRecordType::DELETE ||
+                    type == LogRecordType::UPDATE ||
+                    type == LogRecordType::UPDATE_DELTA) &&
+                   ReadTuple(table, local_rid, &old_tuple);
+
+    if (!redo_.ReplayRecord(log_record, local_page_id)) {
+        return;
+    }
+    applied_records_++;
+    table->table_heap->InvalidatePageZone(local_page_id);
+
+    const std::string& table_name = table->table_name;
+    switch (type) {
+        case LogRecordType::INSERT: {
+            Tuple tuple;
+            if (ReadTuple(table, local_rid, &tuple)) {
+                table_manager_->UpdateIndexesOnInsert(table_name, tuple,
+                                                      local_rid);
+            }
+            break;
+        }
+        case LogRecordType::MULTI_INSERT: {
+            const auto& multi =
+                static_cast<const MultiInsertLogRecord&>(log_record);
+            for (size_t i = 0; i < multi.GetTupleCount(); i++) {
+                RID tuple_rid{local_page_id, multi.GetRID(i).slot_num};
+                Tuple tuple;
+                if (ReadTuple(table, tuple_rid, &tuple)) {
+                    table_manager_->UpdateIndexesOnInsert(table_name, tuple,
+                                                          tuple_rid);
+                }
+            }
+            break;
+        }
+        case LogRecordType::UPDATE:
+        case LogRecordType::UPDATE_DELTA: {
+            Tuple new_tuple;
+            if (has_old && ReadTuple(table, local_rid, &new_tuple)) {
+                table_manager_->UpdateIndexesOnUpdate(table_name, old_tuple,
+                                                      new_tuple, local_rid);
+            }
+            break;
+        }
+        case LogRecordType::DELETE:
+            if (has_old) {
+                table_manager_->UpdateIndexesOnDelete(table_name, old_tuple);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+bool ReplicaApplier::ReadTuple(TableInfo* table, const RID& rid,
+                               Tuple* tuple) {
+    Page* page = buffer_pool_manager_->FetchPage(rid.page_id);
+    if (page == nullptr) {
+        return false;
+    }
+    page->RLatch();
+    bool found = false;
+    try {
+        found = reinterpret_cast<TablePage*>(page)->GetTuple(
+            rid, tuple, table->schema.get());
+    } catch (const StorageException& e) {
+        LOG_WARN("ReplicaApplier: " << e.what());
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(rid.page_id, false);
+    if (found) {
+        tuple->SetRID(rid);
+    }
+    return found;
+}
+
+lsn_t ReplicaApplier::ReadPageLSN(page_id_t page_id) {
+    Page* page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+        return INVALID_LSN;
+    }
+    page->RLatch();
+    lsn_t lsn = INVALID_LSN;
+    try {
+        lsn = reinterpret_cast<TablePage*>(page)->GetPageLSN();
+    } catch (const StorageException& e) {
+        LOG_WARN("ReplicaApplier: " << e.what());
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return lsn;
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,124 @@
+/*
+ * 文件: replica_applier.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: WAL复制的副本一端：把主库发来的日志记录重放到本地的表页面上，
+ *       同时维护索引
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <set>
+#include <unordered_map>
+
+#include "catalog/catalog.h"
+#include "recovery/log_record.h"
+#include "recovery/recovery_manager.h"
+
+namespace SimpleRDBMS {
+
+class BufferPoolManager;
+class TableManager;
+
+/**
+ * ReplicaApplier - 在副本上重放主库的WAL
+ *
+ * 副本从主库数据文件的一份拷贝（检查点之后复制的基础备份）开始，
+ * 之后只靠重放日志变化：
+ *
+ * - 页面翻译：主库的页面ID翻译成本地页面ID。开始时沿每张表的页面链表
+ *   建立映射，基础备份里已有的页面原样对应；之后主库扩展表时的NEW_PAGE
+ *   记录在本地申请一个新页面接到同一张表的末尾，两边的页面ID不必相同。
+ *   本地页面已经包含这条NEW_PAGE（页面LSN不小于它）时说明页面在备份里，
+ *   不再申请；否则是主库释放后又重新使用的页面，映射到新申请的本地页面
+ * - 重放：数据修改用RecoveryManager::ReplayRecord按页面LSN幂等地重放，
+ *   所以从主库现存最早的日志开始接收也没有问题，备份里已有的修改会被跳过
+ * - 索引：索引的修改不写日志，记录确实被重放时由TableManager维护，
+ *   重放前读出旧记录，重放后读出新记录
+ * - 可见性：事务的记录先攒着，只重放LSN小于所有未结束事务第一条记录的
+ *   前缀，读副本的查询不会看到还没提交的修改；攒的记录超过
+ *   REPLICA_MAX_PENDING_RECORDS时不再等待，直接重放
+ *
+ * 中止的事务在主库上并不物理回滚，所以它们的记录同样重放，两边的页面
+ * 保持一致。不认识的页面（副本建立以后新建的表、DDL、列存表）上的记录
+ * 跳过并计数。
+ *
+ * 只由接收线程调用Apply；统计信息可以从任意线程读取
+ */
+class ReplicaApplier {
+   public:
+    /**
+     * @param buffer_pool_manager 副本的缓冲池
+     * @param catalog 副本的catalog，表和索引来自基础备份
+     * @param table_manager 维护索引使用，一般是执行引擎的表管理器
+     */
+    ReplicaApplier(BufferPoolManager* buffer_pool_manager, Catalog* catalog,
+                   TableManager* table_manager);
+
+    /**
+     * 接收一条主库的日志记录，按LSN顺序调用
+     * 能够确定可见的前缀会在这次调用里重放
+     */
+    void Apply(std::unique_ptr<LogRecord> log_record);
+
+    /** 收到的最后一条记录的LSN，重连时从它的下一条开始，没有时为INVALID_LSN */
+    lsn_t GetReceivedLSN() const { return received_lsn_.load(); }
+
+    /** 重放完的最后一条记录的LSN，没有时为INVALID_LSN */
+    lsn_t GetAppliedLSN() const { return applied_lsn_.load(); }
+
+    /** 重放时真正修改了页面的记录数 */
+    size_t GetAppliedRecordCount() const { return applied_records_.load(); }
+
+    /** 因为页面不认识而跳过的记录数 */
+    size_t GetSkippedRecordCount() const { return skipped_records_.load(); }
+
+   private:
+    /** 主库页面在本地对应的表和页面 */
+    struct PageMapping {
+        TableInfo* table;
+        page_id_t local_page_id;
+    };
+
+    void BuildPageMap();
+
+    /**
+     * 重放可见的前缀
+     * @param force 不再等待未结束的事务，全部重放
+     */
+    void Drain(bool force);
+
+    void ApplyRecord(const LogRecord& log_record);
+    void ApplyNewPage(const NewPageLogRecord& log_record);
+    void ApplyTupleChange(const LogRecord& log_record, const RID& rid);
+
+    /** 读出本地页面上的一条记录，记录不存在时返回false */
+    bool ReadTuple(TableInfo* table, const RID& rid, Tuple* tuple);
+
+    /** 页面头中的LSN，页面读取失败时为INVALID_LSN */
+    lsn_t ReadPageLSN(page_id_t page_id);
+
+    BufferPoolManager* buffer_pool_manager_;
+    Catalog* catalog_;
+    TableManager* table_manager_;
+    RecoveryManager redo_;  // 只用ReplayRecord，不做崩溃恢复
+
+    std::unordered_map<page_id_t, PageMapping> page_map_;
+
+    // 等待重放的记录，按LSN顺序
+    std::deque<std::unique_ptr<LogRecord>> pending_;
+    // 未结束的事务和它们的第一条记录
+    std::unordered_map<txn_id_t, lsn_t> open_txns_;
+    std::set<lsn_t> open_txn_first_lsns_;
+
+    std::atomic<lsn_t> received_lsn_{INVALID_LSN};
+    std::atomic<lsn_t> applied_lsn_{INVALID_LSN};
+    std::atomic<size_t> applied_records_{0};
+    std::atomic<size_t> skipped_records_{0};
+};
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,206 @@
+/*
+ * 文件: wal_receiver.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: WAL接收线程的实现
+ */
+
+#include "replication/wal_receiver.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "common/config.h"
+#include "common/debug.h"
+#include "recovery/log_record.h"
+#include "replication/replica_applier.h"
+#include "replication/wal_sender.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+/** 一次recv最多读这么多字节 */
+constexpr size_t RECEIVE_CHUNK_BYTES = 64 * 1024;
+
+}  // namespace
+
+WalReceiver::WalReceiver(ReplicaApplier* applier, std::string host,
+                         uint16_t port)
+    : applier_(applier), host_(std::move(host)), port_(port) {}
+
+WalReceiver::~WalReceiver() { Stop(); }
+
+void WalReceiver::Start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    thread_ = std::thread(&WalReceiver::Run, this);
+}
+
+void WalReceiver::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void WalReceiver::Run() {
+    while (running_) {
+        int fd = Connect();
+        if (fd < 0) {
+            Sleep(REPLICATION_RETRY_INTERVAL_MS);
+            continue;
+        }
+        connected_ = true;
+        Receive(fd);
+        connected_ = false;
+        ::close(fd);
+        if (running_) {
+            LOG_INFO("WalReceiver: disconnected from primary " << host_ << ":"
+                                                               << port_);
+            Sleep(REPLICATION_RETRY_INTERVAL_MS);
+        }
+    }
+}
+
+/**
+ * 连接主库并发送握手消息
+ * @return 连接好的socket，失败时返回-1
+ */
+int WalReceiver::Connect() {
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    std::string port = std::to_string(port_);
+    if (::getaddrinfo(host_.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        LOG_WARN("WalReceiver: cannot resolve primary host " << host_);
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* ai = addresses; ai != nullptr; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(addresses);
+    if (fd < 0) {
+        LOG_DEBUG("WalReceiver: cannot connect to primary " << host_ << ":"
+                                                            << port_);
+        return -1;
+    }
+
+    int enable = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    ::setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+
+    // 从收到的最后一条记录之后开始，什么都没收到时从主库最早的记录开始
+    lsn_t received = applier_->GetReceivedLSN();
+    int64_t start_lsn = received == INVALID_LSN ? 0 : int64_t(received) + 1;
+    char handshake[REPLICATION_HANDSHAKE_SIZE];
+    std::memcpy(handshake, REPLICATION_MAGIC, sizeof(REPLICATION_MAGIC));
+    std::memcpy(handshake + sizeof(REPLICATION_MAGIC),
+                &REPLICATION_PROTOCOL_VERSION, sizeof(uint32_t));
+    std::memcpy(handshake + sizeof(REPLICATION_MAGIC) + sizeof(uint32_t),
+                &start_lsn, sizeof(start_lsn));
+    if (::send(fd, handshake, sizeof(handshake), MSG_NOSIGNAL) !=
+        static_cast<ssize_t>(sizeof(handshake))) {
+        ::close(fd);
+        return -1;
+    }
+    LOG_INFO("WalReceiver: connected to primary " << host_ << ":" << port_
+                                                  << ", starting at LSN "
+                                                  << start_lsn);
+    return fd;
+}
+
+/**
+ * 接收日志
+ * 实现思路：
+ * 1. 每个轮询间隔检查一次停止标志，有数据时追加到缓冲区末尾
+ * 2. 从缓冲区开头切出完整的记录（长度字段 + 记录），解析后交给重放；
+ *    长度超过一个日志块的数据不可能是WAL记录，当作协议错误断开
+ * 3. 剩下的不完整记录移到缓冲区开头，等下一次接收
+ */
+void WalReceiver::Receive(int fd) {
+    std::vector<char> buffer;
+    size_t filled = 0;
+    while (running_) {
+        pollfd pfd{fd, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, REPLICATION_POLL_INTERVAL_MS);
+        if (ready < 0 && errno != EINTR) {
+            return;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+
+        buffer.resize(filled + RECEIVE_CHUNK_BYTES);
+        ssize_t n = ::recv(fd, buffer.data() + filled, RECEIVE_CHUNK_BYTES, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        filled += static_cast<size_t>(n);
+
+        size_t offset = 0;
+        while (filled - offset >= sizeof(uint32_t)) {
+            uint32_t record_size;
+            std::memcpy(&record_size, buffer.data() + offset,
+                        sizeof(record_size));
+            if (record_size < LOG_RECORD_HEADER_SIZE ||
+                record_size > LOG_BLOCK_DATA_SIZE) {
+                LOG_ERROR("WalReceiver: invalid record size "
+                          << record_size << " from primary");
+                return;
+            }
+            size_t total = sizeof(uint32_t) + record_size;
+            if (filled - offset < total) {
+                break;
+            }
+            auto log_record =
+                LogRecord::DeserializeFrom(buffer.data() + offset, total);
+            if (log_record == nullptr) {
+                LOG_ERROR("WalReceiver: malformed record from primary");
+                return;
+            }
+            applier_->Apply(std::move(log_record));
+            offset += total;
+        }
+        std::memmove(buffer.data(), buffer.data() + offset, filled - offset);
+        filled -= offset;
+    }
+}
+
+void WalReceiver::Sleep(int milliseconds) {
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(milliseconds);
+    while (running_ && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(
+            std::min(milliseconds, REPLICATION_POLL_INTERVAL_MS)));
+    }
+}
+
+}  // namespace SimpleRDBMS
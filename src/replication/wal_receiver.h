@@ -0,0 +1,69 @@
+/*
+ * 文件: wal_receiver.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: WAL复制的副本一端：连接主库，接收WAL记录交给ReplicaApplier重放
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace SimpleRDBMS {
+
+class ReplicaApplier;
+
+/**
+ * WalReceiver - 从主库接收WAL
+ *
+ * 后台线程连接主库的复制端口，发送握手消息（协议见WalSender），之后把收到
+ * 的字节流切成一条条WAL记录，用LogRecord::DeserializeFrom解析后按顺序交给
+ * ReplicaApplier。连接断开或者收到无法解析的数据时关闭连接，隔
+ * REPLICATION_RETRY_INTERVAL_MS重连，从收到的最后一条记录之后继续
+ */
+class WalReceiver {
+   public:
+    /**
+     * @param applier 重放日志的对象，只由接收线程调用
+     * @param host 主库地址（IPv4地址或者主机名）
+     * @param port 主库的复制端口
+     */
+    WalReceiver(ReplicaApplier* applier, std::string host, uint16_t port);
+    ~WalReceiver();
+
+    WalReceiver(const WalReceiver&) = delete;
+    WalReceiver& operator=(const WalReceiver&) = delete;
+
+    /** 启动接收线程 */
+    void Start();
+
+    /** 断开连接并等待接收线程退出 */
+    void Stop();
+
+    /** 当前是否连着主库 */
+    bool IsConnected() const { return connected_.load(); }
+
+   private:
+    void Run();
+    int Connect();
+
+    /**
+     * 在一个连接上接收日志，直到停止、断开或者收到坏数据
+     */
+    void Receive(int fd);
+
+    /** 睡眠一段时间，期间停止时提前返回 */
+    void Sleep(int milliseconds);
+
+    ReplicaApplier* applier_;
+    std::string host_;
+    uint16_t port_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> connected_{false};
+    std::thread thread_;
+};
+
+}  // namespace SimpleRDBMS
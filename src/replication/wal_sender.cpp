@@ -0,0 +1,273 @@
+/*
+ * 文件: wal_sender.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: WAL发送线程的实现
+ */
+
+#include "replication/wal_sender.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "common/debug.h"
+#include "recovery/log_cursor.h"
+#include "recovery/log_manager.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+/** 攒够这么多字节的记录发送一次 */
+constexpr size_t SEND_BATCH_BYTES = 64 * 1024;
+
+/**
+ * 在超时之内读满size字节，期间每隔一个轮询间隔检查一次停止标志
+ */
+bool ReceiveAll(int fd, char* data, size_t size,
+                const std::atomic<bool>& running) {
+    size_t received = 0;
+    while (received < size && running) {
+        pollfd pfd{fd, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, REPLICATION_POLL_INTERVAL_MS);
+        if (ready < 0 && errno != EINTR) {
+            return false;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        ssize_t n = ::recv(fd, data + received, size - received, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        received += static_cast<size_t>(n);
+    }
+    return received == size;
+}
+
+}  // namespace
+
+WalSender::WalSender(LogManager* log_manager, uint16_t port)
+    : log_manager_(log_manager), port_(port) {}
+
+WalSender::~WalSender() { Stop(); }
+
+bool WalSender::Start() {
+    if (running_) {
+        return true;
+    }
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        LOG_ERROR("WalSender: cannot create socket: " << std::strerror(errno));
+        return false;
+    }
+    int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port_);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) <
+            0 ||
+        ::listen(listen_fd_, SOMAXCONN) < 0) {
+        LOG_ERROR("WalSender: cannot listen on port " << port_ << ": "
+                                                      << std::strerror(errno));
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    socklen_t addr_len = sizeof(addr);
+    if (::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr),
+                      &addr_len) == 0) {
+        port_ = ntohs(addr.sin_port);
+    }
+
+    running_ = true;
+    accept_thread_ = std::thread(&WalSender::AcceptLoop, this);
+    LOG_INFO("WalSender: listening for replicas on port " << port_);
+    return true;
+}
+
+/**
+ * 停止发送
+ * 实现思路：先清掉运行标志让各个线程在下一个轮询间隔退出，
+ * 再shutdown副本的连接，唤醒阻塞在send里的线程
+ */
+void WalSender::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (accept_thread_.joinable()) {
+        accept_thread_.join();
+    }
+
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        for (int fd : replica_fds_) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+        threads.swap(replica_threads_);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+}
+
+void WalSender::AcceptLoop() {
+    while (running_) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, REPLICATION_POLL_INTERVAL_MS);
+        if (ready <= 0) {
+            continue;
+        }
+        sockaddr_in addr{};
+        socklen_t addr_len = sizeof(addr);
+        int fd = ::accept(listen_fd_, reinterpret_cast<sockaddr*>(&addr),
+                          &addr_len);
+        if (fd < 0) {
+            continue;
+        }
+        int enable = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        ::setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+
+        char address[INET_ADDRSTRLEN] = {0};
+        ::inet_ntop(AF_INET, &addr.sin_addr, address, sizeof(address));
+        LOG_INFO("WalSender: replica connected from " << address << ":"
+                                                      << ntohs(addr.sin_port));
+
+        std::lock_guard<std::mutex> guard(latch_);
+        replica_fds_.push_back(fd);
+        replica_threads_.emplace_back(&WalSender::ServeReplica, this, fd);
+    }
+}
+
+void WalSender::ServeReplica(int fd) {
+    replica_count_++;
+    lsn_t start_lsn = INVALID_LSN;
+    if (ReceiveHandshake(fd, &start_lsn)) {
+        StreamLog(fd, start_lsn);
+    }
+    replica_count_--;
+
+    std::lock_guard<std::mutex> guard(latch_);
+    for (size_t i = 0; i < replica_fds_.size(); i++) {
+        if (replica_fds_[i] == fd) {
+            replica_fds_.erase(replica_fds_.begin() + i);
+            break;
+        }
+    }
+    ::close(fd);
+}
+
+bool WalSender::ReceiveHandshake(int fd, lsn_t* start_lsn) {
+    char handshake[REPLICATION_HANDSHAKE_SIZE];
+    if (!ReceiveAll(fd, handshake, sizeof(handshake), running_)) {
+        return false;
+    }
+    uint32_t version;
+    int64_t lsn;
+    std::memcpy(&version, handshake + sizeof(REPLICATION_MAGIC),
+                sizeof(version));
+    std::memcpy(&lsn, handshake + sizeof(REPLICATION_MAGIC) + sizeof(version),
+                sizeof(lsn));
+    if (std::memcmp(handshake, REPLICATION_MAGIC, sizeof(REPLICATION_MAGIC)) !=
+            0 ||
+        version != REPLICATION_PROTOCOL_VERSION) {
+        LOG_WARN("WalSender: rejected connection with a bad handshake");
+        return false;
+    }
+    *start_lsn = static_cast<lsn_t>(lsn);
+    return true;
+}
+
+/**
+ * 流式发送日志
+ * 实现思路：
+ * 1. 已经持久化的LSN还没到next时等待，每个轮询间隔检查一次停止标志
+ * 2. 否则创建游标（只看得到已经写出的块），从next开始把记录原样攒进
+ *    发送缓冲，攒够一批发送一次，读完再发送剩下的
+ * 3. next大于0时找到的记录必须正好从next开始，LSN是连续分配的，
+ *    不连续说明中间的日志已经被截断
+ */
+void WalSender::StreamLog(int fd, lsn_t start_lsn) {
+    lsn_t next = start_lsn > 0 ? start_lsn : 0;
+    bool contiguous = start_lsn > 0;
+    std::string batch;
+    auto interval = std::chrono::milliseconds(REPLICATION_POLL_INTERVAL_MS);
+
+    while (running_) {
+        if (log_manager_->GetPersistentLSN() < next) {
+            log_manager_->WaitForPersistentLSN(next, interval);
+            continue;
+        }
+
+        auto cursor = log_manager_->CreateLogCursor();
+        size_t sent = 0;
+        for (bool ok = cursor->SeekToLSN(next); ok && running_;
+             ok = cursor->Next()) {
+            lsn_t lsn = cursor->GetRecord().GetLSN();
+            if (contiguous && lsn != next) {
+                LOG_ERROR("WalSender: log needed by replica was truncated, "
+                          "wanted LSN "
+                          << next << " but oldest available is " << lsn);
+                return;
+            }
+            batch.append(cursor->GetRawRecord(), cursor->GetRawRecordSize());
+            next = lsn + 1;
+            contiguous = true;
+            sent++;
+            if (batch.size() >= SEND_BATCH_BYTES) {
+                if (!SendAll(fd, batch.data(), batch.size())) {
+                    return;
+                }
+                batch.clear();
+            }
+        }
+        if (!batch.empty()) {
+            if (!SendAll(fd, batch.data(), batch.size())) {
+                return;
+            }
+            batch.clear();
+        }
+        if (sent == 0) {
+            // 持久化LSN已经到了但块里没有更新的记录（比如刚截断过日志）
+            std::this_thread::sleep_for(interval);
+        }
+    }
+}
+
+bool WalSender::SendAll(int fd, const char* data, size_t size) {
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t n = ::send(fd, data + sent, size - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_INFO("WalSender: replica disconnected: "
+                     << std::strerror(errno));
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace SimpleRDBMS
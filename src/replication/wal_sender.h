@@ -0,0 +1,103 @@
+/*
+ * 文件: wal_sender.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: WAL复制的主库一端：监听副本的连接，把已经持久化的WAL记录
+ *       原样流式发送给副本
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+
+namespace SimpleRDBMS {
+
+class LogManager;
+
+/** 复制连接握手的魔数和版本 */
+static constexpr char REPLICATION_MAGIC[8] = {'S', 'R', 'D', 'B',
+                                              'R', 'E', 'P', 'L'};
+static constexpr uint32_t REPLICATION_PROTOCOL_VERSION = 1;
+
+/** 握手消息：魔数、版本号、副本想要的第一条记录的LSN（本机字节序） */
+static constexpr size_t REPLICATION_HANDSHAKE_SIZE =
+    sizeof(REPLICATION_MAGIC) + sizeof(uint32_t) + sizeof(int64_t);
+
+/**
+ * WalSender - 把WAL发送给副本
+ *
+ * 协议：
+ * - 副本连上以后先发握手消息，start_lsn不大于0表示从主库现存最早的记录开始
+ * - 之后主库只发送数据：一条接一条的WAL记录，和日志块里的字节完全相同
+ *   （uint32长度字段 + 记录头 + 数据，见LogManager），副本用
+ *   LogRecord::DeserializeFrom解析
+ *
+ * 每个副本一个线程：
+ * - 用日志游标从下一条要发的LSN开始读已经写出的日志块，攒够一批发送一次
+ * - 追上以后用LogManager::WaitForPersistentLSN等待新的日志，只发送已经
+ *   持久化的记录，副本不会领先于主库的磁盘
+ * - 副本要的LSN已经被日志截断回收（找到的第一条记录的LSN更大）时
+ *   记下错误并断开，这样的副本要重新拷贝数据文件
+ *
+ * 发送失败（副本断开）时线程退出，副本重连后从它收到的最后一条记录之后继续
+ */
+class WalSender {
+   public:
+    /**
+     * @param log_manager 主库的日志管理器
+     * @param port 监听端口，0表示由系统分配（测试使用），见GetPort
+     */
+    WalSender(LogManager* log_manager, uint16_t port);
+    ~WalSender();
+
+    WalSender(const WalSender&) = delete;
+    WalSender& operator=(const WalSender&) = delete;
+
+    /**
+     * 开始监听并启动接受连接的线程
+     * @return 端口绑定或者监听失败时返回false
+     */
+    bool Start();
+
+    /** 停止接受连接，断开所有副本并等待线程退出 */
+    void Stop();
+
+    /** 实际监听的端口，Start成功以后有效 */
+    uint16_t GetPort() const { return port_; }
+
+    /** 当前连接着的副本数 */
+    size_t GetReplicaCount() const { return replica_count_.load(); }
+
+   private:
+    void AcceptLoop();
+    void ServeReplica(int fd);
+
+    /**
+     * 从start_lsn开始把日志发给副本，直到停止或者发送失败
+     */
+    void StreamLog(int fd, lsn_t start_lsn);
+
+    bool ReceiveHandshake(int fd, lsn_t* start_lsn);
+    bool SendAll(int fd, const char* data, size_t size);
+
+    LogManager* log_manager_;
+    uint16_t port_;
+    int listen_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> replica_count_{0};
+    std::thread accept_thread_;
+
+    std::mutex latch_;                  // 保护下面两个成员
+    std::vector<std::thread> replica_threads_;
+    std::vector<int> replica_fds_;      // Stop时用shutdown唤醒阻塞的发送
+};
+
+}  // namespace SimpleRDBMS
@@ -59,10 +59,13 @@ void ConfigManager::UpdateThreadConfig(const ThreadConfig& config) {
 void ConfigManager::UpdateDatabaseConfig(const DatabaseConfig& config) {
     auto& db_config = server_config_.GetDatabaseConfig();
     std::string old_file = db_config.database_file;
+    size_t old_pool_size = db_config.buffer_pool_size;
     
     db_config = config;
     
     NotifyConfigChange("database.file", old_file, config.database_file);
+    NotifyConfigChange("database.buffer_pool_size", std::to_string(old_pool_size),
+                      std::to_string(config.buffer_pool_size));
 }
 
 void ConfigManager::UpdateQueryConfig(const QueryConfig& config) {
@@ -96,6 +99,7 @@ bool ConfigManager::SaveConfig(const std::string& config_file) const {
     file << "# Network Configuration\n";
     file << "network.host=" << net_config.host << "\n";
     file << "network.port=" << net_config.port << "\n";
+    file << "network.metrics_port=" << net_config.metrics_port << "\n";
     file << "network.max_connections=" << net_config.max_connections << "\n";
     file << "network.connection_timeout=" << net_config.connection_timeout.count() << "\n\n";
     
@@ -107,11 +111,38 @@ bool ConfigManager::SaveConfig(const std::string& config_file) const {
     file << "# Database Configuration\n";
     file << "database.file=" << db_config.database_file << "\n";
     file << "database.log_file=" << db_config.log_file << "\n";
-    file << "database.buffer_pool_size=" << db_config.buffer_pool_size << "\n\n";
+    file << "database.buffer_pool_size=" << db_config.buffer_pool_size << "\n";
+    file << "database.buffer_pool_shards=" << db_config.buffer_pool_shards << "\n";
+    file << "database.buffer_pool_replacer=" << db_config.buffer_pool_replacer << "\n";
+    file << "database.lru_k=" << db_config.lru_k << "\n";
+    file << "database.io_mode=" << db_config.io_mode << "\n";
+    file << "database.log_buffer_size=" << db_config.log_buffer_size << "\n";
+    file << "database.log_segment_size=" << db_config.log_segment_size << "\n";
+    file << "database.log_group_commit_wait_us=" << db_config.log_group_commit_wait_us << "\n";
+    file << "database.recovery_redo_threads=" << db_config.recovery_redo_threads << "\n";
+    file << "database.bgwriter_delay_ms=" << db_config.bgwriter_delay_ms << "\n";
+    file << "database.bgwriter_clean_ratio=" << db_config.bgwriter_clean_ratio << "\n";
+    file << "database.bgwriter_max_pages=" << db_config.bgwriter_max_pages << "\n";
+    file << "database.warmup_file=" << db_config.warmup_file << "\n";
+    file << "database.warmup_dump_interval_s=" << db_config.warmup_dump_interval_s << "\n";
+    file << "database.deadlock_detection_interval_ms=" << db_config.deadlock_detection_interval_ms << "\n";
+    file << "database.lock_wait_timeout_ms=" << db_config.lock_wait_timeout_ms << "\n";
+    file << "database.enable_tracing=" << (db_config.enable_tracing ? "true" : "false") << "\n";
+    file << "database.replication_port=" << db_config.replication_port << "\n";
+    file << "database.primary_host=" << db_config.primary_host << "\n";
+    file << "database.primary_port=" << db_config.primary_port << "\n\n";
     
     file << "# Query Configuration\n";
     file << "query.timeout=" << query_config.query_timeout.count() << "\n";
     file << "query.max_length=" << query_config.max_query_length << "\n";
+    file << "query.slow_log_file=" << query_config.slow_query_log_file << "\n";
+    file << "query.slow_threshold_ms=" << query_config.slow_query_threshold.count() << "\n";
+    file << "query.slow_sample_percent=" << query_config.slow_query_sample_percent << "\n";
+    file << "query.result_cache_bytes=" << query_config.result_cache_bytes << "\n";
+    file << "query.work_mem=" << query_config.work_mem << "\n";
+    file << "query.max_query_memory=" << query_config.max_query_memory << "\n";
+    file << "query.max_session_memory=" << query_config.max_session_memory << "\n";
+    file << "query.max_server_memory=" << query_config.max_server_memory << "\n";
     
     return true;
 }
@@ -6,6 +6,9 @@
 #include <algorithm>
 #include <getopt.h>
 
+#include "buffer/replacer.h"
+#include "storage/disk_manager.h"
+
 namespace SimpleRDBMS {
 
 bool ServerConfig::LoadFromFile(const std::string& config_file) {
@@ -34,6 +37,8 @@ bool ServerConfig::LoadFromArgs(int argc, char* argv[]) {
         {"workers", required_argument, 0, 'w'},
         {"max-connections", required_argument, 0, 'c'},
         {"config", required_argument, 0, 'f'},
+        {"buffer-pool-size", required_argument, 0, 'b'},
+        {"metrics-port", required_argument, 0, 'm'},
         {0, 0, 0, 0}
     };
 
@@ -41,7 +46,7 @@ bool ServerConfig::LoadFromArgs(int argc, char* argv[]) {
     int option_index = 0;
     std::string config_file;
 
-    while ((opt = getopt_long(argc, argv, "h:p:d:w:c:f:", long_options, &option_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "h:p:d:w:c:f:b:m:", long_options, &option_index)) != -1) {
         switch (opt) {
             case 'h':
                 network_config_.host = optarg;
@@ -61,6 +66,12 @@ bool ServerConfig::LoadFromArgs(int argc, char* argv[]) {
             case 'f':
                 config_file = optarg;
                 break;
+            case 'b':
+                database_config_.buffer_pool_size = std::stoul(optarg);
+                break;
+            case 'm':
+                network_config_.metrics_port = std::stoi(optarg);
+                break;
             default:
                 return false;
         }
@@ -82,11 +93,23 @@ void ServerConfig::LoadFromEnv() {
     if (const char* port = std::getenv("SIMPLEDB_PORT")) {
         network_config_.port = std::stoi(port);
     }
+    if (const char* metrics_port = std::getenv("SIMPLEDB_METRICS_PORT")) {
+        network_config_.metrics_port = std::stoi(metrics_port);
+    }
+    if (const char* slow_log = std::getenv("SIMPLEDB_SLOW_QUERY_LOG")) {
+        query_config_.slow_query_log_file = slow_log;
+    }
     
     // Database config
     if (const char* db_file = std::getenv("SIMPLEDB_DATABASE")) {
         database_config_.database_file = db_file;
     }
+    if (const char* pool_size = std::getenv("SIMPLEDB_BUFFER_POOL_SIZE")) {
+        database_config_.buffer_pool_size = std::stoul(pool_size);
+    }
+    if (const char* tracing = std::getenv("SIMPLEDB_TRACING")) {
+        database_config_.enable_tracing = std::string(tracing) == "1" || std::string(tracing) == "true";
+    }
     
     // Thread config
     if (const char* workers = std::getenv("SIMPLEDB_WORKERS")) {
@@ -100,6 +123,12 @@ bool ServerConfig::Validate() const {
         std::cerr << "Invalid port number: " << network_config_.port << std::endl;
         return false;
     }
+    if (network_config_.metrics_port < 0 || network_config_.metrics_port > 65535 ||
+        (network_config_.metrics_port != 0 &&
+         network_config_.metrics_port == network_config_.port)) {
+        std::cerr << "Invalid metrics port: " << network_config_.metrics_port << std::endl;
+        return false;
+    }
     if (network_config_.max_connections < 1) {
         std::cerr << "Invalid max connections: " << network_config_.max_connections << std::endl;
         return false;
@@ -116,7 +145,59 @@ bool ServerConfig::Validate() const {
         std::cerr << "Database file not specified" << std::endl;
         return false;
     }
-    
+    if (database_config_.buffer_pool_size < 1) {
+        std::cerr << "Invalid buffer pool size: " << database_config_.buffer_pool_size << std::endl;
+        return false;
+    }
+    ReplacerType replacer_type;
+    if (!ParseReplacerType(database_config_.buffer_pool_replacer, &replacer_type)) {
+        std::cerr << "Invalid buffer pool replacer: " << database_config_.buffer_pool_replacer << std::endl;
+        return false;
+    }
+    DiskIOMode io_mode;
+    if (!ParseDiskIOMode(database_config_.io_mode, &io_mode)) {
+        std::cerr << "Invalid I/O mode: " << database_config_.io_mode << std::endl;
+        return false;
+    }
+    if (database_config_.log_segment_size < PAGE_SIZE) {
+        std::cerr << "Invalid log segment size: " << database_config_.log_segment_size << std::endl;
+        return false;
+    }
+    if (database_config_.recovery_redo_threads < 1) {
+        std::cerr << "Invalid recovery redo threads: " << database_config_.recovery_redo_threads << std::endl;
+        return false;
+    }
+    if (database_config_.bgwriter_clean_ratio < 0.0 || database_config_.bgwriter_clean_ratio > 1.0) {
+        std::cerr << "Invalid bgwriter clean ratio: " << database_config_.bgwriter_clean_ratio << std::endl;
+        return false;
+    }
+    if (database_config_.bgwriter_max_pages < 1) {
+        std::cerr << "Invalid bgwriter max pages: " << database_config_.bgwriter_max_pages << std::endl;
+        return false;
+    }
+    if (database_config_.replication_port < 0 || database_config_.replication_port > 65535 ||
+        (database_config_.replication_port != 0 &&
+         database_config_.replication_port == network_config_.port)) {
+        std::cerr << "Invalid replication port: " << database_config_.replication_port << std::endl;
+        return false;
+    }
+    if (!database_config_.primary_host.empty()) {
+        if (database_config_.primary_port < 1 || database_config_.primary_port > 65535) {
+            std::cerr << "Invalid primary port: " << database_config_.primary_port << std::endl;
+            return false;
+        }
+        if (database_config_.replication_port != 0) {
+            // A replica's own WAL does not contain the records it applies
+            std::cerr << "A replica cannot serve replication (cascading is not supported)" << std::endl;
+            return false;
+        }
+    }
+    if (query_config_.slow_query_sample_percent < 0.0 ||
+        query_config_.slow_query_sample_percent > 100.0) {
+        std::cerr << "Invalid slow query sample percent: " << query_config_.slow_query_sample_percent << std::endl;
+        return false;
+    }
+
     return true;
 }
 
@@ -125,6 +206,9 @@ void ServerConfig::Print() const {
     std::cout << "Network:" << std::endl;
     std::cout << "  Host: " << network_config_.host << std::endl;
     std::cout << "  Port: " << network_config_.port << std::endl;
+    std::cout << "  Metrics Port: " << (network_config_.metrics_port > 0
+                                            ? std::to_string(network_config_.metrics_port)
+                                            : std::string("disabled")) << std::endl;
     std::cout << "  Max Connections: " << network_config_.max_connections << std::endl;
     std::cout << "  Connection Timeout: " << network_config_.connection_timeout.count() << "s" << std::endl;
     
@@ -132,15 +216,58 @@ void ServerConfig::Print() const {
     std::cout << "  Worker Threads: " << thread_config_.worker_threads << std::endl;
     std::cout << "  Query Threads: " << thread_config_.query_threads << std::endl;
     std::cout << "  I/O Threads: " << thread_config_.io_threads << std::endl;
+    std::cout << "  Pin Threads: " << (thread_config_.pin_threads ? "yes" : "no") << std::endl;
     
     std::cout << "Database:" << std::endl;
     std::cout << "  Database File: " << database_config_.database_file << std::endl;
     std::cout << "  Log File: " << database_config_.log_file << std::endl;
     std::cout << "  Buffer Pool Size: " << database_config_.buffer_pool_size << std::endl;
+    std::cout << "  Buffer Pool Shards: " << database_config_.buffer_pool_shards << std::endl;
+    std::cout << "  Buffer Pool Replacer: " << database_config_.buffer_pool_replacer << std::endl;
+    std::cout << "  I/O Mode: " << database_config_.io_mode << std::endl;
+    std::cout << "  Log Buffer Size: " << database_config_.log_buffer_size << " bytes x 2" << std::endl;
+    std::cout << "  Log Segment Size: " << database_config_.log_segment_size << " bytes" << std::endl;
+    std::cout << "  Log Group Commit Wait: " << database_config_.log_group_commit_wait_us << "us" << std::endl;
+    std::cout << "  Recovery Redo Threads: " << database_config_.recovery_redo_threads << std::endl;
+    std::cout << "  BgWriter Delay: " << database_config_.bgwriter_delay_ms << "ms" << std::endl;
+    std::cout << "  BgWriter Clean Ratio: " << database_config_.bgwriter_clean_ratio << std::endl;
+    std::cout << "  BgWriter Max Pages: " << database_config_.bgwriter_max_pages << std::endl;
+    std::cout << "  Warmup File: " << (database_config_.warmup_file.empty() ? "(disabled)" : database_config_.warmup_file) << std::endl;
+    std::cout << "  Warmup Dump Interval: " << database_config_.warmup_dump_interval_s << "s" << std::endl;
+    std::cout << "  Deadlock Detection Interval: " << database_config_.deadlock_detection_interval_ms << "ms" << std::endl;
+    std::cout << "  Lock Wait Timeout: " << database_config_.lock_wait_timeout_ms << "ms" << std::endl;
+    std::cout << "  Tracing: " << (database_config_.enable_tracing ? "on" : "off") << std::endl;
+    std::cout << "  Replication Port: " << (database_config_.replication_port > 0
+                                                ? std::to_string(database_config_.replication_port)
+                                                : "(disabled)") << std::endl;
+    if (!database_config_.primary_host.empty()) {
+        std::cout << "  Replica Of: " << database_config_.primary_host << ":"
+                  << database_config_.primary_port << std::endl;
+    }
     
     std::cout << "Query:" << std::endl;
     std::cout << "  Query Timeout: " << query_config_.query_timeout.count() << "s" << std::endl;
     std::cout << "  Max Query Length: " << query_config_.max_query_length << " bytes" << std::endl;
+    std::cout << "  Max Concurrent Heavy Queries: " << query_config_.max_concurrent_heavy_queries << std::endl;
+    if (query_config_.slow_query_log_file.empty()) {
+        std::cout << "  Slow Query Log: disabled" << std::endl;
+    } else {
+        std::cout << "  Slow Query Log: " << query_config_.slow_query_log_file
+                  << " (>= " << query_config_.slow_query_threshold.count() << "ms, "
+                  << query_config_.slow_query_sample_percent << "% sampled)" << std::endl;
+    }
+    if (query_config_.result_cache_bytes == 0) {
+        std::cout << "  Result Cache: disabled" << std::endl;
+    } else {
+        std::cout << "  Result Cache: " << query_config_.result_cache_bytes << " bytes" << std::endl;
+    }
+    std::cout << "  Work Mem: " << (query_config_.work_mem == 0
+                                        ? std::string("(default)")
+                                        : std::to_string(query_config_.work_mem) + " bytes") << std::endl;
+    std::cout << "  Memory Limits (query/session/server): "
+              << query_config_.max_query_memory << "/"
+              << query_config_.max_session_memory << "/"
+              << query_config_.max_server_memory << " bytes (0 = unlimited)" << std::endl;
     std::cout << "=========================" << std::endl;
 }
 
@@ -174,6 +301,8 @@ bool ServerConfig::ParseConfigLine(const std::string& line) {
         network_config_.host = value;
     } else if (key == "network.port") {
         network_config_.port = std::stoi(value);
+    } else if (key == "network.metrics_port") {
+        network_config_.metrics_port = std::stoi(value);
     } else if (key == "network.max_connections") {
         network_config_.max_connections = std::stoi(value);
     } else if (key == "network.connection_timeout") {
@@ -186,6 +315,14 @@ bool ServerConfig::ParseConfigLine(const std::string& line) {
         thread_config_.query_threads = std::stoi(value);
     } else if (key == "thread.max_queue_size") {
         thread_config_.max_queue_size = std::stoul(value);
+    } else if (key == "thread.pin_threads") {
+        thread_config_.pin_threads = (value == "true" || value == "1");
+    } else if (key == "thread.io_numa_node") {
+        thread_config_.io_numa_node = std::stoi(value);
+    } else if (key == "thread.nic_interface") {
+        thread_config_.nic_interface = value;
+    } else if (key == "thread.interactive_weight") {
+        thread_config_.interactive_weight = std::stoul(value);
     }
     // Database config
     else if (key == "database.file") {
@@ -194,12 +331,74 @@ bool ServerConfig::ParseConfigLine(const std::string& line) {
         database_config_.log_file = value;
     } else if (key == "database.buffer_pool_size") {
         database_config_.buffer_pool_size = std::stoul(value);
+    } else if (key == "database.buffer_pool_shards") {
+        database_config_.buffer_pool_shards = std::stoul(value);
+    } else if (key == "database.buffer_pool_replacer") {
+        database_config_.buffer_pool_replacer = value;
+    } else if (key == "database.lru_k") {
+        database_config_.lru_k = std::stoul(value);
+    } else if (key == "database.io_mode") {
+        database_config_.io_mode = value;
+    } else if (key == "database.log_buffer_size") {
+        database_config_.log_buffer_size = std::stoul(value);
+    } else if (key == "database.log_segment_size") {
+        database_config_.log_segment_size = std::stoul(value);
+    } else if (key == "database.log_group_commit_wait_us") {
+        database_config_.log_group_commit_wait_us = std::stoul(value);
+    } else if (key == "database.recovery_redo_threads") {
+        database_config_.recovery_redo_threads = std::stoul(value);
+    } else if (key == "database.bgwriter_delay_ms") {
+        database_config_.bgwriter_delay_ms = std::stoul(value);
+    } else if (key == "database.bgwriter_clean_ratio") {
+        database_config_.bgwriter_clean_ratio = std::stod(value);
+    } else if (key == "database.bgwriter_max_pages") {
+        database_config_.bgwriter_max_pages = std::stoul(value);
+    } else if (key == "database.warmup_file") {
+        database_config_.warmup_file = value;
+    } else if (key == "database.warmup_dump_interval_s") {
+        database_config_.warmup_dump_interval_s = std::stoul(value);
+    } else if (key == "database.deadlock_detection_interval_ms") {
+        database_config_.deadlock_detection_interval_ms = std::stoul(value);
+    } else if (key == "database.lock_wait_timeout_ms") {
+        database_config_.lock_wait_timeout_ms = std::stoul(value);
+    } else if (key == "database.enable_tracing") {
+        database_config_.enable_tracing = (value == "true" || value == "1");
+    } else if (key == "database.replication_port") {
+        database_config_.replication_port = std::stoi(value);
+    } else if (key == "database.primary_host") {
+        database_config_.primary_host = value;
+    } else if (key == "database.primary_port") {
+        database_config_.primary_port = std::stoi(value);
     }
     // Query config
     else if (key == "query.timeout") {
         query_config_.query_timeout = std::chrono::seconds(std::stoi(value));
     } else if (key == "query.max_length") {
         query_config_.max_query_length = std::stoul(value);
+    } else if (key == "query.max_concurrent_heavy") {
+        query_config_.max_concurrent_heavy_queries = std::stoul(value);
+    } else if (key == "query.max_queued_heavy") {
+        query_config_.max_queued_heavy_queries = std::stoul(value);
+    } else if (key == "query.heavy_queue_timeout_ms") {
+        query_config_.heavy_query_queue_timeout = std::chrono::milliseconds(std::stoul(value));
+    } else if (key == "query.heavy_min_pages") {
+        query_config_.heavy_query_min_pages = std::stoul(value);
+    } else if (key == "query.slow_log_file") {
+        query_config_.slow_query_log_file = value;
+    } else if (key == "query.slow_threshold_ms") {
+        query_config_.slow_query_threshold = std::chrono::milliseconds(std::stoul(value));
+    } else if (key == "query.slow_sample_percent") {
+        query_config_.slow_query_sample_percent = std::stod(value);
+    } else if (key == "query.result_cache_bytes") {
+        query_config_.result_cache_bytes = std::stoul(value);
+    } else if (key == "query.work_mem") {
+        query_config_.work_mem = std::stoul(value);
+    } else if (key == "query.max_query_memory") {
+        query_config_.max_query_memory = std::stoul(value);
+    } else if (key == "query.max_session_memory") {
+        query_config_.max_session_memory = std::stoul(value);
+    } else if (key == "query.max_server_memory") {
+        query_config_.max_server_memory = std::stoul(value);
     }
     
     return true;
@@ -13,6 +13,7 @@ struct NetworkConfig {
     int max_connections = 100;
     std::chrono::seconds connection_timeout{30};
     std::chrono::seconds idle_timeout{300};
+    int metrics_port = 0;  // HTTP endpoint for Prometheus scrapes, 0 = disabled
 };
 
 struct ThreadConfig {
@@ -20,15 +21,37 @@ struct ThreadConfig {
     int query_threads = 8;
     int io_threads = 2;
     size_t max_queue_size = 1000;
+    bool pin_threads = false;    // pin query workers to cores, I/O threads to the NIC's node
+    int io_numa_node = -1;       // -1 = the node of nic_interface (or the first NIC that reports one)
+    std::string nic_interface;   // empty = auto-detect
+    size_t interactive_weight = 4;  // interactive tasks run per batch task when both are queued
 };
 
 struct DatabaseConfig {
     std::string database_file = "simpledb.db";
     std::string log_file = "simpledb.log";
     size_t buffer_pool_size = 1000;
-    size_t log_buffer_size = 1024 * 1024; // 1MB
+    size_t buffer_pool_shards = 1;  // 1 = single latch, >1 = partitioned pool
+    std::string buffer_pool_replacer = "lru";  // lru / clock / lru-k / 2q
+    size_t lru_k = 2;  // K for the lru-k replacer
+    std::string io_mode = "pread";  // stream / pread / direct / io_uring / mmap
+    size_t log_buffer_size = 1024 * 1024; // 1MB, size of each of the two log buffers
+    size_t log_segment_size = 16 * 1024 * 1024;  // size of each preallocated WAL segment
+    size_t log_group_commit_wait_us = 0;  // extra wait before a log flush, 0 = none
     bool enable_logging = true;
     bool enable_recovery = true;
+    size_t recovery_redo_threads = 4;  // redo workers, records partitioned by page; 1 = sequential
+    size_t bgwriter_delay_ms = 200;  // background dirty-page writer interval, 0 = disabled
+    double bgwriter_clean_ratio = 0.2;  // fraction of each shard kept clean or free
+    size_t bgwriter_max_pages = 64;  // pages written per round at most
+    std::string warmup_file = "simpledb.warmup";  // hot page ids saved at shutdown, preloaded at startup; empty = disabled
+    size_t warmup_dump_interval_s = 300;  // also save the warmup file this often, 0 = only at shutdown
+    size_t deadlock_detection_interval_ms = 50;  // waits-for graph check interval, 0 = disabled
+    size_t lock_wait_timeout_ms = 5000;  // lock wait limit while the deadlock detector runs
+    bool enable_tracing = false;  // record hot-path trace spans from startup, see /trace
+    int replication_port = 0;  // stream the WAL to replicas on this port, 0 = disabled
+    std::string primary_host;  // run as a read-only replica of this primary; empty = not a replica
+    int primary_port = 0;      // replication port of the primary
 };
 
 struct QueryConfig {
@@ -36,6 +59,27 @@ struct QueryConfig {
     size_t max_query_length = 1024 * 1024; // 1MB
     bool enable_query_cache = false;
     size_t query_cache_size = 100;
+    // Admission control for heavy (analytical) queries
+    size_t max_concurrent_heavy_queries = 2;
+    size_t max_queued_heavy_queries = 16;
+    std::chrono::milliseconds heavy_query_queue_timeout{30000};
+    size_t heavy_query_min_pages = 256;  // smaller tables are always cheap
+    // Slow query log: empty file disables it; queries slower than the
+    // threshold are logged, plus a random sample of all queries
+    std::string slow_query_log_file;
+    std::chrono::milliseconds slow_query_threshold{1000};
+    double slow_query_sample_percent = 0.0;
+    // Result cache for autocommit SELECTs, invalidated when a table they
+    // read is modified; 0 bytes disables it
+    size_t result_cache_bytes = 0;
+    // Memory accounting. work_mem is the budget of each spilling operator
+    // (sort, hash join, hash aggregation, UPDATE/DELETE row ids); 0 keeps
+    // the built-in 16MB budgets. A statement that needs more than the
+    // query, session or server limit fails; 0 leaves a level unlimited
+    size_t work_mem = 0;
+    size_t max_query_memory = 0;
+    size_t max_session_memory = 0;
+    size_t max_server_memory = 0;
 };
 
 class ServerConfig {
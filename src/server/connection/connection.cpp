@@ -6,6 +6,9 @@
 #include <sys/socket.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <climits>
 #include <errno.h>
 #include <cstring>
 #include <iostream>
@@ -121,13 +124,40 @@ ssize_t Connection::SendData(const char* data, size_t length) {
         SetError("Connection is not valid");
         return -1;
     }
-    
+    if (output_corked_) {
+        AppendOutput(data, length);
+        if (output_bytes_ >= OUTPUT_COALESCE_BYTES && !FlushOutput()) {
+            return -1;
+        }
+        return static_cast<ssize_t>(length);
+    }
+    return SendAll(data, length);
+}
+
+void Connection::AppendOutput(const char* data, size_t length) {
+    if (length < OUTPUT_SMALL_WRITE_BYTES && !output_chain_.empty() &&
+        output_chain_.back().size() < OUTPUT_COALESCE_BYTES) {
+        output_chain_.back().append(data, length);
+    } else {
+        output_chain_.emplace_back(data, length);
+    }
+    output_bytes_ += length;
+}
+
+ssize_t Connection::SendAll(const char* data, size_t length) {
     ssize_t total_sent = 0;
     while (total_sent < static_cast<ssize_t>(length)) {
         ssize_t sent = SafeSend(data + total_sent, length - total_sent);
         if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // Would block, return what we've sent so far
+                // 非阻塞socket的发送缓冲区满了，等它可写再继续，
+                // 超时就返回已经发出去的部分
+                if (WaitWritable()) {
+                    continue;
+                }
                 break;
             }
             SetError("Send failed: " + std::string(strerror(errno)));
@@ -146,6 +176,99 @@ ssize_t Connection::SendData(const std::string& data) {
     return SendData(data.c_str(), data.length());
 }
 
+ssize_t Connection::SendData(std::string&& data) {
+    if (!output_corked_ || data.size() < OUTPUT_SMALL_WRITE_BYTES) {
+        return SendData(data.c_str(), data.length());
+    }
+    if (!IsValid()) {
+        SetError("Connection is not valid");
+        return -1;
+    }
+    size_t length = data.size();
+    output_chain_.push_back(std::move(data));
+    output_bytes_ += length;
+    if (output_bytes_ >= OUTPUT_COALESCE_BYTES && !FlushOutput()) {
+        return -1;
+    }
+    return static_cast<ssize_t>(length);
+}
+
+void Connection::CorkOutput() {
+    output_corked_ = true;
+}
+
+bool Connection::UncorkOutput() {
+    output_corked_ = false;
+    return FlushOutput();
+}
+
+/**
+ * 把输出缓冲区链发出去
+ * 实现思路：
+ * 1. 每次最多拿IOV_MAX个块组成iovec，用一次sendmsg发出
+ * 2. 只发出一部分时跳过已经发完的块，从没发完的块的中间继续
+ * 3. 发送缓冲区满了等可写；超时或者出错时丢掉剩下的数据，
+ *    没有办法按顺序补发，当作失败
+ */
+bool Connection::FlushOutput() {
+    if (output_chain_.empty()) {
+        return true;
+    }
+    std::vector<std::string> chain;
+    chain.swap(output_chain_);
+    size_t total = output_bytes_;
+    output_bytes_ = 0;
+    if (!IsValid()) {
+        return false;
+    }
+
+    std::vector<iovec> iov;
+    size_t block = 0;
+    size_t block_offset = 0;
+    size_t total_sent = 0;
+    while (block < chain.size()) {
+        iov.clear();
+        for (size_t i = block; i < chain.size() && iov.size() < IOV_MAX; i++) {
+            size_t skip = i == block ? block_offset : 0;
+            iov.push_back({const_cast<char*>(chain[i].data()) + skip,
+                           chain[i].size() - skip});
+        }
+        msghdr message{};
+        message.msg_iov = iov.data();
+        message.msg_iovlen = iov.size();
+        ssize_t sent =
+            sendmsg(connection_info_.socket_fd, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && WaitWritable()) {
+                continue;
+            }
+            SetError("Send failed: " + std::string(strerror(errno)));
+            break;
+        }
+        total_sent += static_cast<size_t>(sent);
+        size_t remaining = static_cast<size_t>(sent);
+        while (block < chain.size() &&
+               remaining >= chain[block].size() - block_offset) {
+            remaining -= chain[block].size() - block_offset;
+            block++;
+            block_offset = 0;
+        }
+        block_offset += remaining;
+    }
+
+    AddBytesSent(total_sent);
+    UpdateLastActivity();
+    return total_sent == total;
+}
+
+bool Connection::WaitWritable() {
+    pollfd writable{connection_info_.socket_fd, POLLOUT, 0};
+    return poll(&writable, 1, SEND_WAIT_TIMEOUT_MS) > 0;
+}
+
 ssize_t Connection::ReceiveData(char* buffer, size_t buffer_size) {
     if (!IsValid()) {
         SetError("Connection is not valid");
@@ -229,17 +352,26 @@ bool Connection::ProcessRequest() {
     
     std::cout << "[DEBUG] ProcessRequest: Received " << received << " bytes" << std::endl;
     receive_buffer_[received] = '\0';
-    std::string data(receive_buffer_, received);
-    
-    // 清理数据，移除可能的空白字符
-    size_t start = data.find_first_not_of(" \t\r\n");
-    if (start == std::string::npos) {
-        // 只有空白字符，继续等待更多数据
-        return true;
+    return HandleRequest(std::string(receive_buffer_, received));
+}
+
+bool Connection::HandleRequest(std::string data) {
+    if (!protocol_handler_) {
+        SetError("No protocol handler");
+        return false;
+    }
+
+    if (protocol_handler_->IsTextProtocol()) {
+        // 清理数据，移除可能的空白字符
+        size_t start = data.find_first_not_of(" \t\r\n");
+        if (start == std::string::npos) {
+            // 只有空白字符，继续等待更多数据
+            return true;
+        }
+        data = data.substr(start);
+
+        std::cout << "[DEBUG] ProcessRequest: Processing data: '" << data << "'" << std::endl;
     }
-    data = data.substr(start);
-    
-    std::cout << "[DEBUG] ProcessRequest: Processing data: '" << data << "'" << std::endl;
     
     // Parse message
     auto message = protocol_handler_->ParseMessage(data);
@@ -280,8 +412,21 @@ bool Connection::ProcessRequest() {
                     SendData(error_resp);
                     return true; // 继续保持连接
                 }
-                success = static_cast<SimpleProtocolHandler*>(protocol_handler_.get())->HandleCommand(this, *message);
+                if (auto* simple = dynamic_cast<SimpleProtocolHandler*>(protocol_handler_.get())) {
+                    success = simple->HandleCommand(this, *message);
+                } else {
+                    SendData(protocol_handler_->FormatError("Commands are not supported by this protocol"));
+                    success = true;
+                }
                 break;
+            case MessageType::SWITCH_PROTOCOL:
+                // 确认用的还是旧协议，之后的字节按二进制帧解析；
+                // 缓冲区里已经收到的后续请求由新协议分帧
+                SendData(protocol_handler_->FormatOkMessage("BINARY"));
+                SetProtocolHandler(ProtocolHandlerFactory::CreateHandler(
+                    ProtocolHandlerFactory::ProtocolType::BINARY));
+                IncrementRequests();
+                return true;
             case MessageType::HEARTBEAT:
                 std::cout << "[DEBUG] Processing HEARTBEAT message" << std::endl;
                 SendData(protocol_handler_->FormatOkMessage("PONG"));
@@ -4,6 +4,7 @@
 #include "server/protocol/protocol_handler.h"
 #include <memory>
 #include <string>
+#include <vector>
 #include <chrono>
 #include <mutex>
 #include <atomic>
@@ -65,8 +66,19 @@ public:
     // Data I/O
     ssize_t SendData(const char* data, size_t length);
     ssize_t SendData(const std::string& data);
+    // 合并响应时直接接管data，不再复制一遍
+    ssize_t SendData(std::string&& data);
     ssize_t ReceiveData(char* buffer, size_t buffer_size);
     std::string ReceiveLine(); // Receive until '\n'
+
+    /**
+     * 合并响应：CorkOutput之后SendData只把数据挂到输出缓冲区链上，
+     * 攒够OUTPUT_COALESCE_BYTES或者UncorkOutput时才用sendmsg一次发出去，
+     * 连续处理多个流水线请求时小响应合并成一次系统调用
+     * @return UncorkOutput发送失败时返回false
+     */
+    void CorkOutput();
+    bool UncorkOutput();
     
     // Protocol handling
     void SetProtocolHandler(std::unique_ptr<ProtocolHandler> handler);
@@ -74,6 +86,8 @@ public:
     
     // Request processing
     bool ProcessRequest();
+    // 处理一个已经完整收到的请求，事件循环把请求交给查询线程时调用
+    bool HandleRequest(std::string data);
     bool HandleQuery(const std::string& query);
     
     // Authentication
@@ -120,11 +134,27 @@ private:
     
     // Buffer for I/O operations
     static constexpr size_t BUFFER_SIZE = 8192;
+    // 非阻塞发送遇到缓冲区满时最多等待的时间
+    static constexpr int SEND_WAIT_TIMEOUT_MS = 5000;
+    // 合并响应时输出缓冲区链攒到这么多字节就先发出去
+    static constexpr size_t OUTPUT_COALESCE_BYTES = 64 * 1024;
+    // 小于这个长度的数据拷贝到链尾的块里，大块数据单独挂一个块，
+    // 避免一次sendmsg带太多很短的iovec
+    static constexpr size_t OUTPUT_SMALL_WRITE_BYTES = 1024;
     char receive_buffer_[BUFFER_SIZE];
+
+    // 合并响应的输出缓冲区链，只由正在处理请求的线程访问
+    bool output_corked_ = false;
+    std::vector<std::string> output_chain_;
+    size_t output_bytes_ = 0;
     
     // Helper methods
     bool SetSocketOptions();
     ssize_t SafeSend(const char* data, size_t length);
+    ssize_t SendAll(const char* data, size_t length);
+    void AppendOutput(const char* data, size_t length);
+    bool FlushOutput();
+    bool WaitWritable();
     ssize_t SafeReceive(char* buffer, size_t buffer_size);
     std::string GenerateSessionId() const;
 };
@@ -0,0 +1,349 @@
+#include "server/connection/event_loop.h"
+#include "common/numa.h"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace SimpleRDBMS {
+
+// 一次epoll_wait最多返回的事件数
+static constexpr int MAX_EVENTS = 256;
+
+EventLoop::EventLoop(Dispatcher dispatcher, CloseHandler on_close)
+    : dispatcher_(std::move(dispatcher)), on_close_(std::move(on_close)) {}
+
+EventLoop::~EventLoop() {
+    Stop();
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+    if (wakeup_fd_ >= 0) {
+        close(wakeup_fd_);
+    }
+}
+
+bool EventLoop::Start() {
+    if (running_) {
+        return true;
+    }
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        std::cerr << "[ERROR] EventLoop: epoll_create1 failed: "
+                  << strerror(errno) << std::endl;
+        return false;
+    }
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ < 0) {
+        std::cerr << "[ERROR] EventLoop: eventfd failed: " << strerror(errno)
+                  << std::endl;
+        return false;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wakeup_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event) < 0) {
+        std::cerr << "[ERROR] EventLoop: failed to register eventfd: "
+                  << strerror(errno) << std::endl;
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::make_unique<std::thread>(&EventLoop::Loop, this);
+    return true;
+}
+
+void EventLoop::Stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    Wakeup();
+    if (thread_ && thread_->joinable()) {
+        thread_->join();
+    }
+    thread_.reset();
+}
+
+void EventLoop::AddConnection(std::shared_ptr<Connection> connection) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_connections_.push_back(std::move(connection));
+    }
+    Wakeup();
+}
+
+void EventLoop::Wakeup() {
+    uint64_t one = 1;
+    ssize_t written = write(wakeup_fd_, &one, sizeof(one));
+    (void)written;  // 计数器已经非零时写失败也能唤醒
+}
+
+void EventLoop::Loop() {
+    if (!cpu_affinity_.empty() &&
+        !NumaTopology::PinCurrentThread(cpu_affinity_)) {
+        std::cerr << "[ERROR] EventLoop: failed to set cpu affinity"
+                  << std::endl;
+    }
+    std::vector<epoll_event> events(MAX_EVENTS);
+    while (running_) {
+        int count = epoll_wait(epoll_fd_, events.data(), MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "[ERROR] EventLoop: epoll_wait failed: "
+                      << strerror(errno) << std::endl;
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+            if (fd == wakeup_fd_) {
+                uint64_t value;
+                while (read(wakeup_fd_, &value, sizeof(value)) > 0) {
+                }
+                continue;
+            }
+            auto it = channels_.find(fd);
+            if (it != channels_.end()) {
+                HandleReadable(fd, it->second);
+            }
+        }
+        RunPending();
+    }
+
+    // 连接由ConnectionManager关闭，这里只放手
+    channels_.clear();
+    connection_count_ = 0;
+}
+
+void EventLoop::RunPending() {
+    std::vector<std::shared_ptr<Connection>> connections;
+    std::vector<Completion> completions;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        connections.swap(pending_connections_);
+        completions.swap(pending_completions_);
+    }
+    for (auto& connection : connections) {
+        Register(std::move(connection));
+    }
+    for (const auto& completion : completions) {
+        FinishRequest(completion);
+    }
+}
+
+/**
+ * 注册连接
+ * 实现思路：
+ * 1. 以 EPOLLIN | EPOLLRDHUP | EPOLLET 注册，注册时已经有数据也会报告一次
+ * 2. 同一个fd上还留着旧的通道时，说明旧连接已经被别处关闭、fd被复用，
+ *    直接用新通道替换
+ */
+void EventLoop::Register(std::shared_ptr<Connection> connection) {
+    int fd = connection->GetSocketFd();
+    if (fd < 0 || !connection->IsValid()) {
+        return;
+    }
+    if (!connection->SetNonBlocking(true)) {
+        std::cerr << "[ERROR] EventLoop: failed to make socket non-blocking"
+                  << std::endl;
+        on_close_(fd, connection);
+        return;
+    }
+    channels_.erase(fd);
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    event.data.fd = fd;
+    int result = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+    if (result < 0 && errno == EEXIST) {
+        result = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+    }
+    if (result < 0) {
+        std::cerr << "[ERROR] EventLoop: failed to register connection: "
+                  << strerror(errno) << std::endl;
+        connection_count_ = channels_.size();
+        on_close_(fd, connection);
+        return;
+    }
+
+    Channel& channel = channels_[fd];
+    channel.connection = std::move(connection);
+    channel.id = next_channel_id_++;
+    connection_count_ = channels_.size();
+}
+
+/**
+ * 处理可读事件
+ * 实现思路：
+ * 1. 边沿触发，一直读到EAGAIN；读到0或者出错说明对端已经关闭。
+ *    直接recv而不是ReceiveData：对端只关闭了写方向时，
+ *    已经收到的请求仍然要执行并回复，连接状态留到最后再改
+ * 2. 派发缓冲区里的完整请求，缓冲区里没有完整请求却超过了
+ *    最大请求长度时回一个错误后断开，长度前缀的协议收到头部就按
+ *    头部里的长度判断；对端关闭且没有请求在执行时关闭连接，
+ *    有请求在执行时等缓冲区里的请求都执行完再关闭
+ */
+void EventLoop::HandleReadable(int fd, Channel& channel) {
+    char buffer[8192];
+    while (true) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            channel.input.append(buffer, static_cast<size_t>(received));
+            channel.connection->AddBytesReceived(received);
+            channel.connection->UpdateLastActivity();
+            continue;
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        channel.peer_closed = true;
+        break;
+    }
+
+    DispatchNext(fd, channel);
+    if (channel.peer_closed && !channel.busy) {
+        CloseChannel(fd);
+    }
+}
+
+void EventLoop::DispatchNext(int fd, Channel& channel) {
+    if (channel.busy) {
+        return;
+    }
+    if (GetRequestLength(channel.connection.get(), channel.input) == 0) {
+        auto* handler = channel.connection->GetProtocolHandler();
+        if (handler ? handler->IsOversized(channel.input, MAX_REQUEST_SIZE)
+                    : channel.input.size() > MAX_REQUEST_SIZE) {
+            if (handler) {
+                channel.connection->SendData(
+                    handler->FormatError("Request too large"));
+            }
+            channel.input.clear();
+            channel.peer_closed = true;
+        }
+        return;
+    }
+    // 缓冲区里的数据整个交给查询线程，由它按顺序分帧执行：
+    // 前面的请求可能切换协议，后面的请求必须等它执行完再分帧
+    std::string input;
+    input.swap(channel.input);
+
+    channel.busy = true;
+    std::shared_ptr<Connection> connection = channel.connection;
+    uint64_t id = channel.id;
+    Session* session = connection->GetSession();
+    TaskPriority priority = session && session->IsHeavyWorkload()
+                                ? TaskPriority::BATCH
+                                : TaskPriority::INTERACTIVE;
+    try {
+        dispatcher_([this, connection, fd, id, input]() mutable {
+            bool keep_open = false;
+            try {
+                keep_open = RunPipeline(connection.get(), &input);
+            } catch (const std::exception& e) {
+                std::cerr << "[ERROR] EventLoop: exception handling request: "
+                          << e.what() << std::endl;
+                connection->UncorkOutput();
+                keep_open = connection->IsValid();
+            }
+            {
+                std::lock_guard<std::mutex> lock(pending_mutex_);
+                pending_completions_.push_back(
+                    {fd, id, keep_open, std::move(input)});
+            }
+            Wakeup();
+        }, priority);
+    } catch (const std::exception& e) {
+        // 查询线程池满了，丢掉这些请求，连接保持
+        channel.busy = false;
+        if (auto* handler = connection->GetProtocolHandler()) {
+            connection->SendData(
+                handler->FormatError("Server busy: " + std::string(e.what())));
+        }
+    }
+}
+
+/**
+ * 缓冲区开头的完整请求的长度，还不完整时返回0
+ * 分帧交给连接当前的协议，协议可能在上一个请求里被切换过，
+ * 所以只在没有请求执行的线程里调用
+ */
+size_t EventLoop::GetRequestLength(Connection* connection,
+                                   const std::string& input) {
+    if (auto* handler = connection->GetProtocolHandler()) {
+        return handler->GetMessageLength(input);
+    }
+    size_t end = input.find('\n');
+    return end == std::string::npos ? 0 : end + 1;
+}
+
+/**
+ * 在查询线程里执行一批流水线请求
+ * 实现思路：
+ * 1. 合并响应，逐个取出完整的请求执行，每个请求之前重新按当前协议分帧
+ * 2. 连接要关闭、执行了MAX_PIPELINED_REQUESTS个或者没有完整请求时停下，
+ *    剩下的数据留在input里交还给I/O线程
+ * 3. 最后把合并的响应一次发出去
+ * @return 连接是否保持
+ */
+bool EventLoop::RunPipeline(Connection* connection, std::string* input) {
+    connection->CorkOutput();
+    bool keep_open = true;
+    for (size_t handled = 0; keep_open && handled < MAX_PIPELINED_REQUESTS;
+         handled++) {
+        size_t length = GetRequestLength(connection, *input);
+        if (length == 0) {
+            break;
+        }
+        std::string request = input->substr(0, length);
+        input->erase(0, length);
+        keep_open =
+            connection->HandleRequest(std::move(request)) || connection->IsValid();
+    }
+    if (!connection->UncorkOutput()) {
+        return connection->IsValid();
+    }
+    return keep_open;
+}
+
+void EventLoop::FinishRequest(const Completion& completion) {
+    auto it = channels_.find(completion.fd);
+    if (it == channels_.end() || it->second.id != completion.id) {
+        return;
+    }
+    Channel& channel = it->second;
+    channel.busy = false;
+    // 没执行的数据在执行期间新收到的数据之前
+    channel.input.insert(0, completion.unprocessed);
+    if (!completion.keep_open) {
+        CloseChannel(completion.fd);
+        return;
+    }
+    DispatchNext(completion.fd, channel);
+    if (channel.peer_closed && !channel.busy) {
+        CloseChannel(completion.fd);
+    }
+}
+
+void EventLoop::CloseChannel(int fd) {
+    auto it = channels_.find(fd);
+    if (it == channels_.end()) {
+        return;
+    }
+    std::shared_ptr<Connection> connection = std::move(it->second.connection);
+    channels_.erase(it);
+    connection_count_ = channels_.size();
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    on_close_(fd, connection);
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "connection.h"
+#include "server/thread/thread_pool.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace SimpleRDBMS {
+
+/**
+ * EventLoop - 一个I/O线程上的epoll反应器
+ *
+ * 设计思路：
+ * - 连接的socket设成非阻塞，以边沿触发注册到epoll；可读时一直读到
+ *   EAGAIN，数据追加到连接的输入缓冲区，空闲的连接只占一个缓冲区
+ * - 请求按连接当前协议的GetMessageLength分帧（文本协议按行，二进制
+ *   协议按长度前缀），只有收到完整的请求才交给查询线程池执行；
+ *   同一个连接同时只有一个任务在执行，响应顺序和请求顺序一致，
+ *   执行期间到达的请求先留在缓冲区里
+ * - 流水线：客户端不等响应连续发来的请求一次交给查询线程，
+ *   查询线程按顺序逐个分帧执行，中间不用回到I/O线程；这些请求的响应
+ *   合并在连接的输出缓冲区里，一批执行完再一起发出去。执行期间I/O线程
+ *   继续接收后面的请求
+ * - 查询线程执行完把结果投递回I/O线程（eventfd唤醒），由I/O线程
+ *   派发下一个请求或者关闭连接；连接表只由I/O线程访问，不需要加锁
+ * - 上一条查询是重查询的连接，后面的请求以批处理优先级派发，
+ *   不和短查询抢同一个队列
+ * - 每个连接有一个编号，连接被关闭、fd被新连接复用之后，
+ *   旧请求的完成通知不会落到新连接上
+ */
+class EventLoop {
+   public:
+    // 把任务按优先级交给查询线程池，线程池满时抛出异常
+    using Dispatcher =
+        std::function<void(std::function<void()>, TaskPriority)>;
+    // 连接关闭时调用，参数是连接注册时的fd
+    using CloseHandler =
+        std::function<void(int, const std::shared_ptr<Connection>&)>;
+
+    EventLoop(Dispatcher dispatcher, CloseHandler on_close);
+    ~EventLoop();
+
+    // I/O线程只在这些CPU上运行，在Start之前设置，为空时不限制
+    void SetCpuAffinity(std::vector<int> cpus) { cpu_affinity_ = std::move(cpus); }
+
+    // 创建epoll和eventfd，启动I/O线程
+    bool Start();
+    // 停止I/O线程，连接本身由ConnectionManager关闭
+    void Stop();
+    bool IsRunning() const { return running_; }
+
+    /**
+     * 接管一个连接，可以从任意线程调用
+     * 连接在I/O线程里注册到epoll
+     */
+    void AddConnection(std::shared_ptr<Connection> connection);
+
+    size_t GetConnectionCount() const { return connection_count_; }
+
+    // 一个请求的最大长度，超过时断开连接
+    static constexpr size_t MAX_REQUEST_SIZE = 1024 * 1024;
+    // 查询线程一次最多连续执行一个连接的这么多个请求，
+    // 剩下的重新派发，避免一个连接长时间占着查询线程
+    static constexpr size_t MAX_PIPELINED_REQUESTS = 64;
+
+   private:
+    struct Channel {
+        std::shared_ptr<Connection> connection;
+        uint64_t id = 0;
+        std::string input;        // 还没有派发的数据
+        bool busy = false;        // 有请求正在查询线程池里执行
+        bool peer_closed = false;  // 对端已经关闭或者读出错
+    };
+
+    struct Completion {
+        int fd;
+        uint64_t id;
+        bool keep_open;
+        std::string unprocessed;  // 交给查询线程但是还没有执行的数据
+    };
+
+    void Loop();
+    void Wakeup();
+    void RunPending();
+    void Register(std::shared_ptr<Connection> connection);
+    void HandleReadable(int fd, Channel& channel);
+    void DispatchNext(int fd, Channel& channel);
+    static size_t GetRequestLength(Connection* connection,
+                                   const std::string& input);
+    static bool RunPipeline(Connection* connection, std::string* input);
+    void FinishRequest(const Completion& completion);
+    void CloseChannel(int fd);
+
+    Dispatcher dispatcher_;
+    CloseHandler on_close_;
+
+    int epoll_fd_ = -1;
+    int wakeup_fd_ = -1;
+    std::unique_ptr<std::thread> thread_;
+    std::atomic<bool> running_{false};
+    std::vector<int> cpu_affinity_;
+
+    // 只由I/O线程访问
+    std::unordered_map<int, Channel> channels_;
+    uint64_t next_channel_id_ = 1;
+    std::atomic<size_t> connection_count_{0};
+
+    // 其他线程投递给I/O线程的新连接和请求完成通知
+    std::mutex pending_mutex_;
+    std::vector<std::shared_ptr<Connection>> pending_connections_;
+    std::vector<Completion> pending_completions_;
+};
+
+}  // namespace SimpleRDBMS
@@ -68,7 +68,7 @@ void Session::SetState(SessionState state) {
     session_info_.state = state;
 }
 
-bool Session::BeginTransaction() {
+bool Session::BeginTransaction(bool read_only) {
     std::cout << "[DEBUG] Session::BeginTransaction: Attempting to acquire session lock" << std::endl;
     std::lock_guard<std::mutex> lock(session_mutex_);
     std::cout << "[DEBUG] Session::BeginTransaction: Session lock acquired" << std::endl;
@@ -85,7 +85,8 @@ bool Session::BeginTransaction() {
     }
     
     std::cout << "[DEBUG] Session::BeginTransaction: Calling transaction_manager_->Begin()" << std::endl;
-    current_transaction_ = transaction_manager_->Begin();
+    current_transaction_ = transaction_manager_->Begin(
+        IsolationLevel::REPEATABLE_READ, read_only);
     std::cout << "[DEBUG] Session::BeginTransaction: transaction_manager_->Begin() returned: " 
               << (current_transaction_ ? "success" : "null") << std::endl;
     
@@ -235,6 +236,10 @@ void Session::InitializeSessionVariables() {
     session_variables_["autocommit"] = "true";
     session_variables_["transaction_isolation"] = "read_committed";
     session_variables_["query_timeout"] = "60";
+    // Milliseconds; 0 lets statements run without a limit
+    session_variables_["statement_timeout"] = "0";
+    // Bytes, or a number followed by kB, MB or GB; 0 uses query.work_mem
+    session_variables_["work_mem"] = "0";
     session_variables_["max_result_rows"] = "1000";
     session_variables_["client_encoding"] = "utf8";
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <mutex>
@@ -7,6 +8,7 @@
 #include <unordered_map>
 
 #include "common/config.h"
+#include "common/memory_tracker.h"
 #include "common/types.h"
 #include "record/tuple.h"
 #include "transaction/transaction.h"
@@ -18,6 +20,7 @@ class Transaction;
 class TransactionManager;
 class ExecutionEngine;
 class QueryProcessor;
+class ResultSink;
 
 enum class SessionState {
     INVALID = 0,
@@ -62,7 +65,8 @@ class Session {
     std::string GetSessionId() const { return session_info_.session_id; }
 
     // Transaction management
-    bool BeginTransaction();
+    // read_only为true时开始只读事务（BEGIN READ ONLY、自动提交的SELECT）
+    bool BeginTransaction(bool read_only = false);
     bool CommitTransaction();
     bool RollbackTransaction();
     bool IsInTransaction() const { return current_transaction_ != nullptr; }
@@ -71,6 +75,20 @@ class Session {
     // Query execution
     bool ExecuteQuery(const std::string& query, std::vector<Tuple>* result_set);
 
+    // 设置后SELECT的结果边执行边交给sink，不再放进result_set；
+    // 由协议层在一次查询前后设置和清除
+    void SetResultSink(ResultSink* sink) { result_sink_ = sink; }
+    ResultSink* GetResultSink() const { return result_sink_; }
+
+    // 上一条查询是不是重查询，由QueryProcessor设置；I/O线程据此把这个
+    // 连接后面的请求放进批处理队列，所以要用原子变量
+    void SetHeavyWorkload(bool heavy) { heavy_workload_ = heavy; }
+    bool IsHeavyWorkload() const { return heavy_workload_; }
+
+    // Memory charged by the session's statements; QueryProcessor hangs it
+    // under the server tracker before each statement
+    MemoryTracker* GetMemoryTracker() { return &memory_tracker_; }
+
     // Session variables
     void SetVariable(const std::string& name, const std::string& value);
     std::string GetVariable(const std::string& name) const;
@@ -110,6 +128,9 @@ class Session {
 
     // Query processing
     QueryProcessor* query_processor_;
+    ResultSink* result_sink_ = nullptr;
+    std::atomic<bool> heavy_workload_{false};
+    MemoryTracker memory_tracker_{"session"};
 
     // Session variables
     std::unordered_map<std::string, std::string> session_variables_;
@@ -10,10 +10,15 @@
 #include <cstring>
 #include <cerrno>
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 
 #include "protocol/simple_protocol.h"
+#include "common/numa.h"
+#include "stat/metrics.h"
+#include "stat/trace.h"
 
 namespace SimpleRDBMS {
 
@@ -24,7 +29,8 @@ DatabaseServer::DatabaseServer(const ServerConfig& config)
     : config_(config),
       state_(ServerState::STOPPED),
       server_socket_(-1),
-      accepting_connections_(false) {
+      accepting_connections_(false),
+      metrics_socket_(-1) {
     global_instance_ = this;
     InitializeStats();
 }
@@ -74,6 +80,13 @@ bool DatabaseServer::Initialize() {
         SetState(ServerState::ERROR);
         return false;
     }
+
+    Tracer::SetEnabled(config_.GetDatabaseConfig().enable_tracing);
+
+    // Monitoring is optional; the server still runs without it
+    if (!InitializeMetricsEndpoint()) {
+        LogError("Metrics endpoint disabled");
+    }
     
     LogInfo("Database server initialized successfully");
     return true;
@@ -97,6 +110,10 @@ bool DatabaseServer::Start() {
     accepting_connections_ = true;
     accept_thread_ =
         std::make_unique<std::thread>(&DatabaseServer::AcceptLoop, this);
+    if (metrics_socket_ >= 0) {
+        metrics_thread_ =
+            std::make_unique<std::thread>(&DatabaseServer::MetricsLoop, this);
+    }
     
     SetState(ServerState::RUNNING);
     LogInfo("Database server started successfully");
@@ -126,6 +143,21 @@ void DatabaseServer::Stop() {
         accept_thread_->join();
     }
 
+    // Same for the metrics endpoint; scrapes read the components below
+    if (metrics_socket_ >= 0) {
+        shutdown(metrics_socket_, SHUT_RDWR);
+        close(metrics_socket_);
+        metrics_socket_ = -1;
+    }
+    if (metrics_thread_ && metrics_thread_->joinable()) {
+        metrics_thread_->join();
+    }
+
+    // Stop the I/O threads before their connections are closed
+    for (auto& loop : event_loops_) {
+        loop->Stop();
+    }
+
     // Stop connection manager
     if (connection_manager_) {
         connection_manager_->Shutdown();
@@ -166,8 +198,20 @@ bool DatabaseServer::LoadConfig(int argc, char* argv[]) {
 }
 
 void DatabaseServer::UpdateConfig(const ServerConfig& config) {
+    size_t old_pool_size = config_.GetDatabaseConfig().buffer_pool_size;
     config_ = config;
 
+    // Buffer pool can be resized online
+    size_t new_pool_size = config.GetDatabaseConfig().buffer_pool_size;
+    if (buffer_pool_manager_ && new_pool_size != old_pool_size) {
+        if (!buffer_pool_manager_->Resize(new_pool_size)) {
+            LogError("Buffer pool could only be resized to " +
+                     std::to_string(buffer_pool_manager_->GetPoolSize()) +
+                     " frames (requested " + std::to_string(new_pool_size) +
+                     ")");
+        }
+    }
+
     // Update components with new config
     if (connection_manager_) {
         connection_manager_->UpdateConfig(config);
@@ -218,6 +262,159 @@ void DatabaseServer::ResetStats() {
     InitializeStats();
 }
 
+std::string DatabaseServer::GetMetricsText() {
+    MetricsWriter writer;
+    auto stats = GetStats();
+    writer.AddGauge("simpledb_uptime_seconds", "Seconds since the server started.",
+                    stats.uptime.count() / 1000.0);
+
+    if (connection_manager_) {
+        auto conn_stats = connection_manager_->GetStats();
+        writer.AddCounter("simpledb_connections_accepted_total",
+                          "Client connections accepted.",
+                          conn_stats.total_connections);
+        writer.AddGauge("simpledb_connections", "Open client connections by state.",
+                        conn_stats.active_connections,
+                        MetricsWriter::Label("state", "active"));
+        writer.AddGauge("simpledb_connections", "Open client connections by state.",
+                        conn_stats.authenticated_connections,
+                        MetricsWriter::Label("state", "authenticated"));
+        writer.AddGauge("simpledb_connections", "Open client connections by state.",
+                        conn_stats.idle_connections,
+                        MetricsWriter::Label("state", "idle"));
+        writer.AddGauge("simpledb_connections_peak",
+                        "Most client connections open at once.",
+                        conn_stats.peak_connections);
+        writer.AddGauge("simpledb_connections_max",
+                        "Configured connection limit.",
+                        connection_manager_->GetMaxConnections());
+        writer.AddCounter("simpledb_network_sent_bytes_total",
+                          "Bytes sent to clients.", conn_stats.total_bytes_sent);
+        writer.AddCounter("simpledb_network_received_bytes_total",
+                          "Bytes received from clients.",
+                          conn_stats.total_bytes_received);
+    }
+
+    // One sample per pool for every family, families must stay contiguous
+    std::vector<std::pair<std::string, ThreadPool*>> pools;
+    if (query_thread_pool_) {
+        pools.emplace_back("query", query_thread_pool_.get());
+    }
+    if (connection_thread_pool_) {
+        pools.emplace_back("connection", connection_thread_pool_.get());
+    }
+    for (const auto& [name, pool] : pools) {
+        writer.AddGauge("simpledb_thread_pool_utilization",
+                        "Fraction of pool threads running a task.",
+                        pool->GetUtilization(), MetricsWriter::Label("pool", name));
+    }
+    for (const auto& [name, pool] : pools) {
+        writer.AddGauge("simpledb_thread_pool_queue_depth",
+                        "Tasks waiting for a pool thread.", pool->GetQueueSize(),
+                        MetricsWriter::Label("pool", name));
+    }
+    for (const auto& [name, pool] : pools) {
+        writer.AddGauge("simpledb_thread_pool_threads", "Threads in the pool.",
+                        pool->GetTotalThreads(), MetricsWriter::Label("pool", name));
+    }
+    std::vector<TaskStats> task_stats;
+    for (const auto& entry : pools) {
+        task_stats.push_back(entry.second->GetStats());
+    }
+    for (size_t i = 0; i < pools.size(); i++) {
+        writer.AddCounter("simpledb_thread_pool_tasks_completed_total",
+                          "Tasks finished by the pool.",
+                          task_stats[i].completed_tasks,
+                          MetricsWriter::Label("pool", pools[i].first));
+    }
+    for (size_t i = 0; i < pools.size(); i++) {
+        writer.AddCounter("simpledb_thread_pool_tasks_failed_total",
+                          "Tasks that threw an exception.",
+                          task_stats[i].failed_tasks,
+                          MetricsWriter::Label("pool", pools[i].first));
+    }
+    for (size_t i = 0; i < event_loops_.size(); i++) {
+        writer.AddGauge("simpledb_event_loop_connections",
+                        "Connections served by each I/O thread.",
+                        event_loops_[i]->GetConnectionCount(),
+                        MetricsWriter::Label("loop", std::to_string(i)));
+    }
+
+    if (query_processor_) {
+        auto query_stats = query_processor_->GetStats();
+        writer.AddCounter("simpledb_queries_total", "Queries processed by result.",
+                          query_stats.successful_queries,
+                          MetricsWriter::Label("result", "success"));
+        writer.AddCounter("simpledb_queries_total", "Queries processed by result.",
+                          query_stats.failed_queries,
+                          MetricsWriter::Label("result", "failure"));
+        writer.AddHistogram("simpledb_query_duration_seconds",
+                            "End-to-end query latency including parsing and commit.",
+                            query_processor_->GetLatencyHistogram());
+        writer.AddCounter("simpledb_query_cache_hits_total",
+                          "Queries served from the plan cache.",
+                          query_stats.cache_hits);
+        writer.AddCounter("simpledb_query_cache_misses_total",
+                          "Queries that missed the plan cache.",
+                          query_stats.cache_misses);
+
+        auto result_cache = query_processor_->GetResultCacheStats();
+        writer.AddCounter("simpledb_result_cache_hits_total",
+                          "SELECTs answered from the result cache.",
+                          result_cache.hits);
+        writer.AddCounter("simpledb_result_cache_misses_total",
+                          "Cacheable SELECTs that missed the result cache.",
+                          result_cache.misses);
+        writer.AddCounter("simpledb_result_cache_invalidations_total",
+                          "Cached results dropped because a table they read changed.",
+                          result_cache.invalidations);
+        writer.AddGauge("simpledb_result_cache_bytes",
+                        "Estimated memory held by cached results.",
+                        result_cache.bytes);
+
+        auto memory = query_processor_->GetMemoryUsageStats();
+        writer.AddGauge("simpledb_memory_tracked_bytes",
+                        "Memory charged to the server tracker by queries and caches.",
+                        memory.server_bytes);
+        writer.AddGauge("simpledb_memory_tracked_peak_bytes",
+                        "Highest memory ever charged to the server tracker.",
+                        memory.server_peak_bytes);
+        writer.AddGauge("simpledb_memory_limit_bytes",
+                        "Server memory limit, 0 when unlimited.",
+                        memory.server_limit_bytes);
+        writer.AddGauge("simpledb_plan_cache_bytes",
+                        "Estimated memory held by cached plans.",
+                        memory.plan_cache_bytes);
+
+        auto admission = query_processor_->GetAdmissionStats();
+        writer.AddGauge("simpledb_heavy_queries_running",
+                        "Analytical queries currently admitted.",
+                        admission.running_heavy);
+        writer.AddGauge("simpledb_heavy_queries_waiting",
+                        "Analytical queries waiting for admission.",
+                        admission.waiting_heavy);
+        writer.AddCounter("simpledb_heavy_queries_rejected_total",
+                          "Analytical queries rejected by admission control.",
+                          admission.rejected_heavy);
+
+        auto slow_log = query_processor_->GetSlowQueryLogStats();
+        writer.AddCounter("simpledb_slow_query_log_entries_total",
+                          "Entries written to the slow query log.",
+                          slow_log.logged);
+        writer.AddCounter("simpledb_slow_query_log_dropped_total",
+                          "Slow query log entries dropped because the queue was full.",
+                          slow_log.dropped);
+    }
+
+    if (buffer_pool_manager_) {
+        writer.AddGauge("simpledb_buffer_pool_frames", "Frames in the buffer pool.",
+                        buffer_pool_manager_->GetPoolSize());
+    }
+
+    WriteStatisticsMetrics(&writer);
+    return writer.GetText();
+}
+
 void DatabaseServer::SetupSignalHandlers() {
     signal(SIGINT, SignalHandler);
     signal(SIGTERM, SignalHandler);
@@ -342,61 +539,199 @@ bool DatabaseServer::InitializeNetworking() {
     return true;
 }
 
+bool DatabaseServer::InitializeMetricsEndpoint() {
+    int port = config_.GetNetworkConfig().metrics_port;
+    if (port <= 0) {
+        return true;
+    }
+
+    metrics_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (metrics_socket_ < 0) {
+        LogError("Failed to create metrics socket: " + std::string(strerror(errno)));
+        return false;
+    }
+    int yes = 1;
+    setsockopt(metrics_socket_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    // Same address rules as the client port, but no fallback to other ports:
+    // the scraper is configured with a fixed one
+    struct sockaddr_in metrics_addr;
+    std::memset(&metrics_addr, 0, sizeof(metrics_addr));
+    metrics_addr.sin_family = AF_INET;
+    metrics_addr.sin_port = htons(port);
+    const std::string& host = config_.GetNetworkConfig().host;
+    if (host == "localhost" || host == "127.0.0.1") {
+        metrics_addr.sin_addr.s_addr = INADDR_ANY;
+    } else if (inet_pton(AF_INET, host.c_str(), &metrics_addr.sin_addr) <= 0) {
+        LogError("Invalid host address: " + host);
+        close(metrics_socket_);
+        metrics_socket_ = -1;
+        return false;
+    }
+
+    if (bind(metrics_socket_, (struct sockaddr*)&metrics_addr, sizeof(metrics_addr)) < 0 ||
+        listen(metrics_socket_, 16) < 0) {
+        LogError("Failed to open metrics port " + std::to_string(port) + ": " +
+                 std::string(strerror(errno)));
+        close(metrics_socket_);
+        metrics_socket_ = -1;
+        return false;
+    }
+
+    LogInfo("Metrics available at http://" + host + ":" + std::to_string(port) +
+            "/metrics");
+    return true;
+}
+
 bool DatabaseServer::InitializeDatabaseCore() {
     try {
         LogInfo("Initializing database core components...");
         
         // Initialize disk managers
         LogInfo("Creating disk managers...");
+        DiskIOMode io_mode = DiskIOMode::POSITIONAL;
+        if (!ParseDiskIOMode(config_.GetDatabaseConfig().io_mode, &io_mode)) {
+            LogError("Unknown I/O mode '" +
+                     config_.GetDatabaseConfig().io_mode + "', using pread");
+        }
         disk_manager_ = std::make_unique<DiskManager>(
-            config_.GetDatabaseConfig().database_file);
-        log_disk_manager_ =
-            std::make_unique<DiskManager>(config_.GetDatabaseConfig().log_file);
+            config_.GetDatabaseConfig().database_file, io_mode);
+        LogInfo(std::string("Data file I/O mode: ") +
+                DiskIOModeToString(disk_manager_->GetIOMode()));
         
         // Initialize buffer pool
         LogInfo("Creating buffer pool...");
-        replacer_ = std::make_unique<LRUReplacer>(
-            config_.GetDatabaseConfig().buffer_pool_size);
+        const auto& db_config = config_.GetDatabaseConfig();
+        ReplacerType replacer_type = ReplacerType::LRU;
+        if (!ParseReplacerType(db_config.buffer_pool_replacer,
+                               &replacer_type)) {
+            LogError("Unknown buffer pool replacer '" +
+                     db_config.buffer_pool_replacer + "', using lru");
+        }
+        size_t lru_k = db_config.lru_k;
         buffer_pool_manager_ = std::make_unique<BufferPoolManager>(
-            config_.GetDatabaseConfig().buffer_pool_size,
-            std::move(disk_manager_), std::move(replacer_));
+            db_config.buffer_pool_size, db_config.buffer_pool_shards,
+            std::move(disk_manager_),
+            [replacer_type, lru_k](size_t num_frames) {
+                return CreateReplacer(replacer_type, num_frames, lru_k);
+            });
         
         // Initialize log manager
         LogInfo("Creating log manager...");
-        log_manager_ = std::make_unique<LogManager>(log_disk_manager_.get());
+        log_manager_ = std::make_unique<LogManager>(
+            db_config.log_file, db_config.log_buffer_size,
+            db_config.log_segment_size);
+        log_manager_->SetGroupCommitMaxWait(
+            std::chrono::microseconds(db_config.log_group_commit_wait_us));
+        // A replica's pages carry the primary's LSNs, which its own log
+        // never reaches; WAL-before-data would keep them from being written
+        const bool is_primary = db_config.replication_port > 0;
+        const bool is_replica = !db_config.primary_host.empty();
+        if (!is_replica) {
+            buffer_pool_manager_->SetLogManager(log_manager_.get());
+        }
         
         // Initialize lock manager
         LogInfo("Creating lock manager...");
         lock_manager_ = std::make_unique<LockManager>();
+        if (db_config.deadlock_detection_interval_ms > 0) {
+            DeadlockDetectorConfig detector_config;
+            detector_config.interval = std::chrono::milliseconds(
+                db_config.deadlock_detection_interval_ms);
+            detector_config.wait_timeout =
+                std::chrono::milliseconds(db_config.lock_wait_timeout_ms);
+            lock_manager_->StartDeadlockDetection(detector_config);
+        }
         
         // Initialize transaction manager
         LogInfo("Creating transaction manager...");
         transaction_manager_ = std::make_unique<TransactionManager>(
-            lock_manager_.get(), log_manager_.get());
+            lock_manager_.get(), is_replica ? nullptr : log_manager_.get());
         
-        // Initialize catalog
+        // Initialize catalog; row changes are only logged when they have to
+        // be shipped to replicas
         LogInfo("Creating catalog...");
-        catalog_ = std::make_unique<Catalog>(buffer_pool_manager_.get());
-        
-        // Initialize execution engine
-        LogInfo("Creating execution engine...");
-        execution_engine_ = std::make_unique<ExecutionEngine>(
-            buffer_pool_manager_.get(), catalog_.get(),
-            transaction_manager_.get());
+        LogManager* dml_log_manager =
+            is_primary ? log_manager_.get() : nullptr;
+        catalog_ = std::make_unique<Catalog>(buffer_pool_manager_.get(),
+                                             dml_log_manager);
         
         // Initialize recovery manager
         LogInfo("Creating recovery manager...");
         recovery_manager_ = std::make_unique<RecoveryManager>(
             buffer_pool_manager_.get(), catalog_.get(), log_manager_.get(),
             lock_manager_.get());
+        recovery_manager_->SetRedoThreads(db_config.recovery_redo_threads);
+        recovery_manager_->SetTransactionManager(transaction_manager_.get());
         
-        // Perform recovery if needed
-        if (config_.GetDatabaseConfig().enable_recovery) {
+        // Perform recovery if needed, before the execution engine opens the
+        // indexes so that any index rebuild sees the recovered tables
+        // the read-only mmap mode cannot redo into the mapping, it expects a
+        // database that was shut down cleanly
+        if (buffer_pool_manager_->IsReadOnly()) {
+            LogInfo("Database file opened read-only, skipping recovery");
+        } else if (is_replica) {
+            LogInfo("Running as a replica, state comes from the primary's "
+                    "log, skipping recovery");
+        } else if (config_.GetDatabaseConfig().enable_recovery) {
             LogInfo("Performing recovery...");
             recovery_manager_->Recover();
             LogInfo("Recovery completed");
         }
         
+        // Initialize execution engine
+        LogInfo("Creating execution engine...");
+        execution_engine_ = std::make_unique<ExecutionEngine>(
+            buffer_pool_manager_.get(), catalog_.get(),
+            transaction_manager_.get(), dml_log_manager);
+        
+        // Replication: the primary streams its WAL, a replica replays it
+        // and refuses writes
+        if (is_primary) {
+            wal_sender_ = std::make_unique<WalSender>(
+                log_manager_.get(),
+                static_cast<uint16_t>(db_config.replication_port));
+            if (!wal_sender_->Start()) {
+                LogError("Failed to start WAL sender on port " +
+                         std::to_string(db_config.replication_port));
+                return false;
+            }
+        } else if (is_replica) {
+            LogInfo("Replicating from " + db_config.primary_host + ":" +
+                    std::to_string(db_config.primary_port));
+            execution_engine_->SetReplica(true);
+            replica_applier_ = std::make_unique<ReplicaApplier>(
+                buffer_pool_manager_.get(), catalog_.get(),
+                execution_engine_->GetTableManager());
+            wal_receiver_ = std::make_unique<WalReceiver>(
+                replica_applier_.get(), db_config.primary_host,
+                static_cast<uint16_t>(db_config.primary_port));
+            wal_receiver_->Start();
+        }
+        
+        // Start trickling dirty pages once recovery has settled the pool
+        if (db_config.bgwriter_delay_ms > 0 &&
+            !buffer_pool_manager_->IsReadOnly()) {
+            BackgroundWriterConfig writer_config;
+            writer_config.interval =
+                std::chrono::milliseconds(db_config.bgwriter_delay_ms);
+            writer_config.clean_ratio = db_config.bgwriter_clean_ratio;
+            writer_config.max_pages_per_round = db_config.bgwriter_max_pages;
+            buffer_pool_manager_->StartBackgroundWriter(writer_config);
+        }
+        
+        // Preload last run's hot pages in the background, queries are
+        // served meanwhile; the list is refreshed periodically so a crash
+        // still leaves a recent one behind
+        if (!db_config.warmup_file.empty()) {
+            buffer_pool_manager_->StartWarmup(db_config.warmup_file);
+            if (db_config.warmup_dump_interval_s > 0) {
+                buffer_pool_manager_->StartWarmupDump(
+                    db_config.warmup_file,
+                    std::chrono::seconds(db_config.warmup_dump_interval_s));
+            }
+        }
+        
         LogInfo("Database core initialization completed");
         return true;
     } catch (const std::exception& e) {
@@ -414,27 +749,42 @@ bool DatabaseServer::InitializeServerComponents() {
         LogInfo("Initializing server components...");
         
         // Initialize thread pools
-        LogInfo("Creating connection thread pool...");
-        ThreadPoolConfig conn_pool_config;
-        conn_pool_config.min_threads = config_.GetThreadConfig().io_threads;
-        conn_pool_config.max_threads = config_.GetThreadConfig().io_threads * 2;
-        connection_thread_pool_ =
-            std::make_unique<ThreadPool>(conn_pool_config);
-        if (!connection_thread_pool_->Initialize()) {
-            LogError("Failed to initialize connection thread pool");
-            return false;
-        }
-        
         LogInfo("Creating query thread pool...");
         ThreadPoolConfig query_pool_config;
         query_pool_config.min_threads = config_.GetThreadConfig().query_threads;
         query_pool_config.max_threads =
             config_.GetThreadConfig().query_threads * 2;
+        query_pool_config.max_queue_size =
+            config_.GetThreadConfig().max_queue_size;
+        query_pool_config.interactive_weight =
+            config_.GetThreadConfig().interactive_weight;
+        if (config_.GetThreadConfig().pin_threads) {
+            query_pool_config.cpu_affinity =
+                NumaTopology::Get().GetSpreadCpus();
+        }
         query_thread_pool_ = std::make_unique<ThreadPool>(query_pool_config);
         if (!query_thread_pool_->Initialize()) {
             LogError("Failed to initialize query thread pool");
             return false;
         }
+
+        // Connections are multiplexed on epoll I/O threads; fall back to a
+        // thread per connection if the reactors cannot start
+        if (!InitializeEventLoops()) {
+            LogError("Event loops unavailable, using a thread per connection");
+            LogInfo("Creating connection thread pool...");
+            ThreadPoolConfig conn_pool_config;
+            conn_pool_config.min_threads = config_.GetThreadConfig().io_threads;
+            conn_pool_config.max_threads =
+                config_.GetThreadConfig().io_threads * 2;
+            conn_pool_config.cpu_affinity = GetIoCpus();
+            connection_thread_pool_ =
+                std::make_unique<ThreadPool>(conn_pool_config);
+            if (!connection_thread_pool_->Initialize()) {
+                LogError("Failed to initialize connection thread pool");
+                return false;
+            }
+        }
         
         // Initialize connection manager
         LogInfo("Creating connection manager...");
@@ -466,6 +816,63 @@ bool DatabaseServer::InitializeServerComponents() {
     }
 }
 
+/**
+ * 每个I/O线程一个EventLoop
+ * 完整的请求交给查询线程池执行，连接关闭时从ConnectionManager中移除
+ */
+bool DatabaseServer::InitializeEventLoops() {
+    size_t loop_count = static_cast<size_t>(
+        std::max(1, config_.GetThreadConfig().io_threads));
+    LogInfo("Creating " + std::to_string(loop_count) + " event loops...");
+
+    auto dispatcher = [this](std::function<void()> task,
+                             TaskPriority priority) {
+        query_thread_pool_->Submit(std::move(task), priority);
+    };
+    auto on_close = [this](int fd, const std::shared_ptr<Connection>& conn) {
+        std::string address = conn->GetClientAddress();
+        if (!connection_manager_ ||
+            !connection_manager_->RemoveConnection(conn)) {
+            conn->Close();
+        }
+        LogInfo("Connection closed: " + address + " (fd " +
+                std::to_string(fd) + ")");
+    };
+    std::vector<int> io_cpus = GetIoCpus();
+    for (size_t i = 0; i < loop_count; i++) {
+        auto loop = std::make_unique<EventLoop>(dispatcher, on_close);
+        loop->SetCpuAffinity(io_cpus);
+        if (!loop->Start()) {
+            event_loops_.clear();
+            return false;
+        }
+        event_loops_.push_back(std::move(loop));
+    }
+    return true;
+}
+
+/**
+ * I/O线程运行的CPU
+ * 绑核时把I/O线程限制在收网卡中断的那个节点上，socket缓冲区和
+ * 连接的输入输出缓冲区都落在这个节点；不知道网卡在哪个节点时不限制
+ */
+std::vector<int> DatabaseServer::GetIoCpus() const {
+    const ThreadConfig& thread_config = config_.GetThreadConfig();
+    if (!thread_config.pin_threads) {
+        return {};
+    }
+    const NumaTopology& topology = NumaTopology::Get();
+    int node = thread_config.io_numa_node;
+    if (node < 0) {
+        node = NumaTopology::GetNetworkDeviceNode(thread_config.nic_interface);
+    }
+    if (node < 0 || topology.GetNodeCpus(node).empty()) {
+        return {};
+    }
+    LogInfo("I/O threads pinned to NUMA node " + std::to_string(node));
+    return topology.GetNodeCpus(node);
+}
+
 bool DatabaseServer::InitializeLogging() {
     // In a real implementation, initialize logging framework here
     return true;
@@ -565,8 +972,12 @@ bool DatabaseServer::HandleNewConnection(int client_socket,
         }
     }
     
-    // Process connection in thread pool
-    if (connection_thread_pool_) {
+    // Hand the connection to an I/O thread; requests are read there and
+    // only complete ones reach the query thread pool
+    if (!event_loops_.empty()) {
+        size_t index = next_event_loop_.fetch_add(1) % event_loops_.size();
+        event_loops_[index]->AddConnection(connection);
+    } else if (connection_thread_pool_) {
         connection_thread_pool_->Enqueue(&DatabaseServer::ProcessConnection, this,
                                          connection);
     } else {
@@ -618,15 +1029,151 @@ void DatabaseServer::ProcessConnection(std::shared_ptr<Connection> connection) {
     LogInfo("Connection closed: " + connection->GetClientAddress());
 }
 
+void DatabaseServer::MetricsLoop() {
+    while (accepting_connections_ && metrics_socket_ >= 0) {
+        int client_socket = accept(metrics_socket_, nullptr, nullptr);
+        if (client_socket < 0) {
+            if (errno != EINTR && accepting_connections_) {
+                LogError("Failed to accept metrics connection: " +
+                         std::string(strerror(errno)));
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            continue;
+        }
+        HandleMetricsRequest(client_socket);
+        close(client_socket);
+    }
+}
+
+/**
+ * Answers one HTTP request: GET /metrics (or /) returns the exposition text,
+ * GET /trace dumps the trace buffers as Chrome trace JSON, GET /queries
+ * lists the running statements with the session ids KILL takes, and
+ * POST /trace/start, /trace/stop and /trace/clear control tracing.
+ * Anything else gets a 404 or 405. The connection is always closed afterwards.
+ */
+void DatabaseServer::HandleMetricsRequest(int client_socket) {
+    // A stalled scraper must not hold up the next one for long
+    struct timeval timeout;
+    timeout.tv_sec = 2;
+    timeout.tv_usec = 0;
+    setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client_socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Only the request line matters; read until the headers end
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos &&
+           request.find("\n\n") == std::string::npos && request.size() < 8192) {
+        ssize_t received = recv(client_socket, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    std::istringstream request_line(request.substr(0, request.find('\n')));
+    std::string method;
+    std::string target;
+    request_line >> method >> target;
+    target = target.substr(0, target.find('?'));
+
+    std::string status = "200 OK";
+    std::string content_type = MetricsWriter::CONTENT_TYPE;
+    std::string body;
+    bool is_read = method == "GET" || method == "HEAD";
+    if (target == "/trace/start" || target == "/trace/stop" ||
+        target == "/trace/clear") {
+        content_type = "text/plain";
+        if (method != "POST") {
+            status = "405 Method Not Allowed";
+            body = "Use POST to control tracing\n";
+        } else if (target == "/trace/start") {
+            Tracer::SetEnabled(true);
+            body = "Tracing started\n";
+        } else if (target == "/trace/stop") {
+            Tracer::SetEnabled(false);
+            body = "Tracing stopped\n";
+        } else {
+            Tracer::Clear();
+            body = "Trace buffers cleared\n";
+        }
+    } else if (!is_read) {
+        status = "405 Method Not Allowed";
+        content_type = "text/plain";
+        body = "Only GET is supported\n";
+    } else if (target == "/trace") {
+        content_type = "application/json";
+        body = Tracer::DumpChromeTrace();
+    } else if (target == "/queries") {
+        // One line per statement: session id, elapsed ms, tracked memory
+        // bytes, query text
+        content_type = "text/plain";
+        if (query_processor_) {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(1);
+            for (const auto& query : query_processor_->GetRunningQueries()) {
+                std::string text = query.query;
+                std::replace(text.begin(), text.end(), '\n', ' ');
+                oss << query.session_id << '\t' << query.elapsed_ms << '\t'
+                    << query.memory_bytes << '\t' << text << '\n';
+            }
+            body = oss.str();
+        }
+    } else if (target != "/metrics" && target != "/") {
+        status = "404 Not Found";
+        content_type = "text/plain";
+        body = "Metrics are served at /metrics\n";
+    } else {
+        body = GetMetricsText();
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\n" +
+                           "Content-Type: " + content_type + "\r\n" +
+                           "Content-Length: " + std::to_string(body.size()) +
+                           "\r\n" + "Connection: close\r\n\r\n";
+    if (method != "HEAD") {
+        response += body;
+    }
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = send(client_socket, response.data() + sent,
+                         response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            break;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
 void DatabaseServer::CleanupNetworking() {
     if (server_socket_ >= 0) {
         close(server_socket_);
         server_socket_ = -1;
     }
+    if (metrics_socket_ >= 0) {
+        close(metrics_socket_);
+        metrics_socket_ = -1;
+    }
 }
 
 void DatabaseServer::CleanupDatabaseCore() {
     // Cleanup in reverse order of initialization
+    wal_sender_.reset();
+    wal_receiver_.reset();
+    replica_applier_.reset();
+    if (buffer_pool_manager_) {
+        buffer_pool_manager_->StopWarmup();
+        buffer_pool_manager_->StopWarmupDump();
+        const std::string& warmup_file =
+            config_.GetDatabaseConfig().warmup_file;
+        if (!warmup_file.empty() &&
+            !buffer_pool_manager_->SaveWarmupFile(warmup_file)) {
+            LogError("Failed to save buffer pool warmup file " + warmup_file);
+        }
+        buffer_pool_manager_->StopBackgroundWriter();  // reads the log manager
+    }
     recovery_manager_.reset();
     execution_engine_.reset();
     catalog_.reset();
@@ -635,7 +1182,6 @@ void DatabaseServer::CleanupDatabaseCore() {
     log_manager_.reset();
     buffer_pool_manager_.reset();
     replacer_.reset();
-    log_disk_manager_.reset();
     disk_manager_.reset();
 }
 
@@ -644,6 +1190,8 @@ void DatabaseServer::CleanupServerComponents() {
     connection_manager_.reset();
     query_thread_pool_.reset();
     connection_thread_pool_.reset();
+    // Query workers may still post completions until their pool is gone
+    event_loops_.clear();
 }
 
 void DatabaseServer::SetState(ServerState new_state) {
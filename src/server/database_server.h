@@ -2,6 +2,7 @@
 
 #include "config/server_config.h"
 #include "connection/connection_manager.h"
+#include "connection/event_loop.h"
 #include "thread/thread_pool.h"
 #include "query/query_processor.h"
 #include "protocol/protocol_handler.h"
@@ -16,9 +17,13 @@
 #include "transaction/lock_manager.h"
 #include "recovery/log_manager.h"
 #include "recovery/recovery_manager.h"
+#include "replication/replica_applier.h"
+#include "replication/wal_receiver.h"
+#include "replication/wal_sender.h"
 
 #include <memory>
 #include <thread>
+#include <vector>
 #include <atomic>
 #include <mutex>
 #include <chrono>
@@ -79,6 +84,8 @@ public:
     ServerStats GetStats();
     void PrintStats();
     void ResetStats();
+    // All server and engine metrics in the Prometheus text format
+    std::string GetMetricsText();
     
     // Component access (for testing or advanced usage)
     ConnectionManager* GetConnectionManager() const { return connection_manager_.get(); }
@@ -98,10 +105,14 @@ private:
     int server_socket_;
     std::unique_ptr<std::thread> accept_thread_;
     std::atomic<bool> accepting_connections_;
+
+    // Metrics endpoint, only opened when network.metrics_port > 0;
+    // scrapes are answered one at a time on metrics_thread_
+    int metrics_socket_;
+    std::unique_ptr<std::thread> metrics_thread_;
     
     // Core database components
     std::unique_ptr<DiskManager> disk_manager_;
-    std::unique_ptr<DiskManager> log_disk_manager_;
     std::unique_ptr<LRUReplacer> replacer_;
     std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
     std::unique_ptr<LogManager> log_manager_;
@@ -110,9 +121,16 @@ private:
     std::unique_ptr<Catalog> catalog_;
     std::unique_ptr<ExecutionEngine> execution_engine_;
     std::unique_ptr<RecoveryManager> recovery_manager_;
+    std::unique_ptr<WalSender> wal_sender_;            // primary only
+    std::unique_ptr<ReplicaApplier> replica_applier_;  // replica only
+    std::unique_ptr<WalReceiver> wal_receiver_;        // replica only
     
     // Server components
     std::unique_ptr<ConnectionManager> connection_manager_;
+    // I/O线程上的epoll反应器，连接按轮转分给它们；启动失败时退回到
+    // connection_thread_pool_，每个连接占一个线程
+    std::vector<std::unique_ptr<EventLoop>> event_loops_;
+    std::atomic<size_t> next_event_loop_{0};
     std::unique_ptr<ThreadPool> connection_thread_pool_;
     std::unique_ptr<ThreadPool> query_thread_pool_;
     std::unique_ptr<QueryProcessor> query_processor_;
@@ -132,12 +150,17 @@ private:
     bool InitializeNetworking();
     bool InitializeDatabaseCore();
     bool InitializeServerComponents();
+    bool InitializeEventLoops();
+    std::vector<int> GetIoCpus() const;
     bool InitializeLogging();
+    bool InitializeMetricsEndpoint();
     
     // Network methods
     void AcceptLoop();
     bool HandleNewConnection(int client_socket, const sockaddr_in& client_addr);
     void ProcessConnection(std::shared_ptr<Connection> connection);
+    void MetricsLoop();
+    void HandleMetricsRequest(int client_socket);
     
     // Cleanup methods
     void CleanupNetworking();
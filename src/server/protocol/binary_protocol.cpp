@@ -0,0 +1,421 @@
+#include "server/protocol/binary_protocol.h"
+#include "server/connection/connection.h"
+#include "server/connection/session.h"
+#include "execution/result_sink.h"
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+namespace SimpleRDBMS {
+
+bool BinaryProtocolHandler::HandleConnection(Connection* connection) {
+    if (!connection) {
+        return false;
+    }
+    connection->SendData(FormatAuthenticationChallenge());
+    return true;
+}
+
+bool BinaryProtocolHandler::HandleDisconnection(Connection* /*connection*/) {
+    return true;
+}
+
+/**
+ * 解析一个完整的帧
+ * raw_data以长度字段开头，GetMessageLength已经保证帧是完整的；
+ * 帧内容不合法时返回nullptr，由连接回复错误
+ */
+std::unique_ptr<Message> BinaryProtocolHandler::ParseMessage(const std::string& raw_data) {
+    if (raw_data.size() < HEADER_SIZE + 1) {
+        return nullptr;
+    }
+    size_t length = ReadU32(raw_data, 0);
+    if (length == 0 || raw_data.size() < HEADER_SIZE + length) {
+        return nullptr;
+    }
+    char type = raw_data[HEADER_SIZE];
+    std::string payload = raw_data.substr(HEADER_SIZE + 1, length - 1);
+
+    auto message = std::make_unique<Message>();
+    switch (type) {
+        case FRAME_AUTH: {
+            size_t offset = 0;
+            std::string username;
+            std::string password;
+            if (!ReadString(payload, &offset, &username) ||
+                !ReadString(payload, &offset, &password)) {
+                return nullptr;
+            }
+            message->type = MessageType::AUTHENTICATION;
+            message->parameters.push_back(username);
+            message->parameters.push_back(password);
+            break;
+        }
+        case FRAME_QUERY:
+            message->type = MessageType::QUERY;
+            message->content = std::move(payload);
+            break;
+        case FRAME_PING:
+            message->type = MessageType::HEARTBEAT;
+            break;
+        case FRAME_CLOSE:
+            message->type = MessageType::CLOSE;
+            break;
+        default:
+            message->type = MessageType::UNKNOWN;
+            break;
+    }
+    message->length = raw_data.size();
+    return message;
+}
+
+std::string BinaryProtocolHandler::FormatMessage(const Message& message) {
+    switch (message.type) {
+        case MessageType::OK:
+            return FormatOkMessage(message.content);
+        case MessageType::ERROR:
+            return FormatError(message.content);
+        case MessageType::READY:
+            return MakeFrame(FRAME_READY, message.content);
+        default:
+            return MakeFrame(FRAME_OK, message.content);
+    }
+}
+
+bool BinaryProtocolHandler::HandleAuthentication(Connection* connection, const Message& message) {
+    if (!connection) {
+        return false;
+    }
+    if (message.parameters.size() < 2) {
+        connection->SendData(
+            FormatAuthenticationResponse(false, "Invalid authentication data"));
+        return false;
+    }
+    bool success =
+        connection->Authenticate(message.parameters[0], message.parameters[1]);
+    connection->SendData(FormatAuthenticationResponse(
+        success, success ? "Authentication successful" : "Authentication failed"));
+    return success;
+}
+
+std::string BinaryProtocolHandler::FormatAuthenticationChallenge() {
+    return MakeFrame(FRAME_READY, "Authentication required");
+}
+
+std::string BinaryProtocolHandler::FormatAuthenticationResponse(bool success, const std::string& message) {
+    return success ? FormatOkMessage(message) : FormatError(message);
+}
+
+/**
+ * ResultStream - 一个结果的编码状态
+ * 第一行到达时按各个值的类型确定列类型并发出行描述帧，之后的行编码进
+ * 批次缓冲区，攒够BATCH_BYTES发一个行批次帧；emit返回false（发送失败）
+ * 或者某一行的值类型和列类型对不上时停止，Consume随之返回false
+ */
+class BinaryProtocolHandler::ResultStream : public ResultSink {
+public:
+    using Emit = std::function<bool(std::string&&)>;
+
+    explicit ResultStream(Emit emit) : emit_(std::move(emit)) {}
+
+    bool Consume(std::vector<Tuple>* rows) override {
+        for (const Tuple& row : *rows) {
+            if (!AddRow(row)) {
+                return false;
+            }
+        }
+        streamed_rows_ += rows->size();
+        return true;
+    }
+
+    bool AddRow(const Tuple& tuple) {
+        if (failed_) {
+            return false;
+        }
+        const std::vector<Value>& values = tuple.GetValues();
+        if (!described_ && !Describe(values)) {
+            return false;
+        }
+        if (values.size() != types_.size()) {
+            return Fail("Row " + std::to_string(rows_) + " has " +
+                        std::to_string(values.size()) +
+                        " columns, expected " + std::to_string(types_.size()));
+        }
+        for (size_t i = 0; i < values.size(); i++) {
+            if (GetValueType(values[i]) != types_[i]) {
+                return Fail("Row " + std::to_string(rows_) + " column " +
+                            std::to_string(i) + " changes type");
+            }
+            AppendValue(&batch_, values[i]);
+        }
+        rows_++;
+        batch_rows_++;
+        return batch_.size() < BATCH_BYTES || FlushBatch();
+    }
+
+    // 发出剩下的行和完成帧
+    bool Finish(uint64_t affected_rows) {
+        if (failed_ || (batch_rows_ > 0 && !FlushBatch())) {
+            return false;
+        }
+        std::string payload;
+        AppendU64(&payload, affected_rows);
+        return Send(MakeFrame(FRAME_COMPLETE, payload));
+    }
+
+    // 通过Consume边执行边发出去的行数，这些行不在QueryResult里
+    uint64_t GetStreamedRows() const { return streamed_rows_; }
+    // 编码失败的原因，为空表示失败在发送上或者没有失败
+    const std::string& GetError() const { return error_; }
+    bool IsSendFailed() const { return failed_ && error_.empty(); }
+
+private:
+    bool Describe(const std::vector<Value>& values) {
+        std::string payload;
+        AppendU16(&payload, static_cast<uint16_t>(values.size()));
+        for (size_t i = 0; i < values.size(); i++) {
+            types_.push_back(GetValueType(values[i]));
+            payload.push_back(static_cast<char>(types_.back()));
+            AppendString(&payload, "col" + std::to_string(i));
+        }
+        described_ = true;
+        return Send(MakeFrame(FRAME_ROW_DESCRIPTION, payload));
+    }
+
+    // 帧头和行数据分开交出去，行数据不再拷贝进一个完整的帧，
+    // 连接合并输出时两块由一次sendmsg发出
+    bool FlushBatch() {
+        std::string header;
+        AppendU32(&header, static_cast<uint32_t>(1 + 4 + batch_.size()));
+        header.push_back(FRAME_ROW_BATCH);
+        AppendU32(&header, batch_rows_);
+        std::string rows;
+        rows.swap(batch_);
+        batch_rows_ = 0;
+        return Send(std::move(header)) &&
+               (rows.empty() || Send(std::move(rows)));
+    }
+
+    bool Send(std::string&& frame) {
+        if (!emit_(std::move(frame))) {
+            failed_ = true;
+        }
+        return !failed_;
+    }
+
+    bool Fail(const std::string& error) {
+        error_ = error;
+        failed_ = true;
+        return false;
+    }
+
+    Emit emit_;
+    std::vector<TypeId> types_;
+    bool described_ = false;
+    bool failed_ = false;
+    std::string error_;
+    std::string batch_;
+    uint32_t batch_rows_ = 0;
+    uint64_t rows_ = 0;
+    uint64_t streamed_rows_ = 0;
+};
+
+/**
+ * 执行查询并按批次发送结果
+ * 实现思路：
+ * 1. 把ResultStream设成session的结果接收器，SELECT的行在执行过程中
+ *    直接编码发送，其他语句的结果留在QueryResult里
+ * 2. 执行成功后把QueryResult里的行也交给流，最后发完成帧，
+ *    影响行数加上流式发出去的行数
+ * 3. 执行失败或者编码失败时发错误帧，已经发出去的行描述帧和行批次帧
+ *    由客户端丢弃；发送失败说明连接出了问题，不再回复
+ */
+bool BinaryProtocolHandler::HandleQuery(Connection* connection, const Message& message) {
+    if (!connection || !connection->GetSession()) {
+        if (connection) {
+            connection->SendData(FormatError("No session available"));
+        }
+        return false;
+    }
+
+    Session* session = connection->GetSession();
+    ResultStream stream([connection](std::string&& frame) {
+        return connection->SendData(std::move(frame)) > 0;
+    });
+    session->SetResultSink(&stream);
+    QueryResult result = ExecuteQueryOnSession(session, message.content);
+    session->SetResultSink(nullptr);
+
+    bool sent = !stream.IsSendFailed();
+    if (sent && result.success) {
+        for (const Tuple& tuple : result.result_set) {
+            if (!stream.AddRow(tuple)) {
+                break;
+            }
+        }
+        sent = stream.Finish(result.affected_rows + stream.GetStreamedRows());
+        if (!sent && !stream.IsSendFailed()) {
+            sent = connection->SendData(FormatError(stream.GetError())) > 0;
+        }
+    } else if (sent) {
+        const std::string& error = stream.GetError().empty()
+                                       ? result.error_message
+                                       : stream.GetError();
+        sent = connection->SendData(FormatError(error)) > 0;
+    }
+    if (!sent) {
+        std::cerr << "[ERROR] Failed to send binary query response"
+                  << std::endl;
+    }
+    return sent;
+}
+
+std::string BinaryProtocolHandler::FormatQueryResult(const QueryResult& result) {
+    std::string response;
+    ResultStream stream([&response](std::string&& frame) {
+        response += frame;
+        return true;
+    });
+    for (const Tuple& tuple : result.result_set) {
+        if (!stream.AddRow(tuple)) {
+            break;
+        }
+    }
+    if (!stream.Finish(result.affected_rows)) {
+        response += FormatError(stream.GetError());
+    }
+    return response;
+}
+
+std::string BinaryProtocolHandler::FormatError(const std::string& error_message) {
+    return MakeFrame(FRAME_ERROR, error_message);
+}
+
+std::string BinaryProtocolHandler::FormatReadyMessage() {
+    return MakeFrame(FRAME_READY, "SimpleRDBMS Server ready for queries.");
+}
+
+std::string BinaryProtocolHandler::FormatOkMessage(const std::string& message) {
+    return MakeFrame(FRAME_OK, message);
+}
+
+bool BinaryProtocolHandler::IsComplete(const std::string& buffer) const {
+    return GetMessageLength(buffer) > 0;
+}
+
+size_t BinaryProtocolHandler::GetMessageLength(const std::string& buffer) const {
+    if (buffer.size() < HEADER_SIZE) {
+        return 0;
+    }
+    size_t length = HEADER_SIZE + ReadU32(buffer, 0);
+    return buffer.size() >= length ? length : 0;
+}
+
+bool BinaryProtocolHandler::IsOversized(const std::string& buffer,
+                                        size_t limit) const {
+    if (buffer.size() < HEADER_SIZE) {
+        return buffer.size() > limit;
+    }
+    return HEADER_SIZE + static_cast<size_t>(ReadU32(buffer, 0)) > limit;
+}
+
+std::string BinaryProtocolHandler::MakeFrame(char type, const std::string& payload) {
+    std::string frame;
+    frame.reserve(HEADER_SIZE + 1 + payload.size());
+    AppendU32(&frame, static_cast<uint32_t>(payload.size() + 1));
+    frame.push_back(type);
+    frame += payload;
+    return frame;
+}
+
+void BinaryProtocolHandler::AppendU16(std::string* out, uint16_t value) {
+    out->push_back(static_cast<char>(value >> 8));
+    out->push_back(static_cast<char>(value));
+}
+
+void BinaryProtocolHandler::AppendU32(std::string* out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out->push_back(static_cast<char>(value >> shift));
+    }
+}
+
+void BinaryProtocolHandler::AppendU64(std::string* out, uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out->push_back(static_cast<char>(value >> shift));
+    }
+}
+
+void BinaryProtocolHandler::AppendString(std::string* out, const std::string& value) {
+    AppendU32(out, static_cast<uint32_t>(value.size()));
+    *out += value;
+}
+
+uint32_t BinaryProtocolHandler::ReadU32(const std::string& data, size_t offset) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; i++) {
+        value = (value << 8) | static_cast<uint8_t>(data[offset + i]);
+    }
+    return value;
+}
+
+bool BinaryProtocolHandler::ReadString(const std::string& data, size_t* offset,
+                                       std::string* value) {
+    if (data.size() < *offset + 4) {
+        return false;
+    }
+    size_t length = ReadU32(data, *offset);
+    *offset += 4;
+    if (data.size() - *offset < length) {
+        return false;
+    }
+    value->assign(data, *offset, length);
+    *offset += length;
+    return true;
+}
+
+TypeId BinaryProtocolHandler::GetValueType(const Value& value) {
+    if (std::holds_alternative<bool>(value)) {
+        return TypeId::BOOLEAN;
+    } else if (std::holds_alternative<int8_t>(value)) {
+        return TypeId::TINYINT;
+    } else if (std::holds_alternative<int16_t>(value)) {
+        return TypeId::SMALLINT;
+    } else if (std::holds_alternative<int32_t>(value)) {
+        return TypeId::INTEGER;
+    } else if (std::holds_alternative<int64_t>(value)) {
+        return TypeId::BIGINT;
+    } else if (std::holds_alternative<float>(value)) {
+        return TypeId::FLOAT;
+    } else if (std::holds_alternative<double>(value)) {
+        return TypeId::DOUBLE;
+    }
+    return TypeId::VARCHAR;
+}
+
+void BinaryProtocolHandler::AppendValue(std::string* out, const Value& value) {
+    if (std::holds_alternative<bool>(value)) {
+        out->push_back(std::get<bool>(value) ? 1 : 0);
+    } else if (std::holds_alternative<int8_t>(value)) {
+        out->push_back(static_cast<char>(std::get<int8_t>(value)));
+    } else if (std::holds_alternative<int16_t>(value)) {
+        AppendU16(out, static_cast<uint16_t>(std::get<int16_t>(value)));
+    } else if (std::holds_alternative<int32_t>(value)) {
+        AppendU32(out, static_cast<uint32_t>(std::get<int32_t>(value)));
+    } else if (std::holds_alternative<int64_t>(value)) {
+        AppendU64(out, static_cast<uint64_t>(std::get<int64_t>(value)));
+    } else if (std::holds_alternative<float>(value)) {
+        uint32_t bits;
+        float f = std::get<float>(value);
+        std::memcpy(&bits, &f, sizeof(bits));
+        AppendU32(out, bits);
+    } else if (std::holds_alternative<double>(value)) {
+        uint64_t bits;
+        double d = std::get<double>(value);
+        std::memcpy(&bits, &d, sizeof(bits));
+        AppendU64(out, bits);
+    } else {
+        AppendString(out, std::get<std::string>(value));
+    }
+}
+
+} // namespace SimpleRDBMS
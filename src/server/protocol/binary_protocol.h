@@ -0,0 +1,114 @@
+#pragma once
+
+#include "protocol_handler.h"
+#include <cstdint>
+
+namespace SimpleRDBMS {
+
+/**
+ * Binary protocol for SimpleRDBMS
+ *
+ * A text connection switches to it by sending "BINARY"; the server answers
+ * "OK BINARY" in text and every byte after that is binary.
+ *
+ * Frame format (integers are big-endian):
+ * - u32 length of everything after the length field
+ * - u8  frame type
+ * - payload
+ * A string is a u32 byte count followed by the bytes.
+ *
+ * Client frames:
+ * - 'A' authenticate: string username, string password
+ * - 'Q' query: the rest of the payload is the SQL text
+ * - 'P' ping, 'X' close: empty payload
+ *
+ * Server frames:
+ * - 'R' ready / 'K' ok / 'E' error: the rest of the payload is the text
+ * - 'T' row description: u16 column count, per column u8 TypeId + string name
+ * - 'B' row batch: u32 row count, then each row's values in column order,
+ *   encoded by the column type: BOOLEAN/TINYINT 1 byte, SMALLINT 2,
+ *   INTEGER 4, BIGINT 8, FLOAT/DOUBLE as IEEE bits in 4/8 bytes,
+ *   VARCHAR as a string
+ * - 'C' command complete: u64 affected row count
+ * A result is ended by 'C' or, when the query fails part way, by 'E'.
+ *
+ * 设计思路：
+ * - 结果集按列类型直接写出定长字节，不经过文本格式化，客户端也不用再解析
+ * - 行按批次发送，每攒够BATCH_BYTES字节发一帧，大结果集不需要先在内存里
+ *   拼出完整的响应
+ * - SELECT通过ResultSink边执行边编码发送，服务器只缓存一块结果，
+ *   客户端在查询结束之前就能收到第一批行；socket写满时SendData阻塞，
+ *   执行也跟着停下来
+ */
+class BinaryProtocolHandler : public ProtocolHandler {
+public:
+    BinaryProtocolHandler() = default;
+    ~BinaryProtocolHandler() override = default;
+
+    // Protocol identification
+    std::string GetProtocolName() const override { return "Binary"; }
+    std::string GetProtocolVersion() const override { return "1.0"; }
+    bool IsTextProtocol() const override { return false; }
+
+    // Connection handling
+    bool HandleConnection(Connection* connection) override;
+    bool HandleDisconnection(Connection* connection) override;
+
+    // Message parsing and formatting
+    std::unique_ptr<Message> ParseMessage(const std::string& raw_data) override;
+    std::string FormatMessage(const Message& message) override;
+
+    // Authentication
+    bool HandleAuthentication(Connection* connection, const Message& message) override;
+    std::string FormatAuthenticationChallenge() override;
+    std::string FormatAuthenticationResponse(bool success, const std::string& message = "") override;
+
+    // Query handling
+    bool HandleQuery(Connection* connection, const Message& message) override;
+    std::string FormatQueryResult(const QueryResult& result) override;
+    std::string FormatError(const std::string& error_message) override;
+
+    // Status messages
+    std::string FormatReadyMessage() override;
+    std::string FormatOkMessage(const std::string& message = "") override;
+
+    // Utility methods
+    bool IsComplete(const std::string& buffer) const override;
+    size_t GetMessageLength(const std::string& buffer) const override;
+    // 按头部里的长度判断，不用等数据收满
+    bool IsOversized(const std::string& buffer, size_t limit) const override;
+
+    // Frame types
+    static constexpr char FRAME_AUTH = 'A';
+    static constexpr char FRAME_QUERY = 'Q';
+    static constexpr char FRAME_PING = 'P';
+    static constexpr char FRAME_CLOSE = 'X';
+    static constexpr char FRAME_READY = 'R';
+    static constexpr char FRAME_OK = 'K';
+    static constexpr char FRAME_ERROR = 'E';
+    static constexpr char FRAME_ROW_DESCRIPTION = 'T';
+    static constexpr char FRAME_ROW_BATCH = 'B';
+    static constexpr char FRAME_COMPLETE = 'C';
+
+    // 一个行批次帧攒到这么多字节就发出去
+    static constexpr size_t BATCH_BYTES = 64 * 1024;
+
+private:
+    static constexpr size_t HEADER_SIZE = 4;
+
+    // 把结果行编码成行描述帧和行批次帧，也作为流式查询的ResultSink
+    class ResultStream;
+
+    static std::string MakeFrame(char type, const std::string& payload);
+    static void AppendU16(std::string* out, uint16_t value);
+    static void AppendU32(std::string* out, uint32_t value);
+    static void AppendU64(std::string* out, uint64_t value);
+    static void AppendString(std::string* out, const std::string& value);
+    static uint32_t ReadU32(const std::string& data, size_t offset);
+    static bool ReadString(const std::string& data, size_t* offset,
+                           std::string* value);
+    static TypeId GetValueType(const Value& value);
+    static void AppendValue(std::string* out, const Value& value);
+};
+
+} // namespace SimpleRDBMS
@@ -5,6 +5,7 @@
 
 #include "server/connection/connection.h"
 #include "server/connection/session.h"
+#include "server/protocol/binary_protocol.h"
 #include "server/protocol/simple_protocol.h"
 
 namespace SimpleRDBMS {
@@ -134,6 +135,8 @@ std::unique_ptr<ProtocolHandler> ProtocolHandlerFactory::CreateHandler(
     switch (type) {
         case ProtocolType::SIMPLE_TEXT:
             return std::make_unique<SimpleProtocolHandler>();
+        case ProtocolType::BINARY:
+            return std::make_unique<BinaryProtocolHandler>();
         case ProtocolType::POSTGRESQL:
             // Not implemented yet
             return nullptr;
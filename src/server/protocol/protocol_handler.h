@@ -22,7 +22,8 @@ enum class MessageType {
     ERROR,              // 错误消息
     RESULT,             // 查询结果
     OK,                 // 成功响应
-    READY               // 准备就绪
+    READY,              // 准备就绪
+    SWITCH_PROTOCOL     // 切换到二进制协议
 };
 
 struct Message {
@@ -55,6 +56,8 @@ public:
     // Protocol identification
     virtual std::string GetProtocolName() const = 0;
     virtual std::string GetProtocolVersion() const = 0;
+    // 文本协议的请求会先去掉首尾空白，二进制协议原样交给ParseMessage
+    virtual bool IsTextProtocol() const { return true; }
     
     // Connection handling
     virtual bool HandleConnection(Connection* connection) = 0;
@@ -81,6 +84,11 @@ public:
     // Utility methods
     virtual bool IsComplete(const std::string& buffer) const = 0;
     virtual size_t GetMessageLength(const std::string& buffer) const = 0;
+    // 缓冲区开头还不完整的请求是否已经超过limit字节；默认按已经收到的
+    // 字节数判断，带长度前缀的协议收到头部就能判断
+    virtual bool IsOversized(const std::string& buffer, size_t limit) const {
+        return buffer.size() > limit;
+    }
 
 protected:
     // Helper methods for subclasses
@@ -95,6 +103,7 @@ class ProtocolHandlerFactory {
 public:
     enum class ProtocolType {
         SIMPLE_TEXT,
+        BINARY,
         POSTGRESQL,
         MYSQL
     };
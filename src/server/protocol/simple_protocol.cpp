@@ -76,6 +76,13 @@ std::unique_ptr<Message> SimpleProtocolHandler::ParseMessage(const std::string&
             }
             break;
         case MessageType::QUERY:
+            // PARSE/BIND换成PREPARE/EXECUTE交给查询处理器，
+            // 预编译语句由执行引擎按名字保存
+            if (command == CMD_PARSE || command == CMD_BIND) {
+                message->content = BuildPreparedStatementQuery(
+                    command, parts.size() > 1 ? parts[1] : "");
+                break;
+            }
             // Reconstruct query from remaining parts
             if (parts.size() > 1) {
                 message->content = trimmed_data.substr(parts[0].length());
@@ -102,6 +109,7 @@ std::unique_ptr<Message> SimpleProtocolHandler::ParseMessage(const std::string&
             break;
         case MessageType::HEARTBEAT:
         case MessageType::CLOSE:
+        case MessageType::SWITCH_PROTOCOL:
             // No additional data needed
             break;
         default:
@@ -399,12 +407,38 @@ MessageType SimpleProtocolHandler::ParseMessageType(const std::string& command)
         return MessageType::CLOSE;
     } else if (command == CMD_PING) {
         return MessageType::HEARTBEAT;
+    } else if (command == CMD_BINARY) {
+        return MessageType::SWITCH_PROTOCOL;
     } else {
         // 默认当作查询处理
         return MessageType::QUERY;
     }
 }
 
+/**
+ * 把PARSE/BIND的参数换成对应的SQL
+ * PARSE <name> <sql> 换成 PREPARE <name> AS <sql>，
+ * BIND <name> [v1, v2 ...] 换成 EXECUTE <name> (v1, v2 ...)
+ */
+std::string SimpleProtocolHandler::BuildPreparedStatementQuery(
+    const std::string& command, const std::string& arguments) const {
+    std::istringstream iss(arguments);
+    std::string name;
+    iss >> name;
+    std::string rest;
+    std::getline(iss, rest);
+    size_t start = rest.find_first_not_of(" \t");
+    rest = start == std::string::npos ? "" : rest.substr(start);
+
+    if (command == CMD_PARSE) {
+        return "PREPARE " + name + " AS " + rest;
+    }
+    if (rest.empty()) {
+        return "EXECUTE " + name;
+    }
+    return "EXECUTE " + name + " (" + rest + ")";
+}
+
 bool SimpleProtocolHandler::HandleCommand(Connection* connection, const Message& message) {
     if (!connection || message.content.empty()) {
         return false;
@@ -508,12 +542,15 @@ bool SimpleProtocolHandler::ProcessHelpCommand(Connection* connection) {
     ss << RESP_OK << " Available Commands:\n";
     ss << "AUTH <username> <password> - Authenticate to the server\n";
     ss << "QUERY <sql_statement> - Execute SQL query\n";
+    ss << "PARSE <name> <sql_statement> - Prepare a statement with $1, $2 ...\n";
+    ss << "BIND <name> [value, ...] - Execute a prepared statement\n";
     ss << "CMD <command> [args] - Execute server command\n";
     ss << "  SHOW TABLES - List all tables\n";
     ss << "  DESCRIBE <table> - Show table structure\n";
     ss << "  STATUS - Show connection status\n";
     ss << "  HELP - Show this help message\n";
     ss << "PING - Test connection\n";
+    ss << "BINARY - Switch this connection to the binary protocol\n";
     ss << "CLOSE - Close connection\n";
     
     connection->SendData(ss.str());
@@ -12,7 +12,17 @@ namespace SimpleRDBMS {
  * - Commands are line-based, terminated by '\n'
  * - Authentication: AUTH <username> <password>
  * - Query: QUERY <sql_statement>
+ * - Prepare: PARSE <name> <sql_statement>, the statement may use $1, $2 ...
+ * - Execute prepared: BIND <name> [value, ...], only the values are sent
+ * - Deallocate prepared: QUERY DEALLOCATE <name>
+ * - Session variables: QUERY SET statement_timeout = <ms>,
+ *   QUERY SET work_mem = <bytes> (or a number with kB, MB, GB)
+ * - Cancel another session's statement: QUERY KILL '<session_id>', the
+ *   running statements and their session ids are listed at GET /queries
+ *   on the metrics port
  * - Command: CMD <command>
+ * - Switch to the binary protocol: BINARY, answered with "OK BINARY";
+ *   see binary_protocol.h for the frames that follow
  * - Close: CLOSE
  * 
  * Response format:
@@ -65,6 +75,9 @@ private:
     static constexpr const char* CMD_COMMAND = "CMD";
     static constexpr const char* CMD_CLOSE = "CLOSE";
     static constexpr const char* CMD_PING = "PING";
+    static constexpr const char* CMD_PARSE = "PARSE";
+    static constexpr const char* CMD_BIND = "BIND";
+    static constexpr const char* CMD_BINARY = "BINARY";
     
     static constexpr const char* RESP_OK = "OK";
     static constexpr const char* RESP_ERROR = "ERROR";
@@ -79,6 +92,8 @@ private:
     std::string FormatValue(const Value& value) const;
     MessageType ParseMessageType(const std::string& command) const;
     bool HandlePing(Connection* connection);
+    std::string BuildPreparedStatementQuery(const std::string& command,
+                                            const std::string& arguments) const;
     
     // Command handlers
     bool ProcessShowTablesCommand(Connection* connection);
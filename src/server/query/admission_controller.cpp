@@ -0,0 +1,66 @@
+#include "admission_controller.h"
+
+namespace SimpleRDBMS {
+
+AdmissionController::AdmissionController(size_t max_running, size_t max_waiting,
+                                         std::chrono::milliseconds wait_timeout)
+    : max_running_(max_running == 0 ? 1 : max_running),
+      max_waiting_(max_waiting),
+      wait_timeout_(wait_timeout) {}
+
+/**
+ * 申请执行名额
+ * 实现思路：
+ * 1. 没人排队而且有空名额时直接放行
+ * 2. 否则排到队尾，队列已满时拒绝
+ * 3. 等到自己是队头并且有空名额；超时就从队列里删掉自己并拒绝，
+ *    同时唤醒其他人，因为队头可能变了
+ */
+bool AdmissionController::Admit() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (queue_.empty() && running_ < max_running_) {
+        running_++;
+        admitted_++;
+        return true;
+    }
+    if (queue_.size() >= max_waiting_) {
+        rejected_++;
+        return false;
+    }
+
+    auto self = queue_.insert(queue_.end(), next_ticket_++);
+    bool admitted = cv_.wait_for(lock, wait_timeout_, [this, self]() {
+        return queue_.begin() == self && running_ < max_running_;
+    });
+    queue_.erase(self);
+    if (!admitted) {
+        rejected_++;
+        cv_.notify_all();
+        return false;
+    }
+    running_++;
+    admitted_++;
+    // 名额可能不止一个，下一个队头也许能接着进
+    cv_.notify_all();
+    return true;
+}
+
+void AdmissionController::Release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_ > 0) {
+        running_--;
+    }
+    cv_.notify_all();
+}
+
+AdmissionStats AdmissionController::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AdmissionStats stats;
+    stats.running_heavy = running_;
+    stats.waiting_heavy = queue_.size();
+    stats.admitted_heavy = admitted_;
+    stats.rejected_heavy = rejected_;
+    return stats;
+}
+
+} // namespace SimpleRDBMS
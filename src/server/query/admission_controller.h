@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <mutex>
+
+namespace SimpleRDBMS {
+
+// 查询按代价分两类：短的OLTP语句直接执行，长的分析查询要先拿到执行名额
+enum class WorkloadClass {
+    SHORT = 0,
+    HEAVY
+};
+
+struct AdmissionStats {
+    size_t running_heavy;
+    size_t waiting_heavy;
+    size_t admitted_heavy;
+    size_t rejected_heavy;
+};
+
+/**
+ * AdmissionController - caps how many heavy queries run at once
+ *
+ * 设计思路：
+ * - 同时执行的重查询不超过max_running个，其余的排队等待名额，
+ *   按到达顺序放行，不会有查询一直抢不到
+ * - 排队的重查询超过max_waiting个，或者等待超过wait_timeout时直接拒绝，
+ *   排队的查询占着查询线程，不能无限排下去
+ * - 短查询不经过这里，不受重查询的影响
+ */
+class AdmissionController {
+public:
+    AdmissionController(size_t max_running, size_t max_waiting,
+                        std::chrono::milliseconds wait_timeout);
+
+    // 拿到执行名额返回true，必须配对调用Release
+    bool Admit();
+    void Release();
+
+    AdmissionStats GetStats() const;
+
+    // 拿到名额期间持有，析构时归还
+    class Ticket {
+    public:
+        Ticket() = default;
+        explicit Ticket(AdmissionController* controller) : controller_(controller) {}
+        Ticket(Ticket&& other) noexcept : controller_(other.controller_) {
+            other.controller_ = nullptr;
+        }
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+        ~Ticket() {
+            if (controller_) {
+                controller_->Release();
+            }
+        }
+
+    private:
+        AdmissionController* controller_ = nullptr;
+    };
+
+private:
+    size_t max_running_;
+    size_t max_waiting_;
+    std::chrono::milliseconds wait_timeout_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t running_ = 0;
+    // 排队的查询按到达顺序排列，只有队头能拿名额；等待超时的从中间删掉
+    std::list<size_t> queue_;
+    size_t next_ticket_ = 0;
+    size_t admitted_ = 0;
+    size_t rejected_ = 0;
+};
+
+} // namespace SimpleRDBMS
@@ -1,7 +1,11 @@
 #include "query_processor.h"
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <random>
 #include <sstream>
 
 #include "query_context.h"
@@ -9,12 +13,78 @@
 
 // Include necessary headers for database components
 #include "catalog/catalog.h"
+#include "common/arena.h"
 #include "execution/execution_engine.h"
 #include "parser/parser.h"
+#include "record/table_heap.h"
 #include "transaction/transaction_manager.h"
 
 namespace SimpleRDBMS {
 
+namespace {
+
+// Parses a statement_timeout value: milliseconds, or a number followed by
+// ms, s or min. 0 disables the timeout
+bool ParseStatementTimeout(const std::string& value, int64_t* timeout_ms) {
+    size_t digits = 0;
+    while (digits < value.size() &&
+           std::isdigit(static_cast<unsigned char>(value[digits]))) {
+        digits++;
+    }
+    // 12 digits of minutes still fit in int64 milliseconds
+    if (digits == 0 || digits > 12) {
+        return false;
+    }
+    int64_t amount = std::stoll(value.substr(0, digits));
+    std::string unit = value.substr(digits);
+    std::transform(unit.begin(), unit.end(), unit.begin(), ::tolower);
+    if (unit.empty() || unit == "ms") {
+        *timeout_ms = amount;
+    } else if (unit == "s") {
+        *timeout_ms = amount * 1000;
+    } else if (unit == "min") {
+        *timeout_ms = amount * 60 * 1000;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Parses a work_mem value: bytes, or a number followed by kB, MB or GB.
+// 0 falls back to query.work_mem
+bool ParseMemorySize(const std::string& value, size_t* bytes) {
+    size_t digits = 0;
+    while (digits < value.size() &&
+           std::isdigit(static_cast<unsigned char>(value[digits]))) {
+        digits++;
+    }
+    // 12 digits of gigabytes still fit in size_t bytes
+    if (digits == 0 || digits > 12) {
+        return false;
+    }
+    size_t amount = std::stoull(value.substr(0, digits));
+    std::string unit = value.substr(digits);
+    std::transform(unit.begin(), unit.end(), unit.begin(), ::tolower);
+    if (unit.empty() || unit == "b") {
+        *bytes = amount;
+    } else if (unit == "kb") {
+        *bytes = amount << 10;
+    } else if (unit == "mb") {
+        *bytes = amount << 20;
+    } else if (unit == "gb") {
+        *bytes = amount << 30;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// A cached plan's AST grows roughly with the length of the query text;
+// charge this many bytes per character of the fingerprint
+constexpr size_t kPlanCacheBytesPerQueryChar = 32;
+
+}  // namespace
+
 QueryProcessor::QueryProcessor(const ServerConfig& config)
     : config_(config),
       initialized_(false),
@@ -23,8 +93,13 @@ QueryProcessor::QueryProcessor(const ServerConfig& config)
       catalog_(nullptr),
       query_cache_enabled_(false),
       max_cache_size_(100),
+      result_cache_(std::make_unique<ResultCache>(0)),
+      slow_query_threshold_ms_(0.0),
+      slow_query_sample_percent_(0.0),
+      heavy_query_min_pages_(256),
       query_timeout_(60),
       max_query_length_(1024 * 1024) {
+    result_cache_->SetMemoryTracker(&result_cache_memory_);
     ResetStats();
 }
 
@@ -59,6 +134,27 @@ bool QueryProcessor::Initialize(ExecutionEngine* execution_engine,
     max_query_length_ = config_.GetQueryConfig().max_query_length;
     query_cache_enabled_ = config_.GetQueryConfig().enable_query_cache;
     max_cache_size_ = config_.GetQueryConfig().query_cache_size;
+    result_cache_->SetCapacity(ResultCacheBudget(config_));
+    server_memory_.SetLimit(config_.GetQueryConfig().max_server_memory);
+    const QueryConfig& query_config = config_.GetQueryConfig();
+    admission_controller_ = std::make_unique<AdmissionController>(
+        query_config.max_concurrent_heavy_queries,
+        query_config.max_queued_heavy_queries,
+        query_config.heavy_query_queue_timeout);
+    heavy_query_min_pages_ = query_config.heavy_query_min_pages;
+    if (!query_config.slow_query_log_file.empty()) {
+        // 慢查询日志只是诊断用的，打不开文件也照常启动
+        auto slow_query_log = std::make_unique<SlowQueryLog>();
+        if (slow_query_log->Start(query_config.slow_query_log_file)) {
+            slow_query_log_ = std::move(slow_query_log);
+            slow_query_threshold_ms_ =
+                static_cast<double>(query_config.slow_query_threshold.count());
+            slow_query_sample_percent_ = query_config.slow_query_sample_percent;
+        } else {
+            std::cerr << "QueryProcessor: Cannot open slow query log "
+                      << query_config.slow_query_log_file << std::endl;
+        }
+    }
     initialized_ = true;
     std::cout << "[QueryProcessor] Initialized successfully" << std::endl;
     return true;
@@ -70,7 +166,12 @@ void QueryProcessor::Shutdown() {
     }
 
     ClearQueryCache();
+    result_cache_->Clear();
     // parser_.reset();
+    if (slow_query_log_) {
+        slow_query_log_->Stop();
+        slow_query_log_.reset();
+    }
 
     execution_engine_ = nullptr;
     transaction_manager_ = nullptr;
@@ -101,43 +202,159 @@ QueryResult QueryProcessor::ProcessQuery(Session* session,
     std::cout << "[DEBUG] ProcessQuery: Starting to process query: "
               << query_string << std::endl;
     auto start_time = std::chrono::high_resolution_clock::now();
+    // 慢查询日志要的开销是查询前后线程I/O计数的差；抽中的查询不管快慢都记
+    const ThreadIOCounters io_before = CurrentThreadIOCounters();
+    const bool sampled = ShouldSampleQuery();
     try {
+        // 解析、计划和执行期间的语法树、计划节点、执行器都从查询的内存池分配，
+        // 查询结束时一起释放；要在context之前构造，context里的语句先析构
+        QueryArena::Scope arena_scope;
+        // 执行引擎在执行器析构之前把计划交给它，只有可能进日志的查询才格式化
+        PlanCapture plan_capture(sampled,
+                                 slow_query_log_
+                                     ? slow_query_threshold_ms_
+                                     : std::numeric_limits<double>::infinity());
+        // statement_timeout counts from here, parsing and queueing included;
+        // KILL from another connection finds the token by session id
+        CancellationToken cancellation_token;
+        int64_t statement_timeout_ms = 0;
+        if (ParseStatementTimeout(session->GetVariable("statement_timeout"),
+                                  &statement_timeout_ms)) {
+            cancellation_token.SetTimeout(statement_timeout_ms);
+        }
+        // Executors charge the query tracker, which rolls up into the
+        // session and the server. Spilling operators spill at work_mem or
+        // when a level refuses more memory; anything else fails the
+        // statement once a limit is reached
+        const QueryConfig& query_config = config_.GetQueryConfig();
+        MemoryTracker* session_memory = session->GetMemoryTracker();
+        session_memory->SetParent(&server_memory_);
+        session_memory->SetLimit(query_config.max_session_memory);
+        MemoryTracker query_memory("query", session_memory,
+                                   query_config.max_query_memory);
+        size_t work_mem = 0;
+        if (!ParseMemorySize(session->GetVariable("work_mem"), &work_mem) ||
+            work_mem == 0) {
+            work_mem = query_config.work_mem;
+        }
+        query_memory.SetOperatorBudget(work_mem);
+        MemoryTracker::Scope memory_scope(&query_memory);
+        const std::string session_id = session->GetSessionId();
+        {
+            std::lock_guard<std::mutex> lock(running_queries_mutex_);
+            running_queries_[session_id] =
+                RunningQuery{&cancellation_token, &query_memory, query_string,
+                             std::chrono::steady_clock::now()};
+        }
+        struct RunningQueryGuard {
+            QueryProcessor* processor;
+            const std::string& session_id;
+            ~RunningQueryGuard() {
+                std::lock_guard<std::mutex> lock(
+                    processor->running_queries_mutex_);
+                processor->running_queries_.erase(session_id);
+            }
+        } running_query_guard{this, session_id};
         // Create query context
         auto context = std::make_unique<QueryContext>(session, query_string);
         context->SetState(QueryState::PARSING);
         std::cout << "[DEBUG] ProcessQuery: Created query context" << std::endl;
-        // Parse query - 每次创建新的parser
-        auto parse_start = std::chrono::high_resolution_clock::now();
-        std::unique_ptr<Parser> parser;
-        std::unique_ptr<Statement> statement;
-        try {
-            std::cout << "[DEBUG] ProcessQuery: Creating parser for query: "
-                      << query_string << std::endl;
-            parser = std::make_unique<Parser>(query_string);
-            std::cout << "[DEBUG] ProcessQuery: Parser created, starting parse"
+        // 只差在常量上的查询共享一个参数化的计划：命中时跳过解析，
+        // 查询里的字面量作为参数绑定
+        std::vector<Value> literals;
+        std::shared_ptr<QueryPlan> cached_plan =
+            LookupParameterizedPlan(query_string, &literals);
+        if (cached_plan) {
+            std::cout << "[DEBUG] ProcessQuery: Using cached parameterized "
+                         "plan"
                       << std::endl;
-            statement = parser->Parse();
-            std::cout << "[DEBUG] ProcessQuery: Parse completed" << std::endl;
-        } catch (const std::exception& e) {
-            std::cout << "[ERROR] ProcessQuery: Parse error: " << e.what()
-                      << std::endl;
-            return CreateErrorResult("Parse error: " + std::string(e.what()));
-        }
-        auto parse_end = std::chrono::high_resolution_clock::now();
-        if (!statement) {
-            std::cout << "[ERROR] ProcessQuery: Statement is null after parsing"
-                      << std::endl;
-            return CreateErrorResult(
-                "Failed to parse query - statement is null");
+        } else {
+            // Parse query - 每次创建新的parser
+            auto parse_start = std::chrono::high_resolution_clock::now();
+            std::unique_ptr<Parser> parser;
+            std::unique_ptr<Statement> statement;
+            try {
+                std::cout << "[DEBUG] ProcessQuery: Creating parser for query: "
+                          << query_string << std::endl;
+                parser = std::make_unique<Parser>(query_string);
+                std::cout << "[DEBUG] ProcessQuery: Parser created, starting parse"
+                          << std::endl;
+                statement = parser->Parse();
+                std::cout << "[DEBUG] ProcessQuery: Parse completed" << std::endl;
+            } catch (const std::exception& e) {
+                std::cout << "[ERROR] ProcessQuery: Parse error: " << e.what()
+                          << std::endl;
+                return CreateErrorResult("Parse error: " + std::string(e.what()));
+            }
+            auto parse_end = std::chrono::high_resolution_clock::now();
+            if (!statement) {
+                std::cout << "[ERROR] ProcessQuery: Statement is null after parsing"
+                          << std::endl;
+                return CreateErrorResult(
+                    "Failed to parse query - statement is null");
+            }
+            context->GetMetrics().parse_time =
+                std::chrono::duration_cast<std::chrono::milliseconds>(parse_end -
+                                                                      parse_start);
+            context->SetStatement(std::move(statement));
         }
-        context->GetMetrics().parse_time =
-            std::chrono::duration_cast<std::chrono::milliseconds>(parse_end -
-                                                                  parse_start);
-        context->SetStatement(std::move(statement));
         context->SetState(QueryState::PLANNING);
         std::cout << "[DEBUG] ProcessQuery: Determining query type"
                   << std::endl;
 
+        // 对于SHOW TABLES等系统查询，使用简化的事务处理
+        QueryType query_type = cached_plan
+                                   ? cached_plan->type
+                                   : DetermineQueryType(context->GetStatement());
+
+        // 重查询先拿执行名额，拿不到就拒绝，不让它占满查询线程
+        const Statement* classified_statement =
+            !cached_plan ? context->GetStatement()
+            : cached_plan->prepared ? cached_plan->prepared->GetStatement()
+                                    : cached_plan->statement.get();
+
+        // 自动提交的SELECT先查结果缓存，命中时不用排队也不开事务。
+        // 表的修改计数要在开事务拿快照之前读
+        std::string result_key;
+        ResultCache::TableVersions result_versions;
+        uint64_t result_schema_version = catalog_->GetSchemaVersion();
+        bool cache_result =
+            query_type == QueryType::SELECT &&
+            !session->GetCurrentTransaction() &&
+            PrepareResultCacheKey(
+                query_string,
+                static_cast<const SelectStatement*>(classified_statement),
+                &result_key, &result_versions);
+        std::vector<Tuple> cached_rows;
+        if (cache_result &&
+            result_cache_->Lookup(result_key, catalog_, &cached_rows)) {
+            QueryResult result = CreateSuccessResult(cached_rows);
+            context->SetState(QueryState::COMPLETED);
+            auto end_time = std::chrono::high_resolution_clock::now();
+            result.execution_time =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    end_time - start_time);
+            double duration_ms = std::chrono::duration<double, std::milli>(
+                                     end_time - start_time)
+                                     .count();
+            query_latency_.Record(duration_ms / 1000.0);
+            UpdateQueryStats(query_type, result.execution_time, true);
+            LogSlowQuery(session, query_string, duration_ms, result,
+                         io_before, nullptr, sampled);
+            return result;
+        }
+
+        bool heavy = ClassifyQuery(query_type, classified_statement) ==
+                     WorkloadClass::HEAVY;
+        session->SetHeavyWorkload(heavy);
+        if (heavy && !admission_controller_->Admit()) {
+            UpdateQueryStats(query_type, std::chrono::milliseconds(0), false);
+            return CreateErrorResult(
+                "Server busy: too many concurrent analytical queries");
+        }
+        AdmissionController::Ticket admission_ticket(
+            heavy ? admission_controller_.get() : nullptr);
+
         // 事务处理 - 确保session有活跃的事务
         auto current_transaction = session->GetCurrentTransaction();
         bool auto_commit = false;  // 标记是否需要自动提交
@@ -146,12 +363,21 @@ QueryResult QueryProcessor::ProcessQuery(Session* session,
             std::cout << "[DEBUG] ProcessQuery: Using existing transaction "
                       << current_transaction->GetTxnId() << std::endl;
             context->SetTransaction(current_transaction);
+        } else if (query_type == QueryType::BEGIN_TRANSACTION ||
+                   query_type == QueryType::COMMIT_TRANSACTION ||
+                   query_type == QueryType::ROLLBACK_TRANSACTION) {
+            // 事务控制语句自己开始或结束session的事务，不套自动事务，
+            // 否则BEGIN [READ ONLY]会因为已经有事务而失败
+        } else if (query_type == QueryType::SET_VARIABLE ||
+                   query_type == QueryType::KILL) {
+            // Session commands touch no data
         } else {
             std::cout << "[DEBUG] ProcessQuery: No active transaction, "
                          "starting new transaction"
                       << std::endl;
             // 使用session的BeginTransaction方法，这样事务会正确设置到session中
-            if (!session->BeginTransaction()) {
+            // 自动提交的SELECT走只读事务，不写日志、不加锁
+            if (!session->BeginTransaction(query_type == QueryType::SELECT)) {
                 std::cout << "[ERROR] ProcessQuery: Failed to begin transaction"
                           << std::endl;
                 return CreateErrorResult("Failed to begin transaction");
@@ -168,14 +394,34 @@ QueryResult QueryProcessor::ProcessQuery(Session* session,
             std::cout << "[DEBUG] ProcessQuery: Auto transaction created: "
                       << current_transaction->GetTxnId() << std::endl;
         }
-        // 对于SHOW TABLES等系统查询，使用简化的事务处理
-        QueryType query_type = DetermineQueryType(context->GetStatement());
-        
         // Execute query
         context->SetState(QueryState::EXECUTING);
         std::cout << "[DEBUG] ProcessQuery: Starting statement execution"
                   << std::endl;
-        QueryResult result = ProcessStatement(session, context->GetStatement());
+        // 流式发送的行也要留一份放进结果缓存
+        ResultSink* result_sink = session->GetResultSink();
+        std::unique_ptr<ResultCaptureSink> capture;
+        if (cache_result && result_sink) {
+            capture = std::make_unique<ResultCaptureSink>(
+                result_sink, result_cache_->GetMaxEntryBytes());
+            session->SetResultSink(capture.get());
+        }
+        QueryResult result =
+            cached_plan ? ExecuteCachedQuery(session, *cached_plan, literals)
+                        : ProcessStatement(session, context->GetStatement());
+        if (capture) {
+            session->SetResultSink(result_sink);
+        }
+        // Executors report a cancelled statement like any other failure
+        CancelReason cancel_reason = cancellation_token.GetReason();
+        if (!result.success && cancel_reason != CancelReason::NONE) {
+            result.error_message =
+                CancellationToken::DescribeReason(cancel_reason);
+        } else if (!result.success &&
+                   !query_memory.GetLimitError().empty()) {
+            result.error_message =
+                "Out of memory: " + query_memory.GetLimitError();
+        }
         std::cout
             << "[DEBUG] ProcessQuery: Statement execution completed, success: "
             << result.success << std::endl;
@@ -185,7 +431,7 @@ QueryResult QueryProcessor::ProcessQuery(Session* session,
             if (result.success) {
                 std::cout << "[DEBUG] ProcessQuery: Auto-committing transaction"
                           << std::endl;
-                if (!session->CommitTransaction()) {
+                if (!CommitSessionTransaction(session)) {
                     std::cout << "[ERROR] ProcessQuery: Failed to auto-commit "
                                  "transaction"
                               << std::endl;
@@ -199,6 +445,21 @@ QueryResult QueryProcessor::ProcessQuery(Session* session,
                 session->RollbackTransaction();
             }
         }
+        if (cache_result && auto_commit && result.success) {
+            std::vector<Tuple> rows;
+            if (capture) {
+                capture->Capture(result.result_set);
+                cache_result = capture->IsComplete();
+                rows = capture->TakeRows();
+            } else {
+                rows = result.result_set;
+            }
+            if (cache_result) {
+                result_cache_->Insert(result_key, result_schema_version,
+                                      std::move(result_versions),
+                                      std::move(rows));
+            }
+        }
 
         if (!result.success) {
             std::cout << "[ERROR] ProcessQuery: Execution failed with error: "
@@ -217,7 +478,13 @@ QueryResult QueryProcessor::ProcessQuery(Session* session,
         result.execution_time =
             std::chrono::duration_cast<std::chrono::milliseconds>(end_time -
                                                                   start_time);
+        double duration_ms =
+            std::chrono::duration<double, std::milli>(end_time - start_time)
+                .count();
+        query_latency_.Record(duration_ms / 1000.0);
         UpdateQueryStats(query_type, result.execution_time, result.success);
+        LogSlowQuery(session, query_string, duration_ms, result, io_before,
+                     &plan_capture, sampled);
         std::cout << "[DEBUG] ProcessQuery: Query processing completed"
                   << std::endl;
         return result;
@@ -228,9 +495,16 @@ QueryResult QueryProcessor::ProcessQuery(Session* session,
         auto execution_time =
             std::chrono::duration_cast<std::chrono::milliseconds>(end_time -
                                                                   start_time);
+        double duration_ms =
+            std::chrono::duration<double, std::milli>(end_time - start_time)
+                .count();
+        query_latency_.Record(duration_ms / 1000.0);
         UpdateQueryStats(QueryType::UNKNOWN, execution_time, false);
-        return CreateErrorResult("Query processing failed: " +
-                                 std::string(e.what()));
+        QueryResult result = CreateErrorResult("Query processing failed: " +
+                                               std::string(e.what()));
+        LogSlowQuery(session, query_string, duration_ms, result, io_before,
+                     nullptr, sampled);
+        return result;
     }
 }
 
@@ -276,9 +550,20 @@ QueryResult QueryProcessor::ProcessStatement(Session* session,
             case QueryType::DROP_TABLE:
             case QueryType::CREATE_INDEX:
             case QueryType::DROP_INDEX:
+            case QueryType::ANALYZE:
+            case QueryType::VACUUM:
+            case QueryType::COPY:
                 std::cout << "[DEBUG] ProcessStatement: Executing DDL"
                           << std::endl;
                 return ExecuteDDLStatement(session, statement);
+            case QueryType::PREPARE:
+            case QueryType::EXECUTE:
+            case QueryType::DEALLOCATE:
+                // 预编译语句由执行引擎按名字保存，EXECUTE的结果集原样返回
+                std::cout << "[DEBUG] ProcessStatement: Executing prepared "
+                             "statement command"
+                          << std::endl;
+                return ExecuteDDLStatement(session, statement);
             case QueryType::BEGIN_TRANSACTION:
             case QueryType::COMMIT_TRANSACTION:
             case QueryType::ROLLBACK_TRANSACTION:
@@ -295,6 +580,12 @@ QueryResult QueryProcessor::ProcessStatement(Session* session,
                           << std::endl;
                 return ExecuteExplainStatement(
                     session, static_cast<ExplainStatement*>(statement));
+            case QueryType::SET_VARIABLE:
+                return ExecuteSetStatement(
+                    session, static_cast<SetStatement*>(statement));
+            case QueryType::KILL:
+                return ExecuteKillStatement(
+                    session, static_cast<KillStatement*>(statement));
             default:
                 std::cout
                     << "[ERROR] ProcessStatement: Unsupported query type: "
@@ -311,6 +602,7 @@ QueryResult QueryProcessor::ProcessStatement(Session* session,
 
 std::unique_ptr<QueryPlan> QueryProcessor::CreateQueryPlan(
     const std::string& query_string) {
+    QueryArena::Suspend heap_allocation;
     auto plan = std::make_unique<QueryPlan>();
     plan->parse_time = std::chrono::system_clock::now();
     try {
@@ -356,10 +648,14 @@ bool QueryProcessor::ValidateQuery(const std::string& query_string,
 
 void QueryProcessor::ClearQueryCache() {
     std::lock_guard<std::mutex> lock(cache_mutex_);
+    for (const auto& entry : cache_lru_) {
+        plan_cache_memory_.Release(entry.second->memory_bytes);
+    }
     query_cache_.clear();
+    cache_lru_.clear();
 }
 
-QueryStats QueryProcessor::GetStats() const {
+QueryProcessorStats QueryProcessor::GetStats() const {
     std::lock_guard<std::mutex> lock(stats_mutex_);
     auto stats = stats_;
 
@@ -373,8 +669,9 @@ QueryStats QueryProcessor::GetStats() const {
 
 void QueryProcessor::ResetStats() {
     std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_ = QueryStats{};
+    stats_ = QueryProcessorStats{};
     stats_.min_execution_time = std::chrono::milliseconds::max();
+    query_latency_.Reset();
 }
 
 void QueryProcessor::UpdateConfig(const ServerConfig& config) {
@@ -391,6 +688,8 @@ void QueryProcessor::UpdateConfig(const ServerConfig& config) {
     }
 
     max_cache_size_ = config.GetQueryConfig().query_cache_size;
+    result_cache_->SetCapacity(ResultCacheBudget(config));
+    server_memory_.SetLimit(config.GetQueryConfig().max_server_memory);
 }
 
 QueryType QueryProcessor::DetermineQueryType(const Statement* statement) const {
@@ -423,30 +722,186 @@ QueryType QueryProcessor::DetermineQueryType(const Statement* statement) const {
             return QueryType::ROLLBACK_TRANSACTION;
         case Statement::StmtType::EXPLAIN:
             return QueryType::EXPLAIN;
+        case Statement::StmtType::ANALYZE:
+            return QueryType::ANALYZE;
+        case Statement::StmtType::VACUUM:
+            return QueryType::VACUUM;
+        case Statement::StmtType::COPY:
+            return QueryType::COPY;
+        case Statement::StmtType::PREPARE:
+            return QueryType::PREPARE;
+        case Statement::StmtType::EXECUTE:
+            return QueryType::EXECUTE;
+        case Statement::StmtType::DEALLOCATE:
+            return QueryType::DEALLOCATE;
+        case Statement::StmtType::SET_VARIABLE:
+            return QueryType::SET_VARIABLE;
+        case Statement::StmtType::KILL:
+            return QueryType::KILL;
         default:
             return QueryType::UNKNOWN;
     }
 }
 
-std::string QueryProcessor::NormalizeQuery(const std::string& query) const {
-    // Simple normalization - remove extra whitespace and convert to uppercase
-    std::string normalized;
-    normalized.reserve(query.length());
-
-    bool in_whitespace = false;
-    for (char c : query) {
-        if (std::isspace(c)) {
-            if (!in_whitespace) {
-                normalized += ' ';
-                in_whitespace = true;
+/**
+ * 判断查询是短查询还是重查询
+ * 实现思路：
+ * 1. SELECT在有JOIN、GROUP BY、聚合、ORDER BY，或者既没有WHERE也没有LIMIT时
+ *    要读完整张表；ANALYZE和CREATE INDEX也要扫全表，没有指定表的ANALYZE
+ *    会扫所有表
+ * 2. 要扫全表并且涉及的表不小于heavy_query_min_pages_页才算重查询，
+ *    小表上的这些操作很快，不用排队
+ */
+WorkloadClass QueryProcessor::ClassifyQuery(QueryType type,
+                                            const Statement* statement) {
+    if (!statement) {
+        return WorkloadClass::SHORT;
+    }
+    std::vector<std::string> tables;
+    switch (type) {
+        case QueryType::SELECT: {
+            auto* select = static_cast<const SelectStatement*>(statement);
+            bool aggregate = false;
+            for (const auto& expr : select->GetSelectList()) {
+                if (expr && expr->GetType() ==
+                                Expression::ExprType::FUNCTION_CALL) {
+                    aggregate = true;
+                }
             }
-        } else {
-            normalized += std::toupper(c);
-            in_whitespace = false;
+            bool full_scan = select->HasJoin() ||
+                             !select->GetGroupBy().empty() || aggregate ||
+                             !select->GetOrderBy().empty() ||
+                             (!select->GetWhereClause() && !select->HasLimit());
+            if (!full_scan) {
+                return WorkloadClass::SHORT;
+            }
+            tables.push_back(select->GetTableName());
+            if (select->HasJoin()) {
+                tables.push_back(select->GetJoinTableName());
+            }
+            break;
         }
+        case QueryType::ANALYZE: {
+            auto* analyze = static_cast<const AnalyzeStatement*>(statement);
+            if (analyze->GetTableName().empty()) {
+                return WorkloadClass::HEAVY;
+            }
+            tables.push_back(analyze->GetTableName());
+            break;
+        }
+        case QueryType::VACUUM: {
+            auto* vacuum = static_cast<const VacuumStatement*>(statement);
+            if (vacuum->GetTableName().empty()) {
+                return WorkloadClass::HEAVY;
+            }
+            tables.push_back(vacuum->GetTableName());
+            break;
+        }
+        case QueryType::COPY: {
+            // 导入的文件多大事先不知道，一律按重查询处理
+            auto* copy = static_cast<const CopyStatement*>(statement);
+            if (copy->IsFrom()) {
+                return WorkloadClass::HEAVY;
+            }
+            tables.push_back(copy->GetTableName());
+            break;
+        }
+        case QueryType::CREATE_INDEX:
+            tables.push_back(
+                static_cast<const CreateIndexStatement*>(statement)
+                    ->GetTableName());
+            break;
+        default:
+            return WorkloadClass::SHORT;
+    }
+
+    size_t pages = 0;
+    for (const auto& table : tables) {
+        pages += GetTablePageCount(table);
     }
+    return pages >= heavy_query_min_pages_ ? WorkloadClass::HEAVY
+                                           : WorkloadClass::SHORT;
+}
+
+size_t QueryProcessor::GetTablePageCount(const std::string& table_name) {
+    TableInfo* table_info = catalog_ ? catalog_->GetTable(table_name) : nullptr;
+    if (!table_info || !table_info->table_heap) {
+        return 0;
+    }
+    return table_info->table_heap->GetPageCount();
+}
 
-    return normalized;
+AdmissionStats QueryProcessor::GetAdmissionStats() const {
+    if (!admission_controller_) {
+        return AdmissionStats{};
+    }
+    return admission_controller_->GetStats();
+}
+
+SlowQueryLogStats QueryProcessor::GetSlowQueryLogStats() const {
+    if (!slow_query_log_) {
+        return SlowQueryLogStats{};
+    }
+    return slow_query_log_->GetStats();
+}
+
+ResultCacheStats QueryProcessor::GetResultCacheStats() const {
+    return result_cache_->GetStats();
+}
+
+bool QueryProcessor::ShouldSampleQuery() const {
+    if (!slow_query_log_ || slow_query_sample_percent_ <= 0.0) {
+        return false;
+    }
+    thread_local std::mt19937_64 rng{std::random_device{}()};
+    std::uniform_real_distribution<double> percent(0.0, 100.0);
+    return percent(rng) < slow_query_sample_percent_;
+}
+
+void QueryProcessor::LogSlowQuery(Session* session, const std::string& query,
+                                  double duration_ms,
+                                  const QueryResult& result,
+                                  const ThreadIOCounters& io_before,
+                                  const PlanCapture* capture, bool sampled) {
+    if (!slow_query_log_) {
+        return;
+    }
+    bool slow = duration_ms >= slow_query_threshold_ms_;
+    if (!slow && !sampled) {
+        return;
+    }
+    // 只算查询线程上的开销，并行扫描工作线程的读盘不在里面
+    const ThreadIOCounters& io_after = CurrentThreadIOCounters();
+    SlowQueryEntry entry;
+    entry.time = std::chrono::system_clock::now();
+    entry.session_id = session->GetSessionId();
+    entry.query = query;
+    entry.duration_ms = duration_ms;
+    entry.success = result.success;
+    entry.sampled = !slow;
+    // 结果分块发给客户端时result_set里只剩最后一块，以执行引擎数的为准
+    entry.rows_returned = result.result_set.size();
+    if (capture && capture->GetRowsReturned() > entry.rows_returned) {
+        entry.rows_returned = capture->GetRowsReturned();
+    }
+    entry.rows_affected = result.affected_rows;
+    entry.io.buffer_hits = io_after.buffer_hits - io_before.buffer_hits;
+    entry.io.buffer_misses = io_after.buffer_misses - io_before.buffer_misses;
+    entry.io.disk_reads = io_after.disk_reads - io_before.disk_reads;
+    entry.io.lock_waits = io_after.lock_waits - io_before.lock_waits;
+    entry.io.lock_wait_ms = io_after.lock_wait_ms - io_before.lock_wait_ms;
+    entry.io.rows_examined = io_after.rows_examined - io_before.rows_examined;
+    if (capture) {
+        entry.plan = capture->GetPlanText();
+    }
+    slow_query_log_->Submit(std::move(entry));
+}
+
+std::string QueryProcessor::NormalizeQuery(
+    const std::string& query, std::vector<Value>* literals) const {
+    // Literals become $1, $2 ... so queries differing only in constants
+    // normalize to the same text
+    return Lexer::Fingerprint(query, literals);
 }
 
 bool QueryProcessor::IsQueryCacheable(QueryType type) const {
@@ -473,7 +928,9 @@ QueryResult QueryProcessor::ExecuteSelectStatement(Session* session,
               << std::endl;
 
     try {
-        bool success = execution_engine_->Execute(stmt, &result_set, txn);
+        // 协议层设置了结果接收器时结果边执行边发出去，result_set里不留行
+        bool success = execution_engine_->Execute(stmt, &result_set, txn,
+                                                  session->GetResultSink());
         std::cout
             << "[DEBUG] ExecuteSelectStatement: Execution engine returned: "
             << success << std::endl;
@@ -677,13 +1134,14 @@ QueryResult QueryProcessor::ExecuteTransactionStatement(Session* session,
 
     switch (type) {
         case QueryType::BEGIN_TRANSACTION:
-            if (session->BeginTransaction()) {
+            if (session->BeginTransaction(
+                    static_cast<BeginStatement*>(stmt)->IsReadOnly())) {
                 return CreateSuccessResult({});
             } else {
                 return CreateErrorResult("Failed to begin transaction");
             }
         case QueryType::COMMIT_TRANSACTION:
-            if (session->CommitTransaction()) {
+            if (CommitSessionTransaction(session)) {
                 return CreateSuccessResult({});
             } else {
                 return CreateErrorResult("Failed to commit transaction");
@@ -783,22 +1241,98 @@ QueryResult QueryProcessor::ExecuteShowTablesStatement(Session* session) {
 
 QueryResult QueryProcessor::ExecuteExplainStatement(Session* session,
                                                     ExplainStatement* stmt) {
+    if (!execution_engine_) {
+        return CreateErrorResult("Execution engine not initialized");
+    }
+
+    // The engine formats the plan; EXPLAIN ANALYZE runs the statement in
+    // the session's transaction
     std::vector<Tuple> result_set;
+    try {
+        Transaction* txn = session ? session->GetCurrentTransaction() : nullptr;
+        if (!execution_engine_->Execute(stmt, &result_set, txn)) {
+            return CreateErrorResult("EXPLAIN execution failed");
+        }
+    } catch (const std::exception& e) {
+        return CreateErrorResult("EXPLAIN execution error: " +
+                                 std::string(e.what()));
+    }
+    return CreateSuccessResult(result_set);
+}
 
-    // Create a simple execution plan explanation
-    std::vector<Value> plan_step;
-    plan_step.push_back(std::string("Sequential Scan"));
-    result_set.emplace_back(plan_step, nullptr);
+QueryResult QueryProcessor::ExecuteSetStatement(Session* session,
+                                                SetStatement* stmt) {
+    const std::string& name = stmt->GetName();
+    if (!session->HasVariable(name)) {
+        return CreateErrorResult("Unknown session variable: " + name);
+    }
+    std::string value = stmt->GetValue();
+    if (name == "statement_timeout") {
+        int64_t timeout_ms;
+        if (!ParseStatementTimeout(value, &timeout_ms)) {
+            return CreateErrorResult(
+                "Invalid value for statement_timeout: " + value +
+                " (expected milliseconds, or a number followed by ms, s or "
+                "min)");
+        }
+        value = std::to_string(timeout_ms);
+    } else if (name == "work_mem") {
+        size_t bytes;
+        if (!ParseMemorySize(value, &bytes)) {
+            return CreateErrorResult(
+                "Invalid value for work_mem: " + value +
+                " (expected bytes, or a number followed by kB, MB or GB)");
+        }
+        value = std::to_string(bytes);
+    }
+    session->SetVariable(name, value);
+    return CreateSuccessResult({});
+}
 
-    plan_step.clear();
-    plan_step.push_back(std::string("  -> Filter"));
-    result_set.emplace_back(plan_step, nullptr);
+QueryResult QueryProcessor::ExecuteKillStatement(Session* session,
+                                                 KillStatement* stmt) {
+    const std::string& target = stmt->GetSessionId();
+    if (target == session->GetSessionId()) {
+        return CreateErrorResult("KILL cannot cancel the current session");
+    }
+    if (!CancelQuery(target)) {
+        return CreateErrorResult("No running query in session " + target);
+    }
+    return CreateSuccessResult({});
+}
 
-    plan_step.clear();
-    plan_step.push_back(std::string("  -> Project"));
-    result_set.emplace_back(plan_step, nullptr);
+bool QueryProcessor::CancelQuery(const std::string& session_id) {
+    std::lock_guard<std::mutex> lock(running_queries_mutex_);
+    auto it = running_queries_.find(session_id);
+    if (it == running_queries_.end()) {
+        return false;
+    }
+    it->second.token->Cancel(CancelReason::USER_REQUEST);
+    return true;
+}
 
-    return CreateSuccessResult(result_set);
+std::vector<RunningQueryInfo> QueryProcessor::GetRunningQueries() const {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<RunningQueryInfo> queries;
+    std::lock_guard<std::mutex> lock(running_queries_mutex_);
+    for (const auto& [session_id, running] : running_queries_) {
+        queries.push_back(RunningQueryInfo{
+            session_id, running.query,
+            std::chrono::duration<double, std::milli>(now - running.start)
+                .count(),
+            running.memory->GetUsage()});
+    }
+    return queries;
+}
+
+MemoryUsageStats QueryProcessor::GetMemoryUsageStats() const {
+    MemoryUsageStats stats;
+    stats.server_bytes = server_memory_.GetUsage();
+    stats.server_peak_bytes = server_memory_.GetPeak();
+    stats.server_limit_bytes = server_memory_.GetLimit();
+    stats.plan_cache_bytes = plan_cache_memory_.GetUsage();
+    stats.result_cache_bytes = result_cache_memory_.GetUsage();
+    return stats;
 }
 
 QueryResult QueryProcessor::CreateErrorResult(
@@ -847,43 +1381,210 @@ void QueryProcessor::UpdateQueryStats(QueryType type,
     stats_.query_type_counts[type]++;
 }
 
-void QueryProcessor::AddToCache(const std::string& query,
-                                std::unique_ptr<QueryPlan> plan) {
-    if (!query_cache_enabled_) return;
+void QueryProcessor::AddToCache(const std::string& key,
+                                std::shared_ptr<QueryPlan> plan) {
+    if (!query_cache_enabled_ || max_cache_size_ == 0) return;
 
     std::lock_guard<std::mutex> lock(cache_mutex_);
 
-    std::string normalized = NormalizeQuery(query);
+    auto it = query_cache_.find(key);
+    if (it != query_cache_.end()) {
+        // Another session built the same plan concurrently; keep theirs
+        cache_lru_.splice(cache_lru_.begin(), cache_lru_, it->second);
+        return;
+    }
 
-    // Check if cache is full
-    if (query_cache_.size() >= max_cache_size_) {
+    while (query_cache_.size() >= max_cache_size_) {
         EvictLRUCacheEntry();
     }
+    // Caching is optional: skip it when the server is out of memory
+    if (!plan_cache_memory_.TryConsume(plan->memory_bytes)) {
+        return;
+    }
 
     plan->is_cached = true;
-    query_cache_[normalized] = std::move(plan);
+    cache_lru_.emplace_front(key, std::move(plan));
+    query_cache_[key] = cache_lru_.begin();
 }
 
-QueryPlan* QueryProcessor::GetFromCache(const std::string& query) const {
+std::shared_ptr<QueryPlan> QueryProcessor::GetFromCache(
+    const std::string& key) {
     if (!query_cache_enabled_) return nullptr;
 
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-
-    std::string normalized = NormalizeQuery(query);
-    auto it = query_cache_.find(normalized);
-    if (it != query_cache_.end()) {
-        return it->second.get();
+    std::shared_ptr<QueryPlan> plan;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = query_cache_.find(key);
+        if (it != query_cache_.end()) {
+            cache_lru_.splice(cache_lru_.begin(), cache_lru_, it->second);
+            plan = it->second->second;
+        }
     }
 
-    return nullptr;
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (plan) {
+        stats_.cache_hits++;
+    } else {
+        stats_.cache_misses++;
+    }
+    return plan;
 }
 
 void QueryProcessor::EvictLRUCacheEntry() {
-    // Simple eviction - remove first entry
-    // In a real implementation, this would track LRU order
-    if (!query_cache_.empty()) {
-        query_cache_.erase(query_cache_.begin());
+    // Caller holds cache_mutex_; the least recently used entry is at the back
+    if (!cache_lru_.empty()) {
+        plan_cache_memory_.Release(cache_lru_.back().second->memory_bytes);
+        query_cache_.erase(cache_lru_.back().first);
+        cache_lru_.pop_back();
+    }
+}
+
+std::shared_ptr<QueryPlan> QueryProcessor::LookupParameterizedPlan(
+    const std::string& query, std::vector<Value>* literals) {
+    if (!query_cache_enabled_) return nullptr;
+
+    std::string fingerprint = NormalizeQuery(query, literals);
+    if (fingerprint.empty()) return nullptr;
+
+    // The literal types are part of the key: a plan chosen for an integer
+    // key is not reused for a string in the same position
+    std::string key = fingerprint + '\n';
+    for (const auto& literal : *literals) {
+        key += std::to_string(literal.index());
+        key += ',';
+    }
+
+    auto plan = GetFromCache(key);
+    if (!plan) {
+        // 缓存的语句活得比这次查询长，不从查询的内存池分配
+        QueryArena::Suspend heap_allocation;
+        plan = std::make_shared<QueryPlan>();
+        plan->parse_time = std::chrono::system_clock::now();
+        plan->estimated_cost = 0;
+        plan->is_cached = false;
+        plan->memory_bytes = sizeof(QueryPlan) + 2 * key.size() +
+                             fingerprint.size() * kPlanCacheBytesPerQueryChar;
+        try {
+            // Literals in positions that only accept constants (LIMIT, for
+            // example) make this parse fail; the entry is then cached
+            // without a statement so the query is parsed normally
+            Parser parser("PREPARE cached_query AS " + fingerprint);
+            auto statement = parser.Parse();
+            auto* prepare_stmt = static_cast<PrepareStatement*>(statement.get());
+            plan->type = DetermineQueryType(prepare_stmt->GetStatement());
+            plan->prepared = std::make_shared<PreparedStatement>(
+                prepare_stmt->ReleaseStatement(),
+                prepare_stmt->GetParameters());
+        } catch (const std::exception&) {
+            plan->type = QueryType::UNKNOWN;
+        }
+        plan->parse_duration =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now() - plan->parse_time);
+        AddToCache(key, plan);
+    }
+    return plan->prepared ? plan : nullptr;
+}
+
+QueryResult QueryProcessor::ExecuteCachedQuery(
+    Session* session, const QueryPlan& plan,
+    const std::vector<Value>& literals) {
+    std::vector<Tuple> result_set;
+    Transaction* txn = session ? session->GetCurrentTransaction() : nullptr;
+    // 只有SELECT流式输出，INSERT/UPDATE/DELETE的结果是影响行数
+    ResultSink* sink = session && plan.type == QueryType::SELECT
+                           ? session->GetResultSink()
+                           : nullptr;
+    try {
+        bool success = execution_engine_->ExecutePrepared(
+            plan.prepared.get(), literals, &result_set, txn, sink);
+        if (!success) {
+            return CreateErrorResult("Cached query execution failed");
+        }
+    } catch (const std::exception& e) {
+        std::cout << "[ERROR] ExecuteCachedQuery: Exception: " << e.what()
+                  << std::endl;
+        return CreateErrorResult("Cached query execution failed: " +
+                                 std::string(e.what()));
+    }
+
+    // Affected rows are reported like the uncached statement paths
+    size_t affected_rows = 0;
+    switch (plan.type) {
+        case QueryType::INSERT:
+            affected_rows = result_set.empty() ? 1 : result_set.size();
+            break;
+        case QueryType::UPDATE:
+        case QueryType::DELETE:
+            affected_rows =
+                result_set.empty() || result_set[0].GetValues().empty()
+                    ? 0
+                    : std::get<int32_t>(result_set[0].GetValue(0));
+            break;
+        default:
+            break;
+    }
+    return CreateSuccessResult(result_set, affected_rows);
+}
+
+size_t QueryProcessor::ResultCacheBudget(const ServerConfig& config) const {
+    // A replica's tables change through WAL replay, which does not bump the
+    // modification counters, so it never caches results
+    if (!config.GetDatabaseConfig().primary_host.empty()) {
+        return 0;
+    }
+    return config.GetQueryConfig().result_cache_bytes;
+}
+
+/**
+ * Result cache key and table counters
+ * The expression language has no volatile functions, so a SELECT's result
+ * depends only on its text, its literals and the tables it reads. The key
+ * is the query fingerprint plus the literal values; queries the lexer
+ * cannot fingerprint are not cached.
+ */
+bool QueryProcessor::PrepareResultCacheKey(
+    const std::string& query, const SelectStatement* select, std::string* key,
+    ResultCache::TableVersions* versions) {
+    if (!select || result_cache_->GetMaxEntryBytes() == 0) {
+        return false;
+    }
+    std::vector<Value> literals;
+    std::string fingerprint = NormalizeQuery(query, &literals);
+    if (fingerprint.empty()) {
+        return false;
+    }
+    std::vector<std::string> tables{select->GetTableName()};
+    if (select->HasJoin()) {
+        tables.push_back(select->GetJoinTableName());
+    }
+    if (!ResultCache::CaptureVersions(catalog_, tables, versions)) {
+        return false;
+    }
+    *key = ResultCache::MakeKey(fingerprint, literals);
+    return true;
+}
+
+/**
+ * Commit with result cache invalidation
+ * The executors bump a table's counter when they modify it, but a snapshot
+ * taken before the commit still reads the old rows; bumping again after
+ * the commit keeps such a result from being cached under the new counters.
+ * The transaction object is reused after the commit, so the tables are
+ * copied out first.
+ */
+bool QueryProcessor::CommitSessionTransaction(Session* session) {
+    Transaction* txn = session->GetCurrentTransaction();
+    std::vector<oid_t> modified_tables;
+    if (txn) {
+        modified_tables.assign(txn->GetModifiedTables().begin(),
+                               txn->GetModifiedTables().end());
+    }
+    bool committed = session->CommitTransaction();
+    for (oid_t table_oid : modified_tables) {
+        catalog_->BumpModificationCount(table_oid);
     }
+    return committed;
 }
 
 bool QueryProcessor::ValidateExecutionParameters(Statement* stmt,
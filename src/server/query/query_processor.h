@@ -1,16 +1,24 @@
 #pragma once
 
 #include <chrono>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "admission_controller.h"
+#include "common/memory_tracker.h"
+#include "execution/cancellation_token.h"
 #include "execution/execution_engine.h"
+#include "execution/result_cache.h"
 #include "parser/parser.h"
 #include "query_context.h"
+#include "slow_query_log.h"
 #include "server/config/server_config.h"
 #include "server/protocol/protocol_handler.h"
+#include "stat/metrics.h"
 
 namespace SimpleRDBMS {
 
@@ -34,19 +42,49 @@ enum class QueryType {
     BEGIN_TRANSACTION,
     COMMIT_TRANSACTION,
     ROLLBACK_TRANSACTION,
-    EXPLAIN
+    EXPLAIN,
+    ANALYZE,
+    VACUUM,
+    COPY,
+    PREPARE,
+    EXECUTE,
+    DEALLOCATE,
+    SET_VARIABLE,
+    KILL
+};
+
+// A statement that is executing, as listed by the /queries endpoint
+struct RunningQueryInfo {
+    std::string session_id;
+    std::string query;
+    double elapsed_ms;
+    size_t memory_bytes;  // charged to the query's memory tracker
+};
+
+// Server-wide memory accounting, as exported by /metrics
+struct MemoryUsageStats {
+    size_t server_bytes = 0;  // running queries plus both caches
+    size_t server_peak_bytes = 0;
+    size_t server_limit_bytes = 0;  // 0 when unlimited
+    size_t plan_cache_bytes = 0;
+    size_t result_cache_bytes = 0;
 };
 
 struct QueryPlan {
     QueryType type;
     std::unique_ptr<Statement> statement;
+    // Parameterized statement shared by every query with the same
+    // fingerprint; null when the fingerprint cannot be parameterized
+    std::shared_ptr<PreparedStatement> prepared;
     std::chrono::system_clock::time_point parse_time;
     std::chrono::milliseconds parse_duration;
     size_t estimated_cost;
     bool is_cached;
+    // Estimated memory of the entry, charged to the plan cache tracker
+    size_t memory_bytes = 0;
 };
 
-struct QueryStats {
+struct QueryProcessorStats {
     size_t total_queries;
     size_t successful_queries;
     size_t failed_queries;
@@ -55,6 +93,8 @@ struct QueryStats {
     std::chrono::milliseconds max_execution_time;
     std::chrono::milliseconds min_execution_time;
     std::unordered_map<QueryType, size_t> query_type_counts;
+    size_t cache_hits;
+    size_t cache_misses;
 };
 
 class QueryProcessor {
@@ -83,13 +123,34 @@ class QueryProcessor {
     void ClearQueryCache();
 
     // Statistics
-    QueryStats GetStats() const;
+    QueryProcessorStats GetStats() const;
     void ResetStats();
+    AdmissionStats GetAdmissionStats() const;
+    // 慢查询日志没有开启时都是0
+    SlowQueryLogStats GetSlowQueryLogStats() const;
+    // 结果缓存没有开启时都是0
+    ResultCacheStats GetResultCacheStats() const;
+    MemoryUsageStats GetMemoryUsageStats() const;
+    // ProcessQuery的端到端耗时分布（解析、执行和自动提交）
+    LatencyHistogram::Snapshot GetLatencyHistogram() const {
+        return query_latency_.GetSnapshot();
+    }
+
+    // Admission control
+    // 重查询：会扫描整张大表的SELECT（JOIN、聚合、排序、没有条件的扫描），
+    // 以及大表上的ANALYZE、VACUUM、COPY和CREATE INDEX
+    WorkloadClass ClassifyQuery(QueryType type, const Statement* statement);
 
     // Configuration
     void UpdateConfig(const ServerConfig& config);
     const ServerConfig& GetConfig() const { return config_; }
 
+    // Query cancellation
+    // Cancels the statement the session is executing, as KILL does;
+    // false when the session is not executing one
+    bool CancelQuery(const std::string& session_id);
+    std::vector<RunningQueryInfo> GetRunningQueries() const;
+
     // Query timeout management
     void SetQueryTimeout(std::chrono::seconds timeout) {
         query_timeout_ = timeout;
@@ -105,19 +166,56 @@ class QueryProcessor {
     TransactionManager* transaction_manager_;
     Catalog* catalog_;
 
+    // Memory accounting: every session tracker hangs off server_memory_,
+    // each statement gets a query tracker under its session, and the two
+    // caches charge their own trackers under the server
+    MemoryTracker server_memory_{"server"};
+    MemoryTracker plan_cache_memory_{"plan cache", &server_memory_};
+    MemoryTracker result_cache_memory_{"result cache", &server_memory_};
+
     // Query planning and parsing
     // std::unique_ptr<Parser> parser_;
     std::unique_ptr<Statement> ParseQuery(const std::string& query_string);
 
-    // Query caching
+    // Query caching: LRU keyed by query fingerprint, most recently used
+    // entry at the front of cache_lru_
     bool query_cache_enabled_;
-    std::unordered_map<std::string, std::unique_ptr<QueryPlan>> query_cache_;
+    using CacheEntry = std::pair<std::string, std::shared_ptr<QueryPlan>>;
+    std::list<CacheEntry> cache_lru_;
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator>
+        query_cache_;
     mutable std::mutex cache_mutex_;
     size_t max_cache_size_;
 
+    // Result cache for autocommit SELECTs, separate from the plan cache;
+    // a zero budget disables it
+    std::unique_ptr<ResultCache> result_cache_;
+
     // Statistics
     mutable std::mutex stats_mutex_;
-    QueryStats stats_;
+    QueryProcessorStats stats_;
+    LatencyHistogram query_latency_;  // 按微秒精度计时，不受stats_mutex_保护
+
+    // Slow query log, null when disabled
+    std::unique_ptr<SlowQueryLog> slow_query_log_;
+    double slow_query_threshold_ms_;
+    double slow_query_sample_percent_;
+
+    // Heavy queries need a slot before they run
+    std::unique_ptr<AdmissionController> admission_controller_;
+    size_t heavy_query_min_pages_;
+
+    // Statements being executed, keyed by session id; each session runs
+    // one statement at a time. The token lives on the executing thread's
+    // stack and is removed from the map before it goes away
+    struct RunningQuery {
+        CancellationToken* token;
+        const MemoryTracker* memory;
+        std::string query;
+        std::chrono::steady_clock::time_point start;
+    };
+    mutable std::mutex running_queries_mutex_;
+    std::unordered_map<std::string, RunningQuery> running_queries_;
 
     // Configuration
     std::chrono::seconds query_timeout_;
@@ -125,7 +223,8 @@ class QueryProcessor {
 
     // Helper methods
     QueryType DetermineQueryType(const Statement* statement) const;
-    std::string NormalizeQuery(const std::string& query) const;
+    std::string NormalizeQuery(const std::string& query,
+                               std::vector<Value>* literals) const;
     bool IsQueryCacheable(QueryType type) const;
 
     // Query execution helpers
@@ -138,6 +237,8 @@ class QueryProcessor {
     QueryResult ExecuteShowTablesStatement(Session* session);
     QueryResult ExecuteExplainStatement(Session* session,
                                         ExplainStatement* stmt);
+    QueryResult ExecuteSetStatement(Session* session, SetStatement* stmt);
+    QueryResult ExecuteKillStatement(Session* session, KillStatement* stmt);
 
     // Error handling
     QueryResult CreateErrorResult(const std::string& error_message) const;
@@ -146,16 +247,45 @@ class QueryProcessor {
 
     QueryResult DetermineQueryTypeFromString(const std::string& query) const;
 
+    // Slow query log helpers
+    bool ShouldSampleQuery() const;
+    // io_before是查询开始时线程的I/O计数，capture为空时不带计划和返回行数
+    void LogSlowQuery(Session* session, const std::string& query,
+                      double duration_ms, const QueryResult& result,
+                      const ThreadIOCounters& io_before,
+                      const PlanCapture* capture, bool sampled);
+
     // Statistics helpers
     void UpdateQueryStats(QueryType type,
                           std::chrono::milliseconds execution_time,
                           bool success);
 
     // Cache management
-    void AddToCache(const std::string& query, std::unique_ptr<QueryPlan> plan);
-    QueryPlan* GetFromCache(const std::string& query) const;
+    void AddToCache(const std::string& key, std::shared_ptr<QueryPlan> plan);
+    std::shared_ptr<QueryPlan> GetFromCache(const std::string& key);
     void EvictLRUCacheEntry();
 
+    // Finds or builds the parameterized plan for a query, returns null when
+    // the query cannot use one; literals receives the values to bind
+    std::shared_ptr<QueryPlan> LookupParameterizedPlan(
+        const std::string& query, std::vector<Value>* literals);
+    QueryResult ExecuteCachedQuery(Session* session, const QueryPlan& plan,
+                                   const std::vector<Value>& literals);
+
+    // Result cache helpers
+    size_t ResultCacheBudget(const ServerConfig& config) const;
+    // Builds the result cache key of a SELECT and reads the counters of the
+    // tables it reads; false when the result cannot be cached
+    bool PrepareResultCacheKey(const std::string& query,
+                               const SelectStatement* select,
+                               std::string* key,
+                               ResultCache::TableVersions* versions);
+    // Commits the session's transaction and bumps the modification
+    // counters of the tables it wrote once more
+    bool CommitSessionTransaction(Session* session);
+
+    size_t GetTablePageCount(const std::string& table_name);
+
     bool ValidateExecutionParameters(Statement* stmt,
                                      std::vector<Tuple>* result_set,
                                      Transaction* txn);
@@ -0,0 +1,190 @@
+#include "slow_query_log.h"
+
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "parser/lexer.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+// 参数的文本形式，字符串加单引号，和SQL里的写法一致
+std::string FormatParameter(const Value& value) {
+    std::ostringstream oss;
+    if (std::holds_alternative<bool>(value)) {
+        oss << (std::get<bool>(value) ? "TRUE" : "FALSE");
+    } else if (std::holds_alternative<int8_t>(value)) {
+        oss << static_cast<int>(std::get<int8_t>(value));
+    } else if (std::holds_alternative<int16_t>(value)) {
+        oss << std::get<int16_t>(value);
+    } else if (std::holds_alternative<int32_t>(value)) {
+        oss << std::get<int32_t>(value);
+    } else if (std::holds_alternative<int64_t>(value)) {
+        oss << std::get<int64_t>(value);
+    } else if (std::holds_alternative<float>(value)) {
+        oss << std::get<float>(value);
+    } else if (std::holds_alternative<double>(value)) {
+        oss << std::get<double>(value);
+    } else if (std::holds_alternative<std::string>(value)) {
+        oss << '\'';
+        for (char c : std::get<std::string>(value)) {
+            if (c == '\'') {
+                oss << '\'';
+            }
+            oss << (c == '\n' ? ' ' : c);
+        }
+        oss << '\'';
+    } else {
+        oss << "NULL";
+    }
+    return oss.str();
+}
+
+// 多行的原始查询压成一行，保证每条SQL在日志里只占一行
+std::string SingleLine(const std::string& text) {
+    std::string line = text;
+    for (char& c : line) {
+        if (c == '\n' || c == '\r') {
+            c = ' ';
+        }
+    }
+    return line;
+}
+
+}  // namespace
+
+SlowQueryLog::SlowQueryLog(size_t queue_capacity)
+    : queue_capacity_(queue_capacity == 0 ? 1 : queue_capacity) {}
+
+SlowQueryLog::~SlowQueryLog() { Stop(); }
+
+bool SlowQueryLog::Start(const std::string& file_path) {
+    if (running_) {
+        return true;
+    }
+    file_.open(file_path, std::ios::out | std::ios::app);
+    if (!file_.is_open()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+    }
+    running_ = true;
+    writer_thread_ = std::thread(&SlowQueryLog::WriterLoop, this);
+    return true;
+}
+
+void SlowQueryLog::Stop() {
+    if (!running_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+    file_.close();
+    running_ = false;
+}
+
+bool SlowQueryLog::Submit(SlowQueryEntry entry) {
+    if (!running_) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= queue_capacity_) {
+            dropped_++;
+            return false;
+        }
+        queue_.push_back(std::move(entry));
+    }
+    queue_cv_.notify_one();
+    return true;
+}
+
+SlowQueryLogStats SlowQueryLog::GetStats() const {
+    return SlowQueryLogStats{logged_.load(), dropped_.load()};
+}
+
+/**
+ * 写日志线程
+ * 实现思路：
+ * 1. 等到队列非空或者要求停止，一次把队列整个换出来，尽快放开锁
+ * 2. 锁外格式化并写入这一批，写完flush一次，外部工具能及时看到
+ * 3. 要求停止并且队列已经写空时退出
+ */
+void SlowQueryLog::WriterLoop() {
+    while (true) {
+        std::deque<SlowQueryEntry> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;  // stopping_ and everything already written
+            }
+            batch.swap(queue_);
+        }
+        for (const auto& entry : batch) {
+            file_ << FormatEntry(entry);
+        }
+        file_.flush();
+        logged_ += batch.size();
+    }
+}
+
+std::string SlowQueryLog::FormatEntry(const SlowQueryEntry& entry) {
+    std::vector<Value> parameters;
+    std::string normalized = Lexer::Fingerprint(entry.query, &parameters);
+    if (normalized.empty()) {
+        // 不能参数化的语句（DDL、已经带占位符的）按原文记录
+        normalized = SingleLine(entry.query);
+        parameters.clear();
+    }
+
+    std::ostringstream oss;
+    std::time_t time = std::chrono::system_clock::to_time_t(entry.time);
+    std::tm tm_buf{};
+    localtime_r(&time, &tm_buf);
+    oss << "# Time: " << std::put_time(&tm_buf, "%Y-%m-%dT%H:%M:%S") << "\n";
+    oss << "# Session: " << entry.session_id
+        << "  Reason: " << (entry.sampled ? "sampled" : "slow")
+        << "  Status: " << (entry.success ? "OK" : "ERROR") << "\n";
+    oss << std::fixed << std::setprecision(3);
+    oss << "# Query_time: " << entry.duration_ms
+        << " ms  Lock_time: " << entry.io.lock_wait_ms << " ms\n";
+    oss << "# Rows_examined: " << entry.io.rows_examined
+        << "  Rows_returned: " << entry.rows_returned
+        << "  Rows_affected: " << entry.rows_affected << "\n";
+    oss << "# Buffer_hits: " << entry.io.buffer_hits
+        << "  Buffer_misses: " << entry.io.buffer_misses
+        << "  Disk_reads: " << entry.io.disk_reads
+        << "  Lock_waits: " << entry.io.lock_waits << "\n";
+    if (!parameters.empty()) {
+        oss << "# Parameters:";
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            oss << " $" << (i + 1) << "=" << FormatParameter(parameters[i]);
+        }
+        oss << "\n";
+    }
+    if (!entry.plan.empty()) {
+        oss << "# Plan:\n";
+        std::istringstream plan_lines(entry.plan);
+        std::string line;
+        while (std::getline(plan_lines, line)) {
+            oss << "#   " << line << "\n";
+        }
+    }
+    oss << normalized << ";\n";
+    return oss.str();
+}
+
+}  // namespace SimpleRDBMS
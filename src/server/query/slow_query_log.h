@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "stat/io_counters.h"
+
+namespace SimpleRDBMS {
+
+// 一条待写入慢查询日志的记录，查询线程只填原始数据，格式化在写日志线程做
+struct SlowQueryEntry {
+    std::chrono::system_clock::time_point time;
+    std::string session_id;
+    std::string query;       // 原始查询文本，写入时再规范化
+    double duration_ms = 0.0;
+    bool success = false;
+    bool sampled = false;    // 按比例抽样记下的，不一定慢
+    uint64_t rows_returned = 0;
+    uint64_t rows_affected = 0;
+    ThreadIOCounters io;     // 这次查询期间查询线程上的增量
+    std::string plan;        // 格式化好的执行计划，可能为空
+};
+
+struct SlowQueryLogStats {
+    uint64_t logged;
+    uint64_t dropped;
+};
+
+/**
+ * SlowQueryLog - 异步写入的慢查询日志
+ *
+ * 设计思路：
+ * - 查询线程只把记录放进一个有界队列就返回，不碰文件；后台线程
+ *   批量取出来规范化、格式化并追加到文件，写盘再慢也不拖累查询
+ * - 队列满了直接丢弃新记录并计数，日志是诊断用的，不能反压查询
+ * - 格式仿照MySQL的慢查询日志：几行以#开头的头部（耗时、行数、
+ *   缓冲池和锁的开销、字面量参数、执行计划），后面是规范化的SQL，
+ *   字面量换成$1、$2，相同形状的查询可以直接按文本聚合
+ */
+class SlowQueryLog {
+public:
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 1024;
+
+    explicit SlowQueryLog(size_t queue_capacity = DEFAULT_QUEUE_CAPACITY);
+    ~SlowQueryLog();
+
+    SlowQueryLog(const SlowQueryLog&) = delete;
+    SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+    // 打开（追加）日志文件并启动写日志线程，打不开文件时返回false
+    bool Start(const std::string& file_path);
+    // 写完队列里剩下的记录后停止
+    void Stop();
+    bool IsRunning() const { return running_; }
+
+    // 放进写入队列，不阻塞；队列满时丢弃并返回false
+    bool Submit(SlowQueryEntry entry);
+
+    SlowQueryLogStats GetStats() const;
+
+    // 一条记录在日志里的文本，以换行结尾
+    static std::string FormatEntry(const SlowQueryEntry& entry);
+
+private:
+    void WriterLoop();
+
+    size_t queue_capacity_;
+    std::ofstream file_;
+    std::thread writer_thread_;
+    std::atomic<bool> running_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<SlowQueryEntry> queue_;
+    bool stopping_ = false;
+
+    std::atomic<uint64_t> logged_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace SimpleRDBMS
@@ -2,13 +2,17 @@
 
 #include <iostream>
 
+#include "common/async_log.h"
 #include "config/config_manager.h"
 #include "database_server.h"
 
 using namespace SimpleRDBMS;
 
 int main(int argc, char* argv[]) {
-    setenv("SIMPLEDB_DEBUG_LEVEL", "4", 1);  // DEBUG级别
+    // 默认DEBUG级别，已经设置了SIMPLEDB_DEBUG_LEVEL时以环境变量为准
+    setenv("SIMPLEDB_DEBUG_LEVEL", "4", 0);
+    // 日志交给后台线程写，查询线程不用等stderr
+    AsyncLogSink::GetInstance().Start();
     try {
         // Setup signal handlers
         DatabaseServer::SetupSignalHandlers();
@@ -60,6 +64,7 @@ int main(int argc, char* argv[]) {
         std::cout << "Server stopping..." << std::endl;
         server.Shutdown();
         std::cout << "Server stopped." << std::endl;
+        AsyncLogSink::GetInstance().Stop();
 
         return 0;
     } catch (const std::exception& e) {
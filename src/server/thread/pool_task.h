@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace SimpleRDBMS {
+
+/**
+ * PoolTask - a move-only void() callable for the thread pool
+ *
+ * 设计思路：
+ * - 和std::function<void()>一样做类型擦除，但只要求可调用对象能移动，
+ *   std::packaged_task这类只能移动的对象可以直接放进来，不用再包一层shared_ptr
+ * - 不超过INLINE_SIZE字节、移动不抛异常的可调用对象放在对象内部的缓冲区里，
+ *   提交任务时不分配内存；更大的才放到堆上
+ */
+class PoolTask {
+public:
+    static constexpr size_t INLINE_SIZE = 64;
+
+    PoolTask() = default;
+
+    template <typename F,
+              typename = std::enable_if_t<
+                  !std::is_same<std::decay_t<F>, PoolTask>::value>>
+    PoolTask(F&& f) {  // NOLINT: implicit like std::function
+        using Callable = std::decay_t<F>;
+        if constexpr (IsInline<Callable>()) {
+            new (storage_) Callable(std::forward<F>(f));
+            ops_ = &InlineOps<Callable>::ops;
+        } else {
+            *reinterpret_cast<Callable**>(storage_) =
+                new Callable(std::forward<F>(f));
+            ops_ = &HeapOps<Callable>::ops;
+        }
+    }
+
+    PoolTask(PoolTask&& other) noexcept { MoveFrom(other); }
+    PoolTask& operator=(PoolTask&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+    PoolTask(const PoolTask&) = delete;
+    PoolTask& operator=(const PoolTask&) = delete;
+    ~PoolTask() { Reset(); }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+    void operator()() { ops_->invoke(storage_); }
+
+    void Reset() {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        // 把from里的可调用对象移到to里，from之后不再持有它
+        void (*move)(void* from, void* to);
+        void (*destroy)(void* storage);
+    };
+
+    template <typename F>
+    static constexpr bool IsInline() {
+        return sizeof(F) <= INLINE_SIZE &&
+               alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<F>::value;
+    }
+
+    template <typename F>
+    struct InlineOps {
+        static void Invoke(void* storage) { (*static_cast<F*>(storage))(); }
+        static void Move(void* from, void* to) {
+            new (to) F(std::move(*static_cast<F*>(from)));
+            static_cast<F*>(from)->~F();
+        }
+        static void Destroy(void* storage) { static_cast<F*>(storage)->~F(); }
+        static constexpr Ops ops{Invoke, Move, Destroy};
+    };
+
+    template <typename F>
+    struct HeapOps {
+        static void Invoke(void* storage) { (**static_cast<F**>(storage))(); }
+        static void Move(void* from, void* to) {
+            *static_cast<F**>(to) = *static_cast<F**>(from);
+        }
+        static void Destroy(void* storage) { delete *static_cast<F**>(storage); }
+        static constexpr Ops ops{Invoke, Move, Destroy};
+    };
+
+    void MoveFrom(PoolTask& other) {
+        ops_ = other.ops_;
+        if (ops_) {
+            ops_->move(other.storage_, storage_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[INLINE_SIZE];
+    const Ops* ops_ = nullptr;
+};
+
+} // namespace SimpleRDBMS
@@ -1,15 +1,108 @@
 #include "thread_pool.h"
 #include "worker_thread.h"
+#include "common/numa.h"
 #include <iostream>
 #include <algorithm>
 
 namespace SimpleRDBMS {
 
+namespace {
+
+// 当前线程是哪个线程池的第几个工作线程，用来把工作线程自己提交的任务
+// 放进它自己的双端队列
+struct CurrentWorker {
+    const void* pool = nullptr;
+    size_t index = 0;
+};
+thread_local CurrentWorker current_worker;
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}  // namespace
+
+ThreadPool::InjectionQueue::InjectionQueue(size_t capacity)
+    : cells_(new Cell[RoundUpToPowerOfTwo(std::max<size_t>(capacity, 2))]),
+      mask_(RoundUpToPowerOfTwo(std::max<size_t>(capacity, 2)) - 1) {
+    for (size_t i = 0; i <= mask_; i++) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * 入队
+ * 格子的序号等于入队位置说明它空着，先用CAS占住位置再写任务，
+ * 最后把序号改成位置+1交给出队的一方
+ */
+bool ThreadPool::InjectionQueue::TryPush(PoolTask& task) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell = &cells_[pos & mask_];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff =
+            static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // 满了
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    cell->task = std::move(task);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool ThreadPool::InjectionQueue::TryPop(PoolTask* task) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell = &cells_[pos & mask_];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff =
+            static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeue_pos_.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // 空的
+        } else {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    *task = std::move(cell->task);
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+size_t ThreadPool::InjectionQueue::ApproxSize() const {
+    size_t enqueued = enqueue_pos_.load(std::memory_order_acquire);
+    size_t dequeued = dequeue_pos_.load(std::memory_order_acquire);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+}
+
 ThreadPool::ThreadPool(const ThreadPoolConfig& config)
     : config_(config),
+      workers_(new Worker[std::max<size_t>(
+          {config.max_threads, config.min_threads, 1})]),
+      worker_capacity_(
+          std::max<size_t>({config.max_threads, config.min_threads, 1})),
       active_threads_(0),
-      running_(false) {
-    ResetStats();
+      running_(false),
+      interactive_queue_(config.max_queue_size),
+      batch_queue_(config.max_queue_size) {
 }
 
 ThreadPool::~ThreadPool() {
@@ -20,27 +113,27 @@ bool ThreadPool::Initialize() {
     if (running_) {
         return true;
     }
-    
+
     try {
         // Validate configuration
         if (config_.min_threads > config_.max_threads) {
             std::cerr << "[ThreadPool] Invalid configuration: min_threads > max_threads" << std::endl;
             return false;
         }
-        
+
+        running_ = true;
         // Start with minimum number of threads
-        for (size_t i = 0; i < config_.min_threads; ++i) {
-            AddWorkerThread();
+        while (worker_count_ < std::max<size_t>(config_.min_threads, 1)) {
+            StartWorker();
         }
-        
-        running_ = true;
-        
-        std::cout << "[ThreadPool] Initialized with " << config_.min_threads 
+
+        std::cout << "[ThreadPool] Initialized with " << worker_count_
                   << " threads (max: " << config_.max_threads << ")" << std::endl;
         return true;
-        
+
     } catch (const std::exception& e) {
         std::cerr << "[ThreadPool] Initialization failed: " << e.what() << std::endl;
+        Shutdown();
         return false;
     }
 }
@@ -49,30 +142,39 @@ void ThreadPool::Shutdown() {
     if (!running_) {
         return;
     }
-    
+
     running_ = false;
-    
+
     // Notify all threads to stop
-    condition_.notify_all();
-    
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        idle_cv_.notify_all();
+    }
+
     // Stop and join all worker threads
-    for (auto& thread : worker_threads_) {
-        if (thread && thread->joinable()) {
-            thread->join();
+    std::lock_guard<std::mutex> grow_lock(grow_mutex_);
+    size_t count = worker_count_;
+    for (size_t i = 0; i < count; i++) {
+        Worker& worker = workers_[i];
+        if (worker.thread && worker.thread->joinable()) {
+            worker.thread->join();
         }
+        worker.thread.reset();
     }
-    
-    worker_threads_.clear();
+    worker_count_ = 0;
     active_threads_ = 0;
-    
+
     // Clear remaining tasks
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        while (!task_queue_.empty()) {
-            task_queue_.pop();
-        }
+    PoolTask task;
+    while (interactive_queue_.TryPop(&task) || batch_queue_.TryPop(&task)) {
+        task.Reset();
+    }
+    for (size_t i = 0; i < worker_capacity_; i++) {
+        std::lock_guard<std::mutex> lock(workers_[i].deque_mutex);
+        workers_[i].deque.clear();
+        workers_[i].deque_size = 0;
     }
-    
+
     std::cout << "[ThreadPool] Shutdown complete" << std::endl;
 }
 
@@ -80,54 +182,71 @@ void ThreadPool::SetPoolSize(size_t min_threads, size_t max_threads) {
     if (min_threads > max_threads) {
         return;
     }
-    
-    config_.min_threads = min_threads;
-    config_.max_threads = max_threads;
-    
-    // Adjust current pool size
-    size_t current_size = worker_threads_.size();
-    if (current_size < min_threads) {
-        // Add threads
-        for (size_t i = current_size; i < min_threads; ++i) {
-            AddWorkerThread();
-        }
-    } else if (current_size > max_threads) {
-        // Remove excess threads
-        for (size_t i = max_threads; i < current_size; ++i) {
-            RemoveWorkerThread();
+
+    config_.min_threads = std::min(min_threads, worker_capacity_);
+    config_.max_threads = std::min(max_threads, worker_capacity_);
+
+    // Add threads up to the new minimum
+    if (running_) {
+        std::lock_guard<std::mutex> lock(grow_mutex_);
+        while (worker_count_ < config_.min_threads) {
+            StartWorker();
         }
     }
 }
 
 size_t ThreadPool::GetQueueSize() const {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    return task_queue_.size();
+    size_t size = interactive_queue_.ApproxSize() + batch_queue_.ApproxSize();
+    for (size_t i = 0; i < worker_capacity_; i++) {
+        size += workers_[i].deque_size.load(std::memory_order_relaxed);
+    }
+    return size;
 }
 
+/**
+ * 汇总各个工作线程的统计
+ * 提交路径上没有计数，已提交的任务数由完成、失败和排队中的任务数相加得到
+ */
 TaskStats ThreadPool::GetStats() const {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    auto stats = stats_;
-    
-    {
-        std::lock_guard<std::mutex> queue_lock(queue_mutex_);
-        stats.pending_tasks = task_queue_.size();
+    TaskStats stats{};
+    int64_t execution_us = 0;
+    int64_t last_task_time = 0;
+    for (size_t i = 0; i < worker_capacity_; i++) {
+        const Worker& worker = workers_[i];
+        stats.completed_tasks += worker.completed.load(std::memory_order_relaxed);
+        stats.failed_tasks += worker.failed.load(std::memory_order_relaxed);
+        execution_us += worker.execution_us.load(std::memory_order_relaxed);
+        last_task_time = std::max(
+            last_task_time, worker.last_task_time.load(std::memory_order_relaxed));
     }
-    
+    stats.pending_tasks = GetQueueSize();
+    stats.total_tasks = stats.completed_tasks + stats.failed_tasks +
+                        stats.pending_tasks + active_threads_.load();
+    stats.total_execution_time =
+        std::chrono::milliseconds(execution_us / 1000);
     if (stats.completed_tasks > 0) {
         stats.average_execution_time = std::chrono::milliseconds(
             stats.total_execution_time.count() / stats.completed_tasks);
     }
-    
+    stats.last_task_time = std::chrono::system_clock::time_point(
+        std::chrono::system_clock::duration(last_task_time));
     return stats;
 }
 
 void ThreadPool::ResetStats() {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_ = TaskStats{};
+    for (size_t i = 0; i < worker_capacity_; i++) {
+        Worker& worker = workers_[i];
+        worker.completed = 0;
+        worker.failed = 0;
+        worker.execution_us = 0;
+        worker.last_task_time = 0;
+    }
 }
 
 void ThreadPool::UpdateConfig(const ThreadPoolConfig& config) {
+    size_t max_queue_size = config_.max_queue_size;
     config_ = config;
+    config_.max_queue_size = max_queue_size;
     SetPoolSize(config.min_threads, config.max_threads);
 }
 
@@ -135,143 +254,224 @@ bool ThreadPool::IsHealthy() const {
     if (!running_) {
         return false;
     }
-    
-    // Check if we have active threads
-    if (active_threads_ == 0 && config_.min_threads > 0) {
+
+    // Check if we have worker threads
+    if (worker_count_ == 0) {
         return false;
     }
-    
+
     // Check queue size
     size_t queue_size = GetQueueSize();
     if (queue_size > config_.max_queue_size) {
         return false;
     }
-    
+
     return true;
 }
 
 double ThreadPool::GetUtilization() const {
-    size_t total_threads = worker_threads_.size();
+    size_t total_threads = worker_count_;
     if (total_threads == 0) {
         return 0.0;
     }
-    
+
     return static_cast<double>(active_threads_) / total_threads;
 }
 
-void ThreadPool::WorkerLoop() {
+/**
+ * 提交任务
+ * 实现思路：
+ * 1. 工作线程提交的任务放进它自己的双端队列，其他线程提交的按优先级
+ *    进对应的环形队列
+ * 2. 有线程睡着时唤醒一个；入队和读sleepers_之间的栅栏与WorkerLoop里
+ *    增加sleepers_之后的栅栏配对，两边至少有一边能看到对方
+ * 3. 没有线程睡着而且所有线程都在执行任务时，试着加一个线程
+ */
+void ThreadPool::SubmitTask(PoolTask task, TaskPriority priority) {
+    if (!running_) {
+        throw std::runtime_error("ThreadPool is not running");
+    }
+
+    if (current_worker.pool == this) {
+        Worker& worker = workers_[current_worker.index];
+        std::lock_guard<std::mutex> lock(worker.deque_mutex);
+        worker.deque.push_back(std::move(task));
+        worker.deque_size.fetch_add(1, std::memory_order_relaxed);
+    } else if (!(priority == TaskPriority::BATCH ? batch_queue_
+                                                 : interactive_queue_)
+                    .TryPush(task)) {
+        throw std::runtime_error("Task queue is full");
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        idle_cv_.notify_one();
+    } else if (active_threads_.load(std::memory_order_relaxed) >=
+               worker_count_.load(std::memory_order_relaxed)) {
+        MaybeAddWorker();
+    }
+}
+
+/**
+ * 工作线程主循环
+ * 先取自己队列的尾部，再按权重取两个环形队列，最后去偷别的线程的队列头部；
+ * 都没有时先让出CPU几次，还没有就睡到有人提交任务
+ */
+void ThreadPool::WorkerLoop(size_t index) {
+    current_worker = {this, index};
+    Worker& self = workers_[index];
+    int idle_spins = 0;
+    size_t interactive_streak = 0;
+
     while (running_) {
-        std::function<void()> task;
-        
-        // Get task from queue
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            
-            condition_.wait(lock, [this] {
-                return !task_queue_.empty() || !running_;
-            });
-            
-            if (!running_) {
-                break;
-            }
-            
-            if (!task_queue_.empty()) {
-                task = std::move(task_queue_.front());
-                task_queue_.pop();
-            }
+        PoolTask task;
+        if (PopLocal(self, &task) || PopInjected(&interactive_streak, &task) ||
+            Steal(index, &task)) {
+            RunTask(self, task);
+            idle_spins = 0;
+            continue;
         }
-        
-        // Execute task
-        if (task) {
-            active_threads_++;
-            
-            auto start_time = std::chrono::high_resolution_clock::now();
-            bool success = true;
-            
-            try {
-                task();
-            } catch (const std::exception& e) {
-                std::cerr << "[ThreadPool] Task execution failed: " << e.what() << std::endl;
-                success = false;
-            } catch (...) {
-                std::cerr << "[ThreadPool] Task execution failed with unknown exception" << std::endl;
-                success = false;
-            }
-            
-            auto end_time = std::chrono::high_resolution_clock::now();
-            auto execution_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-                end_time - start_time);
-            
-            UpdateTaskStats(success, execution_time);
-            active_threads_--;
+        if (++idle_spins < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
         }
-        
-        // Dynamic thread management
-        if (ShouldRemoveThread()) {
-            break; // This thread will exit
+        idle_spins = 0;
+
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        sleepers_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (running_ && !HasWork()) {
+            idle_cv_.wait_for(lock, IDLE_WAIT);
         }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
     }
+
+    current_worker = {};
 }
 
-void ThreadPool::AddWorkerThread() {
-    if (!running_ || worker_threads_.size() >= config_.max_threads) {
-        return;
+bool ThreadPool::PopLocal(Worker& worker, PoolTask* task) {
+    if (worker.deque_size.load(std::memory_order_relaxed) == 0) {
+        return false;
     }
-    
-    try {
-        auto thread = std::make_unique<std::thread>(&ThreadPool::WorkerLoop, this);
-        worker_threads_.push_back(std::move(thread));
-    } catch (const std::exception& e) {
-        std::cerr << "[ThreadPool] Failed to add worker thread: " << e.what() << std::endl;
+    std::lock_guard<std::mutex> lock(worker.deque_mutex);
+    if (worker.deque.empty()) {
+        return false;
     }
+    *task = std::move(worker.deque.back());
+    worker.deque.pop_back();
+    worker.deque_size.fetch_sub(1, std::memory_order_relaxed);
+    return true;
 }
 
-void ThreadPool::RemoveWorkerThread() {
-    if (worker_threads_.size() <= config_.min_threads) {
-        return;
+/**
+ * 加权轮流取外部队列
+ * 连续取了interactive_weight个交互任务之后先看批处理队列，
+ * 哪个队列空了就取另一个，所以只有一类任务时也不会空等
+ */
+bool ThreadPool::PopInjected(size_t* interactive_streak, PoolTask* task) {
+    if (*interactive_streak < std::max<size_t>(config_.interactive_weight, 1)) {
+        if (interactive_queue_.TryPop(task)) {
+            (*interactive_streak)++;
+            return true;
+        }
+        if (batch_queue_.TryPop(task)) {
+            *interactive_streak = 0;
+            return true;
+        }
+        return false;
+    }
+    if (batch_queue_.TryPop(task)) {
+        *interactive_streak = 0;
+        return true;
     }
-    
-    // Mark for removal by decreasing max threads temporarily
-    // The actual removal happens when threads exit naturally
-    condition_.notify_one();
+    if (interactive_queue_.TryPop(task)) {
+        return true;
+    }
+    return false;
 }
 
-bool ThreadPool::ShouldAddThread() const {
-    if (!running_ || worker_threads_.size() >= config_.max_threads) {
-        return false;
+bool ThreadPool::Steal(size_t thief, PoolTask* task) {
+    size_t count = worker_count_.load(std::memory_order_acquire);
+    for (size_t offset = 1; offset < count; offset++) {
+        Worker& victim = workers_[(thief + offset) % count];
+        if (victim.deque_size.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(victim.deque_mutex);
+        if (victim.deque.empty()) {
+            continue;
+        }
+        *task = std::move(victim.deque.front());
+        victim.deque.pop_front();
+        victim.deque_size.fetch_sub(1, std::memory_order_relaxed);
+        return true;
     }
-    
-    // Add thread if queue is growing and we have capacity
-    size_t queue_size = GetQueueSize();
-    size_t thread_count = worker_threads_.size();
-    
-    return queue_size > thread_count && thread_count < config_.max_threads;
+    return false;
 }
 
-bool ThreadPool::ShouldRemoveThread() const {
-    if (!running_ || worker_threads_.size() <= config_.min_threads) {
-        return false;
-    }
-    
-    // Remove thread if we have too many idle threads
-    size_t queue_size = GetQueueSize();
-    size_t thread_count = worker_threads_.size();
-    
-    return queue_size == 0 && thread_count > config_.min_threads;
+bool ThreadPool::HasWork() const {
+    return GetQueueSize() > 0;
 }
 
-void ThreadPool::UpdateTaskStats(bool success, std::chrono::milliseconds execution_time) {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    
-    stats_.total_tasks++;
+void ThreadPool::RunTask(Worker& worker, PoolTask& task) {
+    active_threads_++;
+    auto start_time = std::chrono::steady_clock::now();
+    bool success = true;
+
+    try {
+        task();
+    } catch (const std::exception& e) {
+        std::cerr << "[ThreadPool] Task execution failed: " << e.what() << std::endl;
+        success = false;
+    } catch (...) {
+        std::cerr << "[ThreadPool] Task execution failed with unknown exception" << std::endl;
+        success = false;
+    }
+    task.Reset();
+
+    auto execution_time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_time);
     if (success) {
-        stats_.completed_tasks++;
+        worker.completed.fetch_add(1, std::memory_order_relaxed);
     } else {
-        stats_.failed_tasks++;
+        worker.failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    worker.execution_us.fetch_add(execution_time.count(),
+                                  std::memory_order_relaxed);
+    worker.last_task_time.store(
+        std::chrono::system_clock::now().time_since_epoch().count(),
+        std::memory_order_relaxed);
+    active_threads_--;
+}
+
+// 调用者持有grow_mutex_，或者是还没有其他线程碰线程池的Initialize
+void ThreadPool::StartWorker() {
+    size_t index = worker_count_.load();
+    const std::vector<int>& cpus = config_.cpu_affinity;
+    int cpu = cpus.empty() ? -1 : cpus[index % cpus.size()];
+    workers_[index].thread = std::make_unique<std::thread>([this, index, cpu]() {
+        if (cpu >= 0 && !NumaTopology::PinCurrentThread(cpu)) {
+            std::cerr << "[ThreadPool] Failed to pin worker " << index
+                      << " to cpu " << cpu << std::endl;
+        }
+        WorkerLoop(index);
+    });
+    worker_count_.store(index + 1, std::memory_order_release);
+}
+
+void ThreadPool::MaybeAddWorker() {
+    // 提交路径上不等锁，别人正在加线程就算了
+    std::unique_lock<std::mutex> lock(grow_mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || !running_ ||
+        worker_count_ >= std::min(config_.max_threads, worker_capacity_)) {
+        return;
+    }
+    try {
+        StartWorker();
+    } catch (const std::exception& e) {
+        std::cerr << "[ThreadPool] Failed to add worker thread: " << e.what() << std::endl;
     }
-    
-    stats_.total_execution_time += execution_time;
-    stats_.last_task_time = std::chrono::system_clock::now();
 }
 
-} // namespace SimpleRDBMS
\ No newline at end of file
+} // namespace SimpleRDBMS
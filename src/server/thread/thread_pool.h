@@ -1,7 +1,8 @@
 #pragma once
 
+#include "pool_task.h"
 #include <vector>
-#include <queue>
+#include <deque>
 #include <memory>
 #include <thread>
 #include <mutex>
@@ -11,6 +12,8 @@
 #include <stdexcept>
 #include <atomic>
 #include <chrono>
+#include <tuple>
+#include <type_traits>
 
 namespace SimpleRDBMS {
 
@@ -25,6 +28,12 @@ struct TaskStats {
     std::chrono::system_clock::time_point last_task_time;
 };
 
+// 外部提交的任务分两个队列：交互的（短查询）和批处理的（分析查询）
+enum class TaskPriority {
+    INTERACTIVE = 0,
+    BATCH
+};
+
 // Thread pool configuration
 struct ThreadPoolConfig {
     size_t min_threads = 2;
@@ -32,132 +41,164 @@ struct ThreadPoolConfig {
     size_t max_queue_size = 1000;
     std::chrono::seconds idle_timeout{60};
     bool allow_core_thread_timeout = false;
+    // 为空时不绑核，否则第i个工作线程绑到cpu_affinity[i % size]上
+    std::vector<int> cpu_affinity;
+    // 两个队列都有任务时，每取一个批处理任务之前先取这么多个交互任务
+    size_t interactive_weight = 4;
 };
 
+/**
+ * ThreadPool - work-stealing thread pool
+ *
+ * 设计思路：
+ * - 其他线程提交的任务按优先级进两个有界的无锁MPMC环形队列之一，
+ *   满了抛异常；两个队列按interactive_weight加权轮流取，交互任务
+ *   优先，批处理任务也不会饿死；
+ *   工作线程自己提交的任务放进它自己的双端队列，本线程从尾部取（LIFO，
+ *   缓存还热），空闲的线程从别人的头部偷（FIFO）
+ * - 每个工作线程的双端队列有自己的锁，平时只有它自己在用，偷的时候
+ *   才会碰到争用；队列长度另存一个原子变量，偷之前先看是不是空的
+ * - 任务存成PoolTask，小的可调用对象不分配内存；Submit不返回future，
+ *   不为每个任务创建packaged_task
+ * - 统计按工作线程分开累计，GetStats时再汇总，提交路径上不碰统计
+ * - 没事可做的线程先让出几次CPU再睡在条件变量上；提交者只在有线程
+ *   睡着时才去拿锁唤醒一个，所有线程都在忙时按需加线程，最多max_threads个
+ * - 线程启动后一直保留到Shutdown，空闲的线程睡着不占CPU
+ * - 配置了cpu_affinity时每个线程绑到一个核上，线程执行时分配的
+ *   内存（哈希表、排序缓冲区等）按first-touch落在这个核所在的节点上
+ */
 class ThreadPool {
 public:
     explicit ThreadPool(const ThreadPoolConfig& config = ThreadPoolConfig{});
     ~ThreadPool();
-    
+
     // Lifecycle management
     bool Initialize();
     void Shutdown();
     bool IsRunning() const { return running_; }
-    
+
     // Task submission
+    // 提交不需要结果的任务，队列满或者线程池没有运行时抛出异常
+    template<class F>
+    void Submit(F&& f, TaskPriority priority = TaskPriority::INTERACTIVE) {
+        SubmitTask(PoolTask(std::forward<F>(f)), priority);
+    }
+
     template<class F, class... Args>
-    auto Enqueue(F&& f, Args&&... args) 
-        -> std::future<typename std::result_of<F(Args...)>::type>;
-    
+    auto Enqueue(F&& f, Args&&... args)
+        -> std::future<std::invoke_result_t<F, Args...>>;
+
     // Pool management
+    // 线程只增不减，max_threads不超过构造时的上限
     void SetPoolSize(size_t min_threads, size_t max_threads);
     size_t GetActiveThreads() const { return active_threads_; }
-    size_t GetTotalThreads() const { return worker_threads_.size(); }
+    size_t GetTotalThreads() const { return worker_count_; }
     size_t GetQueueSize() const;
-    
+
     // Statistics
     TaskStats GetStats() const;
     void ResetStats();
-    
+
     // Configuration
+    // max_queue_size只在构造时生效，队列容量不能再改
     void UpdateConfig(const ThreadPoolConfig& config);
     const ThreadPoolConfig& GetConfig() const { return config_; }
-    
+
     // Health monitoring
     bool IsHealthy() const;
     double GetUtilization() const;
 
+    // 外部提交的任务队列：有界MPMC环形队列（Vyukov），每个格子的序号
+    // 说明它是空的还是满的；容量向上取到2的幂
+    class InjectionQueue {
+    public:
+        explicit InjectionQueue(size_t capacity);
+        // 成功时取走task，队列满时task保持不变并返回false
+        bool TryPush(PoolTask& task);
+        bool TryPop(PoolTask* task);
+        size_t ApproxSize() const;
+        size_t Capacity() const { return mask_ + 1; }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            PoolTask task;
+        };
+        std::unique_ptr<Cell[]> cells_;
+        size_t mask_;
+        alignas(64) std::atomic<size_t> enqueue_pos_{0};
+        alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    };
+
 private:
+    struct alignas(64) Worker {
+        std::mutex deque_mutex;
+        std::deque<PoolTask> deque;
+        std::atomic<size_t> deque_size{0};
+        std::unique_ptr<std::thread> thread;
+
+        // 只由这个工作线程写
+        std::atomic<size_t> completed{0};
+        std::atomic<size_t> failed{0};
+        std::atomic<int64_t> execution_us{0};
+        std::atomic<int64_t> last_task_time{0};  // system_clock的tick
+    };
+
+    // 睡眠之前让出CPU的次数
+    static constexpr int IDLE_SPINS = 64;
+    // 睡眠的最长时间，防止漏掉唤醒时一直睡下去
+    static constexpr std::chrono::milliseconds IDLE_WAIT{100};
+
     ThreadPoolConfig config_;
-    
+
     // Thread management
-    std::vector<std::unique_ptr<std::thread>> worker_threads_;
+    std::unique_ptr<Worker[]> workers_;
+    size_t worker_capacity_;
+    std::atomic<size_t> worker_count_{0};
+    std::mutex grow_mutex_;
     std::atomic<size_t> active_threads_;
     std::atomic<bool> running_;
-    
-    // Task queue
-    std::queue<std::function<void()>> task_queue_;
-    mutable std::mutex queue_mutex_;
-    std::condition_variable condition_;
-    
-    // Statistics
-    mutable std::mutex stats_mutex_;
-    TaskStats stats_;
-    
+
+    // Task queues
+    InjectionQueue interactive_queue_;
+    InjectionQueue batch_queue_;
+
+    // Idle workers
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+    std::atomic<size_t> sleepers_{0};
+
+    void SubmitTask(PoolTask task,
+                    TaskPriority priority = TaskPriority::INTERACTIVE);
+
     // Worker thread function
-    void WorkerLoop();
-    
+    void WorkerLoop(size_t index);
+    bool PopLocal(Worker& worker, PoolTask* task);
+    // 按权重从两个外部队列里取，interactive_streak记录连续取了几个交互任务
+    bool PopInjected(size_t* interactive_streak, PoolTask* task);
+    bool Steal(size_t thief, PoolTask* task);
+    bool HasWork() const;
+    void RunTask(Worker& worker, PoolTask& task);
+
     // Thread pool management
-    void AddWorkerThread();
-    void RemoveWorkerThread();
-    bool ShouldAddThread() const;
-    bool ShouldRemoveThread() const;
-    
-    // Statistics helpers
-    void UpdateTaskStats(bool success, std::chrono::milliseconds execution_time);
+    void StartWorker();
+    void MaybeAddWorker();
 };
 
 // Template implementation
 template<class F, class... Args>
-auto ThreadPool::Enqueue(F&& f, Args&&... args) 
-    -> std::future<typename std::result_of<F(Args...)>::type> {
-    
-    using return_type = typename std::result_of<F(Args...)>::type;
-    
-    if (!running_) {
-        throw std::runtime_error("ThreadPool is not running");
-    }
-    
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
-        std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-    );
-    
-    std::future<return_type> result = task->get_future();
-    
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        
-        // Check queue size limit
-        if (task_queue_.size() >= config_.max_queue_size) {
-            throw std::runtime_error("Task queue is full");
-        }
-        
-        task_queue_.emplace([task](){ 
-            auto start_time = std::chrono::high_resolution_clock::now();
-            bool success = true;
-            
-            try {
-                (*task)();
-            } catch (...) {
-                success = false;
-                throw;
-            }
-            
-            auto end_time = std::chrono::high_resolution_clock::now();
-            auto execution_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-                end_time - start_time);
-            
-            // Update stats in the thread pool instance
-            // Note: This requires access to the ThreadPool instance
-            // In practice, you might want to pass a callback or use a different approach
+auto ThreadPool::Enqueue(F&& f, Args&&... args)
+    -> std::future<std::invoke_result_t<F, Args...>> {
+    using return_type = std::invoke_result_t<F, Args...>;
+
+    std::packaged_task<return_type()> task(
+        [f = std::forward<F>(f),
+         args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            return std::apply(std::move(f), std::move(args));
         });
-        
-        // Update pending tasks count
-        {
-            std::lock_guard<std::mutex> stats_lock(stats_mutex_);
-            stats_.total_tasks++;
-            stats_.pending_tasks++;
-        }
-    }
-    
-    condition_.notify_one();
-    
-    // Consider adding more threads if needed
-    if (ShouldAddThread()) {
-        AddWorkerThread();
-    }
-    
+    std::future<return_type> result = task.get_future();
+    SubmitTask(PoolTask(std::move(task)));
     return result;
 }
 
-} // namespace SimpleRDBMS
\ No newline at end of file
+} // namespace SimpleRDBMS
@@ -1,4 +1,5 @@
 #include "worker_thread.h"
+#include "common/numa.h"
 #include <iostream>
 
 namespace SimpleRDBMS {
@@ -125,6 +126,9 @@ std::chrono::milliseconds WorkerThread::GetIdleTime() const {
 }
 
 void WorkerThread::WorkerLoop() {
+    if (!cpu_affinity_.empty() && !NumaTopology::PinCurrentThread(cpu_affinity_)) {
+        std::cerr << "[WorkerThread] Failed to set cpu affinity for " << name_ << std::endl;
+    }
     SetState(WorkerThreadState::IDLE);
     
     while (state_ != WorkerThreadState::STOPPING) {
@@ -7,6 +7,7 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 #include <condition_variable>
 
 namespace SimpleRDBMS {
@@ -47,6 +48,8 @@ public:
     // Task execution
     bool ExecuteTask(TaskFunction task);
     void SetIdleTimeout(std::chrono::seconds timeout) { idle_timeout_ = timeout; }
+    // Restrict the thread to these CPUs; takes effect on the next Start()
+    void SetCpuAffinity(std::vector<int> cpus) { cpu_affinity_ = std::move(cpus); }
     
     // Thread information
     std::string GetName() const { return name_; }
@@ -74,6 +77,7 @@ private:
     
     // Configuration
     std::chrono::seconds idle_timeout_;
+    std::vector<int> cpu_affinity_;
     
     // Statistics
     mutable std::mutex stats_mutex_;
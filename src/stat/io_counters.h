@@ -0,0 +1,35 @@
+/*
+ * 文件: io_counters.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 当前线程的I/O计数，EXPLAIN ANALYZE和慢查询日志用它算一次执行的开销
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace SimpleRDBMS {
+
+/**
+ * 当前线程做过的I/O，只增不减
+ * 在一段执行前后各取一次，差值就是这段执行的开销；
+ * 普通的线程局部变量，记录时不加锁也不做原子操作。
+ * 单独放在这个头文件里，服务器的代码不用引入整个stat.h就能读
+ */
+struct ThreadIOCounters {
+    uint64_t buffer_hits = 0;
+    uint64_t buffer_misses = 0;
+    uint64_t disk_reads = 0;
+    uint64_t lock_waits = 0;
+    double lock_wait_ms = 0.0;
+    uint64_t rows_examined = 0;  // 从表堆读出的行（包括不满足条件的）
+};
+
+/** 当前线程的计数，由Statistics的Record*和表堆的读取路径累加 */
+inline ThreadIOCounters& CurrentThreadIOCounters() {
+    thread_local ThreadIOCounters counters;
+    return counters;
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,333 @@
+/*
+ * 文件: metrics.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 延迟直方图和Prometheus文本格式输出的实现
+ */
+
+#include "stat/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "stat/stat.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+/** 样本值：整数原样输出，其他按%.12g，NaN和无穷大用Prometheus的写法 */
+std::string FormatMetricValue(double value) {
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    if (std::isinf(value)) {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.12g", value);
+    return buffer;
+}
+
+std::string JoinLabels(const std::string& labels, const std::string& extra) {
+    if (labels.empty()) {
+        return extra;
+    }
+    return extra.empty() ? labels : labels + "," + extra;
+}
+
+}  // namespace
+
+// ==================== LatencyHistogram ====================
+
+/**
+ * 桶编号
+ * 小于SUB_BUCKET_COUNT的值直接作编号；其他的值取最高位所在的指数e，
+ * 最高位后面的SUB_BUCKET_BITS位决定是区间[2^e, 2^(e+1))里的第几个子桶
+ */
+size_t LatencyHistogram::BucketIndex(uint64_t micros) {
+    if (micros < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(micros);
+    }
+    size_t exponent = 63 - static_cast<size_t>(__builtin_clzll(micros));
+    if (exponent >= MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+    size_t shift = exponent - SUB_BUCKET_BITS;
+    size_t sub_bucket =
+        static_cast<size_t>(micros >> shift) - SUB_BUCKET_COUNT;
+    return SUB_BUCKET_COUNT + (exponent - SUB_BUCKET_BITS) * SUB_BUCKET_COUNT +
+           sub_bucket;
+}
+
+uint64_t LatencyHistogram::BucketLowest(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    size_t shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT;
+    size_t sub_bucket = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT;
+    return static_cast<uint64_t>(SUB_BUCKET_COUNT + sub_bucket) << shift;
+}
+
+uint64_t LatencyHistogram::BucketHighest(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    size_t shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT;
+    return BucketLowest(index) + (uint64_t{1} << shift) - 1;
+}
+
+void LatencyHistogram::Snapshot::Merge(const Snapshot& other) {
+    for (size_t i = 0; i < buckets.size(); i++) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sum_us += other.sum_us;
+    max_us = std::max(max_us, other.max_us);
+}
+
+/**
+ * 百分位
+ * 排名是percentile% * count四舍五入（和HdrHistogram一样，避免0.999这种
+ * 小数的浮点误差把排名多算一位），从小到大累加桶计数直到够这个排名
+ */
+uint64_t LatencyHistogram::Snapshot::ValueAtPercentile(
+    double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+    double fraction = std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+    uint64_t rank = static_cast<uint64_t>(
+        fraction * static_cast<double>(count) + 0.5);
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(BucketHighest(i), max_us);
+        }
+    }
+    return max_us;
+}
+
+uint64_t LatencyHistogram::Snapshot::CountAtOrBelow(uint64_t micros) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < buckets.size() && BucketLowest(i) <= micros; i++) {
+        total += buckets[i];
+    }
+    return total;
+}
+
+LatencyPercentiles LatencyHistogram::Snapshot::GetPercentiles() const {
+    LatencyPercentiles result;
+    result.count = count;
+    result.p50_ms = ValueAtPercentile(50.0) / 1000.0;
+    result.p95_ms = ValueAtPercentile(95.0) / 1000.0;
+    result.p99_ms = ValueAtPercentile(99.0) / 1000.0;
+    result.p999_ms = ValueAtPercentile(99.9) / 1000.0;
+    result.max_ms = max_us / 1000.0;
+    return result;
+}
+
+void LatencyHistogram::RecordMicros(uint64_t micros) {
+    buckets_[BucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    sum_us_.fetch_add(micros, std::memory_order_relaxed);
+    uint64_t current = max_us_.load(std::memory_order_relaxed);
+    while (micros > current &&
+           !max_us_.compare_exchange_weak(current, micros,
+                                          std::memory_order_relaxed)) {
+        // 自旋直到成功更新
+    }
+}
+
+void LatencyHistogram::Record(double seconds) {
+    RecordMicros(seconds > 0
+                     ? static_cast<uint64_t>(std::llround(seconds * 1e6))
+                     : 0);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const {
+    Snapshot snapshot;
+    for (size_t i = 0; i < buckets_.size(); i++) {
+        snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sum_us = sum_us_.load(std::memory_order_relaxed);
+    snapshot.max_us = max_us_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void LatencyHistogram::Reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sum_us_.store(0, std::memory_order_relaxed);
+    max_us_.store(0, std::memory_order_relaxed);
+}
+
+// ==================== MetricsWriter ====================
+
+void MetricsWriter::AddCounter(const std::string& name,
+                               const std::string& help, double value,
+                               const std::string& labels) {
+    WriteHeader(name, help, "counter");
+    WriteSample(name, labels, value);
+}
+
+void MetricsWriter::AddGauge(const std::string& name, const std::string& help,
+                             double value, const std::string& labels) {
+    WriteHeader(name, help, "gauge");
+    WriteSample(name, labels, value);
+}
+
+/**
+ * 直方图
+ * Prometheus的桶是累积的：le="x"的样本是所有不超过x的次数，
+ * 最后的le="+Inf"等于总次数
+ */
+void MetricsWriter::AddHistogram(const std::string& name,
+                                 const std::string& help,
+                                 const LatencyHistogram::Snapshot& snapshot,
+                                 const std::string& labels) {
+    WriteHeader(name, help, "histogram");
+    for (double bound : LatencyHistogram::EXPORT_BOUNDS) {
+        char bound_text[32];
+        std::snprintf(bound_text, sizeof(bound_text), "%g", bound);
+        uint64_t micros = static_cast<uint64_t>(std::llround(bound * 1e6));
+        WriteSample(name + "_bucket",
+                    JoinLabels(labels, Label("le", bound_text)),
+                    static_cast<double>(snapshot.CountAtOrBelow(micros)));
+    }
+    WriteSample(name + "_bucket", JoinLabels(labels, Label("le", "+Inf")),
+                static_cast<double>(snapshot.count));
+    WriteSample(name + "_sum", labels, snapshot.GetSumSeconds());
+    WriteSample(name + "_count", labels, static_cast<double>(snapshot.count));
+}
+
+std::string MetricsWriter::Label(const std::string& key,
+                                 const std::string& value) {
+    std::string result = key + "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            result += '\\';
+            result += c;
+        } else if (c == '\n') {
+            result += "\\n";
+        } else {
+            result += c;
+        }
+    }
+    result += '"';
+    return result;
+}
+
+void MetricsWriter::WriteHeader(const std::string& name,
+                                const std::string& help, const char* type) {
+    if (!described_.insert(name).second) {
+        return;
+    }
+    text_ += "# HELP " + name + " " + help + "\n";
+    text_ += "# TYPE " + name + " " + type + "\n";
+}
+
+void MetricsWriter::WriteSample(const std::string& name,
+                                const std::string& labels, double value) {
+    text_ += name;
+    if (!labels.empty()) {
+        text_ += "{" + labels + "}";
+    }
+    text_ += " " + FormatMetricValue(value) + "\n";
+}
+
+// ==================== Statistics导出 ====================
+
+void WriteStatisticsMetrics(MetricsWriter* writer) {
+    const Statistics& stats = STATS;
+
+    writer->AddCounter("simpledb_buffer_pool_hits_total",
+                       "Page requests served from the buffer pool.",
+                       stats.GetBufferPoolHits());
+    writer->AddCounter("simpledb_buffer_pool_misses_total",
+                       "Page requests that had to read from disk.",
+                       stats.GetBufferPoolMisses());
+    writer->AddGauge("simpledb_buffer_pool_hit_ratio",
+                     "Buffer pool hits / (hits + misses) since start.",
+                     stats.GetBufferPoolHitRatio() / 100.0);
+    writer->AddCounter("simpledb_buffer_pool_evictions_total",
+                       "Pages evicted from the buffer pool.",
+                       stats.GetPageEvictions());
+
+    writer->AddCounter("simpledb_disk_reads_total", "Page reads from disk.",
+                       stats.GetTotalDiskReads());
+    writer->AddCounter("simpledb_disk_writes_total", "Page writes to disk.",
+                       stats.GetTotalDiskWrites());
+    writer->AddCounter("simpledb_disk_read_bytes_total",
+                       "Bytes read from the data file.",
+                       stats.GetTotalDiskReadBytes());
+    writer->AddCounter("simpledb_disk_written_bytes_total",
+                       "Bytes written to the data file.",
+                       stats.GetTotalDiskWriteBytes());
+    writer->AddHistogram("simpledb_disk_read_seconds",
+                         "Latency of page reads from the data file.",
+                         stats.GetDiskReadHistogram());
+
+    writer->AddCounter("simpledb_log_records_total",
+                       "Log records appended to the WAL.",
+                       stats.GetLogWrites());
+    writer->AddCounter("simpledb_log_bytes_total",
+                       "Bytes appended to the WAL.", stats.GetLogWriteBytes());
+    writer->AddCounter("simpledb_log_flushes_total",
+                       "WAL flushes to stable storage.",
+                       stats.GetLogFlushes());
+    writer->AddHistogram("simpledb_log_flush_seconds",
+                         "Latency of a WAL write plus fsync.",
+                         stats.GetLogFlushHistogram());
+
+    writer->AddCounter("simpledb_lock_waits_total",
+                       "Lock requests that had to wait.",
+                       stats.GetLockWaits());
+    writer->AddHistogram("simpledb_lock_wait_seconds",
+                         "Time spent waiting for a lock.",
+                         stats.GetLockWaitHistogram());
+    writer->AddCounter("simpledb_lock_conflicts_total",
+                       "Lock requests that conflicted with a holder.",
+                       stats.GetLockConflicts());
+    writer->AddCounter("simpledb_deadlocks_total",
+                       "Transactions aborted to break a deadlock.",
+                       stats.GetDeadlocks());
+
+    writer->AddCounter("simpledb_transactions_begun_total",
+                       "Transactions started.", stats.GetTotalTransactions());
+    writer->AddCounter("simpledb_transactions_committed_total",
+                       "Transactions committed.",
+                       stats.GetCommittedTransactions());
+    writer->AddCounter("simpledb_transactions_aborted_total",
+                       "Transactions aborted.",
+                       stats.GetAbortedTransactions());
+    writer->AddHistogram("simpledb_transaction_duration_seconds",
+                         "Transaction duration from begin to commit or abort.",
+                         stats.GetTransactionHistogram());
+
+    // 每类查询一组样本，同名的要写在一起
+    std::vector<std::string> query_types = stats.GetQueryTypes();
+    std::vector<QueryStats> query_stats;
+    query_stats.reserve(query_types.size());
+    for (const auto& query_type : query_types) {
+        query_stats.push_back(stats.GetQueryStats(query_type));
+    }
+    for (size_t i = 0; i < query_types.size(); i++) {
+        writer->AddHistogram("simpledb_query_execution_seconds",
+                             "Statement execution time inside the engine.",
+                             query_stats[i].latency,
+                             MetricsWriter::Label("type", query_types[i]));
+    }
+    for (size_t i = 0; i < query_types.size(); i++) {
+        writer->AddCounter("simpledb_query_tuples_total",
+                           "Tuples returned or modified by statements.",
+                           query_stats[i].total_tuples_processed,
+                           MetricsWriter::Label("type", query_types[i]));
+    }
+}
+
+}  // namespace SimpleRDBMS
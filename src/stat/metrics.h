@@ -0,0 +1,151 @@
+/*
+ * 文件: metrics.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 延迟直方图和Prometheus文本格式的指标输出，给监控系统抓取用
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+
+namespace SimpleRDBMS {
+
+/** 一个直方图的常用百分位，单位毫秒 */
+struct LatencyPercentiles {
+    uint64_t count = 0;
+    double p50_ms = 0.0;
+    double p95_ms = 0.0;
+    double p99_ms = 0.0;
+    double p999_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+/**
+ * LatencyHistogram - 对数线性（HDR风格）的延迟直方图，微秒精度
+ *
+ * 设计思路：
+ * - 平均值看不出长尾，容量规划要看的是p99和p999；按微秒计数，小于
+ *   SUB_BUCKET_COUNT微秒的值每微秒一个桶，之后每个2的幂区间再平均分成
+ *   SUB_BUCKET_COUNT个子桶，相对误差不超过1/SUB_BUCKET_COUNT（约3%），
+ *   一直覆盖到2^MAX_EXPONENT微秒（约19小时），更大的值算在最后一个桶
+ * - 桶的边界固定，不同线程、不同实例的直方图可以直接按桶相加
+ * - 每个桶一个原子计数，记录一次只是几次位运算和一次fetch_add，不加锁；
+ *   一个直方图BUCKET_COUNT个桶，大约8KB
+ * - 百分位取所在桶的最大值（不超过记录过的最大值），不会比真实值小
+ * - 导出成Prometheus格式时按EXPORT_BOUNDS折算成累积计数
+ */
+class LatencyHistogram {
+   public:
+    static constexpr size_t SUB_BUCKET_BITS = 5;
+    static constexpr size_t SUB_BUCKET_COUNT = size_t{1} << SUB_BUCKET_BITS;
+    static constexpr size_t MAX_EXPONENT = 36;
+    static constexpr size_t BUCKET_COUNT =
+        SUB_BUCKET_COUNT + (MAX_EXPONENT - SUB_BUCKET_BITS) * SUB_BUCKET_COUNT;
+
+    /** 导出时用的桶上界，单位秒，和Prometheus的le标签一致 */
+    static constexpr size_t EXPORT_BOUND_COUNT = 16;
+    static constexpr std::array<double, EXPORT_BOUND_COUNT> EXPORT_BOUNDS = {
+        0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+        0.05,   0.1,     0.25,   0.5,   1.0,    2.5,   5.0,  10.0};
+
+    /** 微秒值所在的桶 */
+    static size_t BucketIndex(uint64_t micros);
+    /** 桶能表示的最小值和最大值（都包含），单位微秒 */
+    static uint64_t BucketLowest(size_t index);
+    static uint64_t BucketHighest(size_t index);
+
+    /** 某一时刻的直方图，buckets[i]是落在第i个桶的次数 */
+    struct Snapshot {
+        std::array<uint64_t, BUCKET_COUNT> buckets{};
+        uint64_t count = 0;
+        uint64_t sum_us = 0;
+        uint64_t max_us = 0;
+
+        void Merge(const Snapshot& other);
+
+        /**
+         * 百分位对应的值，单位微秒
+         * @param percentile 0到100之间，比如99.9
+         * @return 没有记录时返回0
+         */
+        uint64_t ValueAtPercentile(double percentile) const;
+
+        /** 不超过micros的记录数，误差不超过一个子桶 */
+        uint64_t CountAtOrBelow(uint64_t micros) const;
+
+        LatencyPercentiles GetPercentiles() const;
+        double GetSumSeconds() const { return sum_us / 1e6; }
+    };
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /** 记录一次耗时，单位微秒 */
+    void RecordMicros(uint64_t micros);
+
+    /** 记录一次耗时，单位秒 */
+    void Record(double seconds);
+
+    /** 记录一次耗时，单位毫秒，给已经按毫秒计时的调用方用 */
+    void RecordMs(double milliseconds) { Record(milliseconds / 1000.0); }
+
+    Snapshot GetSnapshot() const;
+
+    void Reset();
+
+   private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> sum_us_{0};
+    std::atomic<uint64_t> max_us_{0};
+};
+
+/**
+ * MetricsWriter - 按Prometheus文本格式（version 0.0.4）拼接指标
+ *
+ * 同名的样本要连在一起写，HELP和TYPE只在第一次出现时输出；
+ * 标签用Label拼好后传进来，多个标签之间用逗号分隔
+ */
+class MetricsWriter {
+   public:
+    /** HTTP响应里的Content-Type */
+    static constexpr const char* CONTENT_TYPE =
+        "text/plain; version=0.0.4; charset=utf-8";
+
+    void AddCounter(const std::string& name, const std::string& help,
+                    double value, const std::string& labels = "");
+    void AddGauge(const std::string& name, const std::string& help,
+                  double value, const std::string& labels = "");
+    /** 输出name_bucket、name_sum和name_count三组样本 */
+    void AddHistogram(const std::string& name, const std::string& help,
+                      const LatencyHistogram::Snapshot& snapshot,
+                      const std::string& labels = "");
+
+    /** 拼一个key="value"标签，值里的反斜杠、引号和换行会被转义 */
+    static std::string Label(const std::string& key, const std::string& value);
+
+    const std::string& GetText() const { return text_; }
+
+   private:
+    void WriteHeader(const std::string& name, const std::string& help,
+                     const char* type);
+    void WriteSample(const std::string& name, const std::string& labels,
+                     double value);
+
+    std::string text_;
+    std::unordered_set<std::string> described_;
+};
+
+/**
+ * 把Statistics里的计数和直方图写成指标：缓冲池、磁盘、日志、锁、事务
+ * 和各类查询的执行耗时，名字都以simpledb_开头
+ */
+void WriteStatisticsMetrics(MetricsWriter* writer);
+
+}  // namespace SimpleRDBMS
@@ -5,85 +5,222 @@
 
 namespace SimpleRDBMS {
 
+// ==================== 分片计数器 ====================
+
+/**
+ * 取当前线程的分片
+ * 线程局部的holder在线程退出时把分片还回去；单例是函数内的静态对象，
+ * 主线程的thread_local先于它析构，所以这里访问单例是安全的
+ */
+Statistics::ThreadShard& Statistics::GetThreadShard() {
+    struct Holder {
+        ThreadShard* shard = nullptr;
+        ~Holder() {
+            if (shard) {
+                Statistics::GetInstance().ReleaseThreadShard(shard);
+            }
+        }
+    };
+    thread_local Holder holder;
+    if (holder.shard == nullptr) {
+        std::lock_guard<std::mutex> lock(shards_mutex_);
+        if (!free_shards_.empty()) {
+            holder.shard = free_shards_.back();
+            free_shards_.pop_back();
+        } else {
+            shards_.push_back(std::make_unique<ThreadShard>());
+            holder.shard = shards_.back().get();
+        }
+    }
+    return *holder.shard;
+}
+
+void Statistics::ReleaseThreadShard(ThreadShard* shard) {
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    free_shards_.push_back(shard);
+}
+
+uint32_t Statistics::InternName(NameRegistry* registry,
+                                const std::string& name) {
+    auto it = registry->ids.find(name);
+    if (it != registry->ids.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(registry->names.size());
+    registry->ids.emplace(name, id);
+    registry->names.push_back(name);
+    return id;
+}
+
+/**
+ * 索引名到编号
+ * 先查本线程的缓存，不命中才加锁查全局的映射，
+ * 同时为新索引准备好节点数、树高这些值的存放位置
+ */
+uint32_t Statistics::GetIndexStatId(const std::string& index_name) {
+    thread_local std::unordered_map<std::string, uint32_t> cache;
+    auto it = cache.find(index_name);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = InternName(&index_names_, index_name);
+        while (btree_gauges_.size() <= id) {
+            btree_gauges_.push_back(std::make_unique<BTreeStats>());
+        }
+    }
+    cache.emplace(index_name, id);
+    return id;
+}
+
+uint32_t Statistics::GetQueryTypeId(const std::string& query_type) {
+    thread_local std::unordered_map<std::string, uint32_t> cache;
+    auto it = cache.find(query_type);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = InternName(&query_types_, query_type);
+    }
+    cache.emplace(query_type, id);
+    return id;
+}
+
+void Statistics::SumBTreeCounters(uint32_t index_id, BTreeStats* stats) const {
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    for (const auto& shard : shards_) {
+        const BTreeCounterSlot* slot = shard->btree.Find(index_id);
+        if (slot == nullptr) {
+            continue;
+        }
+        stats->splits += slot->splits.load(std::memory_order_relaxed);
+        stats->merges += slot->merges.load(std::memory_order_relaxed);
+        stats->insertions += slot->insertions.load(std::memory_order_relaxed);
+        stats->deletions += slot->deletions.load(std::memory_order_relaxed);
+        stats->searches += slot->searches.load(std::memory_order_relaxed);
+    }
+}
+
+QueryStats Statistics::SumQueryCounters(uint32_t type_id) const {
+    QueryStats stats;
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    for (const auto& shard : shards_) {
+        const QueryCounterSlot* slot = shard->query.Find(type_id);
+        if (slot == nullptr) {
+            continue;
+        }
+        stats.count += slot->count.load(std::memory_order_relaxed);
+        stats.total_time_ms +=
+            slot->total_time_ms.load(std::memory_order_relaxed);
+        stats.min_time_ms = std::min(
+            stats.min_time_ms, slot->min_time_ms.load(std::memory_order_relaxed));
+        stats.max_time_ms = std::max(
+            stats.max_time_ms, slot->max_time_ms.load(std::memory_order_relaxed));
+        stats.total_tuples_processed +=
+            slot->total_tuples_processed.load(std::memory_order_relaxed);
+        const LatencyHistogram* latency =
+            slot->latency.load(std::memory_order_acquire);
+        if (latency != nullptr) {
+            stats.latency.Merge(latency->GetSnapshot());
+        }
+    }
+    return stats;
+}
+
 // ==================== B+树统计 ====================
 
 void Statistics::RecordBTreeSplit(const std::string& index_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (btree_stats_.find(index_name) == btree_stats_.end()) {
-        btree_stats_[index_name] = std::make_unique<BTreeStats>();
-    }
-    btree_stats_[index_name]->splits.fetch_add(1);
+    RecordBTreeSplit(GetIndexStatId(index_name));
     LOG_DEBUG("Statistics: Recorded B+Tree split for index " << index_name);
 }
 
 void Statistics::RecordBTreeMerge(const std::string& index_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (btree_stats_.find(index_name) == btree_stats_.end()) {
-        btree_stats_[index_name] = std::make_unique<BTreeStats>();
-    }
-    btree_stats_[index_name]->merges.fetch_add(1);
+    RecordBTreeMerge(GetIndexStatId(index_name));
     LOG_DEBUG("Statistics: Recorded B+Tree merge for index " << index_name);
 }
 
 void Statistics::RecordBTreeInsertion(const std::string& index_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (btree_stats_.find(index_name) == btree_stats_.end()) {
-        btree_stats_[index_name] = std::make_unique<BTreeStats>();
-    }
-    btree_stats_[index_name]->insertions.fetch_add(1);
+    RecordBTreeInsertion(GetIndexStatId(index_name));
 }
 
 void Statistics::RecordBTreeDeletion(const std::string& index_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (btree_stats_.find(index_name) == btree_stats_.end()) {
-        btree_stats_[index_name] = std::make_unique<BTreeStats>();
-    }
-    btree_stats_[index_name]->deletions.fetch_add(1);
+    RecordBTreeDeletion(GetIndexStatId(index_name));
 }
 
 void Statistics::RecordBTreeSearch(const std::string& index_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (btree_stats_.find(index_name) == btree_stats_.end()) {
-        btree_stats_[index_name] = std::make_unique<BTreeStats>();
+    RecordBTreeSearch(GetIndexStatId(index_name));
+}
+
+// 按编号记录：只碰本线程的分片，计数只有本线程写，用relaxed就够了
+void Statistics::RecordBTreeSplit(uint32_t index_id) {
+    if (BTreeCounterSlot* slot = GetThreadShard().btree.Get(index_id)) {
+        slot->splits.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Statistics::RecordBTreeMerge(uint32_t index_id) {
+    if (BTreeCounterSlot* slot = GetThreadShard().btree.Get(index_id)) {
+        slot->merges.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Statistics::RecordBTreeInsertion(uint32_t index_id) {
+    if (BTreeCounterSlot* slot = GetThreadShard().btree.Get(index_id)) {
+        slot->insertions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Statistics::RecordBTreeDeletion(uint32_t index_id) {
+    if (BTreeCounterSlot* slot = GetThreadShard().btree.Get(index_id)) {
+        slot->deletions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Statistics::RecordBTreeSearch(uint32_t index_id) {
+    if (BTreeCounterSlot* slot = GetThreadShard().btree.Get(index_id)) {
+        slot->searches.fetch_add(1, std::memory_order_relaxed);
     }
-    btree_stats_[index_name]->searches.fetch_add(1);
 }
 
 void Statistics::UpdateBTreeNodeCount(const std::string& index_name,
                                       int node_count) {
+    uint32_t id = GetIndexStatId(index_name);
     std::lock_guard<std::mutex> lock(mutex_);
-    if (btree_stats_.find(index_name) == btree_stats_.end()) {
-        btree_stats_[index_name] = std::make_unique<BTreeStats>();
-    }
-    btree_stats_[index_name]->node_count.store(node_count);
+    btree_gauges_[id]->node_count.store(node_count);
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
                    std::chrono::system_clock::now().time_since_epoch())
                    .count();
-    btree_stats_[index_name]->last_updated.store(now);
+    btree_gauges_[id]->last_updated.store(now);
 }
 
 void Statistics::UpdateBTreeHeight(const std::string& index_name, int height) {
+    uint32_t id = GetIndexStatId(index_name);
     std::lock_guard<std::mutex> lock(mutex_);
-    if (btree_stats_.find(index_name) == btree_stats_.end()) {
-        btree_stats_[index_name] = std::make_unique<BTreeStats>();
-    }
-    btree_stats_[index_name]->height.store(height);
+    btree_gauges_[id]->height.store(height);
 }
 
 void Statistics::UpdateBTreeFillFactor(const std::string& index_name,
                                        double fill_factor) {
+    uint32_t id = GetIndexStatId(index_name);
     std::lock_guard<std::mutex> lock(mutex_);
-    if (btree_stats_.find(index_name) == btree_stats_.end()) {
-        btree_stats_[index_name] = std::make_unique<BTreeStats>();
-    }
-    btree_stats_[index_name]->fill_factor.store(fill_factor);
+    btree_gauges_[id]->fill_factor.store(fill_factor);
 }
 
 // ==================== 缓存统计 ====================
 
-void Statistics::RecordBufferPoolHit() { buffer_pool_hits_.fetch_add(1); }
+void Statistics::RecordBufferPoolHit() {
+    buffer_pool_hits_.fetch_add(1);
+    CurrentThreadIOCounters().buffer_hits++;
+}
 
-void Statistics::RecordBufferPoolMiss() { buffer_pool_misses_.fetch_add(1); }
+void Statistics::RecordBufferPoolMiss() {
+    buffer_pool_misses_.fetch_add(1);
+    CurrentThreadIOCounters().buffer_misses++;
+}
 
 void Statistics::UpdateBufferPoolSize(int size) {
     buffer_pool_size_.store(size);
@@ -100,6 +237,12 @@ void Statistics::RecordPageUnpin() { page_unpins_.fetch_add(1); }
 void Statistics::RecordDiskRead(size_t bytes) {
     disk_reads_.fetch_add(1);
     disk_read_bytes_.fetch_add(bytes);
+    CurrentThreadIOCounters().disk_reads++;
+}
+
+void Statistics::RecordDiskRead(size_t bytes, double latency_ms) {
+    RecordDiskRead(bytes);
+    disk_read_histogram_.RecordMs(latency_ms);
 }
 
 void Statistics::RecordDiskWrite(size_t bytes) {
@@ -122,6 +265,7 @@ void Statistics::RecordTransactionCommit() {
 void Statistics::RecordTransactionAbort() { transaction_aborts_.fetch_add(1); }
 
 void Statistics::RecordTransactionDuration(double duration_ms) {
+    transaction_histogram_.RecordMs(duration_ms);
     double current_total = total_transaction_time_ms_.load();
     while (!total_transaction_time_ms_.compare_exchange_weak(
         current_total, current_total + duration_ms)) {
@@ -131,17 +275,35 @@ void Statistics::RecordTransactionDuration(double duration_ms) {
 
 // ==================== 查询统计 ====================
 
+/**
+ * 记录一次查询
+ * 槽位只有本线程写，浮点数和最值直接读出来改完再写回，不需要CAS
+ */
 void Statistics::RecordQueryExecution(const std::string& query_type,
                                       double execution_time_ms,
                                       uint64_t tuples_processed) {
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    QueryStats& stats = query_stats_[query_type];
-    stats.count++;
-    stats.total_time_ms += execution_time_ms;
-    stats.min_time_ms = std::min(stats.min_time_ms, execution_time_ms);
-    stats.max_time_ms = std::max(stats.max_time_ms, execution_time_ms);
-    stats.total_tuples_processed += tuples_processed;
+    QueryCounterSlot* slot =
+        GetThreadShard().query.Get(GetQueryTypeId(query_type));
+    if (slot == nullptr) {
+        return;
+    }
+    constexpr auto relaxed = std::memory_order_relaxed;
+    slot->count.fetch_add(1, relaxed);
+    slot->total_time_ms.store(
+        slot->total_time_ms.load(relaxed) + execution_time_ms, relaxed);
+    if (execution_time_ms < slot->min_time_ms.load(relaxed)) {
+        slot->min_time_ms.store(execution_time_ms, relaxed);
+    }
+    if (execution_time_ms > slot->max_time_ms.load(relaxed)) {
+        slot->max_time_ms.store(execution_time_ms, relaxed);
+    }
+    slot->total_tuples_processed.fetch_add(tuples_processed, relaxed);
+    LatencyHistogram* latency = slot->latency.load(relaxed);
+    if (latency == nullptr) {
+        latency = new LatencyHistogram();
+        slot->latency.store(latency, std::memory_order_release);
+    }
+    latency->RecordMs(execution_time_ms);
 
     LOG_DEBUG("Statistics: Recorded "
               << query_type << " query execution: " << execution_time_ms
@@ -157,6 +319,10 @@ void Statistics::RecordLockAcquisition(const std::string& lock_type) {
 
 void Statistics::RecordLockWait(double wait_time_ms) {
     lock_waits_.fetch_add(1);
+    lock_wait_histogram_.RecordMs(wait_time_ms);
+    ThreadIOCounters& counters = CurrentThreadIOCounters();
+    counters.lock_waits++;
+    counters.lock_wait_ms += wait_time_ms;
     double current_total = total_lock_wait_time_ms_.load();
     while (!total_lock_wait_time_ms_.compare_exchange_weak(
         current_total, current_total + wait_time_ms)) {
@@ -175,7 +341,10 @@ void Statistics::RecordLogWrite(size_t bytes) {
     log_write_bytes_.fetch_add(bytes);
 }
 
-void Statistics::RecordLogFlush() { log_flushes_.fetch_add(1); }
+void Statistics::RecordLogFlush(double flush_time_ms) {
+    log_flushes_.fetch_add(1);
+    log_flush_histogram_.RecordMs(flush_time_ms);
+}
 
 void Statistics::RecordLogTruncation() { log_truncations_.fetch_add(1); }
 
@@ -206,21 +375,37 @@ double Statistics::GetBufferPoolHitRatio() const {
 }
 
 BTreeStats Statistics::GetBTreeStats(const std::string& index_name) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = btree_stats_.find(index_name);
-    if (it != btree_stats_.end()) {
-        return *(it->second);
+    uint32_t id;
+    BTreeStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_names_.ids.find(index_name);
+        if (it == index_names_.ids.end()) {
+            return BTreeStats();  // 返回默认构造的统计信息
+        }
+        id = it->second;
+        stats = *btree_gauges_[id];
     }
-    return BTreeStats();  // 返回默认构造的统计信息
+    SumBTreeCounters(id, &stats);
+    return stats;
 }
 
 QueryStats Statistics::GetQueryStats(const std::string& query_type) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = query_stats_.find(query_type);
-    if (it != query_stats_.end()) {
-        return it->second;
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = query_types_.ids.find(query_type);
+        if (it == query_types_.ids.end()) {
+            return QueryStats();  // 返回默认构造的统计信息
+        }
+        id = it->second;
     }
-    return QueryStats();  // 返回默认构造的统计信息
+    return SumQueryCounters(id);
+}
+
+std::vector<std::string> Statistics::GetQueryTypes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return query_types_.names;
 }
 
 double Statistics::GetTransactionSuccessRate() const {
@@ -246,35 +431,40 @@ void Statistics::PrintBTreeStatistics() const {
     std::cout << " B+树索引统计信息" << std::endl;
     std::cout << std::string(65, '-') << std::endl;
 
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (btree_stats_.empty()) {
+    std::vector<std::string> index_names;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        index_names = index_names_.names;
+    }
+    if (index_names.empty()) {
         std::cout << "  暂无B+树统计数据" << std::endl;
         return;
     }
 
-    for (const auto& [index_name, stats] : btree_stats_) {
+    for (const auto& index_name : index_names) {
+        BTreeStats stats = GetBTreeStats(index_name);
         std::cout << std::endl;
         std::cout << "  索引名称: " << index_name << std::endl;
-        std::cout << "    |-- 树高度: " << stats->height.load() << " 层"
+        std::cout << "    |-- 树高度: " << stats.height.load() << " 层"
                   << std::endl;
         std::cout << "    |-- 节点数: "
-                  << FormatNumber(stats->node_count.load()) << " 个"
+                  << FormatNumber(stats.node_count.load()) << " 个"
                   << std::endl;
         std::cout << "    |-- 填充率: "
-                  << FormatPercentage(stats->fill_factor.load()) << std::endl;
+                  << FormatPercentage(stats.fill_factor.load()) << std::endl;
         std::cout << "    |-- 操作统计:" << std::endl;
         std::cout << "        |-- 插入操作: "
-                  << FormatNumber(stats->insertions.load()) << " 次"
+                  << FormatNumber(stats.insertions.load()) << " 次"
                   << std::endl;
         std::cout << "        |-- 删除操作: "
-                  << FormatNumber(stats->deletions.load()) << " 次"
+                  << FormatNumber(stats.deletions.load()) << " 次"
                   << std::endl;
         std::cout << "        |-- 查找操作: "
-                  << FormatNumber(stats->searches.load()) << " 次" << std::endl;
+                  << FormatNumber(stats.searches.load()) << " 次" << std::endl;
         std::cout << "        |-- 节点分裂: "
-                  << FormatNumber(stats->splits.load()) << " 次" << std::endl;
+                  << FormatNumber(stats.splits.load()) << " 次" << std::endl;
         std::cout << "        |-- 节点合并: "
-                  << FormatNumber(stats->merges.load()) << " 次" << std::endl;
+                  << FormatNumber(stats.merges.load()) << " 次" << std::endl;
     }
 }
 
@@ -325,6 +515,10 @@ void Statistics::PrintDiskStatistics() const {
     std::cout << "  I/O操作统计:" << std::endl;
     std::cout << "    |-- 磁盘读取: " << FormatNumber(reads) << " 次 ("
               << FormatBytes(read_bytes) << ")" << std::endl;
+    LatencyPercentiles read_latency = GetDiskReadPercentiles();
+    if (read_latency.count > 0) {
+        PrintPercentiles(read_latency);
+    }
     std::cout << "    |-- 磁盘写入: " << FormatNumber(writes) << " 次 ("
               << FormatBytes(write_bytes) << ")" << std::endl;
     std::cout << "    |-- 总I/O操作: " << FormatNumber(reads + writes) << " 次"
@@ -380,13 +574,21 @@ void Statistics::PrintQueryStatistics() const {
     std::cout << " 查询统计信息" << std::endl;
     std::cout << std::string(65, '-') << std::endl;
 
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (query_stats_.empty()) {
+    std::vector<std::string> query_types;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        query_types = query_types_.names;
+    }
+    if (query_types.empty()) {
         std::cout << "  暂无查询统计数据" << std::endl;
         return;
     }
 
-    for (const auto& [query_type, stats] : query_stats_) {
+    for (const auto& query_type : query_types) {
+        QueryStats stats = GetQueryStats(query_type);
+        if (stats.count == 0) {
+            continue;
+        }
         std::cout << std::endl;
         std::cout << "  查询类型: " << query_type << std::endl;
         std::cout << "    |-- 执行次数: " << FormatNumber(stats.count) << " 次"
@@ -402,6 +604,7 @@ void Statistics::PrintQueryStatistics() const {
                       << std::endl;
             std::cout << "    |-- 最长时间: " << FormatTime(stats.max_time_ms)
                       << std::endl;
+            PrintPercentiles(stats.latency.GetPercentiles());
         }
 
         if (stats.total_tuples_processed > 0) {
@@ -437,6 +640,7 @@ void Statistics::PrintLockStatistics() const {
     if (waits > 0) {
         std::cout << "    |-- 平均等待时间: "
                   << FormatTime(total_wait_time / waits) << std::endl;
+        PrintPercentiles(GetLockWaitPercentiles());
     }
     std::cout << std::endl;
     std::cout << "  冲突统计:" << std::endl;
@@ -472,6 +676,9 @@ void Statistics::PrintLogStatistics() const {
               << FormatBytes(write_bytes) << ")" << std::endl;
     std::cout << "    |-- 日志刷盘: " << FormatNumber(flushes) << " 次"
               << std::endl;
+    if (flushes > 0) {
+        PrintPercentiles(GetLogFlushPercentiles());
+    }
     std::cout << "    |-- 日志截断: " << FormatNumber(truncations) << " 次"
               << std::endl;
 
@@ -502,14 +709,17 @@ void Statistics::Reset() {
     disk_write_bytes_.store(0);
     page_allocations_.store(0);
     page_deallocations_.store(0);
+    disk_read_histogram_.Reset();
 
     transaction_begins_.store(0);
     transaction_commits_.store(0);
     transaction_aborts_.store(0);
     total_transaction_time_ms_.store(0.0);
+    transaction_histogram_.Reset();
 
     lock_waits_.store(0);
     total_lock_wait_time_ms_.store(0.0);
+    lock_wait_histogram_.Reset();
     lock_conflicts_.store(0);
     deadlocks_.store(0);
 
@@ -517,14 +727,39 @@ void Statistics::Reset() {
     log_write_bytes_.store(0);
     log_flushes_.store(0);
     log_truncations_.store(0);
+    log_flush_histogram_.Reset();
 
     index_creations_.store(0);
     index_drops_.store(0);
     index_rebuilds_.store(0);
 
-    // 清空容器
-    btree_stats_.clear();
-    query_stats_.clear();
+    // 名字和编号的映射保留（各线程缓存着编号），只把数清零
+    for (auto& gauges : btree_gauges_) {
+        *gauges = BTreeStats();
+    }
+    {
+        std::lock_guard<std::mutex> shards_lock(shards_mutex_);
+        for (auto& shard : shards_) {
+            shard->btree.ForEach([](BTreeCounterSlot& slot) {
+                slot.splits.store(0);
+                slot.merges.store(0);
+                slot.insertions.store(0);
+                slot.deletions.store(0);
+                slot.searches.store(0);
+            });
+            shard->query.ForEach([](QueryCounterSlot& slot) {
+                slot.count.store(0);
+                slot.total_time_ms.store(0.0);
+                slot.min_time_ms.store(std::numeric_limits<double>::max());
+                slot.max_time_ms.store(0.0);
+                slot.total_tuples_processed.store(0);
+                LatencyHistogram* latency = slot.latency.load();
+                if (latency != nullptr) {
+                    latency->Reset();
+                }
+            });
+        }
+    }
     lock_acquisitions_.clear();
 
     LOG_INFO("Statistics: All statistics have been reset");
@@ -575,4 +810,11 @@ std::string Statistics::FormatTime(double time_ms) const {
     }
 }
 
+void Statistics::PrintPercentiles(const LatencyPercentiles& percentiles) const {
+    std::cout << "    |-- p50/p95/p99/p999: " << FormatTime(percentiles.p50_ms)
+              << " / " << FormatTime(percentiles.p95_ms) << " / "
+              << FormatTime(percentiles.p99_ms) << " / "
+              << FormatTime(percentiles.p999_ms) << std::endl;
+}
+
 }  // namespace SimpleRDBMS
\ No newline at end of file
@@ -4,13 +4,18 @@
 #include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <limits>
 #include <unordered_map>
+#include <vector>
 
 #include "common/config.h"
 #include "common/debug.h"
+#include "stat/io_counters.h"
+#include "stat/metrics.h"
 
 namespace SimpleRDBMS {
 
@@ -59,12 +64,109 @@ struct BTreeStats {
 };
 
 // 查询统计信息结构
+// 平均值看不出长尾，百分位从latency里取：latency.GetPercentiles()
 struct QueryStats {
     uint64_t count = 0;
     double total_time_ms = 0.0;
     double min_time_ms = std::numeric_limits<double>::max();
     double max_time_ms = 0.0;
     uint64_t total_tuples_processed = 0;
+    LatencyHistogram::Snapshot latency;  // 执行耗时的分布
+};
+
+/**
+ * 热点计数器的分片
+ *
+ * 设计思路：
+ * - 索引名和查询类型第一次出现时分配一个编号，每个线程缓存名字到编号的
+ *   映射，之后记录一次只是在本线程的分片里按编号加一，不加锁，也不和
+ *   其他线程抢同一个缓存行
+ * - 每个线程一个分片，读统计时才把所有分片加起来
+ * - 分片里的槽位按块分配，块指针只增不减，读者不加锁也能安全地遍历
+ * - 线程退出时分片还回空闲列表给后来的线程复用，已经记下的数不会丢
+ */
+struct BTreeCounterSlot {
+    std::atomic<uint64_t> splits{0};
+    std::atomic<uint64_t> merges{0};
+    std::atomic<uint64_t> insertions{0};
+    std::atomic<uint64_t> deletions{0};
+    std::atomic<uint64_t> searches{0};
+};
+
+struct QueryCounterSlot {
+    std::atomic<uint64_t> count{0};
+    std::atomic<double> total_time_ms{0.0};
+    std::atomic<double> min_time_ms{std::numeric_limits<double>::max()};
+    std::atomic<double> max_time_ms{0.0};
+    std::atomic<uint64_t> total_tuples_processed{0};
+    // 执行耗时的直方图，有8KB，本线程第一次记录这类查询时才分配
+    std::atomic<LatencyHistogram*> latency{nullptr};
+
+    QueryCounterSlot() = default;
+    ~QueryCounterSlot() { delete latency.load(std::memory_order_relaxed); }
+};
+
+/**
+ * 按编号索引的槽位表，只有所属线程写入（分配块和累加），任意线程可以读
+ */
+template <typename Slot>
+class CounterSlotTable {
+   public:
+    static constexpr size_t CHUNK_SIZE = 64;
+    static constexpr size_t MAX_CHUNKS = 1024;
+
+    CounterSlotTable() {
+        for (auto& chunk : chunks_) {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    ~CounterSlotTable() {
+        for (auto& chunk : chunks_) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+    CounterSlotTable(const CounterSlotTable&) = delete;
+    CounterSlotTable& operator=(const CounterSlotTable&) = delete;
+
+    /** 所属线程使用，块不存在时分配，编号超出范围返回nullptr */
+    Slot* Get(uint32_t id) {
+        size_t chunk_index = id / CHUNK_SIZE;
+        if (chunk_index >= MAX_CHUNKS) {
+            return nullptr;
+        }
+        Slot* chunk = chunks_[chunk_index].load(std::memory_order_acquire);
+        if (chunk == nullptr) {
+            chunk = new Slot[CHUNK_SIZE];
+            chunks_[chunk_index].store(chunk, std::memory_order_release);
+        }
+        return &chunk[id % CHUNK_SIZE];
+    }
+
+    /** 读者使用，槽位还没分配时返回nullptr */
+    const Slot* Find(uint32_t id) const {
+        size_t chunk_index = id / CHUNK_SIZE;
+        if (chunk_index >= MAX_CHUNKS) {
+            return nullptr;
+        }
+        Slot* chunk = chunks_[chunk_index].load(std::memory_order_acquire);
+        return chunk ? &chunk[id % CHUNK_SIZE] : nullptr;
+    }
+
+    /** 把所有已分配的槽位交给fn，Reset时用来清零 */
+    template <typename Fn>
+    void ForEach(Fn&& fn) {
+        for (auto& chunk_ptr : chunks_) {
+            Slot* chunk = chunk_ptr.load(std::memory_order_acquire);
+            if (chunk) {
+                for (size_t i = 0; i < CHUNK_SIZE; i++) {
+                    fn(chunk[i]);
+                }
+            }
+        }
+    }
+
+   private:
+    std::atomic<Slot*> chunks_[MAX_CHUNKS];
 };
 
 class Statistics {
@@ -81,11 +183,20 @@ class Statistics {
 
     // ==================== B+树统计 ====================
 
+    // 索引名对应的统计编号，第一次出现时分配；调用方可以缓存编号，
+    // 直接用下面按编号记录的版本，连本线程的名字查找也省掉
+    uint32_t GetIndexStatId(const std::string& index_name);
+
     void RecordBTreeSplit(const std::string& index_name);
     void RecordBTreeMerge(const std::string& index_name);
     void RecordBTreeInsertion(const std::string& index_name);
     void RecordBTreeDeletion(const std::string& index_name);
     void RecordBTreeSearch(const std::string& index_name);
+    void RecordBTreeSplit(uint32_t index_id);
+    void RecordBTreeMerge(uint32_t index_id);
+    void RecordBTreeInsertion(uint32_t index_id);
+    void RecordBTreeDeletion(uint32_t index_id);
+    void RecordBTreeSearch(uint32_t index_id);
     void UpdateBTreeNodeCount(const std::string& index_name, int node_count);
     void UpdateBTreeHeight(const std::string& index_name, int height);
     void UpdateBTreeFillFactor(const std::string& index_name,
@@ -103,6 +214,8 @@ class Statistics {
     // ==================== 磁盘统计 ====================
 
     void RecordDiskRead(size_t bytes = PAGE_SIZE);
+    // 带耗时的版本，耗时进磁盘读延迟的直方图
+    void RecordDiskRead(size_t bytes, double latency_ms);
     void RecordDiskWrite(size_t bytes = PAGE_SIZE);
     void RecordPageAllocation();
     void RecordPageDeallocation();
@@ -130,7 +243,7 @@ class Statistics {
     // ==================== 日志统计 ====================
 
     void RecordLogWrite(size_t bytes);
-    void RecordLogFlush();
+    void RecordLogFlush(double flush_time_ms);
     void RecordLogTruncation();
 
     // ==================== 索引统计 ====================
@@ -139,6 +252,16 @@ class Statistics {
     void RecordIndexDrop(const std::string& index_name);
     void RecordIndexRebuild(const std::string& index_name);
 
+    /** 当前线程的I/O计数，见ThreadIOCounters */
+    static const ThreadIOCounters& GetThreadIOCounters() {
+        return CurrentThreadIOCounters();
+    }
+
+    /** 当前线程从表堆读了rows行，只记在线程的计数里 */
+    static void RecordRowsExamined(uint64_t rows = 1) {
+        CurrentThreadIOCounters().rows_examined += rows;
+    }
+
     // ==================== 获取统计信息 ====================
 
     // 获取缓存命中率
@@ -166,6 +289,49 @@ class Statistics {
     }
     double GetTransactionSuccessRate() const;
 
+    // 给指标输出用的原始计数
+    uint64_t GetBufferPoolHits() const { return buffer_pool_hits_.load(); }
+    uint64_t GetBufferPoolMisses() const { return buffer_pool_misses_.load(); }
+    uint64_t GetPageEvictions() const { return page_evictions_.load(); }
+    uint64_t GetLogWrites() const { return log_writes_.load(); }
+    uint64_t GetLogWriteBytes() const { return log_write_bytes_.load(); }
+    uint64_t GetLogFlushes() const { return log_flushes_.load(); }
+    uint64_t GetLockWaits() const { return lock_waits_.load(); }
+    uint64_t GetLockConflicts() const { return lock_conflicts_.load(); }
+    uint64_t GetDeadlocks() const { return deadlocks_.load(); }
+
+    // 延迟分布：锁等待、事务耗时、日志刷盘和磁盘读
+    LatencyHistogram::Snapshot GetLockWaitHistogram() const {
+        return lock_wait_histogram_.GetSnapshot();
+    }
+    LatencyHistogram::Snapshot GetTransactionHistogram() const {
+        return transaction_histogram_.GetSnapshot();
+    }
+    LatencyHistogram::Snapshot GetLogFlushHistogram() const {
+        return log_flush_histogram_.GetSnapshot();
+    }
+    LatencyHistogram::Snapshot GetDiskReadHistogram() const {
+        return disk_read_histogram_.GetSnapshot();
+    }
+
+    // p50/p95/p99/p999，单位毫秒
+    LatencyPercentiles GetQueryLatencyPercentiles(
+        const std::string& query_type) const {
+        return GetQueryStats(query_type).latency.GetPercentiles();
+    }
+    LatencyPercentiles GetLockWaitPercentiles() const {
+        return GetLockWaitHistogram().GetPercentiles();
+    }
+    LatencyPercentiles GetLogFlushPercentiles() const {
+        return GetLogFlushHistogram().GetPercentiles();
+    }
+    LatencyPercentiles GetDiskReadPercentiles() const {
+        return GetDiskReadHistogram().GetPercentiles();
+    }
+
+    // 记录过的查询类型
+    std::vector<std::string> GetQueryTypes() const;
+
     // ==================== 输出和重置 ====================
 
     void PrintStatistics() const;
@@ -205,8 +371,40 @@ class Statistics {
 
     mutable std::mutex mutex_;
 
+    // ==================== 分片计数器 ====================
+    struct ThreadShard {
+        CounterSlotTable<BTreeCounterSlot> btree;
+        CounterSlotTable<QueryCounterSlot> query;
+    };
+
+    // 名字和编号的双向映射，受mutex_保护
+    struct NameRegistry {
+        std::unordered_map<std::string, uint32_t> ids;
+        std::vector<std::string> names;
+    };
+
+    /** 当前线程的分片，第一次调用时分配或者复用一个空闲的 */
+    ThreadShard& GetThreadShard();
+
+    /** 线程退出时把分片还回空闲列表 */
+    void ReleaseThreadShard(ThreadShard* shard);
+
+    uint32_t InternName(NameRegistry* registry, const std::string& name);
+    uint32_t GetQueryTypeId(const std::string& query_type);
+
+    /** 把所有分片里某个索引的计数加起来 */
+    void SumBTreeCounters(uint32_t index_id, BTreeStats* stats) const;
+    QueryStats SumQueryCounters(uint32_t type_id) const;
+
+    // 所有分片（包括空闲的），受shards_mutex_保护
+    mutable std::mutex shards_mutex_;
+    std::vector<std::unique_ptr<ThreadShard>> shards_;
+    std::vector<ThreadShard*> free_shards_;
+
     // ==================== B+树统计 ====================
-    std::unordered_map<std::string, std::unique_ptr<BTreeStats>> btree_stats_;
+    NameRegistry index_names_;
+    // 按编号保存节点数、树高这些很少更新的值，计数在分片里
+    std::vector<std::unique_ptr<BTreeStats>> btree_gauges_;
 
     // ==================== 缓存统计 ====================
     std::atomic<uint64_t> buffer_pool_hits_{0};
@@ -223,20 +421,23 @@ class Statistics {
     std::atomic<uint64_t> disk_write_bytes_{0};
     std::atomic<uint64_t> page_allocations_{0};
     std::atomic<uint64_t> page_deallocations_{0};
+    LatencyHistogram disk_read_histogram_;
 
     // ==================== 事务统计 ====================
     std::atomic<uint64_t> transaction_begins_{0};
     std::atomic<uint64_t> transaction_commits_{0};
     std::atomic<uint64_t> transaction_aborts_{0};
     std::atomic<double> total_transaction_time_ms_{0.0};
+    LatencyHistogram transaction_histogram_;
 
     // ==================== 查询统计 ====================
-    std::unordered_map<std::string, QueryStats> query_stats_;
+    NameRegistry query_types_;
 
     // ==================== 锁统计 ====================
     std::unordered_map<std::string, uint64_t> lock_acquisitions_;
     std::atomic<uint64_t> lock_waits_{0};
     std::atomic<double> total_lock_wait_time_ms_{0.0};
+    LatencyHistogram lock_wait_histogram_;
     std::atomic<uint64_t> lock_conflicts_{0};
     std::atomic<uint64_t> deadlocks_{0};
 
@@ -245,6 +446,7 @@ class Statistics {
     std::atomic<uint64_t> log_write_bytes_{0};
     std::atomic<uint64_t> log_flushes_{0};
     std::atomic<uint64_t> log_truncations_{0};
+    LatencyHistogram log_flush_histogram_;
 
     // ==================== 索引统计 ====================
     std::atomic<uint64_t> index_creations_{0};
@@ -256,6 +458,7 @@ class Statistics {
     std::string FormatNumber(uint64_t number) const;
     std::string FormatPercentage(double percentage) const;
     std::string FormatTime(double time_ms) const;
+    void PrintPercentiles(const LatencyPercentiles& percentiles) const;
 };
 
 // 宏定义，方便在代码中使用
@@ -0,0 +1,206 @@
+/*
+ * 文件: trace.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 跟踪缓冲区和Chrome trace导出的实现
+ */
+
+#include "stat/trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+namespace SimpleRDBMS {
+
+namespace {
+
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<TraceBuffer>> registry;
+std::atomic<uint32_t> next_thread_id{1};
+
+/** 线程退出时把缓冲区标记为已退出，事件留给导出 */
+struct ThreadBufferHolder {
+    std::shared_ptr<TraceBuffer> buffer;
+    ~ThreadBufferHolder() {
+        if (buffer != nullptr) {
+            buffer->Detach();
+        }
+    }
+};
+
+thread_local ThreadBufferHolder thread_buffer;
+
+/** 从最早登记的开始丢掉多出来的已退出缓冲区，调用方持有registry_mutex */
+void PruneDetachedBuffers() {
+    size_t detached = 0;
+    for (const auto& buffer : registry) {
+        if (buffer->IsDetached()) {
+            detached++;
+        }
+    }
+    for (auto it = registry.begin();
+         it != registry.end() && detached > Tracer::MAX_DETACHED_BUFFERS;) {
+        if ((*it)->IsDetached()) {
+            it = registry.erase(it);
+            detached--;
+        } else {
+            ++it;
+        }
+    }
+}
+
+/** JSON字符串里的转义，事件名都是字面量，一般用不到 */
+void AppendJsonString(std::string* out, const char* text) {
+    out->push_back('"');
+    for (const char* p = text; p != nullptr && *p != '\0'; ++p) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            out->push_back('\\');
+            out->push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out->append(escaped);
+        } else {
+            out->push_back(c);
+        }
+    }
+    out->push_back('"');
+}
+
+/** 纳秒换成Chrome trace要的微秒，保留到纳秒 */
+void AppendMicros(std::string* out, uint64_t ns) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%llu.%03llu",
+                  static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned long long>(ns % 1000));
+    out->append(text);
+}
+
+}  // namespace
+
+std::atomic<bool> Tracer::enabled_{false};
+
+TraceBuffer::TraceBuffer(uint32_t thread_id)
+    : thread_id_(thread_id), events_(CAPACITY) {}
+
+void TraceBuffer::Append(const TraceEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_[next_ % CAPACITY] = event;
+    next_++;
+}
+
+void TraceBuffer::CopyEvents(std::vector<TraceEvent>* out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t begin = next_ > CAPACITY ? next_ - CAPACITY : 0;
+    for (uint64_t i = begin; i < next_; ++i) {
+        out->push_back(events_[i % CAPACITY]);
+    }
+}
+
+void TraceBuffer::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    next_ = 0;
+}
+
+void Tracer::SetEnabled(bool enabled) { enabled_.store(enabled); }
+
+uint64_t Tracer::NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+TraceBuffer* Tracer::CurrentBuffer() {
+    if (thread_buffer.buffer == nullptr) {
+        auto buffer = std::make_shared<TraceBuffer>(next_thread_id++);
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        PruneDetachedBuffers();
+        registry.push_back(buffer);
+        thread_buffer.buffer = std::move(buffer);
+    }
+    return thread_buffer.buffer.get();
+}
+
+void Tracer::Record(const char* category, const char* name,
+                    uint64_t start_ns, uint64_t duration_ns, uint64_t arg) {
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.start_ns = start_ns;
+    event.duration_ns = duration_ns;
+    event.arg = arg;
+    CurrentBuffer()->Append(event);
+}
+
+/**
+ * 导出成Chrome trace
+ * 实现思路：
+ * 1. 持有登记表的锁复制出所有缓冲区的指针，之后逐个缓冲区复制事件，
+ *    不会长时间挡住写入的线程
+ * 2. 每个线程先输出一个thread_name元数据事件，再输出它的区间
+ */
+std::string Tracer::DumpChromeTrace() {
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        buffers = registry;
+    }
+    std::sort(buffers.begin(), buffers.end(),
+              [](const std::shared_ptr<TraceBuffer>& a,
+                 const std::shared_ptr<TraceBuffer>& b) {
+                  return a->GetThreadId() < b->GetThreadId();
+              });
+
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    std::vector<TraceEvent> events;
+    for (const auto& buffer : buffers) {
+        events.clear();
+        buffer->CopyEvents(&events);
+        if (events.empty()) {
+            continue;
+        }
+        std::string tid = std::to_string(buffer->GetThreadId());
+        if (!first) {
+            out += ",";
+        }
+        first = false;
+        out += "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" +
+               tid + ",\"args\":{\"name\":\"thread " + tid + "\"}}";
+        for (const auto& event : events) {
+            out += ",\n{\"name\":";
+            AppendJsonString(&out, event.name);
+            out += ",\"cat\":";
+            AppendJsonString(&out, event.category);
+            out += ",\"ph\":\"X\",\"ts\":";
+            AppendMicros(&out, event.start_ns);
+            out += ",\"dur\":";
+            AppendMicros(&out, event.duration_ns);
+            out += ",\"pid\":1,\"tid\":" + tid;
+            if (event.arg != 0) {
+                out += ",\"args\":{\"value\":" + std::to_string(event.arg) + "}";
+            }
+            out += "}";
+        }
+    }
+    out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return out;
+}
+
+void Tracer::Clear() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.erase(std::remove_if(registry.begin(), registry.end(),
+                                  [](const std::shared_ptr<TraceBuffer>& b) {
+                                      return b->IsDetached();
+                                  }),
+                   registry.end());
+    for (const auto& buffer : registry) {
+        buffer->Clear();
+    }
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,158 @@
+/*
+ * 文件: trace.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 热点路径的跟踪区间，记在每个线程自己的环形缓冲区里，
+ *       按需导出成Chrome trace JSON，可以用chrome://tracing或Perfetto查看
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 编译进来的跟踪点，0时TRACE_SPAN*宏编译后什么都不剩
+#ifndef SIMPLERDBMS_ENABLE_TRACING
+#define SIMPLERDBMS_ENABLE_TRACING 1
+#endif
+
+namespace SimpleRDBMS {
+
+/**
+ * 一个已经结束的区间
+ * category和name必须是字符串字面量，缓冲区里只存指针
+ */
+struct TraceEvent {
+    const char* category = nullptr;
+    const char* name = nullptr;
+    uint64_t start_ns = 0;
+    uint64_t duration_ns = 0;
+    uint64_t arg = 0;  // 附带的数值（页号、行数、字节数），0表示没有
+};
+
+/**
+ * TraceBuffer - 一个线程的环形缓冲区
+ *
+ * 只有所属线程写入，满了以后覆盖最旧的事件，内存用量固定。
+ * 写入时加的锁只有导出的时候才会有人争，平时只是一次无竞争的加锁
+ */
+class TraceBuffer {
+   public:
+    static constexpr size_t CAPACITY = 8192;
+
+    explicit TraceBuffer(uint32_t thread_id);
+
+    void Append(const TraceEvent& event);
+
+    /** 按时间顺序（最旧的在前）追加到out */
+    void CopyEvents(std::vector<TraceEvent>* out) const;
+
+    void Clear();
+
+    uint32_t GetThreadId() const { return thread_id_; }
+
+    /** 所属线程是否已经退出，退出后的缓冲区只保留给导出 */
+    bool IsDetached() const { return detached_.load(); }
+    void Detach() { detached_.store(true); }
+
+   private:
+    const uint32_t thread_id_;
+    std::atomic<bool> detached_{false};
+    mutable std::mutex mutex_;
+    std::vector<TraceEvent> events_;
+    uint64_t next_ = 0;  // 下一个写入的序号，对CAPACITY取模得到位置
+};
+
+/**
+ * Tracer - 跟踪开关和所有线程的缓冲区
+ *
+ * 设计思路：
+ * - 默认关闭，关闭时一个区间只读一次原子变量，不取时钟也不写缓冲区，
+ *   线上可以一直编译着，出问题时再打开，不用换调试版本重启
+ * - 线程第一次记录事件时才分配缓冲区并登记；线程退出后缓冲区还留着，
+ *   退出线程的缓冲区最多保留MAX_DETACHED_BUFFERS个，避免线程来来去去时无限增长
+ * - 导出时逐个缓冲区复制事件，每个区间是一个"ph":"X"的完整事件，
+ *   时间戳用steady_clock，单位微秒，同一台机器上的线程可以对齐
+ */
+class Tracer {
+   public:
+    static constexpr size_t MAX_DETACHED_BUFFERS = 64;
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /** 单调时钟，单位纳秒 */
+    static uint64_t NowNs();
+
+    /** 记录一个结束的区间到当前线程的缓冲区 */
+    static void Record(const char* category, const char* name,
+                       uint64_t start_ns, uint64_t duration_ns,
+                       uint64_t arg = 0);
+
+    /** 所有缓冲区里的事件，Chrome trace的JSON对象格式 */
+    static std::string DumpChromeTrace();
+
+    /** 清空所有缓冲区，丢掉已经退出的线程的缓冲区 */
+    static void Clear();
+
+   private:
+    static TraceBuffer* CurrentBuffer();
+
+    static std::atomic<bool> enabled_;
+};
+
+/**
+ * TraceSpan - 作用域内的一个区间，析构时记录
+ * 构造时跟踪没有打开，这个区间就不记录（中途打开也不补）
+ */
+class TraceSpan {
+   public:
+    TraceSpan(const char* category, const char* name)
+        : category_(category),
+          name_(name),
+          start_ns_(Tracer::IsEnabled() ? Tracer::NowNs() : 0) {}
+
+    ~TraceSpan() {
+        if (start_ns_ != 0) {
+            Tracer::Record(category_, name_, start_ns_,
+                           Tracer::NowNs() - start_ns_, arg_);
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void SetArg(uint64_t arg) { arg_ = arg; }
+
+   private:
+    const char* category_;
+    const char* name_;
+    uint64_t start_ns_;
+    uint64_t arg_ = 0;
+};
+
+}  // namespace SimpleRDBMS
+
+// TRACE_SPAN在当前作用域开一个区间；要在区间结束前附带数值时用
+// TRACE_SPAN_NAMED给区间起名，再用TRACE_SPAN_SET_ARG设置
+#if SIMPLERDBMS_ENABLE_TRACING
+#define SIMPLERDBMS_TRACE_CONCAT_INNER(a, b) a##b
+#define SIMPLERDBMS_TRACE_CONCAT(a, b) SIMPLERDBMS_TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(category, name)                                      \
+    ::SimpleRDBMS::TraceSpan SIMPLERDBMS_TRACE_CONCAT(trace_span_,      \
+                                                      __LINE__)(category, \
+                                                                name)
+#define TRACE_SPAN_NAMED(var, category, name) \
+    ::SimpleRDBMS::TraceSpan var(category, name)
+#define TRACE_SPAN_SET_ARG(var, value) (var).SetArg(value)
+#else
+#define TRACE_SPAN(category, name) ((void)0)
+#define TRACE_SPAN_NAMED(var, category, name) ((void)0)
+#define TRACE_SPAN_SET_ARG(var, value) ((void)0)
+#endif
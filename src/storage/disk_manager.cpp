@@ -8,54 +8,309 @@
 
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 
 #include "common/exception.h"
 #include "stat/stat.h"
+#include "stat/trace.h"
+#include "storage/io_uring.h"
+#include "storage/page.h"
+#include "storage/page_compression.h"
 
 namespace SimpleRDBMS {
 
+namespace {
+
+// O_DIRECT要求缓冲区、offset和长度都按逻辑块大小对齐，这里统一按页面大小对齐
+constexpr size_t DIRECT_IO_ALIGNMENT = PAGE_SIZE;
+
+bool IsDirectIOAligned(const void* buffer) {
+    return reinterpret_cast<uintptr_t>(buffer) % DIRECT_IO_ALIGNMENT == 0;
+}
+
+struct AlignedBuffer {
+    char* data = nullptr;
+    AlignedBuffer() {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, DIRECT_IO_ALIGNMENT, PAGE_SIZE) == 0) {
+            data = static_cast<char*>(memory);
+        }
+    }
+    ~AlignedBuffer() { free(data); }
+};
+
+/**
+ * 每个线程一个对齐的中转缓冲区
+ * 调用者传入的缓冲区没有对齐时（比如Page内嵌的data_），DIRECT方式先读写这里
+ */
+char* GetDirectIOBuffer() {
+    thread_local AlignedBuffer buffer;
+    if (buffer.data == nullptr) {
+        throw StorageException("Cannot allocate aligned I/O buffer");
+    }
+    return buffer.data;
+}
+
+/**
+ * 每个线程一个对齐的压缩缓冲区，存放压缩后的页面槽位
+ * 和中转缓冲区分开，压缩好的槽位可以直接交给DIRECT方式写
+ */
+char* GetCompressionBuffer() {
+    thread_local AlignedBuffer buffer;
+    if (buffer.data == nullptr) {
+        throw StorageException("Cannot allocate page compression buffer");
+    }
+    return buffer.data;
+}
+
+/**
+ * 每个线程一个对齐的缓冲区，存放填好校验值的页面副本
+ * 副本之后还可能被压缩到压缩缓冲区，所以和压缩缓冲区分开
+ */
+char* GetChecksumBuffer() {
+    thread_local AlignedBuffer buffer;
+    if (buffer.data == nullptr) {
+        throw StorageException("Cannot allocate page checksum buffer");
+    }
+    return buffer.data;
+}
+
+/**
+ * database文件头，存放在文件的第一个页面里
+ * 旧文件的第一个页面是catalog页面，不会以这个magic开头
+ */
+constexpr char FILE_HEADER_MAGIC[8] = {'S', 'R', 'D', 'B', 'F', 'I', 'L', 'E'};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t page_size;
+};
+
+// 没有文件头的旧文件都是4KB页面
+constexpr size_t LEGACY_PAGE_SIZE = 4096;
+
+}  // namespace
+
+bool ParseDiskIOMode(const std::string& name, DiskIOMode* mode) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    if (lower == "stream" || lower == "fstream") {
+        *mode = DiskIOMode::STREAM;
+    } else if (lower == "pread" || lower == "positional") {
+        *mode = DiskIOMode::POSITIONAL;
+    } else if (lower == "direct" || lower == "o_direct") {
+        *mode = DiskIOMode::DIRECT;
+    } else if (lower == "io_uring" || lower == "uring") {
+        *mode = DiskIOMode::IO_URING;
+    } else if (lower == "mmap") {
+        *mode = DiskIOMode::MMAP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* DiskIOModeToString(DiskIOMode mode) {
+    switch (mode) {
+        case DiskIOMode::STREAM:
+            return "stream";
+        case DiskIOMode::POSITIONAL:
+            return "pread";
+        case DiskIOMode::DIRECT:
+            return "direct";
+        case DiskIOMode::IO_URING:
+            return "io_uring";
+        case DiskIOMode::MMAP:
+            return "mmap";
+    }
+    return "pread";
+}
+
 /**
  * 构造函数 - 初始化磁盘管理器
  * @param db_file database文件路径
+ * @param io_mode I/O方式
  *
  * 实现思路：
- * 1. 尝试打开已存在的database文件
- * 2. 如果文件不存在，创建新文件
- * 3. 通过stat系统调用获取文件大小，计算已有页面数量
- * 4. 设置next_page_id为下一个可用的page ID
+ * 1. STREAM方式：尝试打开已存在的文件，不存在就创建
+ * 2. 其它方式：open(O_RDWR | O_CREAT)，DIRECT再加O_DIRECT，
+ *    文件系统不支持O_DIRECT（比如tmpfs）时退回普通方式；
+ *    IO_URING再创建一个io_uring，内核不支持时同样退回普通方式；
+ *    MMAP方式open(O_RDONLY)，不创建文件
+ * 3. 通过stat系统调用获取文件大小，写入或者校验文件头
+ * 4. 根据文件头之后的大小计算已有页面数量，设置next_page_id
+ * 5. MMAP方式把整个文件映射成只读内存，文件大小在只读期间不会变
  */
-DiskManager::DiskManager(const std::string& db_file)
-    : db_file_name_(db_file), num_pages_(0), next_page_id_(0) {
-    // 先尝试以读写模式打开existing文件
-    db_file_.open(db_file_name_,
-                  std::ios::binary | std::ios::in | std::ios::out);
-
-    // 如果文件不存在，创建新文件
-    if (!db_file_.is_open()) {
-        db_file_.clear();
-        // 创建空文件
-        db_file_.open(db_file_name_,
-                      std::ios::binary | std::ios::trunc | std::ios::out);
-        db_file_.close();
-        // 重新以读写模式打开
+DiskManager::DiskManager(const std::string& db_file, DiskIOMode io_mode)
+    : db_file_name_(db_file),
+      io_mode_(io_mode),
+      num_pages_(0),
+      next_page_id_(0) {
+    if (io_mode_ == DiskIOMode::STREAM) {
+        // 先尝试以读写模式打开existing文件
         db_file_.open(db_file_name_,
                       std::ios::binary | std::ios::in | std::ios::out);
+
+        // 如果文件不存在，创建新文件
         if (!db_file_.is_open()) {
+            db_file_.clear();
+            // 创建空文件
+            db_file_.open(db_file_name_,
+                          std::ios::binary | std::ios::trunc | std::ios::out);
+            db_file_.close();
+            // 重新以读写模式打开
+            db_file_.open(db_file_name_,
+                          std::ios::binary | std::ios::in | std::ios::out);
+            if (!db_file_.is_open()) {
+                throw StorageException("Cannot open database file: " +
+                                       db_file_name_);
+            }
+        }
+    } else {
+        int flags = io_mode_ == DiskIOMode::MMAP ? O_RDONLY : O_RDWR | O_CREAT;
+#ifdef O_DIRECT
+        if (io_mode_ == DiskIOMode::DIRECT) {
+            fd_ = open(db_file_name_.c_str(), flags | O_DIRECT, 0644);
+            if (fd_ < 0) {
+                LOG_WARN("O_DIRECT not supported for " << db_file_name_
+                                                       << ", using pread");
+            }
+        }
+#endif
+        if (fd_ < 0) {
+            if (io_mode_ == DiskIOMode::DIRECT) {
+                io_mode_ = DiskIOMode::POSITIONAL;
+            }
+            fd_ = open(db_file_name_.c_str(), flags, 0644);
+        }
+        if (fd_ < 0) {
             throw StorageException("Cannot open database file: " +
                                    db_file_name_);
         }
+        if (io_mode_ == DiskIOMode::IO_URING) {
+            ring_ = std::make_unique<IoUring>();
+            if (!ring_->IsAvailable()) {
+                LOG_WARN("io_uring not available for " << db_file_name_
+                                                       << ", using pread");
+                ring_.reset();
+                io_mode_ = DiskIOMode::POSITIONAL;
+            }
+        }
     }
 
     // 获取文件统计信息，计算已有页面数量
     struct stat file_stat;
+    size_t file_size = 0;
     if (stat(db_file_name_.c_str(), &file_stat) == 0) {
-        num_pages_ = file_stat.st_size / PAGE_SIZE;
-        next_page_id_ = std::max(0, static_cast<int>(num_pages_));
+        file_size = static_cast<size_t>(file_stat.st_size);
+    }
+    try {
+        if (io_mode_ == DiskIOMode::MMAP && file_size == 0) {
+            throw StorageException("Cannot map empty database file: " +
+                                   db_file_name_);
+        }
+        size_t data_size = InitFileHeader(file_size);
+        file_size_ = static_cast<off_t>(data_offset_ + data_size);
+        num_pages_ = static_cast<int>(data_size / PAGE_SIZE);
+        next_page_id_ = std::max(0, num_pages_.load());
+        if (io_mode_ == DiskIOMode::MMAP) {
+            void* mapping =
+                mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd_, 0);
+            if (mapping == MAP_FAILED) {
+                throw StorageException("Cannot map database file " +
+                                       db_file_name_ + ": " +
+                                       std::strerror(errno));
+            }
+            mapping_ = static_cast<char*>(mapping);
+            mapping_size_ = file_size;
+        }
+    } catch (...) {
+        // 构造失败不会调用析构函数，这里自己关闭文件
+        ring_.reset();
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+        throw;
+    }
+}
+
+/**
+ * 写入或校验database文件头
+ * @param file_size 当前文件大小
+ * @return 文件头之后的字节数
+ *
+ * 实现思路：
+ * 1. 空文件：写入带magic、格式版本和页面大小的文件头页面，
+ *    之后的页面都从文件头后面开始
+ * 2. 已有文件：读出第一个页面，以magic开头的说明带文件头，
+ *    版本和页面大小必须和当前构建一致，否则页面边界全部错位
+ * 3. 不以magic开头的是旧版本创建的文件，没有文件头，按4KB页面处理
+ */
+size_t DiskManager::InitFileHeader(size_t file_size) {
+    data_offset_ = 0;
+    std::vector<char> page(PAGE_SIZE, 0);
+
+    if (file_size == 0) {
+        FileHeader header;
+        std::memcpy(header.magic, FILE_HEADER_MAGIC, sizeof(header.magic));
+        header.format_version = FILE_FORMAT_VERSION;
+        header.page_size = static_cast<uint32_t>(PAGE_SIZE);
+        std::memcpy(page.data(), &header, sizeof(header));
+        if (io_mode_ == DiskIOMode::STREAM) {
+            StreamWritePage(0, page.data());
+        } else {
+            PositionalWritePage(0, page.data());
+        }
+        data_offset_ = PAGE_SIZE;
+        return 0;
+    }
+
+    if (io_mode_ == DiskIOMode::STREAM) {
+        StreamReadPage(0, page.data());
+    } else {
+        PositionalReadPage(0, page.data());
+    }
+    FileHeader header;
+    std::memcpy(&header, page.data(), sizeof(header));
+    if (std::memcmp(header.magic, FILE_HEADER_MAGIC, sizeof(header.magic)) !=
+        0) {
+        if (PAGE_SIZE != LEGACY_PAGE_SIZE) {
+            throw StorageException(
+                "Database file " + db_file_name_ + " uses " +
+                std::to_string(LEGACY_PAGE_SIZE) + "-byte pages, this build "
+                "uses " + std::to_string(PAGE_SIZE) + "-byte pages");
+        }
+        LOG_DEBUG("Database file " << db_file_name_ << " has no file header");
+        return file_size;
+    }
+    if (header.format_version != FILE_FORMAT_VERSION) {
+        throw StorageException("Unsupported database file format version " +
+                               std::to_string(header.format_version) +
+                               " in " + db_file_name_);
+    }
+    if (header.page_size != PAGE_SIZE) {
+        throw StorageException(
+            "Database file " + db_file_name_ + " uses " +
+            std::to_string(header.page_size) + "-byte pages, this build "
+            "uses " + std::to_string(PAGE_SIZE) + "-byte pages");
     }
+    data_offset_ = PAGE_SIZE;
+    return file_size > data_offset_ ? file_size - data_offset_ : 0;
 }
 
 /**
@@ -63,9 +318,16 @@ DiskManager::DiskManager(const std::string& db_file)
  * 确保文件正确关闭
  */
 DiskManager::~DiskManager() {
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapping_size_);
+    }
+    ring_.reset();
     if (db_file_.is_open()) {
         db_file_.close();
     }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
 }
 
 /**
@@ -73,24 +335,489 @@ DiskManager::~DiskManager() {
  * @param page_id 要读取的页面ID
  * @param page_data 存储读取数据的buffer（调用者负责分配内存）
  *
- * 实现思路：
- * 1. 加锁保证线程安全
- * 2. 验证page_id的有效性
- * 3. 计算文件offset = page_id * PAGE_SIZE
- * 4. 使用seekg定位到指定位置
- * 5. 读取PAGE_SIZE字节的数据
- * 6. 如果读取不足，用0填充剩余部分
+ * 验证page_id之后按I/O方式分发，读取不足PAGE_SIZE的部分用0填充
  */
 void DiskManager::ReadPage(page_id_t page_id, char* page_data) {
-    std::lock_guard<std::mutex> lock(latch_);
-
     // 验证page_id范围
-    if (page_id < 0 || page_id >= num_pages_) {
+    if (page_id < 0 || page_id >= num_pages_.load()) {
         throw StorageException("Invalid page id: " + std::to_string(page_id));
     }
 
+    TRACE_SPAN_NAMED(read_span, "disk", "DiskManager::ReadPage");
+    TRACE_SPAN_SET_ARG(read_span, static_cast<uint64_t>(page_id));
+    Statistics::PerformanceTimer read_timer;
+    if (mapping_ != nullptr) {
+        std::memcpy(page_data, mapping_ + PageOffset(page_id), PAGE_SIZE);
+    } else if (io_mode_ == DiskIOMode::STREAM) {
+        StreamReadPage(page_id, page_data);
+    } else {
+        PositionalReadPage(page_id, page_data);
+    }
+    DecodeStoredPage(page_id, page_data);
+
+    STATS.RecordDiskRead(PAGE_SIZE, read_timer.GetElapsedMs());
+}
+
+/**
+ * 将页面数据写入磁盘
+ * @param page_id 要写入的页面ID
+ * @param page_data 要写入的数据buffer
+ *
+ * 验证page_id之后按I/O方式分发，写入新页面时更新页面数量
+ */
+void DiskManager::WritePage(page_id_t page_id, const char* page_data,
+                            size_t checksum_offset) {
+    CheckWritable("write page");
+    if (page_id < 0) {
+        throw StorageException("Invalid page id: " + std::to_string(page_id));
+    }
+    if (checksum_offset != 0) {
+        char* stamped = GetChecksumBuffer();
+        std::memcpy(stamped, page_data, PAGE_SIZE);
+        StampPageChecksum(stamped, checksum_offset);
+        page_data = stamped;
+    }
+
+    TRACE_SPAN_NAMED(write_span, "disk", "DiskManager::WritePage");
+    TRACE_SPAN_SET_ARG(write_span, static_cast<uint64_t>(page_id));
+    if (WriteCompressedPage(page_id, page_data)) {
+        UpdatePageCount(page_id);
+        return;
+    }
+    if (io_mode_ == DiskIOMode::STREAM) {
+        StreamWritePage(page_id, page_data);
+    } else {
+        PositionalWritePage(page_id, page_data);
+    }
+
+    UpdatePageCount(page_id);
+
+    STATS.RecordDiskWrite(PAGE_SIZE);
+
+    LOG_DEBUG("Successfully wrote page "
+              << page_id << " to disk at offset " << PageOffset(page_id));
+}
+
+bool DiskManager::CanCompressWrites() const {
+    return PAGE_SIZE > PAGE_COMPRESSION_BLOCK_SIZE &&
+           io_mode_ != DiskIOMode::STREAM && punch_hole_supported_.load();
+}
+
+/**
+ * 压缩写入一个页面
+ *
+ * 实现思路：
+ * 1. 页面没有登记压缩算法，或者当前配置下压缩省不下空间时直接返回false
+ * 2. 压缩到对齐的缓冲区，按PAGE_COMPRESSION_BLOCK_SIZE向上取整后
+ *    不比页面小的（数据压不动）照原样写
+ * 3. 槽位已经完整地在文件里时只写取整后的开头，再把剩下的部分打洞；
+ *    槽位超出文件末尾时写满整个槽位再打洞，文件大小总是覆盖所有页面
+ */
+bool DiskManager::WriteCompressedPage(page_id_t page_id,
+                                      const char* page_data) {
+    if (!compression_used_.load(std::memory_order_relaxed) ||
+        !CanCompressWrites()) {
+        return false;
+    }
+    PageCompression compression = GetPageCompression(page_id);
+    if (compression == PageCompression::NONE) {
+        return false;
+    }
+
+    char* buffer = GetCompressionBuffer();
+    size_t compressed_size =
+        CompressPage(page_id, compression, page_data, buffer);
+    size_t stored_size =
+        (compressed_size + PAGE_COMPRESSION_BLOCK_SIZE - 1) /
+        PAGE_COMPRESSION_BLOCK_SIZE * PAGE_COMPRESSION_BLOCK_SIZE;
+    if (compressed_size == 0 || stored_size >= PAGE_SIZE) {
+        return false;
+    }
+
+    off_t offset = PageOffset(page_id);
+    size_t write_size =
+        offset + static_cast<off_t>(PAGE_SIZE) <= file_size_.load()
+            ? stored_size
+            : PAGE_SIZE;
+    std::memset(buffer + compressed_size, 0, write_size - compressed_size);
+    PositionalWritePage(page_id, buffer, write_size);
+    PunchHole(offset + static_cast<off_t>(stored_size),
+              PAGE_SIZE - stored_size);
+
+    STATS.RecordDiskWrite(stored_size);
+    LOG_DEBUG("Wrote page " << page_id << " compressed to " << stored_size
+                            << " bytes");
+    return true;
+}
+
+/**
+ * 槽位开头是压缩页面的头部时解压
+ * 头部记录的页面ID和要读的页面一致、但数据校验不通过时，页面已经损坏；
+ * 页面ID不一致说明只是普通页面碰巧以magic开头，原样返回
+ */
+void DiskManager::DecodeStoredPage(page_id_t page_id, char* page_data) {
+    if (!IsCompressedPage(page_data)) {
+        return;
+    }
+    char* stored = GetCompressionBuffer();
+    std::memcpy(stored, page_data, PAGE_SIZE);
+    PageCompression compression;
+    if (!DecompressPage(page_id, stored, page_data, &compression)) {
+        CompressedPageHeader header;
+        std::memcpy(&header, stored, sizeof(header));
+        std::memcpy(page_data, stored, PAGE_SIZE);
+        if (header.page_id == page_id) {
+            throw StorageException("Corrupted compressed page " +
+                                   std::to_string(page_id) + " in " +
+                                   db_file_name_);
+        }
+        return;
+    }
+    if (GetPageCompression(page_id) != compression) {
+        SetPageCompression(page_id, compression);
+    }
+}
+
+/**
+ * 打洞释放槽位的尾部
+ * 文件系统不支持时以后不再压缩：写进去的压缩页面仍然能读，只是省不下空间
+ */
+void DiskManager::PunchHole(off_t offset, size_t length) {
+#ifdef FALLOC_FL_PUNCH_HOLE
+    if (fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset,
+                  static_cast<off_t>(length)) == 0) {
+        return;
+    }
+    if (errno != EOPNOTSUPP && errno != ENOSYS) {
+        LOG_WARN("Failed to punch hole in " << db_file_name_ << ": "
+                                            << std::strerror(errno));
+        return;
+    }
+#else
+    (void)offset;
+    (void)length;
+#endif
+    if (punch_hole_supported_.exchange(false)) {
+        LOG_WARN("Hole punching not supported for "
+                 << db_file_name_ << ", page compression disabled");
+    }
+}
+
+void DiskManager::SetPageCompression(page_id_t page_id,
+                                     PageCompression compression) {
+    std::lock_guard<std::mutex> lock(compression_latch_);
+    if (compression == PageCompression::NONE) {
+        page_compression_.erase(page_id);
+        return;
+    }
+    page_compression_[page_id] = compression;
+    compression_used_ = true;
+}
+
+PageCompression DiskManager::GetPageCompression(page_id_t page_id) const {
+    if (!compression_used_.load(std::memory_order_relaxed)) {
+        return PageCompression::NONE;
+    }
+    std::lock_guard<std::mutex> lock(compression_latch_);
+    auto it = page_compression_.find(page_id);
+    return it == page_compression_.end() ? PageCompression::NONE : it->second;
+}
+
+/**
+ * 页面在只读映射里的地址
+ * 压缩存放的页面在映射里是压缩数据，不能直接用；槽位开头碰巧是
+ * 压缩页面magic的普通页面同样返回nullptr，由ReadPage判断
+ */
+const char* DiskManager::GetMappedPage(page_id_t page_id) const {
+    if (mapping_ == nullptr || page_id < 0 || page_id >= num_pages_.load()) {
+        return nullptr;
+    }
+    const char* slot = mapping_ + PageOffset(page_id);
+    if (IsCompressedPage(slot)) {
+        return nullptr;
+    }
+    return slot;
+}
+
+/**
+ * 对一段页面调用madvise(MADV_WILLNEED)
+ * madvise要求起始地址按操作系统页对齐，这里把范围向外扩到对齐的边界
+ */
+void DiskManager::AdviseWillNeed(page_id_t first_page_id, size_t count) const {
+    if (mapping_ == nullptr || first_page_id < 0 || count == 0) {
+        return;
+    }
+    size_t begin = static_cast<size_t>(PageOffset(first_page_id));
+    if (begin >= mapping_size_) {
+        return;
+    }
+    size_t end = std::min(mapping_size_, begin + count * PAGE_SIZE);
+    static const size_t os_page_size =
+        static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    begin -= begin % os_page_size;
+    if (madvise(mapping_ + begin, end - begin, MADV_WILLNEED) != 0) {
+        LOG_DEBUG("madvise(MADV_WILLNEED) failed for " << db_file_name_ << ": "
+                                                       << std::strerror(errno));
+    }
+}
+
+void DiskManager::CheckWritable(const char* operation) const {
+    if (IsReadOnly()) {
+        throw StorageException(std::string("Cannot ") + operation +
+                               ": database file " + db_file_name_ +
+                               " is opened read-only");
+    }
+}
+
+/**
+ * 把已经写入的数据落盘
+ *
+ * 实现思路：
+ * 1. 文件描述符方式直接fdatasync
+ * 2. fstream方式先flush流，再临时打开一个fd做fsync（fsync作用于文件本身）
+ */
+void DiskManager::Sync() {
+    int ret = 0;
+    if (fd_ >= 0) {
+        ret = fdatasync(fd_);
+    } else {
+        std::lock_guard<std::mutex> lock(latch_);
+        db_file_.flush();
+        int fd = open(db_file_name_.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            ret = fsync(fd);
+            close(fd);
+        }
+    }
+    if (ret != 0) {
+        throw StorageException("Failed to sync " + db_file_name_ + ": " +
+                               std::strerror(errno));
+    }
+}
+
+/**
+ * 批量读取页面
+ *
+ * 实现思路：
+ * 1. 先统一验证所有page_id，避免提交了一半才发现非法页面
+ * 2. IO_URING方式下整批提交
+ * 3. POSITIONAL和DIRECT方式下页面号连续的一段用一次preadv读完，
+ *    STREAM方式和只读映射逐页读取
+ */
+void DiskManager::ReadPages(const std::vector<PageReadRequest>& requests) {
+    for (const auto& request : requests) {
+        if (request.page_id < 0 || request.page_id >= num_pages_.load()) {
+            throw StorageException("Invalid page id: " +
+                                   std::to_string(request.page_id));
+        }
+    }
+
+    if (ring_ != nullptr && requests.size() > 1) {
+        TRACE_SPAN_NAMED(batch_span, "disk", "DiskManager::RingReadPages");
+        TRACE_SPAN_SET_ARG(batch_span, requests.size());
+        RingReadPages(requests);
+        return;
+    }
+    if (mapping_ == nullptr && io_mode_ != DiskIOMode::STREAM &&
+        requests.size() > 1) {
+        TRACE_SPAN_NAMED(batch_span, "disk", "DiskManager::VectoredReadPages");
+        TRACE_SPAN_SET_ARG(batch_span, requests.size());
+        VectoredReadPages(requests);
+        return;
+    }
+    for (const auto& request : requests) {
+        ReadPage(request.page_id, request.data);
+    }
+}
+
+/**
+ * 批量写入页面
+ *
+ * 实现思路：
+ * 1. 先统一验证所有page_id
+ * 2. IO_URING方式下整批提交，否则逐页写入；整批提交时有校验值的页面
+ *    先在一块临时内存里做好副本并填上校验值
+ */
+void DiskManager::WritePages(const std::vector<PageWriteRequest>& requests) {
+    CheckWritable("write pages");
+    for (const auto& request : requests) {
+        if (request.page_id < 0) {
+            throw StorageException("Invalid page id: " +
+                                   std::to_string(request.page_id));
+        }
+    }
+
+    if (ring_ != nullptr && requests.size() > 1) {
+        // 压缩的页面写入长度不一而且要打洞，逐页写，其余的整批提交
+        std::vector<PageWriteRequest> plain;
+        plain.reserve(requests.size());
+        std::vector<char> stamped;
+        for (size_t i = 0; i < requests.size(); i++) {
+            PageWriteRequest request = requests[i];
+            if (request.checksum_offset != 0) {
+                if (stamped.empty()) {
+                    stamped.resize(requests.size() * PAGE_SIZE);
+                }
+                char* copy = stamped.data() + i * PAGE_SIZE;
+                std::memcpy(copy, request.data, PAGE_SIZE);
+                StampPageChecksum(copy, request.checksum_offset);
+                request.data = copy;
+                request.checksum_offset = 0;
+            }
+            if (!WriteCompressedPage(request.page_id, request.data)) {
+                plain.push_back(request);
+            } else {
+                UpdatePageCount(request.page_id);
+            }
+        }
+        if (plain.empty()) {
+            return;
+        }
+        TRACE_SPAN_NAMED(batch_span, "disk", "DiskManager::RingWritePages");
+        TRACE_SPAN_SET_ARG(batch_span, plain.size());
+        RingWritePages(plain);
+        return;
+    }
+    for (const auto& request : requests) {
+        WritePage(request.page_id, request.data, request.checksum_offset);
+    }
+}
+
+/**
+ * 用preadv批量读取
+ *
+ * 实现思路：
+ * 1. 把页面号连续的请求连成一段，每段最多IOV_MAX个页面；
+ *    DIRECT方式下buffer没有对齐的页面单独读
+ * 2. 每段一次preadv，读到文件的连续区域，各页面直接落进自己的buffer
+ * 3. 没有读满的段（短读、文件末尾、出错）逐页用pread补读，
+ *    由PositionalReadPage负责零填充和抛异常
+ */
+void DiskManager::VectoredReadPages(
+    const std::vector<PageReadRequest>& requests) {
+    const size_t max_run = static_cast<size_t>(IOV_MAX);
+    std::vector<struct iovec> iov;
+    iov.reserve(std::min(requests.size(), max_run));
+
+    size_t begin = 0;
+    while (begin < requests.size()) {
+        size_t end = begin + 1;
+        auto vectorizable = [this](const PageReadRequest& request) {
+            return io_mode_ != DiskIOMode::DIRECT ||
+                   IsDirectIOAligned(request.data);
+        };
+        if (vectorizable(requests[begin])) {
+            while (end < requests.size() && end - begin < max_run &&
+                   requests[end].page_id == requests[end - 1].page_id + 1 &&
+                   vectorizable(requests[end])) {
+                end++;
+            }
+        }
+
+        Statistics::PerformanceTimer run_timer;
+        bool complete = false;
+        if (end - begin > 1) {
+            iov.clear();
+            for (size_t i = begin; i < end; i++) {
+                iov.push_back({requests[i].data, PAGE_SIZE});
+            }
+            ssize_t n;
+            do {
+                n = preadv(fd_, iov.data(), static_cast<int>(iov.size()),
+                           PageOffset(requests[begin].page_id));
+            } while (n < 0 && errno == EINTR);
+            complete = n == static_cast<ssize_t>((end - begin) * PAGE_SIZE);
+        }
+        double run_ms = run_timer.GetElapsedMs();
+
+        // 一段的页面是一起读到的，每页都记整段的耗时
+        for (size_t i = begin; i < end; i++) {
+            Statistics::PerformanceTimer retry_timer;
+            if (!complete) {
+                PositionalReadPage(requests[i].page_id, requests[i].data);
+            }
+            DecodeStoredPage(requests[i].page_id, requests[i].data);
+            STATS.RecordDiskRead(PAGE_SIZE,
+                                 run_ms + retry_timer.GetElapsedMs());
+        }
+        begin = end;
+    }
+}
+
+/**
+ * 通过io_uring批量读取
+ * 每个页面一个SQE，一次提交；短读或者失败的页面再用pread同步读一遍，
+ * 由PositionalReadPage负责零填充和抛异常
+ */
+void DiskManager::RingReadPages(const std::vector<PageReadRequest>& requests) {
+    std::vector<IoUring::Request> batch;
+    batch.reserve(requests.size());
+    for (const auto& request : requests) {
+        batch.push_back({fd_, false, request.data, PAGE_SIZE,
+                         PageOffset(request.page_id), 0});
+    }
+    Statistics::PerformanceTimer batch_timer;
+    ring_->Submit(&batch);
+    double batch_ms = batch_timer.GetElapsedMs();
+
+    // 一批的页面是一起等到的，每页都记整批的耗时
+    for (size_t i = 0; i < requests.size(); i++) {
+        Statistics::PerformanceTimer retry_timer;
+        if (batch[i].result != static_cast<ssize_t>(PAGE_SIZE)) {
+            PositionalReadPage(requests[i].page_id, requests[i].data);
+        }
+        DecodeStoredPage(requests[i].page_id, requests[i].data);
+        STATS.RecordDiskRead(PAGE_SIZE, batch_ms + retry_timer.GetElapsedMs());
+    }
+}
+
+/**
+ * 通过io_uring批量写入
+ * 写完之后按最大的page_id更新一次页面数量
+ */
+void DiskManager::RingWritePages(
+    const std::vector<PageWriteRequest>& requests) {
+    std::vector<IoUring::Request> batch;
+    batch.reserve(requests.size());
+    for (const auto& request : requests) {
+        batch.push_back({fd_, true, const_cast<char*>(request.data), PAGE_SIZE,
+                         PageOffset(request.page_id), 0});
+    }
+    ring_->Submit(&batch);
+
+    page_id_t max_page_id = INVALID_PAGE_ID;
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (batch[i].result != static_cast<ssize_t>(PAGE_SIZE)) {
+            PositionalWritePage(requests[i].page_id, requests[i].data);
+        }
+        off_t end = PageOffset(requests[i].page_id) +
+                    static_cast<off_t>(PAGE_SIZE);
+        off_t known = file_size_.load();
+        while (known < end && !file_size_.compare_exchange_weak(known, end)) {
+        }
+        max_page_id = std::max(max_page_id, requests[i].page_id);
+        STATS.RecordDiskWrite(PAGE_SIZE);
+    }
+    UpdatePageCount(max_page_id);
+
+    LOG_DEBUG("Wrote " << requests.size() << " pages through io_uring");
+}
+
+/**
+ * fstream方式读取页面
+ *
+ * 实现思路：
+ * 1. 加锁保证线程安全（文件流只有一个读写位置）
+ * 2. 计算文件offset = 文件头大小 + page_id * PAGE_SIZE
+ * 3. 使用seekg定位到指定位置
+ * 4. 读取PAGE_SIZE字节的数据
+ * 5. 如果读取不足，用0填充剩余部分
+ */
+void DiskManager::StreamReadPage(page_id_t page_id, char* page_data) {
+    std::lock_guard<std::mutex> lock(latch_);
+
     // 计算文件中的offset位置
-    size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+    size_t offset = static_cast<size_t>(PageOffset(page_id));
     db_file_.seekg(offset);
     db_file_.read(page_data, PAGE_SIZE);
 
@@ -104,32 +831,21 @@ void DiskManager::ReadPage(page_id_t page_id, char* page_data) {
     if (read_count < PAGE_SIZE) {
         std::memset(page_data + read_count, 0, PAGE_SIZE - read_count);
     }
-
-    STATS.RecordDiskRead(PAGE_SIZE);
 }
 
 /**
- * 将页面数据写入磁盘
- * @param page_id 要写入的页面ID
- * @param page_data 要写入的数据buffer
+ * fstream方式写入页面
  *
  * 实现思路：
  * 1. 加锁保证线程安全
- * 2. 验证page_id有效性（允许写入新页面）
- * 3. 如果需要，扩展文件大小以容纳新页面
- * 4. 写入页面数据到指定offset
- * 5. 强制flush到磁盘，确保持久化
- * 6. 在Unix系统上调用fsync进一步确保数据写入
- * 7. 更新metadata（页面数量等）
+ * 2. 如果需要，扩展文件大小以容纳新页面
+ * 3. 写入页面数据到指定offset
+ * 4. 强制flush到磁盘
  */
-void DiskManager::WritePage(page_id_t page_id, const char* page_data) {
+void DiskManager::StreamWritePage(page_id_t page_id, const char* page_data) {
     std::lock_guard<std::mutex> lock(latch_);
 
-    if (page_id < 0) {
-        throw StorageException("Invalid page id: " + std::to_string(page_id));
-    }
-
-    size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+    size_t offset = static_cast<size_t>(PageOffset(page_id));
 
     // 检查并扩展文件大小
     db_file_.seekp(0, std::ios::end);
@@ -156,48 +872,127 @@ void DiskManager::WritePage(page_id_t page_id, const char* page_data) {
     // 强制刷新到磁盘缓冲区
     db_file_.flush();
     LOG_DEBUG("Flushed page " << page_id << " to disk");
+}
 
-    // 在Unix系统上调用fsync确保数据真正写入磁盘
-// #ifdef __unix__
-//     FILE* file = fopen(db_file_name_.c_str(), "r+");
-//     if (file != nullptr) {
-//         int fd = fileno(file);
-//         if (fd != -1) {
-//             LOG_DEBUG("Calling fsync on file descriptor " << fd);
-//             fsync(fd);
-//         }
-//         fclose(file);
-//     }
-// #endif
-
-    // 更新页面数量metadata
-    if (page_id >= num_pages_) {
-        num_pages_ = page_id + 1;
-        if (next_page_id_ <= page_id) {
-            next_page_id_ = page_id + 1;
+/**
+ * pread方式读取页面
+ *
+ * 实现思路：
+ * 1. 不加锁，pread自带offset，多个线程可以同时读
+ * 2. DIRECT方式下缓冲区没对齐时，先读到线程私有的对齐缓冲区再拷贝
+ * 3. 处理EINTR和短读，文件末尾之后的部分用0填充
+ */
+void DiskManager::PositionalReadPage(page_id_t page_id, char* page_data) {
+    bool bounce =
+        io_mode_ == DiskIOMode::DIRECT && !IsDirectIOAligned(page_data);
+    char* buffer = bounce ? GetDirectIOBuffer() : page_data;
+
+    off_t offset = PageOffset(page_id);
+    size_t read_count = 0;
+    while (read_count < PAGE_SIZE) {
+        ssize_t n = pread(fd_, buffer + read_count, PAGE_SIZE - read_count,
+                          offset + static_cast<off_t>(read_count));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw StorageException("Failed to read page: " +
+                                   std::to_string(page_id) + ": " +
+                                   std::strerror(errno));
+        }
+        if (n == 0) {
+            break;  // 文件末尾
         }
+        read_count += static_cast<size_t>(n);
     }
 
-    STATS.RecordDiskWrite(PAGE_SIZE);
+    if (read_count < PAGE_SIZE) {
+        std::memset(buffer + read_count, 0, PAGE_SIZE - read_count);
+    }
+    if (bounce) {
+        std::memcpy(page_data, buffer, PAGE_SIZE);
+    }
+}
+
+/**
+ * pwrite方式写入页面
+ *
+ * 实现思路：
+ * 1. 不加锁，pwrite写到文件末尾之后时文件会自动扩展
+ * 2. DIRECT方式下缓冲区没对齐时，先拷贝到对齐缓冲区再写
+ * 3. 处理EINTR和短写
+ * 4. 写完以后推进记录的文件大小
+ */
+void DiskManager::PositionalWritePage(page_id_t page_id,
+                                      const char* page_data, size_t length) {
+    const char* buffer = page_data;
+    if (io_mode_ == DiskIOMode::DIRECT && !IsDirectIOAligned(page_data)) {
+        char* aligned = GetDirectIOBuffer();
+        std::memcpy(aligned, page_data, length);
+        buffer = aligned;
+    }
 
-    LOG_DEBUG("Successfully wrote page " << page_id << " to disk at offset "
-                                         << offset);
+    off_t offset = PageOffset(page_id);
+    size_t written = 0;
+    while (written < length) {
+        ssize_t n = pwrite(fd_, buffer + written, length - written,
+                           offset + static_cast<off_t>(written));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw StorageException("Failed to write page: " +
+                                   std::to_string(page_id) + ": " +
+                                   std::strerror(errno));
+        }
+        written += static_cast<size_t>(n);
+    }
+    off_t end = offset + static_cast<off_t>(length);
+    off_t known = file_size_.load();
+    while (known < end && !file_size_.compare_exchange_weak(known, end)) {
+    }
+    LOG_DEBUG("Writing page " << page_id << " to disk at offset " << offset);
+}
+
+/**
+ * 写入新页面后更新页面数量metadata
+ * 绝大多数写入都落在已有页面上，只有扩展文件时才需要加锁
+ */
+void DiskManager::UpdatePageCount(page_id_t page_id) {
+    if (page_id < num_pages_.load()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(latch_);
+    if (page_id >= num_pages_.load()) {
+        num_pages_ = page_id + 1;
+    }
+    if (next_page_id_ <= page_id) {
+        next_page_id_ = page_id + 1;
+    }
 }
 
 /**
  * 分配一个新的页面ID
  * @return 新分配的page_id
+ */
+page_id_t DiskManager::AllocatePage() {
+    CheckWritable("allocate page");
+    std::lock_guard<std::mutex> lock(latch_);
+    return AllocatePageLocked();
+}
+
+/**
+ * 分配一个单独的页面
  *
  * 实现思路：
  * 1. 优先复用已释放的页面（从free_pages_列表中取）
- * 2. 如果没有可复用的页面，分配新的page_id
- * 3. 更新next_page_id和num_pages计数器
+ * 2. 其次从归还的区段里取一个页面
+ * 3. 都没有时分配新的page_id
+ * 4. 更新next_page_id和num_pages计数器
  *
  * 这种设计可以有效复用磁盘空间，避免文件无限增长
  */
-page_id_t DiskManager::AllocatePage() {
-    std::lock_guard<std::mutex> lock(latch_);
-
+page_id_t DiskManager::AllocatePageLocked() {
     // 页面0和页面1是系统保留页面
     // 页面0: catalog页面
     // 页面1: 索引头部页面
@@ -206,7 +1001,7 @@ page_id_t DiskManager::AllocatePage() {
     if (next_page_id_ < RESERVED_PAGES && num_pages_ <= RESERVED_PAGES) {
         // 初始化时，确保从保留页面之后开始分配
         next_page_id_ = RESERVED_PAGES;
-        num_pages_ = std::max(num_pages_, RESERVED_PAGES);
+        num_pages_ = std::max(num_pages_.load(), RESERVED_PAGES);
         LOG_DEBUG("AllocatePage: Initialized next_page_id to "
                   << next_page_id_);
     }
@@ -227,6 +1022,19 @@ page_id_t DiskManager::AllocatePage() {
         }
     }
 
+    if (!free_extents_.empty()) {
+        auto& free_extent = free_extents_.back();
+        page_id_t reused_page = free_extent.first++;
+        if (--free_extent.second == 0) {
+            free_extents_.pop_back();
+        }
+        num_pages_ = std::max(num_pages_.load(), reused_page + 1);
+        STATS.RecordPageAllocation();
+        LOG_DEBUG("AllocatePage: Reusing page " << reused_page
+                                                << " of a released extent");
+        return reused_page;
+    }
+
     page_id_t new_page_id = next_page_id_++;
 
     // 跳过保留页面
@@ -235,7 +1043,7 @@ page_id_t DiskManager::AllocatePage() {
         next_page_id_++;
     }
 
-    num_pages_ = std::max(num_pages_, next_page_id_);
+    num_pages_ = std::max(num_pages_.load(), new_page_id + 1);
 
     STATS.RecordPageAllocation();
 
@@ -243,6 +1051,90 @@ page_id_t DiskManager::AllocatePage() {
     return new_page_id;
 }
 
+/**
+ * 从对象的区段里分配一个页面
+ *
+ * 实现思路：
+ * 1. 区段里还有页面时直接取下一个，和其他对象的分配互不交错
+ * 2. 区段用完时预留下一个区段：优先复用归还的区段（最多EXTENT_PAGES页），
+ *    否则从next_page_id_开始预留EXTENT_PAGES个连续页面
+ * 3. 预留只推进next_page_id_，num_pages_只计到真正分配出去的页面，
+ *    没用到的预留页面不会被当成文件里已有的页面
+ */
+page_id_t DiskManager::AllocatePage(ExtentReservation* extent) {
+    if (extent == nullptr) {
+        return AllocatePage();
+    }
+    CheckWritable("allocate page");
+    page_id_t page_id;
+    {
+        std::lock_guard<std::mutex> lock(latch_);
+        page_id = AllocateExtentPageLocked(extent);
+    }
+    // 复用的页面可能还登记着之前对象的压缩算法，这里总是重新登记
+    if (extent->compression != PageCompression::NONE ||
+        compression_used_.load(std::memory_order_relaxed)) {
+        SetPageCompression(page_id, extent->compression);
+    }
+    return page_id;
+}
+
+page_id_t DiskManager::AllocateExtentPageLocked(ExtentReservation* extent) {
+    if (extent->next_page_id == INVALID_PAGE_ID ||
+        extent->next_page_id >= extent->end_page_id) {
+        if (!free_extents_.empty()) {
+            auto& free_extent = free_extents_.back();
+            size_t pages = std::min(free_extent.second, EXTENT_PAGES);
+            extent->next_page_id = free_extent.first;
+            extent->end_page_id =
+                free_extent.first + static_cast<page_id_t>(pages);
+            free_extent.first += static_cast<page_id_t>(pages);
+            free_extent.second -= pages;
+            if (free_extent.second == 0) {
+                free_extents_.pop_back();
+            }
+        } else {
+            // 先按单页分配拿到区段的第一个页面，处理好保留页面
+            page_id_t first_page_id = AllocatePageLocked();
+            if (first_page_id + 1 != next_page_id_) {
+                // 复用了单独释放的页面，区段只有这一页
+                return first_page_id;
+            }
+            extent->next_page_id = first_page_id + 1;
+            extent->end_page_id =
+                first_page_id + static_cast<page_id_t>(EXTENT_PAGES);
+            next_page_id_ = extent->end_page_id;
+            LOG_DEBUG("AllocatePage: Reserved extent ["
+                      << first_page_id << ", " << extent->end_page_id << ")");
+            return first_page_id;
+        }
+        LOG_DEBUG("AllocatePage: Reusing released extent ["
+                  << extent->next_page_id << ", " << extent->end_page_id
+                  << ")");
+    }
+
+    page_id_t page_id = extent->next_page_id++;
+    num_pages_ = std::max(num_pages_.load(), page_id + 1);
+    STATS.RecordPageAllocation();
+    return page_id;
+}
+
+/**
+ * 归还区段里还没分配的页面
+ * 对象销毁（比如删除表）时调用，剩下的页面进入free_extents_
+ */
+void DiskManager::ReleaseExtent(ExtentReservation* extent) {
+    std::lock_guard<std::mutex> lock(latch_);
+    if (extent->next_page_id != INVALID_PAGE_ID &&
+        extent->next_page_id < extent->end_page_id) {
+        free_extents_.emplace_back(
+            extent->next_page_id,
+            static_cast<size_t>(extent->end_page_id - extent->next_page_id));
+    }
+    extent->next_page_id = INVALID_PAGE_ID;
+    extent->end_page_id = INVALID_PAGE_ID;
+}
+
 /**
  * 释放一个页面，将其加入空闲列表
  * @param page_id 要释放的页面ID
@@ -256,6 +1148,7 @@ page_id_t DiskManager::AllocatePage() {
  * 实际的页面清理工作由上层模块负责
  */
 void DiskManager::DeallocatePage(page_id_t page_id) {
+    CheckWritable("deallocate page");
     std::lock_guard<std::mutex> lock(latch_);
 
     const page_id_t RESERVED_PAGES = 2;
@@ -269,6 +1162,10 @@ void DiskManager::DeallocatePage(page_id_t page_id) {
 
     if (page_id >= 0 && page_id < next_page_id_) {
         free_pages_.push_back(page_id);
+        if (compression_used_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> compression_lock(compression_latch_);
+            page_compression_.erase(page_id);
+        }
 
         STATS.RecordPageDeallocation();
         
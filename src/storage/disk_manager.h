@@ -8,15 +8,77 @@
 
 #pragma once
 
+#include <sys/types.h>
+
+#include <atomic>
 #include <fstream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "common/config.h"
+#include "common/types.h"
 
 namespace SimpleRDBMS {
 
+/**
+ * 磁盘I/O方式
+ *
+ * - STREAM：std::fstream + seekg/seekp，所有读写串行执行（最初的实现）
+ * - POSITIONAL：文件描述符 + pread/pwrite，读写页面不持有全局锁，
+ *   多个缓存未命中可以同时下发到设备
+ * - DIRECT：在POSITIONAL的基础上用O_DIRECT打开，绕过操作系统页缓存，
+ *   避免和缓冲池重复缓存；文件系统不支持时自动退回POSITIONAL
+ * - IO_URING：单页读写和POSITIONAL一样，批量读写（ReadPages/WritePages）
+ *   通过io_uring一次系统调用提交；内核不支持时自动退回POSITIONAL
+ * - MMAP：只读打开已有的文件并整个映射到内存，缓冲池的frame直接指向
+ *   映射里的页面，不复制到frame自己的内存（见GetMappedPage）；
+ *   写页面、分配和释放页面都抛出StorageException
+ */
+enum class DiskIOMode { STREAM, POSITIONAL, DIRECT, IO_URING, MMAP };
+
+class IoUring;
+
+/** 批量读取中的一个页面 */
+struct PageReadRequest {
+    page_id_t page_id;
+    char* data;
+};
+
+/** 批量写入中的一个页面 */
+struct PageWriteRequest {
+    page_id_t page_id;
+    const char* data;
+    size_t checksum_offset = 0;  // 页面校验值字段的偏移，0表示没有校验值
+};
+
+/**
+ * 一个对象（表或索引）预留的连续页面区段
+ * 对象的新页面从区段里顺序分配，用完再向磁盘管理器预留下一个区段；
+ * 只由DiskManager在持有latch_时读写
+ */
+struct ExtentReservation {
+    page_id_t next_page_id = INVALID_PAGE_ID;  // 下一个要分配的页面
+    page_id_t end_page_id = INVALID_PAGE_ID;   // 区段末尾（不含）
+    // 对象的页面写盘时使用的压缩算法，从区段分配的页面都会登记上
+    PageCompression compression = PageCompression::NONE;
+};
+/**
+ * 解析I/O方式名称（stream / pread / direct / io_uring / mmap，不区分大小写）
+ * @param name 配置中的名称
+ * @param mode 输出参数
+ * @return 名称有效返回true
+ */
+bool ParseDiskIOMode(const std::string& name, DiskIOMode* mode);
+
+/**
+ * I/O方式转换为配置名称
+ */
+const char* DiskIOModeToString(DiskIOMode mode);
+
 /**
  * 磁盘管理器类 - RDBMS存储层的底层组件
  *
@@ -28,20 +90,31 @@ namespace SimpleRDBMS {
  * 5. 确保磁盘I/O操作的线程安全性
  *
  * 设计思路：
- * - 使用fstream进行文件I/O操作
- * - 通过mutex保证多线程环境下的安全性
+ * - 默认使用pread/pwrite按offset读写，页面I/O之间互不阻塞；
+ *   也可以选择原来的fstream方式或者O_DIRECT方式（见DiskIOMode）
+ * - 通过mutex保护页面分配信息，fstream方式下同时保护文件流
  * - 采用页面复用机制减少磁盘空间浪费
  * - 为上层Buffer Pool Manager提供统一的存储接口
+ * - 文件开头保留一个页面作为文件头，记录格式版本和创建时的页面大小，
+ *   页面ID从文件头之后开始编号；没有文件头的旧文件按4KB页面读写
+ * - 登记了压缩算法的页面写盘时压缩：压缩数据写在页面槽位开头，
+ *   槽位剩下的整块通过打洞还给文件系统，页面ID和offset的对应关系不变；
+ *   读盘时按槽位开头的头部识别压缩页面并解压，缓冲池只看到解压后的页面。
+ *   压缩只在页面比PAGE_COMPRESSION_BLOCK_SIZE大、文件系统支持打洞、
+ *   不是STREAM方式时生效，否则登记了也按原样写
  */
 class DiskManager {
    public:
     /**
      * 构造函数 - 初始化磁盘管理器
      * @param db_file database文件的路径
+     * @param io_mode I/O方式，默认使用pread/pwrite
      *
-     * 功能：打开或创建database文件，初始化页面计数器
+     * 功能：打开或创建database文件，初始化页面计数器；
+     * MMAP方式只打开已有的文件，文件不存在或者为空时抛出StorageException
      */
-    explicit DiskManager(const std::string& db_file);
+    explicit DiskManager(const std::string& db_file,
+                         DiskIOMode io_mode = DiskIOMode::POSITIONAL);
 
     /**
      * 析构函数 - 清理资源
@@ -49,6 +122,9 @@ class DiskManager {
      */
     ~DiskManager();
 
+    DiskManager(const DiskManager&) = delete;
+    DiskManager& operator=(const DiskManager&) = delete;
+
     /**
      * 从磁盘读取指定页面的数据
      * @param page_id 要读取的页面ID
@@ -63,10 +139,40 @@ class DiskManager {
      * 将页面数据写入磁盘
      * @param page_id 要写入的页面ID
      * @param page_data 要写入的数据buffer（必须是PAGE_SIZE大小）
+     * @param checksum_offset 页面校验值字段的偏移，非0时在页面的副本上
+     *        填好CRC32C校验值再写，调用者的数据不变，写盘时页面还在被修改
+     *        也不会让校验值和写下去的数据对不上
      *
      * 功能：写入数据并强制刷新到磁盘，确保数据持久化
      */
-    void WritePage(page_id_t page_id, const char* page_data);
+    void WritePage(page_id_t page_id, const char* page_data,
+                   size_t checksum_offset = 0);
+
+    /**
+     * 批量读取页面
+     * @param requests 要读取的页面及各自的buffer
+     *
+     * IO_URING方式下整批一起提交；POSITIONAL和DIRECT方式下
+     * 页面号连续的请求合并成一次preadv，按页面号排好序再调用收益最大；
+     * STREAM方式逐页读取。任何一个页面失败都会抛出StorageException
+     */
+    void ReadPages(const std::vector<PageReadRequest>& requests);
+
+    /**
+     * 批量写入页面
+     * @param requests 要写入的页面及各自的数据
+     *
+     * 用于FlushAllPages、检查点等一次写很多页面的场景
+     */
+    void WritePages(const std::vector<PageWriteRequest>& requests);
+
+    /**
+     * 把已经写入的数据真正落盘（fdatasync）
+     *
+     * WritePage只保证数据交给了操作系统，需要持久化保证的场景
+     * （比如日志提交）再调用这个方法
+     */
+    void Sync();
 
     /**
      * 分配一个新的页面ID
@@ -75,6 +181,20 @@ class DiskManager {
      * 策略：优先复用已释放的页面，如果没有则分配新页面
      */
     page_id_t AllocatePage();
+    /**
+     * 从对象预留的区段里分配一个页面
+     * @param extent 对象的区段，用完时预留下一个EXTENT_PAGES页的区段
+     * @return 新分配的page_id
+     *
+     * 区段优先复用释放回来的区段，否则从文件末尾预留；
+     * 预留只推进下一个可分配的页面ID，页面真正分配时才计入页面数
+     */
+    page_id_t AllocatePage(ExtentReservation* extent);
+    /**
+     * 归还区段里还没分配的页面，供之后的区段和单页分配复用
+     * @param extent 对象的区段，归还后为空
+     */
+    void ReleaseExtent(ExtentReservation* extent);
 
     /**
      * 释放一个页面，将其标记为可复用
@@ -84,19 +204,129 @@ class DiskManager {
      */
     void DeallocatePage(page_id_t page_id);
 
+    /**
+     * 登记页面写盘时使用的压缩算法，NONE表示取消登记
+     * 从带压缩算法的区段分配的页面自动登记；读到压缩页面时也会登记，
+     * 重启以后已经压缩的页面再写回去仍然压缩
+     */
+    void SetPageCompression(page_id_t page_id, PageCompression compression);
+
+    /** 页面登记的压缩算法，没有登记时返回NONE */
+    PageCompression GetPageCompression(page_id_t page_id) const;
+
     /**
      * 获取当前database文件的总页面数
      * @return 页面数量
      */
-    int GetNumPages() const { return num_pages_; }
+    int GetNumPages() const { return num_pages_.load(); }
+
+    /**
+     * 获取实际使用的I/O方式
+     * 请求DIRECT/IO_URING但系统不支持时，这里返回POSITIONAL
+     */
+    DiskIOMode GetIOMode() const { return io_mode_; }
+
+    /** 获取database文件路径 */
+    const std::string& GetFileName() const { return db_file_name_; }
+
+    /** 文件是否只读打开（MMAP方式），只读时所有写入和页面分配都会失败 */
+    bool IsReadOnly() const { return io_mode_ == DiskIOMode::MMAP; }
+
+    /**
+     * 页面在文件映射里的地址，映射是只读的（PROT_READ），
+     * 通过这个地址写页面会触发段错误
+     * @return 不是MMAP方式、页面不存在或者页面压缩存放时返回nullptr，
+     *         这时用ReadPage读出解压后的副本
+     */
+    const char* GetMappedPage(page_id_t page_id) const;
+
+    /**
+     * 提示内核即将顺序读取一段页面（madvise MADV_WILLNEED），
+     * 内核在后台把它们读进页缓存；不是MMAP方式时什么都不做
+     * @param first_page_id 第一个页面
+     * @param count 页面数量，超出文件末尾的部分忽略
+     */
+    void AdviseWillNeed(page_id_t first_page_id, size_t count) const;
+
+    /**
+     * database文件是否带文件头
+     * 新建的文件总是带文件头，旧版本创建的文件没有
+     */
+    bool HasFileHeader() const { return data_offset_ != 0; }
+
+    // 文件头格式版本
+    static constexpr uint32_t FILE_FORMAT_VERSION = 1;
 
    private:
+    // fstream方式的读写，调用者不需要加锁
+    void StreamReadPage(page_id_t page_id, char* page_data);
+    void StreamWritePage(page_id_t page_id, const char* page_data);
+
+    // pread/pwrite方式的读写，不持有latch_
+    // 写入可以只写页面槽位开头的length字节（压缩页面）
+    void PositionalReadPage(page_id_t page_id, char* page_data);
+    void PositionalWritePage(page_id_t page_id, const char* page_data,
+                             size_t length = PAGE_SIZE);
+
+    // 页面登记了压缩算法、而且压缩能省下空间时压缩写入，
+    // 返回false表示什么都没写，调用者按原样写
+    bool WriteCompressedPage(page_id_t page_id, const char* page_data);
+    // 读出来的槽位是压缩页面时解压回page_data
+    void DecodeStoredPage(page_id_t page_id, char* page_data);
+    // 当前配置下写入是否可以压缩
+    bool CanCompressWrites() const;
+    // 把页面槽位里压缩数据之后的部分还给文件系统
+    void PunchHole(off_t offset, size_t length);
+
+    // 分配一个单独的页面，调用者持有latch_
+    page_id_t AllocatePageLocked();
+    // 从区段里分配一个页面，调用者持有latch_
+    page_id_t AllocateExtentPageLocked(ExtentReservation* extent);
+    // 写入新页面后更新页面数量
+    void UpdatePageCount(page_id_t page_id);
+
+    // 新文件写入文件头，已有文件校验文件头，返回文件头之后的字节数
+    size_t InitFileHeader(size_t file_size);
+
+    // 只读打开时拒绝写入、分配和释放页面
+    void CheckWritable(const char* operation) const;
+
+    // 页面在文件中的offset，跳过文件头
+    off_t PageOffset(page_id_t page_id) const {
+        return static_cast<off_t>(data_offset_) +
+               static_cast<off_t>(page_id) * static_cast<off_t>(PAGE_SIZE);
+    }
+
+    // 页面号连续的一段请求用一次preadv读取，没有读满的段逐页补读
+    void VectoredReadPages(const std::vector<PageReadRequest>& requests);
+
+    // 通过io_uring提交一批读写，没有完整完成的页面用pread/pwrite补齐
+    void RingReadPages(const std::vector<PageReadRequest>& requests);
+    void RingWritePages(const std::vector<PageWriteRequest>& requests);
+
     std::string db_file_name_;           // database文件路径
-    std::fstream db_file_;               // 文件流对象，用于I/O操作
-    int num_pages_;                      // 当前database文件的总页面数
+    DiskIOMode io_mode_;                 // 实际使用的I/O方式
+    std::fstream db_file_;               // 文件流对象，STREAM方式使用
+    int fd_ = -1;                        // 文件描述符，STREAM以外的方式使用
+    size_t data_offset_ = 0;             // 第0号页面在文件中的offset
+    std::unique_ptr<IoUring> ring_;      // IO_URING方式的批量提交器
+    char* mapping_ = nullptr;            // MMAP方式下整个文件的只读映射
+    size_t mapping_size_ = 0;            // 映射的字节数
+    std::atomic<int> num_pages_;         // 当前database文件的总页面数
     int next_page_id_;                   // 下一个可分配的页面ID
-    std::mutex latch_;                   // 互斥锁，保证线程安全
+    std::mutex latch_;                   // 保护页面分配信息和文件流
     std::vector<page_id_t> free_pages_;  // 空闲页面列表，用于页面复用
+    // 归还的区段（第一个页面，页数），用于区段和页面复用
+    std::vector<std::pair<page_id_t, size_t>> free_extents_;
+
+    // 页面压缩：登记的页面和各自的算法，由compression_latch_保护；
+    // 从来没有登记过时写入不加锁
+    mutable std::mutex compression_latch_;
+    std::unordered_map<page_id_t, PageCompression> page_compression_;
+    std::atomic<bool> compression_used_{false};
+    std::atomic<bool> punch_hole_supported_{true};
+    // 文件当前的大小，页面槽位完整地在文件里时压缩页面才可以只写开头
+    std::atomic<off_t> file_size_{0};
 };
 
 }  // namespace SimpleRDBMS
\ No newline at end of file
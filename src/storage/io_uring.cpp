@@ -0,0 +1,203 @@
+/*
+ * 文件: io_uring.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: io_uring最小封装的实现
+ */
+
+#include "storage/io_uring.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/debug.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+int SysIoUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int SysIoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                    unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit,
+                                    min_complete, flags, nullptr, 0));
+}
+
+}  // namespace
+
+IoUring::IoUring(unsigned entries) {
+    if (!Setup(entries == 0 ? DEFAULT_ENTRIES : entries)) {
+        LOG_WARN("io_uring unavailable: " << std::strerror(errno));
+        Teardown();
+    }
+}
+
+IoUring::~IoUring() { Teardown(); }
+
+/**
+ * 创建ring并映射共享内存
+ *
+ * 实现思路：
+ * 1. io_uring_setup拿到ring的fd和各个字段在共享内存中的偏移
+ * 2. mmap提交队列、完成队列（可能是同一块）和SQE数组
+ * 3. 按偏移取出head/tail/mask等指针，之后直接读写共享内存
+ */
+bool IoUring::Setup(unsigned entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = SysIoUringSetup(entries, &params);
+    if (ring_fd_ < 0) {
+        return false;
+    }
+    sq_entries_ = params.sq_entries;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        return false;
+    }
+    if (single_mmap) {
+        cq_ring_ = sq_ring_;
+    } else {
+        cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            cq_ring_ = nullptr;
+            return false;
+        }
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    auto* sq = static_cast<char*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+    auto* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    LOG_DEBUG("io_uring initialized with " << sq_entries_ << " entries");
+    return true;
+}
+
+void IoUring::Teardown() {
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    cq_ring_ = nullptr;
+    if (sq_ring_ != nullptr) {
+        munmap(sq_ring_, sq_ring_size_);
+        sq_ring_ = nullptr;
+    }
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);
+        ring_fd_ = -1;
+    }
+}
+
+/**
+ * 提交一批请求并等待全部完成
+ *
+ * 实现思路：
+ * 1. 每轮最多取队列深度个请求，依次填进SQE，user_data记录请求下标
+ * 2. 用release语义更新SQ tail，让内核看到新的SQE
+ * 3. io_uring_enter提交并等待这一轮全部完成（GETEVENTS）
+ * 4. 用acquire语义读CQ tail，把结果写回请求，再推进CQ head
+ */
+bool IoUring::Submit(std::vector<Request>* requests) {
+    for (auto& request : *requests) {
+        request.result = -ECANCELED;
+    }
+    if (!IsAvailable()) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(latch_);
+
+    size_t next = 0;
+    while (next < requests->size()) {
+        unsigned batch = static_cast<unsigned>(
+            std::min<size_t>(requests->size() - next, sq_entries_));
+
+        unsigned tail = *sq_tail_;
+        unsigned mask = *sq_mask_;
+        for (unsigned i = 0; i < batch; i++) {
+            const Request& request = (*requests)[next + i];
+            unsigned index = tail & mask;
+            io_uring_sqe* sqe = &sqes_[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = request.is_write ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe->fd = request.fd;
+            sqe->addr = reinterpret_cast<uint64_t>(request.buffer);
+            sqe->len = static_cast<uint32_t>(request.length);
+            sqe->off = static_cast<uint64_t>(request.offset);
+            sqe->user_data = next + i;
+            sq_array_[index] = index;
+            tail++;
+        }
+        __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+        unsigned to_submit = batch;
+        unsigned completed = 0;
+        while (completed < batch) {
+            int ret = SysIoUringEnter(ring_fd_, to_submit, batch - completed,
+                                      IORING_ENTER_GETEVENTS);
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                LOG_ERROR("io_uring_enter failed: " << std::strerror(errno));
+                return false;
+            }
+            to_submit -= std::min<unsigned>(static_cast<unsigned>(ret),
+                                            to_submit);
+
+            unsigned head = *cq_head_;
+            unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            while (head != cq_tail) {
+                const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+                (*requests)[cqe.user_data].result = cqe.res;
+                head++;
+                completed++;
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        }
+        next += batch;
+    }
+    return true;
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,103 @@
+/*
+ * 文件: io_uring.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: io_uring的最小封装，直接使用系统调用（不依赖liburing），
+ *       一次系统调用提交一批读写请求并等待它们完成
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace SimpleRDBMS {
+
+/**
+ * IoUring - 批量同步I/O提交器
+ *
+ * 设计思路：
+ * - 构造时io_uring_setup并mmap提交队列（SQ）和完成队列（CQ）
+ * - Submit把一批请求填进SQ，一次io_uring_enter提交并等待全部完成，
+ *   请求数超过队列深度时分批进行
+ * - 每个请求的结果写回Request::result（字节数或负的errno），
+ *   短读短写由调用者补齐
+ * - 内核不支持io_uring（或者被seccomp禁止）时IsAvailable返回false，
+ *   调用者应该退回pread/pwrite
+ *
+ * 同一时刻只允许一个线程提交，内部用latch_串行化。
+ */
+class IoUring {
+   public:
+    /** 默认队列深度 */
+    static constexpr unsigned DEFAULT_ENTRIES = 64;
+
+    /** 一个读写请求 */
+    struct Request {
+        int fd;
+        bool is_write;
+        void* buffer;
+        size_t length;
+        off_t offset;
+        ssize_t result;  // 完成后的返回值：传输的字节数或者-errno
+    };
+
+    /**
+     * 构造函数
+     * @param entries 队列深度，内核会向上取整到2的幂
+     */
+    explicit IoUring(unsigned entries = DEFAULT_ENTRIES);
+
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    /** io_uring是否初始化成功 */
+    bool IsAvailable() const { return ring_fd_ >= 0; }
+
+    /**
+     * 提交一批请求并等待全部完成
+     * @param requests 请求列表，result字段会被填写
+     * @return io_uring_enter本身失败时返回false，没执行的请求result为-ECANCELED
+     */
+    bool Submit(std::vector<Request>* requests);
+
+   private:
+    // 创建ring并映射共享内存
+    bool Setup(unsigned entries);
+
+    // 解除映射并关闭ring
+    void Teardown();
+
+    int ring_fd_ = -1;
+    unsigned sq_entries_ = 0;
+
+    // 提交队列
+    void* sq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    // 完成队列，内核支持IORING_FEAT_SINGLE_MMAP时和提交队列共用一块映射
+    void* cq_ring_ = nullptr;
+    size_t cq_ring_size_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+
+    std::mutex latch_;
+};
+
+}  // namespace SimpleRDBMS
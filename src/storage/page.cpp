@@ -8,6 +8,8 @@
 
 #include "storage/page.h"
 
+#include "common/crc32c.h"
+
 namespace SimpleRDBMS {
 
 // 构造函数：初始化页面对象的基本状态
@@ -15,10 +17,12 @@ namespace SimpleRDBMS {
 // 表示当前没人引用它 is_dirty 表示这个页有没有被修改过；lsn
 // 是日志序列号，用于恢复
 Page::Page()
-    : page_id_(INVALID_PAGE_ID),
+    : data_(buffer_),
+      page_id_(INVALID_PAGE_ID),
       pin_count_(0),
       is_dirty_(false),
-      lsn_(INVALID_LSN) {
+      lsn_(INVALID_LSN),
+      rec_lsn_(INVALID_LSN) {
     // 注意：这里我们没有立刻清空 data_，是为了性能考虑
     // 真正使用 Page 数据时，再去手动 memset(data_, 0, PAGE_SIZE) 即可
     // 延迟初始化是为了避免一次性构造大量 Page 时影响性能
@@ -27,4 +31,34 @@ Page::Page()
 // 析构函数：当前没做资源释放，默认行为就够用了
 Page::~Page() = default;
 
+bool Page::VerifyPendingChecksum(size_t offset) const {
+    if (!VerifyPageChecksum(data_, offset)) {
+        return false;
+    }
+    checksum_offset_.store(static_cast<uint16_t>(offset),
+                           std::memory_order_relaxed);
+    checksum_pending_.store(false, std::memory_order_release);
+    return true;
+}
+
+uint32_t ComputePageChecksum(const char* data, size_t offset) {
+    static const char zeros[sizeof(uint32_t)] = {};
+    uint32_t crc = Crc32c(data, offset);
+    crc = Crc32c(zeros, sizeof(zeros), crc);
+    size_t rest = offset + sizeof(uint32_t);
+    crc = Crc32c(data + rest, PAGE_SIZE - rest, crc);
+    return crc == 0 ? 1 : crc;
+}
+
+void StampPageChecksum(char* data, size_t offset) {
+    uint32_t checksum = ComputePageChecksum(data, offset);
+    std::memcpy(data + offset, &checksum, sizeof(checksum));
+}
+
+bool VerifyPageChecksum(const char* data, size_t offset) {
+    uint32_t stored;
+    std::memcpy(&stored, data + offset, sizeof(stored));
+    return stored == 0 || stored == ComputePageChecksum(data, offset);
+}
+
 }  // namespace SimpleRDBMS
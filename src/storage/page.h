@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <mutex>
 #include <shared_mutex>
@@ -31,6 +34,14 @@ class Page {
     char* GetData() { return data_; }
     const char* GetData() const { return data_; }
 
+    // 数据区改为指向只读文件映射里的页面（MMAP方式，见DiskManager），
+    // 这时通过GetData()写页面会触发段错误；DetachData恢复使用自己的内存
+    void AttachMappedData(const char* mapped) {
+        data_ = const_cast<char*>(mapped);
+    }
+    void DetachData() { data_ = buffer_; }
+    bool IsMapped() const { return data_ != buffer_; }
+
     // 获取 / 设置当前页的唯一标识 ID
     page_id_t GetPageId() const { return page_id_; }
     void SetPageId(page_id_t page_id) { page_id_ = page_id; }
@@ -44,12 +55,54 @@ class Page {
     // 设置 / 获取脏页标志：表示这个页有没有被修改过
     // 用于写回磁盘判断
     bool IsDirty() const { return is_dirty_; }
-    void SetDirty(bool dirty) { is_dirty_ = dirty; }
+    void SetDirty(bool dirty) {
+        is_dirty_ = dirty;
+        if (!dirty) {
+            rec_lsn_ = INVALID_LSN;  // 写回之后页面不再需要redo
+        }
+    }
 
     // 设置 / 获取日志序列号（LSN），用于支持 WAL 日志恢复
     lsn_t GetLSN() const { return lsn_; }
     void SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
+    // 获取 / 记录 recLSN：页面上次写回之后第一次被修改的日志LSN
+    // 脏页表（DPT）由它构成，检查点据此确定恢复时redo的起点
+    lsn_t GetRecLSN() const { return rec_lsn_.load(); }
+    void MarkRecLSN(lsn_t lsn) {
+        lsn_t expected = INVALID_LSN;
+        rec_lsn_.compare_exchange_strong(expected, lsn);
+    }
+
+    // 页面校验值：校验值字段在数据区里的偏移由页面格式决定，0表示没有校验值
+    // 写盘时磁盘管理器按这个偏移在页面的副本上填好CRC32C再写；
+    // 从磁盘读入后偏移还不知道，由知道页面格式的上层第一次访问时调用
+    // VerifyChecksum核对，核对通过之后的访问只多一次原子读
+    size_t GetChecksumOffset() const {
+        return checksum_offset_.load(std::memory_order_relaxed);
+    }
+    void SetChecksumOffset(size_t offset) {
+        checksum_offset_.store(static_cast<uint16_t>(offset),
+                               std::memory_order_relaxed);
+        checksum_pending_.store(false, std::memory_order_release);
+    }
+    /** 页面刚从磁盘读入，校验值等待核对 */
+    void MarkChecksumUnverified() {
+        checksum_offset_.store(0, std::memory_order_relaxed);
+        checksum_pending_.store(true, std::memory_order_release);
+    }
+    /**
+     * 按页面格式核对从磁盘读入的校验值，已经核对过的页面直接返回true
+     * @param offset 校验值字段的偏移
+     * @return 校验值不对时返回false，页面保持待核对状态，之后的访问还会失败
+     */
+    bool VerifyChecksum(size_t offset) const {
+        if (!checksum_pending_.load(std::memory_order_acquire)) {
+            return true;
+        }
+        return VerifyPendingChecksum(offset);
+    }
+
     // 读写锁控制，保证并发访问时线程安全
     // 写锁（独占）
     void WLatch() { latch_.lock(); }
@@ -59,8 +112,13 @@ class Page {
     void RUnlatch() { latch_.unlock_shared(); }
 
    protected:
-    // 数据区，一页大小固定为 PAGE_SIZE 字节
-    char data_[PAGE_SIZE];
+    bool VerifyPendingChecksum(size_t offset) const;
+
+    // 页面自己的数据区，一页大小固定为 PAGE_SIZE 字节
+    char buffer_[PAGE_SIZE];
+
+    // 当前的数据区：通常指向buffer_，只读映射模式下可能指向文件映射
+    char* data_;
 
     // 页的唯一 ID，用于在磁盘或缓冲池中定位
     page_id_t page_id_;
@@ -74,8 +132,30 @@ class Page {
     // 页对应的日志序列号（用于恢复时重放日志）
     lsn_t lsn_;
 
+    // 写回后第一次修改的LSN，检查点线程会并发读取
+    std::atomic<lsn_t> rec_lsn_;
+
+    // 校验值字段的偏移和是否等待核对，持有读锁的多个线程可能同时核对
+    mutable std::atomic<uint16_t> checksum_offset_{0};
+    mutable std::atomic<bool> checksum_pending_{false};
+
     // 用于并发控制的读写锁
     std::shared_mutex latch_;
 };
 
+/**
+ * 计算页面的校验值：CRC32C覆盖整个页面，校验值字段按0计算
+ * 结果为0时换成1，0留给还没有写过校验值的页面
+ */
+uint32_t ComputePageChecksum(const char* data, size_t offset);
+
+/** 计算校验值并写入offset处的字段 */
+void StampPageChecksum(char* data, size_t offset);
+
+/**
+ * 核对页面上的校验值
+ * 字段为0的页面是加上校验值之前写的，或者从来没有写过，不核对
+ */
+bool VerifyPageChecksum(const char* data, size_t offset);
+
 }  // namespace SimpleRDBMS
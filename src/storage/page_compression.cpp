@@ -0,0 +1,269 @@
+/*
+ * 文件: page_compression.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 页面压缩实现，包括LZ4块格式的压缩/解压和压缩页面的磁盘格式
+ */
+
+#include "storage/page_compression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "common/crc32c.h"
+
+namespace SimpleRDBMS {
+
+namespace {
+
+constexpr char COMPRESSED_PAGE_MAGIC[4] = {'S', 'R', 'P', 'Z'};
+
+// LZ4块格式的约束：匹配至少4字节，最后5个字节必须是字面量，
+// 最后一个匹配至少在末尾12个字节之前开始
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MF_LIMIT = 12;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_LOG = 12;
+
+uint32_t Read32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t HashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+
+/** 压缩数据的校验值，和页面校验值一样用CRC32C */
+uint32_t PayloadChecksum(const char* data, size_t size) {
+    return Crc32c(data, size);
+}
+
+}  // namespace
+
+bool ParsePageCompression(const std::string& name, PageCompression* codec) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    if (lower == "none") {
+        *codec = PageCompression::NONE;
+    } else if (lower == "lz4") {
+        *codec = PageCompression::LZ4;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* PageCompressionToString(PageCompression codec) {
+    switch (codec) {
+        case PageCompression::NONE:
+            return "none";
+        case PageCompression::LZ4:
+            return "lz4";
+    }
+    return "none";
+}
+
+/**
+ * LZ4块格式压缩
+ *
+ * 实现思路：
+ * 1. 哈希表记录每个4字节序列最近出现的位置，命中且在64KB以内时向后扩展匹配
+ * 2. 每个匹配输出一个序列：token（字面量长度和匹配长度各4位）、
+ *    超过15的长度用255逐字节延伸、字面量、2字节小端偏移
+ * 3. 连续找不到匹配时步长逐渐加大，不可压缩的数据很快扫完
+ * 4. 剩下的字节作为最后一个只有字面量的序列
+ */
+size_t Lz4Compress(const char* src, size_t size, char* dst, size_t capacity) {
+    size_t op = 0;
+    size_t anchor = 0;
+
+    auto emit = [&](size_t literal_end, size_t match_length,
+                    size_t offset) -> bool {
+        size_t literals = literal_end - anchor;
+        size_t need = 1 + literals / 255 + 1 + literals;
+        if (match_length > 0) {
+            need += 2 + match_length / 255 + 1;
+        }
+        if (op + need > capacity) {
+            return false;
+        }
+        size_t match_code = match_length > 0 ? match_length - MIN_MATCH : 0;
+        uint8_t token =
+            static_cast<uint8_t>(std::min<size_t>(literals, 15) << 4) |
+            static_cast<uint8_t>(std::min<size_t>(match_code, 15));
+        dst[op++] = static_cast<char>(token);
+        if (literals >= 15) {
+            size_t rest = literals - 15;
+            for (; rest >= 255; rest -= 255) {
+                dst[op++] = static_cast<char>(255);
+            }
+            dst[op++] = static_cast<char>(rest);
+        }
+        std::memcpy(dst + op, src + anchor, literals);
+        op += literals;
+        if (match_length > 0) {
+            dst[op++] = static_cast<char>(offset & 0xFF);
+            dst[op++] = static_cast<char>(offset >> 8);
+            if (match_code >= 15) {
+                size_t rest = match_code - 15;
+                for (; rest >= 255; rest -= 255) {
+                    dst[op++] = static_cast<char>(255);
+                }
+                dst[op++] = static_cast<char>(rest);
+            }
+        }
+        return true;
+    };
+
+    if (size > MF_LIMIT) {
+        int32_t table[1 << HASH_LOG];
+        std::fill(std::begin(table), std::end(table), -1);
+        size_t match_limit = size - LAST_LITERALS;
+        size_t ip = 0;
+        while (ip + MF_LIMIT <= size) {
+            uint32_t sequence = Read32(src + ip);
+            uint32_t hash = HashSequence(sequence);
+            int32_t ref = table[hash];
+            table[hash] = static_cast<int32_t>(ip);
+            if (ref < 0 || ip - static_cast<size_t>(ref) > MAX_OFFSET ||
+                Read32(src + ref) != sequence) {
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+            size_t match_length = MIN_MATCH;
+            while (ip + match_length < match_limit &&
+                   src[ref + match_length] == src[ip + match_length]) {
+                match_length++;
+            }
+            if (!emit(ip, match_length, ip - static_cast<size_t>(ref))) {
+                return 0;
+            }
+            ip += match_length;
+            anchor = ip;
+        }
+    }
+    if (!emit(size, 0, 0)) {
+        return 0;
+    }
+    return op;
+}
+
+/**
+ * LZ4块格式解压
+ * 每一步都检查输入和输出的边界，偏移不能指到输出开头之前
+ */
+bool Lz4Decompress(const char* src, size_t size, char* dst,
+                   size_t output_size) {
+    size_t ip = 0;
+    size_t op = 0;
+    auto read_length = [&](size_t* length) {
+        while (true) {
+            if (ip >= size) {
+                return false;
+            }
+            uint8_t byte = static_cast<uint8_t>(src[ip++]);
+            *length += byte;
+            if (byte != 255) {
+                return true;
+            }
+        }
+    };
+
+    while (ip < size) {
+        uint8_t token = static_cast<uint8_t>(src[ip++]);
+        size_t literals = token >> 4;
+        if (literals == 15 && !read_length(&literals)) {
+            return false;
+        }
+        if (literals > size - ip || literals > output_size - op) {
+            return false;
+        }
+        std::memcpy(dst + op, src + ip, literals);
+        ip += literals;
+        op += literals;
+        if (ip == size) {
+            // 最后一个序列只有字面量
+            return op == output_size;
+        }
+
+        if (size - ip < 2) {
+            return false;
+        }
+        size_t offset = static_cast<uint8_t>(src[ip]) |
+                        (static_cast<size_t>(static_cast<uint8_t>(src[ip + 1]))
+                         << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return false;
+        }
+        size_t match_length = token & 0x0F;
+        if (match_length == 15 && !read_length(&match_length)) {
+            return false;
+        }
+        match_length += MIN_MATCH;
+        if (match_length > output_size - op) {
+            return false;
+        }
+        // 匹配可以和正在写的输出重叠，逐字节复制
+        const char* match = dst + op - offset;
+        for (size_t i = 0; i < match_length; i++) {
+            dst[op + i] = match[i];
+        }
+        op += match_length;
+    }
+    return false;
+}
+
+size_t CompressPage(page_id_t page_id, PageCompression codec,
+                    const char* page_data, char* out) {
+    if (codec != PageCompression::LZ4) {
+        return 0;
+    }
+    CompressedPageHeader header;
+    std::memset(&header, 0, sizeof(header));
+    size_t payload_size =
+        Lz4Compress(page_data, PAGE_SIZE, out + sizeof(header),
+                    PAGE_SIZE - sizeof(header));
+    if (payload_size == 0) {
+        return 0;
+    }
+    std::memcpy(header.magic, COMPRESSED_PAGE_MAGIC, sizeof(header.magic));
+    header.codec = static_cast<uint8_t>(codec);
+    header.page_id = page_id;
+    header.payload_size = static_cast<uint32_t>(payload_size);
+    header.checksum = PayloadChecksum(out + sizeof(header), payload_size);
+    std::memcpy(out, &header, sizeof(header));
+    return sizeof(header) + payload_size;
+}
+
+bool IsCompressedPage(const char* stored) {
+    return std::memcmp(stored, COMPRESSED_PAGE_MAGIC,
+                       sizeof(COMPRESSED_PAGE_MAGIC)) == 0;
+}
+
+bool DecompressPage(page_id_t page_id, const char* stored, char* page_data,
+                    PageCompression* codec) {
+    CompressedPageHeader header;
+    std::memcpy(&header, stored, sizeof(header));
+    if (!IsCompressedPage(stored) || header.page_id != page_id ||
+        header.codec != static_cast<uint8_t>(PageCompression::LZ4) ||
+        header.payload_size > PAGE_SIZE - sizeof(header)) {
+        return false;
+    }
+    const char* payload = stored + sizeof(header);
+    if (PayloadChecksum(payload, header.payload_size) != header.checksum) {
+        return false;
+    }
+    if (!Lz4Decompress(payload, header.payload_size, page_data, PAGE_SIZE)) {
+        return false;
+    }
+    *codec = static_cast<PageCompression>(header.codec);
+    return true;
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,79 @@
+/*
+ * 文件: page_compression.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: 页面压缩，磁盘管理器写盘时把页面压缩成带头部的格式，
+ *       读盘时识别并解压；压缩算法是自带的LZ4块格式实现，不依赖liblz4
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "common/config.h"
+#include "common/types.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * 压缩页面在页面槽位开头的头部
+ * 后面紧跟payload_size字节的压缩数据，槽位剩下的部分没有意义（通常是洞）
+ * 校验值覆盖压缩数据，和magic、page_id一起把压缩页面和普通页面区分开
+ */
+struct CompressedPageHeader {
+    char magic[4];
+    uint8_t codec;
+    uint8_t reserved[3];
+    page_id_t page_id;
+    uint32_t payload_size;
+    uint32_t checksum;
+};
+
+/**
+ * 解析压缩算法名称（none / lz4，不区分大小写）
+ * @return 名称有效返回true
+ */
+bool ParsePageCompression(const std::string& name, PageCompression* codec);
+
+/** 压缩算法转换为名称 */
+const char* PageCompressionToString(PageCompression codec);
+
+/**
+ * LZ4块格式压缩
+ * @param capacity dst的大小
+ * @return 压缩后的字节数，放不进capacity时返回0
+ */
+size_t Lz4Compress(const char* src, size_t size, char* dst, size_t capacity);
+
+/**
+ * LZ4块格式解压
+ * @param output_size 解压后必须正好是这么多字节
+ * @return 数据完整且长度一致返回true，损坏的输入不会越界读写
+ */
+bool Lz4Decompress(const char* src, size_t size, char* dst,
+                   size_t output_size);
+
+/**
+ * 把一个页面压缩成磁盘格式
+ * @param out 输出缓冲区，至少PAGE_SIZE字节
+ * @return 头部加压缩数据的字节数；压缩后不比原页面小时返回0，调用者按原样写
+ */
+size_t CompressPage(page_id_t page_id, PageCompression codec,
+                    const char* page_data, char* out);
+
+/** 页面槽位开头是不是压缩页面的头部（只看magic） */
+bool IsCompressedPage(const char* stored);
+
+/**
+ * 把磁盘格式的压缩页面解压成页面
+ * @param stored 读出来的页面槽位，PAGE_SIZE字节
+ * @param page_data 输出参数，PAGE_SIZE字节，不能和stored重叠
+ * @param codec 输出参数，页面使用的压缩算法
+ * @return 头部、校验值或者压缩数据不对时返回false
+ */
+bool DecompressPage(page_id_t page_id, const char* stored, char* page_data,
+                    PageCompression* codec);
+
+}  // namespace SimpleRDBMS
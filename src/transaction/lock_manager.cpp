@@ -1,132 +1,170 @@
 /*
  * 文件: lock_manager.cpp
  * 描述: 事务锁管理器实现，支持 S/X 锁申请、升级、释放，以及基本的锁调度逻辑。
+ *       锁表按RID分片，队列和请求从分片的池里分配。
  * 作者: QCQCQC
  * 日期: 2025-6-1
  */
 
 #include "transaction/lock_manager.h"
 
+#include <algorithm>
+#include <functional>
+
+#include "common/debug.h"
+#include "stat/stat.h"
+#include "stat/trace.h"
+
 namespace SimpleRDBMS {
 
+LockManager::~LockManager() { StopDeadlockDetection(); }
+
 /**
- * 申请共享锁（S锁）
- * - 如果当前事务处于收缩阶段（shrinking），直接 abort。
- * - 如果已有 S 或 X 锁，直接返回 true。
- * - 否则尝试申请，如果冲突则等待一定时间。
+ * RID所在的分片
+ * RID的哈希值低位主要来自页号，乘一个奇数常量后取高位，
+ * 同一页面上的记录也能分散到不同分片
  */
-bool LockManager::LockShared(Transaction* txn, const RID& rid) {
-    std::unique_lock<std::mutex> lock(latch_);
+LockManager::LockShard& LockManager::GetShard(const RID& rid) {
+    uint64_t hash = std::hash<RID>()(rid);
+    hash *= 0x9E3779B97F4A7C15ULL;
+    return shards_[(hash >> 32) % LOCK_TABLE_SHARDS];
+}
 
-    if (txn->GetState() == TransactionState::SHRINKING) {
-        txn->SetState(TransactionState::ABORTED);
-        return false;
+LockManager::LockRequestQueue* LockManager::GetQueue(LockShard* shard,
+                                                     const RID& rid) {
+    auto it = shard->lock_table.find(rid);
+    if (it != shard->lock_table.end()) {
+        return it->second;
     }
-
-    if (txn->GetExclusiveLockSet().count(rid) > 0 ||
-        txn->GetSharedLockSet().count(rid) > 0) {
-        return true;
+    LockRequestQueue* queue;
+    if (!shard->free_queues.empty()) {
+        queue = shard->free_queues.back();
+        shard->free_queues.pop_back();
+    } else {
+        queue = &shard->queue_pool.emplace_back();
     }
+    shard->lock_table.emplace(rid, queue);
+    return queue;
+}
 
-    // 创建请求队列（如无）
-    if (lock_table_.find(rid) == lock_table_.end()) {
-        lock_table_[rid] = std::make_unique<LockRequestQueue>();
+LockManager::LockRequest* LockManager::NewRequest(LockShard* shard,
+                                                  Transaction* txn,
+                                                  LockMode lock_mode) {
+    LockRequest* request;
+    if (!shard->free_requests.empty()) {
+        request = shard->free_requests.back();
+        shard->free_requests.pop_back();
+    } else {
+        request = &shard->request_pool.emplace_back();
     }
-    auto* queue = lock_table_[rid].get();
-
-    auto request = std::make_unique<LockRequest>();
     request->txn_id = txn->GetTxnId();
-    request->lock_mode = LockMode::SHARED;
+    request->lock_mode = lock_mode;
     request->granted = false;
+    request->txn = txn;
+    return request;
+}
 
-    // 判断是否可立即获得锁
-    bool can_grant = GrantLock(request.get(), queue);
-    if (can_grant) {
-        request->granted = true;
-        txn->AddSharedLock(rid);
-        queue->request_queue.push_back(std::move(request));
-        return true;
+void LockManager::RemoveRequest(LockShard* shard, const RID& rid,
+                                LockRequestQueue* queue,
+                                LockRequest* request) {
+    auto& requests = queue->request_queue;
+    auto it = std::find(requests.begin(), requests.end(), request);
+    if (it != requests.end()) {
+        requests.erase(it);
+        shard->free_requests.push_back(request);
     }
+    // 没有请求也就没有等待者，队列可以放回池里
+    if (requests.empty() && !queue->upgrading) {
+        shard->lock_table.erase(rid);
+        shard->free_queues.push_back(queue);
+    }
+}
 
-    // 加入队列并等待
-    queue->request_queue.push_back(std::move(request));
-    auto timeout = std::chrono::milliseconds(100);
-    if (queue->cv.wait_for(lock, timeout, [&]() {
-            return CheckAbort(txn) ||
-                   GrantLock(queue->request_queue.back().get(), queue);
-        })) {
-        if (CheckAbort(txn)) {
-            queue->request_queue.pop_back();
-            return false;
+LockManager::LockRequest* LockManager::FindRequest(LockRequestQueue* queue,
+                                                   txn_id_t txn_id) {
+    for (LockRequest* request : queue->request_queue) {
+        if (request->txn_id == txn_id) {
+            return request;
         }
-        queue->request_queue.back()->granted = true;
-        txn->AddSharedLock(rid);
-        return true;
     }
+    return nullptr;
+}
 
-    // 超时失败
-    queue->request_queue.pop_back();
-    return false;
+/**
+ * 申请共享锁（S锁）
+ * - 如果当前事务处于收缩阶段（shrinking），直接 abort。
+ * - 如果已有 S 或 X 锁，直接返回 true。
+ * - 否则尝试申请，如果冲突则等待一定时间。
+ */
+bool LockManager::LockShared(Transaction* txn, const RID& rid) {
+    return AcquireLock(txn, rid, LockMode::SHARED);
 }
 
 /**
  * 申请排他锁（X锁）
  */
 bool LockManager::LockExclusive(Transaction* txn, const RID& rid) {
-    std::unique_lock<std::mutex> lock(latch_);
+    return AcquireLock(txn, rid, LockMode::EXCLUSIVE);
+}
+
+/**
+ * 申请锁的公共流程
+ * 实现思路：
+ * 1. 只锁住RID所在的分片
+ * 2. 能立即授予就授予，否则把请求放进队列，在分片的锁上等待
+ * 3. 等待时检查的是自己的请求，超时或事务被中止时把它放回池里
+ */
+bool LockManager::AcquireLock(Transaction* txn, const RID& rid,
+                              LockMode lock_mode) {
+    LockShard& shard = GetShard(rid);
+    std::unique_lock<std::mutex> lock(shard.latch);
 
     if (txn->GetState() == TransactionState::SHRINKING) {
         txn->SetState(TransactionState::ABORTED);
         return false;
     }
 
-    if (txn->GetExclusiveLockSet().count(rid) > 0) {
-        return true;
-    }
-
-    if (lock_table_.find(rid) == lock_table_.end()) {
-        lock_table_[rid] = std::make_unique<LockRequestQueue>();
-    }
-    auto* queue = lock_table_[rid].get();
-
-    auto request = std::make_unique<LockRequest>();
-    request->txn_id = txn->GetTxnId();
-    request->lock_mode = LockMode::EXCLUSIVE;
-    request->granted = false;
-
-    bool can_grant = GrantLock(request.get(), queue);
-    if (can_grant) {
-        request->granted = true;
-        txn->AddExclusiveLock(rid);
-        queue->request_queue.push_back(std::move(request));
+    if (txn->GetExclusiveLockSet().count(rid) > 0 ||
+        (lock_mode == LockMode::SHARED &&
+         txn->GetSharedLockSet().count(rid) > 0)) {
         return true;
     }
 
-    // 加入队列等待
-    queue->request_queue.push_back(std::move(request));
-    auto timeout = std::chrono::milliseconds(100);
-    if (queue->cv.wait_for(lock, timeout, [&]() {
-            return CheckAbort(txn) ||
-                   GrantLock(queue->request_queue.back().get(), queue);
-        })) {
-        if (CheckAbort(txn)) {
-            queue->request_queue.pop_back();
+    LockRequestQueue* queue = GetQueue(&shard, rid);
+    LockRequest* request = NewRequest(&shard, txn, lock_mode);
+    queue->request_queue.push_back(request);
+
+    if (!GrantLock(request, queue)) {
+        Statistics::PerformanceTimer wait_timer;
+        bool woken;
+        {
+            TRACE_SPAN("lock", "LockManager::WaitRowLock");
+            woken = queue->cv.wait_for(lock, WaitTimeout(), [&]() {
+                return CheckAbort(txn) || GrantLock(request, queue);
+            });
+        }
+        STATS.RecordLockWait(wait_timer.GetElapsedMs());
+        if (!woken || CheckAbort(txn)) {
+            RemoveRequest(&shard, rid, queue, request);
             return false;
         }
-        queue->request_queue.back()->granted = true;
-        txn->AddExclusiveLock(rid);
-        return true;
     }
 
-    queue->request_queue.pop_back();
-    return false;
+    request->granted = true;
+    if (lock_mode == LockMode::SHARED) {
+        txn->AddSharedLock(rid);
+    } else {
+        txn->AddExclusiveLock(rid);
+    }
+    return true;
 }
 
 /**
  * 将已有 S 锁升级为 X 锁
  */
 bool LockManager::LockUpgrade(Transaction* txn, const RID& rid) {
-    std::unique_lock<std::mutex> lock(latch_);
+    LockShard& shard = GetShard(rid);
+    std::unique_lock<std::mutex> lock(shard.latch);
 
     if (txn->GetState() == TransactionState::SHRINKING) {
         txn->SetState(TransactionState::ABORTED);
@@ -141,50 +179,45 @@ bool LockManager::LockUpgrade(Transaction* txn, const RID& rid) {
         return false;
     }
 
-    auto* queue = lock_table_[rid].get();
+    auto table_it = shard.lock_table.find(rid);
+    if (table_it == shard.lock_table.end()) {
+        return false;
+    }
+    LockRequestQueue* queue = table_it->second;
     if (queue->upgrading) {
         txn->SetState(TransactionState::ABORTED);
         return false;
     }
-    queue->upgrading = true;
 
-    auto it = queue->request_queue.begin();
-    while (it != queue->request_queue.end()) {
-        if ((*it)->txn_id == txn->GetTxnId()) {
-            (*it)->lock_mode = LockMode::EXCLUSIVE;
-            (*it)->granted = false;
-            break;
-        }
-        ++it;
-    }
-    if (it == queue->request_queue.end()) {
-        queue->upgrading = false;
+    LockRequest* request = FindRequest(queue, txn->GetTxnId());
+    if (request == nullptr) {
         return false;
     }
+    queue->upgrading = true;
+    request->lock_mode = LockMode::EXCLUSIVE;
+    request->granted = false;
 
     txn->RemoveSharedLock(rid);
 
-    bool can_grant = GrantLock(it->get(), queue);
-    if (can_grant) {
-        (*it)->granted = true;
-        txn->AddExclusiveLock(rid);
-        queue->upgrading = false;
-        queue->cv.notify_all();
-        return true;
-    }
-
-    // 等待升级锁
-    auto timeout = std::chrono::milliseconds(100);
-    if (queue->cv.wait_for(lock, timeout, [&]() {
-            return CheckAbort(txn) || GrantLock(it->get(), queue);
-        })) {
-        if (CheckAbort(txn)) {
+    bool granted = GrantLock(request, queue);
+    if (!granted) {
+        Statistics::PerformanceTimer wait_timer;
+        {
+            TRACE_SPAN("lock", "LockManager::WaitUpgrade");
+            granted = queue->cv.wait_for(lock, WaitTimeout(), [&]() {
+                return CheckAbort(txn) || GrantLock(request, queue);
+            });
+        }
+        STATS.RecordLockWait(wait_timer.GetElapsedMs());
+        if (granted && CheckAbort(txn)) {
             queue->upgrading = false;
             queue->cv.notify_all();
-            queue->request_queue.erase(it);
+            RemoveRequest(&shard, rid, queue, request);
             return false;
         }
-        (*it)->granted = true;
+    }
+    if (granted) {
+        request->granted = true;
         txn->AddExclusiveLock(rid);
         queue->upgrading = false;
         queue->cv.notify_all();
@@ -193,8 +226,8 @@ bool LockManager::LockUpgrade(Transaction* txn, const RID& rid) {
 
     // 升级失败还原
     txn->AddSharedLock(rid);
-    (*it)->lock_mode = LockMode::SHARED;
-    (*it)->granted = true;
+    request->lock_mode = LockMode::SHARED;
+    request->granted = true;
     queue->upgrading = false;
     queue->cv.notify_all();
     return false;
@@ -204,78 +237,248 @@ bool LockManager::LockUpgrade(Transaction* txn, const RID& rid) {
  * 释放某个资源上的锁
  */
 bool LockManager::Unlock(Transaction* txn, const RID& rid) {
-    std::unique_lock<std::mutex> lock(latch_);
+    LockShard& shard = GetShard(rid);
+    std::unique_lock<std::mutex> lock(shard.latch);
 
     if (txn->GetState() == TransactionState::GROWING) {
         txn->SetState(TransactionState::SHRINKING);
     }
 
-    bool found = false;
-    if (txn->GetSharedLockSet().count(rid)) {
-        txn->RemoveSharedLock(rid);
-        found = true;
-    } else if (txn->GetExclusiveLockSet().count(rid)) {
-        txn->RemoveExclusiveLock(rid);
-        found = true;
+    if (txn->GetSharedLockSet().count(rid) == 0 &&
+        txn->GetExclusiveLockSet().count(rid) == 0) {
+        return false;
     }
+    ReleaseLock(&shard, txn, rid);
+    return true;
+}
 
-    if (!found) return false;
+/**
+ * 释放该事务上的所有锁
+ * 先释放记录锁，再释放表锁；记录锁的释放见 ReleaseRowLocks
+ */
+void LockManager::UnlockAll(Transaction* txn) {
+    std::vector<RID> rids(txn->GetSharedLockSet().begin(),
+                          txn->GetSharedLockSet().end());
+    for (const auto& rid : txn->GetExclusiveLockSet()) {
+        if (txn->GetSharedLockSet().count(rid) == 0) {
+            rids.push_back(rid);
+        }
+    }
+    ReleaseRowLocks(txn, rids);
 
-    auto* queue = lock_table_[rid].get();
-    auto it = queue->request_queue.begin();
-    while (it != queue->request_queue.end()) {
-        if ((*it)->txn_id == txn->GetTxnId()) {
-            queue->request_queue.erase(it);
-            break;
+    if (txn->GetTableLockSet().empty()) {
+        return;
+    }
+    std::vector<oid_t> tables;
+    for (const auto& [table_oid, mode] : txn->GetTableLockSet()) {
+        tables.push_back(table_oid);
+    }
+    std::unique_lock<std::mutex> lock(table_latch_);
+    for (oid_t table_oid : tables) {
+        txn->RemoveTableLock(table_oid);
+        txn->TakeTableRowLocks(table_oid);
+        auto it = table_locks_.find(table_oid);
+        if (it == table_locks_.end()) {
+            continue;
         }
-        ++it;
+        auto& granted = it->second.granted;
+        granted.erase(std::remove_if(granted.begin(), granted.end(),
+                                     [txn](const LockRequest& request) {
+                                         return request.txn_id ==
+                                                txn->GetTxnId();
+                                     }),
+                      granted.end());
+        it->second.cv.notify_all();
     }
+}
 
-    GrantNewLocksInQueue(queue);
-    queue->cv.notify_all();
+void LockManager::ReleaseRowLocks(Transaction* txn,
+                                  const std::vector<RID>& rids) {
+    std::vector<std::vector<RID>> by_shard(LOCK_TABLE_SHARDS);
+    for (const auto& rid : rids) {
+        by_shard[&GetShard(rid) - shards_.data()].push_back(rid);
+    }
+    for (size_t i = 0; i < LOCK_TABLE_SHARDS; i++) {
+        if (by_shard[i].empty()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(shards_[i].latch);
+        for (const auto& rid : by_shard[i]) {
+            ReleaseLock(&shards_[i], txn, rid);
+        }
+    }
+}
+
+bool LockManager::LockTable(Transaction* txn, oid_t table_oid,
+                            LockMode lock_mode) {
+    return AcquireTableLock(txn, table_oid, lock_mode, true);
+}
 
+/**
+ * 表锁的加锁流程
+ * 实现思路：
+ * 1. 事务已经持有的表锁覆盖请求的模式时不访问锁表
+ * 2. 否则算出合并后的模式，和其他事务已经授予的表锁逐个检查兼容性
+ * 3. 冲突时按需要等待，授予后更新自己的记录，没有就新加一条
+ */
+bool LockManager::AcquireTableLock(Transaction* txn, oid_t table_oid,
+                                   LockMode lock_mode, bool wait) {
+    if (txn->GetState() == TransactionState::SHRINKING) {
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+    }
+    LockMode held;
+    bool has_lock = txn->GetTableLockMode(table_oid, &held);
+    if (has_lock && Covers(held, lock_mode)) {
+        return true;
+    }
+    LockMode target = has_lock ? CombineModes(held, lock_mode) : lock_mode;
+
+    std::unique_lock<std::mutex> lock(table_latch_);
+    TableLockQueue& queue = table_locks_[table_oid];
+    auto can_grant = [&]() {
+        for (const auto& request : queue.granted) {
+            if (request.txn_id != txn->GetTxnId() &&
+                !IsCompatible(request.lock_mode, target)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!can_grant()) {
+        if (!wait) {
+            return false;
+        }
+        queue.waiting.push_back(
+            LockRequest{txn->GetTxnId(), target, false, txn});
+        Statistics::PerformanceTimer wait_timer;
+        bool woken;
+        {
+            TRACE_SPAN("lock", "LockManager::WaitTableLock");
+            woken = queue.cv.wait_for(lock, WaitTimeout(), [&]() {
+                return CheckAbort(txn) || can_grant();
+            });
+        }
+        STATS.RecordLockWait(wait_timer.GetElapsedMs());
+        auto& waiting = queue.waiting;
+        waiting.erase(std::remove_if(waiting.begin(), waiting.end(),
+                                     [txn](const LockRequest& request) {
+                                         return request.txn == txn;
+                                     }),
+                      waiting.end());
+        if (!woken || CheckAbort(txn)) {
+            return false;
+        }
+    }
+
+    bool updated = false;
+    for (auto& request : queue.granted) {
+        if (request.txn_id == txn->GetTxnId()) {
+            request.lock_mode = target;
+            updated = true;
+            break;
+        }
+    }
+    if (!updated) {
+        queue.granted.push_back(
+            LockRequest{txn->GetTxnId(), target, true, txn});
+    }
+    txn->SetTableLock(table_oid, target);
     return true;
 }
 
 /**
- * 释放该事务上的所有锁
+ * 给表里的一条记录加锁
+ * 实现思路：
+ * 1. 表锁已经覆盖时直接返回，锁升级之后的记录都走这里
+ * 2. 先加意向锁再加记录锁，记下记录属于哪张表
+ * 3. 记录锁数到达阈值时尝试升级，失败（别的事务持有冲突的表锁）
+ *    就继续用记录锁，每再多一个阈值的记录锁再试一次
  */
-void LockManager::UnlockAll(Transaction* txn) {
-    std::unique_lock<std::mutex> lock(latch_);
+bool LockManager::LockRow(Transaction* txn, oid_t table_oid, const RID& rid,
+                          LockMode lock_mode) {
+    LockMode held;
+    if (txn->GetTableLockMode(table_oid, &held) && Covers(held, lock_mode)) {
+        return true;
+    }
+    if (txn->GetExclusiveLockSet().count(rid) > 0 ||
+        (lock_mode == LockMode::SHARED &&
+         txn->GetSharedLockSet().count(rid) > 0)) {
+        return true;
+    }
+    LockMode intention = lock_mode == LockMode::EXCLUSIVE
+                             ? LockMode::INTENTION_EXCLUSIVE
+                             : LockMode::INTENTION_SHARED;
+    if (!LockTable(txn, table_oid, intention) ||
+        !AcquireLock(txn, rid, lock_mode)) {
+        return false;
+    }
+    size_t row_locks = txn->AddTableRowLock(table_oid, rid);
+    if (row_locks % LOCK_ESCALATION_THRESHOLD == 0) {
+        EscalateRowLocks(txn, table_oid);
+    }
+    return true;
+}
 
-    std::unordered_set<RID> lock_set;
-    for (const auto& rid : txn->GetSharedLockSet()) {
-        lock_set.insert(rid);
+void LockManager::EscalateRowLocks(Transaction* txn, oid_t table_oid) {
+    std::vector<RID> rids = txn->TakeTableRowLocks(table_oid);
+    LockMode target = LockMode::SHARED;
+    for (const auto& rid : rids) {
+        if (txn->GetExclusiveLockSet().count(rid) > 0) {
+            target = LockMode::EXCLUSIVE;
+            break;
+        }
     }
-    for (const auto& rid : txn->GetExclusiveLockSet()) {
-        lock_set.insert(rid);
+    if (!AcquireTableLock(txn, table_oid, target, false)) {
+        for (const auto& rid : rids) {
+            txn->AddTableRowLock(table_oid, rid);
+        }
+        return;
     }
+    ReleaseRowLocks(txn, rids);
+}
 
-    for (const auto& rid : lock_set) {
-        txn->RemoveSharedLock(rid);
-        txn->RemoveExclusiveLock(rid);
+size_t LockManager::GetRowLockCount() {
+    size_t count = 0;
+    for (auto& shard : shards_) {
+        std::unique_lock<std::mutex> lock(shard.latch);
+        count += shard.lock_table.size();
+    }
+    return count;
+}
 
-        if (lock_table_.find(rid) != lock_table_.end()) {
-            auto* queue = lock_table_[rid].get();
-            auto it = queue->request_queue.begin();
-            while (it != queue->request_queue.end()) {
-                if ((*it)->txn_id == txn->GetTxnId()) {
-                    queue->request_queue.erase(it);
-                    break;
-                }
-                ++it;
-            }
-            GrantNewLocksInQueue(queue);
-            queue->cv.notify_all();
+/**
+ * 释放事务在一条记录上的锁
+ * 同一事务在这条记录上可能同时有 S 和 X 两个请求，都要放回池里
+ */
+void LockManager::ReleaseLock(LockShard* shard, Transaction* txn,
+                              const RID& rid) {
+    txn->RemoveSharedLock(rid);
+    txn->RemoveExclusiveLock(rid);
+
+    auto table_it = shard->lock_table.find(rid);
+    if (table_it == shard->lock_table.end()) {
+        return;
+    }
+    LockRequestQueue* queue = table_it->second;
+    // 先唤醒等待者，RemoveRequest可能把空队列放回池里
+    queue->cv.notify_all();
+    LockRequest* request;
+    while ((request = FindRequest(queue, txn->GetTxnId())) != nullptr) {
+        bool last = queue->request_queue.size() == 1;
+        RemoveRequest(shard, rid, queue, request);
+        if (last) {
+            return;
         }
     }
+    GrantNewLocksInQueue(queue);
 }
 
 /**
  * 判断当前请求是否可以被授权
  */
 bool LockManager::GrantLock(LockRequest* request, LockRequestQueue* queue) {
-    for (const auto& req : queue->request_queue) {
+    for (const LockRequest* req : queue->request_queue) {
         if (!req->granted) continue;
         if (req->txn_id == request->txn_id) continue;
 
@@ -296,13 +499,246 @@ bool LockManager::GrantLock(LockRequest* request, LockRequestQueue* queue) {
  * 每次释放锁后，尝试授权队列中尚未 granted 的锁请求
  */
 void LockManager::GrantNewLocksInQueue(LockRequestQueue* queue) {
-    for (auto& request : queue->request_queue) {
-        if (!request->granted && GrantLock(request.get(), queue)) {
+    for (LockRequest* request : queue->request_queue) {
+        if (!request->granted && GrantLock(request, queue)) {
             request->granted = true;
         }
     }
 }
 
+void LockManager::StartDeadlockDetection(
+    const DeadlockDetectorConfig& config) {
+    StopDeadlockDetection();
+    {
+        std::lock_guard<std::mutex> guard(detector_latch_);
+        detector_config_ = config;
+        detector_running_ = true;
+    }
+    wait_timeout_ms_ = config.wait_timeout.count();
+    detector_thread_ = std::thread(&LockManager::DeadlockDetectionLoop, this);
+    LOG_INFO("Deadlock detector started: interval="
+             << config.interval.count()
+             << "ms, wait_timeout=" << config.wait_timeout.count() << "ms");
+}
+
+void LockManager::StopDeadlockDetection() {
+    {
+        std::lock_guard<std::mutex> guard(detector_latch_);
+        if (!detector_running_) {
+            return;
+        }
+        detector_running_ = false;
+    }
+    detector_cv_.notify_one();
+    if (detector_thread_.joinable()) {
+        detector_thread_.join();
+    }
+    wait_timeout_ms_ = LOCK_WAIT_TIMEOUT_MS;
+    LOG_INFO("Deadlock detector stopped, " << deadlock_count_.load()
+                                           << " deadlocks resolved");
+}
+
+void LockManager::DeadlockDetectionLoop() {
+    std::unique_lock<std::mutex> lock(detector_latch_);
+    while (detector_running_) {
+        detector_cv_.wait_for(lock, detector_config_.interval,
+                              [this] { return !detector_running_; });
+        if (!detector_running_) {
+            break;
+        }
+        lock.unlock();
+        RunDeadlockDetection();
+        lock.lock();
+    }
+}
+
+/**
+ * 执行一轮死锁检测
+ * 实现思路：
+ * 1. 按固定顺序锁住所有分片和表锁，其他路径同时最多持有其中一个，
+ *    不会和检测线程互相等待；这一刻的等待图是一致的
+ * 2. 记录锁队列里每个未授予的请求指向和它冲突的已授予请求的事务，
+ *    等待升级的请求挡住后来的 S 请求；表锁的等待者指向不兼容的持有者
+ * 3. 反复找环，每个环中止事务ID最大的事务，把它从图里去掉，
+ *    唤醒它等待的队列，它在等待条件里看到自己被中止后返回失败
+ */
+size_t LockManager::RunDeadlockDetection() {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(LOCK_TABLE_SHARDS + 1);
+    for (auto& shard : shards_) {
+        locks.emplace_back(shard.latch);
+    }
+    locks.emplace_back(table_latch_);
+
+    WaitsForGraph graph;
+    std::unordered_map<txn_id_t, Transaction*> waiters;
+    std::unordered_map<txn_id_t, std::vector<std::condition_variable*>>
+        waiter_cvs;
+    auto add_waiter = [&](Transaction* txn, std::condition_variable* cv) {
+        waiters[txn->GetTxnId()] = txn;
+        waiter_cvs[txn->GetTxnId()].push_back(cv);
+    };
+    for (auto& shard : shards_) {
+        for (auto& [rid, queue] : shard.lock_table) {
+            const LockRequest* upgrader = nullptr;
+            for (const LockRequest* request : queue->request_queue) {
+                if (!request->granted &&
+                    request->lock_mode == LockMode::EXCLUSIVE &&
+                    queue->upgrading) {
+                    upgrader = request;
+                }
+            }
+            for (const LockRequest* request : queue->request_queue) {
+                if (request->granted || request->txn->IsAborted()) {
+                    continue;
+                }
+                for (const LockRequest* holder : queue->request_queue) {
+                    if (holder->granted && holder->txn_id != request->txn_id &&
+                        (holder->lock_mode == LockMode::EXCLUSIVE ||
+                         request->lock_mode == LockMode::EXCLUSIVE)) {
+                        graph[request->txn_id].insert(holder->txn_id);
+                    }
+                }
+                if (upgrader != nullptr && upgrader != request &&
+                    request->lock_mode == LockMode::SHARED) {
+                    graph[request->txn_id].insert(upgrader->txn_id);
+                }
+                add_waiter(request->txn, &queue->cv);
+            }
+        }
+    }
+    for (auto& [table_oid, queue] : table_locks_) {
+        for (const LockRequest& request : queue.waiting) {
+            if (request.txn->IsAborted()) {
+                continue;
+            }
+            for (const LockRequest& holder : queue.granted) {
+                if (holder.txn_id != request.txn_id &&
+                    !IsCompatible(holder.lock_mode, request.lock_mode)) {
+                    graph[request.txn_id].insert(holder.txn_id);
+                }
+            }
+            add_waiter(request.txn, &queue.cv);
+        }
+    }
+
+    size_t aborted = 0;
+    std::vector<txn_id_t> cycle;
+    while (FindCycle(graph, &cycle)) {
+        txn_id_t victim = *std::max_element(cycle.begin(), cycle.end());
+        LOG_WARN("Deadlock detected among " << cycle.size()
+                                            << " transactions, aborting txn "
+                                            << victim);
+        waiters[victim]->SetState(TransactionState::ABORTED);
+        for (auto* cv : waiter_cvs[victim]) {
+            cv->notify_all();
+        }
+        graph.erase(victim);
+        for (auto& [waiter, holders] : graph) {
+            holders.erase(victim);
+        }
+        aborted++;
+        deadlock_count_++;
+        STATS.RecordDeadlock();
+    }
+    return aborted;
+}
+
+/**
+ * 深度优先搜索找环
+ * 从事务ID小的节点开始，邻居也按ID顺序访问，同样的图总是找到同一个环
+ */
+bool LockManager::FindCycle(const WaitsForGraph& graph,
+                            std::vector<txn_id_t>* cycle) {
+    enum class Color { WHITE, GRAY, BLACK };
+    std::unordered_map<txn_id_t, Color> colors;
+    std::vector<txn_id_t> path;
+
+    std::function<bool(txn_id_t)> visit = [&](txn_id_t txn_id) {
+        colors[txn_id] = Color::GRAY;
+        path.push_back(txn_id);
+        auto it = graph.find(txn_id);
+        if (it != graph.end()) {
+            for (txn_id_t next : it->second) {
+                Color color = colors.count(next) ? colors[next] : Color::WHITE;
+                if (color == Color::GRAY) {
+                    auto start = std::find(path.begin(), path.end(), next);
+                    cycle->assign(start, path.end());
+                    return true;
+                }
+                if (color == Color::WHITE && visit(next)) {
+                    return true;
+                }
+            }
+        }
+        path.pop_back();
+        colors[txn_id] = Color::BLACK;
+        return false;
+    };
+
+    for (const auto& [txn_id, holders] : graph) {
+        if (!colors.count(txn_id) && visit(txn_id)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 表锁的兼容矩阵
+ *         IS   IX   S    SIX  X
+ *   IS    是   是   是   是   否
+ *   IX    是   是   否   否   否
+ *   S     是   否   是   否   否
+ *   SIX   是   否   否   否   否
+ *   X     否   否   否   否   否
+ */
+bool LockManager::IsCompatible(LockMode held, LockMode requested) {
+    if (held == LockMode::EXCLUSIVE || requested == LockMode::EXCLUSIVE) {
+        return false;
+    }
+    if (held == LockMode::INTENTION_SHARED ||
+        requested == LockMode::INTENTION_SHARED) {
+        return true;
+    }
+    if (held == LockMode::SHARED_INTENTION_EXCLUSIVE ||
+        requested == LockMode::SHARED_INTENTION_EXCLUSIVE) {
+        return false;
+    }
+    return held == requested;
+}
+
+/**
+ * 锁的强弱：IS < IX < SIX < X，IS < S < SIX
+ */
+bool LockManager::Covers(LockMode held, LockMode requested) {
+    if (held == requested || held == LockMode::EXCLUSIVE) {
+        return true;
+    }
+    switch (held) {
+        case LockMode::SHARED_INTENTION_EXCLUSIVE:
+            return requested != LockMode::EXCLUSIVE;
+        case LockMode::SHARED:
+        case LockMode::INTENTION_EXCLUSIVE:
+            return requested == LockMode::INTENTION_SHARED;
+        default:
+            return false;
+    }
+}
+
+/**
+ * 两种模式中一个覆盖另一个时取较强的，只有 S 和 IX 互不覆盖，合并成 SIX
+ */
+LockMode LockManager::CombineModes(LockMode held, LockMode requested) {
+    if (Covers(held, requested)) {
+        return held;
+    }
+    if (Covers(requested, held)) {
+        return requested;
+    }
+    return LockMode::SHARED_INTENTION_EXCLUSIVE;
+}
+
 /**
  * 判断事务是否已被中止
  */
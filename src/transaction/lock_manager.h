@@ -11,12 +11,17 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
-#include <list>
-#include <memory>
+#include <deque>
+#include <map>
 #include <mutex>
+#include <set>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "common/config.h"
 #include "common/types.h"
@@ -25,20 +30,27 @@
 namespace SimpleRDBMS {
 
 /**
- * LockMode 枚举表示锁的类型：
- * - SHARED: 共享锁，允许多个事务并发读取。
- * - EXCLUSIVE: 排他锁，只允许一个事务写入。
+ * 后台死锁检测线程的配置
  */
-enum class LockMode { SHARED = 0, EXCLUSIVE };
+struct DeadlockDetectorConfig {
+    /** 两轮检测之间的间隔 */
+    std::chrono::milliseconds interval{50};
+
+    /**
+     * 检测线程运行时等锁的超时时间
+     * 死锁由检测线程打破，超时只兜底没有形成环的长时间等待
+     */
+    std::chrono::milliseconds wait_timeout{5000};
+};
 
 /**
- * LockManager 类负责管理所有记录上的锁，维护一个 lock_table_。
+ * LockManager 类负责管理所有记录上的锁，锁表按RID分成 LOCK_TABLE_SHARDS 个分片。
  * 提供加锁、解锁、锁升级、批量解锁等接口，用于事务在并发环境下的同步控制。
  */
 class LockManager {
    public:
     LockManager() = default;
-    ~LockManager() = default;
+    ~LockManager();
 
     /**
      * 尝试对某个记录加共享锁，适用于只读事务。
@@ -64,10 +76,50 @@ class LockManager {
     bool Unlock(Transaction* txn, const RID& rid);
 
     /**
-     * 解锁事务持有的所有锁，一般在事务提交或中止时调用。
+     * 解锁事务持有的所有锁（包括表锁），一般在事务提交或中止时调用。
      */
     void UnlockAll(Transaction* txn);
 
+    /**
+     * 给表加锁，支持 IS/IX/S/SIX/X 五种模式。
+     * 已经持有的表锁覆盖请求的模式时直接返回 true；
+     * 否则升级成两者合并后的模式（比如 S 加 IX 得到 SIX）。
+     */
+    bool LockTable(Transaction* txn, oid_t table_oid, LockMode lock_mode);
+
+    /**
+     * 给表里的一条记录加 S 或 X 锁。
+     * 先在表上加 IS 或 IX 锁，表锁已经覆盖记录锁时不再加记录锁；
+     * 事务在这张表上的记录锁超过 LOCK_ESCALATION_THRESHOLD 个时
+     * 尝试升级成表锁，成功后释放这张表上的记录锁。
+     */
+    bool LockRow(Transaction* txn, oid_t table_oid, const RID& rid,
+                 LockMode lock_mode);
+
+    /** 锁表里正在被锁的记录数，用来观察锁升级的效果 */
+    size_t GetRowLockCount();
+
+    /**
+     * 启动后台死锁检测线程
+     * 线程每隔一段时间用所有等待中的请求建等待图（等待者指向和它冲突的
+     * 持有者），图里每个环中止事务ID最大（最年轻）的事务，等待者在
+     * CheckAbort 里发现自己被中止后放弃等待。已经启动时按新配置重启
+     */
+    void StartDeadlockDetection(const DeadlockDetectorConfig& config);
+
+    /** 停止死锁检测线程，等锁的超时恢复成默认值 */
+    void StopDeadlockDetection();
+
+    /**
+     * 执行一轮死锁检测
+     * @return 本轮中止的事务数
+     * 一般由后台线程调用，测试里可以直接调用
+     */
+    size_t RunDeadlockDetection();
+
+    /** 累计检测到的死锁数 */
+    uint64_t GetDeadlockCount() const { return deadlock_count_.load(); }
+
    private:
     /**
      * LockRequest 结构体表示某个事务对某个记录的加锁请求。
@@ -77,43 +129,157 @@ class LockManager {
         txn_id_t txn_id;
         LockMode lock_mode;
         bool granted;
+        Transaction* txn;  // 死锁检测中止等待者时使用
     };
 
     /**
      * LockRequestQueue 是记录对应的锁等待队列。
      * 内含请求队列、条件变量（用于等待/唤醒）、以及升级标志。
+     * 请求按到达顺序排列，指向所在分片池里的对象。
      */
     struct LockRequestQueue {
-        std::list<std::unique_ptr<LockRequest>> request_queue;
+        std::vector<LockRequest*> request_queue;
         std::condition_variable cv;  // 等待当前锁释放时唤醒阻塞事务
         bool upgrading = false;      // 是否有事务正在进行锁升级
     };
 
-    std::mutex latch_;  // 全局锁管理器的互斥锁，保护 lock_table_ 并发访问
+    /**
+     * LockShard 是锁表的一个分片。
+     *
+     * 设计思路：
+     * - RID按哈希值分到固定的分片，不同分片上的加锁解锁互不阻塞，
+     *   等待和唤醒也只在分片的互斥锁上进行
+     * - 队列和请求从分片自己的池里取，用完放回空闲链表，
+     *   池用deque存放，扩容时已有对象的地址不变；
+     *   队列里没有请求时从锁表中摘下来放回池里，锁表只保存正在使用的记录
+     */
+    struct LockShard {
+        std::mutex latch;  // 保护这个分片的锁表和池
+        std::unordered_map<RID, LockRequestQueue*> lock_table;
+        std::deque<LockRequestQueue> queue_pool;
+        std::vector<LockRequestQueue*> free_queues;
+        std::deque<LockRequest> request_pool;
+        std::vector<LockRequest*> free_requests;
+    };
+
+    std::array<LockShard, LOCK_TABLE_SHARDS> shards_;
+
+    /**
+     * TableLockQueue 是一张表上的表锁。
+     * 表的数量少，每个事务在一张表上只在第一次加锁或升级时访问这里，
+     * 所有表共用一个互斥锁；等待者在条件变量上等待重新检查兼容性，
+     * 等待期间登记在 waiting 里，供死锁检测建等待图。
+     */
+    struct TableLockQueue {
+        std::vector<LockRequest> granted;
+        std::vector<LockRequest> waiting;
+        std::condition_variable cv;
+    };
+
+    std::mutex table_latch_;  // 保护 table_locks_
+    std::unordered_map<oid_t, TableLockQueue> table_locks_;
+
+    /**
+     * 内部函数：表锁的加锁流程。
+     * @param wait 冲突时是否等待，锁升级时只尝试一次
+     */
+    bool AcquireTableLock(Transaction* txn, oid_t table_oid,
+                          LockMode lock_mode, bool wait);
+
+    /**
+     * 内部函数：把事务在一张表上的记录锁升级成表锁。
+     * 有记录 X 锁时升级成表 X 锁，否则是表 S 锁；有冲突时保持记录锁。
+     */
+    void EscalateRowLocks(Transaction* txn, oid_t table_oid);
+
+    /**
+     * 内部函数：释放一组记录锁，按分片分组，每个分片只加一次锁。
+     */
+    void ReleaseRowLocks(Transaction* txn, const std::vector<RID>& rids);
+
+    /** 当前等锁的超时时间 */
+    std::chrono::milliseconds WaitTimeout() const {
+        return std::chrono::milliseconds(wait_timeout_ms_.load());
+    }
+
+    /** 等待图：等待者 -> 它在等的持有者，按事务ID排序，检测结果是确定的 */
+    using WaitsForGraph = std::map<txn_id_t, std::set<txn_id_t>>;
+
+    /**
+     * 在等待图里找一个环
+     * @param cycle 输出参数，环上的事务
+     */
+    static bool FindCycle(const WaitsForGraph& graph,
+                          std::vector<txn_id_t>* cycle);
+
+    /** 死锁检测线程的主循环 */
+    void DeadlockDetectionLoop();
+
+    std::thread detector_thread_;
+    DeadlockDetectorConfig detector_config_;
+    /** 配合detector_cv_唤醒检测线程，启停时修改detector_running_要持有它 */
+    std::mutex detector_latch_;
+    std::condition_variable detector_cv_;
+    bool detector_running_ = false;
+    std::atomic<int64_t> wait_timeout_ms_{LOCK_WAIT_TIMEOUT_MS};
+    std::atomic<uint64_t> deadlock_count_{0};
+
+    /** 两个事务分别持有这两种表锁是否兼容 */
+    static bool IsCompatible(LockMode held, LockMode requested);
+
+    /** held 是否已经包含 requested 的权限 */
+    static bool Covers(LockMode held, LockMode requested);
+
+    /** 同一事务先后请求两种表锁时实际需要的模式 */
+    static LockMode CombineModes(LockMode held, LockMode requested);
+
+    /** RID所在的分片 */
+    LockShard& GetShard(const RID& rid);
+
+    /** 取出记录的锁队列，没有时从池里取一个放进锁表 */
+    static LockRequestQueue* GetQueue(LockShard* shard, const RID& rid);
+
+    /** 从池里取一个请求 */
+    static LockRequest* NewRequest(LockShard* shard, Transaction* txn,
+                                   LockMode lock_mode);
+
+    /**
+     * 把请求从队列中去掉并放回池里
+     * 队列空了就从锁表中摘下来放回池里
+     */
+    static void RemoveRequest(LockShard* shard, const RID& rid,
+                              LockRequestQueue* queue, LockRequest* request);
+
+    /** 找到事务在队列里的请求，没有返回nullptr */
+    static LockRequest* FindRequest(LockRequestQueue* queue, txn_id_t txn_id);
+
+    /**
+     * 内部函数：加共享锁或排他锁，已经持有足够的锁时直接返回。
+     */
+    bool AcquireLock(Transaction* txn, const RID& rid, LockMode lock_mode);
 
     /**
-     * lock_table_ 是整个数据库的锁表。
-     * 键是记录的 RID，值是对应的锁请求队列。
+     * 内部函数：释放事务在某个分片里对一条记录的锁，调用者持有分片的锁。
      */
-    std::unordered_map<RID, std::unique_ptr<LockRequestQueue>> lock_table_;
+    void ReleaseLock(LockShard* shard, Transaction* txn, const RID& rid);
 
     /**
      * 内部函数：尝试授予某个锁请求。
      * 根据当前队列状态和锁兼容性来判断是否可以立即授予。
      */
-    bool GrantLock(LockRequest* request, LockRequestQueue* queue);
+    static bool GrantLock(LockRequest* request, LockRequestQueue* queue);
 
     /**
      * 内部函数：在某个请求被释放之后，尝试授予等待队列中的新请求。
      * 主要逻辑是：看前面有哪些请求现在可以执行了。
      */
-    void GrantNewLocksInQueue(LockRequestQueue* queue);
+    static void GrantNewLocksInQueue(LockRequestQueue* queue);
 
     /**
      * 内部函数：根据当前事务的状态判断是否需要中止。
      * 一般用于检测死锁后是否被标记为 ABORTED。
      */
-    bool CheckAbort(Transaction* txn);
+    static bool CheckAbort(Transaction* txn);
 };
 
 }  // namespace SimpleRDBMS
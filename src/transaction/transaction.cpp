@@ -22,11 +22,13 @@ Transaction::Transaction(txn_id_t txn_id, IsolationLevel isolation_level)
     : txn_id_(txn_id),
       state_(TransactionState::GROWING),
       isolation_level_(isolation_level),
-      prev_lsn_(INVALID_LSN) {
+      prev_lsn_(INVALID_LSN),
+      version_writer_(std::make_shared<VersionWriter>(txn_id)) {
     // 初始化事务对象的时候，事务开始处于 GROWING
     // 状态（可获得锁、写操作还未提交）
     txn_id_ = txn_id;
     isolation_level_ = isolation_level;
+    read_view_.txn_id = txn_id;
 }
 
 /*
@@ -35,6 +37,31 @@ Transaction::Transaction(txn_id_t txn_id, IsolationLevel isolation_level)
  */
 Transaction::~Transaction() = default;
 
+/*
+ * Reset - 复用事务对象
+ * 和构造函数得到同样的初始状态；撤销记录通过shared_ptr引用旧的
+ * VersionWriter，这里只换成新的，不修改旧的
+ */
+void Transaction::Reset(txn_id_t txn_id, IsolationLevel isolation_level) {
+    txn_id_ = txn_id;
+    state_ = TransactionState::GROWING;
+    isolation_level_ = isolation_level;
+    read_only_ = false;
+    prev_lsn_ = INVALID_LSN;
+    start_time_ = {};
+    shared_lock_set_.clear();
+    exclusive_lock_set_.clear();
+    table_lock_set_.clear();
+    table_row_locks_.clear();
+    modified_tables_.clear();
+    write_set_.clear();
+    read_view_ = ReadView();
+    read_view_.txn_id = txn_id;
+    has_snapshot_ = false;
+    version_writer_ = std::make_shared<VersionWriter>(txn_id);
+    version_stores_.clear();
+}
+
 /*
  * AddToWriteSet - 将一条写操作添加到事务的写集合中（write set）
  * 参数:
@@ -53,4 +80,18 @@ void Transaction::AddToWriteSet(const RID& rid, const Tuple& tuple) {
     }
 }
 
+/*
+ * AddVersionStore - 记下事务写过的版本存储
+ * 一个事务通常只写少数几张表，线性查找去重即可；
+ * 表被删除之后弱引用失效，提交时跳过
+ */
+void Transaction::AddVersionStore(const std::shared_ptr<VersionStore>& store) {
+    for (const auto& existing : version_stores_) {
+        if (existing.lock() == store) {
+            return;
+        }
+    }
+    version_stores_.push_back(store);
+}
+
 }  // namespace SimpleRDBMS
@@ -13,10 +13,12 @@
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
 #include "common/types.h"
 #include "record/tuple.h"
+#include "transaction/version_store.h"
 
 namespace SimpleRDBMS {
 
@@ -50,6 +52,23 @@ enum class IsolationLevel {
     SERIALIZABLE
 };
 
+/**
+ * LockMode 枚举表示锁的类型：
+ * - SHARED: 共享锁，允许多个事务并发读取。
+ * - EXCLUSIVE: 排他锁，只允许一个事务写入。
+ * 表上另外有三种意向锁，表示事务要在表里的记录上加锁：
+ * - INTENTION_SHARED: 意向共享锁（IS），准备给记录加 S 锁。
+ * - INTENTION_EXCLUSIVE: 意向排他锁（IX），准备给记录加 X 锁。
+ * - SHARED_INTENTION_EXCLUSIVE: 共享意向排他锁（SIX），读整张表并修改其中一部分记录。
+ */
+enum class LockMode {
+    SHARED = 0,
+    EXCLUSIVE,
+    INTENTION_SHARED,
+    INTENTION_EXCLUSIVE,
+    SHARED_INTENTION_EXCLUSIVE
+};
+
 /*
  * Transaction 类
  * 每个正在执行的事务在系统中对应一个 Transaction 对象
@@ -64,6 +83,13 @@ class Transaction {
     // 析构函数：清理资源（当前无额外操作）
     ~Transaction();
 
+    /**
+     * 重新初始化为一个新事务，事务表复用事务对象时调用
+     * 清空锁集合、写集合和快照，换一个新的提交状态
+     * （旧的还被撤销记录引用着），容器保留已经分配的空间
+     */
+    void Reset(txn_id_t txn_id, IsolationLevel isolation_level);
+
     // 获取事务ID
     txn_id_t GetTxnId() const { return txn_id_; }
 
@@ -74,6 +100,13 @@ class Transaction {
     // 获取事务的隔离级别
     IsolationLevel GetIsolationLevel() const { return isolation_level_; }
 
+    /**
+     * 只读事务：BEGIN READ ONLY 或者自动提交的 SELECT
+     * 不写 BEGIN/COMMIT 日志、不加锁，只读自己的快照，写操作直接失败
+     */
+    bool IsReadOnly() const { return read_only_; }
+    void SetReadOnly(bool read_only) { read_only_ = read_only; }
+
     // 获取/设置该事务最近的日志序列号（用于WAL恢复）
     lsn_t GetPrevLSN() const { return prev_lsn_; }
     void SetPrevLSN(lsn_t lsn) { prev_lsn_ = lsn; }
@@ -92,6 +125,47 @@ class Transaction {
         return exclusive_lock_set_;
     }
 
+    // 表锁：事务在每张表上持有的锁
+    bool GetTableLockMode(oid_t table_oid, LockMode* mode) const {
+        auto it = table_lock_set_.find(table_oid);
+        if (it == table_lock_set_.end()) {
+            return false;
+        }
+        *mode = it->second;
+        return true;
+    }
+    void SetTableLock(oid_t table_oid, LockMode mode) {
+        table_lock_set_[table_oid] = mode;
+    }
+    void RemoveTableLock(oid_t table_oid) { table_lock_set_.erase(table_oid); }
+    const std::unordered_map<oid_t, LockMode>& GetTableLockSet() const {
+        return table_lock_set_;
+    }
+
+    // 通过表加的记录锁，按表分组，锁升级时一起释放
+    size_t AddTableRowLock(oid_t table_oid, const RID& rid) {
+        auto& rids = table_row_locks_[table_oid];
+        rids.push_back(rid);
+        return rids.size();
+    }
+    std::vector<RID> TakeTableRowLocks(oid_t table_oid) {
+        std::vector<RID> rids;
+        auto it = table_row_locks_.find(table_oid);
+        if (it != table_row_locks_.end()) {
+            rids = std::move(it->second);
+            table_row_locks_.erase(it);
+        }
+        return rids;
+    }
+
+    // 事务修改过数据的表，提交后要让读过这些表的缓存结果作废
+    void AddModifiedTable(oid_t table_oid) {
+        modified_tables_.insert(table_oid);
+    }
+    const std::unordered_set<oid_t>& GetModifiedTables() const {
+        return modified_tables_;
+    }
+
     // 写集合管理 —— 添加旧值用于回滚
     void AddToWriteSet(const RID& rid, const Tuple& tuple);
 
@@ -113,10 +187,57 @@ class Transaction {
         start_time_ = start_time;
     }
 
+    /**
+     * 记下事务的快照，由TransactionManager::Begin调用
+     * 有快照的事务写表堆时留下撤销记录，读表堆时按快照读
+     */
+    void SetReadTimestamp(timestamp_t read_ts) {
+        read_view_.read_ts = read_ts;
+        has_snapshot_ = true;
+    }
+
+    /** 是否有快照：不是经过TransactionManager开始的事务没有快照 */
+    bool HasSnapshot() const { return has_snapshot_; }
+
+    /** 事务的快照，写冲突检查也用它 */
+    const ReadView& GetSnapshot() const { return read_view_; }
+
+    /**
+     * 读表堆时使用的快照
+     * @return 没有快照或者隔离级别是READ_UNCOMMITTED时返回nullptr，
+     *         这时直接读表堆里最新的内容
+     */
+    const ReadView* GetReadView() const {
+        if (!has_snapshot_ ||
+            isolation_level_ == IsolationLevel::READ_UNCOMMITTED) {
+            return nullptr;
+        }
+        return &read_view_;
+    }
+
+    /** 事务的提交状态，和它写下的撤销记录共享 */
+    const std::shared_ptr<VersionWriter>& GetVersionWriter() const {
+        return version_writer_;
+    }
+
+    /** 记下写过的版本存储，提交时通知它们、回收旧版本 */
+    void AddVersionStore(const std::shared_ptr<VersionStore>& store);
+
+    const std::vector<std::weak_ptr<VersionStore>>& GetVersionStores() const {
+        return version_stores_;
+    }
+
+    /** 事务在事务表里的槽位，不是经过TransactionManager开始的事务没有槽位 */
+    size_t GetTableSlot() const { return table_slot_; }
+    void SetTableSlot(size_t slot) { table_slot_ = slot; }
+
+    static constexpr size_t NO_TABLE_SLOT = static_cast<size_t>(-1);
+
    private:
     txn_id_t txn_id_;                 // 当前事务的唯一标识符
     TransactionState state_;          // 当前事务状态
     IsolationLevel isolation_level_;  // 当前隔离级别
+    bool read_only_ = false;          // 是否是只读事务
     lsn_t prev_lsn_;                  // 上一个WAL日志的LSN（用于恢复）
     // 开始时间
     std::chrono::high_resolution_clock::time_point start_time_;  // 事务开始时间
@@ -124,9 +245,20 @@ class Transaction {
     // 锁集合，用于记录事务已经持有的锁
     std::unordered_set<RID> shared_lock_set_;     // 已获得的共享锁
     std::unordered_set<RID> exclusive_lock_set_;  // 已获得的排他锁
+    std::unordered_map<oid_t, LockMode> table_lock_set_;  // 已获得的表锁
+    std::unordered_map<oid_t, std::vector<RID>> table_row_locks_;
+    std::unordered_set<oid_t> modified_tables_;  // 修改过数据的表
 
     // 写集合，记录了事务修改过的数据（用于回滚时还原）
     std::unordered_map<RID, Tuple> write_set_;
+
+    // MVCC：快照、提交状态和写过的版本存储
+    ReadView read_view_;
+    bool has_snapshot_ = false;
+    std::shared_ptr<VersionWriter> version_writer_;
+    std::vector<std::weak_ptr<VersionStore>> version_stores_;
+
+    size_t table_slot_ = NO_TABLE_SLOT;
 };
 
 }  // namespace SimpleRDBMS
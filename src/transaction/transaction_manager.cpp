@@ -9,7 +9,9 @@
 
 #include "transaction/transaction_manager.h"
 
+#include <algorithm>
 #include <chrono>
+#include <thread>
 
 #include "common/debug.h"
 #include "recovery/log_record.h"
@@ -22,37 +24,126 @@ namespace SimpleRDBMS {
  */
 TransactionManager::TransactionManager(LockManager* lock_manager,
                                        LogManager* log_manager)
-    : lock_manager_(lock_manager), log_manager_(log_manager) {
+    : lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      slots_(std::make_unique<TransactionSlot[]>(TRANSACTION_TABLE_SLOTS)) {
         next_txn_id_ = 0;  // 初始化事务 ID 计数器
     }
 
+template <typename Func>
+void TransactionManager::ForEachSlot(Func&& func) {
+    for (size_t i = 0; i < TRANSACTION_TABLE_SLOTS; i++) {
+        if (slots_[i].in_use.load()) {
+            func(slots_[i]);
+        }
+    }
+    if (overflow_count_.load() == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(overflow_latch_);
+    for (auto& slot : overflow_slots_) {
+        if (slot.in_use.load()) {
+            func(slot);
+        }
+    }
+}
+
 /**
  * 析构函数：
  * - 尝试终止所有仍处于活跃状态（Growing 或 Shrinking）的事务
  * - 释放它们持有的所有锁
  */
 TransactionManager::~TransactionManager() {
-    std::lock_guard<std::mutex> lock(txn_map_latch_);
-    for (auto& [txn_id, txn] : txn_map_) {
+    ForEachSlot([this](TransactionSlot& slot) {
+        Transaction* txn = slot.txn.load();
         if (txn && (txn->GetState() == TransactionState::GROWING ||
                     txn->GetState() == TransactionState::SHRINKING)) {
             txn->SetState(TransactionState::ABORTED);
             if (lock_manager_) {
                 try {
-                    lock_manager_->UnlockAll(txn.get());
+                    lock_manager_->UnlockAll(txn);
                 } catch (...) {
                     // 析构期间不抛出异常，安全退出
                 }
             }
         }
+    });
+}
+
+/**
+ * 占用槽位
+ * 实现思路：
+ * 1. 事务ID是连续分配的，从ID对应的槽位开始探测，事务都很短时
+ *    第一次就能占到，并发开始的事务落在不同的槽位上
+ * 2. 用CAS把in_use从false改成true，成功的线程独占这个槽位
+ * 3. 固定槽位都被占用时在溢出锁内找空闲的溢出槽位，没有就追加一个
+ */
+size_t TransactionManager::ClaimSlot(txn_id_t txn_id) {
+    size_t start = static_cast<size_t>(txn_id) % TRANSACTION_TABLE_SLOTS;
+    for (size_t probe = 0; probe < TRANSACTION_TABLE_SLOTS; probe++) {
+        size_t index = (start + probe) % TRANSACTION_TABLE_SLOTS;
+        bool expected = false;
+        if (!slots_[index].in_use.load(std::memory_order_relaxed) &&
+            slots_[index].in_use.compare_exchange_strong(expected, true)) {
+            return index;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(overflow_latch_);
+    for (size_t i = 0; i < overflow_slots_.size(); i++) {
+        if (!overflow_slots_[i].in_use.load()) {
+            overflow_slots_[i].in_use.store(true);
+            return TRANSACTION_TABLE_SLOTS + i;
+        }
+    }
+    overflow_slots_.emplace_back();
+    overflow_slots_.back().in_use.store(true);
+    overflow_count_.store(overflow_slots_.size());
+    if (overflow_slots_.size() == 1) {
+        LOG_WARN("TransactionManager: transaction table full, using overflow "
+                 "slots");
     }
+    return TRANSACTION_TABLE_SLOTS + overflow_slots_.size() - 1;
+}
+
+TransactionManager::TransactionSlot& TransactionManager::GetSlot(size_t index) {
+    if (index < TRANSACTION_TABLE_SLOTS) {
+        return slots_[index];
+    }
+    std::lock_guard<std::mutex> lock(overflow_latch_);
+    return overflow_slots_[index - TRANSACTION_TABLE_SLOTS];
+}
+
+void TransactionManager::ReleaseSlot(Transaction* txn) {
+    if (txn->GetTableSlot() == Transaction::NO_TABLE_SLOT) {
+        return;
+    }
+    TransactionSlot& slot = GetSlot(txn->GetTableSlot());
+    txn->SetTableSlot(Transaction::NO_TABLE_SLOT);
+    slot.read_ts.store(NO_SNAPSHOT);
+    slot.in_use.store(false);
+}
+
+void TransactionManager::PublishSnapshot(Transaction* txn,
+                                         TransactionSlot& slot) {
+    timestamp_t read_ts = last_commit_ts_.load();
+    while (true) {
+        slot.read_ts.store(read_ts);
+        timestamp_t latest = last_commit_ts_.load();
+        if (latest == read_ts) {
+            break;
+        }
+        read_ts = latest;
+    }
+    txn->SetReadTimestamp(read_ts);
 }
 
 /**
  * 创建一个新的事务对象，并将其加入事务映射表
  * 同时会记录 BEGIN 日志（若启用了日志模块）
  */
-Transaction* TransactionManager::Begin(IsolationLevel isolation_level) {
+Transaction* TransactionManager::Begin(IsolationLevel isolation_level,
+                                       bool read_only) {
     LOG_DEBUG("TransactionManager::Begin: Starting new transaction");
 
     auto transaction_start_time = std::chrono::high_resolution_clock::now();
@@ -60,13 +151,24 @@ Transaction* TransactionManager::Begin(IsolationLevel isolation_level) {
     txn_id_t txn_id = GetNextTxnId();
     LOG_DEBUG("TransactionManager::Begin: Assigned transaction ID " << txn_id);
 
-    // 分配事务对象并设置隔离级别
-    auto txn = std::make_unique<Transaction>(txn_id, isolation_level);
+    // 占用事务表槽位，复用槽位里的事务对象
+    size_t slot_index = ClaimSlot(txn_id);
+    TransactionSlot& slot = GetSlot(slot_index);
+    if (!slot.owned) {
+        slot.owned = std::make_unique<Transaction>(txn_id, isolation_level);
+        slot.txn.store(slot.owned.get());
+    } else {
+        slot.owned->Reset(txn_id, isolation_level);
+    }
+    Transaction* txn = slot.owned.get();
+    txn->SetTableSlot(slot_index);
+    txn->SetReadOnly(read_only);
 
     txn->SetStartTime(transaction_start_time);
 
-    // 如果配置了日志管理器，写入 BEGIN 记录
-    if (log_manager_ != nullptr) {
+    // 如果配置了日志管理器，写入 BEGIN 记录；只读事务不写日志，
+    // 恢复时也不需要知道它
+    if (log_manager_ != nullptr && !read_only) {
         try {
             LOG_DEBUG("TransactionManager::Begin: Writing begin log record");
             BeginLogRecord log_record(txn_id);
@@ -82,18 +184,13 @@ Transaction* TransactionManager::Begin(IsolationLevel isolation_level) {
         }
     }
 
-    // 添加事务到全局事务表中
-    Transaction* txn_ptr = txn.get();
-    {
-        std::lock_guard<std::mutex> lock(txn_map_latch_);
-        txn_map_[txn_id] = std::move(txn);
-    }
+    PublishSnapshot(txn, slot);
 
     STATS.RecordTransactionBegin();
 
     LOG_DEBUG("TransactionManager::Begin: Transaction "
               << txn_id << " created successfully");
-    return txn_ptr;
+    return txn;
 }
 
 /**
@@ -113,7 +210,8 @@ bool TransactionManager::Commit(Transaction* txn) {
 
     txn->SetState(TransactionState::COMMITTED);
 
-    if (log_manager_ != nullptr) {
+    // 只读事务没有日志要刷，也没有持有锁
+    if (log_manager_ != nullptr && !txn->IsReadOnly()) {
         try {
             CommitLogRecord log_record(txn->GetTxnId(), txn->GetPrevLSN());
             lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
@@ -124,7 +222,7 @@ bool TransactionManager::Commit(Transaction* txn) {
         }
     }
 
-    if (lock_manager_) {
+    if (lock_manager_ && !txn->IsReadOnly()) {
         lock_manager_->UnlockAll(txn);  // 释放该事务的所有锁
     }
 
@@ -133,16 +231,16 @@ bool TransactionManager::Commit(Transaction* txn) {
             commit_start_time - txn->GetStartTime());
     double duration_ms = transaction_duration.count() / 1000.0;
 
-    {
-        std::lock_guard<std::mutex> lock(txn_map_latch_);
-        txn_map_.erase(txn->GetTxnId());
-    }
+    FinishVersions(txn);
 
     STATS.RecordTransactionCommit();
     STATS.RecordTransactionDuration(duration_ms);
 
     LOG_DEBUG("TransactionManager::Commit: Transaction "
               << txn->GetTxnId() << " committed successfully");
+
+    // 归还槽位之后事务对象可能马上被新事务复用
+    ReleaseSlot(txn);
     return true;
 }
 
@@ -166,7 +264,7 @@ bool TransactionManager::Abort(Transaction* txn) {
 
     txn->SetState(TransactionState::ABORTED);
 
-    if (log_manager_ != nullptr) {
+    if (log_manager_ != nullptr && !txn->IsReadOnly()) {
         try {
             AbortLogRecord log_record(txn->GetTxnId(), txn->GetPrevLSN());
             lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
@@ -177,7 +275,7 @@ bool TransactionManager::Abort(Transaction* txn) {
         }
     }
 
-    if (lock_manager_) {
+    if (lock_manager_ && !txn->IsReadOnly()) {
         lock_manager_->UnlockAll(txn);  // 释放所有锁
     }
 
@@ -186,17 +284,110 @@ bool TransactionManager::Abort(Transaction* txn) {
             abort_start_time - txn->GetStartTime());
     double duration_ms = transaction_duration.count() / 1000.0;
 
-    {
-        std::lock_guard<std::mutex> lock(txn_map_latch_);
-        txn_map_.erase(txn->GetTxnId());
-    }
+    FinishVersions(txn);
 
     STATS.RecordTransactionAbort();
     STATS.RecordTransactionDuration(duration_ms);
 
     LOG_DEBUG("TransactionManager::Abort: Transaction "
               << txn->GetTxnId() << " aborted successfully");
+
+    ReleaseSlot(txn);
     return true;
 }
 
+/**
+ * 事务结束时的MVCC处理
+ * 实现思路：
+ * 1. 写过表堆的事务分配提交时间戳并写进VersionWriter，等前面分配的
+ *    时间戳都公开之后再公开自己的，之后开始的事务的快照都看得到它的修改；
+ *    公开之前进回收队列，队列因此按提交时间戳排好序
+ * 2. 回收队列不空时扫描事务表，计算除它以外的活跃快照中最小的时间戳，
+ *    没有活跃快照时是最新的提交时间戳；回收队列里提交时间戳不超过它的
+ *    存储出队。只读事务居多时队列通常是空的，结束时不必扫描
+ * 3. 通知写过的存储这个事务已经结束，再回收出队的存储
+ */
+void TransactionManager::FinishVersions(Transaction* txn) {
+    if (!txn->HasSnapshot()) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<VersionStore>> written;
+    for (const auto& store : txn->GetVersionStores()) {
+        if (auto locked = store.lock()) {
+            written.push_back(std::move(locked));
+        }
+    }
+
+    timestamp_t commit_ts = 0;
+    if (!written.empty()) {
+        commit_ts = next_commit_ts_.fetch_add(1) + 1;
+        txn->GetVersionWriter()->commit_ts.store(commit_ts);
+        while (last_commit_ts_.load() != commit_ts - 1) {
+            std::this_thread::yield();
+        }
+        {
+            std::lock_guard<std::mutex> lock(gc_latch_);
+            for (const auto& store : written) {
+                gc_queue_.emplace_back(commit_ts, store);
+            }
+            gc_pending_.store(gc_queue_.size());
+        }
+        last_commit_ts_.store(commit_ts);
+    }
+
+    timestamp_t horizon = last_commit_ts_.load();
+    std::vector<std::shared_ptr<VersionStore>> to_prune;
+    if (gc_pending_.load() > 0) {
+        ForEachSlot([&horizon, txn](TransactionSlot& slot) {
+            if (slot.txn.load() != txn) {
+                horizon = std::min(horizon, slot.read_ts.load());
+            }
+        });
+
+        std::lock_guard<std::mutex> lock(gc_latch_);
+        while (!gc_queue_.empty() && gc_queue_.front().first <= horizon) {
+            if (auto store = gc_queue_.front().second.lock()) {
+                if (std::find(to_prune.begin(), to_prune.end(), store) ==
+                    to_prune.end()) {
+                    to_prune.push_back(std::move(store));
+                }
+            }
+            gc_queue_.pop_front();
+        }
+        gc_pending_.store(gc_queue_.size());
+    }
+
+    for (const auto& store : written) {
+        store->FinishWriter(txn->GetTxnId(), commit_ts);
+    }
+    size_t pruned = 0;
+    for (const auto& store : to_prune) {
+        pruned += store->Prune(horizon);
+    }
+    if (pruned > 0) {
+        LOG_DEBUG("TransactionManager: pruned " << pruned
+                                                << " versions below timestamp "
+                                                << horizon);
+    }
+}
+
+/**
+ * 活跃事务表快照：
+ * - 逐个槽位原子读，不阻塞正在开始和结束的事务
+ * - 只处于GROWING/SHRINKING状态的事务会被记下
+ */
+std::vector<std::pair<txn_id_t, lsn_t>>
+TransactionManager::GetActiveTransactionTable() {
+    std::vector<std::pair<txn_id_t, lsn_t>> active_txns;
+    ForEachSlot([&active_txns](TransactionSlot& slot) {
+        Transaction* txn = slot.txn.load();
+        if (txn && (txn->GetState() == TransactionState::GROWING ||
+                    txn->GetState() == TransactionState::SHRINKING)) {
+            active_txns.emplace_back(txn->GetTxnId(), txn->GetPrevLSN());
+        }
+    });
+    return active_txns;
+}
+
 }  // namespace SimpleRDBMS
@@ -10,9 +10,12 @@
 #pragma once
 
 #include <atomic>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "lock_manager.h"
@@ -44,9 +47,12 @@ class TransactionManager {
     /**
      * 开启一个新事务，并根据设定的隔离级别进行初始化
      * 默认使用 Repeatable Read（可重复读）隔离级别
+     * @param read_only 只读事务不写 BEGIN/COMMIT 日志，提交时不刷日志、
+     *        不释放锁（它不加锁），只取快照和归还事务表槽位
      */
     Transaction* Begin(
-        IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ);
+        IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ,
+        bool read_only = false);
 
     /**
      * 提交指定事务：
@@ -74,7 +80,81 @@ class TransactionManager {
      */
     txn_id_t GetNextTxnId() { return next_txn_id_.fetch_add(1); }
 
+    /**
+     * 获取活跃事务表的快照，供模糊检查点使用
+     * @return 每个仍在执行的事务及其最后一条日志的LSN
+     * 已经进入COMMITTED/ABORTED状态的事务不包含在内
+     */
+    std::vector<std::pair<txn_id_t, lsn_t>> GetActiveTransactionTable();
+
    private:
+    /**
+     * TransactionSlot - 事务表的一个槽位
+     * 槽位里的事务对象在事务结束后留给下一个占用槽位的事务复用；
+     * 每个槽位独占一个缓存行，相邻槽位的Begin/Commit互不干扰
+     */
+    struct alignas(64) TransactionSlot {
+        std::atomic<bool> in_use{false};
+        // 槽位里事务的快照时间戳，没有快照时是NO_SNAPSHOT
+        std::atomic<timestamp_t> read_ts{NO_SNAPSHOT};
+        // 第一次占用时创建，之后不再改变，扫描事务表的线程只读它
+        std::atomic<Transaction*> txn{nullptr};
+        std::unique_ptr<Transaction> owned;  // 只由占用槽位的线程访问
+    };
+
+    static constexpr timestamp_t NO_SNAPSHOT = static_cast<timestamp_t>(-1);
+
+    /**
+     * 占用一个空闲槽位，从事务ID对应的位置开始线性探测
+     * 固定槽位都被占用时使用溢出槽位
+     * @return 槽位编号，不小于TRANSACTION_TABLE_SLOTS的是溢出槽位
+     */
+    size_t ClaimSlot(txn_id_t txn_id);
+
+    /** 槽位编号对应的槽位 */
+    TransactionSlot& GetSlot(size_t index);
+
+    /** 事务结束，清掉快照时间戳并归还槽位 */
+    void ReleaseSlot(Transaction* txn);
+
+    /**
+     * 对事务表里的每个占用中的槽位调用func
+     * 固定槽位只做原子读，溢出槽位在溢出锁内访问
+     */
+    template <typename Func>
+    void ForEachSlot(Func&& func);
+
+    /**
+     * 给新事务取快照并登记到槽位里
+     * 登记之后重读一遍最新的提交时间戳，变了就重取：
+     * 提交者先推进时间戳再扫描槽位，两边至少有一边看到对方
+     */
+    void PublishSnapshot(Transaction* txn, TransactionSlot& slot);
+
+    /**
+     * 事务结束时的MVCC处理：分配提交时间戳，通知写过的版本存储，
+     * 回收所有活跃快照都看得到的旧版本
+     * Abort不回滚表堆（和以前一样），它的修改同样按提交处理
+     */
+    void FinishVersions(Transaction* txn);
+
+    /**
+     * 最近一次公开的提交时间戳，新事务的快照就是它
+     * 提交时间戳从next_commit_ts_分配，按分配顺序依次公开，
+     * 快照因此不会看到后分配的时间戳却漏掉先分配的
+     */
+    std::atomic<timestamp_t> last_commit_ts_{0};
+    std::atomic<timestamp_t> next_commit_ts_{0};
+
+    /**
+     * 等待回收的版本存储，按提交时间戳从小到大排列
+     * 最小的活跃快照超过提交时间戳之后，对应的存储做一次回收
+     */
+    std::deque<std::pair<timestamp_t, std::weak_ptr<VersionStore>>> gc_queue_;
+    std::mutex gc_latch_;
+    // 回收队列的长度，队列为空时事务结束不必扫描事务表
+    std::atomic<size_t> gc_pending_{0};
+
     /**
      * 全局事务 ID 计数器，保证每个事务分配到唯一 ID
      */
@@ -91,14 +171,18 @@ class TransactionManager {
     LogManager* log_manager_;
 
     /**
-     * 活跃事务表：记录当前正在执行的所有事务
+     * 活跃事务表：预先分配的槽位，按槽位编号访问
+     * Begin/Commit用原子操作占用和归还槽位，查询不加锁
      */
-    std::unordered_map<txn_id_t, std::unique_ptr<Transaction>> txn_map_;
+    std::unique_ptr<TransactionSlot[]> slots_;
 
     /**
-     * 用于保护事务表的互斥锁（避免并发访问冲突）
+     * 溢出槽位：固定槽位用完之后才会用到，只增不减
+     * deque追加元素时已有元素的地址不变
      */
-    std::mutex txn_map_latch_;
+    std::deque<TransactionSlot> overflow_slots_;
+    std::atomic<size_t> overflow_count_{0};
+    std::mutex overflow_latch_;
 };
 
 }  // namespace SimpleRDBMS
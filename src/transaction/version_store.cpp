@@ -0,0 +1,178 @@
+/*
+ * 文件: version_store.cpp
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: MVCC版本存储的实现
+ */
+
+#include "transaction/version_store.h"
+
+#include <iterator>
+
+namespace SimpleRDBMS {
+
+void VersionStore::AddVersion(const RID& rid,
+                              const std::shared_ptr<VersionWriter>& writer,
+                              bool existed, const char* before, size_t size) {
+    std::lock_guard<std::mutex> guard(latch_);
+    UndoRecord record{writer, existed, std::string()};
+    if (existed) {
+        record.before.assign(before, size);
+    }
+    pages_[rid.page_id][rid.slot_num].push_back(std::move(record));
+    version_count_++;
+    pending_writers_.insert(writer->txn_id);
+    pending_count_.store(pending_writers_.size());
+}
+
+bool VersionStore::HasWriteConflict(const RID& rid, const ReadView& view,
+                                    bool check_snapshot) const {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto page_it = pages_.find(rid.page_id);
+    if (page_it == pages_.end()) {
+        return false;
+    }
+    auto slot_it = page_it->second.find(rid.slot_num);
+    if (slot_it == page_it->second.end() || slot_it->second.empty()) {
+        return false;
+    }
+    const VersionWriter& writer = *slot_it->second.back().writer;
+    if (writer.txn_id == view.txn_id) {
+        return false;
+    }
+    timestamp_t commit_ts = writer.commit_ts.load();
+    return commit_ts == 0 || (check_snapshot && commit_ts > view.read_ts);
+}
+
+/**
+ * 写事务结束
+ * 先推进newest_commit_ts_再把事务从未提交集合中去掉，
+ * 读者先看未提交集合再看newest_commit_ts_，两边之间不会漏掉这个事务
+ */
+void VersionStore::FinishWriter(txn_id_t txn_id, timestamp_t commit_ts) {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (commit_ts > newest_commit_ts_.load()) {
+        newest_commit_ts_.store(commit_ts);
+    }
+    pending_writers_.erase(txn_id);
+    pending_count_.store(pending_writers_.size());
+}
+
+bool VersionStore::HasInvisibleVersions(const ReadView& view) const {
+    if (pending_count_.load() > 0) {
+        std::lock_guard<std::mutex> guard(latch_);
+        for (txn_id_t writer : pending_writers_) {
+            if (writer != view.txn_id) {
+                return true;
+            }
+        }
+    }
+    return newest_commit_ts_.load() > view.read_ts;
+}
+
+bool VersionStore::ResolveChain(const Chain& chain, const ReadView& view,
+                                SnapshotVersion* version) {
+    size_t undone = chain.size();
+    while (undone > 0 && !view.Sees(*chain[undone - 1].writer)) {
+        undone--;
+    }
+    if (undone == chain.size()) {
+        return false;
+    }
+    version->exists = chain[undone].existed;
+    version->data = chain[undone].before;
+    return true;
+}
+
+bool VersionStore::GetVisibleVersion(const RID& rid, const ReadView& view,
+                                     SnapshotVersion* version) const {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto page_it = pages_.find(rid.page_id);
+    if (page_it == pages_.end()) {
+        return false;
+    }
+    auto slot_it = page_it->second.find(rid.slot_num);
+    if (slot_it == page_it->second.end()) {
+        return false;
+    }
+    version->rid = rid;
+    return ResolveChain(slot_it->second, view, version);
+}
+
+void VersionStore::GetPageVersions(
+    page_id_t page_id, const ReadView& view,
+    std::vector<SnapshotVersion>* versions) const {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto page_it = pages_.find(page_id);
+    if (page_it == pages_.end()) {
+        return;
+    }
+    for (const auto& [slot, chain] : page_it->second) {
+        SnapshotVersion version;
+        version.rid = RID{page_id, slot};
+        if (ResolveChain(chain, view, &version)) {
+            versions->push_back(std::move(version));
+        }
+    }
+}
+
+void VersionStore::GetAllVersions(
+    const ReadView& view, std::vector<SnapshotVersion>* versions) const {
+    std::lock_guard<std::mutex> guard(latch_);
+    for (const auto& [page_id, slots] : pages_) {
+        for (const auto& [slot, chain] : slots) {
+            SnapshotVersion version;
+            version.rid = RID{page_id, slot};
+            if (ResolveChain(chain, view, &version)) {
+                versions->push_back(std::move(version));
+            }
+        }
+    }
+}
+
+/**
+ * 回收撤销记录
+ * 实现思路：
+ * 1. 每条链上找最新的一条提交时间戳不大于horizon的记录，
+ *    所有快照沿链往回找时最晚在这里停下，它和更早的记录都用不到了
+ * 2. 链空了删掉slot，页面上没有链了删掉页面
+ */
+size_t VersionStore::Prune(timestamp_t horizon) {
+    std::lock_guard<std::mutex> guard(latch_);
+    size_t pruned = 0;
+    for (auto page_it = pages_.begin(); page_it != pages_.end();) {
+        auto& slots = page_it->second;
+        for (auto slot_it = slots.begin(); slot_it != slots.end();) {
+            Chain& chain = slot_it->second;
+            size_t keep_from = 0;
+            for (size_t i = chain.size(); i > 0; i--) {
+                timestamp_t commit_ts = chain[i - 1].writer->commit_ts.load();
+                if (commit_ts != 0 && commit_ts <= horizon) {
+                    keep_from = i;
+                    break;
+                }
+            }
+            if (keep_from > 0) {
+                chain.erase(chain.begin(), chain.begin() + keep_from);
+                pruned += keep_from;
+            }
+            slot_it = chain.empty() ? slots.erase(slot_it) : std::next(slot_it);
+        }
+        page_it = slots.empty() ? pages_.erase(page_it) : std::next(page_it);
+    }
+    version_count_ -= pruned;
+    return pruned;
+}
+
+size_t VersionStore::GetVersionCount() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    return version_count_;
+}
+
+bool VersionStore::HasPageVersions(page_id_t page_id) const {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto it = pages_.find(page_id);
+    return it != pages_.end() && !it->second.empty();
+}
+
+}  // namespace SimpleRDBMS
@@ -0,0 +1,172 @@
+/*
+ * 文件: version_store.h
+ * 作者: QCQCQC
+ * 日期: 2025-6-1
+ * 描述: MVCC的版本存储：每个表堆记下被修改记录的撤销链，
+ *       快照读按提交时间戳沿链找到对自己可见的版本
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/config.h"
+#include "common/types.h"
+
+namespace SimpleRDBMS {
+
+/**
+ * VersionWriter - 写事务的提交状态
+ * 事务和它写下的撤销记录共享同一个对象，事务对象销毁之后
+ * 撤销记录仍然能查到写事务是否提交、在什么时间提交
+ */
+struct VersionWriter {
+    explicit VersionWriter(txn_id_t id) : txn_id(id) {}
+
+    const txn_id_t txn_id;
+    std::atomic<timestamp_t> commit_ts{0};  // 0表示还没有提交
+};
+
+/**
+ * ReadView - 事务的快照
+ * 事务开始时记下已经分配的最大提交时间戳，之后只看得到在这之前
+ * 提交的修改和自己的修改
+ */
+struct ReadView {
+    txn_id_t txn_id = static_cast<txn_id_t>(INVALID_TXN_ID);
+    timestamp_t read_ts = 0;
+
+    /** 写事务的修改对这个快照是否可见 */
+    bool Sees(const VersionWriter& writer) const {
+        if (writer.txn_id == txn_id) {
+            return true;
+        }
+        timestamp_t commit_ts = writer.commit_ts.load();
+        return commit_ts != 0 && commit_ts <= read_ts;
+    }
+};
+
+/**
+ * SnapshotVersion - 一条记录在快照下的版本
+ * 只有和表堆里当前的内容不同时才会返回
+ */
+struct SnapshotVersion {
+    RID rid;
+    bool exists = false;  // 快照下这条记录是否存在
+    std::string data;     // 存在时是记录序列化后的字节
+};
+
+/**
+ * VersionStore - 一个表堆的撤销链
+ *
+ * 设计思路：
+ * - 表堆里始终是最新的版本，每次插入、更新、删除在页面写锁内
+ *   记下一条撤销记录：写事务和修改前的内容（插入时是"不存在"）
+ * - 同一条记录的撤销记录从旧到新排成链，快照读从最新的一条往回找，
+ *   遇到自己看得到的记录就停下，之前撤掉的最后一条的修改前内容
+ *   就是自己看到的版本；一条都没撤掉时直接用表堆里的内容
+ * - 读者持有页面读锁时查询同一页面的撤销链，和写者的修改是原子的
+ * - 链按页面组织，顺序扫描一次取出一个页面上所有不同的版本
+ * - 活跃事务都看得到的撤销记录（提交时间戳不大于所有快照）连同
+ *   更早的记录一起由Prune回收
+ * - 撤销链只在内存里，重启之后没有活跃的快照，也就不需要旧版本
+ */
+class VersionStore {
+   public:
+    /**
+     * 记下一条撤销记录，调用者持有记录所在页面的写锁
+     * @param rid 被修改的记录
+     * @param writer 写事务的提交状态
+     * @param existed 修改前记录是否存在，插入时为false
+     * @param before 修改前的记录字节，existed为false时忽略
+     * @param size 修改前的记录字节数
+     */
+    void AddVersion(const RID& rid, const std::shared_ptr<VersionWriter>& writer,
+                    bool existed, const char* before, size_t size);
+
+    /**
+     * 判断修改一条记录是否和别的事务冲突，调用者持有页面写锁
+     * 最新的撤销记录属于别的还没有提交的事务时冲突；
+     * check_snapshot为true时，在快照之后提交的修改也算冲突（先提交者胜）
+     */
+    bool HasWriteConflict(const RID& rid, const ReadView& view,
+                          bool check_snapshot) const;
+
+    /**
+     * 写事务提交或回滚之后调用，提交时间戳已经写进VersionWriter
+     */
+    void FinishWriter(txn_id_t txn_id, timestamp_t commit_ts);
+
+    /**
+     * 是否可能有对这个快照不可见的版本
+     * 返回false时表堆里的内容就是快照看到的内容，读者可以直接读表堆；
+     * 对快照不可见的撤销记录在快照结束之前不会被回收，
+     * 所以某一时刻返回false说明之前读到的内容都是快照可见的
+     */
+    bool HasInvisibleVersions(const ReadView& view) const;
+
+    /**
+     * 取出一条记录在快照下的版本
+     * @return 快照下的版本和表堆里的内容不同时返回true
+     */
+    bool GetVisibleVersion(const RID& rid, const ReadView& view,
+                           SnapshotVersion* version) const;
+
+    /**
+     * 取出一个页面上在快照下和表堆不同的所有记录，按slot排序
+     */
+    void GetPageVersions(page_id_t page_id, const ReadView& view,
+                         std::vector<SnapshotVersion>* versions) const;
+
+    /**
+     * 取出整个表堆在快照下和当前内容不同的所有记录
+     * 索引扫描用它补上索引里已经查不到的旧版本
+     */
+    void GetAllVersions(const ReadView& view,
+                        std::vector<SnapshotVersion>* versions) const;
+
+    /**
+     * 回收所有活跃快照都看得到的撤销记录
+     * @param horizon 活跃快照中最小的时间戳
+     * @return 回收的撤销记录数
+     */
+    size_t Prune(timestamp_t horizon);
+
+    /** 撤销记录的总数 */
+    size_t GetVersionCount() const;
+
+    /** 页面上是否还有记录的撤销链，有的话页面上的记录不能搬走 */
+    bool HasPageVersions(page_id_t page_id) const;
+
+   private:
+    struct UndoRecord {
+        std::shared_ptr<VersionWriter> writer;
+        bool existed;
+        std::string before;
+    };
+    using Chain = std::vector<UndoRecord>;  // 从旧到新
+
+    /**
+     * 沿撤销链找快照下的版本
+     * @return 至少撤掉了一条记录时返回true
+     */
+    static bool ResolveChain(const Chain& chain, const ReadView& view,
+                             SnapshotVersion* version);
+
+    mutable std::mutex latch_;
+    std::unordered_map<page_id_t, std::map<slot_offset_t, Chain>> pages_;
+    std::unordered_set<txn_id_t> pending_writers_;  // 未提交的写事务
+    std::atomic<size_t> pending_count_{0};
+    std::atomic<timestamp_t> newest_commit_ts_{0};  // 只增不减
+    size_t version_count_ = 0;
+};
+
+}  // namespace SimpleRDBMS
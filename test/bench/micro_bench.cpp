@@ -0,0 +1,420 @@
+// 核心数据结构的Google Benchmark微基准
+//
+// 覆盖LRUReplacer、BufferPoolManager::FetchPage（命中/未命中，1到64线程）、
+// 每种实例化键类型的BPlusTree Insert/GetValue、Tuple的序列化和反序列化、
+// ExpressionEvaluator::Evaluate、Lexer/Parser吞吐和LogManager::AppendLogRecord。
+//
+// 默认按JSON输出（--benchmark_format=json），方便按版本存档比较；
+// 其余参数和Google Benchmark一样，比如：
+//   micro_bench --benchmark_filter=BPlusTree --benchmark_out=bptree.json
+//   micro_bench --benchmark_format=console
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/lru_replacer.h"
+#include "execution/expression_evaluator.h"
+#include "index/b_plus_tree.h"
+#include "index/non_unique_key.h"
+#include "parser/lexer.h"
+#include "parser/parser.h"
+#include "recovery/log_manager.h"
+#include "recovery/log_record.h"
+#include "record/tuple.h"
+#include "storage/disk_manager.h"
+
+using namespace SimpleRDBMS;
+
+namespace {
+
+// 基准共用的数据库文件，每个用例自己建自己删
+std::unique_ptr<BufferPoolManager> MakeBufferPool(const std::string& db_file,
+                                                  size_t pool_size,
+                                                  size_t num_shards = 1) {
+    std::remove(db_file.c_str());
+    return std::make_unique<BufferPoolManager>(
+        pool_size, num_shards, std::make_unique<DiskManager>(db_file));
+}
+
+const char* const SAMPLE_QUERY =
+    "SELECT id, name, score FROM users WHERE age > 30 AND name = 'alice' "
+    "AND score * 2 + 1 >= 150.5 ORDER BY score DESC LIMIT 10";
+
+Schema MakeSampleSchema() {
+    return Schema({{"id", TypeId::INTEGER, 0, false, true},
+                   {"name", TypeId::VARCHAR, 32, true, false},
+                   {"age", TypeId::INTEGER, 0, true, false},
+                   {"score", TypeId::DOUBLE, 0, true, false},
+                   {"active", TypeId::BOOLEAN, 0, true, false}});
+}
+
+Tuple MakeSampleTuple(const Schema* schema, int32_t id) {
+    return Tuple({Value(id), Value(std::string("alice")), Value(int32_t{42}),
+                  Value(75.0), Value(true)},
+                 schema);
+}
+
+// ==================== LRUReplacer ====================
+
+void BM_LRUReplacerPinUnpin(benchmark::State& state) {
+    const size_t frames = static_cast<size_t>(state.range(0));
+    LRUReplacer replacer(frames);
+    for (size_t i = 0; i < frames; i++) {
+        replacer.Unpin(i);
+    }
+    size_t frame = 0;
+    for (auto _ : state) {
+        replacer.Pin(frame);
+        replacer.Unpin(frame);
+        frame = (frame + 1) % frames;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LRUReplacerPinUnpin)->Arg(64)->Arg(4096)->Arg(65536);
+
+void BM_LRUReplacerVictim(benchmark::State& state) {
+    const size_t frames = static_cast<size_t>(state.range(0));
+    LRUReplacer replacer(frames);
+    for (size_t i = 0; i < frames; i++) {
+        replacer.Unpin(i);
+    }
+    for (auto _ : state) {
+        size_t victim;
+        benchmark::DoNotOptimize(replacer.Victim(&victim));
+        replacer.Unpin(victim);  // 放回去，保持可淘汰的帧数不变
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LRUReplacerVictim)->Arg(64)->Arg(4096)->Arg(65536);
+
+// ==================== BufferPoolManager ====================
+
+// 多线程用例共享的缓冲池，由0号线程在计时循环之前建好、结束后销毁
+std::unique_ptr<BufferPoolManager> shared_pool;
+std::vector<page_id_t> shared_pages;
+
+void SetUpSharedPool(const std::string& db_file, size_t pool_size,
+                     size_t page_count) {
+    shared_pool = MakeBufferPool(db_file, pool_size, 16);
+    shared_pages.clear();
+    for (size_t i = 0; i < page_count; i++) {
+        page_id_t page_id;
+        Page* page = shared_pool->NewPage(&page_id);
+        std::memset(page->GetData(), static_cast<int>(i & 0xff), PAGE_SIZE);
+        shared_pool->UnpinPage(page_id, true);
+        shared_pages.push_back(page_id);
+    }
+    shared_pool->FlushAllPages();
+}
+
+void TearDownSharedPool(const std::string& db_file) {
+    shared_pool.reset();
+    shared_pages.clear();
+    std::remove(db_file.c_str());
+}
+
+void RunFetchLoop(benchmark::State& state) {
+    // 计时循环开始时所有线程会同步一次，在这之前0号线程可能还没建好缓冲池，
+    // 所以循环外不能碰shared_pages
+    std::mt19937 rng(static_cast<uint32_t>(state.thread_index()) + 1);
+    for (auto _ : state) {
+        page_id_t page_id = shared_pages[rng() % shared_pages.size()];
+        Page* page = shared_pool->FetchPage(page_id);
+        if (page != nullptr) {
+            benchmark::DoNotOptimize(page->GetData()[0]);
+            shared_pool->UnpinPage(page_id, false);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** 所有页面都在缓冲池里，测的是页表查找、pin/unpin和分片锁 */
+void BM_BufferPoolFetchHit(benchmark::State& state) {
+    const std::string db_file = "micro_bench_fetch_hit.db";
+    if (state.thread_index() == 0) {
+        SetUpSharedPool(db_file, 4096, 1024);
+    }
+    RunFetchLoop(state);
+    if (state.thread_index() == 0) {
+        TearDownSharedPool(db_file);
+    }
+}
+BENCHMARK(BM_BufferPoolFetchHit)->ThreadRange(1, 64)->UseRealTime();
+
+/** 页面数是缓冲池的16倍，绝大多数访问要淘汰一页再从磁盘（页缓存）读 */
+void BM_BufferPoolFetchMiss(benchmark::State& state) {
+    const std::string db_file = "micro_bench_fetch_miss.db";
+    if (state.thread_index() == 0) {
+        SetUpSharedPool(db_file, 256, 4096);
+    }
+    RunFetchLoop(state);
+    if (state.thread_index() == 0) {
+        TearDownSharedPool(db_file);
+    }
+}
+BENCHMARK(BM_BufferPoolFetchMiss)->ThreadRange(1, 64)->UseRealTime();
+
+// ==================== BPlusTree ====================
+
+template <typename KeyType>
+struct KeyMaker;
+
+template <>
+struct KeyMaker<int32_t> {
+    static int32_t Make(uint32_t i) { return static_cast<int32_t>(i); }
+};
+template <>
+struct KeyMaker<int64_t> {
+    static int64_t Make(uint32_t i) { return static_cast<int64_t>(i) << 20; }
+};
+template <>
+struct KeyMaker<float> {
+    static float Make(uint32_t i) { return static_cast<float>(i) * 0.5f; }
+};
+template <>
+struct KeyMaker<double> {
+    static double Make(uint32_t i) { return static_cast<double>(i) * 0.25; }
+};
+template <>
+struct KeyMaker<std::string> {
+    static std::string Make(uint32_t i) {
+        char key[16];
+        std::snprintf(key, sizeof(key), "key%08u", i);
+        return key;
+    }
+};
+template <typename K>
+struct KeyMaker<NonUniqueKey<K>> {
+    static NonUniqueKey<K> Make(uint32_t i) {
+        // 每8行共用一个键，RID区分
+        return NonUniqueKey<K>{KeyMaker<K>::Make(i / 8),
+                               RID{static_cast<page_id_t>(i / 64),
+                                   static_cast<slot_offset_t>(i % 64)}};
+    }
+};
+
+// 打乱后的插入顺序，避免总是在最右边的叶子上分裂
+std::vector<uint32_t> ShuffledIds(size_t count) {
+    std::vector<uint32_t> ids(count);
+    for (size_t i = 0; i < count; i++) {
+        ids[i] = static_cast<uint32_t>(i);
+    }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(42));
+    return ids;
+}
+
+/** 每次迭代插入一个新键，树从空开始增长；键用完后换一棵新树 */
+template <typename KeyType>
+void BM_BPlusTreeInsert(benchmark::State& state) {
+    const std::string db_file = "micro_bench_bptree_insert.db";
+    constexpr size_t KEYS_PER_TREE = 1 << 18;
+    auto ids = ShuffledIds(KEYS_PER_TREE);
+    std::vector<KeyType> keys;
+    keys.reserve(ids.size());
+    for (uint32_t id : ids) {
+        keys.push_back(KeyMaker<KeyType>::Make(id));
+    }
+
+    auto bpm = MakeBufferPool(db_file, 16384);
+    auto tree = std::make_unique<BPlusTree<KeyType, RID>>("bench_idx", bpm.get(),
+                                                          INVALID_PAGE_ID);
+    size_t next = 0;
+    for (auto _ : state) {
+        if (next == keys.size()) {
+            state.PauseTiming();
+            tree.reset();
+            bpm = MakeBufferPool(db_file, 16384);
+            tree = std::make_unique<BPlusTree<KeyType, RID>>(
+                "bench_idx", bpm.get(), INVALID_PAGE_ID);
+            next = 0;
+            state.ResumeTiming();
+        }
+        RID rid{static_cast<page_id_t>(next / 64),
+                static_cast<slot_offset_t>(next % 64)};
+        benchmark::DoNotOptimize(tree->Insert(keys[next], rid));
+        next++;
+    }
+    state.SetItemsProcessed(state.iterations());
+    tree.reset();
+    bpm.reset();
+    std::remove(db_file.c_str());
+}
+
+/** 先建好一棵state.range(0)个键的树，再随机查找 */
+template <typename KeyType>
+void BM_BPlusTreeGetValue(benchmark::State& state) {
+    const std::string db_file = "micro_bench_bptree_get.db";
+    const size_t key_count = static_cast<size_t>(state.range(0));
+    auto ids = ShuffledIds(key_count);
+    std::vector<KeyType> keys;
+    keys.reserve(ids.size());
+    for (uint32_t id : ids) {
+        keys.push_back(KeyMaker<KeyType>::Make(id));
+    }
+
+    auto bpm = MakeBufferPool(db_file, 16384);
+    BPlusTree<KeyType, RID> tree("bench_idx", bpm.get(), INVALID_PAGE_ID);
+    for (size_t i = 0; i < keys.size(); i++) {
+        tree.Insert(keys[i], RID{static_cast<page_id_t>(i / 64),
+                                 static_cast<slot_offset_t>(i % 64)});
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+    for (auto _ : state) {
+        RID rid;
+        benchmark::DoNotOptimize(tree.GetValue(keys[pick(rng)], &rid));
+    }
+    state.SetItemsProcessed(state.iterations());
+    bpm.reset();
+    std::remove(db_file.c_str());
+}
+
+#define BPLUS_TREE_BENCHMARKS(KeyType)                                   \
+    BENCHMARK_TEMPLATE(BM_BPlusTreeInsert, KeyType);                     \
+    BENCHMARK_TEMPLATE(BM_BPlusTreeGetValue, KeyType)->Arg(10000)->Arg(200000)
+
+BPLUS_TREE_BENCHMARKS(int32_t);
+BPLUS_TREE_BENCHMARKS(int64_t);
+BPLUS_TREE_BENCHMARKS(float);
+BPLUS_TREE_BENCHMARKS(double);
+BPLUS_TREE_BENCHMARKS(std::string);
+BPLUS_TREE_BENCHMARKS(NonUniqueKey<int32_t>);
+BPLUS_TREE_BENCHMARKS(NonUniqueKey<int64_t>);
+BPLUS_TREE_BENCHMARKS(NonUniqueKey<float>);
+BPLUS_TREE_BENCHMARKS(NonUniqueKey<double>);
+BPLUS_TREE_BENCHMARKS(NonUniqueKey<std::string>);
+
+// ==================== Tuple ====================
+
+void BM_TupleSerialize(benchmark::State& state) {
+    Schema schema = MakeSampleSchema();
+    Tuple tuple = MakeSampleTuple(&schema, 1);
+    std::vector<char> buffer(tuple.GetSerializedSize());
+    for (auto _ : state) {
+        tuple.SerializeTo(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<int64_t>(buffer.size()));
+}
+BENCHMARK(BM_TupleSerialize);
+
+void BM_TupleDeserialize(benchmark::State& state) {
+    Schema schema = MakeSampleSchema();
+    Tuple source = MakeSampleTuple(&schema, 1);
+    std::vector<char> buffer(source.GetSerializedSize());
+    source.SerializeTo(buffer.data());
+    Tuple tuple;
+    for (auto _ : state) {
+        tuple.DeserializeFrom(buffer.data(), &schema);
+        benchmark::DoNotOptimize(tuple);
+    }
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<int64_t>(buffer.size()));
+}
+BENCHMARK(BM_TupleDeserialize);
+
+// ==================== ExpressionEvaluator ====================
+
+/** 对一行求SAMPLE_QUERY的WHERE条件：比较、AND和算术都覆盖到 */
+void BM_ExpressionEvaluate(benchmark::State& state) {
+    Schema schema = MakeSampleSchema();
+    Tuple tuple = MakeSampleTuple(&schema, 1);
+    Parser parser(SAMPLE_QUERY);
+    auto statement = parser.Parse();
+    auto* select = static_cast<SelectStatement*>(statement.get());
+    ExpressionEvaluator evaluator(&schema);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            evaluator.EvaluateAsBoolean(select->GetWhereClause(), tuple));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ExpressionEvaluate);
+
+// ==================== Lexer / Parser ====================
+
+void BM_LexerTokenize(benchmark::State& state) {
+    const std::string query = SAMPLE_QUERY;
+    for (auto _ : state) {
+        Lexer lexer(query);
+        while (lexer.NextToken().type != TokenType::EOF_TOKEN) {
+        }
+    }
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<int64_t>(query.size()));
+}
+BENCHMARK(BM_LexerTokenize);
+
+void BM_ParserParse(benchmark::State& state) {
+    const std::string query = SAMPLE_QUERY;
+    for (auto _ : state) {
+        Parser parser(query);
+        benchmark::DoNotOptimize(parser.Parse());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<int64_t>(query.size()));
+}
+BENCHMARK(BM_ParserParse);
+
+// ==================== LogManager ====================
+
+std::unique_ptr<LogManager> shared_log;
+
+/** 追加INSERT日志记录；缓冲区由后台线程刷盘，测的是追加路径本身 */
+void BM_LogManagerAppend(benchmark::State& state) {
+    const std::string log_file = "micro_bench.log";
+    if (state.thread_index() == 0) {
+        LogManager::RemoveLogFiles(log_file);
+        shared_log = std::make_unique<LogManager>(log_file);
+    }
+    Schema schema = MakeSampleSchema();
+    Tuple tuple = MakeSampleTuple(&schema, 1);
+    // 记录的LSN由AppendLogRecord写回，每个线程用自己的记录
+    InsertLogRecord record(state.thread_index() + 1, INVALID_LSN, RID{1, 0},
+                           tuple);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(shared_log->AppendLogRecord(&record));
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        shared_log.reset();
+        LogManager::RemoveLogFiles(log_file);
+    }
+}
+BENCHMARK(BM_LogManagerAppend)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
+
+// 没有指定--benchmark_format时默认输出JSON
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv, argv + argc);
+    bool has_format = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--benchmark_format", 18) == 0) {
+            has_format = true;
+        }
+    }
+    static char json_format[] = "--benchmark_format=json";
+    if (!has_format) {
+        args.insert(args.begin() + 1, json_format);
+    }
+    int arg_count = static_cast<int>(args.size());
+    benchmark::Initialize(&arg_count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(arg_count, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,817 @@
+// YCSB风格的并发负载基准测试
+//
+// 直接驱动执行引擎（默认），或者通过socket驱动simple_rdbms_server（--server）。
+// 六种负载和YCSB的core workload一致：
+//   a: 50%读 50%更新        b: 95%读 5%更新        c: 100%读
+//   d: 95%读最新的记录 5%插入  e: 95%范围扫描 5%插入  f: 50%读 50%读-改-写
+// 同样的参数和种子得到同样的操作序列，可以用来比较两个版本的吞吐和延迟。
+//
+// 用法示例：
+//   rdbms_bench --workload a --records 100000 --operations 200000 --threads 8
+//   rdbms_bench --workload b --duration 30 --server 127.0.0.1:5432
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "execution/execution_engine.h"
+#include "parser/parser.h"
+#include "recovery/log_manager.h"
+#include "stat/metrics.h"
+#include "storage/disk_manager.h"
+#include "transaction/lock_manager.h"
+#include "transaction/transaction_manager.h"
+
+using namespace SimpleRDBMS;
+
+namespace {
+
+// ==================== 参数 ====================
+
+struct BenchOptions {
+    char workload = 'a';
+    uint64_t record_count = 10000;
+    uint64_t operation_count = 100000;
+    int duration_seconds = 0;  // 大于0时按时间运行，忽略operation_count
+    int threads = 4;
+    int warmup_seconds = 2;
+    int field_count = 10;
+    int field_length = 100;
+    int max_scan_length = 100;
+    double zipfian_theta = 0.99;
+    uint64_t seed = 42;
+    size_t buffer_pool_size = 4096;
+    std::string db_file = "rdbms_bench.db";
+    std::string server;  // host:port，为空时直接驱动执行引擎
+    std::string user = "admin";
+    std::string password = "admin";
+    bool skip_load = false;
+};
+
+void PrintUsage(const char* program) {
+    std::cout
+        << "Usage: " << program << " [options]\n"
+        << "  -w, --workload a|b|c|d|e|f   YCSB core workload (default a)\n"
+        << "  -r, --records N              records loaded before the run (default 10000)\n"
+        << "  -o, --operations N           operations in the measured run (default 100000)\n"
+        << "  -t, --duration SECONDS       run for a fixed time instead of --operations\n"
+        << "  -n, --threads N              client threads (default 4)\n"
+        << "  -u, --warmup SECONDS         unmeasured warmup before the run (default 2)\n"
+        << "      --fields N               VARCHAR fields per record (default 10)\n"
+        << "      --field-length N         bytes per field (default 100)\n"
+        << "      --max-scan-length N      longest scan in workload e (default 100)\n"
+        << "      --theta X                Zipfian constant (default 0.99)\n"
+        << "      --seed N                 random seed (default 42)\n"
+        << "  -b, --buffer-pool-size N     engine mode: buffer pool frames (default 4096)\n"
+        << "  -d, --db FILE                engine mode: database file (default rdbms_bench.db)\n"
+        << "  -s, --server HOST:PORT       drive simple_rdbms_server instead of the engine\n"
+        << "      --user NAME              server mode: user (default admin)\n"
+        << "      --password PASSWORD      server mode: password (default admin)\n"
+        << "      --skip-load              server mode: usertable is already loaded\n"
+        << "  -h, --help                   show this help\n";
+}
+
+bool ParseOptions(int argc, char* argv[], BenchOptions* options) {
+    enum {
+        OPT_FIELDS = 1000,
+        OPT_FIELD_LENGTH,
+        OPT_MAX_SCAN_LENGTH,
+        OPT_THETA,
+        OPT_SEED,
+        OPT_USER,
+        OPT_PASSWORD,
+        OPT_SKIP_LOAD
+    };
+    static struct option long_options[] = {
+        {"workload", required_argument, 0, 'w'},
+        {"records", required_argument, 0, 'r'},
+        {"operations", required_argument, 0, 'o'},
+        {"duration", required_argument, 0, 't'},
+        {"threads", required_argument, 0, 'n'},
+        {"warmup", required_argument, 0, 'u'},
+        {"fields", required_argument, 0, OPT_FIELDS},
+        {"field-length", required_argument, 0, OPT_FIELD_LENGTH},
+        {"max-scan-length", required_argument, 0, OPT_MAX_SCAN_LENGTH},
+        {"theta", required_argument, 0, OPT_THETA},
+        {"seed", required_argument, 0, OPT_SEED},
+        {"buffer-pool-size", required_argument, 0, 'b'},
+        {"db", required_argument, 0, 'd'},
+        {"server", required_argument, 0, 's'},
+        {"user", required_argument, 0, OPT_USER},
+        {"password", required_argument, 0, OPT_PASSWORD},
+        {"skip-load", no_argument, 0, OPT_SKIP_LOAD},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}};
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "w:r:o:t:n:u:b:d:s:h", long_options,
+                              nullptr)) != -1) {
+        switch (opt) {
+            case 'w':
+                options->workload = static_cast<char>(std::tolower(optarg[0]));
+                break;
+            case 'r':
+                options->record_count = std::stoull(optarg);
+                break;
+            case 'o':
+                options->operation_count = std::stoull(optarg);
+                break;
+            case 't':
+                options->duration_seconds = std::stoi(optarg);
+                break;
+            case 'n':
+                options->threads = std::stoi(optarg);
+                break;
+            case 'u':
+                options->warmup_seconds = std::stoi(optarg);
+                break;
+            case OPT_FIELDS:
+                options->field_count = std::stoi(optarg);
+                break;
+            case OPT_FIELD_LENGTH:
+                options->field_length = std::stoi(optarg);
+                break;
+            case OPT_MAX_SCAN_LENGTH:
+                options->max_scan_length = std::stoi(optarg);
+                break;
+            case OPT_THETA:
+                options->zipfian_theta = std::stod(optarg);
+                break;
+            case OPT_SEED:
+                options->seed = std::stoull(optarg);
+                break;
+            case 'b':
+                options->buffer_pool_size = std::stoul(optarg);
+                break;
+            case 'd':
+                options->db_file = optarg;
+                break;
+            case 's':
+                options->server = optarg;
+                break;
+            case OPT_USER:
+                options->user = optarg;
+                break;
+            case OPT_PASSWORD:
+                options->password = optarg;
+                break;
+            case OPT_SKIP_LOAD:
+                options->skip_load = true;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    if (options->workload < 'a' || options->workload > 'f') {
+        std::cerr << "Unknown workload: " << options->workload << std::endl;
+        return false;
+    }
+    if (options->record_count == 0 || options->threads < 1 ||
+        options->field_count < 1 || options->field_length < 1 ||
+        options->max_scan_length < 1 || options->zipfian_theta <= 0.0 ||
+        options->zipfian_theta >= 1.0) {
+        std::cerr << "Invalid option value" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ==================== 负载定义 ====================
+
+enum class Operation { READ = 0, UPDATE, INSERT, SCAN, READ_MODIFY_WRITE };
+constexpr size_t OPERATION_COUNT = 5;
+const char* const OPERATION_NAMES[OPERATION_COUNT] = {
+    "READ", "UPDATE", "INSERT", "SCAN", "READ-MODIFY-WRITE"};
+
+enum class KeyDistribution { ZIPFIAN, LATEST };
+
+struct Workload {
+    std::array<double, OPERATION_COUNT> proportions;  // 按Operation的顺序
+    KeyDistribution distribution;
+};
+
+Workload GetWorkload(char name) {
+    switch (name) {
+        case 'a':
+            return {{0.5, 0.5, 0.0, 0.0, 0.0}, KeyDistribution::ZIPFIAN};
+        case 'b':
+            return {{0.95, 0.05, 0.0, 0.0, 0.0}, KeyDistribution::ZIPFIAN};
+        case 'c':
+            return {{1.0, 0.0, 0.0, 0.0, 0.0}, KeyDistribution::ZIPFIAN};
+        case 'd':
+            return {{0.95, 0.0, 0.05, 0.0, 0.0}, KeyDistribution::LATEST};
+        case 'e':
+            return {{0.0, 0.0, 0.05, 0.95, 0.0}, KeyDistribution::ZIPFIAN};
+        default:
+            return {{0.5, 0.0, 0.0, 0.0, 0.5}, KeyDistribution::ZIPFIAN};
+    }
+}
+
+/**
+ * Zipfian分布的整数，范围[0, items)，算法和YCSB的ZipfianGenerator一致
+ * （Gray等人的"Quickly Generating Billion-Record Synthetic Databases"）。
+ * zeta(n)要O(n)算一次，只在构造时算；线程共享一个生成器，Next不修改状态
+ */
+class ZipfianGenerator {
+   public:
+    ZipfianGenerator(uint64_t items, double theta)
+        : items_(items), theta_(theta) {
+        double zeta2 = Zeta(2, theta);
+        zetan_ = Zeta(items, theta);
+        alpha_ = 1.0 / (1.0 - theta);
+        eta_ = (1.0 - std::pow(2.0 / static_cast<double>(items), 1.0 - theta)) /
+               (1.0 - zeta2 / zetan_);
+    }
+
+    uint64_t Next(std::mt19937_64* rng) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(*rng);
+        double uz = u * zetan_;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < 1.0 + std::pow(0.5, theta_)) {
+            return 1;
+        }
+        auto value = static_cast<uint64_t>(
+            static_cast<double>(items_) *
+            std::pow(eta_ * u - eta_ + 1.0, alpha_));
+        return std::min(value, items_ - 1);
+    }
+
+    /** 打散后的Zipfian：热点分散在整个键空间，而不是集中在最小的几个键上 */
+    uint64_t NextScrambled(std::mt19937_64* rng) const {
+        return Fnv1a64(Next(rng)) % items_;
+    }
+
+   private:
+    static double Zeta(uint64_t n, double theta) {
+        double sum = 0.0;
+        for (uint64_t i = 1; i <= n; i++) {
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        return sum;
+    }
+
+    static uint64_t Fnv1a64(uint64_t value) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (int i = 0; i < 8; i++) {
+            hash ^= value & 0xff;
+            hash *= 0x100000001b3ULL;
+            value >>= 8;
+        }
+        return hash;
+    }
+
+    uint64_t items_;
+    double theta_;
+    double zetan_;
+    double alpha_;
+    double eta_;
+};
+
+// ==================== 客户端 ====================
+
+/** 执行一条SQL，返回是否成功；实现不要求线程安全，每个线程一个 */
+class BenchClient {
+   public:
+    virtual ~BenchClient() = default;
+    virtual bool Execute(const std::string& sql) = 0;
+};
+
+/** 直接驱动执行引擎的数据库实例，所有客户端线程共享 */
+struct EngineDatabase {
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager;
+    std::unique_ptr<LogManager> log_manager;
+    std::unique_ptr<LockManager> lock_manager;
+    std::unique_ptr<TransactionManager> transaction_manager;
+    std::unique_ptr<Catalog> catalog;
+    std::unique_ptr<ExecutionEngine> execution_engine;
+
+    explicit EngineDatabase(const BenchOptions& options) {
+        std::remove(options.db_file.c_str());
+        std::string log_file = options.db_file + ".log";
+        LogManager::RemoveLogFiles(log_file);
+
+        // 和服务器一样的组装方式，缓冲池按线程数分片
+        size_t shards = std::max<size_t>(1, static_cast<size_t>(options.threads));
+        buffer_pool_manager = std::make_unique<BufferPoolManager>(
+            options.buffer_pool_size, shards,
+            std::make_unique<DiskManager>(options.db_file));
+        log_manager = std::make_unique<LogManager>(log_file);
+        buffer_pool_manager->SetLogManager(log_manager.get());
+        lock_manager = std::make_unique<LockManager>();
+        lock_manager->StartDeadlockDetection(DeadlockDetectorConfig{});
+        transaction_manager = std::make_unique<TransactionManager>(
+            lock_manager.get(), log_manager.get());
+        catalog = std::make_unique<Catalog>(buffer_pool_manager.get());
+        execution_engine = std::make_unique<ExecutionEngine>(
+            buffer_pool_manager.get(), catalog.get(),
+            transaction_manager.get());
+    }
+
+    ~EngineDatabase() {
+        execution_engine.reset();
+        catalog.reset();
+        transaction_manager.reset();
+        lock_manager.reset();
+        buffer_pool_manager.reset();
+        log_manager.reset();
+    }
+};
+
+/** 每条语句一个自动提交的事务，SELECT走只读事务，和服务器的行为一致 */
+class EngineClient : public BenchClient {
+   public:
+    explicit EngineClient(EngineDatabase* database) : database_(database) {}
+
+    bool Execute(const std::string& sql) override {
+        bool read_only = sql.compare(0, 6, "SELECT") == 0;
+        Transaction* txn = database_->transaction_manager->Begin(
+            IsolationLevel::REPEATABLE_READ, read_only);
+        bool success = false;
+        try {
+            Parser parser(sql);
+            auto statement = parser.Parse();
+            std::vector<Tuple> result_set;
+            success = database_->execution_engine->Execute(statement.get(),
+                                                           &result_set, txn);
+        } catch (const std::exception& e) {
+            success = false;
+        }
+        if (success) {
+            return database_->transaction_manager->Commit(txn);
+        }
+        database_->transaction_manager->Abort(txn);
+        return false;
+    }
+
+   private:
+    EngineDatabase* database_;
+};
+
+/** 通过simple_rdbms_server的文本协议执行：AUTH一次，之后每条语句一个QUERY */
+class SocketClient : public BenchClient {
+   public:
+    ~SocketClient() override {
+        if (socket_ >= 0) {
+            close(socket_);
+        }
+    }
+
+    bool Connect(const std::string& address, const std::string& user,
+                 const std::string& password) {
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos) {
+            std::cerr << "Server address must be HOST:PORT" << std::endl;
+            return false;
+        }
+        std::string host = address.substr(0, colon);
+        std::string port = address.substr(colon + 1);
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0) {
+            std::cerr << "Cannot resolve " << address << std::endl;
+            return false;
+        }
+        for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+            socket_ = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (socket_ < 0) {
+                continue;
+            }
+            if (connect(socket_, ai->ai_addr, ai->ai_addrlen) == 0) {
+                break;
+            }
+            close(socket_);
+            socket_ = -1;
+        }
+        freeaddrinfo(result);
+        if (socket_ < 0) {
+            std::cerr << "Cannot connect to " << address << std::endl;
+            return false;
+        }
+
+        std::string line;
+        if (!ReadLine(&line)) {  // greeting
+            return false;
+        }
+        if (!Send("AUTH " + user + " " + password + "\n") || !ReadLine(&line) ||
+            line.compare(0, 5, "ERROR") == 0) {
+            std::cerr << "Authentication failed: " << line << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool Execute(const std::string& sql) override {
+        if (!Send("QUERY " + sql + "\n")) {
+            return false;
+        }
+        std::string line;
+        if (!ReadLine(&line)) {
+            return false;
+        }
+        if (line.compare(0, 6, "RESULT") == 0) {
+            // RESULT <rows>，然后是列名一行和每行一行
+            size_t rows = std::stoul(line.substr(7));
+            for (size_t i = 0; i < rows + 1; i++) {
+                if (!ReadLine(&line)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return line.compare(0, 2, "OK") == 0;
+    }
+
+   private:
+    bool Send(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(socket_, data.data() + sent, data.size() - sent,
+                             MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool ReadLine(std::string* line) {
+        line->clear();
+        while (true) {
+            size_t newline = buffer_.find('\n', offset_);
+            if (newline != std::string::npos) {
+                line->assign(buffer_, offset_, newline - offset_);
+                offset_ = newline + 1;
+                if (offset_ == buffer_.size()) {
+                    buffer_.clear();
+                    offset_ = 0;
+                }
+                return true;
+            }
+            char chunk[16384];
+            ssize_t n = recv(socket_, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                return false;
+            }
+            buffer_.append(chunk, static_cast<size_t>(n));
+        }
+    }
+
+    int socket_ = -1;
+    std::string buffer_;
+    size_t offset_ = 0;
+};
+
+// ==================== 语句生成 ====================
+
+std::string RandomField(std::mt19937_64* rng, int length) {
+    static const char ALPHABET[] =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    std::uniform_int_distribution<int> pick(0, sizeof(ALPHABET) - 2);
+    std::string field(static_cast<size_t>(length), 'a');
+    for (char& c : field) {
+        c = ALPHABET[pick(*rng)];
+    }
+    return field;
+}
+
+std::string CreateTableSql(const BenchOptions& options) {
+    std::ostringstream sql;
+    sql << "CREATE TABLE usertable (ycsb_key INT PRIMARY KEY";
+    for (int i = 0; i < options.field_count; i++) {
+        sql << ", field" << i << " VARCHAR(" << options.field_length << ")";
+    }
+    sql << ")";
+    return sql.str();
+}
+
+std::string InsertSql(const BenchOptions& options, uint64_t first_key,
+                      uint64_t count, std::mt19937_64* rng) {
+    std::ostringstream sql;
+    sql << "INSERT INTO usertable VALUES ";
+    for (uint64_t key = first_key; key < first_key + count; key++) {
+        sql << (key == first_key ? "(" : ", (") << key;
+        for (int i = 0; i < options.field_count; i++) {
+            sql << ", '" << RandomField(rng, options.field_length) << "'";
+        }
+        sql << ")";
+    }
+    return sql.str();
+}
+
+std::string ReadSql(uint64_t key) {
+    return "SELECT * FROM usertable WHERE ycsb_key = " + std::to_string(key);
+}
+
+std::string UpdateSql(const BenchOptions& options, uint64_t key,
+                      std::mt19937_64* rng) {
+    // 和YCSB的默认设置一样只改一个字段
+    int field = std::uniform_int_distribution<int>(
+        0, options.field_count - 1)(*rng);
+    return "UPDATE usertable SET field" + std::to_string(field) + " = '" +
+           RandomField(rng, options.field_length) +
+           "' WHERE ycsb_key = " + std::to_string(key);
+}
+
+std::string ScanSql(uint64_t start_key, uint64_t length) {
+    return "SELECT * FROM usertable WHERE ycsb_key >= " +
+           std::to_string(start_key) + " AND ycsb_key < " +
+           std::to_string(start_key + length);
+}
+
+// ==================== 运行 ====================
+
+/** 一个线程的延迟直方图和错误数，运行结束后合并 */
+struct ThreadResult {
+    std::array<std::unique_ptr<LatencyHistogram>, OPERATION_COUNT> latency;
+    std::array<uint64_t, OPERATION_COUNT> errors{};
+
+    ThreadResult() {
+        for (auto& histogram : latency) {
+            histogram = std::make_unique<LatencyHistogram>();
+        }
+    }
+};
+
+/** 所有客户端线程共享的运行状态 */
+struct RunState {
+    const BenchOptions* options;
+    Workload workload;
+    std::unique_ptr<ZipfianGenerator> zipfian;
+    std::atomic<uint64_t> next_insert_key{0};  // 下一个插入的键
+    std::atomic<uint64_t> remaining_ops{0};    // 按次数运行时剩下的操作数
+    std::atomic<bool> measuring{false};        // 预热结束后才记录
+    std::atomic<bool> stop{false};
+};
+
+Operation ChooseOperation(const Workload& workload, std::mt19937_64* rng) {
+    double r = std::uniform_real_distribution<double>(0.0, 1.0)(*rng);
+    for (size_t i = 0; i < OPERATION_COUNT; i++) {
+        if (r < workload.proportions[i]) {
+            return static_cast<Operation>(i);
+        }
+        r -= workload.proportions[i];
+    }
+    // 舍入误差时取比例最大的操作
+    auto largest = std::max_element(workload.proportions.begin(),
+                                    workload.proportions.end());
+    return static_cast<Operation>(largest - workload.proportions.begin());
+}
+
+/**
+ * 选择一个已经存在的键
+ * LATEST分布把Zipfian的0对到最近插入的键上；插入的键超过了
+ * 生成器的范围也没关系，只是最旧的那些键再也不会被选中
+ */
+uint64_t ChooseKey(RunState* state, std::mt19937_64* rng) {
+    if (state->workload.distribution == KeyDistribution::LATEST) {
+        uint64_t newest = state->next_insert_key.load() - 1;
+        uint64_t offset = state->zipfian->Next(rng);
+        return offset > newest ? 0 : newest - offset;
+    }
+    return state->zipfian->NextScrambled(rng);
+}
+
+bool RunOperation(RunState* state, BenchClient* client, Operation op,
+                  std::mt19937_64* rng) {
+    const BenchOptions& options = *state->options;
+    switch (op) {
+        case Operation::READ:
+            return client->Execute(ReadSql(ChooseKey(state, rng)));
+        case Operation::UPDATE:
+            return client->Execute(UpdateSql(options, ChooseKey(state, rng), rng));
+        case Operation::INSERT: {
+            uint64_t key = state->next_insert_key.fetch_add(1);
+            return client->Execute(InsertSql(options, key, 1, rng));
+        }
+        case Operation::SCAN: {
+            uint64_t length = std::uniform_int_distribution<uint64_t>(
+                1, static_cast<uint64_t>(options.max_scan_length))(*rng);
+            return client->Execute(ScanSql(ChooseKey(state, rng), length));
+        }
+        case Operation::READ_MODIFY_WRITE: {
+            uint64_t key = ChooseKey(state, rng);
+            return client->Execute(ReadSql(key)) &&
+                   client->Execute(UpdateSql(options, key, rng));
+        }
+    }
+    return false;
+}
+
+void ClientLoop(RunState* state, BenchClient* client, int thread_index,
+                ThreadResult* result) {
+    std::mt19937_64 rng(state->options->seed * 1000003ULL +
+                        static_cast<uint64_t>(thread_index));
+    bool timed = state->options->duration_seconds > 0;
+    while (!state->stop.load()) {
+        bool measuring = state->measuring.load();
+        if (measuring && !timed) {
+            // 按次数运行：取一个名额，取完就结束
+            uint64_t remaining = state->remaining_ops.load();
+            do {
+                if (remaining == 0) {
+                    return;
+                }
+            } while (!state->remaining_ops.compare_exchange_weak(
+                remaining, remaining - 1));
+        }
+        Operation op = ChooseOperation(state->workload, &rng);
+        auto start = std::chrono::steady_clock::now();
+        bool success = RunOperation(state, client, op, &rng);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (!measuring) {
+            continue;
+        }
+        size_t index = static_cast<size_t>(op);
+        result->latency[index]->RecordMicros(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                .count()));
+        if (!success) {
+            result->errors[index]++;
+        }
+    }
+}
+
+/** 多个线程分段插入初始记录，每条INSERT带100行 */
+bool LoadRecords(const BenchOptions& options,
+                 std::vector<std::unique_ptr<BenchClient>>* clients) {
+    constexpr uint64_t ROWS_PER_STATEMENT = 100;
+    std::atomic<uint64_t> next_key{0};
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < clients->size(); i++) {
+        threads.emplace_back([&, i]() {
+            std::mt19937_64 rng(options.seed + i);
+            while (!failed.load()) {
+                uint64_t first = next_key.fetch_add(ROWS_PER_STATEMENT);
+                if (first >= options.record_count) {
+                    return;
+                }
+                uint64_t count =
+                    std::min(ROWS_PER_STATEMENT, options.record_count - first);
+                if (!(*clients)[i]->Execute(
+                        InsertSql(options, first, count, &rng))) {
+                    std::cerr << "Load failed at key " << first << std::endl;
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return !failed.load();
+}
+
+void PrintReport(const std::vector<ThreadResult>& results, double run_seconds) {
+    std::array<LatencyHistogram::Snapshot, OPERATION_COUNT> merged;
+    std::array<uint64_t, OPERATION_COUNT> errors{};
+    uint64_t total_ops = 0;
+    for (const auto& result : results) {
+        for (size_t i = 0; i < OPERATION_COUNT; i++) {
+            merged[i].Merge(result.latency[i]->GetSnapshot());
+            errors[i] += result.errors[i];
+        }
+    }
+    for (const auto& snapshot : merged) {
+        total_ops += snapshot.count;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "[OVERALL], RunTime(ms), " << run_seconds * 1000.0 << "\n";
+    std::cout << "[OVERALL], Operations, " << total_ops << "\n";
+    std::cout << "[OVERALL], Throughput(ops/sec), "
+              << (run_seconds > 0 ? total_ops / run_seconds : 0.0) << "\n";
+    for (size_t i = 0; i < OPERATION_COUNT; i++) {
+        const auto& snapshot = merged[i];
+        if (snapshot.count == 0) {
+            continue;
+        }
+        const char* name = OPERATION_NAMES[i];
+        std::cout << "[" << name << "], Operations, " << snapshot.count << "\n";
+        std::cout << "[" << name << "], Errors, " << errors[i] << "\n";
+        std::cout << "[" << name << "], AverageLatency(us), "
+                  << static_cast<double>(snapshot.sum_us) / snapshot.count
+                  << "\n";
+        std::cout << "[" << name << "], 50thPercentileLatency(us), "
+                  << snapshot.ValueAtPercentile(50.0) << "\n";
+        std::cout << "[" << name << "], 95thPercentileLatency(us), "
+                  << snapshot.ValueAtPercentile(95.0) << "\n";
+        std::cout << "[" << name << "], 99thPercentileLatency(us), "
+                  << snapshot.ValueAtPercentile(99.0) << "\n";
+        std::cout << "[" << name << "], 99.9thPercentileLatency(us), "
+                  << snapshot.ValueAtPercentile(99.9) << "\n";
+        std::cout << "[" << name << "], MaxLatency(us), " << snapshot.max_us
+                  << "\n";
+    }
+    std::cout.flush();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, &options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // 每个线程一个客户端；引擎模式的客户端共享一个数据库实例
+    std::unique_ptr<EngineDatabase> database;
+    std::vector<std::unique_ptr<BenchClient>> clients;
+    if (options.server.empty()) {
+        database = std::make_unique<EngineDatabase>(options);
+        for (int i = 0; i < options.threads; i++) {
+            clients.push_back(std::make_unique<EngineClient>(database.get()));
+        }
+    } else {
+        for (int i = 0; i < options.threads; i++) {
+            auto client = std::make_unique<SocketClient>();
+            if (!client->Connect(options.server, options.user,
+                                 options.password)) {
+                return 1;
+            }
+            clients.push_back(std::move(client));
+        }
+    }
+
+    std::cout << "Workload " << options.workload << ": "
+              << options.record_count << " records, " << options.threads
+              << " threads, "
+              << (options.server.empty() ? "engine" : options.server)
+              << std::endl;
+
+    if (!options.skip_load || options.server.empty()) {
+        auto load_start = std::chrono::steady_clock::now();
+        if (!clients[0]->Execute(CreateTableSql(options))) {
+            std::cerr << "Cannot create usertable" << std::endl;
+            return 1;
+        }
+        if (!LoadRecords(options, &clients)) {
+            return 1;
+        }
+        std::chrono::duration<double> load_time =
+            std::chrono::steady_clock::now() - load_start;
+        std::cout << "[LOAD], RunTime(ms), " << std::fixed
+                  << std::setprecision(2) << load_time.count() * 1000.0
+                  << std::endl;
+    }
+
+    RunState state;
+    state.options = &options;
+    state.workload = GetWorkload(options.workload);
+    state.zipfian = std::make_unique<ZipfianGenerator>(options.record_count,
+                                                       options.zipfian_theta);
+    state.next_insert_key = options.record_count;
+    state.remaining_ops = options.operation_count;
+
+    std::vector<ThreadResult> results(clients.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < clients.size(); i++) {
+        threads.emplace_back(ClientLoop, &state, clients[i].get(),
+                             static_cast<int>(i), &results[i]);
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(options.warmup_seconds));
+    auto run_start = std::chrono::steady_clock::now();
+    state.measuring = true;
+    if (options.duration_seconds > 0) {
+        std::this_thread::sleep_for(
+            std::chrono::seconds(options.duration_seconds));
+        state.stop = true;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> run_time =
+        std::chrono::steady_clock::now() - run_start;
+
+    PrintReport(results, run_time.count());
+    return 0;
+}
@@ -0,0 +1,1153 @@
+// simple_rdbms_server的网络负载生成器
+//
+// 每个线程一个epoll循环，管理一批非阻塞连接，可以开几千个连接；
+// 连接说文本协议（SimpleProtocolHandler），或者认证后发BINARY切到二进制协议。
+//
+// 默认是开环的：按--rate给定的总速率排好每个请求"应该发出"的时间，
+// 到点了就交给一个空闲连接，没有空闲连接就排队。延迟从计划发出的时间
+// 算到收到完整响应，服务器变慢时排队的时间也算在里面，不会像闭环客户端
+// 那样因为少发了请求而把长尾藏起来（coordinated omission）。
+// 报告同时给出从实际发出算起的服务时间，两者的差就是排队。
+// --rate 0是闭环模式：每个连接收到响应后立刻发下一个请求。
+//
+// 请求来自脚本，每行"<权重> <SQL>"，#开头是注释，SQL里的{rand:LO:HI}
+// 每次发送时换成[LO, HI]之间的随机整数，比如：
+//   90 SELECT * FROM t WHERE id = {rand:1:10000}
+//   10 UPDATE t SET v = {rand:0:99} WHERE id = {rand:1:10000}
+// 没有脚本时用--query给的语句（可以给多个，权重相同）。
+//
+// 用法示例：
+//   rdbms_loadgen --server 127.0.0.1:5432 --connections 2000 --threads 8
+//                 --rate 20000 --duration 30 --script mix.txt --protocol binary
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "stat/metrics.h"
+
+using namespace SimpleRDBMS;
+
+namespace {
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// ==================== 参数 ====================
+
+struct LoadOptions {
+    std::string server = "127.0.0.1:5432";
+    int connections = 100;
+    int threads = 4;
+    double rate = 1000.0;  // 每秒请求数，0表示闭环
+    int duration_seconds = 10;
+    int warmup_seconds = 2;
+    double connect_rate = 0.0;  // 每秒新建的连接数，0表示一次全部发起
+    bool binary = false;
+    std::string script_file;
+    std::vector<std::string> queries;
+    std::vector<std::string> setup;
+    std::string user = "admin";
+    std::string password = "admin";
+    uint64_t seed = 42;
+};
+
+void PrintUsage(const char* program) {
+    std::cout
+        << "Usage: " << program << " [options]\n"
+        << "  -s, --server HOST:PORT     server address (default 127.0.0.1:5432)\n"
+        << "  -c, --connections N        connections (default 100)\n"
+        << "  -n, --threads N            event loop threads (default 4)\n"
+        << "  -r, --rate N               target requests/sec, 0 = closed loop (default 1000)\n"
+        << "  -t, --duration SECONDS     measured run time (default 10)\n"
+        << "  -u, --warmup SECONDS       unmeasured warmup (default 2)\n"
+        << "      --connect-rate N       new connections/sec, 0 = all at once (default 0)\n"
+        << "  -p, --protocol text|binary wire protocol (default text)\n"
+        << "  -f, --script FILE          weighted query mix, one \"<weight> <SQL>\" per line\n"
+        << "  -q, --query SQL            query to run when there is no script (repeatable)\n"
+        << "      --setup SQL            statement run once before the load (repeatable)\n"
+        << "      --user NAME            user (default admin)\n"
+        << "      --password PASSWORD    password (default admin)\n"
+        << "      --seed N               random seed (default 42)\n"
+        << "  -h, --help                 show this help\n";
+}
+
+bool ParseOptions(int argc, char* argv[], LoadOptions* options) {
+    enum { OPT_CONNECT_RATE = 1000, OPT_SETUP, OPT_USER, OPT_PASSWORD, OPT_SEED };
+    static struct option long_options[] = {
+        {"server", required_argument, 0, 's'},
+        {"connections", required_argument, 0, 'c'},
+        {"threads", required_argument, 0, 'n'},
+        {"rate", required_argument, 0, 'r'},
+        {"duration", required_argument, 0, 't'},
+        {"warmup", required_argument, 0, 'u'},
+        {"connect-rate", required_argument, 0, OPT_CONNECT_RATE},
+        {"protocol", required_argument, 0, 'p'},
+        {"script", required_argument, 0, 'f'},
+        {"query", required_argument, 0, 'q'},
+        {"setup", required_argument, 0, OPT_SETUP},
+        {"user", required_argument, 0, OPT_USER},
+        {"password", required_argument, 0, OPT_PASSWORD},
+        {"seed", required_argument, 0, OPT_SEED},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}};
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:c:n:r:t:u:p:f:q:h", long_options,
+                              nullptr)) != -1) {
+        switch (opt) {
+            case 's':
+                options->server = optarg;
+                break;
+            case 'c':
+                options->connections = std::stoi(optarg);
+                break;
+            case 'n':
+                options->threads = std::stoi(optarg);
+                break;
+            case 'r':
+                options->rate = std::stod(optarg);
+                break;
+            case 't':
+                options->duration_seconds = std::stoi(optarg);
+                break;
+            case 'u':
+                options->warmup_seconds = std::stoi(optarg);
+                break;
+            case OPT_CONNECT_RATE:
+                options->connect_rate = std::stod(optarg);
+                break;
+            case 'p':
+                if (std::string(optarg) == "binary") {
+                    options->binary = true;
+                } else if (std::string(optarg) != "text") {
+                    std::cerr << "Unknown protocol: " << optarg << std::endl;
+                    return false;
+                }
+                break;
+            case 'f':
+                options->script_file = optarg;
+                break;
+            case 'q':
+                options->queries.push_back(optarg);
+                break;
+            case OPT_SETUP:
+                options->setup.push_back(optarg);
+                break;
+            case OPT_USER:
+                options->user = optarg;
+                break;
+            case OPT_PASSWORD:
+                options->password = optarg;
+                break;
+            case OPT_SEED:
+                options->seed = std::stoull(optarg);
+                break;
+            default:
+                return false;
+        }
+    }
+
+    if (options->connections < 1 || options->threads < 1 ||
+        options->rate < 0.0 || options->duration_seconds < 1 ||
+        options->connect_rate < 0.0) {
+        std::cerr << "Invalid option value" << std::endl;
+        return false;
+    }
+    options->threads = std::min(options->threads, options->connections);
+    if (options->script_file.empty() && options->queries.empty()) {
+        std::cerr << "Either --script or --query is required" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ==================== 脚本 ====================
+
+/**
+ * 脚本里的一条语句，预先切成字面量和随机数占位符，
+ * 发送时按顺序拼起来
+ */
+struct ScriptEntry {
+    struct Segment {
+        std::string literal;
+        bool is_random = false;
+        int64_t low = 0;
+        int64_t high = 0;
+    };
+
+    double weight = 1.0;
+    std::string text;
+    std::vector<Segment> segments;
+
+    std::string Expand(std::mt19937_64* rng) const {
+        std::string sql;
+        for (const auto& segment : segments) {
+            if (segment.is_random) {
+                sql += std::to_string(std::uniform_int_distribution<int64_t>(
+                    segment.low, segment.high)(*rng));
+            } else {
+                sql += segment.literal;
+            }
+        }
+        return sql;
+    }
+};
+
+bool CompileEntry(const std::string& sql, double weight, ScriptEntry* entry) {
+    entry->weight = weight;
+    entry->text = sql;
+    size_t pos = 0;
+    while (pos < sql.size()) {
+        size_t open = sql.find("{rand:", pos);
+        if (open == std::string::npos) {
+            entry->segments.push_back({sql.substr(pos), false, 0, 0});
+            break;
+        }
+        size_t close = sql.find('}', open);
+        if (close == std::string::npos) {
+            std::cerr << "Unterminated placeholder: " << sql << std::endl;
+            return false;
+        }
+        if (open > pos) {
+            entry->segments.push_back({sql.substr(pos, open - pos), false, 0, 0});
+        }
+        std::string range = sql.substr(open + 6, close - open - 6);
+        size_t colon = range.find(':');
+        ScriptEntry::Segment segment;
+        segment.is_random = true;
+        try {
+            segment.low = std::stoll(range.substr(0, colon));
+            segment.high = std::stoll(range.substr(colon + 1));
+        } catch (const std::exception&) {
+            colon = std::string::npos;
+        }
+        if (colon == std::string::npos || segment.low > segment.high) {
+            std::cerr << "Invalid placeholder {rand:" << range << "}" << std::endl;
+            return false;
+        }
+        entry->segments.push_back(segment);
+        pos = close + 1;
+    }
+    return true;
+}
+
+bool LoadScript(const LoadOptions& options, std::vector<ScriptEntry>* entries) {
+    if (options.script_file.empty()) {
+        for (const auto& query : options.queries) {
+            ScriptEntry entry;
+            if (!CompileEntry(query, 1.0, &entry)) {
+                return false;
+            }
+            entries->push_back(std::move(entry));
+        }
+        return true;
+    }
+
+    std::ifstream file(options.script_file);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open script " << options.script_file << std::endl;
+        return false;
+    }
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+        std::istringstream iss(line.substr(start));
+        double weight = 0.0;
+        std::string sql;
+        if (!(iss >> weight) || weight <= 0.0 || !std::getline(iss >> std::ws, sql) ||
+            sql.empty()) {
+            std::cerr << options.script_file << ":" << line_number
+                      << ": expected \"<weight> <SQL>\"" << std::endl;
+            return false;
+        }
+        ScriptEntry entry;
+        if (!CompileEntry(sql, weight, &entry)) {
+            return false;
+        }
+        entries->push_back(std::move(entry));
+    }
+    if (entries->empty()) {
+        std::cerr << "Script " << options.script_file << " has no queries"
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ==================== 协议 ====================
+
+/**
+ * 从接收缓冲区里取出一个完整的响应单元
+ * 返回值：>0 消耗的字节数，0 数据还不够
+ */
+size_t TakeLine(const std::string& buffer, size_t offset, std::string* line) {
+    size_t newline = buffer.find('\n', offset);
+    if (newline == std::string::npos) {
+        return 0;
+    }
+    line->assign(buffer, offset, newline - offset);
+    return newline + 1 - offset;
+}
+
+std::string EncodeQuery(bool binary, const std::string& sql) {
+    if (!binary) {
+        return "QUERY " + sql + "\n";
+    }
+    // u32长度（类型加负载）+ 'Q' + SQL
+    uint32_t length = static_cast<uint32_t>(sql.size() + 1);
+    std::string frame(4, '\0');
+    frame[0] = static_cast<char>((length >> 24) & 0xff);
+    frame[1] = static_cast<char>((length >> 16) & 0xff);
+    frame[2] = static_cast<char>((length >> 8) & 0xff);
+    frame[3] = static_cast<char>(length & 0xff);
+    frame += 'Q';
+    frame += sql;
+    return frame;
+}
+
+/**
+ * 增量解析一个查询的响应
+ * 文本协议：OK/ERROR一行，或者RESULT n加列名一行和n行数据
+ * 二进制协议：若干帧，以'C'（完成）或'E'（错误）结束
+ */
+class ResponseParser {
+   public:
+    explicit ResponseParser(bool binary) : binary_(binary) {}
+
+    void Reset() {
+        remaining_lines_ = -1;
+        error_ = false;
+    }
+
+    /**
+     * 尽量消耗buffer[*offset...]，响应完整时返回true
+     */
+    bool Consume(const std::string& buffer, size_t* offset) {
+        return binary_ ? ConsumeFrames(buffer, offset)
+                       : ConsumeLines(buffer, offset);
+    }
+
+    bool IsError() const { return error_; }
+
+   private:
+    bool ConsumeLines(const std::string& buffer, size_t* offset) {
+        std::string line;
+        while (size_t used = TakeLine(buffer, *offset, &line)) {
+            *offset += used;
+            if (remaining_lines_ < 0) {
+                if (line.compare(0, 6, "RESULT") == 0) {
+                    remaining_lines_ =
+                        static_cast<int64_t>(std::strtoull(line.c_str() + 6,
+                                                           nullptr, 10)) + 1;
+                    continue;
+                }
+                error_ = line.compare(0, 2, "OK") != 0;
+                return true;
+            }
+            if (--remaining_lines_ == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ConsumeFrames(const std::string& buffer, size_t* offset) {
+        while (buffer.size() - *offset >= 5) {
+            const auto* bytes =
+                reinterpret_cast<const unsigned char*>(buffer.data() + *offset);
+            uint32_t length = (static_cast<uint32_t>(bytes[0]) << 24) |
+                              (static_cast<uint32_t>(bytes[1]) << 16) |
+                              (static_cast<uint32_t>(bytes[2]) << 8) |
+                              static_cast<uint32_t>(bytes[3]);
+            if (buffer.size() - *offset < 4 + static_cast<size_t>(length)) {
+                return false;
+            }
+            char type = static_cast<char>(bytes[4]);
+            *offset += 4 + length;
+            if (type == 'C' || type == 'K') {
+                return true;
+            }
+            if (type == 'E') {
+                error_ = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool binary_;
+    int64_t remaining_lines_ = -1;
+    bool error_ = false;
+};
+
+// ==================== 连接 ====================
+
+enum class ConnState {
+    CONNECTING,  // 非阻塞connect还没完成
+    GREETING,    // 等服务器的READY
+    AUTHENTICATING,
+    SWITCHING,   // 发了BINARY，等OK BINARY
+    IDLE,
+    BUSY,        // 请求已发出，等响应
+    CLOSED
+};
+
+struct Connection {
+    int fd = -1;
+    ConnState state = ConnState::CONNECTING;
+    std::string in;
+    size_t in_offset = 0;
+    std::string out;
+    size_t out_offset = 0;
+    bool want_write = false;
+    int64_t connect_start_ns = 0;
+    int64_t intended_ns = 0;  // 请求计划发出的时间
+    int64_t sent_ns = 0;      // 请求实际发出的时间
+    size_t entry = 0;
+    ResponseParser parser;
+
+    explicit Connection(bool binary) : parser(binary) {}
+};
+
+/** 一个线程的统计，运行结束后合并 */
+struct ThreadStats {
+    std::unique_ptr<LatencyHistogram> latency = std::make_unique<LatencyHistogram>();
+    std::unique_ptr<LatencyHistogram> service = std::make_unique<LatencyHistogram>();
+    std::unique_ptr<LatencyHistogram> connect = std::make_unique<LatencyHistogram>();
+    std::vector<std::unique_ptr<LatencyHistogram>> entry_latency;
+    std::vector<uint64_t> entry_errors;
+    uint64_t completed = 0;
+    uint64_t errors = 0;
+    uint64_t disconnects = 0;
+    uint64_t connect_failures = 0;
+    uint64_t max_backlog = 0;
+};
+
+/** 所有线程共享的运行状态 */
+struct SharedState {
+    const LoadOptions* options = nullptr;
+    const std::vector<ScriptEntry>* entries = nullptr;
+    std::vector<double> cumulative_weights;
+    sockaddr_storage address{};
+    socklen_t address_length = 0;
+
+    std::atomic<int> ready_connections{0};
+    std::atomic<int> failed_connections{0};
+    std::atomic<bool> generating{false};
+    std::atomic<int64_t> generate_start_ns{0};
+    std::atomic<int64_t> measure_start_ns{LLONG_MAX};
+    std::atomic<bool> stop{false};
+};
+
+/**
+ * LoadThread - 一个epoll循环和它负责的连接
+ *
+ * 实现思路：
+ * 1. 按connect_rate逐个发起非阻塞connect，完成后读问候、认证、按需切协议，
+ *    之后进入空闲连接列表
+ * 2. 开环模式下按本线程的速率份额推进计划时间，到期的请求进入待发队列；
+ *    待发队列和空闲连接都不空时就发出去，延迟从计划时间算
+ * 3. epoll_wait的超时取到下一个计划时间，尽量准时；来不及的请求
+ *    留在队列里，排队时间算进延迟
+ */
+class LoadThread {
+   public:
+    LoadThread(SharedState* shared, int index, int connection_count)
+        : shared_(shared),
+          options_(*shared->options),
+          rng_(shared->options->seed * 1000003ULL + static_cast<uint64_t>(index)),
+          index_(index),
+          connection_count_(connection_count) {
+        size_t entry_count = shared_->entries->size();
+        stats_.entry_errors.assign(entry_count, 0);
+        for (size_t i = 0; i < entry_count; i++) {
+            stats_.entry_latency.push_back(std::make_unique<LatencyHistogram>());
+        }
+        if (options_.rate > 0.0) {
+            interval_ns_ = static_cast<int64_t>(
+                1e9 * options_.threads / options_.rate);
+        }
+        if (options_.connect_rate > 0.0) {
+            connect_interval_ns_ = static_cast<int64_t>(
+                1e9 * options_.threads / options_.connect_rate);
+        }
+    }
+
+    ~LoadThread() {
+        for (auto& conn : connections_) {
+            if (conn->fd >= 0) {
+                close(conn->fd);
+            }
+        }
+        if (epoll_fd_ >= 0) {
+            close(epoll_fd_);
+        }
+    }
+
+    const ThreadStats& GetStats() const { return stats_; }
+
+    void Run() {
+        epoll_fd_ = epoll_create1(0);
+        if (epoll_fd_ < 0) {
+            std::cerr << "epoll_create1: " << std::strerror(errno) << std::endl;
+            shared_->failed_connections += connection_count_;
+            return;
+        }
+        std::vector<epoll_event> events(256);
+        int64_t next_connect_ns = NowNs();
+        while (!shared_->stop.load()) {
+            int64_t now = NowNs();
+            while (opened_ < connection_count_ && now >= next_connect_ns) {
+                OpenConnection();
+                next_connect_ns += connect_interval_ns_;
+                if (connect_interval_ns_ == 0) {
+                    next_connect_ns = now;
+                }
+            }
+
+            GenerateDue(now);
+            Dispatch();
+
+            int timeout_ms = ComputeTimeoutMs(NowNs(), next_connect_ns);
+            int ready = epoll_wait(epoll_fd_, events.data(),
+                                   static_cast<int>(events.size()), timeout_ms);
+            for (int i = 0; i < ready; i++) {
+                auto* conn = static_cast<Connection*>(events[i].data.ptr);
+                HandleEvent(conn, events[i].events);
+            }
+        }
+    }
+
+   private:
+    void OpenConnection() {
+        opened_++;
+        auto conn = std::make_unique<Connection>(options_.binary);
+        conn->connect_start_ns = NowNs();
+        conn->fd = socket(shared_->address.ss_family,
+                          SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (conn->fd < 0) {
+            FailConnection(conn.get());
+            connections_.push_back(std::move(conn));
+            return;
+        }
+        int one = 1;
+        setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        int rc = connect(conn->fd,
+                         reinterpret_cast<const sockaddr*>(&shared_->address),
+                         shared_->address_length);
+        if (rc < 0 && errno != EINPROGRESS) {
+            FailConnection(conn.get());
+            connections_.push_back(std::move(conn));
+            return;
+        }
+        conn->state = ConnState::CONNECTING;
+        conn->want_write = true;
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT;
+        event.data.ptr = conn.get();
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, conn->fd, &event);
+        connections_.push_back(std::move(conn));
+    }
+
+    /** 建连阶段失败：不会再重连 */
+    void FailConnection(Connection* conn) {
+        stats_.connect_failures++;
+        shared_->failed_connections++;
+        CloseConnection(conn);
+    }
+
+    /** 运行中断开：请求没有响应，计一次断开 */
+    void DropConnection(Connection* conn) {
+        if (conn->state == ConnState::BUSY || conn->state == ConnState::IDLE) {
+            stats_.disconnects++;
+            // 断开前在等的请求还要有人发，放回队列
+            if (conn->state == ConnState::BUSY && interval_ns_ > 0) {
+                pending_.push_front(conn->intended_ns);
+            }
+            auto it = std::find(idle_.begin(), idle_.end(), conn);
+            if (it != idle_.end()) {
+                idle_.erase(it);
+            }
+        } else {
+            stats_.connect_failures++;
+            shared_->failed_connections++;
+        }
+        CloseConnection(conn);
+    }
+
+    void CloseConnection(Connection* conn) {
+        if (conn->fd >= 0) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+            close(conn->fd);
+            conn->fd = -1;
+        }
+        conn->state = ConnState::CLOSED;
+    }
+
+    void HandleEvent(Connection* conn, uint32_t events) {
+        if (conn->state == ConnState::CLOSED) {
+            return;
+        }
+        if (conn->state == ConnState::CONNECTING) {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &error, &length);
+            if (error != 0 || (events & (EPOLLERR | EPOLLHUP))) {
+                FailConnection(conn);
+                return;
+            }
+            conn->state = ConnState::GREETING;
+            UpdateInterest(conn, false);
+        }
+        if (events & EPOLLOUT) {
+            if (!FlushOutput(conn)) {
+                DropConnection(conn);
+                return;
+            }
+        }
+        if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+            if (!ReadInput(conn)) {
+                DropConnection(conn);
+                return;
+            }
+            ProcessInput(conn);
+        }
+    }
+
+    bool ReadInput(Connection* conn) {
+        char chunk[65536];
+        while (true) {
+            ssize_t n = recv(conn->fd, chunk, sizeof(chunk), 0);
+            if (n > 0) {
+                conn->in.append(chunk, static_cast<size_t>(n));
+                continue;
+            }
+            if (n == 0) {
+                return false;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+    }
+
+    void ProcessInput(Connection* conn) {
+        std::string line;
+        bool progressed = true;
+        while (progressed && conn->state != ConnState::CLOSED) {
+            progressed = false;
+            switch (conn->state) {
+                case ConnState::GREETING:
+                    if (size_t used = TakeLine(conn->in, conn->in_offset, &line)) {
+                        conn->in_offset += used;
+                        conn->state = ConnState::AUTHENTICATING;
+                        Send(conn, "AUTH " + options_.user + " " +
+                                       options_.password + "\n");
+                        progressed = true;
+                    }
+                    break;
+                case ConnState::AUTHENTICATING:
+                    if (size_t used = TakeLine(conn->in, conn->in_offset, &line)) {
+                        conn->in_offset += used;
+                        if (line.compare(0, 2, "OK") != 0) {
+                            FailConnection(conn);
+                            return;
+                        }
+                        if (options_.binary) {
+                            conn->state = ConnState::SWITCHING;
+                            Send(conn, "BINARY\n");
+                        } else {
+                            MarkReady(conn);
+                        }
+                        progressed = true;
+                    }
+                    break;
+                case ConnState::SWITCHING:
+                    if (size_t used = TakeLine(conn->in, conn->in_offset, &line)) {
+                        conn->in_offset += used;
+                        if (line.compare(0, 2, "OK") != 0) {
+                            FailConnection(conn);
+                            return;
+                        }
+                        MarkReady(conn);
+                        progressed = true;
+                    }
+                    break;
+                case ConnState::BUSY:
+                    if (conn->parser.Consume(conn->in, &conn->in_offset)) {
+                        CompleteRequest(conn);
+                        progressed = true;
+                    }
+                    break;
+                default:
+                    // 空闲时不应该有数据，丢掉
+                    conn->in_offset = conn->in.size();
+                    break;
+            }
+        }
+        if (conn->in_offset == conn->in.size()) {
+            conn->in.clear();
+            conn->in_offset = 0;
+        } else if (conn->in_offset > 65536) {
+            conn->in.erase(0, conn->in_offset);
+            conn->in_offset = 0;
+        }
+    }
+
+    void MarkReady(Connection* conn) {
+        conn->state = ConnState::IDLE;
+        stats_.connect->RecordMicros(static_cast<uint64_t>(
+            (NowNs() - conn->connect_start_ns) / 1000));
+        shared_->ready_connections++;
+        idle_.push_back(conn);
+    }
+
+    void CompleteRequest(Connection* conn) {
+        int64_t now = NowNs();
+        bool error = conn->parser.IsError();
+        if (conn->intended_ns >= shared_->measure_start_ns.load()) {
+            auto latency_us = static_cast<uint64_t>((now - conn->intended_ns) / 1000);
+            stats_.latency->RecordMicros(latency_us);
+            stats_.service->RecordMicros(
+                static_cast<uint64_t>((now - conn->sent_ns) / 1000));
+            stats_.entry_latency[conn->entry]->RecordMicros(latency_us);
+            stats_.completed++;
+            if (error) {
+                stats_.errors++;
+                stats_.entry_errors[conn->entry]++;
+            }
+        }
+        conn->state = ConnState::IDLE;
+        idle_.push_back(conn);
+    }
+
+    /** 开环模式：把到期的计划时间放进待发队列 */
+    void GenerateDue(int64_t now) {
+        if (!shared_->generating.load() || interval_ns_ == 0) {
+            return;
+        }
+        if (next_intended_ns_ == 0) {
+            // 各线程错开一点，避免同时发出
+            next_intended_ns_ = shared_->generate_start_ns.load() +
+                                interval_ns_ * index_ / options_.threads;
+        }
+        while (next_intended_ns_ <= now) {
+            pending_.push_back(next_intended_ns_);
+            next_intended_ns_ += interval_ns_;
+        }
+        stats_.max_backlog =
+            std::max<uint64_t>(stats_.max_backlog, pending_.size());
+    }
+
+    void Dispatch() {
+        if (!shared_->generating.load()) {
+            return;
+        }
+        while (!idle_.empty()) {
+            int64_t intended;
+            if (interval_ns_ > 0) {
+                if (pending_.empty()) {
+                    return;
+                }
+                intended = pending_.front();
+                pending_.pop_front();
+            } else {
+                intended = NowNs();  // 闭环：没有计划时间，发出即开始
+            }
+            Connection* conn = idle_.front();
+            idle_.pop_front();
+            SendRequest(conn, intended);
+        }
+    }
+
+    void SendRequest(Connection* conn, int64_t intended_ns) {
+        double r = std::uniform_real_distribution<double>(
+            0.0, shared_->cumulative_weights.back())(rng_);
+        size_t entry = static_cast<size_t>(
+            std::upper_bound(shared_->cumulative_weights.begin(),
+                             shared_->cumulative_weights.end(), r) -
+            shared_->cumulative_weights.begin());
+        entry = std::min(entry, shared_->entries->size() - 1);
+
+        conn->entry = entry;
+        conn->intended_ns = intended_ns;
+        conn->sent_ns = NowNs();
+        conn->parser.Reset();
+        conn->state = ConnState::BUSY;
+        Send(conn, EncodeQuery(options_.binary,
+                               (*shared_->entries)[entry].Expand(&rng_)));
+    }
+
+    void Send(Connection* conn, const std::string& data) {
+        conn->out += data;
+        if (!FlushOutput(conn)) {
+            DropConnection(conn);
+        }
+    }
+
+    bool FlushOutput(Connection* conn) {
+        while (conn->out_offset < conn->out.size()) {
+            ssize_t n = send(conn->fd, conn->out.data() + conn->out_offset,
+                             conn->out.size() - conn->out_offset, MSG_NOSIGNAL);
+            if (n > 0) {
+                conn->out_offset += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                UpdateInterest(conn, true);
+                return true;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        conn->out.clear();
+        conn->out_offset = 0;
+        UpdateInterest(conn, false);
+        return true;
+    }
+
+    void UpdateInterest(Connection* conn, bool want_write) {
+        if (conn->want_write == want_write) {
+            return;
+        }
+        conn->want_write = want_write;
+        epoll_event event{};
+        event.events = EPOLLIN | (want_write ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        event.data.ptr = conn;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn->fd, &event);
+    }
+
+    int ComputeTimeoutMs(int64_t now, int64_t next_connect_ns) const {
+        int64_t deadline = now + 100'000'000;  // 最多100ms检查一次stop
+        if (opened_ < connection_count_) {
+            deadline = std::min(deadline, next_connect_ns);
+        }
+        if (interval_ns_ > 0 && next_intended_ns_ != 0) {
+            deadline = std::min(deadline, next_intended_ns_);
+        }
+        if (interval_ns_ > 0 && !pending_.empty() && !idle_.empty()) {
+            return 0;
+        }
+        if (interval_ns_ > 0 && next_intended_ns_ == 0 && shared_->generating.load()) {
+            return 0;
+        }
+        int64_t wait_ns = deadline - now;
+        if (wait_ns <= 0) {
+            return 0;
+        }
+        // 向上取整会让计划时间晚一点点，但延迟从计划时间算，不影响结果
+        return static_cast<int>((wait_ns + 999'999) / 1'000'000);
+    }
+
+    SharedState* shared_;
+    const LoadOptions& options_;
+    std::mt19937_64 rng_;
+    int index_;
+    int connection_count_;
+    int opened_ = 0;
+    int epoll_fd_ = -1;
+    int64_t interval_ns_ = 0;          // 本线程相邻两个计划时间的间隔，0表示闭环
+    int64_t connect_interval_ns_ = 0;  // 本线程相邻两次建连的间隔
+    int64_t next_intended_ns_ = 0;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::deque<Connection*> idle_;
+    std::deque<int64_t> pending_;  // 到期还没发出的请求的计划时间
+    ThreadStats stats_;
+};
+
+// ==================== 初始化 ====================
+
+bool ResolveAddress(const std::string& server, SharedState* shared) {
+    size_t colon = server.rfind(':');
+    if (colon == std::string::npos) {
+        std::cerr << "Server address must be HOST:PORT" << std::endl;
+        return false;
+    }
+    std::string host = server.substr(0, colon);
+    std::string port = server.substr(colon + 1);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0 ||
+        result == nullptr) {
+        std::cerr << "Cannot resolve " << server << std::endl;
+        return false;
+    }
+    std::memcpy(&shared->address, result->ai_addr, result->ai_addrlen);
+    shared->address_length = result->ai_addrlen;
+    freeaddrinfo(result);
+    return true;
+}
+
+/** 几千个连接需要的文件描述符数超过默认的软限制，尽量提到硬限制 */
+void RaiseFileLimit(int connections) {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+        return;
+    }
+    rlim_t wanted = static_cast<rlim_t>(connections) + 64;
+    if (limit.rlim_cur < wanted) {
+        limit.rlim_cur = std::min(wanted, limit.rlim_max);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    if (limit.rlim_cur < wanted) {
+        std::cerr << "Warning: open file limit " << limit.rlim_cur
+                  << " is below " << wanted << std::endl;
+    }
+}
+
+/** 阻塞地在一个文本连接上执行--setup的语句 */
+bool RunSetup(const LoadOptions& options, const SharedState& shared) {
+    if (options.setup.empty()) {
+        return true;
+    }
+    int fd = socket(shared.address.ss_family, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr*>(&shared.address),
+                          shared.address_length) != 0) {
+        std::cerr << "Cannot connect to " << options.server << std::endl;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+
+    std::string buffer;
+    size_t offset = 0;
+    auto read_more = [&]() {
+        char chunk[16384];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+        return true;
+    };
+    auto read_line = [&](std::string* line) {
+        while (true) {
+            if (size_t used = TakeLine(buffer, offset, line)) {
+                offset += used;
+                return true;
+            }
+            if (!read_more()) {
+                return false;
+            }
+        }
+    };
+    auto send_all = [&](const std::string& data) {
+        return send(fd, data.data(), data.size(), MSG_NOSIGNAL) ==
+               static_cast<ssize_t>(data.size());
+    };
+
+    std::string line;
+    bool ok = read_line(&line) &&
+              send_all("AUTH " + options.user + " " + options.password + "\n") &&
+              read_line(&line) && line.compare(0, 2, "OK") == 0;
+    for (size_t i = 0; ok && i < options.setup.size(); i++) {
+        ResponseParser parser(false);
+        ok = send_all(EncodeQuery(false, options.setup[i]));
+        while (ok && !parser.Consume(buffer, &offset)) {
+            ok = read_more();
+        }
+        if (ok && parser.IsError()) {
+            std::cerr << "Setup statement failed: " << options.setup[i]
+                      << std::endl;
+        }
+    }
+    close(fd);
+    if (!ok) {
+        std::cerr << "Setup failed" << std::endl;
+    }
+    return ok;
+}
+
+// ==================== 报告 ====================
+
+double Ms(uint64_t micros) { return static_cast<double>(micros) / 1000.0; }
+
+void PrintLatency(const std::string& label,
+                  const LatencyHistogram::Snapshot& snapshot) {
+    if (snapshot.count == 0) {
+        return;
+    }
+    std::cout << "[" << label << "], AverageLatency(ms), "
+              << Ms(snapshot.sum_us) / snapshot.count << "\n";
+    std::cout << "[" << label << "], 50thPercentileLatency(ms), "
+              << Ms(snapshot.ValueAtPercentile(50.0)) << "\n";
+    std::cout << "[" << label << "], 90thPercentileLatency(ms), "
+              << Ms(snapshot.ValueAtPercentile(90.0)) << "\n";
+    std::cout << "[" << label << "], 99thPercentileLatency(ms), "
+              << Ms(snapshot.ValueAtPercentile(99.0)) << "\n";
+    std::cout << "[" << label << "], 99.9thPercentileLatency(ms), "
+              << Ms(snapshot.ValueAtPercentile(99.9)) << "\n";
+    std::cout << "[" << label << "], MaxLatency(ms), " << Ms(snapshot.max_us)
+              << "\n";
+}
+
+void PrintReport(const LoadOptions& options,
+                 const std::vector<ScriptEntry>& entries,
+                 const std::vector<std::unique_ptr<LoadThread>>& threads,
+                 double run_seconds) {
+    LatencyHistogram::Snapshot latency, service, connect;
+    std::vector<LatencyHistogram::Snapshot> entry_latency(entries.size());
+    std::vector<uint64_t> entry_errors(entries.size(), 0);
+    uint64_t completed = 0, errors = 0, disconnects = 0, connect_failures = 0;
+    uint64_t max_backlog = 0;
+    for (const auto& thread : threads) {
+        const ThreadStats& stats = thread->GetStats();
+        latency.Merge(stats.latency->GetSnapshot());
+        service.Merge(stats.service->GetSnapshot());
+        connect.Merge(stats.connect->GetSnapshot());
+        for (size_t i = 0; i < entries.size(); i++) {
+            entry_latency[i].Merge(stats.entry_latency[i]->GetSnapshot());
+            entry_errors[i] += stats.entry_errors[i];
+        }
+        completed += stats.completed;
+        errors += stats.errors;
+        disconnects += stats.disconnects;
+        connect_failures += stats.connect_failures;
+        max_backlog += stats.max_backlog;
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "[OVERALL], RunTime(ms), " << run_seconds * 1000.0 << "\n";
+    std::cout << "[OVERALL], Protocol, " << (options.binary ? "binary" : "text")
+              << "\n";
+    std::cout << "[OVERALL], TargetRate(ops/sec), "
+              << (options.rate > 0.0 ? std::to_string(options.rate) : "closed-loop")
+              << "\n";
+    std::cout << "[OVERALL], Requests, " << completed << "\n";
+    std::cout << "[OVERALL], Throughput(ops/sec), "
+              << (run_seconds > 0 ? completed / run_seconds : 0.0) << "\n";
+    std::cout << "[OVERALL], Errors, " << errors << "\n";
+    std::cout << "[OVERALL], Disconnects, " << disconnects << "\n";
+    if (options.rate > 0.0) {
+        std::cout << "[OVERALL], MaxBacklog, " << max_backlog << "\n";
+    }
+    std::cout << "[CONNECT], Established, " << connect.count << "\n";
+    std::cout << "[CONNECT], Failed, " << connect_failures << "\n";
+    PrintLatency("CONNECT", connect);
+    // 开环时LATENCY从计划时间算（已经修正了coordinated omission），
+    // SERVICE从实际发出算；闭环时两者相同
+    PrintLatency("LATENCY", latency);
+    PrintLatency("SERVICE", service);
+    if (entries.size() > 1) {
+        for (size_t i = 0; i < entries.size(); i++) {
+            std::string label = "QUERY " + std::to_string(i + 1);
+            std::cout << "[" << label << "], Text, " << entries[i].text << "\n";
+            std::cout << "[" << label << "], Requests, "
+                      << entry_latency[i].count << "\n";
+            std::cout << "[" << label << "], Errors, " << entry_errors[i] << "\n";
+            PrintLatency(label, entry_latency[i]);
+        }
+    }
+    std::cout.flush();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    if (!ParseOptions(argc, argv, &options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    std::vector<ScriptEntry> entries;
+    if (!LoadScript(options, &entries)) {
+        return 1;
+    }
+
+    SharedState shared;
+    shared.options = &options;
+    shared.entries = &entries;
+    double total_weight = 0.0;
+    for (const auto& entry : entries) {
+        total_weight += entry.weight;
+        shared.cumulative_weights.push_back(total_weight);
+    }
+    if (!ResolveAddress(options.server, &shared) || !RunSetup(options, shared)) {
+        return 1;
+    }
+    RaiseFileLimit(options.connections);
+
+    // 连接按线程平均分
+    std::vector<std::unique_ptr<LoadThread>> load_threads;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.threads; i++) {
+        int count = options.connections / options.threads +
+                    (i < options.connections % options.threads ? 1 : 0);
+        load_threads.push_back(std::make_unique<LoadThread>(&shared, i, count));
+    }
+    for (auto& load_thread : load_threads) {
+        threads.emplace_back(&LoadThread::Run, load_thread.get());
+    }
+
+    // 等所有连接建好（或者失败），最多等到按connect_rate算的时间再加30秒
+    double connect_seconds =
+        options.connect_rate > 0.0 ? options.connections / options.connect_rate : 0.0;
+    auto connect_deadline = std::chrono::steady_clock::now() +
+                            std::chrono::milliseconds(static_cast<int64_t>(
+                                (connect_seconds + 30.0) * 1000.0));
+    while (shared.ready_connections.load() + shared.failed_connections.load() <
+               options.connections &&
+           std::chrono::steady_clock::now() < connect_deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::cout << "Connections: " << shared.ready_connections.load() << " ready, "
+              << shared.failed_connections.load() << " failed" << std::endl;
+    if (shared.ready_connections.load() == 0) {
+        shared.stop = true;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return 1;
+    }
+
+    shared.generate_start_ns = NowNs();
+    shared.generating = true;
+    std::this_thread::sleep_for(std::chrono::seconds(options.warmup_seconds));
+    int64_t run_start = NowNs();
+    shared.measure_start_ns = run_start;
+    std::this_thread::sleep_for(std::chrono::seconds(options.duration_seconds));
+    shared.stop = true;
+    double run_seconds = static_cast<double>(NowNs() - run_start) / 1e9;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    PrintReport(options, entries, load_threads, run_seconds);
+    return 0;
+}
@@ -0,0 +1,872 @@
+// TPC-C风格的事务基准测试
+//
+// 直接驱动TransactionManager、LockManager和ExecutionEngine，每个终端线程
+// 按45:43:12的比例循环执行New-Order、Payment和Order-Status三种事务，
+// 每种事务都是一个显式事务里的多条语句，锁在提交时才释放，
+// 热点在district.d_next_o_id（New-Order）和warehouse.w_ytd（Payment）上。
+//
+// 和TPC-C规范的差别：
+// - 没有复合主键，各表的主键是拼出来的整数（见下面的*Key函数）
+// - 客户只按编号选（规范里60%按姓选），也不维护history以外的辅助表
+// - 客户表里记着最后一个订单号，Order-Status不用按客户扫订单表
+// - 没有思考时间和键入时间，终端线程尽可能快地提交
+// - 默认规模比规范小（每个区300个客户、10000种商品），用--customers和--items调整
+//
+// 报告：tpmC（每分钟提交的New-Order数）、每种事务的提交/中止数和延迟，
+// 以及测量期间Statistics记录的事务中止数、锁等待次数和等锁时间。
+//
+// 用法示例（写冲突中止时引擎会打ERROR日志，SIMPLEDB_DEBUG_LEVEL=0关掉）：
+//   SIMPLEDB_DEBUG_LEVEL=0 tpcc_bench --warehouses 2 --terminals 8 --duration 30
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "execution/execution_engine.h"
+#include "parser/parser.h"
+#include "recovery/log_manager.h"
+#include "stat/metrics.h"
+#include "stat/stat.h"
+#include "storage/disk_manager.h"
+#include "transaction/lock_manager.h"
+#include "transaction/transaction_manager.h"
+
+using namespace SimpleRDBMS;
+
+namespace {
+
+// ==================== 参数 ====================
+
+struct BenchOptions {
+    int warehouses = 1;
+    int terminals = 4;
+    int duration_seconds = 10;
+    int warmup_seconds = 2;
+    int customers_per_district = 300;
+    int items = 10000;
+    uint64_t seed = 42;
+    size_t buffer_pool_size = 8192;
+    std::string db_file = "tpcc_bench.db";
+};
+
+constexpr int DISTRICTS_PER_WAREHOUSE = 10;
+constexpr int MAX_WAREHOUSES = 100;
+constexpr int MAX_ORDERS_PER_DISTRICT = 100000;
+constexpr int MAX_ORDER_LINES = 15;
+
+void PrintUsage(const char* program) {
+    std::cout
+        << "Usage: " << program << " [options]\n"
+        << "  -w, --warehouses N         warehouses (default 1, at most 100)\n"
+        << "  -n, --terminals N          terminal threads (default 4)\n"
+        << "  -t, --duration SECONDS     measured run time (default 10)\n"
+        << "  -u, --warmup SECONDS       unmeasured warmup (default 2)\n"
+        << "      --customers N          customers per district (default 300)\n"
+        << "      --items N              items (default 10000)\n"
+        << "      --seed N               random seed (default 42)\n"
+        << "  -b, --buffer-pool-size N   buffer pool frames (default 8192)\n"
+        << "  -d, --db FILE              database file (default tpcc_bench.db)\n"
+        << "  -h, --help                 show this help\n";
+}
+
+bool ParseOptions(int argc, char* argv[], BenchOptions* options) {
+    enum { OPT_CUSTOMERS = 1000, OPT_ITEMS, OPT_SEED };
+    static struct option long_options[] = {
+        {"warehouses", required_argument, 0, 'w'},
+        {"terminals", required_argument, 0, 'n'},
+        {"duration", required_argument, 0, 't'},
+        {"warmup", required_argument, 0, 'u'},
+        {"customers", required_argument, 0, OPT_CUSTOMERS},
+        {"items", required_argument, 0, OPT_ITEMS},
+        {"seed", required_argument, 0, OPT_SEED},
+        {"buffer-pool-size", required_argument, 0, 'b'},
+        {"db", required_argument, 0, 'd'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}};
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "w:n:t:u:b:d:h", long_options,
+                              nullptr)) != -1) {
+        switch (opt) {
+            case 'w':
+                options->warehouses = std::stoi(optarg);
+                break;
+            case 'n':
+                options->terminals = std::stoi(optarg);
+                break;
+            case 't':
+                options->duration_seconds = std::stoi(optarg);
+                break;
+            case 'u':
+                options->warmup_seconds = std::stoi(optarg);
+                break;
+            case OPT_CUSTOMERS:
+                options->customers_per_district = std::stoi(optarg);
+                break;
+            case OPT_ITEMS:
+                options->items = std::stoi(optarg);
+                break;
+            case OPT_SEED:
+                options->seed = std::stoull(optarg);
+                break;
+            case 'b':
+                options->buffer_pool_size = std::stoul(optarg);
+                break;
+            case 'd':
+                options->db_file = optarg;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    if (options->warehouses < 1 || options->warehouses > MAX_WAREHOUSES ||
+        options->terminals < 1 || options->duration_seconds < 1 ||
+        options->customers_per_district < 1 || options->items < 1) {
+        std::cerr << "Invalid option value" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ==================== 键 ====================
+
+// 复合键拼成一个INT；MAX_WAREHOUSES和MAX_ORDERS_PER_DISTRICT保证不溢出
+int DistrictKey(int w_id, int d_id) {
+    return w_id * DISTRICTS_PER_WAREHOUSE + d_id;
+}
+
+int CustomerKey(const BenchOptions& options, int w_id, int d_id, int c_id) {
+    return DistrictKey(w_id, d_id) * options.customers_per_district + c_id;
+}
+
+int StockKey(const BenchOptions& options, int w_id, int i_id) {
+    return w_id * options.items + i_id;
+}
+
+int OrderKey(int w_id, int d_id, int o_id) {
+    return DistrictKey(w_id, d_id) * MAX_ORDERS_PER_DISTRICT + o_id;
+}
+
+int OrderLineKey(int order_key, int ol_number) {
+    return order_key * (MAX_ORDER_LINES + 1) + ol_number;
+}
+
+// ==================== 数据库 ====================
+
+/** 和服务器一样的组装方式，所有终端线程共享 */
+struct Database {
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager;
+    std::unique_ptr<LogManager> log_manager;
+    std::unique_ptr<LockManager> lock_manager;
+    std::unique_ptr<TransactionManager> transaction_manager;
+    std::unique_ptr<Catalog> catalog;
+    std::unique_ptr<ExecutionEngine> execution_engine;
+
+    explicit Database(const BenchOptions& options) {
+        std::remove(options.db_file.c_str());
+        std::string log_file = options.db_file + ".log";
+        LogManager::RemoveLogFiles(log_file);
+
+        size_t shards =
+            std::max<size_t>(1, static_cast<size_t>(options.terminals));
+        buffer_pool_manager = std::make_unique<BufferPoolManager>(
+            options.buffer_pool_size, shards,
+            std::make_unique<DiskManager>(options.db_file));
+        log_manager = std::make_unique<LogManager>(log_file);
+        buffer_pool_manager->SetLogManager(log_manager.get());
+        lock_manager = std::make_unique<LockManager>();
+        lock_manager->StartDeadlockDetection(DeadlockDetectorConfig{});
+        transaction_manager = std::make_unique<TransactionManager>(
+            lock_manager.get(), log_manager.get());
+        catalog = std::make_unique<Catalog>(buffer_pool_manager.get());
+        execution_engine = std::make_unique<ExecutionEngine>(
+            buffer_pool_manager.get(), catalog.get(),
+            transaction_manager.get());
+    }
+
+    ~Database() {
+        execution_engine.reset();
+        catalog.reset();
+        transaction_manager.reset();
+        lock_manager.reset();
+        buffer_pool_manager.reset();
+        log_manager.reset();
+    }
+};
+
+/**
+ * 一个进行中的事务，语句失败（锁超时、死锁牺牲品、约束冲突）后
+ * 后续语句都不再执行，由调用方Abort
+ */
+class TxnContext {
+   public:
+    TxnContext(Database* database, bool read_only) : database_(database) {
+        txn_ = database_->transaction_manager->Begin(
+            IsolationLevel::REPEATABLE_READ, read_only);
+    }
+
+    ~TxnContext() {
+        if (txn_ != nullptr) {
+            database_->transaction_manager->Abort(txn_);
+        }
+    }
+
+    bool Execute(const std::string& sql, std::vector<Tuple>* rows = nullptr) {
+        if (failed_) {
+            return false;
+        }
+        std::vector<Tuple> local_rows;
+        std::vector<Tuple>* result_set = rows != nullptr ? rows : &local_rows;
+        result_set->clear();
+        try {
+            Parser parser(sql);
+            auto statement = parser.Parse();
+            failed_ = !database_->execution_engine->Execute(statement.get(),
+                                                            result_set, txn_);
+        } catch (const std::exception& e) {
+            failed_ = true;
+        }
+        return !failed_;
+    }
+
+    /** 查询恰好返回一行时才算成功 */
+    bool QueryRow(const std::string& sql, Tuple* row) {
+        std::vector<Tuple> rows;
+        if (!Execute(sql, &rows)) {
+            return false;
+        }
+        if (rows.size() != 1) {
+            failed_ = true;
+            return false;
+        }
+        *row = rows[0];
+        return true;
+    }
+
+    bool Commit() {
+        Transaction* txn = txn_;
+        txn_ = nullptr;
+        if (failed_) {
+            database_->transaction_manager->Abort(txn);
+            return false;
+        }
+        return database_->transaction_manager->Commit(txn);
+    }
+
+    /** 业务上的回滚（New-Order的无效商品），不算失败 */
+    void Rollback() {
+        database_->transaction_manager->Abort(txn_);
+        txn_ = nullptr;
+    }
+
+   private:
+    Database* database_;
+    Transaction* txn_ = nullptr;
+    bool failed_ = false;
+};
+
+int32_t GetInt(const Tuple& row, size_t column) {
+    return std::get<int32_t>(row.GetValue(column));
+}
+
+double GetDouble(const Tuple& row, size_t column) {
+    return std::get<double>(row.GetValue(column));
+}
+
+std::string FormatMoney(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.2f", value);
+    return text;
+}
+
+// ==================== 加载 ====================
+
+const char* const SCHEMA[] = {
+    "CREATE TABLE warehouse (w_id INT PRIMARY KEY, w_name VARCHAR(10), "
+    "w_tax DOUBLE, w_ytd DOUBLE)",
+    "CREATE TABLE district (d_key INT PRIMARY KEY, d_w_id INT, d_id INT, "
+    "d_tax DOUBLE, d_ytd DOUBLE, d_next_o_id INT)",
+    "CREATE TABLE customer (c_key INT PRIMARY KEY, c_w_id INT, c_d_id INT, "
+    "c_id INT, c_last VARCHAR(16), c_discount DOUBLE, c_balance DOUBLE, "
+    "c_ytd_payment DOUBLE, c_payment_cnt INT, c_last_o_id INT)",
+    "CREATE TABLE item (i_id INT PRIMARY KEY, i_name VARCHAR(24), "
+    "i_price DOUBLE)",
+    "CREATE TABLE stock (s_key INT PRIMARY KEY, s_w_id INT, s_i_id INT, "
+    "s_quantity INT, s_ytd INT, s_order_cnt INT, s_remote_cnt INT)",
+    "CREATE TABLE orders (o_key INT PRIMARY KEY, o_w_id INT, o_d_id INT, "
+    "o_id INT, o_c_id INT, o_ol_cnt INT, o_all_local INT)",
+    "CREATE TABLE new_order (no_key INT PRIMARY KEY)",
+    "CREATE TABLE order_line (ol_key INT PRIMARY KEY, ol_o_key INT, "
+    "ol_number INT, ol_i_id INT, ol_supply_w_id INT, ol_quantity INT, "
+    "ol_amount DOUBLE)",
+    "CREATE TABLE history (h_c_key INT, h_w_id INT, h_d_id INT, "
+    "h_amount DOUBLE)"};
+
+/** 一批行一条INSERT，一个事务 */
+bool InsertRows(Database* database, const std::string& table,
+                const std::vector<std::string>& rows) {
+    constexpr size_t ROWS_PER_STATEMENT = 100;
+    for (size_t begin = 0; begin < rows.size(); begin += ROWS_PER_STATEMENT) {
+        std::string sql = "INSERT INTO " + table + " VALUES ";
+        size_t end = std::min(rows.size(), begin + ROWS_PER_STATEMENT);
+        for (size_t i = begin; i < end; i++) {
+            sql += (i == begin ? "(" : ", (") + rows[i] + ")";
+        }
+        TxnContext txn(database, false);
+        if (!txn.Execute(sql) || !txn.Commit()) {
+            std::cerr << "Load failed: " << table << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LoadDatabase(Database* database, const BenchOptions& options) {
+    for (const char* ddl : SCHEMA) {
+        TxnContext txn(database, false);
+        if (!txn.Execute(ddl) || !txn.Commit()) {
+            std::cerr << "Cannot create schema: " << ddl << std::endl;
+            return false;
+        }
+    }
+
+    std::mt19937_64 rng(options.seed);
+    std::uniform_real_distribution<double> tax(0.0, 0.2);
+    std::uniform_real_distribution<double> discount(0.0, 0.5);
+    std::uniform_real_distribution<double> price(1.0, 100.0);
+
+    std::vector<std::string> rows;
+    for (int i = 1; i <= options.items; i++) {
+        rows.push_back(std::to_string(i) + ", 'item" + std::to_string(i) +
+                       "', " + FormatMoney(price(rng)));
+    }
+    if (!InsertRows(database, "item", rows)) {
+        return false;
+    }
+
+    for (int w = 1; w <= options.warehouses; w++) {
+        if (!InsertRows(database, "warehouse",
+                        {std::to_string(w) + ", 'wh" + std::to_string(w) +
+                         "', " + FormatMoney(tax(rng)) + ", 300000.00"})) {
+            return false;
+        }
+
+        rows.clear();
+        for (int d = 1; d <= DISTRICTS_PER_WAREHOUSE; d++) {
+            rows.push_back(std::to_string(DistrictKey(w, d)) + ", " +
+                           std::to_string(w) + ", " + std::to_string(d) +
+                           ", " + FormatMoney(tax(rng)) + ", 30000.00, 1");
+        }
+        if (!InsertRows(database, "district", rows)) {
+            return false;
+        }
+
+        rows.clear();
+        for (int d = 1; d <= DISTRICTS_PER_WAREHOUSE; d++) {
+            for (int c = 1; c <= options.customers_per_district; c++) {
+                rows.push_back(std::to_string(CustomerKey(options, w, d, c)) +
+                               ", " + std::to_string(w) + ", " +
+                               std::to_string(d) + ", " + std::to_string(c) +
+                               ", 'cust" + std::to_string(c) + "', " +
+                               FormatMoney(discount(rng)) +
+                               ", 0.00, 10.00, 1, 0");
+            }
+        }
+        if (!InsertRows(database, "customer", rows)) {
+            return false;
+        }
+
+        rows.clear();
+        std::uniform_int_distribution<int> quantity(10, 100);
+        for (int i = 1; i <= options.items; i++) {
+            rows.push_back(std::to_string(StockKey(options, w, i)) + ", " +
+                           std::to_string(w) + ", " + std::to_string(i) +
+                           ", " + std::to_string(quantity(rng)) + ", 0, 0, 0");
+        }
+        if (!InsertRows(database, "stock", rows)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ==================== 事务 ====================
+
+enum class TxnType { NEW_ORDER = 0, PAYMENT, ORDER_STATUS };
+constexpr size_t TXN_TYPE_COUNT = 3;
+const char* const TXN_TYPE_NAMES[TXN_TYPE_COUNT] = {"NEW-ORDER", "PAYMENT",
+                                                    "ORDER-STATUS"};
+
+/** 一个事务的结果；ROLLED_BACK是New-Order按规范故意回滚的那1% */
+enum class TxnOutcome { COMMITTED, ABORTED, ROLLED_BACK };
+
+class Terminal {
+   public:
+    Terminal(Database* database, const BenchOptions& options, uint64_t seed)
+        : database_(database), options_(options), rng_(seed) {
+        // 规范要求每个终端运行期间C取一个固定值
+        c_for_customer_ = Uniform(0, 1023);
+        c_for_item_ = Uniform(0, 8191);
+    }
+
+    TxnType ChooseType() {
+        int r = Uniform(1, 100);
+        if (r <= 45) {
+            return TxnType::NEW_ORDER;
+        }
+        return r <= 88 ? TxnType::PAYMENT : TxnType::ORDER_STATUS;
+    }
+
+    TxnOutcome Run(TxnType type) {
+        switch (type) {
+            case TxnType::NEW_ORDER:
+                return NewOrder();
+            case TxnType::PAYMENT:
+                return Payment();
+            default:
+                return OrderStatus();
+        }
+    }
+
+   private:
+    int Uniform(int low, int high) {
+        return std::uniform_int_distribution<int>(low, high)(rng_);
+    }
+
+    /** 规范2.1.6的非均匀随机数NURand(A, x, y) */
+    int NURand(int a, int c, int x, int y) {
+        return (((Uniform(0, a) | Uniform(x, y)) + c) % (y - x + 1)) + x;
+    }
+
+    int ChooseCustomer() {
+        int a = options_.customers_per_district >= 1024 ? 1023 : 0;
+        if (a == 0) {
+            return Uniform(1, options_.customers_per_district);
+        }
+        return NURand(a, c_for_customer_, 1, options_.customers_per_district);
+    }
+
+    int ChooseItem() {
+        int a = options_.items >= 8192 ? 8191 : 0;
+        if (a == 0) {
+            return Uniform(1, options_.items);
+        }
+        return NURand(a, c_for_item_, 1, options_.items);
+    }
+
+    /** 其他仓库，只有一个仓库时就是本仓库 */
+    int RemoteWarehouse(int w_id) {
+        if (options_.warehouses == 1) {
+            return w_id;
+        }
+        int remote = Uniform(1, options_.warehouses - 1);
+        return remote >= w_id ? remote + 1 : remote;
+    }
+
+    /**
+     * New-Order
+     * 实现思路：
+     * 1. 读仓库和区的税率，把区的d_next_o_id加一作为新订单号；
+     *    同一个区的New-Order在这一行上排队，这是TPC-C的主要热点
+     * 2. 插入orders和new_order，逐个商品读价格、扣库存、插入order_line，
+     *    1%的商品来自其他仓库
+     * 3. 1%的事务最后一个商品号无效，按规范回滚
+     */
+    TxnOutcome NewOrder() {
+        int w_id = Uniform(1, options_.warehouses);
+        int d_id = Uniform(1, DISTRICTS_PER_WAREHOUSE);
+        int c_id = ChooseCustomer();
+        int ol_cnt = Uniform(5, MAX_ORDER_LINES);
+        bool rollback = Uniform(1, 100) == 1;
+
+        TxnContext txn(database_, false);
+        Tuple row;
+        if (!txn.QueryRow("SELECT w_tax FROM warehouse WHERE w_id = " +
+                              std::to_string(w_id),
+                          &row)) {
+            return TxnOutcome::ABORTED;
+        }
+        int d_key = DistrictKey(w_id, d_id);
+        if (!txn.QueryRow(
+                "SELECT d_tax, d_next_o_id FROM district WHERE d_key = " +
+                    std::to_string(d_key),
+                &row)) {
+            return TxnOutcome::ABORTED;
+        }
+        int o_id = GetInt(row, 1);
+        if (o_id >= MAX_ORDERS_PER_DISTRICT) {
+            return TxnOutcome::ABORTED;
+        }
+        if (!txn.Execute("UPDATE district SET d_next_o_id = " +
+                         std::to_string(o_id + 1) +
+                         " WHERE d_key = " + std::to_string(d_key))) {
+            return TxnOutcome::ABORTED;
+        }
+        int c_key = CustomerKey(options_, w_id, d_id, c_id);
+        if (!txn.QueryRow("SELECT c_discount FROM customer WHERE c_key = " +
+                              std::to_string(c_key),
+                          &row)) {
+            return TxnOutcome::ABORTED;
+        }
+
+        std::vector<int> item_ids(static_cast<size_t>(ol_cnt));
+        std::vector<int> supply_w_ids(static_cast<size_t>(ol_cnt));
+        bool all_local = true;
+        for (int i = 0; i < ol_cnt; i++) {
+            item_ids[i] = ChooseItem();
+            supply_w_ids[i] =
+                Uniform(1, 100) == 1 ? RemoteWarehouse(w_id) : w_id;
+            all_local = all_local && supply_w_ids[i] == w_id;
+        }
+        if (rollback) {
+            item_ids[ol_cnt - 1] = options_.items + 1;  // 不存在的商品
+        }
+
+        int o_key = OrderKey(w_id, d_id, o_id);
+        if (!txn.Execute("INSERT INTO orders VALUES (" +
+                         std::to_string(o_key) + ", " + std::to_string(w_id) +
+                         ", " + std::to_string(d_id) + ", " +
+                         std::to_string(o_id) + ", " + std::to_string(c_id) +
+                         ", " + std::to_string(ol_cnt) + ", " +
+                         (all_local ? "1" : "0") + ")") ||
+            !txn.Execute("INSERT INTO new_order VALUES (" +
+                         std::to_string(o_key) + ")")) {
+            return TxnOutcome::ABORTED;
+        }
+
+        for (int i = 0; i < ol_cnt; i++) {
+            std::vector<Tuple> items;
+            if (!txn.Execute("SELECT i_price FROM item WHERE i_id = " +
+                                 std::to_string(item_ids[i]),
+                             &items)) {
+                return TxnOutcome::ABORTED;
+            }
+            if (items.empty()) {
+                txn.Rollback();
+                return TxnOutcome::ROLLED_BACK;
+            }
+            double price = GetDouble(items[0], 0);
+
+            int s_key = StockKey(options_, supply_w_ids[i], item_ids[i]);
+            if (!txn.QueryRow("SELECT s_quantity FROM stock WHERE s_key = " +
+                                  std::to_string(s_key),
+                              &row)) {
+                return TxnOutcome::ABORTED;
+            }
+            int quantity = Uniform(1, 10);
+            int s_quantity = GetInt(row, 0);
+            s_quantity = s_quantity >= quantity + 10 ? s_quantity - quantity
+                                                     : s_quantity - quantity + 91;
+            bool remote = supply_w_ids[i] != w_id;
+            if (!txn.Execute("UPDATE stock SET s_quantity = " +
+                             std::to_string(s_quantity) +
+                             ", s_ytd = s_ytd + " + std::to_string(quantity) +
+                             ", s_order_cnt = s_order_cnt + 1" +
+                             (remote ? ", s_remote_cnt = s_remote_cnt + 1" : "") +
+                             " WHERE s_key = " + std::to_string(s_key))) {
+                return TxnOutcome::ABORTED;
+            }
+            if (!txn.Execute(
+                    "INSERT INTO order_line VALUES (" +
+                    std::to_string(OrderLineKey(o_key, i + 1)) + ", " +
+                    std::to_string(o_key) + ", " + std::to_string(i + 1) +
+                    ", " + std::to_string(item_ids[i]) + ", " +
+                    std::to_string(supply_w_ids[i]) + ", " +
+                    std::to_string(quantity) + ", " +
+                    FormatMoney(price * quantity) + ")")) {
+                return TxnOutcome::ABORTED;
+            }
+        }
+
+        if (!txn.Execute("UPDATE customer SET c_last_o_id = " +
+                         std::to_string(o_id) +
+                         " WHERE c_key = " + std::to_string(c_key))) {
+            return TxnOutcome::ABORTED;
+        }
+        return txn.Commit() ? TxnOutcome::COMMITTED : TxnOutcome::ABORTED;
+    }
+
+    /**
+     * Payment
+     * 仓库的w_ytd每个Payment都要改，同一个仓库的Payment全部在这一行上排队；
+     * 15%的客户属于其他仓库
+     */
+    TxnOutcome Payment() {
+        int w_id = Uniform(1, options_.warehouses);
+        int d_id = Uniform(1, DISTRICTS_PER_WAREHOUSE);
+        int c_w_id = w_id;
+        int c_d_id = d_id;
+        if (Uniform(1, 100) > 85) {
+            c_w_id = RemoteWarehouse(w_id);
+            c_d_id = Uniform(1, DISTRICTS_PER_WAREHOUSE);
+        }
+        int c_key = CustomerKey(options_, c_w_id, c_d_id, ChooseCustomer());
+        std::string amount =
+            FormatMoney(std::uniform_real_distribution<double>(1.0, 5000.0)(rng_));
+
+        TxnContext txn(database_, false);
+        Tuple row;
+        if (!txn.Execute("UPDATE warehouse SET w_ytd = w_ytd + " + amount +
+                         " WHERE w_id = " + std::to_string(w_id)) ||
+            !txn.QueryRow("SELECT w_name FROM warehouse WHERE w_id = " +
+                              std::to_string(w_id),
+                          &row) ||
+            !txn.Execute("UPDATE district SET d_ytd = d_ytd + " + amount +
+                         " WHERE d_key = " +
+                         std::to_string(DistrictKey(w_id, d_id))) ||
+            !txn.QueryRow("SELECT c_balance FROM customer WHERE c_key = " +
+                              std::to_string(c_key),
+                          &row) ||
+            !txn.Execute("UPDATE customer SET c_balance = c_balance - " +
+                         amount + ", c_ytd_payment = c_ytd_payment + " +
+                         amount + ", c_payment_cnt = c_payment_cnt + 1" +
+                         " WHERE c_key = " + std::to_string(c_key)) ||
+            !txn.Execute("INSERT INTO history VALUES (" +
+                         std::to_string(c_key) + ", " + std::to_string(w_id) +
+                         ", " + std::to_string(d_id) + ", " + amount + ")")) {
+            return TxnOutcome::ABORTED;
+        }
+        return txn.Commit() ? TxnOutcome::COMMITTED : TxnOutcome::ABORTED;
+    }
+
+    /** Order-Status：只读，读客户、最后一个订单和它的订单行 */
+    TxnOutcome OrderStatus() {
+        int w_id = Uniform(1, options_.warehouses);
+        int d_id = Uniform(1, DISTRICTS_PER_WAREHOUSE);
+        int c_key = CustomerKey(options_, w_id, d_id, ChooseCustomer());
+
+        TxnContext txn(database_, true);
+        Tuple row;
+        if (!txn.QueryRow(
+                "SELECT c_balance, c_last_o_id FROM customer WHERE c_key = " +
+                    std::to_string(c_key),
+                &row)) {
+            return TxnOutcome::ABORTED;
+        }
+        int o_id = GetInt(row, 1);
+        if (o_id > 0) {
+            int o_key = OrderKey(w_id, d_id, o_id);
+            std::vector<Tuple> lines;
+            if (!txn.QueryRow("SELECT o_id, o_ol_cnt FROM orders WHERE o_key = " +
+                                  std::to_string(o_key),
+                              &row) ||
+                !txn.Execute(
+                    "SELECT ol_i_id, ol_quantity, ol_amount FROM order_line "
+                    "WHERE ol_key >= " +
+                        std::to_string(OrderLineKey(o_key, 1)) +
+                        " AND ol_key <= " +
+                        std::to_string(OrderLineKey(o_key, MAX_ORDER_LINES)),
+                    &lines)) {
+                return TxnOutcome::ABORTED;
+            }
+        }
+        return txn.Commit() ? TxnOutcome::COMMITTED : TxnOutcome::ABORTED;
+    }
+
+    Database* database_;
+    const BenchOptions& options_;
+    std::mt19937_64 rng_;
+    int c_for_customer_;
+    int c_for_item_;
+};
+
+// ==================== 运行 ====================
+
+struct TerminalResult {
+    std::array<std::unique_ptr<LatencyHistogram>, TXN_TYPE_COUNT> latency;
+    std::array<uint64_t, TXN_TYPE_COUNT> committed{};
+    std::array<uint64_t, TXN_TYPE_COUNT> aborted{};
+    std::array<uint64_t, TXN_TYPE_COUNT> rolled_back{};
+
+    TerminalResult() {
+        for (auto& histogram : latency) {
+            histogram = std::make_unique<LatencyHistogram>();
+        }
+    }
+};
+
+struct RunState {
+    std::atomic<bool> measuring{false};
+    std::atomic<bool> stop{false};
+};
+
+void TerminalLoop(Database* database, const BenchOptions& options,
+                  int terminal_index, RunState* state,
+                  TerminalResult* result) {
+    Terminal terminal(database, options,
+                      options.seed * 1000003ULL +
+                          static_cast<uint64_t>(terminal_index));
+    while (!state->stop.load()) {
+        bool measuring = state->measuring.load();
+        TxnType type = terminal.ChooseType();
+        auto start = std::chrono::steady_clock::now();
+        TxnOutcome outcome = terminal.Run(type);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (!measuring) {
+            continue;
+        }
+        size_t index = static_cast<size_t>(type);
+        switch (outcome) {
+            case TxnOutcome::COMMITTED:
+                result->committed[index]++;
+                result->latency[index]->RecordMicros(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        elapsed)
+                        .count()));
+                break;
+            case TxnOutcome::ABORTED:
+                result->aborted[index]++;
+                break;
+            case TxnOutcome::ROLLED_BACK:
+                result->rolled_back[index]++;
+                break;
+        }
+    }
+}
+
+double Ms(uint64_t micros) { return static_cast<double>(micros) / 1000.0; }
+
+void PrintReport(const std::vector<TerminalResult>& results,
+                 double run_seconds) {
+    std::array<LatencyHistogram::Snapshot, TXN_TYPE_COUNT> merged;
+    std::array<uint64_t, TXN_TYPE_COUNT> committed{};
+    std::array<uint64_t, TXN_TYPE_COUNT> aborted{};
+    std::array<uint64_t, TXN_TYPE_COUNT> rolled_back{};
+    for (const auto& result : results) {
+        for (size_t i = 0; i < TXN_TYPE_COUNT; i++) {
+            merged[i].Merge(result.latency[i]->GetSnapshot());
+            committed[i] += result.committed[i];
+            aborted[i] += result.aborted[i];
+            rolled_back[i] += result.rolled_back[i];
+        }
+    }
+    uint64_t total_committed = 0;
+    for (uint64_t count : committed) {
+        total_committed += count;
+    }
+    double minutes = run_seconds / 60.0;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "[OVERALL], RunTime(s), " << run_seconds << "\n";
+    std::cout << "[OVERALL], tpmC, "
+              << committed[static_cast<size_t>(TxnType::NEW_ORDER)] / minutes
+              << "\n";
+    std::cout << "[OVERALL], tpmTotal, " << total_committed / minutes << "\n";
+    for (size_t i = 0; i < TXN_TYPE_COUNT; i++) {
+        const char* name = TXN_TYPE_NAMES[i];
+        uint64_t attempts = committed[i] + aborted[i] + rolled_back[i];
+        const auto& snapshot = merged[i];
+        std::cout << "[" << name << "], Committed, " << committed[i] << "\n";
+        std::cout << "[" << name << "], Aborted, " << aborted[i] << "\n";
+        if (i == static_cast<size_t>(TxnType::NEW_ORDER)) {
+            std::cout << "[" << name << "], RolledBack, " << rolled_back[i]
+                      << "\n";
+        }
+        std::cout << "[" << name << "], AbortRate(%), "
+                  << (attempts > 0 ? 100.0 * aborted[i] / attempts : 0.0)
+                  << "\n";
+        if (snapshot.count > 0) {
+            std::cout << "[" << name << "], AverageLatency(ms), "
+                      << Ms(snapshot.sum_us) / snapshot.count << "\n";
+            std::cout << "[" << name << "], 50thPercentileLatency(ms), "
+                      << Ms(snapshot.ValueAtPercentile(50.0)) << "\n";
+            std::cout << "[" << name << "], 95thPercentileLatency(ms), "
+                      << Ms(snapshot.ValueAtPercentile(95.0)) << "\n";
+            std::cout << "[" << name << "], 99thPercentileLatency(ms), "
+                      << Ms(snapshot.ValueAtPercentile(99.0)) << "\n";
+            std::cout << "[" << name << "], MaxLatency(ms), "
+                      << Ms(snapshot.max_us) << "\n";
+        }
+    }
+
+    // 引擎视角：测量开始时Statistics清过零，这里是测量期间的数
+    // （包括故意回滚的New-Order，它们在引擎看来也是中止）
+    uint64_t engine_committed = STATS.GetCommittedTransactions();
+    uint64_t engine_aborted = STATS.GetAbortedTransactions();
+    uint64_t engine_total = engine_committed + engine_aborted;
+    auto lock_wait = STATS.GetLockWaitHistogram();
+    std::cout << "[ENGINE], CommittedTransactions, " << engine_committed
+              << "\n";
+    std::cout << "[ENGINE], AbortedTransactions, " << engine_aborted << "\n";
+    std::cout << "[ENGINE], AbortRate(%), "
+              << (engine_total > 0 ? 100.0 * engine_aborted / engine_total
+                                   : 0.0)
+              << "\n";
+    std::cout << "[ENGINE], Deadlocks, " << STATS.GetDeadlocks() << "\n";
+    std::cout << "[ENGINE], LockWaits, " << lock_wait.count << "\n";
+    std::cout << "[ENGINE], TotalLockWait(ms), " << Ms(lock_wait.sum_us)
+              << "\n";
+    if (lock_wait.count > 0) {
+        std::cout << "[ENGINE], AverageLockWait(ms), "
+                  << Ms(lock_wait.sum_us) / lock_wait.count << "\n";
+        std::cout << "[ENGINE], 99thPercentileLockWait(ms), "
+                  << Ms(lock_wait.ValueAtPercentile(99.0)) << "\n";
+        std::cout << "[ENGINE], MaxLockWait(ms), " << Ms(lock_wait.max_us)
+                  << "\n";
+    }
+    std::cout.flush();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, &options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    Database database(options);
+    std::cout << "TPC-C: " << options.warehouses << " warehouses, "
+              << options.terminals << " terminals, "
+              << options.customers_per_district << " customers/district, "
+              << options.items << " items" << std::endl;
+
+    auto load_start = std::chrono::steady_clock::now();
+    if (!LoadDatabase(&database, options)) {
+        return 1;
+    }
+    std::chrono::duration<double> load_time =
+        std::chrono::steady_clock::now() - load_start;
+    std::cout << "[LOAD], RunTime(s), " << std::fixed << std::setprecision(2)
+              << load_time.count() << std::endl;
+
+    RunState state;
+    std::vector<TerminalResult> results(
+        static_cast<size_t>(options.terminals));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.terminals; i++) {
+        threads.emplace_back(TerminalLoop, &database, std::cref(options), i,
+                             &state, &results[static_cast<size_t>(i)]);
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(options.warmup_seconds));
+    STATS.Reset();
+    auto run_start = std::chrono::steady_clock::now();
+    state.measuring = true;
+    std::this_thread::sleep_for(std::chrono::seconds(options.duration_seconds));
+    state.stop = true;
+    std::chrono::duration<double> run_time =
+        std::chrono::steady_clock::now() - run_start;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    PrintReport(results, run_time.count());
+    return 0;
+}
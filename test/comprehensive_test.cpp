@@ -155,7 +155,10 @@ class TestUtils {
 
         for (const auto& file : files) {
             std::remove(file.c_str());
+            LogManager::RemoveLogFiles(file);
         }
+        std::remove("integration_test.log");
+        LogManager::RemoveLogFiles("integration_test.log");
     }
 
     static std::vector<Value> CreateTestValues(int count) {
@@ -36,6 +36,7 @@ class IndexManagerTest : public ::testing::Test {
         // 清理之前的文件
         std::remove(DB_FILE);
         std::remove(LOG_FILE);
+        LogManager::RemoveLogFiles(LOG_FILE);
 
         // 创建系统组件
         disk_manager_ = std::make_unique<DiskManager>(DB_FILE);
@@ -85,6 +86,7 @@ class IndexManagerTest : public ::testing::Test {
         // 清理文件
         std::remove(DB_FILE);
         std::remove(LOG_FILE);
+        LogManager::RemoveLogFiles(LOG_FILE);
     }
 
     bool ExecuteSQL(const std::string& sql,
@@ -352,9 +354,22 @@ TEST_F(IndexManagerTest, ErrorHandling) {
     EXPECT_FALSE(index_manager->CreateIndex("idx_empty", "error_test", {},
                                             table_info->schema.get()));
 
-    // 创建多列索引（当前不支持）
-    EXPECT_FALSE(index_manager->CreateIndex(
+    // 创建多列索引（组合键），按完整的键和键前缀都能查到
+    EXPECT_TRUE(index_manager->CreateIndex(
         "idx_multi", "error_test", {"id", "name"}, table_info->schema.get()));
+    RID multi_rid{1, 0};
+    EXPECT_TRUE(index_manager->InsertEntry(
+        "idx_multi", {Value(7), Value(std::string("seven"))}, multi_rid));
+    std::vector<RID> multi_rids;
+    EXPECT_TRUE(index_manager->FindEntry(
+        "idx_multi", {Value(7), Value(std::string("seven"))}, &multi_rids));
+    ASSERT_EQ(multi_rids.size(), 1u);
+    EXPECT_EQ(multi_rids[0], multi_rid);
+    multi_rids.clear();
+    EXPECT_TRUE(index_manager->FindEntry("idx_multi", {Value(7)}, &multi_rids));
+    EXPECT_EQ(multi_rids.size(), 1u);
+    EXPECT_FALSE(index_manager->FindEntry(
+        "idx_multi", {Value(7), Value(std::string("eight"))}, &multi_rids));
 
     // 删除不存在的索引
     EXPECT_FALSE(index_manager->DropIndex("non_existent_index"));
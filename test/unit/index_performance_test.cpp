@@ -30,6 +30,7 @@ class PerformanceTestFixture : public ::testing::Test {
         // 清理之前的测试文件
         std::remove("test_perf.db");
         std::remove("test_perf.db.log");
+        LogManager::RemoveLogFiles("test_perf.db.log");
 
         // 初始化数据库组件
         disk_manager_ = std::make_unique<DiskManager>("test_perf.db");
@@ -68,6 +69,7 @@ class PerformanceTestFixture : public ::testing::Test {
         // 清理测试文件
         std::remove("test_perf.db");
         std::remove("test_perf.db.log");
+        LogManager::RemoveLogFiles("test_perf.db.log");
     }
 
     // 执行SQL并返回执行时间（毫秒）
@@ -58,6 +58,7 @@ class PersistenceRecoveryTest {
     void CleanupFiles() {
         std::remove(DB_FILE);
         std::remove(LOG_FILE);
+        LogManager::RemoveLogFiles(LOG_FILE);
     }
 
     // 创建系统组件的辅助函数
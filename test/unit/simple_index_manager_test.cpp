@@ -50,6 +50,7 @@ class SimpleIndexTest {
         // 清理之前的文件
         std::remove(DB_FILE);
         std::remove(LOG_FILE);
+        LogManager::RemoveLogFiles(LOG_FILE);
 
         // 创建系统组件
         disk_manager_ = std::make_unique<DiskManager>(DB_FILE);
@@ -75,6 +76,7 @@ class SimpleIndexTest {
         // 清理文件
         std::remove(DB_FILE);
         std::remove(LOG_FILE);
+        LogManager::RemoveLogFiles(LOG_FILE);
     }
 
     bool ExecuteSQL(const std::string& sql,
@@ -80,6 +80,7 @@ protected:
                 std::filesystem::remove(file);
             }
         }
+        LogManager::RemoveLogFiles("test_log_recovery.db.log");
     }
     
     void CreateTestTable() {
@@ -1,12 +1,89 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <functional>
+#include <string>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
 #include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/two_q_replacer.h"
+#include "catalog/catalog.h"
+#include "catalog/partition.h"
+#include "catalog/schema.h"
+#include "catalog/table_manager.h"
+#include "catalog/table_statistics.h"
+#include "execution/aggregation_hash_table.h"
+#include "execution/cancellation_token.h"
+#include "execution/compiled_expression.h"
+#include "execution/execution_engine.h"
+#include "execution/expression_cloner.h"
+#include "execution/plan_node.h"
+#include "execution/result_cache.h"
+#include "execution/rid_bitmap.h"
+#include "execution/vector_kernels.h"
+#include "index/b_plus_tree.h"
+#include "index/b_plus_tree_page.h"
+#include "index/bulk_load_sorter.h"
+#include "index/extendible_hash_table.h"
+#include "index/generic_key.h"
+#include "index/index_manager.h"
+#include "index/inline_string_key.h"
+#include "parser/parser.h"
+#include "record/column_store.h"
+#include "record/free_space_map.h"
+#include "record/page_directory.h"
+#include "record/table_heap.h"
+#include "record/tuple_view.h"
+#include "recovery/log_manager.h"
+#include "recovery/recovery_manager.h"
+#include "recovery/wal_file.h"
+#include "replication/replica_applier.h"
+#include "replication/wal_receiver.h"
+#include "replication/wal_sender.h"
+#include "server/config/server_config.h"
+#include "server/connection/connection.h"
+#include "server/connection/event_loop.h"
+#include "server/protocol/binary_protocol.h"
+#include "server/protocol/simple_protocol.h"
+#include "server/query/admission_controller.h"
+#include "server/query/query_processor.h"
+#include "server/thread/thread_pool.h"
 #include "storage/disk_manager.h"
 #include "storage/page.h"
+#include "storage/page_compression.h"
+#include "transaction/lock_manager.h"
+#include "transaction/transaction_manager.h"
+#include "common/arena.h"
+#include "common/async_log.h"
+#include "common/bloom_filter.h"
+#include "common/compact_value.h"
+#include "common/crc32c.h"
 #include "common/config.h"
+#include "common/exception.h"
+#include "common/memory_tracker.h"
+#include "common/numa.h"
+#include "stat/metrics.h"
+#include "stat/stat.h"
+#include "stat/trace.h"
 
 using namespace SimpleRDBMS;
 
@@ -41,6 +118,248 @@ void TestLRUReplacer() {
     std::cout << "LRU Replacer tests passed!" << std::endl;
 }
 
+// Test Clock Replacer
+void TestClockReplacer() {
+    std::cout << "Testing Clock Replacer..." << std::endl;
+
+    ClockReplacer replacer(4);
+    replacer.Unpin(0);
+    replacer.Unpin(1);
+    replacer.Unpin(2);
+    assert(replacer.Size() == 3);
+
+    // All reference bits are set, first sweep clears them, frame 0 goes first
+    size_t victim;
+    assert(replacer.Victim(&victim) == true);
+    assert(victim == 0);
+
+    // Touch frame 1 again so it gets a second chance over frame 2
+    replacer.Pin(1);
+    replacer.Unpin(1);
+    assert(replacer.Victim(&victim) == true);
+    assert(victim == 2);
+
+    replacer.Pin(1);
+    assert(replacer.Size() == 0);
+    assert(replacer.Victim(&victim) == false);
+
+    std::cout << "Clock Replacer tests passed!" << std::endl;
+}
+
+// Test LRU-K Replacer
+void TestLRUKReplacer() {
+    std::cout << "Testing LRU-K Replacer..." << std::endl;
+
+    LRUKReplacer replacer(8, 2);
+
+    // Frame 0 is a hot page accessed twice, frames 1-3 are scanned once
+    replacer.Pin(0);
+    replacer.Unpin(0);
+    replacer.Pin(0);
+    replacer.Unpin(0);
+    for (size_t frame = 1; frame <= 3; frame++) {
+        replacer.Pin(frame);
+        replacer.Unpin(frame);
+    }
+    assert(replacer.Size() == 4);
+
+    // Pages with fewer than K accesses are evicted first, oldest first
+    size_t victim;
+    assert(replacer.Victim(&victim) && victim == 1);
+    assert(replacer.Victim(&victim) && victim == 2);
+    assert(replacer.Victim(&victim) && victim == 3);
+    assert(replacer.Victim(&victim) && victim == 0);
+    assert(replacer.Victim(&victim) == false);
+
+    std::cout << "LRU-K Replacer tests passed!" << std::endl;
+}
+
+// Test 2Q Replacer
+void TestTwoQReplacer() {
+    std::cout << "Testing 2Q Replacer..." << std::endl;
+
+    TwoQReplacer replacer(8);
+
+    // Frames 0 and 1 are re-referenced while resident and move to Am
+    for (size_t frame = 0; frame < 2; frame++) {
+        replacer.Pin(frame);
+        replacer.Unpin(frame);
+        replacer.Pin(frame);
+        replacer.Unpin(frame);
+    }
+    // Frames 2-5 are touched once by a scan and stay in A1
+    for (size_t frame = 2; frame < 6; frame++) {
+        replacer.Pin(frame);
+        replacer.Unpin(frame);
+    }
+    assert(replacer.Size() == 6);
+
+    // A1 may hold 25% of the capacity (2 frames); the surplus scan pages
+    // are evicted first, then Am is used LRU, then the rest of A1
+    size_t victim;
+    assert(replacer.Victim(&victim) && victim == 2);
+    assert(replacer.Victim(&victim) && victim == 3);
+    assert(replacer.Victim(&victim) && victim == 0);
+    assert(replacer.Victim(&victim) && victim == 1);
+    assert(replacer.Victim(&victim) && victim == 4);
+    assert(replacer.Victim(&victim) && victim == 5);
+    assert(replacer.Victim(&victim) == false);
+
+    std::cout << "2Q Replacer tests passed!" << std::endl;
+}
+
+// Test DiskManager I/O modes: same data through fstream, pread and O_DIRECT
+void TestDiskManagerIOModes() {
+    std::cout << "Testing DiskManager I/O Modes..." << std::endl;
+
+    for (auto mode : {DiskIOMode::STREAM, DiskIOMode::POSITIONAL,
+                      DiskIOMode::DIRECT, DiskIOMode::IO_URING}) {
+        const std::string db_name = "test_io_mode.db";
+        std::remove(db_name.c_str());
+        const int num_pages = 32;
+        {
+            DiskManager disk_manager(db_name, mode);
+            // O_DIRECT (tmpfs) or io_uring (old kernels) may be unsupported,
+            // then pread is used instead
+            assert(disk_manager.GetIOMode() == mode ||
+                   ((mode == DiskIOMode::DIRECT ||
+                     mode == DiskIOMode::IO_URING) &&
+                    disk_manager.GetIOMode() == DiskIOMode::POSITIONAL));
+
+            // Page::GetData() is not block aligned, like frames in the pool
+            char data[PAGE_SIZE + 1];
+            for (int i = 0; i < num_pages; i++) {
+                std::memset(data + 1, 'a' + i % 26, PAGE_SIZE);
+                disk_manager.WritePage(i, data + 1);
+            }
+            assert(disk_manager.GetNumPages() == num_pages);
+
+            // Concurrent readers must each see their own page
+            std::vector<std::thread> readers;
+            for (int t = 0; t < 4; t++) {
+                readers.emplace_back([&disk_manager, t, num_pages]() {
+                    char buffer[PAGE_SIZE];
+                    for (int i = t; i < num_pages; i += 4) {
+                        disk_manager.ReadPage(i, buffer);
+                        assert(buffer[0] == 'a' + i % 26);
+                        assert(buffer[PAGE_SIZE - 1] == 'a' + i % 26);
+                    }
+                });
+            }
+            for (auto& reader : readers) {
+                reader.join();
+            }
+
+            // Batched writes and reads, past the current end of file
+            std::vector<std::vector<char>> pages(
+                num_pages, std::vector<char>(PAGE_SIZE));
+            std::vector<PageWriteRequest> writes;
+            std::vector<PageReadRequest> reads;
+            for (int i = 0; i < num_pages; i++) {
+                std::memset(pages[i].data(), 'A' + i % 26, PAGE_SIZE);
+                writes.push_back({num_pages + i, pages[i].data()});
+            }
+            disk_manager.WritePages(writes);
+            assert(disk_manager.GetNumPages() == 2 * num_pages);
+            for (int i = 0; i < num_pages; i++) {
+                std::memset(pages[i].data(), 0, PAGE_SIZE);
+                reads.push_back({num_pages + i, pages[i].data()});
+            }
+            disk_manager.ReadPages(reads);
+            for (int i = 0; i < num_pages; i++) {
+                assert(pages[i][0] == 'A' + i % 26);
+                assert(pages[i][PAGE_SIZE - 1] == 'A' + i % 26);
+            }
+        }
+
+        // Reopening finds the pages written before
+        DiskManager reopened(db_name, mode);
+        assert(reopened.GetNumPages() == 2 * num_pages);
+        char buffer[PAGE_SIZE];
+        reopened.ReadPage(num_pages - 1, buffer);
+        assert(buffer[0] == 'a' + (num_pages - 1) % 26);
+        std::remove(db_name.c_str());
+    }
+
+    DiskIOMode parsed;
+    assert(ParseDiskIOMode("Direct", &parsed) && parsed == DiskIOMode::DIRECT);
+    assert(ParseDiskIOMode("io_uring", &parsed) &&
+           parsed == DiskIOMode::IO_URING);
+    assert(ParseDiskIOMode("MMAP", &parsed) && parsed == DiskIOMode::MMAP);
+    assert(!ParseDiskIOMode("aio", &parsed));
+
+    std::cout << "DiskManager I/O Modes tests passed!" << std::endl;
+}
+
+void TestDatabaseFileHeader() {
+    std::cout << "Testing Database File Header..." << std::endl;
+
+    const std::string db_name = "test_file_header.db";
+    std::remove(db_name.c_str());
+
+    // A new file starts with a header page that does not count as a page
+    {
+        DiskManager disk_manager(db_name);
+        assert(disk_manager.HasFileHeader());
+        assert(disk_manager.GetNumPages() == 0);
+        char data[PAGE_SIZE];
+        std::memset(data, 'h', PAGE_SIZE);
+        disk_manager.WritePage(0, data);
+    }
+    {
+        std::ifstream file(db_name, std::ios::binary | std::ios::ate);
+        assert(static_cast<size_t>(file.tellg()) == 2 * PAGE_SIZE);
+    }
+    {
+        DiskManager reopened(db_name, DiskIOMode::STREAM);
+        assert(reopened.HasFileHeader());
+        assert(reopened.GetNumPages() == 1);
+        char buffer[PAGE_SIZE];
+        reopened.ReadPage(0, buffer);
+        assert(buffer[0] == 'h' && buffer[PAGE_SIZE - 1] == 'h');
+    }
+
+    // A file created with a different page size is rejected
+    {
+        std::fstream file(db_name,
+                          std::ios::binary | std::ios::in | std::ios::out);
+        uint32_t other_page_size = PAGE_SIZE * 2;
+        file.seekp(12);
+        file.write(reinterpret_cast<const char*>(&other_page_size),
+                   sizeof(other_page_size));
+    }
+    bool rejected = false;
+    try {
+        DiskManager mismatched(db_name);
+    } catch (const StorageException&) {
+        rejected = true;
+    }
+    assert(rejected);
+    std::remove(db_name.c_str());
+
+    // Files written before the header existed use 4KB pages from offset 0
+    {
+        std::ofstream file(db_name, std::ios::binary);
+        std::vector<char> legacy(2 * 4096, 'l');
+        file.write(legacy.data(), static_cast<std::streamsize>(legacy.size()));
+    }
+    rejected = false;
+    try {
+        DiskManager legacy(db_name);
+        assert(!legacy.HasFileHeader());
+        assert(legacy.GetNumPages() == 2);
+        char buffer[PAGE_SIZE];
+        legacy.ReadPage(1, buffer);
+        assert(buffer[0] == 'l');
+    } catch (const StorageException&) {
+        rejected = true;
+    }
+    assert(rejected == (PAGE_SIZE != 4096));
+    std::remove(db_name.c_str());
+
+    std::cout << "Database File Header tests passed!" << std::endl;
+}
+
 // Test Buffer Pool Manager
 void TestBufferPoolManager() {
     std::cout << "Testing Buffer Pool Manager..." << std::endl;
@@ -84,6 +403,8854 @@ void TestBufferPoolManager() {
     std::remove(db_name.c_str());
 }
 
+// Test sharded Buffer Pool Manager
+void TestShardedBufferPoolManager() {
+    std::cout << "Testing Sharded Buffer Pool Manager..." << std::endl;
+
+    const std::string db_name = "test_sharded.db";
+    const size_t buffer_pool_size = 16;
+    const size_t num_shards = 4;
+
+    auto bpm = std::make_unique<BufferPoolManager>(
+        buffer_pool_size, num_shards,
+        std::make_unique<DiskManager>(db_name));
+    assert(bpm->GetNumShards() == num_shards);
+    assert(bpm->GetPoolSize() == buffer_pool_size);
+
+    // Create more pages than the pool holds so every shard has to evict
+    std::vector<page_id_t> page_ids;
+    for (int i = 0; i < 40; i++) {
+        page_id_t page_id;
+        auto* page = bpm->NewPage(&page_id);
+        assert(page != nullptr);
+        std::snprintf(page->GetData(), PAGE_SIZE, "page-%d", i);
+        assert(bpm->UnpinPage(page_id, true) == true);
+        page_ids.push_back(page_id);
+    }
+
+    // Every page must come back with its own contents
+    for (size_t i = 0; i < page_ids.size(); i++) {
+        auto* page = bpm->FetchPage(page_ids[i]);
+        assert(page != nullptr);
+        std::string expected = "page-" + std::to_string(i);
+        assert(std::string(page->GetData()) == expected);
+        bpm->UnpinPage(page_ids[i], false);
+    }
+
+    // Pin every frame of the pool, then further fetches must fail
+    std::vector<page_id_t> pinned;
+    for (size_t i = 0; i < page_ids.size() && pinned.size() < buffer_pool_size;
+         i++) {
+        if (bpm->FetchPage(page_ids[i]) != nullptr) {
+            pinned.push_back(page_ids[i]);
+        }
+    }
+    page_id_t extra_page_id;
+    assert(bpm->NewPage(&extra_page_id) == nullptr);
+    for (auto page_id : pinned) {
+        bpm->UnpinPage(page_id, false);
+    }
+
+    bpm.reset();
+    std::remove(db_name.c_str());
+    std::cout << "Sharded Buffer Pool Manager tests passed!" << std::endl;
+}
+
+// Test online grow/shrink of the Buffer Pool Manager
+void TestBufferPoolResize() {
+    std::cout << "Testing Buffer Pool Resize..." << std::endl;
+
+    const std::string db_name = "test_resize.db";
+    auto bpm = std::make_unique<BufferPoolManager>(
+        8, 2, std::make_unique<DiskManager>(db_name));
+
+    // Grow: more pages can be pinned at the same time
+    assert(bpm->Resize(32) == true);
+    assert(bpm->GetPoolSize() == 32);
+    std::vector<page_id_t> page_ids;
+    for (int i = 0; i < 32; i++) {
+        page_id_t page_id;
+        auto* page = bpm->NewPage(&page_id);
+        assert(page != nullptr);
+        std::snprintf(page->GetData(), PAGE_SIZE, "resize-%d", i);
+        page_ids.push_back(page_id);
+    }
+
+    // Shrink while every frame is pinned: nothing can be released
+    assert(bpm->Resize(4) == false);
+    assert(bpm->GetPoolSize() == 32);
+
+    for (auto page_id : page_ids) {
+        bpm->UnpinPage(page_id, true);
+    }
+
+    // Shrink for real: dirty pages are written back before frames go away
+    assert(bpm->Resize(4) == true);
+    assert(bpm->GetPoolSize() == 4);
+    for (size_t i = 0; i < page_ids.size(); i++) {
+        auto* page = bpm->FetchPage(page_ids[i]);
+        assert(page != nullptr);
+        assert(std::string(page->GetData()) ==
+               "resize-" + std::to_string(i));
+        bpm->UnpinPage(page_ids[i], false);
+    }
+
+    bpm.reset();
+    std::remove(db_name.c_str());
+    std::cout << "Buffer Pool Resize tests passed!" << std::endl;
+}
+
+// Test the background dirty-page writer and its WAL check
+void TestBackgroundWriter() {
+    std::cout << "Testing Background Writer..." << std::endl;
+
+    const std::string db_name = "test_bgwriter.db";
+    const std::string log_name = "test_bgwriter.log";
+    std::remove(db_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    const size_t pool_size = 16;
+    page_id_t first_page_id = INVALID_PAGE_ID;
+    {
+        LogManager log_manager(log_name);
+        auto bpm = std::make_unique<BufferPoolManager>(
+            pool_size, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(pool_size));
+        bpm->SetLogManager(&log_manager);
+
+        BeginLogRecord begin(1);
+        lsn_t durable_lsn = log_manager.AppendLogRecord(&begin);
+        log_manager.Flush(durable_lsn);
+
+        // Half the pages carry a durable LSN, half one not yet in the log
+        std::vector<page_id_t> page_ids;
+        for (size_t i = 0; i < pool_size; i++) {
+            page_id_t page_id;
+            Page* page = bpm->NewPage(&page_id);
+            assert(page != nullptr);
+            std::memset(page->GetData(), static_cast<int>('a' + i), PAGE_SIZE);
+            page->SetLSN(i < pool_size / 2 ? durable_lsn : durable_lsn + 4);
+            assert(bpm->UnpinPage(page_id, true));
+            page_ids.push_back(page_id);
+        }
+
+        auto wait_for_writes = [&bpm](uint64_t expected) {
+            auto deadline =
+                std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (bpm->GetBackgroundWriteCount() < expected &&
+                   std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            return bpm->GetBackgroundWriteCount();
+        };
+
+        BackgroundWriterConfig config;
+        config.interval = std::chrono::milliseconds(5);
+        config.clean_ratio = 1.0;
+        bpm->StartBackgroundWriter(config);
+        assert(wait_for_writes(pool_size / 2) == pool_size / 2);
+
+        // The WAL rule holds the rest back until the log catches up
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        assert(bpm->GetBackgroundWriteCount() == pool_size / 2);
+        for (int i = 0; i < 4; i++) {
+            CommitLogRecord commit(1, INVALID_LSN);
+            log_manager.Flush(log_manager.AppendLogRecord(&commit));
+        }
+        assert(wait_for_writes(pool_size) == pool_size);
+        bpm->StopBackgroundWriter();
+
+        for (page_id_t page_id : page_ids) {
+            Page* page = bpm->FetchPage(page_id);
+            assert(page != nullptr && !page->IsDirty());
+            bpm->UnpinPage(page_id, false);
+        }
+
+        // Every victim is already clean: new pages never wait on a write
+        uint64_t dirty_evictions = bpm->GetDirtyEvictionCount();
+        for (size_t i = 0; i < pool_size; i++) {
+            page_id_t page_id;
+            assert(bpm->NewPage(&page_id) != nullptr);
+            bpm->UnpinPage(page_id, false);
+        }
+        assert(bpm->GetDirtyEvictionCount() == dirty_evictions);
+        first_page_id = page_ids[0];
+    }
+
+    // Pages written in the background are on disk
+    {
+        DiskManager disk_manager(db_name);
+        char buffer[PAGE_SIZE];
+        disk_manager.ReadPage(first_page_id, buffer);
+        assert(buffer[0] == 'a');
+    }
+
+    std::remove(db_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    std::cout << "Background Writer tests passed!" << std::endl;
+}
+
+// Scan many pages through the bulk-read ring and check a hot page survives
+static void ScanWithHotPage(bool use_strategy, bool* hot_survived,
+                            size_t* ring_reuses) {
+    const std::string db_name = "test_bulk_read.db";
+    auto bpm = std::make_unique<BufferPoolManager>(
+        16, std::make_unique<DiskManager>(db_name),
+        std::make_unique<LRUReplacer>(16));
+
+    // The hot page's in-memory copy differs from disk, so eviction is visible
+    page_id_t hot_page_id;
+    auto* hot = bpm->NewPage(&hot_page_id);
+    assert(hot != nullptr);
+    std::snprintf(hot->GetData(), PAGE_SIZE, "hot-disk");
+    bpm->UnpinPage(hot_page_id, true);
+    assert(bpm->FlushPage(hot_page_id));
+
+    std::vector<page_id_t> scan_pages;
+    for (int i = 0; i < 40; i++) {
+        page_id_t page_id;
+        auto* page = bpm->NewPage(&page_id);
+        assert(page != nullptr);
+        bpm->UnpinPage(page_id, true);
+        scan_pages.push_back(page_id);
+    }
+
+    hot = bpm->FetchPage(hot_page_id);
+    assert(hot != nullptr);
+    std::snprintf(hot->GetData(), PAGE_SIZE, "hot-memory");
+    bpm->UnpinPage(hot_page_id, false);
+
+    auto strategy = use_strategy ? bpm->CreateBulkReadStrategy(4) : nullptr;
+    for (auto page_id : scan_pages) {
+        auto* page = bpm->FetchPage(page_id, strategy.get());
+        assert(page != nullptr);
+        assert(page->GetPageId() == page_id);
+        bpm->UnpinPage(page_id, false);
+    }
+
+    hot = bpm->FetchPage(hot_page_id);
+    assert(hot != nullptr);
+    *hot_survived = std::string(hot->GetData()) == "hot-memory";
+    bpm->UnpinPage(hot_page_id, false);
+    *ring_reuses = strategy ? strategy->GetRingReuses() : 0;
+
+    bpm.reset();
+    std::remove(db_name.c_str());
+}
+
+void TestBulkReadStrategy() {
+    std::cout << "Testing Bulk Read Strategy..." << std::endl;
+
+    bool hot_survived = false;
+    size_t ring_reuses = 0;
+
+    // Without a strategy the scan flushes the hot page out of the pool
+    ScanWithHotPage(false, &hot_survived, &ring_reuses);
+    assert(hot_survived == false);
+
+    // With the ring the scan recycles its own frames
+    ScanWithHotPage(true, &hot_survived, &ring_reuses);
+    assert(hot_survived == true);
+    assert(ring_reuses > 0);
+
+    std::cout << "Bulk Read Strategy tests passed!" << std::endl;
+}
+
+// Scan a multi-page heap from a cold pool with background read-ahead
+void TestTableHeapReadAhead() {
+    std::cout << "Testing TableHeap Read-Ahead..." << std::endl;
+
+    const std::string db_name = "test_read_ahead.db";
+    std::remove(db_name.c_str());
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, 256, false, false}});
+    // About 20 rows fit per 4KB page, enough rows to span more than the pool
+    const int num_rows = static_cast<int>(PAGE_SIZE / 1024) * 100;
+
+    page_id_t first_page_id;
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            16, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(16));
+        TableHeap heap(bpm.get(), &schema);
+        first_page_id = heap.GetFirstPageId();
+        for (int i = 0; i < num_rows; i++) {
+            std::string name(200, static_cast<char>('a' + i % 26));
+            Tuple tuple({Value(int32_t(i)), Value(name)}, &schema);
+            RID rid;
+            assert(heap.InsertTuple(tuple, &rid, INVALID_TXN_ID));
+        }
+        bpm->FlushAllPages();
+    }
+
+    // Fresh pool: every page starts cold, the scan must still see all rows
+    auto bpm = std::make_unique<BufferPoolManager>(
+        16, std::make_unique<DiskManager>(db_name),
+        std::make_unique<LRUReplacer>(16));
+    assert(bpm->GetDiskManager()->GetNumPages() > 16);
+    TableHeap heap(bpm.get(), &schema, first_page_id);
+    int count = 0;
+    for (auto it = heap.Begin(bpm->CreateBulkReadStrategy(8), 4);
+         !it.IsEnd(); ++it) {
+        Tuple tuple = *it;
+        assert(std::get<int32_t>(tuple.GetValue(0)) == count);
+        count++;
+    }
+    assert(count == num_rows);
+
+    bpm.reset();
+    std::remove(db_name.c_str());
+    std::cout << "TableHeap Read-Ahead tests passed!" << std::endl;
+}
+
+// Test free space map: inserts go straight to a page with room
+void TestTableHeapFreeSpaceMap() {
+    std::cout << "Testing TableHeap Free Space Map..." << std::endl;
+
+    FreeSpaceMap fsm;
+    fsm.Update(5, 160);
+    fsm.Update(3, 40);
+    assert(fsm.GetPageCount() == 2);
+    assert(fsm.FindPage(30) == 3);
+    assert(fsm.FindPage(100) == 5);
+    assert(fsm.FindPage(200) == INVALID_PAGE_ID);
+    fsm.Update(5, 0);
+    assert(fsm.FindPage(100) == INVALID_PAGE_ID);
+    assert(fsm.GetPageCount() == 2);
+
+    const std::string db_name = "test_free_space_map.db";
+    std::remove(db_name.c_str());
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, 2048, false, false}});
+    auto bpm = std::make_unique<BufferPoolManager>(
+        16, std::make_unique<DiskManager>(db_name),
+        std::make_unique<LRUReplacer>(16));
+
+    // Two large rows per page leave roughly a quarter of every page free
+    page_id_t first_page_id;
+    {
+        TableHeap heap(bpm.get(), &schema);
+        first_page_id = heap.GetFirstPageId();
+        for (int i = 0; i < 10; i++) {
+            Tuple tuple({Value(int32_t(i)), Value(std::string(1500, 'x'))},
+                        &schema);
+            RID rid;
+            assert(heap.InsertTuple(tuple, &rid, INVALID_TXN_ID));
+            if (i < 2) {
+                assert(rid.page_id == first_page_id);
+            }
+        }
+    }
+    int num_pages = bpm->GetDiskManager()->GetNumPages();
+
+    // A reopened heap rebuilds the map and reuses the room in the first page
+    TableHeap heap(bpm.get(), &schema, first_page_id);
+    Tuple small({Value(int32_t(10)), Value(std::string("small"))}, &schema);
+    RID rid;
+    assert(heap.InsertTuple(small, &rid, INVALID_TXN_ID));
+    assert(rid.page_id == first_page_id);
+    assert(bpm->GetDiskManager()->GetNumPages() == num_pages);
+
+    // A large row fits nowhere and extends the table
+    Tuple large({Value(int32_t(11)), Value(std::string(1500, 'y'))}, &schema);
+    assert(heap.InsertTuple(large, &rid, INVALID_TXN_ID));
+    assert(bpm->GetDiskManager()->GetNumPages() > num_pages);
+
+    int count = 0;
+    for (auto it = heap.Begin(); !it.IsEnd(); ++it) {
+        count++;
+    }
+    assert(count == 12);
+
+    bpm.reset();
+    std::remove(db_name.c_str());
+    std::cout << "TableHeap Free Space Map tests passed!" << std::endl;
+}
+
+// Test bulk insert: pages are filled in one pass with one log record each
+void TestTableHeapBulkInsert() {
+    std::cout << "Testing TableHeap Bulk Insert..." << std::endl;
+
+    const std::string db_name = "test_bulk_insert.db";
+    const std::string log_name = "test_bulk_insert.log";
+    std::remove(db_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, 128, false, false}});
+    const int num_rows = 300;
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            16, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(16));
+        LogManager log_manager(log_name);
+        Catalog catalog(bpm.get(), &log_manager);
+        assert(catalog.CreateTable("bulk_test", schema));
+        TableHeap* heap = catalog.GetTable("bulk_test")->table_heap.get();
+
+        std::vector<Tuple> tuples;
+        for (int i = 0; i < num_rows; i++) {
+            tuples.emplace_back(
+                std::vector<Value>{Value(int32_t(i)),
+                                   Value(std::string(100, 'a' + i % 26))},
+                &schema);
+        }
+        std::vector<RID> rids;
+        assert(heap->InsertTuples(tuples, &rids, 1));
+        assert(rids.size() == tuples.size());
+
+        int count = 0;
+        for (auto it = heap->Begin(); !it.IsEnd(); ++it) {
+            Tuple tuple = *it;
+            assert(std::get<int32_t>(tuple.GetValue(0)) == count);
+            assert(tuple.GetRID().page_id == rids[count].page_id);
+            assert(tuple.GetRID().slot_num == rids[count].slot_num);
+            count++;
+        }
+        assert(count == num_rows);
+        log_manager.Flush();
+
+        // One MULTI_INSERT per page whose slots match the returned RIDs
+        size_t logged = 0;
+        size_t dml_records = 0;
+        auto cursor = log_manager.CreateLogCursor();
+        for (bool ok = cursor->SeekToFirst(); ok; ok = cursor->Next()) {
+            const LogRecord& record = cursor->GetRecord();
+            if (record.GetType() == LogRecordType::INSERT) {
+                logged++;
+                dml_records++;
+            } else if (record.GetType() == LogRecordType::MULTI_INSERT) {
+                const auto& multi =
+                    static_cast<const MultiInsertLogRecord&>(record);
+                for (size_t i = 0; i < multi.GetTupleCount(); i++) {
+                    RID rid = multi.GetRID(i);
+                    assert(rid.page_id == rids[logged].page_id);
+                    assert(rid.slot_num == rids[logged].slot_num);
+                    logged++;
+                }
+                dml_records++;
+            }
+        }
+        assert(logged == rids.size());
+        assert(dml_records < 20);
+
+        // The next single-row insert goes to the half-empty last page
+        RID rid;
+        assert(heap->InsertTuple(tuples[0], &rid, 1));
+        assert(rid.page_id == rids.back().page_id);
+    }
+    std::remove(db_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+
+    std::cout << "TableHeap Bulk Insert tests passed!" << std::endl;
+}
+
+// Test B+ tree bulk load: sorted bottom-up build and the external sorter
+// Check in-page search of one key type against std::lower_bound/upper_bound
+template <typename KeyType, typename MakeKey>
+void CheckPageKeySearch(MakeKey make_key) {
+    alignas(8) char leaf_buffer[PAGE_SIZE];
+    alignas(8) char internal_buffer[PAGE_SIZE];
+    auto* leaf =
+        reinterpret_cast<BPlusTreeLeafPage<KeyType, RID>*>(leaf_buffer);
+    auto* internal =
+        reinterpret_cast<BPlusTreeInternalPage<KeyType>*>(internal_buffer);
+    leaf->Init(1);
+    internal->Init(2);
+
+    int max_size = std::min(leaf->GetMaxSize(), internal->GetMaxSize());
+    for (int size = 0; size <= max_size; size++) {
+        // Keys 0, 2, 4, ... so odd probes fall between them
+        std::vector<KeyType> keys;
+        leaf->SetSize(size);
+        internal->SetSize(size);
+        internal->SetValueAt(0, 0);
+        for (int i = 0; i < size; i++) {
+            keys.push_back(make_key(i * 2));
+            leaf->SetKeyAt(i, keys.back());
+            leaf->SetValueAt(i, RID{i, 0});
+            internal->SetKeyAt(i + 1, keys.back());
+            internal->SetValueAt(i + 1, i + 1);
+        }
+        for (int probe = -1; probe <= size * 2 + 1; probe++) {
+            KeyType key = make_key(probe);
+            int lower = static_cast<int>(
+                std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+            int upper = static_cast<int>(
+                std::upper_bound(keys.begin(), keys.end(), key) - keys.begin());
+            assert(leaf->KeyIndex(key) == lower);
+            if (size > 0) {
+                assert(internal->KeyIndex(key) == upper);
+            }
+        }
+    }
+}
+
+void TestPageKeySearch() {
+    std::cout << "Testing Page Key Search..." << std::endl;
+
+    CheckPageKeySearch<int32_t>([](int v) { return static_cast<int32_t>(v); });
+    CheckPageKeySearch<int64_t>(
+        [](int v) { return static_cast<int64_t>(v) * 1000000007LL; });
+    CheckPageKeySearch<double>([](int v) { return v * 0.5; });
+    // Non-arithmetic keys take the reference-comparing path
+    CheckPageKeySearch<InlineStringKey<16>>([](int v) {
+        std::string digits = std::to_string(v + 100000);
+        return InlineStringKey<16>("k" + digits);
+    });
+
+    std::cout << "Page Key Search tests passed!" << std::endl;
+}
+
+void TestLeafPrefixCompression() {
+    std::cout << "Testing Leaf Prefix Compression..." << std::endl;
+
+    using Key = InlineStringKey<64>;
+    auto url = [](int i) {
+        std::string digits = std::to_string(i);
+        return "https://example.com/items/" + std::string(8 - digits.size(), '0') +
+               digits;
+    };
+
+    // Keys sharing a long prefix fit more entries than a fresh page allows
+    alignas(8) char leaf_buffer[PAGE_SIZE];
+    auto* leaf = reinterpret_cast<BPlusTreeLeafPage<Key, RID>*>(leaf_buffer);
+    leaf->Init(2);
+    int plain_capacity = leaf->GetMaxSize();
+    std::vector<std::pair<Key, RID>> entries;
+    for (int i = 0; i < plain_capacity + 1; i++) {
+        entries.emplace_back(Key(url(i)), RID{i, 0});
+    }
+    assert(leaf->Assign(entries.data(), static_cast<int>(entries.size())));
+    assert(leaf->GetMaxSize() > plain_capacity);
+    for (int i = 0; i < leaf->GetSize(); i++) {
+        assert(leaf->KeyAt(i) == entries[i].first);
+        assert(leaf->ValueAt(i).page_id == i);
+    }
+    // A key without the shared prefix shrinks it and no longer fits
+    assert(!leaf->HasRoomFor(Key("a")));
+    assert(!leaf->Insert(Key("a"), RID{-1, 0}));
+    assert(leaf->GetSize() == plain_capacity + 1);
+    assert(leaf->Delete(entries[3].first));
+    assert(leaf->KeyIndex(entries[3].first) == 3);
+    assert(leaf->KeyAt(3) == entries[4].first);
+
+    // Random inserts and deletes, including keys that break the prefix
+    const std::string db_name = "test_leaf_prefix.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        page_id_t first_page;
+        assert(bpm->NewPage(&first_page) != nullptr);
+        bpm->UnpinPage(first_page, true);
+
+        BPlusTree<Key, RID> tree("prefix_idx", bpm.get());
+        std::map<std::string, int> expected;
+        uint32_t seed = 12345;
+        auto next_random = [&seed]() {
+            seed = seed * 1103515245u + 12345u;
+            return (seed >> 8) % 100000;
+        };
+        for (int round = 0; round < 12000; round++) {
+            int n = static_cast<int>(next_random() % 6000);
+            std::string key = n % 97 == 0 ? "x" + std::to_string(n) : url(n);
+            if (next_random() % 3 == 0) {
+                bool removed = tree.Remove(Key(key));
+                assert(removed == (expected.erase(key) == 1));
+            } else {
+                assert(tree.Insert(Key(key), RID{n, 0}));
+                expected[key] = n;
+            }
+        }
+        RID rid;
+        auto it = tree.Begin();
+        for (const auto& [key, value] : expected) {
+            assert(!it.IsEnd());
+            assert((*it).first == Key(key));
+            assert((*it).second.page_id == value);
+            ++it;
+            assert(tree.GetValue(Key(key), &rid) && rid.page_id == value);
+        }
+        assert(it.IsEnd());
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Leaf Prefix Compression tests passed!" << std::endl;
+}
+
+void TestBPlusTreeBulkLoad() {
+    std::cout << "Testing B+ Tree Bulk Load..." << std::endl;
+
+    const std::string db_name = "test_bulk_load.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            32, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(32));
+        // Page 0 stands in for the catalog page so the header lands on page 1
+        page_id_t first_page;
+        assert(bpm->NewPage(&first_page) != nullptr);
+        bpm->UnpinPage(first_page, true);
+
+        const int num_keys = 5000;
+        std::vector<std::pair<int32_t, RID>> entries;
+        for (int i = 0; i < num_keys; i++) {
+            int32_t key = (i * 7919) % num_keys;
+            entries.emplace_back(key * 2, RID{key, 0});
+        }
+        // A repeated key keeps the value added last
+        entries.emplace_back(0, RID{0, 1});
+
+        BPlusTree<int32_t, RID> tree("bulk_load_idx", bpm.get());
+        assert(tree.IsEmpty());
+        assert(tree.BulkLoad(entries, 0.7));
+        assert(!tree.IsEmpty());
+        assert(!tree.BulkLoad(entries));
+
+        RID rid;
+        for (int32_t key = 0; key < num_keys; key++) {
+            assert(tree.GetValue(key * 2, &rid));
+            assert(rid.page_id == key);
+            assert(rid.slot_num == (key == 0 ? 1 : 0));
+            assert(!tree.GetValue(key * 2 + 1, &rid));
+        }
+        int32_t expected = 0;
+        for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+            assert((*it).first == expected);
+            expected += 2;
+        }
+        assert(expected == num_keys * 2);
+
+        // The bulk-loaded tree keeps working with regular inserts
+        for (int32_t key = 1; key < 400; key += 2) {
+            assert(tree.Insert(key, RID{key, 2}));
+        }
+        for (int32_t key = 1; key < 400; key += 2) {
+            assert(tree.GetValue(key, &rid));
+            assert(rid.slot_num == 2);
+        }
+    }
+    std::remove(db_name.c_str());
+
+    // A tiny memory limit forces sorted runs on disk and a k-way merge
+    BulkLoadSorter<int32_t, RID> sorter(
+        64 * sizeof(BulkLoadSorter<int32_t, RID>::Entry));
+    for (int i = 999; i >= 0; i--) {
+        sorter.Add(i % 500, RID{i, i % 500});
+    }
+    assert(sorter.Finish());
+    assert(sorter.GetRunCount() > 1);
+    assert(sorter.GetCount() == 500);
+    BulkLoadSorter<int32_t, RID>::Entry entry;
+    int32_t next_key = 0;
+    while (sorter.Next(&entry)) {
+        assert(entry.first == next_key);
+        assert(entry.second.page_id == next_key);
+        next_key++;
+    }
+    assert(next_key == 500);
+
+    std::cout << "B+ Tree Bulk Load tests passed!" << std::endl;
+}
+
+// Test index persistence: clean restarts reopen trees, crashes rebuild them
+void TestBPlusTreeConcurrentAccess() {
+    std::cout << "Testing B+ Tree Concurrent Access..." << std::endl;
+
+    const std::string db_name = "test_bplus_concurrent.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            128, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(128));
+        page_id_t first_page;
+        assert(bpm->NewPage(&first_page) != nullptr);
+        bpm->UnpinPage(first_page, true);
+
+        BPlusTree<int32_t, RID> tree("concurrent_idx", bpm.get());
+        // Even keys are loaded up front and read while writers run
+        const int num_base = 2000;
+        for (int32_t key = 0; key < num_base; key++) {
+            assert(tree.Insert(key * 2, RID{key, 0}));
+        }
+
+        const int num_writers = 4;
+        const int num_readers = 4;
+        const int keys_per_writer = 1000;
+        std::atomic<int> read_failures{0};
+        std::vector<std::thread> threads;
+        for (int w = 0; w < num_writers; w++) {
+            threads.emplace_back([&tree, w]() {
+                // Odd keys go in between the existing ones and split leaves
+                for (int i = 0; i < keys_per_writer; i++) {
+                    int32_t key = (i * num_writers + w) * 2 + 1;
+                    tree.Insert(key, RID{key, 1});
+                }
+            });
+        }
+        for (int r = 0; r < num_readers; r++) {
+            threads.emplace_back([&tree, &read_failures, r]() {
+                RID rid;
+                for (int round = 0; round < 3; round++) {
+                    for (int32_t key = r; key < num_base; key += num_readers) {
+                        if (!tree.GetValue(key * 2, &rid) ||
+                            rid.page_id != key) {
+                            read_failures++;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(read_failures == 0);
+
+        // Concurrent removes of every other odd key
+        threads.clear();
+        for (int w = 0; w < num_writers; w++) {
+            threads.emplace_back([&tree, w]() {
+                for (int i = 0; i < keys_per_writer; i += 2) {
+                    int32_t key = (i * num_writers + w) * 2 + 1;
+                    tree.Remove(key);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        RID rid;
+        int32_t prev = -1;
+        int count = 0;
+        for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+            int32_t key = (*it).first;
+            assert(key > prev);
+            prev = key;
+            count++;
+        }
+        assert(count == num_base + num_writers * keys_per_writer / 2);
+        for (int w = 0; w < num_writers; w++) {
+            for (int i = 0; i < keys_per_writer; i++) {
+                int32_t key = (i * num_writers + w) * 2 + 1;
+                assert(tree.GetValue(key, &rid) == (i % 2 == 1));
+            }
+        }
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "B+ Tree Concurrent Access tests passed!" << std::endl;
+}
+
+static std::vector<Tuple> RunQuery(ExecutionEngine* engine,
+                                   TransactionManager* txn_manager,
+                                   const std::string& sql) {
+    Parser parser(sql);
+    auto statement = parser.Parse();
+    Transaction* txn = txn_manager->Begin();
+    std::vector<Tuple> result;
+    bool success = engine->Execute(statement.get(), &result, txn);
+    assert(success);
+    (void)success;
+    txn_manager->Commit(txn);
+    return result;
+}
+
+void TestIndexRangeScan() {
+    std::cout << "Testing Index Range Scan..." << std::endl;
+
+    const std::string db_name = "test_range_scan.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE events (ts INT PRIMARY KEY, kind INT);");
+        // Inserted out of order so results come back sorted by the index
+        std::string insert_sql = "INSERT INTO events VALUES ";
+        for (int i = 0; i < 500; i++) {
+            int32_t ts = (i * 37) % 500;
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(ts) + ", " +
+                          std::to_string(ts % 3) + ")";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+
+        auto keys_of = [](const std::vector<Tuple>& rows) {
+            std::vector<int32_t> keys;
+            for (const auto& row : rows) {
+                keys.push_back(std::get<int32_t>(row.GetValue(0)));
+            }
+            return keys;
+        };
+        auto range = [](int32_t from, int32_t to, int32_t step = 1) {
+            std::vector<int32_t> keys;
+            for (int32_t k = from; k < to; k += step) {
+                keys.push_back(k);
+            }
+            return keys;
+        };
+
+        auto plan = RunQuery(&engine, &txn_manager,
+                             "EXPLAIN SELECT * FROM events WHERE ts > 100;");
+        assert(std::get<std::string>(plan[0].GetValue(0)).find(
+                   "Index Range Scan") != std::string::npos);
+
+        assert(keys_of(RunQuery(&engine, &txn_manager,
+                                "SELECT * FROM events WHERE ts > 490;")) ==
+               range(491, 500));
+        assert(keys_of(RunQuery(&engine, &txn_manager,
+                                "SELECT * FROM events WHERE ts <= 4;")) ==
+               range(0, 5));
+        assert(keys_of(RunQuery(
+                   &engine, &txn_manager,
+                   "SELECT * FROM events WHERE ts >= 10 AND ts < 20;")) ==
+               range(10, 20));
+        assert(keys_of(RunQuery(
+                   &engine, &txn_manager,
+                   "SELECT * FROM events WHERE ts BETWEEN 200 AND 210;")) ==
+               range(200, 211));
+        // Constant on the left and a bound that is tightened twice
+        assert(keys_of(RunQuery(
+                   &engine, &txn_manager,
+                   "SELECT * FROM events WHERE 300 > ts AND ts < 295 AND "
+                   "ts >= 290;")) == range(290, 295));
+        // Conditions on other columns still filter the rows in range
+        assert(keys_of(RunQuery(
+                   &engine, &txn_manager,
+                   "SELECT * FROM events WHERE ts < 30 AND kind = 0;")) ==
+               range(0, 30, 3));
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM events WHERE ts > 1000;")
+                   .empty());
+
+        // Equality still uses the point lookup, and extra filters apply
+        assert(keys_of(RunQuery(
+                   &engine, &txn_manager,
+                   "SELECT * FROM events WHERE kind = 1 AND ts = 7;")) ==
+               std::vector<int32_t>{7});
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM events WHERE ts = 7 AND kind = 0;")
+                   .empty());
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Index Range Scan tests passed!" << std::endl;
+}
+
+void TestNonUniqueIndex() {
+    std::cout << "Testing Non-Unique Index..." << std::endl;
+
+    const std::string db_name = "test_non_unique.db";
+    std::remove(db_name.c_str());
+    const int num_rows = 600;
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+    auto sorted_ids = [](const std::vector<Tuple>& rows) {
+        std::vector<int32_t> ids;
+        for (const auto& row : rows) {
+            ids.push_back(std::get<int32_t>(row.GetValue(0)));
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+    auto ids_with_kind = [num_rows](int32_t kind) {
+        std::vector<int32_t> ids;
+        for (int32_t id = 0; id < num_rows; id++) {
+            if (id % 3 == kind) {
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    };
+
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE items (id INT PRIMARY KEY, kind INT);");
+        std::string insert_sql = "INSERT INTO items VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                          std::to_string(i % 3) + ")";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        // Built over existing rows: 200 rows per key, spread over many leaves
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX items_kind ON items (kind);");
+        assert(!catalog.GetIndex("items_kind")->is_unique);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE UNIQUE INDEX items_id ON items (id);");
+        assert(catalog.GetIndex("items_id")->is_unique);
+
+        auto plan = RunQuery(&engine, &txn_manager,
+                             "EXPLAIN SELECT * FROM items WHERE kind = 1;");
+        assert(std::get<std::string>(plan[0].GetValue(0)).find(
+                   "Index Scan") != std::string::npos);
+        for (int32_t kind = 0; kind < 3; kind++) {
+            assert(sorted_ids(RunQuery(&engine, &txn_manager,
+                                       "SELECT * FROM items WHERE kind = " +
+                                           std::to_string(kind) + ";")) ==
+                   ids_with_kind(kind));
+        }
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM items WHERE kind >= 1;")
+                   .size() == 400);
+
+        // Rows inserted after the index exists join the existing key
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO items VALUES (1000, 2), (1001, 2);");
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM items WHERE kind = 2;")
+                   .size() == 202);
+
+        // Deleting one row removes only its own entry from the index
+        RunQuery(&engine, &txn_manager, "DELETE FROM items WHERE id = 1000;");
+        RunQuery(&engine, &txn_manager, "DELETE FROM items WHERE id = 1001;");
+        RunQuery(&engine, &txn_manager, "DELETE FROM items WHERE id = 5;");
+        std::vector<int32_t> expected = ids_with_kind(2);
+        expected.erase(std::find(expected.begin(), expected.end(), 5));
+        assert(sorted_ids(RunQuery(&engine, &txn_manager,
+                                   "SELECT * FROM items WHERE kind = 2;")) ==
+               expected);
+
+        // Moving a row to another key keeps the other duplicates in place
+        RunQuery(&engine, &txn_manager,
+                 "UPDATE items SET kind = 7 WHERE id = 8;");
+        expected.erase(std::find(expected.begin(), expected.end(), 8));
+        assert(sorted_ids(RunQuery(&engine, &txn_manager,
+                                   "SELECT * FROM items WHERE kind = 2;")) ==
+               expected);
+        assert(sorted_ids(RunQuery(&engine, &txn_manager,
+                                   "SELECT * FROM items WHERE kind = 7;")) ==
+               std::vector<int32_t>{8});
+    }
+
+    // The uniqueness flag survives a restart
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        assert(!catalog.GetIndex("items_kind")->is_unique);
+        assert(catalog.GetIndex("items_id")->is_unique);
+        TableManager table_manager(bpm.get(), &catalog);
+        IndexManager* index_manager = table_manager.GetIndexManager();
+        std::vector<RID> rids;
+        assert(index_manager->FindEntry("items_kind", Value(int32_t(0)),
+                                        &rids));
+        assert(rids.size() == 200);
+        assert(!index_manager->FindEntry("items_kind", Value(int32_t(3)),
+                                         &rids));
+        // Deleting by RID leaves the other rows with the same key
+        assert(index_manager->DeleteEntry("items_kind", Value(int32_t(0)),
+                                          rids[0]));
+        rids.clear();
+        assert(index_manager->FindEntry("items_kind", Value(int32_t(0)),
+                                        &rids));
+        assert(rids.size() == 199);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Non-Unique Index tests passed!" << std::endl;
+}
+
+void TestCompositeIndex() {
+    std::cout << "Testing Composite Index..." << std::endl;
+
+    // Encoded keys compare the same way as the column values
+    auto encode_int = [](int32_t v) {
+        GenericKey<8> key;
+        GenericKeyEncoder::EncodeInt32(v, key.data);
+        return key;
+    };
+    auto encode_double = [](double v) {
+        GenericKey<8> key;
+        GenericKeyEncoder::EncodeDouble(v, key.data);
+        return key;
+    };
+    auto encode_string = [](const std::string& v) {
+        GenericKey<8> key;
+        GenericKeyEncoder::EncodeString(v, key.data, 8);
+        return key;
+    };
+    assert(encode_int(-5) < encode_int(-1));
+    assert(encode_int(-1) < encode_int(0));
+    assert(encode_int(0) < encode_int(7));
+    assert(encode_double(-2.5) < encode_double(-0.5));
+    assert(encode_double(-0.0) == encode_double(0.0));
+    assert(encode_double(0.0) < encode_double(1e-9));
+    assert(encode_string("ab") < encode_string("abc"));
+    assert(encode_string("abc") < encode_string("abd"));
+
+    const std::string db_name = "test_composite_index.db";
+    std::remove(db_name.c_str());
+    const int num_rows = 400;
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+    auto sorted_ids = [](const std::vector<Tuple>& rows) {
+        std::vector<int32_t> ids;
+        for (const auto& row : rows) {
+            ids.push_back(std::get<int32_t>(row.GetValue(0)));
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+    // Row i belongs to tenant i % 8 and was created at i / 8
+    auto ids_where = [num_rows](const std::function<bool(int32_t, int32_t)>&
+                                    match) {
+        std::vector<int32_t> ids;
+        for (int32_t id = 0; id < num_rows; id++) {
+            if (match(id % 8, id / 8)) {
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    };
+
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE orders (id INT PRIMARY KEY, tenant INT, "
+                 "created INT, region VARCHAR(8));");
+        std::string insert_sql = "INSERT INTO orders VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                          std::to_string(i % 8) + ", " +
+                          std::to_string(i / 8) + ", '" +
+                          (i % 2 == 0 ? "east" : "west") + "')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX orders_tenant ON orders (tenant);");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX orders_tenant_created ON orders "
+                 "(tenant, created);");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE UNIQUE INDEX orders_region_id ON orders "
+                 "(region, id);");
+
+        // Both columns bound: the composite index wins over orders_tenant
+        auto plan = RunQuery(
+            &engine, &txn_manager,
+            "EXPLAIN SELECT * FROM orders WHERE created = 17 AND tenant = 5;");
+        assert(std::get<std::string>(plan[0].GetValue(0)).find(
+                   "orders_tenant_created") != std::string::npos);
+        assert(sorted_ids(RunQuery(&engine, &txn_manager,
+                                   "SELECT * FROM orders WHERE created = 17 "
+                                   "AND tenant = 5;")) ==
+               ids_where([](int32_t t, int32_t c) {
+                   return t == 5 && c == 17;
+               }));
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM orders WHERE tenant = 5 AND "
+                        "created = 1000;")
+                   .empty());
+
+        // Only the leading column bound: prefix lookup plus filtering
+        assert(sorted_ids(RunQuery(&engine, &txn_manager,
+                                   "SELECT * FROM orders WHERE tenant = 3 AND "
+                                   "created < 20;")) ==
+               ids_where([](int32_t t, int32_t c) {
+                   return t == 3 && c < 20;
+               }));
+        assert(sorted_ids(RunQuery(&engine, &txn_manager,
+                                   "SELECT * FROM orders WHERE region = "
+                                   "'west' AND id = 17;")) ==
+               std::vector<int32_t>{17});
+
+        // Index maintenance goes through every key column
+        RunQuery(&engine, &txn_manager,
+                 "UPDATE orders SET created = 500 WHERE id = 13;");
+        RunQuery(&engine, &txn_manager, "DELETE FROM orders WHERE id = 21;");
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM orders WHERE tenant = 5 AND "
+                        "created = 1;")
+                   .empty());
+        assert(sorted_ids(RunQuery(&engine, &txn_manager,
+                                   "SELECT * FROM orders WHERE tenant = 5 AND "
+                                   "created = 500;")) ==
+               std::vector<int32_t>{13});
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM orders WHERE tenant = 5 AND "
+                        "created = 2;")
+                   .empty());
+    }
+
+    // Reopen: the composite trees come back from the catalog
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        TableManager table_manager(bpm.get(), &catalog);
+        IndexManager* index_manager = table_manager.GetIndexManager();
+        std::vector<RID> rids;
+        assert(index_manager->FindEntry(
+            "orders_tenant_created", {Value(int32_t(2)), Value(int32_t(0))},
+            &rids));
+        assert(rids.size() == 1);
+        rids.clear();
+        assert(index_manager->FindEntry("orders_tenant_created",
+                                        {Value(int32_t(2))}, &rids));
+        assert(rids.size() == static_cast<size_t>(num_rows / 8));
+        rids.clear();
+        assert(index_manager->FindEntry("orders_region_id",
+                                        {Value(std::string("east"))}, &rids));
+        assert(rids.size() == static_cast<size_t>(num_rows / 2));
+
+        // 64 + 4 bytes does not fit in the widest key
+        Schema wide_schema({{"a", TypeId::VARCHAR, 64, false, false},
+                            {"b", TypeId::INTEGER, 4, false, false}});
+        assert(catalog.CreateTable("wide", wide_schema));
+        assert(!table_manager.CreateIndex("wide_ab", "wide", {"a", "b"}));
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Composite Index tests passed!" << std::endl;
+}
+
+void TestInlineStringKey() {
+    std::cout << "Testing Inline String Key..." << std::endl;
+
+    using Key = InlineStringKey<32>;
+    assert(Key("ab") < Key("abc"));
+    assert(Key("abc") < Key("abd"));
+    assert(!(Key("abc") < Key("abc")));
+    assert(Key("abc") == Key(std::string("abc")));
+    assert(Key("abc").ToString() == "abc");
+    assert(Key::Fits(std::string(32, 'x')));
+    assert(!Key::Fits(std::string(33, 'x')));
+    // Separators stop at the first byte that tells the two sides apart
+    assert(Key::ShortestSeparator(Key("apple"), Key("apricot")) == Key("apr"));
+    assert(Key::ShortestSeparator(Key("ab"), Key("abc")) == Key("abc"));
+    assert(Key::ShortestSeparator(Key("abc"), Key("b")) == Key("b"));
+
+    const std::string db_name = "test_inline_string_key.db";
+    std::remove(db_name.c_str());
+    const int num_keys = 3000;
+    // Long shared prefixes, like e-mail addresses of one domain
+    auto email = [](int i) {
+        std::string digits = std::to_string(i);
+        return "user" + std::string(6 - digits.size(), '0') + digits +
+               "@example.com";
+    };
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        page_id_t first_page;
+        assert(bpm->NewPage(&first_page) != nullptr);
+        bpm->UnpinPage(first_page, true);
+
+        BPlusTree<Key, RID> tree("inline_string_idx", bpm.get());
+        for (int i = 0; i < num_keys; i++) {
+            int k = (i * 7919) % num_keys;
+            assert(tree.Insert(Key(email(k)), RID{k, 0}));
+        }
+        RID rid;
+        for (int i = 0; i < num_keys; i++) {
+            assert(tree.GetValue(Key(email(i)), &rid));
+            assert(rid.page_id == i);
+        }
+        assert(!tree.GetValue(Key("user"), &rid));
+        assert(!tree.GetValue(Key(email(num_keys)), &rid));
+
+        int expected = 0;
+        for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+            assert((*it).first == Key(email(expected)));
+            expected++;
+        }
+        assert(expected == num_keys);
+
+        for (int i = 0; i < num_keys; i += 2) {
+            assert(tree.Remove(Key(email(i))));
+        }
+        for (int i = 0; i < num_keys; i++) {
+            assert(tree.GetValue(Key(email(i)), &rid) == (i % 2 == 1));
+        }
+
+        // Bulk loading builds the same separators
+        std::vector<std::pair<Key, RID>> entries;
+        for (int i = 0; i < num_keys; i++) {
+            entries.emplace_back(Key(email(i)), RID{i, 1});
+        }
+        BPlusTree<Key, RID> loaded("inline_string_bulk_idx", bpm.get());
+        assert(loaded.BulkLoad(entries, 0.8));
+        for (int i = 0; i < num_keys; i++) {
+            assert(loaded.GetValue(Key(email(i)), &rid));
+            assert(rid.page_id == i && rid.slot_num == 1);
+        }
+    }
+    std::remove(db_name.c_str());
+
+    // VARCHAR indexes use inline keys and survive a restart
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE users (id INT PRIMARY KEY, email VARCHAR(24), "
+                 "city VARCHAR(12));");
+        std::string insert_sql = "INSERT INTO users VALUES ";
+        for (int i = 0; i < 500; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", '" +
+                          email(i) + "', '" +
+                          (i % 3 == 0 ? "berlin" : "boston") + "')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE UNIQUE INDEX users_email ON users (email);");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX users_city ON users (city);");
+
+        auto rows = RunQuery(
+            &engine, &txn_manager,
+            "SELECT * FROM users WHERE email = '" + email(321) + "';");
+        assert(rows.size() == 1);
+        assert(std::get<int32_t>(rows[0].GetValue(0)) == 321);
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM users WHERE email >= '" + email(490) +
+                            "';");
+        assert(rows.size() == 10);
+        RunQuery(&engine, &txn_manager,
+                 "DELETE FROM users WHERE email = '" + email(7) + "';");
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM users WHERE email = '" + email(7) + "';")
+                   .empty());
+    }
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        TableManager table_manager(bpm.get(), &catalog);
+        IndexManager* index_manager = table_manager.GetIndexManager();
+        RID rid;
+        assert(
+            index_manager->FindEntry("users_email", Value(email(123)), &rid));
+        assert(!index_manager->FindEntry("users_email", Value(email(7)), &rid));
+        std::vector<RID> rids;
+        assert(index_manager->FindEntry(
+            "users_city", Value(std::string("berlin")), &rids));
+        assert(rids.size() == 167);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Inline String Key tests passed!" << std::endl;
+}
+
+void TestHashIndex() {
+    std::cout << "Testing Hash Index..." << std::endl;
+
+    const std::string db_name = "test_hash_index.db";
+    std::remove(db_name.c_str());
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+
+    const int32_t num_keys = 20000;
+    page_id_t directory_page_id = INVALID_PAGE_ID;
+    {
+        auto bpm = make_bpm();
+        ExtendibleHashTable<int32_t, RID> table("hash_ids", bpm.get());
+        RID rid;
+        assert(table.GetDirectoryPageId() == INVALID_PAGE_ID);
+        assert(!table.GetValue(1, &rid));
+        for (int32_t i = 0; i < num_keys; i++) {
+            assert(table.Insert(i, RID{i, 3}));
+        }
+        // Buckets split and the directory grows with the number of keys
+        uint32_t grown_depth = table.GetGlobalDepth();
+        assert(grown_depth > 0);
+        for (int32_t i = 0; i < num_keys; i++) {
+            assert(table.GetValue(i, &rid));
+            assert(rid.page_id == i && rid.slot_num == 3);
+        }
+        assert(!table.GetValue(num_keys, &rid));
+
+        // A unique table keeps one entry per key and overwrites it
+        assert(table.Insert(5, RID{99, 0}));
+        std::vector<RID> rids;
+        assert(table.GetValue(5, &rids));
+        assert(rids.size() == 1 && rids[0].page_id == 99);
+
+        // Emptied buckets merge back and the directory shrinks again
+        for (int32_t i = 100; i < num_keys; i++) {
+            assert(table.Remove(i));
+        }
+        assert(!table.Remove(num_keys));
+        assert(table.GetGlobalDepth() < grown_depth);
+        for (int32_t i = 0; i < num_keys; i += 37) {
+            assert(table.GetValue(i, &rid) == (i < 100));
+        }
+        directory_page_id = table.GetDirectoryPageId();
+    }
+
+    // The directory page id is enough to reopen the table
+    {
+        auto bpm = make_bpm();
+        ExtendibleHashTable<int32_t, RID> table("hash_ids", bpm.get(),
+                                                directory_page_id);
+        RID rid;
+        assert(table.GetValue(5, &rid) && rid.page_id == 99);
+        assert(table.GetValue(99, &rid) && rid.slot_num == 3);
+        assert(!table.GetValue(100, &rid));
+
+        // One key with more rows than a bucket holds ends up in an
+        // overflow chain once the bucket cannot split any further
+        ExtendibleHashTable<int32_t, RID> dup("hash_dup", bpm.get(),
+                                              INVALID_PAGE_ID, false);
+        const int32_t num_dups =
+            3 * HashTableBucketPage<int32_t, RID>::MAX_ENTRIES;
+        for (int32_t i = 0; i < num_dups; i++) {
+            assert(dup.Insert(42, RID{i, 0}));
+            assert(dup.Insert(i + 1000, RID{i, 1}));
+        }
+        assert(dup.Insert(42, RID{7, 0}));  // same pair is stored once
+        assert(dup.GetGlobalDepth() == HashTableDirectoryPage::MAX_DEPTH);
+        std::vector<RID> rids;
+        assert(dup.GetValue(42, &rids));
+        assert(rids.size() == static_cast<size_t>(num_dups));
+        assert(dup.Remove(42, RID{7, 0}));
+        assert(!dup.Remove(42, RID{7, 0}));
+        rids.clear();
+        assert(dup.GetValue(42, &rids) && rids.size() == num_dups - 1u);
+        assert(dup.Remove(42));
+        assert(!dup.GetValue(42, &rid));
+        for (int32_t i = 0; i < num_dups; i++) {
+            assert(dup.GetValue(i + 1000, &rid) && rid.page_id == i);
+        }
+    }
+    std::remove(db_name.c_str());
+
+    // SQL: hash indexes serve equality lookups and stay maintained
+    const std::string sql_db_name = "test_hash_index_sql.db";
+    std::remove(sql_db_name.c_str());
+    const int num_rows = 500;
+    auto make_sql_bpm = [&sql_db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(sql_db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+    {
+        auto bpm = make_sql_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE accounts (id INT, region INT, "
+                 "code VARCHAR(16));");
+        std::string insert_sql = "INSERT INTO accounts VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                          std::to_string(i % 5) + ", 'c" +
+                          std::to_string(i) + "')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE UNIQUE INDEX accounts_id ON accounts (id) "
+                 "USING HASH;");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX accounts_code ON accounts USING HASH "
+                 "(region, code);");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX accounts_region ON accounts USING HASH "
+                 "(region);");
+        assert(catalog.GetIndex("accounts_id")->index_type ==
+               IndexType::HASH);
+        assert(catalog.GetIndex("accounts_id")->is_unique);
+        assert(!catalog.GetIndex("accounts_region")->is_unique);
+
+        auto explain = [&](const std::string& sql) {
+            auto plan =
+                RunQuery(&engine, &txn_manager, "EXPLAIN " + sql + ";");
+            return std::get<std::string>(plan[0].GetValue(0));
+        };
+        assert(explain("SELECT * FROM accounts WHERE id = 7")
+                   .find("accounts_id") != std::string::npos);
+        assert(explain("SELECT * FROM accounts WHERE region = 1 AND "
+                       "code = 'c6'")
+                   .find("accounts_code") != std::string::npos);
+        // Ranges cannot use a hash index and fall back to a scan
+        assert(explain("SELECT * FROM accounts WHERE id < 10")
+                   .find("Index") == std::string::npos);
+
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM accounts WHERE id = 7;")
+                   .size() == 1);
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM accounts WHERE region = 1 AND "
+                        "code = 'c6';")
+                   .size() == 1);
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM accounts WHERE region = 2;")
+                   .size() == num_rows / 5);
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM accounts WHERE id < 10;")
+                   .size() == 10);
+
+        RunQuery(&engine, &txn_manager,
+                 "UPDATE accounts SET id = 1000 WHERE id = 7;");
+        RunQuery(&engine, &txn_manager, "DELETE FROM accounts WHERE id = 8;");
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM accounts WHERE id = 7;")
+                   .empty());
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM accounts WHERE id = 1000;")
+                   .size() == 1);
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM accounts WHERE id = 8;")
+                   .empty());
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM accounts WHERE region = 3;")
+                   .size() == num_rows / 5 - 1);
+    }
+
+    // The index type survives a restart and the directory is reopened
+    {
+        auto bpm = make_sql_bpm();
+        Catalog catalog(bpm.get());
+        assert(catalog.GetIndex("accounts_id")->index_type ==
+               IndexType::HASH);
+        assert(catalog.GetIndex("accounts_code")->index_type ==
+               IndexType::HASH);
+        TableManager table_manager(bpm.get(), &catalog);
+        IndexManager* index_manager = table_manager.GetIndexManager();
+        assert(index_manager->GetIndex<int32_t>("accounts_id") == nullptr);
+        RID rid;
+        assert(index_manager->FindEntry("accounts_id", Value(int32_t(1000)),
+                                        &rid));
+        assert(!index_manager->FindEntry("accounts_id", Value(int32_t(8)),
+                                         &rid));
+        std::vector<RID> rids;
+        assert(index_manager->FindEntry(
+            "accounts_code",
+            {Value(int32_t(4)), Value(std::string("c499"))}, &rids));
+        assert(rids.size() == 1);
+        // Hash keys have no order: prefixes and ranges are not supported
+        assert(!index_manager->FindEntry("accounts_code",
+                                         {Value(int32_t(4))}, &rids));
+        Value lower(int32_t(0));
+        assert(!index_manager->ScanRange("accounts_id", &lower, true,
+                                         nullptr, false,
+                                         [](const RID&) { return true; }));
+    }
+    std::remove(sql_db_name.c_str());
+
+    std::cout << "Hash Index tests passed!" << std::endl;
+}
+
+void TestCoveringIndex() {
+    std::cout << "Testing Covering Index..." << std::endl;
+
+    const std::string db_name = "test_covering_index.db";
+    std::remove(db_name.c_str());
+    const int num_rows = 200;
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE orders (id INT, user_id INT, status VARCHAR(8), "
+                 "total DOUBLE, note VARCHAR(32));");
+        std::string insert_sql = "INSERT INTO orders VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                          std::to_string(i % 10) + ", 's" +
+                          std::to_string(i % 3) + "', " +
+                          std::to_string(i) + ".5, 'n" + std::to_string(i) +
+                          "')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX orders_user ON orders (user_id) "
+                 "INCLUDE (status, total);");
+        const auto& include_columns =
+            catalog.GetIndex("orders_user")->include_columns;
+        assert(include_columns.size() == 2 && include_columns[0] == "status" &&
+               include_columns[1] == "total");
+
+        // Each plan node is one row of the EXPLAIN output
+        auto explain = [&](const std::string& sql) {
+            std::string text;
+            for (const auto& row :
+                 RunQuery(&engine, &txn_manager, "EXPLAIN " + sql + ";")) {
+                text += std::get<std::string>(row.GetValue(0)) + "\n";
+            }
+            return text;
+        };
+        // Only stored columns are needed: the table is not touched
+        assert(explain("SELECT status, total FROM orders WHERE user_id = 3")
+                   .find("Index Only Scan using orders_user") !=
+               std::string::npos);
+        assert(explain("SELECT total FROM orders WHERE user_id = 3 AND "
+                       "status = 's0'")
+                   .find("Index Only Scan") != std::string::npos);
+        // An uncovered column needs the row from the table
+        std::string plan = explain("SELECT note FROM orders WHERE user_id = 3");
+        assert(plan.find("Index Scan using orders_user") != std::string::npos);
+        assert(plan.find("Index Only") == std::string::npos);
+        assert(explain("SELECT * FROM orders WHERE user_id = 3")
+                   .find("Index Only") == std::string::npos);
+
+        auto rows = RunQuery(&engine, &txn_manager,
+                             "SELECT status, total FROM orders WHERE "
+                             "user_id = 3;");
+        assert(rows.size() == num_rows / 10);
+        for (const auto& row : rows) {
+            double total = std::get<double>(row.GetValue(1));
+            int id = static_cast<int>(total);
+            assert(id % 10 == 3 && total == id + 0.5);
+            assert(std::get<std::string>(row.GetValue(0)) ==
+                   "s" + std::to_string(id % 3));
+        }
+        // The rest of the WHERE clause is checked on the index values
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT total FROM orders WHERE user_id = 3 AND "
+                        "status = 's0';")
+                   .size() == 7);
+
+        // Updating an INCLUDE column rewrites the index entry
+        RunQuery(&engine, &txn_manager,
+                 "UPDATE orders SET status = 'sx' WHERE id = 13;");
+        RunQuery(&engine, &txn_manager, "DELETE FROM orders WHERE id = 23;");
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT status FROM orders WHERE user_id = 3;");
+        assert(rows.size() == num_rows / 10 - 1);
+        assert(std::count_if(rows.begin(), rows.end(), [](const Tuple& row) {
+                   return std::get<std::string>(row.GetValue(0)) == "sx";
+               }) == 1);
+
+        // A value longer than the declared width is read from the table
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO orders VALUES (500, 42, 'overlong-status', "
+                 "1.5, 'n500');");
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT status FROM orders WHERE user_id = 42;");
+        assert(rows.size() == 1);
+        assert(std::get<std::string>(rows[0].GetValue(0)) ==
+               "overlong-status");
+    }
+
+    // INCLUDE columns survive a restart and the index is rebuilt with them
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        const auto& include_columns =
+            catalog.GetIndex("orders_user")->include_columns;
+        assert(include_columns.size() == 2 && include_columns[1] == "total");
+        TableManager table_manager(bpm.get(), &catalog);
+        IndexManager* index_manager = table_manager.GetIndexManager();
+        std::vector<std::pair<std::vector<Value>, RID>> entries;
+        assert(index_manager->FindEntryWithValues(
+            "orders_user", {Value(int32_t(7))}, &entries));
+        assert(entries.size() == num_rows / 10);
+        for (const auto& entry : entries) {
+            assert(entry.first.size() == 3);
+            assert(std::get<int32_t>(entry.first[0]) == 7);
+            int id = static_cast<int>(std::get<double>(entry.first[2]));
+            assert(std::get<std::string>(entry.first[1]) ==
+                   "s" + std::to_string(id % 3));
+        }
+        entries.clear();
+        assert(!index_manager->FindEntryWithValues(
+            "orders_user", {Value(int32_t(99))}, &entries));
+        assert(entries.empty());
+
+        // Hash indexes cannot carry INCLUDE columns
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        Transaction* txn = txn_manager.Begin();
+        std::vector<Tuple> result;
+        Parser parser("CREATE INDEX orders_hash ON orders (id) INCLUDE "
+                      "(total) USING HASH;");
+        auto stmt = parser.Parse();
+        bool created = false;
+        try {
+            created = engine.Execute(stmt.get(), &result, txn);
+        } catch (const std::exception&) {
+        }
+        txn_manager.Abort(txn);
+        assert(!created);
+        assert(catalog.GetIndex("orders_hash") == nullptr);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Covering Index tests passed!" << std::endl;
+}
+
+void TestZoneMap() {
+    std::cout << "Testing Zone Map..." << std::endl;
+
+    const std::string db_name = "test_zone_map.db";
+    std::remove(db_name.c_str());
+    const int num_rows = static_cast<int>(PAGE_SIZE / 4);
+    auto bpm = std::make_unique<BufferPoolManager>(
+        64, std::make_unique<DiskManager>(db_name),
+        std::make_unique<LRUReplacer>(64));
+    Catalog catalog(bpm.get());
+    LockManager lock_manager;
+    TransactionManager txn_manager(&lock_manager, nullptr);
+    ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+    // ts grows with the insert order, so every page covers a narrow range
+    RunQuery(&engine, &txn_manager,
+             "CREATE TABLE events (id INT, ts INT, tag VARCHAR(16));");
+    std::string insert_sql = "INSERT INTO events VALUES ";
+    for (int i = 0; i < num_rows; i++) {
+        insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                      std::to_string(1000 + i) + ", 'tag" +
+                      std::to_string(i % 7) + "')";
+    }
+    RunQuery(&engine, &txn_manager, insert_sql + ";");
+
+    TableInfo* table_info = catalog.GetTable("events");
+    TableHeap* table_heap = table_info->table_heap.get();
+    ZoneMap::PageZone zone;
+    assert(table_heap->GetPageZone(table_heap->GetFirstPageId(), &zone));
+    assert(zone.next_page_id != INVALID_PAGE_ID);
+    assert(zone.columns.size() == 3 && zone.columns[1].has_value);
+    assert(std::get<int32_t>(zone.columns[1].min) == 1000);
+    int first_page_max = std::get<int32_t>(zone.columns[1].max);
+    assert(first_page_max > 1000 && first_page_max < 1000 + num_rows);
+    assert(std::get<std::string>(zone.columns[2].min) == "tag0");
+    assert(std::get<std::string>(zone.columns[2].max) == "tag6");
+
+    // Scan events through the executor to see how many pages were skipped
+    auto scan = [&](std::unique_ptr<Expression> predicate,
+                    size_t* skipped_pages) {
+        Transaction* txn = txn_manager.Begin();
+        ExecutorContext exec_ctx(txn, &catalog, bpm.get(), nullptr);
+        SeqScanExecutor executor(
+            &exec_ctx,
+            std::make_unique<SeqScanPlanNode>(table_info->schema.get(),
+                                              "events", std::move(predicate)));
+        executor.Init();
+        size_t count = 0;
+        Tuple tuple;
+        RID rid;
+        while (executor.Next(&tuple, &rid)) {
+            count++;
+        }
+        *skipped_pages = executor.GetSkippedPages();
+        txn_manager.Commit(txn);
+        return count;
+    };
+    auto compare = [](const std::string& column,
+                      BinaryOpExpression::OpType op, const Value& value) {
+        return std::make_unique<BinaryOpExpression>(
+            std::make_unique<ColumnRefExpression>("", column), op,
+            std::make_unique<ConstantExpression>(value));
+    };
+    using OpType = BinaryOpExpression::OpType;
+    const int32_t last_ts = 1000 + num_rows - 1;
+
+    size_t skipped_pages = 0;
+    assert(scan(nullptr, &skipped_pages) == static_cast<size_t>(num_rows));
+    assert(skipped_pages == 0);
+    assert(scan(compare("ts", OpType::GREATER_EQUALS, last_ts - 4),
+                &skipped_pages) == 5);
+    assert(skipped_pages > 0);
+    // Constant on the left side of the comparison
+    assert(scan(std::make_unique<BinaryOpExpression>(
+                    std::make_unique<ConstantExpression>(Value(int32_t(1005))),
+                    OpType::GREATER_THAN,
+                    std::make_unique<ColumnRefExpression>("", "ts")),
+                &skipped_pages) == 5);
+    assert(skipped_pages > 0);
+    // Values outside every page skip the whole table
+    assert(scan(compare("ts", OpType::EQUALS, int32_t(5)), &skipped_pages) ==
+           0);
+    assert(skipped_pages > 1);
+    // OR keeps pages that match either side
+    assert(scan(std::make_unique<BinaryOpExpression>(
+                    compare("ts", OpType::LESS_THAN, int32_t(1003)),
+                    OpType::OR,
+                    compare("ts", OpType::GREATER_THAN, last_ts - 3)),
+                &skipped_pages) == 6);
+    assert(skipped_pages > 0);
+    // A condition the zone map cannot check reads every page
+    assert(scan(compare("ts", OpType::NOT_EQUALS, int32_t(1000)),
+                &skipped_pages) == static_cast<size_t>(num_rows - 1));
+    assert(skipped_pages == 0);
+
+    // Updates widen the ranges, so moved values are still found
+    RunQuery(&engine, &txn_manager,
+             "UPDATE events SET ts = 1 WHERE id = " +
+                 std::to_string(num_rows - 1) + ";");
+    assert(RunQuery(&engine, &txn_manager,
+                    "SELECT * FROM events WHERE ts < 10;")
+               .size() == 1);
+    assert(RunQuery(&engine, &txn_manager,
+                    "SELECT * FROM events WHERE ts >= " +
+                        std::to_string(last_ts - 4) + ";")
+               .size() == 4);
+    // Deleted rows leave the ranges wide but are not returned
+    RunQuery(&engine, &txn_manager, "DELETE FROM events WHERE ts < 1010;");
+    assert(RunQuery(&engine, &txn_manager,
+                    "SELECT * FROM events WHERE ts < 1020;")
+               .size() == 10);
+    assert(scan(compare("ts", OpType::LESS_THAN, int32_t(1010)),
+                &skipped_pages) == 0);
+
+    // Rows inserted later extend the zone of the page they land on
+    RunQuery(&engine, &txn_manager, "INSERT INTO events VALUES (100000, 7, 'x');");
+    assert(RunQuery(&engine, &txn_manager,
+                    "SELECT * FROM events WHERE ts = 7;")
+               .size() == 1);
+
+    std::remove(db_name.c_str());
+    std::cout << "Zone map test passed!" << std::endl;
+}
+
+void TestVectorizedExecution() {
+    std::cout << "Testing Vectorized Execution..." << std::endl;
+
+    const std::string db_name = "test_vectorized.db";
+    std::remove(db_name.c_str());
+    // More rows than one batch holds
+    const int num_rows = static_cast<int>(VECTOR_BATCH_SIZE * 2 + 300);
+    auto bpm = std::make_unique<BufferPoolManager>(
+        64, std::make_unique<DiskManager>(db_name),
+        std::make_unique<LRUReplacer>(64));
+    Catalog catalog(bpm.get());
+    LockManager lock_manager;
+    TransactionManager txn_manager(&lock_manager, nullptr);
+    ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+    RunQuery(&engine, &txn_manager,
+             "CREATE TABLE items (id INT, price DOUBLE, tag VARCHAR(16));");
+    std::string insert_sql = "INSERT INTO items VALUES ";
+    for (int i = 0; i < num_rows; i++) {
+        insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                      std::to_string(i % 100) + ".25, 't" +
+                      std::to_string(i % 5) + "')";
+    }
+    RunQuery(&engine, &txn_manager, insert_sql + ";");
+    TableInfo* table_info = catalog.GetTable("items");
+
+    // Runs the same scan through Next and NextBatch and returns both RID lists
+    auto where = [](const std::string& condition) {
+        Parser parser("SELECT * FROM items WHERE " + condition + ";");
+        auto statement = parser.Parse();
+        return ExpressionCloner::Clone(
+            static_cast<SelectStatement*>(statement.get())->GetWhereClause());
+    };
+    auto scan_both = [&](const std::string& condition, size_t* batches) {
+        Transaction* txn = txn_manager.Begin();
+        ExecutorContext exec_ctx(txn, &catalog, bpm.get(), nullptr);
+        auto make_executor = [&]() {
+            return std::make_unique<SeqScanExecutor>(
+                &exec_ctx, std::make_unique<SeqScanPlanNode>(
+                               table_info->schema.get(), "items",
+                               condition.empty() ? nullptr : where(condition)));
+        };
+        std::vector<RID> row_rids;
+        auto row_executor = make_executor();
+        row_executor->Init();
+        Tuple tuple;
+        RID rid;
+        while (row_executor->Next(&tuple, &rid)) {
+            row_rids.push_back(rid);
+        }
+        std::vector<RID> batch_rids;
+        auto batch_executor = make_executor();
+        batch_executor->Init();
+        VectorBatch batch;
+        *batches = 0;
+        while (batch_executor->NextBatch(&batch)) {
+            assert(batch.GetRowCount() <= VECTOR_BATCH_SIZE);
+            assert(batch.GetSelectedCount() > 0);
+            for (uint32_t row : batch.GetSelection()) {
+                batch_rids.push_back(batch.GetRID(row));
+            }
+            (*batches)++;
+        }
+        txn_manager.Commit(txn);
+        assert(row_rids == batch_rids);
+        return row_rids.size();
+    };
+
+    size_t batches = 0;
+    assert(scan_both("", &batches) == static_cast<size_t>(num_rows));
+    assert(batches == 3);
+    assert(scan_both("id < 10", &batches) == 10);
+    assert(scan_both("10 > id", &batches) == 10);
+    assert(scan_both("price >= 99", &batches) ==
+           static_cast<size_t>(num_rows / 100));
+    // Mixed numeric types and strings
+    assert(scan_both("price = 3.25 AND tag = 't3'", &batches) ==
+           scan_both("price = 3.25", &batches));
+    assert(scan_both("id < 5 OR id >= " + std::to_string(num_rows - 5) +
+                         " OR tag = 't9'",
+                     &batches) == 10);
+    assert(scan_both("NOT (id > 2)", &batches) == 3);
+    assert(scan_both("id * 2 + 1 = 21", &batches) == 1);
+    assert(scan_both("id > 100 AND (tag = 't1' OR price < 1)", &batches) ==
+           scan_both("id > 100 AND tag = 't1'", &batches) +
+               scan_both("id > 100 AND price < 1", &batches));
+    // A comparison that cannot be evaluated ends the scan in both paths
+    scan_both("tag > 5", &batches);
+    assert(batches == 0);
+
+    // Projection evaluates every expression once per batch
+    auto rows = RunQuery(&engine, &txn_manager,
+                         "SELECT tag, id FROM items WHERE id >= " +
+                             std::to_string(num_rows - 3) + ";");
+    assert(rows.size() == 3);
+    for (size_t i = 0; i < rows.size(); i++) {
+        int id = num_rows - 3 + static_cast<int>(i);
+        assert(std::get<int32_t>(rows[i].GetValue(1)) == id);
+        assert(std::get<std::string>(rows[i].GetValue(0)) ==
+               "t" + std::to_string(id % 5));
+    }
+    assert(RunQuery(&engine, &txn_manager,
+                    "SELECT tag FROM items WHERE tag = 't4';")
+               .size() == static_cast<size_t>(num_rows / 5));
+    assert(RunQuery(&engine, &txn_manager, "SELECT * FROM items;").size() ==
+           static_cast<size_t>(num_rows));
+
+    std::remove(db_name.c_str());
+    std::cout << "Vectorized execution test passed!" << std::endl;
+}
+
+void TestVectorKernels() {
+    std::cout << "Testing Vector Kernels..." << std::endl;
+
+    using OpType = BinaryOpExpression::OpType;
+    const std::vector<OpType> ops = {
+        OpType::EQUALS,      OpType::NOT_EQUALS,   OpType::LESS_THAN,
+        OpType::LESS_EQUALS, OpType::GREATER_THAN, OpType::GREATER_EQUALS};
+    auto expected = [](auto a, auto b, OpType op) {
+        switch (op) {
+            case OpType::EQUALS:
+                return a == b;
+            case OpType::NOT_EQUALS:
+                return a != b;
+            case OpType::LESS_THAN:
+                return a < b;
+            case OpType::LESS_EQUALS:
+                return a <= b;
+            case OpType::GREATER_THAN:
+                return a > b;
+            default:
+                return a >= b;
+        }
+    };
+
+    // A count that is not a multiple of any register width leaves a tail
+    const size_t count = 1027;
+    std::vector<int32_t> ints(count);
+    std::vector<int64_t> longs(count);
+    std::vector<double> doubles(count);
+    for (size_t i = 0; i < count; i++) {
+        ints[i] = static_cast<int32_t>(i % 50) - 25;
+        longs[i] = (static_cast<int64_t>(i % 50) - 25) * 10000000000LL;
+        doubles[i] = static_cast<double>(i % 50) / 4 - 6;
+    }
+    ints[3] = INT32_MIN;
+    ints[4] = INT32_MAX;
+    longs[5] = INT64_MIN;
+    longs[6] = INT64_MAX;
+    doubles[7] = std::nan("");
+
+    std::vector<uint8_t> matches(count);
+    std::vector<uint8_t> other(count);
+    std::vector<double> results(count);
+    bool had_simd = VectorKernels::IsSimdEnabled();
+    for (bool simd : {true, false}) {
+        VectorKernels::SetSimdEnabled(simd);
+        for (OpType op : ops) {
+            VectorKernels::Compare(ints.data(), count, 0, op, matches.data());
+            for (size_t i = 0; i < count; i++) {
+                assert(matches[i] == expected(ints[i], 0, op));
+            }
+            VectorKernels::Compare(longs.data(), count, 50000000000LL, op,
+                                   matches.data());
+            for (size_t i = 0; i < count; i++) {
+                assert(matches[i] == expected(longs[i], 50000000000LL, op));
+            }
+            VectorKernels::Compare(doubles.data(), count, 0.25, op,
+                                   matches.data());
+            for (size_t i = 0; i < count; i++) {
+                assert(matches[i] == expected(doubles[i], 0.25, op));
+            }
+        }
+
+        VectorKernels::Compare(ints.data(), count, 0, OpType::LESS_THAN,
+                               matches.data());
+        VectorKernels::Compare(ints.data(), count, -10, OpType::GREATER_THAN,
+                               other.data());
+        VectorKernels::And(matches.data(), other.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            assert(matches[i] == (ints[i] < 0 && ints[i] > -10));
+        }
+        VectorKernels::Compare(ints.data(), count, 20, OpType::GREATER_EQUALS,
+                               other.data());
+        VectorKernels::Or(matches.data(), other.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            assert(matches[i] ==
+                   ((ints[i] < 0 && ints[i] > -10) || ints[i] >= 20));
+        }
+
+        VectorKernels::Arithmetic(doubles.data(), doubles.data(), count,
+                                  OpType::MULTIPLY, results.data());
+        for (size_t i = 8; i < count; i++) {
+            assert(results[i] == doubles[i] * doubles[i]);
+        }
+        assert(std::isnan(results[7]));
+    }
+    VectorKernels::SetSimdEnabled(had_simd);
+
+    // Batched filters agree with row-at-a-time evaluation in both modes
+    Schema schema({{"i", TypeId::INTEGER, 0, false, false},
+                   {"l", TypeId::BIGINT, 0, false, false},
+                   {"f", TypeId::FLOAT, 0, false, false},
+                   {"d", TypeId::DOUBLE, 0, false, false}});
+    VectorBatch batch;
+    batch.Reset(4);
+    for (size_t i = 0; i < count; i++) {
+        Tuple tuple({Value(ints[i]), Value(longs[i]),
+                     Value(static_cast<float>(doubles[i])), Value(doubles[i])},
+                    &schema);
+        tuple.SetRID(RID{0, static_cast<slot_offset_t>(i)});
+        batch.AppendRow(tuple);
+    }
+    const std::vector<std::string> conditions = {
+        "i < 0", "0 >= i", "i = 7.0", "i > 2.5 AND i < 20", "l <= 0",
+        "l = 0 OR l > 1000000000", "l > 3", "f >= 1.5", "d != 0.25",
+        "d > 2 OR i < -20 AND l < 0", "d * 2 + 1 > 3", "d / 2 <= 1"};
+    for (bool simd : {true, false}) {
+        VectorKernels::SetSimdEnabled(simd);
+        for (const auto& condition : conditions) {
+            Parser parser("SELECT * FROM t WHERE " + condition + ";");
+            auto statement = parser.Parse();
+            const Expression* predicate =
+                static_cast<SelectStatement*>(statement.get())
+                    ->GetWhereClause();
+            ExpressionEvaluator evaluator(&schema);
+            VectorBatch filtered = batch;
+            evaluator.FilterBatch(predicate, &filtered);
+            std::vector<uint32_t> expected_rows;
+            for (uint32_t row = 0; row < count; row++) {
+                if (evaluator.EvaluateAsBoolean(predicate,
+                                                batch.GetTuple(row, &schema))) {
+                    expected_rows.push_back(row);
+                }
+            }
+            assert(filtered.GetSelection() == expected_rows);
+        }
+    }
+    VectorKernels::SetSimdEnabled(had_simd);
+
+    std::cout << "Vector kernels test passed!" << std::endl;
+}
+
+void TestCompiledExpression() {
+    std::cout << "Testing Compiled Expression..." << std::endl;
+
+    Schema schema({{"id", TypeId::INTEGER, 0, false, false},
+                   {"price", TypeId::DOUBLE, 0, false, false},
+                   {"name", TypeId::VARCHAR, 16, false, false}});
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 20; i++) {
+        tuples.emplace_back(
+            std::vector<Value>{Value(int32_t(i)), Value(i * 1.5),
+                               Value(std::string(i % 2 ? "odd" : ""))},
+            &schema);
+    }
+    auto parse = [](const std::string& condition) {
+        Parser parser("SELECT * FROM t WHERE " + condition + ";");
+        auto statement = parser.Parse();
+        return ExpressionCloner::Clone(
+            static_cast<SelectStatement*>(statement.get())->GetWhereClause());
+    };
+
+    // Compiled and interpreted evaluation return the same values and errors
+    const std::vector<std::string> expressions = {
+        "id", "id + 1", "id * 2 - price", "price / 2", "id > 5",
+        "5 > id", "id = 3 OR price >= 20", "id < 10 AND name = 'odd'",
+        "NOT (id > 2)", "-id < -5", "name", "1 + 2 * 3 < id",
+        "id > 3 AND missing = 1", "missing = 1 OR id > 3", "name > 1",
+        "id / 0", "id / (1 - 1) > 1", "0 AND missing", "1 OR missing"};
+    ExpressionEvaluator evaluator(&schema);
+    for (const auto& text : expressions) {
+        auto expr = parse(text);
+        CompiledExpression compiled =
+            CompiledExpression::Compile(expr.get(), &schema);
+        for (const auto& tuple : tuples) {
+            std::string expected_error;
+            std::string actual_error;
+            Value expected;
+            Value actual;
+            try {
+                expected = evaluator.Evaluate(expr.get(), tuple);
+            } catch (const std::exception& e) {
+                expected_error = e.what();
+            }
+            try {
+                actual = compiled.Evaluate(tuple);
+            } catch (const std::exception& e) {
+                actual_error = e.what();
+            }
+            assert(expected_error == actual_error);
+            assert(!expected_error.empty() || expected == actual);
+        }
+    }
+
+    // The expression tree is not needed after compiling
+    CompiledExpression compiled =
+        CompiledExpression::Compile(parse("price >= 4.5").get(), &schema);
+    assert(!compiled.IsConstant());
+    assert(!compiled.EvaluateAsBoolean(tuples[2]));
+    assert(compiled.EvaluateAsBoolean(tuples[3]));
+
+    // Constant sub-expressions are folded at compile time
+    compiled = CompiledExpression::Compile(parse("1 + 2 * 3").get(), &schema);
+    assert(compiled.IsConstant());
+    assert(std::get<int32_t>(compiled.GetConstantValue()) == 7);
+    assert(CompiledExpression::Compile(parse("0 AND id > 1").get(), &schema)
+               .IsConstant());
+    assert(CompiledExpression::Compile(parse("2 > 1 OR missing").get(),
+                                       &schema)
+               .IsConstant());
+    assert(!CompiledExpression::Compile(parse("1 AND id > 1").get(), &schema)
+                .IsConstant());
+    // Errors in constants are reported when the row is evaluated
+    compiled = CompiledExpression::Compile(parse("1 / 0").get(), &schema);
+    assert(!compiled.IsConstant());
+    bool threw = false;
+    try {
+        compiled.Evaluate(tuples[0]);
+    } catch (const ExecutionException&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(!CompiledExpression::Compile(nullptr, &schema).IsConstant());
+
+    // An always-false WHERE clause returns nothing without reading the table
+    const std::string db_name = "test_compiled_expression.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            16, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(16));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE t (id INT, price DOUBLE, name VARCHAR(16));");
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO t VALUES (1, 1.5, 'a'), (2, 3.0, 'b'), "
+                 "(3, 4.5, 'c');");
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM t WHERE 1 = 0;")
+                   .empty());
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM t WHERE 1 = 1 AND id > 1;")
+                   .size() == 2);
+        auto rows = RunQuery(&engine, &txn_manager,
+                             "SELECT name, id FROM t WHERE price * 2 > 5;");
+        assert(rows.size() == 2);
+        assert(std::get<std::string>(rows[0].GetValue(0)) == "b");
+        assert(std::get<int32_t>(rows[1].GetValue(1)) == 3);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Compiled expression test passed!" << std::endl;
+}
+
+void TestRowFormat() {
+    std::cout << "Testing Row Format..." << std::endl;
+
+    // Every column sits at an offset computed from the schema:
+    // version byte, null bitmap, fixed values and VARCHAR entries
+    Schema schema({{"id", TypeId::INTEGER, 0, false, false},
+                   {"name", TypeId::VARCHAR, 32, true, false},
+                   {"flag", TypeId::BOOLEAN, 0, true, false},
+                   {"score", TypeId::DOUBLE, 0, true, false},
+                   {"note", TypeId::VARCHAR, 32, true, false},
+                   {"a", TypeId::SMALLINT, 0, true, false},
+                   {"b", TypeId::TINYINT, 0, true, false},
+                   {"c", TypeId::FLOAT, 0, true, false},
+                   {"d", TypeId::BIGINT, 0, true, false}});
+    assert(schema.GetNullBitmapSize() == 2);
+    assert(schema.GetColumnOffset(0) == 3);
+    assert(schema.GetColumnOffset(1) == 3 + sizeof(int32_t));
+    assert(schema.GetColumnOffset(2) == 7 + Schema::VAR_ENTRY_SIZE);
+    assert(schema.GetColumnOffset(8) == schema.GetVarDataOffset() -
+                                            sizeof(int64_t));
+
+    Tuple tuple({Value(int32_t(-5)), Value(std::string("first")), Value(true),
+                 Value(0.25), Value(std::string("second")),
+                 Value(int16_t(300)), Value(int8_t(-3)), Value(1.5f),
+                 Value(-(int64_t(1) << 50))},
+                &schema);
+    assert(tuple.GetSerializedSize() == schema.GetVarDataOffset() + 11);
+    std::vector<char> data(tuple.GetSerializedSize());
+    tuple.SerializeTo(data.data());
+    assert(static_cast<uint8_t>(data[0]) == ROW_FORMAT_VERSION);
+    int32_t id = 0;
+    std::memcpy(&id, data.data() + schema.GetColumnOffset(0), sizeof(id));
+    assert(id == -5);
+    uint16_t entry[2];
+    std::memcpy(entry, data.data() + schema.GetColumnOffset(4), sizeof(entry));
+    assert(std::string(data.data() + entry[0], entry[1]) == "second");
+
+    Tuple copy;
+    copy.DeserializeFrom(data.data(), &schema);
+    assert(copy.GetValues() == tuple.GetValues());
+    assert(copy.GetSerializedSize() == tuple.GetSerializedSize());
+    for (size_t i = 0; i < schema.GetColumnCount(); i++) {
+        assert(!copy.IsNull(i));
+    }
+
+    // NULL columns round-trip through the bitmap and store no string bytes
+    tuple.SetNull(1, true);
+    tuple.SetNull(8, true);
+    assert(tuple.IsNull(1) && tuple.IsNull(8) && !tuple.IsNull(0));
+    assert(std::get<std::string>(tuple.GetValue(1)).empty());
+    assert(std::get<int64_t>(tuple.GetValue(8)) == 0);
+    assert(tuple.GetSerializedSize() == schema.GetVarDataOffset() + 6);
+    data.assign(tuple.GetSerializedSize(), 0);
+    tuple.SerializeTo(data.data());
+    copy.DeserializeFrom(data.data(), &schema);
+    assert(copy.GetValues() == tuple.GetValues());
+    for (size_t i = 0; i < schema.GetColumnCount(); i++) {
+        assert(copy.IsNull(i) == (i == 1 || i == 8));
+    }
+    TupleView view(data.data(), data.size(), &schema, RID{1, 2});
+    assert(view.IsNull(8) && !view.IsNull(4));
+    assert(std::get<std::string>(view.GetValue(4)) == "second");
+    tuple.SetNull(8, false);
+    assert(!tuple.IsNull(8));
+
+    // Rows with an unknown format version are rejected
+    data[0] = static_cast<char>(ROW_FORMAT_VERSION + 1);
+    copy.DeserializeFrom(data.data(), &schema);
+    assert(copy.GetValues().empty());
+    bool threw = false;
+    try {
+        view.GetValue(0);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Row format test passed!" << std::endl;
+}
+
+void TestTupleView() {
+    std::cout << "Testing Tuple View..." << std::endl;
+
+    Schema schema({{"id", TypeId::INTEGER, 0, false, false},
+                   {"flag", TypeId::BOOLEAN, 0, false, false},
+                   {"name", TypeId::VARCHAR, 32, false, false},
+                   {"score", TypeId::DOUBLE, 0, false, false},
+                   {"note", TypeId::VARCHAR, 32, false, false},
+                   {"total", TypeId::BIGINT, 0, false, false}});
+
+    // Each column decodes to the same value as a full deserialize,
+    // in any order
+    Tuple tuple({Value(int32_t(7)), Value(true), Value(std::string("alice")),
+                 Value(2.5), Value(std::string("")), Value(int64_t(1) << 40)},
+                &schema);
+    std::vector<char> data(tuple.GetSerializedSize());
+    tuple.SerializeTo(data.data());
+    TupleView view(data.data(), data.size(), &schema, RID{3, 4});
+    assert(std::get<int64_t>(view.GetValue(5)) == int64_t(1) << 40);
+    assert(std::get<std::string>(view.GetValue(2)) == "alice");
+    for (size_t i = 0; i < schema.GetColumnCount(); i++) {
+        assert(view.GetValue(i) == tuple.GetValue(i));
+    }
+    Tuple copy = view.ToTuple();
+    assert(copy.GetValues() == tuple.GetValues());
+    assert(copy.GetRID() == (RID{3, 4}));
+    bool threw = false;
+    try {
+        view.GetValue(schema.GetColumnCount());
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Data past the end of the tuple is reported instead of being read
+    TupleView truncated(data.data(), data.size() - 1, &schema, RID{3, 4});
+    assert(std::get<int32_t>(truncated.GetValue(0)) == 7);
+    threw = false;
+    try {
+        truncated.GetValue(2);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Compiled predicates give the same answer on views and tuples
+    auto parse = [](const std::string& condition) {
+        Parser parser("SELECT * FROM t WHERE " + condition + ";");
+        auto statement = parser.Parse();
+        return ExpressionCloner::Clone(
+            static_cast<SelectStatement*>(statement.get())->GetWhereClause());
+    };
+    for (const std::string text :
+         {"total > 5 AND name = 'alice'", "7 = id", "score * 2 < 5",
+          "note = ''", "missing = 1"}) {
+        CompiledExpression compiled =
+            CompiledExpression::Compile(parse(text).get(), &schema);
+        std::string tuple_error;
+        std::string view_error;
+        bool tuple_result = false;
+        bool view_result = false;
+        try {
+            tuple_result = compiled.EvaluateAsBoolean(tuple);
+        } catch (const std::exception& e) {
+            tuple_error = e.what();
+        }
+        try {
+            view_result = compiled.EvaluateAsBoolean(view);
+        } catch (const std::exception& e) {
+            view_error = e.what();
+        }
+        assert(tuple_error == view_error && tuple_result == view_result);
+    }
+
+    // Table scans read through views of the pinned pages
+    const std::string db_name = "test_tuple_view.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            16, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(16));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE t (id INT, name VARCHAR(16), score DOUBLE, "
+                 "note VARCHAR(16));");
+        const int num_rows = static_cast<int>(PAGE_SIZE / 16);
+        std::string insert_sql = "INSERT INTO t VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) +
+                          ", 'n" + std::to_string(i) + "', " +
+                          std::to_string(i % 10) + ".5, 'x')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+
+        TableHeap* table_heap = catalog.GetTable("t")->table_heap.get();
+        auto it = table_heap->Begin();
+        Tuple expected = *it;
+        std::string name;
+        assert(it.ReadCurrent([&name](const TupleView& current) {
+            name = std::get<std::string>(current.GetValue(1));
+        }));
+        assert(name == std::get<std::string>(expected.GetValue(1)));
+        RID deleted = it.GetRID();
+        Transaction* txn = txn_manager.Begin();
+        assert(table_heap->DeleteTuple(deleted, txn->GetTxnId()));
+        txn_manager.Commit(txn);
+        assert(!table_heap->ReadTuple(deleted, [](const TupleView&) {
+            assert(false);
+        }));
+
+        auto rows = RunQuery(&engine, &txn_manager,
+                             "SELECT note, id FROM t WHERE score > 9;");
+        assert(rows.size() == static_cast<size_t>(num_rows / 10));
+        for (const auto& row : rows) {
+            assert(std::get<std::string>(row.GetValue(0)) == "x");
+            assert(std::get<int32_t>(row.GetValue(1)) % 10 == 9);
+        }
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM t WHERE name = 'n5';");
+        assert(rows.size() == 1);
+        assert(std::get<double>(rows[0].GetValue(2)) == 5.5);
+        assert(std::get<std::string>(rows[0].GetValue(3)) == "x");
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Tuple view test passed!" << std::endl;
+}
+
+void TestHashJoin() {
+    std::cout << "Testing Hash Join..." << std::endl;
+
+    const std::string db_name = "test_hash_join.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        // No index on either join column, so the planner picks a hash join
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE users (id INT, name VARCHAR(16));");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE orders (id INT PRIMARY KEY, user_id INT, "
+                 "amount INT);");
+        const int num_users = 50;
+        const int num_orders = static_cast<int>(PAGE_SIZE / 8);
+        std::string insert_sql = "INSERT INTO users VALUES ";
+        for (int i = 0; i < num_users; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) +
+                          ", 'u" + std::to_string(i) + "')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        // Users 50..59 do not exist, so some orders have no match
+        insert_sql = "INSERT INTO orders VALUES ";
+        for (int i = 0; i < num_orders; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                          std::to_string(i % 60) + ", " +
+                          std::to_string(i % 7) + ")";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+
+        auto expected_pairs = [&](int min_amount) {
+            std::vector<std::pair<int32_t, int32_t>> pairs;
+            for (int i = 0; i < num_orders; i++) {
+                if (i % 60 < num_users && i % 7 > min_amount) {
+                    pairs.emplace_back(i, i % 60);
+                }
+            }
+            return pairs;
+        };
+        auto sorted = [](std::vector<std::pair<int32_t, int32_t>> pairs) {
+            std::sort(pairs.begin(), pairs.end());
+            return pairs;
+        };
+
+        // SELECT * returns the left columns followed by the right columns
+        auto rows = RunQuery(&engine, &txn_manager,
+                             "SELECT * FROM orders INNER JOIN users "
+                             "ON user_id = users.id;");
+        std::vector<std::pair<int32_t, int32_t>> pairs;
+        for (const auto& row : rows) {
+            assert(row.GetValues().size() == 5);
+            assert(row.GetValue(1) == row.GetValue(3));
+            assert(std::get<std::string>(row.GetValue(4)) ==
+                   "u" + std::to_string(std::get<int32_t>(row.GetValue(3))));
+            pairs.emplace_back(std::get<int32_t>(row.GetValue(0)),
+                               std::get<int32_t>(row.GetValue(3)));
+        }
+        assert(sorted(pairs) == expected_pairs(-1));
+
+        // Projection, a pushed-down filter and a residual condition
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT orders.id, users.id, name FROM users JOIN "
+                        "orders ON users.id = orders.user_id WHERE amount > 3 "
+                        "AND orders.id + users.id > 0;");
+        pairs.clear();
+        for (const auto& row : rows) {
+            assert(row.GetValues().size() == 3);
+            pairs.emplace_back(std::get<int32_t>(row.GetValue(0)),
+                               std::get<int32_t>(row.GetValue(1)));
+        }
+        auto expected = expected_pairs(3);
+        expected.erase(std::remove(expected.begin(), expected.end(),
+                                   std::make_pair(0, 0)),
+                       expected.end());
+        assert(sorted(pairs) == expected);
+
+        auto plan = RunQuery(&engine, &txn_manager,
+                             "EXPLAIN SELECT name FROM users JOIN orders ON "
+                             "users.id = orders.user_id WHERE amount > 3;");
+        std::string plan_text;
+        for (const auto& line : plan) {
+            plan_text += std::get<std::string>(line.GetValue(0)) + "\n";
+        }
+        assert(plan_text.find("Hash Join") != std::string::npos);
+        assert(plan_text.find("users.id = orders.user_id") !=
+               std::string::npos);
+
+        // Unresolvable joins are rejected
+        for (const std::string sql :
+             {"SELECT * FROM users JOIN orders ON users.id > orders.user_id;",
+              "SELECT id FROM users JOIN orders ON users.id = user_id;",
+              "SELECT * FROM users JOIN missing ON users.id = missing.id;"}) {
+            Parser parser(sql);
+            auto statement = parser.Parse();
+            Transaction* txn = txn_manager.Begin();
+            std::vector<Tuple> result;
+            assert(!engine.Execute(statement.get(), &result, txn));
+            txn_manager.Commit(txn);
+        }
+
+        // A tiny memory budget spills both inputs to temp pages and
+        // produces the same result
+        TableInfo* users = catalog.GetTable("users");
+        TableInfo* orders = catalog.GetTable("orders");
+        std::vector<Column> columns = users->schema->GetColumns();
+        for (const auto& column : orders->schema->GetColumns()) {
+            columns.push_back(column);
+            columns.back().name = "orders." + column.name;
+        }
+        columns[0].name = "users.id";
+        columns[1].name = "users.name";
+        for (size_t budget : {size_t(1), size_t(1) << 20}) {
+            auto join_plan = std::make_unique<HashJoinPlanNode>(
+                std::make_unique<Schema>(columns),
+                std::make_unique<SeqScanPlanNode>(users->schema.get(),
+                                                  "users"),
+                std::make_unique<SeqScanPlanNode>(orders->schema.get(),
+                                                  "orders"),
+                std::make_unique<ColumnRefExpression>("", "id"),
+                std::make_unique<ColumnRefExpression>("", "user_id"));
+            join_plan->SetMemoryBudget(budget);
+            Transaction* txn = txn_manager.Begin();
+            ExecutorContext exec_ctx(txn, &catalog, bpm.get(), nullptr);
+            HashJoinExecutor executor(&exec_ctx, std::move(join_plan));
+            executor.Init();
+            assert(executor.IsSpilled() == (budget == 1));
+            if (budget != 1) {
+                // Users run out first, so they are the build side
+                assert(executor.IsBuildLeft());
+            }
+            pairs.clear();
+            Tuple tuple;
+            RID rid;
+            while (executor.Next(&tuple, &rid)) {
+                pairs.emplace_back(std::get<int32_t>(tuple.GetValue(2)),
+                                   std::get<int32_t>(tuple.GetValue(0)));
+            }
+            assert(sorted(pairs) == expected_pairs(-1));
+            txn_manager.Commit(txn);
+        }
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Hash Join tests passed!" << std::endl;
+}
+
+void TestIndexNestedLoopJoin() {
+    std::cout << "Testing Index Nested Loop Join..." << std::endl;
+
+    const std::string db_name = "test_index_join.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE customers (id INT PRIMARY KEY, "
+                 "name VARCHAR(16));");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE orders (id INT PRIMARY KEY, customer_id INT, "
+                 "amount INT);");
+        const int num_customers = static_cast<int>(PAGE_SIZE / 16);
+        const int num_orders = 200;
+        std::string insert_sql = "INSERT INTO customers VALUES ";
+        for (int i = 0; i < num_customers; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) +
+                          ", 'c" + std::to_string(i) + "')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        // Some orders point at customers that do not exist
+        auto customer_of = [&](int order) {
+            return (order * 7) % (num_customers + 20);
+        };
+        insert_sql = "INSERT INTO orders VALUES ";
+        for (int i = 0; i < num_orders; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                          std::to_string(customer_of(i)) + ", " +
+                          std::to_string(i % 5) + ")";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+
+        using Pairs = std::vector<std::pair<int32_t, int32_t>>;
+        auto expected_pairs = [&](int min_amount, int max_customer) {
+            Pairs pairs;
+            for (int i = 0; i < num_orders; i++) {
+                if (customer_of(i) < std::min(num_customers, max_customer) &&
+                    i % 5 > min_amount) {
+                    pairs.emplace_back(i, customer_of(i));
+                }
+            }
+            std::sort(pairs.begin(), pairs.end());
+            return pairs;
+        };
+        auto plan_text = [&](const std::string& sql) {
+            std::string text;
+            for (const auto& line :
+                 RunQuery(&engine, &txn_manager, "EXPLAIN " + sql)) {
+                text += std::get<std::string>(line.GetValue(0)) + "\n";
+            }
+            return text;
+        };
+
+        // Orders drive the join and probe the customers primary key
+        std::string sql =
+            "SELECT orders.id, customers.id, name FROM orders JOIN customers "
+            "ON orders.customer_id = customers.id WHERE amount > 2;";
+        std::string text = plan_text(sql);
+        assert(text.find("Index Nested Loop Join") != std::string::npos);
+        assert(text.find("Seq Scan on orders") != std::string::npos);
+        assert(text.find("Seq Scan on customers") == std::string::npos);
+        Pairs pairs;
+        for (const auto& row : RunQuery(&engine, &txn_manager, sql)) {
+            assert(std::get<std::string>(row.GetValue(2)) ==
+                   "c" + std::to_string(std::get<int32_t>(row.GetValue(1))));
+            pairs.emplace_back(std::get<int32_t>(row.GetValue(0)),
+                               std::get<int32_t>(row.GetValue(1)));
+        }
+        std::sort(pairs.begin(), pairs.end());
+        assert(pairs == expected_pairs(2, num_customers));
+
+        // Only the left join column is indexed: orders become the outer
+        // side, the output still starts with the customers columns
+        sql = "SELECT * FROM customers JOIN orders "
+              "ON customers.id = orders.customer_id;";
+        assert(plan_text(sql).find("Index Nested Loop Join") !=
+               std::string::npos);
+        pairs.clear();
+        for (const auto& row : RunQuery(&engine, &txn_manager, sql)) {
+            assert(row.GetValues().size() == 5);
+            assert(row.GetValue(0) == row.GetValue(3));
+            pairs.emplace_back(std::get<int32_t>(row.GetValue(2)),
+                               std::get<int32_t>(row.GetValue(0)));
+        }
+        std::sort(pairs.begin(), pairs.end());
+        assert(pairs == expected_pairs(-1, num_customers));
+
+        // A non-unique index on the right join column returns every
+        // matching order; filters on the inner table still apply
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX orders_customer ON orders (customer_id);");
+        sql = "SELECT orders.id, customers.id FROM customers JOIN orders "
+              "ON customers.id = orders.customer_id "
+              "WHERE customers.id < 100 AND orders.amount > 1;";
+        text = plan_text(sql);
+        assert(text.find("orders_customer") != std::string::npos);
+        assert(text.find("Seq Scan on customers") != std::string::npos);
+        pairs.clear();
+        for (const auto& row : RunQuery(&engine, &txn_manager, sql)) {
+            pairs.emplace_back(std::get<int32_t>(row.GetValue(0)),
+                               std::get<int32_t>(row.GetValue(1)));
+        }
+        std::sort(pairs.begin(), pairs.end());
+        assert(pairs == expected_pairs(1, 100));
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Index Nested Loop Join tests passed!" << std::endl;
+}
+
+void TestHashAggregation() {
+    std::cout << "Testing Hash Aggregation..." << std::endl;
+
+    const std::string db_name = "test_hash_aggregation.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE sales (id INT PRIMARY KEY, region VARCHAR(16), "
+                 "qty INT, price DOUBLE);");
+        const int num_rows = static_cast<int>(PAGE_SIZE / 8);
+        std::string insert_sql = "INSERT INTO sales VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", 'r" +
+                          std::to_string(i % 5) + "', " +
+                          std::to_string(i % 11) + ", " +
+                          std::to_string(i % 3) + ".5)";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+
+        struct Group {
+            int64_t count = 0;
+            int64_t qty_sum = 0;
+            int32_t qty_min = 1 << 30;
+            int32_t qty_max = -1;
+            double price_sum = 0;
+        };
+        std::map<std::string, Group> expected;
+        for (int i = 0; i < num_rows; i++) {
+            Group& group = expected["r" + std::to_string(i % 5)];
+            group.count++;
+            group.qty_sum += i % 11;
+            group.qty_min = std::min(group.qty_min, i % 11);
+            group.qty_max = std::max(group.qty_max, i % 11);
+            group.price_sum += i % 3 + 0.5;
+        }
+
+        // One output row per region, columns in SELECT order
+        auto rows = RunQuery(&engine, &txn_manager,
+                             "SELECT region, COUNT(*), SUM(qty), MIN(qty), "
+                             "MAX(qty), AVG(price) FROM sales GROUP BY "
+                             "region;");
+        assert(rows.size() == expected.size());
+        for (const auto& row : rows) {
+            const Group& group =
+                expected.at(std::get<std::string>(row.GetValue(0)));
+            assert(std::get<int64_t>(row.GetValue(1)) == group.count);
+            assert(std::get<int64_t>(row.GetValue(2)) == group.qty_sum);
+            assert(std::get<int32_t>(row.GetValue(3)) == group.qty_min);
+            assert(std::get<int32_t>(row.GetValue(4)) == group.qty_max);
+            assert(std::fabs(std::get<double>(row.GetValue(5)) -
+                             group.price_sum / group.count) < 1e-9);
+        }
+
+        // Without GROUP BY the whole filtered input is one group
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT MAX(region), COUNT(qty), SUM(price) FROM "
+                        "sales WHERE qty > 5;");
+        assert(rows.size() == 1);
+        int64_t filtered = 0;
+        double filtered_price = 0;
+        for (int i = 0; i < num_rows; i++) {
+            if (i % 11 > 5) {
+                filtered++;
+                filtered_price += i % 3 + 0.5;
+            }
+        }
+        assert(std::get<std::string>(rows[0].GetValue(0)) == "r4");
+        assert(std::get<int64_t>(rows[0].GetValue(1)) == filtered);
+        assert(std::fabs(std::get<double>(rows[0].GetValue(2)) -
+                         filtered_price) < 1e-9);
+
+        // Empty input: one row with COUNT 0 and NULL for the rest, but no
+        // rows at all when grouping
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT COUNT(*), SUM(qty) FROM sales WHERE qty > "
+                        "100;");
+        assert(rows.size() == 1);
+        assert(std::get<int64_t>(rows[0].GetValue(0)) == 0);
+        assert(rows[0].IsNull(1));
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT region, COUNT(*) FROM sales WHERE qty > 100 "
+                        "GROUP BY region;");
+        assert(rows.empty());
+
+        // Grouping by a column that is not selected, and by an expression
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT COUNT(*) FROM sales GROUP BY qty;");
+        assert(rows.size() == 11);
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT qty + 1, COUNT(*) FROM sales GROUP BY qty + "
+                        "1;");
+        assert(rows.size() == 11);
+        for (const auto& row : rows) {
+            int64_t key = std::get<int64_t>(row.GetValue(0)) - 1;
+            assert(std::get<int64_t>(row.GetValue(1)) ==
+                   (num_rows - key + 10) / 11);
+        }
+
+        auto plan = RunQuery(&engine, &txn_manager,
+                             "EXPLAIN SELECT region, COUNT(*) FROM sales "
+                             "GROUP BY region;");
+        std::string plan_text;
+        for (const auto& line : plan) {
+            plan_text += std::get<std::string>(line.GetValue(0)) + "\n";
+        }
+        assert(plan_text.find("Aggregation (Group Key: region)") !=
+               std::string::npos);
+        assert(plan_text.find("Seq Scan on sales") != std::string::npos);
+
+        // Aggregation over a join groups by the qualified column
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE regions (name VARCHAR(16), manager "
+                 "VARCHAR(16));");
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO regions VALUES ('r0', 'm0'), ('r1', 'm1'), "
+                 "('r2', 'm0'), ('r3', 'm1'), ('r4', 'm0');");
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT manager, COUNT(*), SUM(qty) FROM sales JOIN "
+                        "regions ON region = name GROUP BY manager;");
+        assert(rows.size() == 2);
+        for (const auto& row : rows) {
+            bool m0 = std::get<std::string>(row.GetValue(0)) == "m0";
+            int64_t count = 0;
+            int64_t qty_sum = 0;
+            for (const auto& entry : expected) {
+                int region = entry.first[1] - '0';
+                if ((region % 2 == 0) == m0) {
+                    count += entry.second.count;
+                    qty_sum += entry.second.qty_sum;
+                }
+            }
+            assert(std::get<int64_t>(row.GetValue(1)) == count);
+            assert(std::get<int64_t>(row.GetValue(2)) == qty_sum);
+        }
+
+        // Invalid aggregate queries are rejected
+        for (const std::string sql :
+             {"SELECT id, COUNT(*) FROM sales GROUP BY region;",
+              "SELECT * FROM sales GROUP BY region;",
+              "SELECT SUM(region) FROM sales;",
+              "SELECT COUNT(*) + 1 FROM sales;",
+              "SELECT SUM(COUNT(*)) FROM sales;",
+              "SELECT LENGTH(region) FROM sales;",
+              "SELECT id FROM sales WHERE COUNT(*) > 1;"}) {
+            Parser parser(sql);
+            auto statement = parser.Parse();
+            Transaction* txn = txn_manager.Begin();
+            std::vector<Tuple> result;
+            assert(!engine.Execute(statement.get(), &result, txn));
+            txn_manager.Commit(txn);
+        }
+
+        // A tiny memory budget spills partial groups to temp pages and
+        // still produces one row per group
+        TableInfo* sales = catalog.GetTable("sales");
+        for (size_t budget : {size_t(1), size_t(1) << 20}) {
+            std::vector<std::unique_ptr<Expression>> group_by;
+            group_by.push_back(std::make_unique<ColumnRefExpression>("", "id"));
+            std::vector<AggregationPlanNode::Aggregate> aggregates;
+            aggregates.push_back({AggregateType::COUNT_STAR, nullptr});
+            aggregates.push_back(
+                {AggregateType::SUM,
+                 std::make_unique<ColumnRefExpression>("", "qty")});
+            auto aggregation_plan = std::make_unique<AggregationPlanNode>(
+                std::make_unique<Schema>(std::vector<Column>{
+                    {"id", TypeId::INTEGER, 0, true, false},
+                    {"COUNT(*)", TypeId::BIGINT, 0, true, false},
+                    {"SUM(qty)", TypeId::BIGINT, 0, true, false}}),
+                std::make_unique<SeqScanPlanNode>(sales->schema.get(),
+                                                  "sales"),
+                std::move(group_by), std::move(aggregates),
+                std::vector<AggregationPlanNode::OutputColumn>{
+                    {false, 0}, {true, 0}, {true, 1}});
+            aggregation_plan->SetMemoryBudget(budget);
+            Transaction* txn = txn_manager.Begin();
+            ExecutorContext exec_ctx(txn, &catalog, bpm.get(), nullptr);
+            HashAggregationExecutor executor(&exec_ctx,
+                                             std::move(aggregation_plan));
+            executor.Init();
+            assert(executor.IsSpilled() == (budget == 1));
+            std::vector<bool> seen(num_rows, false);
+            Tuple tuple;
+            RID rid;
+            while (executor.Next(&tuple, &rid)) {
+                int32_t id = std::get<int32_t>(tuple.GetValue(0));
+                assert(!seen[id]);
+                seen[id] = true;
+                assert(std::get<int64_t>(tuple.GetValue(1)) == 1);
+                assert(std::get<int64_t>(tuple.GetValue(2)) == id % 11);
+            }
+            assert(std::count(seen.begin(), seen.end(), true) == num_rows);
+            txn_manager.Commit(txn);
+        }
+    }
+    std::remove(db_name.c_str());
+
+    // Two tables fed disjoint halves and merged through their partial
+    // results match one table fed everything; NULL arguments are skipped
+    Schema key_schema({{"k", TypeId::INTEGER, 0, true, false}});
+    std::vector<AggregationHashTable::Aggregate> aggregates = {
+        {AggregateType::COUNT_STAR, TypeId::BIGINT},
+        {AggregateType::COUNT, TypeId::INTEGER},
+        {AggregateType::AVG, TypeId::INTEGER},
+        {AggregateType::MIN, TypeId::VARCHAR},
+        {AggregateType::MAX, TypeId::DOUBLE}};
+    AggregationHashTable whole(&key_schema, aggregates);
+    AggregationHashTable halves[2] = {
+        AggregationHashTable(&key_schema, aggregates),
+        AggregationHashTable(&key_schema, aggregates)};
+    for (int i = 0; i < 200; i++) {
+        std::vector<Value> key = {Value(int32_t(i % 7))};
+        std::vector<bool> key_nulls = {i % 13 == 0};
+        Value number = int32_t(i);
+        Value text = "s" + std::to_string(1000 - i);
+        Value real = double(i) / 4;
+        const Value* number_arg = i % 5 == 0 ? nullptr : &number;
+        std::vector<const Value*> arguments = {nullptr, number_arg,
+                                               number_arg, &text, &real};
+        whole.Accumulate(key, key_nulls, arguments);
+        halves[i % 2].Accumulate(key, key_nulls, arguments);
+    }
+    AggregationHashTable merged(&key_schema, aggregates);
+    for (auto& half : halves) {
+        half.ForEachPartial([&merged](uint64_t, const Tuple& partial) {
+            merged.MergePartial(partial);
+        });
+    }
+    using Result = std::pair<std::vector<Value>, std::vector<bool>>;
+    auto collect = [](const AggregationHashTable& table) {
+        std::map<int32_t, Result> results;
+        table.ForEachResult([&results](const Tuple& key,
+                                       const std::vector<Value>& values,
+                                       const std::vector<bool>& nulls) {
+            int32_t k = key.IsNull(0) ? -1 : std::get<int32_t>(key.GetValue(0));
+            assert(results.count(k) == 0);
+            results[k] = {values, nulls};
+        });
+        return results;
+    };
+    auto expected = collect(whole);
+    assert(expected.size() == 8);  // seven keys plus NULL
+    assert(collect(merged) == expected);
+    int64_t total = 0;
+    for (const auto& entry : expected) {
+        total += std::get<int64_t>(entry.second.first[0]);
+        assert(std::get<int64_t>(entry.second.first[1]) <=
+               std::get<int64_t>(entry.second.first[0]));
+    }
+    assert(total == 200);
+
+    std::cout << "Hash Aggregation tests passed!" << std::endl;
+}
+
+void TestExternalSort() {
+    std::cout << "Testing External Sort..." << std::endl;
+
+    const std::string db_name = "test_external_sort.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE events (id INT PRIMARY KEY, created_at INT, "
+                 "name VARCHAR(16));");
+        const int num_rows = static_cast<int>(PAGE_SIZE / 8);
+        std::string insert_sql = "INSERT INTO events VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                          std::to_string(i * 37 % 101) + ", 'n" +
+                          std::to_string(i % 7) + "')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+
+        // Expected order of ORDER BY created_at DESC, id
+        std::vector<int> expected(num_rows);
+        for (int i = 0; i < num_rows; i++) {
+            expected[i] = i;
+        }
+        std::sort(expected.begin(), expected.end(), [](int a, int b) {
+            return a * 37 % 101 != b * 37 % 101 ? a * 37 % 101 > b * 37 % 101
+                                                : a < b;
+        });
+
+        auto rows = RunQuery(&engine, &txn_manager,
+                             "SELECT * FROM events ORDER BY created_at DESC, "
+                             "id;");
+        assert(rows.size() == static_cast<size_t>(num_rows));
+        for (int i = 0; i < num_rows; i++) {
+            assert(std::get<int32_t>(rows[i].GetValue(0)) == expected[i]);
+        }
+
+        // The sort runs below the projection, so the key need not be selected
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT name FROM events ORDER BY id DESC;");
+        assert(rows.size() == static_cast<size_t>(num_rows));
+        for (int i = 0; i < num_rows; i++) {
+            assert(std::get<std::string>(rows[i].GetValue(0)) ==
+                   "n" + std::to_string((num_rows - 1 - i) % 7));
+        }
+
+        // ORDER BY with LIMIT returns the first rows of the full order
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT id, created_at FROM events ORDER BY "
+                        "created_at DESC, id ASC LIMIT 50;");
+        assert(rows.size() == 50);
+        for (int i = 0; i < 50; i++) {
+            assert(std::get<int32_t>(rows[i].GetValue(0)) == expected[i]);
+        }
+        rows = RunQuery(&engine, &txn_manager, "SELECT id FROM events LIMIT 5;");
+        assert(rows.size() == 5);
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM events ORDER BY id LIMIT 0;");
+        assert(rows.empty());
+
+        // Aggregate queries sort on their output columns
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT name, COUNT(*) FROM events GROUP BY name "
+                        "ORDER BY COUNT(*) DESC, name LIMIT 3;");
+        assert(rows.size() == 3);
+        for (int i = 0; i < 3; i++) {
+            // The first num_rows % 7 names get one extra row, ties by name
+            assert(std::get<std::string>(rows[i].GetValue(0)) ==
+                   "n" + std::to_string(i));
+            assert(std::get<int64_t>(rows[i].GetValue(1)) ==
+                   num_rows / 7 + (i < num_rows % 7 ? 1 : 0));
+        }
+
+        // Sorting a join on a column of the other table
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE labels (name VARCHAR(16), label INT);");
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO labels VALUES ('n0', 0), ('n1', 1), ('n2', 2), "
+                 "('n3', 3), ('n4', 4), ('n5', 5), ('n6', 6);");
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT events.id, label FROM events JOIN labels ON "
+                        "events.name = labels.name ORDER BY label DESC, "
+                        "events.id LIMIT 10;");
+        assert(rows.size() == 10);
+        for (int i = 0; i < 10; i++) {
+            assert(std::get<int32_t>(rows[i].GetValue(0)) == 6 + 7 * i);
+            assert(std::get<int32_t>(rows[i].GetValue(1)) == 6);
+        }
+
+        auto plan = RunQuery(&engine, &txn_manager,
+                             "EXPLAIN SELECT id FROM events ORDER BY "
+                             "created_at DESC LIMIT 50;");
+        std::string plan_text;
+        for (const auto& line : plan) {
+            plan_text += std::get<std::string>(line.GetValue(0)) + "\n";
+        }
+        assert(plan_text.find("Sort (Sort Key: created_at DESC) (Top-N: 50)") !=
+               std::string::npos);
+        plan = RunQuery(&engine, &txn_manager,
+                        "EXPLAIN SELECT id FROM events LIMIT 5;");
+        plan_text.clear();
+        for (const auto& line : plan) {
+            plan_text += std::get<std::string>(line.GetValue(0)) + "\n";
+        }
+        assert(plan_text.find("Limit (5 rows)") != std::string::npos);
+
+        // Invalid ORDER BY items are rejected
+        for (const std::string sql :
+             {"SELECT id FROM events ORDER BY missing;",
+              "SELECT id FROM events ORDER BY COUNT(*);",
+              "SELECT name, COUNT(*) FROM events GROUP BY name ORDER BY id;"}) {
+            Parser parser(sql);
+            auto statement = parser.Parse();
+            Transaction* txn = txn_manager.Begin();
+            std::vector<Tuple> result;
+            assert(!engine.Execute(statement.get(), &result, txn));
+            txn_manager.Commit(txn);
+        }
+
+        // A budget of one page writes many sorted runs that merge back into
+        // the same order; a LIMIT whose rows fit uses the Top-N heap, and
+        // one whose rows do not falls back to the external sort
+        TableInfo* events = catalog.GetTable("events");
+        struct Case {
+            size_t budget;
+            int64_t limit;
+            bool top_n;
+            bool spilled;
+        };
+        for (const Case& c : {Case{size_t(1) << 26, -1, false, false},
+                              Case{PAGE_SIZE, -1, false, true},
+                              Case{PAGE_SIZE, 10, true, false},
+                              Case{PAGE_SIZE, num_rows / 2, false, true}}) {
+            std::vector<SortPlanNode::SortKey> keys;
+            keys.push_back(
+                {std::make_unique<ColumnRefExpression>("", "created_at"),
+                 false});
+            keys.push_back(
+                {std::make_unique<ColumnRefExpression>("", "id"), true});
+            auto sort_plan = std::make_unique<SortPlanNode>(
+                std::make_unique<SeqScanPlanNode>(events->schema.get(),
+                                                  "events"),
+                std::move(keys), c.limit);
+            sort_plan->SetMemoryBudget(c.budget);
+            Transaction* txn = txn_manager.Begin();
+            ExecutorContext exec_ctx(txn, &catalog, bpm.get(), nullptr);
+            SortExecutor executor(&exec_ctx, std::move(sort_plan));
+            executor.Init();
+            assert(executor.IsTopN() == c.top_n);
+            assert(executor.IsSpilled() == c.spilled);
+            assert(!c.spilled || executor.GetRunCount() > 2);
+            size_t count = c.limit >= 0 ? c.limit : num_rows;
+            std::vector<int> ids;
+            Tuple tuple;
+            RID rid;
+            while (executor.Next(&tuple, &rid)) {
+                ids.push_back(std::get<int32_t>(tuple.GetValue(0)));
+            }
+            assert(ids.size() == count);
+            assert(std::equal(ids.begin(), ids.end(), expected.begin()));
+            txn_manager.Commit(txn);
+        }
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "External Sort tests passed!" << std::endl;
+}
+
+void TestLimitPushdown() {
+    std::cout << "Testing Limit Pushdown..." << std::endl;
+
+    const std::string db_name = "test_limit_pushdown.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE pages (id INT PRIMARY KEY, kind INT);");
+        const int num_rows = static_cast<int>(PAGE_SIZE / 4);
+        std::string insert_sql = "INSERT INTO pages VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            int id = i * 37 % num_rows;
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(id) + ", " +
+                          std::to_string(id % 3) + ")";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+
+        // Keyset pagination returns the next keys in index order, also when
+        // other conditions reject rows from the first batch
+        auto rows = RunQuery(&engine, &txn_manager,
+                             "SELECT * FROM pages WHERE id > 100 LIMIT 20;");
+        assert(rows.size() == 20);
+        for (int i = 0; i < 20; i++) {
+            assert(std::get<int32_t>(rows[i].GetValue(0)) == 101 + i);
+        }
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT id FROM pages WHERE id >= 0 AND kind = 0 "
+                        "LIMIT 5;");
+        assert(rows.size() == 5);
+        for (int i = 0; i < 5; i++) {
+            assert(std::get<int32_t>(rows[i].GetValue(0)) == 3 * i);
+        }
+        rows = RunQuery(&engine, &txn_manager, "SELECT * FROM pages LIMIT 7;");
+        assert(rows.size() == 7);
+
+        // With a row limit the range scan takes RIDs from the index in
+        // growing batches, and still returns the whole range when drained
+        TableManager table_manager(bpm.get(), &catalog);
+        std::string index_name =
+            catalog.GetTableIndexes("pages")[0]->index_name;
+        TableInfo* pages = catalog.GetTable("pages");
+        for (size_t row_limit : {size_t(10), SIZE_MAX}) {
+            auto range_plan = std::make_unique<IndexRangeScanPlanNode>(
+                pages->schema.get(), "pages", index_name);
+            range_plan->SetLowerBound(Value(int32_t(100)), false);
+            Transaction* txn = txn_manager.Begin();
+            ExecutorContext exec_ctx(txn, &catalog, bpm.get(), &table_manager);
+            IndexRangeScanExecutor executor(&exec_ctx, std::move(range_plan));
+            executor.SetRowLimit(row_limit);
+            executor.Init();
+            size_t range_size = static_cast<size_t>(num_rows - 101);
+            assert(executor.GetCandidateCount() ==
+                   std::min(row_limit, range_size));
+            Tuple tuple;
+            RID rid;
+            int32_t expected = 101;
+            while (executor.Next(&tuple, &rid)) {
+                assert(std::get<int32_t>(tuple.GetValue(0)) == expected);
+                expected++;
+                if (expected == 111) {
+                    assert(executor.GetCandidateCount() ==
+                           std::min(row_limit, range_size));
+                }
+            }
+            assert(expected == num_rows);
+            assert(executor.GetCandidateCount() == range_size);
+            txn_manager.Commit(txn);
+        }
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Limit Pushdown tests passed!" << std::endl;
+}
+
+void TestParallelScan() {
+    std::cout << "Testing Parallel Scan..." << std::endl;
+
+    const std::string db_name = "test_parallel_scan.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            128, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(128));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE facts (id INT, grp INT, amount INT);");
+        const int num_rows = static_cast<int>(PAGE_SIZE / 2);
+        for (int start = 0; start < num_rows; start += 500) {
+            std::string insert_sql = "INSERT INTO facts VALUES ";
+            for (int i = start; i < std::min(num_rows, start + 500); i++) {
+                insert_sql += (i == start ? "(" : ", (") + std::to_string(i) +
+                              ", " + std::to_string(i % 7) + ", " +
+                              std::to_string(i % 100) + ")";
+            }
+            RunQuery(&engine, &txn_manager, insert_sql + ";");
+        }
+
+        auto sorted_ids = [](const std::vector<Tuple>& rows) {
+            std::vector<int32_t> ids;
+            for (const auto& row : rows) {
+                ids.push_back(std::get<int32_t>(row.GetValue(0)));
+            }
+            std::sort(ids.begin(), ids.end());
+            return ids;
+        };
+        const std::vector<std::string> queries = {
+            "SELECT * FROM facts;",
+            "SELECT id, amount FROM facts WHERE grp = 3;",
+            "SELECT id FROM facts WHERE amount < 10 AND grp > 1;",
+        };
+        std::vector<std::vector<int32_t>> serial;
+        for (const auto& sql : queries) {
+            serial.push_back(sorted_ids(RunQuery(&engine, &txn_manager, sql)));
+        }
+        auto serial_count = RunQuery(
+            &engine, &txn_manager,
+            "SELECT grp, COUNT(*), SUM(amount) FROM facts GROUP BY grp "
+            "ORDER BY grp;");
+
+        // Any number of workers returns the same rows as the serial scan,
+        // in some order
+        for (size_t workers : {size_t(2), size_t(4)}) {
+            engine.SetParallelScanWorkers(workers);
+            for (size_t i = 0; i < queries.size(); i++) {
+                auto rows = RunQuery(&engine, &txn_manager, queries[i]);
+                assert(sorted_ids(rows) == serial[i]);
+            }
+            auto counts = RunQuery(
+                &engine, &txn_manager,
+                "SELECT grp, COUNT(*), SUM(amount) FROM facts GROUP BY grp "
+                "ORDER BY grp;");
+            assert(counts.size() == serial_count.size());
+            for (size_t i = 0; i < counts.size(); i++) {
+                for (size_t col = 0; col < 3; col++) {
+                    assert(counts[i].GetValue(col) ==
+                           serial_count[i].GetValue(col));
+                }
+            }
+            auto limited = RunQuery(&engine, &txn_manager,
+                                    "SELECT id FROM facts WHERE grp = 0 "
+                                    "LIMIT 25;");
+            assert(limited.size() == 25);
+            for (const auto& row : limited) {
+                assert(std::get<int32_t>(row.GetValue(0)) % 7 == 0);
+            }
+            auto top = RunQuery(&engine, &txn_manager,
+                                "SELECT id FROM facts ORDER BY id DESC "
+                                "LIMIT 3;");
+            assert(top.size() == 3);
+            assert(std::get<int32_t>(top[0].GetValue(0)) == num_rows - 1);
+            assert(std::get<int32_t>(top[2].GetValue(0)) == num_rows - 3);
+        }
+
+        // EXPLAIN shows the exchange with its worker count
+        auto plan = RunQuery(&engine, &txn_manager,
+                             "EXPLAIN SELECT id FROM facts WHERE grp = 1;");
+        std::string plan_text;
+        for (const auto& line : plan) {
+            plan_text += std::get<std::string>(line.GetValue(0)) + "\n";
+        }
+        assert(plan_text.find("Gather (4 workers)") != std::string::npos);
+        engine.SetParallelScanWorkers(1);
+        plan = RunQuery(&engine, &txn_manager,
+                        "EXPLAIN SELECT id FROM facts WHERE grp = 1;");
+        plan_text.clear();
+        for (const auto& line : plan) {
+            plan_text += std::get<std::string>(line.GetValue(0)) + "\n";
+        }
+        assert(plan_text.find("Gather") == std::string::npos);
+
+        // Threads taking one-page morsels from the same source see every
+        // page of the chain exactly once
+        TableInfo* facts = catalog.GetTable("facts");
+        MorselSource source(facts->table_heap.get(), "facts", 1);
+        std::mutex seen_mutex;
+        std::map<page_id_t, int> seen;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&]() {
+                std::vector<page_id_t> pages;
+                while (source.NextMorsel(&pages)) {
+                    std::lock_guard<std::mutex> guard(seen_mutex);
+                    for (page_id_t page_id : pages) {
+                        seen[page_id]++;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(seen.size() > 1);
+        assert(source.GetMorselCount() == seen.size());
+        for (const auto& entry : seen) {
+            assert(entry.second == 1);
+        }
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Parallel scan tests passed!" << std::endl;
+}
+
+void TestTableHeapPageDirectory() {
+    std::cout << "Testing TableHeap Page Directory..." << std::endl;
+
+    // Consecutive page ids share an extent; random access and ranges
+    // resolve across extents
+    PageDirectory directory;
+    for (page_id_t page_id : {4, 5, 6, 9, 10, 20}) {
+        directory.Append(page_id);
+    }
+    assert(directory.GetPageCount() == 6);
+    assert(directory.GetExtentCount() == 3);
+    assert(directory.GetPage(0) == 4);
+    assert(directory.GetPage(3) == 9);
+    assert(directory.GetPage(5) == 20);
+    assert(directory.GetPage(6) == INVALID_PAGE_ID);
+    assert(directory.GetLastPage() == 20);
+    std::vector<page_id_t> pages;
+    assert(directory.GetPages(2, 3, &pages) == 3);
+    assert((pages == std::vector<page_id_t>{6, 9, 10}));
+    assert(directory.GetPages(4, 10, &pages) == 2);
+    assert(directory.GetPages(6, 1, &pages) == 0);
+
+    const std::string db_name = "test_page_directory.db";
+    std::remove(db_name.c_str());
+    const size_t row_bytes = PAGE_SIZE / 3;
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, static_cast<int>(PAGE_SIZE / 2),
+                    false, false}});
+    auto bpm = std::make_unique<BufferPoolManager>(
+        16, std::make_unique<DiskManager>(db_name),
+        std::make_unique<LRUReplacer>(16));
+
+    // Two heaps growing in turn interleave their pages on disk
+    page_id_t first_page_id;
+    std::vector<page_id_t> chain;
+    {
+        TableHeap heap(bpm.get(), &schema);
+        TableHeap other(bpm.get(), &schema);
+        first_page_id = heap.GetFirstPageId();
+        for (int i = 0; i < 12; i++) {
+            Tuple tuple({Value(int32_t(i)),
+                         Value(std::string(row_bytes, 'a' + i % 26))},
+                        &schema);
+            RID rid;
+            assert(heap.InsertTuple(tuple, &rid, INVALID_TXN_ID));
+            assert(other.InsertTuple(tuple, &rid, INVALID_TXN_ID));
+            if (chain.empty() || chain.back() != rid.page_id) {
+                chain.push_back(rid.page_id);
+            }
+        }
+        assert(heap.GetPageCount() == chain.size());
+        assert(heap.GetPageCount() > 2);
+    }
+
+    // A reopened heap rebuilds the directory in chain order
+    TableHeap heap(bpm.get(), &schema, first_page_id);
+    std::vector<page_id_t> expected;
+    for (auto it = heap.Begin(); !it.IsEnd(); ++it) {
+        if (expected.empty() || expected.back() != it.GetRID().page_id) {
+            expected.push_back(it.GetRID().page_id);
+        }
+    }
+    assert(heap.GetPageCount() == expected.size());
+    assert(heap.GetPageRange(0, expected.size(), &pages) == expected.size());
+    assert(pages == expected);
+    assert(heap.GetPageRange(1, 2, &pages) == 2);
+    assert(pages[0] == expected[1] && pages[1] == expected[2]);
+
+    // Extending the reopened heap appends to the directory
+    Tuple tuple({Value(int32_t(99)), Value(std::string(row_bytes, 'z'))},
+                &schema);
+    RID rid;
+    for (int i = 0; i < 3; i++) {
+        assert(heap.InsertTuple(tuple, &rid, INVALID_TXN_ID));
+    }
+    assert(heap.GetPageCount() > expected.size());
+    assert(heap.GetPageRange(heap.GetPageCount() - 1, 1, &pages) == 1);
+    assert(pages[0] == rid.page_id);
+
+    bpm.reset();
+    std::remove(db_name.c_str());
+    std::cout << "TableHeap Page Directory tests passed!" << std::endl;
+}
+
+void TestExtentAllocation() {
+    std::cout << "Testing Extent Allocation..." << std::endl;
+
+    const std::string db_name = "test_extent_allocation.db";
+    std::remove(db_name.c_str());
+    {
+        // Two objects growing in turn each get a contiguous run of pages;
+        // pages reserved but not handed out are not counted in the file
+        DiskManager disk_manager(db_name);
+        ExtentReservation first, second;
+        std::vector<page_id_t> first_pages, second_pages;
+        for (size_t i = 0; i < EXTENT_PAGES + 2; i++) {
+            first_pages.push_back(disk_manager.AllocatePage(&first));
+            second_pages.push_back(disk_manager.AllocatePage(&second));
+        }
+        for (size_t i = 1; i < EXTENT_PAGES; i++) {
+            assert(first_pages[i] == first_pages[i - 1] + 1);
+            assert(second_pages[i] == second_pages[i - 1] + 1);
+        }
+        assert(second_pages[0] == first_pages[0] + page_id_t(EXTENT_PAGES));
+        assert(first_pages[EXTENT_PAGES] ==
+               second_pages[0] + page_id_t(EXTENT_PAGES));
+        assert(disk_manager.GetNumPages() == second_pages.back() + 1);
+
+        // A single-page allocation does not land inside a reserved extent
+        page_id_t single = disk_manager.AllocatePage();
+        assert(single >= second_pages.back() + 1);
+        assert(single >= first_pages.back() +
+                             page_id_t(EXTENT_PAGES - 1));
+
+        // The unused tail of a released extent is handed out again
+        disk_manager.ReleaseExtent(&first);
+        ExtentReservation third;
+        assert(disk_manager.AllocatePage(&third) == first_pages.back() + 1);
+        disk_manager.ReleaseExtent(&third);
+        assert(disk_manager.AllocatePage() == first_pages.back() + 2);
+    }
+    std::remove(db_name.c_str());
+
+    // Table pages are contiguous on disk even when two tables grow in turn
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            32, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(32));
+        Catalog catalog(bpm.get());
+        Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                       {"name", TypeId::VARCHAR,
+                        static_cast<int>(PAGE_SIZE / 2), false, false}});
+        assert(catalog.CreateTable("left_table", schema));
+        assert(catalog.CreateTable("right_table", schema));
+        TableHeap* left = catalog.GetTable("left_table")->table_heap.get();
+        TableHeap* right = catalog.GetTable("right_table")->table_heap.get();
+        for (int i = 0; i < 20; i++) {
+            Tuple tuple({Value(int32_t(i)),
+                         Value(std::string(PAGE_SIZE / 3, 'x'))},
+                        &schema);
+            RID rid;
+            assert(left->InsertTuple(tuple, &rid, INVALID_TXN_ID));
+            assert(right->InsertTuple(tuple, &rid, INVALID_TXN_ID));
+        }
+        std::vector<page_id_t> pages;
+        left->GetPageRange(1, left->GetPageCount(), &pages);
+        assert(pages.size() > 4);
+        for (size_t i = 1; i < pages.size(); i++) {
+            assert(pages[i] == pages[i - 1] + 1);
+        }
+        assert(catalog.DropTable("left_table"));
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Extent allocation tests passed!" << std::endl;
+}
+
+void TestCostBasedOptimizer() {
+    std::cout << "Testing Cost-Based Optimizer..." << std::endl;
+
+    const std::string db_name = "test_cost_based_optimizer.db";
+    std::remove(db_name.c_str());
+
+    // Column statistics: NULL fraction, exact distinct count for a table
+    // smaller than the sample, most common values and a histogram
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            32, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(32));
+        Catalog catalog(bpm.get());
+        Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                       {"score", TypeId::INTEGER, 4, true, false}});
+        assert(catalog.CreateTable("scores", schema));
+        TableHeap* heap = catalog.GetTable("scores")->table_heap.get();
+        for (int i = 0; i < 1000; i++) {
+            // Every fourth score is NULL, half of all rows score -1
+            Tuple tuple({Value(int32_t(i)),
+                         Value(int32_t(i % 2 == 0 ? -1 : i))},
+                        &schema);
+            tuple.SetNull(1, i % 4 == 1);
+            RID rid;
+            assert(heap->InsertTuple(tuple, &rid, INVALID_TXN_ID));
+        }
+        auto stats = TableStatistics::Collect(bpm.get(), heap, &schema);
+        assert(stats->row_count == 1000 && stats->sample_rows == 1000);
+        assert(stats->page_count == heap->GetPageCount());
+        const ColumnStatistics& id_stats = stats->columns[0];
+        assert(id_stats.null_fraction == 0.0);
+        assert(id_stats.distinct_count == 1000);
+        assert(id_stats.most_common_values.empty());
+        assert(id_stats.histogram_bounds.size() ==
+               STATISTICS_HISTOGRAM_BUCKETS + 1);
+        assert(std::get<int32_t>(id_stats.histogram_bounds.front()) == 0);
+        assert(std::get<int32_t>(id_stats.histogram_bounds.back()) == 999);
+        Value low(int32_t(100));
+        Value high(int32_t(300));
+        double range =
+            id_stats.EstimateRangeSelectivity(&low, true, &high, false);
+        assert(std::fabs(range - 0.2) < 0.02);
+
+        const ColumnStatistics& score_stats = stats->columns[1];
+        assert(std::fabs(score_stats.null_fraction - 0.25) < 1e-9);
+        assert(score_stats.distinct_count == 251);
+        assert(score_stats.most_common_values.size() == 1);
+        assert(std::get<int32_t>(score_stats.most_common_values[0].first) ==
+               -1);
+        assert(std::fabs(score_stats.EstimateEqualSelectivity(
+                             Value(int32_t(-1))) -
+                         0.5) < 1e-9);
+        assert(std::fabs(score_stats.EstimateEqualSelectivity(
+                             Value(int32_t(3))) -
+                         0.001) < 1e-9);
+    }
+    std::remove(db_name.c_str());
+
+    // ANALYZE switches a predicate on a dominant value to a sequential scan
+    // and keeps the index for rare values
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE skewed (id INT PRIMARY KEY, kind INT, "
+                 "label VARCHAR(32));");
+        // Nine out of ten rows have kind 0, the rest have kind = id
+        const int num_rows = static_cast<int>(PAGE_SIZE / 2);
+        std::string insert_sql = "INSERT INTO skewed VALUES ";
+        size_t dominant_rows = 0;
+        for (int i = 0; i < num_rows; i++) {
+            dominant_rows += i % 10 == 0 && i > 0 ? 0 : 1;
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                          std::to_string(i % 10 == 0 ? i : 0) +
+                          ", 'label-" + std::to_string(i) + "')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX skewed_kind ON skewed (kind);");
+
+        auto explain = [&](const std::string& sql) {
+            std::string text;
+            for (const auto& line :
+                 RunQuery(&engine, &txn_manager, "EXPLAIN " + sql + ";")) {
+                text += std::get<std::string>(line.GetValue(0));
+            }
+            return text;
+        };
+        const std::string dominant = "SELECT * FROM skewed WHERE kind = 0";
+        const std::string rare = "SELECT * FROM skewed WHERE kind = 50";
+        const std::string wide_range = "SELECT * FROM skewed WHERE kind >= 0";
+        const std::string narrow_range =
+            "SELECT * FROM skewed WHERE kind > " +
+            std::to_string(num_rows - 30);
+
+        // Without statistics the index is used whenever it applies and
+        // EXPLAIN shows no estimates
+        assert(explain(dominant).find("Index Scan") != std::string::npos);
+        assert(explain(wide_range).find("Index Range Scan") !=
+               std::string::npos);
+        assert(explain(dominant).find("Rows:") == std::string::npos);
+
+        Parser bad_parser("ANALYZE missing_table;");
+        auto bad_stmt = bad_parser.Parse();
+        std::vector<Tuple> result_set;
+        Transaction* txn = txn_manager.Begin();
+        assert(!engine.Execute(bad_stmt.get(), &result_set, txn));
+        txn_manager.Commit(txn);
+
+        RunQuery(&engine, &txn_manager, "ANALYZE skewed;");
+        auto stats = catalog.GetTableStatistics("skewed");
+        assert(stats != nullptr);
+        assert(stats->row_count == static_cast<size_t>(num_rows));
+        const ColumnStatistics& kind_stats = stats->columns[1];
+        assert(!kind_stats.most_common_values.empty());
+        assert(std::get<int32_t>(kind_stats.most_common_values[0].first) ==
+               0);
+        assert(!kind_stats.histogram_bounds.empty());
+
+        std::string plan = explain(dominant);
+        assert(plan.find("Seq Scan") != std::string::npos);
+        assert(plan.find("Rows: " + std::to_string(dominant_rows) + ",") !=
+               std::string::npos);
+        assert(explain(rare).find("Index Scan") != std::string::npos);
+        assert(explain("SELECT * FROM skewed WHERE id = 5")
+                   .find("Index Scan") != std::string::npos);
+        assert(explain(wide_range).find("Seq Scan") != std::string::npos);
+        assert(explain(narrow_range).find("Index Range Scan") !=
+               std::string::npos);
+
+        // The chosen plans return the same rows as before
+        assert(RunQuery(&engine, &txn_manager, dominant + ";").size() ==
+               dominant_rows);
+        assert(RunQuery(&engine, &txn_manager, rare + ";").size() == 1);
+        assert(RunQuery(&engine, &txn_manager, narrow_range + ";").size() ==
+               3);
+
+        // ANALYZE without a table name covers every table
+        RunQuery(&engine, &txn_manager, "CREATE TABLE other (id INT);");
+        RunQuery(&engine, &txn_manager, "INSERT INTO other VALUES (1), (2);");
+        RunQuery(&engine, &txn_manager, "ANALYZE;");
+        assert(catalog.GetTableStatistics("other")->row_count == 2);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Cost-based optimizer tests passed!" << std::endl;
+}
+
+void TestPreparedStatements() {
+    std::cout << "Testing Prepared Statements..." << std::endl;
+
+    const std::string db_name = "test_prepared_statements.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+
+        auto fails = [&](const std::string& sql) {
+            Parser parser(sql);
+            auto statement = parser.Parse();
+            std::vector<Tuple> result_set;
+            Transaction* txn = txn_manager.Begin();
+            bool success = engine.Execute(statement.get(), &result_set, txn);
+            txn_manager.Commit(txn);
+            return !success;
+        };
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE accounts (id INT PRIMARY KEY, owner "
+                 "VARCHAR(32), balance INT);");
+
+        // A prepared INSERT takes its values from the bound parameters
+        RunQuery(&engine, &txn_manager,
+                 "PREPARE add_account AS INSERT INTO accounts VALUES "
+                 "($1, $2, $3);");
+        const int num_rows = 200;
+        for (int i = 0; i < num_rows; i++) {
+            RunQuery(&engine, &txn_manager,
+                     "EXECUTE add_account (" + std::to_string(i) +
+                         ", 'owner-" + std::to_string(i) + "', " +
+                         std::to_string(i * 10) + ");");
+        }
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM accounts;")
+                   .size() == static_cast<size_t>(num_rows));
+        assert(engine.GetPreparedStatement("add_account")->GetExecuteCount() ==
+               static_cast<size_t>(num_rows));
+
+        // A point lookup is planned once and reused with every binding
+        RunQuery(&engine, &txn_manager,
+                 "PREPARE find_account AS SELECT owner, balance FROM accounts "
+                 "WHERE id = $1;");
+        for (int i = 0; i < num_rows; i += 17) {
+            auto rows = RunQuery(&engine, &txn_manager,
+                                 "EXECUTE find_account (" +
+                                     std::to_string(i) + ");");
+            assert(rows.size() == 1);
+            assert(std::get<std::string>(rows[0].GetValue(0)) ==
+                   "owner-" + std::to_string(i));
+            assert(std::get<int32_t>(rows[0].GetValue(1)) == i * 10);
+        }
+        assert(RunQuery(&engine, &txn_manager, "EXECUTE find_account (-1);")
+                   .empty());
+        auto find_account = engine.GetPreparedStatement("find_account");
+        assert(find_account->GetParameterCount() == 1);
+        assert(find_account->GetPlanCount() == 1);
+
+        // Range bounds from parameters follow the binding too
+        RunQuery(&engine, &txn_manager,
+                 "PREPARE ids_between AS SELECT id FROM accounts "
+                 "WHERE id >= $1 AND id < $2;");
+        assert(RunQuery(&engine, &txn_manager, "EXECUTE ids_between (10, 20);")
+                   .size() == 10);
+        auto rows =
+            RunQuery(&engine, &txn_manager, "EXECUTE ids_between (190, 500);");
+        assert(rows.size() == 10);
+        for (const auto& row : rows) {
+            assert(std::get<int32_t>(row.GetValue(0)) >= 190);
+        }
+        assert(engine.GetPreparedStatement("ids_between")->GetPlanCount() == 1);
+
+        // Prepared UPDATE and DELETE
+        RunQuery(&engine, &txn_manager,
+                 "PREPARE set_balance AS UPDATE accounts SET balance = $2 "
+                 "WHERE id = $1;");
+        RunQuery(&engine, &txn_manager, "EXECUTE set_balance (5, 777);");
+        RunQuery(&engine, &txn_manager, "EXECUTE set_balance (6, 888);");
+        assert(std::get<int32_t>(RunQuery(&engine, &txn_manager,
+                                          "EXECUTE find_account (5);")[0]
+                                     .GetValue(1)) == 777);
+        assert(std::get<int32_t>(RunQuery(&engine, &txn_manager,
+                                          "EXECUTE find_account (6);")[0]
+                                     .GetValue(1)) == 888);
+        RunQuery(&engine, &txn_manager,
+                 "PREPARE remove_account AS DELETE FROM accounts "
+                 "WHERE id = $1;");
+        RunQuery(&engine, &txn_manager, "EXECUTE remove_account (5);");
+        assert(RunQuery(&engine, &txn_manager, "EXECUTE find_account (5);")
+                   .empty());
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM accounts;")
+                   .size() == static_cast<size_t>(num_rows - 1));
+
+        // DDL and ANALYZE change the catalog version and force a new plan
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX accounts_balance ON accounts (balance);");
+        assert(RunQuery(&engine, &txn_manager, "EXECUTE find_account (7);")
+                   .size() == 1);
+        assert(find_account->GetPlanCount() == 2);
+        RunQuery(&engine, &txn_manager, "ANALYZE accounts;");
+        assert(RunQuery(&engine, &txn_manager, "EXECUTE find_account (8);")
+                   .size() == 1);
+        assert(RunQuery(&engine, &txn_manager, "EXECUTE find_account (9);")
+                   .size() == 1);
+        assert(find_account->GetPlanCount() == 3);
+
+        // Wrong argument counts, unknown and duplicate names are errors
+        assert(fails("EXECUTE find_account;"));
+        assert(fails("EXECUTE find_account (1, 2);"));
+        assert(fails("EXECUTE missing (1);"));
+        assert(fails("PREPARE find_account AS SELECT * FROM accounts;"));
+        assert(fails("DEALLOCATE missing;"));
+
+        RunQuery(&engine, &txn_manager, "DEALLOCATE find_account;");
+        assert(engine.GetPreparedStatement("find_account") == nullptr);
+        assert(fails("EXECUTE find_account (1);"));
+    }
+    std::remove(db_name.c_str());
+
+    // Placeholders are only accepted inside PREPARE and must be numbered
+    // without gaps
+    for (const std::string& sql :
+         {std::string("SELECT * FROM accounts WHERE id = $1;"),
+          std::string("PREPARE gap AS SELECT * FROM t WHERE a = $2;"),
+          std::string("PREPARE zero AS SELECT * FROM t WHERE a = $0;")}) {
+        bool threw = false;
+        try {
+            Parser parser(sql);
+            parser.Parse();
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    std::cout << "Prepared statement tests passed!" << std::endl;
+}
+
+void TestQueryFingerprint() {
+    std::cout << "Testing Query Fingerprint..." << std::endl;
+
+    // Queries differing only in literals, spacing and keyword case share
+    // a fingerprint; the literals come back in order
+    std::vector<Value> literals;
+    std::string fingerprint = Lexer::Fingerprint(
+        "SELECT name FROM users WHERE id = 42 AND city = 'Paris';",
+        &literals);
+    assert(fingerprint ==
+           "SELECT name FROM users WHERE id = $1 AND city = $2");
+    assert(literals.size() == 2);
+    assert(std::get<int32_t>(literals[0]) == 42);
+    assert(std::get<std::string>(literals[1]) == "Paris");
+    std::vector<Value> other_literals;
+    assert(Lexer::Fingerprint("select name  from users where id=7 and "
+                              "city='Oslo'",
+                              &other_literals) == fingerprint);
+    assert(std::get<int32_t>(other_literals[0]) == 7);
+
+    // Identifiers, operators and booleans are part of the fingerprint
+    assert(Lexer::Fingerprint("SELECT name FROM users WHERE id > 42",
+                              &literals) != fingerprint);
+    assert(Lexer::Fingerprint("SELECT * FROM t WHERE flag = TRUE",
+                              &literals) ==
+           "SELECT * FROM t WHERE flag = TRUE");
+    assert(literals.empty());
+    assert(Lexer::Fingerprint("INSERT INTO t VALUES (1, 2.5, 'x')",
+                              &literals) ==
+           "INSERT INTO t VALUES ( $1 , $2 , $3 )");
+    assert(std::get<double>(literals[1]) == 2.5);
+
+    // Only DML without placeholders or lexical errors is fingerprinted
+    assert(Lexer::Fingerprint("CREATE TABLE t (a VARCHAR(10))", &literals)
+               .empty());
+    assert(Lexer::Fingerprint("SELECT * FROM t WHERE a = $1", &literals)
+               .empty());
+    assert(Lexer::Fingerprint("SELECT * FROM t WHERE a = 99999999999",
+                              &literals)
+               .empty());
+    assert(Lexer::Fingerprint("SELECT * FROM t; SELECT 1", &literals)
+               .empty());
+
+    const std::string db_name = "test_query_fingerprint.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE users (id INT PRIMARY KEY, city VARCHAR(16));");
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO users VALUES (1, 'Paris'), (2, 'Oslo'), "
+                 "(3, 'Paris');");
+
+        // The fingerprint text prepares into one statement that runs every
+        // query with that shape, planned once
+        auto prepare = [](const std::string& text) {
+            Parser parser("PREPARE cached AS " + text);
+            auto statement = parser.Parse();
+            auto* prepare_stmt =
+                static_cast<PrepareStatement*>(statement.get());
+            return std::make_shared<PreparedStatement>(
+                prepare_stmt->ReleaseStatement(),
+                prepare_stmt->GetParameters());
+        };
+        fingerprint = Lexer::Fingerprint(
+            "SELECT id FROM users WHERE city = 'Paris' AND id > 1",
+            &literals);
+        auto prepared = prepare(fingerprint);
+        for (const auto& query :
+             {std::string("SELECT id FROM users WHERE city = 'Paris' AND "
+                          "id > 1"),
+              std::string("SELECT id FROM users WHERE city = 'Oslo' AND "
+                          "id > 0"),
+              std::string("SELECT id FROM users WHERE city = 'Rome' AND "
+                          "id > 0")}) {
+            assert(Lexer::Fingerprint(query, &literals) == fingerprint);
+            std::vector<Tuple> cached_result;
+            Transaction* txn = txn_manager.Begin();
+            assert(engine.ExecutePrepared(prepared.get(), literals,
+                                          &cached_result, txn));
+            txn_manager.Commit(txn);
+            auto direct = RunQuery(&engine, &txn_manager, query + ";");
+            assert(cached_result.size() == direct.size());
+            for (size_t i = 0; i < direct.size(); i++) {
+                assert(cached_result[i].GetValue(0) == direct[i].GetValue(0));
+            }
+        }
+        assert(prepared->GetPlanCount() == 1);
+        assert(prepared->GetExecuteCount() == 3);
+
+        // Literals where only constants are accepted keep the query on the
+        // normal path: the fingerprint does not prepare
+        fingerprint =
+            Lexer::Fingerprint("SELECT * FROM users LIMIT 2", &literals);
+        bool threw = false;
+        try {
+            prepare(fingerprint);
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Query fingerprint tests passed!" << std::endl;
+}
+
+void TestSnapshotReads() {
+    std::cout << "Testing Snapshot Reads..." << std::endl;
+
+    const std::string db_name = "test_snapshot_reads.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE accounts (id INT PRIMARY KEY, balance INT);");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX idx_balance ON accounts (balance);");
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO accounts VALUES (1, 100), (2, 200), (3, 300), "
+                 "(4, 400), (5, 500);");
+
+        auto query = [&engine](Transaction* txn, const std::string& sql) {
+            Parser parser(sql);
+            auto statement = parser.Parse();
+            std::vector<Tuple> result;
+            bool success = engine.Execute(statement.get(), &result, txn);
+            assert(success);
+            (void)success;
+            return result;
+        };
+        auto total = [](const std::vector<Tuple>& rows) {
+            int32_t sum = 0;
+            for (const auto& row : rows) {
+                sum += std::get<int32_t>(row.GetValue(1));
+            }
+            return sum;
+        };
+
+        // The reader's snapshot is taken before the writer changes anything
+        Transaction* reader = txn_manager.Begin();
+        Transaction* writer = txn_manager.Begin();
+        query(writer, "UPDATE accounts SET balance = 999 WHERE id = 1;");
+        query(writer, "DELETE FROM accounts WHERE id = 2;");
+        query(writer, "INSERT INTO accounts VALUES (6, 600);");
+
+        // The writer sees its own changes
+        auto rows = query(writer, "SELECT * FROM accounts;");
+        assert(rows.size() == 5);
+        assert(total(rows) == 999 + 300 + 400 + 500 + 600);
+
+        // The reader keeps seeing the old rows through scans and both
+        // indexes, before and after the writer commits
+        auto check_reader = [&]() {
+            auto old_rows = query(reader, "SELECT * FROM accounts;");
+            assert(old_rows.size() == 5);
+            assert(total(old_rows) == 1500);
+            auto point =
+                query(reader, "SELECT * FROM accounts WHERE id = 1;");
+            assert(point.size() == 1);
+            assert(std::get<int32_t>(point[0].GetValue(1)) == 100);
+            auto by_balance =
+                query(reader, "SELECT * FROM accounts WHERE balance = 200;");
+            assert(by_balance.size() == 1);
+            assert(std::get<int32_t>(by_balance[0].GetValue(0)) == 2);
+            auto range =
+                query(reader, "SELECT * FROM accounts WHERE balance > 450;");
+            assert(range.size() == 1);
+            assert(std::get<int32_t>(range[0].GetValue(0)) == 5);
+        };
+        check_reader();
+        assert(txn_manager.Commit(writer));
+        check_reader();
+
+        // Transactions starting after the commit see the new rows
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM accounts WHERE balance > 450;");
+        assert(rows.size() == 3);
+
+        // Updating a row changed after the snapshot is a write conflict
+        Parser parser("UPDATE accounts SET balance = 0 WHERE id = 1;");
+        auto update = parser.Parse();
+        std::vector<Tuple> result;
+        assert(!engine.Execute(update.get(), &result, reader));
+        txn_manager.Abort(reader);
+
+        // Once no snapshot needs them the old versions are reclaimed
+        TableHeap* table_heap = catalog.GetTable("accounts")->table_heap.get();
+        assert(table_heap->GetVersionStore()->GetVersionCount() == 0);
+        rows = RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM accounts WHERE id = 1;");
+        assert(std::get<int32_t>(rows[0].GetValue(1)) == 999);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Snapshot reads tests passed!" << std::endl;
+}
+
+void TestPartitionedLockManager() {
+    std::cout << "Testing Partitioned Lock Manager..." << std::endl;
+
+    LockManager lock_manager;
+
+    // Writers on disjoint rows never wait for each other, and shared locks
+    // on common rows stay compatible; repeated rounds reuse pooled queues
+    const int writers = 8;
+    std::atomic<int> failures{0};
+    for (int round = 0; round < 3; round++) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < writers; t++) {
+            threads.emplace_back([&lock_manager, &failures, t, round]() {
+                Transaction txn(round * writers + t + 1);
+                for (int i = 0; i < 500; i++) {
+                    RID rid{t * 1000 + i / 8, i % 8};
+                    if (!lock_manager.LockExclusive(&txn, rid)) {
+                        failures++;
+                    }
+                }
+                for (int i = 0; i < 16; i++) {
+                    if (!lock_manager.LockShared(&txn, RID{99999, i})) {
+                        failures++;
+                    }
+                }
+                assert(txn.GetExclusiveLockSet().size() == 500);
+                lock_manager.UnlockAll(&txn);
+                assert(txn.GetExclusiveLockSet().empty());
+                assert(txn.GetSharedLockSet().empty());
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    assert(failures == 0);
+
+    // Conflicting requests still block: a waiter is granted the lock once
+    // the holder releases it
+    Transaction holder(100);
+    Transaction waiter(101);
+    RID rid{7, 3};
+    assert(lock_manager.LockExclusive(&holder, rid));
+    assert(!lock_manager.LockShared(&waiter, rid));
+    bool granted = false;
+    std::thread waiting([&]() {
+        granted = lock_manager.LockExclusive(&waiter, rid);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    lock_manager.UnlockAll(&holder);
+    waiting.join();
+    assert(granted);
+    assert(waiter.GetExclusiveLockSet().count(rid) == 1);
+
+    // Upgrading waits for the other shared holder to leave
+    Transaction reader(102);
+    lock_manager.UnlockAll(&waiter);
+    Transaction upgrader(103);
+    assert(lock_manager.LockShared(&upgrader, rid));
+    assert(lock_manager.LockShared(&reader, rid));
+    assert(!lock_manager.LockUpgrade(&upgrader, rid));
+    assert(upgrader.GetSharedLockSet().count(rid) == 1);
+    lock_manager.UnlockAll(&reader);
+    assert(lock_manager.LockUpgrade(&upgrader, rid));
+    assert(upgrader.GetExclusiveLockSet().count(rid) == 1);
+    lock_manager.UnlockAll(&upgrader);
+
+    std::cout << "Partitioned lock manager tests passed!" << std::endl;
+}
+
+void TestHierarchicalLocks() {
+    std::cout << "Testing Hierarchical Locks..." << std::endl;
+
+    {
+        LockManager lock_manager;
+        LockMode mode;
+
+        // Intention locks are compatible with each other, a table S lock is
+        // not compatible with IX
+        Transaction reader(1);
+        Transaction writer(2);
+        Transaction scanner(3);
+        assert(lock_manager.LockTable(&reader, 1, LockMode::INTENTION_SHARED));
+        assert(
+            lock_manager.LockTable(&writer, 1, LockMode::INTENTION_EXCLUSIVE));
+        assert(!lock_manager.LockTable(&scanner, 1, LockMode::SHARED));
+        lock_manager.UnlockAll(&writer);
+        assert(lock_manager.LockTable(&scanner, 1, LockMode::SHARED));
+        assert(!lock_manager.LockTable(&reader, 1,
+                                       LockMode::INTENTION_EXCLUSIVE));
+        assert(reader.GetTableLockMode(1, &mode) &&
+               mode == LockMode::INTENTION_SHARED);
+        lock_manager.UnlockAll(&reader);
+
+        // S plus IX on the same table becomes SIX; row locks under a table
+        // lock that covers them are not taken
+        assert(lock_manager.LockRow(&scanner, 1, RID{5, 0},
+                                    LockMode::SHARED));
+        assert(lock_manager.GetRowLockCount() == 0);
+        assert(lock_manager.LockRow(&scanner, 1, RID{5, 0},
+                                    LockMode::EXCLUSIVE));
+        assert(scanner.GetTableLockMode(1, &mode) &&
+               mode == LockMode::SHARED_INTENTION_EXCLUSIVE);
+        assert(lock_manager.GetRowLockCount() == 1);
+        lock_manager.UnlockAll(&scanner);
+        assert(lock_manager.GetRowLockCount() == 0);
+        assert(scanner.GetTableLockSet().empty());
+
+        // Past the threshold, row locks escalate to a table lock
+        Transaction bulk(4);
+        for (size_t i = 0; i < LOCK_ESCALATION_THRESHOLD + 10; i++) {
+            RID rid{static_cast<page_id_t>(i / 50),
+                    static_cast<slot_offset_t>(i % 50)};
+            assert(lock_manager.LockRow(&bulk, 2, rid, LockMode::EXCLUSIVE));
+        }
+        assert(bulk.GetTableLockMode(2, &mode) &&
+               mode == LockMode::EXCLUSIVE);
+        assert(bulk.GetExclusiveLockSet().empty());
+        assert(lock_manager.GetRowLockCount() == 0);
+        Transaction other(5);
+        assert(!lock_manager.LockRow(&other, 2, RID{0, 0}, LockMode::SHARED));
+        lock_manager.UnlockAll(&bulk);
+        assert(lock_manager.LockRow(&other, 2, RID{0, 0}, LockMode::SHARED));
+        lock_manager.UnlockAll(&other);
+    }
+
+    // A bulk DELETE ends up holding one table X lock, which blocks a
+    // serializable scan of the table until it commits
+    const std::string db_name = "test_hierarchical_locks.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            256, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(256));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE events (id INT, payload INT);");
+        size_t rows = LOCK_ESCALATION_THRESHOLD + 100;
+        std::string insert = "INSERT INTO events VALUES ";
+        for (size_t i = 0; i < rows; i++) {
+            insert += (i == 0 ? "(" : ", (") + std::to_string(i) + ", 1)";
+        }
+        RunQuery(&engine, &txn_manager, insert + ";");
+
+        Transaction* deleter = txn_manager.Begin();
+        Parser parser("DELETE FROM events WHERE payload = 1;");
+        auto statement = parser.Parse();
+        std::vector<Tuple> result;
+        assert(engine.Execute(statement.get(), &result, deleter));
+        assert(std::get<int32_t>(result[0].GetValue(0)) ==
+               static_cast<int32_t>(rows));
+        LockMode mode;
+        oid_t table_oid = catalog.GetTable("events")->table_oid;
+        assert(deleter->GetTableLockMode(table_oid, &mode) &&
+               mode == LockMode::EXCLUSIVE);
+        assert(lock_manager.GetRowLockCount() == 0);
+
+        Transaction* scanner =
+            txn_manager.Begin(IsolationLevel::SERIALIZABLE);
+        Parser select_parser("SELECT * FROM events;");
+        auto select = select_parser.Parse();
+        result.clear();
+        bool blocked = false;
+        try {
+            blocked = !engine.Execute(select.get(), &result, scanner);
+        } catch (const ExecutionException&) {
+            blocked = true;
+        }
+        assert(blocked);
+        txn_manager.Abort(scanner);
+        txn_manager.Commit(deleter);
+
+        scanner = txn_manager.Begin(IsolationLevel::SERIALIZABLE);
+        result.clear();
+        assert(engine.Execute(select.get(), &result, scanner));
+        assert(result.empty());
+        txn_manager.Commit(scanner);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Hierarchical locks tests passed!" << std::endl;
+}
+
+void TestDeadlockDetection() {
+    std::cout << "Testing Deadlock Detection..." << std::endl;
+
+    LockManager lock_manager;
+    DeadlockDetectorConfig config;
+    config.interval = std::chrono::milliseconds(10);
+    config.wait_timeout = std::chrono::milliseconds(10000);
+    lock_manager.StartDeadlockDetection(config);
+
+    // Two transactions each wait for a row the other holds; the detector
+    // aborts the younger one long before the wait timeout
+    {
+        Transaction older(1);
+        Transaction younger(2);
+        RID first{1, 0};
+        RID second{2, 0};
+        assert(lock_manager.LockExclusive(&older, first));
+        assert(lock_manager.LockExclusive(&younger, second));
+        auto start = std::chrono::steady_clock::now();
+        bool older_granted = false;
+        bool younger_granted = false;
+        std::thread older_thread([&]() {
+            older_granted = lock_manager.LockExclusive(&older, second);
+        });
+        std::thread younger_thread([&]() {
+            younger_granted = lock_manager.LockShared(&younger, first);
+            // The victim releases its locks like an aborting transaction
+            lock_manager.UnlockAll(&younger);
+        });
+        younger_thread.join();
+        older_thread.join();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        assert(elapsed < std::chrono::seconds(5));
+        assert(!younger_granted);
+        assert(younger.IsAborted());
+        assert(older_granted);
+        assert(!older.IsAborted());
+        assert(lock_manager.GetDeadlockCount() == 1);
+        lock_manager.UnlockAll(&older);
+    }
+
+    // Cycles through table locks are found as well
+    {
+        Transaction older(3);
+        Transaction younger(4);
+        assert(lock_manager.LockTable(&older, 1, LockMode::SHARED));
+        assert(lock_manager.LockTable(&younger, 2, LockMode::SHARED));
+        bool older_granted = false;
+        bool younger_granted = false;
+        std::thread older_thread([&]() {
+            older_granted =
+                lock_manager.LockTable(&older, 2, LockMode::EXCLUSIVE);
+        });
+        std::thread younger_thread([&]() {
+            younger_granted =
+                lock_manager.LockTable(&younger, 1, LockMode::EXCLUSIVE);
+            lock_manager.UnlockAll(&younger);
+        });
+        younger_thread.join();
+        older_thread.join();
+        assert(!younger_granted && younger.IsAborted());
+        assert(older_granted);
+        assert(lock_manager.GetDeadlockCount() == 2);
+        lock_manager.UnlockAll(&older);
+    }
+
+    // Plain conflicts without a cycle are left alone
+    Transaction holder(5);
+    Transaction waiter(6);
+    assert(lock_manager.LockExclusive(&holder, RID{3, 0}));
+    bool granted = false;
+    std::thread waiting([&]() {
+        granted = lock_manager.LockExclusive(&waiter, RID{3, 0});
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(lock_manager.RunDeadlockDetection() == 0);
+    lock_manager.UnlockAll(&holder);
+    waiting.join();
+    assert(granted && !waiter.IsAborted());
+    lock_manager.UnlockAll(&waiter);
+    lock_manager.StopDeadlockDetection();
+
+    std::cout << "Deadlock detection tests passed!" << std::endl;
+}
+
+void TestTransactionTable() {
+    std::cout << "Testing Transaction Table..." << std::endl;
+
+    LockManager lock_manager;
+    TransactionManager txn_manager(&lock_manager, nullptr);
+
+    // Concurrent Begin/Commit claims distinct slots and leaves the table
+    // empty; finished transaction objects are recycled
+    const int threads_count = 8;
+    const int per_thread = 2000;
+    std::mutex seen_latch;
+    std::set<Transaction*> objects;
+    std::set<txn_id_t> ids;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; t++) {
+        threads.emplace_back([&]() {
+            std::set<Transaction*> local_objects;
+            std::vector<txn_id_t> local_ids;
+            for (int i = 0; i < per_thread; i++) {
+                Transaction* txn = txn_manager.Begin();
+                assert(txn->GetState() == TransactionState::GROWING);
+                assert(txn->GetWriteSet().empty());
+                assert(txn->GetSharedLockSet().empty());
+                local_objects.insert(txn);
+                local_ids.push_back(txn->GetTxnId());
+                txn_manager.Commit(txn);
+            }
+            std::lock_guard<std::mutex> guard(seen_latch);
+            objects.insert(local_objects.begin(), local_objects.end());
+            ids.insert(local_ids.begin(), local_ids.end());
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(ids.size() == static_cast<size_t>(threads_count * per_thread));
+    assert(objects.size() <= TRANSACTION_TABLE_SLOTS);
+    assert(txn_manager.GetActiveTransactionTable().empty());
+
+    // A recycled object starts clean even if the previous owner held locks
+    Transaction* first = txn_manager.Begin();
+    assert(lock_manager.LockExclusive(first, RID{1, 1}));
+    first->AddToWriteSet(RID{1, 1}, Tuple());
+    txn_id_t first_id = first->GetTxnId();
+    txn_manager.Commit(first);
+    Transaction* reused = nullptr;
+    for (size_t i = 0; i < TRANSACTION_TABLE_SLOTS && reused != first; i++) {
+        reused = txn_manager.Begin();
+        if (reused != first) {
+            txn_manager.Commit(reused);
+        }
+    }
+    assert(reused == first);
+    assert(reused->GetTxnId() != first_id);
+    assert(reused->GetExclusiveLockSet().empty());
+    assert(reused->GetWriteSet().empty());
+    assert(reused->HasSnapshot());
+    txn_manager.Commit(reused);
+
+    // More active transactions than slots spill into overflow slots and
+    // all of them show up in the active table
+    std::vector<Transaction*> active;
+    for (size_t i = 0; i < TRANSACTION_TABLE_SLOTS + 100; i++) {
+        active.push_back(txn_manager.Begin());
+    }
+    auto table = txn_manager.GetActiveTransactionTable();
+    assert(table.size() == active.size());
+    for (Transaction* txn : active) {
+        txn_manager.Abort(txn);
+    }
+    assert(txn_manager.GetActiveTransactionTable().empty());
+
+    std::cout << "Transaction table tests passed!" << std::endl;
+}
+
+void TestReadOnlyTransactions() {
+    std::cout << "Testing Read-Only Transactions..." << std::endl;
+
+    // BEGIN READ ONLY parses case-insensitively; READ alone is rejected
+    {
+        Parser parser("begin read only;");
+        auto statement = parser.Parse();
+        assert(static_cast<BeginStatement*>(statement.get())->IsReadOnly());
+        Parser plain("BEGIN;");
+        auto plain_statement = plain.Parse();
+        assert(
+            !static_cast<BeginStatement*>(plain_statement.get())->IsReadOnly());
+        bool rejected = false;
+        try {
+            Parser partial("BEGIN READ;");
+            partial.Parse();
+        } catch (const Exception&) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+
+    const std::string db_name = "test_read_only_txn.db";
+    const std::string log_name = "test_read_only_txn.log";
+    std::remove(db_name.c_str());
+    std::remove(log_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        DiskManager log_disk(log_name);
+        LogManager log_manager(&log_disk);
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, &log_manager);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE items (id INT PRIMARY KEY, qty INT);");
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO items VALUES (1, 10), (2, 20), (3, 30);");
+
+        auto execute = [&engine](Transaction* txn, const std::string& sql,
+                                 std::vector<Tuple>* result) {
+            Parser parser(sql);
+            auto statement = parser.Parse();
+            try {
+                return engine.Execute(statement.get(), result, txn);
+            } catch (const ExecutionException&) {
+                return false;
+            }
+        };
+
+        // A read-only transaction writes no BEGIN/COMMIT records and holds
+        // no locks, even under SERIALIZABLE
+        lsn_t before = log_manager.GetLastReservedLSN();
+        Transaction* reader =
+            txn_manager.Begin(IsolationLevel::SERIALIZABLE, true);
+        assert(reader->IsReadOnly());
+        std::vector<Tuple> rows;
+        assert(execute(reader, "SELECT * FROM items;", &rows));
+        assert(rows.size() == 3);
+        assert(reader->GetTableLockSet().empty());
+        assert(reader->GetSharedLockSet().empty());
+
+        // It keeps reading its snapshot while a writer commits
+        Transaction* writer = txn_manager.Begin();
+        std::vector<Tuple> ignored;
+        assert(execute(writer, "UPDATE items SET qty = 0 WHERE id = 1;",
+                       &ignored));
+        txn_manager.Commit(writer);
+        lsn_t after_writer = log_manager.GetLastReservedLSN();
+        assert(after_writer > before);
+        rows.clear();
+        assert(execute(reader, "SELECT * FROM items WHERE id = 1;", &rows));
+        assert(rows.size() == 1 &&
+               std::get<int32_t>(rows[0].GetValue(1)) == 10);
+
+        // Writes are refused before anything reaches the table
+        assert(!execute(reader, "INSERT INTO items VALUES (4, 40);",
+                        &ignored));
+        assert(!execute(reader, "DELETE FROM items WHERE id = 2;", &ignored));
+        txn_manager.Commit(reader);
+        assert(log_manager.GetLastReservedLSN() == after_writer);
+
+        rows = RunQuery(&engine, &txn_manager, "SELECT * FROM items;");
+        assert(rows.size() == 3);
+        assert(txn_manager.GetActiveTransactionTable().empty());
+    }
+    std::remove(db_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+
+    std::cout << "Read-only transaction tests passed!" << std::endl;
+}
+
+// Records the chunk sizes it receives and stops after max_chunks chunks
+class ChunkRecordingSink : public ResultSink {
+   public:
+    explicit ChunkRecordingSink(size_t max_chunks = SIZE_MAX)
+        : max_chunks_(max_chunks) {}
+
+    bool Consume(std::vector<Tuple>* rows) override {
+        chunk_sizes.push_back(rows->size());
+        for (const Tuple& row : *rows) {
+            ids.push_back(std::get<int32_t>(row.GetValue(0)));
+        }
+        return chunk_sizes.size() < max_chunks_;
+    }
+
+    std::vector<size_t> chunk_sizes;
+    std::vector<int32_t> ids;
+
+   private:
+    size_t max_chunks_;
+};
+
+void TestStreamingResults() {
+    std::cout << "Testing Streaming Results..." << std::endl;
+
+    const std::string db_name = "test_streaming_results.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+        RunQuery(&engine, &txn_manager, "CREATE TABLE nums (id INT, v INT);");
+        const int num_rows = 2 * RESULT_STREAM_CHUNK_ROWS + 88;
+        std::string insert_sql = "INSERT INTO nums VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            insert_sql += (i > 0 ? ", (" : "(") + std::to_string(i) + ", " +
+                          std::to_string(i * 2) + ")";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+
+        auto execute = [&](const std::string& sql, ResultSink* sink,
+                           std::vector<Tuple>* result) {
+            Parser parser(sql);
+            auto statement = parser.Parse();
+            Transaction* txn = txn_manager.Begin();
+            bool success = engine.Execute(statement.get(), result, txn, sink);
+            txn_manager.Commit(txn);
+            return success;
+        };
+
+        // Rows go to the sink in full chunks plus one partial chunk and none
+        // stay in the result set
+        ChunkRecordingSink sink;
+        std::vector<Tuple> rows;
+        assert(execute("SELECT * FROM nums;", &sink, &rows));
+        assert(rows.empty());
+        assert(sink.chunk_sizes.size() == 3);
+        assert(sink.chunk_sizes[0] == RESULT_STREAM_CHUNK_ROWS &&
+               sink.chunk_sizes[1] == RESULT_STREAM_CHUNK_ROWS &&
+               sink.chunk_sizes[2] == 88);
+        assert(sink.ids.size() == static_cast<size_t>(num_rows));
+        std::set<int32_t> seen(sink.ids.begin(), sink.ids.end());
+        assert(seen.size() == static_cast<size_t>(num_rows));
+
+        // Prepared statements stream through the same path
+        assert(execute("PREPARE big AS SELECT * FROM nums WHERE v >= $1;",
+                       nullptr, &rows));
+        ChunkRecordingSink prepared_sink;
+        assert(execute("EXECUTE big (0);", &prepared_sink, &rows));
+        assert(rows.empty());
+        assert(prepared_sink.ids.size() == static_cast<size_t>(num_rows));
+
+        // A sink that refuses more rows stops the query
+        ChunkRecordingSink stopping_sink(1);
+        assert(!execute("SELECT * FROM nums;", &stopping_sink, &rows));
+        assert(stopping_sink.chunk_sizes.size() == 1);
+
+        // Without a sink the result set is filled as before
+        rows.clear();
+        assert(execute("SELECT * FROM nums;", nullptr, &rows));
+        assert(rows.size() == static_cast<size_t>(num_rows));
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Streaming result tests passed!" << std::endl;
+}
+
+// Test NUMA topology detection and thread pinning
+void TestNumaTopology() {
+    std::cout << "Testing NUMA topology..." << std::endl;
+
+    const NumaTopology& topology = NumaTopology::Get();
+    assert(topology.GetNodeCount() >= 1);
+    assert(topology.GetNodeIds().size() == topology.GetNodeCount());
+
+    // Every usable cpu appears exactly once, on the node that lists it
+    size_t total_cpus = 0;
+    for (int node : topology.GetNodeIds()) {
+        const std::vector<int>& cpus = topology.GetNodeCpus(node);
+        assert(!cpus.empty());
+        total_cpus += cpus.size();
+        for (int cpu : cpus) {
+            assert(topology.GetNodeOfCpu(cpu) == node);
+        }
+    }
+    const std::vector<int>& spread = topology.GetSpreadCpus();
+    assert(spread.size() == total_cpus);
+    assert(std::set<int>(spread.begin(), spread.end()).size() == total_cpus);
+    assert(topology.GetNodeCpus(-1).empty());
+    assert(topology.GetNodeOfCpu(-1) == -1);
+
+    // Alternating nodes: the first cpus come from different nodes
+    if (topology.GetNodeCount() > 1) {
+        assert(topology.GetNodeOfCpu(spread[0]) !=
+               topology.GetNodeOfCpu(spread[1]));
+    }
+
+    // A pinned thread only runs on the cpu it was pinned to
+    int target = spread.back();
+    bool pinned = false;
+    int observed = -1;
+    std::thread worker([&]() {
+        pinned = NumaTopology::PinCurrentThread(target);
+        observed = sched_getcpu();
+    });
+    worker.join();
+    assert(pinned);
+    assert(observed == target);
+
+    std::cout << "NUMA topology tests passed!" << std::endl;
+}
+
+// Test sharded statistics counters
+void TestShardedStatistics() {
+    std::cout << "Testing sharded statistics..." << std::endl;
+
+    const int num_threads = 4;
+    const int per_thread = 10000;
+    uint32_t index_id = STATS.GetIndexStatId("sharded_stats_idx");
+    assert(STATS.GetIndexStatId("sharded_stats_idx") == index_id);
+
+    // Counters recorded by name and by id land on the same index and
+    // are summed across threads after they exit
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([t, per_thread, index_id]() {
+            for (int i = 0; i < per_thread; i++) {
+                STATS.RecordBTreeInsertion("sharded_stats_idx");
+                STATS.RecordBTreeSearch(index_id);
+                STATS.RecordQueryExecution("SHARDED_TEST",
+                                           static_cast<double>(t * 10 + 1), 2);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    STATS.UpdateBTreeHeight("sharded_stats_idx", 3);
+
+    BTreeStats btree = STATS.GetBTreeStats("sharded_stats_idx");
+    assert(btree.insertions.load() ==
+           static_cast<uint64_t>(num_threads * per_thread));
+    assert(btree.searches.load() ==
+           static_cast<uint64_t>(num_threads * per_thread));
+    assert(btree.deletions.load() == 0);
+    assert(btree.height.load() == 3);
+
+    QueryStats query = STATS.GetQueryStats("SHARDED_TEST");
+    assert(query.count == static_cast<uint64_t>(num_threads * per_thread));
+    assert(query.min_time_ms == 1.0);
+    assert(query.max_time_ms == (num_threads - 1) * 10 + 1.0);
+    assert(query.total_tuples_processed == query.count * 2);
+
+    // Threads started later reuse released shards without losing counts
+    std::thread later([]() { STATS.RecordBTreeInsertion("sharded_stats_idx"); });
+    later.join();
+    assert(STATS.GetBTreeStats("sharded_stats_idx").insertions.load() ==
+           static_cast<uint64_t>(num_threads * per_thread + 1));
+
+    // Reset keeps the interned ids but zeroes every shard
+    STATS.Reset();
+    assert(STATS.GetIndexStatId("sharded_stats_idx") == index_id);
+    assert(STATS.GetBTreeStats("sharded_stats_idx").insertions.load() == 0);
+    assert(STATS.GetQueryStats("SHARDED_TEST").count == 0);
+    STATS.RecordBTreeInsertion(index_id);
+    assert(STATS.GetBTreeStats("sharded_stats_idx").insertions.load() == 1);
+    assert(STATS.GetBTreeStats("no_such_index").insertions.load() == 0);
+
+    std::cout << "Sharded statistics tests passed!" << std::endl;
+}
+
+void TestAsyncLogSink() {
+    std::cout << "Testing async log sink..." << std::endl;
+
+    // The sink writes through std::cerr, so capture it for the duration
+    std::ostringstream captured;
+    std::streambuf* original = std::cerr.rdbuf(captured.rdbuf());
+    AsyncLogSink& sink = AsyncLogSink::GetInstance();
+
+    sink.Write("sync line");
+    assert(!sink.IsRunning());
+    assert(captured.str() == "sync line\n");
+
+    // Lines from several threads all come out whole after Stop drains;
+    // fewer lines than CAPACITY in total so nothing can be dropped
+    const int num_threads = 4;
+    const int per_thread = 1000;
+    uint64_t dropped_before = sink.GetDroppedCount();
+    sink.Start();
+    assert(sink.IsRunning());
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([t, per_thread]() {
+            for (int i = 0; i < per_thread; i++) {
+                WriteLogLine("async " + std::to_string(t) + " " +
+                             std::to_string(i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    sink.Write(std::string(AsyncLogSink::MAX_LINE + 100, 'x'));
+    sink.Stop();
+    assert(!sink.IsRunning());
+    std::cerr.rdbuf(original);
+
+    std::istringstream lines(captured.str());
+    std::string line;
+    std::set<std::string> seen;
+    size_t longest = 0;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, 6, "async ") == 0) {
+            seen.insert(line);
+        } else if (line[0] == 'x') {
+            longest = line.size();
+        }
+    }
+    assert(seen.size() == static_cast<size_t>(num_threads * per_thread));
+    assert(seen.count("async 3 999") == 1);
+    assert(longest == AsyncLogSink::MAX_LINE);
+    assert(sink.GetDroppedCount() == dropped_before);
+
+    std::cout << "Async log sink tests passed!" << std::endl;
+}
+
+void TestQueryArena() {
+    std::cout << "Testing query arena..." << std::endl;
+
+    QueryArena arena(256);
+    void* first = arena.Allocate(10);
+    void* second = arena.Allocate(8, 64);
+    assert(reinterpret_cast<uintptr_t>(second) % 64 == 0);
+    assert(static_cast<char*>(second) >= static_cast<char*>(first) + 10);
+    // Allocations larger than a block get a block of their own
+    void* large = arena.Allocate(4096);
+    std::memset(large, 0xab, 4096);
+    assert(arena.GetBlockCount() == 2);
+    assert(arena.GetBytesUsed() == 10 + 8 + 4096);
+    arena.Reset();
+    assert(arena.GetBlockCount() == 1);
+    assert(arena.GetBytesUsed() == 0);
+    assert(arena.Allocate(10) == first);
+
+    // Nodes come from the current arena and go back to the heap without one
+    assert(QueryArena::Current() == nullptr);
+    {
+        QueryArena::Scope scope(&arena);
+        assert(QueryArena::Current() == &arena);
+        size_t before = arena.GetBytesUsed();
+        auto node = std::make_unique<ConstantExpression>(Value(int32_t(7)));
+        assert(arena.GetBytesUsed() > before);
+        {
+            QueryArena::Suspend suspend;
+            assert(QueryArena::Current() == nullptr);
+            before = arena.GetBytesUsed();
+            auto heap_node =
+                std::make_unique<ConstantExpression>(Value(int32_t(8)));
+            assert(arena.GetBytesUsed() == before);
+        }
+        assert(QueryArena::Current() == &arena);
+    }
+    assert(QueryArena::Current() == nullptr);
+
+    // The thread's own arena is shared by nested scopes and reset once
+    {
+        QueryArena::Scope outer;
+        QueryArena* thread_arena = QueryArena::Current();
+        assert(thread_arena != nullptr);
+        {
+            QueryArena::Scope inner;
+            assert(QueryArena::Current() == thread_arena);
+            Parser parser("SELECT id FROM users WHERE id = 1");
+            auto statement = parser.Parse();
+            assert(thread_arena->GetBytesUsed() > 0);
+        }
+        assert(thread_arena->GetBytesUsed() > 0);
+    }
+    assert(QueryArena::Current() == nullptr);
+
+    // PREPARE parses the statement it keeps onto the heap
+    const std::string select = "SELECT id, name FROM users WHERE id = 5";
+    arena.Reset();
+    std::unique_ptr<Statement> prepared_body;
+    size_t select_bytes;
+    size_t prepare_bytes;
+    {
+        QueryArena::Scope scope(&arena);
+        Parser(select).Parse();
+    }
+    select_bytes = arena.GetBytesUsed();
+    arena.Reset();
+    {
+        QueryArena::Scope scope(&arena);
+        auto statement = Parser("PREPARE p AS " + select).Parse();
+        prepared_body =
+            static_cast<PrepareStatement*>(statement.get())->ReleaseStatement();
+    }
+    prepare_bytes = arena.GetBytesUsed();
+    arena.Reset();
+    assert(prepare_bytes < select_bytes);
+    assert(prepared_body->GetType() == Statement::StmtType::SELECT);
+
+    std::cout << "Query arena tests passed!" << std::endl;
+}
+
+void TestTupleReuse() {
+    std::cout << "Testing tuple storage reuse..." << std::endl;
+
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, 64, true, false}});
+    const std::string long_name(40, 'a');
+    const std::string shorter_name(30, 'b');
+    std::vector<char> first(256);
+    std::vector<char> second(256);
+    Tuple(std::vector<Value>{Value(int32_t(1)), Value(long_name)}, &schema)
+        .SerializeTo(first.data());
+    Tuple row(std::vector<Value>{Value(int32_t(2)), Value(shorter_name)},
+              &schema);
+    row.SerializeTo(second.data());
+
+    // Deserializing into the same tuple keeps the string's buffer
+    Tuple tuple;
+    tuple.DeserializeFrom(first.data(), &schema);
+    const char* buffer = std::get<std::string>(tuple.GetValues()[1]).data();
+    tuple.DeserializeFrom(second.data(), &schema);
+    assert(std::get<int32_t>(tuple.GetValues()[0]) == 2);
+    assert(std::get<std::string>(tuple.GetValues()[1]) == shorter_name);
+    assert(std::get<std::string>(tuple.GetValues()[1]).data() == buffer);
+    assert(tuple.GetSerializedSize() == row.GetSerializedSize());
+
+    // NULL flags from an earlier row do not leak into the next one
+    Tuple with_null(std::vector<Value>{Value(int32_t(3)), Value(long_name)},
+                    &schema);
+    with_null.SetNull(1, true);
+    with_null.SerializeTo(first.data());
+    tuple.DeserializeFrom(first.data(), &schema);
+    assert(tuple.IsNull(1));
+    tuple.DeserializeFrom(second.data(), &schema);
+    assert(!tuple.IsNull(1));
+
+    // Reset + SetValue + Normalize builds the same row as the constructor,
+    // converting types the same way and reusing the string in place
+    tuple.SetRID(RID{5, 6});
+    tuple.Reset(2);
+    assert(tuple.GetRID().page_id == INVALID_PAGE_ID);
+    tuple.SetValue(0, Value(int64_t(9)));
+    tuple.SetValue(1, Value(std::string("xyz")));
+    assert(std::get<std::string>(tuple.GetValues()[1]).data() == buffer);
+    tuple.Normalize(&schema);
+    Tuple expected(std::vector<Value>{Value(int32_t(9)),
+                                      Value(std::string("xyz"))},
+                   &schema);
+    assert(std::get<int32_t>(tuple.GetValues()[0]) == 9);
+    assert(tuple.GetSerializedSize() == expected.GetSerializedSize());
+    bool threw = false;
+    try {
+        tuple.SetValue(2, Value(int32_t(0)));
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Tuple storage reuse tests passed!" << std::endl;
+}
+
+void TestCompactValue() {
+    std::cout << "Testing compact values..." << std::endl;
+
+    assert(sizeof(CompactValue) == 16);
+
+    // Short strings are stored inline, long ones point at the source bytes
+    const std::string short_name = "alice";
+    const std::string long_name(40, 'x');
+    const Value long_source(long_name);
+    CompactValue short_value = CompactValue::FromValue(Value(short_name));
+    CompactValue long_value = CompactValue::FromValue(long_source);
+    assert(short_value.IsInline() && short_value.GetString() == short_name);
+    assert(!long_value.IsInline());
+    assert(long_value.GetString().data() ==
+           std::get<std::string>(long_source).data());
+    assert(std::get<std::string>(long_value.ToValue()) == long_name);
+    assert(std::get<float>(
+               CompactValue::FromValue(Value(1.5f)).ToValue()) == 1.5f);
+    assert(std::get<int16_t>(
+               CompactValue::FromValue(Value(int16_t(-7))).ToValue()) == -7);
+
+    // Same rules as CompareValues: mixed numerics compare as double,
+    // NaN only satisfies !=, bool never compares with other types
+    using Ordering = CompactValue::Ordering;
+    auto compare = [](const Value& left, const Value& right) {
+        return CompactValue::Compare(CompactValue::FromValue(left),
+                                     CompactValue::FromValue(right));
+    };
+    assert(compare(Value(int32_t(2)), Value(2.5)) == Ordering::LESS);
+    assert(compare(Value(int64_t(3)), Value(3.0f)) == Ordering::EQUAL);
+    assert(compare(Value(std::string("b")), Value(std::string("a"))) ==
+           Ordering::GREATER);
+    assert(compare(Value(std::nan("")), Value(1.0)) == Ordering::UNORDERED);
+    assert(compare(Value(true), Value(int32_t(1))) == Ordering::INCOMPARABLE);
+    assert(compare(Value(std::string("1")), Value(int32_t(1))) ==
+           Ordering::INCOMPARABLE);
+    using OpType = BinaryOpExpression::OpType;
+    assert(ExpressionEvaluator::CompareValues(Value(std::nan("")),
+                                              Value(1.0), OpType::NOT_EQUALS));
+    assert(!ExpressionEvaluator::CompareValues(Value(std::nan("")),
+                                               Value(1.0), OpType::EQUALS));
+    bool threw = false;
+    try {
+        ExpressionEvaluator::CompareValues(Value(true), Value(int32_t(1)),
+                                           OpType::EQUALS);
+    } catch (const ExecutionException&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Decoding from a page view references the page bytes directly
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, 64, true, false}});
+    Tuple row(std::vector<Value>{Value(int32_t(7)), Value(long_name)},
+              &schema);
+    std::vector<char> data(row.GetSerializedSize());
+    row.SerializeTo(data.data());
+    TupleView view(data.data(), data.size(), &schema, RID{1, 2});
+    CompactValue id = view.GetCompactValue(0);
+    CompactValue name = view.GetCompactValue(1);
+    assert(id.GetType() == TypeId::INTEGER && id.GetInteger() == 7);
+    assert(name.GetString() == long_name);
+    assert(name.GetString().data() >= data.data() &&
+           name.GetString().data() < data.data() + data.size());
+    assert(CompactValue::Compare(name, long_value) == Ordering::EQUAL);
+    assert(row.GetCompactValue(1).GetString().data() ==
+           std::get<std::string>(row.GetValues()[1]).data());
+
+    std::cout << "Compact value tests passed!" << std::endl;
+}
+
+void TestPlanCatalogBinding() {
+    std::cout << "Testing plan catalog binding..." << std::endl;
+
+    // Bindings are only visible while the catalog version is unchanged,
+    // and copies of a cached plan carry them along
+    Schema scan_schema({{"id", TypeId::INTEGER, 4, false, true}});
+    TableInfo table;
+    SeqScanPlanNode scan(&scan_schema, "t");
+    assert(scan.GetBoundTable(0) == nullptr);
+    scan.BindCatalogObjects(&table, nullptr, 7);
+    assert(scan.GetBoundTable(7) == &table);
+    assert(scan.GetBoundTable(8) == nullptr);
+    auto copy = CopyPlan(&scan);
+    assert(copy->GetBoundTable(7) == &table);
+    assert(copy->GetBoundIndex(7) == nullptr);
+
+    const std::string db_name = "test_plan_binding.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE items (id INT PRIMARY KEY, name VARCHAR(16));");
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO items VALUES (1, 'first'), (2, 'second');");
+        RunQuery(&engine, &txn_manager,
+                 "PREPARE find_item AS SELECT name FROM items WHERE id = $1;");
+        auto rows = RunQuery(&engine, &txn_manager, "EXECUTE find_item (2);");
+        assert(rows.size() == 1);
+        assert(std::get<std::string>(rows[0].GetValue(0)) == "second");
+
+        // Recreating the table frees the bound TableInfo; the cached plan is
+        // replanned for the new catalog version instead of using it
+        RunQuery(&engine, &txn_manager, "DROP TABLE items;");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE items (id INT PRIMARY KEY, name VARCHAR(16));");
+        RunQuery(&engine, &txn_manager, "INSERT INTO items VALUES (2, 'new');");
+        rows = RunQuery(&engine, &txn_manager, "EXECUTE find_item (2);");
+        assert(rows.size() == 1);
+        assert(std::get<std::string>(rows[0].GetValue(0)) == "new");
+        assert(engine.GetPreparedStatement("find_item")->GetPlanCount() == 2);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Plan catalog binding tests passed!" << std::endl;
+}
+
+void TestExplainAnalyze() {
+    std::cout << "Testing EXPLAIN ANALYZE..." << std::endl;
+
+    const std::string db_name = "test_explain_analyze.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE events (id INT PRIMARY KEY, kind INT);");
+        for (int i = 0; i < 50; i++) {
+            RunQuery(&engine, &txn_manager,
+                     "INSERT INTO events VALUES (" + std::to_string(i) + ", " +
+                         std::to_string(i % 5) + ");");
+        }
+
+        Parser parser("EXPLAIN ANALYZE SELECT id FROM events;");
+        auto statement = parser.Parse();
+        assert(static_cast<ExplainStatement*>(statement.get())->IsAnalyze());
+
+        // Every executor reports the rows it actually produced; the scan
+        // under the projection sees only the rows that passed the filter
+        auto lines = RunQuery(&engine, &txn_manager,
+                              "EXPLAIN ANALYZE SELECT id FROM events "
+                              "WHERE kind = 1;");
+        assert(lines.size() == 3);
+        auto line = [&lines](size_t i) {
+            return std::get<std::string>(lines[i].GetValue(0));
+        };
+        assert(line(0).find("Projection") != std::string::npos);
+        assert(line(0).find("actual rows=10 loops=1") != std::string::npos);
+        assert(line(1).find("Seq Scan on events") != std::string::npos);
+        assert(line(1).find("actual rows=10 loops=1") != std::string::npos);
+        assert(line(1).find("buffers: hit=") != std::string::npos);
+        assert(line(1).find("lock waits=0") != std::string::npos);
+        assert(line(2).rfind("Execution Time: ", 0) == 0);
+
+        // Plain EXPLAIN does not run anything; EXPLAIN ANALYZE of a DML
+        // statement does
+        assert(RunQuery(&engine, &txn_manager,
+                        "EXPLAIN DELETE FROM events WHERE kind = 2;")
+                   .size() == 1);
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM events;")
+                   .size() == 50);
+        RunQuery(&engine, &txn_manager,
+                 "EXPLAIN ANALYZE DELETE FROM events WHERE kind = 2;");
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM events;")
+                   .size() == 40);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "EXPLAIN ANALYZE tests passed!" << std::endl;
+}
+
+void TestMetricsExposition() {
+    std::cout << "Testing latency histograms and metrics exposition..."
+              << std::endl;
+
+    LatencyHistogram histogram;
+    histogram.Record(0.00005);
+    histogram.Record(0.001);
+    histogram.RecordMs(3.0);
+    histogram.Record(60.0);
+    LatencyHistogram::Snapshot snapshot = histogram.GetSnapshot();
+    assert(snapshot.count == 4);
+    assert(snapshot.sum_us == 60004050);
+    assert(snapshot.CountAtOrBelow(1000) == 2);
+    assert(snapshot.CountAtOrBelow(10000000) == 3);
+
+    LatencyHistogram::Snapshot merged = snapshot;
+    merged.Merge(snapshot);
+    assert(merged.count == 8 && merged.CountAtOrBelow(100) == 2);
+
+    // Buckets are cumulative, HELP/TYPE appear once per family
+    MetricsWriter writer;
+    writer.AddCounter("test_requests_total", "Requests.", 3,
+                      MetricsWriter::Label("kind", "a\"b"));
+    writer.AddCounter("test_requests_total", "Requests.", 4,
+                      MetricsWriter::Label("kind", "c"));
+    writer.AddHistogram("test_latency_seconds", "Latency.", snapshot,
+                        MetricsWriter::Label("op", "x"));
+    const std::string& text = writer.GetText();
+    auto count_of = [&text](const std::string& needle) {
+        size_t count = 0;
+        for (size_t pos = text.find(needle); pos != std::string::npos;
+             pos = text.find(needle, pos + 1)) {
+            count++;
+        }
+        return count;
+    };
+    assert(count_of("# TYPE test_requests_total counter\n") == 1);
+    assert(text.find("test_requests_total{kind=\"a\\\"b\"} 3\n") !=
+           std::string::npos);
+    assert(text.find("test_requests_total{kind=\"c\"} 4\n") !=
+           std::string::npos);
+    assert(text.find("# TYPE test_latency_seconds histogram\n") !=
+           std::string::npos);
+    assert(text.find("test_latency_seconds_bucket{op=\"x\",le=\"0.001\"} 2\n") !=
+           std::string::npos);
+    assert(text.find("test_latency_seconds_bucket{op=\"x\",le=\"10\"} 3\n") !=
+           std::string::npos);
+    assert(text.find("test_latency_seconds_bucket{op=\"x\",le=\"+Inf\"} 4\n") !=
+           std::string::npos);
+    assert(text.find("test_latency_seconds_count{op=\"x\"} 4\n") !=
+           std::string::npos);
+
+    // Statistics feed per-type query histograms and lock wait histograms
+    STATS.Reset();
+    STATS.RecordQueryExecution("METRICS_TEST", 2.0, 5);
+    STATS.RecordQueryExecution("METRICS_TEST", 200.0, 1);
+    STATS.RecordLockWait(7.0);
+    QueryStats query = STATS.GetQueryStats("METRICS_TEST");
+    assert(query.latency.count == 2);
+    assert(query.latency.CountAtOrBelow(2500) == 1);
+    assert(query.latency.CountAtOrBelow(250000) == 2);
+    assert(STATS.GetLockWaitHistogram().CountAtOrBelow(10000) == 1);
+
+    MetricsWriter stats_writer;
+    WriteStatisticsMetrics(&stats_writer);
+    const std::string& stats_text = stats_writer.GetText();
+    assert(stats_text.find(
+               "simpledb_query_execution_seconds_count{type=\"METRICS_TEST\"} 2\n") !=
+           std::string::npos);
+    assert(stats_text.find(
+               "simpledb_query_tuples_total{type=\"METRICS_TEST\"} 6\n") !=
+           std::string::npos);
+    assert(stats_text.find("simpledb_lock_waits_total 1\n") != std::string::npos);
+    assert(stats_text.find("# TYPE simpledb_buffer_pool_hit_ratio gauge\n") !=
+           std::string::npos);
+
+    STATS.Reset();
+    assert(STATS.GetQueryStats("METRICS_TEST").latency.count == 0);
+    assert(STATS.GetLockWaitHistogram().count == 0);
+
+    std::cout << "Metrics exposition tests passed!" << std::endl;
+}
+
+void TestLatencyPercentiles() {
+    std::cout << "Testing HDR latency histograms and percentiles..."
+              << std::endl;
+
+    // Small values are exact, larger ones keep ~3% relative precision
+    for (uint64_t micros = 0; micros < LatencyHistogram::SUB_BUCKET_COUNT;
+         micros++) {
+        size_t index = LatencyHistogram::BucketIndex(micros);
+        assert(LatencyHistogram::BucketLowest(index) == micros);
+        assert(LatencyHistogram::BucketHighest(index) == micros);
+    }
+    for (uint64_t micros : {32ull, 33ull, 100ull, 1000ull, 123456ull,
+                            987654321ull, (1ull << 35) + 12345}) {
+        size_t index = LatencyHistogram::BucketIndex(micros);
+        uint64_t lowest = LatencyHistogram::BucketLowest(index);
+        uint64_t highest = LatencyHistogram::BucketHighest(index);
+        assert(lowest <= micros && micros <= highest);
+        assert(static_cast<double>(highest - lowest) <=
+               static_cast<double>(micros) / LatencyHistogram::SUB_BUCKET_COUNT);
+        assert(LatencyHistogram::BucketIndex(highest + 1) == index + 1);
+    }
+    assert(LatencyHistogram::BucketIndex(~0ull) ==
+           LatencyHistogram::BUCKET_COUNT - 1);
+
+    // 1..1000us once each: percentiles within one sub-bucket of the truth
+    LatencyHistogram histogram;
+    for (uint64_t micros = 1; micros <= 1000; micros++) {
+        histogram.RecordMicros(micros);
+    }
+    LatencyHistogram::Snapshot snapshot = histogram.GetSnapshot();
+    assert(snapshot.count == 1000 && snapshot.max_us == 1000);
+    auto near = [](uint64_t actual, uint64_t expected) {
+        return actual >= expected &&
+               actual <= expected + expected / LatencyHistogram::SUB_BUCKET_COUNT;
+    };
+    assert(near(snapshot.ValueAtPercentile(50.0), 500));
+    assert(near(snapshot.ValueAtPercentile(95.0), 950));
+    assert(near(snapshot.ValueAtPercentile(99.0), 990));
+    assert(snapshot.ValueAtPercentile(99.9) == 1000);  // capped at the max
+    assert(snapshot.ValueAtPercentile(0.0) == 1);
+    assert(LatencyHistogram::Snapshot().ValueAtPercentile(99.0) == 0);
+
+    // A long tail shows up in p999 even though the average barely moves
+    LatencyHistogram tail;
+    for (int i = 0; i < 9990; i++) {
+        tail.RecordMicros(100);
+    }
+    for (int i = 0; i < 10; i++) {
+        tail.RecordMs(500.0);
+    }
+    LatencyPercentiles percentiles = tail.GetSnapshot().GetPercentiles();
+    assert(percentiles.count == 10000);
+    assert(percentiles.p50_ms < 0.11 && percentiles.p99_ms < 0.11);
+    assert(percentiles.p999_ms < 0.11);
+    assert(percentiles.max_ms == 500.0);
+    tail.RecordMs(500.0);
+    assert(tail.GetSnapshot().GetPercentiles().p999_ms > 480.0);
+
+    // Concurrent recording is lock-free and loses nothing
+    LatencyHistogram shared;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&shared, t]() {
+            for (int i = 0; i < 10000; i++) {
+                shared.RecordMicros(static_cast<uint64_t>(t * 1000 + i % 100));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(shared.GetSnapshot().count == 40000);
+
+    // Statistics exposes percentiles for queries, locks, log flushes, reads
+    STATS.Reset();
+    for (int i = 1; i <= 100; i++) {
+        STATS.RecordQueryExecution("PERCENTILE_TEST", i * 0.1);
+    }
+    std::thread other([]() { STATS.RecordQueryExecution("PERCENTILE_TEST", 80.0); });
+    other.join();
+    LatencyPercentiles query =
+        STATS.GetQueryLatencyPercentiles("PERCENTILE_TEST");
+    assert(query.count == 101);
+    assert(query.p50_ms >= 5.0 && query.p50_ms < 5.3);
+    assert(query.max_ms == 80.0 && query.p999_ms == 80.0);
+    STATS.RecordLockWait(4.0);
+    STATS.RecordLogFlush(1.5);
+    STATS.RecordDiskRead(PAGE_SIZE, 0.25);
+    assert(STATS.GetLockWaitPercentiles().p99_ms == 4.0);
+    assert(STATS.GetLogFlushPercentiles().p50_ms == 1.5);
+    assert(STATS.GetDiskReadPercentiles().p999_ms == 0.25);
+    assert(STATS.GetTotalDiskReads() == 1);
+
+    STATS.Reset();
+    assert(STATS.GetQueryLatencyPercentiles("PERCENTILE_TEST").count == 0);
+    assert(STATS.GetLogFlushPercentiles().count == 0);
+    assert(STATS.GetDiskReadPercentiles().count == 0);
+
+    std::cout << "Latency percentile tests passed!" << std::endl;
+}
+
+void TestPlanCapture() {
+    std::cout << "Testing plan capture for the slow query log..." << std::endl;
+
+    const std::string db_name = "test_plan_capture.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE items (id INT PRIMARY KEY, kind INT);");
+        for (int i = 0; i < 30; i++) {
+            RunQuery(&engine, &txn_manager,
+                     "INSERT INTO items VALUES (" + std::to_string(i) + ", " +
+                         std::to_string(i % 3) + ");");
+        }
+
+        // Capturing always: the plan is formatted and every row the scan
+        // read counts as examined, not only the ones returned
+        uint64_t examined_before =
+            Statistics::GetThreadIOCounters().rows_examined;
+        {
+            PlanCapture capture(true, 0.0);
+            assert(PlanCapture::Current() == &capture);
+            auto rows = RunQuery(&engine, &txn_manager,
+                                 "SELECT id FROM items WHERE kind = 1;");
+            assert(rows.size() == 10);
+            assert(capture.GetRowsReturned() == 10);
+            assert(capture.GetPlanText().find("Seq Scan on items") !=
+                   std::string::npos);
+        }
+        assert(PlanCapture::Current() == nullptr);
+        assert(Statistics::GetThreadIOCounters().rows_examined -
+                   examined_before >= 30);
+
+        // A fast query under a high threshold keeps only the row count
+        {
+            PlanCapture capture(false, 1e9);
+            RunQuery(&engine, &txn_manager, "SELECT * FROM items;");
+            assert(capture.GetRowsReturned() == 30);
+            assert(capture.GetPlanText().empty());
+        }
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Plan capture tests passed!" << std::endl;
+}
+
+void TestTraceSpans() {
+    std::cout << "Testing trace spans..." << std::endl;
+
+    Tracer::Clear();
+    Tracer::SetEnabled(false);
+    { TraceSpan span("test", "DisabledSpan"); }
+
+    Tracer::SetEnabled(true);
+    {
+        TraceSpan span("test", "OuterSpan");
+        span.SetArg(42);
+        TraceSpan inner("test", "Inner\"Span");
+    }
+    // Another thread gets its own buffer and its own tid
+    std::thread worker([] { TraceSpan span("test", "WorkerSpan"); });
+    worker.join();
+
+    std::string trace = Tracer::DumpChromeTrace();
+    assert(trace.rfind("{\"traceEvents\":[", 0) == 0);
+    assert(trace.find("DisabledSpan") == std::string::npos);
+    assert(trace.find("\"name\":\"OuterSpan\",\"cat\":\"test\",\"ph\":\"X\"") !=
+           std::string::npos);
+    assert(trace.find("\"args\":{\"value\":42}") != std::string::npos);
+    assert(trace.find("Inner\\\"Span") != std::string::npos);
+    assert(trace.find("WorkerSpan") != std::string::npos);
+    assert(trace.find("\"thread_name\"") != std::string::npos);
+
+    // The ring keeps only the newest CAPACITY events of a thread
+    Tracer::Clear();
+    for (size_t i = 0; i < TraceBuffer::CAPACITY + 10; i++) {
+        Tracer::Record("test", "RingSpan", i + 1, 1, i + 1);
+    }
+    trace = Tracer::DumpChromeTrace();
+    size_t ring_events = 0;
+    for (size_t pos = trace.find("RingSpan"); pos != std::string::npos;
+         pos = trace.find("RingSpan", pos + 1)) {
+        ring_events++;
+    }
+    assert(ring_events == TraceBuffer::CAPACITY);
+    assert(trace.find("\"value\":10}") == std::string::npos);
+    assert(trace.find("\"value\":11}") != std::string::npos);
+
+    Tracer::SetEnabled(false);
+    Tracer::Clear();
+    assert(Tracer::DumpChromeTrace().find("RingSpan") == std::string::npos);
+
+    std::cout << "Trace span tests passed!" << std::endl;
+}
+
+void TestIndexPersistence() {
+    std::cout << "Testing Index Persistence..." << std::endl;
+
+    const std::string db_name = "test_index_persist.db";
+    std::remove(db_name.c_str());
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, 32, false, false}});
+    const int num_rows = 2000;
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+    auto check_index = [num_rows](TableManager* table_manager) {
+        RID rid;
+        for (int i = 0; i < num_rows; i += 7) {
+            assert(table_manager->GetIndexManager()->FindEntry(
+                "persist_id", Value(int32_t(i)), &rid));
+        }
+        assert(!table_manager->GetIndexManager()->FindEntry(
+            "persist_id", Value(int32_t(num_rows)), &rid));
+    };
+
+    page_id_t root_page_id = INVALID_PAGE_ID;
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        assert(catalog.CreateTable("persist", schema));
+        TableManager table_manager(bpm.get(), &catalog);
+        assert(table_manager.CreateIndex("persist_id", "persist", {"id"}));
+        TableHeap* heap = catalog.GetTable("persist")->table_heap.get();
+        for (int i = 0; i < num_rows; i++) {
+            Tuple tuple({Value(int32_t(i)), Value(std::string("row"))},
+                        &schema);
+            RID rid;
+            assert(heap->InsertTuple(tuple, &rid, 1));
+            assert(table_manager.UpdateIndexesOnInsert("persist", tuple, rid));
+        }
+        // Root splits are written back to the catalog as they happen
+        root_page_id = catalog.GetIndex("persist_id")->root_page_id;
+        assert(root_page_id != INVALID_PAGE_ID);
+        assert(!catalog.AreIndexesTrusted());
+    }
+
+    // Clean restart: the tree is opened from the catalog root, not rebuilt
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        assert(catalog.AreIndexesTrusted());
+        assert(catalog.GetIndex("persist_id")->root_page_id == root_page_id);
+        auto* table_manager = new TableManager(bpm.get(), &catalog);
+        assert(table_manager->GetIndexManager()
+                   ->GetIndex<int32_t>("persist_id")
+                   ->GetRootPageId() == root_page_id);
+        check_index(table_manager);
+        // Simulate a crash: the table manager is never destroyed, so the
+        // clean marker cleared at startup is never set again
+    }
+
+    // After the crash the catalog is not trusted and the index is rebuilt
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        assert(!catalog.AreIndexesTrusted());
+        TableManager table_manager(bpm.get(), &catalog);
+        check_index(&table_manager);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Index Persistence tests passed!" << std::endl;
+}
+
+void TestColumnStore() {
+    std::cout << "Testing column store..." << std::endl;
+
+    // Each encoding round-trips, and the smallest one is chosen
+    auto round_trip = [](TypeId type, const std::vector<Value>& values,
+                         const std::vector<bool>& nulls) {
+        ColumnStore::Encoding encoding;
+        std::string segment =
+            ColumnStore::EncodeSegment(type, values, nulls, &encoding);
+        std::vector<Value> decoded;
+        std::vector<bool> decoded_nulls;
+        ColumnStore::DecodeSegment(type, segment, &decoded, &decoded_nulls);
+        assert(decoded_nulls == nulls);
+        for (size_t i = 0; i < values.size(); i++) {
+            assert(nulls[i] || decoded[i] == values[i]);
+        }
+        return encoding;
+    };
+    std::vector<Value> ints, runs, words;
+    for (int i = 0; i < 1000; i++) {
+        ints.push_back(Value(int32_t(1000000 + i % 100)));
+        runs.push_back(Value(int32_t(i / 250)));
+        words.push_back(Value(std::string(i % 3 == 0 ? "alpha" : "beta")));
+    }
+    std::vector<bool> no_nulls(1000, false), some_nulls(1000, false);
+    some_nulls[7] = some_nulls[500] = true;
+    assert(round_trip(TypeId::INTEGER, ints, no_nulls) ==
+           ColumnStore::Encoding::FRAME_OF_REFERENCE);
+    assert(round_trip(TypeId::INTEGER, runs, some_nulls) ==
+           ColumnStore::Encoding::RLE);
+    assert(round_trip(TypeId::VARCHAR, words, no_nulls) ==
+           ColumnStore::Encoding::DICTIONARY);
+
+    const std::string db_name = "test_column_store.db";
+    std::remove(db_name.c_str());
+    const int num_rows = static_cast<int>(COLUMN_ROW_GROUP_SIZE) * 2 + 100;
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+    auto check_table = [num_rows](ExecutionEngine* engine,
+                                  TransactionManager* txn_manager) {
+        auto rows = RunQuery(engine, txn_manager, "SELECT id FROM events;");
+        assert(rows.size() == static_cast<size_t>(num_rows));
+        // Row groups whose id range misses the predicate are skipped
+        rows = RunQuery(engine, txn_manager,
+                        "SELECT id, kind FROM events WHERE id >= 10 AND "
+                        "id < 20;");
+        assert(rows.size() == 10);
+        for (const auto& row : rows) {
+            int32_t id = std::get<int32_t>(row.GetValue(0));
+            assert(std::get<std::string>(row.GetValue(1)) ==
+                   (id % 2 == 0 ? "click" : "view"));
+        }
+        rows = RunQuery(engine, txn_manager,
+                        "SELECT COUNT(*) FROM events WHERE kind = 'view';");
+        assert(rows.size() == 1);
+    };
+
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE events (id INT, kind VARCHAR(16)) "
+                 "WITH (storage = column);");
+        assert(catalog.GetTable("events")->storage == TableStorage::COLUMN);
+        for (int start = 0; start < num_rows; start += 500) {
+            std::string sql = "INSERT INTO events VALUES ";
+            for (int i = start; i < std::min(start + 500, num_rows); i++) {
+                if (i != start) {
+                    sql += ", ";
+                }
+                sql += "(" + std::to_string(i) + ", '" +
+                       (i % 2 == 0 ? "click" : "view") + "')";
+            }
+            RunQuery(&engine, &txn_manager, sql + ";");
+        }
+        ColumnStore* store = catalog.GetTable("events")->column_store.get();
+        assert(store->GetRowGroupCount() == 2);
+        assert(store->GetRowCount() == static_cast<size_t>(num_rows));
+        check_table(&engine, &txn_manager);
+
+        // Column tables are append-only
+        Parser parser("DELETE FROM events WHERE id = 1;");
+        auto statement = parser.Parse();
+        Transaction* txn = txn_manager.Begin();
+        std::vector<Tuple> result;
+        bool failed = false;
+        try {
+            failed = !engine.Execute(statement.get(), &result, txn);
+        } catch (const std::exception&) {
+            failed = true;
+        }
+        assert(failed);
+        txn_manager.Abort(txn);
+    }
+
+    // Row groups and the unsealed tail are read back after a restart
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        assert(catalog.GetTable("events")->storage == TableStorage::COLUMN);
+        check_table(&engine, &txn_manager);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Column store tests passed!" << std::endl;
+}
+
+void TestPageCompression() {
+    std::cout << "Testing page compression..." << std::endl;
+
+    // LZ4 round trip on a compressible page; incompressible data does not
+    // fit and corrupted payloads are rejected
+    std::vector<char> page(PAGE_SIZE), stored(PAGE_SIZE), decoded(PAGE_SIZE);
+    for (size_t i = 0; i < PAGE_SIZE; i++) {
+        page[i] = "the quick brown fox jumps over the lazy dog "[i % 44];
+    }
+    size_t compressed = CompressPage(7, PageCompression::LZ4, page.data(),
+                                     stored.data());
+    assert(compressed > 0 && compressed < PAGE_SIZE / 4);
+    assert(IsCompressedPage(stored.data()));
+    PageCompression codec = PageCompression::NONE;
+    assert(DecompressPage(7, stored.data(), decoded.data(), &codec));
+    assert(codec == PageCompression::LZ4);
+    assert(decoded == page);
+    assert(!DecompressPage(8, stored.data(), decoded.data(), &codec));
+    stored[compressed - 1] ^= 0x5A;
+    assert(!DecompressPage(7, stored.data(), decoded.data(), &codec));
+
+    std::vector<char> noise(PAGE_SIZE);
+    uint32_t state = 12345;
+    for (auto& byte : noise) {
+        state = state * 1103515245u + 12345u;
+        byte = static_cast<char>(state >> 24);
+    }
+    assert(CompressPage(7, PageCompression::LZ4, noise.data(),
+                        stored.data()) == 0);
+    assert(Lz4Decompress(noise.data(), 64, decoded.data(), PAGE_SIZE) ==
+           false);
+
+    PageCompression parsed;
+    assert(ParsePageCompression("LZ4", &parsed) &&
+           parsed == PageCompression::LZ4);
+    assert(!ParsePageCompression("zstd", &parsed));
+
+    // Registered pages read back unchanged; a page found compressed on disk
+    // is registered so it stays compressed when written again
+    const std::string db_name = "test_page_compression.db";
+    std::remove(db_name.c_str());
+    {
+        DiskManager disk_manager(db_name);
+        ExtentReservation extent;
+        extent.compression = PageCompression::LZ4;
+        page_id_t compressed_page = disk_manager.AllocatePage(&extent);
+        assert(disk_manager.GetPageCompression(compressed_page) ==
+               PageCompression::LZ4);
+        disk_manager.WritePage(compressed_page, page.data());
+        disk_manager.ReadPage(compressed_page, decoded.data());
+        assert(decoded == page);
+
+        page_id_t plain_page = disk_manager.AllocatePage();
+        assert(disk_manager.GetPageCompression(plain_page) ==
+               PageCompression::NONE);
+        compressed = CompressPage(plain_page, PageCompression::LZ4,
+                                  page.data(), stored.data());
+        std::memset(stored.data() + compressed, 0, PAGE_SIZE - compressed);
+        disk_manager.WritePage(plain_page, stored.data());
+        disk_manager.ReadPage(plain_page, decoded.data());
+        assert(decoded == page);
+        assert(disk_manager.GetPageCompression(plain_page) ==
+               PageCompression::LZ4);
+
+        disk_manager.DeallocatePage(compressed_page);
+        assert(disk_manager.GetPageCompression(compressed_page) ==
+               PageCompression::NONE);
+    }
+    std::remove(db_name.c_str());
+
+    // Tables created WITH (compression = lz4) keep the setting across restarts
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE notes (id INT, body VARCHAR(64)) "
+                 "WITH (compression = lz4);");
+        TableInfo* table_info = catalog.GetTable("notes");
+        assert(table_info->compression == PageCompression::LZ4);
+        assert(bpm->GetDiskManager()->GetPageCompression(
+                   table_info->first_page_id) == PageCompression::LZ4);
+        for (int start = 0; start < 2000; start += 200) {
+            std::string sql = "INSERT INTO notes VALUES ";
+            for (int i = start; i < start + 200; i++) {
+                sql += (i == start ? "(" : ", (") + std::to_string(i) +
+                       ", 'repeated note body text')";
+            }
+            RunQuery(&engine, &txn_manager, sql + ";");
+        }
+    }
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        assert(catalog.GetTable("notes")->compression == PageCompression::LZ4);
+        auto rows = RunQuery(&engine, &txn_manager,
+                             "SELECT id, body FROM notes WHERE id >= 1990;");
+        assert(rows.size() == 10);
+        for (const auto& row : rows) {
+            assert(std::get<std::string>(row.GetValue(1)) ==
+                   "repeated note body text");
+        }
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Page compression tests passed!" << std::endl;
+}
+
+void TestPageChecksums() {
+    std::cout << "Testing page checksums..." << std::endl;
+
+    // Standard CRC32C check value, and segmented computation matches
+    assert(Crc32c("123456789", 9) == 0xE3069283u);
+    assert(Crc32c("6789", 4, Crc32c("12345", 5)) == 0xE3069283u);
+
+    // Stamp/verify round trip; a zero field means no checksum yet
+    std::vector<char> page(PAGE_SIZE);
+    for (size_t i = 0; i < PAGE_SIZE; i++) {
+        page[i] = static_cast<char>(i * 31);
+    }
+    const size_t offset = TablePage::CHECKSUM_OFFSET;
+    std::memset(page.data() + offset, 0, sizeof(uint32_t));
+    assert(VerifyPageChecksum(page.data(), offset));
+    StampPageChecksum(page.data(), offset);
+    assert(VerifyPageChecksum(page.data(), offset));
+    page[PAGE_SIZE - 1] ^= 0x01;
+    assert(!VerifyPageChecksum(page.data(), offset));
+
+    const std::string db_name = "test_page_checksums.db";
+    std::remove(db_name.c_str());
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, 64, false, false}});
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            16, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(16));
+    };
+    // Flip one byte of a page directly in the file, bypassing the stamp
+    auto corrupt = [&db_name](page_id_t page_id, size_t pos) {
+        DiskManager disk(db_name);
+        std::vector<char> data(PAGE_SIZE);
+        disk.ReadPage(page_id, data.data());
+        data[pos] ^= 0x40;
+        disk.WritePage(page_id, data.data());
+    };
+
+    page_id_t first_page_id;
+    page_id_t root_page_id;
+    const int num_keys = 100;
+    {
+        auto bpm = make_bpm();
+        TableHeap heap(bpm.get(), &schema);
+        first_page_id = heap.GetFirstPageId();
+        for (int i = 0; i < 10; i++) {
+            Tuple tuple({Value(int32_t(i)), Value(std::string("row"))},
+                        &schema);
+            RID rid;
+            assert(heap.InsertTuple(tuple, &rid, INVALID_TXN_ID));
+        }
+        BPlusTree<int32_t, RID> tree("checksum_idx", bpm.get());
+        for (int i = 0; i < num_keys; i++) {
+            assert(tree.Insert(i, RID{i, 0}));
+        }
+        root_page_id = tree.GetRootPageId();
+        bpm->FlushAllPages();
+    }
+
+    // Intact pages read back normally after a restart
+    {
+        auto bpm = make_bpm();
+        TableHeap heap(bpm.get(), &schema, first_page_id);
+        Tuple tuple;
+        assert(heap.GetTuple(RID{first_page_id, 0}, &tuple, INVALID_TXN_ID));
+        assert(std::get<int32_t>(tuple.GetValue(0)) == 0);
+        BPlusTree<int32_t, RID> tree("checksum_idx", bpm.get(), root_page_id);
+        RID rid;
+        assert(tree.GetValue(num_keys - 1, &rid));
+        assert(rid.page_id == num_keys - 1);
+    }
+
+    // A corrupted table page raises instead of returning garbage
+    corrupt(first_page_id, PAGE_SIZE - 1);
+    {
+        auto bpm = make_bpm();
+        bool thrown = false;
+        try {
+            TableHeap heap(bpm.get(), &schema, first_page_id);
+            Tuple tuple;
+            heap.GetTuple(RID{first_page_id, 0}, &tuple, INVALID_TXN_ID);
+        } catch (const StorageException&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    // A corrupted index root is not trusted: the tree opens as empty
+    corrupt(root_page_id, PAGE_SIZE - 1);
+    {
+        auto bpm = make_bpm();
+        BPlusTree<int32_t, RID> tree("checksum_idx", bpm.get(), root_page_id);
+        RID rid;
+        assert(!tree.GetValue(0, &rid));
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Page checksums test passed!" << std::endl;
+}
+
+void TestInPlaceUpdate() {
+    std::cout << "Testing in-place update..." << std::endl;
+
+    const std::string db_name = "test_in_place_update.db";
+    std::remove(db_name.c_str());
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+
+    // Page level: growing the tuple next to the free space reuses its bytes,
+    // growing any other tuple moves it within the page; the RID never changes
+    {
+        auto bpm = make_bpm();
+        Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                       {"name", TypeId::VARCHAR, 64, false, false}});
+        TableHeap heap(bpm.get(), &schema);
+        RID first, last;
+        Tuple small({Value(int32_t(1)), Value(std::string(10, 'a'))}, &schema);
+        assert(heap.InsertTuple(small, &first, INVALID_TXN_ID));
+        assert(heap.InsertTuple(small, &last, INVALID_TXN_ID));
+        Page* page = bpm->FetchPage(last.page_id);
+        auto* table_page = reinterpret_cast<TablePage*>(page);
+        size_t free_before = table_page->GetFreeSpace();
+
+        Tuple grown({Value(int32_t(2)), Value(std::string(30, 'b'))}, &schema);
+        assert(table_page->UpdateTuple(grown, last));
+        assert(table_page->GetFreeSpace() == free_before - 20);
+        assert(table_page->UpdateTuple(grown, first));
+        assert(table_page->GetFreeSpace() == free_before - 40);
+        Tuple tuple;
+        assert(table_page->GetTuple(first, &tuple, &schema));
+        assert(std::get<std::string>(tuple.GetValue(1)) ==
+               std::string(30, 'b'));
+        assert(table_page->GetTuple(last, &tuple, &schema));
+        assert(std::get<std::string>(tuple.GetValue(1)) ==
+               std::string(30, 'b'));
+        bpm->UnpinPage(last.page_id, true);
+    }
+    std::remove(db_name.c_str());
+
+    // Executor level: non-key updates keep index entries, an update that no
+    // longer fits on its page moves the row and repoints every index
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        const size_t note_size = MAX_TUPLE_SIZE / 4;
+        const int num_rows = 64;
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE notes (id INT PRIMARY KEY, kind INT, note "
+                 "VARCHAR(" + std::to_string(MAX_TUPLE_SIZE) + "));");
+        for (int i = 0; i < num_rows; i++) {
+            RunQuery(&engine, &txn_manager,
+                     "INSERT INTO notes VALUES (" + std::to_string(i) + ", " +
+                         std::to_string(i % 2) + ", '" +
+                         std::string(note_size, 'n') + "');");
+        }
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX notes_kind ON notes (kind);");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX notes_id ON notes (id);");
+        TableHeap* heap = catalog.GetTable("notes")->table_heap.get();
+        auto rid_of = [heap](int32_t id) {
+            for (auto it = heap->Begin(); !it.IsEnd(); ++it) {
+                Tuple tuple = *it;
+                if (std::get<int32_t>(tuple.GetValue(0)) == id) {
+                    return tuple.GetRID();
+                }
+            }
+            assert(false);
+            return RID{};
+        };
+
+        // Row 0 sits at the end of a full page, so growing it past the
+        // slack left on the page cannot fit
+        const size_t long_size = MAX_TUPLE_SIZE - 32;
+        RID before = rid_of(0);
+        RunQuery(&engine, &txn_manager,
+                 "UPDATE notes SET note = '" + std::string(long_size, 'x') +
+                     "' WHERE id = 0;");
+        RID after = rid_of(0);
+        assert(!(after == before));
+
+        // Shrinking a row keeps it where it is
+        before = rid_of(3);
+        RunQuery(&engine, &txn_manager,
+                 "UPDATE notes SET note = 'short' WHERE id = 3;");
+        assert(rid_of(3) == before);
+        assert(std::get<std::string>(
+                   RunQuery(&engine, &txn_manager,
+                            "SELECT * FROM notes WHERE id = 3;")[0]
+                       .GetValue(2)) == "short");
+        auto rows = RunQuery(&engine, &txn_manager,
+                             "SELECT * FROM notes WHERE id = 0;");
+        assert(rows.size() == 1);
+        assert(std::get<std::string>(rows[0].GetValue(2)).size() ==
+               long_size);
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM notes WHERE kind = 0;")
+                   .size() == num_rows / 2);
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM notes;")
+                   .size() == num_rows);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "In-place update test passed!" << std::endl;
+}
+
+void TestVacuum() {
+    std::cout << "Testing page compaction and VACUUM..." << std::endl;
+
+    const std::string db_name = "test_vacuum.db";
+    std::remove(db_name.c_str());
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+
+    // Holes left by deletes count as free space; an insert that only fits
+    // after defragmenting compacts the page and keeps surviving RIDs
+    {
+        auto bpm = make_bpm();
+        Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                       {"name", TypeId::VARCHAR, 256, false, false}});
+        TableHeap heap(bpm.get(), &schema);
+        Page* page = bpm->FetchPage(heap.GetFirstPageId());
+        auto* table_page = reinterpret_cast<TablePage*>(page);
+        std::vector<RID> rids;
+        for (int i = 0;; i++) {
+            Tuple tuple({Value(int32_t(i)), Value(std::string(100, 'a'))},
+                        &schema);
+            RID rid;
+            if (!table_page->InsertTuple(tuple, &rid)) {
+                break;
+            }
+            rids.push_back(rid);
+        }
+        size_t full_free = table_page->GetFreeSpace();
+        for (size_t i = 0; i < rids.size(); i += 2) {
+            assert(table_page->DeleteTuple(rids[i]));
+        }
+        assert(table_page->GetFreeSpace() > full_free + 200);
+        Tuple big({Value(int32_t(-1)), Value(std::string(200, 'b'))}, &schema);
+        RID big_rid;
+        assert(table_page->InsertTuple(big, &big_rid));
+        assert(!table_page->Compact());
+        for (size_t i = 1; i < rids.size(); i += 2) {
+            Tuple tuple;
+            assert(table_page->GetTuple(rids[i], &tuple, &schema));
+            assert(std::get<int32_t>(tuple.GetValue(0)) ==
+                   static_cast<int32_t>(i));
+        }
+        bpm->UnpinPage(page->GetPageId(), true);
+    }
+    std::remove(db_name.c_str());
+
+    // VACUUM merges the sparse pages left by a large delete, frees them and
+    // repoints the index entries of every moved row
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        const int num_rows = static_cast<int>(PAGE_SIZE / 2);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE churn (id INT PRIMARY KEY, pad VARCHAR(64));");
+        std::string insert_sql = "INSERT INTO churn VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", '" +
+                          std::string(40, 'p') + "')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX churn_id ON churn (id);");
+        RunQuery(&engine, &txn_manager,
+                 "DELETE FROM churn WHERE id >= 50;");
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO churn VALUES (" + std::to_string(num_rows) +
+                     ", 'tail');");
+
+        TableHeap* heap = catalog.GetTable("churn")->table_heap.get();
+        size_t pages_before = heap->GetPageCount();
+        assert(pages_before > 10);
+        RunQuery(&engine, &txn_manager, "VACUUM churn;");
+        size_t pages_after = heap->GetPageCount();
+        assert(pages_after < pages_before / 4);
+
+        auto rows = RunQuery(&engine, &txn_manager, "SELECT * FROM churn;");
+        assert(rows.size() == 51);
+        for (int id : {0, 25, 49, num_rows}) {
+            auto found = RunQuery(&engine, &txn_manager,
+                                  "SELECT * FROM churn WHERE id = " +
+                                      std::to_string(id) + ";");
+            assert(found.size() == 1);
+            assert(std::get<int32_t>(found[0].GetValue(0)) == id);
+        }
+
+        // Freed pages are reused by later growth instead of extending
+        page_id_t next_before = bpm->GetDiskManager()->GetNumPages();
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO churn VALUES (" + std::to_string(num_rows + 1) +
+                     ", 'again');");
+        RunQuery(&engine, &txn_manager, "VACUUM;");
+        assert(bpm->GetDiskManager()->GetNumPages() == next_before);
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM churn;")
+                   .size() == 52);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Page compaction and VACUUM test passed!" << std::endl;
+}
+
+void TestCopy() {
+    std::cout << "Testing COPY FROM/TO..." << std::endl;
+
+    const std::string db_name = "test_copy.db";
+    const std::string csv_in = "test_copy_in.csv";
+    const std::string csv_out = "test_copy_out.csv";
+    const std::string bin_out = "test_copy_out.bin";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        for (const char* table : {"people", "people_csv", "people_bin"}) {
+            RunQuery(&engine, &txn_manager,
+                     std::string("CREATE TABLE ") + table +
+                         " (id INT PRIMARY KEY, name VARCHAR(64), score "
+                         "DOUBLE, active BOOLEAN);");
+            RunQuery(&engine, &txn_manager,
+                     std::string("CREATE INDEX ") + table + "_id ON " + table +
+                         " (id);");
+        }
+
+        // Large enough to span several chunks; the first rows exercise
+        // quoting, embedded newlines, NULLs and CRLF line endings
+        const int num_rows = static_cast<int>(2 * COPY_CHUNK_SIZE / 40);
+        {
+            std::ofstream csv(csv_in, std::ios::binary);
+            csv << "id,name,score,active\n";
+            csv << "0,\"Smith, \"\"Jo\"\"\",1.5,true\r\n";
+            csv << "1,\"two\nlines\",,f\n";
+            csv << "2,\"\",-0.25,0\n";
+            csv << "\n";
+            for (int i = 3; i < num_rows; i++) {
+                csv << i << ",name_" << i << "_padding," << i * 0.5 << ","
+                    << (i % 2 == 0 ? "true" : "false") << "\n";
+            }
+        }
+        auto copied = RunQuery(&engine, &txn_manager,
+                               "COPY people FROM '" + csv_in +
+                                   "' WITH (header = true);");
+        assert(copied.size() == 1);
+        assert(std::get<int32_t>(copied[0].GetValue(0)) == num_rows);
+
+        auto row = [&](const std::string& table, int id) {
+            auto rows = RunQuery(&engine, &txn_manager,
+                                 "SELECT * FROM " + table + " WHERE id = " +
+                                     std::to_string(id) + ";");
+            assert(rows.size() == 1);
+            return rows[0];
+        };
+        Tuple first = row("people", 0);
+        assert(std::get<std::string>(first.GetValue(1)) == "Smith, \"Jo\"");
+        assert(std::get<double>(first.GetValue(2)) == 1.5);
+        assert(std::get<bool>(first.GetValue(3)));
+        Tuple second = row("people", 1);
+        assert(std::get<std::string>(second.GetValue(1)) == "two\nlines");
+        assert(second.IsNull(2) && !first.IsNull(2));
+        Tuple third = row("people", 2);
+        assert(std::get<std::string>(third.GetValue(1)).empty());
+        assert(!third.IsNull(1));
+        assert(std::get<int32_t>(row("people", num_rows - 1).GetValue(0)) ==
+               num_rows - 1);
+
+        // Both formats round-trip every row, NULLs included
+        RunQuery(&engine, &txn_manager,
+                 "COPY people TO '" + csv_out + "' WITH (header = true);");
+        RunQuery(&engine, &txn_manager,
+                 "COPY people TO '" + bin_out + "' WITH (format = binary);");
+        RunQuery(&engine, &txn_manager,
+                 "COPY people_csv FROM '" + csv_out +
+                     "' WITH (header = true);");
+        RunQuery(&engine, &txn_manager,
+                 "COPY people_bin FROM '" + bin_out +
+                     "' WITH (format = binary);");
+        auto sorted_rows = [&](const std::string& table) {
+            auto rows =
+                RunQuery(&engine, &txn_manager, "SELECT * FROM " + table + ";");
+            std::sort(rows.begin(), rows.end(),
+                      [](const Tuple& a, const Tuple& b) {
+                          return std::get<int32_t>(a.GetValue(0)) <
+                                 std::get<int32_t>(b.GetValue(0));
+                      });
+            return rows;
+        };
+        auto original = sorted_rows("people");
+        assert(original.size() == static_cast<size_t>(num_rows));
+        for (const char* table : {"people_csv", "people_bin"}) {
+            auto copy = sorted_rows(table);
+            assert(copy.size() == original.size());
+            for (size_t i = 0; i < copy.size(); i++) {
+                assert(copy[i].GetValues() == original[i].GetValues());
+                for (size_t c = 0; c < 4; c++) {
+                    assert(copy[i].IsNull(c) == original[i].IsNull(c));
+                }
+            }
+            assert(std::get<std::string>(row(table, 1).GetValue(1)) ==
+                   "two\nlines");
+        }
+
+        // A bad value reports its line; the chunk holding it is not loaded
+        {
+            std::ofstream csv(csv_in, std::ios::binary);
+            csv << "100000,ok,1,true\n100001,bad,not_a_number,true\n";
+        }
+        Parser parser("COPY people FROM '" + csv_in + "';");
+        auto statement = parser.Parse();
+        Transaction* txn = txn_manager.Begin();
+        std::vector<Tuple> result;
+        bool threw = false;
+        try {
+            engine.Execute(statement.get(), &result, txn);
+        } catch (const ExecutionException& e) {
+            threw = std::string(e.what()).find("line 2") != std::string::npos;
+        }
+        txn_manager.Commit(txn);
+        assert(threw);
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM people WHERE id = 100000;")
+                   .empty());
+    }
+    std::remove(db_name.c_str());
+    std::remove(csv_in.c_str());
+    std::remove(csv_out.c_str());
+    std::remove(bin_out.c_str());
+
+    std::cout << "COPY FROM/TO test passed!" << std::endl;
+}
+
+// Test the read-only mmap mode: frames point into the file mapping, writes fail
+void TestMmapReadOnly() {
+    std::cout << "Testing mmap read-only mode..." << std::endl;
+
+    const std::string db_name = "test_mmap.db";
+    std::remove(db_name.c_str());
+    try {
+        DiskManager missing(db_name, DiskIOMode::MMAP);
+        assert(false);
+    } catch (const StorageException&) {
+    }
+    assert(!std::ifstream(db_name).good());
+
+    const int num_rows = 3000;
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE items (id INT PRIMARY KEY, name VARCHAR(64));");
+        RunQuery(&engine, &txn_manager, "CREATE INDEX items_id ON items (id);");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE packed (id INT, body VARCHAR(64)) "
+                 "WITH (compression = lz4);");
+        for (int start = 0; start < num_rows; start += 500) {
+            std::string items = "INSERT INTO items VALUES ";
+            std::string packed = "INSERT INTO packed VALUES ";
+            for (int i = start; i < start + 500; i++) {
+                std::string sep = i == start ? "" : ", ";
+                items += sep + "(" + std::to_string(i) + ", 'item_" +
+                         std::to_string(i) + "')";
+                packed += sep + "(" + std::to_string(i) +
+                          ", 'aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa')";
+            }
+            RunQuery(&engine, &txn_manager, items + ";");
+            RunQuery(&engine, &txn_manager, packed + ";");
+        }
+    }
+    auto read_file = [&db_name]() {
+        std::ifstream in(db_name, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in),
+                           std::istreambuf_iterator<char>());
+    };
+    const std::string before = read_file();
+
+    {
+        // A pool much smaller than the tables, so frames are reused
+        auto bpm = std::make_unique<BufferPoolManager>(
+            16, std::make_unique<DiskManager>(db_name, DiskIOMode::MMAP),
+            std::make_unique<LRUReplacer>(16));
+        DiskManager* disk_manager = bpm->GetDiskManager();
+        assert(disk_manager->GetIOMode() == DiskIOMode::MMAP);
+        assert(bpm->IsReadOnly());
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM items;").size() ==
+               num_rows);
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM packed;")
+                   .size() == num_rows);
+        for (int id : {0, 1234, num_rows - 1}) {
+            auto rows = RunQuery(&engine, &txn_manager,
+                                 "SELECT name FROM items WHERE id = " +
+                                     std::to_string(id) + ";");
+            assert(rows.size() == 1);
+            assert(std::get<std::string>(rows[0].GetValue(0)) ==
+                   "item_" + std::to_string(id));
+        }
+
+        // Uncompressed pages are used in place, compressed ones are copied
+        for (const char* table : {"items", "packed"}) {
+            page_id_t page_id =
+                catalog.GetTable(table)->table_heap->GetFirstPageId();
+            Page* page = bpm->FetchPage(page_id);
+            assert(page != nullptr);
+            const char* mapped = disk_manager->GetMappedPage(page_id);
+            assert(page->IsMapped() == (mapped != nullptr));
+            assert(mapped == nullptr || page->GetData() == mapped);
+            bpm->UnpinPage(page_id, false);
+        }
+
+        // Every kind of write is refused before anything is touched
+        page_id_t new_page_id;
+        assert(bpm->NewPage(&new_page_id) == nullptr);
+        assert(!bpm->DeletePage(2));
+        char buffer[PAGE_SIZE] = {};
+        try {
+            disk_manager->WritePage(0, buffer);
+            assert(false);
+        } catch (const StorageException&) {
+        }
+        for (const char* sql :
+             {"INSERT INTO items VALUES (99999, 'x');",
+              "UPDATE items SET name = 'y' WHERE id = 1;",
+              "DELETE FROM items WHERE id = 1;",
+              "CREATE TABLE other (id INT);", "DROP TABLE items;"}) {
+            Parser parser(sql);
+            auto statement = parser.Parse();
+            Transaction* txn = txn_manager.Begin();
+            std::vector<Tuple> result;
+            bool threw = false;
+            try {
+                engine.Execute(statement.get(), &result, txn);
+            } catch (const ExecutionException&) {
+                threw = true;
+            }
+            txn_manager.Commit(txn);
+            assert(threw);
+        }
+    }
+    assert(read_file() == before);
+    std::remove(db_name.c_str());
+
+    std::cout << "mmap read-only mode tests passed!" << std::endl;
+}
+
+// Test lazy startup: tables and indexes open without reading their pages,
+// and the warmup file brings the hot pages back in the background
+void TestLazyStartup() {
+    std::cout << "Testing lazy startup and warmup..." << std::endl;
+
+    const std::string db_name = "test_lazy_startup.db";
+    const std::string warmup_name = "test_lazy_startup.warmup";
+    std::remove(db_name.c_str());
+    std::remove(warmup_name.c_str());
+    const int num_rows = 2000;
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            256, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(256));
+    };
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE lazy (id INT, name VARCHAR(32));");
+        RunQuery(&engine, &txn_manager, "CREATE INDEX lazy_id ON lazy (id);");
+        for (int start = 0; start < num_rows; start += 500) {
+            std::string sql = "INSERT INTO lazy VALUES ";
+            for (int i = start; i < start + 500; i++) {
+                sql += std::string(i == start ? "" : ", ") + "(" +
+                       std::to_string(i) + ", 'row_" + std::to_string(i) +
+                       "')";
+            }
+            RunQuery(&engine, &txn_manager, sql + ";");
+        }
+    }
+
+    // The warmup file lists the resident page ids after a magic and a count
+    auto read_warmup = [&warmup_name]() {
+        std::ifstream in(warmup_name, std::ios::binary);
+        char magic[8];
+        uint32_t count = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char*>(&count), sizeof(count));
+        assert(in.good() && std::string(magic, 8) == "SRDBWARM");
+        std::vector<page_id_t> ids(count);
+        in.read(reinterpret_cast<char*>(ids.data()), count * sizeof(page_id_t));
+        assert(in.good());
+        return std::set<page_id_t>(ids.begin(), ids.end());
+    };
+
+    page_id_t first_page_id;
+    page_id_t root_page_id;
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        assert(catalog.AreIndexesTrusted());
+        TableManager table_manager(bpm.get(), &catalog);
+        first_page_id = catalog.GetTable("lazy")->table_heap->GetFirstPageId();
+        root_page_id = catalog.GetIndex("lazy_id")->root_page_id;
+
+        // Opening read neither the first table page nor the index root
+        assert(bpm->SaveWarmupFile(warmup_name));
+        std::set<page_id_t> resident = read_warmup();
+        assert(resident.count(first_page_id) == 0);
+        assert(resident.count(root_page_id) == 0);
+
+        // The deferred index is listed and opens on first use
+        IndexManager* index_manager = table_manager.GetIndexManager();
+        assert(index_manager->GetTableIndexes("lazy") ==
+               std::vector<std::string>{"lazy_id"});
+        assert(!index_manager->CreateIndex(
+            "lazy_id", "lazy", {"id"},
+            catalog.GetTable("lazy")->schema.get()));
+        std::vector<RID> rids;
+        assert(index_manager->FindEntry("lazy_id", {Value(1234)}, &rids));
+        assert(rids.size() == 1);
+        assert(bpm->SaveWarmupFile(warmup_name));
+        assert(read_warmup().count(root_page_id) == 1);
+
+        // Touch every table page, then save them all at shutdown
+        size_t rows = 0;
+        for (auto it = catalog.GetTable("lazy")->table_heap->Begin();
+             !it.IsEnd(); ++it) {
+            rows++;
+        }
+        assert(rows == num_rows);
+        assert(bpm->SaveWarmupFile(warmup_name));
+    }
+    std::set<page_id_t> saved = read_warmup();
+    assert(saved.count(first_page_id) == 1);
+    assert(saved.count(root_page_id) == 1);
+
+    {
+        auto bpm = make_bpm();
+        bpm->StartWarmup(warmup_name);
+        bpm->WaitForWarmup();
+        assert(bpm->GetWarmupPagesLoaded() == saved.size());
+        assert(bpm->SaveWarmupFile(warmup_name));
+        assert(read_warmup() == saved);
+
+        // A pool smaller than the file stops warming up once it is full
+        auto small_bpm = std::make_unique<BufferPoolManager>(
+            8, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(8));
+        small_bpm->StartWarmup(warmup_name);
+        small_bpm->WaitForWarmup();
+        assert(small_bpm->GetWarmupPagesLoaded() <= 8);
+        // A missing file is not an error
+        small_bpm->StartWarmup("test_lazy_startup.missing");
+        small_bpm->StopWarmup();
+    }
+    std::remove(db_name.c_str());
+    std::remove(warmup_name.c_str());
+
+    std::cout << "Lazy startup and warmup tests passed!" << std::endl;
+}
+
+// Test the warmup file order and the batched reload
+void TestWarmupDump() {
+    std::cout << "Testing warmup dump and restore..." << std::endl;
+
+    // Every replacer lists the frame it would evict next last
+    std::vector<std::unique_ptr<Replacer>> replacers;
+    replacers.push_back(std::make_unique<LRUReplacer>(8));
+    replacers.push_back(std::make_unique<ClockReplacer>(8));
+    replacers.push_back(std::make_unique<LRUKReplacer>(8, 2));
+    replacers.push_back(std::make_unique<TwoQReplacer>(8));
+    for (auto& replacer : replacers) {
+        for (size_t frame_id : {3, 1, 4, 5}) {
+            replacer->Unpin(frame_id);
+        }
+        replacer->Pin(1);
+        std::vector<size_t> order = replacer->GetRecencyOrder();
+        assert(order.size() == 3);
+        size_t victim;
+        assert(replacer->Victim(&victim));
+        assert(victim == order.back());
+    }
+    LRUReplacer lru(8);
+    for (size_t frame_id : {0, 1, 2}) {
+        lru.Unpin(frame_id);
+    }
+    lru.Pin(0);
+    lru.Unpin(0);
+    assert(lru.GetRecencyOrder() == (std::vector<size_t>{0, 2, 1}));
+
+    const std::string db_name = "test_warmup.db";
+    const std::string warmup_name = "test_warmup.warmup";
+    std::remove(db_name.c_str());
+    std::remove(warmup_name.c_str());
+    auto make_bpm = [&db_name](size_t pool_size) {
+        return std::make_unique<BufferPoolManager>(
+            pool_size, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(pool_size));
+    };
+    auto read_warmup = [](const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        in.seekg(8);
+        uint32_t count = 0;
+        in.read(reinterpret_cast<char*>(&count), sizeof(count));
+        std::vector<page_id_t> ids(count);
+        in.read(reinterpret_cast<char*>(ids.data()), count * sizeof(page_id_t));
+        assert(in.good());
+        return ids;
+    };
+    {
+        auto bpm = make_bpm(16);
+        for (int i = 0; i < 200; i++) {
+            page_id_t page_id;
+            Page* page = bpm->NewPage(&page_id);
+            assert(page != nullptr);
+            std::memcpy(page->GetData() + 64, &page_id, sizeof(page_id));
+            bpm->UnpinPage(page_id, true);
+        }
+        bpm->FlushAllPages();
+    }
+
+    // Pinned pages first, then the replacer from most to least recent
+    std::vector<page_id_t> saved;
+    {
+        auto bpm = make_bpm(64);
+        for (page_id_t page_id = 20; page_id < 60; page_id++) {
+            assert(bpm->FetchPage(page_id) != nullptr);
+            bpm->UnpinPage(page_id, false);
+        }
+        assert(bpm->FetchPage(25) != nullptr);
+        bpm->UnpinPage(25, false);
+        assert(bpm->FetchPage(30) != nullptr);
+        assert(bpm->SaveWarmupFile(warmup_name));
+        saved = read_warmup(warmup_name);
+        assert(saved.size() == 40);
+        assert((std::vector<page_id_t>(saved.begin(), saved.begin() + 4) ==
+                std::vector<page_id_t>{30, 25, 59, 58}));
+        assert(saved.back() == 20);
+        bpm->UnpinPage(30, false);
+
+        // The periodic dump keeps the file fresh
+        std::remove(warmup_name.c_str());
+        bpm->StartWarmupDump(warmup_name, std::chrono::milliseconds(10));
+        for (int i = 0; i < 200 && !std::ifstream(warmup_name).good(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        bpm->StopWarmupDump();
+        assert(read_warmup(warmup_name).size() == 40);
+    }
+
+    // A smaller pool reloads the hottest pages and keeps their order
+    {
+        auto bpm = make_bpm(16);
+        bpm->StartWarmup(warmup_name);
+        bpm->WaitForWarmup();
+        assert(bpm->GetWarmupPagesLoaded() == 16);
+        const std::string resaved_name = warmup_name + ".2";
+        assert(bpm->SaveWarmupFile(resaved_name));
+        std::vector<page_id_t> resaved = read_warmup(resaved_name);
+        std::remove(resaved_name.c_str());
+        assert(resaved.size() == 16);
+        assert(resaved[0] == 30 && resaved[1] == 25);
+        std::set<page_id_t> hottest(saved.begin(), saved.begin() + 16);
+        assert(std::set<page_id_t>(resaved.begin(), resaved.end()) == hottest);
+        for (page_id_t page_id : resaved) {
+            Page* page = bpm->FetchPage(page_id);
+            page_id_t marker;
+            std::memcpy(&marker, page->GetData() + 64, sizeof(marker));
+            assert(marker == page_id);
+            bpm->UnpinPage(page_id, false);
+        }
+    }
+
+    // Batched reads split at gaps and still land every page in its buffer
+    {
+        DiskManager disk_manager(db_name);
+        std::vector<std::vector<char>> buffers(6, std::vector<char>(PAGE_SIZE));
+        std::vector<page_id_t> ids = {40, 41, 42, 50, 51, 199};
+        std::vector<PageReadRequest> requests;
+        for (size_t i = 0; i < ids.size(); i++) {
+            requests.push_back({ids[i], buffers[i].data()});
+        }
+        disk_manager.ReadPages(requests);
+        for (size_t i = 0; i < ids.size(); i++) {
+            page_id_t marker;
+            std::memcpy(&marker, buffers[i].data() + 64, sizeof(marker));
+            assert(marker == ids[i]);
+        }
+    }
+    std::remove(db_name.c_str());
+    std::remove(warmup_name.c_str());
+
+    std::cout << "Warmup dump and restore tests passed!" << std::endl;
+}
+
+// Test WAL-shipping replication: base backup, streamed DML, read-only replica
+void TestReplication() {
+    std::cout << "Testing Replication..." << std::endl;
+
+    const std::string primary_db = "test_replication_primary.db";
+    const std::string primary_log = "test_replication_primary.log";
+    const std::string replica_db = "test_replication_replica.db";
+    std::remove(primary_db.c_str());
+    std::remove(replica_db.c_str());
+    LogManager::RemoveLogFiles(primary_log);
+    auto make_bpm = [](const std::string& db_name) {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+    auto insert_rows = [](ExecutionEngine* engine, TransactionManager* txns,
+                          int from, int to) {
+        for (int i = from; i < to; i++) {
+            RunQuery(engine, txns,
+                     "INSERT INTO rep VALUES (" + std::to_string(i) +
+                         ", 'row" + std::to_string(i) +
+                         "-padding-padding-padding');");
+        }
+    };
+
+    auto primary_bpm = make_bpm(primary_db);
+    LogManager log_manager(primary_log);
+    primary_bpm->SetLogManager(&log_manager);
+    LockManager primary_locks;
+    TransactionManager primary_txns(&primary_locks, &log_manager);
+    Catalog primary_catalog(primary_bpm.get(), &log_manager);
+    ExecutionEngine primary(primary_bpm.get(), &primary_catalog,
+                            &primary_txns, &log_manager);
+    RunQuery(&primary, &primary_txns,
+             "CREATE TABLE rep (id INT, name VARCHAR(64));");
+    RunQuery(&primary, &primary_txns, "CREATE INDEX rep_id ON rep (id);");
+    insert_rows(&primary, &primary_txns, 0, 100);
+
+    // Base backup: everything so far is in the data file
+    primary_catalog.SaveCatalogToDisk();
+    primary_bpm->FlushAllPages();
+    {
+        std::ifstream in(primary_db, std::ios::binary);
+        std::ofstream out(replica_db, std::ios::binary | std::ios::trunc);
+        out << in.rdbuf();
+    }
+
+    // Changes after the backup only exist in the primary's log; enough
+    // inserts to extend the table, same-size and growing updates, deletes
+    insert_rows(&primary, &primary_txns, 100, 500);
+    RunQuery(&primary, &primary_txns,
+             "UPDATE rep SET name = 'same-size-padding-padding-pad' "
+             "WHERE id < 50;");
+    RunQuery(&primary, &primary_txns,
+             "UPDATE rep SET name = 'a much longer value for this row, "
+             "longer than before' WHERE id >= 450;");
+    RunQuery(&primary, &primary_txns, "DELETE FROM rep WHERE id > 80 AND "
+                                      "id < 120;");
+
+    auto replica_bpm = make_bpm(replica_db);
+    LockManager replica_locks;
+    TransactionManager replica_txns(&replica_locks, nullptr);
+    Catalog replica_catalog(replica_bpm.get());
+    ExecutionEngine replica(replica_bpm.get(), &replica_catalog,
+                            &replica_txns);
+    replica.SetReplica(true);
+    ReplicaApplier applier(replica_bpm.get(), &replica_catalog,
+                           replica.GetTableManager());
+
+    WalSender sender(&log_manager, 0);
+    assert(sender.Start());
+    assert(sender.GetPort() != 0);
+    WalReceiver receiver(&applier, "127.0.0.1", sender.GetPort());
+    receiver.Start();
+
+    auto wait_for_replica = [&]() {
+        lsn_t target = log_manager.GetPersistentLSN();
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (applier.GetAppliedLSN() == INVALID_LSN ||
+               applier.GetAppliedLSN() < target) {
+            assert(std::chrono::steady_clock::now() < deadline);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    };
+    wait_for_replica();
+    assert(receiver.IsConnected());
+    assert(sender.GetReplicaCount() == 1);
+    assert(applier.GetSkippedRecordCount() == 0);
+    assert(applier.GetAppliedRecordCount() > 0);
+
+    // Changes made while connected are streamed as well
+    RunQuery(&primary, &primary_txns, "DELETE FROM rep WHERE id = 7;");
+    wait_for_replica();
+
+    auto snapshot = [](ExecutionEngine* engine, TransactionManager* txns) {
+        std::map<int32_t, std::string> rows;
+        for (const auto& tuple :
+             RunQuery(engine, txns, "SELECT * FROM rep;")) {
+            auto inserted = rows.emplace(std::get<int32_t>(tuple.GetValue(0)),
+                                         std::get<std::string>(tuple.GetValue(1)));
+            assert(inserted.second);
+            (void)inserted;
+        }
+        return rows;
+    };
+    auto primary_rows = snapshot(&primary, &primary_txns);
+    auto replica_rows = snapshot(&replica, &replica_txns);
+    assert(primary_rows.size() == 500 - 39 - 1);
+    assert(replica_rows == primary_rows);
+
+    // The replica's index follows the replayed rows
+    IndexManager* index_manager =
+        replica.GetTableManager()->GetIndexManager();
+    RID rid;
+    assert(index_manager->FindEntry("rep_id", Value(int32_t(300)), &rid));
+    assert(index_manager->FindEntry("rep_id", Value(int32_t(499)), &rid));
+    assert(!index_manager->FindEntry("rep_id", Value(int32_t(100)), &rid));
+    assert(!index_manager->FindEntry("rep_id", Value(int32_t(7)), &rid));
+    auto by_index =
+        RunQuery(&replica, &replica_txns, "SELECT * FROM rep WHERE id = 460;");
+    assert(by_index.size() == 1);
+
+    // Writes are refused on the replica
+    bool rejected = false;
+    try {
+        RunQuery(&replica, &replica_txns, "INSERT INTO rep VALUES (1000, 'x');");
+    } catch (const ExecutionException&) {
+        rejected = true;
+    }
+    assert(rejected);
+
+    receiver.Stop();
+    sender.Stop();
+    assert(!receiver.IsConnected());
+
+    std::remove(primary_db.c_str());
+    std::remove(replica_db.c_str());
+    LogManager::RemoveLogFiles(primary_log);
+    std::cout << "Replication tests passed!" << std::endl;
+}
+
+// Test hash and range partitioned tables: routing, pruning, DML and restart
+void TestPartitionedTables() {
+    std::cout << "Testing Partitioned Tables..." << std::endl;
+
+    // A bare MAXVALUE entry parses like VALUES LESS THAN (MAXVALUE) and
+    // must still be the last one
+    {
+        Parser parser(
+            "CREATE TABLE sales (id INT, day INT) PARTITION BY RANGE (day) "
+            "(VALUES LESS THAN (-5), VALUES LESS THAN (100), maxvalue);");
+        auto statement = parser.Parse();
+        const auto& scheme =
+            static_cast<CreateTableStatement*>(statement.get())
+                ->GetPartitionScheme();
+        assert(scheme != nullptr);
+        assert(scheme->type == PartitionType::RANGE);
+        assert(scheme->partition_count == 3);
+        assert(scheme->upper_bounds == (std::vector<int64_t>{-5, 100}));
+        bool rejected = false;
+        try {
+            Parser trailing(
+                "CREATE TABLE sales (id INT, day INT) PARTITION BY RANGE "
+                "(day) (MAXVALUE, VALUES LESS THAN (100));");
+            trailing.Parse();
+        } catch (const Exception&) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+
+    const std::string db_name = "test_partitioned_tables.db";
+    std::remove(db_name.c_str());
+    auto make_bpm = [&db_name]() {
+        return std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+    };
+    auto count_rows = [](TableInfo* table) {
+        size_t rows = 0;
+        for (auto it = table->table_heap->Begin(); !it.IsEnd(); ++it) {
+            rows++;
+        }
+        return rows;
+    };
+    auto affected = [](const std::vector<Tuple>& result) {
+        assert(result.size() == 1);
+        return std::get<int32_t>(result[0].GetValue(0));
+    };
+    auto explain = [](ExecutionEngine* engine, TransactionManager* txns,
+                      const std::string& sql) {
+        auto plan = RunQuery(engine, txns, "EXPLAIN " + sql);
+        return std::get<std::string>(plan[0].GetValue(0));
+    };
+    auto fails = [](ExecutionEngine* engine, TransactionManager* txns,
+                    const std::string& sql) {
+        Parser parser(sql);
+        auto statement = parser.Parse();
+        Transaction* txn = txns->Begin();
+        std::vector<Tuple> result;
+        bool success = true;
+        try {
+            success = engine->Execute(statement.get(), &result, txn);
+        } catch (const ExecutionException&) {
+            success = false;
+        }
+        txns->Abort(txn);
+        return !success;
+    };
+
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE users (id INT PRIMARY KEY, name VARCHAR(16)) "
+                 "PARTITION BY HASH (id) PARTITIONS 4;");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE events (ts INT, kind INT) PARTITION BY RANGE "
+                 "(ts) (VALUES LESS THAN (100), VALUES LESS THAN (200), "
+                 "VALUES LESS THAN (MAXVALUE));");
+        TableInfo* users = catalog.GetTable("users");
+        assert(users->partition_scheme != nullptr);
+        assert(catalog.GetPartitions(users).size() == 4);
+        assert(catalog.GetTable("users$p3")->parent_table == "users");
+        // The primary key is one index per partition
+        assert(catalog.GetIndex("users_pk") == nullptr);
+        assert(catalog.GetIndex("users_pk$p0") != nullptr);
+        // Only the columns of the partitioned tables are listed
+        assert(RunQuery(&engine, &txn_manager, "SHOW TABLES;").size() == 4);
+
+        std::string insert_sql = "INSERT INTO users VALUES ";
+        for (int i = 0; i < 400; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) +
+                          ", 'u" + std::to_string(i) + "')";
+        }
+        assert(RunQuery(&engine, &txn_manager, insert_sql + ";").size() ==
+               400);
+        insert_sql = "INSERT INTO events VALUES ";
+        for (int i = 0; i < 300; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                          std::to_string(i % 2) + ")";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+
+        // Every row lands in exactly one partition and the parent stays empty
+        size_t total = 0;
+        for (TableInfo* partition : catalog.GetPartitions(users)) {
+            size_t rows = count_rows(partition);
+            assert(rows > 0 && rows < 400);
+            total += rows;
+        }
+        assert(total == 400);
+        assert(count_rows(users) == 0);
+        for (size_t i = 0; i < 3; i++) {
+            assert(count_rows(catalog.GetTable(
+                       PartitionScheme::PartitionTableName("events", i))) ==
+                   100);
+        }
+
+        // Pruning: equality on the hash key and ranges on the range key
+        // touch one partition, everything else scans them all
+        assert(explain(&engine, &txn_manager,
+                       "SELECT * FROM users WHERE id = 7;")
+                   .find("Append") == std::string::npos);
+        assert(explain(&engine, &txn_manager, "SELECT * FROM users;")
+                   .find("Append (4 partitions") != std::string::npos);
+        assert(explain(&engine, &txn_manager,
+                       "SELECT * FROM events WHERE ts >= 120 AND ts < 150;")
+                   .find("Append") == std::string::npos);
+        assert(explain(&engine, &txn_manager,
+                       "SELECT * FROM events WHERE ts < 50 OR ts > 250;")
+                   .find("Append (2 partitions") != std::string::npos);
+
+        auto rows = RunQuery(&engine, &txn_manager,
+                             "SELECT * FROM users WHERE id = 7;");
+        assert(rows.size() == 1);
+        assert(std::get<std::string>(rows[0].GetValue(1)) == "u7");
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM users;")
+                   .size() == 400);
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM events WHERE ts >= 120 AND ts < 150;")
+                   .size() == 30);
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM events WHERE ts < 50 OR ts > 250;")
+                   .size() == 99);
+
+        // Several workers give the same answer
+        engine.SetParallelScanWorkers(3);
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM events WHERE kind = 1;")
+                   .size() == 150);
+        engine.SetParallelScanWorkers(1);
+
+        // UPDATE and DELETE report rows summed over the partitions
+        assert(affected(RunQuery(&engine, &txn_manager,
+                                 "UPDATE events SET kind = 5 WHERE ts >= 90 "
+                                 "AND ts < 110;")) == 20);
+        assert(affected(RunQuery(&engine, &txn_manager,
+                                 "DELETE FROM users WHERE id >= 100;")) ==
+               300);
+        assert(affected(RunQuery(&engine, &txn_manager,
+                                 "DELETE FROM events WHERE ts > 1000;")) ==
+               0);
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM users;")
+                   .size() == 100);
+
+        // Point lookups use the primary key index of the one partition
+        assert(explain(&engine, &txn_manager,
+                       "SELECT * FROM users WHERE id = 7;")
+                   .find("Index Scan") != std::string::npos);
+        // Rows cannot move between partitions
+        assert(fails(&engine, &txn_manager,
+                     "UPDATE users SET id = 1000 WHERE id = 7;"));
+        // Unique indexes must contain the partition column
+        assert(fails(&engine, &txn_manager,
+                     "CREATE UNIQUE INDEX users_name ON users (name);"));
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX events_kind ON events (kind);");
+        assert(catalog.GetIndex("events_kind$p2") != nullptr);
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM events WHERE kind = 5;")
+                   .size() == 20);
+    }
+
+    // A range table without MAXVALUE has no partition for large keys, and
+    // the partition schemes survive a restart
+    {
+        auto bpm = make_bpm();
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+        engine.SetParallelScanWorkers(1);
+
+        TableInfo* events = catalog.GetTable("events");
+        assert(events->partition_scheme != nullptr);
+        assert(events->partition_scheme->type == PartitionType::RANGE);
+        assert(events->partition_scheme->upper_bounds ==
+               (std::vector<int64_t>{100, 200}));
+        assert(catalog.GetTable("events$p1")->parent_table == "events");
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM users;")
+                   .size() == 100);
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT * FROM events WHERE kind = 5;")
+                   .size() == 20);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE logs (day INT, msg VARCHAR(8)) PARTITION BY "
+                 "RANGE (day) (VALUES LESS THAN (10), VALUES LESS THAN "
+                 "(20));");
+        RunQuery(&engine, &txn_manager, "INSERT INTO logs VALUES (5, 'a');");
+        assert(fails(&engine, &txn_manager,
+                     "INSERT INTO logs VALUES (25, 'b');"));
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM logs;")
+                   .size() == 1);
+
+        RunQuery(&engine, &txn_manager, "ANALYZE events;");
+        RunQuery(&engine, &txn_manager, "DROP TABLE users;");
+        assert(catalog.GetTable("users$p0") == nullptr);
+        assert(catalog.GetIndex("users_pk$p0") == nullptr);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Partitioned Tables tests passed!" << std::endl;
+}
+
+// Test bitmap index scans: RID bitmap operations, AND/OR plans and results
+void TestBitmapIndexScan() {
+    std::cout << "Testing Bitmap Index Scan..." << std::endl;
+
+    // Sparse pages stay arrays, dense pages become bitsets; results come
+    // back ordered by page and slot either way
+    auto collect = [](const RidBitmap& bitmap) {
+        std::vector<std::pair<page_id_t, slot_offset_t>> rids;
+        RidBitmap::Iterator it(&bitmap);
+        RID rid;
+        while (it.Next(&rid)) {
+            rids.emplace_back(rid.page_id, rid.slot_num);
+        }
+        return rids;
+    };
+    RidBitmap evens;
+    RidBitmap threes;
+    for (slot_offset_t slot = 0; slot < 300; slot++) {
+        if (slot % 2 == 0) {
+            evens.Add(RID{7, slot});
+        }
+        if (slot % 3 == 0) {
+            threes.Add(RID{7, slot});
+        }
+    }
+    threes.Add(RID{9, 5});
+    threes.Add(RID{3, 1});
+    threes.Add(RID{3, 1});
+    assert(evens.GetCardinality() == 150);
+    assert(threes.GetCardinality() == 102);
+    assert(threes.Contains(RID{9, 5}) && !threes.Contains(RID{9, 6}));
+    auto ordered = collect(threes);
+    assert(ordered.front() == std::make_pair(page_id_t{3}, slot_offset_t{1}));
+    assert(ordered.back() == std::make_pair(page_id_t{9}, slot_offset_t{5}));
+    assert(std::is_sorted(ordered.begin(), ordered.end()));
+
+    RidBitmap both = evens;
+    both.IntersectWith(threes);
+    assert(both.GetCardinality() == 50);
+    assert(both.GetPageCount() == 1);
+    for (const auto& [page_id, slot] : collect(both)) {
+        assert(page_id == 7 && slot % 6 == 0);
+    }
+    RidBitmap either = evens;
+    either.UnionWith(threes);
+    assert(either.GetCardinality() == 150 + 102 - 50);
+    either.Remove(RID{3, 1});
+    either.Remove(RID{3, 1});
+    assert(either.GetPageCount() == 2 && !either.Contains(RID{3, 1}));
+
+    const std::string db_name = "test_bitmap_scan.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        const int num_rows = 2000;
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE orders (id INT PRIMARY KEY, customer INT, "
+                 "status INT, amount INT);");
+        std::string insert_sql = "INSERT INTO orders VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                          std::to_string(i % 50) + ", " +
+                          std::to_string(i % 7) + ", " +
+                          std::to_string((i * 13) % 1000) + ")";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX orders_customer ON orders (customer);");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX orders_status ON orders (status);");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX orders_amount ON orders (amount);");
+
+        auto explain = [&](const std::string& sql) {
+            auto plan = RunQuery(&engine, &txn_manager, "EXPLAIN " + sql);
+            return std::get<std::string>(plan[0].GetValue(0));
+        };
+        auto ids = [&](const std::string& sql) {
+            std::vector<int32_t> result;
+            for (const auto& row : RunQuery(&engine, &txn_manager, sql)) {
+                result.push_back(std::get<int32_t>(row.GetValue(0)));
+            }
+            return result;
+        };
+        auto expected = [num_rows](auto matches) {
+            std::vector<int32_t> result;
+            for (int32_t i = 0; i < num_rows; i++) {
+                if (matches(i)) {
+                    result.push_back(i);
+                }
+            }
+            return result;
+        };
+
+        // Two equality conditions on different indexes are intersected,
+        // rows come back in physical (insertion) order
+        const std::string and_sql =
+            "SELECT * FROM orders WHERE customer = 3 AND status = 3;";
+        std::string plan = explain(and_sql);
+        assert(plan.find("Bitmap Heap Scan") != std::string::npos);
+        assert(plan.find("orders_customer AND orders_status") !=
+                   std::string::npos ||
+               plan.find("orders_status AND orders_customer") !=
+                   std::string::npos);
+        assert(ids(and_sql) == expected([](int32_t i) {
+                   return i % 50 == 3 && i % 7 == 3;
+               }));
+
+        // OR cannot use a single index at all
+        const std::string or_sql =
+            "SELECT * FROM orders WHERE customer = 1 OR status = 6 OR "
+            "amount < 20;";
+        assert(explain(or_sql).find("Bitmap Heap Scan") != std::string::npos);
+        assert(ids(or_sql) == expected([](int32_t i) {
+                   return i % 50 == 1 || i % 7 == 6 || (i * 13) % 1000 < 20;
+               }));
+
+        // Ranges, nested OR inside AND, and conditions no index can use
+        const std::string mixed_sql =
+            "SELECT * FROM orders WHERE amount >= 100 AND amount < 300 AND "
+            "(customer = 4 OR customer = 5) AND id <> 104;";
+        assert(explain(mixed_sql).find("Bitmap Heap Scan") !=
+               std::string::npos);
+        assert(ids(mixed_sql) == expected([](int32_t i) {
+                   int32_t amount = (i * 13) % 1000;
+                   return amount >= 100 && amount < 300 &&
+                          (i % 50 == 4 || i % 50 == 5) && i != 104;
+               }));
+        assert(ids("SELECT * FROM orders WHERE customer = 3 AND status = 3 "
+                   "AND amount > 5000;")
+                   .empty());
+
+        // A unique key lookup already pinpoints the row; one indexed
+        // condition or an OR with an unindexed branch keep their plans
+        assert(explain("SELECT * FROM orders WHERE id = 10 AND status = 3;")
+                   .find("Index Scan") != std::string::npos);
+        assert(explain("SELECT * FROM orders WHERE customer = 3;")
+                   .find("Bitmap") == std::string::npos);
+        assert(explain("SELECT * FROM orders WHERE customer = 3 OR id <> 5;")
+                   .find("Seq Scan") != std::string::npos);
+
+        // Rows changed after the bitmap's index lookups are rechecked
+        RunQuery(&engine, &txn_manager,
+                 "UPDATE orders SET status = 0 WHERE customer = 3;");
+        assert(ids(and_sql).empty());
+
+        // Parameters bind into the cached bitmap plan on every execution
+        RunQuery(&engine, &txn_manager,
+                 "PREPARE find_orders AS SELECT * FROM orders WHERE "
+                 "customer = $1 AND status = $2;");
+        for (int32_t customer : {7, 8}) {
+            auto rows = ids("EXECUTE find_orders (" + std::to_string(customer) +
+                            ", 2);");
+            assert(rows == expected([customer](int32_t i) {
+                       return i % 50 == customer && i % 7 == 2;
+                   }));
+        }
+        assert(engine.GetPreparedStatement("find_orders")->GetPlanCount() ==
+               1);
+
+        // With statistics the planner still picks the bitmap scan for a
+        // selective combination
+        RunQuery(&engine, &txn_manager, "ANALYZE orders;");
+        assert(explain(and_sql).find("Bitmap Heap Scan") != std::string::npos);
+        assert(explain("SELECT * FROM orders WHERE status = 1 OR status = 2 "
+                       "OR amount >= 0;")
+                   .find("Seq Scan") != std::string::npos);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Bitmap Index Scan tests passed!" << std::endl;
+}
+
+// Test the query result cache: table modification counters bumped by DML,
+// invalidation, memory budget and capturing streamed rows
+void TestResultCache() {
+    std::cout << "Testing Result Cache..." << std::endl;
+
+    const std::string db_name = "test_result_cache.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE metrics (id INT PRIMARY KEY, v INT);");
+        auto count_of = [&catalog](const std::string& table) {
+            uint64_t count = 0;
+            bool found = catalog.GetModificationCount(table, &count);
+            assert(found);
+            (void)found;
+            return count;
+        };
+
+        // Every statement that changes rows bumps the counter; reads and
+        // statements that change nothing leave it alone
+        uint64_t count = count_of("metrics");
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO metrics VALUES (1, 10), (2, 20), (3, 30);");
+        assert(count_of("metrics") > count);
+        count = count_of("metrics");
+        RunQuery(&engine, &txn_manager, "SELECT * FROM metrics;");
+        RunQuery(&engine, &txn_manager,
+                 "DELETE FROM metrics WHERE id = 99;");
+        assert(count_of("metrics") == count);
+        RunQuery(&engine, &txn_manager,
+                 "UPDATE metrics SET v = 11 WHERE id = 1;");
+        assert(count_of("metrics") > count);
+        count = count_of("metrics");
+        uint64_t missing;
+        assert(!catalog.GetModificationCount("nope", &missing));
+
+        // The transaction remembers what it wrote so the committer can
+        // bump the counters again after the commit
+        {
+            Parser parser("DELETE FROM metrics WHERE id = 3;");
+            auto statement = parser.Parse();
+            Transaction* txn = txn_manager.Begin();
+            std::vector<Tuple> result;
+            assert(engine.Execute(statement.get(), &result, txn));
+            oid_t oid = catalog.GetTable("metrics")->table_oid;
+            assert(txn->GetModifiedTables().count(oid) == 1);
+            txn_manager.Commit(txn);
+            assert(count_of("metrics") > count);
+            catalog.BumpModificationCount(oid);
+        }
+
+        // Writes to a partition also invalidate the partitioned table
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE shards (id INT, v INT) PARTITION BY HASH (id) "
+                 "PARTITIONS 2;");
+        uint64_t parent_count = count_of("shards");
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO shards VALUES (1, 1), (2, 2), (3, 3);");
+        assert(count_of("shards") > parent_count);
+
+        // Keys differ by literal value and type
+        std::string fp = "SELECT * FROM metrics WHERE id = $1";
+        assert(ResultCache::MakeKey(fp, {Value(int32_t{5})}) !=
+               ResultCache::MakeKey(fp, {Value(int64_t{5})}));
+        assert(ResultCache::MakeKey(fp, {Value(std::string("ab")),
+                                         Value(std::string("c"))}) !=
+               ResultCache::MakeKey(fp, {Value(std::string("a")),
+                                         Value(std::string("bc"))}));
+        assert(ResultCache::MakeKey(fp, {Value(int32_t{5})}) ==
+               ResultCache::MakeKey(fp, {Value(int32_t{5})}));
+
+        ResultCache cache(1 << 20);
+        auto cache_query = [&](const std::string& key, const std::string& sql) {
+            ResultCache::TableVersions versions;
+            uint64_t schema_version = catalog.GetSchemaVersion();
+            bool captured =
+                ResultCache::CaptureVersions(&catalog, {"metrics"}, &versions);
+            assert(captured);
+            (void)captured;
+            cache.Insert(key, schema_version, std::move(versions),
+                         RunQuery(&engine, &txn_manager, sql));
+        };
+        ResultCache::TableVersions versions;
+        assert(!ResultCache::CaptureVersions(&catalog, {"metrics", "nope"},
+                                             &versions));
+
+        const std::string sum_sql = "SELECT SUM(v) FROM metrics;";
+        std::vector<Tuple> rows;
+        assert(!cache.Lookup("sum", &catalog, &rows));
+        cache_query("sum", sum_sql);
+        assert(cache.Lookup("sum", &catalog, &rows));
+        assert(rows.size() == 1);
+        Value cached_sum = rows[0].GetValue(0);
+        assert(cache.Lookup("sum", &catalog, &rows));
+        assert(cache.GetStats().hits == 2 && cache.GetStats().entries == 1);
+
+        // A write to the table drops the cached result, the next run sees
+        // the new data
+        RunQuery(&engine, &txn_manager, "INSERT INTO metrics VALUES (4, 40);");
+        assert(!cache.Lookup("sum", &catalog, &rows));
+        assert(cache.GetStats().invalidations == 1);
+        assert(cache.GetStats().entries == 0 && cache.GetStats().bytes == 0);
+        cache_query("sum", sum_sql);
+        assert(cache.Lookup("sum", &catalog, &rows));
+        assert(rows[0].GetValue(0) != cached_sum);
+
+        // So does a schema change, even on another table
+        RunQuery(&engine, &txn_manager, "CREATE TABLE other (id INT);");
+        assert(!cache.Lookup("sum", &catalog, &rows));
+
+        // The least recently used result goes first when over budget, and a
+        // result over a quarter of the budget is not cached at all
+        std::string big_insert = "INSERT INTO metrics VALUES ";
+        for (int i = 100; i < 400; i++) {
+            big_insert += (i > 100 ? ", (" : "(") + std::to_string(i) + ", " +
+                          std::to_string(i) + ")";
+        }
+        RunQuery(&engine, &txn_manager, big_insert + ";");
+        const std::string all_sql = "SELECT * FROM metrics;";
+        size_t row_bytes =
+            ResultCache::EstimateRowBytes(RunQuery(&engine, &txn_manager,
+                                                   all_sql)[0]);
+        const size_t budget = (row_bytes * 303 + 2048) * 4;
+        cache.SetCapacity(budget);
+        cache_query("all_a", all_sql);
+        cache_query("all_b", all_sql);
+        cache_query("sum", sum_sql);
+        assert(cache.GetStats().entries == 3);
+        assert(cache.Lookup("all_a", &catalog, &rows) && rows.size() == 303);
+        cache_query("all_c", all_sql);
+        cache_query("all_d", all_sql);
+        cache_query("all_e", all_sql);
+        assert(cache.GetStats().evictions > 0);
+        assert(cache.GetStats().bytes <= budget);
+        assert(!cache.Lookup("all_b", &catalog, &rows));
+        assert(cache.Lookup("all_a", &catalog, &rows));
+        cache.SetCapacity(row_bytes * 303 * 2);
+        cache.Clear();
+        cache_query("all_a", all_sql);
+        assert(!cache.Lookup("all_a", &catalog, &rows));
+        cache.SetCapacity(0);
+        assert(cache.GetMaxEntryBytes() == 0);
+
+        // Streamed rows are copied on their way to the client; a result
+        // over the limit is passed through but not kept
+        ChunkRecordingSink downstream;
+        ResultCaptureSink capture(&downstream, row_bytes * 1000);
+        Parser parser(all_sql);
+        auto statement = parser.Parse();
+        Transaction* txn = txn_manager.Begin();
+        std::vector<Tuple> result;
+        assert(engine.Execute(statement.get(), &result, txn, &capture));
+        txn_manager.Commit(txn);
+        capture.Capture(result);
+        assert(capture.IsComplete());
+        assert(capture.TakeRows().size() == 303);
+        assert(downstream.ids.size() == 303);
+
+        ResultCaptureSink small(&downstream, row_bytes * 10);
+        std::vector<Tuple> chunk = RunQuery(&engine, &txn_manager, all_sql);
+        assert(small.Consume(&chunk));
+        assert(!small.IsComplete() && small.TakeRows().empty());
+        assert(downstream.ids.size() == 606);
+    }
+    std::remove(db_name.c_str());
+    std::cout << "Result cache test passed!" << std::endl;
+}
+
+// Test query cancellation: the token, executors stopping on it, SET and KILL
+void TestQueryCancellation() {
+    std::cout << "Testing Query Cancellation..." << std::endl;
+
+    // A token installs itself for the thread; the first reason sticks
+    assert(CancellationToken::Current() == nullptr);
+    {
+        CancellationToken token;
+        assert(CancellationToken::Current() == &token);
+        assert(!token.IsCancelled());
+        token.Cancel(CancelReason::USER_REQUEST);
+        token.Cancel(CancelReason::STATEMENT_TIMEOUT);
+        assert(token.IsCancelled());
+        assert(token.GetReason() == CancelReason::USER_REQUEST);
+        bool thrown = false;
+        try {
+            token.ThrowIfCancelled();
+        } catch (const QueryCancelledException& e) {
+            thrown = e.GetReason() == CancelReason::USER_REQUEST;
+        }
+        assert(thrown);
+    }
+    assert(CancellationToken::Current() == nullptr);
+    {
+        CancellationToken token;
+        token.SetTimeout(0);
+        assert(!token.IsCancelled());
+        token.SetTimeout(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        assert(token.IsCancelled());
+        assert(token.GetReason() == CancelReason::STATEMENT_TIMEOUT);
+    }
+
+    const std::string db_name = "test_query_cancellation.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE big (id INT PRIMARY KEY, grp INT);");
+        const int num_rows = 3000;
+        for (int start = 0; start < num_rows; start += 500) {
+            std::string insert_sql = "INSERT INTO big VALUES ";
+            for (int i = start; i < start + 500; i++) {
+                insert_sql += (i == start ? "(" : ", (") + std::to_string(i) +
+                              ", " + std::to_string(i % 10) + ")";
+            }
+            RunQuery(&engine, &txn_manager, insert_sql + ";");
+        }
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE groups (gid INT, label INT);");
+        RunQuery(&engine, &txn_manager,
+                 "INSERT INTO groups VALUES (1, 10), (2, 20), (3, 30);");
+
+        // Executors either fail Next or throw from Init; both abort the query
+        auto run = [&](const std::string& sql) {
+            Parser parser(sql);
+            auto statement = parser.Parse();
+            Transaction* txn = txn_manager.Begin();
+            std::vector<Tuple> result;
+            bool success;
+            try {
+                success = engine.Execute(statement.get(), &result, txn);
+            } catch (const QueryCancelledException&) {
+                success = false;
+            }
+            if (success) {
+                txn_manager.Commit(txn);
+            } else {
+                txn_manager.Abort(txn);
+            }
+            return success;
+        };
+        const std::vector<std::string> queries = {
+            "SELECT * FROM big;",
+            "SELECT id FROM big WHERE grp = 3;",
+            "SELECT id FROM big WHERE id >= 10;",
+            "SELECT grp, COUNT(*) FROM big GROUP BY grp;",
+            "SELECT id FROM big ORDER BY grp DESC;",
+            "SELECT id, label FROM big JOIN groups ON grp = gid;",
+            "UPDATE big SET grp = 0 WHERE grp = 1;",
+        };
+        {
+            CancellationToken token;
+            token.Cancel(CancelReason::USER_REQUEST);
+            for (const auto& sql : queries) {
+                assert(!run(sql));
+            }
+            engine.SetParallelScanWorkers(2);
+            assert(!run("SELECT id FROM big WHERE grp = 3;"));
+            engine.SetParallelScanWorkers(1);
+        }
+        // Nothing was changed by the cancelled UPDATE
+        assert(RunQuery(&engine, &txn_manager,
+                        "SELECT id FROM big WHERE grp = 1;")
+                   .size() == num_rows / 10);
+        {
+            CancellationToken token;
+            token.SetTimeout(60000);
+            for (const auto& sql : queries) {
+                assert(run(sql));
+            }
+        }
+        for (const auto& sql : queries) {
+            assert(run(sql));
+        }
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM big;").size() ==
+               static_cast<size_t>(num_rows));
+    }
+    std::remove(db_name.c_str());
+
+    // SET keeps the value as text; KILL takes a quoted session id
+    {
+        Parser parser("SET Statement_Timeout = 5000;");
+        auto statement = parser.Parse();
+        assert(statement->GetType() == Statement::StmtType::SET_VARIABLE);
+        auto* set = static_cast<SetStatement*>(statement.get());
+        assert(set->GetName() == "statement_timeout");
+        assert(set->GetValue() == "5000");
+    }
+    {
+        Parser parser("SET statement_timeout TO '2s';");
+        auto statement = parser.Parse();
+        assert(static_cast<SetStatement*>(statement.get())->GetValue() ==
+               "2s");
+    }
+    for (const char* sql : {"KILL QUERY 'abc123';", "kill 'abc123';"}) {
+        Parser parser(sql);
+        auto statement = parser.Parse();
+        assert(statement->GetType() == Statement::StmtType::KILL);
+        assert(static_cast<KillStatement*>(statement.get())->GetSessionId() ==
+               "abc123");
+    }
+    {
+        bool rejected = false;
+        try {
+            Parser parser("KILL abc123;");
+            parser.Parse();
+        } catch (const std::exception&) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+    std::cout << "Query cancellation test passed!" << std::endl;
+}
+
+void TestMemoryTracker() {
+    std::cout << "Testing Memory Tracker..." << std::endl;
+
+    // Every level sees the charge; a refused charge leaves nothing behind
+    {
+        MemoryTracker server("server", nullptr, 1000);
+        MemoryTracker session("session", &server);
+        {
+            MemoryTracker query("query", &session, 600);
+            assert(query.TryConsume(500));
+            assert(session.GetUsage() == 500 && server.GetUsage() == 500);
+            assert(!query.TryConsume(200));
+            assert(query.GetUsage() == 500 && server.GetUsage() == 500);
+
+            MemoryTracker other("query", &session);
+            bool thrown = false;
+            try {
+                other.Consume(600);
+            } catch (const MemoryLimitExceededException& e) {
+                thrown = std::string(e.what()).find("server memory limit") !=
+                         std::string::npos;
+            }
+            assert(thrown);
+            assert(!other.GetLimitError().empty());
+            assert(query.GetLimitError().empty());
+            assert(server.GetUsage() == 500);
+            other.Consume(400);
+            assert(server.GetUsage() == 900);
+            query.Release(500);
+            assert(server.GetUsage() == 400 && query.GetPeak() == 500);
+        }
+        // Destroyed trackers hand back what they still held
+        assert(session.GetUsage() == 0 && server.GetUsage() == 0);
+        assert(server.GetPeak() == 900);
+    }
+
+    // Reservations move in whole chunks
+    {
+        MemoryTracker query("query");
+        {
+            MemoryReservation reservation(&query);
+            assert(reservation.TryResize(10));
+            assert(query.GetUsage() == MEMORY_RESERVATION_CHUNK);
+            assert(reservation.TryResize(MEMORY_RESERVATION_CHUNK));
+            assert(query.GetUsage() == MEMORY_RESERVATION_CHUNK);
+            assert(reservation.TryResize(MEMORY_RESERVATION_CHUNK + 1));
+            assert(query.GetUsage() == 2 * MEMORY_RESERVATION_CHUNK);
+            assert(reservation.TryResize(0));
+            assert(query.GetUsage() == 0);
+            reservation.Resize(3 * MEMORY_RESERVATION_CHUNK);
+            query.SetLimit(4 * MEMORY_RESERVATION_CHUNK);
+            assert(!reservation.TryResize(5 * MEMORY_RESERVATION_CHUNK));
+            assert(query.GetUsage() == 3 * MEMORY_RESERVATION_CHUNK);
+            bool thrown = false;
+            try {
+                reservation.Resize(5 * MEMORY_RESERVATION_CHUNK);
+            } catch (const MemoryLimitExceededException&) {
+                thrown = true;
+            }
+            assert(thrown);
+        }
+        assert(query.GetUsage() == 0);
+
+        // work_mem only ever lowers the plan's budget
+        ExecutorContext exec_ctx(nullptr, nullptr, nullptr, nullptr);
+        assert(exec_ctx.GetOperatorBudget(1 << 20) == size_t(1) << 20);
+        exec_ctx.SetMemoryTracker(&query);
+        assert(exec_ctx.GetOperatorBudget(1 << 20) == size_t(1) << 20);
+        query.SetOperatorBudget(4096);
+        assert(exec_ctx.GetOperatorBudget(1 << 20) == 4096);
+        assert(exec_ctx.GetOperatorBudget(100) == 100);
+    }
+
+    const std::string db_name = "test_memory_tracker.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager, "CREATE TABLE big (id INT, grp INT);");
+        const int num_rows = 3000;
+        for (int start = 0; start < num_rows; start += 500) {
+            std::string insert_sql = "INSERT INTO big VALUES ";
+            for (int i = start; i < start + 500; i++) {
+                insert_sql += (i == start ? "(" : ", (") + std::to_string(i) +
+                              ", " + std::to_string(i % 10) + ")";
+            }
+            RunQuery(&engine, &txn_manager, insert_sql + ";");
+        }
+        TableInfo* big = catalog.GetTable("big");
+
+        // A materialized result larger than the query limit fails cleanly
+        {
+            MemoryTracker query("query", nullptr, 4096);
+            MemoryTracker::Scope scope(&query);
+            Parser parser("SELECT * FROM big;");
+            auto statement = parser.Parse();
+            Transaction* txn = txn_manager.Begin();
+            std::vector<Tuple> result;
+            assert(!engine.Execute(statement.get(), &result, txn));
+            txn_manager.Abort(txn);
+            assert(query.GetLimitError().find("query memory limit") !=
+                   std::string::npos);
+        }
+        {
+            MemoryTracker query("query");
+            MemoryTracker::Scope scope(&query);
+            assert(RunQuery(&engine, &txn_manager, "SELECT * FROM big;")
+                       .size() == static_cast<size_t>(num_rows));
+            assert(query.GetUsage() > 0);
+        }
+
+        // A sort well inside its plan budget spills once the tracker says no
+        {
+            MemoryTracker query("query", nullptr,
+                                2 * MEMORY_RESERVATION_CHUNK);
+            std::vector<SortPlanNode::SortKey> keys;
+            keys.push_back(
+                {std::make_unique<ColumnRefExpression>("", "grp"), true});
+            keys.push_back(
+                {std::make_unique<ColumnRefExpression>("", "id"), true});
+            auto sort_plan = std::make_unique<SortPlanNode>(
+                std::make_unique<SeqScanPlanNode>(big->schema.get(), "big"),
+                std::move(keys), -1);
+            Transaction* txn = txn_manager.Begin();
+            ExecutorContext exec_ctx(txn, &catalog, bpm.get(), nullptr);
+            exec_ctx.SetMemoryTracker(&query);
+            {
+                SortExecutor executor(&exec_ctx, std::move(sort_plan));
+                executor.Init();
+                assert(executor.IsSpilled());
+                Tuple tuple;
+                RID rid;
+                int count = 0;
+                int previous = -1;
+                while (executor.Next(&tuple, &rid)) {
+                    int grp = std::get<int32_t>(tuple.GetValue(1));
+                    assert(grp >= previous);
+                    previous = grp;
+                    count++;
+                }
+                assert(count == num_rows);
+            }
+            assert(query.GetUsage() == 0);
+            txn_manager.Commit(txn);
+        }
+
+        // DELETE writes the row ids past work_mem to temporary pages and
+        // still deletes every row
+        {
+            MemoryTracker query("query");
+            query.SetOperatorBudget(4096);
+            Transaction* txn = txn_manager.Begin();
+            ExecutorContext exec_ctx(txn, &catalog, bpm.get(), nullptr);
+            exec_ctx.SetMemoryTracker(&query);
+            std::vector<Column> columns = {
+                Column{"deleted", TypeId::INTEGER, 0, false, false}};
+            auto delete_plan = std::make_unique<DeletePlanNode>(
+                std::make_unique<Schema>(columns), "big");
+            {
+                DeleteExecutor executor(&exec_ctx, std::move(delete_plan));
+                executor.Init();
+                assert(executor.IsTargetSpilled());
+                assert(query.GetPeak() <= MEMORY_RESERVATION_CHUNK);
+                Tuple tuple;
+                RID rid;
+                assert(executor.Next(&tuple, &rid));
+                assert(std::get<int32_t>(tuple.GetValue(0)) == num_rows);
+            }
+            assert(query.GetUsage() == 0);
+            txn_manager.Commit(txn);
+        }
+        assert(RunQuery(&engine, &txn_manager, "SELECT * FROM big;").empty());
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Memory tracker test passed!" << std::endl;
+}
+
+// Test the zero-copy lexer: tokens point into the input, keywords are found
+// through the perfect hash in any case, escaped strings are still decoded
+void TestZeroCopyLexer() {
+    std::cout << "Testing zero-copy lexer..." << std::endl;
+
+    const std::vector<std::pair<std::string, TokenType>> keywords = {
+        {"select", TokenType::SELECT},   {"FrOm", TokenType::FROM},
+        {"integer", TokenType::INT},     {"Bool", TokenType::BOOLEAN},
+        {"deallocate", TokenType::DEALLOCATE},
+        {"between", TokenType::BETWEEN}, {"AS", TokenType::AS},
+        {"null", TokenType::_NULL},      {"tables", TokenType::TABLES}};
+    for (const auto& [word, expected] : keywords) {
+        TokenType type = TokenType::INVALID;
+        assert(Lexer::LookupKeyword(word, &type));
+        assert(type == expected);
+    }
+    TokenType type = TokenType::INVALID;
+    assert(!Lexer::LookupKeyword("selects", &type));
+    assert(!Lexer::LookupKeyword("sel", &type));
+    assert(!Lexer::LookupKeyword("users", &type));
+    assert(!Lexer::LookupKeyword("deallocated", &type));
+    assert(!Lexer::LookupKeyword("", &type));
+
+    std::string sql =
+        "select Name, 42, 2.5 from users where flag = true and "
+        "s = 'plain' and t = 'it\\'s' and u <> $12;";
+    Lexer lexer(sql);
+    const char* begin = sql.data();
+    const char* end = sql.data() + sql.size();
+    auto in_input = [&](const Token& token) {
+        return token.value.data() >= begin && token.value.data() < end;
+    };
+    std::vector<Token> tokens;
+    for (Token token = lexer.NextToken(); token.type != TokenType::EOF_TOKEN;
+         token = lexer.NextToken()) {
+        tokens.push_back(token);
+    }
+    assert(tokens.size() == 25);
+    assert(tokens[0].type == TokenType::SELECT && tokens[0].value == "select");
+    assert(tokens[1].type == TokenType::IDENTIFIER &&
+           tokens[1].value == "Name" && in_input(tokens[1]));
+    assert(tokens[3].type == TokenType::INTEGER_LITERAL &&
+           tokens[3].value == "42" && in_input(tokens[3]));
+    assert(std::get<int32_t>(Lexer::LiteralValue(tokens[3])) == 42);
+    assert(tokens[5].type == TokenType::FLOAT_LITERAL &&
+           std::get<double>(Lexer::LiteralValue(tokens[5])) == 2.5);
+    assert(tokens[11].type == TokenType::BOOLEAN_LITERAL &&
+           tokens[11].value == "TRUE");
+    assert(tokens[15].type == TokenType::STRING_LITERAL &&
+           tokens[15].value == "plain" && in_input(tokens[15]));
+    assert(tokens[19].type == TokenType::STRING_LITERAL &&
+           tokens[19].value == "it's" && !in_input(tokens[19]));
+    assert(tokens[22].type == TokenType::NOT_EQUALS &&
+           tokens[22].value == "<>" && in_input(tokens[22]));
+    assert(tokens[23].type == TokenType::PARAMETER &&
+           tokens[23].value == "12");
+    assert(tokens[24].type == TokenType::SEMICOLON);
+    assert(tokens[0].line == 1 && tokens[1].column == 8);
+
+    Token big;
+    big.type = TokenType::INTEGER_LITERAL;
+    big.value = "99999999999";
+    bool threw = false;
+    try {
+        Lexer::LiteralValue(big);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // The parser keeps its own copy of the text, so a temporary works
+    Parser parser(std::string("SELECT a FROM t WHERE s = 'x\\ty';"));
+    auto statement = parser.Parse();
+    assert(statement->GetType() == Statement::StmtType::SELECT);
+
+    std::cout << "Zero-copy lexer test passed!" << std::endl;
+}
+
+void TestBloomFilter() {
+    std::cout << "Testing Bloom filters..." << std::endl;
+
+    // No false negatives, and a low false positive rate at 10 bits per key
+    {
+        BloomFilter filter;
+        assert(!filter.IsInitialized());
+        filter.Reset(10000);
+        assert(filter.IsInitialized());
+        for (int64_t i = 0; i < 10000; i++) {
+            filter.Insert(JoinHashTable::HashValue(Value(i * 2)));
+        }
+        for (int64_t i = 0; i < 10000; i++) {
+            assert(filter.MayContain(JoinHashTable::HashValue(Value(i * 2))));
+        }
+        size_t false_positives = 0;
+        for (int64_t i = 0; i < 10000; i++) {
+            if (filter.MayContain(JoinHashTable::HashValue(Value(i * 2 + 1)))) {
+                false_positives++;
+            }
+        }
+        assert(false_positives < 500);
+        filter.Clear();
+        assert(!filter.IsInitialized());
+    }
+
+    const std::string db_name = "test_bloom_filter.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE dims (id INT, name VARCHAR(16));");
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE facts (id INT PRIMARY KEY, dim_id INT);");
+        const int num_dims = 20;
+        const int num_facts = 2000;
+        std::string insert_sql = "INSERT INTO dims VALUES ";
+        for (int i = 0; i < num_dims; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i * 50) +
+                          ", 'd" + std::to_string(i) + "')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        // Only every 50th fact has a matching dimension row
+        insert_sql = "INSERT INTO facts VALUES ";
+        for (int i = 0; i < num_facts; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", " +
+                          std::to_string(i) + ")";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+        auto expected_ids = [&]() {
+            std::vector<int32_t> ids;
+            for (int i = 0; i < num_facts; i++) {
+                if (i % 50 == 0 && i / 50 < num_dims) {
+                    ids.push_back(i);
+                }
+            }
+            return ids;
+        };
+
+        auto rows = RunQuery(&engine, &txn_manager,
+                             "SELECT facts.id FROM dims JOIN facts ON "
+                             "dims.id = facts.dim_id;");
+        std::vector<int32_t> ids;
+        for (const auto& row : rows) {
+            ids.push_back(std::get<int32_t>(row.GetValue(0)));
+        }
+        std::sort(ids.begin(), ids.end());
+        assert(ids == expected_ids());
+
+        // The build side pushes its keys down to the probe scan; a spilled
+        // join keeps scanning everything
+        TableInfo* dims = catalog.GetTable("dims");
+        TableInfo* facts = catalog.GetTable("facts");
+        std::vector<Column> columns = dims->schema->GetColumns();
+        for (const auto& column : facts->schema->GetColumns()) {
+            columns.push_back(column);
+            columns.back().name = "facts." + column.name;
+        }
+        columns[0].name = "dims.id";
+        columns[1].name = "dims.name";
+        for (size_t budget : {size_t(1), size_t(1) << 20}) {
+            auto join_plan = std::make_unique<HashJoinPlanNode>(
+                std::make_unique<Schema>(columns),
+                std::make_unique<SeqScanPlanNode>(dims->schema.get(), "dims"),
+                std::make_unique<SeqScanPlanNode>(facts->schema.get(),
+                                                  "facts"),
+                std::make_unique<ColumnRefExpression>("", "id"),
+                std::make_unique<ColumnRefExpression>("", "dim_id"));
+            join_plan->SetMemoryBudget(budget);
+            Transaction* txn = txn_manager.Begin();
+            ExecutorContext exec_ctx(txn, &catalog, bpm.get(), nullptr);
+            HashJoinExecutor executor(&exec_ctx, std::move(join_plan));
+            executor.Init();
+            assert(executor.IsRuntimeFilterPushed() == (budget != 1));
+            ids.clear();
+            Tuple tuple;
+            RID rid;
+            while (executor.Next(&tuple, &rid)) {
+                assert(tuple.GetValue(0) == tuple.GetValue(3));
+                ids.push_back(std::get<int32_t>(tuple.GetValue(2)));
+            }
+            std::sort(ids.begin(), ids.end());
+            assert(ids == expected_ids());
+            txn_manager.Commit(txn);
+        }
+
+        // The probe scan drops non-matching rows before the join sees them
+        {
+            auto scan_plan =
+                std::make_unique<SeqScanPlanNode>(facts->schema.get(), "facts");
+            Transaction* txn = txn_manager.Begin();
+            ExecutorContext exec_ctx(txn, &catalog, bpm.get(), nullptr);
+            SeqScanExecutor scan(&exec_ctx, std::move(scan_plan));
+            scan.Init();
+            auto filter = std::make_shared<BloomFilter>();
+            filter->Reset(num_dims);
+            for (int i = 0; i < num_dims; i++) {
+                filter->Insert(
+                    JoinHashTable::HashValue(Value(int32_t(i * 50))));
+            }
+            ColumnRefExpression key("", "dim_id");
+            assert(scan.SetRuntimeFilter(filter, &key));
+            size_t returned = 0;
+            Tuple tuple;
+            RID rid;
+            while (scan.Next(&tuple, &rid)) {
+                returned++;
+            }
+            assert(returned >= static_cast<size_t>(num_dims));
+            assert(returned + scan.GetRuntimeFilteredRows() ==
+                   static_cast<size_t>(num_facts));
+            assert(scan.GetRuntimeFilteredRows() > num_facts / 2);
+            txn_manager.Commit(txn);
+        }
+
+        // Index filter: misses skip the tree, hits and later inserts are
+        // still found, including past the capacity that forces a rebuild
+        IndexManager* index_manager =
+            engine.GetTableManager()->GetIndexManager();
+        RunQuery(&engine, &txn_manager,
+                 "CREATE INDEX facts_dim ON facts (dim_id);");
+        assert(!index_manager->SetBloomFilter("missing", true));
+        assert(index_manager->SetBloomFilter("facts_dim", true));
+        std::vector<RID> rids;
+        for (int i = 0; i < num_facts; i++) {
+            assert(index_manager->FindEntry("facts_dim", Value(int32_t(i)),
+                                            &rids));
+        }
+        assert(rids.size() == static_cast<size_t>(num_facts));
+        size_t misses = 0;
+        for (int i = num_facts; i < num_facts * 2; i++) {
+            if (!index_manager->FindEntry("facts_dim", Value(int32_t(i)),
+                                          &rids)) {
+                misses++;
+            }
+        }
+        assert(misses == static_cast<size_t>(num_facts));
+        size_t skips = index_manager->GetBloomFilterSkips("facts_dim");
+        assert(skips > misses * 9 / 10 && skips <= misses);
+
+        for (int i = num_facts; i < num_facts * 3; i++) {
+            assert(index_manager->InsertEntry("facts_dim", Value(int32_t(i)),
+                                              RID{1, i}));
+        }
+        for (int i = 0; i < num_facts * 3; i++) {
+            rids.clear();
+            assert(index_manager->FindEntry("facts_dim", Value(int32_t(i)),
+                                            &rids));
+        }
+        assert(index_manager->GetBloomFilterSkips("facts_dim") == skips);
+
+        assert(index_manager->SetBloomFilter("facts_dim", false));
+        assert(!index_manager->FindEntry("facts_dim", Value(int32_t(-1)),
+                                         &rids));
+        assert(index_manager->GetBloomFilterSkips("facts_dim") == skips);
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Bloom filter tests passed!" << std::endl;
+}
+
+void TestWorkStealingThreadPool() {
+    std::cout << "Testing work-stealing thread pool..." << std::endl;
+
+    auto wait_until = [](const std::function<bool()>& done) {
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (!done()) {
+            assert(std::chrono::steady_clock::now() < deadline);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    // A full ring rejects the push and leaves the task with the caller
+    {
+        ThreadPool::InjectionQueue queue(3);
+        assert(queue.Capacity() == 4);
+        std::vector<int> order;
+        for (int i = 0; i < 4; i++) {
+            PoolTask task([&order, i]() { order.push_back(i); });
+            assert(queue.TryPush(task));
+            assert(!task);
+        }
+        assert(queue.ApproxSize() == 4);
+        PoolTask rejected([&order]() { order.push_back(4); });
+        assert(!queue.TryPush(rejected));
+        assert(rejected);
+        PoolTask task;
+        while (queue.TryPop(&task)) {
+            task();
+        }
+        assert((order == std::vector<int>{0, 1, 2, 3}));
+        assert(queue.TryPush(rejected) && !rejected);
+        assert(queue.TryPop(&task) && !queue.TryPop(&task));
+        task();
+        assert(order.back() == 4);
+    }
+
+    // Through the pool: a full queue throws, the rejected task never runs
+    // and nothing it captured is kept
+    {
+        ThreadPoolConfig config;
+        config.min_threads = 1;
+        config.max_threads = 1;
+        config.max_queue_size = 2;
+        ThreadPool pool(config);
+        assert(pool.Initialize());
+        std::atomic<bool> started{false};
+        std::atomic<bool> release{false};
+        pool.Submit([&]() {
+            started = true;
+            while (!release) {
+                std::this_thread::yield();
+            }
+        });
+        wait_until([&]() { return started.load(); });
+        auto payload = std::make_shared<int>(0);
+        std::atomic<int> ran{0};
+        pool.Submit([payload, &ran]() { ran++; });
+        pool.Submit([payload, &ran]() { ran++; });
+        bool threw = false;
+        try {
+            pool.Submit([payload, &ran]() { ran += 100; });
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+        assert(payload.use_count() == 3);
+        release = true;
+        wait_until([&]() { return pool.GetStats().completed_tasks == 3; });
+        assert(ran == 2);
+        assert(payload.use_count() == 1);
+        pool.Shutdown();
+    }
+
+    // N producers x M tasks over both priorities: each task runs exactly once
+    {
+        ThreadPoolConfig config;
+        config.min_threads = 4;
+        config.max_threads = 4;
+        config.max_queue_size = 64;
+        ThreadPool pool(config);
+        assert(pool.Initialize());
+        const size_t producers = 4;
+        const size_t tasks_per_producer = 5000;
+        std::vector<std::atomic<int>> runs(producers * tasks_per_producer);
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; p++) {
+            threads.emplace_back([&, p]() {
+                for (size_t i = 0; i < tasks_per_producer; i++) {
+                    size_t slot = p * tasks_per_producer + i;
+                    TaskPriority priority = i % 3 == 0
+                                                ? TaskPriority::BATCH
+                                                : TaskPriority::INTERACTIVE;
+                    while (true) {
+                        try {
+                            pool.Submit([&runs, slot]() { runs[slot]++; },
+                                        priority);
+                            break;
+                        } catch (const std::runtime_error&) {
+                            std::this_thread::yield();  // queue full
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const size_t total = producers * tasks_per_producer;
+        wait_until([&]() { return pool.GetStats().completed_tasks >= total; });
+        TaskStats stats = pool.GetStats();
+        assert(stats.completed_tasks == total);
+        assert(stats.failed_tasks == 0);
+        assert(stats.pending_tasks == 0);
+        assert(stats.total_tasks == total);
+        for (const auto& count : runs) {
+            assert(count == 1);
+        }
+        pool.Shutdown();
+    }
+
+    // Tasks a worker submits go to its own deque: a queue of two takes
+    // sixteen of them, and the other worker steals them while the
+    // submitting task keeps its worker busy
+    {
+        ThreadPoolConfig config;
+        config.min_threads = 2;
+        config.max_threads = 2;
+        config.max_queue_size = 2;
+        ThreadPool pool(config);
+        assert(pool.Initialize());
+        const int children = 16;
+        std::atomic<int> done{0};
+        std::atomic<int> stolen{0};
+        std::atomic<bool> parent_finished{false};
+        pool.Submit([&]() {
+            std::thread::id parent = std::this_thread::get_id();
+            for (int i = 0; i < children; i++) {
+                pool.Submit([&, parent]() {
+                    if (std::this_thread::get_id() != parent) {
+                        stolen++;
+                    }
+                    done++;
+                });
+            }
+            auto deadline =
+                std::chrono::steady_clock::now() + std::chrono::seconds(30);
+            while (done < children &&
+                   std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            parent_finished = true;
+        });
+        wait_until([&]() { return parent_finished.load(); });
+        assert(done == children);
+        assert(stolen == children);
+        wait_until([&]() {
+            return pool.GetStats().completed_tasks == children + 1;
+        });
+        pool.Shutdown();
+    }
+
+    // Shutdown with queued work returns and drops the tasks still queued,
+    // both in the ring and in a worker's deque
+    {
+        ThreadPoolConfig config;
+        config.min_threads = 1;
+        config.max_threads = 1;
+        config.max_queue_size = 16;
+        ThreadPool pool(config);
+        assert(pool.Initialize());
+        auto payload = std::make_shared<int>(0);
+        std::atomic<int> ran{0};
+        std::atomic<bool> started{false};
+        std::atomic<bool> release{false};
+        pool.Submit([&, payload]() {
+            for (int i = 0; i < 4; i++) {
+                pool.Submit([payload, &ran]() { ran++; });
+            }
+            started = true;
+            while (!release) {
+                std::this_thread::yield();
+            }
+        });
+        wait_until([&]() { return started.load(); });
+        for (int i = 0; i < 8; i++) {
+            pool.Submit([payload, &ran]() { ran++; });
+        }
+        assert(pool.GetQueueSize() == 12);
+        std::thread stopper([&pool]() { pool.Shutdown(); });
+        wait_until([&]() { return !pool.IsRunning(); });
+        release = true;
+        stopper.join();
+        assert(ran == 0);
+        assert(payload.use_count() == 1);
+        assert(pool.GetQueueSize() == 0);
+        assert(pool.GetTotalThreads() == 0);
+    }
+
+    std::cout << "Work-stealing thread pool tests passed!" << std::endl;
+}
+
+void TestBinaryProtocolFraming() {
+    std::cout << "Testing binary protocol framing..." << std::endl;
+
+    auto u32 = [](uint32_t value) {
+        std::string out;
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>(value >> shift));
+        }
+        return out;
+    };
+    auto frame = [&u32](char type, const std::string& payload) {
+        return u32(static_cast<uint32_t>(payload.size() + 1)) + type + payload;
+    };
+    BinaryProtocolHandler handler;
+    const size_t limit = EventLoop::MAX_REQUEST_SIZE;
+
+    // Partial header: nothing to frame yet
+    std::string query = frame(BinaryProtocolHandler::FRAME_QUERY, "SELECT 1;");
+    for (size_t size = 0; size < 4; size++) {
+        std::string partial = query.substr(0, size);
+        assert(handler.GetMessageLength(partial) == 0);
+        assert(!handler.IsComplete(partial));
+        assert(!handler.IsOversized(partial, limit));
+    }
+
+    // Partial body: the header is there but the payload is one byte short
+    std::string partial = query.substr(0, query.size() - 1);
+    assert(handler.GetMessageLength(partial) == 0);
+    assert(!handler.IsComplete(partial));
+    assert(!handler.IsOversized(partial, limit));
+    assert(handler.GetMessageLength(query) == query.size());
+
+    // Two frames in one read are split at the length prefix
+    std::string auth = frame(BinaryProtocolHandler::FRAME_AUTH,
+                             u32(5) + "alice" + u32(6) + "secret");
+    std::string buffer = auth + query + frame('P', "");
+    std::vector<std::unique_ptr<Message>> messages;
+    while (size_t length = handler.GetMessageLength(buffer)) {
+        messages.push_back(handler.ParseMessage(buffer.substr(0, length)));
+        assert(messages.back() != nullptr);
+        buffer.erase(0, length);
+    }
+    assert(buffer.empty());
+    assert(messages.size() == 3);
+    assert(messages[0]->type == MessageType::AUTHENTICATION);
+    assert((messages[0]->parameters ==
+            std::vector<std::string>{"alice", "secret"}));
+    assert(messages[1]->type == MessageType::QUERY);
+    assert(messages[1]->content == "SELECT 1;");
+    assert(messages[2]->type == MessageType::HEARTBEAT);
+
+    // A frame whose strings run past the payload is rejected
+    std::string truncated =
+        frame(BinaryProtocolHandler::FRAME_AUTH, u32(50) + "alice");
+    assert(handler.GetMessageLength(truncated) == truncated.size());
+    assert(handler.ParseMessage(truncated) == nullptr);
+
+    // An oversize length is rejected from the header alone; the text
+    // protocol only knows once that many bytes have arrived
+    assert(handler.IsOversized(u32(static_cast<uint32_t>(limit)), limit));
+    assert(handler.IsOversized(u32(0xFFFFFFFFu) + "Q", limit));
+    assert(!handler.IsOversized(u32(static_cast<uint32_t>(limit - 4)), limit));
+    SimpleProtocolHandler text_handler;
+    assert(!text_handler.IsOversized("SELECT", limit));
+    assert(text_handler.IsOversized(std::string(limit + 1, 'x'), limit));
+
+    // Server frames use the same framing
+    std::string ok = handler.FormatOkMessage("PONG");
+    assert(handler.GetMessageLength(ok + ok) == ok.size());
+    assert(ok[4] == BinaryProtocolHandler::FRAME_OK && ok.substr(5) == "PONG");
+
+    std::cout << "Binary protocol framing tests passed!" << std::endl;
+}
+
+void TestAdmissionController() {
+    std::cout << "Testing admission controller..." << std::endl;
+
+    auto wait_until = [](const std::function<bool()>& done) {
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (!done()) {
+            assert(std::chrono::steady_clock::now() < deadline);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    // Two slots, two waiting places; the waiters are admitted in FIFO order
+    {
+        AdmissionController controller(2, 2, std::chrono::seconds(30));
+        assert(controller.Admit());
+        assert(controller.Admit());
+        AdmissionStats stats = controller.GetStats();
+        assert(stats.running_heavy == 2 && stats.admitted_heavy == 2);
+
+        std::mutex order_mutex;
+        std::vector<int> order;
+        std::vector<std::thread> waiters;
+        for (int i = 0; i < 2; i++) {
+            waiters.emplace_back([&, i]() {
+                assert(controller.Admit());
+                std::lock_guard<std::mutex> lock(order_mutex);
+                order.push_back(i);
+            });
+            // The second waiter queues behind the first
+            wait_until([&]() {
+                return controller.GetStats().waiting_heavy ==
+                       static_cast<size_t>(i + 1);
+            });
+        }
+
+        // The queue is full: the next caller is turned away immediately
+        auto start = std::chrono::steady_clock::now();
+        assert(!controller.Admit());
+        assert(std::chrono::steady_clock::now() - start <
+               std::chrono::seconds(5));
+        stats = controller.GetStats();
+        assert(stats.rejected_heavy == 1 && stats.waiting_heavy == 2);
+
+        controller.Release();
+        wait_until([&]() {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            return order.size() == 1;
+        });
+        {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            assert(order[0] == 0);
+        }
+        stats = controller.GetStats();
+        assert(stats.running_heavy == 2 && stats.waiting_heavy == 1);
+
+        controller.Release();
+        for (auto& waiter : waiters) {
+            waiter.join();
+        }
+        assert((order == std::vector<int>{0, 1}));
+        stats = controller.GetStats();
+        assert(stats.running_heavy == 2 && stats.waiting_heavy == 0);
+        assert(stats.admitted_heavy == 4 && stats.rejected_heavy == 1);
+
+        // A ticket gives the slot back when it goes away
+        controller.Release();
+        {
+            assert(controller.Admit());
+            AdmissionController::Ticket ticket(&controller);
+            assert(controller.GetStats().running_heavy == 2);
+        }
+        assert(controller.GetStats().running_heavy == 1);
+    }
+
+    // A waiter that does not get a slot in time gives up and is counted
+    // as rejected; it leaves the queue so later callers are not blocked
+    {
+        AdmissionController controller(1, 4, std::chrono::milliseconds(50));
+        assert(controller.Admit());
+        auto start = std::chrono::steady_clock::now();
+        assert(!controller.Admit());
+        assert(std::chrono::steady_clock::now() - start >=
+               std::chrono::milliseconds(50));
+        AdmissionStats stats = controller.GetStats();
+        assert(stats.rejected_heavy == 1);
+        assert(stats.waiting_heavy == 0 && stats.running_heavy == 1);
+        controller.Release();
+        assert(controller.Admit());
+        assert(controller.GetStats().admitted_heavy == 2);
+        controller.Release();
+    }
+
+    std::cout << "Admission controller tests passed!" << std::endl;
+}
+
+// Loopback test of the epoll event loop: pipelined requests in one write,
+// coalesced responses, and a buffer-chain flush through tiny socket buffers
+void TestEventLoopPipelining() {
+    std::cout << "Testing event loop pipelining..." << std::endl;
+
+    const std::string db_name = "test_event_loop.db";
+    std::remove(db_name.c_str());
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        Catalog catalog(bpm.get());
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, nullptr);
+        ExecutionEngine engine(bpm.get(), &catalog, &txn_manager);
+
+        const int num_rows = 3000;
+        auto pad = [](int id) {
+            std::string value = "row-" + std::to_string(id) + "-";
+            return value + std::string(60 - value.size(), 'x');
+        };
+        RunQuery(&engine, &txn_manager,
+                 "CREATE TABLE items (id INT, pad VARCHAR(64));");
+        std::string insert_sql = "INSERT INTO items VALUES ";
+        for (int i = 0; i < num_rows; i++) {
+            insert_sql += (i == 0 ? "(" : ", (") + std::to_string(i) +
+                          ", '" + pad(i) + "')";
+        }
+        RunQuery(&engine, &txn_manager, insert_sql + ";");
+
+        ServerConfig server_config;
+        QueryProcessor processor(server_config);
+        assert(processor.Initialize(&engine, &txn_manager, &catalog));
+
+        ThreadPoolConfig pool_config;
+        pool_config.min_threads = 2;
+        pool_config.max_threads = 2;
+        ThreadPool pool(pool_config);
+        assert(pool.Initialize());
+        std::atomic<bool> closed{false};
+        EventLoop loop(
+            [&pool](std::function<void()> task, TaskPriority priority) {
+                pool.Submit(std::move(task), priority);
+            },
+            [&closed](int, const std::shared_ptr<Connection>& connection) {
+                connection->Close();
+                closed = true;
+            });
+        assert(loop.Start());
+
+        // Loopback connection; both ends get the smallest buffers the
+        // kernel allows, so the large response cannot leave in one sendmsg
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        assert(listener >= 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        assert(bind(listener, reinterpret_cast<sockaddr*>(&address),
+                    sizeof(address)) == 0);
+        assert(listen(listener, 1) == 0);
+        socklen_t address_length = sizeof(address);
+        assert(getsockname(listener, reinterpret_cast<sockaddr*>(&address),
+                           &address_length) == 0);
+        int client = socket(AF_INET, SOCK_STREAM, 0);
+        int small_buffer = 4096;
+        setsockopt(client, SOL_SOCKET, SO_RCVBUF, &small_buffer,
+                   sizeof(small_buffer));
+        timeval receive_timeout{30, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &receive_timeout,
+                   sizeof(receive_timeout));
+        assert(connect(client, reinterpret_cast<sockaddr*>(&address),
+                       sizeof(address)) == 0);
+        int server_fd = accept(listener, nullptr, nullptr);
+        assert(server_fd >= 0);
+        close(listener);
+
+        auto connection =
+            std::make_shared<Connection>(server_fd, "127.0.0.1", 0);
+        assert(connection->Initialize());
+        setsockopt(server_fd, SOL_SOCKET, SO_SNDBUF, &small_buffer,
+                   sizeof(small_buffer));
+        connection->SetProtocolHandler(
+            std::make_unique<SimpleProtocolHandler>());
+        assert(connection->CreateSession());
+        connection->GetSession()->SetTransactionManager(&txn_manager);
+        connection->GetSession()->SetQueryProcessor(&processor);
+        loop.AddConnection(connection);
+
+        auto u32 = [](uint32_t value) {
+            std::string out;
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                out.push_back(static_cast<char>(value >> shift));
+            }
+            return out;
+        };
+        auto frame = [&u32](char type, const std::string& payload) {
+            return u32(static_cast<uint32_t>(payload.size() + 1)) + type +
+                   payload;
+        };
+        auto read_u32 = [](const std::string& data, size_t offset) {
+            uint32_t value = 0;
+            for (size_t i = 0; i < 4; i++) {
+                value = (value << 8) | static_cast<uint8_t>(data[offset + i]);
+            }
+            return value;
+        };
+
+        // Everything in one write: the protocol switch, authentication,
+        // point queries, a ping and a result far larger than the buffers
+        const std::vector<int> point_ids = {7, 1234, 42, 2999, 0};
+        std::string requests = "BINARY\n";
+        requests += frame('A', u32(4) + "test" + u32(4) + "test");
+        for (int id : point_ids) {
+            requests += frame('Q', "SELECT id FROM items WHERE id = " +
+                                       std::to_string(id) + ";");
+        }
+        requests += frame('P', "");
+        requests += frame('Q', "SELECT * FROM items;");
+        requests += frame('Q', "SELECT id FROM items WHERE id = 5;");
+        assert(send(client, requests.data(), requests.size(), 0) ==
+               static_cast<ssize_t>(requests.size()));
+
+        // Read frames until the expected number of responses has arrived;
+        // a response ends with a 'C', 'K' or 'E' frame
+        std::string input;
+        auto receive_more = [&]() {
+            char buffer[1000];
+            ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+            assert(received > 0);
+            input.append(buffer, static_cast<size_t>(received));
+        };
+        const std::string switched = "OK BINARY\n";
+        while (input.size() < switched.size()) {
+            receive_more();
+        }
+        assert(input.compare(0, switched.size(), switched) == 0);
+        input.erase(0, switched.size());
+        using Response = std::vector<std::pair<char, std::string>>;
+        std::vector<Response> responses(1);
+        const size_t expected_responses = 1 + point_ids.size() + 1 + 1 + 1;
+        while (responses.size() <= expected_responses) {
+            if (input.size() < 4 || input.size() < 4 + read_u32(input, 0)) {
+                // Read slowly at first so the server sees a full buffer
+                if (responses.size() < 8) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+                receive_more();
+                continue;
+            }
+            size_t length = read_u32(input, 0);
+            char type = input[4];
+            responses.back().emplace_back(type, input.substr(5, length - 1));
+            input.erase(0, 4 + length);
+            if (type == 'C' || type == 'K' || type == 'E') {
+                responses.emplace_back();
+            }
+        }
+        responses.pop_back();
+        assert(responses.size() == expected_responses);
+        assert(input.empty());
+
+        // Responses come back in request order
+        auto point_result = [&](const Response& response) {
+            assert(response.size() == 3);
+            assert(response[0].first == 'T' && response[1].first == 'B' &&
+                   response[2].first == 'C');
+            assert(read_u32(response[1].second, 0) == 1);
+            return static_cast<int>(read_u32(response[1].second, 4));
+        };
+        assert(responses[0].size() == 1 && responses[0][0].first == 'K');
+        for (size_t i = 0; i < point_ids.size(); i++) {
+            assert(point_result(responses[1 + i]) == point_ids[i]);
+        }
+        const auto& pong = responses[1 + point_ids.size()];
+        assert(pong.size() == 1 && pong[0].first == 'K' &&
+               pong[0].second == "PONG");
+        assert(point_result(responses.back()) == 5);
+
+        // The large result arrives intact although every sendmsg was cut
+        // short somewhere inside the chain of row batches
+        const auto& scan = responses[2 + point_ids.size()];
+        assert(scan.front().first == 'T' && scan.back().first == 'C');
+        assert(scan.size() > 3);
+        std::vector<int> ids;
+        size_t scan_bytes = 0;
+        for (size_t i = 1; i + 1 < scan.size(); i++) {
+            const std::string& batch = scan[i].second;
+            assert(scan[i].first == 'B');
+            scan_bytes += batch.size();
+            size_t offset = 4;
+            for (uint32_t row = 0; row < read_u32(batch, 0); row++) {
+                int id = static_cast<int>(read_u32(batch, offset));
+                size_t pad_length = read_u32(batch, offset + 4);
+                assert(batch.compare(offset + 8, pad_length, pad(id)) == 0);
+                ids.push_back(id);
+                offset += 8 + pad_length;
+            }
+            assert(offset == batch.size());
+        }
+        assert(scan_bytes > 16 * static_cast<size_t>(small_buffer));
+        std::sort(ids.begin(), ids.end());
+        for (int i = 0; i < num_rows; i++) {
+            assert(ids[i] == i);
+        }
+        uint64_t affected = 0;
+        for (char byte : scan.back().second) {
+            affected = (affected << 8) | static_cast<uint8_t>(byte);
+        }
+        assert(affected == static_cast<uint64_t>(num_rows));
+
+        // A frame announcing more than MAX_REQUEST_SIZE is refused as soon
+        // as its header arrives, and the connection is closed
+        std::string oversize = u32(0xFFFFFFF0u) + "Q";
+        assert(send(client, oversize.data(), oversize.size(), 0) ==
+               static_cast<ssize_t>(oversize.size()));
+        while (input.size() < 4 || input.size() < 4 + read_u32(input, 0)) {
+            receive_more();
+        }
+        assert(input[4] == 'E');
+        assert(input.substr(5, read_u32(input, 0) - 1) == "Request too large");
+        char byte;
+        assert(recv(client, &byte, 1, 0) == 0);
+        assert(closed);
+        close(client);
+
+        loop.Stop();
+        pool.Shutdown();
+        processor.Shutdown();
+    }
+    std::remove(db_name.c_str());
+
+    std::cout << "Event loop pipelining tests passed!" << std::endl;
+}
+
+// Test segmented WAL file: append across segments, reopen, recycle
+void TestWalFile() {
+    std::cout << "Testing WAL File..." << std::endl;
+
+    const std::string wal_name = "test_wal_file.log";
+    WalFile::RemoveAll(wal_name);
+    const size_t blocks_per_segment = 4;
+
+    auto make_block = [](int n) {
+        std::vector<char> block(PAGE_SIZE, 0);
+        *reinterpret_cast<uint32_t*>(block.data()) = 16;  // non-empty block
+        *reinterpret_cast<int*>(block.data() + sizeof(uint32_t)) = n;
+        return block;
+    };
+    auto block_value = [](const char* block) {
+        return *reinterpret_cast<const int*>(block + sizeof(uint32_t));
+    };
+
+    uint64_t begin;
+    {
+        WalFile wal(wal_name, blocks_per_segment * PAGE_SIZE);
+        begin = wal.GetBeginBlock();
+        assert(wal.GetEndBlock() == begin);
+        // Ten blocks span three segments, appended in uneven batches
+        int next = 0;
+        for (size_t batch : {3, 5, 2}) {
+            std::vector<char> data;
+            for (size_t i = 0; i < batch; i++) {
+                auto block = make_block(next++);
+                data.insert(data.end(), block.begin(), block.end());
+            }
+            wal.Append(data.data(), batch);
+        }
+        wal.Sync();
+        assert(wal.GetEndBlock() == begin + 10);
+        assert(wal.GetSize() == 10 * PAGE_SIZE);
+    }
+
+    {
+        // Reopening finds the same range and contents
+        WalFile wal(wal_name, blocks_per_segment * PAGE_SIZE);
+        assert(wal.GetBeginBlock() == begin);
+        assert(wal.GetEndBlock() == begin + 10);
+        char block[PAGE_SIZE];
+        for (int i = 0; i < 10; i++) {
+            assert(wal.ReadBlock(begin + i, block));
+            assert(block_value(block) == i);
+        }
+        assert(!wal.ReadBlock(begin + 10, block));
+
+        // Truncation starts a fresh segment and recycles the old ones
+        wal.Truncate();
+        assert(wal.GetSize() == 0);
+        assert(wal.GetBeginBlock() % blocks_per_segment == 0);
+        assert(wal.GetSpareSegmentCount() == WalFile::MAX_SPARE_SEGMENTS);
+        uint64_t new_begin = wal.GetBeginBlock();
+        auto data = make_block(100);
+        wal.Append(data.data(), 1);
+        wal.Sync();
+        begin = new_begin;
+    }
+
+    {
+        // Recycled segments are zeroed, so stale blocks never reappear
+        WalFile wal(wal_name, blocks_per_segment * PAGE_SIZE);
+        assert(wal.GetBeginBlock() == begin);
+        assert(wal.GetEndBlock() == begin + 1);
+        char block[PAGE_SIZE];
+        assert(wal.ReadBlock(begin, block));
+        assert(block_value(block) == 100);
+    }
+
+    WalFile::RemoveAll(wal_name);
+    std::cout << "WAL File tests passed!" << std::endl;
+}
+
+// Test group commit: concurrent committers share background log flushes
+void TestLogGroupCommit() {
+    std::cout << "Testing Log Group Commit..." << std::endl;
+
+    const std::string log_name = "test_group_commit.log";
+    std::remove(log_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    const int num_threads = 8;
+    const int commits_per_thread = 20;
+    {
+        DiskManager log_disk(log_name);
+        LogManager log_manager(&log_disk);
+        log_manager.SetGroupCommitMaxWait(std::chrono::microseconds(200));
+
+        std::vector<std::thread> committers;
+        for (int t = 0; t < num_threads; t++) {
+            committers.emplace_back([&log_manager, t]() {
+                for (int i = 0; i < commits_per_thread; i++) {
+                    txn_id_t txn_id = t * commits_per_thread + i + 1;
+                    CommitLogRecord record(txn_id, INVALID_LSN);
+                    lsn_t lsn = log_manager.AppendLogRecord(&record);
+                    assert(lsn != INVALID_LSN);
+                    log_manager.Flush(lsn);
+                    // Flush returns only after the commit record is durable
+                    assert(log_manager.GetPersistentLSN() >= lsn);
+                }
+            });
+        }
+        for (auto& committer : committers) {
+            committer.join();
+        }
+
+        uint64_t flushes = log_manager.GetFlushCount();
+        assert(flushes > 0);
+        assert(flushes <= static_cast<uint64_t>(num_threads * commits_per_thread));
+        std::cout << "  " << num_threads * commits_per_thread << " commits, "
+                  << flushes << " log flushes" << std::endl;
+
+        // Already durable: no extra flush
+        log_manager.Flush();
+        assert(log_manager.GetFlushCount() == flushes);
+    }
+    std::remove(log_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    std::cout << "Log Group Commit tests passed!" << std::endl;
+}
+
+// Test double-buffered log: concurrent appends across many buffer switches
+void TestLogDoubleBuffer() {
+    std::cout << "Testing Log Double Buffer..." << std::endl;
+
+    const std::string log_name = "test_log_double_buffer.log";
+    std::remove(log_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, 256, false, false}});
+    const int num_threads = 4;
+    const int records_per_thread = 300;
+    {
+        DiskManager log_disk(log_name);
+        // Two pages per buffer: appenders keep switching buffers
+        LogManager log_manager(&log_disk, 2 * PAGE_SIZE);
+        assert(log_manager.GetBufferSize() == 2 * PAGE_SIZE);
+
+        std::vector<std::thread> appenders;
+        std::vector<std::vector<lsn_t>> lsns(num_threads);
+        for (int t = 0; t < num_threads; t++) {
+            appenders.emplace_back([&, t]() {
+                for (int i = 0; i < records_per_thread; i++) {
+                    // Varying sizes force records onto the next page
+                    std::string name(1 + (i * 37 + t) % 200, 'x');
+                    Tuple tuple({Value(int32_t(i)), Value(name)}, &schema);
+                    RID rid{t, static_cast<slot_offset_t>(i)};
+                    InsertLogRecord record(t + 1, INVALID_LSN, rid, tuple);
+                    lsn_t lsn = log_manager.AppendLogRecord(&record);
+                    assert(lsn != INVALID_LSN);
+                    lsns[t].push_back(lsn);
+                }
+            });
+        }
+        for (auto& appender : appenders) {
+            appender.join();
+        }
+
+        // LSNs are unique and increasing per thread
+        std::vector<lsn_t> all;
+        for (const auto& thread_lsns : lsns) {
+            for (size_t i = 1; i < thread_lsns.size(); i++) {
+                assert(thread_lsns[i] > thread_lsns[i - 1]);
+            }
+            all.insert(all.end(), thread_lsns.begin(), thread_lsns.end());
+        }
+        std::sort(all.begin(), all.end());
+        assert(std::adjacent_find(all.begin(), all.end()) == all.end());
+
+        log_manager.Flush();
+        assert(log_manager.GetPersistentLSN() >= all.back());
+        assert(log_manager.GetFlushCount() > 1);
+
+        // Every record survives the page padding and buffer switches
+        auto records = log_manager.ReadLogRecords();
+        assert(records.size() ==
+               static_cast<size_t>(num_threads * records_per_thread));
+    }
+    std::remove(log_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    std::cout << "Log Double Buffer tests passed!" << std::endl;
+}
+
+// Test streaming log cursor: forward and backward over many log blocks
+void TestLogCursor() {
+    std::cout << "Testing Log Cursor..." << std::endl;
+
+    const std::string log_name = "test_log_cursor.log";
+    LogManager::RemoveLogFiles(log_name);
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, 256, false, false}});
+    // Enough records for more than 10 log blocks at any page size
+    const int num_records = static_cast<int>(PAGE_SIZE / 4096) * 500;
+    std::vector<size_t> body_sizes;
+    {
+        LogManager log_manager(log_name, 2 * PAGE_SIZE);
+        BeginLogRecord begin(7);
+        log_manager.AppendLogRecord(&begin);
+        for (int i = 0; i < num_records; i++) {
+            std::string name(1 + i % 150, 'c');
+            Tuple tuple({Value(int32_t(i)), Value(name)}, &schema);
+            RID rid{i / 10, static_cast<slot_offset_t>(i % 10)};
+            DeleteLogRecord record(7, INVALID_LSN, rid, tuple);
+            log_manager.AppendLogRecord(&record);
+            body_sizes.push_back(record.GetLogRecordSize());
+        }
+        CommitLogRecord commit(7, INVALID_LSN);
+        log_manager.Flush(log_manager.AppendLogRecord(&commit));
+        assert(log_manager.GetWalFile()->GetEndBlock() -
+                   log_manager.GetWalFile()->GetBeginBlock() > 10);
+
+        // Forward: LSN order, RIDs decoded, one reused record per type
+        auto cursor = log_manager.CreateLogCursor();
+        assert(cursor->SeekToFirst());
+        assert(cursor->GetRecord().GetType() == LogRecordType::BEGIN);
+        const LogRecord* first_delete = nullptr;
+        int deletes = 0;
+        lsn_t prev_lsn = INVALID_LSN;
+        for (bool ok = cursor->SeekToFirst(); ok; ok = cursor->Next()) {
+            const LogRecord& record = cursor->GetRecord();
+            assert(record.GetLSN() > prev_lsn);
+            prev_lsn = record.GetLSN();
+            if (record.GetType() != LogRecordType::DELETE) {
+                continue;
+            }
+            const auto& del = static_cast<const DeleteLogRecord&>(record);
+            assert(del.GetRID().page_id == deletes / 10);
+            assert(del.GetRID().slot_num == deletes % 10);
+            assert(cursor->GetBodySize() == body_sizes[deletes]);
+            if (first_delete == nullptr) {
+                first_delete = &record;
+            }
+            assert(&record == first_delete);
+            deletes++;
+        }
+        assert(deletes == num_records);
+        assert(!cursor->Valid());
+        assert(prev_lsn == log_manager.GetPersistentLSN());
+
+        // Backward: the same records in reverse
+        int count = 0;
+        lsn_t next_lsn = prev_lsn + 1;
+        for (bool ok = cursor->SeekToLast(); ok; ok = cursor->Prev()) {
+            assert(cursor->GetRecord().GetLSN() < next_lsn);
+            next_lsn = cursor->GetRecord().GetLSN();
+            count++;
+        }
+        assert(count == num_records + 2);
+        assert(log_manager.ReadLogRecords().size() ==
+               static_cast<size_t>(num_records + 2));
+    }
+    {
+        // LSNs continue after reopening the log
+        LogManager log_manager(log_name);
+        CommitLogRecord record(8, INVALID_LSN);
+        assert(log_manager.AppendLogRecord(&record) == num_records + 3);
+    }
+    LogManager::RemoveLogFiles(log_name);
+    std::cout << "Log Cursor tests passed!" << std::endl;
+}
+
+// Test page-partitioned parallel redo against sequential redo
+void TestParallelRedo() {
+    std::cout << "Testing Parallel Redo..." << std::endl;
+
+    const std::string db_name = "test_parallel_redo.db";
+    const std::string snapshot_name = "test_parallel_redo.snapshot";
+    const std::string log_name = "test_parallel_redo.log";
+    std::remove(db_name.c_str());
+    std::remove(snapshot_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    auto copy_file = [](const std::string& from, const std::string& to) {
+        std::ifstream in(from, std::ios::binary);
+        std::ofstream out(to, std::ios::binary | std::ios::trunc);
+        out << in.rdbuf();
+    };
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, 256, false, false}});
+    const int num_rows = 300;
+
+    std::vector<RID> rids;
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        LogManager log_manager(log_name);
+        Catalog catalog(bpm.get(), &log_manager);
+        assert(catalog.CreateTable("redo_test", schema));
+        TableHeap* heap = catalog.GetTable("redo_test")->table_heap.get();
+
+        BeginLogRecord begin1(1);
+        log_manager.AppendLogRecord(&begin1);
+        for (int i = 0; i < num_rows; i++) {
+            std::string name(100, static_cast<char>('a' + i % 26));
+            Tuple tuple({Value(int32_t(i)), Value(name)}, &schema);
+            RID rid;
+            assert(heap->InsertTuple(tuple, &rid, 1));
+            rids.push_back(rid);
+        }
+        CommitLogRecord commit1(1, INVALID_LSN);
+        log_manager.Flush(log_manager.AppendLogRecord(&commit1));
+
+        // Inserts are on disk; the deletes below only reach the log
+        catalog.SaveCatalogToDisk();
+        bpm->FlushAllPages();
+        copy_file(db_name, snapshot_name);
+
+        BeginLogRecord begin2(2);
+        log_manager.AppendLogRecord(&begin2);
+        // Highest RID first: a delete never moves the slots still to delete
+        for (int i = num_rows - 3; i >= 0; i -= 3) {
+            assert(heap->DeleteTuple(rids[i], 2));
+        }
+        CommitLogRecord commit2(2, INVALID_LSN);
+        log_manager.Flush(log_manager.AppendLogRecord(&commit2));
+    }
+
+    size_t expected_ops = 0;
+    for (size_t threads : {size_t(1), size_t(4)}) {
+        copy_file(snapshot_name, db_name);
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        LogManager log_manager(log_name);
+        Catalog catalog(bpm.get(), &log_manager);
+        LockManager lock_manager;
+        RecoveryManager recovery_manager(bpm.get(), &catalog, &log_manager,
+                                         &lock_manager);
+        recovery_manager.SetRedoThreads(threads);
+        assert(recovery_manager.GetRedoThreads() == threads);
+        recovery_manager.Recover();
+
+        // Same records replayed whatever the partitioning
+        if (threads == 1) {
+            expected_ops = recovery_manager.GetRedoOperationCount();
+            assert(expected_ops == static_cast<size_t>(num_rows + num_rows / 3));
+        } else {
+            assert(recovery_manager.GetRedoOperationCount() == expected_ops);
+        }
+
+        // Exactly the rows deleted after the snapshot are gone
+        TableHeap* heap = catalog.GetTable("redo_test")->table_heap.get();
+        int count = 0;
+        for (auto it = heap->Begin(); !it.IsEnd(); ++it) {
+            Tuple tuple = *it;
+            assert(std::get<int32_t>(tuple.GetValue(0)) % 3 != 0);
+            count++;
+        }
+        assert(count == num_rows - num_rows / 3);
+    }
+
+    std::remove(db_name.c_str());
+    std::remove(snapshot_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    std::cout << "Parallel Redo tests passed!" << std::endl;
+}
+
+// Test delta-encoded update records
+void TestUpdateDeltaLogRecord() {
+    std::cout << "Testing Update Delta Log Record..." << std::endl;
+
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"payload", TypeId::VARCHAR, 400, false, false},
+                   {"note", TypeId::VARCHAR, 64, false, false}});
+    auto serialize = [](const Tuple& tuple) {
+        std::vector<char> image(tuple.GetSerializedSize());
+        tuple.SerializeTo(image.data());
+        return image;
+    };
+    auto check_round_trip = [&serialize](const Tuple& old_tuple,
+                                        const Tuple& new_tuple) {
+        UpdateDeltaLogRecord record(1, INVALID_LSN, RID{3, 7}, old_tuple,
+                                    new_tuple);
+        std::vector<char> old_image = serialize(old_tuple);
+        std::vector<char> new_image = serialize(new_tuple);
+        assert(record.GetOldSize() == old_image.size());
+        assert(record.GetNewSize() == new_image.size());
+
+        std::vector<char> result;
+        assert(record.ApplyRedo(old_image.data(), old_image.size(), &result));
+        assert(result == new_image);
+        assert(record.ApplyUndo(new_image.data(), new_image.size(), &result));
+        assert(result == old_image);
+        return record.GetLogRecordSize();
+    };
+
+    std::string payload(300, 'p');
+    Tuple base({Value(int32_t(1)), Value(payload), Value(std::string("short"))},
+               &schema);
+
+    // One narrow column changes: a handful of bytes instead of two images
+    Tuple id_changed(
+        {Value(int32_t(2)), Value(payload), Value(std::string("short"))},
+        &schema);
+    size_t full_size = sizeof(page_id_t) + sizeof(slot_offset_t) +
+                       2 * base.GetSerializedSize();
+    assert(check_round_trip(base, id_changed) < 32);
+    assert(full_size > 600);
+
+    // Variable-length column grows and shrinks
+    Tuple note_grown({Value(int32_t(1)), Value(payload),
+                      Value(std::string("a considerably longer note"))},
+                     &schema);
+    check_round_trip(base, note_grown);
+    check_round_trip(note_grown, base);
+
+    // Changes at both ends, and no change at all
+    std::string other_payload = payload;
+    other_payload[0] = 'q';
+    other_payload[299] = 'q';
+    Tuple both_ends({Value(int32_t(9)), Value(other_payload),
+                     Value(std::string("other"))},
+                    &schema);
+    check_round_trip(base, both_ends);
+    check_round_trip(base, base);
+
+    // Applying to an image of the wrong size is rejected
+    UpdateDeltaLogRecord record(1, INVALID_LSN, RID{3, 7}, base, note_grown);
+    std::vector<char> new_image = serialize(note_grown);
+    std::vector<char> result;
+    assert(!record.ApplyRedo(new_image.data(), new_image.size(), &result));
+
+    // TableHeap logs the delta form and the cursor decodes it
+    const std::string db_name = "test_update_delta.db";
+    const std::string log_name = "test_update_delta.log";
+    std::remove(db_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            16, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(16));
+        LogManager log_manager(log_name);
+        Catalog catalog(bpm.get(), &log_manager);
+        assert(catalog.CreateTable("delta_test", schema));
+        TableHeap* heap = catalog.GetTable("delta_test")->table_heap.get();
+
+        RID rid;
+        assert(heap->InsertTuple(base, &rid, 1));
+        assert(heap->UpdateTuple(id_changed, rid, 1));
+        log_manager.Flush();
+
+        auto cursor = log_manager.CreateLogCursor();
+        assert(cursor->SeekToLast());
+        assert(cursor->GetRecord().GetType() == LogRecordType::UPDATE_DELTA);
+        const auto& delta =
+            static_cast<const UpdateDeltaLogRecord&>(cursor->GetRecord());
+        assert(delta.GetRID().page_id == rid.page_id);
+        assert(delta.GetRID().slot_num == rid.slot_num);
+        std::vector<char> old_image = serialize(base);
+        assert(delta.ApplyRedo(old_image.data(), old_image.size(), &result));
+        assert(result == serialize(id_changed));
+
+        auto records = log_manager.ReadLogRecords();
+        assert(records.back()->GetType() == LogRecordType::UPDATE_DELTA);
+        assert(records.back()->GetLogRecordSize() == delta.GetLogRecordSize());
+    }
+    std::remove(db_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+
+    std::cout << "Update Delta Log Record tests passed!" << std::endl;
+}
+
+// Test fuzzy checkpoints: no page flushed, redo starts at the min recLSN
+void TestFuzzyCheckpoint() {
+    std::cout << "Testing Fuzzy Checkpoint..." << std::endl;
+
+    const std::string db_name = "test_fuzzy_checkpoint.db";
+    const std::string snapshot_name = "test_fuzzy_checkpoint.snapshot";
+    const std::string log_name = "test_fuzzy_checkpoint.log";
+    std::remove(db_name.c_str());
+    std::remove(snapshot_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    auto copy_file = [](const std::string& from, const std::string& to) {
+        std::ifstream in(from, std::ios::binary);
+        std::ofstream out(to, std::ios::binary | std::ios::trunc);
+        out << in.rdbuf();
+    };
+    Schema schema({{"id", TypeId::INTEGER, 4, false, true},
+                   {"name", TypeId::VARCHAR, 256, false, false}});
+    const int num_rows = 300;
+
+    lsn_t first_delete_lsn = INVALID_LSN;
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        LogManager log_manager(log_name);
+        Catalog catalog(bpm.get(), &log_manager);
+        LockManager lock_manager;
+        TransactionManager txn_manager(&lock_manager, &log_manager);
+        RecoveryManager recovery_manager(bpm.get(), &catalog, &log_manager,
+                                         &lock_manager);
+        recovery_manager.SetTransactionManager(&txn_manager);
+        assert(catalog.CreateTable("checkpoint_test", schema));
+        TableHeap* heap = catalog.GetTable("checkpoint_test")->table_heap.get();
+
+        Transaction* txn1 = txn_manager.Begin();
+        std::vector<RID> rids;
+        for (int i = 0; i < num_rows; i++) {
+            std::string name(100, static_cast<char>('a' + i % 26));
+            Tuple tuple({Value(int32_t(i)), Value(name)}, &schema);
+            RID rid;
+            assert(heap->InsertTuple(tuple, &rid, txn1->GetTxnId()));
+            rids.push_back(rid);
+        }
+        txn_manager.Commit(txn1);
+
+        // Inserts are on disk, nothing is dirty until the deletes
+        catalog.SaveCatalogToDisk();
+        bpm->FlushAllPages();
+        copy_file(db_name, snapshot_name);
+        assert(bpm->GetDirtyPageTable().empty());
+
+        Transaction* txn2 = txn_manager.Begin();
+        first_delete_lsn = log_manager.GetLastReservedLSN() + 1;
+        for (int i = num_rows - 3; i >= 0; i -= 3) {
+            assert(heap->DeleteTuple(rids[i], txn2->GetTxnId()));
+        }
+        txn_manager.Commit(txn2);
+
+        // Still running while the checkpoint is taken, commits afterwards
+        Transaction* txn3 = txn_manager.Begin();
+        lsn_t txn3_begin_lsn = txn3->GetPrevLSN();
+
+        auto dirty_pages = bpm->GetDirtyPageTable();
+        assert(!dirty_pages.empty());
+        for (const auto& [page_id, rec_lsn] : dirty_pages) {
+            assert(rec_lsn >= first_delete_lsn);
+        }
+        recovery_manager.Checkpoint();
+        assert(bpm->GetDirtyPageTable().size() == dirty_pages.size());
+
+        auto cursor = log_manager.CreateLogCursor();
+        assert(cursor->SeekToLast());
+        assert(cursor->GetRecord().GetType() == LogRecordType::CHECKPOINT);
+        const auto& checkpoint =
+            static_cast<const CheckpointLogRecord&>(cursor->GetRecord());
+        assert(checkpoint.IsDirtyPageTableComplete());
+        assert(checkpoint.GetRedoLSN() == first_delete_lsn);
+        assert(checkpoint.GetBeginLSN() <= checkpoint.GetLSN());
+        assert(checkpoint.GetDirtyPageTable().size() == dirty_pages.size());
+        assert(checkpoint.GetActiveTxnTable().size() == 1);
+        assert(checkpoint.GetActiveTxnTable()[0].first == txn3->GetTxnId());
+        assert(checkpoint.GetActiveTxnTable()[0].second == txn3_begin_lsn);
+
+        txn_manager.Commit(txn3);
+    }
+
+    // Crash with only the pre-delete pages on disk
+    copy_file(snapshot_name, db_name);
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(
+            64, std::make_unique<DiskManager>(db_name),
+            std::make_unique<LRUReplacer>(64));
+        LogManager log_manager(log_name);
+        Catalog catalog(bpm.get(), &log_manager);
+        LockManager lock_manager;
+        RecoveryManager recovery_manager(bpm.get(), &catalog, &log_manager,
+                                         &lock_manager);
+        recovery_manager.Recover();
+
+        // The inserts before the min recLSN are not replayed
+        assert(recovery_manager.GetRedoStartLSN() == first_delete_lsn);
+        assert(recovery_manager.GetRedoOperationCount() ==
+               static_cast<size_t>(num_rows / 3));
+
+        TableHeap* heap = catalog.GetTable("checkpoint_test")->table_heap.get();
+        int count = 0;
+        for (auto it = heap->Begin(); !it.IsEnd(); ++it) {
+            Tuple tuple = *it;
+            assert(std::get<int32_t>(tuple.GetValue(0)) % 3 != 0);
+            count++;
+        }
+        assert(count == num_rows - num_rows / 3);
+    }
+
+    std::remove(db_name.c_str());
+    std::remove(snapshot_name.c_str());
+    LogManager::RemoveLogFiles(log_name);
+    std::cout << "Fuzzy Checkpoint tests passed!" << std::endl;
+}
+
 // Test Page operations
 void TestPage() {
     std::cout << "Testing Page..." << std::endl;
@@ -119,7 +9286,94 @@ int main() {
     try {
         TestPage();
         TestLRUReplacer();
+        TestClockReplacer();
+        TestLRUKReplacer();
+        TestTwoQReplacer();
+        TestDiskManagerIOModes();
+        TestDatabaseFileHeader();
         TestBufferPoolManager();
+        TestShardedBufferPoolManager();
+        TestBufferPoolResize();
+        TestBackgroundWriter();
+        TestBulkReadStrategy();
+        TestTableHeapReadAhead();
+        TestTableHeapFreeSpaceMap();
+        TestTableHeapBulkInsert();
+        TestPageKeySearch();
+        TestLeafPrefixCompression();
+        TestBPlusTreeBulkLoad();
+        TestBPlusTreeConcurrentAccess();
+        TestIndexPersistence();
+        TestIndexRangeScan();
+        TestNonUniqueIndex();
+        TestCompositeIndex();
+        TestInlineStringKey();
+        TestHashIndex();
+        TestCoveringIndex();
+        TestZoneMap();
+        TestVectorizedExecution();
+        TestVectorKernels();
+        TestCompiledExpression();
+        TestRowFormat();
+        TestTupleView();
+        TestHashJoin();
+        TestIndexNestedLoopJoin();
+        TestHashAggregation();
+        TestExternalSort();
+        TestLimitPushdown();
+        TestParallelScan();
+        TestTableHeapPageDirectory();
+        TestExtentAllocation();
+        TestCostBasedOptimizer();
+        TestPreparedStatements();
+        TestQueryFingerprint();
+        TestSnapshotReads();
+        TestPartitionedLockManager();
+        TestHierarchicalLocks();
+        TestDeadlockDetection();
+        TestTransactionTable();
+        TestReadOnlyTransactions();
+        TestStreamingResults();
+        TestNumaTopology();
+        TestShardedStatistics();
+        TestAsyncLogSink();
+        TestQueryArena();
+        TestTupleReuse();
+        TestCompactValue();
+        TestPlanCatalogBinding();
+        TestExplainAnalyze();
+        TestMetricsExposition();
+        TestLatencyPercentiles();
+        TestPlanCapture();
+        TestTraceSpans();
+        TestColumnStore();
+        TestPageCompression();
+        TestPageChecksums();
+        TestInPlaceUpdate();
+        TestVacuum();
+        TestCopy();
+        TestMmapReadOnly();
+        TestLazyStartup();
+        TestWarmupDump();
+    TestReplication();
+    TestPartitionedTables();
+    TestBitmapIndexScan();
+    TestResultCache();
+    TestQueryCancellation();
+    TestMemoryTracker();
+    TestZeroCopyLexer();
+    TestBloomFilter();
+    TestWorkStealingThreadPool();
+    TestBinaryProtocolFraming();
+    TestAdmissionController();
+    TestEventLoopPipelining();
+        TestWalFile();
+        TestLogGroupCommit();
+        TestLogDoubleBuffer();
+        TestLogCursor();
+        TestUpdateDeltaLogRecord();
+        TestParallelRedo();
+        TestFuzzyCheckpoint();
         
         // TODO: Add more tests for other components
         // TestBPlusTree();
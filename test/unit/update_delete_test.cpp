@@ -50,6 +50,7 @@ public:
         // 清理测试文件
         std::remove("update_delete_test.db");
         std::remove("update_delete_test.log");
+        LogManager::RemoveLogFiles("update_delete_test.log");
     }
 
     void RunTests() {
@@ -267,6 +268,7 @@ void DemoUpdateDeleteFeatures() {
     // 清理
     std::remove("demo.db");
     std::remove("demo.log");
+    LogManager::RemoveLogFiles("demo.log");
     
     std::cout << "演示完成!" << std::endl;
 }